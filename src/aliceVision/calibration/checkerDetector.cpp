@@ -6,6 +6,11 @@
 
 #include <OpenImageIO/imagebufalgo.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+
 
 // TODO: to remove when moving to eigen 3.4
 namespace Eigen
@@ -19,6 +24,68 @@ using RowVector = Matrix<Type, 1, Size>;
 namespace aliceVision{
 namespace calibration{
 
+namespace {
+
+/**
+ * @brief Bucket the corners in square cells, the corners closer than the cell size
+ * to a position are in the 3x3 cells around it.
+ */
+class CornersGrid
+{
+public:
+    explicit CornersGrid(double cellSize) : _cellSize(cellSize) {}
+
+    void insert(IndexT id, const Vec2 & pt)
+    {
+        _cells[key(cell(pt.x()), cell(pt.y()))].push_back(id);
+    }
+
+    /// @return true if the predicate is true for one of the corners in the cells around pt
+    template <class Predicate>
+    bool anyNeighbor(const Vec2 & pt, const Predicate & predicate) const
+    {
+        const int cx = cell(pt.x());
+        const int cy = cell(pt.y());
+        for (int y = cy - 1; y <= cy + 1; y++)
+        {
+            for (int x = cx - 1; x <= cx + 1; x++)
+            {
+                const auto it = _cells.find(key(x, y));
+                if (it == _cells.end())
+                {
+                    continue;
+                }
+
+                for (IndexT id : it->second)
+                {
+                    if (predicate(id))
+                    {
+                        return true;
+                    }
+                }
+            }
+        }
+
+        return false;
+    }
+
+private:
+    int cell(double v) const
+    {
+        return static_cast<int>(std::floor(v / _cellSize));
+    }
+
+    static std::int64_t key(int x, int y)
+    {
+        return (static_cast<std::int64_t>(x) << 32) | static_cast<std::uint32_t>(y);
+    }
+
+    const double _cellSize;
+    std::unordered_map<std::int64_t, std::vector<IndexT>> _cells;
+};
+
+} // namespace
+
 
 
 bool CheckerDetector::process(const image::Image<image::RGBColor> & source)
@@ -27,37 +94,40 @@ bool CheckerDetector::process(const image::Image<image::RGBColor> & source)
     image::ConvertPixelType(source, &grayscale);
 
     const double scales[] = {1.0, 0.75, 0.5, 0.25};
+    const int nbScales = sizeof(scales) / sizeof(scales[0]);
 
-    std::vector<Vec2> allCorners;
-    for (double scale : scales)
+    // The levels are independent, only their merge is sequential
+    std::vector<std::vector<Vec2>> cornersPerScale(nbScales);
+    std::vector<char> isValidScale(nbScales, 0);
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int idScale = 0; idScale < nbScales; idScale++)
     {
-        std::vector<Vec2> corners;
-        if (!processLevel(corners, grayscale, scale))
-        {
-            return false;
-        }
+        isValidScale[idScale] = processLevel(cornersPerScale[idScale], grayscale, scales[idScale]);
+    }
+
+    if (std::find(isValidScale.begin(), isValidScale.end(), 0) != isValidScale.end())
+    {
+        return false;
+    }
 
+    std::vector<Vec2> allCorners;
+    CornersGrid allCornersGrid(5.0);
+    for (const std::vector<Vec2> & corners : cornersPerScale)
+    {
         //Merge with previous level corners
-        for (Vec2 c : corners)
+        for (const Vec2 & c : corners)
         {
-            double distmin = 5.0;
-
-            for (Vec2 oc : allCorners)
-            {
-                double dist = (oc - c).norm();
-                
-                if (dist < distmin)
-                {
-                    distmin = dist;
-                    break;
-                }
-            }
+            const bool hasCloseCorner = allCornersGrid.anyNeighbor(c, [&](IndexT id) {
+                return (allCorners[id] - c).norm() < 5.0;
+            });
 
-            if (distmin < 5.0)
+            if (hasCloseCorner)
             {
                 continue;
-            } 
+            }
 
+            allCornersGrid.insert(allCorners.size(), c);
             allCorners.push_back(c);
         }
     }
@@ -70,21 +140,20 @@ bool CheckerDetector::process(const image::Image<image::RGBColor> & source)
     std::vector<CheckerBoardCorner> fitted_corners;
     fitCorners(fitted_corners, allCorners, normalized);
 
-    //Remove multiple points at the same position
-    for (int i = 0; i < fitted_corners.size(); i++)
+    //Remove multiple points at the same position, keep the last one
+    CornersGrid fittedCornersGrid(2.0);
+    for (IndexT i = 0; i < fitted_corners.size(); i++)
     {
-        const CheckerBoardCorner & ci = fitted_corners[i];
+        fittedCornersGrid.insert(i, fitted_corners[i].center);
+    }
 
-        bool found = false;
-        for (int j = i + 1; j < fitted_corners.size(); j++)
-        {
-            const CheckerBoardCorner & cj = fitted_corners[j];
+    for (IndexT i = 0; i < fitted_corners.size(); i++)
+    {
+        const CheckerBoardCorner & ci = fitted_corners[i];
 
-            if ((ci.center - cj.center).norm() < 2.0) 
-            {
-                found = true;
-            }
-        }
+        const bool found = fittedCornersGrid.anyNeighbor(ci.center, [&](IndexT j) {
+            return j > i && (ci.center - fitted_corners[j].center).norm() < 2.0;
+        });
 
         if (!found)
         {
@@ -401,15 +470,21 @@ bool CheckerDetector::fitCorners(std::vector<CheckerBoardCorner> & refined_corne
     image::Image<float> filtered;
     image::ImageConvolution(input, kernel, filtered);
 
-    Eigen::MatrixXd AtA(6, 6);
-    Eigen::Vector<double, 6> Atb;
-
     const image::Sampler2d<image::SamplerLinear> sampler;
 
-    for (Vec2 corner : raw_corners)
+    // The corners are fitted independently, the valid ones are kept in the input order
+    std::vector<Vec2> fitted_centers(raw_corners.size());
+    std::vector<char> isValidCorner(raw_corners.size(), 0);
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int idCorner = 0; idCorner < raw_corners.size(); idCorner++)
     {
+        Vec2 corner = raw_corners[idCorner];
         bool isValid = true;
 
+        Eigen::MatrixXd AtA(6, 6);
+        Eigen::Vector<double, 6> Atb;
+
         const double cx = corner(0);
         const double cy = corner(1);
 
@@ -497,23 +572,31 @@ bool CheckerDetector::fitCorners(std::vector<CheckerBoardCorner> & refined_corne
         }
 
         
-        if (isValid)   
+        fitted_centers[idCorner] = corner;
+        isValidCorner[idCorner] = isValid;
+    }
+
+    for (std::size_t idCorner = 0; idCorner < raw_corners.size(); idCorner++)
+    {
+        if (isValidCorner[idCorner])
         {
             CheckerBoardCorner c;
-            c.center = corner;
+            c.center = fitted_centers[idCorner];
             refined_corners.push_back(c);
         }
     }
 
-    for (CheckerBoardCorner & corner : refined_corners)
+    #pragma omp parallel for schedule(dynamic)
+    for (int idCorner = 0; idCorner < refined_corners.size(); idCorner++)
     {
+        CheckerBoardCorner & corner = refined_corners[idCorner];
         bool isValid = true;
 
         const double cx = corner.center(0);
         const double cy = corner.center(1);
 
-        AtA.fill(0);
-        Atb.fill(0);
+        Eigen::MatrixXd AtA = Eigen::MatrixXd::Zero(6, 6);
+        Eigen::Vector<double, 6> Atb = Eigen::Vector<double, 6>::Zero();
 
         for (int i = -radius; i <= radius; i++)
         {
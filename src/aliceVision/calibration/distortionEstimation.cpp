@@ -23,8 +23,8 @@ public:
     {
         set_num_residuals(1);
 
-        mutable_parameter_block_sizes()->push_back(1);
-        mutable_parameter_block_sizes()->push_back(1);
+        // the angle and the distance of the line are in the same block, it is eliminated by the Schur complement
+        mutable_parameter_block_sizes()->push_back(2);
         mutable_parameter_block_sizes()->push_back(2);
         mutable_parameter_block_sizes()->push_back(2);
         mutable_parameter_block_sizes()->push_back(camera->getDistortionParams().size());
@@ -32,14 +32,13 @@ public:
 
     bool Evaluate(double const* const* parameters, double* residuals, double** jacobians) const override
     {
-        const double* parameter_angle_line = parameters[0];
-        const double* parameter_dist_line = parameters[1];
-        const double* parameter_scale = parameters[2];
-        const double* parameter_center = parameters[3];
-        const double* parameter_disto = parameters[4];
+        const double* parameter_line = parameters[0];
+        const double* parameter_scale = parameters[1];
+        const double* parameter_center = parameters[2];
+        const double* parameter_disto = parameters[3];
 
-        const double angle = parameter_angle_line[0];
-        const double distanceToLine = parameter_dist_line[0];
+        const double angle = parameter_line[0];
+        const double distanceToLine = parameter_line[1];
 
         const double cangle = cos(angle);
         const double sangle = sin(angle);
@@ -67,20 +66,15 @@ public:
 
         if(jacobians[0] != nullptr)
         {
-            Eigen::Map<Eigen::Matrix<double, 1, 1, Eigen::RowMajor>> J(jacobians[0]);
+            Eigen::Map<Eigen::Matrix<double, 1, 2, Eigen::RowMajor>> J(jacobians[0]);
 
             J(0, 0) = w * (ipt.x() * -sangle + ipt.y() * cangle);
+            J(0, 1) = -w;
         }
 
         if(jacobians[1] != nullptr)
         {
-            Eigen::Map<Eigen::Matrix<double, 1, 1, Eigen::RowMajor>> J(jacobians[1]);
-            J(0, 0) = -w;
-        }
-
-        if(jacobians[2] != nullptr)
-        {
-            Eigen::Map<Eigen::Matrix<double, 1, 2, Eigen::RowMajor>> J(jacobians[2]);
+            Eigen::Map<Eigen::Matrix<double, 1, 2, Eigen::RowMajor>> J(jacobians[1]);
             
             Eigen::Matrix<double, 1, 2> Jline;
             Jline(0, 0) = cangle;
@@ -89,9 +83,9 @@ public:
             J = w * Jline * (_camera->getDerivativeIma2CamWrtScale(distorted) + _camera->getDerivativeCam2ImaWrtPoint() * _camera->getDerivativeAddDistoWrtPt(cpt) * _camera->getDerivativeIma2CamWrtScale(_pt));
         }
 
-        if(jacobians[3] != nullptr)
+        if(jacobians[2] != nullptr)
         {
-            Eigen::Map<Eigen::Matrix<double, 1, 2, Eigen::RowMajor>> J(jacobians[3]);
+            Eigen::Map<Eigen::Matrix<double, 1, 2, Eigen::RowMajor>> J(jacobians[2]);
 
             Eigen::Matrix<double, 1, 2> Jline;
             Jline(0, 0) = cangle;
@@ -100,9 +94,9 @@ public:
             J = w * Jline * (_camera->getDerivativeCam2ImaWrtPrincipalPoint() + _camera->getDerivativeCam2ImaWrtPoint() * _camera->getDerivativeAddDistoWrtPt(cpt) * _camera->getDerivativeIma2CamWrtPrincipalPoint());
         }
 
-        if(jacobians[4] != nullptr)
+        if(jacobians[3] != nullptr)
         {
-            Eigen::Map<Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>> J(jacobians[4], 1, distortionSize);
+            Eigen::Map<Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>> J(jacobians[3], 1, distortionSize);
 
             Eigen::Matrix<double, 1, 2> Jline;
             Jline(0, 0) = cangle;
@@ -288,15 +282,28 @@ bool estimate(std::shared_ptr<camera::Pinhole> & cameraToEstimate, Statistics &
     }
     
     
-    for (auto & l : lines)
+    // The lines parameters are eliminated first, the reduced system only contains the camera parameters
+    ceres::ParameterBlockOrdering* ordering = new ceres::ParameterBlockOrdering;
+    ordering->AddElementToGroup(scale, 1);
+    ordering->AddElementToGroup(center, 1);
+    ordering->AddElementToGroup(distortionParameters, 1);
+
+    // (angle, distance) of each line
+    std::vector<Vec2> linesParameters(lines.size());
+    for (std::size_t idLine = 0; idLine < lines.size(); idLine++)
     {
-        problem.AddParameterBlock(&l.angle, 1);
-        problem.AddParameterBlock(&l.dist, 1);
+        const LineWithPoints & l = lines[idLine];
+        double * lineParameters = linesParameters[idLine].data();
+        lineParameters[0] = l.angle;
+        lineParameters[1] = l.dist;
+
+        problem.AddParameterBlock(lineParameters, 2);
+        ordering->AddElementToGroup(lineParameters, 0);
 
-        for (Vec2 pt : l.points)
+        for (const Vec2 & pt : l.points)
         {
             ceres::CostFunction * costFunction = new CostLine(cameraToEstimate, pt);   
-            problem.AddResidualBlock(costFunction, lossFunction, &l.angle, &l.dist, scale, center, distortionParameters);
+            problem.AddResidualBlock(costFunction, lossFunction, lineParameters, scale, center, distortionParameters);
         }
     }
 
@@ -304,6 +311,8 @@ bool estimate(std::shared_ptr<camera::Pinhole> & cameraToEstimate, Statistics &
     options.use_inner_iterations = true;
     options.max_num_iterations = 10000; 
     options.logging_type = ceres::SILENT;
+    options.linear_solver_type = ceres::DENSE_SCHUR;
+    options.linear_solver_ordering.reset(ordering);
 
     ceres::Solver::Summary summary;  
     ceres::Solve(options, &problem, &summary);
@@ -318,6 +327,12 @@ bool estimate(std::shared_ptr<camera::Pinhole> & cameraToEstimate, Statistics &
 
     cameraToEstimate->updateFromParams(params);
 
+    for (std::size_t idLine = 0; idLine < lines.size(); idLine++)
+    {
+        lines[idLine].angle = linesParameters[idLine](0);
+        lines[idLine].dist = linesParameters[idLine](1);
+    }
+
     std::vector<double> errors;
 
     for (auto & l : lines)
@@ -454,6 +469,8 @@ bool estimate(std::shared_ptr<camera::Pinhole> & cameraToEstimate, Statistics &
     options.use_inner_iterations = true;
     options.max_num_iterations = 10000; 
     options.logging_type = ceres::SILENT;
+    // all the residuals depend on the few camera parameters, the normal equations are small and dense
+    options.linear_solver_type = ceres::DENSE_NORMAL_CHOLESKY;
 
     ceres::Solver::Summary summary;  
     ceres::Solve(options, &problem, &summary);
@@ -135,6 +135,9 @@ bool findPattern(const Pattern& pattern, const cv::Mat& viewGray, const cv::Size
       boost::ptr_list<cctag::ICCTag> cctags;
       cctag::logtime::Mgmt durations( 25 );
 
+      // the frames are processed in parallel by the calibration softwares,
+      // but all the detections share the CCTag pipe 0: they are serialized
+      #pragma omp critical(cctagDetection)
       cctag::cctagDetection(cctags, pipeId, frame, viewGray, cctagParams, &durations);
 
       boost::ptr_list<cctag::ICCTag>::iterator iterCCTags = cctags.begin();
@@ -42,6 +42,22 @@ public:
         return p;
     }
 
+    /// Add distortion to each column of p (assume p is in the camera frame [normalized coordinates])
+    virtual void addDistortionBatch(const Mat2X& p, Mat2X& distorted) const
+    {
+        distorted.resize(2, p.cols());
+        for(Mat2X::Index i = 0; i < p.cols(); ++i)
+            distorted.col(i) = addDistortion(p.col(i));
+    }
+
+    /// Remove distortion from each column of p
+    virtual void removeDistortionBatch(const Mat2X& p, Mat2X& undistorted) const
+    {
+        undistorted.resize(2, p.cols());
+        for(Mat2X::Index i = 0; i < p.cols(); ++i)
+            undistorted.col(i) = removeDistortion(p.col(i));
+    }
+
     virtual double getUndistortedRadius(double r) const
     {
         return r;
@@ -70,6 +86,32 @@ public:
     virtual ~Distortion() = default;
 
 protected:
+    /**
+     * @brief Batch distortion with a static dispatch to the point function of the distortion model,
+     *        to be used by the models to implement addDistortionBatch.
+     */
+    template <class DistortionModel>
+    void addDistortionBatchImpl(const Mat2X& p, Mat2X& distorted) const
+    {
+        const DistortionModel& model = static_cast<const DistortionModel&>(*this);
+        distorted.resize(2, p.cols());
+        for(Mat2X::Index i = 0; i < p.cols(); ++i)
+            distorted.col(i) = model.DistortionModel::addDistortion(p.col(i));
+    }
+
+    /**
+     * @brief Batch undistortion with a static dispatch to the point function of the distortion model,
+     *        to be used by the models to implement removeDistortionBatch.
+     */
+    template <class DistortionModel>
+    void removeDistortionBatchImpl(const Mat2X& p, Mat2X& undistorted) const
+    {
+        const DistortionModel& model = static_cast<const DistortionModel&>(*this);
+        undistorted.resize(2, p.cols());
+        for(Mat2X::Index i = 0; i < p.cols(); ++i)
+            undistorted.col(i) = model.DistortionModel::removeDistortion(p.col(i));
+    }
+
     std::vector<double> _distortionParams{};
 };
 
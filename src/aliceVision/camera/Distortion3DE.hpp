@@ -38,6 +38,16 @@ public:
 
   Distortion3DERadial4* clone() const override { return new Distortion3DERadial4(*this); }
 
+  void addDistortionBatch(const Mat2X& p, Mat2X& distorted) const override
+  {
+    addDistortionBatchImpl<Distortion3DERadial4>(p, distorted);
+  }
+
+  void removeDistortionBatch(const Mat2X& p, Mat2X& undistorted) const override
+  {
+    removeDistortionBatchImpl<Distortion3DERadial4>(p, undistorted);
+  }
+
   /// Add distortion to the point p (assume p is in the camera frame [normalized coordinates])
   Vec2 addDistortion(const Vec2 & p) const override
   {
@@ -282,6 +292,16 @@ public:
 
   Distortion3DEAnamorphic4* clone() const override { return new Distortion3DEAnamorphic4(*this); }
 
+  void addDistortionBatch(const Mat2X& p, Mat2X& distorted) const override
+  {
+    addDistortionBatchImpl<Distortion3DEAnamorphic4>(p, distorted);
+  }
+
+  void removeDistortionBatch(const Mat2X& p, Mat2X& undistorted) const override
+  {
+    removeDistortionBatchImpl<Distortion3DEAnamorphic4>(p, undistorted);
+  }
+
   /// Add distortion to the point p (assume p is in the camera frame [normalized coordinates])
   Vec2 addDistortion(const Vec2 & p) const override
   {
@@ -423,6 +443,16 @@ public:
 
   Distortion3DEClassicLD* clone() const override { return new Distortion3DEClassicLD(*this); }
 
+  void addDistortionBatch(const Mat2X& p, Mat2X& distorted) const override
+  {
+    addDistortionBatchImpl<Distortion3DEClassicLD>(p, distorted);
+  }
+
+  void removeDistortionBatch(const Mat2X& p, Mat2X& undistorted) const override
+  {
+    removeDistortionBatchImpl<Distortion3DEClassicLD>(p, undistorted);
+  }
+
   /// Add distortion to the point p (assume p is in the camera frame [normalized coordinates])
   Vec2 addDistortion(const Vec2 & p) const override
   {
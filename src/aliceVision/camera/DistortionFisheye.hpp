@@ -30,6 +30,16 @@ public:
       return new DistortionFisheye(*this);
   }
 
+  void addDistortionBatch(const Mat2X& p, Mat2X& distorted) const override
+  {
+    addDistortionBatchImpl<DistortionFisheye>(p, distorted);
+  }
+
+  void removeDistortionBatch(const Mat2X& p, Mat2X& undistorted) const override
+  {
+    removeDistortionBatchImpl<DistortionFisheye>(p, undistorted);
+  }
+
   /// Add distortion to the point p (assume p is in the camera frame [normalized coordinates])
   Vec2 addDistortion(const Vec2 & p) const override
   {
@@ -28,6 +28,16 @@ public:
 
   DistortionFisheye1* clone() const override { return new DistortionFisheye1(*this); }
 
+  void addDistortionBatch(const Mat2X& p, Mat2X& distorted) const override
+  {
+    addDistortionBatchImpl<DistortionFisheye1>(p, distorted);
+  }
+
+  void removeDistortionBatch(const Mat2X& p, Mat2X& undistorted) const override
+  {
+    removeDistortionBatchImpl<DistortionFisheye1>(p, undistorted);
+  }
+
   /// Add distortion to the point p (assume p is in the camera frame [normalized coordinates])
   Vec2 addDistortion(const Vec2 & p) const override
   {
@@ -73,6 +73,20 @@ public:
 
   DistortionRadialK1* clone() const override { return new DistortionRadialK1(*this); }
 
+  /// Add distortion to each column of p (assume p is in the camera frame [normalized coordinates])
+  void addDistortionBatch(const Mat2X& p, Mat2X& distorted) const override
+  {
+    const double k1 = _distortionParams.at(0);
+
+    const Eigen::Array<double, 1, Eigen::Dynamic> r2 = p.colwise().squaredNorm().array();
+    distorted = p.array().rowwise() * (1. + k1 * r2);
+  }
+
+  void removeDistortionBatch(const Mat2X& p, Mat2X& undistorted) const override
+  {
+    removeDistortionBatchImpl<DistortionRadialK1>(p, undistorted);
+  }
+
   /// Add distortion to the point p (assume p is in the camera frame [normalized coordinates])
   Vec2 addDistortion(const Vec2 & p) const override
   {
@@ -227,6 +241,22 @@ public:
 
   DistortionRadialK3* clone() const override { return new DistortionRadialK3(*this); }
 
+  /// Add distortion to each column of p (assume p is in the camera frame [normalized coordinates])
+  void addDistortionBatch(const Mat2X& p, Mat2X& distorted) const override
+  {
+    const double k1 = _distortionParams[0];
+    const double k2 = _distortionParams[1];
+    const double k3 = _distortionParams[2];
+
+    const Eigen::Array<double, 1, Eigen::Dynamic> r2 = p.colwise().squaredNorm().array();
+    distorted = p.array().rowwise() * (1. + r2 * (k1 + r2 * (k2 + r2 * k3)));
+  }
+
+  void removeDistortionBatch(const Mat2X& p, Mat2X& undistorted) const override
+  {
+    removeDistortionBatchImpl<DistortionRadialK3>(p, undistorted);
+  }
+
   /// Add distortion to the point p (assume p is in the camera frame [normalized coordinates])
   Vec2 addDistortion(const Vec2 & p) const override
   {
@@ -398,6 +428,22 @@ public:
 
   DistortionRadialK3PT* clone() const override { return new DistortionRadialK3PT(*this); }
 
+  /// Add distortion to each column of p (assume p is in the camera frame [normalized coordinates])
+  void addDistortionBatch(const Mat2X& p, Mat2X& distorted) const override
+  {
+    const double k1 = _distortionParams[0];
+    const double k2 = _distortionParams[1];
+    const double k3 = _distortionParams[2];
+
+    const Eigen::Array<double, 1, Eigen::Dynamic> r2 = p.colwise().squaredNorm().array();
+    distorted = p.array().rowwise() * ((1. + r2 * (k1 + r2 * (k2 + r2 * k3))) / (1.0 + k1 + k2 + k3));
+  }
+
+  void removeDistortionBatch(const Mat2X& p, Mat2X& undistorted) const override
+  {
+    removeDistortionBatchImpl<DistortionRadialK3PT>(p, undistorted);
+  }
+
   /// Add distortion to the point p (assume p is in the camera frame [normalized coordinates])
   Vec2 addDistortion(const Vec2 & p) const override
   {
@@ -96,6 +96,13 @@ public:
     return pt_ima;
   }
 
+  void projectBatch(const geometry::Pose3& pose, const Mat3X& pts3D, Mat2X& pts2D, bool applyDistortion = true) const override
+  {
+    pts2D.resize(2, pts3D.cols());
+    for(Mat3X::Index i = 0; i < pts3D.cols(); ++i)
+      pts2D.col(i) = EquiDistant::project(pose, pts3D.col(i).homogeneous(), applyDistortion);
+  }
+
   Eigen::Matrix<double, 2, 9> getDerivativeProjectWrtRotation(const geometry::Pose3& pose, const Vec4 & pt) 
   {
     Eigen::Matrix4d T = pose.getHomogeneous();
@@ -402,12 +409,24 @@ public:
     return Eigen::Matrix2d::Identity() * _circleRadius;
   }
 
+  // Transform several points from the camera plane to the image plane
+  void cam2imaBatch(const Mat2X& p, Mat2X& ima) const override
+  {
+    ima = (_circleRadius * p).colwise() + getPrincipalPoint();
+  }
+
   // Transform a point from the image plane to the camera plane
   Vec2 ima2cam(const Vec2& p) const override
   {
     return (p - getPrincipalPoint()) / _circleRadius;
   }
 
+  // Transform several points from the image plane to the camera plane
+  void ima2camBatch(const Mat2X& p, Mat2X& cam) const override
+  {
+    cam = (p.colwise() - getPrincipalPoint()) / _circleRadius;
+  }
+
   Eigen::Matrix2d getDerivativeIma2CamWrtPoint() const override
   {
     return Eigen::Matrix2d::Identity() * (1.0 / _circleRadius);
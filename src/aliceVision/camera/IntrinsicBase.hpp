@@ -139,6 +139,20 @@ public:
    */
   virtual Vec2 project(const geometry::Pose3& pose, const Vec4& pt3D, bool applyDistortion = true) const = 0;
 
+  /**
+   * @brief Projection of several 3D points into the camera plane with the same pose
+   * @param[in] pose The pose
+   * @param[in] pts3D The 3d points (one per column)
+   * @param[out] pts2D The 2d projections in the camera plane (one per column)
+   * @param[in] applyDistortion If true apply distrortion if any
+   */
+  virtual void projectBatch(const geometry::Pose3& pose, const Mat3X& pts3D, Mat2X& pts2D, bool applyDistortion = true) const
+  {
+    pts2D.resize(2, pts3D.cols());
+    for(Mat3X::Index i = 0; i < pts3D.cols(); ++i)
+      pts2D.col(i) = project(pose, pts3D.col(i).homogeneous(), applyDistortion);
+  }
+
   /**
    * @brief Back-projection of a 2D point at a specific depth into a 3D point
    * @param[in] pt2D The 2d point
@@ -429,6 +443,54 @@ public:
    */
   virtual Vec2 get_d_pixel(const Vec2& p) const = 0;
 
+  /**
+   * @brief Add the distortion field to several points (that are in normalized camera frame)
+   * @param[in] p The points (one per column)
+   * @param[out] distorted The points with added distortion field
+   */
+  virtual void addDistortionBatch(const Mat2X& p, Mat2X& distorted) const
+  {
+    distorted.resize(2, p.cols());
+    for(Mat2X::Index i = 0; i < p.cols(); ++i)
+      distorted.col(i) = addDistortion(p.col(i));
+  }
+
+  /**
+   * @brief Remove the distortion to several camera points (that are in normalized camera frame)
+   * @param[in] p The points (one per column)
+   * @param[out] undistorted The points with removed distortion field
+   */
+  virtual void removeDistortionBatch(const Mat2X& p, Mat2X& undistorted) const
+  {
+    undistorted.resize(2, p.cols());
+    for(Mat2X::Index i = 0; i < p.cols(); ++i)
+      undistorted.col(i) = removeDistortion(p.col(i));
+  }
+
+  /**
+   * @brief Return the undistorted pixels (with removed distortion), e.g. of a pixel grid
+   * @param[in] p The pixels (one per column)
+   * @param[out] undistorted The undistorted pixels
+   */
+  virtual void get_ud_pixelBatch(const Mat2X& p, Mat2X& undistorted) const
+  {
+    undistorted.resize(2, p.cols());
+    for(Mat2X::Index i = 0; i < p.cols(); ++i)
+      undistorted.col(i) = get_ud_pixel(p.col(i));
+  }
+
+  /**
+   * @brief Return the distorted pixels (with added distortion), e.g. of a pixel grid
+   * @param[in] p The undistorted pixels (one per column)
+   * @param[out] distorted The distorted pixels
+   */
+  virtual void get_d_pixelBatch(const Mat2X& p, Mat2X& distorted) const
+  {
+    distorted.resize(2, p.cols());
+    for(Mat2X::Index i = 0; i < p.cols(); ++i)
+      distorted.col(i) = get_d_pixel(p.col(i));
+  }
+
   /**
    * @brief Normalize a given unit pixel error to the camera plane
    * @param[in] value Given unit pixel error
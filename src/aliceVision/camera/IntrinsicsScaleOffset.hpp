@@ -80,6 +80,12 @@ public:
     return p.cwiseProduct(_scale) + getPrincipalPoint();
   }
 
+  // Transform several points from the camera plane to the image plane
+  virtual void cam2imaBatch(const Mat2X& p, Mat2X& ima) const
+  {
+    ima = (p.array().colwise() * _scale.array()).colwise() + getPrincipalPoint().array();
+  }
+
   virtual Eigen::Matrix2d getDerivativeCam2ImaWrtScale(const Vec2& p) const
   {
     Eigen::Matrix2d M = Eigen::Matrix2d::Zero();
@@ -118,6 +124,12 @@ public:
     return np;
   }
 
+  // Transform several points from the image plane to the camera plane
+  virtual void ima2camBatch(const Mat2X& p, Mat2X& cam) const
+  {
+    cam = (p.array().colwise() - getPrincipalPoint().array()).colwise() / _scale.array();
+  }
+
   virtual Eigen::Matrix<double, 2, 2> getDerivativeIma2CamWrtScale(const Vec2& p) const
   {
       Eigen::Matrix2d M = Eigen::Matrix2d::Zero();
@@ -86,6 +86,44 @@ public:
     return cam2ima(addDistortion(ima2cam(p)));
   }
 
+  void addDistortionBatch(const Mat2X& p, Mat2X& distorted) const override
+  {
+    if (_pDistortion == nullptr)
+    {
+      distorted = p;
+      return;
+    }
+    _pDistortion->addDistortionBatch(p, distorted);
+  }
+
+  void removeDistortionBatch(const Mat2X& p, Mat2X& undistorted) const override
+  {
+    if (_pDistortion == nullptr)
+    {
+      undistorted = p;
+      return;
+    }
+    _pDistortion->removeDistortionBatch(p, undistorted);
+  }
+
+  /// Return the un-distorted pixels (with removed distortion)
+  void get_ud_pixelBatch(const Mat2X& p, Mat2X& undistorted) const override
+  {
+    Mat2X cam, undistortedCam;
+    ima2camBatch(p, cam);
+    removeDistortionBatch(cam, undistortedCam);
+    cam2imaBatch(undistortedCam, undistorted);
+  }
+
+  /// Return the distorted pixels (with added distortion)
+  void get_d_pixelBatch(const Mat2X& p, Mat2X& distorted) const override
+  {
+    Mat2X cam, distortedCam;
+    ima2camBatch(p, cam);
+    addDistortionBatch(cam, distortedCam);
+    cam2imaBatch(distortedCam, distorted);
+  }
+
   std::size_t getDistortionParamsSize() const
   {
     if (_pDistortion == nullptr)
@@ -262,6 +300,15 @@ public:
       return _pDistortion;
   }
 
+  /**
+   * @brief Replace the distortion object, e.g. by a copy to not share it with the clones of this intrinsic
+   * @param[in] distortion The distortion object
+   */
+  void setDistortionObject(std::shared_ptr<Distortion> distortion)
+  {
+      _pDistortion = distortion;
+  }
+
   /**
   * @brief Set The intrinsic disto initialization mode
   * @param[in] distortionInitializationMode The intrintrinsic distortion initialization mode enum
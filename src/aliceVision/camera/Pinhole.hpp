@@ -103,12 +103,30 @@ public:
     const Vec4 X = pose.getHomogeneous() * pt; // apply pose
     const Vec2 P = X.head<2>() / X(2);
 
-    const Vec2 distorted = this->addDistortion(P);
+    const Vec2 distorted = applyDistortion ? this->addDistortion(P) : P;
     const Vec2 impt = this->cam2ima(distorted);
 
     return impt;
   }
 
+  void projectBatch(const geometry::Pose3& pose, const Mat3X& pts3D, Mat2X& pts2D, bool applyDistortion = true) const override
+  {
+    // apply pose
+    const Mat3X X = (pose.rotation() * (pts3D.colwise() - pose.center()));
+    const Mat2X P = X.colwise().hnormalized();
+
+    if(applyDistortion)
+    {
+      Mat2X distorted;
+      this->addDistortionBatch(P, distorted);
+      this->cam2imaBatch(distorted, pts2D);
+    }
+    else
+    {
+      this->cam2imaBatch(P, pts2D);
+    }
+  }
+
   Eigen::Matrix<double, 2, 9> getDerivativeProjectWrtRotation(const geometry::Pose3& pose, const Vec4 & pt)
   {
     const Vec4 X = pose.getHomogeneous() * pt; // apply pose
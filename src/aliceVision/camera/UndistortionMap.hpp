@@ -0,0 +1,261 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/numeric/numeric.hpp>
+#include <aliceVision/camera/cameraCommon.hpp>
+#include <aliceVision/camera/IntrinsicBase.hpp>
+#include <aliceVision/camera/Pinhole.hpp>
+#include <aliceVision/half.hpp>
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+namespace aliceVision {
+namespace camera {
+
+/**
+ * @brief Domain of an undistortion map: input image resolution and region of the undistorted image.
+ */
+struct UndistortionMapDomain
+{
+  UndistortionMapDomain() = default;
+
+  /**
+   * @param[in] imageWidth_ The distorted image width
+   * @param[in] imageHeight_ The distorted image height
+   * @param[in] correctPrincipalPoint_ Move the principal point to the image center
+   */
+  UndistortionMapDomain(int imageWidth_, int imageHeight_, bool correctPrincipalPoint_ = false)
+    : imageWidth(imageWidth_)
+    , imageHeight(imageHeight_)
+    , correctPrincipalPoint(correctPrincipalPoint_)
+    , width(imageWidth_)
+    , height(imageHeight_)
+  {}
+
+  /// Restrict the undistorted image to the region [xOffset, xOffset + width) x [yOffset, yOffset + height)
+  void setRegion(int xOffset_, int yOffset_, int width_, int height_)
+  {
+    xOffset = xOffset_;
+    yOffset = yOffset_;
+    width = width_;
+    height = height_;
+  }
+
+  bool operator<(const UndistortionMapDomain& other) const
+  {
+    return std::tie(imageWidth, imageHeight, correctPrincipalPoint, xOffset, yOffset, width, height) <
+           std::tie(other.imageWidth, other.imageHeight, other.correctPrincipalPoint, other.xOffset, other.yOffset, other.width, other.height);
+  }
+
+  int imageWidth = 0;
+  int imageHeight = 0;
+  bool correctPrincipalPoint = false;
+  int xOffset = 0;
+  int yOffset = 0;
+  int width = 0;
+  int height = 0;
+};
+
+/**
+ * @brief Precomputed remap table of an undistortion:
+ *        distorted pixel position of each pixel of the undistorted image.
+ *
+ * The displacement between the distorted and the undistorted positions is stored instead of the positions,
+ * its magnitude is small compared to the image size so it can be stored in half precision.
+ */
+class UndistortionMap
+{
+public:
+  /**
+   * @brief Compute the remap table
+   * @param[in] intrinsic The camera intrinsic
+   * @param[in] domain The map domain
+   * @param[in] halfPrecision Store the displacements in half precision
+   */
+  UndistortionMap(const IntrinsicBase& intrinsic, const UndistortionMapDomain& domain, bool halfPrecision = false)
+    : _domain(domain)
+    , _halfPrecision(halfPrecision)
+  {
+    Vec2 ppCorrection(0.0, 0.0);
+    if(domain.correctPrincipalPoint && isPinhole(intrinsic.getType()))
+    {
+      const Pinhole& pinhole = dynamic_cast<const Pinhole&>(intrinsic);
+      ppCorrection = pinhole.getPrincipalPoint() - Vec2(domain.imageWidth * 0.5, domain.imageHeight * 0.5);
+    }
+
+    const std::size_t nbValues = 2 * static_cast<std::size_t>(domain.width) * domain.height;
+    if(halfPrecision)
+      _displacementsHalf.resize(nbValues);
+    else
+      _displacements.resize(nbValues);
+
+    #pragma omp parallel for
+    for(int j = 0; j < domain.height; ++j)
+    {
+      Mat2X undistortedPixels(2, domain.width);
+      for(int i = 0; i < domain.width; ++i)
+        undistortedPixels.col(i) = Vec2(i + domain.xOffset, j + domain.yOffset);
+
+      Mat2X distortedPixels;
+      intrinsic.get_d_pixelBatch(undistortedPixels.colwise() + ppCorrection, distortedPixels);
+
+      const Mat2X displacements = distortedPixels - undistortedPixels;
+      const std::size_t rowOffset = 2 * static_cast<std::size_t>(j) * domain.width;
+      for(int i = 0; i < domain.width; ++i)
+      {
+        const std::size_t index = rowOffset + 2 * i;
+        if(halfPrecision)
+        {
+          _displacementsHalf[index] = half(static_cast<float>(displacements(0, i)));
+          _displacementsHalf[index + 1] = half(static_cast<float>(displacements(1, i)));
+        }
+        else
+        {
+          _displacements[index] = static_cast<float>(displacements(0, i));
+          _displacements[index + 1] = static_cast<float>(displacements(1, i));
+        }
+      }
+    }
+  }
+
+  const UndistortionMapDomain& getDomain() const { return _domain; }
+
+  int width() const { return _domain.width; }
+  int height() const { return _domain.height; }
+
+  bool isHalfPrecision() const { return _halfPrecision; }
+
+  /**
+   * @brief Get the distorted pixel position of a pixel of the undistorted image
+   * @param[in] i The column in the undistorted image region
+   * @param[in] j The row in the undistorted image region
+   * @return the pixel position in the distorted image
+   */
+  Vec2 getDistortedPixel(int i, int j) const
+  {
+    const std::size_t index = 2 * (static_cast<std::size_t>(j) * _domain.width + i);
+    if(_halfPrecision)
+      return Vec2(i + _domain.xOffset + static_cast<float>(_displacementsHalf[index]),
+                  j + _domain.yOffset + static_cast<float>(_displacementsHalf[index + 1]));
+    return Vec2(i + _domain.xOffset + _displacements[index],
+                j + _domain.yOffset + _displacements[index + 1]);
+  }
+
+  /// Memory used by the table (bytes)
+  std::size_t memorySize() const
+  {
+    return _displacements.size() * sizeof(float) + _displacementsHalf.size() * sizeof(half);
+  }
+
+private:
+  UndistortionMapDomain _domain;
+  bool _halfPrecision;
+  /// interleaved (dx, dy) displacements, row major
+  std::vector<float> _displacements;
+  std::vector<half> _displacementsHalf;
+};
+
+/**
+ * @brief Thread-safe cache of undistortion maps, shared by the images of the same intrinsic.
+ *        The least recently used maps are released when the memory limit is exceeded.
+ */
+class UndistortionMapCache
+{
+public:
+  /**
+   * @param[in] maxMemorySize The memory limit of the cached maps (bytes)
+   * @param[in] halfPrecision Store the displacements in half precision
+   */
+  explicit UndistortionMapCache(std::size_t maxMemorySize = 1024 * 1024 * 1024, bool halfPrecision = false)
+    : _maxMemorySize(maxMemorySize)
+    , _halfPrecision(halfPrecision)
+  {}
+
+  /**
+   * @brief Get the undistortion map of an intrinsic, compute it if it is not in the cache
+   * @param[in] intrinsic The camera intrinsic
+   * @param[in] domain The map domain
+   * @return the undistortion map
+   */
+  std::shared_ptr<const UndistortionMap> get(const IntrinsicBase& intrinsic, const UndistortionMapDomain& domain)
+  {
+    const Key key(intrinsic.hashValue(), domain);
+
+    // the map is computed under the lock: the images of the same intrinsic wait for it instead of computing it again
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    const auto it = _index.find(key);
+    if(it != _index.end())
+    {
+      // move the map to the front of the LRU list
+      _entries.splice(_entries.begin(), _entries, it->second);
+      return it->second->second;
+    }
+
+    std::shared_ptr<const UndistortionMap> map = std::make_shared<UndistortionMap>(intrinsic, domain, _halfPrecision);
+
+    if(map->memorySize() > _maxMemorySize)
+      return map;
+
+    _entries.emplace_front(key, map);
+    _index[key] = _entries.begin();
+    _memorySize += map->memorySize();
+
+    while(_memorySize > _maxMemorySize)
+    {
+      _memorySize -= _entries.back().second->memorySize();
+      _index.erase(_entries.back().first);
+      _entries.pop_back();
+    }
+    return map;
+  }
+
+  /// Number of cached maps
+  std::size_t size() const
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _entries.size();
+  }
+
+  /// Memory used by the cached maps (bytes)
+  std::size_t memorySize() const
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _memorySize;
+  }
+
+  /// Release all the cached maps
+  void clear()
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries.clear();
+    _index.clear();
+    _memorySize = 0;
+  }
+
+private:
+  using Key = std::pair<std::size_t, UndistortionMapDomain>;
+  using Entries = std::list<std::pair<Key, std::shared_ptr<const UndistortionMap>>>;
+
+  std::size_t _maxMemorySize;
+  bool _halfPrecision;
+  std::size_t _memorySize = 0;
+  /// cached maps, most recently used first
+  Entries _entries;
+  std::map<Key, Entries::iterator> _index;
+  mutable std::mutex _mutex;
+};
+
+} // namespace camera
+} // namespace aliceVision
@@ -14,6 +14,7 @@
 #include <aliceVision/camera/cameraCommon.hpp>
 #include <aliceVision/camera/IntrinsicBase.hpp>
 #include <aliceVision/camera/Pinhole.hpp>
+#include <aliceVision/camera/UndistortionMap.hpp>
 #include <aliceVision/image/io.hpp>
 
 #include <memory>
@@ -80,6 +81,54 @@ void UndistortImage(
   }
 }
 
+/// Undistort an image with a precomputed undistortion map
+template <typename T>
+void UndistortImage(
+  const image::Image<T>& imageIn,
+  const camera::UndistortionMap& undistortionMap,
+  image::Image<T>& image_ud,
+  T fillcolor)
+{
+  image_ud.resize(undistortionMap.width(), undistortionMap.height(), true, fillcolor);
+  const image::Sampler2d<image::SamplerLinear> sampler;
+
+  #pragma omp parallel for
+  for(int j = 0; j < undistortionMap.height(); ++j)
+      for(int i = 0; i < undistortionMap.width(); ++i)
+      {
+          const Vec2 disto_pix = undistortionMap.getDistortedPixel(i, j);
+
+          // pick pixel if it is in the image domain
+          if(imageIn.Contains(disto_pix(1), disto_pix(0)))
+              image_ud(j, i) = sampler(imageIn, disto_pix(1), disto_pix(0));
+      }
+}
+
+/// Undistort an image according a given camera and its distortion model,
+/// the undistortion map is shared with the other images of the same camera through the cache
+template <typename T>
+void UndistortImage(
+  const image::Image<T>& imageIn,
+  const camera::IntrinsicBase* intrinsicPtr,
+  image::Image<T>& image_ud,
+  T fillcolor,
+  camera::UndistortionMapCache& undistortionMapCache,
+  bool correctPrincipalPoint = false,
+  const oiio::ROI & roi = oiio::ROI())
+{
+  if (!intrinsicPtr->hasDistortion()) // no distortion, perform a direct copy
+  {
+    image_ud = imageIn;
+    return;
+  }
+
+  camera::UndistortionMapDomain domain(imageIn.Width(), imageIn.Height(), correctPrincipalPoint);
+  if(roi.defined())
+    domain.setRegion(roi.xbegin, roi.ybegin, roi.width(), roi.height());
+
+  UndistortImage(imageIn, *undistortionMapCache.get(*intrinsicPtr, domain), image_ud, fillcolor);
+}
+
 } // namespace camera
 } // namespace aliceVision
 
@@ -51,3 +51,38 @@ BOOST_AUTO_TEST_CASE(distortion_distort_undistort)
         }
     }
 }
+
+BOOST_AUTO_TEST_CASE(distortion_batch)
+{
+    makeRandomOperationsReproducible();
+
+    std::array<std::unique_ptr<Distortion>, 6> distortionsModels;
+    distortionsModels[0].reset(new DistortionBrown(-0.25349, 0.11868, -0.00028, 0.00005, 0.0000001));
+    distortionsModels[1].reset(new DistortionFisheye(0.02, -0.03, 0.1, -0.2));
+    distortionsModels[2].reset(new DistortionFisheye1(0.02));
+    distortionsModels[3].reset(new DistortionRadialK1(0.02));
+    distortionsModels[4].reset(new DistortionRadialK3(-1.8061369278146561e-01, 1.8759742680633607e-01, -2.5341468279930644e-02));
+    distortionsModels[5].reset(new DistortionRadialK3PT(-1.8061369278146561e-01, 1.8759742680633607e-01, -2.5341468279930644e-02));
+
+    // random points in [-lim, lim]x[-lim, lim]
+    const double lim{0.8};
+    const Mat2X pts = lim * Mat2X::Random(2, 1000);
+
+    for(const auto& model : distortionsModels)
+    {
+        Mat2X distorted;
+        Mat2X undistorted;
+        model->addDistortionBatch(pts, distorted);
+        model->removeDistortionBatch(distorted, undistorted);
+
+        BOOST_CHECK_EQUAL(distorted.cols(), pts.cols());
+        BOOST_CHECK_EQUAL(undistorted.cols(), pts.cols());
+
+        // the batch functions give the same result as the point functions
+        for(Mat2X::Index i = 0; i < pts.cols(); ++i)
+        {
+            EXPECT_MATRIX_NEAR(model->addDistortion(pts.col(i)), distorted.col(i), 1e-12);
+            EXPECT_MATRIX_NEAR(model->removeDistortion(distorted.col(i)), undistorted.col(i), 1e-12);
+        }
+    }
+}
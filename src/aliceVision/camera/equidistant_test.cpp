@@ -64,5 +64,30 @@ BOOST_AUTO_TEST_CASE(cameraEquidistant_disto_undisto_Radial)
   }
 }
 
+BOOST_AUTO_TEST_CASE(cameraEquidistant_batch_Radial)
+{
+  makeRandomOperationsReproducible();
+
+  const EquiDistantRadialK3 cam(1000, 800, 800.0, 0.0, 0.0, 0.0, 0.3, 0.2, 0.1);
+  const geometry::Pose3 pose(geometry::randomPose());
+
+  // back-project random pixels at random depths
+  Mat3X pts3D(3, 100);
+  for(Mat3X::Index i = 0; i < pts3D.cols(); ++i)
+  {
+    const Vec2 ptImage = (Vec2::Random() * 800./2.) + Vec2(500,400) + Vec2::Random();
+    pts3D.col(i) = cam.backproject(ptImage, true, pose, 1.0 + std::abs(Vec2::Random()(0)) * 100.0);
+  }
+
+  Mat2X pts2D;
+  cam.projectBatch(pose, pts3D, pts2D, true);
 
+  Mat2X undistorted;
+  cam.get_ud_pixelBatch(pts2D, undistorted);
 
+  for(Mat3X::Index i = 0; i < pts3D.cols(); ++i)
+  {
+    EXPECT_MATRIX_NEAR(cam.project(pose, pts3D.col(i).homogeneous(), true), pts2D.col(i), 1e-8);
+    EXPECT_MATRIX_NEAR(cam.get_ud_pixel(pts2D.col(i)), undistorted.col(i), 1e-8);
+  }
+}
@@ -102,3 +102,54 @@ BOOST_AUTO_TEST_CASE(cameraPinholeRadial_disto_undisto_K3)
 
   }
 }
+
+//-----------------
+// Test summary:
+//-----------------
+// - Create a PinholeRadialK3 camera
+// - Project random points and undistort a pixel grid with the batch functions
+// - Assert that they match the point functions
+//-----------------
+BOOST_AUTO_TEST_CASE(cameraPinholeRadial_batch_K3)
+{
+  makeRandomOperationsReproducible();
+
+  const PinholeRadialK3 cam(1000, 1000, 1000, 1000, 0, 0,
+    // K1, K2, K3
+    -0.245539, 0.255195, 0.163773);
+
+  const geometry::Pose3 pose(geometry::randomPose());
+
+  // random points in front of the camera
+  Mat3X pts3D(3, 100);
+  for(Mat3X::Index i = 0; i < pts3D.cols(); ++i)
+    pts3D.col(i) = pose.inverse()(Vec3(Vec2::Random()(0), Vec2::Random()(1), 2.0 + std::abs(Vec2::Random()(0))));
+
+  const IntrinsicBase& intrinsic = cam;
+  for(const bool applyDistortion : {true, false})
+  {
+    Mat2X pts2D;
+    intrinsic.projectBatch(pose, pts3D, pts2D, applyDistortion);
+    BOOST_CHECK_EQUAL(pts2D.cols(), pts3D.cols());
+
+    for(Mat3X::Index i = 0; i < pts3D.cols(); ++i)
+      EXPECT_MATRIX_NEAR(cam.project(pose, pts3D.col(i).homogeneous(), applyDistortion), pts2D.col(i), 1e-8);
+  }
+
+  // pixel grid
+  Mat2X pixels(2, 11 * 11);
+  for(int y = 0; y < 11; ++y)
+    for(int x = 0; x < 11; ++x)
+      pixels.col(y * 11 + x) = Vec2(x * 100.0, y * 100.0);
+
+  Mat2X undistorted;
+  Mat2X distorted;
+  intrinsic.get_ud_pixelBatch(pixels, undistorted);
+  intrinsic.get_d_pixelBatch(pixels, distorted);
+
+  for(Mat2X::Index i = 0; i < pixels.cols(); ++i)
+  {
+    EXPECT_MATRIX_NEAR(cam.get_ud_pixel(pixels.col(i)), undistorted.col(i), 1e-8);
+    EXPECT_MATRIX_NEAR(cam.get_d_pixel(pixels.col(i)), distorted.col(i), 1e-8);
+  }
+}
@@ -0,0 +1,97 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/camera/PinholeRadial.hpp>
+#include <aliceVision/camera/UndistortionMap.hpp>
+
+#define BOOST_TEST_MODULE undistortionMap
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/floating_point_comparison.hpp>
+#include <aliceVision/unitTest.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::camera;
+
+//-----------------
+// Test summary:
+//-----------------
+// - Create a PinholeRadialK3 camera
+// - Compute its undistortion map in float and half precision, on the full image and on a region
+// - Assert that the map gives the same distorted pixels as the camera
+//-----------------
+BOOST_AUTO_TEST_CASE(undistortionMap_PinholeRadialK3)
+{
+  const int w = 1000;
+  const int h = 800;
+  const PinholeRadialK3 cam(w, h, 1000, 1000, 10, -15, -0.245539, 0.255195, 0.163773);
+
+  UndistortionMapDomain region(w, h);
+  region.setRegion(-50, 20, 200, 100);
+
+  for(const UndistortionMapDomain& domain : {UndistortionMapDomain(w, h), UndistortionMapDomain(w, h, true), region})
+  {
+    Vec2 ppCorrection(0.0, 0.0);
+    if(domain.correctPrincipalPoint)
+      ppCorrection = cam.getPrincipalPoint() - Vec2(w * 0.5, h * 0.5);
+
+    const UndistortionMap map(cam, domain);
+    const UndistortionMap mapHalf(cam, domain, true);
+
+    BOOST_CHECK_EQUAL(map.width(), domain.width);
+    BOOST_CHECK_EQUAL(map.height(), domain.height);
+    BOOST_CHECK_EQUAL(map.memorySize() / sizeof(float), mapHalf.memorySize() / sizeof(half));
+
+    for(int j = 0; j < domain.height; j += 7)
+    {
+      for(int i = 0; i < domain.width; i += 7)
+      {
+        const Vec2 distorted = cam.get_d_pixel(Vec2(i + domain.xOffset, j + domain.yOffset) + ppCorrection);
+        EXPECT_MATRIX_NEAR(distorted, map.getDistortedPixel(i, j), 1e-3);
+        // half precision keeps 11 significant bits of the displacement
+        const double tolerance = std::max(1e-3, (distorted - Vec2(i + domain.xOffset, j + domain.yOffset)).norm() / 1024.0);
+        EXPECT_MATRIX_NEAR(distorted, mapHalf.getDistortedPixel(i, j), tolerance);
+      }
+    }
+  }
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Get the undistortion maps of several cameras from a cache
+// - Assert that the maps are shared and that the least recently used maps are released
+//-----------------
+BOOST_AUTO_TEST_CASE(undistortionMap_cache)
+{
+  const int w = 100;
+  const int h = 80;
+  const PinholeRadialK1 camA(w, h, 100, 100, 0, 0, 0.1);
+  const PinholeRadialK1 camB(w, h, 100, 100, 0, 0, 0.2);
+  const PinholeRadialK1 camC(w, h, 100, 100, 0, 0, 0.3);
+  const UndistortionMapDomain domain(w, h);
+
+  const std::size_t mapSize = UndistortionMap(camA, domain).memorySize();
+  UndistortionMapCache cache(2 * mapSize);
+
+  const auto mapA = cache.get(camA, domain);
+  BOOST_CHECK(mapA == cache.get(camA, domain));
+  BOOST_CHECK(mapA != cache.get(camA, UndistortionMapDomain(w, h, true)));
+  BOOST_CHECK_EQUAL(cache.size(), 2);
+
+  // camA is the most recently used
+  cache.get(camA, domain);
+  const auto mapB = cache.get(camB, domain);
+  BOOST_CHECK_EQUAL(cache.size(), 2);
+  BOOST_CHECK(mapA == cache.get(camA, domain));
+  BOOST_CHECK(mapB == cache.get(camB, domain));
+
+  cache.get(camC, domain);
+  BOOST_CHECK_EQUAL(cache.size(), 2);
+  BOOST_CHECK_EQUAL(cache.memorySize(), 2 * mapSize);
+  BOOST_CHECK(mapB == cache.get(camB, domain));
+  BOOST_CHECK(mapA != cache.get(camA, domain));
+}
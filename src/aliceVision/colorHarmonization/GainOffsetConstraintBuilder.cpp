@@ -7,9 +7,63 @@
 
 #include "GainOffsetConstraintBuilder.hpp"
 
+#include <Eigen/SparseCholesky>
+
 namespace aliceVision {
 namespace lInfinity {
 
+/**
+ * @brief Compute the positions of the quantiles (5%, 15%, ..., 95%) of the two histograms of an edge.
+ */
+static void computeQuantilesPositions(const relativeColorHistogramEdge & edge,
+    std::vector<double> & vec_pourcentilePositionI,
+    std::vector<double> & vec_pourcentilePositionJ)
+{
+  const size_t nbQuantile = 10;
+  const double incrementPourcentile = 1./(double) nbQuantile;
+
+  //-- compute the two cumulated and normalized histogram
+
+  const std::vector< size_t > & vec_histoI = edge.histoI;
+  const std::vector< size_t > & vec_histoJ = edge.histoJ;
+
+  const size_t nBuckets = vec_histoI.size();
+
+  // Normalize histogram
+  std::vector<double> ndf_I(nBuckets), ndf_J(nBuckets);
+  histogram::normalizeHisto(vec_histoI, ndf_I);
+  histogram::normalizeHisto(vec_histoJ, ndf_J);
+
+  // Compute cumulative distribution functions (cdf)
+  std::vector<double> cdf_I(nBuckets), cdf_J(nBuckets);
+  histogram::cdf(ndf_I, cdf_I);
+  histogram::cdf(ndf_J, cdf_J);
+
+  double currentPourcentile = 5./100.;
+
+  //-- Compute pourcentile and their positions
+  vec_pourcentilePositionI.clear();
+  vec_pourcentilePositionJ.clear();
+  vec_pourcentilePositionI.reserve(nbQuantile);
+  vec_pourcentilePositionJ.reserve(nbQuantile);
+
+  std::vector<double>::const_iterator cdf_I_IterBegin = cdf_I.begin();
+  std::vector<double>::const_iterator cdf_J_IterBegin = cdf_J.begin();
+  while( currentPourcentile < 1.0)
+  {
+    std::vector<double>::const_iterator iterFI = std::lower_bound(cdf_I.begin(), cdf_I.end(), currentPourcentile);
+    const size_t positionI = std::distance(cdf_I_IterBegin, iterFI);
+
+    std::vector<double>::const_iterator iterFJ = std::lower_bound(cdf_J.begin(), cdf_J.end(), currentPourcentile);
+    const size_t positionJ = std::distance(cdf_J_IterBegin, iterFJ);
+
+    vec_pourcentilePositionI.push_back(positionI);
+    vec_pourcentilePositionJ.push_back(positionJ);
+
+    currentPourcentile += incrementPourcentile;
+  }
+}
+
 void Encode_histo_relation(
     const size_t nImage,
     const std::vector<relativeColorHistogramEdge > & vec_relativeHistograms,
@@ -66,7 +120,6 @@ void Encode_histo_relation(
   //--
 
   size_t rowPos = 0;
-  double incrementPourcentile = 1./(double) nbQuantile;
 
   for (size_t i = 0; i < Nrelative; ++i)
   {
@@ -75,45 +128,8 @@ void Encode_histo_relation(
 
     const relativeColorHistogramEdge & edge = *iter;
 
-    //-- compute the two cumulated and normalized histogram
-
-    const std::vector< size_t > & vec_histoI = edge.histoI;
-    const std::vector< size_t > & vec_histoJ = edge.histoJ;
-
-    const size_t nBuckets = vec_histoI.size();
-
-    // Normalize histogram
-    std::vector<double> ndf_I(nBuckets), ndf_J(nBuckets);
-    histogram::normalizeHisto(vec_histoI, ndf_I);
-    histogram::normalizeHisto(vec_histoJ, ndf_J);
-
-    // Compute cumulative distribution functions (cdf)
-    std::vector<double> cdf_I(nBuckets), cdf_J(nBuckets);
-    histogram::cdf(ndf_I, cdf_I);
-    histogram::cdf(ndf_J, cdf_J);
-
-    double currentPourcentile = 5./100.;
-
-    //-- Compute pourcentile and their positions
     std::vector<double> vec_pourcentilePositionI, vec_pourcentilePositionJ;
-    vec_pourcentilePositionI.reserve(1.0/incrementPourcentile);
-    vec_pourcentilePositionJ.reserve(1.0/incrementPourcentile);
-
-    std::vector<double>::const_iterator cdf_I_IterBegin = cdf_I.begin();
-    std::vector<double>::const_iterator cdf_J_IterBegin = cdf_J.begin();
-    while( currentPourcentile < 1.0)
-    {
-      std::vector<double>::const_iterator iterFI = std::lower_bound(cdf_I.begin(), cdf_I.end(), currentPourcentile);
-      const size_t positionI = std::distance(cdf_I_IterBegin, iterFI);
-
-      std::vector<double>::const_iterator iterFJ = std::lower_bound(cdf_J.begin(), cdf_J.end(), currentPourcentile);
-      const size_t positionJ = std::distance(cdf_J_IterBegin, iterFJ);
-
-      vec_pourcentilePositionI.push_back(positionI);
-      vec_pourcentilePositionJ.push_back(positionJ);
-
-      currentPourcentile += incrementPourcentile;
-    }
+    computeQuantilesPositions(edge, vec_pourcentilePositionI, vec_pourcentilePositionJ);
 
     //-- Add the constraints:
     // pos * ga + offa - pos * gb - offb <= gamma
@@ -153,5 +169,107 @@ void Encode_histo_relation(
 #undef GAMMAVAR
 }
 
+bool solveGainOffsetLeastSquares(
+    const size_t nImage,
+    const std::vector<relativeColorHistogramEdge > & vec_relativeHistograms,
+    const std::vector<size_t> & vec_indexToFix,
+    std::vector<double> & vec_solution)
+{
+  const size_t NVar = 2 * nImage;
+
+  // the fixed images have a gain of 1 and an offset of 0, the other variables are the unknowns
+  std::vector<double> vec_values(NVar, 0.0);
+  std::vector<int> vec_unknownIndex(NVar, 0);
+  for (const size_t index : vec_indexToFix)
+  {
+    vec_values[2 * index] = 1.0;
+    vec_unknownIndex[2 * index] = -1;
+    vec_unknownIndex[2 * index + 1] = -1;
+  }
+  int nbUnknowns = 0;
+  for (int& unknownIndex : vec_unknownIndex)
+  {
+    if (unknownIndex == 0)
+      unknownIndex = nbUnknowns++;
+  }
+
+  // one row per quantile and edge: posI * gI + oI - posJ * gJ - oJ = 0
+  std::vector<std::vector<double>> vec_positionsI(vec_relativeHistograms.size());
+  std::vector<std::vector<double>> vec_positionsJ(vec_relativeHistograms.size());
+
+  #pragma omp parallel for
+  for (int i = 0; i < vec_relativeHistograms.size(); ++i)
+    computeQuantilesPositions(vec_relativeHistograms[i], vec_positionsI[i], vec_positionsJ[i]);
+
+  size_t nbRows = 0;
+  for (const std::vector<double>& positions : vec_positionsI)
+    nbRows += positions.size();
+
+  std::vector<Eigen::Triplet<double>> triplets;
+  triplets.reserve(nbRows * 4);
+  Vec b = Vec::Zero(nbRows);
+
+  size_t rowPos = 0;
+  for (size_t i = 0; i < vec_relativeHistograms.size(); ++i)
+  {
+    const relativeColorHistogramEdge & edge = vec_relativeHistograms[i];
+    for (size_t k = 0; k < vec_positionsI[i].size(); ++k, ++rowPos)
+    {
+      const std::pair<size_t, double> coefficients[4] = {
+        {2 * edge.I, vec_positionsI[i][k]}, {2 * edge.I + 1, 1.0},
+        {2 * edge.J, -vec_positionsJ[i][k]}, {2 * edge.J + 1, -1.0}};
+
+      for (const auto& coefficient : coefficients)
+      {
+        const int unknownIndex = vec_unknownIndex[coefficient.first];
+        if (unknownIndex < 0)
+          b(rowPos) -= coefficient.second * vec_values[coefficient.first];
+        else
+          triplets.emplace_back(rowPos, unknownIndex, coefficient.second);
+      }
+    }
+  }
+
+  sMat A(nbRows, nbUnknowns);
+  A.setFromTriplets(triplets.begin(), triplets.end());
+
+  if (nbUnknowns > 0)
+  {
+    const sMat AtA = A.transpose() * A;
+    const Vec Atb = A.transpose() * b;
+
+    Eigen::SimplicialLDLT<sMat> solver(AtA);
+    if (solver.info() != Eigen::Success)
+      return false;
+
+    const Vec x = solver.solve(Atb);
+    if (solver.info() != Eigen::Success || !x.allFinite())
+      return false;
+
+    for (size_t v = 0; v < NVar; ++v)
+    {
+      if (vec_unknownIndex[v] >= 0)
+        vec_values[v] = x(vec_unknownIndex[v]);
+    }
+  }
+
+  // the last value is the maximal residual, like the gamma variable of the linear program
+  double maxResidual = 0.0;
+  for (size_t i = 0; i < vec_relativeHistograms.size(); ++i)
+  {
+    const relativeColorHistogramEdge & edge = vec_relativeHistograms[i];
+    for (size_t k = 0; k < vec_positionsI[i].size(); ++k)
+    {
+      const double residual = vec_positionsI[i][k] * vec_values[2 * edge.I] + vec_values[2 * edge.I + 1]
+                            - vec_positionsJ[i][k] * vec_values[2 * edge.J] - vec_values[2 * edge.J + 1];
+      maxResidual = std::max(maxResidual, std::abs(residual));
+    }
+  }
+
+  vec_solution = vec_values;
+  vec_solution.push_back(maxResidual);
+  return true;
+}
+
 }; // namespace lInfinity
 }; // namespace aliceVision
@@ -68,6 +68,22 @@ void Encode_histo_relation(const std::size_t nImage,
     std::vector<double> & vec_costs,
     std::vector< std::pair<double,double> > & vec_bounds);
 
+/**
+ * @brief Sparse least squares alternative to the L-infinity linear program of Encode_histo_relation.
+ *        It minimizes the sum of the squared differences of the same quantiles positions,
+ *        with a sparse Cholesky solve of the normal equations, so it scales to thousands of images.
+ * @param[in] nImage The number of images
+ * @param[in] vec_relativeHistograms The histograms of the image pairs
+ * @param[in] vec_indexToFix The images with a gain of 1 and an offset of 0
+ * @param[out] vec_solution {gain, offset} per image, then the maximal absolute residual (gray levels),
+ *             the same layout as the linear program solution
+ * @return false if the system cannot be solved, e.g. an image is not connected to a fixed image
+ */
+bool solveGainOffsetLeastSquares(const std::size_t nImage,
+    const std::vector<relativeColorHistogramEdge > & vec_relativeHistograms,
+    const std::vector<std::size_t> & vec_indexToFix,
+    std::vector<double> & vec_solution);
+
 struct GainOffsetConstraintBuilder
 {
   GainOffsetConstraintBuilder(
@@ -174,6 +174,23 @@ BOOST_AUTO_TEST_CASE(ColorHarmonisation_Offset_gain) {
   BOOST_CHECK_SMALL(0.-o2, 1e-2);
   BOOST_CHECK(gamma < 1.0); // Alignment must be below one gray level
 
+  //-- The sparse least squares solve finds the same gains and offsets
+  std::vector<double> vec_solutionLeastSquares;
+  BOOST_REQUIRE(solveGainOffsetLeastSquares(3, vec_relativeHistograms, vec_indexToFix, vec_solutionLeastSquares));
+  BOOST_REQUIRE_EQUAL(vec_solutionLeastSquares.size(), vec_solution.size());
+
+  BOOST_CHECK_SMALL(1.-vec_solutionLeastSquares[0], 1e-2);
+  BOOST_CHECK_SMALL(0.-vec_solutionLeastSquares[1], 1e-2);
+  BOOST_CHECK_SMALL((1./GAIN)-vec_solutionLeastSquares[2], 1e-1);
+  BOOST_CHECK_SMALL((127-OFFSET/GAIN)-vec_solutionLeastSquares[3], 2.); // +/- quantization error (2 gray levels)
+  // the squared residuals are spread over all the images
+  BOOST_CHECK_SMALL(1.-vec_solutionLeastSquares[4], 1e-2);
+  BOOST_CHECK_SMALL(0.-vec_solutionLeastSquares[5], 1.);
+  BOOST_CHECK(vec_solutionLeastSquares[6] < 2.0);
+
+  //-- An image without any histogram relation cannot be solved
+  BOOST_CHECK(!solveGainOffsetLeastSquares(4, vec_relativeHistograms, vec_indexToFix, vec_solutionLeastSquares));
+
   //-- Visual HTML export
   using namespace htmlDocument;
   htmlDocument::htmlDocumentStream _htmlDocStream ("Global Multiple-View Color Consistency.");
@@ -0,0 +1,133 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "AsyncFeedProvider.hpp"
+
+#include <algorithm>
+
+namespace aliceVision{
+namespace dataio{
+
+AsyncFeedProvider::AsyncFeedProvider(const std::string &feedPath, const std::string &calibPath, std::size_t bufferSize)
+: _feed(feedPath, calibPath), _bufferSize(std::max(bufferSize, std::size_t(1)))
+{
+  if(_feed.isInit())
+    _thread = std::thread(&AsyncFeedProvider::decode, this);
+}
+
+AsyncFeedProvider::~AsyncFeedProvider()
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _frameRead.notify_all();
+
+  if(_thread.joinable())
+    _thread.join();
+}
+
+void AsyncFeedProvider::decode()
+{
+  try
+  {
+    while(true)
+    {
+      Frame frame;
+      const bool hasFrame = _feed.readImage(frame.imageGray, frame.camIntrinsics, frame.mediaPath, frame.hasIntrinsics);
+
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if(!hasFrame)
+        {
+          _isFeedEnd = true;
+          break;
+        }
+
+        if(_feed.isLiveFeed())
+        {
+          // do not slow down the camera, drop the oldest frame
+          if(_frames.size() == _bufferSize)
+          {
+            _frames.pop_front();
+            ++_nbDroppedFrames;
+          }
+        }
+        else
+        {
+          _frameRead.wait(lock, [this]() { return _frames.size() < _bufferSize || _stop; });
+        }
+
+        if(_stop)
+          return;
+
+        _frames.push_back(std::move(frame));
+      }
+      _frameDecoded.notify_one();
+
+      _feed.goToNextFrame();
+    }
+  }
+  catch(...)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _error = std::current_exception();
+    _isFeedEnd = true;
+  }
+  _frameDecoded.notify_one();
+}
+
+bool AsyncFeedProvider::fetchFrame()
+{
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _frameDecoded.wait(lock, [this]() { return !_frames.empty() || _isFeedEnd; });
+
+    if(_frames.empty())
+    {
+      // the errors of the decoding are raised after the frames decoded before them
+      if(_error)
+        std::rethrow_exception(_error);
+      return false;
+    }
+
+    _currentFrame = std::move(_frames.front());
+    _frames.pop_front();
+    _hasCurrentFrame = true;
+  }
+  _frameRead.notify_one();
+  return true;
+}
+
+bool AsyncFeedProvider::readImage(image::Image<float> &imageGray,
+        camera::PinholeRadialK3 &camIntrinsics,
+        std::string &mediaPath,
+        bool &hasIntrinsics)
+{
+  if(!_hasCurrentFrame && !fetchFrame())
+    return false;
+
+  imageGray = _currentFrame.imageGray;
+  camIntrinsics = _currentFrame.camIntrinsics;
+  mediaPath = _currentFrame.mediaPath;
+  hasIntrinsics = _currentFrame.hasIntrinsics;
+  return true;
+}
+
+bool AsyncFeedProvider::goToNextFrame()
+{
+  _hasCurrentFrame = false;
+  return fetchFrame();
+}
+
+std::size_t AsyncFeedProvider::getNbDroppedFrames() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _nbDroppedFrames;
+}
+
+}//namespace dataio
+}//namespace aliceVision
@@ -0,0 +1,137 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include "FeedProvider.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace aliceVision{
+namespace dataio{
+
+/**
+ * @brief A feed provider that decodes the grayscale frames ahead in a thread,
+ * so the frames are decoded while the previous ones are processed.
+ *
+ * The decoded frames are stored in a buffer of fixed size. For a video file or
+ * an image sequence, the decoding waits while the buffer is full. For a live feed,
+ * the oldest frame of the buffer is dropped (FIFO strategy), so the processing
+ * always gets recent frames.
+ */
+class AsyncFeedProvider
+{
+public:
+
+  /**
+   * @param[in] feedPath The feed path, as FeedProvider.
+   * @param[in] calibPath The calibration file path, as FeedProvider.
+   * @param[in] bufferSize The maximum number of decoded frames waiting to be read.
+   */
+  AsyncFeedProvider(const std::string &feedPath, const std::string &calibPath = "", std::size_t bufferSize = 4);
+
+  AsyncFeedProvider(const AsyncFeedProvider&) = delete;
+  AsyncFeedProvider& operator=(const AsyncFeedProvider&) = delete;
+
+  ~AsyncFeedProvider();
+
+  /**
+   * @brief Provide the current float grayscale image from the feed, it waits
+   * until the frame is decoded.
+   *
+   * @param[out] imageGray The image from the feed.
+   * @param[out] camIntrinsics The associated camera intrinsics.
+   * @param[out] mediaPath The original media path, for a video is the path to the
+   * file, for an image sequence is the path to the single image.
+   * @param[out] hasIntrinsics True if \p camIntrinsics is valid, otherwise there
+   * is no intrinsics associated to \p imageGray.
+   * @return True if there is a new image, false otherwise.
+   */
+  bool readImage(image::Image<float> &imageGray,
+        camera::PinholeRadialK3 &camIntrinsics,
+        std::string &mediaPath,
+        bool &hasIntrinsics);
+
+  /**
+   * @brief It acquires the next decoded frame, it waits until the frame is decoded.
+   * @return true if successful.
+   */
+  bool goToNextFrame();
+
+  /**
+   * @brief It returns the number of frames contained of the video. It return infinity
+   * if the feed is a live stream.
+   * @return the number of frames of the video or infinity if it is a live stream.
+   */
+  std::size_t nbFrames() const { return _feed.nbFrames(); }
+
+  /**
+   * @brief Return true if the feed is correctly initialized.
+   *
+   * @return True if the feed is correctly initialized.
+   */
+  bool isInit() const { return _feed.isInit(); }
+
+  /**
+   * @brief Return true if the feed is a video.
+   *
+   * @return True if the feed is a video.
+   */
+  bool isVideo() const { return _feed.isVideo(); }
+
+  /**
+   * @brief Return true if the feed is a live stream (e.g. a  webcam).
+   *
+   * @return True if the feed is a live stream.
+   */
+  bool isLiveFeed() const { return _feed.isLiveFeed(); }
+
+  /**
+   * @brief Return the number of frames of a live feed dropped because the buffer was full.
+   */
+  std::size_t getNbDroppedFrames() const;
+
+private:
+
+  struct Frame
+  {
+    image::Image<float> imageGray;
+    camera::PinholeRadialK3 camIntrinsics;
+    std::string mediaPath;
+    bool hasIntrinsics = false;
+  };
+
+  /// The decoding thread loop
+  void decode();
+
+  /// Wait for the next decoded frame and make it the current frame
+  bool fetchFrame();
+
+  FeedProvider _feed;
+  const std::size_t _bufferSize;
+
+  std::deque<Frame> _frames;
+  Frame _currentFrame;
+  bool _hasCurrentFrame = false;
+
+  mutable std::mutex _mutex;
+  std::condition_variable _frameDecoded;
+  std::condition_variable _frameRead;
+  bool _isFeedEnd = false;
+  bool _stop = false;
+  std::exception_ptr _error;
+  std::size_t _nbDroppedFrames = 0;
+
+  std::thread _thread;
+};
+
+}//namespace dataio
+}//namespace aliceVision
@@ -0,0 +1,120 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/dataio/AsyncFeedProvider.hpp>
+#include <aliceVision/image/io.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+#include <string>
+
+#define BOOST_TEST_MODULE AsyncFeedProvider
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+/// write an image sequence, the value of the pixels is the frame index
+fs::path writeImageSequence(int nbImages)
+{
+    const fs::path folder = fs::temp_directory_path() / fs::unique_path();
+    fs::create_directories(folder);
+
+    for(int i = 0; i < nbImages; ++i)
+    {
+        const image::Image<float> image(4, 3, true, float(i));
+        image::writeImage((folder / (std::to_string(i) + ".exr")).string(), image,
+                          image::ImageWriteOptions().toColorSpace(image::EImageColorSpace::NO_CONVERSION));
+    }
+    return folder;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(AsyncFeedProvider_imageSequence)
+{
+    const int nbImages = 8;
+    const fs::path folder = writeImageSequence(nbImages);
+
+    for(std::size_t bufferSize : {1, 3, 16})
+    {
+        dataio::AsyncFeedProvider feed(folder.string(), "", bufferSize);
+        BOOST_REQUIRE(feed.isInit());
+        BOOST_CHECK(!feed.isLiveFeed());
+        BOOST_CHECK_EQUAL(feed.nbFrames(), std::size_t(nbImages));
+
+        image::Image<float> imageGray;
+        camera::PinholeRadialK3 camIntrinsics;
+        std::string mediaPath;
+        bool hasIntrinsics = true;
+
+        // the decoding waits while the buffer is full: no frame is lost and the order is kept
+        for(int i = 0; i < nbImages; ++i)
+        {
+            BOOST_REQUIRE(feed.readImage(imageGray, camIntrinsics, mediaPath, hasIntrinsics));
+            BOOST_CHECK_EQUAL(imageGray.Width(), 4);
+            BOOST_CHECK_EQUAL(imageGray.Height(), 3);
+            BOOST_CHECK_EQUAL(imageGray(1, 2), float(i));
+            BOOST_CHECK_EQUAL(fs::path(mediaPath).filename().string(), std::to_string(i) + ".exr");
+            BOOST_CHECK(!hasIntrinsics);
+
+            // reading again gives the current frame
+            BOOST_REQUIRE(feed.readImage(imageGray, camIntrinsics, mediaPath, hasIntrinsics));
+            BOOST_CHECK_EQUAL(imageGray(1, 2), float(i));
+
+            BOOST_CHECK_EQUAL(feed.goToNextFrame(), i + 1 < nbImages);
+        }
+
+        BOOST_CHECK(!feed.readImage(imageGray, camIntrinsics, mediaPath, hasIntrinsics));
+        BOOST_CHECK(!feed.goToNextFrame());
+        BOOST_CHECK_EQUAL(feed.getNbDroppedFrames(), std::size_t(0));
+    }
+
+    // the provider is destroyed while the decoding waits on a full buffer
+    {
+        dataio::AsyncFeedProvider feed(folder.string(), "", 1);
+        image::Image<float> imageGray;
+        camera::PinholeRadialK3 camIntrinsics;
+        std::string mediaPath;
+        bool hasIntrinsics;
+        BOOST_CHECK(feed.readImage(imageGray, camIntrinsics, mediaPath, hasIntrinsics));
+    }
+
+    fs::remove_all(folder);
+}
+
+BOOST_AUTO_TEST_CASE(AsyncFeedProvider_decodingError)
+{
+    const int nbImages = 3;
+    const fs::path folder = writeImageSequence(nbImages);
+
+    // the last image of the sequence can not be decoded
+    std::ofstream((folder / (std::to_string(nbImages) + ".exr")).string()) << "not an image";
+
+    dataio::AsyncFeedProvider feed(folder.string(), "", 2);
+
+    image::Image<float> imageGray;
+    camera::PinholeRadialK3 camIntrinsics;
+    std::string mediaPath;
+    bool hasIntrinsics;
+
+    // the frames decoded before the error are provided first
+    for(int i = 0; i < nbImages; ++i)
+    {
+        BOOST_REQUIRE(feed.readImage(imageGray, camIntrinsics, mediaPath, hasIntrinsics));
+        BOOST_CHECK_EQUAL(imageGray(0, 0), float(i));
+        if(i + 1 < nbImages)
+            BOOST_CHECK(feed.goToNextFrame());
+    }
+    BOOST_CHECK_THROW(feed.goToNextFrame(), std::exception);
+
+    fs::remove_all(folder);
+}
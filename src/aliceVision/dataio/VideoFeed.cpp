@@ -67,7 +67,12 @@ VideoFeed::FeederImpl::FeederImpl(const std::string &videoPath, const std::strin
 : _isInit(false), _isLive(false), _withIntrinsics(false), _videoPath(videoPath)
 {
     // load the video
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && (CV_VERSION_MINOR > 5 || (CV_VERSION_MINOR == 5 && CV_VERSION_REVISION >= 2)))
+  // use the hardware decoding when it is available, the backend falls back to the software decoding otherwise
+  _videoCapture.open(videoPath, cv::CAP_ANY, {cv::CAP_PROP_HW_ACCELERATION, cv::VIDEO_ACCELERATION_ANY});
+#else
   _videoCapture.open(videoPath);
+#endif
   if (!_videoCapture.isOpened())
   {
     ALICEVISION_LOG_WARNING("Unable to open the video : " << videoPath);
@@ -121,8 +126,6 @@ bool VideoFeed::FeederImpl::readImage(image::Image<image::RGBColor> &imageRGB,
   if(frame.channels() == 3)
   {
     cv::Mat color;
-    resize(frame, color, cv::Size(frame.cols, frame.rows));
-
     cv::cvtColor(frame, color, cv::COLOR_BGR2RGB);
     imageRGB.resize(color.cols, color.rows);
 
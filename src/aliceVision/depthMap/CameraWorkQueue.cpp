@@ -0,0 +1,157 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "CameraWorkQueue.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/exceptions.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <numeric>
+
+namespace fs = boost::filesystem;
+
+namespace aliceVision {
+namespace depthMap {
+
+CameraWorkQueue::CameraWorkQueue(const std::vector<int>& cams, const std::vector<double>& costs, const std::string& queueFolder)
+    : _queueFolder(queueFolder)
+{
+    assert(cams.size() == costs.size());
+
+    // sort by decreasing cost, the order is the same for all the processes
+    std::vector<std::size_t> order(cams.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return costs.at(a) > costs.at(b); });
+
+    _cams.reserve(cams.size());
+    for(const std::size_t i : order)
+        _cams.push_back(cams.at(i));
+
+    if(!_queueFolder.empty() && !fs::exists(_queueFolder))
+        fs::create_directories(_queueFolder);
+}
+
+bool CameraWorkQueue::pull(std::size_t maxNbCams, std::vector<int>& cams)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    cams.clear();
+
+    while(_next < _cams.size() && cams.size() < maxNbCams)
+    {
+        const int rc = _cams.at(_next++);
+
+        if(claim(rc))
+            cams.push_back(rc);
+    }
+
+    // at the end of the queue, the cameras of the processes which stopped are claimed again
+    if(cams.empty() && !_skipped.empty())
+    {
+        const std::vector<int> skipped = std::move(_skipped);
+        _skipped.clear();
+        for(const int rc : skipped)
+        {
+            if(cams.size() >= maxNbCams)
+            {
+                _skipped.push_back(rc);
+            }
+            else if(claim(rc))
+            {
+                ALICEVISION_LOG_INFO("R camera " << rc << " claimed again, the process which claimed it has stopped.");
+                cams.push_back(rc);
+            }
+        }
+    }
+
+    return !cams.empty();
+}
+
+void CameraWorkQueue::done(const std::vector<int>& cams)
+{
+    if(_queueFolder.empty())
+        return;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    for(const int rc : cams)
+    {
+        // the done file is written before the lock is released, so no other process can claim the camera again
+        std::ofstream doneFile(getDoneFilepath(rc));
+        if(!doneFile)
+            ALICEVISION_LOG_WARNING("Cannot create the work queue done file: " << getDoneFilepath(rc));
+        doneFile.close();
+
+        const auto claimIt = _claims.find(rc);
+        if(claimIt != _claims.end())
+        {
+            claimIt->second->unlock();
+            _claims.erase(claimIt);
+        }
+    }
+}
+
+bool CameraWorkQueue::claim(int rc)
+{
+    if(_queueFolder.empty())
+        return true;
+
+    if(fs::exists(getDoneFilepath(rc)))
+        return false;
+
+    // the lock file must not be opened again while this process holds its lock, closing it would release the lock
+    if(_claims.count(rc))
+        return false;
+
+    const std::string lockFilepath = getLockFilepath(rc);
+
+    try
+    {
+        // the file lock needs an existing file
+        std::ofstream(lockFilepath, std::ios::app);
+
+        // exclusive lock, released by the system if the process stops
+        std::unique_ptr<boost::interprocess::file_lock> fileLock(new boost::interprocess::file_lock(lockFilepath.c_str()));
+        if(!fileLock->try_lock())
+        {
+            ALICEVISION_LOG_TRACE("R camera " << rc << " is claimed by another process.");
+            _skipped.push_back(rc);
+            return false;
+        }
+
+        // computed by another process between the done file check and the lock
+        if(fs::exists(getDoneFilepath(rc)))
+        {
+            fileLock->unlock();
+            return false;
+        }
+
+        _claims[rc] = std::move(fileLock);
+    }
+    catch(const boost::interprocess::interprocess_exception& e)
+    {
+        ALICEVISION_THROW_ERROR("Cannot lock the work queue lock file: " << lockFilepath << " (" << e.what() << ")");
+    }
+    return true;
+}
+
+std::string CameraWorkQueue::getLockFilepath(int rc) const
+{
+    return (fs::path(_queueFolder) / ("rc_" + std::to_string(rc) + ".lock")).string();
+}
+
+std::string CameraWorkQueue::getDoneFilepath(int rc) const
+{
+    return (fs::path(_queueFolder) / ("rc_" + std::to_string(rc) + ".done")).string();
+}
+
+} // namespace depthMap
+} // namespace aliceVision
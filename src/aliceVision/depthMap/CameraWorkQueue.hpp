@@ -0,0 +1,78 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <boost/interprocess/sync/file_lock.hpp>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace depthMap {
+
+/**
+ * @brief Queue of R cameras from which the GPUs pull their work.
+ *
+ * Cameras are pulled by decreasing estimated cost, so the most expensive depth maps start first
+ * and the cheap ones fill the end of the computation.
+ *
+ * With a queue folder, a camera is claimed by an exclusive file lock on its lock file in the folder:
+ * several processes (on one or several nodes sharing the folder) can pull from the same cameras,
+ * each camera is computed by a single worker. A computed camera is marked by a done file.
+ * The lock of a process which stops before the end of its cameras is released by the system,
+ * so its cameras are claimed again by the processes still pulling from the queue.
+ * All the processes should use the same SfMData and camera list.
+ */
+class CameraWorkQueue
+{
+public:
+    /**
+     * @brief CameraWorkQueue constructor.
+     * @param[in] cams the R camera index list
+     * @param[in] costs the estimated cost of each R camera
+     * @param[in] queueFolder the folder of the lock files shared by the processes, empty for a process local queue
+     */
+    CameraWorkQueue(const std::vector<int>& cams, const std::vector<double>& costs, const std::string& queueFolder = "");
+
+    /**
+     * @brief Pull the next R cameras not claimed by another worker (thread-safe).
+     * @param[in] maxNbCams the maximum number of R cameras to pull
+     * @param[out] cams the pulled R camera index list
+     * @return false if there is no more R camera to compute
+     */
+    bool pull(std::size_t maxNbCams, std::vector<int>& cams);
+
+    /**
+     * @brief Mark pulled R cameras as computed and release their claims (thread-safe).
+     * @param[in] cams the computed R camera index list
+     */
+    void done(const std::vector<int>& cams);
+
+private:
+    /**
+     * @brief Claim a R camera for this process.
+     * @param[in] rc the R camera index
+     * @return false if the R camera is claimed by another process or already computed
+     */
+    bool claim(int rc);
+
+    std::string getLockFilepath(int rc) const;
+    std::string getDoneFilepath(int rc) const;
+
+    std::vector<int> _cams;     //< R camera index list, sorted by decreasing cost
+    std::size_t _next = 0;      //< next R camera to pull
+    std::vector<int> _skipped;  //< R cameras claimed by other processes, claimed again if these processes stop
+    std::string _queueFolder;   //< lock files folder
+    std::map<int, std::unique_ptr<boost::interprocess::file_lock>> _claims; //< locks held by this process
+    std::mutex _mutex;
+};
+
+} // namespace depthMap
+} // namespace aliceVision
@@ -0,0 +1,31 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+namespace aliceVision {
+namespace depthMap {
+
+/**
+ * @brief Depth Map Filtering Parameters
+ * @see fuseCut::Fuser::filterGroups / filterDepthMaps
+ */
+struct DepthMapFilterParams
+{
+  // user parameters
+
+  int minNumOfConsistentCams = 3;                   //< minimal number of consistent cameras to keep a pixel
+  int minNumOfConsistentCamsWithLowSimilarity = 4;  //< minimal number of consistent cameras to keep a weakly supported pixel
+  float pixToleranceFactor = 2.0f;                  //< depth tolerance, in pixel size
+  int pixSizeBall = 0;                              //< neighborhood radius (pixels)
+  int pixSizeBallWithLowSimilarity = 0;             //< neighborhood radius for the weakly supported pixels (pixels)
+  int nNearestCams = 10;                            //< number of neighbor cameras
+  int maxNbCachedDepthMaps = 20;                    //< maximum number of neighbor depth maps kept in device memory
+  bool computeNormalMaps = false;                   //< compute the normal maps from the filtered depth maps in device memory
+};
+
+} // namespace depthMap
+} // namespace aliceVision
@@ -10,6 +10,8 @@
 #include <aliceVision/depthMap/SgmParams.hpp>
 #include <aliceVision/depthMap/RefineParams.hpp>
 
+#include <string>
+
 namespace aliceVision {
 namespace depthMap {
 
@@ -27,6 +29,9 @@ struct DepthMapParams
   bool chooseTCamsPerTile = true;     //< choose T cameras per R tile or for the entire R image
   bool exportTilePattern = false;     //< export tile pattern obj
   bool autoAdjustSmallImage = true;   //< allow program to override parameters for the single tile case
+  std::string imageCacheFolder;       //< preprocessed images disk cache folder (empty means no disk cache)
+  double targetTimePerImage = 0.0;    //< auto-tuning target computation time per image in seconds (0 means disabled)
+  double maxDeviceMemoryPerImage = 0.0; //< auto-tuning device memory budget per image in MB, also limits the simultaneous tiles (0 means disabled)
 
   // constant parameters
 
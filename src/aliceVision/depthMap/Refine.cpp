@@ -8,6 +8,7 @@
 
 #include <aliceVision/alicevision_omp.hpp>
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Profiler.hpp>
 #include <aliceVision/mvsData/Point2d.hpp>
 #include <aliceVision/mvsData/Point3d.hpp>
 #include <aliceVision/mvsUtils/fileIO.hpp>
@@ -99,8 +100,33 @@ double Refine::getDeviceMemoryConsumptionUnpadded() const
     return (double(bytes) / (1024.0 * 1024.0));
 }
 
+double Refine::estimateDeviceMemoryConsumption(const mvsUtils::TileParams& tileParams, const RefineParams& refineParams)
+{
+    // same buffers as the constructor
+    const int downscale = refineParams.scale * refineParams.stepXY;
+    const int maxTileWidth  = divideRoundUp(tileParams.bufferWidth , downscale);
+    const int maxTileHeight = divideRoundUp(tileParams.bufferHeight, downscale);
+    const CudaSize<2> depthSimMapDim(maxTileWidth, maxTileHeight);
+    const CudaSize<3> volDim(maxTileWidth, maxTileHeight, refineParams.halfNbDepths * 2 + 1);
+
+    size_t bytes = 0;
+
+    bytes += 3 * estimateBytesPadded<float2>(depthSimMapDim);
+    bytes += estimateBytesPadded<TSimRefine>(volDim);
+
+    if(refineParams.useNormalMap)
+        bytes += estimateBytesPadded<float3>(depthSimMapDim);
+
+    if(refineParams.useColorOptimization)
+        bytes += 2 * estimateBytesPadded<float>(depthSimMapDim);
+
+    return (double(bytes) / (1024.0 * 1024.0));
+}
+
 void Refine::refineRc(const Tile& tile, const CudaDeviceMemoryPitched<float2, 2>& in_sgmDepthSimMap_dmp, const CudaDeviceMemoryPitched<float3, 2>& in_sgmNormalMap_dmp)
 {
+    ALICEVISION_PROFILE_ZONE("refine");
+
     const IndexT viewId = _mp.getViewId(tile.rc);
 
     ALICEVISION_LOG_INFO(tile << "Refine depth/sim map of view id: " << viewId << ", rc: " << tile.rc << " (" << (tile.rc + 1) << " / " << _mp.ncams << ").");
@@ -170,24 +196,21 @@ void Refine::refineAndFuseDepthSimMap(const Tile& tile)
     // get the depth range
     const Range depthRange(0, _volumeRefineSim_dmp.getSize().z());
 
-    // initialize the similarity volume at 0
-    // each tc filtered and inverted similarity value will be summed in this volume
-    cuda_volumeInitialize(_volumeRefineSim_dmp, TSimRefine(0.f), _stream);
-
     // get device cache instance
     DeviceCache& deviceCache = DeviceCache::getInstance();
 
     // get R device camera from cache
     const DeviceCamera& rcDeviceCamera = deviceCache.requestCamera(tile.rc, _refineParams.scale, _mp);
 
-    // compute for each RcTc each similarity value for each depth to refine
-    // sum the inverted / filtered similarity value, best value is the HIGHEST
+    // get T device cameras from cache
+    std::vector<const DeviceCamera*> tcDeviceCameras;
+    tcDeviceCameras.reserve(tile.refineTCams.size());
+
     for(std::size_t tci = 0; tci < tile.refineTCams.size(); ++tci)
     {
         const int tc = tile.refineTCams.at(tci);
-
-        // get T device camera from cache
         const DeviceCamera& tcDeviceCamera = deviceCache.requestCamera(tc, _refineParams.scale, _mp);
+        tcDeviceCameras.push_back(&tcDeviceCamera);
 
         ALICEVISION_LOG_DEBUG(tile << "Refine similarity volume:" << std::endl
                                    << "\t- rc: " << tile.rc << std::endl
@@ -196,18 +219,21 @@ void Refine::refineAndFuseDepthSimMap(const Tile& tile)
                                    << "\t- tc camera device id: " << tcDeviceCamera.getDeviceCamId() << std::endl
                                    << "\t- tile range x: [" << downscaledRoi.x.begin << " - " << downscaledRoi.x.end << "]" << std::endl
                                    << "\t- tile range y: [" << downscaledRoi.y.begin << " - " << downscaledRoi.y.end << "]" << std::endl);
-
-        cuda_volumeRefineSimilarity(_volumeRefineSim_dmp, 
-                                    _sgmDepthPixSizeMap_dmp,
-                                    (_refineParams.useNormalMap) ? &_normalMap_dmp : nullptr,
-                                    rcDeviceCamera, 
-                                    tcDeviceCamera,
-                                    _refineParams, 
-                                    depthRange,
-                                    downscaledRoi, 
-                                    _stream);
     }
 
+    // compute for each RcTc each similarity value for each depth to refine
+    // sum the inverted / filtered similarity value, best value is the HIGHEST
+    // all the T cameras are evaluated in the same kernel launch, no volume initialization needed
+    cuda_volumeRefineSimilarityMultiTc(_volumeRefineSim_dmp,
+                                       _sgmDepthPixSizeMap_dmp,
+                                       (_refineParams.useNormalMap) ? &_normalMap_dmp : nullptr,
+                                       rcDeviceCamera,
+                                       tcDeviceCameras,
+                                       _refineParams,
+                                       depthRange,
+                                       downscaledRoi,
+                                       _stream);
+
     // export intermediate volume information (if requested by user)
     exportVolumeInformation(tile, "afterRefine");
 
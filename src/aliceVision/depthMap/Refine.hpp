@@ -60,6 +60,14 @@ public:
      */
     double getDeviceMemoryConsumptionUnpadded() const;
 
+    /**
+     * @brief Estimate the device memory consumption of a Refine instance, without allocating its buffers.
+     * @param[in] tileParams the tile workflow parameters
+     * @param[in] refineParams the Refine parameters
+     * @return estimated device memory consumption (in MB)
+     */
+    static double estimateDeviceMemoryConsumption(const mvsUtils::TileParams& tileParams, const RefineParams& refineParams);
+
     /**
      * @brief Refine for a single R camera the Semi-Global Matching depth/sim map.
      * @param[in] tile The given tile for Refine computation
@@ -7,6 +7,7 @@
 #include "Sgm.hpp"
 
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Profiler.hpp>
 #include <aliceVision/mvsUtils/fileIO.hpp>
 #include <aliceVision/depthMap/depthMapUtils.hpp>
 #include <aliceVision/depthMap/volumeIO.hpp>
@@ -63,7 +64,22 @@ Sgm::Sgm(const mvsUtils::MultiViewParams& mp,
         const size_t maxTileSide = std::max(maxTileWidth, maxTileHeight);
         _volumeSliceAccA_dmp.allocate(CudaSize<2>(maxTileSide, _sgmParams.maxDepths));
         _volumeSliceAccB_dmp.allocate(CudaSize<2>(maxTileSide, _sgmParams.maxDepths));
-        _volumeAxisAcc_dmp.allocate(CudaSize<2>(maxTileSide, 1));
+        // the fused volume optimization uses 3 rows (previous, current and next slices)
+        _volumeAxisAcc_dmp.allocate(CudaSize<2>(maxTileSide, _sgmParams.useFusedVolumeOptimization ? 3 : 1));
+    }
+
+    // allocate coarse-to-fine depth pruning buffers
+    if(sgmParams.useCoarseDepthPruning)
+    {
+        // one more pixel, the coarse region of interest can be shifted by the rounding
+        const int coarseDownscale = downscale * _sgmParams.coarseDepthPruningStep;
+        const CudaSize<2> coarseDim(divideRoundUp(tileParams.bufferWidth, coarseDownscale) + 1,
+                                    divideRoundUp(tileParams.bufferHeight, coarseDownscale) + 1);
+
+        _coarseBestZIndex_dmp.allocate(coarseDim);
+        _coarseBestZIndex_hmh.allocate(coarseDim);
+        _depthBands_hmh.allocate(coarseDim);
+        _depthBands_dmp.allocate(coarseDim);
     }
 }
 
@@ -86,6 +102,12 @@ double Sgm::getDeviceMemoryConsumption() const
         bytes += _volumeAxisAcc_dmp.getBytesPadded();
     }
 
+    if(_sgmParams.useCoarseDepthPruning)
+    {
+        bytes += _coarseBestZIndex_dmp.getBytesPadded();
+        bytes += _depthBands_dmp.getBytesPadded();
+    }
+
     return (double(bytes) / (1024.0 * 1024.0));
 }
 
@@ -108,11 +130,56 @@ double Sgm::getDeviceMemoryConsumptionUnpadded() const
         bytes += _volumeAxisAcc_dmp.getBytesUnpadded();
     }
 
+    if(_sgmParams.useCoarseDepthPruning)
+    {
+        bytes += _coarseBestZIndex_dmp.getBytesUnpadded();
+        bytes += _depthBands_dmp.getBytesUnpadded();
+    }
+
+    return (double(bytes) / (1024.0 * 1024.0));
+}
+
+double Sgm::estimateDeviceMemoryConsumption(const mvsUtils::TileParams& tileParams, const SgmParams& sgmParams)
+{
+    // same buffers as the constructor
+    const int downscale = sgmParams.scale * sgmParams.stepXY;
+    const int maxTileWidth  = divideRoundUp(tileParams.bufferWidth , downscale);
+    const int maxTileHeight = divideRoundUp(tileParams.bufferHeight, downscale);
+    const CudaSize<2> mapDim(maxTileWidth, maxTileHeight);
+    const CudaSize<3> volDim(maxTileWidth, maxTileHeight, sgmParams.maxDepths);
+
+    size_t bytes = 0;
+
+    bytes += estimateBytesPadded<float>(CudaSize<2>(sgmParams.maxDepths, 1));
+    bytes += estimateBytesPadded<float2>(mapDim);
+    bytes += 2 * estimateBytesPadded<TSim>(volDim);
+
+    if(sgmParams.computeNormalMap)
+        bytes += estimateBytesPadded<float3>(mapDim);
+
+    if(sgmParams.doSgmOptimizeVolume)
+    {
+        const size_t maxTileSide = std::max(maxTileWidth, maxTileHeight);
+        bytes += 2 * estimateBytesPadded<TSimAcc>(CudaSize<2>(maxTileSide, sgmParams.maxDepths));
+        bytes += estimateBytesPadded<TSimAcc>(CudaSize<2>(maxTileSide, sgmParams.useFusedVolumeOptimization ? 3 : 1));
+    }
+
+    if(sgmParams.useCoarseDepthPruning)
+    {
+        const int coarseDownscale = downscale * sgmParams.coarseDepthPruningStep;
+        const CudaSize<2> coarseDim(divideRoundUp(tileParams.bufferWidth, coarseDownscale) + 1,
+                                    divideRoundUp(tileParams.bufferHeight, coarseDownscale) + 1);
+        bytes += estimateBytesPadded<int>(coarseDim);
+        bytes += estimateBytesPadded<int2>(coarseDim);
+    }
+
     return (double(bytes) / (1024.0 * 1024.0));
 }
 
 void Sgm::sgmRc(const Tile& tile, const SgmDepthList& tileDepthList)
 {
+    ALICEVISION_PROFILE_ZONE("sgm");
+
     const IndexT viewId = _mp.getViewId(tile.rc);
 
     ALICEVISION_LOG_INFO(tile << "SGM depth/sim map of view id: " << viewId << ", rc: " << tile.rc << " (" << (tile.rc + 1) << " / " << _mp.ncams << ").");
@@ -128,18 +195,33 @@ void Sgm::sgmRc(const Tile& tile, const SgmDepthList& tileDepthList)
     // copy rc depth data in device memory
     _depths_dmp.copyFrom(_depths_hmh, _stream);
 
+    // coarse-to-fine depth pruning (if requested by user)
+    SgmDepthList prunedDepthList(tileDepthList);
+    const bool useDepthBands = _sgmParams.useCoarseDepthPruning && computeDepthBands(tile, tileDepthList, prunedDepthList);
+    const SgmDepthList& depthList = useDepthBands ? prunedDepthList : tileDepthList;
+
+    if(useDepthBands)
+    {
+        // copy pruned rc depth data in device memory
+        // note: the stream is synchronized by computeDepthBands, the previous copy is done
+        for(int i = 0; i < depthList.getDepths().size(); ++i)
+            _depths_hmh(i, 0) = depthList.getDepths()[i];
+
+        _depths_dmp.copyFrom(_depths_hmh, _stream);
+    }
+
     // compute best sim and second best sim volumes
-    computeSimilarityVolumes(tile, tileDepthList);
+    computeSimilarityVolumes(tile, depthList, _sgmParams, useDepthBands);
 
     // export intermediate volume information (if requested by user)
-    exportVolumeInformation(tile, tileDepthList, _volumeSecBestSim_dmp, "beforeFiltering");
+    exportVolumeInformation(tile, depthList, _volumeSecBestSim_dmp, "beforeFiltering");
 
     // this is here for experimental purposes
     // to show how SGGC work on non optimized depthmaps
     // it must equals to true in normal case
     if(_sgmParams.doSgmOptimizeVolume)                      
     {
-        optimizeSimilarityVolume(tile, tileDepthList);
+        optimizeSimilarityVolume(tile, depthList);
     }
     else
     {
@@ -148,10 +230,10 @@ void Sgm::sgmRc(const Tile& tile, const SgmDepthList& tileDepthList)
     }
 
     // export intermediate volume information (if requested by user)
-    exportVolumeInformation(tile, tileDepthList, _volumeBestSim_dmp, "afterFiltering");
+    exportVolumeInformation(tile, depthList, _volumeBestSim_dmp, "afterFiltering");
 
     // retrieve best depth
-    retrieveBestDepth(tile, tileDepthList);
+    retrieveBestDepth(tile, depthList);
 
     // export intermediate depth/sim map (if requested by user)
     if(_sgmParams.exportIntermediateDepthSimMaps)
@@ -178,12 +260,16 @@ void Sgm::sgmRc(const Tile& tile, const SgmDepthList& tileDepthList)
     ALICEVISION_LOG_INFO(tile << "SGM depth/sim map done.");
 }
 
-void Sgm::computeSimilarityVolumes(const Tile& tile, const SgmDepthList& tileDepthList)
+void Sgm::computeSimilarityVolumes(const Tile& tile, const SgmDepthList& tileDepthList, const SgmParams& sgmParams, bool useDepthBands)
 {
     ALICEVISION_LOG_INFO(tile << "SGM Compute similarity volume.");
 
     // downscale the region of interest
-    const ROI downscaledRoi = downscaleROI(tile.roi, _sgmParams.scale * _sgmParams.stepXY);
+    const ROI downscaledRoi = downscaleROI(tile.roi, sgmParams.scale * sgmParams.stepXY);
+
+    // depth bands region of interest, see computeDepthBands
+    const int depthBandsStep = _sgmParams.coarseDepthPruningStep;
+    const ROI depthBandsRoi = useDepthBands ? downscaleROI(tile.roi, sgmParams.scale * sgmParams.stepXY * depthBandsStep) : ROI();
 
     // initialize the two similarity volumes at 255
     cuda_volumeInitialize(_volumeBestSim_dmp, 255.f, _stream);
@@ -193,20 +279,24 @@ void Sgm::computeSimilarityVolumes(const Tile& tile, const SgmDepthList& tileDep
     DeviceCache& deviceCache = DeviceCache::getInstance();
 
     // get R device camera from cache
-    const DeviceCamera& rcDeviceCamera = deviceCache.requestCamera(tile.rc, _sgmParams.scale, _mp);
+    const DeviceCamera& rcDeviceCamera = deviceCache.requestCamera(tile.rc, sgmParams.scale, _mp);
 
     // compute similarity volume per Rc Tc
     for(std::size_t tci = 0; tci < tile.sgmTCams.size(); ++tci)
     {
         const int tc = tile.sgmTCams.at(tci);
 
+        // T camera with no depth (can be removed by the depth pruning)
+        if(tileDepthList.getDepthsTcLimits()[tci].y <= 0)
+            continue;
+
         const int firstDepth = tileDepthList.getDepthsTcLimits()[tci].x;
         const int lastDepth  = firstDepth + tileDepthList.getDepthsTcLimits()[tci].y;
 
         const Range tcDepthRange(firstDepth, lastDepth);
 
         // get T device camera from cache
-        const DeviceCamera& tcDeviceCamera = deviceCache.requestCamera(tc, _sgmParams.scale, _mp);
+        const DeviceCamera& tcDeviceCamera = deviceCache.requestCamera(tc, sgmParams.scale, _mp);
 
         ALICEVISION_LOG_DEBUG(tile << "Compute similarity volume:" << std::endl
                                    << "\t- rc: " << tile.rc << std::endl
@@ -221,9 +311,12 @@ void Sgm::computeSimilarityVolumes(const Tile& tile, const SgmDepthList& tileDep
         cuda_volumeComputeSimilarity(_volumeBestSim_dmp, 
                                      _volumeSecBestSim_dmp, 
                                      _depths_dmp, 
+                                     useDepthBands ? &_depthBands_dmp : nullptr,
+                                     depthBandsStep,
+                                     depthBandsRoi,
                                      rcDeviceCamera, 
                                      tcDeviceCamera,
-                                     _sgmParams, 
+                                     sgmParams, 
                                      tcDepthRange,
                                      downscaledRoi, 
                                      _stream);
@@ -232,7 +325,7 @@ void Sgm::computeSimilarityVolumes(const Tile& tile, const SgmDepthList& tileDep
     // update second best uninitialized similarity volume values with first best similarity volume values
     // - allows to avoid the particular case with a single tc (second best volume has no valid similarity values)
     // - usefull if a tc alone contributes to the calculation of a subpart of the similarity volume
-    if(_sgmParams.updateUninitializedSim) // should always be true, false for debug purposes
+    if(sgmParams.updateUninitializedSim) // should always be true, false for debug purposes
     {
         ALICEVISION_LOG_DEBUG(tile << "SGM Update uninitialized similarity volume values from best similarity volume.");
 
@@ -242,9 +335,107 @@ void Sgm::computeSimilarityVolumes(const Tile& tile, const SgmDepthList& tileDep
     ALICEVISION_LOG_INFO(tile << "SGM Compute similarity volume done.");
 }
 
+bool Sgm::computeDepthBands(const Tile& tile, const SgmDepthList& tileDepthList, SgmDepthList& out_prunedDepthList)
+{
+    ALICEVISION_LOG_INFO(tile << "SGM Compute coarse depth bands (step: " << _sgmParams.coarseDepthPruningStep << ").");
+
+    // coarse similarity volume parameters, one pixel over N in the XY image plane
+    SgmParams coarseSgmParams = _sgmParams;
+    coarseSgmParams.stepXY *= _sgmParams.coarseDepthPruningStep;
+
+    // downscale the region of interest
+    const ROI coarseRoi = downscaleROI(tile.roi, coarseSgmParams.scale * coarseSgmParams.stepXY);
+
+    const int nbDepths = int(tileDepthList.getDepths().size());
+    const int margin = _sgmParams.coarseDepthPruningMargin;
+
+    // compute the coarse similarity volumes in the full resolution volumes (not yet used)
+    computeSimilarityVolumes(tile, tileDepthList, coarseSgmParams, false);
+
+    // best depth index per coarse pixel, in the second best similarity volume (as the optimization input)
+    cuda_volumeRetrieveBestDepthIndex(_coarseBestZIndex_dmp, _volumeSecBestSim_dmp, Range(0, nbDepths), coarseRoi, _stream);
+
+    _coarseBestZIndex_hmh.copyFrom(_coarseBestZIndex_dmp, _stream);
+    cudaStreamSynchronize(_stream);
+
+    // depth band of each coarse pixel: best depths of its 3x3 neighborhood with a margin
+    const int2 emptyBand = make_int2(0, -1);
+    const int width = int(coarseRoi.width());
+    const int height = int(coarseRoi.height());
+
+    std::vector<bool> keepDepths(nbDepths, false);
+
+    for(int y = 0; y < height; ++y)
+    {
+        for(int x = 0; x < width; ++x)
+        {
+            int minZIndex = nbDepths;
+            int maxZIndex = -1;
+
+            for(int ny = std::max(0, y - 1); ny <= std::min(height - 1, y + 1); ++ny)
+            {
+                for(int nx = std::max(0, x - 1); nx <= std::min(width - 1, x + 1); ++nx)
+                {
+                    const int zIndex = _coarseBestZIndex_hmh(nx, ny);
+                    if(zIndex < 0) // no valid similarity
+                        continue;
+                    minZIndex = std::min(minZIndex, zIndex);
+                    maxZIndex = std::max(maxZIndex, zIndex);
+                }
+            }
+
+            if(maxZIndex < 0)
+            {
+                // no valid similarity in the neighborhood (e.g. sky), all the depths are pruned
+                _depthBands_hmh(x, y) = emptyBand;
+                continue;
+            }
+
+            const int2 band = make_int2(std::max(0, minZIndex - margin), std::min(nbDepths - 1, maxZIndex + margin));
+            _depthBands_hmh(x, y) = band;
+
+            for(int z = band.x; z <= band.y; ++z)
+                keepDepths[z] = true;
+        }
+    }
+
+    // new index of each depth in the pruned depth list
+    std::vector<int> newIndexes(nbDepths + 1, 0);
+    for(int z = 0; z < nbDepths; ++z)
+        newIndexes[z + 1] = newIndexes[z] + (keepDepths[z] ? 1 : 0);
+
+    const int nbKeptDepths = newIndexes[nbDepths];
+
+    if(nbKeptDepths == 0)
+    {
+        ALICEVISION_LOG_INFO(tile << "SGM Compute coarse depth bands: no valid depth, use the full depth list.");
+        return false;
+    }
+
+    // convert the depth bands to the pruned depth list indexes
+    for(int y = 0; y < height; ++y)
+    {
+        for(int x = 0; x < width; ++x)
+        {
+            int2& band = _depthBands_hmh(x, y);
+            if(band.y < band.x) // empty band
+                continue;
+            band = make_int2(newIndexes[band.x], newIndexes[band.y + 1] - 1);
+        }
+    }
+
+    _depthBands_dmp.copyFrom(_depthBands_hmh, _stream);
+
+    out_prunedDepthList.pruneDepths(keepDepths);
+
+    ALICEVISION_LOG_INFO(tile << "SGM Compute coarse depth bands done (depths: " << nbDepths << " -> " << nbKeptDepths << ").");
+    return true;
+}
+
 void Sgm::optimizeSimilarityVolume(const Tile& tile, const SgmDepthList& tileDepthList)
 {
-    ALICEVISION_LOG_INFO(tile << "SGM Optimizing volume (filtering axes: " << _sgmParams.filteringAxes << ").");
+    ALICEVISION_LOG_INFO(tile << "SGM Optimizing volume (filtering axes: " << _sgmParams.filteringAxes
+                              << ", fused kernel: " << (_sgmParams.useFusedVolumeOptimization ? "yes" : "no") << ").");
 
     // downscale the region of interest
     const ROI downscaledRoi = downscaleROI(tile.roi, _sgmParams.scale * _sgmParams.stepXY);
@@ -252,6 +443,21 @@ void Sgm::optimizeSimilarityVolume(const Tile& tile, const SgmDepthList& tileDep
     // get R device camera from cache
     DeviceCache& deviceCache = DeviceCache::getInstance();
     const DeviceCamera& rcDeviceCamera = deviceCache.requestCamera(tile.rc, _sgmParams.scale, _mp);
+
+    // measure the optimization on the stream, to compare the fused and the default kernels
+    // only when intermediate results are exported: the host waits for the volume anyway,
+    // otherwise the tiles are not synchronized here
+    const bool measureElapsedTime = _sgmParams.exportIntermediateDepthSimMaps ||
+                                    _sgmParams.exportIntermediateVolumes ||
+                                    _sgmParams.exportIntermediateCrossVolumes ||
+                                    _sgmParams.exportIntermediateVolume9pCsv;
+    cudaEvent_t startEvent, stopEvent;
+    if(measureElapsedTime)
+    {
+        cudaEventCreate(&startEvent);
+        cudaEventCreate(&stopEvent);
+        cudaEventRecord(startEvent, _stream);
+    }
     
     cuda_volumeOptimize(_volumeBestSim_dmp,    // output volume (reuse best sim to put optimized similarity)
                         _volumeSliceAccA_dmp,  // slice A accumulation buffer pre-allocate
@@ -264,7 +470,21 @@ void Sgm::optimizeSimilarityVolume(const Tile& tile, const SgmDepthList& tileDep
                         downscaledRoi,
                         _stream);
 
-    ALICEVISION_LOG_INFO(tile << "SGM Optimizing volume done.");
+    if(!measureElapsedTime)
+    {
+        ALICEVISION_LOG_INFO(tile << "SGM Optimizing volume done.");
+        return;
+    }
+
+    cudaEventRecord(stopEvent, _stream);
+    cudaEventSynchronize(stopEvent);
+
+    float elapsedMs = 0.f;
+    cudaEventElapsedTime(&elapsedMs, startEvent, stopEvent);
+    cudaEventDestroy(startEvent);
+    cudaEventDestroy(stopEvent);
+
+    ALICEVISION_LOG_INFO(tile << "SGM Optimizing volume done (" << elapsedMs << " ms).");
 }
 
 void Sgm::retrieveBestDepth(const Tile& tile, const SgmDepthList& tileDepthList)
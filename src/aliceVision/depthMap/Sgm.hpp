@@ -64,6 +64,14 @@ public:
      */
     double getDeviceMemoryConsumptionUnpadded() const;
 
+    /**
+     * @brief Estimate the device memory consumption of a Sgm instance, without allocating its buffers.
+     * @param[in] tileParams the tile workflow parameters
+     * @param[in] sgmParams the Semi Global Matching parameters
+     * @return estimated device memory consumption (in MB)
+     */
+    static double estimateDeviceMemoryConsumption(const mvsUtils::TileParams& tileParams, const SgmParams& sgmParams);
+
     /**
      * @brief Compute for a single R camera the Semi-Global Matching depth/sim map.
      * @param[in] tile The given tile for SGM computation
@@ -79,8 +87,21 @@ private:
      * @brief Compute for each RcTc the best / second best similarity volumes.
      * @param[in] tile The given tile for SGM computation
      * @param[in] tileDepthList the tile SGM depth list
+     * @param[in] sgmParams the Semi Global Matching parameters used for the volumes (coarse or full resolution)
+     * @param[in] useDepthBands only compute the depths in the band of each pixel (see computeDepthBands)
+     */
+    void computeSimilarityVolumes(const Tile& tile, const SgmDepthList& tileDepthList, const SgmParams& sgmParams, bool useDepthBands);
+
+    /**
+     * @brief Coarse-to-fine depth pruning: compute a coarse similarity volume (larger step in the XY image plane),
+     *        keep for each coarse pixel a band of depths around the best depths of its neighborhood
+     *        and remove the depths used by no band from the depth list.
+     * @param[in] tile The given tile for SGM computation
+     * @param[in] tileDepthList the tile SGM depth list
+     * @param[out] out_prunedDepthList the pruned tile SGM depth list (the depth bands use its indexes)
+     * @return false if no coarse pixel has a valid depth (the depth list cannot be pruned)
      */
-    void computeSimilarityVolumes(const Tile& tile, const SgmDepthList& tileDepthList);
+    bool computeDepthBands(const Tile& tile, const SgmDepthList& tileDepthList, SgmDepthList& out_prunedDepthList);
 
     /**
      * @brief Optimize the given similarity volume.
@@ -129,6 +150,10 @@ private:
     CudaDeviceMemoryPitched<TSimAcc, 2> _volumeSliceAccA_dmp;  //< for optimization: volume accumulation slice A
     CudaDeviceMemoryPitched<TSimAcc, 2> _volumeSliceAccB_dmp;  //< for optimization: volume accumulation slice B
     CudaDeviceMemoryPitched<TSimAcc, 2> _volumeAxisAcc_dmp;    //< for optimization: volume accumulation axis
+    CudaDeviceMemoryPitched<int, 2> _coarseBestZIndex_dmp;     //< for depth pruning: coarse best depth index map
+    CudaHostMemoryHeap<int, 2> _coarseBestZIndex_hmh;          //< for depth pruning: coarse best depth index map host memory
+    CudaHostMemoryHeap<int2, 2> _depthBands_hmh;               //< for depth pruning: coarse depth band map host memory
+    CudaDeviceMemoryPitched<int2, 2> _depthBands_dmp;          //< for depth pruning: coarse depth band map
     cudaStream_t _stream;                                      //< stream for gpu execution
 };
 
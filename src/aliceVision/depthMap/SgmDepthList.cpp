@@ -220,6 +220,42 @@ void SgmDepthList::removeTcWithNoDepth(Tile& tile)
     std::swap(_depthsTcLimits, out_depthsTcLimits);
 }
 
+void SgmDepthList::pruneDepths(const std::vector<bool>& keepDepths)
+{
+    assert(keepDepths.size() == _depths.size());
+
+    // new index of each depth (number of kept depths before it)
+    std::vector<int> newIndexes(_depths.size() + 1, 0);
+    std::vector<float> depths;
+    depths.reserve(_depths.size());
+
+    for(size_t i = 0; i < _depths.size(); ++i)
+    {
+        newIndexes[i + 1] = newIndexes[i] + (keepDepths[i] ? 1 : 0);
+        if(keepDepths[i])
+            depths.push_back(_depths[i]);
+    }
+
+    // update T cameras depth limits (first depth index, number of depths)
+    for(Pixel& tcLimits : _depthsTcLimits)
+    {
+        if(tcLimits.x == -1 || tcLimits.y == -1)
+            continue;
+
+        const int firstIndex = newIndexes[tcLimits.x];
+        const int nbDepths = newIndexes[tcLimits.x + tcLimits.y] - firstIndex;
+
+        if(nbDepths > 0)
+            tcLimits = Pixel(firstIndex, nbDepths);
+        else
+            tcLimits = Pixel(-1, -1);
+    }
+
+    ALICEVISION_LOG_DEBUG(_tile << "Depth list pruned: " << _depths.size() << " -> " << depths.size() << " depths.");
+
+    std::swap(_depths, depths);
+}
+
 void SgmDepthList::logRcTcDepthInformation() const
 {
     std::ostringstream ostr;
@@ -53,6 +53,13 @@ public:
      */
     void removeTcWithNoDepth(Tile& tile);
 
+    /**
+     * @brief Remove the depths not used by any pixel
+     * @note also update depthsTcLimits, T cameras with no remaining depth get invalid limits (-1, -1)
+     * @param[in] keepDepths For each depth of the list, true if the depth is kept
+     */
+    void pruneDepths(const std::vector<bool>& keepDepths);
+
     /**
      * @brief Log depth information
      */
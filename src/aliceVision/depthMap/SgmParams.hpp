@@ -32,6 +32,10 @@ struct SgmParams
   std::string filteringAxes = "YX";
   bool useSfmSeeds = true;
   bool depthListPerTile = false;
+  bool useFusedVolumeOptimization = false;
+  bool useCoarseDepthPruning = false;
+  int coarseDepthPruningStep = 4;
+  int coarseDepthPruningMargin = 16;
 
   // intermediate results export parameters
 
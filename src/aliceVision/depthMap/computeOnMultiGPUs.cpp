@@ -8,12 +8,25 @@
 
 #include <aliceVision/alicevision_omp.hpp>
 #include <aliceVision/depthMap/cuda/host/utils.hpp>
+#include <aliceVision/gpu/GpuResourceManager.hpp>
 
 namespace aliceVision {
 namespace depthMap {
 
-void computeOnMultiGPUs(mvsUtils::MultiViewParams& mp, const std::vector<int>& cams, GPUJob gpujob, int nbGPUsToUse)
+namespace {
+
+/**
+ * @brief Reserve the GPU devices of the jobs
+ * @return the CUDA device index used by each CPU thread, empty if the user disabled the GPU devices
+ */
+std::vector<int> acquireGPUs(gpu::GpuResourceManager& gpuResourceManager, int nbGPUsToUse, const HardwareContext& hContext)
 {
+    if(hContext.getUserMaxGpusAvailable() == 0)
+    {
+        ALICEVISION_LOG_WARNING("The GPU devices are disabled (maxGpusAvailable = 0).");
+        return std::vector<int>();
+    }
+
     const int nbGPUDevices = listCudaDevices();
     const int nbCPUThreads = omp_get_max_threads();
 
@@ -26,13 +39,32 @@ void computeOnMultiGPUs(mvsUtils::MultiViewParams& mp, const std::vector<int>& c
         // Use the user specified limit on the number of GPUs to use
         nbThreads = std::min(nbThreads, nbGPUsToUse);
     }
+    nbThreads = int(std::min(unsigned(std::max(nbThreads, 0)), hContext.getUserMaxGpusAvailable()));
+
+    // the GPU sorting is determined by an environment variable named CUDA_DEVICE_ORDER
+    // possible values: FASTEST_FIRST (default) or PCI_BUS_ID
+    const std::vector<int> cudaDeviceIds = (nbThreads > 0) ? gpuResourceManager.acquireDevices(nbThreads) : std::vector<int>();
+
+    if (cudaDeviceIds.empty())
+        ALICEVISION_THROW_ERROR("No CUDA device available.");
+
+    return cudaDeviceIds;
+}
+
+} // namespace
+
+void computeOnMultiGPUs(mvsUtils::MultiViewParams& mp, const std::vector<int>& cams, GPUJob gpujob, int nbGPUsToUse,
+                        const HardwareContext& hContext)
+{
+    gpu::GpuResourceManager gpuResourceManager(hContext);
+    const std::vector<int> cudaDeviceIds = acquireGPUs(gpuResourceManager, nbGPUsToUse, hContext);
+    if(cudaDeviceIds.empty())
+        ALICEVISION_THROW_ERROR("The depth maps computation needs a GPU device, the GPU devices are disabled.");
+    const int nbThreads = cudaDeviceIds.size();
 
     if (nbThreads == 1)
     {
-        // the GPU sorting is determined by an environment variable named CUDA_DEVICE_ORDER
-        // possible values: FASTEST_FIRST (default) or PCI_BUS_ID
-        const int cudaDeviceIndex = 0;
-        gpujob(cudaDeviceIndex, mp, cams);
+        gpujob(cudaDeviceIds.front(), mp, cams);
     }
     else
     {
@@ -42,14 +74,15 @@ void computeOnMultiGPUs(mvsUtils::MultiViewParams& mp, const std::vector<int>& c
 #pragma omp parallel
         {
             const int cpuThreadId = omp_get_thread_num();
-            const int cudaDeviceId = cpuThreadId % nbThreads;
+            const int deviceIndex = cpuThreadId % nbThreads;
+            const int cudaDeviceId = cudaDeviceIds.at(deviceIndex);
 
             ALICEVISION_LOG_INFO("CPU thread " << cpuThreadId << " (of " << nbThreads << ") uses CUDA device: " << cudaDeviceId);
 
             const int nbCamsPerThread = (cams.size() / nbThreads);
-            const int rcFrom = cudaDeviceId * nbCamsPerThread;
-            int rcTo = (cudaDeviceId + 1) * nbCamsPerThread;
-            if(cudaDeviceId == nbThreads - 1)
+            const int rcFrom = deviceIndex * nbCamsPerThread;
+            int rcTo = (deviceIndex + 1) * nbCamsPerThread;
+            if(deviceIndex == nbThreads - 1)
             {
                 rcTo = cams.size();
             }
@@ -68,5 +101,35 @@ void computeOnMultiGPUs(mvsUtils::MultiViewParams& mp, const std::vector<int>& c
     }
 }
 
+void computeOnMultiGPUs(mvsUtils::MultiViewParams& mp, CameraWorkQueue& workQueue, GPUJob gpujob, int nbGPUsToUse, int nbCamsPerJob,
+                        const HardwareContext& hContext)
+{
+    gpu::GpuResourceManager gpuResourceManager(hContext);
+    const std::vector<int> cudaDeviceIds = acquireGPUs(gpuResourceManager, nbGPUsToUse, hContext);
+    if(cudaDeviceIds.empty())
+        ALICEVISION_THROW_ERROR("The depth maps computation needs a GPU device, the GPU devices are disabled.");
+    const int nbThreads = cudaDeviceIds.size();
+
+    //backup max threads to keep potentially previously set value
+    int previous_count_threads = omp_get_max_threads();
+    omp_set_num_threads(nbThreads); // create as many CPU threads as there are CUDA devices
+#pragma omp parallel
+    {
+        const int cpuThreadId = omp_get_thread_num();
+        const int cudaDeviceId = cudaDeviceIds.at(cpuThreadId % nbThreads);
+
+        ALICEVISION_LOG_INFO("CPU thread " << cpuThreadId << " (of " << nbThreads << ") uses CUDA device: " << cudaDeviceId);
+
+        std::vector<int> subcams;
+        while(workQueue.pull(nbCamsPerJob, subcams))
+        {
+            ALICEVISION_LOG_INFO("CUDA device " << cudaDeviceId << " pulled " << subcams.size() << " camera(s) from the work queue.");
+            gpujob(cudaDeviceId, mp, subcams);
+            workQueue.done(subcams);
+        }
+    }
+    omp_set_num_threads(previous_count_threads);
+}
+
 } // namespace depthMap
 } // namespace aliceVision
@@ -7,13 +7,39 @@
 #pragma once
 
 #include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/depthMap/CameraWorkQueue.hpp>
+#include <aliceVision/system/hardwareContext.hpp>
 
 namespace aliceVision {
 namespace depthMap {
 
 typedef void (*GPUJob)(int cudaDeviceNo, mvsUtils::MultiViewParams& mp, const std::vector<int>& cams);
 
-void computeOnMultiGPUs(mvsUtils::MultiViewParams& mp, const std::vector<int>& cams, GPUJob gpujob, int nbGPUsToUse);
+/**
+ * @brief Compute the R cameras on the local GPUs, the cameras are split evenly between the GPUs.
+ *        The GPUs are reserved with gpu::GpuResourceManager, the least used devices of the machine are chosen
+ *        and the job waits while all the devices are used by other processes.
+ * @param[in] mp the multi-view parameters
+ * @param[in] cams the R cameras
+ * @param[in] gpujob the job to run on each GPU
+ * @param[in] nbGPUsToUse the maximum number of GPUs to use (0 means all)
+ * @param[in] hContext the hardware context with the user limits on the GPUs
+ */
+void computeOnMultiGPUs(mvsUtils::MultiViewParams& mp, const std::vector<int>& cams, GPUJob gpujob, int nbGPUsToUse,
+                        const HardwareContext& hContext = HardwareContext());
+
+/**
+ * @brief Compute the R cameras of a work queue on the local GPUs.
+ *        Each GPU pulls its next cameras from the queue when its previous job is finished.
+ * @param[in] mp the multi-view parameters
+ * @param[in,out] workQueue the R camera work queue
+ * @param[in] gpujob the job to run on each set of pulled cameras
+ * @param[in] nbGPUsToUse the maximum number of GPUs to use (0 means all)
+ * @param[in] nbCamsPerJob the number of R cameras pulled by a GPU for each job
+ * @param[in] hContext the hardware context with the user limits on the GPUs
+ */
+void computeOnMultiGPUs(mvsUtils::MultiViewParams& mp, CameraWorkQueue& workQueue, GPUJob gpujob, int nbGPUsToUse, int nbCamsPerJob,
+                        const HardwareContext& hContext = HardwareContext());
 
 } // namespace depthMap
 } // namespace aliceVision
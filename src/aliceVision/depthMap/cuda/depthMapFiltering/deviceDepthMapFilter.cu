@@ -0,0 +1,88 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "deviceDepthMapFilter.hpp"
+#include "deviceDepthMapFilterKernels.cuh"
+
+#include <aliceVision/depthMap/cuda/host/divUp.hpp>
+
+namespace aliceVision {
+namespace depthMap {
+
+__host__ void cuda_depthMapCountConsistentCams(CudaDeviceMemoryPitched<int, 2>& inout_tcStampMap_dmp,
+                                               CudaDeviceMemoryPitched<int, 2>& inout_nbConsistentCamsMap_dmp,
+                                               const CudaDeviceMemoryPitched<float, 2>& in_rcDepthMap_dmp,
+                                               const CudaDeviceMemoryPitched<float, 2>& in_rcSimMap_dmp,
+                                               const CudaDeviceMemoryPitched<float, 2>& in_tcDepthMap_dmp,
+                                               const DeviceCameraParams& rcCamParams,
+                                               const DeviceCameraParams& tcCamParams,
+                                               const DepthMapFilterParams& filterParams,
+                                               int tcStamp,
+                                               int border,
+                                               cudaStream_t stream)
+{
+    const int tcWidth = int(in_tcDepthMap_dmp.getSize().x());
+    const int tcHeight = int(in_tcDepthMap_dmp.getSize().y());
+
+    // one thread per T camera pixel
+    const dim3 block(16, 16, 1);
+    const dim3 grid(divUp(tcWidth, block.x), divUp(tcHeight, block.y), 1);
+
+    depthMapFilter_countConsistentCams_kernel<<<grid, block, 0, stream>>>(
+        rcCamParams,
+        tcCamParams,
+        in_rcDepthMap_dmp.getBuffer(),
+        in_rcDepthMap_dmp.getPitch(),
+        in_rcSimMap_dmp.getBuffer(),
+        in_rcSimMap_dmp.getPitch(),
+        in_tcDepthMap_dmp.getBuffer(),
+        in_tcDepthMap_dmp.getPitch(),
+        inout_tcStampMap_dmp.getBuffer(),
+        inout_tcStampMap_dmp.getPitch(),
+        inout_nbConsistentCamsMap_dmp.getBuffer(),
+        inout_nbConsistentCamsMap_dmp.getPitch(),
+        tcStamp,
+        int(in_rcDepthMap_dmp.getSize().x()),
+        int(in_rcDepthMap_dmp.getSize().y()),
+        tcWidth,
+        tcHeight,
+        border,
+        filterParams.pixToleranceFactor,
+        filterParams.pixSizeBall,
+        filterParams.pixSizeBallWithLowSimilarity);
+
+    CHECK_CUDA_ERROR();
+}
+
+__host__ void cuda_depthMapFilterByConsistentCams(CudaDeviceMemoryPitched<float, 2>& inout_depthMap_dmp,
+                                                  CudaDeviceMemoryPitched<float, 2>& inout_simMap_dmp,
+                                                  const CudaDeviceMemoryPitched<int, 2>& in_nbConsistentCamsMap_dmp,
+                                                  const DepthMapFilterParams& filterParams,
+                                                  cudaStream_t stream)
+{
+    const int width = int(inout_depthMap_dmp.getSize().x());
+    const int height = int(inout_depthMap_dmp.getSize().y());
+
+    const dim3 block(32, 8, 1);
+    const dim3 grid(divUp(width, block.x), divUp(height, block.y), 1);
+
+    depthMapFilter_filterByConsistentCams_kernel<<<grid, block, 0, stream>>>(
+        inout_depthMap_dmp.getBuffer(),
+        inout_depthMap_dmp.getPitch(),
+        inout_simMap_dmp.getBuffer(),
+        inout_simMap_dmp.getPitch(),
+        in_nbConsistentCamsMap_dmp.getBuffer(),
+        in_nbConsistentCamsMap_dmp.getPitch(),
+        width,
+        height,
+        filterParams.minNumOfConsistentCams,
+        filterParams.minNumOfConsistentCamsWithLowSimilarity);
+
+    CHECK_CUDA_ERROR();
+}
+
+} // namespace depthMap
+} // namespace aliceVision
@@ -0,0 +1,57 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/depthMap/DepthMapFilterParams.hpp>
+#include <aliceVision/depthMap/cuda/host/memory.hpp>
+#include <aliceVision/depthMap/cuda/device/DeviceCameraParams.hpp>
+
+namespace aliceVision {
+namespace depthMap {
+
+/**
+ * @brief Count for each R camera pixel if the given T camera depth map is consistent with it.
+ * @param[in,out] inout_tcStampMap_dmp the last T camera stamp of each R camera pixel (initialized to 0 for each R camera)
+ * @param[in,out] inout_nbConsistentCamsMap_dmp the number of consistent cameras of each R camera pixel (initialized to 0 for each R camera)
+ * @param[in] in_rcDepthMap_dmp the R camera depth map
+ * @param[in] in_rcSimMap_dmp the R camera similarity map
+ * @param[in] in_tcDepthMap_dmp the T camera depth map
+ * @param[in] rcCamParams the R camera parameters
+ * @param[in] tcCamParams the T camera parameters
+ * @param[in] filterParams the depth map filtering parameters
+ * @param[in] tcStamp the T camera stamp, unique for the R camera and > 0
+ * @param[in] border the R camera image border (pixels)
+ * @param[in] stream the stream for gpu execution
+ */
+extern void cuda_depthMapCountConsistentCams(CudaDeviceMemoryPitched<int, 2>& inout_tcStampMap_dmp,
+                                             CudaDeviceMemoryPitched<int, 2>& inout_nbConsistentCamsMap_dmp,
+                                             const CudaDeviceMemoryPitched<float, 2>& in_rcDepthMap_dmp,
+                                             const CudaDeviceMemoryPitched<float, 2>& in_rcSimMap_dmp,
+                                             const CudaDeviceMemoryPitched<float, 2>& in_tcDepthMap_dmp,
+                                             const DeviceCameraParams& rcCamParams,
+                                             const DeviceCameraParams& tcCamParams,
+                                             const DepthMapFilterParams& filterParams,
+                                             int tcStamp,
+                                             int border,
+                                             cudaStream_t stream);
+
+/**
+ * @brief Filter the R camera depth/sim map according to its number of consistent cameras.
+ * @param[in,out] inout_depthMap_dmp the R camera depth map
+ * @param[in,out] inout_simMap_dmp the R camera similarity map
+ * @param[in] in_nbConsistentCamsMap_dmp the number of consistent cameras of each R camera pixel
+ * @param[in] filterParams the depth map filtering parameters
+ * @param[in] stream the stream for gpu execution
+ */
+extern void cuda_depthMapFilterByConsistentCams(CudaDeviceMemoryPitched<float, 2>& inout_depthMap_dmp,
+                                                CudaDeviceMemoryPitched<float, 2>& inout_simMap_dmp,
+                                                const CudaDeviceMemoryPitched<int, 2>& in_nbConsistentCamsMap_dmp,
+                                                const DepthMapFilterParams& filterParams,
+                                                cudaStream_t stream);
+
+} // namespace depthMap
+} // namespace aliceVision
@@ -0,0 +1,241 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/depthMap/cuda/device/buffer.cuh>
+#include <aliceVision/depthMap/cuda/device/matrix.cuh>
+#include <aliceVision/depthMap/cuda/device/DeviceCameraParams.hpp>
+
+namespace aliceVision {
+namespace depthMap {
+
+/**
+ * @brief Project a 3d point in a camera.
+ * @param[in] camParams the camera parameters
+ * @param[in] p the 3d point
+ * @param[out] out_pix the projected pixel
+ * @return false if the point is behind the camera
+ */
+__device__ static inline bool depthMapFilter_project(const DeviceCameraParams& camParams, const float3& p, float2& out_pix)
+{
+    const float3 pc = M3x4mulV3(camParams.P, p);
+
+    if(pc.z <= 0.0f)
+        return false;
+
+    out_pix = make_float2(pc.x / pc.z, pc.y / pc.z);
+    return true;
+}
+
+/**
+ * @brief Get the normalized ray direction of a camera pixel.
+ */
+__device__ static inline float3 depthMapFilter_pixelRay(const DeviceCameraParams& camParams, const float2& pix)
+{
+    float3 ray = M3x3mulV2(camParams.iP, pix);
+    normalize(ray);
+    return ray;
+}
+
+/**
+ * @brief Size in 3d space of one pixel of the R camera at the given 3d point.
+ * @see MultiViewParams::getCamPixelSize
+ */
+__device__ static inline float depthMapFilter_rcPixSize(const DeviceCameraParams& rcCamParams, const float3& p, const float2& rpix)
+{
+    const float3 ray = depthMapFilter_pixelRay(rcCamParams, rpix + make_float2(1.0f, 0.0f));
+    return pointLineDistance3D(p, rcCamParams.C, ray);
+}
+
+/**
+ * @brief Size in 3d space of one pixel along the epipolar line in the T camera at the given 3d point.
+ * @see MultiViewParams::getCamPixelSizeRcTc
+ */
+__device__ static inline float depthMapFilter_rcTcPixSize(const DeviceCameraParams& rcCamParams,
+                                                          const DeviceCameraParams& tcCamParams,
+                                                          const float3& p,
+                                                          const float2& rpix)
+{
+    const float3 rcRay = depthMapFilter_pixelRay(rcCamParams, rpix);
+
+    // epipolar line direction in the T camera
+    const float baseline = dist(rcCamParams.C, tcCamParams.C);
+    float2 epipolarFrom;
+    float2 epipolarTo;
+    float2 tpix;
+
+    if(!depthMapFilter_project(tcCamParams, rcCamParams.C + rcRay * baseline, epipolarFrom) ||
+       !depthMapFilter_project(tcCamParams, rcCamParams.C + rcRay * (baseline * 500.0f), epipolarTo) ||
+       !depthMapFilter_project(tcCamParams, p, tpix))
+    {
+        return depthMapFilter_rcPixSize(rcCamParams, p, rpix);
+    }
+
+    float2 epipolarDir = epipolarTo - epipolarFrom;
+    normalize(epipolarDir);
+
+    // triangulate the R pixel with the T pixel moved by one pixel along the epipolar line
+    const float3 tcRay = depthMapFilter_pixelRay(tcCamParams, tpix + epipolarDir);
+
+    const float3 d = cross(rcRay, tcRay);
+    if(dot(d, d) < 1e-12f)
+        return depthMapFilter_rcPixSize(rcCamParams, p, rpix);
+
+    float k, l;
+    float3 lli1, lli2;
+    const float3 p1 = lineLineIntersect(&k, &l, &lli1, &lli2, rcCamParams.C, rcCamParams.C + rcRay, tcCamParams.C, tcCamParams.C + tcRay);
+
+    return dist(p, p1);
+}
+
+/**
+ * @brief Back-project each T camera depth in the R camera and mark the R camera pixels
+ *        with a consistent depth in their neighborhood.
+ *        Each R camera pixel supported by the T camera is counted once in the consistent cameras map.
+ *
+ * @param[in] rcCamParams the R camera parameters
+ * @param[in] tcCamParams the T camera parameters
+ * @param[in] rcDepthMap_d the R camera depth map buffer
+ * @param[in] rcDepthMap_p the R camera depth map buffer pitch
+ * @param[in] rcSimMap_d the R camera similarity map buffer
+ * @param[in] rcSimMap_p the R camera similarity map buffer pitch
+ * @param[in] tcDepthMap_d the T camera depth map buffer
+ * @param[in] tcDepthMap_p the T camera depth map buffer pitch
+ * @param[in,out] inout_tcStampMap_d the last T camera stamp of each R camera pixel buffer
+ * @param[in] inout_tcStampMap_p the last T camera stamp of each R camera pixel buffer pitch
+ * @param[in,out] inout_nbConsistentCamsMap_d the number of consistent cameras of each R camera pixel buffer
+ * @param[in] inout_nbConsistentCamsMap_p the number of consistent cameras of each R camera pixel buffer pitch
+ * @param[in] tcStamp the stamp of the T camera, unique for the R camera
+ * @param[in] rcWidth the R camera depth map width
+ * @param[in] rcHeight the R camera depth map height
+ * @param[in] tcWidth the T camera depth map width
+ * @param[in] tcHeight the T camera depth map height
+ * @param[in] border the R camera image border (pixels)
+ * @param[in] pixToleranceFactor the pixel size tolerance factor
+ * @param[in] pixSizeBall the neighborhood radius (pixels)
+ * @param[in] pixSizeBallWSP the neighborhood radius for the weakly supported pixels (pixels)
+ */
+__global__ void depthMapFilter_countConsistentCams_kernel(const DeviceCameraParams rcCamParams,
+                                                          const DeviceCameraParams tcCamParams,
+                                                          const float* rcDepthMap_d, int rcDepthMap_p,
+                                                          const float* rcSimMap_d, int rcSimMap_p,
+                                                          const float* tcDepthMap_d, int tcDepthMap_p,
+                                                          int* inout_tcStampMap_d, int inout_tcStampMap_p,
+                                                          int* inout_nbConsistentCamsMap_d, int inout_nbConsistentCamsMap_p,
+                                                          int tcStamp,
+                                                          int rcWidth,
+                                                          int rcHeight,
+                                                          int tcWidth,
+                                                          int tcHeight,
+                                                          int border,
+                                                          float pixToleranceFactor,
+                                                          int pixSizeBall,
+                                                          int pixSizeBallWSP)
+{
+    const int x = blockIdx.x * blockDim.x + threadIdx.x;
+    const int y = blockIdx.y * blockDim.y + threadIdx.y;
+
+    if(x >= tcWidth || y >= tcHeight)
+        return;
+
+    const float tcDepth = *get2DBufferAt(tcDepthMap_d, tcDepthMap_p, x, y);
+
+    if(tcDepth <= 0.0f)
+        return;
+
+    // 3d point back-projected from the T camera
+    const float3 p = tcCamParams.C + depthMapFilter_pixelRay(tcCamParams, make_float2(float(x), float(y))) * tcDepth;
+
+    float2 rpix;
+    if(!depthMapFilter_project(rcCamParams, p, rpix))
+        return;
+
+    const int2 cell = make_int2(int(floorf(rpix.x + 0.5f)), int(floorf(rpix.y + 0.5f)));
+
+    if(cell.x < border || cell.x >= rcWidth - border || cell.y < border || cell.y >= rcHeight - border)
+        return;
+
+    const float pixDepth = dist(rcCamParams.C, p);
+    const float sim = *get2DBufferAt(rcSimMap_d, rcSimMap_p, cell.x, cell.y);
+    const int d = (sim >= 1.0f) ? pixSizeBallWSP : pixSizeBall;
+    const float pixSize = pixToleranceFactor * 0.5f * (depthMapFilter_rcTcPixSize(rcCamParams, tcCamParams, p, rpix) +
+                                                       depthMapFilter_rcPixSize(rcCamParams, p, rpix));
+
+    for(int ny = max(0, cell.y - d); ny <= min(rcHeight - 1, cell.y + d); ++ny)
+    {
+        for(int nx = max(0, cell.x - d); nx <= min(rcWidth - 1, cell.x + d); ++nx)
+        {
+            const float depth = *get2DBufferAt(rcDepthMap_d, rcDepthMap_p, nx, ny);
+
+            if(fabsf(pixDepth - depth) >= pixSize)
+                continue;
+
+            // only the first T camera pixel supporting the R camera pixel increments the counter
+            if(atomicExch(get2DBufferAt(inout_tcStampMap_d, inout_tcStampMap_p, nx, ny), tcStamp) != tcStamp)
+                atomicAdd(get2DBufferAt(inout_nbConsistentCamsMap_d, inout_nbConsistentCamsMap_p, nx, ny), 1);
+        }
+    }
+}
+
+/**
+ * @brief Filter the R camera depth/sim map according to its number of consistent cameras.
+ * @see Fuser::filterDepthMapsRC
+ *
+ * @param[in,out] inout_depthMap_d the R camera depth map buffer
+ * @param[in] inout_depthMap_p the R camera depth map buffer pitch
+ * @param[in,out] inout_simMap_d the R camera similarity map buffer
+ * @param[in] inout_simMap_p the R camera similarity map buffer pitch
+ * @param[in] in_nbConsistentCamsMap_d the number of consistent cameras of each R camera pixel buffer
+ * @param[in] in_nbConsistentCamsMap_p the number of consistent cameras of each R camera pixel buffer pitch
+ * @param[in] width the R camera depth map width
+ * @param[in] height the R camera depth map height
+ * @param[in] minNumOfModals the minimal number of consistent cameras
+ * @param[in] minNumOfModalsWSP2SSP the minimal number of consistent cameras of a weakly supported pixel to be strongly supported
+ */
+__global__ void depthMapFilter_filterByConsistentCams_kernel(float* inout_depthMap_d, int inout_depthMap_p,
+                                                             float* inout_simMap_d, int inout_simMap_p,
+                                                             const int* in_nbConsistentCamsMap_d, int in_nbConsistentCamsMap_p,
+                                                             int width,
+                                                             int height,
+                                                             int minNumOfModals,
+                                                             int minNumOfModalsWSP2SSP)
+{
+    const int x = blockIdx.x * blockDim.x + threadIdx.x;
+    const int y = blockIdx.y * blockDim.y + threadIdx.y;
+
+    if(x >= width || y >= height)
+        return;
+
+    float& depth = *get2DBufferAt(inout_depthMap_d, inout_depthMap_p, x, y);
+    float& sim = *get2DBufferAt(inout_simMap_d, inout_simMap_p, x, y);
+    const int nbConsistentCams = *get2DBufferAt(in_nbConsistentCamsMap_d, in_nbConsistentCamsMap_p, x, y);
+
+    // the pixel is part of a mask (alpha)
+    if(depth <= -2.0f)
+        return;
+
+    // weakly supported pixel consistent in enough cameras, make it strongly supported
+    if((nbConsistentCams >= minNumOfModalsWSP2SSP - 1) && (sim >= 1.0f))
+        sim -= 2.0f;
+
+    // weakly supported pixel must be consistent in at least two cameras
+    if((nbConsistentCams <= 1) && (sim >= 1.0f))
+    {
+        depth = -1.0f;
+        sim = 1.0f;
+    }
+
+    // strongly supported pixel not consistent in the minimal number of cameras
+    if((nbConsistentCams < minNumOfModals - 1) && (sim < 1.0f))
+    {
+        depth = -1.0f;
+        sim = 1.0f;
+    }
+}
+
+} // namespace depthMap
+} // namespace aliceVision
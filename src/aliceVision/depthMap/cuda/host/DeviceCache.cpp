@@ -11,11 +11,100 @@
 #include <aliceVision/depthMap/cuda/host/utils.hpp>
 #include <aliceVision/depthMap/cuda/imageProcessing/deviceGaussianFilter.hpp>
 
+#include <boost/filesystem.hpp>
+
+#include <cstdint>
+#include <fstream>
+
 #define DEVICE_MAX_DOWNSCALE  ( MAX_CONSTANT_GAUSS_SCALES - 1 ) // maximum pre-computed Gaussian scales
 
+namespace fs = boost::filesystem;
+
 namespace aliceVision {
 namespace depthMap {
 
+namespace {
+
+/**
+ * @brief Preprocessed frame file header.
+ */
+struct DiskCacheFrameHeader
+{
+    std::uint32_t magic = 0x43445641; // "AVDC"
+    std::uint32_t version = 1;
+    std::uint32_t elementSize = sizeof(CudaRGBA);
+    std::int32_t originalWidth = 0;
+    std::int32_t originalHeight = 0;
+    std::int32_t width = 0;
+    std::int32_t height = 0;
+};
+
+std::string getDiskCacheFramePath(const std::string& diskCacheFolder, int globalCamId, int downscale, const mvsUtils::MultiViewParams& mp)
+{
+    const std::string filename = std::to_string(mp.getViewId(globalCamId)) + "_" + std::to_string(mp.getProcessDownscale()) + "_" + std::to_string(downscale) + ".bin";
+    return (fs::path(diskCacheFolder) / filename).string();
+}
+
+bool readDiskCacheFrame(const std::string& path,
+                        const std::string& imagePath,
+                        int downscale,
+                        int& out_originalWidth,
+                        int& out_originalHeight,
+                        CudaHostMemoryHeap<CudaRGBA, 2>& out_frame_hmh)
+{
+    if(!fs::exists(path))
+        return false;
+
+    // the preprocessed frame is outdated if the image has been modified after it
+    if(fs::exists(imagePath) && fs::last_write_time(imagePath) > fs::last_write_time(path))
+        return false;
+
+    std::ifstream file(path, std::ios::binary);
+    DiskCacheFrameHeader header;
+    const DiskCacheFrameHeader expectedHeader;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+    if(!file || header.magic != expectedHeader.magic || header.version != expectedHeader.version ||
+       header.elementSize != expectedHeader.elementSize ||
+       header.width != header.originalWidth / downscale || header.height != header.originalHeight / downscale)
+        return false;
+
+    out_originalWidth = header.originalWidth;
+    out_originalHeight = header.originalHeight;
+    out_frame_hmh.allocate(CudaSize<2>(header.width, header.height));
+    file.read(reinterpret_cast<char*>(out_frame_hmh.getBytePtr()), out_frame_hmh.getBytesUnpadded());
+
+    return bool(file);
+}
+
+void writeDiskCacheFrame(const std::string& path, int originalWidth, int originalHeight, const CudaHostMemoryHeap<CudaRGBA, 2>& frame_hmh)
+{
+    DiskCacheFrameHeader header;
+    header.originalWidth = originalWidth;
+    header.originalHeight = originalHeight;
+    header.width = frame_hmh.getSize().x();
+    header.height = frame_hmh.getSize().y();
+
+    // write in a temporary file and rename it: another process can read the same frame
+    const fs::path tmpPath = fs::path(path).parent_path() / fs::unique_path("%%%%%%%%.tmp");
+    {
+        std::ofstream file(tmpPath.string(), std::ios::binary);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(frame_hmh.getBytePtr()), frame_hmh.getBytesUnpadded());
+
+        if(!file)
+        {
+            ALICEVISION_LOG_WARNING("Cannot write the preprocessed frame in the disk cache: " << path);
+            file.close();
+            fs::remove(tmpPath);
+            return;
+        }
+    }
+    fs::rename(tmpPath, path);
+}
+
+} // namespace
+
 float3 M3x3mulV3(const float* M3x3, const float3& V)
 {
     return make_float3(M3x3[0] * V.x + M3x3[3] * V.y + M3x3[6] * V.z, 
@@ -144,8 +233,9 @@ void fillHostCameraParameters(DeviceCameraParams& cameraParameters_h, int global
     initCameraMatrix(cameraParameters_h);
 }
 
-DeviceCache::SingleDeviceCache::SingleDeviceCache(int maxNbCameras)
+DeviceCache::SingleDeviceCache::SingleDeviceCache(int maxNbCameras, const std::string& diskCacheFolder)
     : cameraCache(maxNbCameras)
+    , diskCacheFolder(diskCacheFolder)
 {
     // get the current device id
     const int cudaDeviceId = getCudaDeviceId();
@@ -158,6 +248,9 @@ DeviceCache::SingleDeviceCache::SingleDeviceCache(int maxNbCameras)
     if(maxNbCameras > ALICEVISION_DEVICE_MAX_CONSTANT_CAMERA_PARAM_SETS)
         ALICEVISION_THROW_ERROR("Cannot initialize device cache with more than " << ALICEVISION_DEVICE_MAX_CONSTANT_CAMERA_PARAM_SETS << " cameras (device id: " << cudaDeviceId << ", cameras: " << maxNbCameras << ").")
 
+    if(!diskCacheFolder.empty() && !fs::exists(diskCacheFolder))
+        fs::create_directories(diskCacheFolder);
+
     // initialize cached camera containers
     cameras.reserve(maxNbCameras);
     for(int i = 0; i < maxNbCameras; ++i)
@@ -178,13 +271,13 @@ void DeviceCache::clear()
         _cachePerDevice.erase(it);
 }
 
-void DeviceCache::buildCache(int maxNbCameras)
+void DeviceCache::buildCache(int maxNbCameras, const std::string& diskCacheFolder)
 {
     // get the current device id
     const int cudaDeviceId = getCudaDeviceId();
 
     // reset the current device cache
-    _cachePerDevice[cudaDeviceId].reset(new SingleDeviceCache(maxNbCameras));
+    _cachePerDevice[cudaDeviceId].reset(new SingleDeviceCache(maxNbCameras, diskCacheFolder));
 }
 
 void DeviceCache::addCamera(int globalCamId, int downscale, mvsUtils::ImagesCache<image::Image<image::RGBAfColor>>& imageCache, const mvsUtils::MultiViewParams& mp)
@@ -222,6 +315,27 @@ void DeviceCache::addCamera(int globalCamId, int downscale, mvsUtils::ImagesCach
       ALICEVISION_LOG_TRACE("Add camera on device cache (id: " << globalCamId << ", view id: " << viewId << ", downscale: " << downscale << ")."
                             << "Replace camera (id: " << deviceCamera.getGlobalCamId() << ", view id: " << mp.getViewId(deviceCamera.getGlobalCamId()) << ", downscale: " << deviceCamera.getDownscale() << ")");
 
+    // build host-side device camera parameters struct
+    DeviceCameraParams cameraParameters_h;
+    fillHostCameraParameters(cameraParameters_h, globalCamId, downscale, mp);
+
+    // try to upload the preprocessed frame from the disk cache
+    const bool useDiskCache = !currentDeviceCache.diskCacheFolder.empty();
+    const std::string diskCacheFramePath = useDiskCache ? getDiskCacheFramePath(currentDeviceCache.diskCacheFolder, globalCamId, downscale, mp) : std::string();
+
+    if(useDiskCache)
+    {
+        int originalWidth, originalHeight;
+        CudaHostMemoryHeap<CudaRGBA, 2> preprocessedFrame_hmh;
+
+        if(readDiskCacheFrame(diskCacheFramePath, mp.getImagePath(globalCamId), downscale, originalWidth, originalHeight, preprocessedFrame_hmh))
+        {
+            ALICEVISION_LOG_TRACE("Add camera on device cache: Preprocessed frame found in disk cache (id: " << globalCamId << ", view id: " << viewId << ", downscale: " << downscale << ").");
+            deviceCamera.fillPreprocessed(globalCamId, downscale, originalWidth, originalHeight, preprocessedFrame_hmh, cameraParameters_h);
+            return;
+        }
+    }
+
     mvsUtils::ImagesCache<image::Image<image::RGBAfColor>>::ImgSharedPtr img = imageCache.getImg_sync(globalCamId);
 
     // allocate the frame full size host-sided data buffer
@@ -252,12 +366,16 @@ void DeviceCache::addCamera(int globalCamId, int downscale, mvsUtils::ImagesCach
         }
     }
 
-    // build host-side device camera parameters struct
-    DeviceCameraParams cameraParameters_h;
-    fillHostCameraParameters(cameraParameters_h, globalCamId, downscale, mp);
-
     // update device camera
     deviceCamera.fill(globalCamId, downscale, originalFrameSize.x(), originalFrameSize.y(), frame_hmh, cameraParameters_h);
+
+    // write the preprocessed frame in the disk cache for the next runs
+    if(useDiskCache)
+    {
+        CudaHostMemoryHeap<CudaRGBA, 2> preprocessedFrame_hmh;
+        deviceCamera.getPreprocessedFrame(preprocessedFrame_hmh);
+        writeDiskCacheFrame(diskCacheFramePath, originalFrameSize.x(), originalFrameSize.y(), preprocessedFrame_hmh);
+    }
 }
 
 const DeviceCamera& DeviceCache::requestCamera(int globalCamId, int downscale, const mvsUtils::MultiViewParams& mp)
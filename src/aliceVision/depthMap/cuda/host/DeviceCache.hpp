@@ -7,6 +7,7 @@
 #pragma once
 
 #include <memory>
+#include <string>
 
 #include <aliceVision/mvsUtils/MultiViewParams.hpp>
 #include <aliceVision/mvsUtils/ImagesCache.hpp>
@@ -45,8 +46,11 @@ public:
     /**
      * @brief Build the current device cache with the given maximum number of cameras.
      * @param[in] maxNbCameras the maximum number of cameras in the current device cache
+     * @param[in] diskCacheFolder the folder of the preprocessed images disk cache (empty means no disk cache)
+     * @note The disk cache keeps the camera frames as preprocessed on device (downscaled, converted into CIELAB).
+     *       A camera found in the disk cache is uploaded directly, without image decoding and device filtering.
      */
-    void buildCache(int maxNbCameras);
+    void buildCache(int maxNbCameras, const std::string& diskCacheFolder = "");
 
     /**
      * @brief Add a camera (images + parameters) in current gpu device cache.
@@ -80,11 +84,12 @@ private:
      */
     struct SingleDeviceCache 
     {
-        SingleDeviceCache(int maxNbCameras);
+        SingleDeviceCache(int maxNbCameras, const std::string& diskCacheFolder);
         ~SingleDeviceCache() = default;
 
         LRUCameraCache cameraCache; // Least Recently Used device camera id cache
         std::vector<std::unique_ptr<DeviceCamera>> cameras;
+        std::string diskCacheFolder; // preprocessed images disk cache folder
     };
 
     std::map <int, std::unique_ptr<SingleDeviceCache>> _cachePerDevice; // <cudaDeviceId, SingleDeviceCachePtr>
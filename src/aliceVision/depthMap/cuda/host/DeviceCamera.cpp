@@ -78,6 +78,45 @@ void DeviceCamera::fill(int globalCamId,
                         int originalHeight, 
                         const CudaHostMemoryHeap<CudaRGBA, 2>& frame_hmh,
                         const DeviceCameraParams& cameraParameters_h)
+{
+    // update members, parameters and device frame allocation
+    updateCamera(globalCamId, downscale, originalWidth, originalHeight, cameraParameters_h);
+
+    // update device frame
+    fillDeviceFrameFromHostFrame(frame_hmh);
+}
+
+void DeviceCamera::fillPreprocessed(int globalCamId,
+                                    int downscale,
+                                    int originalWidth,
+                                    int originalHeight,
+                                    const CudaHostMemoryHeap<CudaRGBA, 2>& preprocessedFrame_hmh,
+                                    const DeviceCameraParams& cameraParameters_h)
+{
+    // update members, parameters and device frame allocation
+    updateCamera(globalCamId, downscale, originalWidth, originalHeight, cameraParameters_h);
+
+    if(preprocessedFrame_hmh.getSize() != _frame_dmp->getSize())
+        ALICEVISION_THROW_ERROR("Invalid preprocessed frame size (camera id: " << globalCamId << ", downscale: " << downscale << ").");
+
+    // copy the preprocessed frame from host to device, no downscale and no color conversion
+    _frame_dmp->copyFrom(preprocessedFrame_hmh);
+
+    // re-build the frame associated CUDA texture object
+    buildFrameCudaTexture(*_frame_dmp.get(), &_textureObject);
+}
+
+void DeviceCamera::getPreprocessedFrame(CudaHostMemoryHeap<CudaRGBA, 2>& out_preprocessedFrame_hmh) const
+{
+    out_preprocessedFrame_hmh.allocate(_frame_dmp->getSize());
+    out_preprocessedFrame_hmh.copyFrom(*_frame_dmp);
+}
+
+void DeviceCamera::updateCamera(int globalCamId,
+                                int downscale,
+                                int originalWidth,
+                                int originalHeight,
+                                const DeviceCameraParams& cameraParameters_h)
 {
     // update members
     _globalCamId = globalCamId;
@@ -128,9 +167,6 @@ void DeviceCamera::fill(int globalCamId,
         _frame_dmp.reset(new CudaDeviceMemoryPitched<CudaRGBA, 2>(deviceFrameSize));
         _memBytes = _frame_dmp->getBytesPadded();
     }
-
-    // update device frame
-    fillDeviceFrameFromHostFrame(frame_hmh);
 }
 
 void DeviceCamera::fillDeviceFrameFromHostFrame(const CudaHostMemoryHeap<CudaRGBA, 2>& frame_hmh)
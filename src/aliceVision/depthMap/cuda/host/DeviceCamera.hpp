@@ -64,10 +64,46 @@ public:
               const CudaHostMemoryHeap<CudaRGBA, 2>& frame_hmh,
               const DeviceCameraParams& cameraParameters_h);
 
+    /**
+     * @brief Update the DeviceCamera from a new host-side preprocessed frame (downscaled and converted into CIELAB).
+     * @param[in] globalCamId the camera index in the ImagesCache / MultiViewParams
+     * @param[in] downscale the downscale applied to the preprocessed frame
+     * @param[in] originalWidth the image original width
+     * @param[in] originalHeight the image original height
+     * @param[in] preprocessedFrame_hmh the host-side preprocessed frame
+     * @param[in] cameraParameters_h the host-side camera parameters
+     */
+    void fillPreprocessed(int globalCamId,
+                          int downscale,
+                          int originalWidth,
+                          int originalHeight,
+                          const CudaHostMemoryHeap<CudaRGBA, 2>& preprocessedFrame_hmh,
+                          const DeviceCameraParams& cameraParameters_h);
+
+    /**
+     * @brief Copy the device preprocessed frame (downscaled and converted into CIELAB) in host memory.
+     * @param[out] out_preprocessedFrame_hmh the host-side preprocessed frame
+     */
+    void getPreprocessedFrame(CudaHostMemoryHeap<CudaRGBA, 2>& out_preprocessedFrame_hmh) const;
+
 private:
 
     // private methods
 
+    /**
+     * @brief Update the DeviceCamera members and parameters, allocate the device frame if needed.
+     * @param[in] globalCamId the camera index in the ImagesCache / MultiViewParams
+     * @param[in] downscale the downscale to apply on gpu
+     * @param[in] originalWidth the image original width
+     * @param[in] originalHeight the image original height
+     * @param[in] cameraParameters_h the host-side camera parameters
+     */
+    void updateCamera(int globalCamId,
+                      int downscale,
+                      int originalWidth,
+                      int originalHeight,
+                      const DeviceCameraParams& cameraParameters_h);
+
     /**
      * @brief Update the DeviceCamera frame with an host-side corresponding frame.
      * @param[in] frame_hmh the host-side corresponding frame
@@ -0,0 +1,129 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "DeviceKernelTimer.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Metrics.hpp>
+
+#include <array>
+#include <stdexcept>
+#include <string>
+
+namespace aliceVision {
+namespace depthMap {
+
+const char* EDeviceKernel_enumToString(EDeviceKernel kernel)
+{
+    switch(kernel)
+    {
+        case EDeviceKernel::SIMILARITY_VOLUME: return "similarityVolume";
+        case EDeviceKernel::SGM_OPTIMIZE:      return "sgmOptimize";
+        case EDeviceKernel::REFINE:            return "refine";
+        case EDeviceKernel::NORMAL_MAP:        return "normalMap";
+        case EDeviceKernel::GAUSSIAN_FILTER:   return "gaussianFilter";
+        case EDeviceKernel::NB_KERNELS:        break;
+    }
+    throw std::out_of_range("Invalid device kernel enum: " + std::to_string(int(kernel)));
+}
+
+bool DeviceKernelTimer::isEnabled() const
+{
+    return system::Metrics::get().isEnabled();
+}
+
+void DeviceKernelTimer::setStreamCamera(cudaStream_t stream, int rc)
+{
+    _streamCameras[stream] = rc;
+}
+
+void DeviceKernelTimer::addKernel(EDeviceKernel kernel, cudaStream_t stream, cudaEvent_t start, cudaEvent_t end)
+{
+    const auto it = _streamCameras.find(stream);
+    _kernels.push_back({kernel, (it != _streamCameras.end()) ? it->second : -1, start, end});
+}
+
+void DeviceKernelTimer::flush()
+{
+    if(_kernels.empty())
+        return;
+
+    constexpr std::size_t nbKernels = std::size_t(EDeviceKernel::NB_KERNELS);
+
+    // kernel families duration in milliseconds per R camera, -1 for the kernels without R camera
+    std::map<int, std::array<double, nbKernels>> rcDurations;
+
+    for(const TimedKernel& timedKernel : _kernels)
+    {
+        float durationMs = 0.f;
+        const cudaError_t err = cudaEventElapsedTime(&durationMs, timedKernel.start, timedKernel.end);
+        cudaEventDestroy(timedKernel.start);
+        cudaEventDestroy(timedKernel.end);
+
+        if(err != cudaSuccess)
+        {
+            ALICEVISION_LOG_WARNING("DeviceKernelTimer: Failed to read a kernel duration, " << cudaGetErrorString(err));
+            continue;
+        }
+
+        auto it = rcDurations.find(timedKernel.rc);
+        if(it == rcDurations.end())
+            it = rcDurations.emplace(timedKernel.rc, std::array<double, nbKernels>{}).first;
+        it->second.at(std::size_t(timedKernel.kernel)) += durationMs;
+    }
+    _kernels.clear();
+    _streamCameras.clear();
+
+    system::Metrics& metrics = system::Metrics::get();
+
+    for(const auto& rcDuration : rcDurations)
+    {
+        for(std::size_t k = 0; k < nbKernels; ++k)
+        {
+            const double durationMs = rcDuration.second.at(k);
+            if(durationMs <= 0.0)
+                continue;
+
+            const std::string name = std::string("depthMap.kernel.") + EDeviceKernel_enumToString(EDeviceKernel(k));
+            metrics.addCounter(name + ".totalTimeMs", durationMs);
+            if(rcDuration.first >= 0)
+                metrics.addSample(name + ".timeMsPerRc", durationMs);
+        }
+    }
+}
+
+DeviceKernelTiming::DeviceKernelTiming(EDeviceKernel kernel, cudaStream_t stream)
+    : _kernel(kernel)
+    , _stream(stream)
+{
+    if(!DeviceKernelTimer::getInstance().isEnabled())
+        return;
+
+    if(cudaEventCreate(&_start) != cudaSuccess)
+    {
+        _start = nullptr;
+        return;
+    }
+    cudaEventRecord(_start, _stream);
+}
+
+DeviceKernelTiming::~DeviceKernelTiming()
+{
+    if(_start == nullptr)
+        return;
+
+    cudaEvent_t end;
+    if(cudaEventCreate(&end) != cudaSuccess)
+    {
+        cudaEventDestroy(_start);
+        return;
+    }
+    cudaEventRecord(end, _stream);
+    DeviceKernelTimer::getInstance().addKernel(_kernel, _stream, _start, end);
+}
+
+} // namespace depthMap
+} // namespace aliceVision
@@ -0,0 +1,124 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <cuda_runtime.h>
+
+#include <map>
+#include <vector>
+
+namespace aliceVision {
+namespace depthMap {
+
+/**
+ * @brief The timed families of depth map kernels.
+ */
+enum class EDeviceKernel
+{
+    SIMILARITY_VOLUME = 0,
+    SGM_OPTIMIZE,
+    REFINE,
+    NORMAL_MAP,
+    GAUSSIAN_FILTER,
+    NB_KERNELS
+};
+
+const char* EDeviceKernel_enumToString(EDeviceKernel kernel);
+
+/*
+ * @class DeviceKernelTimer
+ * @brief This per-thread singleton measures the device duration of the kernel families with CUDA events.
+ *
+ * The kernels are only timed when the metrics are enabled.
+ * Each timed kernel is attributed to the R camera of its stream (see setStreamCamera()).
+ * The events are only read by flush(), once the device is synchronized, so the timing never stalls the streams.
+ */
+class DeviceKernelTimer
+{
+public:
+
+    /**
+     * @brief Get the kernel timer of the calling thread.
+     * @note Each GPU has its own computation thread, the timed events are never shared across devices.
+     */
+    static DeviceKernelTimer& getInstance()
+    {
+        thread_local DeviceKernelTimer instance;
+        return instance;
+    }
+
+    // Singleton, no copy constructor
+    DeviceKernelTimer(DeviceKernelTimer const&) = delete;
+
+    // Singleton, no copy operator
+    void operator=(DeviceKernelTimer const&) = delete;
+
+    /**
+     * @brief Return true if the kernels are timed.
+     */
+    bool isEnabled() const;
+
+    /**
+     * @brief Attribute the next kernels of the given stream to the given R camera.
+     * @param[in] stream the CUDA stream
+     * @param[in] rc the R camera index
+     */
+    void setStreamCamera(cudaStream_t stream, int rc);
+
+    /**
+     * @brief Add a timed kernel.
+     * @param[in] kernel the kernel family
+     * @param[in] stream the CUDA stream of the kernel
+     * @param[in] start the event recorded before the kernel
+     * @param[in] end the event recorded after the kernel
+     */
+    void addKernel(EDeviceKernel kernel, cudaStream_t stream, cudaEvent_t start, cudaEvent_t end);
+
+    /**
+     * @brief Read the timed kernels and add their duration to the metrics, then forget the stream cameras.
+     *        Each R camera adds a sample to the histogram of each of its kernel families.
+     * @note The device should be synchronized.
+     */
+    void flush();
+
+private:
+
+    DeviceKernelTimer() = default;
+
+    struct TimedKernel
+    {
+        EDeviceKernel kernel;
+        int rc;
+        cudaEvent_t start;
+        cudaEvent_t end;
+    };
+
+    std::map<cudaStream_t, int> _streamCameras;
+    std::vector<TimedKernel> _kernels;
+};
+
+/*
+ * @class DeviceKernelTiming
+ * @brief Time the kernels launched on a stream for the lifetime of the object.
+ */
+class DeviceKernelTiming
+{
+public:
+    DeviceKernelTiming(EDeviceKernel kernel, cudaStream_t stream);
+    ~DeviceKernelTiming();
+
+    DeviceKernelTiming(DeviceKernelTiming const&) = delete;
+    void operator=(DeviceKernelTiming const&) = delete;
+
+private:
+    const EDeviceKernel _kernel;
+    const cudaStream_t _stream;
+    cudaEvent_t _start = nullptr;
+};
+
+} // namespace depthMap
+} // namespace aliceVision
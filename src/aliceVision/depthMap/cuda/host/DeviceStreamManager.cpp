@@ -8,6 +8,8 @@
 
 #include<aliceVision/system/Logger.hpp>
 
+#include <algorithm>
+
 namespace aliceVision {
 namespace depthMap {
 
@@ -27,6 +29,8 @@ DeviceStreamManager::DeviceStreamManager(int nbStreams)
             _streams.at(i) = 0;
         }
     }
+
+    updateDeviceMemoryWatermark();
 }
 
 DeviceStreamManager::~DeviceStreamManager() 
@@ -50,6 +54,22 @@ cudaStream_t DeviceStreamManager::getStream(int streamIndex)
 void DeviceStreamManager::waitStream(int streamIndex)
 {
     cudaStreamSynchronize(getStream(streamIndex));
+    updateDeviceMemoryWatermark();
+}
+
+void DeviceStreamManager::updateDeviceMemoryWatermark()
+{
+    size_t availableBytes;
+    size_t totalBytes;
+
+    if(cudaMemGetInfo(&availableBytes, &totalBytes) == cudaSuccess)
+        _deviceMemoryWatermark = std::max(_deviceMemoryWatermark, totalBytes - availableBytes);
+}
+
+void DeviceStreamManager::resetDeviceMemoryWatermark()
+{
+    _deviceMemoryWatermark = 0;
+    updateDeviceMemoryWatermark();
 }
 
 } // namespace depthMap
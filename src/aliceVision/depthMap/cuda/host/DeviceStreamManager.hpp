@@ -8,6 +8,7 @@
 
 #include <cuda_runtime.h>
 
+#include <cstddef>
 #include <vector>
 
 namespace aliceVision {
@@ -56,10 +57,27 @@ public:
      */
     void waitStream(int streamIndex);
 
+    /**
+     * @brief Update the device memory watermark with the current device memory usage.
+     * @note The usage is the one of the whole device, including the other processes.
+     */
+    void updateDeviceMemoryWatermark();
+
+    /**
+     * @brief Get the maximum device memory usage since the last reset, in bytes.
+     */
+    inline std::size_t getDeviceMemoryWatermark() const { return _deviceMemoryWatermark; }
+
+    /**
+     * @brief Reset the device memory watermark to the current device memory usage.
+     */
+    void resetDeviceMemoryWatermark();
+
 private:
 
     const int _nbStreams;
     std::vector<cudaStream_t> _streams;
+    std::size_t _deviceMemoryWatermark = 0;
 };
 
 } // namespace depthMap
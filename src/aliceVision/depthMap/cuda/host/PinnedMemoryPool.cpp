@@ -0,0 +1,155 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "PinnedMemoryPool.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/depthMap/cuda/host/utils.hpp>
+
+#include <cuda_runtime.h>
+
+#include <algorithm>
+
+namespace aliceVision {
+namespace depthMap {
+
+PinnedMemoryPool::~PinnedMemoryPool()
+{
+    // the CUDA runtime may already be unloaded, errors are ignored
+    for(auto& blocksPair : _cachedBlocks)
+        for(void* ptr : blocksPair.second)
+            cudaFreeHost(ptr);
+}
+
+std::size_t PinnedMemoryPool::getSizeClass(std::size_t bytes)
+{
+    // small blocks: 4 KB granularity
+    constexpr std::size_t minSize = 4096;
+    if(bytes <= minSize)
+        return minSize;
+
+    // largest power of two lower or equal to bytes
+    std::size_t powerOfTwo = minSize;
+    while(powerOfTwo <= bytes / 2)
+        powerOfTwo *= 2;
+
+    // quarter steps between two powers of two, at most 25% of unused memory
+    const std::size_t step = powerOfTwo / 4;
+    return ((bytes + step - 1) / step) * step;
+}
+
+void* PinnedMemoryPool::allocate(std::size_t bytes)
+{
+    const std::size_t blockSize = getSizeClass(bytes);
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        ++_stats.nbAllocations;
+
+        auto it = _cachedBlocks.find(blockSize);
+        if(it != _cachedBlocks.end() && !it->second.empty())
+        {
+            void* ptr = it->second.back();
+            it->second.pop_back();
+
+            ++_stats.nbPoolHits;
+            _stats.cachedBytes -= blockSize;
+            _stats.usedBytes += blockSize;
+            return ptr;
+        }
+    }
+
+    // pinned memory accessible from all the devices
+    void* ptr = nullptr;
+    cudaError_t err = cudaHostAlloc(&ptr, blockSize, cudaHostAllocPortable);
+
+    if(err != cudaSuccess)
+    {
+        // free the cached blocks and retry
+        clear();
+        err = cudaHostAlloc(&ptr, blockSize, cudaHostAllocPortable);
+    }
+
+    THROW_ON_CUDA_ERROR(err, "Could not allocate pinned host memory in " << __FILE__ << ":" << __LINE__ << ", " << cudaGetErrorString(err));
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    ++_stats.nbPinnedAllocations;
+    _stats.usedBytes += blockSize;
+    _stats.peakBytes = std::max(_stats.peakBytes, _stats.usedBytes + _stats.cachedBytes);
+    return ptr;
+}
+
+void PinnedMemoryPool::deallocate(void* ptr, std::size_t bytes)
+{
+    if(ptr == nullptr)
+        return;
+
+    const std::size_t blockSize = getSizeClass(bytes);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _stats.usedBytes -= blockSize;
+
+    if(_stats.cachedBytes + blockSize > _maxCachedBytes)
+    {
+        cudaFreeHost(ptr);
+        return;
+    }
+
+    _cachedBlocks[blockSize].push_back(ptr);
+    _stats.cachedBytes += blockSize;
+}
+
+void PinnedMemoryPool::setMaxCachedBytes(std::size_t maxCachedBytes)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _maxCachedBytes = maxCachedBytes;
+    freeCachedBlocks(_maxCachedBytes);
+}
+
+void PinnedMemoryPool::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    freeCachedBlocks(0);
+}
+
+void PinnedMemoryPool::freeCachedBlocks(std::size_t maxCachedBytes)
+{
+    // free the largest blocks first
+    for(auto it = _cachedBlocks.rbegin(); it != _cachedBlocks.rend() && _stats.cachedBytes > maxCachedBytes; ++it)
+    {
+        std::vector<void*>& blocks = it->second;
+        while(!blocks.empty() && _stats.cachedBytes > maxCachedBytes)
+        {
+            cudaFreeHost(blocks.back());
+            blocks.pop_back();
+            _stats.cachedBytes -= it->first;
+        }
+    }
+}
+
+PinnedMemoryPool::Stats PinnedMemoryPool::getStats() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+}
+
+void PinnedMemoryPool::logStats() const
+{
+    const Stats stats = getStats();
+    const double toMB = 1.0 / (1024.0 * 1024.0);
+
+    ALICEVISION_LOG_INFO("Pinned host memory pool:" << std::endl
+                         << "\t- # block requests: " << stats.nbAllocations << " (served by the pool: " << stats.nbPoolHits << ")" << std::endl
+                         << "\t- # pinned allocations: " << stats.nbPinnedAllocations << std::endl
+                         << "\t- used: " << stats.usedBytes * toMB << " MB" << std::endl
+                         << "\t- cached: " << stats.cachedBytes * toMB << " MB" << std::endl
+                         << "\t- peak: " << stats.peakBytes * toMB << " MB");
+}
+
+} // namespace depthMap
+} // namespace aliceVision
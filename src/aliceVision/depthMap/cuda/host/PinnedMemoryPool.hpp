@@ -0,0 +1,113 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace aliceVision {
+namespace depthMap {
+
+/*
+ * @class PinnedMemoryPool
+ * @brief This singleton keeps the released pinned host memory blocks for reuse.
+ *        Pinned allocations are slow and fragment the host memory, the blocks are
+ *        rounded up to size classes and shared by all the threads (gpu devices and streams).
+ */
+class PinnedMemoryPool
+{
+public:
+
+    /*
+     * @struct Stats
+     * @brief Pinned memory pool usage statistics.
+     */
+    struct Stats
+    {
+        std::size_t nbAllocations = 0;       // number of block requests
+        std::size_t nbPoolHits = 0;          // number of requests served by a cached block
+        std::size_t nbPinnedAllocations = 0; // number of pinned memory allocations
+        std::size_t usedBytes = 0;           // bytes in blocks currently in use
+        std::size_t cachedBytes = 0;         // bytes in cached blocks, available for reuse
+        std::size_t peakBytes = 0;           // maximum of used + cached bytes
+    };
+
+    static PinnedMemoryPool& getInstance()
+    {
+        static PinnedMemoryPool instance;
+        return instance;
+    }
+
+    // Singleton, no copy constructor
+    PinnedMemoryPool(PinnedMemoryPool const&) = delete;
+
+    // Singleton, no copy operator
+    void operator=(PinnedMemoryPool const&) = delete;
+
+    /**
+     * @brief Get a pinned host memory block.
+     * @param[in] bytes the requested size
+     * @return the block pointer (the block can be larger than requested)
+     */
+    void* allocate(std::size_t bytes);
+
+    /**
+     * @brief Give a block back to the pool.
+     * @param[in] ptr the block pointer
+     * @param[in] bytes the size requested for this block
+     */
+    void deallocate(void* ptr, std::size_t bytes);
+
+    /**
+     * @brief Set the maximum size of the cached blocks, larger released blocks are freed.
+     * @param[in] maxCachedBytes the maximum size of the cached blocks
+     */
+    void setMaxCachedBytes(std::size_t maxCachedBytes);
+
+    /**
+     * @brief Free all the cached blocks.
+     */
+    void clear();
+
+    /**
+     * @brief Get the pool usage statistics.
+     * @return the pool statistics
+     */
+    Stats getStats() const;
+
+    /**
+     * @brief Log the pool usage statistics.
+     */
+    void logStats() const;
+
+    /**
+     * @brief Get the size class of a requested size: the next value of the form 2^k * (1 + i/4).
+     * @param[in] bytes the requested size
+     * @return the block size
+     */
+    static std::size_t getSizeClass(std::size_t bytes);
+
+private:
+
+    // Singleton, private default constructor
+    PinnedMemoryPool() = default;
+
+    // Singleton, private destructor, free the cached blocks
+    ~PinnedMemoryPool();
+
+    void freeCachedBlocks(std::size_t maxCachedBytes);
+
+    std::map<std::size_t, std::vector<void*>> _cachedBlocks; // <size class, free blocks>
+    std::size_t _maxCachedBytes = std::size_t(4) * 1024 * 1024 * 1024;
+    Stats _stats;
+    mutable std::mutex _mutex;
+};
+
+} // namespace depthMap
+} // namespace aliceVision
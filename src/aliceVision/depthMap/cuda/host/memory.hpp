@@ -16,7 +16,9 @@
 #endif
 
 #include <aliceVision/depthMap/cuda/host/utils.hpp>
+#include <aliceVision/depthMap/cuda/host/PinnedMemoryPool.hpp>
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/MemoryTracker.hpp>
 
 #include <cuda_runtime.h>
 
@@ -181,6 +183,20 @@ CudaSize<Dim> operator-(const CudaSize<Dim> &lhs, const CudaSize<Dim> &rhs) {
   return out;
 }
 
+/**
+ * @brief Estimate the number of bytes of a pitched device buffer, without allocating it.
+ * @note The rows are padded to 512 bytes, the usual pitch alignment of cudaMallocPitch and cudaMalloc3D.
+ */
+template <class Type, unsigned Dim>
+inline size_t estimateBytesPadded(const CudaSize<Dim>& size)
+{
+    const size_t pitchAlignment = 512;
+    size_t bytes = ((size[0] * sizeof(Type) + pitchAlignment - 1) / pitchAlignment) * pitchAlignment;
+    for(unsigned i = 1; i < Dim; ++i)
+        bytes *= size[i];
+    return bytes;
+}
+
 /*********************************************************************************
  * CudaMemorySizeBase
  *********************************************************************************/
@@ -320,9 +336,19 @@ protected:
  * CudaHostMemoryHeap
  *********************************************************************************/
 
+/**
+ * @brief The pinned host memory requested by the CudaHostMemoryHeap buffers.
+ */
+inline system::AllocationCounter& cudaHostMemoryHeapAllocations()
+{
+    static system::AllocationCounter counter("CudaHostMemoryHeap");
+    return counter;
+}
+
 template <class Type, unsigned Dim> class CudaHostMemoryHeap : public CudaMemorySizeBase<Type,Dim>
 {
     Type* buffer = nullptr;
+    size_t bufferBytes = 0; // size requested to the pinned memory pool
 public:
     CudaHostMemoryHeap( )
         : buffer( nullptr )
@@ -414,18 +440,24 @@ private:
 public:
     void allocate( const CudaSize<Dim> &size )
     {
-        this->setSize( size, true );
+        // give the previous buffer back to the pool
+        deallocate();
 
-        cudaError_t err = cudaMallocHost( &buffer, this->getBytesUnpadded() );
+        this->setSize( size, true );
 
-        THROW_ON_CUDA_ERROR( err, "Could not allocate pinned host memory in " << __FILE__ << ":" << __LINE__ << ", " << cudaGetErrorString(err) );
+        // pinned memory blocks are reused through the process-wide pool
+        bufferBytes = this->getBytesUnpadded();
+        buffer = static_cast<Type*>( PinnedMemoryPool::getInstance().allocate( bufferBytes ) );
+        cudaHostMemoryHeapAllocations().add( bufferBytes );
     }
 
     void deallocate( )
     {
         if( buffer == nullptr ) return;
-        cudaFreeHost(buffer);
+        PinnedMemoryPool::getInstance().deallocate( buffer, bufferBytes );
+        cudaHostMemoryHeapAllocations().remove( bufferBytes );
         buffer = nullptr;
+        bufferBytes = 0;
     }
 };
 
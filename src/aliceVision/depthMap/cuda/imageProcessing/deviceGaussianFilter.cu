@@ -7,6 +7,7 @@
 #include "deviceGaussianFilter.hpp"
 
 #include <aliceVision/depthMap/cuda/host/divUp.hpp>
+#include <aliceVision/depthMap/cuda/host/DeviceKernelTimer.hpp>
 #include <aliceVision/depthMap/cuda/host/memory.hpp>
 #include <aliceVision/depthMap/cuda/device/buffer.cuh>
 #include <aliceVision/depthMap/cuda/device/operators.cuh>
@@ -273,6 +274,8 @@ __host__ void cuda_downscaleWithGaussianBlur(CudaDeviceMemoryPitched<CudaRGBA, 2
                                              int gaussRadius,
                                              cudaStream_t stream)
 {
+    const DeviceKernelTiming kernelTiming(EDeviceKernel::GAUSSIAN_FILTER, stream);
+
     const dim3 block(32, 2, 1);
     const dim3 grid(divUp(downscaleFrameWidth, block.x), divUp(downscaleFrameHeight, block.y), 1);
 
@@ -290,6 +293,8 @@ __host__ void cuda_downscaleWithGaussianBlur(CudaDeviceMemoryPitched<CudaRGBA, 2
 
 __host__ void cuda_gaussianBlurVolumeZ(CudaDeviceMemoryPitched<float, 3>& inout_volume_dmp, int gaussRadius, cudaStream_t stream)
 {
+    const DeviceKernelTiming kernelTiming(EDeviceKernel::GAUSSIAN_FILTER, stream);
+
     const CudaSize<3>& volDim = inout_volume_dmp.getSize();
     CudaDeviceMemoryPitched<float, 3> volSmoothZ_dmp(volDim);
 
@@ -315,6 +320,8 @@ __host__ void cuda_gaussianBlurVolumeZ(CudaDeviceMemoryPitched<float, 3>& inout_
 
 __host__ void cuda_gaussianBlurVolumeXYZ(CudaDeviceMemoryPitched<float, 3>& inout_volume_dmp, int gaussRadius, cudaStream_t stream)
 {
+    const DeviceKernelTiming kernelTiming(EDeviceKernel::GAUSSIAN_FILTER, stream);
+
     const CudaSize<3>& volDim = inout_volume_dmp.getSize();
     CudaDeviceMemoryPitched<float, 3> volSmoothXYZ_dmp(volDim);
 
@@ -8,6 +8,7 @@
 #include "deviceNormalMapKernels.cuh"
 
 #include <aliceVision/depthMap/cuda/host/divUp.hpp>
+#include <aliceVision/depthMap/cuda/host/DeviceKernelTimer.hpp>
 
 namespace aliceVision {
 namespace depthMap {
@@ -19,7 +20,7 @@ __host__ void cuda_computeNormalMap(DeviceNormalMapper* mapping,
                                     float gammaC, 
                                     float gammaP)
 {
-  const DeviceCameraParams* cameraParameters_d = mapping->cameraParameters_d;
+    const DeviceKernelTiming kernelTiming(EDeviceKernel::NORMAL_MAP, 0);
 
   CudaDeviceMemoryPitched<float, 2>  depthMap_dmp(CudaSize<2>( width, height ));
   depthMap_dmp.copyFrom( mapping->getDepthMapHst(), width, height );
@@ -32,7 +33,7 @@ __host__ void cuda_computeNormalMap(DeviceNormalMapper* mapping,
 
   // compute normal map
   computeNormalMap_kernel<<<grid, block>>>(
-    *cameraParameters_d,
+    *mapping->cameraParameters_h,
     depthMap_dmp.getBuffer(),
     depthMap_dmp.getPitch(),
     normalMap_dmp.getBuffer(),
@@ -45,6 +46,36 @@ __host__ void cuda_computeNormalMap(DeviceNormalMapper* mapping,
   CHECK_CUDA_ERROR();
 }
 
+__host__ void cuda_depthMapComputeNormal(CudaDeviceMemoryPitched<float3, 2>& out_normalMap_dmp,
+                                         const CudaDeviceMemoryPitched<float, 2>& in_depthMap_dmp,
+                                         const DeviceCameraParams& rcCamParams,
+                                         int wsh,
+                                         cudaStream_t stream)
+{
+    const DeviceKernelTiming kernelTiming(EDeviceKernel::NORMAL_MAP, stream);
+
+    const int width = int(in_depthMap_dmp.getSize().x());
+    const int height = int(in_depthMap_dmp.getSize().y());
+
+    // default parameters
+    const float gammaC = 1.0f;
+    const float gammaP = 1.0f;
+
+    const dim3 block(8, 8, 1);
+    const dim3 grid(divUp(width, block.x), divUp(height, block.y), 1);
+
+    computeNormalMap_kernel<<<grid, block, 0, stream>>>(
+        rcCamParams,
+        in_depthMap_dmp.getBuffer(),
+        in_depthMap_dmp.getPitch(),
+        out_normalMap_dmp.getBuffer(),
+        out_normalMap_dmp.getPitch(),
+        width, height, wsh,
+        gammaC, gammaP);
+
+    CHECK_CUDA_ERROR();
+}
+
 } // namespace depthMap
 } // namespace aliceVision
 
@@ -18,6 +18,20 @@ extern void cuda_computeNormalMap(DeviceNormalMapper* mapping,
                                   float gammaC, 
                                   float gammaP);
 
+/**
+ * @brief Compute the normal map of a depth map already in device memory.
+ * @param[out] out_normalMap_dmp the output normal map, same size as the depth map
+ * @param[in] in_depthMap_dmp the input depth map
+ * @param[in] rcCamParams the R camera parameters (at the depth map scale)
+ * @param[in] wsh the half size of the neighborhood used to fit the plane (pixels)
+ * @param[in] stream the stream for gpu execution
+ */
+extern void cuda_depthMapComputeNormal(CudaDeviceMemoryPitched<float3, 2>& out_normalMap_dmp,
+                                       const CudaDeviceMemoryPitched<float, 2>& in_depthMap_dmp,
+                                       const DeviceCameraParams& rcCamParams,
+                                       int wsh,
+                                       cudaStream_t stream);
+
 } // namespace depthMap
 } // namespace aliceVision
 
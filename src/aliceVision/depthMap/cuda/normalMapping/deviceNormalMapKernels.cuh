@@ -40,7 +40,7 @@ float orientedPointPlaneDistanceNormalizedNormal(const float3& point, const floa
     return (dot(point, planeNormalNormalized) - dot(planePoint, planeNormalNormalized));
 }
 
-__global__ void computeNormalMap_kernel(const DeviceCameraParams& rcDeviceCamParams,
+__global__ void computeNormalMap_kernel(const DeviceCameraParams rcDeviceCamParams,
                                         float* depthMap_d, int depthMap_p, //cudaTextureObject_t depthsTex,
                                         float3* nmap_d, int nmap_p,
                                         int width, int height, int wsh, const float gammaC, const float gammaP)
@@ -8,6 +8,7 @@
 #include "deviceDepthSimilarityMapKernels.cuh"
 
 #include <aliceVision/depthMap/cuda/host/divUp.hpp>
+#include <aliceVision/depthMap/cuda/host/DeviceKernelTimer.hpp>
 
 #include <utility>
 
@@ -118,6 +119,8 @@ __host__ void cuda_depthSimMapComputeNormal(CudaDeviceMemoryPitched<float3, 2>&
                                             const ROI& roi,
                                             cudaStream_t stream)
 {
+    const DeviceKernelTiming kernelTiming(EDeviceKernel::NORMAL_MAP, stream);
+
     // default parameters
     const int wsh = 4;
     const float gammaC = 1.0f;
@@ -151,6 +154,8 @@ __host__ void cuda_depthSimMapOptimizeGradientDescent(CudaDeviceMemoryPitched<fl
                                                       const ROI& roi,
                                                       cudaStream_t stream)
 {
+    const DeviceKernelTiming kernelTiming(EDeviceKernel::REFINE, stream);
+
     // initialize depth/sim map optimized with SGM depth/pixSize map
     out_optimizeDepthSimMap_dmp.copyFrom(in_sgmDepthPixSizeMap_dmp, stream);
 
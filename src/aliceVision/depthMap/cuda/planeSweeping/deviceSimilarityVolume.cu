@@ -8,7 +8,9 @@
 #include "deviceSimilarityVolumeKernels.cuh"
 
 #include <aliceVision/depthMap/cuda/host/divUp.hpp>
+#include <aliceVision/depthMap/cuda/host/DeviceKernelTimer.hpp>
 
+#include <algorithm>
 #include <map>
 
 namespace aliceVision {
@@ -96,6 +98,9 @@ __host__ void cuda_volumeUpdateUninitializedSimilarity(const CudaDeviceMemoryPit
 __host__ void cuda_volumeComputeSimilarity(CudaDeviceMemoryPitched<TSim, 3>& out_volBestSim_dmp,
                                            CudaDeviceMemoryPitched<TSim, 3>& out_volSecBestSim_dmp,
                                            const CudaDeviceMemoryPitched<float, 2>& in_depths_dmp,
+                                           const CudaDeviceMemoryPitched<int2, 2>* in_depthBands_dmpPtr,
+                                           int depthBandsStep,
+                                           const ROI& depthBandsRoi,
                                            const DeviceCamera& rcDeviceCamera, 
                                            const DeviceCamera& tcDeviceCamera,
                                            const SgmParams& sgmParams,
@@ -103,6 +108,8 @@ __host__ void cuda_volumeComputeSimilarity(CudaDeviceMemoryPitched<TSim, 3>& out
                                            const ROI& roi,
                                            cudaStream_t stream)
 {
+    const DeviceKernelTiming kernelTiming(EDeviceKernel::SIMILARITY_VOLUME, stream);
+
     const dim3 block(32, 1, 1); // minimal default settings
     const dim3 grid(divUp(roi.width(), block.x), divUp(roi.height(), block.y), depthRange.size());
 
@@ -121,6 +128,10 @@ __host__ void cuda_volumeComputeSimilarity(CudaDeviceMemoryPitched<TSim, 3>& out
         sgmParams.stepXY,
         in_depths_dmp.getBuffer(), 
         in_depths_dmp.getBytesPaddedUpToDim(0), 
+        (in_depthBands_dmpPtr == nullptr) ? nullptr : in_depthBands_dmpPtr->getBuffer(),
+        (in_depthBands_dmpPtr == nullptr) ? 0 : in_depthBands_dmpPtr->getBytesPaddedUpToDim(0),
+        depthBandsStep,
+        depthBandsRoi,
         out_volBestSim_dmp.getBuffer(),
         out_volBestSim_dmp.getBytesPaddedUpToDim(1),
         out_volBestSim_dmp.getBytesPaddedUpToDim(0),
@@ -143,6 +154,8 @@ extern void cuda_volumeRefineSimilarity(CudaDeviceMemoryPitched<TSimRefine, 3>&
                                         const ROI& roi,
                                         cudaStream_t stream)
 {
+    const DeviceKernelTiming kernelTiming(EDeviceKernel::SIMILARITY_VOLUME, stream);
+
     const dim3 block(32, 1, 1); // minimal default settings
     const dim3 grid(divUp(roi.width(), block.x), divUp(roi.height(), block.y), depthRange.size());
 
@@ -173,6 +186,67 @@ extern void cuda_volumeRefineSimilarity(CudaDeviceMemoryPitched<TSimRefine, 3>&
     CHECK_CUDA_ERROR();
 }
 
+__host__ void cuda_volumeRefineSimilarityMultiTc(CudaDeviceMemoryPitched<TSimRefine, 3>& out_volSim_dmp,
+                                                 const CudaDeviceMemoryPitched<float2, 2>& in_sgmDepthPixSizeMap_dmp,
+                                                 const CudaDeviceMemoryPitched<float3, 2>* in_sgmNormalMap_dmpPtr,
+                                                 const DeviceCamera& rcDeviceCamera,
+                                                 const std::vector<const DeviceCamera*>& tcDeviceCameras,
+                                                 const RefineParams& refineParams,
+                                                 const Range& depthRange,
+                                                 const ROI& roi,
+                                                 cudaStream_t stream)
+{
+    const DeviceKernelTiming kernelTiming(EDeviceKernel::SIMILARITY_VOLUME, stream);
+
+    const dim3 block(32, 1, 1); // minimal default settings
+    const dim3 grid(divUp(roi.width(), block.x), divUp(roi.height(), block.y), depthRange.size());
+
+    // the first launch writes the volume, even without T camera
+    const int nbTCams = int(tcDeviceCameras.size());
+    const int nbLaunches = std::max(1, int(divUp(nbTCams, ALICEVISION_DEVICE_REFINE_MAX_TCAMS_PER_LAUNCH)));
+
+    for(int l = 0; l < nbLaunches; ++l)
+    {
+        const int firstTc = l * ALICEVISION_DEVICE_REFINE_MAX_TCAMS_PER_LAUNCH;
+
+        DeviceRefineTCams tcams;
+        tcams.nbTCams = std::min(nbTCams - firstTc, ALICEVISION_DEVICE_REFINE_MAX_TCAMS_PER_LAUNCH);
+
+        for(int i = 0; i < tcams.nbTCams; ++i)
+        {
+            const DeviceCamera& tcDeviceCamera = *tcDeviceCameras.at(firstTc + i);
+            tcams.tex[i] = tcDeviceCamera.getTextureObject();
+            tcams.deviceCamId[i] = tcDeviceCamera.getDeviceCamId();
+            tcams.width[i] = tcDeviceCamera.getWidth();
+            tcams.height[i] = tcDeviceCamera.getHeight();
+        }
+
+        volume_refineMultiTc_kernel<<<grid, block, 0, stream>>>(
+            rcDeviceCamera.getTextureObject(),
+            rcDeviceCamera.getDeviceCamId(),
+            rcDeviceCamera.getWidth(),
+            rcDeviceCamera.getHeight(),
+            tcams,
+            int(out_volSim_dmp.getSize().z()),
+            refineParams.stepXY,
+            refineParams.wsh,
+            float(refineParams.gammaC),
+            float(refineParams.gammaP),
+            in_sgmDepthPixSizeMap_dmp.getBuffer(),
+            in_sgmDepthPixSizeMap_dmp.getBytesPaddedUpToDim(0),
+            (in_sgmNormalMap_dmpPtr == nullptr) ? nullptr : in_sgmNormalMap_dmpPtr->getBuffer(),
+            (in_sgmNormalMap_dmpPtr == nullptr) ? 0 : in_sgmNormalMap_dmpPtr->getBytesPaddedUpToDim(0),
+            out_volSim_dmp.getBuffer(),
+            out_volSim_dmp.getBytesPaddedUpToDim(1),
+            out_volSim_dmp.getBytesPaddedUpToDim(0),
+            l > 0 /* accumulate */,
+            depthRange,
+            roi);
+    }
+
+    CHECK_CUDA_ERROR();
+}
+
 
 __host__ void cuda_volumeAggregatePath(CudaDeviceMemoryPitched<TSim, 3>& out_volAgr_dmp,
                                        CudaDeviceMemoryPitched<TSimAcc, 2>& inout_volSliceAccA_dmp,
@@ -282,6 +356,96 @@ __host__ void cuda_volumeAggregatePath(CudaDeviceMemoryPitched<TSim, 3>& out_vol
     CHECK_CUDA_ERROR();
 }
 
+__host__ void cuda_volumeAggregatePathFused(CudaDeviceMemoryPitched<TSim, 3>& out_volAgr_dmp,
+                                            CudaDeviceMemoryPitched<TSimAcc, 2>& inout_volSliceAccA_dmp,
+                                            CudaDeviceMemoryPitched<TSimAcc, 2>& inout_volSliceAccB_dmp,
+                                            CudaDeviceMemoryPitched<TSimAcc, 2>& inout_volAxisAcc_dmp,
+                                            const CudaDeviceMemoryPitched<TSim, 3>& in_volSim_dmp,
+                                            const CudaSize<3>& axisT,
+                                            const DeviceCamera& rcDeviceCamera,
+                                            const SgmParams& sgmParams,
+                                            int lastDepthIndex,
+                                            int filteringIndex,
+                                            bool invY,
+                                            const ROI& roi,
+                                            cudaStream_t stream)
+{
+    assert(inout_volAxisAcc_dmp.getSize().y() >= 3);
+
+    CudaSize<3> volDim = in_volSim_dmp.getSize();
+    volDim[2] = lastDepthIndex; // override volume depth, use rc depth list last index
+
+    const size_t volDimX = volDim[axisT[0]];
+    const size_t volDimY = volDim[axisT[1]];
+    const size_t volDimZ = volDim[axisT[2]];
+
+    const int3 volDim_ = make_int3(volDim[0], volDim[1], volDim[2]);
+    const int3 axisT_ = make_int3(axisT[0], axisT[1], axisT[2]);
+    const int ySign = (invY ? -1 : 1);
+
+    // setup block and grid
+    const dim3 block(SGM_FUSED_BLOCK_X, SGM_FUSED_BLOCK_Z, 1);
+    const dim3 grid(divUp(volDimX, block.x), divUp(volDimZ, block.y), 1);
+
+    CudaDeviceMemoryPitched<TSimAcc, 2>* xzSliceForY_dmpPtr   = &inout_volSliceAccA_dmp; // Y slice
+    CudaDeviceMemoryPitched<TSimAcc, 2>* xzSliceForYm1_dmpPtr = &inout_volSliceAccB_dmp; // Y-1 slice
+
+    // best sim score along the Y axis for each Z value, 3 rows used in turn
+    const auto bestSimRow = [&](int iy) { return inout_volAxisAcc_dmp.getRow(iy % 3); };
+
+    // initialize the best sim score rows to the maximum value
+    cudaMemset2DAsync(inout_volAxisAcc_dmp.getBuffer(), inout_volAxisAcc_dmp.getPitch(), 0xFF, volDimX * sizeof(TSimAcc), 3, stream);
+
+    // copy the first XZ plane (at Y=0) from 'in_volSim_dmp' into 'xzSliceForYm1_dmpPtr'
+    // set the first Y plane from 'out_volAgr_dmp' to 255 and compute its best sim score
+    volume_initAggregatePathFused_kernel<<<grid, block, 0, stream>>>(
+        xzSliceForYm1_dmpPtr->getBuffer(),
+        xzSliceForYm1_dmpPtr->getPitch(),
+        bestSimRow(0),
+        in_volSim_dmp.getBuffer(),
+        in_volSim_dmp.getBytesPaddedUpToDim(1),
+        in_volSim_dmp.getBytesPaddedUpToDim(0),
+        out_volAgr_dmp.getBuffer(),
+        out_volAgr_dmp.getBytesPaddedUpToDim(1),
+        out_volAgr_dmp.getBytesPaddedUpToDim(0),
+        volDim_,
+        axisT_,
+        0 /* Y = 0, same first slice as cuda_volumeAggregatePath */);
+
+    for(int iy = 1; iy < volDimY; ++iy)
+    {
+        const int y = invY ? volDimY - 1 - iy : iy;
+
+        volume_aggregatePathFused_kernel<<<grid, block, 0, stream>>>(
+            rcDeviceCamera.getTextureObject(),
+            xzSliceForY_dmpPtr->getBuffer(),   // out: xzSliceForY
+            xzSliceForY_dmpPtr->getPitch(),
+            xzSliceForYm1_dmpPtr->getBuffer(), // in:  xzSliceForYm1
+            xzSliceForYm1_dmpPtr->getPitch(),
+            bestSimRow(iy - 1),                // in:  bestSimInYm1
+            bestSimRow(iy),                    // out: bestSimInY
+            bestSimRow(iy + 1),                // out: bestSimInYp1 (reset)
+            in_volSim_dmp.getBuffer(),
+            in_volSim_dmp.getBytesPaddedUpToDim(1),
+            in_volSim_dmp.getBytesPaddedUpToDim(0),
+            out_volAgr_dmp.getBuffer(),
+            out_volAgr_dmp.getBytesPaddedUpToDim(1),
+            out_volAgr_dmp.getBytesPaddedUpToDim(0),
+            volDim_, axisT_,
+            sgmParams.stepXY,
+            y,
+            sgmParams.p1,
+            sgmParams.p2Weighting,
+            ySign,
+            filteringIndex,
+            roi);
+
+        std::swap(xzSliceForYm1_dmpPtr, xzSliceForY_dmpPtr);
+    }
+
+    CHECK_CUDA_ERROR();
+}
+
 __host__ void cuda_volumeOptimize(CudaDeviceMemoryPitched<TSim, 3>& out_volSimFiltered_dmp,
                                   CudaDeviceMemoryPitched<TSimAcc, 2>& inout_volSliceAccA_dmp,
                                   CudaDeviceMemoryPitched<TSimAcc, 2>& inout_volSliceAccB_dmp,
@@ -293,23 +457,28 @@ __host__ void cuda_volumeOptimize(CudaDeviceMemoryPitched<TSim, 3>& out_volSimFi
                                   const ROI& roi,
                                   cudaStream_t stream)
 {
+    const DeviceKernelTiming kernelTiming(EDeviceKernel::SGM_OPTIMIZE, stream);
+
     // update aggregation volume
     int npaths = 0;
     const auto updateAggrVolume = [&](const CudaSize<3>& axisT, bool invX)
     {
-        cuda_volumeAggregatePath(out_volSimFiltered_dmp, 
-                                 inout_volSliceAccA_dmp, 
-                                 inout_volSliceAccB_dmp,
-                                 inout_volAxisAcc_dmp,
-                                 in_volSim_dmp, 
-                                 axisT, 
-                                 rcDeviceCamera, 
-                                 sgmParams, 
-                                 lastDepthIndex,
-                                 npaths,
-                                 invX, 
-                                 roi,
-                                 stream);
+        // fused kernel or separate kernels per slice
+        const auto aggregatePath = sgmParams.useFusedVolumeOptimization ? &cuda_volumeAggregatePathFused : &cuda_volumeAggregatePath;
+
+        aggregatePath(out_volSimFiltered_dmp, 
+                      inout_volSliceAccA_dmp, 
+                      inout_volSliceAccB_dmp,
+                      inout_volAxisAcc_dmp,
+                      in_volSim_dmp, 
+                      axisT, 
+                      rcDeviceCamera, 
+                      sgmParams, 
+                      lastDepthIndex,
+                      npaths,
+                      invX, 
+                      roi,
+                      stream);
         npaths++;
     };
 
@@ -358,6 +527,28 @@ __host__ void cuda_volumeRetrieveBestDepth(CudaDeviceMemoryPitched<float2, 2>& o
     CHECK_CUDA_ERROR();
 }
 
+__host__ void cuda_volumeRetrieveBestDepthIndex(CudaDeviceMemoryPitched<int, 2>& out_bestZIndexMap_dmp,
+                                                const CudaDeviceMemoryPitched<TSim, 3>& in_volSim_dmp,
+                                                const Range& depthRange,
+                                                const ROI& roi,
+                                                cudaStream_t stream)
+{
+    const int blockSize = 8;
+    const dim3 block(blockSize, blockSize, 1);
+    const dim3 grid(divUp(roi.width(), blockSize), divUp(roi.height(), blockSize), 1);
+
+    volume_retrieveBestZIndex_kernel<<<grid, block, 0, stream>>>(
+      out_bestZIndexMap_dmp.getBuffer(),
+      out_bestZIndexMap_dmp.getBytesPaddedUpToDim(0),
+      in_volSim_dmp.getBuffer(),
+      in_volSim_dmp.getBytesPaddedUpToDim(1),
+      in_volSim_dmp.getBytesPaddedUpToDim(0),
+      depthRange,
+      roi);
+
+    CHECK_CUDA_ERROR();
+}
+
 extern void cuda_volumeRefineBestDepth(CudaDeviceMemoryPitched<float2, 2>& out_refineDepthSimMap_dmp,
                                        const CudaDeviceMemoryPitched<float2, 2>& in_sgmDepthPixSizeMap_dmp,
                                        const CudaDeviceMemoryPitched<TSimRefine, 3>& in_volSim_dmp, 
@@ -366,6 +557,8 @@ extern void cuda_volumeRefineBestDepth(CudaDeviceMemoryPitched<float2, 2>& out_r
                                        const ROI& roi, 
                                        cudaStream_t stream)
 {
+    const DeviceKernelTiming kernelTiming(EDeviceKernel::REFINE, stream);
+
     const int scaleStep = refineParams.scale * refineParams.stepXY;
     const int halfNbSamples = refineParams.nbSubsamples * refineParams.halfNbDepths;
     const float twoTimesSigmaPowerTwo = float(2.0 * refineParams.sigma * refineParams.sigma);
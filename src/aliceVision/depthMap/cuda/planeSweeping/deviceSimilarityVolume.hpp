@@ -13,6 +13,8 @@
 #include <aliceVision/depthMap/cuda/host/DeviceCamera.hpp>
 #include <aliceVision/depthMap/cuda/planeSweeping/similarity.hpp>
 
+#include <vector>
+
 namespace aliceVision {
 namespace depthMap {
 
@@ -57,6 +59,9 @@ extern void cuda_volumeUpdateUninitializedSimilarity(const CudaDeviceMemoryPitch
  * @param[out] out_volBestSim_dmp the best similarity volume in device memory
  * @param[out] out_volSecBestSim_dmp the second best similarity volume in device memory
  * @param[in] in_depths_dmp the R camera depth list in device memory
+ * @param[in] in_depthBands_dmpPtr the per coarse pixel [first, last] depth index band in device memory (or nullptr)
+ * @param[in] depthBandsStep the coarse pixel size of the depth band map (in roi pixels)
+ * @param[in] depthBandsRoi the 2d region of interest of the depth band map
  * @param[in] rcDeviceCamera the R device camera
  * @param[in] tcDeviceCamera the T device camera
  * @param[in] sgmParams the Semi Global Matching parameters
@@ -67,6 +72,9 @@ extern void cuda_volumeUpdateUninitializedSimilarity(const CudaDeviceMemoryPitch
 extern void cuda_volumeComputeSimilarity(CudaDeviceMemoryPitched<TSim, 3>& out_volBestSim_dmp, 
                                          CudaDeviceMemoryPitched<TSim, 3>& out_volSecBestSim_dmp,
                                          const CudaDeviceMemoryPitched<float, 2>& in_depths_dmp,
+                                         const CudaDeviceMemoryPitched<int2, 2>* in_depthBands_dmpPtr,
+                                         int depthBandsStep,
+                                         const ROI& depthBandsRoi,
                                          const DeviceCamera& rcDeviceCamera, 
                                          const DeviceCamera& tcDeviceCamera, 
                                          const SgmParams& sgmParams, 
@@ -96,6 +104,31 @@ extern void cuda_volumeRefineSimilarity(CudaDeviceMemoryPitched<TSimRefine, 3>&
                                         const ROI& roi,
                                         cudaStream_t stream);
 
+/**
+ * @brief Compute the refine similarity volume for the given RC and all its TCs.
+ *        The TCs are evaluated in the same kernel launch (by chunks of ALICEVISION_DEVICE_REFINE_MAX_TCAMS_PER_LAUNCH),
+ *        each volume value is written once per launch instead of once per TC.
+ * @note The volume does not need to be initialized.
+ * @param[out] out_volSim_dmp the similarity volume in device memory
+ * @param[in] in_sgmDepthPixSizeMap_dmp the SGM upscaled depth/pixSize map (usefull to get middle depth) in device memory
+ * @param[in] in_sgmNormalMap_dmpPtr (or nullptr) the SGM upscaled normal map in device memory
+ * @param[in] rcDeviceCamera the R device camera
+ * @param[in] tcDeviceCameras the T device cameras
+ * @param[in] refineParams the Refine parameters
+ * @param[in] depthRange the volume depth range to compute
+ * @param[in] roi the 2d region of interest
+ * @param[in] stream the stream for gpu execution
+ */
+extern void cuda_volumeRefineSimilarityMultiTc(CudaDeviceMemoryPitched<TSimRefine, 3>& out_volSim_dmp,
+                                               const CudaDeviceMemoryPitched<float2, 2>& in_sgmDepthPixSizeMap_dmp,
+                                               const CudaDeviceMemoryPitched<float3, 2>* in_sgmNormalMap_dmpPtr,
+                                               const DeviceCamera& rcDeviceCamera,
+                                               const std::vector<const DeviceCamera*>& tcDeviceCameras,
+                                               const RefineParams& refineParams,
+                                               const Range& depthRange,
+                                               const ROI& roi,
+                                               cudaStream_t stream);
+
 /**
  * @brief Filter / Optimize the given similarity volume
  * @param[out] out_volSimFiltered_dmp the output similarity volume in device memory
@@ -140,6 +173,20 @@ extern void cuda_volumeRetrieveBestDepth(CudaDeviceMemoryPitched<float2, 2>& out
                                          const ROI& roi, 
                                          cudaStream_t stream);
 
+/**
+ * @brief Retrieve the best depth index in the given similarity volume.
+ * @param[out] out_bestZIndexMap_dmp the output best depth index map in device memory (-1 if no valid similarity)
+ * @param[in] in_volSim_dmp the input similarity volume in device memory
+ * @param[in] depthRange the volume depth range to search
+ * @param[in] roi the 2d region of interest
+ * @param[in] stream the stream for gpu execution
+ */
+extern void cuda_volumeRetrieveBestDepthIndex(CudaDeviceMemoryPitched<int, 2>& out_bestZIndexMap_dmp,
+                                              const CudaDeviceMemoryPitched<TSim, 3>& in_volSim_dmp,
+                                              const Range& depthRange,
+                                              const ROI& roi,
+                                              cudaStream_t stream);
+
 /**
  * @brief Retrieve the best depth/sim in the given refined similarity volume.
  * @param[out] out_refineDepthSimMap_dmp the output refined and fused depth/sim map in device memory
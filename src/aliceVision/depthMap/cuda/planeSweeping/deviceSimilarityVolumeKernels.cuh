@@ -108,6 +108,9 @@ __global__ void volume_slice_kernel(cudaTextureObject_t rcTex,
                                     const int wsh,
                                     const int stepXY,
                                     const float* in_depths_d, int in_depths_p, 
+                                    const int2* in_depthBands_d, int in_depthBands_p,
+                                    const int depthBandsStep,
+                                    const ROI depthBandsRoi,
                                     TSim* out_volume_1st_d, int out_volume1st_s, int out_volume1st_p,
                                     TSim* out_volume_2nd_d, int out_volume2nd_s, int out_volume2nd_p,
                                     const Range depthRange,
@@ -125,6 +128,19 @@ __global__ void volume_slice_kernel(cudaTextureObject_t rcTex,
     const int vy = roiY;
     const int vz = depthRange.begin + roiZ;
 
+    // skip the depths outside of the pixel depth band (if any)
+    if(in_depthBands_d != nullptr)
+    {
+        // corresponding coarse pixel of the depth bands map
+        const int bx = min(max((roi.x.begin + vx) / depthBandsStep - int(depthBandsRoi.x.begin), 0), int(depthBandsRoi.width()) - 1);
+        const int by = min(max((roi.y.begin + vy) / depthBandsStep - int(depthBandsRoi.y.begin), 0), int(depthBandsRoi.height()) - 1);
+
+        const int2 depthBand = *get2DBufferAt(in_depthBands_d, in_depthBands_p, bx, by);
+
+        if(vz < depthBand.x || vz > depthBand.y)
+            return; // pruned depth, similarity stays undefined
+    }
+
     // corresponding device image coordinates
     const int x = (roi.x.begin + vx) * stepXY;
     const int y = (roi.y.begin + vy) * stepXY;
@@ -293,6 +309,147 @@ __global__ void volume_refine_kernel(cudaTextureObject_t rcTex,
 #endif
 }
 
+/**
+ * @brief T cameras evaluated by a single refine similarity volume kernel launch.
+ * @note Passed by value as a kernel parameter.
+ */
+struct DeviceRefineTCams
+{
+    cudaTextureObject_t tex[ALICEVISION_DEVICE_REFINE_MAX_TCAMS_PER_LAUNCH];
+    int deviceCamId[ALICEVISION_DEVICE_REFINE_MAX_TCAMS_PER_LAUNCH];
+    int width[ALICEVISION_DEVICE_REFINE_MAX_TCAMS_PER_LAUNCH];
+    int height[ALICEVISION_DEVICE_REFINE_MAX_TCAMS_PER_LAUNCH];
+    int nbTCams;
+};
+
+__global__ void volume_refineMultiTc_kernel(cudaTextureObject_t rcTex,
+                                            int rcDeviceCamId,
+                                            int rcWidth, int rcHeight,
+                                            const DeviceRefineTCams tcams,
+                                            int volDimZ,
+                                            int stepXY,
+                                            int wsh,
+                                            float gammaC,
+                                            float gammaP,
+                                            const float2* in_sgmDepthPixSizeMap_d, int in_sgmDepthPixSizeMap_p,
+                                            const float3* in_sgmNormalMap_d, int in_sgmNormalMap_p,
+                                            TSimRefine* inout_volSim_d, int inout_volSim_s, int inout_volSim_p,
+                                            bool accumulate,
+                                            const Range depthRange,
+                                            const ROI roi)
+{
+    const int roiX = blockIdx.x * blockDim.x + threadIdx.x;
+    const int roiY = blockIdx.y * blockDim.y + threadIdx.y;
+    const int roiZ = blockIdx.z;
+
+    if(roiX >= roi.width() || roiY >= roi.height()) // no need to check roiZ
+        return;
+
+    // corresponding volume and depth/sim map coordinates
+    const int vx = roiX;
+    const int vy = roiY;
+    const int vz = depthRange.begin + roiZ;
+
+    // corresponding device image coordinates
+    const int x = (roi.x.begin + vx) * stepXY;
+    const int y = (roi.y.begin + vy) * stepXY;
+
+    // get output similarity pointer
+    TSimRefine* outSimPtr = get3DBufferAt(inout_volSim_d, inout_volSim_s, inout_volSim_p, vx, vy, vz);
+
+    // corresponding original plane depth
+    const float originalDepth = get2DBufferAt(in_sgmDepthPixSizeMap_d, in_sgmDepthPixSizeMap_p, vx, vy)->x; // input original middle depth
+
+    // original depth invalid or masked, similarity value remain at 0
+    if(originalDepth <= 0.0f)
+    {
+        if(!accumulate)
+            *outSimPtr = TSimRefine(0.f);
+        return;
+    }
+
+    // get rc 3d point at original depth (z center)
+    float3 p = get3DPointForPixelAndDepthFromRC(rcDeviceCamId, make_int2(x, y), originalDepth);
+
+    // move rc 3d point according to the relative depth
+    const int relativeDepthIndexOffset = vz - ((volDimZ - 1) / 2);
+    if(relativeDepthIndexOffset != 0)
+    {
+        const float pixSizeOffset = relativeDepthIndexOffset * computePixSize(rcDeviceCamId, p);
+        move3DPointByRcPixSize(rcDeviceCamId, p, pixSizeOffset);
+    }
+
+    // the patch point, size and the vector to the reference camera do not depend on the T camera
+    const float pixSize = computePixSize(rcDeviceCamId, p);
+    float3 v1 = constantCameraParametersArray_d[rcDeviceCamId].C - p;
+    normalize(v1);
+
+    // sum of the inverted and filtered similarity of each T camera
+    float simSum = 0.f;
+
+    for(int tci = 0; tci < tcams.nbTCams; ++tci)
+    {
+        const int tcDeviceCamId = tcams.deviceCamId[tci];
+
+        Patch ptch;
+        ptch.p = p;
+        ptch.d = pixSize;
+
+        // computeRotCSEpip
+        {
+          // Vector from the target camera to the 3d point
+          float3 v2 = constantCameraParametersArray_d[tcDeviceCamId].C - ptch.p;
+          normalize(v2);
+
+          // y has to be ortogonal to the epipolar plane
+          // n has to be on the epipolar plane
+          // x has to be on the epipolar plane
+
+          ptch.y = cross(v1, v2);
+          normalize(ptch.y);
+
+          if(in_sgmNormalMap_d != nullptr) // initialize patch normal from input normal map
+          {
+            ptch.n = *get2DBufferAt(in_sgmNormalMap_d, in_sgmNormalMap_p, vx, vy);
+          }
+          else // initialize patch normal from v1 & v2
+          {
+            ptch.n = (v1 + v2) / 2.0f;
+            normalize(ptch.n);
+          }
+
+          ptch.x = cross(ptch.y, ptch.n);
+          normalize(ptch.x);
+        }
+
+        // compute similarity
+        float fsim = compNCCby3DptsYK(rcTex, tcams.tex[tci], rcDeviceCamId, tcDeviceCamId, ptch, rcWidth, rcHeight, tcams.width[tci], tcams.height[tci], wsh, gammaC, gammaP);
+
+        if(fsim == 1.f || fsim == CUDART_INF_F) // infinite or invalid similarity
+        {
+            fsim = 0.0f; // 0 is the worst similarity value at this point
+        }
+
+        // invert and filter similarity between 0 and 1, see volume_refine_kernel
+        simSum += sigmoid(0.0f, 1.0f, 0.7f, -0.7f, fsim);
+    }
+
+    // write the output similarity value once for all the T cameras of the launch
+    // the addition is performed in float
+    if(accumulate)
+    {
+#ifdef TSIM_REFINE_USE_HALF
+        *outSimPtr = __float2half(__half2float(*outSimPtr) + simSum);
+#else
+        *outSimPtr += TSimRefine(simSum);
+#endif
+    }
+    else
+    {
+        *outSimPtr = TSimRefine(simSum);
+    }
+}
+
 __global__ void volume_retrieveBestZ_kernel(float2* out_sgmDepthSimMap_d, int out_sgmDepthSimMap_p,
                                             const float* in_depths_d, int in_depths_p, 
                                             const TSim* in_volSim_d, int in_volSim_s, int in_volSim_p,
@@ -371,6 +528,32 @@ __global__ void volume_retrieveBestZ_kernel(float2* out_sgmDepthSimMap_d, int ou
 #endif
 }
 
+__global__ void volume_retrieveBestZIndex_kernel(int* out_bestZIndexMap_d, int out_bestZIndexMap_p,
+                                                 const TSim* in_volSim_d, int in_volSim_s, int in_volSim_p,
+                                                 const Range depthRange,
+                                                 const ROI roi)
+{
+    const int vx = blockIdx.x * blockDim.x + threadIdx.x;
+    const int vy = blockIdx.y * blockDim.y + threadIdx.y;
+
+    if(vx >= roi.width() || vy >= roi.height())
+        return;
+
+    // find best depth index, -1 if no valid similarity
+    float bestSim = 255.0f;
+    int bestZIdx = -1;
+    for(int vz = depthRange.begin; vz < depthRange.end; ++vz)
+    {
+      const float simAtZ = *get3DBufferAt(in_volSim_d, in_volSim_s, in_volSim_p, vx, vy, vz);
+      if (simAtZ < bestSim)
+      {
+        bestSim = simAtZ;
+        bestZIdx = vz;
+      }
+    }
+
+    *get2DBufferAt(out_bestZIndexMap_d, out_bestZIndexMap_p, vx, vy) = bestZIdx;
+}
 
 __global__ void volume_refineBestZ_kernel(float2* out_refineDepthSimMap_d, int out_refineDepthSimMap_p,
                                           const float2* in_sgmDepthPixSizeMap_d, int in_sgmDepthPixSizeMap_p,
@@ -511,6 +694,42 @@ __global__ void volume_computeBestZInSlice_kernel(TSimAcc* xzSlice_d, int xzSlic
     ySliceBestInColCst_d[x] = bestCst;
 }
 
+/**
+ * @brief Compute the SGM P2 penalty of a volume position, adapted to the color difference with the previous position of the path.
+ * @note _P2 convention: use negative value to skip the use of deltaC.
+ */
+inline __device__ float volume_computeP2(cudaTextureObject_t rcTex,
+                                         const int3& v,
+                                         const int3& axisT,
+                                         float step,
+                                         float _P2,
+                                         int ySign,
+                                         const ROI& roi)
+{
+    if(_P2 < 0)
+        return std::abs(_P2);
+
+    // find texture offset
+    const int beginX = (axisT.x == 0) ? roi.x.begin : roi.y.begin;
+    const int beginY = (axisT.x == 0) ? roi.y.begin : roi.x.begin;
+
+    const int imX0 = (beginX + v.x) * step; // current
+    const int imY0 = (beginY + v.y) * step;
+
+    const int imX1 = imX0 - ySign * step * (axisT.y == 0); // M1
+    const int imY1 = imY0 - ySign * step * (axisT.y == 1);
+
+    const float4 gcr0 = tex2D_float4(rcTex, float(imX0) + 0.5f, float(imY0) + 0.5f);
+    const float4 gcr1 = tex2D_float4(rcTex, float(imX1) + 0.5f, float(imY1) + 0.5f);
+    const float deltaC = Euclidean3(gcr0, gcr1);
+
+    // sigmoid f(x) = i + (a - i) * (1 / ( 1 + e^(10 * (x - P2) / w)))
+    // see: https://www.desmos.com/calculator/1qvampwbyx
+    // best values found from tests: i = 80, a = 255, w = 80, P2 = 100
+    // historical values: i = 15, a = 255, w = 80, P2 = 20
+    return sigmoid(80.f, 255.f, 80.f, _P2, deltaC);
+}
+
 /**
  * @param[inout] xySliceForZ input similarity plane
  * @param[in] xySliceForZM1
@@ -541,40 +760,12 @@ __global__ void volume_agregateCostVolumeAtXinSlices_kernel(
     if (x >= (&volDim.x)[axisT.x] || z >= volDim.z)
         return;
 
-    // find texture offset
-    const int beginX = (axisT.x == 0) ? roi.x.begin : roi.y.begin;
-    const int beginY = (axisT.x == 0) ? roi.y.begin : roi.x.begin;
-
     TSimAcc* sim_xz = get2DBufferAt(xzSliceForY_d, xzSliceForY_p, x, z);
     float pathCost = 255.0f;
 
     if((z >= 1) && (z < volDim.z - 1))
     {
-        float P2 = 0;
-
-        if(_P2 < 0)
-        {
-          // _P2 convention: use negative value to skip the use of deltaC.
-          P2 = std::abs(_P2);
-        }
-        else
-        {
-          const int imX0 = (beginX + v.x) * step; // current
-          const int imY0 = (beginY + v.y) * step;
-
-          const int imX1 = imX0 - ySign * step * (axisT.y == 0); // M1
-          const int imY1 = imY0 - ySign * step * (axisT.y == 1);
-
-          const float4 gcr0 = tex2D_float4(rcTex, float(imX0) + 0.5f, float(imY0) + 0.5f);
-          const float4 gcr1 = tex2D_float4(rcTex, float(imX1) + 0.5f, float(imY1) + 0.5f);
-          const float deltaC = Euclidean3(gcr0, gcr1);
-
-          // sigmoid f(x) = i + (a - i) * (1 / ( 1 + e^(10 * (x - P2) / w)))
-          // see: https://www.desmos.com/calculator/1qvampwbyx
-          // best values found from tests: i = 80, a = 255, w = 80, P2 = 100
-          // historical values: i = 15, a = 255, w = 80, P2 = 20
-          P2 = sigmoid(80.f, 255.f, 80.f, _P2, deltaC);
-        }
+        const float P2 = volume_computeP2(rcTex, v, axisT, step, _P2, ySign, roi);
 
         const TSimAcc bestCostInColM1 = bestSimInYm1_d[x];
         const TSimAcc pathCostMDM1 = *get2DBufferAt(xzSliceForYm1_d, xzSliceForYm1_p, x, z - 1); // M1: minus 1 over depths
@@ -600,5 +791,184 @@ __global__ void volume_agregateCostVolumeAtXinSlices_kernel(
     *volume_xyz = TSim(val);
 }
 
+/*
+ * Fused SGM path aggregation
+ *
+ * The path is processed one slice (line of x, all z) per launch with a single kernel:
+ * - the similarity of the slice is read directly from the similarity volume (no slice copy),
+ * - the previous slice is tiled in shared memory (each value is read once for the 3 depth neighbors),
+ * - the best cost of the slice is reduced in shared memory and merged with an atomic min,
+ *   it is ready for the next slice without a dedicated kernel.
+ * Path costs are positive, the atomic min is done on the unsigned int representation (valid for float and unsigned int).
+ * The best cost buffer has 3 rows used in turn: previous slice (read), current slice (write), next slice (reset).
+ */
+
+#define SGM_FUSED_BLOCK_X 32
+#define SGM_FUSED_BLOCK_Z 8
+
+static_assert(sizeof(TSimAcc) == sizeof(unsigned int), "TSimAcc should be a 32 bits type.");
+
+inline __device__ TSimAcc volume_maxSimAcc()
+{
+    unsigned int maxCost = 0xFFFFFFFF; // maximum as unsigned int, NaN as float (ignored by the comparisons)
+    return *reinterpret_cast<TSimAcc*>(&maxCost);
+}
+
+inline __device__ void volume_atomicMinSimAcc(TSimAcc* address, TSimAcc value)
+{
+    atomicMin(reinterpret_cast<unsigned int*>(address), *reinterpret_cast<unsigned int*>(&value));
+}
+
+/**
+ * @brief Merge the best cost of each x of the block in the best cost buffer row.
+ * @note all the threads of the block should call this function
+ */
+inline __device__ void volume_blockBestCostInSlice(TSimAcc (&bestTile)[SGM_FUSED_BLOCK_Z][SGM_FUSED_BLOCK_X],
+                                                   TSimAcc cost, bool valid, bool validX, int x, TSimAcc* bestCost_d)
+{
+    bestTile[threadIdx.y][threadIdx.x] = valid ? cost : volume_maxSimAcc();
+
+    __syncthreads();
+
+    if(validX && threadIdx.y == 0)
+    {
+        TSimAcc bestCost = bestTile[0][threadIdx.x];
+        for(int tz = 1; tz < blockDim.y; ++tz)
+        {
+            const TSimAcc c = bestTile[tz][threadIdx.x];
+            bestCost = c < bestCost ? c : bestCost;
+        }
+        volume_atomicMinSimAcc(&bestCost_d[x], bestCost);
+    }
+}
+
+__global__ void volume_initAggregatePathFused_kernel(TSimAcc* xzSliceForY_d, int xzSliceForY_p,
+                                                     TSimAcc* bestSimInY_d,
+                                                     const TSim* volSim_d, int volSim_s, int volSim_p,
+                                                     TSim* volAgr_d, int volAgr_s, int volAgr_p,
+                                                     const int3 volDim,
+                                                     const int3 axisT,
+                                                     int y)
+{
+    __shared__ TSimAcc bestTile[SGM_FUSED_BLOCK_Z][SGM_FUSED_BLOCK_X];
+
+    const int x = blockIdx.x * blockDim.x + threadIdx.x;
+    const int z = blockIdx.y * blockDim.y + threadIdx.y;
+
+    int3 v;
+    (&v.x)[axisT.x] = x;
+    (&v.x)[axisT.y] = y;
+    (&v.x)[axisT.z] = z;
+
+    const bool validX = (x < (&volDim.x)[axisT.x]);
+    const bool valid = validX && (z < volDim.z);
+
+    TSimAcc sim = 0;
+
+    if(valid)
+    {
+        // copy the first slice of the path in the slice buffer
+        sim = TSimAcc(*get3DBufferAt(volSim_d, volSim_s, volSim_p, v));
+        *get2DBufferAt(xzSliceForY_d, xzSliceForY_p, x, z) = sim;
+
+        // first slice of the path is undefined in the aggregated volume
+        *get3DBufferAt(volAgr_d, volAgr_s, volAgr_p, v) = TSim(255);
+    }
+
+    // best cost of each column of the first slice
+    volume_blockBestCostInSlice(bestTile, sim, valid, validX, x, bestSimInY_d);
+}
+
+__global__ void volume_aggregatePathFused_kernel(cudaTextureObject_t rcTex,
+                                                 TSimAcc* xzSliceForY_d, int xzSliceForY_p,
+                                                 const TSimAcc* xzSliceForYm1_d, int xzSliceForYm1_p,
+                                                 const TSimAcc* bestSimInYm1_d,
+                                                 TSimAcc* bestSimInY_d,
+                                                 TSimAcc* bestSimInYp1_d,
+                                                 const TSim* volSim_d, int volSim_s, int volSim_p,
+                                                 TSim* volAgr_d, int volAgr_s, int volAgr_p,
+                                                 const int3 volDim,
+                                                 const int3 axisT,
+                                                 float step,
+                                                 int y, float _P1, float _P2,
+                                                 int ySign, int filteringIndex,
+                                                 const ROI roi)
+{
+    // previous slice tile with one depth of margin on each side
+    __shared__ TSimAcc prevTile[SGM_FUSED_BLOCK_Z + 2][SGM_FUSED_BLOCK_X];
+    __shared__ TSimAcc bestTile[SGM_FUSED_BLOCK_Z][SGM_FUSED_BLOCK_X];
+
+    const int x = blockIdx.x * blockDim.x + threadIdx.x;
+    const int z = blockIdx.y * blockDim.y + threadIdx.y;
+    const int volDimX = (&volDim.x)[axisT.x];
+
+    int3 v;
+    (&v.x)[axisT.x] = x;
+    (&v.x)[axisT.y] = y;
+    (&v.x)[axisT.z] = z;
+
+    const bool validX = (x < volDimX);
+    const bool valid = validX && (z < volDim.z);
+
+    // load the previous slice tile
+    if(valid)
+    {
+        prevTile[threadIdx.y + 1][threadIdx.x] = *get2DBufferAt(xzSliceForYm1_d, xzSliceForYm1_p, x, z);
+
+        if(threadIdx.y == 0 && z > 0)
+            prevTile[0][threadIdx.x] = *get2DBufferAt(xzSliceForYm1_d, xzSliceForYm1_p, x, z - 1);
+
+        if(threadIdx.y == blockDim.y - 1 && z + 1 < volDim.z)
+            prevTile[threadIdx.y + 2][threadIdx.x] = *get2DBufferAt(xzSliceForYm1_d, xzSliceForYm1_p, x, z + 1);
+    }
+
+    // reset the best cost row of the next slice, the kernel of the previous slice is done with it
+    if(validX && blockIdx.y == 0 && threadIdx.y == 0)
+        bestSimInYp1_d[x] = volume_maxSimAcc();
+
+    __syncthreads();
+
+    float pathCost = 255.0f;
+
+    if(valid)
+    {
+        // similarity of the current position, directly from the similarity volume
+        const float sim = float(TSimAcc(*get3DBufferAt(volSim_d, volSim_s, volSim_p, v)));
+
+        if((z >= 1) && (z < volDim.z - 1))
+        {
+            const float P2 = volume_computeP2(rcTex, v, axisT, step, _P2, ySign, roi);
+
+            const TSimAcc bestCostInColM1 = bestSimInYm1_d[x];
+            const TSimAcc pathCostMDM1 = prevTile[threadIdx.y][threadIdx.x];     // M1: minus 1 over depths
+            const TSimAcc pathCostMD   = prevTile[threadIdx.y + 1][threadIdx.x];
+            const TSimAcc pathCostMDP1 = prevTile[threadIdx.y + 2][threadIdx.x]; // P1: plus 1 over depths
+            const float minCost = multi_fminf(pathCostMD, pathCostMDM1 + _P1, pathCostMDP1 + _P1, bestCostInColM1 + P2);
+
+            // if 'pathCostMD' is the minimal value of the depth
+            pathCost = sim + minCost - bestCostInColM1;
+        }
+
+        // fill the current slice with the new similarity score
+        *get2DBufferAt(xzSliceForY_d, xzSliceForY_p, x, z) = TSimAcc(pathCost);
+    }
+
+    // best cost of each column of the current slice, for the next slice
+    volume_blockBestCostInSlice(bestTile, TSimAcc(pathCost), valid, validX, x, bestSimInY_d);
+
+    if(!valid)
+        return;
+
+#ifndef TSIM_USE_FLOAT
+    // clamp if TSim = uchar (TSimAcc = unsigned int)
+    pathCost = fminf(255.0f, fmaxf(0.0f, pathCost));
+#endif
+
+    // aggregate into the final output
+    TSim* volume_xyz = get3DBufferAt(volAgr_d, volAgr_s, volAgr_p, v.x, v.y, v.z);
+    const float val = (float(*volume_xyz) * float(filteringIndex) + pathCost) / float(filteringIndex + 1);
+    *volume_xyz = TSim(val);
+}
+
 } // namespace depthMap
 } // namespace aliceVision
@@ -13,6 +13,9 @@
 #include <cuda_fp16.h>
 #endif
 
+// maximum number of T cameras evaluated by a single refine similarity volume kernel launch
+#define ALICEVISION_DEVICE_REFINE_MAX_TCAMS_PER_LAUNCH 8
+
 namespace aliceVision {
 namespace depthMap {
 
@@ -7,23 +7,37 @@
 #include "depthMap.hpp"
 
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/MemoryTracker.hpp>
+#include <aliceVision/system/Metrics.hpp>
 #include <aliceVision/system/Timer.hpp>
 #include <aliceVision/mvsUtils/fileIO.hpp>
 #include <aliceVision/mvsUtils/depthSimMapIO.hpp>
 #include <aliceVision/mvsUtils/MultiViewParams.hpp>
 #include <aliceVision/depthMap/depthMapUtils.hpp>
 #include <aliceVision/depthMap/DepthMapParams.hpp>
+#include <aliceVision/depthMap/DepthMapFilterParams.hpp>
 #include <aliceVision/depthMap/SgmDepthList.hpp>
 #include <aliceVision/depthMap/Sgm.hpp>
 #include <aliceVision/depthMap/Refine.hpp>
 #include <aliceVision/depthMap/cuda/host/utils.hpp>
 #include <aliceVision/depthMap/cuda/host/DeviceCache.hpp>
+#include <aliceVision/depthMap/cuda/host/DeviceKernelTimer.hpp>
 #include <aliceVision/depthMap/cuda/host/DeviceStreamManager.hpp>
+#include <aliceVision/depthMap/cuda/host/PinnedMemoryPool.hpp>
+#include <aliceVision/depthMap/cuda/host/LRUCache.hpp>
 #include <aliceVision/depthMap/cuda/normalMapping/DeviceNormalMapper.hpp>
 #include <aliceVision/depthMap/cuda/normalMapping/deviceNormalMap.hpp>
+#include <aliceVision/depthMap/cuda/depthMapFiltering/deviceDepthMapFilter.hpp>
 
 #include <boost/filesystem.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <memory>
+#include <set>
+#include <sstream>
+
 namespace fs = boost::filesystem;
 
 namespace aliceVision {
@@ -159,6 +173,13 @@ int getNbStreams(const mvsUtils::MultiViewParams& mp, const DepthMapParams& dept
         deviceMemoryMB = availableMB * 0.8; // available memory margin
     }
 
+    // the user device memory budget, the first tile is always allowed
+    if(depthMapParams.maxDeviceMemoryPerImage > 0.0 && depthMapParams.maxDeviceMemoryPerImage < deviceMemoryMB)
+    {
+        deviceMemoryMB = std::max(depthMapParams.maxDeviceMemoryPerImage, std::min(rcMinCostMB, deviceMemoryMB));
+        ALICEVISION_LOG_INFO("Device memory limited to " << deviceMemoryMB << " MB by the device memory budget.");
+    }
+
     int nbAllowedSimultaneousRc = int(deviceMemoryMB / rcMaxCostMB);
     int nbRemainingTiles = 0;
 
@@ -180,6 +201,7 @@ int getNbStreams(const mvsUtils::MultiViewParams& mp, const DepthMapParams& dept
                          << "\t- available: " << deviceMemoryMB << " MB" << std::endl
                          << "\t- requirement for the first tile: " << rcMinCostMB << " MB" << std::endl
                          << "\t- # computation buffers per tile: " << tileCostMB << " MB" << " (Sgm: " << sgmTileCostMB << " MB" << ", Refine: " << refineTileCostMB << " MB)" << std::endl
+                         << "\t- # similarity volume value size: Sgm: " << sizeof(TSim) << " byte(s), Refine: " << sizeof(TSimRefine) << " byte(s)" << std::endl
                          << "\t- # input images (R + " << depthMapParams.maxTCams << " Ts): " << rcCamsCost << " MB (single multi-res image size: " << cameraFrameCostMB << " MB)");
 
     ALICEVISION_LOG_DEBUG( "Theoretical device memory cost for a tile without padding: " << tileCostUnpaddedMB << " MB" << " (Sgm: " << sgmTileCostUnpaddedMB << " MB" << ", Refine: " << refineTileCostUnpaddedMB << " MB)");
@@ -221,6 +243,10 @@ void getDepthMapParams(const mvsUtils::MultiViewParams& mp, DepthMapParams& dept
     sgmParams.filteringAxes = mp.userParams.get<std::string>("sgm.filteringAxes", sgmParams.filteringAxes);
     sgmParams.useSfmSeeds = mp.userParams.get<bool>("sgm.useSfmSeeds", sgmParams.useSfmSeeds);
     sgmParams.depthListPerTile = mp.userParams.get<bool>("sgm.depthListPerTile", sgmParams.depthListPerTile);
+    sgmParams.useFusedVolumeOptimization = mp.userParams.get<bool>("sgm.useFusedVolumeOptimization", sgmParams.useFusedVolumeOptimization);
+    sgmParams.useCoarseDepthPruning = mp.userParams.get<bool>("sgm.useCoarseDepthPruning", sgmParams.useCoarseDepthPruning);
+    sgmParams.coarseDepthPruningStep = mp.userParams.get<int>("sgm.coarseDepthPruningStep", sgmParams.coarseDepthPruningStep);
+    sgmParams.coarseDepthPruningMargin = mp.userParams.get<int>("sgm.coarseDepthPruningMargin", sgmParams.coarseDepthPruningMargin);
     sgmParams.exportIntermediateDepthSimMaps = mp.userParams.get<bool>("sgm.exportIntermediateDepthSimMaps", sgmParams.exportIntermediateDepthSimMaps);
     sgmParams.exportIntermediateVolumes = mp.userParams.get<bool>("sgm.exportIntermediateVolumes", sgmParams.exportIntermediateVolumes);
     sgmParams.exportIntermediateCrossVolumes = mp.userParams.get<bool>("sgm.exportIntermediateCrossVolumes", sgmParams.exportIntermediateCrossVolumes);
@@ -251,10 +277,164 @@ void getDepthMapParams(const mvsUtils::MultiViewParams& mp, DepthMapParams& dept
     depthMapParams.chooseTCamsPerTile = mp.userParams.get<bool>("depthMap.chooseTCamsPerTile", depthMapParams.chooseTCamsPerTile);
     depthMapParams.exportTilePattern = mp.userParams.get<bool>("depthMap.exportTilePattern", depthMapParams.exportTilePattern);
     depthMapParams.autoAdjustSmallImage = mp.userParams.get<bool>("depthMap.autoAdjustSmallImage", depthMapParams.autoAdjustSmallImage);
+    depthMapParams.imageCacheFolder = mp.userParams.get<std::string>("depthMap.imageCacheFolder", depthMapParams.imageCacheFolder);
+    depthMapParams.targetTimePerImage = mp.userParams.get<double>("depthMap.targetTimePerImage", depthMapParams.targetTimePerImage);
+    depthMapParams.maxDeviceMemoryPerImage = mp.userParams.get<double>("depthMap.maxDeviceMemoryPerImage", depthMapParams.maxDeviceMemoryPerImage);
+}
+
+/**
+ * @brief Depth map quality preset, relative to the user parameters.
+ *        Each preset reduces the parameters driving the similarity volumes size.
+ */
+struct DepthMapPreset
+{
+    const char* name;
+    double sgmDepthsFactor;         //< SGM maximum number of depths factor
+    double tCamsFactor;             //< maximum number of T cameras factor
+    int sgmStepXYIncrement;         //< SGM step XY increment
+    double refineDepthsFactor;      //< Refine number of depths factor
+    double refineSubsamplesFactor;  //< Refine number of subsamples factor
+};
+
+// ordered from the highest to the lowest quality
+const DepthMapPreset depthMapPresets[] = {
+    {"user",   1.0,  1.0,  0, 1.0,  1.0},
+    {"high",   0.75, 0.8,  0, 1.0,  1.0},
+    {"medium", 0.5,  0.6,  0, 0.67, 0.7},
+    {"low",    0.5,  0.5,  1, 0.5,  0.5},
+    {"draft",  0.33, 0.4,  2, 0.34, 0.3}
+};
+
+// relative cost of a similarity volume voxel per T camera and per patch pixel (work unit)
+// initial throughput guess (work units per second) used until a batch has been measured on the device
+constexpr double defaultWorkThroughput = 5.0e10;
+
+// throughput measured on the device of the calling thread, reused by the next calls of the process
+thread_local double measuredWorkThroughput = 0.0;
+
+void applyDepthMapPreset(const DepthMapPreset& preset, const DepthMapParams& userParams, DepthMapParams& depthMapParams)
+{
+    // the parameters structures have constant members, only the tuned parameters are set
+    auto& sgmParams = depthMapParams.sgmParams;
+    auto& refineParams = depthMapParams.refineParams;
+
+    depthMapParams.maxTCams = std::max(1, int(std::lround(userParams.maxTCams * preset.tCamsFactor)));
+    sgmParams.maxTCamsPerTile = std::min(userParams.sgmParams.maxTCamsPerTile, depthMapParams.maxTCams);
+    sgmParams.maxDepths = std::max(32, int(std::lround(userParams.sgmParams.maxDepths * preset.sgmDepthsFactor)));
+    sgmParams.stepXY = userParams.sgmParams.stepXY + preset.sgmStepXYIncrement;
+    refineParams.maxTCamsPerTile = std::min(userParams.refineParams.maxTCamsPerTile, depthMapParams.maxTCams);
+    refineParams.halfNbDepths = std::max(2, int(std::lround(userParams.refineParams.halfNbDepths * preset.refineDepthsFactor)));
+    refineParams.nbSubsamples = std::max(1, int(std::lround(userParams.refineParams.nbSubsamples * preset.refineSubsamplesFactor)));
+}
+
+int getNbTilesPerCamera(const mvsUtils::MultiViewParams& mp, const DepthMapParams& depthMapParams)
+{
+    const int maxDownscale = std::max(depthMapParams.sgmParams.scale * depthMapParams.sgmParams.stepXY,
+                                      depthMapParams.refineParams.scale * depthMapParams.refineParams.stepXY);
+
+    mvsUtils::TileParams tileParams = depthMapParams.tileParams;
+    tileParams.padding = divideRoundUp(tileParams.padding, maxDownscale) * maxDownscale;
+
+    std::vector<ROI> tileRoiList;
+    getTileRoiList(tileParams, mp.getMaxImageWidth(), mp.getMaxImageHeight(), maxDownscale, tileRoiList);
+    return int(tileRoiList.size());
+}
+
+double getDepthMapWorkPerImage(const mvsUtils::MultiViewParams& mp, const DepthMapParams& depthMapParams)
+{
+    const auto& sgmParams = depthMapParams.sgmParams;
+    const auto& refineParams = depthMapParams.refineParams;
+    const auto getNbPixels = [&](int downscale)
+    {
+        return double(divideRoundUp(mp.getMaxImageWidth(), downscale)) * double(divideRoundUp(mp.getMaxImageHeight(), downscale));
+    };
+    const auto getPatchSize = [](int wsh) { return double((2 * wsh + 1) * (2 * wsh + 1)); };
+
+    // SGM: similarity volume per T camera, then one optimization pass per filtering axis
+    const int sgmTCams = depthMapParams.chooseTCamsPerTile ? std::min(sgmParams.maxTCamsPerTile, depthMapParams.maxTCams) : depthMapParams.maxTCams;
+    const double sgmVoxels = getNbPixels(sgmParams.scale * sgmParams.stepXY) * sgmParams.maxDepths;
+    const double sgmWork = sgmVoxels * (sgmTCams * getPatchSize(sgmParams.wsh) + sgmParams.filteringAxes.size());
+
+    if(!depthMapParams.useRefine)
+        return sgmWork;
+
+    // Refine: similarity volume per T camera, sliding gaussian over the subsamples, then the color optimization
+    const int refineTCams = depthMapParams.chooseTCamsPerTile ? std::min(refineParams.maxTCamsPerTile, depthMapParams.maxTCams) : depthMapParams.maxTCams;
+    const double refinePixels = getNbPixels(refineParams.scale * refineParams.stepXY);
+    const double refineVoxels = refinePixels * (2 * refineParams.halfNbDepths + 1);
+    double refineWork = refineVoxels * (refineTCams * getPatchSize(refineParams.wsh) + refineParams.nbSubsamples);
+
+    if(refineParams.useColorOptimization)
+        refineWork += refinePixels * refineParams.optimizationNbIterations;
+
+    return sgmWork + refineWork;
+}
+
+double getDeviceMemoryPerImage(const mvsUtils::MultiViewParams& mp, const DepthMapParams& depthMapParams)
+{
+    // same model as getNbStreams: input images (R + Ts) and the computation buffers of all the tiles
+    const int maxImageSize = mp.getMaxImageWidth() * mp.getMaxImageHeight();
+    const double sgmFrameCostMB = ((maxImageSize / depthMapParams.sgmParams.scale) * sizeof(CudaRGBA)) / (1024.0 * 1024.0);
+    const double refineFrameCostMB = ((maxImageSize / depthMapParams.refineParams.scale) * sizeof(CudaRGBA)) / (1024.0 * 1024.0);
+    const double cameraFrameCostMB = sgmFrameCostMB + (depthMapParams.useRefine ? refineFrameCostMB : 0.0);
+
+    // estimated from the buffers dimensions, nothing is allocated on the device
+    double tileCostMB = Sgm::estimateDeviceMemoryConsumption(depthMapParams.tileParams, depthMapParams.sgmParams);
+
+    if(depthMapParams.useRefine)
+        tileCostMB += Refine::estimateDeviceMemoryConsumption(depthMapParams.tileParams, depthMapParams.refineParams);
+
+    return (1 + depthMapParams.maxTCams) * cameraFrameCostMB + getNbTilesPerCamera(mp, depthMapParams) * tileCostMB;
+}
+
+double autoTuneDepthMapParams(const mvsUtils::MultiViewParams& mp, DepthMapParams& depthMapParams)
+{
+    const double workThroughput = (measuredWorkThroughput > 0.0) ? measuredWorkThroughput : defaultWorkThroughput;
+    const DepthMapParams userParams = depthMapParams;
+
+    std::ostringstream ss;
+    double predictedTime = 0.0;
+    bool fits = false;
+
+    for(const DepthMapPreset& preset : depthMapPresets)
+    {
+        applyDepthMapPreset(preset, userParams, depthMapParams);
+
+        predictedTime = getDepthMapWorkPerImage(mp, depthMapParams) / workThroughput;
+        const double memoryMB = getDeviceMemoryPerImage(mp, depthMapParams);
+
+        ss << std::endl << "\t- " << preset.name << ": " << predictedTime << " s, " << memoryMB << " MB";
+
+        fits = (depthMapParams.targetTimePerImage <= 0.0 || predictedTime <= depthMapParams.targetTimePerImage) &&
+               (depthMapParams.maxDeviceMemoryPerImage <= 0.0 || memoryMB <= depthMapParams.maxDeviceMemoryPerImage);
+
+        if(fits)
+        {
+            ss << " (selected)";
+            break;
+        }
+    }
+
+    ALICEVISION_LOG_INFO("Depth map auto-tuning (target time per image: " << depthMapParams.targetTimePerImage << " s, "
+                         << "device memory per image: " << depthMapParams.maxDeviceMemoryPerImage << " MB, "
+                         << "throughput: " << workThroughput << ((measuredWorkThroughput > 0.0) ? " (measured)" : " (default)") << "):"
+                         << ss.str());
+
+    if(!fits)
+        ALICEVISION_LOG_WARNING("Depth map auto-tuning: no preset fits the budget, use the lowest quality preset.");
+
+    ALICEVISION_LOG_INFO("Depth map auto-tuned parameters:" << std::endl
+                         << "\t- maxTCams: " << depthMapParams.maxTCams << std::endl
+                         << "\t- SGM maxDepths: " << depthMapParams.sgmParams.maxDepths << ", stepXY: " << depthMapParams.sgmParams.stepXY << std::endl
+                         << "\t- Refine halfNbDepths: " << depthMapParams.refineParams.halfNbDepths << ", nbSubsamples: " << depthMapParams.refineParams.nbSubsamples);
+
+    return predictedTime;
 }
 
 void estimateAndRefineDepthMaps(int cudaDeviceId, mvsUtils::MultiViewParams& mp, const std::vector<int>& cams)
 {
+    ALICEVISION_MEMORY_STAGE("depthMapEstimation");
+
     // set the device to use for GPU executions
     // the CUDA runtime API is thread-safe, it maintains per-thread state about the current device 
     setCudaDeviceId(cudaDeviceId);
@@ -273,6 +453,10 @@ void estimateAndRefineDepthMaps(int cudaDeviceId, mvsUtils::MultiViewParams& mp,
     if(hasOnlyOneTile(depthMapParams.tileParams, mp.getMaxImageWidth(), mp.getMaxImageHeight()))
       updateDepthMapParamsForSingleTileComputation(mp, autoSgmScaleStep, depthMapParams);
 
+    // choose the depth map parameters from the time and device memory budgets per image, if any
+    const bool autoTune = (depthMapParams.targetTimePerImage > 0.0 || depthMapParams.maxDeviceMemoryPerImage > 0.0);
+    const double predictedTimePerImage = autoTune ? autoTuneDepthMapParams(mp, depthMapParams) : 0.0;
+
     // compute the maximum downscale factor
     const int maxDownscale = std::max(depthMapParams.sgmParams.scale * depthMapParams.sgmParams.stepXY,
                                       depthMapParams.refineParams.scale * depthMapParams.refineParams.stepXY);
@@ -315,7 +499,7 @@ void estimateAndRefineDepthMaps(int cudaDeviceId, mvsUtils::MultiViewParams& mp,
     const int nbCamerasPerBatch = nbRcPerBatch * (nbCamerasPerSgm + nbCamerasPerRefine);         // number of cameras in the same batch
 
     DeviceCache& deviceCache = DeviceCache::getInstance();
-    deviceCache.buildCache(nbCamerasPerBatch);
+    deviceCache.buildCache(nbCamerasPerBatch, depthMapParams.imageCacheFolder);
     
     // build tile list
     // order by R camera
@@ -377,10 +561,11 @@ void estimateAndRefineDepthMaps(int cudaDeviceId, mvsUtils::MultiViewParams& mp,
           refinePerStream.emplace_back(mp, depthMapParams.tileParams, depthMapParams.refineParams, deviceStreamManager.getStream(i));
 
     // allocate final deth/similarity map tile list in host memory
-    std::vector<std::vector<CudaHostMemoryHeap<float2, 2>>> depthSimMapTilePerCam(nbRcPerBatch);
-    std::vector<std::vector<std::pair<float, float>>> depthMinMaxTilePerCam(nbRcPerBatch);
+    // two sets of buffers: one is filled by the current batch while the other one is written by the previous batch
+    std::vector<std::vector<CudaHostMemoryHeap<float2, 2>>> depthSimMapTilePerCam(2 * nbRcPerBatch);
+    std::vector<std::vector<std::pair<float, float>>> depthMinMaxTilePerCam(2 * nbRcPerBatch);
 
-    for(int i = 0; i < nbRcPerBatch; ++i)
+    for(int i = 0; i < 2 * nbRcPerBatch; ++i)
     {
         auto& depthSimMapTiles = depthSimMapTilePerCam.at(i);
         auto& depthMinMaxTiles = depthMinMaxTilePerCam.at(i);
@@ -401,15 +586,46 @@ void estimateAndRefineDepthMaps(int cudaDeviceId, mvsUtils::MultiViewParams& mp,
     logDeviceMemoryInfo();
 
     // compute number of batches
+    // batches contain whole R cameras (nbTilesPerBatch is a multiple of nbTilesPerCamera)
     const int nbBatches = divideRoundUp(int(tiles.size()), nbTilesPerBatch);
 
+    // get the cameras (R and T) of a batch
+    const auto getBatchCameras = [&](int b)
+    {
+        std::set<int> batchCams;
+        for(int i = b * nbTilesPerBatch; i < std::min((b + 1) * nbTilesPerBatch, int(tiles.size())); ++i)
+        {
+            const Tile& tile = tiles.at(i);
+            batchCams.insert(tile.rc);
+            batchCams.insert(tile.sgmTCams.begin(), tile.sgmTCams.end());
+            if(depthMapParams.useRefine)
+                batchCams.insert(tile.refineTCams.begin(), tile.refineTCams.end());
+        }
+        return std::vector<int>(batchCams.begin(), batchCams.end());
+    };
+
+    // staged pipeline:
+    // - the images of the next batch are loaded from disk in the RAM images cache during the current batch computation
+    // - the depth/sim maps of the previous batch are written on disk during the current batch computation
+    std::future<void> prefetchImages;
+    std::future<void> writeDepthSimMaps;
+
+    system::Timer computationTimer;
+
     // compute each batch of R cameras
     for(int b = 0; b < nbBatches; ++b)
     {
         // find first/last tile to compute
         const int firstTileIndex = b * nbTilesPerBatch;
         const int lastTileIndex = std::min((b + 1) * nbTilesPerBatch, int(tiles.size()));
-        
+
+        // host buffers set of the batch
+        const int bufferOffset = (b % 2) * nbRcPerBatch;
+
+        // wait for the batch images loading in the RAM images cache
+        if(prefetchImages.valid())
+            prefetchImages.get();
+
         // load tile R and corresponding T cameras in device cache  
         for(int i = firstTileIndex; i < lastTileIndex; ++i)
         {
@@ -441,14 +657,20 @@ void estimateAndRefineDepthMaps(int cudaDeviceId, mvsUtils::MultiViewParams& mp,
             }
         }
 
+        // load the next batch images in the RAM images cache
+        // the images cache is not used by this thread until the next batch device cache loading
+        if(b + 1 < nbBatches)
+            prefetchImages = std::async(std::launch::async, [&ic, nextBatchCams = getBatchCameras(b + 1)]() { ic.refreshImages_sync(nextBatchCams); });
+
         // wait for camera loading in device cache
         cudaDeviceSynchronize();
+        deviceStreamManager.updateDeviceMemoryWatermark();
 
         // compute each batch tile
         for(int i = firstTileIndex; i < lastTileIndex; ++i)
         {
             Tile& tile = tiles.at(i);
-            const int batchCamIndex = tile.rc % nbRcPerBatch;
+            const int batchCamIndex = bufferOffset + (i - firstTileIndex) / nbTilesPerCamera;
             const int streamIndex = tile.id % nbStreams;
 
             // do not compute empty ROI
@@ -492,6 +714,9 @@ void estimateAndRefineDepthMaps(int cudaDeviceId, mvsUtils::MultiViewParams& mp,
             // check if starting and stopping depth are valid
             sgmDepthList.checkStartingAndStoppingDepth();
 
+            // the timed kernels of the tile stream are attributed to the tile R camera
+            DeviceKernelTimer::getInstance().setStreamCamera(deviceStreamManager.getStream(streamIndex), tile.rc);
+
             // compute Semi-Global Matching
             Sgm& sgm = sgmPerStream.at(streamIndex);
             sgm.sgmRc(tile, sgmDepthList);
@@ -510,31 +735,67 @@ void estimateAndRefineDepthMaps(int cudaDeviceId, mvsUtils::MultiViewParams& mp,
               // copy Sgm depth/similarity map from device to host
               tileDepthSimMap_hmh.copyFrom(sgm.getDeviceDepthSimMap(), deviceStreamManager.getStream(streamIndex));
             }
+
+            deviceStreamManager.updateDeviceMemoryWatermark();
         }
 
         // wait for tiles batch computation
         cudaDeviceSynchronize();
-        
-        // find first and last tile R camera
-        const int firstRc = tiles.at(firstTileIndex).rc;
-        int lastRc = tiles.at(lastTileIndex - 1).rc;
 
-        // check if last tile depth map is finished
-        if(lastTileIndex < tiles.size() && (tiles.at(lastTileIndex).rc == lastRc))
-          --lastRc;
-
-        // write depth/sim map result
-        for(int c = firstRc; c <= lastRc; ++c)
+        // wait for the previous batch depth/sim maps writing, its buffers are used by the next batch
+        if(writeDepthSimMaps.valid())
+            writeDepthSimMaps.get();
+
+        // batch R cameras
+        std::vector<int> batchRcs;
+        for(int i = firstTileIndex; i < lastTileIndex; i += nbTilesPerCamera)
+            batchRcs.push_back(tiles.at(i).rc);
+
+        // add the batch kernels duration and device memory watermark to the metrics, per R camera
+        // the R cameras of a batch are computed together, they share the batch device memory watermark
+        DeviceKernelTimer::getInstance().flush();
+        deviceStreamManager.updateDeviceMemoryWatermark();
+        for(std::size_t c = 0; c < batchRcs.size(); ++c)
+            system::Metrics::get().addSample("depthMap.deviceMemoryWatermark", deviceStreamManager.getDeviceMemoryWatermark());
+        deviceStreamManager.resetDeviceMemoryWatermark();
+
+        // write depth/sim map result on a CPU worker, during the next batch computation
+        writeDepthSimMaps = std::async(std::launch::async, [&, batchRcs, bufferOffset]()
         {
-          const int batchCamIndex = c % nbRcPerBatch;
+            for(std::size_t c = 0; c < batchRcs.size(); ++c)
+            {
+              const int rc = batchRcs.at(c);
+              const int batchCamIndex = bufferOffset + c;
 
-          if(depthMapParams.useRefine)
-            writeDepthSimMapFromTileList(c, mp, depthMapParams.tileParams, tileRoiList, depthSimMapTilePerCam.at(batchCamIndex), depthMapParams.refineParams.scale, depthMapParams.refineParams.stepXY);
-          else
-            writeDepthSimMapFromTileList(c, mp, depthMapParams.tileParams, tileRoiList, depthSimMapTilePerCam.at(batchCamIndex), depthMapParams.sgmParams.scale, depthMapParams.sgmParams.stepXY);
+              if(depthMapParams.useRefine)
+                writeDepthSimMapFromTileList(rc, mp, depthMapParams.tileParams, tileRoiList, depthSimMapTilePerCam.at(batchCamIndex), depthMapParams.refineParams.scale, depthMapParams.refineParams.stepXY);
+              else
+                writeDepthSimMapFromTileList(rc, mp, depthMapParams.tileParams, tileRoiList, depthSimMapTilePerCam.at(batchCamIndex), depthMapParams.sgmParams.scale, depthMapParams.sgmParams.stepXY);
+
+              if(depthMapParams.exportTilePattern)
+                  exportDepthSimMapTilePatternObj(rc, mp, tileRoiList, depthMinMaxTilePerCam.at(batchCamIndex));
+            }
+        });
+    }
+
+    // wait for the last batch depth/sim maps writing
+    if(writeDepthSimMaps.valid())
+        writeDepthSimMaps.get();
 
-          if(depthMapParams.exportTilePattern)
-              exportDepthSimMapTilePatternObj(c, mp, tileRoiList, depthMinMaxTilePerCam.at(batchCamIndex));
+    // measure the work throughput of the device, used by the next auto-tuning on this device
+    if(!cams.empty())
+    {
+        const double timePerImage = computationTimer.elapsed() / cams.size();
+
+        if(timePerImage > 0.0)
+            measuredWorkThroughput = getDepthMapWorkPerImage(mp, depthMapParams) / timePerImage;
+
+        system::Metrics::get().setGauge("depthMap.timePerImage", timePerImage);
+
+        if(autoTune)
+        {
+            ALICEVISION_LOG_INFO("Depth map auto-tuning: predicted time per image: " << predictedTimePerImage << " s, actual: " << timePerImage << " s.");
+            system::Metrics::get().setGauge("depthMap.predictedTimePerImage", predictedTimePerImage);
         }
     }
 
@@ -562,6 +823,72 @@ void estimateAndRefineDepthMaps(int cudaDeviceId, mvsUtils::MultiViewParams& mp,
     DeviceCache::getInstance().clear();
     sgmPerStream.clear();
     refinePerStream.clear();
+
+    // log pinned host memory usage, the cached blocks are kept for the next cameras
+    PinnedMemoryPool::getInstance().logStats();
+}
+
+void estimateDepthMapsCost(const mvsUtils::MultiViewParams& mp, const std::vector<int>& cams, std::vector<double>& costs)
+{
+    // get user parameters from MultiViewParams property_tree
+    DepthMapParams depthMapParams;
+    getDepthMapParams(mp, depthMapParams);
+
+    // compute SGM scale and step (set to -1)
+    computeScaleStepSgmParams(mp, depthMapParams.sgmParams);
+
+    costs.resize(cams.size());
+
+    #pragma omp parallel for
+    for(int i = 0; i < int(cams.size()); ++i)
+    {
+        const int rc = cams.at(i);
+
+        // single tile covering the R camera image
+        Tile tile;
+        tile.id = 0;
+        tile.nbTiles = 1;
+        tile.rc = rc;
+        tile.roi = ROI(Range(0, mp.getWidth(rc)), Range(0, mp.getHeight(rc)));
+        tile.sgmTCams = mp.findNearestCamsFromLandmarks(rc, depthMapParams.maxTCams).getDataWritable();
+
+        if(tile.sgmTCams.empty())
+        {
+            costs.at(i) = 0.0;
+            continue;
+        }
+
+        SgmDepthList sgmDepthList(mp, depthMapParams.sgmParams, tile);
+        sgmDepthList.computeListRc();
+
+        // the similarity volume computation is the main cost: one similarity per pixel, depth and T camera
+        const double nbPixels = double(mp.getWidth(rc)) * double(mp.getHeight(rc));
+        costs.at(i) = nbPixels * double(sgmDepthList.getDepths().size()) * double(tile.sgmTCams.size());
+    }
+}
+
+void writeNormalMap(int rc, const mvsUtils::MultiViewParams& mp, const float3* normalMapPtr, int width, int height)
+{
+    image::Image<image::RGBfColor> normalMap(width, height);
+
+    constexpr bool q = (sizeof(image::RGBfColor[2]) == sizeof(float3[2]));
+    if(q == true)
+    {
+        memcpy(normalMap.data(), normalMapPtr, width * height * sizeof(float3));
+    }
+    else
+    {
+        for(int i = 0; i < width * height; i++)
+        {
+            normalMap(i).r() = normalMapPtr[i].x;
+            normalMap(i).g() = normalMapPtr[i].y;
+            normalMap(i).b() = normalMapPtr[i].z;
+        }
+    }
+
+    image::writeImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::normalMap, 0), normalMap,
+                      image::ImageWriteOptions().toColorSpace(image::EImageColorSpace::LINEAR)
+                                                .storageDataType(image::EStorageDataType::Float));
 }
 
 void computeNormalMaps(int cudaDeviceId, mvsUtils::MultiViewParams& mp, const std::vector<int>& cams)
@@ -589,8 +916,6 @@ void computeNormalMaps(int cudaDeviceId, mvsUtils::MultiViewParams& mp, const st
             image::Image<float> depthMap;
             readImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::depthMap, 0), depthMap, image::EImageColorSpace::NO_CONVERSION);
 
-            image::Image<image::RGBfColor> normalMap(mp.getWidth(rc), mp.getHeight(rc));
-
             const int w = mp.getWidth(rc) / scale;
             const int h = mp.getHeight(rc) / scale;
 
@@ -604,32 +929,187 @@ void computeNormalMaps(int cudaDeviceId, mvsUtils::MultiViewParams& mp, const st
             normalMapper.allocHostMaps(w, h);
             normalMapper.copyDepthMap(depthMap.data(), depthMap.size());
 
+            DeviceKernelTimer::getInstance().setStreamCamera(0, rc);
             cuda_computeNormalMap(&normalMapper, w, h, wsh, gammaC, gammaP);
+            DeviceKernelTimer::getInstance().flush();
 
-            float3* normalMapPtr = normalMapper.getNormalMapHst();
+            writeNormalMap(rc, mp, normalMapper.getNormalMapHst(), w, h);
 
-            constexpr bool q = (sizeof(image::RGBfColor[2]) == sizeof(float3[2]));
-            if(q == true)
-            {
-                memcpy(normalMap.data(), normalMapper.getNormalMapHst(), w * h * sizeof(float3));
-            }
-            else
+            ALICEVISION_LOG_INFO("Compute normal map (rc: " << rc << ") done in: " << timer.elapsedMs() << " ms.");
+        }
+    }
+}
+
+void getDepthMapFilterParams(const mvsUtils::MultiViewParams& mp, DepthMapFilterParams& filterParams)
+{
+    filterParams.minNumOfConsistentCams = mp.userParams.get<int>("depthMapFiltering.minNumOfConsistentCams", filterParams.minNumOfConsistentCams);
+    filterParams.minNumOfConsistentCamsWithLowSimilarity = mp.userParams.get<int>("depthMapFiltering.minNumOfConsistentCamsWithLowSimilarity", filterParams.minNumOfConsistentCamsWithLowSimilarity);
+    filterParams.pixToleranceFactor = mp.userParams.get<float>("depthMapFiltering.pixToleranceFactor", filterParams.pixToleranceFactor);
+    filterParams.pixSizeBall = mp.userParams.get<int>("depthMapFiltering.pixSizeBall", filterParams.pixSizeBall);
+    filterParams.pixSizeBallWithLowSimilarity = mp.userParams.get<int>("depthMapFiltering.pixSizeBallWithLowSimilarity", filterParams.pixSizeBallWithLowSimilarity);
+    filterParams.nNearestCams = mp.userParams.get<int>("depthMapFiltering.nNearestCams", filterParams.nNearestCams);
+    filterParams.maxNbCachedDepthMaps = mp.userParams.get<int>("depthMapFiltering.maxNbCachedDepthMaps", filterParams.maxNbCachedDepthMaps);
+    filterParams.computeNormalMaps = mp.userParams.get<bool>("depthMapFiltering.computeNormalMaps", filterParams.computeNormalMaps);
+}
+
+void filterDepthMaps(int cudaDeviceId, mvsUtils::MultiViewParams& mp, const std::vector<int>& cams)
+{
+    ALICEVISION_MEMORY_STAGE("depthMapFiltering");
+
+    // set the device to use for GPU executions
+    // the CUDA runtime API is thread-safe, it maintains per-thread state about the current device
+    setCudaDeviceId(cudaDeviceId);
+
+    DepthMapFilterParams filterParams;
+    getDepthMapFilterParams(mp, filterParams);
+
+    // the neighbor depth maps are shared by close R cameras, keep the most recently used ones in device memory
+    const int nbCachedDepthMaps = std::max(1, filterParams.maxNbCachedDepthMaps);
+    LRUCache<int> depthMapCache(nbCachedDepthMaps);
+    std::vector<std::unique_ptr<CudaDeviceMemoryPitched<float, 2>>> cachedDepthMaps_dmp(nbCachedDepthMaps);
+
+    DeviceCameraParams rcCamParams;
+    DeviceCameraParams tcCamParams;
+
+    const cudaStream_t stream = 0;
+
+    // already filtered R cameras without normal map, their normal map is computed from the depth map on disk
+    std::vector<int> normalMapCams;
+
+    for(const int rc : cams)
+    {
+        const std::string nmodMapFilepath = getFileNameFromIndex(mp, rc, mvsUtils::EFileType::nmodMap);
+        const bool computeNormalMap = filterParams.computeNormalMaps && !fs::exists(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::normalMap, 0));
+
+        if(fs::exists(nmodMapFilepath))
+        {
+            if(computeNormalMap)
+                normalMapCams.push_back(rc);
+            continue;
+        }
+
+        const system::Timer timer;
+        ALICEVISION_LOG_INFO("Filter depth map (rc: " << rc << ")");
+
+        const int width = mp.getWidth(rc);
+        const int height = mp.getHeight(rc);
+
+        image::Image<float> depthMap;
+        image::Image<float> simMap;
+        mvsUtils::readDepthSimMap(rc, mp, depthMap, simMap, 1);
+
+        if(depthMap.Width() != width || depthMap.Height() != height || simMap.Width() != width || simMap.Height() != height)
+            ALICEVISION_THROW_ERROR("Filter depth map: bad image dimension for camera: " << mp.getViewId(rc));
+
+        const CudaSize<2> rcMapDim(width, height);
+
+        CudaDeviceMemoryPitched<float, 2> depthMap_dmp(rcMapDim);
+        CudaDeviceMemoryPitched<float, 2> simMap_dmp(rcMapDim);
+        CudaDeviceMemoryPitched<int, 2> tcStampMap_dmp(rcMapDim);
+        CudaDeviceMemoryPitched<int, 2> nbConsistentCamsMap_dmp(rcMapDim);
+
+        depthMap_dmp.copyFrom(depthMap.data(), width, height);
+        simMap_dmp.copyFrom(simMap.data(), width, height);
+
+        THROW_ON_CUDA_ERROR(cudaMemset2D(tcStampMap_dmp.getBuffer(), tcStampMap_dmp.getPitch(), 0, width * sizeof(int), height),
+                            "Filter depth map: failed to initialize the T camera stamp map");
+        THROW_ON_CUDA_ERROR(cudaMemset2D(nbConsistentCamsMap_dmp.getBuffer(), nbConsistentCamsMap_dmp.getPitch(), 0, width * sizeof(int), height),
+                            "Filter depth map: failed to initialize the consistent cameras map");
+
+        fillHostCameraParameters(rcCamParams, rc, 1, mp);
+
+        const StaticVector<int> tcams = mp.findNearestCamsFromLandmarks(rc, filterParams.nNearestCams);
+
+        for(int c = 0; c < tcams.size(); ++c)
+        {
+            const int tc = tcams[c];
+
+            int cacheIndex;
+            int oldTc;
+            if(depthMapCache.insert(tc, cacheIndex, oldTc))
             {
-                for(int i = 0; i < w * h; i++)
+                // the T camera depth map is not in device memory, read and upload it
+                image::Image<float> tcDepthMap;
+                mvsUtils::readDepthMap(tc, mp, tcDepthMap, 1);
+
+                std::unique_ptr<CudaDeviceMemoryPitched<float, 2>>& tcDepthMap_dmp = cachedDepthMaps_dmp.at(cacheIndex);
+                const CudaSize<2> tcMapDim(tcDepthMap.Width(), tcDepthMap.Height());
+
+                if(tcDepthMap.Width() == 0 || tcDepthMap.Height() == 0)
                 {
-                    normalMap(i).r() = normalMapPtr[i].x;
-                    normalMap(i).g() = normalMapPtr[i].y;
-                    normalMap(i).b() = normalMapPtr[i].z;
+                    // no depth map for this T camera
+                    tcDepthMap_dmp.reset();
+                }
+                else
+                {
+                    if(tcDepthMap_dmp == nullptr || tcDepthMap_dmp->getSize() != tcMapDim)
+                        tcDepthMap_dmp.reset(new CudaDeviceMemoryPitched<float, 2>(tcMapDim));
+
+                    tcDepthMap_dmp->copyFrom(tcDepthMap.data(), tcDepthMap.Width(), tcDepthMap.Height());
                 }
             }
 
-            image::writeImage(normalMapFilepath, normalMap,
-                              image::ImageWriteOptions().toColorSpace(image::EImageColorSpace::LINEAR)
-                                                        .storageDataType(image::EStorageDataType::Float));
+            if(cachedDepthMaps_dmp.at(cacheIndex) == nullptr)
+                continue;
 
-            ALICEVISION_LOG_INFO("Compute normal map (rc: " << rc << ") done in: " << timer.elapsedMs() << " ms.");
+            const CudaDeviceMemoryPitched<float, 2>& tcDepthMap_dmp = *cachedDepthMaps_dmp.at(cacheIndex);
+
+            fillHostCameraParameters(tcCamParams, tc, 1, mp);
+
+            cuda_depthMapCountConsistentCams(tcStampMap_dmp,
+                                             nbConsistentCamsMap_dmp,
+                                             depthMap_dmp,
+                                             simMap_dmp,
+                                             tcDepthMap_dmp,
+                                             rcCamParams,
+                                             tcCamParams,
+                                             filterParams,
+                                             c + 1 /* T camera stamp */,
+                                             mp.g_border,
+                                             stream);
         }
+
+        // download the number of consistent cameras map before the filtering
+        std::vector<int> nbConsistentCamsMap(width * height);
+        nbConsistentCamsMap_dmp.copyTo(nbConsistentCamsMap.data(), width, height);
+
+        cuda_depthMapFilterByConsistentCams(depthMap_dmp, simMap_dmp, nbConsistentCamsMap_dmp, filterParams, stream);
+
+        // compute the normal map from the filtered depth map while it is in device memory
+        std::vector<float3> normalMap;
+        if(computeNormalMap)
+        {
+            CudaDeviceMemoryPitched<float3, 2> normalMap_dmp(rcMapDim);
+            DeviceKernelTimer::getInstance().setStreamCamera(stream, rc);
+            cuda_depthMapComputeNormal(normalMap_dmp, depthMap_dmp, rcCamParams, 3 /* wsh */, stream);
+
+            normalMap.resize(width * height);
+            normalMap_dmp.copyTo(normalMap.data(), width, height);
+            DeviceKernelTimer::getInstance().flush();
+        }
+
+        depthMap_dmp.copyTo(depthMap.data(), width, height);
+        simMap_dmp.copyTo(simMap.data(), width, height);
+
+        image::Image<unsigned char> numOfModalsMap(width, height, true, 0);
+        for(int i = 0; i < width * height; ++i)
+            numOfModalsMap(i) = static_cast<unsigned char>(std::min(nbConsistentCamsMap[i], 255));
+
+        image::writeImageWithFloat(nmodMapFilepath,
+                                   numOfModalsMap,
+                                   image::ImageWriteOptions().toColorSpace(image::EImageColorSpace::LINEAR)
+                                                             .storageDataType(image::EStorageDataType::Float));
+
+        mvsUtils::writeDepthSimMap(rc, mp, depthMap, simMap, 0);
+
+        if(computeNormalMap)
+            writeNormalMap(rc, mp, normalMap.data(), width, height);
+
+        ALICEVISION_LOG_INFO("Filter depth map (rc: " << rc << ") done in: " << timer.elapsedMs() << " ms.");
     }
+
+    if(!normalMapCams.empty())
+        computeNormalMaps(cudaDeviceId, mp, normalMapCams);
 }
 
 } // namespace depthMap
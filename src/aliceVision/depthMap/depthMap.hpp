@@ -15,8 +15,49 @@ namespace mvsUtils { class MultiViewParams; }
 
 namespace depthMap {
 
+struct DepthMapParams;
+
 void estimateAndRefineDepthMaps(int cudaDeviceId, mvsUtils::MultiViewParams& mp, const std::vector<int>& cams);
 void computeNormalMaps(int cudaDeviceId, mvsUtils::MultiViewParams& mp, const std::vector<int>& cams);
 
+/**
+ * @brief Filter the depth/sim map of each R camera according to its consistency with the neighbor cameras depth maps.
+ *        GPU implementation of fuseCut::Fuser::filterGroups and fuseCut::Fuser::filterDepthMaps,
+ *        the parameters are read from the "depthMapFiltering" user parameters.
+ *        If "depthMapFiltering.computeNormalMaps" is set, the normal maps are computed from the filtered depth maps in device memory.
+ * @param[in] cudaDeviceId the CUDA device id
+ * @param[in] mp the multi-view parameters
+ * @param[in] cams the R camera index list
+ */
+void filterDepthMaps(int cudaDeviceId, mvsUtils::MultiViewParams& mp, const std::vector<int>& cams);
+
+/**
+ * @brief Estimate the depth map computation cost of each R camera,
+ *        from the number of pixels, the number of SGM depths and the number of T cameras.
+ * @param[in] mp the multi-view parameters
+ * @param[in] cams the R camera index list
+ * @param[out] costs the estimated cost of each R camera
+ */
+void estimateDepthMapsCost(const mvsUtils::MultiViewParams& mp, const std::vector<int>& cams, std::vector<double>& costs);
+
+/**
+ * @brief Estimate the device memory used to compute the depth map of an image:
+ *        the input images (R + Ts) and the Sgm and Refine buffers of all its tiles.
+ *        The buffers are sized from their dimensions, nothing is allocated on the device.
+ * @param[in] mp the multi-view parameters
+ * @param[in] depthMapParams the depth map parameters, SGM scale and step should be computed
+ * @return the estimated device memory per image (in MB)
+ */
+double getDeviceMemoryPerImage(const mvsUtils::MultiViewParams& mp, const DepthMapParams& depthMapParams);
+
+/**
+ * @brief Choose the highest quality preset fitting the per image time and device memory budgets.
+ *        The user parameters are the highest quality preset.
+ * @param[in] mp the multi-view parameters
+ * @param[in,out] depthMapParams the depth map parameters, SGM scale and step should be computed
+ * @return the predicted computation time per image (in seconds)
+ */
+double autoTuneDepthMapParams(const mvsUtils::MultiViewParams& mp, DepthMapParams& depthMapParams);
+
 } // namespace depthMap
 } // namespace aliceVision
@@ -0,0 +1,126 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/depthMap/depthMap.hpp>
+#include <aliceVision/depthMap/DepthMapParams.hpp>
+#include <aliceVision/depthMap/Sgm.hpp>
+#include <aliceVision/depthMap/Refine.hpp>
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/camera/Pinhole.hpp>
+#include <aliceVision/gpu/gpu.hpp>
+
+#define BOOST_TEST_MODULE depthMap
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+
+namespace {
+
+/// two 1920x1080 cameras, only the image dimensions are used by the estimations
+sfmData::SfMData makeSfMData()
+{
+    sfmData::SfMData sfmData;
+    sfmData.intrinsics[0] = std::make_shared<camera::Pinhole>(1920, 1080, 1500.0, 1500.0, 0.0, 0.0);
+    for(IndexT viewId = 0; viewId < 2; ++viewId)
+    {
+        sfmData.views[viewId] = std::make_shared<sfmData::View>("", viewId, 0, viewId, 1920, 1080);
+        sfmData.setPose(*sfmData.views[viewId], sfmData::CameraPose(geometry::Pose3(Mat3::Identity(), Vec3(viewId, 0.0, 0.0))));
+    }
+    return sfmData;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(depthMap_autoTuneDeviceMemory)
+{
+    const sfmData::SfMData sfmData = makeSfMData();
+    const mvsUtils::MultiViewParams mp(sfmData);
+
+    depthMap::DepthMapParams userParams;
+    const double userMemoryMB = depthMap::getDeviceMemoryPerImage(mp, userParams);
+    BOOST_CHECK_GT(userMemoryMB, 0.0);
+
+    // the user parameters fit the budget, they are kept
+    {
+        depthMap::DepthMapParams depthMapParams = userParams;
+        depthMapParams.maxDeviceMemoryPerImage = userMemoryMB * 1.01;
+        depthMap::autoTuneDepthMapParams(mp, depthMapParams);
+        BOOST_CHECK_EQUAL(depthMapParams.maxTCams, userParams.maxTCams);
+        BOOST_CHECK_EQUAL(depthMapParams.sgmParams.maxDepths, userParams.sgmParams.maxDepths);
+        BOOST_CHECK_EQUAL(depthMapParams.refineParams.halfNbDepths, userParams.refineParams.halfNbDepths);
+    }
+
+    // a lower quality preset fits a smaller budget
+    {
+        depthMap::DepthMapParams depthMapParams = userParams;
+        depthMapParams.maxDeviceMemoryPerImage = userMemoryMB * 0.6;
+        depthMap::autoTuneDepthMapParams(mp, depthMapParams);
+        BOOST_CHECK_LE(depthMap::getDeviceMemoryPerImage(mp, depthMapParams), depthMapParams.maxDeviceMemoryPerImage);
+        BOOST_CHECK_LT(depthMapParams.sgmParams.maxDepths, userParams.sgmParams.maxDepths);
+        BOOST_CHECK_LE(depthMapParams.maxTCams, userParams.maxTCams);
+    }
+
+    // no preset fits, the lowest quality preset is used
+    {
+        depthMap::DepthMapParams depthMapParams = userParams;
+        depthMapParams.maxDeviceMemoryPerImage = 1.0;
+        depthMap::autoTuneDepthMapParams(mp, depthMapParams);
+        BOOST_CHECK_EQUAL(depthMapParams.maxTCams, 4);
+        BOOST_CHECK_EQUAL(depthMapParams.sgmParams.stepXY, userParams.sgmParams.stepXY + 2);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(depthMap_autoTuneTime)
+{
+    const sfmData::SfMData sfmData = makeSfMData();
+    const mvsUtils::MultiViewParams mp(sfmData);
+
+    depthMap::DepthMapParams userParams;
+
+    depthMap::DepthMapParams depthMapParams = userParams;
+    depthMapParams.targetTimePerImage = 1e6;
+    const double userTime = depthMap::autoTuneDepthMapParams(mp, depthMapParams);
+    BOOST_CHECK_GT(userTime, 0.0);
+    BOOST_CHECK_EQUAL(depthMapParams.sgmParams.maxDepths, userParams.sgmParams.maxDepths);
+
+    // the predicted time of the selected preset fits the target
+    depthMapParams = userParams;
+    depthMapParams.targetTimePerImage = userTime * 0.5;
+    const double predictedTime = depthMap::autoTuneDepthMapParams(mp, depthMapParams);
+    BOOST_CHECK_LE(predictedTime, depthMapParams.targetTimePerImage);
+    BOOST_CHECK_LT(depthMapParams.sgmParams.maxDepths, userParams.sgmParams.maxDepths);
+}
+
+BOOST_AUTO_TEST_CASE(depthMap_estimateDeviceMemoryConsumption)
+{
+    if(!gpu::gpuSupportCUDA(3, 0))
+    {
+        BOOST_TEST_MESSAGE("No CUDA device, the estimations are not compared to the allocations.");
+        return;
+    }
+
+    const sfmData::SfMData sfmData = makeSfMData();
+    const mvsUtils::MultiViewParams mp(sfmData);
+
+    for(int maxDepths : {64, 1500})
+    {
+        depthMap::DepthMapParams depthMapParams;
+        depthMapParams.sgmParams.maxDepths = maxDepths;
+
+        // the estimation assumes the usual pitch alignment, allow a small difference with the device one
+        const double sgmEstimatedMB = depthMap::Sgm::estimateDeviceMemoryConsumption(depthMapParams.tileParams, depthMapParams.sgmParams);
+        const double sgmAllocatedMB = depthMap::Sgm(mp, depthMapParams.tileParams, depthMapParams.sgmParams, 0).getDeviceMemoryConsumption();
+        BOOST_CHECK_GE(sgmEstimatedMB, sgmAllocatedMB * 0.9);
+        BOOST_CHECK_LE(sgmEstimatedMB, sgmAllocatedMB * 1.1);
+
+        const double refineEstimatedMB = depthMap::Refine::estimateDeviceMemoryConsumption(depthMapParams.tileParams, depthMapParams.refineParams);
+        const double refineAllocatedMB = depthMap::Refine(mp, depthMapParams.tileParams, depthMapParams.refineParams, 0).getDeviceMemoryConsumption();
+        BOOST_CHECK_GE(refineEstimatedMB, refineAllocatedMB * 0.9);
+        BOOST_CHECK_LE(refineEstimatedMB, refineAllocatedMB * 1.1);
+    }
+}
@@ -9,6 +9,7 @@
 
 #include <aliceVision/numeric/numeric.hpp>
 
+#include <cstring>
 #include <iostream>
 #include <iterator>
 #include <fstream>
@@ -296,6 +297,47 @@ inline void loadDescsFromBinFile(
   fileIn.close();
 }
 
+/**
+ * @brief Load descriptors from a memory buffer containing a binary descriptors file (.desc).
+ * @see loadDescsFromBinFile
+ * @param[in] data The beginning of the buffer
+ * @param[in] size The buffer size in bytes
+ * @param[out] vec_desc A vector of descriptors that stores the descriptors to load
+ * @param[in] sourceName The name of the buffer source used in error messages
+ */
+template<typename DescriptorT, typename FileDescriptorT = DescriptorT>
+inline void loadDescsFromBinBuffer(
+  const char* data,
+  std::size_t size,
+  std::vector<DescriptorT> & vec_desc,
+  const std::string& sourceName)
+{
+  vec_desc.clear();
+
+  if(size < sizeof(std::size_t))
+    throw std::runtime_error("Can't load binary descriptors, '" + sourceName + "' is incorrect !");
+
+  std::size_t cardDesc = 0;
+  std::memcpy(&cardDesc, data, sizeof(std::size_t));
+
+  // Compute the memory size of one descriptor
+  constexpr std::size_t oneDescSize = FileDescriptorT::static_size * sizeof(typename FileDescriptorT::bin_type);
+
+  if(size < sizeof(std::size_t) + cardDesc * oneDescSize)
+    throw std::runtime_error("Can't load binary descriptors, '" + sourceName + "' is truncated !");
+
+  vec_desc.resize(cardDesc);
+
+  const char* ptr = data + sizeof(std::size_t);
+  FileDescriptorT fileDescriptor;
+  for(DescriptorT& desc : vec_desc)
+  {
+    std::memcpy(fileDescriptor.getData(), ptr, oneDescSize);
+    convertDesc<FileDescriptorT, DescriptorT>(fileDescriptor, desc);
+    ptr += oneDescSize;
+  }
+}
+
 /// Write descriptors to file (in binary mode)
 template<typename DescriptorsT >
 inline void saveDescsToBinFile(
@@ -5,47 +5,251 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "FeatureExtractor.hpp"
+#include <aliceVision/image/imageCache.hpp>
 #include <aliceVision/image/io.hpp>
 #include <aliceVision/system/MemoryInfo.hpp>
-#include <aliceVision/alicevision_omp.hpp>
+#include <aliceVision/system/Profiler.hpp>
+#include <aliceVision/system/TaskScheduler.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <ctime>
+#include <exception>
+#include <functional>
+#include <fstream>
 #include <iomanip>
+#include <limits>
+#include <mutex>
+#include <regex>
+#include <set>
 
 namespace fs = boost::filesystem;
+namespace bpt = boost::property_tree;
 
 namespace aliceVision {
 namespace feature {
 
+/// Number of views described together on the GPU
+static const std::size_t gpuJobsBatchSize = 4;
+
 FeatureExtractorViewJob::FeatureExtractorViewJob(const sfmData::View& view,
                                                  const std::string& outputFolder) :
     _view(view),
-    _outputBasename(fs::path(fs::path(outputFolder) / fs::path(std::to_string(view.getViewId()))).string())
+    _outputBasename(outputFolder.empty() ? "" : fs::path(fs::path(outputFolder) / fs::path(std::to_string(view.getViewId()))).string())
 {}
 
 FeatureExtractorViewJob::~FeatureExtractorViewJob() = default;
 
+namespace {
+
+/// Increment when the content of the manifest files changes
+const int manifestVersion = 1;
+
+/// Hash of the content of a file
+std::size_t computeFileHash(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        throw std::runtime_error("Cannot read the file '" + path + "' to compute its hash.");
+
+    std::size_t hash = 0;
+    std::vector<char> buffer(1024 * 1024);
+    while (file)
+    {
+        file.read(buffer.data(), buffer.size());
+        boost::hash_range(hash, buffer.begin(), buffer.begin() + file.gcount());
+    }
+    return hash;
+}
+
+/// Size and modification time of a file, the empty path has a null signature
+bpt::ptree getFileSignature(const std::string& path)
+{
+    bpt::ptree signature;
+    signature.put("path", path);
+    signature.put("size", path.empty() ? std::uintmax_t(0) : fs::file_size(path));
+    signature.put("writeTime", path.empty() ? std::time_t(0) : fs::last_write_time(path));
+    return signature;
+}
+
+/// Remove the temporary outputs of the given views left by an interrupted extraction
+void removeTemporaryOutputs(const std::string& outputFolder, const std::set<IndexT>& viewIds)
+{
+    // temporary outputs are named "<viewId>.<describer>.<unique>.feat|desc" or "<viewId>.<describer>.manifest.json.<unique>.tmp"
+    const std::regex temporaryFileRegex(R"((\d{1,10})\.\w+\.(manifest\.json\.)?[0-9a-f]{4}-[0-9a-f]{4}-[0-9a-f]{4}-[0-9a-f]{4}\.(feat|desc|tmp))");
+
+    boost::system::error_code ec;
+    for (fs::directory_iterator it(outputFolder, ec), end; !ec && it != end; it.increment(ec))
+    {
+        const std::string filename = it->path().filename().string();
+        std::smatch match;
+        if (std::regex_match(filename, match, temporaryFileRegex) &&
+            viewIds.count(std::stoul(match[1].str())))
+        {
+            ALICEVISION_LOG_INFO("Remove the temporary file '" << it->path().string() << "' of an interrupted extraction.");
+            fs::remove(it->path(), ec);
+        }
+    }
+}
+
+/**
+ * @brief Hand out the jobs in order, each one once its memory consumption fits in the budget.
+ * A job larger than the whole budget runs once no other job is running.
+ * The admission never waits: the jobs not admitted are admitted later, when a running job releases its memory.
+ */
+class MemoryBudgetScheduler
+{
+public:
+    MemoryBudgetScheduler(const std::vector<FeatureExtractorViewJob>& jobs, std::size_t budget, std::size_t maxRunningJobs)
+      : _jobs(jobs)
+      , _budget(budget)
+      , _maxRunningJobs(maxRunningJobs)
+    {}
+
+    /// Admit the next jobs whose memory is available, return their indexes (none if the next job does not fit yet)
+    std::vector<int> admitAvailable()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::vector<int> admitted;
+        while (_nextJob < _jobs.size() &&
+               _nbRunningJobs < _maxRunningJobs &&
+               (_nbRunningJobs == 0 || _usedMemory + _jobs.at(_nextJob).memoryConsuption() <= _budget))
+        {
+            _usedMemory += _jobs.at(_nextJob).memoryConsuption();
+            ++_nbRunningJobs;
+            admitted.push_back(static_cast<int>(_nextJob++));
+        }
+        return admitted;
+    }
+
+    /// Release the memory of a finished job
+    void release(int jobIndex)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _usedMemory -= _jobs.at(jobIndex).memoryConsuption();
+        --_nbRunningJobs;
+    }
+
+private:
+    const std::vector<FeatureExtractorViewJob>& _jobs;
+    const std::size_t _budget;
+    const std::size_t _maxRunningJobs;
+    std::size_t _nextJob = 0;
+    std::size_t _usedMemory = 0;
+    std::size_t _nbRunningJobs = 0;
+    std::mutex _mutex;
+};
+
+} // namespace
+
+bool FeatureExtractorViewJob::isUpToDate(feature::EImageDescriberType imageDescriberType,
+                                         const std::string& settings,
+                                         const std::string& maskPath) const
+{
+    // without output folder, the regions are only kept in memory
+    if (_outputBasename.empty())
+        return false;
+
+    if (!fs::exists(getFeaturesPath(imageDescriberType)) ||
+        !fs::exists(getDescriptorPath(imageDescriberType)))
+        return false;
+
+    if (settings.empty())
+        return true;
+
+    const std::string manifestPath = getManifestPath(imageDescriberType);
+    if (!fs::exists(manifestPath))
+        return false;
+
+    try
+    {
+        bpt::ptree manifest;
+        bpt::read_json(manifestPath, manifest);
+
+        if (manifest.get<int>("version", 0) != manifestVersion ||
+            manifest.get<std::string>("settings") != settings ||
+            manifest.get_child("mask") != getFileSignature(maskPath))
+            return false;
+
+        // the image content is only hashed if the file was copied or touched
+        const std::string& imagePath = _view.getImagePath();
+        const bpt::ptree imageSignature = getFileSignature(imagePath);
+        if (manifest.get<std::uintmax_t>("image.size") != imageSignature.get<std::uintmax_t>("size"))
+            return false;
+        if (manifest.get<std::time_t>("image.writeTime") == imageSignature.get<std::time_t>("writeTime"))
+            return true;
+        return manifest.get<std::size_t>("image.hash") == computeFileHash(imagePath);
+    }
+    catch (const std::exception& e)
+    {
+        ALICEVISION_LOG_WARNING("Invalid features manifest '" << manifestPath << "': " << e.what());
+        return false;
+    }
+}
+
+void FeatureExtractorViewJob::saveManifest(feature::EImageDescriberType imageDescriberType,
+                                           const std::string& settings,
+                                           const std::string& maskPath) const
+{
+    const std::string& imagePath = _view.getImagePath();
+    bpt::ptree imageSignature = getFileSignature(imagePath);
+    imageSignature.put("hash", computeFileHash(imagePath));
+
+    bpt::ptree manifest;
+    manifest.put("version", manifestVersion);
+    manifest.put("settings", settings);
+    manifest.add_child("image", imageSignature);
+    manifest.add_child("mask", getFileSignature(maskPath));
+
+    // the manifest is written once the features and descriptors files are complete
+    const std::string manifestPath = getManifestPath(imageDescriberType);
+    const std::string tmpManifestPath = manifestPath + "." + fs::unique_path().string() + ".tmp";
+    bpt::write_json(tmpManifestPath, manifest);
+    fs::rename(tmpManifestPath, manifestPath);
+}
+
 void FeatureExtractorViewJob::setImageDescribers(
-        const std::vector<std::shared_ptr<feature::ImageDescriber>>& imageDescribers)
+        const std::vector<std::shared_ptr<feature::ImageDescriber>>& imageDescribers,
+        const std::string& settings,
+        const std::string& maskPath)
 {
+    std::size_t describerMaxMemoryConsuption = 0;
+    bool useUCharImage = false;
+
     for (std::size_t i = 0; i < imageDescribers.size(); ++i)
     {
         const std::shared_ptr<feature::ImageDescriber>& imageDescriber = imageDescribers.at(i);
         feature::EImageDescriberType imageDescriberType = imageDescriber->getDescriberType();
 
-        if (fs::exists(getFeaturesPath(imageDescriberType)) &&
-            fs::exists(getDescriptorPath(imageDescriberType)))
+        if (isUpToDate(imageDescriberType, settings, maskPath))
         {
+            ALICEVISION_LOG_INFO("Skip the up-to-date " << imageDescriberType << " features of view '"
+                                 << _view.getImagePath() << "'");
             continue;
         }
 
-        _memoryConsuption += imageDescriber->getMemoryConsumption(_view.getWidth(),
-                                                                  _view.getHeight());
+        describerMaxMemoryConsuption = std::max(describerMaxMemoryConsuption,
+                                                imageDescriber->getMemoryConsumption(_view.getWidth(),
+                                                                                     _view.getHeight()));
+        useUCharImage = useUCharImage || !imageDescriber->useFloatImage();
 
         if(imageDescriber->useCuda())
             _gpuImageDescriberIndexes.push_back(i);
         else
             _cpuImageDescriberIndexes.push_back(i);
     }
+
+    if (describerMaxMemoryConsuption == 0)
+        return;
+
+    // the describers of a view run one after the other on the image buffers decoded once for the view
+    const std::size_t nbPixels = _view.getWidth() * _view.getHeight();
+    _memoryConsuption = describerMaxMemoryConsuption + nbPixels * sizeof(float);
+    if (useUCharImage)
+        _memoryConsuption += nbPixels * sizeof(unsigned char);
 }
 
 
@@ -73,25 +277,54 @@ void FeatureExtractor::process(const HardwareContext & hContext)
     }
 
     std::size_t jobMaxMemoryConsuption = 0;
+    std::size_t jobMinMemoryConsuption = std::numeric_limits<std::size_t>::max();
+    std::size_t gpuJobMaxMemoryConsuption = 0;
 
     std::vector<FeatureExtractorViewJob> cpuJobs;
     std::vector<FeatureExtractorViewJob> gpuJobs;
+    std::size_t sharedImageMaxSize = 0;
+
+    std::set<IndexT> viewIds;
+    std::vector<const sfmData::View*> views;
+    for (auto it = itViewBegin; it != itViewEnd; ++it)
+    {
+        viewIds.insert(it->second->getViewId());
+        views.push_back(it->second.get());
+    }
+
+    // the outputs of the views being extracted when a previous run was interrupted are recomputed
+    removeTemporaryOutputs(_outputFolder, viewIds);
 
     for (auto it = itViewBegin; it != itViewEnd; ++it)
     {
         const sfmData::View& view = *(it->second.get());
         FeatureExtractorViewJob viewJob(view, _outputFolder);
 
-        viewJob.setImageDescribers(_imageDescribers);
-        jobMaxMemoryConsuption = std::max(jobMaxMemoryConsuption, viewJob.memoryConsuption());
+        viewJob.setImageDescribers(_imageDescribers, _settings, getViewMaskPath(view));
 
         if (viewJob.useCPU())
+        {
+            jobMaxMemoryConsuption = std::max(jobMaxMemoryConsuption, viewJob.memoryConsuption());
+            jobMinMemoryConsuption = std::min(jobMinMemoryConsuption, viewJob.memoryConsuption());
             cpuJobs.push_back(viewJob);
+        }
 
         if (viewJob.useGPU())
+        {
+            gpuJobMaxMemoryConsuption = std::max(gpuJobMaxMemoryConsuption, viewJob.memoryConsuption());
             gpuJobs.push_back(viewJob);
+        }
+
+        if (viewJob.useCPU() && viewJob.useGPU())
+            sharedImageMaxSize = std::max(sharedImageMaxSize, view.getWidth() * view.getHeight() * sizeof(float));
     }
 
+    // the images of the views described both on the CPU and on the GPU are decoded once
+    image::ImageCache imageCache;
+
+    std::size_t nbThreads = 0;
+    std::size_t memoryBudget = 0;
+
     if (!cpuJobs.empty())
     {
         system::MemoryInfo memoryInformation = system::getMemoryInfo();
@@ -101,19 +334,23 @@ void FeatureExtractor::process(const HardwareContext & hContext)
         size_t maxMemory = std::min(memoryInformation.availableRam, maxAvailableMemory);
         size_t maxTotalMemory = std::min(memoryInformation.totalRam, maxAvailableMemory);
 
-        ALICEVISION_LOG_INFO("Job max memory consumption for one image: "
+        ALICEVISION_LOG_INFO("Job memory consumption for one image: "
+                             << jobMinMemoryConsuption / (1024*1024) << " MB to "
                              << jobMaxMemoryConsuption / (1024*1024) << " MB");
         ALICEVISION_LOG_INFO("Memory information: " << std::endl << memoryInformation);
 
         if (jobMaxMemoryConsuption == 0)
             throw std::runtime_error("Cannot compute feature extraction job max memory consumption.");
 
-        // How many buffers can fit in 90% of the available RAM?
-        // This is used to estimate how many jobs can be computed in parallel without SWAP.
-        const std::size_t memoryImageCapacity =
-                std::size_t((0.9 * maxMemory) / jobMaxMemoryConsuption);
+        // The jobs run in parallel while their memory consumption fits in 90% of the available RAM, without SWAP.
+        // The memory of one batch of jobs is kept for the GPU thread.
+        const std::size_t gpuMemory = gpuJobs.empty() ? 0 : gpuJobsBatchSize * gpuJobMaxMemoryConsuption;
+        memoryBudget = std::size_t(0.9 * maxMemory);
+        memoryBudget -= std::min(memoryBudget, gpuMemory);
 
-        std::size_t nbThreads = std::max(std::size_t(1), memoryImageCapacity);
+        // more threads than the smallest jobs fitting in the budget would only wait
+        nbThreads = std::max(std::size_t(1), memoryBudget / std::max(std::size_t(1), jobMinMemoryConsuption));
+        ALICEVISION_LOG_INFO("Memory budget for extraction: " << memoryBudget / (1024*1024) << " MB");
         ALICEVISION_LOG_INFO("Max number of threads regarding memory usage: " << nbThreads);
         const double oneGB = 1024.0 * 1024.0 * 1024.0;
         if (jobMaxMemoryConsuption > maxMemory)
@@ -147,54 +384,196 @@ void FeatureExtractor::process(const HardwareContext & hContext)
           ALICEVISION_LOG_WARNING("Cannot find available system memory, this can be due to OS limitation.\n"
                                   "Use only one thread for CPU feature extraction.");
           nbThreads = 1;
+          memoryBudget = 0;
         }
 
-        // nbThreads should not be higher than the available cores
-        nbThreads = std::min(static_cast<std::size_t>(maxAvailableCores), nbThreads);
+        // nbThreads should not be higher than the available cores, one of them is kept for the GPU thread
+        const std::size_t maxCpuCores = (gpuJobs.empty() || maxAvailableCores <= 1) ? maxAvailableCores : maxAvailableCores - 1;
+        nbThreads = std::min(maxCpuCores, nbThreads);
 
         // nbThreads should not be higher than the number of jobs
         nbThreads = std::min(cpuJobs.size(), nbThreads);
 
         ALICEVISION_LOG_INFO("# threads for extraction: " << nbThreads);
-        omp_set_nested(1);
-
-#pragma omp parallel for num_threads(nbThreads)
-        for (int i = 0; i < cpuJobs.size(); ++i)
-            computeViewJob(cpuJobs.at(i), false);
     }
 
+    // a shared image is kept until the other job of its view uses it, or until it is evicted by the next ones
+    imageCache.setMaxSize((nbThreads + 1) * sharedImageMaxSize);
+
+    system::TaskGroup group;
+
+    // the GPU jobs mostly wait on the device, they run on an IO thread concurrently with the CPU jobs
     if (!gpuJobs.empty())
     {
-        for (const auto& job : gpuJobs)
-            computeViewJob(job, true);
+        group.runIO([&]() {
+            for (std::size_t i = 0; i < gpuJobs.size(); i += gpuJobsBatchSize)
+            {
+                std::vector<const FeatureExtractorViewJob*> batch;
+                for (std::size_t j = i; j < std::min(i + gpuJobsBatchSize, gpuJobs.size()); ++j)
+                    batch.push_back(&gpuJobs.at(j));
+                computeGpuViewJobs(batch, imageCache);
+            }
+        });
     }
+
+    // each finished job starts the next ones whose memory is available, small images run wide and big ones alone.
+    // No task waits for the memory, so the threads left idle run the parallel loops of the describers.
+    MemoryBudgetScheduler scheduler(cpuJobs, memoryBudget, std::max(std::size_t(1), nbThreads));
+    std::function<void()> startAdmittedJobs;
+    startAdmittedJobs = [&]() {
+        for (const int i : scheduler.admitAvailable())
+        {
+            group.run([&, i]() {
+                try
+                {
+                    computeViewJob(cpuJobs.at(i), false, imageCache);
+                }
+                catch (...)
+                {
+                    scheduler.release(i);
+                    throw;
+                }
+                scheduler.release(i);
+                startAdmittedJobs();
+            });
+        }
+    };
+    startAdmittedJobs();
+
+    group.wait();
+
+    if (_regionsPerView)
+        loadSkippedRegions(views);
 }
 
-void FeatureExtractor::computeViewJob(const FeatureExtractorViewJob& job, bool useGPU)
+void FeatureExtractor::loadSkippedRegions(const std::vector<const sfmData::View*>& views)
 {
-    image::Image<float> imageGrayFloat;
-    image::Image<unsigned char> imageGrayUChar;
-    image::Image<unsigned char> mask;
+    for (const sfmData::View* view : views)
+    {
+        const FeatureExtractorViewJob job(*view, _outputFolder);
+        for (const auto& imageDescriber : _imageDescribers)
+        {
+            const feature::EImageDescriberType imageDescriberType = imageDescriber->getDescriberType();
+            const auto viewIt = _regionsPerView->getData().find(view->getViewId());
+            if (viewIt != _regionsPerView->getData().end() && viewIt->second.count(imageDescriberType))
+                continue;
+
+            std::unique_ptr<feature::Regions> regions;
+            imageDescriber->allocate(regions);
+            imageDescriber->Load(regions.get(), job.getFeaturesPath(imageDescriberType),
+                                 job.getDescriptorPath(imageDescriberType));
+            _regionsPerView->addRegions(view->getViewId(), imageDescriberType, regions.release());
+        }
+    }
+}
+
+std::shared_ptr<image::Image<float>> FeatureExtractor::readViewImage(const FeatureExtractorViewJob& job,
+                                                                     image::ImageCache& imageCache) const
+{
+    if (job.useCPU() && job.useGPU())
+    {
+        // the concurrent requests of the CPU and GPU jobs wait for the same decoding
+        return imageCache.get<float>(job.view().getImagePath(),
+                                     image::ImageReadOptions(image::EImageColorSpace::SRGB));
+    }
 
-    image::readImage(job.view().getImagePath(), imageGrayFloat, image::EImageColorSpace::SRGB);
+    std::shared_ptr<image::Image<float>> imageGrayFloat = std::make_shared<image::Image<float>>();
+    image::readImage(job.view().getImagePath(), *imageGrayFloat, image::EImageColorSpace::SRGB);
+    return imageGrayFloat;
+}
 
+std::string FeatureExtractor::getViewMaskPath(const sfmData::View& view) const
+{
     if (!_masksFolder.empty() && fs::exists(_masksFolder))
     {
         const auto masksFolder = fs::path(_masksFolder);
         const auto idMaskPath = masksFolder /
-                fs::path(std::to_string(job.view().getViewId())).replace_extension("png");
+                fs::path(std::to_string(view.getViewId())).replace_extension("png");
         const auto nameMaskPath = masksFolder /
-                fs::path(job.view().getImagePath()).filename().replace_extension("png");
+                fs::path(view.getImagePath()).filename().replace_extension("png");
 
         if (fs::exists(idMaskPath))
+            return idMaskPath.string();
+        if (fs::exists(nameMaskPath))
+            return nameMaskPath.string();
+    }
+    return "";
+}
+
+void FeatureExtractor::readViewMask(const FeatureExtractorViewJob& job, image::Image<unsigned char>& mask) const
+{
+    const std::string maskPath = getViewMaskPath(job.view());
+    if (!maskPath.empty())
+        image::readImage(maskPath, mask, image::EImageColorSpace::LINEAR);
+}
+
+void FeatureExtractor::saveViewRegions(const FeatureExtractorViewJob& job,
+                                       const feature::ImageDescriber& imageDescriber,
+                                       std::unique_ptr<feature::Regions>& regions,
+                                       const image::Image<unsigned char>& mask)
+{
+    const feature::EImageDescriberType imageDescriberType = imageDescriber.getDescriberType();
+    const std::string imageDescriberTypeName =
+            feature::EImageDescriberType_enumToString(imageDescriberType);
+
+    if (mask.Height() > 0)
+    {
+        std::vector<feature::FeatureInImage> selectedIndices;
+        for (size_t i=0, n=regions->RegionCount(); i != n; ++i)
         {
-            image::readImage(idMaskPath.string(), mask, image::EImageColorSpace::LINEAR);
-        }
-        else if (fs::exists(nameMaskPath))
-        {
-            image::readImage(nameMaskPath.string(), mask, image::EImageColorSpace::LINEAR);
+            const Vec2 position = regions->GetRegionPosition(i);
+            const int x = int(position.x());
+            const int y = int(position.y());
+
+            bool masked = false;
+            if (x < mask.Width() && y < mask.Height())
+            {
+                if (mask(y, x) == 0)
+                {
+                    masked = true;
+                }
+            }
+
+            if (!masked)
+            {
+                selectedIndices.push_back({IndexT(i), 0});
+            }
         }
+
+        std::vector<IndexT> out_associated3dPoint;
+        std::map<IndexT, IndexT> out_mapFullToLocal;
+        regions = regions->createFilteredRegions(selectedIndices, out_associated3dPoint,
+                                                 out_mapFullToLocal);
+    }
+
+    if (!_outputFolder.empty())
+    {
+        imageDescriber.Save(regions.get(), job.getFeaturesPath(imageDescriberType),
+                            job.getDescriptorPath(imageDescriberType), _featuresFileFormat);
+        if (!_settings.empty())
+            job.saveManifest(imageDescriberType, _settings, getViewMaskPath(job.view()));
+    }
+    ALICEVISION_LOG_INFO(std::left << std::setw(6) << " " << regions->RegionCount() << " "
+                         << imageDescriberTypeName  << " features extracted from view '"
+                         << job.view().getImagePath() << "'");
+
+    if (_regionsPerView)
+    {
+        std::lock_guard<std::mutex> lock(_regionsPerViewMutex);
+        _regionsPerView->addRegions(job.view().getViewId(), imageDescriberType, regions.release());
     }
+}
+
+void FeatureExtractor::computeViewJob(const FeatureExtractorViewJob& job, bool useGPU, image::ImageCache& imageCache)
+{
+    ALICEVISION_PROFILE_ZONE("featureExtraction");
+
+    const std::shared_ptr<image::Image<float>> imageGrayFloatPtr = readViewImage(job, imageCache);
+    const image::Image<float>& imageGrayFloat = *imageGrayFloatPtr;
+    image::Image<unsigned char> imageGrayUChar;
+    image::Image<unsigned char> mask;
+
+    readViewMask(job, mask);
 
     for (const auto & imageDescriberIndex : job.imageDescriberIndexes(useGPU))
     {
@@ -221,41 +600,71 @@ void FeatureExtractor::computeViewJob(const FeatureExtractorViewJob& job, bool u
             imageDescriber->describe(imageGrayUChar, regions);
         }
 
-        if (mask.Height() > 0)
+        saveViewRegions(job, *imageDescriber, regions, mask);
+    }
+}
+
+void FeatureExtractor::computeGpuViewJobs(const std::vector<const FeatureExtractorViewJob*>& jobs,
+                                          image::ImageCache& imageCache)
+{
+    ALICEVISION_PROFILE_ZONE("featureExtractionGpu");
+
+    std::vector<std::shared_ptr<image::Image<float>>> imagesGrayFloat;
+    std::vector<image::Image<unsigned char>> masks(jobs.size());
+    imagesGrayFloat.reserve(jobs.size());
+
+    for (std::size_t i = 0; i < jobs.size(); ++i)
+    {
+        imagesGrayFloat.push_back(readViewImage(*jobs.at(i), imageCache));
+        readViewMask(*jobs.at(i), masks.at(i));
+    }
+
+    for (std::size_t imageDescriberIndex = 0; imageDescriberIndex < _imageDescribers.size(); ++imageDescriberIndex)
+    {
+        const auto& imageDescriber = _imageDescribers.at(imageDescriberIndex);
+        const std::string imageDescriberTypeName =
+                feature::EImageDescriberType_enumToString(imageDescriber->getDescriberType());
+
+        // jobs of the batch that need this image describer
+        std::vector<std::size_t> jobIndexes;
+        for (std::size_t i = 0; i < jobs.size(); ++i)
         {
-            std::vector<feature::FeatureInImage> selectedIndices;
-            for (size_t i=0, n=regions->RegionCount(); i != n; ++i)
+            const std::vector<std::size_t>& indexes = jobs.at(i)->imageDescriberIndexes(true);
+            if (std::find(indexes.begin(), indexes.end(), imageDescriberIndex) != indexes.end())
             {
-                const Vec2 position = regions->GetRegionPosition(i);
-                const int x = int(position.x());
-                const int y = int(position.y());
+                jobIndexes.push_back(i);
+                ALICEVISION_LOG_INFO("Extracting " << imageDescriberTypeName  << " features from view '"
+                                     << jobs.at(i)->view().getImagePath() << "' [gpu]");
+            }
+        }
 
-                bool masked = false;
-                if (x < mask.Width() && y < mask.Height())
-                {
-                    if (mask(y, x) == 0)
-                    {
-                        masked = true;
-                    }
-                }
+        if (jobIndexes.empty())
+            continue;
 
-                if (!masked)
-                {
-                    selectedIndices.push_back({IndexT(i), 0});
-                }
+        std::vector<std::unique_ptr<feature::Regions>> regions(jobIndexes.size());
+        if (imageDescriber->useFloatImage())
+        {
+            // the images are described together, so their transfers overlap with the extraction
+            std::vector<const image::Image<float>*> images;
+            for (const std::size_t i : jobIndexes)
+                images.push_back(imagesGrayFloat.at(i).get());
+            imageDescriber->describeBatch(images, regions);
+        }
+        else
+        {
+            // the images may be described on several CUDA pipes
+            std::vector<image::Image<unsigned char>> imagesGrayUChar(jobIndexes.size());
+            std::vector<const image::Image<unsigned char>*> images;
+            for (std::size_t r = 0; r < jobIndexes.size(); ++r)
+            {
+                imagesGrayUChar.at(r) = (imagesGrayFloat.at(jobIndexes.at(r))->GetMat() * 255.f).cast<unsigned char>();
+                images.push_back(&imagesGrayUChar.at(r));
             }
-
-            std::vector<IndexT> out_associated3dPoint;
-            std::map<IndexT, IndexT> out_mapFullToLocal;
-            regions = regions->createFilteredRegions(selectedIndices, out_associated3dPoint,
-                                                     out_mapFullToLocal);
+            imageDescriber->describeBatch(images, regions);
         }
 
-        imageDescriber->Save(regions.get(), job.getFeaturesPath(imageDescriberType),
-                             job.getDescriptorPath(imageDescriberType));
-        ALICEVISION_LOG_INFO(std::left << std::setw(6) << " " << regions->RegionCount() << " "
-                             << imageDescriberTypeName  << " features extracted from view '"
-                             << job.view().getImagePath() << "'");
+        for (std::size_t r = 0; r < jobIndexes.size(); ++r)
+            saveViewRegions(*jobs.at(jobIndexes.at(r)), *imageDescriber, regions.at(r), masks.at(jobIndexes.at(r)));
     }
 }
 
@@ -5,10 +5,18 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "ImageDescriber.hpp"
+#include "RegionsPerView.hpp"
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/sfmData/View.hpp>
 #include <aliceVision/system/hardwareContext.hpp>
+
+#include <mutex>
 namespace aliceVision {
+
+namespace image {
+class ImageCache;
+} // namespace image
+
 namespace feature {
 
 class FeatureExtractorViewJob
@@ -39,8 +47,42 @@ public:
         return _outputBasename + "." + EImageDescriberType_enumToString(imageDescriberType) + ".desc";
     }
 
+    /// Path of the manifest of the features and descriptors files
+    std::string getManifestPath(feature::EImageDescriberType imageDescriberType) const
+    {
+        return _outputBasename + "." + EImageDescriberType_enumToString(imageDescriberType) + ".manifest.json";
+    }
+
+    /**
+     * @brief Select the image describers to compute, the ones with up-to-date outputs are skipped
+     * @param[in] imageDescribers the image describers
+     * @param[in] settings the extraction settings, if empty the existing outputs are always up-to-date
+     * @param[in] maskPath the path of the view mask, empty if there is none
+     */
     void setImageDescribers(
-            const std::vector<std::shared_ptr<feature::ImageDescriber>>& imageDescribers);
+            const std::vector<std::shared_ptr<feature::ImageDescriber>>& imageDescribers,
+            const std::string& settings = "",
+            const std::string& maskPath = "");
+
+    /**
+     * @brief Check if the outputs of an image describer exist and match its manifest
+     * @param[in] imageDescriberType the image describer type
+     * @param[in] settings the extraction settings, if empty only the outputs existence is checked
+     * @param[in] maskPath the path of the view mask, empty if there is none
+     */
+    bool isUpToDate(feature::EImageDescriberType imageDescriberType,
+                    const std::string& settings,
+                    const std::string& maskPath) const;
+
+    /**
+     * @brief Write the manifest of the outputs of an image describer, once they are saved
+     * @param[in] imageDescriberType the image describer type
+     * @param[in] settings the extraction settings
+     * @param[in] maskPath the path of the view mask, empty if there is none
+     */
+    void saveManifest(feature::EImageDescriberType imageDescriberType,
+                      const std::string& settings,
+                      const std::string& maskPath) const;
 
     const sfmData::View& view() const
     {
@@ -89,6 +131,30 @@ public:
       _outputFolder = folder;
     }
 
+    void setFeaturesFileFormat(EFeatureFileFormat format)
+    {
+      _featuresFileFormat = format;
+    }
+
+    /**
+     * @brief Keep the regions of the views in memory, for the next stages of an in-process pipeline.
+     * The regions are only saved if an output folder is set, the up-to-date outputs are then loaded instead of extracted.
+     */
+    void setRegionsPerView(feature::RegionsPerView* regionsPerView)
+    {
+      _regionsPerView = regionsPerView;
+    }
+
+    /**
+     * @brief Set the settings of the extraction, written in the manifest of each output.
+     * The existing outputs are skipped only if their image, mask and settings did not change.
+     * If empty, no manifest is used and the existing outputs are always skipped.
+     */
+    void setSettings(const std::string& settings)
+    {
+      _settings = settings;
+    }
+
     void addImageDescriber(std::shared_ptr<feature::ImageDescriber>& imageDescriber)
     {
       _imageDescribers.push_back(imageDescriber);
@@ -98,14 +164,41 @@ public:
 
 private:
 
-    void computeViewJob(const FeatureExtractorViewJob& job, bool useGPU);
+    /// Read the grayscale image of the view, decoded once if the view is described on both the CPU and the GPU
+    std::shared_ptr<image::Image<float>> readViewImage(const FeatureExtractorViewJob& job,
+                                                       image::ImageCache& imageCache) const;
+
+    /// Path of the mask of the view in the masks folder, empty if there is none
+    std::string getViewMaskPath(const sfmData::View& view) const;
+
+    /// Read the mask of the view if there is one in the masks folder
+    void readViewMask(const FeatureExtractorViewJob& job, image::Image<unsigned char>& mask) const;
+
+    /// Filter the regions with the mask, save them and keep them in the regions per view if set
+    void saveViewRegions(const FeatureExtractorViewJob& job,
+                         const feature::ImageDescriber& imageDescriber,
+                         std::unique_ptr<feature::Regions>& regions,
+                         const image::Image<unsigned char>& mask);
+
+    /// Load the up-to-date outputs, which were not extracted, in the regions per view
+    void loadSkippedRegions(const std::vector<const sfmData::View*>& views);
+
+    void computeViewJob(const FeatureExtractorViewJob& job, bool useGPU, image::ImageCache& imageCache);
+
+    /// Compute the GPU describers of several views, each describer processes all the views together
+    void computeGpuViewJobs(const std::vector<const FeatureExtractorViewJob*>& jobs,
+                            image::ImageCache& imageCache);
 
     const sfmData::SfMData& _sfmData;
     std::vector<std::shared_ptr<feature::ImageDescriber>> _imageDescribers;
     std::string _masksFolder;
     std::string _outputFolder;
+    EFeatureFileFormat _featuresFileFormat = EFeatureFileFormat::BINARY;
+    std::string _settings;
     int _rangeStart = -1;
     int _rangeSize = -1;
+    feature::RegionsPerView* _regionsPerView = nullptr;
+    std::mutex _regionsPerViewMutex;
 };
 
 } // namespace feature
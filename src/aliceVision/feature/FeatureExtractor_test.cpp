@@ -0,0 +1,191 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/feature/FeatureExtractor.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <ctime>
+#include <fstream>
+#include <string>
+
+#define BOOST_TEST_MODULE FeatureExtractor
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+void writeFile(const fs::path& path, const std::string& content)
+{
+    std::ofstream file(path.string(), std::ios::binary);
+    file << content;
+}
+
+/// a view and its outputs in a temporary folder
+struct ViewFolder
+{
+    ViewFolder()
+      : folder(fs::temp_directory_path() / fs::unique_path())
+      , imagePath(folder / "image.jpg")
+      , maskPath(folder / "mask.png")
+      , view(imagePath.string(), 5, 0, 0, 640, 480)
+    {
+        fs::create_directories(folder);
+        writeFile(imagePath, "image content");
+        writeFile(maskPath, "mask content");
+    }
+
+    ~ViewFolder()
+    {
+        fs::remove_all(folder);
+    }
+
+    /// the features and descriptors files saved by the extraction
+    void writeOutputs(const feature::FeatureExtractorViewJob& job) const
+    {
+        writeFile(job.getFeaturesPath(feature::EImageDescriberType::SIFT), "");
+        writeFile(job.getDescriptorPath(feature::EImageDescriberType::SIFT), "");
+    }
+
+    fs::path folder;
+    fs::path imagePath;
+    fs::path maskPath;
+    sfmData::View view;
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(FeatureExtractor_manifest)
+{
+    const feature::EImageDescriberType sift = feature::EImageDescriberType::SIFT;
+    const std::string settings = "describerPreset=normal";
+
+    ViewFolder viewFolder;
+    const std::string maskPath = viewFolder.maskPath.string();
+    const feature::FeatureExtractorViewJob job(viewFolder.view, viewFolder.folder.string());
+    BOOST_CHECK_EQUAL(fs::path(job.getManifestPath(sift)).filename().string(), "5.sift.manifest.json");
+
+    // no outputs
+    BOOST_CHECK(!job.isUpToDate(sift, "", maskPath));
+    BOOST_CHECK(!job.isUpToDate(sift, settings, maskPath));
+
+    // outputs without manifest, only checked without settings
+    viewFolder.writeOutputs(job);
+    BOOST_CHECK(job.isUpToDate(sift, "", maskPath));
+    BOOST_CHECK(!job.isUpToDate(sift, settings, maskPath));
+
+    job.saveManifest(sift, settings, maskPath);
+    BOOST_CHECK(job.isUpToDate(sift, settings, maskPath));
+
+    // the settings or the mask changed
+    BOOST_CHECK(!job.isUpToDate(sift, "describerPreset=high", maskPath));
+    BOOST_CHECK(!job.isUpToDate(sift, settings, ""));
+    writeFile(viewFolder.maskPath, "new mask content");
+    BOOST_CHECK(!job.isUpToDate(sift, settings, maskPath));
+    job.saveManifest(sift, settings, maskPath);
+    BOOST_CHECK(job.isUpToDate(sift, settings, maskPath));
+
+    // the image is touched, its content is hashed again and did not change
+    const std::time_t writeTime = fs::last_write_time(viewFolder.imagePath);
+    fs::last_write_time(viewFolder.imagePath, writeTime + 10);
+    BOOST_CHECK(job.isUpToDate(sift, settings, maskPath));
+
+    // the content is only hashed if the modification time changed
+    writeFile(viewFolder.imagePath, "IMAGE CONTENT");
+    fs::last_write_time(viewFolder.imagePath, writeTime);
+    BOOST_CHECK(job.isUpToDate(sift, settings, maskPath));
+    fs::last_write_time(viewFolder.imagePath, writeTime + 20);
+    BOOST_CHECK(!job.isUpToDate(sift, settings, maskPath));
+
+    // the image size changed
+    job.saveManifest(sift, settings, maskPath);
+    BOOST_CHECK(job.isUpToDate(sift, settings, maskPath));
+    writeFile(viewFolder.imagePath, "a larger image content");
+    fs::last_write_time(viewFolder.imagePath, writeTime + 20);
+    BOOST_CHECK(!job.isUpToDate(sift, settings, maskPath));
+
+    // an invalid manifest
+    job.saveManifest(sift, settings, maskPath);
+    writeFile(job.getManifestPath(sift), "{");
+    BOOST_CHECK(!job.isUpToDate(sift, settings, maskPath));
+
+    // a missing output
+    job.saveManifest(sift, settings, maskPath);
+    fs::remove(job.getDescriptorPath(sift));
+    BOOST_CHECK(!job.isUpToDate(sift, settings, maskPath));
+}
+
+BOOST_AUTO_TEST_CASE(FeatureExtractor_skipUpToDate)
+{
+    const feature::EImageDescriberType sift = feature::EImageDescriberType::SIFT;
+    const std::string settings = "describerPreset=normal";
+    const std::vector<std::shared_ptr<feature::ImageDescriber>> imageDescribers = {feature::createImageDescriber(sift)};
+
+    ViewFolder viewFolder;
+    const std::string maskPath = viewFolder.maskPath.string();
+
+    {
+        feature::FeatureExtractorViewJob job(viewFolder.view, viewFolder.folder.string());
+        job.setImageDescribers(imageDescribers, settings, maskPath);
+        BOOST_CHECK(job.useCPU());
+        BOOST_CHECK_GT(job.memoryConsuption(), std::size_t(0));
+
+        viewFolder.writeOutputs(job);
+        job.saveManifest(sift, settings, maskPath);
+    }
+    {
+        feature::FeatureExtractorViewJob job(viewFolder.view, viewFolder.folder.string());
+        job.setImageDescribers(imageDescribers, settings, maskPath);
+        BOOST_CHECK(!job.useCPU());
+        BOOST_CHECK(!job.useGPU());
+        BOOST_CHECK_EQUAL(job.memoryConsuption(), std::size_t(0));
+    }
+    {
+        feature::FeatureExtractorViewJob job(viewFolder.view, viewFolder.folder.string());
+        job.setImageDescribers(imageDescribers, "describerPreset=high", maskPath);
+        BOOST_CHECK(job.useCPU());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(FeatureExtractor_removeTemporaryOutputs)
+{
+    const fs::path folder = fs::temp_directory_path() / fs::unique_path();
+    fs::create_directories(folder);
+
+    sfmData::SfMData sfmData;
+    sfmData.views[5] = std::make_shared<sfmData::View>((folder / "image.jpg").string(), 5, 0, 0, 640, 480);
+
+    // the temporary files of an interrupted extraction of the view 5
+    const std::vector<std::string> temporaryFiles = {"5.sift.0a1b-2c3d-4e5f-6a7b.feat",
+                                                     "5.sift.0a1b-2c3d-4e5f-6a7b.desc",
+                                                     "5.sift.manifest.json.0a1b-2c3d-4e5f-6a7b.tmp"};
+    // the outputs of the view 5 and the temporary files of a view outside of the range
+    const std::vector<std::string> keptFiles = {"5.sift.feat",
+                                                "5.sift.desc",
+                                                "5.sift.manifest.json",
+                                                "7.sift.0a1b-2c3d-4e5f-6a7b.feat"};
+    for(const std::string& filename : temporaryFiles)
+        writeFile(folder / filename, "");
+    for(const std::string& filename : keptFiles)
+        writeFile(folder / filename, "");
+
+    // no image describer, only the temporary files are cleaned
+    feature::FeatureExtractor extractor(sfmData);
+    extractor.setOutputFolder(folder.string());
+    extractor.process(HardwareContext());
+
+    for(const std::string& filename : temporaryFiles)
+        BOOST_CHECK_MESSAGE(!fs::exists(folder / filename), filename);
+    for(const std::string& filename : keptFiles)
+        BOOST_CHECK_MESSAGE(fs::exists(folder / filename), filename);
+
+    fs::remove_all(folder);
+}
@@ -187,14 +187,14 @@ std::istream& operator>>(std::istream& in, EFeatureConstrastFiltering& p)
     return in;
 }
 
-void ImageDescriber::Save(const Regions* regions, const std::string& sfileNameFeats, const std::string& sfileNameDescs) const
+void ImageDescriber::Save(const Regions* regions, const std::string& sfileNameFeats, const std::string& sfileNameDescs, EFeatureFileFormat featuresFileFormat) const
 {
   const fs::path bFeatsPath = fs::path(sfileNameFeats);
   const fs::path bDescsPath = fs::path(sfileNameDescs);
   const std::string tmpFeatsPath = (bFeatsPath.parent_path() / bFeatsPath.stem()).string() + "." + fs::unique_path().string() + bFeatsPath.extension().string();
   const std::string tmpDescsPath = (bDescsPath.parent_path() / bDescsPath.stem()).string() + "." + fs::unique_path().string() + bDescsPath.extension().string();
 
-  regions->Save(tmpFeatsPath, tmpDescsPath);
+  regions->Save(tmpFeatsPath, tmpDescsPath, featuresFileFormat);
 
   // rename temporary filenames
   fs::rename(tmpFeatsPath, sfileNameFeats);
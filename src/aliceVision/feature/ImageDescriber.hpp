@@ -14,6 +14,7 @@
 #include <memory>
 
 #include <string>
+#include <vector>
 #include <iostream>
 
 namespace aliceVision {
@@ -245,6 +246,40 @@ public:
     return false;
   }
 
+  /**
+   * @brief Detect regions on several float images and compute their attributes (description)
+   * The default implementation describes the images one after the other,
+   * a CUDA image describer may keep several images in flight.
+   * @param[in] images The images.
+   * @param[out] regions The detected regions and attributes of each image
+   */
+  virtual bool describeBatch(const std::vector<const image::Image<float>*>& images,
+                             std::vector<std::unique_ptr<Regions>>& regions)
+  {
+    regions.resize(images.size());
+    bool success = true;
+    for(std::size_t i = 0; i < images.size(); ++i)
+      success = describe(*images.at(i), regions.at(i)) && success;
+    return success;
+  }
+
+  /**
+   * @brief Detect regions on several 8-bit images and compute their attributes (description)
+   * The default implementation describes the images one after the other,
+   * a CUDA image describer may describe them on several CUDA pipes.
+   * @param[in] images The images.
+   * @param[out] regions The detected regions and attributes of each image
+   */
+  virtual bool describeBatch(const std::vector<const image::Image<unsigned char>*>& images,
+                             std::vector<std::unique_ptr<Regions>>& regions)
+  {
+    regions.resize(images.size());
+    bool success = true;
+    for(std::size_t i = 0; i < images.size(); ++i)
+      success = describe(*images.at(i), regions.at(i)) && success;
+    return success;
+  }
+
   /**
    * @brief Allocate Regions type depending of the ImageDescriber
    * @param[in,out] regions
@@ -262,7 +297,8 @@ public:
 
   void Save(const Regions* regions,
     const std::string& sfileNameFeats,
-    const std::string& sfileNameDescs) const;
+    const std::string& sfileNameDescs,
+    EFeatureFileFormat featuresFileFormat = EFeatureFileFormat::TEXT) const;
 
   void LoadFeatures(Regions* regions,
     const std::string& sfileNameFeats) const
@@ -8,9 +8,16 @@
 #pragma once
 
 #include "aliceVision/numeric/numeric.hpp"
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <iterator>
 #include <fstream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -94,12 +101,228 @@ inline std::istream& operator>>(std::istream& in, PointFeature& obj)
   return in >> obj._coords(0) >> obj._coords(1) >> obj._scale >> obj._orientation;
 }
 
-/// Read feats from file
+/**
+ * @brief File format used to store the features (position, scale, orientation)
+ */
+enum class EFeatureFileFormat
+{
+  /// Human readable ASCII format, one feature per line (useful for debugging)
+  TEXT = 0,
+  /// Versioned binary container with packed SoA arrays (x, y, scale, orientation), memory-mappable
+  BINARY
+};
+
+inline std::string EFeatureFileFormat_information()
+{
+  return "Features file format:\n"
+         "* text: ASCII format, one feature per line (debug).\n"
+         "* binary: Versioned binary format, fast to load (memory-mapped).\n";
+}
+
+inline std::string EFeatureFileFormat_enumToString(EFeatureFileFormat format)
+{
+  switch(format)
+  {
+    case EFeatureFileFormat::TEXT:   return "text";
+    case EFeatureFileFormat::BINARY: return "binary";
+  }
+  throw std::out_of_range("Invalid EFeatureFileFormat enum: " + std::to_string(int(format)));
+}
+
+inline EFeatureFileFormat EFeatureFileFormat_stringToEnum(const std::string& format)
+{
+  std::string f = format;
+  std::transform(f.begin(), f.end(), f.begin(), ::tolower);
+
+  if(f == "text")   return EFeatureFileFormat::TEXT;
+  if(f == "binary") return EFeatureFileFormat::BINARY;
+
+  throw std::out_of_range("Invalid features file format: " + format);
+}
+
+inline std::ostream& operator<<(std::ostream& os, EFeatureFileFormat format)
+{
+  return os << EFeatureFileFormat_enumToString(format);
+}
+
+inline std::istream& operator>>(std::istream& in, EFeatureFileFormat& format)
+{
+  std::string token;
+  in >> token;
+  format = EFeatureFileFormat_stringToEnum(token);
+  return in;
+}
+
+/**
+ * @brief Header of the binary features file.
+ *
+ * The header is followed by 4 packed float arrays of size count:
+ * x[count], y[count], scale[count], orientation[count].
+ * The header size is a multiple of 8 bytes so the arrays stay aligned when the file is mapped.
+ */
+struct BinaryFeatsHeader
+{
+  static constexpr std::uint32_t currentVersion = 1;
+
+  char magic[8] = {'A', 'V', 'F', 'E', 'A', 'T', 'S', '\0'};
+  std::uint32_t version = currentVersion;
+  std::uint32_t reserved = 0;
+  std::uint64_t count = 0;
+
+  bool isValid() const
+  {
+    return std::memcmp(magic, BinaryFeatsHeader().magic, sizeof(magic)) == 0;
+  }
+};
+
+static_assert(sizeof(BinaryFeatsHeader) == 24, "BinaryFeatsHeader must be packed on 24 bytes");
+
+/**
+ * @brief Check if the given features file uses the binary format.
+ * @param[in] sfileNameFeats The features file path
+ * @return true if the file starts with the binary features magic number
+ */
+inline bool isBinaryFeatsFile(const std::string& sfileNameFeats)
+{
+  std::ifstream fileIn(sfileNameFeats, std::ios::in | std::ios::binary);
+  if(!fileIn.is_open())
+    return false;
+
+  BinaryFeatsHeader header;
+  fileIn.read(header.magic, sizeof(header.magic));
+  return fileIn.good() && header.isValid();
+}
+
+/**
+ * @brief Read feats from a memory buffer containing a binary features file.
+ * @param[in] data The beginning of the buffer
+ * @param[in] size The buffer size in bytes
+ * @param[out] vec_feat The output features
+ * @param[in] sourceName The name of the buffer source used in error messages
+ */
+template<typename FeaturesT>
+inline void loadFeatsFromBinBuffer(
+  const char* data,
+  std::size_t size,
+  FeaturesT & vec_feat,
+  const std::string& sourceName)
+{
+  vec_feat.clear();
+
+  if(size < sizeof(BinaryFeatsHeader))
+    throw std::runtime_error("Can't load binary features, '" + sourceName + "' is incorrect !");
+
+  BinaryFeatsHeader header;
+  std::memcpy(&header, data, sizeof(BinaryFeatsHeader));
+
+  if(!header.isValid())
+    throw std::runtime_error("Can't load binary features, '" + sourceName + "' has an invalid header !");
+
+  if(header.version > BinaryFeatsHeader::currentVersion)
+    throw std::runtime_error("Can't load binary features, '" + sourceName + "' has an unsupported version (" + std::to_string(header.version) + ") !");
+
+  const std::size_t count = static_cast<std::size_t>(header.count);
+
+  if(size < sizeof(BinaryFeatsHeader) + 4 * count * sizeof(float))
+    throw std::runtime_error("Can't load binary features, '" + sourceName + "' is truncated !");
+
+  const float* x = reinterpret_cast<const float*>(data + sizeof(BinaryFeatsHeader));
+  const float* y = x + count;
+  const float* scale = y + count;
+  const float* orientation = scale + count;
+
+  vec_feat.reserve(count);
+  for(std::size_t i = 0; i < count; ++i)
+    vec_feat.emplace_back(x[i], y[i], scale[i], orientation[i]);
+}
+
+/**
+ * @brief Read feats from a binary features file.
+ *        The file is memory-mapped and the SoA arrays are directly converted into the output container.
+ * @param[in] sfileNameFeats The features file path
+ * @param[out] vec_feat The output features
+ */
+template<typename FeaturesT>
+inline void loadFeatsFromBinFile(
+  const std::string & sfileNameFeats,
+  FeaturesT & vec_feat)
+{
+  boost::iostreams::mapped_file_source file;
+  try
+  {
+    file.open(sfileNameFeats);
+  }
+  catch(const std::exception&)
+  {
+    throw std::runtime_error("Can't load binary features file, can't open '" + sfileNameFeats + "' !");
+  }
+
+  loadFeatsFromBinBuffer(file.data(), file.size(), vec_feat, sfileNameFeats);
+}
+
+/**
+ * @brief Write feats in the binary features format (header + packed SoA arrays) into a stream.
+ * @param[in,out] stream The output binary stream
+ * @param[in] vec_feat The features to export
+ */
+template<typename FeaturesT>
+inline void writeFeatsToBinStream(
+  std::ostream& stream,
+  const FeaturesT & vec_feat)
+{
+  BinaryFeatsHeader header;
+  header.count = static_cast<std::uint64_t>(vec_feat.size());
+  stream.write(reinterpret_cast<const char*>(&header), sizeof(BinaryFeatsHeader));
+
+  std::vector<float> buffer(vec_feat.size());
+
+  const auto writeComponent = [&](float (*getter)(const typename FeaturesT::value_type&))
+  {
+    std::transform(vec_feat.begin(), vec_feat.end(), buffer.begin(), getter);
+    stream.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(float));
+  };
+
+  writeComponent([](const typename FeaturesT::value_type& f) { return f.x(); });
+  writeComponent([](const typename FeaturesT::value_type& f) { return f.y(); });
+  writeComponent([](const typename FeaturesT::value_type& f) { return f.scale(); });
+  writeComponent([](const typename FeaturesT::value_type& f) { return f.orientation(); });
+}
+
+/**
+ * @brief Write feats to a binary features file (header + packed SoA arrays).
+ * @param[in] sfileNameFeats The features file path
+ * @param[in] vec_feat The features to export
+ */
+template<typename FeaturesT>
+inline void saveFeatsToBinFile(
+  const std::string & sfileNameFeats,
+  const FeaturesT & vec_feat)
+{
+  std::ofstream file(sfileNameFeats, std::ios::out | std::ios::binary);
+
+  if(!file.is_open())
+    throw std::runtime_error("Can't save binary features file, can't open '" + sfileNameFeats + "' !");
+
+  writeFeatsToBinStream(file, vec_feat);
+
+  if(!file.good())
+    throw std::runtime_error("Can't save binary features file, '" + sfileNameFeats + "' is incorrect !");
+
+  file.close();
+}
+
+/// Read feats from file (the text or binary format is automatically detected)
 template<typename FeaturesT >
 inline void loadFeatsFromFile(
   const std::string & sfileNameFeats,
   FeaturesT & vec_feat)
 {
+  if(isBinaryFeatsFile(sfileNameFeats))
+  {
+    loadFeatsFromBinFile(sfileNameFeats, vec_feat);
+    return;
+  }
+
   vec_feat.clear();
 
   std::ifstream fileIn(sfileNameFeats);
@@ -120,8 +343,15 @@ inline void loadFeatsFromFile(
 template<typename FeaturesT >
 inline void saveFeatsToFile(
   const std::string & sfileNameFeats,
-  FeaturesT & vec_feat)
+  FeaturesT & vec_feat,
+  EFeatureFileFormat format = EFeatureFileFormat::TEXT)
 {
+  if(format == EFeatureFileFormat::BINARY)
+  {
+    saveFeatsToBinFile(sfileNameFeats, vec_feat);
+    return;
+  }
+
   std::ofstream file(sfileNameFeats);
 
   if (!file.is_open())
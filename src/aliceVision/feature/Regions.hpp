@@ -62,6 +62,17 @@ public:
     loadFeatsFromFile(sfileNameFeats, _vec_feats);
   }
 
+  /**
+   * @brief Load the region features from a memory buffer in the binary features format.
+   * @param[in] featsData The features buffer
+   * @param[in] featsSize The features buffer size in bytes
+   * @param[in] sourceName The name of the buffer source used in error messages
+   */
+  void LoadFeaturesFromBinBuffer(const char* featsData, std::size_t featsSize, const std::string& sourceName)
+  {
+    loadFeatsFromBinBuffer(featsData, featsSize, _vec_feats, sourceName);
+  }
+
   PointFeatures GetRegionsPositions() const
   {
     return PointFeatures(_vec_feats.begin(), _vec_feats.end());
@@ -89,10 +100,20 @@ public:
 
   virtual void Save(
     const std::string& sfileNameFeats,
-    const std::string& sfileNameDescs) const = 0;
+    const std::string& sfileNameDescs,
+    EFeatureFileFormat featuresFileFormat = EFeatureFileFormat::TEXT) const = 0;
 
   virtual void SaveDesc(const std::string& sfileNameDescs) const = 0;
 
+  /**
+   * @brief Load regions from memory buffers in the binary features and descriptors formats
+   *        (e.g. slices of a memory-mapped regions pack).
+   */
+  virtual void LoadFromBinBuffers(
+    const char* featsData, std::size_t featsSize,
+    const char* descsData, std::size_t descsSize,
+    const std::string& sourceName) = 0;
+
   //--
   //- Basic description of a descriptor [Type, Length]
   //--
@@ -119,6 +140,9 @@ public:
 
   virtual void clearDescriptors() = 0;
 
+  /// Return the memory size (in bytes) used by the descriptors
+  virtual std::size_t DescriptorsMemorySize() const = 0;
+
   /// Return the squared distance between two descriptors
   // A default metric is used according the descriptor type:
   // - Scalar: L2,
@@ -199,9 +223,10 @@ public:
   /// Export in two separate files the regions and their corresponding descriptors.
   void Save(
     const std::string& sfileNameFeats,
-    const std::string& sfileNameDescs) const override
+    const std::string& sfileNameDescs,
+    EFeatureFileFormat featuresFileFormat = EFeatureFileFormat::TEXT) const override
   {
-    saveFeatsToFile(sfileNameFeats, this->_vec_feats);
+    saveFeatsToFile(sfileNameFeats, this->_vec_feats, featuresFileFormat);
     saveDescsToBinFile(sfileNameDescs, _vec_descs);
   }
 
@@ -210,6 +235,16 @@ public:
     saveDescsToBinFile(sfileNameDescs, _vec_descs);
   }
 
+  /// Read the regions and their corresponding descriptors from memory buffers.
+  void LoadFromBinBuffers(
+    const char* featsData, std::size_t featsSize,
+    const char* descsData, std::size_t descsSize,
+    const std::string& sourceName) override
+  {
+    loadFeatsFromBinBuffer(featsData, featsSize, this->_vec_feats, sourceName);
+    loadDescsFromBinBuffer(descsData, descsSize, _vec_descs, sourceName);
+  }
+
   /// Mutable and non-mutable DescriptorT getters.
   inline std::vector<DescriptorT> & Descriptors() { return _vec_descs; }
   inline const std::vector<DescriptorT> & Descriptors() const { return _vec_descs; }
@@ -218,7 +253,9 @@ public:
 
   inline const void* DescriptorRawData() const override { return &_vec_descs[0];}
 
-  inline void clearDescriptors() override { _vec_descs.clear(); }
+  inline void clearDescriptors() override { _vec_descs.clear(); _vec_descs.shrink_to_fit(); }
+
+  inline std::size_t DescriptorsMemorySize() const override { return _vec_descs.capacity() * sizeof(DescriptorT); }
 
   inline void swap(This& other)
   {
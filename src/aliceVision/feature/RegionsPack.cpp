@@ -0,0 +1,185 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "RegionsPack.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+namespace fs = boost::filesystem;
+
+namespace aliceVision {
+namespace feature {
+
+bool RegionsPackHeader::isValid() const
+{
+  return std::memcmp(magic, RegionsPackHeader().magic, sizeof(magic)) == 0;
+}
+
+std::string getRegionsPackPath(const std::string& folder, EImageDescriberType imageDescriberType)
+{
+  return (fs::path(folder) / (EImageDescriberType_enumToString(imageDescriberType) + ".regionsPack")).string();
+}
+
+RegionsPackWriter::RegionsPackWriter(const std::string& filepath)
+  : _filepath(filepath)
+  , _file(filepath, std::ios::out | std::ios::binary)
+{
+  if(!_file.is_open())
+    throw std::runtime_error("Can't create regions pack file, can't open '" + filepath + "' !");
+
+  // write a placeholder header, updated in close()
+  const RegionsPackHeader header;
+  _file.write(reinterpret_cast<const char*>(&header), sizeof(RegionsPackHeader));
+}
+
+RegionsPackWriter::~RegionsPackWriter()
+{
+  if(_file.is_open())
+  {
+    try
+    {
+      close();
+    }
+    catch(const std::exception& e)
+    {
+      ALICEVISION_LOG_ERROR(e.what());
+    }
+  }
+}
+
+void RegionsPackWriter::addView(IndexT viewId, const std::string& featsFilepath, const std::string& descsFilepath)
+{
+  RegionsPackEntry entry;
+  entry.viewId = viewId;
+
+  // features are always converted to the binary format
+  {
+    std::vector<PointFeature> feats;
+    loadFeatsFromFile(featsFilepath, feats);
+
+    entry.featsOffset = static_cast<std::uint64_t>(_file.tellp());
+    writeFeatsToBinStream(_file, feats);
+    entry.featsSize = static_cast<std::uint64_t>(_file.tellp()) - entry.featsOffset;
+  }
+
+  // descriptors are already stored in binary
+  {
+    std::ifstream descsFile(descsFilepath, std::ios::in | std::ios::binary);
+    if(!descsFile.is_open())
+      throw std::runtime_error("Can't add view " + std::to_string(viewId) + " to regions pack, can't open '" + descsFilepath + "' !");
+
+    entry.descsOffset = static_cast<std::uint64_t>(_file.tellp());
+    _file << descsFile.rdbuf();
+    entry.descsSize = static_cast<std::uint64_t>(_file.tellp()) - entry.descsOffset;
+  }
+
+  if(!_file.good())
+    throw std::runtime_error("Can't write regions pack file, '" + _filepath + "' is incorrect !");
+
+  _entries.push_back(entry);
+}
+
+void RegionsPackWriter::close()
+{
+  std::sort(_entries.begin(), _entries.end(), [](const RegionsPackEntry& a, const RegionsPackEntry& b) {
+    return a.viewId < b.viewId;
+  });
+
+  RegionsPackHeader header;
+  header.viewCount = _entries.size();
+  header.indexOffset = static_cast<std::uint64_t>(_file.tellp());
+
+  _file.write(reinterpret_cast<const char*>(_entries.data()), _entries.size() * sizeof(RegionsPackEntry));
+  _file.seekp(0);
+  _file.write(reinterpret_cast<const char*>(&header), sizeof(RegionsPackHeader));
+
+  if(!_file.good())
+    throw std::runtime_error("Can't write regions pack file, '" + _filepath + "' is incorrect !");
+
+  _file.close();
+}
+
+RegionsPackReader::RegionsPackReader(const std::string& filepath)
+  : _filepath(filepath)
+{
+  try
+  {
+    _file.open(filepath);
+  }
+  catch(const std::exception&)
+  {
+    throw std::runtime_error("Can't load regions pack file, can't open '" + filepath + "' !");
+  }
+
+  if(_file.size() < sizeof(RegionsPackHeader))
+    throw std::runtime_error("Can't load regions pack file, '" + filepath + "' is incorrect !");
+
+  RegionsPackHeader header;
+  std::memcpy(&header, _file.data(), sizeof(RegionsPackHeader));
+
+  if(!header.isValid())
+    throw std::runtime_error("Can't load regions pack file, '" + filepath + "' has an invalid header !");
+
+  if(header.version > RegionsPackHeader::currentVersion)
+    throw std::runtime_error("Can't load regions pack file, '" + filepath + "' has an unsupported version (" + std::to_string(header.version) + ") !");
+
+  if(header.indexOffset + header.viewCount * sizeof(RegionsPackEntry) > _file.size())
+    throw std::runtime_error("Can't load regions pack file, '" + filepath + "' is truncated !");
+
+  _entries.resize(header.viewCount);
+  std::memcpy(_entries.data(), _file.data() + header.indexOffset, _entries.size() * sizeof(RegionsPackEntry));
+
+  for(const RegionsPackEntry& entry : _entries)
+  {
+    if(entry.featsOffset + entry.featsSize > _file.size() ||
+       entry.descsOffset + entry.descsSize > _file.size())
+      throw std::runtime_error("Can't load regions pack file, '" + filepath + "' has an invalid entry for view " + std::to_string(entry.viewId) + " !");
+  }
+}
+
+const RegionsPackEntry* RegionsPackReader::findEntry(IndexT viewId) const
+{
+  const auto it = std::lower_bound(_entries.begin(), _entries.end(), viewId, [](const RegionsPackEntry& entry, IndexT id) {
+    return entry.viewId < id;
+  });
+
+  if(it == _entries.end() || it->viewId != viewId)
+    return nullptr;
+  return &(*it);
+}
+
+const RegionsPackEntry& RegionsPackReader::getEntry(IndexT viewId) const
+{
+  const RegionsPackEntry* entry = findEntry(viewId);
+  if(entry == nullptr)
+    throw std::runtime_error("Can't find view " + std::to_string(viewId) + " in regions pack '" + _filepath + "'");
+  return *entry;
+}
+
+void RegionsPackReader::loadRegions(IndexT viewId, Regions& regions) const
+{
+  const RegionsPackEntry& entry = getEntry(viewId);
+  regions.LoadFromBinBuffers(_file.data() + entry.featsOffset, entry.featsSize,
+                             _file.data() + entry.descsOffset, entry.descsSize,
+                             _filepath + ":" + std::to_string(viewId));
+}
+
+void RegionsPackReader::loadFeatures(IndexT viewId, Regions& regions) const
+{
+  const RegionsPackEntry& entry = getEntry(viewId);
+  regions.LoadFeaturesFromBinBuffer(_file.data() + entry.featsOffset, entry.featsSize,
+                                    _filepath + ":" + std::to_string(viewId));
+}
+
+} // namespace feature
+} // namespace aliceVision
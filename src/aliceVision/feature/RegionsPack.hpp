@@ -0,0 +1,142 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+#include <aliceVision/feature/Regions.hpp>
+#include <aliceVision/feature/imageDescriberCommon.hpp>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace feature {
+
+/**
+ * @brief Regions pack file layout.
+ *
+ * A regions pack stores the regions of all the views for one describer type in a single file:
+ * - a RegionsPackHeader,
+ * - for each view, the binary features blob (same content as a binary .feat file)
+ *   followed by the binary descriptors blob (same content as a .desc file),
+ * - an index of RegionsPackEntry sorted by viewId, located at RegionsPackHeader::indexOffset.
+ */
+struct RegionsPackHeader
+{
+  static constexpr std::uint32_t currentVersion = 1;
+
+  char magic[8] = {'A', 'V', 'R', 'P', 'A', 'C', 'K', '\0'};
+  std::uint32_t version = currentVersion;
+  std::uint32_t reserved = 0;
+  std::uint64_t viewCount = 0;
+  std::uint64_t indexOffset = 0;
+
+  bool isValid() const;
+};
+
+struct RegionsPackEntry
+{
+  std::uint64_t viewId = 0;
+  std::uint64_t featsOffset = 0;
+  std::uint64_t featsSize = 0;
+  std::uint64_t descsOffset = 0;
+  std::uint64_t descsSize = 0;
+};
+
+/**
+ * @brief Get the regions pack filename for the given describer type.
+ * @param[in] folder The features folder
+ * @param[in] imageDescriberType The describer type
+ * @return the regions pack file path
+ */
+std::string getRegionsPackPath(const std::string& folder, EImageDescriberType imageDescriberType);
+
+/**
+ * @brief Write the regions of several views into a single regions pack file.
+ */
+class RegionsPackWriter
+{
+public:
+  explicit RegionsPackWriter(const std::string& filepath);
+  ~RegionsPackWriter();
+
+  /**
+   * @brief Append the regions of a view from its per-view features and descriptors files.
+   *        The features are always stored in the binary format.
+   * @param[in] viewId The view id
+   * @param[in] featsFilepath The features file (text or binary)
+   * @param[in] descsFilepath The binary descriptors file
+   */
+  void addView(IndexT viewId, const std::string& featsFilepath, const std::string& descsFilepath);
+
+  /**
+   * @brief Write the index and close the file.
+   */
+  void close();
+
+private:
+  std::string _filepath;
+  std::ofstream _file;
+  std::vector<RegionsPackEntry> _entries;
+};
+
+/**
+ * @brief Read the regions of a regions pack file.
+ *        The file is memory-mapped once and each view is decoded lazily from its own slice.
+ * @note Thread-safe for concurrent reads.
+ */
+class RegionsPackReader
+{
+public:
+  explicit RegionsPackReader(const std::string& filepath);
+
+  const std::string& getFilepath() const { return _filepath; }
+
+  std::size_t getNbViews() const { return _entries.size(); }
+
+  bool hasView(IndexT viewId) const { return findEntry(viewId) != nullptr; }
+
+  /**
+   * @brief Get the size of the binary descriptors blob of the given view.
+   * @param[in] viewId The view id
+   * @return the descriptors size in bytes, 0 if the view is not in the pack
+   */
+  std::size_t getDescriptorsSize(IndexT viewId) const
+  {
+    const RegionsPackEntry* entry = findEntry(viewId);
+    return (entry != nullptr) ? static_cast<std::size_t>(entry->descsSize) : 0;
+  }
+
+  /**
+   * @brief Load features and descriptors of the given view.
+   * @param[in] viewId The view id
+   * @param[in,out] regions The allocated regions to fill
+   */
+  void loadRegions(IndexT viewId, Regions& regions) const;
+
+  /**
+   * @brief Load features only of the given view.
+   * @param[in] viewId The view id
+   * @param[in,out] regions The allocated regions to fill
+   */
+  void loadFeatures(IndexT viewId, Regions& regions) const;
+
+private:
+  const RegionsPackEntry* findEntry(IndexT viewId) const;
+  const RegionsPackEntry& getEntry(IndexT viewId) const;
+
+  std::string _filepath;
+  boost::iostreams::mapped_file_source _file;
+  std::vector<RegionsPackEntry> _entries;
+};
+
+} // namespace feature
+} // namespace aliceVision
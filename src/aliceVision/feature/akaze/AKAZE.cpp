@@ -42,6 +42,17 @@ inline float sigma(const float sigma0 , const int p , const int q , const int Q)
     return sigma0 * powf(2.f, p + static_cast<float>(q) / static_cast<float>(Q)) ;
 }
 
+/**
+ * @brief Temporary images of the AKAZE slices computation, reused from a slice to the next one
+ */
+struct AKAZESliceBuffers
+{
+  image::Image<float> smoothed;
+  image::Image<float> Lxx;
+  image::Image<float> Lyy;
+  image::Image<float> Lxy;
+};
+
 /**
  * @brief Compute an AKAZE slice
  * @param[in] src Input image for the given octave
@@ -54,6 +65,7 @@ inline float sigma(const float sigma0 , const int p , const int q , const int Q)
  * @param Lx X derivatives
  * @param Ly Y derivatives
  * @param Lhess Det(Hessian)
+ * @param buffers Temporary images
  */
 void computeAKAZESlice(const image::Image<float>& src,
                        const int p,
@@ -64,13 +76,14 @@ void computeAKAZESlice(const image::Image<float>& src,
                        image::Image<float>& Li,
                        image::Image<float>& Lx,
                        image::Image<float>& Ly,
-                       image::Image<float>& Lhess)
+                       image::Image<float>& Lhess,
+                       AKAZESliceBuffers& buffers)
 {
   const float sigmaCur = sigma(sigma0, p, q, nbSlice);
   const float ratio = 1 << p; //pow(2,p);
   const int sigmaScale = MathTrait<float>::round(sigmaCur * derivativeFactor / ratio);
 
-  image::Image<float> smoothed;
+  image::Image<float>& smoothed = buffers.smoothed;
 
   if(p == 0 && q == 0)
   {
@@ -79,15 +92,14 @@ void computeAKAZESlice(const image::Image<float>& src,
   }
   else
   {
-    // general case
-    image::Image<float> in;
+    // general case, the evolution image is diffused in place
     if( q == 0 )
     {
-      image::ImageHalfSample(src , in);
+      image::ImageHalfSample(src , Li);
     }
     else
     {
-      in = src;
+      Li = src;
     }
 
     const float sigmaPrev = ( q == 0 ) ? sigma(sigma0, p - 1, nbSlice - 1, nbSlice) : sigma(sigma0, p, q - 1, nbSlice);
@@ -98,7 +110,7 @@ void computeAKAZESlice(const image::Image<float>& src,
     const float total_cycle_time = t_cur - t_prev;
 
     // compute first derivatives (Scharr scale 1, non normalized) for diffusion coef
-    image::ImageGaussianFilter(in , 1.f , smoothed, 0, 0 );
+    image::ImageGaussianFilter(Li , 1.f , smoothed, 0, 0 );
     image::ImageScharrXDerivative(smoothed, Lx, false);
     image::ImageScharrYDerivative(smoothed, Ly, false);
 
@@ -109,8 +121,7 @@ void computeAKAZESlice(const image::Image<float>& src,
     // compute FED cycles
     std::vector<float> tau ;
     image::FEDCycleTimings(total_cycle_time, 0.25f, tau);
-    image::ImageFEDCycle(in, diff, tau);
-    Li = in ; // evolution image
+    image::ImageFEDCycle(Li, diff, tau);
   }
 
   // compute Hessian response
@@ -129,18 +140,24 @@ void computeAKAZESlice(const image::Image<float>& src,
   image::ImageScaledScharrYDerivative(smoothed, Ly, sigmaScale);
 
   // second order spatial derivatives
-  image::Image<float> Lxx, Lyy, Lxy;
+  image::Image<float>& Lxx = buffers.Lxx;
+  image::Image<float>& Lyy = buffers.Lyy;
+  image::Image<float>& Lxy = buffers.Lxy;
   image::ImageScaledScharrXDerivative(Lx, Lxx, sigmaScale);
   image::ImageScaledScharrYDerivative(Lx, Lxy, sigmaScale);
   image::ImageScaledScharrYDerivative(Ly, Lyy, sigmaScale);
 
-  Lx *= static_cast<float>(sigmaScale);
-  Ly *= static_cast<float>(sigmaScale);
-
-  // compute Determinant of the Hessian
-  Lhess.resize(Li.Width(), Li.Height());
+  // compute Determinant of the Hessian and scale the first derivatives, row by row
   const float sigmaSizeQuad = Square(sigmaScale) * Square(sigmaScale);
-  Lhess.array() = (Lxx.array() * Lyy.array() - Lxy.array().square()) * sigmaSizeQuad;
+  Lhess.resize(Li.Width(), Li.Height(), false);
+
+  #pragma omp parallel for if(Li.Width() * Li.Height() > 128 * 128)
+  for(int y = 0; y < Li.Height(); ++y)
+  {
+    Lhess.row(y).array() = (Lxx.row(y).array() * Lyy.row(y).array() - Lxy.row(y).array().square()) * sigmaSizeQuad;
+    Lx.row(y) *= static_cast<float>(sigmaScale);
+    Ly.row(y) *= static_cast<float>(sigmaScale);
+  }
 }
 
 #if DEBUG_OCTAVE
@@ -167,7 +184,11 @@ AKAZE::AKAZE(const image::Image<float>& image, const AKAZEOptions& options):
 void AKAZE::computeScaleSpace()
 {
   float contrastFactor = computeAutomaticContrastFactor( _input, 0.7f);
-  image::Image<float> input = _input;
+
+  // the slices are computed from the previous one, the vector must not reallocate
+  _evolution.reserve(_evolution.size() + _options.nbOctaves * _options.nbSlicePerOctave);
+  const image::Image<float>* input = &_input;
+  AKAZESliceBuffers buffers;
 
   // octave computation
   for(int p = 0; p < _options.nbOctaves; ++p)
@@ -180,11 +201,11 @@ void AKAZE::computeScaleSpace()
       TEvolution& evo = _evolution.back();
 
       // compute Slice at (p,q) index
-      computeAKAZESlice(input, p, q, _options.nbSlicePerOctave, _options.sigma0, contrastFactor,
-        evo.cur, evo.Lx, evo.Ly, evo.Lhess);
+      computeAKAZESlice(*input, p, q, _options.nbSlicePerOctave, _options.sigma0, contrastFactor,
+        evo.cur, evo.Lx, evo.Ly, evo.Lhess, buffers);
 
       // Prepare inputs for next slice
-      input = evo.cur;
+      input = &evo.cur;
 
       // DEBUG octave image
 #if DEBUG_OCTAVE
@@ -12,17 +12,83 @@
 #include <apriltag/apriltag.h>
 #include <apriltag/tag16h5.h>
 
+#include <mutex>
+#include <vector>
+
 namespace aliceVision {
 namespace feature {
 
+struct ImageDescriber_APRILTAG::DetectorPool
+{
+  /// a detector with its own family, the family decoding table is built once
+  struct Detector
+  {
+    Detector()
+      : family(tag16h5_create())
+      , detector(apriltag_detector_create())
+    {
+      apriltag_detector_add_family(detector, family);
+    }
+
+    ~Detector()
+    {
+      apriltag_detector_destroy(detector);
+      tag16h5_destroy(family);
+    }
+
+    Detector(const Detector&) = delete;
+    Detector& operator=(const Detector&) = delete;
+
+    apriltag_family_t* family;
+    apriltag_detector_t* detector;
+  };
+
+  std::unique_ptr<Detector> acquire()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if(!freeDetectors.empty())
+      {
+        std::unique_ptr<Detector> detector = std::move(freeDetectors.back());
+        freeDetectors.pop_back();
+        return detector;
+      }
+    }
+    return std::unique_ptr<Detector>(new Detector());
+  }
+
+  void release(std::unique_ptr<Detector>&& detector)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    freeDetectors.push_back(std::move(detector));
+  }
+
+  std::mutex mutex;
+  std::vector<std::unique_ptr<Detector>> freeDetectors;
+};
+
 void ImageDescriber_APRILTAG::AprilTagParameters::setPreset(EImageDescriberPreset preset)
 {
+  // the quads are found on the decimated image, a higher decimation misses the smaller tags
+  switch(preset)
+  {
+    case EImageDescriberPreset::LOW:    quadDecimate = 4.f;  break;
+    case EImageDescriberPreset::MEDIUM: quadDecimate = 3.f;  break;
+    case EImageDescriberPreset::NORMAL: quadDecimate = 2.f;  break;
+    case EImageDescriberPreset::HIGH:   quadDecimate = 1.5f; break;
+    case EImageDescriberPreset::ULTRA:  quadDecimate = 1.f;  break;
+    default:
+      throw std::out_of_range("Invalid image describer preset enum");
+  }
 }
 
 ImageDescriber_APRILTAG::ImageDescriber_APRILTAG()
   : ImageDescriber()
+  , _detectorPool(new DetectorPool())
   {}
 
+ImageDescriber_APRILTAG::~ImageDescriber_APRILTAG() = default;
+
 void ImageDescriber_APRILTAG::allocate(std::unique_ptr<Regions> &regions) const
 {
   regions.reset( new APRILTAG_Regions );
@@ -47,10 +113,9 @@ bool ImageDescriber_APRILTAG::describe(const image::Image<unsigned char>& image,
   APRILTAG_Regions * regionsCasted = dynamic_cast<APRILTAG_Regions*>(regions.get());
   ALICEVISION_LOG_DEBUG(" regionsCasted = " << regionsCasted);
 
-  apriltag_family_t *tf = tag16h5_create();
-  apriltag_detector_t *td = apriltag_detector_create();
-  apriltag_detector_add_family(td, tf);
-  td->quad_decimate = 2.0;
+  std::unique_ptr<DetectorPool::Detector> detector = _detectorPool->acquire();
+  apriltag_detector_t *td = detector->detector;
+  td->quad_decimate = _params.quadDecimate;
   td->quad_sigma = 0.0; // blur
   td->nthreads = 1;
   td->debug = 0;
@@ -100,8 +165,7 @@ bool ImageDescriber_APRILTAG::describe(const image::Image<unsigned char>& image,
     }
   }
   apriltag_detections_destroy(detections);
-  apriltag_detector_destroy(td);
-  tag16h5_destroy(tf);
+  _detectorPool->release(std::move(detector));
 
   return true;
 }
@@ -26,7 +26,7 @@ class ImageDescriber_APRILTAG : public ImageDescriber
 public:
   explicit ImageDescriber_APRILTAG();
 
-  ~ImageDescriber_APRILTAG() override = default;
+  ~ImageDescriber_APRILTAG() override;
 
   /**
    * @brief Check if the image describer use CUDA
@@ -98,10 +98,17 @@ public:
     ~AprilTagParameters() = default;
 
     void setPreset(EImageDescriberPreset preset);
+
+    /// decimation of the image for the quad detection, the quad edges are refined on the full resolution image
+    float quadDecimate = 2.f;
   };
 private:
   //AprilTag parameters
   AprilTagParameters _params;
+
+  /// the detectors are created once and reused by the next images, one by concurrent describe() call
+  struct DetectorPool;
+  std::unique_ptr<DetectorPool> _detectorPool;
 };
 
 /**
@@ -11,6 +11,13 @@
 
 #include <cctag/ICCTag.hpp>
 #include <cctag/utils/LogTime.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <mutex>
+#include <set>
+#include <thread>
 //#define CPU_ADAPT_OF_GPU_PART //todo: #ifdef depreciated
 #ifdef CPU_ADAPT_OF_GPU_PART    
   #include "cctag/progBase/MemoryPool.hpp"
@@ -90,6 +97,76 @@ bool ImageDescriber_CCTAG::describe(const image::Image<unsigned char>& image,
     std::unique_ptr<Regions> &regions,
     const image::Image<unsigned char> * mask)
 {
+  return detect(image, regions, _cudaPipe);
+}
+
+bool ImageDescriber_CCTAG::describeBatch(const std::vector<const image::Image<unsigned char>*>& images,
+                                         std::vector<std::unique_ptr<Regions>>& regions)
+{
+  const int nbPipes = std::min<int>(_nbCudaPipes, images.size());
+  if(!useCuda() || nbPipes <= 1)
+    return ImageDescriber::describeBatch(images, regions);
+
+  regions.resize(images.size());
+
+  // the CCTag CUDA pipes are created at their first use, which is not thread-safe
+  static std::mutex pipeCreationMutex;
+  static std::set<int> createdPipes;
+
+  std::atomic<std::size_t> nextImage(0);
+  std::atomic<bool> success(true);
+  std::vector<std::exception_ptr> errors(nbPipes);
+  std::vector<std::thread> threads;
+
+  for(int p = 0; p < nbPipes; ++p)
+  {
+    threads.emplace_back([&, p]() {
+      const int cudaPipe = _cudaPipe + p;
+      std::size_t nbImages = 0;
+      const auto start = std::chrono::steady_clock::now();
+      try
+      {
+        for(std::size_t i = nextImage++; i < images.size(); i = nextImage++)
+        {
+          std::unique_lock<std::mutex> lock(pipeCreationMutex);
+          if(createdPipes.insert(cudaPipe).second)
+          {
+            // the first detection of the pipe is done under the lock
+            success = detect(*images.at(i), regions.at(i), cudaPipe) && success;
+          }
+          else
+          {
+            lock.unlock();
+            success = detect(*images.at(i), regions.at(i), cudaPipe) && success;
+          }
+          ++nbImages;
+        }
+      }
+      catch(...)
+      {
+        errors.at(p) = std::current_exception();
+      }
+      const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      ALICEVISION_LOG_INFO("CCTag CUDA pipe " << cudaPipe << ": " << nbImages << " images in " << seconds << " s ("
+                           << ((seconds > 0.0) ? nbImages / seconds : 0.0) << " images/s)");
+    });
+  }
+
+  for(std::thread& thread : threads)
+    thread.join();
+
+  for(const std::exception_ptr& error : errors)
+  {
+    if(error)
+      std::rethrow_exception(error);
+  }
+  return success;
+}
+
+bool ImageDescriber_CCTAG::detect(const image::Image<unsigned char>& image,
+                                  std::unique_ptr<Regions>& regions,
+                                  int cudaPipe)
+{
 
   if ( !_doAppend )
     allocate(regions);
@@ -111,11 +188,11 @@ bool ImageDescriber_CCTAG::describe(const image::Image<unsigned char>& image,
   //// Invert the image
   //cv::Mat invertImg;
   //cv::bitwise_not(graySrc,invertImg);
-  cctag::cctagDetection(cctags, _cudaPipe, 1,graySrc, *_params._internalParams, durations);
+  cctag::cctagDetection(cctags, cudaPipe, 1,graySrc, *_params._internalParams, durations);
 #else //todo: #ifdef depreciated
   cctag::MemoryPool::instance().updateMemoryAuthorizedWithRAM();
   cctag::View cctagView((const unsigned char *) image.data(), image.Width(), image.Height(), image.Depth()*image.Width());
-  cctag::cctagDetection(cctags, _cudaPipe, 1 ,cctagView._grayView ,*_params._internalParams, durations );
+  cctag::cctagDetection(cctags, cudaPipe, 1 ,cctagView._grayView ,*_params._internalParams, durations );
 #endif
   durations->print( std::cerr );
 
@@ -12,6 +12,7 @@
 #include <aliceVision/feature/regionsFactory.hpp>
 #include <aliceVision/types.hpp>
 
+#include <algorithm>
 #include <iostream>
 #include <numeric>
 
@@ -80,6 +81,15 @@ public:
     _cudaPipe = pipe;
   }
 
+  /**
+   * @brief Set the number of CUDA pipes used by describeBatch, from the CUDA pipe id
+   * @param[in] nbPipes The number of CUDA pipes
+   */
+  void setNbCudaPipes(int nbPipes)
+  {
+    _nbCudaPipes = std::max(1, nbPipes);
+  }
+
   /**
    * @brief Use a preset to control the number of detected regions
    * @param[in] preset The preset configuration
@@ -99,6 +109,19 @@ public:
     std::unique_ptr<Regions> &regions,
     const image::Image<unsigned char> * mask = nullptr) override;
 
+  using ImageDescriber::describeBatch;
+
+  /**
+   * @brief Detect regions on several 8-bit images and compute their attributes (description)
+   * With CUDA, the images are taken from a shared queue by one thread per CUDA pipe,
+   * the throughput of each pipe is logged.
+   * @param[in] images The images.
+   * @param[out] regions The detected regions and attributes of each image
+   * @return True if detection succeed for all the images.
+   */
+  bool describeBatch(const std::vector<const image::Image<unsigned char>*>& images,
+                     std::vector<std::unique_ptr<Regions>>& regions) override;
+
   /**
    * @brief Allocate Regions type depending of the ImageDescriber
    * @param[in,out] regions
@@ -118,10 +141,14 @@ public:
     std::unique_ptr<cctag::Parameters> _internalParams;
   };
 private:
+  /// Detect the CCTags of an image with the given CUDA pipe
+  bool detect(const image::Image<unsigned char>& image, std::unique_ptr<Regions>& regions, int cudaPipe);
+
   //CCTag parameters
   CCTagParameters _params;
   bool _doAppend = false;
   int _cudaPipe = 0;
+  int _nbCudaPipes = 2;
 };
 
 /**
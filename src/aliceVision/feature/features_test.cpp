@@ -6,6 +6,7 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "aliceVision/feature/feature.hpp"
+#include "aliceVision/feature/RegionsPack.hpp"
 
 #include <iostream>
 #include <fstream>
@@ -69,6 +70,30 @@ BOOST_AUTO_TEST_CASE(featureIO_ASCII) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(featureIO_BINARY) {
+  Feats_T vec_feats;
+  for(int i = 0; i < CARD; ++i)  {
+    vec_feats.push_back(Feature_T(i, i*2, i*3, i*4));
+  }
+
+  //Save them to a binary file
+  BOOST_CHECK_NO_THROW(saveFeatsToFile("tempFeats.bin.feat", vec_feats, EFeatureFileFormat::BINARY));
+  BOOST_CHECK(isBinaryFeatsFile("tempFeats.bin.feat"));
+
+  //Read the saved data (binary format is detected automatically) and compare to input
+  Feats_T vec_feats_read;
+  BOOST_CHECK_NO_THROW(loadFeatsFromFile("tempFeats.bin.feat", vec_feats_read));
+  BOOST_CHECK_EQUAL(CARD, vec_feats_read.size());
+
+  for(int i = 0; i < CARD; ++i) {
+    BOOST_CHECK_EQUAL(vec_feats[i], vec_feats_read[i]);
+  }
+
+  //The text format must not be detected as binary
+  BOOST_CHECK_NO_THROW(saveFeatsToFile("tempFeats.txt.feat", vec_feats, EFeatureFileFormat::TEXT));
+  BOOST_CHECK(!isBinaryFeatsFile("tempFeats.txt.feat"));
+}
+
 //--
 //-- Descriptors interface test
 //--
@@ -121,3 +146,45 @@ BOOST_AUTO_TEST_CASE(descriptorIO_BINARY) {
       BOOST_CHECK_EQUAL(vec_descs[i][j], vec_descs_read[i][j]);
   }
 }
+
+//Test regions pack export/import
+BOOST_AUTO_TEST_CASE(regionsPackIO) {
+  typedef ScalarRegions<float, DESC_LENGTH> Regions_T;
+
+  Regions_T regions;
+  for(int i = 0; i < CARD; ++i)
+  {
+    regions.Features().push_back(Feature_T(i, i*2, i*3, i*4));
+    Desc_T desc;
+    for (int j = 0; j < DESC_LENGTH; ++j)
+      desc[j] = i*DESC_LENGTH+j;
+    regions.Descriptors().push_back(desc);
+  }
+  regions.Save("tempRegions.feat", "tempRegions.desc");
+
+  {
+    RegionsPackWriter writer("tempRegions.regionsPack");
+    BOOST_CHECK_NO_THROW(writer.addView(12, "tempRegions.feat", "tempRegions.desc"));
+    BOOST_CHECK_NO_THROW(writer.addView(3, "tempRegions.feat", "tempRegions.desc"));
+    BOOST_CHECK_NO_THROW(writer.close());
+  }
+
+  RegionsPackReader reader("tempRegions.regionsPack");
+  BOOST_CHECK_EQUAL(2, reader.getNbViews());
+  BOOST_CHECK(reader.hasView(3));
+  BOOST_CHECK(reader.hasView(12));
+  BOOST_CHECK(!reader.hasView(4));
+
+  Regions_T regionsRead;
+  BOOST_CHECK_NO_THROW(reader.loadRegions(12, regionsRead));
+  BOOST_CHECK_EQUAL(CARD, regionsRead.RegionCount());
+  BOOST_CHECK_EQUAL(CARD, regionsRead.Descriptors().size());
+
+  for(int i = 0; i < CARD; ++i) {
+    BOOST_CHECK_EQUAL(regions.Features()[i], regionsRead.Features()[i]);
+    for (int j = 0; j < DESC_LENGTH; ++j)
+      BOOST_CHECK_EQUAL(regions.Descriptors()[i][j], regionsRead.Descriptors()[i][j]);
+  }
+
+  BOOST_CHECK_THROW(reader.loadRegions(4, regionsRead), std::exception);
+}
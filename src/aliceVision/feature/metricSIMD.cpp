@@ -0,0 +1,362 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "metricSIMD.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+// The SIMD kernels are compiled with function-level target attributes,
+// so that the library does not require specific compilation flags
+// and the best kernel is selected at runtime.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define ALICEVISION_METRIC_SIMD_X86 1
+#include <immintrin.h>
+#define ALICEVISION_TARGET_AVX2 __attribute__((target("avx2")))
+#define ALICEVISION_TARGET_AVX512 __attribute__((target("avx512f,avx512bw,avx512vpopcntdq")))
+#else
+#define ALICEVISION_METRIC_SIMD_X86 0
+#endif
+
+namespace aliceVision {
+namespace feature {
+namespace simd {
+
+namespace {
+
+//
+// Scalar reference kernels
+//
+
+void squaredL2DistancesUCharScalar(const unsigned char* query, const unsigned char* dataset,
+                                   std::size_t nbRows, std::size_t dimension, float* distances)
+{
+  for(std::size_t r = 0; r < nbRows; ++r)
+  {
+    const unsigned char* row = dataset + r * dimension;
+    std::uint32_t sum = 0;
+    for(std::size_t i = 0; i < dimension; ++i)
+    {
+      const int diff = int(query[i]) - int(row[i]);
+      sum += std::uint32_t(diff * diff);
+    }
+    distances[r] = static_cast<float>(sum);
+  }
+}
+
+/// 4 interleaved lanes accumulation, same summation order as the SSE L2_Vectorized<float>
+float squaredL2DistanceFloatScalar(const float* a, const float* b, std::size_t dimension)
+{
+  float lanes[4] = {0.f, 0.f, 0.f, 0.f};
+  for(std::size_t i = 0; i < dimension; ++i)
+  {
+    const float diff = a[i] - b[i];
+    const float sq = diff * diff;
+    lanes[i & 3] += sq;
+  }
+  return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+void squaredL2DistancesFloatScalar(const float* query, const float* dataset,
+                                   std::size_t nbRows, std::size_t dimension, float* distances)
+{
+  for(std::size_t r = 0; r < nbRows; ++r)
+    distances[r] = squaredL2DistanceFloatScalar(query, dataset + r * dimension, dimension);
+}
+
+inline unsigned int popcount64(std::uint64_t v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<unsigned int>(__builtin_popcountll(v));
+#else
+  v = v - ((v >> 1) & 0x5555555555555555ULL);
+  v = (v & 0x3333333333333333ULL) + ((v >> 2) & 0x3333333333333333ULL);
+  v = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+  return static_cast<unsigned int>((v * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+unsigned int hammingDistanceScalar(const unsigned char* a, const unsigned char* b, std::size_t nbBytes)
+{
+  unsigned int result = 0;
+  std::size_t i = 0;
+  for(; i + 8 <= nbBytes; i += 8)
+  {
+    std::uint64_t va, vb;
+    std::memcpy(&va, a + i, 8);
+    std::memcpy(&vb, b + i, 8);
+    result += popcount64(va ^ vb);
+  }
+  for(; i < nbBytes; ++i)
+    result += popcount64(std::uint64_t(a[i] ^ b[i]));
+  return result;
+}
+
+void hammingDistancesScalar(const unsigned char* query, const unsigned char* dataset,
+                            std::size_t nbRows, std::size_t nbBytes, unsigned int* distances)
+{
+  for(std::size_t r = 0; r < nbRows; ++r)
+    distances[r] = hammingDistanceScalar(query, dataset + r * nbBytes, nbBytes);
+}
+
+#if ALICEVISION_METRIC_SIMD_X86
+
+//
+// AVX2 kernels
+//
+
+ALICEVISION_TARGET_AVX2
+inline std::uint32_t hsumEpi32Avx2(__m256i v)
+{
+  __m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+  s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+  s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+  return static_cast<std::uint32_t>(_mm_cvtsi128_si32(s));
+}
+
+ALICEVISION_TARGET_AVX2
+void squaredL2DistancesUCharAvx2(const unsigned char* query, const unsigned char* dataset,
+                                 std::size_t nbRows, std::size_t dimension, float* distances)
+{
+  for(std::size_t r = 0; r < nbRows; ++r)
+  {
+    const unsigned char* row = dataset + r * dimension;
+    __m256i acc = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for(; i + 16 <= dimension; i += 16)
+    {
+      const __m256i q = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(query + i)));
+      const __m256i d = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i)));
+      const __m256i diff = _mm256_sub_epi16(q, d);
+      acc = _mm256_add_epi32(acc, _mm256_madd_epi16(diff, diff));
+    }
+    std::uint32_t sum = hsumEpi32Avx2(acc);
+    for(; i < dimension; ++i)
+    {
+      const int diff = int(query[i]) - int(row[i]);
+      sum += std::uint32_t(diff * diff);
+    }
+    distances[r] = static_cast<float>(sum);
+  }
+}
+
+ALICEVISION_TARGET_AVX2
+void squaredL2DistancesFloatAvx2(const float* query, const float* dataset,
+                                 std::size_t nbRows, std::size_t dimension, float* distances)
+{
+  for(std::size_t r = 0; r < nbRows; ++r)
+  {
+    const float* row = dataset + r * dimension;
+    // 8 squared differences per iteration, folded into 4 lanes in the scalar order (low then high half)
+    __m128 acc = _mm_setzero_ps();
+    std::size_t i = 0;
+    for(; i + 8 <= dimension; i += 8)
+    {
+      const __m256 diff = _mm256_sub_ps(_mm256_loadu_ps(query + i), _mm256_loadu_ps(row + i));
+      const __m256 sq = _mm256_mul_ps(diff, diff);
+      acc = _mm_add_ps(acc, _mm256_castps256_ps128(sq));
+      acc = _mm_add_ps(acc, _mm256_extractf128_ps(sq, 1));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, acc);
+    for(; i < dimension; ++i)
+    {
+      const float diff = query[i] - row[i];
+      const float sq = diff * diff;
+      lanes[i & 3] += sq;
+    }
+    distances[r] = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+  }
+}
+
+/// Popcount of each byte with a nibble lookup table (W. Mula), summed per 64-bit lane
+ALICEVISION_TARGET_AVX2
+inline __m256i popcountEpi64Avx2(__m256i v)
+{
+  const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                          0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i lowMask = _mm256_set1_epi8(0x0f);
+  const __m256i lo = _mm256_and_si256(v, lowMask);
+  const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), lowMask);
+  const __m256i cnt = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+  return _mm256_sad_epu8(cnt, _mm256_setzero_si256());
+}
+
+ALICEVISION_TARGET_AVX2
+void hammingDistancesAvx2(const unsigned char* query, const unsigned char* dataset,
+                          std::size_t nbRows, std::size_t nbBytes, unsigned int* distances)
+{
+  for(std::size_t r = 0; r < nbRows; ++r)
+  {
+    const unsigned char* row = dataset + r * nbBytes;
+    __m256i acc = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for(; i + 32 <= nbBytes; i += 32)
+    {
+      const __m256i x = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(query + i)),
+                                         _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i)));
+      acc = _mm256_add_epi64(acc, popcountEpi64Avx2(x));
+    }
+    alignas(32) std::uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    unsigned int result = static_cast<unsigned int>(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+    result += hammingDistanceScalar(query + i, row + i, nbBytes - i);
+    distances[r] = result;
+  }
+}
+
+//
+// AVX-512 kernels
+//
+
+ALICEVISION_TARGET_AVX512
+void squaredL2DistancesUCharAvx512(const unsigned char* query, const unsigned char* dataset,
+                                   std::size_t nbRows, std::size_t dimension, float* distances)
+{
+  for(std::size_t r = 0; r < nbRows; ++r)
+  {
+    const unsigned char* row = dataset + r * dimension;
+    __m512i acc = _mm512_setzero_si512();
+    std::size_t i = 0;
+    for(; i + 32 <= dimension; i += 32)
+    {
+      const __m512i q = _mm512_cvtepu8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(query + i)));
+      const __m512i d = _mm512_cvtepu8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i)));
+      const __m512i diff = _mm512_sub_epi16(q, d);
+      acc = _mm512_add_epi32(acc, _mm512_madd_epi16(diff, diff));
+    }
+    std::uint32_t sum = static_cast<std::uint32_t>(_mm512_reduce_add_epi32(acc));
+    for(; i < dimension; ++i)
+    {
+      const int diff = int(query[i]) - int(row[i]);
+      sum += std::uint32_t(diff * diff);
+    }
+    distances[r] = static_cast<float>(sum);
+  }
+}
+
+ALICEVISION_TARGET_AVX512
+void hammingDistancesAvx512(const unsigned char* query, const unsigned char* dataset,
+                            std::size_t nbRows, std::size_t nbBytes, unsigned int* distances)
+{
+  for(std::size_t r = 0; r < nbRows; ++r)
+  {
+    const unsigned char* row = dataset + r * nbBytes;
+    __m512i acc = _mm512_setzero_si512();
+    std::size_t i = 0;
+    for(; i + 64 <= nbBytes; i += 64)
+    {
+      const __m512i x = _mm512_xor_si512(_mm512_loadu_si512(query + i), _mm512_loadu_si512(row + i));
+      acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(x));
+    }
+    unsigned int result = static_cast<unsigned int>(_mm512_reduce_add_epi64(acc));
+    result += hammingDistanceScalar(query + i, row + i, nbBytes - i);
+    distances[r] = result;
+  }
+}
+
+#endif // ALICEVISION_METRIC_SIMD_X86
+
+EInstructionSet detectInstructionSet()
+{
+#if ALICEVISION_METRIC_SIMD_X86
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vpopcntdq"))
+    return EInstructionSet::AVX512;
+  if(__builtin_cpu_supports("avx2"))
+    return EInstructionSet::AVX2;
+#endif
+  return EInstructionSet::SCALAR;
+}
+
+EInstructionSet cpuInstructionSet()
+{
+  static const EInstructionSet instructionSet = detectInstructionSet();
+  return instructionSet;
+}
+
+std::atomic<EInstructionSet>& currentInstructionSet()
+{
+  static std::atomic<EInstructionSet> instructionSet(cpuInstructionSet());
+  return instructionSet;
+}
+
+} // namespace
+
+std::string EInstructionSet_enumToString(EInstructionSet instructionSet)
+{
+  switch(instructionSet)
+  {
+    case EInstructionSet::SCALAR: return "scalar";
+    case EInstructionSet::AVX2:   return "avx2";
+    case EInstructionSet::AVX512: return "avx512";
+  }
+  throw std::out_of_range("Invalid instruction set enum");
+}
+
+EInstructionSet getInstructionSet()
+{
+  return currentInstructionSet().load(std::memory_order_relaxed);
+}
+
+void setInstructionSet(EInstructionSet instructionSet)
+{
+  if(static_cast<int>(instructionSet) > static_cast<int>(cpuInstructionSet()))
+  {
+    ALICEVISION_LOG_WARNING("Instruction set '" << EInstructionSet_enumToString(instructionSet)
+                            << "' is not supported by the CPU, use '" << EInstructionSet_enumToString(cpuInstructionSet()) << "'.");
+    instructionSet = cpuInstructionSet();
+  }
+  currentInstructionSet().store(instructionSet, std::memory_order_relaxed);
+}
+
+void squaredL2Distances(const unsigned char* query, const unsigned char* dataset,
+                        std::size_t nbRows, std::size_t dimension, float* distances)
+{
+  switch(getInstructionSet())
+  {
+#if ALICEVISION_METRIC_SIMD_X86
+    case EInstructionSet::AVX512: squaredL2DistancesUCharAvx512(query, dataset, nbRows, dimension, distances); return;
+    case EInstructionSet::AVX2:   squaredL2DistancesUCharAvx2(query, dataset, nbRows, dimension, distances); return;
+#endif
+    default:                      squaredL2DistancesUCharScalar(query, dataset, nbRows, dimension, distances); return;
+  }
+}
+
+void squaredL2Distances(const float* query, const float* dataset,
+                        std::size_t nbRows, std::size_t dimension, float* distances)
+{
+  switch(getInstructionSet())
+  {
+#if ALICEVISION_METRIC_SIMD_X86
+    // the 4 lanes accumulation order does not benefit from wider registers
+    case EInstructionSet::AVX512:
+    case EInstructionSet::AVX2:   squaredL2DistancesFloatAvx2(query, dataset, nbRows, dimension, distances); return;
+#endif
+    default:                      squaredL2DistancesFloatScalar(query, dataset, nbRows, dimension, distances); return;
+  }
+}
+
+void hammingDistances(const unsigned char* query, const unsigned char* dataset,
+                      std::size_t nbRows, std::size_t nbBytes, unsigned int* distances)
+{
+  switch(getInstructionSet())
+  {
+#if ALICEVISION_METRIC_SIMD_X86
+    case EInstructionSet::AVX512: hammingDistancesAvx512(query, dataset, nbRows, nbBytes, distances); return;
+    case EInstructionSet::AVX2:   hammingDistancesAvx2(query, dataset, nbRows, nbBytes, distances); return;
+#endif
+    default:                      hammingDistancesScalar(query, dataset, nbRows, nbBytes, distances); return;
+  }
+}
+
+} // namespace simd
+} // namespace feature
+} // namespace aliceVision
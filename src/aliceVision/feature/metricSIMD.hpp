@@ -0,0 +1,81 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Brief:
+// Explicit SIMD descriptor distance kernels (AVX2 / AVX-512) with runtime CPU dispatch.
+// Each kernel computes the distances between one query and a set of contiguous descriptors.
+// All the instruction sets (including the scalar fallback) return bit-identical results:
+// - L2 on unsigned char is computed with exact integer arithmetic (descriptor length up to maxL2UCharLength),
+// - L2 on float is accumulated on 4 interleaved lanes (same order as the SSE L2_Vectorized<float>),
+// - Hamming is computed with exact integer arithmetic.
+
+namespace aliceVision {
+namespace feature {
+namespace simd {
+
+/**
+ * @brief Instruction set used by the descriptor distance kernels
+ */
+enum class EInstructionSet
+{
+  SCALAR = 0,
+  AVX2,
+  AVX512
+};
+
+std::string EInstructionSet_enumToString(EInstructionSet instructionSet);
+
+/**
+ * @brief Return the best instruction set supported by the CPU for the distance kernels.
+ */
+EInstructionSet getInstructionSet();
+
+/**
+ * @brief Force the instruction set used by the distance kernels (clamped to the CPU capabilities).
+ *        Mainly intended for tests and benchmarks.
+ */
+void setInstructionSet(EInstructionSet instructionSet);
+
+/// Maximum descriptor length for which the unsigned char L2 distance is exact in float
+constexpr std::size_t maxL2UCharLength = 258;
+
+/**
+ * @brief Squared L2 distances between a query and nbRows unsigned char descriptors.
+ * @param[in] query The query descriptor
+ * @param[in] dataset The row-major descriptors
+ * @param[in] nbRows The number of descriptors in the dataset
+ * @param[in] dimension The descriptor length (must be <= maxL2UCharLength)
+ * @param[out] distances The nbRows output distances
+ */
+void squaredL2Distances(const unsigned char* query, const unsigned char* dataset,
+                        std::size_t nbRows, std::size_t dimension, float* distances);
+
+/**
+ * @brief Squared L2 distances between a query and nbRows float descriptors.
+ * @see squaredL2Distances
+ */
+void squaredL2Distances(const float* query, const float* dataset,
+                        std::size_t nbRows, std::size_t dimension, float* distances);
+
+/**
+ * @brief Hamming distances between a query and nbRows binary descriptors.
+ * @param[in] query The query descriptor
+ * @param[in] dataset The row-major descriptors
+ * @param[in] nbRows The number of descriptors in the dataset
+ * @param[in] nbBytes The descriptor length in bytes
+ * @param[out] distances The nbRows output distances
+ */
+void hammingDistances(const unsigned char* query, const unsigned char* dataset,
+                      std::size_t nbRows, std::size_t nbBytes, unsigned int* distances);
+
+} // namespace simd
+} // namespace feature
+} // namespace aliceVision
@@ -6,9 +6,12 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include <aliceVision/feature/metric.hpp>
+#include <aliceVision/feature/metricSIMD.hpp>
 
 #include <iostream>
+#include <random>
 #include <string>
+#include <vector>
 
 #define BOOST_TEST_MODULE matchingMetric
 
@@ -134,3 +137,62 @@ BOOST_AUTO_TEST_CASE(Metric_HAMMING_BITSET_RAW_MEMORY_32BITS)
     }
   }
 }
+
+BOOST_AUTO_TEST_CASE(Metric_SIMD_bitIdentical)
+{
+  std::mt19937 randomNumberGenerator(0);
+  std::uniform_int_distribution<int> byteDistribution(0, 255);
+  std::uniform_real_distribution<float> floatDistribution(0.f, 1.f);
+
+  const simd::EInstructionSet cpuInstructionSet = simd::getInstructionSet();
+  const std::size_t nbRows = 37;
+
+  // descriptor lengths with and without SIMD tails
+  for(const std::size_t dimension : {1, 7, 32, 61, 64, 128, 200, 256})
+  {
+    std::vector<unsigned char> queryU8(dimension), datasetU8(nbRows * dimension);
+    std::vector<float> queryF(dimension), datasetF(nbRows * dimension);
+    for(auto& v : queryU8) v = static_cast<unsigned char>(byteDistribution(randomNumberGenerator));
+    for(auto& v : datasetU8) v = static_cast<unsigned char>(byteDistribution(randomNumberGenerator));
+    for(auto& v : queryF) v = floatDistribution(randomNumberGenerator);
+    for(auto& v : datasetF) v = floatDistribution(randomNumberGenerator);
+
+    // scalar references
+    simd::setInstructionSet(simd::EInstructionSet::SCALAR);
+    std::vector<float> refL2U8(nbRows), refL2F(nbRows);
+    std::vector<unsigned int> refHamming(nbRows);
+    simd::squaredL2Distances(queryU8.data(), datasetU8.data(), nbRows, dimension, refL2U8.data());
+    simd::squaredL2Distances(queryF.data(), datasetF.data(), nbRows, dimension, refL2F.data());
+    simd::hammingDistances(queryU8.data(), datasetU8.data(), nbRows, dimension, refHamming.data());
+
+    for(std::size_t r = 0; r < nbRows; ++r)
+    {
+      BOOST_CHECK_EQUAL(refL2U8[r], L2_Vectorized<unsigned char>()(queryU8.data(), &datasetU8[r * dimension], dimension));
+      BOOST_CHECK_EQUAL(refHamming[r], Hamming<unsigned char>()(queryU8.data(), &datasetU8[r * dimension], dimension));
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_SSE)
+      if(dimension % 4 == 0)
+        BOOST_CHECK_EQUAL(refL2F[r], L2_Vectorized<float>()(queryF.data(), &datasetF[r * dimension], dimension));
+#endif
+    }
+
+    // all the instruction sets supported by the CPU give the same results
+    for(int i = 1; i <= static_cast<int>(cpuInstructionSet); ++i)
+    {
+      const simd::EInstructionSet instructionSet = static_cast<simd::EInstructionSet>(i);
+      simd::setInstructionSet(instructionSet);
+      BOOST_TEST_MESSAGE("instruction set: " << simd::EInstructionSet_enumToString(instructionSet) << ", dimension: " << dimension);
+
+      std::vector<float> l2U8(nbRows), l2F(nbRows);
+      std::vector<unsigned int> hamming(nbRows);
+      simd::squaredL2Distances(queryU8.data(), datasetU8.data(), nbRows, dimension, l2U8.data());
+      simd::squaredL2Distances(queryF.data(), datasetF.data(), nbRows, dimension, l2F.data());
+      simd::hammingDistances(queryU8.data(), datasetU8.data(), nbRows, dimension, hamming.data());
+
+      BOOST_CHECK(l2U8 == refL2U8);
+      BOOST_CHECK(l2F == refL2F);
+      BOOST_CHECK(hamming == refHamming);
+    }
+  }
+
+  simd::setInstructionSet(cpuInstructionSet);
+}
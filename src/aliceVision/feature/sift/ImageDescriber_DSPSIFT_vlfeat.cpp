@@ -10,6 +10,7 @@
 #include <aliceVision/feature/ImageDescriber.hpp>
 #include <aliceVision/feature/regionsFactory.hpp>
 #include <aliceVision/feature/sift/SIFT.hpp>
+#include <aliceVision/system/TaskScheduler.hpp>
 
 extern "C" {
 #include <nonFree/sift/vl/covdet.h>
@@ -315,7 +316,7 @@ bool extractDSPSIFT(const image::Image<float>& image, std::unique_ptr<Regions>&
             dspNumScales = params.dspNumScales;
         }
 
-#pragma omp parallel
+        system::parallelForChunks(0, indexSort.size(), [&](std::ptrdiff_t chunkBegin, std::ptrdiff_t chunkEnd)
         {
             VlCovDetBuffer internalBuffer;
             vl_covdetbuffer_init(&internalBuffer);
@@ -323,8 +324,7 @@ bool extractDSPSIFT(const image::Image<float>& image, std::unique_ptr<Regions>&
             std::vector<float> patch(kPatchSide * kPatchSide);
             std::vector<float> patchXY(2 * kPatchSide * kPatchSide);
 
-#pragma omp for
-            for(int oIndex = 0; oIndex < indexSort.size(); ++oIndex)
+            for(std::ptrdiff_t oIndex = chunkBegin; oIndex < chunkEnd; ++oIndex)
             {
                 const int iIndex = indexSort[oIndex];
                 const auto& inFeat = features[iIndex];
@@ -365,7 +365,7 @@ bool extractDSPSIFT(const image::Image<float>& image, std::unique_ptr<Regions>&
             }
 
             vl_covdetbuffer_clear(&internalBuffer);
-        }
+        });
     }
 
     return true;
@@ -21,6 +21,7 @@ namespace feature {
 
 std::unique_ptr<PopSift> ImageDescriber_SIFT_popSIFT::_popSift{nullptr};
 std::atomic<int> ImageDescriber_SIFT_popSIFT::_instanceCounter{0};
+int ImageDescriber_SIFT_popSIFT::_cudaDevice{0};
 
 void ImageDescriber_SIFT_popSIFT::setConfigurationPreset(ConfigurationPreset preset)
 {
@@ -28,26 +29,27 @@ void ImageDescriber_SIFT_popSIFT::setConfigurationPreset(ConfigurationPreset pre
     _popSift.reset(nullptr); // reset by describe method
 }
 
-bool ImageDescriber_SIFT_popSIFT::describe(const image::Image<float>& image,
-                                      std::unique_ptr<Regions>& regions,
-                                      const image::Image<unsigned char>* mask)
+void ImageDescriber_SIFT_popSIFT::setCudaPipe(int pipe)
 {
-  if(_popSift == nullptr)
-    resetConfiguration();
-
-  std::unique_ptr<SiftJob> job(_popSift->enqueue(image.Width(), image.Height(), &image(0,0)));
-  std::unique_ptr<popsift::Features> popFeatures(job->get());
+    if(pipe == _cudaDevice)
+        return;
+    _cudaDevice = pipe;
+    _popSift.reset(nullptr); // reset by describe method, on the new device
+}
 
-  allocate(regions);
+namespace {
 
-  // Build alias to cached data
-  SIFT_Regions * regionsCasted = dynamic_cast<SIFT_Regions*>(regions.get());
-  regionsCasted->Features().reserve(popFeatures->getDescriptorCount());
-  regionsCasted->Descriptors().reserve(popFeatures->getDescriptorCount());
+/**
+ * @brief Convert the PopSIFT features of an image to SIFT regions
+ */
+void convertFeatures(const popsift::Features& popFeatures, SIFT_Regions& regions)
+{
+  regions.Features().reserve(popFeatures.getDescriptorCount());
+  regions.Descriptors().reserve(popFeatures.getDescriptorCount());
 
-  ALICEVISION_LOG_TRACE("PopSIFT features count: " << popFeatures->getFeatureCount() << ", descriptors count: " << popFeatures->getDescriptorCount() << std::endl);
+  ALICEVISION_LOG_TRACE("PopSIFT features count: " << popFeatures.getFeatureCount() << ", descriptors count: " << popFeatures.getDescriptorCount() << std::endl);
 
-  for(const auto& popFeat: *popFeatures)
+  for(const auto& popFeat: popFeatures)
   {
     for(int orientationIndex = 0; orientationIndex < popFeat.num_ori; ++orientationIndex)
     {
@@ -59,17 +61,62 @@ bool ImageDescriber_SIFT_popSIFT::describe(const image::Image<float>& image,
       for (std::size_t k = 0; k < 128; ++k)
         desc[k] = static_cast<unsigned char>(popDesc->features[k]);
 
-      regionsCasted->Features().emplace_back(
+      regions.Features().emplace_back(
         popFeat.xpos,
         popFeat.ypos,
         popFeat.sigma,
         popFeat.orientation[orientationIndex]);
 
-      regionsCasted->Descriptors().emplace_back(desc);
+      regions.Descriptors().emplace_back(desc);
     }
   }
 
-  ALICEVISION_LOG_TRACE("aliceVision PopSIFT feature count : " << regionsCasted->RegionCount() << std::endl);
+  ALICEVISION_LOG_TRACE("aliceVision PopSIFT feature count : " << regions.RegionCount() << std::endl);
+}
+
+} // namespace
+
+bool ImageDescriber_SIFT_popSIFT::describe(const image::Image<float>& image,
+                                      std::unique_ptr<Regions>& regions,
+                                      const image::Image<unsigned char>* mask)
+{
+  if(_popSift == nullptr)
+    resetConfiguration();
+
+  std::unique_ptr<SiftJob> job(_popSift->enqueue(image.Width(), image.Height(), &image(0,0)));
+  std::unique_ptr<popsift::Features> popFeatures(job->get());
+
+  allocate(regions);
+
+  // Build alias to cached data
+  SIFT_Regions * regionsCasted = dynamic_cast<SIFT_Regions*>(regions.get());
+  convertFeatures(*popFeatures, *regionsCasted);
+
+  return true;
+}
+
+bool ImageDescriber_SIFT_popSIFT::describeBatch(const std::vector<const image::Image<float>*>& images,
+                                                std::vector<std::unique_ptr<Regions>>& regions)
+{
+  if(_popSift == nullptr)
+    resetConfiguration();
+
+  // enqueue all the images before waiting for the first one,
+  // so the PopSift pipeline uploads the next images while it extracts the current one
+  std::vector<std::unique_ptr<SiftJob>> jobs;
+  jobs.reserve(images.size());
+  for(const image::Image<float>* image : images)
+    jobs.emplace_back(_popSift->enqueue(image->Width(), image->Height(), &(*image)(0,0)));
+
+  regions.resize(images.size());
+  for(std::size_t i = 0; i < jobs.size(); ++i)
+  {
+    std::unique_ptr<popsift::Features> popFeatures(jobs.at(i)->get());
+
+    allocate(regions.at(i));
+    SIFT_Regions * regionsCasted = dynamic_cast<SIFT_Regions*>(regions.at(i).get());
+    convertFeatures(*popFeatures, *regionsCasted);
+  }
 
   return true;
 }
@@ -81,7 +128,7 @@ void ImageDescriber_SIFT_popSIFT::resetConfiguration()
   cudaDeviceReset();
 
   popsift::cuda::device_prop_t deviceInfo;
-  deviceInfo.set(0, true); // use only the first device & print information
+  deviceInfo.set(_cudaDevice, true); // use only the selected device & print information
 
   // reset configuration
   popsift::Config config;
@@ -94,7 +141,7 @@ void ImageDescriber_SIFT_popSIFT::resetConfiguration()
   config.setFilterMaxExtrema(_params._maxTotalKeypoints);
   config.setFilterSorting(popsift::Config::LargestScaleFirst);
 
-  _popSift.reset(new PopSift(config, popsift::Config::ExtractingMode, PopSift::FloatImages));
+  _popSift.reset(new PopSift(config, popsift::Config::ExtractingMode, PopSift::FloatImages, _cudaDevice));
 }
 
 ImageDescriber_SIFT_popSIFT::ImageDescriber_SIFT_popSIFT(const SiftParams& params, bool isOriented)
@@ -85,6 +85,12 @@ public:
    */
   void setConfigurationPreset(ConfigurationPreset preset) override;
 
+  /**
+   * @brief set the CUDA pipe
+   * @param[in] pipe The CUDA device used by PopSift
+   */
+  void setCudaPipe(int pipe) override;
+
   /**
    * @brief Detect regions on the 8-bit image and compute their attributes (description)
    * @param[in] image Image.
@@ -97,6 +103,17 @@ public:
                 std::unique_ptr<Regions>& regions,
                 const image::Image<unsigned char>* mask = nullptr) override;
 
+  /**
+   * @brief Detect regions on several float images and compute their attributes (description)
+   * All the images are enqueued in the PopSift pipeline before the first result is read,
+   * so the upload of an image overlaps with the extraction of the previous ones.
+   * @param[in] images The images.
+   * @param[out] regions The detected regions and attributes of each image
+   * @return True if detection succed.
+   */
+  bool describeBatch(const std::vector<const image::Image<float>*>& images,
+                     std::vector<std::unique_ptr<Regions>>& regions) override;
+
   /**
    * @brief Allocate Regions type depending of the ImageDescriber
    * @param[in,out] regions
@@ -119,6 +136,7 @@ private:
   bool _isOriented = true;
   static std::unique_ptr<PopSift> _popSift;
   static std::atomic<int> _instanceCounter;
+  static int _cudaDevice;
 };
 
 } // namespace feature
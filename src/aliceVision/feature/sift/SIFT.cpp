@@ -6,6 +6,10 @@
 
 #include "SIFT.hpp"
 
+#include <aliceVision/system/TaskScheduler.hpp>
+
+#include <mutex>
+
 namespace aliceVision {
 namespace feature {
 
@@ -137,6 +141,104 @@ void VLFeatInstance::destroy()
     vl_destructor();
 }
 
+namespace {
+
+/**
+ * @brief Select the keypoints to describe with a spatial repartition on the image grid.
+ * The keypoints are ranked on their detector response as the final features filtering does,
+ * then the best ones of each grid cell are kept and the budget is completed with the best remaining ones.
+ * @param[in] keys the detected keypoints
+ * @param[in] w image width
+ * @param[in] h image height
+ * @param[in] params SIFT parameters, with a grid size and a maximum number of keypoints
+ * @return the indexes of the selected keypoints, at most params._maxTotalKeypoints
+ */
+std::vector<IndexT> selectGridKeypoints(const std::vector<VlSiftKeypoint>& keys, int w, int h, const SiftParams& params)
+{
+    std::vector<IndexT> indexSort(keys.size());
+    std::iota(indexSort.begin(), indexSort.end(), 0);
+    if(keys.size() <= params._maxTotalKeypoints)
+        return indexSort;
+
+    if(params._contrastFiltering == EFeatureConstrastFiltering::GridSortScaleSteps)
+    {
+        std::sort(indexSort.begin(), indexSort.end(), [&](IndexT a, IndexT b) {
+            const int scaleA = int(log2(keys[a].sigma) * 3.0f); // 3 scale steps per octave
+            const int scaleB = int(log2(keys[b].sigma) * 3.0f);
+            if(scaleA == scaleB)
+                return keys[a].peak_value > keys[b].peak_value;
+            return scaleA > scaleB;
+        });
+    }
+    else if(params._contrastFiltering == EFeatureConstrastFiltering::GridSortOctaveSteps)
+    {
+        std::sort(indexSort.begin(), indexSort.end(), [&](IndexT a, IndexT b) {
+            const int scaleA = int(log2(keys[a].sigma)); // 1 scale steps per octave
+            const int scaleB = int(log2(keys[b].sigma));
+            if(scaleA == scaleB)
+                return keys[a].peak_value > keys[b].peak_value;
+            return scaleA > scaleB;
+        });
+    }
+    else if(params._contrastFiltering == EFeatureConstrastFiltering::GridSort)
+    {
+        std::sort(indexSort.begin(), indexSort.end(), [&](IndexT a, IndexT b) {
+            return keys[a].sigma * keys[a].peak_value > keys[b].sigma * keys[b].peak_value;
+        });
+    }
+    else if(params._contrastFiltering == EFeatureConstrastFiltering::GridSortOctaves)
+    {
+        // sort the octaves from largest scales to smallest ones, by peak value inside each octave
+        std::sort(indexSort.begin(), indexSort.end(), [&](IndexT a, IndexT b) {
+            if(keys[a].o == keys[b].o)
+                return keys[a].peak_value > keys[b].peak_value;
+            return keys[a].o > keys[b].o;
+        });
+    }
+    else
+    {
+        // sort from largest scales to smallest ones
+        std::sort(indexSort.begin(), indexSort.end(), [&](IndexT a, IndexT b) { return keys[a].sigma > keys[b].sigma; });
+    }
+
+    std::vector<IndexT> filteredIndexes;
+    std::vector<IndexT> rejectedIndexes;
+    filteredIndexes.reserve(params._maxTotalKeypoints);
+    rejectedIndexes.reserve(keys.size());
+
+    const std::size_t sizeMat = params._gridSize * params._gridSize;
+    std::vector<std::size_t> countFeatPerCell(sizeMat, 0);
+    const std::size_t keypointsPerCell = params._maxTotalKeypoints / sizeMat;
+    const double regionWidth = w / double(params._gridSize);
+    const double regionHeight = h / double(params._gridSize);
+
+    for(const IndexT i : indexSort)
+    {
+        const std::size_t cellX = std::min(std::size_t(keys[i].x / regionWidth), params._gridSize - 1);
+        const std::size_t cellY = std::min(std::size_t(keys[i].y / regionHeight), params._gridSize - 1);
+
+        std::size_t& count = countFeatPerCell[cellX * params._gridSize + cellY];
+        ++count;
+
+        if(count < keypointsPerCell)
+            filteredIndexes.push_back(i);
+        else
+            rejectedIndexes.push_back(i);
+    }
+
+    // If we do not have enough keypoints after the grid filtering (empty regions in the grid for example),
+    // we add the best other ones, without repartition constraint.
+    if(filteredIndexes.size() < params._maxTotalKeypoints)
+    {
+        const std::size_t remainingElements =
+            std::min(rejectedIndexes.size(), params._maxTotalKeypoints - filteredIndexes.size());
+        filteredIndexes.insert(filteredIndexes.end(), rejectedIndexes.begin(), rejectedIndexes.begin() + remainingElements);
+    }
+    return filteredIndexes;
+}
+
+} // namespace
+
 template <typename T>
 bool extractSIFT(const image::Image<float>& image, std::unique_ptr<Regions>& regions, const SiftParams& params,
                  bool orientation, const image::Image<unsigned char>* mask)
@@ -199,210 +301,168 @@ bool extractSIFT(const image::Image<float>& image, std::unique_ptr<Regions>& reg
     std::vector<float> featuresPeakValue;
     featuresPeakValue.reserve(reserveSize);
 
-    size_t maxOctaveKeypoints = params._maxTotalKeypoints;
+    // Compute the orientations and the descriptors of the keypoints of the current octave
+    std::mutex regionsMutex;
+    const auto describeKeypoints = [&](const VlSiftKeypoint* keys, const std::vector<IndexT>& keypointsIndex) {
+        system::parallelFor(0, keypointsIndex.size(), [&](std::ptrdiff_t ii)
+        {
+            const int i = keypointsIndex[ii];
 
-    while(true)
-    {
-        vl_sift_detect(filt);
+            double angles[4] = {0.0, 0.0, 0.0, 0.0};
+            int nangles = 1; // by default (1 upright feature)
+            if(orientation)
+            { // compute from 1 to 4 orientations
+                nangles = vl_sift_calc_keypoint_orientations(filt, angles, keys + i);
+            }
+
+            Descriptor<vl_sift_pix, 128> vlFeatDescriptor;
+            Descriptor<T, 128> descriptor;
+
+            for(int q = 0; q < nangles; ++q)
+            {
+                const PointFeature fp(keys[i].x, keys[i].y, keys[i].sigma, static_cast<float>(angles[q]));
 
-        VlSiftKeypoint const* keys = vl_sift_get_keypoints(filt);
-        const int nkeys = vl_sift_get_nkeypoints(filt);
+                vl_sift_calc_keypoint_descriptor(filt, &vlFeatDescriptor[0], keys + i, angles[q]);
+                convertSIFT<T>(&vlFeatDescriptor[0], descriptor, params._rootSift);
 
-        std::vector<IndexT> filteredKeypointsIndex;
+                std::lock_guard<std::mutex> lock(regionsMutex);
+                regionsCasted->Descriptors().push_back(descriptor);
+                regionsCasted->Features().push_back(fp);
+                featuresPeakValue.push_back(keys[i].peak_value);
+            }
+        });
+    };
 
-        // TODO: should we reduce maxOctaveKeypoints per octave?
+    const auto isMasked = [&](const VlSiftKeypoint& keypoint) {
+        return mask && (*mask)(keypoint.y, keypoint.x) > 0;
+    };
 
-        // grid filtering at the octave level
-        if(params._gridSize && params._maxTotalKeypoints &&
-           (params._contrastFiltering == EFeatureConstrastFiltering::GridSort ||
-            params._contrastFiltering == EFeatureConstrastFiltering::GridSortScaleSteps ||
-            params._contrastFiltering == EFeatureConstrastFiltering::GridSortOctaves))
+    if(params._gridSize && params._maxTotalKeypoints &&
+       params._contrastFiltering != EFeatureConstrastFiltering::NonExtremaFiltering)
+    {
+        // The keypoints of all the octaves are detected first, so that the grid filtering is done on the detector
+        // response and the descriptors are only computed for the selected keypoints.
+        std::vector<VlSiftKeypoint> detectedKeypoints;
+        while(true)
         {
-            // Only filter features if we have more features than the maxTotalKeypoints
-            if(nkeys > maxOctaveKeypoints)
-            {
-                // Sorting the extracted features according to their dog value (peak threshold)
-                std::vector<std::size_t> keysIndexSort(nkeys);
-                std::iota(keysIndexSort.begin(), keysIndexSort.end(), 0);
+            vl_sift_detect(filt);
 
-                if(params._contrastFiltering == EFeatureConstrastFiltering::GridSortScaleSteps)
-                {
-                    std::sort(keysIndexSort.begin(), keysIndexSort.end(), [&](std::size_t a, std::size_t b) {
-                        const int scaleA = int(log2(keys[a].sigma) * 3.0f); // 3 scale steps per octave
-                        const int scaleB = int(log2(keys[b].sigma) * 3.0f);
-                        if(scaleA == scaleB)
-                        {
-                            // sort by peak value, when we are in the same scale
-                            return keys[a].peak_value > keys[b].peak_value;
-                        }
-                        return scaleA > scaleB;
-                    });
-                }
-                else if(params._contrastFiltering == EFeatureConstrastFiltering::GridSortOctaveSteps)
-                {
-                    std::sort(keysIndexSort.begin(), keysIndexSort.end(), [&](std::size_t a, std::size_t b) {
-                        const int scaleA = int(log2(keys[a].sigma)); // 3 scale steps per octave
-                        const int scaleB = int(log2(keys[b].sigma));
-                        if(scaleA == scaleB)
-                        {
-                            // sort by peak value, when we are in the same scale
-                            return keys[a].peak_value > keys[b].peak_value;
-                        }
-                        return scaleA > scaleB;
-                    });
-                }
-                else if(params._contrastFiltering == EFeatureConstrastFiltering::GridSort)
-                {
-                    std::sort(keysIndexSort.begin(), keysIndexSort.end(), [&](std::size_t a, std::size_t b) {
-                        return keys[a].sigma * keys[a].peak_value > keys[b].sigma * keys[b].peak_value;
-                    });
-                }
-                else // GridSortOctaves
-                {
-                    // sort from largest peaks to smallest ones
-                    std::sort(keysIndexSort.begin(), keysIndexSort.end(),
-                              [&](std::size_t a, std::size_t b) { return keys[a].peak_value > keys[b].peak_value; });
-                }
+            VlSiftKeypoint const* keys = vl_sift_get_keypoints(filt);
+            const int nkeys = vl_sift_get_nkeypoints(filt);
+            for(int i = 0; i < nkeys; ++i)
+            {
+                if(!isMasked(keys[i]))
+                    detectedKeypoints.push_back(keys[i]);
+            }
 
-                std::vector<IndexT> rejected_indexes;
-                filteredKeypointsIndex.reserve(maxOctaveKeypoints);
-                rejected_indexes.reserve(nkeys);
+            if(vl_sift_process_next_octave(filt))
+                break; // Last octave
+        }
 
-                const std::size_t sizeMat = params._gridSize * params._gridSize;
-                std::vector<std::size_t> countFeatPerCell(sizeMat, 0);
-                for(int idx = 0; idx < sizeMat; ++idx)
-                {
-                    countFeatPerCell[idx] = 0;
-                }
-                const std::size_t keypointsPerCell = params._maxTotalKeypoints / sizeMat;
-                const double regionWidth = w / double(params._gridSize);
-                const double regionHeight = h / double(params._gridSize);
+        std::vector<IndexT> selectedKeypointsIndex = selectGridKeypoints(detectedKeypoints, w, h, params);
 
-                for(IndexT ii = 0; ii < nkeys; ++ii)
-                {
-                    const IndexT i = keysIndexSort[ii]; // use sorted keypoints
-                    const auto& keypoint = keys[i];
+        ALICEVISION_LOG_TRACE("SIFT keypoints:\n"
+                              << " * detected: " << detectedKeypoints.size() << "\n"
+                              << " * after grid filtering: " << selectedKeypointsIndex.size());
 
-                    const std::size_t cellX = std::min(std::size_t(keypoint.x / regionWidth), params._gridSize);
-                    const std::size_t cellY = std::min(std::size_t(keypoint.y / regionHeight), params._gridSize);
+        // The Gaussian scale space is computed again, the gradients only for the octaves with selected keypoints
+        std::sort(selectedKeypointsIndex.begin(), selectedKeypointsIndex.end());
 
-                    std::size_t& count = countFeatPerCell[cellX * params._gridSize + cellY];
-                    ++count;
+        std::size_t octaveBegin = 0;
+        if(!selectedKeypointsIndex.empty())
+            vl_sift_process_first_octave(filt, image.data());
 
-                    if(count < keypointsPerCell)
-                        filteredKeypointsIndex.push_back(i);
-                    else
-                        rejected_indexes.push_back(i);
-                }
-                // If we don't have enough features (less than maxTotalKeypoints) after the grid filtering (empty
-                // regions in the grid for example). We add the best other ones, without repartition constraint.
-                if(filteredKeypointsIndex.size() < params._maxTotalKeypoints && !rejected_indexes.empty())
-                {
-                    const std::size_t remainingElements =
-                        std::min(rejected_indexes.size(), params._maxTotalKeypoints - filteredKeypointsIndex.size());
-                    ALICEVISION_LOG_TRACE("Octave Grid filtering -- Copy remaining points: " << remainingElements);
-                    filteredKeypointsIndex.insert(filteredKeypointsIndex.end(), rejected_indexes.begin(),
-                                            rejected_indexes.begin() + remainingElements);
-                }
+        while(octaveBegin < selectedKeypointsIndex.size())
+        {
+            const int octave = vl_sift_get_octave_index(filt);
+            std::size_t octaveEnd = octaveBegin;
+            while(octaveEnd < selectedKeypointsIndex.size() && detectedKeypoints[selectedKeypointsIndex[octaveEnd]].o == octave)
+                ++octaveEnd;
 
-                ALICEVISION_LOG_TRACE("Octave SIFT keypoints:\n"
-                                      << " * detected: " << nkeys << "\n"
-                                      << " * max octave keypoints: " << maxOctaveKeypoints << "\n"
-                                      << " * after grid filtering: " << filteredKeypointsIndex.size());
+            if(octaveEnd > octaveBegin)
+            {
+                vl_sift_update_gradient(filt);
+                describeKeypoints(detectedKeypoints.data(),
+                                  std::vector<IndexT>(selectedKeypointsIndex.begin() + octaveBegin,
+                                                      selectedKeypointsIndex.begin() + octaveEnd));
             }
+            octaveBegin = octaveEnd;
+
+            if(octaveBegin == selectedKeypointsIndex.size() || vl_sift_process_next_octave(filt))
+                break; // Last octave
         }
-        else if(params._maxTotalKeypoints &&
-                params._contrastFiltering == EFeatureConstrastFiltering::NonExtremaFiltering)
+    }
+    else
+    {
+        while(true)
         {
-            std::vector<float> radiusMaxima(nkeys, std::numeric_limits<float>::max());
-            for(IndexT i = 0; i < nkeys; ++i)
+            vl_sift_detect(filt);
+
+            VlSiftKeypoint const* keys = vl_sift_get_keypoints(filt);
+            const int nkeys = vl_sift_get_nkeypoints(filt);
+
+            std::vector<IndexT> filteredKeypointsIndex;
+
+            if(params._maxTotalKeypoints &&
+               params._contrastFiltering == EFeatureConstrastFiltering::NonExtremaFiltering)
             {
-                const auto& keypointI = keys[i];
-                for(IndexT j = 0; j < nkeys; ++j)
+                std::vector<float> radiusMaxima(nkeys, std::numeric_limits<float>::max());
+                for(IndexT i = 0; i < nkeys; ++i)
                 {
-                    const auto& keypointJ = keys[j];
-                    if(keypointJ.peak_value > keypointI.peak_value)
+                    const auto& keypointI = keys[i];
+                    for(IndexT j = 0; j < nkeys; ++j)
                     {
-                        const float dx = (keypointJ.x - keypointI.x);
-                        const float dy = (keypointJ.y - keypointI.y);
-                        const float radius = dx * dx + dy * dy;
-                        if(radius < radiusMaxima[i])
-                            radiusMaxima[i] = radius;
+                        const auto& keypointJ = keys[j];
+                        if(keypointJ.peak_value > keypointI.peak_value)
+                        {
+                            const float dx = (keypointJ.x - keypointI.x);
+                            const float dy = (keypointJ.y - keypointI.y);
+                            const float radius = dx * dx + dy * dy;
+                            if(radius < radiusMaxima[i])
+                                radiusMaxima[i] = radius;
+                        }
                     }
                 }
+                filteredKeypointsIndex.resize(nkeys);
+                std::iota(filteredKeypointsIndex.begin(), filteredKeypointsIndex.end(), 0);
+                const std::size_t maxKeypoints = std::min(params._maxTotalKeypoints, std::size_t(nkeys));
+                std::partial_sort(filteredKeypointsIndex.begin(),
+                                  filteredKeypointsIndex.begin() + maxKeypoints,
+                                  filteredKeypointsIndex.end(), [&](int a, int b) {
+                                      return radiusMaxima[a] * keys[a].sigma > radiusMaxima[b] * keys[b].sigma;
+                                  });
+                filteredKeypointsIndex.resize(maxKeypoints);
             }
-            filteredKeypointsIndex.resize(nkeys);
-            std::iota(filteredKeypointsIndex.begin(), filteredKeypointsIndex.end(), 0);
-            const std::size_t maxKeypoints = std::min(params._maxTotalKeypoints, std::size_t(nkeys));
-            std::partial_sort(filteredKeypointsIndex.begin(),
-                              filteredKeypointsIndex.begin() + maxKeypoints,
-                              filteredKeypointsIndex.end(), [&](int a, int b) {
-                                  return radiusMaxima[a] * keys[a].sigma > radiusMaxima[b] * keys[b].sigma;
-                              });
-            filteredKeypointsIndex.resize(maxKeypoints);
-        }
 
-        if(filteredKeypointsIndex.empty())
-        {
-            ALICEVISION_LOG_TRACE("Octave SIFT nb keypoints:\n" << nkeys << " (no grid filtering)");
-            filteredKeypointsIndex.resize(nkeys);
-            std::iota(filteredKeypointsIndex.begin(), filteredKeypointsIndex.end(), 0);
-        }
-
-        // Update gradient before launching parallel extraction
-        vl_sift_update_gradient(filt);
-
-        // Feature masking
-        if(mask)
-        {
-            std::vector<IndexT> newFilteredKeypointsIndex;
-            const image::Image<unsigned char>& maskIma = *mask;
-
-            for(int ii = 0; ii < filteredKeypointsIndex.size(); ++ii)
+            if(filteredKeypointsIndex.empty())
             {
-                const int i = filteredKeypointsIndex[ii];
-                if(maskIma(keys[i].y, keys[i].x) > 0)
-                    continue;
-                newFilteredKeypointsIndex.push_back(i);
-            }
-            filteredKeypointsIndex.swap(newFilteredKeypointsIndex);
-        }
-
-        std::vector<std::vector<double>> anglesPerKeypoint(filteredKeypointsIndex.size());
-
-#pragma omp parallel for
-        for(int ii = 0; ii < filteredKeypointsIndex.size(); ++ii)
-        {
-            const int i = filteredKeypointsIndex[ii];
-
-            double angles[4] = {0.0, 0.0, 0.0, 0.0};
-            int nangles = 1; // by default (1 upright feature)
-            if(orientation)
-            { // compute from 1 to 4 orientations
-                nangles = vl_sift_calc_keypoint_orientations(filt, angles, keys + i);
+                ALICEVISION_LOG_TRACE("Octave SIFT nb keypoints:\n" << nkeys << " (no grid filtering)");
+                filteredKeypointsIndex.resize(nkeys);
+                std::iota(filteredKeypointsIndex.begin(), filteredKeypointsIndex.end(), 0);
             }
 
-            Descriptor<vl_sift_pix, 128> vlFeatDescriptor;
-            Descriptor<T, 128> descriptor;
+            // Update gradient before launching parallel extraction
+            vl_sift_update_gradient(filt);
 
-            for(int q = 0; q < nangles; ++q)
+            // Feature masking
+            if(mask)
             {
-                const PointFeature fp(keys[i].x, keys[i].y, keys[i].sigma, static_cast<float>(angles[q]));
-
-                vl_sift_calc_keypoint_descriptor(filt, &vlFeatDescriptor[0], keys + i, angles[q]);
-                convertSIFT<T>(&vlFeatDescriptor[0], descriptor, params._rootSift);
-
-#pragma omp critical
+                std::vector<IndexT> newFilteredKeypointsIndex;
+                for(int ii = 0; ii < filteredKeypointsIndex.size(); ++ii)
                 {
-                    regionsCasted->Descriptors().push_back(descriptor);
-                    regionsCasted->Features().push_back(fp);
-                    featuresPeakValue.push_back(keys[i].peak_value);
+                    const int i = filteredKeypointsIndex[ii];
+                    if(isMasked(keys[i]))
+                        continue;
+                    newFilteredKeypointsIndex.push_back(i);
                 }
+                filteredKeypointsIndex.swap(newFilteredKeypointsIndex);
             }
-        }
 
-        if(vl_sift_process_next_octave(filt))
-            break; // Last octave
+            describeKeypoints(keys, filteredKeypointsIndex);
+
+            if(vl_sift_process_next_octave(filt))
+                break; // Last octave
+        }
     }
     vl_sift_delete(filt);
 
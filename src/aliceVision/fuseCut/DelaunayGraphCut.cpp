@@ -8,8 +8,9 @@
 // #define ALICEVISION_DEBUG_VOTE
 
 #include "DelaunayGraphCut.hpp"
-// #include <aliceVision/fuseCut/MaxFlow_CSR.hpp>
+#include <aliceVision/fuseCut/MaxFlow_CSR.hpp>
 #include <aliceVision/fuseCut/MaxFlow_AdjList.hpp>
+#include <aliceVision/fuseCut/MaxFlow_PushRelabel.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/mvsData/geometry.hpp>
 #include <aliceVision/mvsData/jetColorMap.hpp>
@@ -20,16 +21,23 @@
 #include <aliceVision/mvsUtils/depthSimMapIO.hpp>
 #include <aliceVision/image/imageAlgo.hpp>
 #include <aliceVision/system/ProgressDisplay.hpp>
+#include <aliceVision/system/MemoryTracker.hpp>
+#include <aliceVision/system/numa.hpp>
+#include <aliceVision/system/Profiler.hpp>
+#include <aliceVision/system/Timer.hpp>
 #include <aliceVision/alicevision_omp.hpp>
 
 #include "nanoflann.hpp"
 
 #include <geogram/points/kd_tree.h>
+#include <geogram/basic/process.h>
 
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/operations.hpp>
 
+#include <algorithm>
 #include <cmath>
+#include <memory>
 #include <random>
 #include <stdexcept>
 
@@ -242,7 +250,18 @@ void removeInvalidPoints(std::vector<Point3d>& verticesCoordsPrepare, std::vecto
     simScorePrepare.swap(simScoreTmp);
 }
 
-void removeInvalidPoints(std::vector<Point3d>& verticesCoordsPrepare, std::vector<double>& pixSizePrepare, std::vector<float>& simScorePrepare, std::vector<GC_vertexInfo>& verticesAttrPrepare)
+/**
+ * @brief Vertex information during the depth maps fusion,
+ *        the cameras are packed into the vertices cameras pool once the points are selected.
+ */
+struct VertexInfoPrepare
+{
+    float pixSize = 0.0f;
+    int nrc = 0;
+    StaticVector<int> cams;
+};
+
+void removeInvalidPoints(std::vector<Point3d>& verticesCoordsPrepare, std::vector<double>& pixSizePrepare, std::vector<float>& simScorePrepare, std::vector<VertexInfoPrepare>& verticesAttrPrepare)
 {
     std::vector<Point3d> verticesCoordsTmp;
     verticesCoordsTmp.reserve(verticesCoordsPrepare.size());
@@ -250,7 +269,7 @@ void removeInvalidPoints(std::vector<Point3d>& verticesCoordsPrepare, std::vecto
     pixSizeTmp.reserve(pixSizePrepare.size());
     std::vector<float> simScoreTmp;
     simScoreTmp.reserve(simScorePrepare.size());
-    std::vector<GC_vertexInfo> verticesAttrTmp;
+    std::vector<VertexInfoPrepare> verticesAttrTmp;
     verticesAttrTmp.reserve(verticesAttrPrepare.size());
     for(int i = 0; i < verticesCoordsPrepare.size(); ++i)
     {
@@ -259,7 +278,7 @@ void removeInvalidPoints(std::vector<Point3d>& verticesCoordsPrepare, std::vecto
             verticesCoordsTmp.push_back(verticesCoordsPrepare[i]);
             pixSizeTmp.push_back(pixSizePrepare[i]);
             simScoreTmp.push_back(simScorePrepare[i]);
-            verticesAttrTmp.push_back(verticesAttrPrepare[i]);
+            verticesAttrTmp.push_back(std::move(verticesAttrPrepare[i]));
         }
     }
     ALICEVISION_LOG_INFO((verticesCoordsPrepare.size() - verticesCoordsTmp.size()) << " invalid points removed.");
@@ -270,7 +289,7 @@ void removeInvalidPoints(std::vector<Point3d>& verticesCoordsPrepare, std::vecto
 }
 
 void createVerticesWithVisibilities(const StaticVector<int>& cams, std::vector<Point3d>& verticesCoordsPrepare, std::vector<double>& pixSizePrepare, std::vector<float>& simScorePrepare,
-                                    std::vector<GC_vertexInfo>& verticesAttrPrepare, mvsUtils::MultiViewParams& mp, float simFactor, float voteMarginFactor, float contributeMarginFactor, float simGaussianSize)
+                                    std::vector<VertexInfoPrepare>& verticesAttrPrepare, mvsUtils::MultiViewParams& mp, float simFactor, float voteMarginFactor, float contributeMarginFactor, float simGaussianSize)
 {
 #ifdef USE_GEOGRAM_KDTREE
     GEO::AdaptiveKdTree kdTree(3);
@@ -357,7 +376,7 @@ void createVerticesWithVisibilities(const StaticVector<int>& cams, std::vector<P
 
                 if(dist < voteMarginFactor * std::max(pixSizeScoreI, pixSizeScoreV))
                 {
-                    GC_vertexInfo& va = verticesAttrPrepare[nearestVertexIndex];
+                    VertexInfoPrepare& va = verticesAttrPrepare[nearestVertexIndex];
                     Point3d& vc = verticesCoordsPrepare[nearestVertexIndex];
                     const float simValue = simMap(index);
                     // remap similarity values from [-1;+1] to [+1;+simFactor]
@@ -393,7 +412,7 @@ void createVerticesWithVisibilities(const StaticVector<int>& cams, std::vector<P
     #pragma omp parallel for
     for(int vi = 0; vi < verticesAttrPrepare.size(); ++vi)
     {
-        GC_vertexInfo& v = verticesAttrPrepare[vi];
+        VertexInfoPrepare& v = verticesAttrPrepare[vi];
         v.pixSize = mp.getCamsMinPixelSize(verticesCoordsPrepare[vi], v.cams);
     }
 
@@ -423,7 +442,27 @@ DelaunayGraphCut::DelaunayGraphCut(mvsUtils::MultiViewParams& mp)
     saveTemporaryBinFiles = _mp.userParams.get<bool>("LargeScale.saveTemporaryBinFiles", false);
 
     GEO::initialize();
-    _tetrahedralization = GEO::Delaunay::create(3, "BDEL");
+
+    // "BDEL": sequential insertion, "PDEL": parallel insertion (requires Geogram with multithreading support)
+    const std::string delaunayBackend = _mp.userParams.get<std::string>("delaunaycut.delaunayBackend", "BDEL");
+    if(delaunayBackend == "PDEL")
+    {
+        // Geogram threads follow the OpenMP threads limit (set from the hardware context)
+        GEO::Process::enable_multithreading(true);
+        GEO::Process::set_max_threads(GEO::index_t(omp_get_max_threads()));
+    }
+    else if(delaunayBackend != "BDEL")
+    {
+        ALICEVISION_THROW_ERROR("Unknown Delaunay backend: " << delaunayBackend);
+    }
+
+    _tetrahedralization = GEO::Delaunay::create(3, delaunayBackend);
+    if(_tetrahedralization.is_null())
+    {
+        ALICEVISION_LOG_WARNING("Delaunay backend " << delaunayBackend << " is not available, use BDEL.");
+        _tetrahedralization = GEO::Delaunay::create(3, "BDEL");
+    }
+    ALICEVISION_LOG_INFO("Delaunay backend: " << delaunayBackend << " (" << omp_get_max_threads() << " threads).");
     // _tetrahedralization->set_keeps_infinite(true);
     _tetrahedralization->set_stores_neighbors(true);
     // _tetrahedralization->set_stores_cicl(true);
@@ -441,7 +480,7 @@ void DelaunayGraphCut::saveDhInfo(const std::string& fileNameInfo)
     fwrite(&npts, sizeof(int), 1, f);
     for(const GC_vertexInfo& v: _verticesAttr)
     {
-        v.fwriteinfo(f);
+        v.fwriteinfo(f, _verticesCamerasPool);
     }
 
     int ncells = _cellsAttr.size();
@@ -475,7 +514,10 @@ std::vector<DelaunayGraphCut::CellIndex> DelaunayGraphCut::getNeighboringCellsBy
     case EGeometryType::Edge:
         return getNeighboringCellsByEdge(g.edge);
     case EGeometryType::Vertex:
-        return getNeighboringCellsByVertexIndex(g.vertexIndex);
+    {
+        const GC_arrayView<CellIndex> neighboringCells = getNeighboringCellsByVertexIndex(g.vertexIndex);
+        return std::vector<CellIndex>(neighboringCells.begin(), neighboringCells.end());
+    }
     case EGeometryType::Facet:
         return getNeighboringCellsByFacet(g.facet);
     case EGeometryType::None:
@@ -498,8 +540,8 @@ std::vector<DelaunayGraphCut::CellIndex> DelaunayGraphCut::getNeighboringCellsBy
 
 std::vector<DelaunayGraphCut::CellIndex> DelaunayGraphCut::getNeighboringCellsByEdge(const Edge& e) const
 {
-    const std::vector<CellIndex>& v0ci = getNeighboringCellsByVertexIndex(e.v0);
-    const std::vector<CellIndex>& v1ci = getNeighboringCellsByVertexIndex(e.v1);
+    const GC_arrayView<CellIndex> v0ci = getNeighboringCellsByVertexIndex(e.v0);
+    const GC_arrayView<CellIndex> v1ci = getNeighboringCellsByVertexIndex(e.v1);
 
     std::vector<CellIndex> neighboringCells;
     std::set_intersection(v0ci.begin(), v0ci.end(), v1ci.begin(), v1ci.end(), std::back_inserter(neighboringCells));
@@ -526,9 +568,12 @@ void DelaunayGraphCut::computeDelaunay()
 
 void DelaunayGraphCut::initCells()
 {
+    // the cells are processed by parallel loops, their pages are placed on the nodes of these threads
+    system::firstTouchReserve(_cellsAttr, _tetrahedralization->nb_cells());
     _cellsAttr.resize(_tetrahedralization->nb_cells()); // or nb_finite_cells() if keeps_infinite()
 
     ALICEVISION_LOG_INFO(_cellsAttr.size() << " cells created by tetrahedralization.");
+    #pragma omp parallel for
     for(int i = 0; i < _cellsAttr.size(); ++i)
     {
         GC_cellInfo& c = _cellsAttr[i];
@@ -547,6 +592,58 @@ void DelaunayGraphCut::initCells()
     ALICEVISION_LOG_DEBUG("initCells [" << _tetrahedralization->nb_cells() << "] done");
 }
 
+void DelaunayGraphCut::updateVertexToCellsCache()
+{
+    const std::size_t nbVertices = _verticesCoords.size();
+    const std::ptrdiff_t nbCells = static_cast<std::ptrdiff_t>(_tetrahedralization->nb_cells());
+
+    _neighboringCellsOffsets.assign(nbVertices + 1, 0);
+    _neighboringCells.clear();
+
+    // count the cells of each vertex
+    int coutInvalidVertices = 0;
+    #pragma omp parallel for reduction(+:coutInvalidVertices)
+    for(std::ptrdiff_t ci = 0; ci < nbCells; ++ci)
+    {
+        for(VertexIndex k = 0; k < 4; ++k)
+        {
+            const VertexIndex vi = _tetrahedralization->cell_vertex(ci, k);
+            if(vi == GEO::NO_VERTEX || vi >= nbVertices)
+            {
+                ++coutInvalidVertices;
+                continue;
+            }
+            boost::atomic_ref<std::size_t>{_neighboringCellsOffsets[vi + 1]}++;
+        }
+    }
+    ALICEVISION_LOG_INFO("coutInvalidVertices: " << coutInvalidVertices);
+    ALICEVISION_LOG_INFO("verticesCoords: " << nbVertices);
+
+    for(std::size_t vi = 0; vi < nbVertices; ++vi)
+        _neighboringCellsOffsets[vi + 1] += _neighboringCellsOffsets[vi];
+
+    // fill the cells of each vertex
+    system::firstTouchReserve(_neighboringCells, _neighboringCellsOffsets.back());
+    _neighboringCells.resize(_neighboringCellsOffsets.back());
+    std::vector<std::size_t> fillOffsets(_neighboringCellsOffsets.begin(), _neighboringCellsOffsets.end() - 1);
+    #pragma omp parallel for
+    for(std::ptrdiff_t ci = 0; ci < nbCells; ++ci)
+    {
+        for(VertexIndex k = 0; k < 4; ++k)
+        {
+            const VertexIndex vi = _tetrahedralization->cell_vertex(ci, k);
+            if(vi == GEO::NO_VERTEX || vi >= nbVertices)
+                continue;
+            _neighboringCells[boost::atomic_ref<std::size_t>{fillOffsets[vi]}++] = ci;
+        }
+    }
+
+    // the cells are filled in any order by the threads, sort them to keep a deterministic order
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for(std::ptrdiff_t vi = 0; vi < static_cast<std::ptrdiff_t>(nbVertices); ++vi)
+        std::sort(_neighboringCells.begin() + _neighboringCellsOffsets[vi], _neighboringCells.begin() + _neighboringCellsOffsets[vi + 1]);
+}
+
 void DelaunayGraphCut::displayStatistics()
 {
     // Display some statistics
@@ -556,6 +653,15 @@ void DelaunayGraphCut::displayStatistics()
     for(int i = 0; i < ptsCamsHist->size(); ++i)
         ALICEVISION_LOG_TRACE("    " << i << ": " << mvsUtils::num2str((*ptsCamsHist)[i]));
     delete ptsCamsHist;
+
+    if(_fillGraphStats.nbBatches > 0)
+    {
+        ALICEVISION_LOG_INFO("s-t graph weights timings:" << std::endl
+                             << "\t- ray casting: " << _fillGraphStats.rayCastingTime << " s (" << _fillGraphStats.nbRays << " rays)" << std::endl
+                             << "\t- votes merge: " << _fillGraphStats.mergeTime << " s (" << _fillGraphStats.nbVotes << " votes)" << std::endl
+                             << "\t- " << _fillGraphStats.nbBatches << " batch(es), "
+                             << (_fillGraphStats.partitioned ? std::to_string(_fillGraphStats.nbPartitions) + " cell ranges" : std::string("atomic votes")));
+    }
     /*
     StaticVector<int>* ptsNrcsHist = getPtsNrcHist();
     ALICEVISION_LOG_TRACE("Histogram of Nrc per point:");
@@ -577,9 +683,9 @@ StaticVector<StaticVector<int>*>* DelaunayGraphCut::createPtsCams()
     {
         StaticVector<int>* cams = new StaticVector<int>();
         cams->reserve(v.getNbCameras());
-        for(int c = 0; c < v.getNbCameras(); c++)
+        for(const int cam : _verticesCamerasPool.get(v.cams))
         {
-            cams->push_back(v.cams[c]);
+            cams->push_back(cam);
         }
         out->push_back(cams);
     } // for i
@@ -602,9 +708,9 @@ void DelaunayGraphCut::createPtsCams(StaticVector<StaticVector<int>>& out_ptsCam
     {
         StaticVector<int> cams;
         cams.reserve(v.getNbCameras());
-        for(int c = 0; c < v.getNbCameras(); c++)
+        for(const int cam : _verticesCamerasPool.get(v.cams))
         {
-            cams.push_back(v.cams[c]);
+            cams.push_back(cam);
         }
         out_ptsCams.push_back(cams);
     } // for i
@@ -673,10 +779,8 @@ StaticVector<int> DelaunayGraphCut::getIsUsedPerCamera() const
 //#pragma omp parallel for
     for(int vi = 0; vi < _verticesAttr.size(); ++vi)
     {
-        const GC_vertexInfo& v = _verticesAttr[vi];
-        for(int c = 0; c < v.cams.size(); ++c)
+        for(const int obsCam : getVertexCameras(vi))
         {
-            const int obsCam = v.cams[c];
             // boost::atomic_ref<int>(cams[obsCam]) = 1;
             cams[obsCam] = 1;
         }
@@ -705,6 +809,8 @@ void DelaunayGraphCut::addPointsFromSfM(const Point3d hexah[8], const StaticVect
   const std::size_t nbPoints = sfmData.getLandmarks().size();
   const std::size_t verticesOffset = _verticesCoords.size();
 
+  system::firstTouchReserve(_verticesCoords, verticesOffset + nbPoints);
+  system::firstTouchReserve(_verticesAttr, verticesOffset + nbPoints);
   _verticesCoords.resize(verticesOffset + nbPoints);
   _verticesAttr.resize(verticesOffset + nbPoints);
 
@@ -726,12 +832,14 @@ void DelaunayGraphCut::addPointsFromSfM(const Point3d hexah[8], const StaticVect
       *vCoordsIt = p;
 
       vAttrIt->nrc = landmark.observations.size();
-      vAttrIt->cams.reserve(vAttrIt->nrc);
 
+      StaticVector<int> landmarkCams;
+      landmarkCams.reserve(vAttrIt->nrc);
       for(const auto& observationPair : landmark.observations)
-        vAttrIt->cams.push_back(_mp.getIndexFromViewId(observationPair.first));
+        landmarkCams.push_back(_mp.getIndexFromViewId(observationPair.first));
 
-      vAttrIt->pixSize = _mp.getCamsMinPixelSize(p, vAttrIt->cams);
+      vAttrIt->cams = _verticesCamerasPool.add(landmarkCams);
+      vAttrIt->pixSize = _mp.getCamsMinPixelSize(p, landmarkCams);
 
       ++vCoordsIt;
       ++vAttrIt;
@@ -747,20 +855,31 @@ void DelaunayGraphCut::addPointsFromSfM(const Point3d hexah[8], const StaticVect
   ALICEVISION_LOG_WARNING("Add " << addedPoints << " new points for the SfM.");
 }
 
+void DelaunayGraphCut::updateVerticesHash(float minDist)
+{
+    if(_verticesHash.getMinDist() != minDist || _verticesHash.size() > _verticesCoords.size())
+        _verticesHash.reset(minDist);
+    _verticesHash.insertPoints(_verticesCoords, _verticesHash.size(), _verticesCoords.size());
+}
+
 void DelaunayGraphCut::addPointsFromCameraCenters(const StaticVector<int>& cams, float minDist)
 {
+    updateVerticesHash(minDist);
+
     int addedPoints = 0;
     for(int camid = 0; camid < cams.size(); camid++)
     {
         int rc = cams[camid];
         {
             const Point3d p(_mp.CArr[rc].x, _mp.CArr[rc].y, _mp.CArr[rc].z);
-            const GEO::index_t vi = locateNearestVertex(p);
+            const std::size_t vi = _verticesHash.findNearby(_verticesCoords, p);
 
-            if((vi == GEO::NO_VERTEX) || ((_verticesCoords[vi] - _mp.CArr[rc]).size() > minDist))
+            // if there is no vertex closer than minDist
+            if(vi == PointsVoxelHash::npos)
             {
                 const GEO::index_t nvi = _verticesCoords.size();
                 _verticesCoords.push_back(p);
+                _verticesHash.insertPoint(_verticesCoords, nvi);
 
                 GC_vertexInfo newv;
                 newv.nrc = 0;
@@ -796,15 +915,18 @@ void DelaunayGraphCut::addPointsToPreventSingularities(const Point3d voxel[8], f
     extrPts[4] = fcg + (fcg - vcg) / 10.0f;
     fcg = (voxel[3] + voxel[2] + voxel[6] + voxel[7]) / 4.0f;
     extrPts[5] = fcg + (fcg - vcg) / 10.0f;
+    updateVerticesHash(minDist);
+
     int addedPoints = 0;
     for(int i = 0; i < 6; i++)
     {
         const Point3d p(extrPts[i].x, extrPts[i].y, extrPts[i].z);
-        const GEO::index_t vi = locateNearestVertex(p);
 
-        if((vi == GEO::NO_VERTEX) || ((_verticesCoords[vi] - extrPts[i]).size() > minDist))
+        // if there is no vertex closer than minDist
+        if(_verticesHash.findNearby(_verticesCoords, p) == PointsVoxelHash::npos)
         {
             _verticesCoords.push_back(p);
+            _verticesHash.insertPoint(_verticesCoords, _verticesCoords.size() - 1);
             GC_vertexInfo newv;
             newv.nrc = 0;
 
@@ -830,17 +952,17 @@ void DelaunayGraphCut::densifyWithHelperPoints(int nbFront, int nbBack, double s
         const Point3d& v = _verticesCoords[vi];
         const GC_vertexInfo& vAttr = _verticesAttr[vi];
 
-        if(vAttr.cams.empty() || vAttr.pixSize <= std::numeric_limits<float>::epsilon())
+        if(vAttr.isVirtual() || vAttr.pixSize <= std::numeric_limits<float>::epsilon())
             continue;
 
         Point3d mainCamDir;
-        for(int camId: vAttr.cams)
+        for(int camId: getVertexCameras(vi))
         {
             const Point3d& cam = _mp.CArr[camId];
             const Point3d d = (cam - v).normalize();
             mainCamDir += d;
         }
-        mainCamDir /= double(vAttr.cams.size());
+        mainCamDir /= double(vAttr.getNbCameras());
         mainCamDir = mainCamDir.normalize() * vAttr.pixSize;
         
         for(int iFront = 1; iFront < nbFront + 1; ++iFront)
@@ -848,6 +970,8 @@ void DelaunayGraphCut::densifyWithHelperPoints(int nbFront, int nbBack, double s
         for(int iBack = 1; iBack < nbBack + 1; ++iBack)
             newHelperPoints.push_back(v - mainCamDir * iBack * scale);
     }
+    system::firstTouchReserve(_verticesCoords, nbInputVertices + newHelperPoints.size());
+    system::firstTouchReserve(_verticesAttr, nbInputVertices + newHelperPoints.size());
     _verticesCoords.resize(nbInputVertices + newHelperPoints.size());
     _verticesAttr.resize(nbInputVertices + newHelperPoints.size());
     for(std::size_t vi = 0; vi < newHelperPoints.size(); ++vi)
@@ -884,6 +1008,8 @@ void DelaunayGraphCut::addGridHelperPoints(int helperPointsGridSize, const Point
     std::mt19937 generator(seed != 0 ? seed : std::random_device{}());
     auto rand = std::bind(std::uniform_real_distribution<float>{0.0, 1.0}, generator);
 
+    updateVerticesHash(minDist);
+
     int addedPoints = 0;
     for(int x = 0; x <= ns; ++x)
     {
@@ -896,12 +1022,12 @@ void DelaunayGraphCut::addGridHelperPoints(int helperPointsGridSize, const Point
                 pt = pt + (CG - pt).normalize() * (maxSize * rand());
 
                 const Point3d p(pt.x, pt.y, pt.z);
-                const GEO::index_t vi = locateNearestVertex(p);
 
-                // if there is no nearest vertex or the nearest vertex is not too close
-                if((vi == GEO::NO_VERTEX) || ((_verticesCoords[vi] - pt).size() > minDist))
+                // if there is no vertex closer than minDist
+                if(_verticesHash.findNearby(_verticesCoords, p) == PointsVoxelHash::npos)
                 {
                     _verticesCoords.push_back(p);
+                    _verticesHash.insertPoint(_verticesCoords, _verticesCoords.size() - 1);
                     GC_vertexInfo newv;
                     newv.nrc = 0;
 
@@ -1018,7 +1144,7 @@ void DelaunayGraphCut::addMaskHelperPoints(const Point3d voxel[8], const StaticV
                         GC_vertexInfo newv;
                         newv.nrc = params.maskHelperPointsWeight;
                         newv.pixSize = 0.0f;
-                        newv.cams.push_back_distinct(c);
+                        newv.cams = _verticesCamerasPool.add(&c, &c + 1);
 
                         _verticesAttr.push_back(newv);
                         _verticesCoords.emplace_back(p);
@@ -1086,9 +1212,14 @@ void DelaunayGraphCut::fuseFromDepthMaps(const StaticVector<int>& cams, const Po
             const int width = _mp.getWidth(c);
             const int height = _mp.getHeight(c);
 
+            // only the image region covered by the voxel can produce points, the score kernel needs a 1 pixel margin
+            const ROI roi = (voxel == nullptr) ? ROI(0, width, 0, height) : _mp.getHexahedronImageROI(c, voxel, 1);
+            const int roiWidth = roi.width();
+
+            if(!roi.isEmpty())
             {
                 // read depth map
-                mvsUtils::readDepthMap(c, _mp, depthMap, 0);
+                mvsUtils::readDepthMapROI(c, _mp, roi, depthMap, 0);
 
                 if(depthMap.size() <= 0)
                 {
@@ -1099,7 +1230,7 @@ void DelaunayGraphCut::fuseFromDepthMaps(const StaticVector<int>& cams, const Po
                 // read similarity map
                 try
                 {
-                    mvsUtils::readSimMap(c, _mp, simMap, 0);
+                    mvsUtils::readSimMapROI(c, _mp, roi, simMap, 0);
                         image::Image<float> simMapTmp;
                         imageAlgo::convolveImage(simMap, simMapTmp, "gaussian",
                                                  params.simGaussianSizeInit,
@@ -1109,7 +1240,7 @@ void DelaunayGraphCut::fuseFromDepthMaps(const StaticVector<int>& cams, const Po
                 catch(const std::exception& e)
                 {
                     ALICEVISION_LOG_WARNING("simMap file can't be found.");
-                    simMap.resize(width, height, true, -1);
+                    simMap.resize(roi.width(), roi.height(), true, -1);
                 }
 
                 // read nmod map
@@ -1123,11 +1254,15 @@ void DelaunayGraphCut::fuseFromDepthMaps(const StaticVector<int>& cams, const Po
                                      image::EImageColorSpace::NO_CONVERSION);
                     if (numOfModalsMap.Width() != width || numOfModalsMap.Height() != height)
                         throw std::runtime_error("Wrong nmod map dimensions: " + nmodMapFilepath);
+
+                    // crop to the region of interest
+                    image::Image<unsigned char> numOfModalsMapTmp(numOfModalsMap.block(roi.y.begin, roi.x.begin, roi.height(), roi.width()));
+                    numOfModalsMap.swap(numOfModalsMapTmp);
                 }
                 else
                 {
                     ALICEVISION_LOG_WARNING("nModMap file can't be found.");
-                    numOfModalsMap.resize(width, height, true, 1);
+                    numOfModalsMap.resize(roi.width(), roi.height(), true, 1);
                 }
             }
 
@@ -1144,26 +1279,28 @@ void DelaunayGraphCut::fuseFromDepthMaps(const StaticVector<int>& cams, const Po
                     float bestSimScore = 0;
                     int bestX = 0;
                     int bestY = 0;
-                    for(int y = sy * step, ymax = std::min((sy+1) * step, height);
+                    // pixels outside of the region of interest are skipped, the point is discarded if there is no valid pixel
+                    for(int y = std::max(sy * step, int(roi.y.begin)), ymax = std::min((sy+1) * step, int(roi.y.end));
                         y < ymax; ++y)
                     {
-                        for(int x = sx * step, xmax = std::min((sx+1) * step, width);
+                        for(int x = std::max(sx * step, int(roi.x.begin)), xmax = std::min((sx+1) * step, int(roi.x.end));
                             x < xmax; ++x)
                         {
-                            const std::size_t index = y * width + x;
+                            const std::size_t index = (y - roi.y.begin) * roiWidth + (x - roi.x.begin);
                             const float depth = depthMap(index);
                             if(depth <= 0.0f)
                                 continue;
 
                             int numOfModals = 0;
                             const int scoreKernelSize = 1;
-                            for(int ly = std::max(y-scoreKernelSize, 0), lyMax = std::min(y+scoreKernelSize, height-1); ly < lyMax; ++ly)
+                            for(int ly = std::max(y-scoreKernelSize, int(roi.y.begin)), lyMax = std::min(y+scoreKernelSize, int(roi.y.end)-1); ly < lyMax; ++ly)
                             {
-                                for(int lx = std::max(x-scoreKernelSize, 0), lxMax = std::min(x+scoreKernelSize, width-1); lx < lxMax; ++lx)
+                                for(int lx = std::max(x-scoreKernelSize, int(roi.x.begin)), lxMax = std::min(x+scoreKernelSize, int(roi.x.end)-1); lx < lxMax; ++lx)
                                 {
-                                    if (depthMap(ly * width + lx) > 0.0f)
+                                    const std::size_t lIndex = (ly - roi.y.begin) * roiWidth + (lx - roi.x.begin);
+                                    if (depthMap(lIndex) > 0.0f)
                                     {
-                                        numOfModals += 10 + int(numOfModalsMap(ly * width + lx));
+                                        numOfModals += 10 + int(numOfModalsMap(lIndex));
                                     }
                                 }
                             }
@@ -1222,7 +1359,7 @@ void DelaunayGraphCut::fuseFromDepthMaps(const StaticVector<int>& cams, const Po
     ALICEVISION_LOG_INFO("3D points loaded and filtered to " << verticesCoordsPrepare.size() << " points.");
 
     ALICEVISION_LOG_INFO("Init visibilities to compute angle scores");
-    std::vector<GC_vertexInfo> verticesAttrPrepare(verticesCoordsPrepare.size());
+    std::vector<VertexInfoPrepare> verticesAttrPrepare(verticesCoordsPrepare.size());
 
     // Compute the vertices positions and simScore from all input depthMap/simMap images,
     // and declare the visibility information (the cameras indexes seeing the vertex).
@@ -1342,13 +1479,30 @@ void DelaunayGraphCut::fuseFromDepthMaps(const StaticVector<int>& cams, const Po
     {
         // replace with the new points if emoty
         _verticesCoords.swap(verticesCoordsPrepare);
-        _verticesAttr.swap(verticesAttrPrepare);
     }
     else
     {
         // concatenate the new elements with the previous ones
         _verticesCoords.insert(_verticesCoords.end(), verticesCoordsPrepare.begin(), verticesCoordsPrepare.end() );
-        _verticesAttr.insert(_verticesAttr.end(), verticesAttrPrepare.begin(), verticesAttrPrepare.end() );
+    }
+
+    // pack the visibilities into the vertices cameras pool
+    std::size_t nbCams = _verticesCamerasPool.size();
+    for(const VertexInfoPrepare& v : verticesAttrPrepare)
+        nbCams += v.cams.size();
+    _verticesCamerasPool.reserve(nbCams);
+    _verticesAttr.reserve(_verticesAttr.size() + verticesAttrPrepare.size());
+
+    for(VertexInfoPrepare& v : verticesAttrPrepare)
+    {
+        GC_vertexInfo newv;
+        newv.pixSize = v.pixSize;
+        newv.nrc = v.nrc;
+        newv.cams = _verticesCamerasPool.add(v.cams);
+        _verticesAttr.push_back(newv);
+
+        // release the vertex visibility as soon as it is packed
+        StaticVector<int>().swap(v.cams);
     }
 }
 
@@ -1379,7 +1533,7 @@ void DelaunayGraphCut::computeVerticesSegSize(std::vector<GC_Seg>& out_segments,
         const Point3d& p = _verticesCoords[vi];
         if((v.getNbCameras() > 0) && (useVertex.empty() || useVertex[vi]))
         {
-            int rc = v.getCamera(0);
+            int rc = getVertexCameras(vi)[0];
 
             // go through all the neighbouring points
             GEO::vector<VertexIndex> adjVertices;
@@ -1462,7 +1616,7 @@ void DelaunayGraphCut::removeSmallSegs(const std::vector<GC_Seg>& segments, int
         int iR = toRemove[i];
         GC_vertexInfo& v = _verticesAttr[iR];
 
-        v.cams.clear();
+        v.cams = GC_camerasRange();
         // T.remove(fit); // TODO GEOGRAM
     }
 
@@ -1835,6 +1989,8 @@ void DelaunayGraphCut::fillGraph(double nPixelSizeBehind, bool labatutWeights, b
                                  float fullWeight) // nPixelSizeBehind=2*spaceSteps allPoints=1 behind=0
                                                       // labatutWeights=0 fillOut=1 distFcnHeight=0
 {
+    ALICEVISION_PROFILE_ZONE("fillGraph");
+
     ALICEVISION_LOG_INFO("Computing s-t graph weights.");
     long t1 = clock();
 
@@ -1869,73 +2025,116 @@ void DelaunayGraphCut::fillGraph(double nPixelSizeBehind, bool labatutWeights, b
     GeometriesCount totalGeometriesIntersectedFrontCount;
     GeometriesCount totalGeometriesIntersectedBehindCount;
 
+    // partitioned variant: the votes are accumulated in thread-local buffers split by range of cells
+    // and merged by range after each batch of vertices, instead of atomics on the shared cells attributes
+    const bool partitioned = _mp.userParams.get<bool>("delaunaycut.fillGraphPartitioned", true);
+    const int nbThreads = omp_get_max_threads();
+    const int nbPartitions = partitioned ? 4 * nbThreads : 0;
+    // the batch size bounds the memory used by the votes buffers
+    const std::size_t batchSize = partitioned ? std::max(1, _mp.userParams.get<int>("delaunaycut.fillGraphBatchSize", 100000))
+                                              : std::max(std::size_t(1), verticesRandIds.size());
+
+    std::vector<CellVotesBuffer> votesBuffers(partitioned ? nbThreads : 0);
+    for(CellVotesBuffer& votesBuffer : votesBuffers)
+    {
+        votesBuffer.cellsPerPartition = std::max(std::size_t(1), (_cellsAttr.size() + nbPartitions - 1) / nbPartitions);
+        votesBuffer.partitions.resize(nbPartitions);
+    }
+
+    _fillGraphStats = FillGraphStats();
+    _fillGraphStats.partitioned = partitioned;
+    _fillGraphStats.nbPartitions = nbPartitions;
+
     auto progressDisplay =
             system::createConsoleProgressDisplay(std::min(size_t(100), verticesRandIds.size()),
                                                  std::cout, "fillGraphPartPtRc\n");
 
     size_t progressStep = verticesRandIds.size() / 100;
     progressStep = std::max(size_t(1), progressStep);
-#pragma omp parallel for reduction(+:totalStepsFront,totalRayFront,totalStepsBehind,totalRayBehind,totalCamHaveVisibilityOnVertex,totalOfVertex,totalIsRealNrc)
-    for(int i = 0; i < verticesRandIds.size(); i++)
-    {
-        if(i % progressStep == 0)
-        {
-            ++progressDisplay;
-        }
 
-        const int vertexIndex = verticesRandIds[i];
-        const GC_vertexInfo& v = _verticesAttr[vertexIndex];
+    for(std::size_t batchBegin = 0; batchBegin < verticesRandIds.size(); batchBegin += batchSize)
+    {
+        const int batchEnd = int(std::min(batchBegin + batchSize, verticesRandIds.size()));
 
-        GeometriesCount subTotalGeometriesIntersectedFrontCount;
-        GeometriesCount subTotalGeometriesIntersectedBehindCount;
+        system::Timer rayCastingTimer;
 
-        if(v.isReal())
+#pragma omp parallel for reduction(+:totalStepsFront,totalRayFront,totalStepsBehind,totalRayBehind,totalCamHaveVisibilityOnVertex,totalOfVertex,totalIsRealNrc)
+        for(int i = int(batchBegin); i < batchEnd; i++)
         {
-            ++totalIsRealNrc;
-            // "weight" is called alpha(p) in the paper
-            const float weight = weightFcn((float)v.nrc, labatutWeights, v.getNbCameras()); // number of cameras
+            if(i % progressStep == 0)
+            {
+                ++progressDisplay;
+            }
+
+            const int vertexIndex = verticesRandIds[i];
+            const GC_vertexInfo& v = _verticesAttr[vertexIndex];
+            CellVotesBuffer* votes = partitioned ? &votesBuffers[omp_get_thread_num()] : nullptr;
 
-            for(int c = 0; c < v.cams.size(); c++)
+            GeometriesCount subTotalGeometriesIntersectedFrontCount;
+            GeometriesCount subTotalGeometriesIntersectedBehindCount;
+
+            if(v.isReal())
             {
-                assert(v.cams[c] >= 0);
-                assert(v.cams[c] < _mp.ncams);
-
-                int stepsFront = 0;
-                int stepsBehind = 0;
-                GeometriesCount geometriesIntersectedFrontCount;
-                GeometriesCount geometriesIntersectedBehindCount;
-                fillGraphPartPtRc(stepsFront, stepsBehind, geometriesIntersectedFrontCount,
-                                  geometriesIntersectedBehindCount, vertexIndex, v.cams[c], weight, fullWeight,
-                                  nPixelSizeBehind,
-                                  fillOut, distFcnHeight);
-
-                totalStepsFront += stepsFront;
-                totalRayFront += 1;
-                totalStepsBehind += stepsBehind;
-                totalRayBehind += 1;
-
-                subTotalGeometriesIntersectedFrontCount += geometriesIntersectedFrontCount;
-                subTotalGeometriesIntersectedBehindCount += geometriesIntersectedBehindCount;
-            } // for c
-
-            totalCamHaveVisibilityOnVertex += v.cams.size();
-            totalOfVertex += 1;
-
-            boost::atomic_ref<std::size_t>{totalGeometriesIntersectedFrontCount.facets} +=
-                    subTotalGeometriesIntersectedFrontCount.facets;
-            boost::atomic_ref<std::size_t>{totalGeometriesIntersectedFrontCount.vertices} +=
-                    subTotalGeometriesIntersectedFrontCount.vertices;
-            boost::atomic_ref<std::size_t>{totalGeometriesIntersectedFrontCount.edges} +=
-                    subTotalGeometriesIntersectedFrontCount.edges;
-            boost::atomic_ref<std::size_t>{totalGeometriesIntersectedBehindCount.facets} +=
-                    subTotalGeometriesIntersectedBehindCount.facets;
-            boost::atomic_ref<std::size_t>{totalGeometriesIntersectedBehindCount.vertices} +=
-                    subTotalGeometriesIntersectedBehindCount.vertices;
-            boost::atomic_ref<std::size_t>{totalGeometriesIntersectedBehindCount.edges} +=
-                    subTotalGeometriesIntersectedBehindCount.edges;
+                ++totalIsRealNrc;
+                // "weight" is called alpha(p) in the paper
+                const float weight = weightFcn((float)v.nrc, labatutWeights, v.getNbCameras()); // number of cameras
+
+                const GC_arrayView<int> vCams = _verticesCamerasPool.get(v.cams);
+                for(int c = 0; c < vCams.size(); c++)
+                {
+                    assert(vCams[c] >= 0);
+                    assert(vCams[c] < _mp.ncams);
+
+                    int stepsFront = 0;
+                    int stepsBehind = 0;
+                    GeometriesCount geometriesIntersectedFrontCount;
+                    GeometriesCount geometriesIntersectedBehindCount;
+                    fillGraphPartPtRc(stepsFront, stepsBehind, geometriesIntersectedFrontCount,
+                                      geometriesIntersectedBehindCount, vertexIndex, vCams[c], weight, fullWeight,
+                                      nPixelSizeBehind,
+                                      fillOut, distFcnHeight, votes);
+
+                    totalStepsFront += stepsFront;
+                    totalRayFront += 1;
+                    totalStepsBehind += stepsBehind;
+                    totalRayBehind += 1;
+
+                    subTotalGeometriesIntersectedFrontCount += geometriesIntersectedFrontCount;
+                    subTotalGeometriesIntersectedBehindCount += geometriesIntersectedBehindCount;
+                } // for c
+
+                totalCamHaveVisibilityOnVertex += v.getNbCameras();
+                totalOfVertex += 1;
+
+                boost::atomic_ref<std::size_t>{totalGeometriesIntersectedFrontCount.facets} +=
+                        subTotalGeometriesIntersectedFrontCount.facets;
+                boost::atomic_ref<std::size_t>{totalGeometriesIntersectedFrontCount.vertices} +=
+                        subTotalGeometriesIntersectedFrontCount.vertices;
+                boost::atomic_ref<std::size_t>{totalGeometriesIntersectedFrontCount.edges} +=
+                        subTotalGeometriesIntersectedFrontCount.edges;
+                boost::atomic_ref<std::size_t>{totalGeometriesIntersectedBehindCount.facets} +=
+                        subTotalGeometriesIntersectedBehindCount.facets;
+                boost::atomic_ref<std::size_t>{totalGeometriesIntersectedBehindCount.vertices} +=
+                        subTotalGeometriesIntersectedBehindCount.vertices;
+                boost::atomic_ref<std::size_t>{totalGeometriesIntersectedBehindCount.edges} +=
+                        subTotalGeometriesIntersectedBehindCount.edges;
+            }
         }
+
+        _fillGraphStats.rayCastingTime += rayCastingTimer.elapsed();
+
+        if(partitioned)
+        {
+            system::Timer mergeTimer;
+            _fillGraphStats.nbVotes += mergeCellVotes(votesBuffers);
+            _fillGraphStats.mergeTime += mergeTimer.elapsed();
+        }
+
+        ++_fillGraphStats.nbBatches;
     }
 
+    _fillGraphStats.nbRays = std::size_t(totalRayFront);
+
     ALICEVISION_LOG_DEBUG("_verticesAttr.size(): " << _verticesAttr.size() << "(" << verticesRandIds.size() << ")");
     ALICEVISION_LOG_DEBUG("totalIsRealNrc: " << totalIsRealNrc);
     ALICEVISION_LOG_DEBUG("totalStepsFront//totalRayFront = " << totalStepsFront << " // " << totalRayFront);
@@ -1952,10 +2151,68 @@ void DelaunayGraphCut::fillGraph(double nPixelSizeBehind, bool labatutWeights, b
     mvsUtils::printfElapsedTime(t1, "s-t graph weights computed : ");
 }
 
+inline void DelaunayGraphCut::voteCell(CellVotesBuffer* votes, CellIndex cellIndex, CellVote::EField field, float value, int localVertexIndex)
+{
+    if(votes != nullptr)
+    {
+        votes->add(cellIndex, field, value, localVertexIndex);
+        return;
+    }
+
+    GC_cellInfo& c = _cellsAttr[cellIndex];
+    switch(field)
+    {
+        case CellVote::EField::cellSWeight:    boost::atomic_ref<float>{c.cellSWeight} = value; break;
+        case CellVote::EField::cellTWeight:    boost::atomic_ref<float>{c.cellTWeight} += value; break;
+        case CellVote::EField::fullnessScore:  boost::atomic_ref<float>{c.fullnessScore} += value; break;
+        case CellVote::EField::emptinessScore: boost::atomic_ref<float>{c.emptinessScore} += value; break;
+        case CellVote::EField::on:             boost::atomic_ref<float>{c.on} += value; break;
+        case CellVote::EField::gEdgeVisWeight: boost::atomic_ref<float>{c.gEdgeVisWeight[localVertexIndex]} += value; break;
+    }
+}
+
+std::size_t DelaunayGraphCut::mergeCellVotes(std::vector<CellVotesBuffer>& votesBuffers)
+{
+    if(votesBuffers.empty())
+        return 0;
+
+    const int nbPartitions = int(votesBuffers.front().partitions.size());
+    std::size_t nbVotes = 0;
+
+    // each range of cells is only updated by one thread
+#pragma omp parallel for schedule(dynamic) reduction(+:nbVotes)
+    for(int p = 0; p < nbPartitions; ++p)
+    {
+        for(CellVotesBuffer& votesBuffer : votesBuffers)
+        {
+            std::vector<CellVote>& votes = votesBuffer.partitions[p];
+
+            for(const CellVote& vote : votes)
+            {
+                GC_cellInfo& c = _cellsAttr[vote.cellIndex];
+                switch(vote.field)
+                {
+                    case CellVote::EField::cellSWeight:    c.cellSWeight = vote.value; break;
+                    case CellVote::EField::cellTWeight:    c.cellTWeight += vote.value; break;
+                    case CellVote::EField::fullnessScore:  c.fullnessScore += vote.value; break;
+                    case CellVote::EField::emptinessScore: c.emptinessScore += vote.value; break;
+                    case CellVote::EField::on:             c.on += vote.value; break;
+                    case CellVote::EField::gEdgeVisWeight: c.gEdgeVisWeight[vote.localVertexIndex] += vote.value; break;
+                }
+            }
+
+            nbVotes += votes.size();
+            // keep the capacity for the next batch
+            votes.clear();
+        }
+    }
+    return nbVotes;
+}
+
 void DelaunayGraphCut::fillGraphPartPtRc(
     int& outTotalStepsFront, int& outTotalStepsBehind, GeometriesCount& outFrontCount, GeometriesCount& outBehindCount,
     int vertexIndex, int cam, float weight, float fullWeight, double nPixelSizeBehind,
-                                       bool fillOut, float distFcnHeight)  // nPixelSizeBehind=2*spaceSteps allPoints=1 behind=0 fillOut=1 distFcnHeight=0
+                                       bool fillOut, float distFcnHeight, CellVotesBuffer* votes)  // nPixelSizeBehind=2*spaceSteps allPoints=1 behind=0 fillOut=1 distFcnHeight=0
 {
     const int maxint = 1000000; // std::numeric_limits<int>::std::max()
     const double marginEpsilonFactor = 1.0e-4;
@@ -2032,11 +2289,11 @@ void DelaunayGraphCut::fillGraphPartPtRc(
             if (geometry.type == EGeometryType::Facet)
             {
                 ++outFrontCount.facets;
-                boost::atomic_ref<float>{_cellsAttr[geometry.facet.cellIndex].emptinessScore} += weight;
+                voteCell(votes, geometry.facet.cellIndex, CellVote::EField::emptinessScore, weight);
 
                 {
                     const float dist = distFcn(maxDist, (originPt - lastIntersectPt).size(), distFcnHeight);
-                    boost::atomic_ref<float>{_cellsAttr[geometry.facet.cellIndex].gEdgeVisWeight[geometry.facet.localVertexIndex]} += weight * dist;
+                    voteCell(votes, geometry.facet.cellIndex, CellVote::EField::gEdgeVisWeight, weight * dist, geometry.facet.localVertexIndex);
                 }
 
                 // Take the mirror facet to iterate over the next cell
@@ -2063,7 +2320,7 @@ void DelaunayGraphCut::fillGraphPartPtRc(
                 // These geometries do not have a cellIndex, so we use the previousGeometry to retrieve the cell between the previous geometry and the current one.
                 if (previousGeometry.type == EGeometryType::Facet)
                 {
-                    boost::atomic_ref<float>{_cellsAttr[previousGeometry.facet.cellIndex].emptinessScore} += weight;
+                    voteCell(votes, previousGeometry.facet.cellIndex, CellVote::EField::emptinessScore, weight);
                 }
 
                 if (geometry.type == EGeometryType::Vertex)
@@ -2091,7 +2348,7 @@ void DelaunayGraphCut::fillGraphPartPtRc(
             if (lastIntersectedFacet.cellIndex != GEO::NO_CELL &&
                 (_mp.CArr[cam] - intersectPt).size() < 0.2 * pointCamDistance)
             {
-                boost::atomic_ref<float>{_cellsAttr[lastIntersectedFacet.cellIndex].cellSWeight} = (float)maxint;
+                voteCell(votes, lastIntersectedFacet.cellIndex, CellVote::EField::cellSWeight, (float)maxint);
             }
         }
 
@@ -2103,7 +2360,7 @@ void DelaunayGraphCut::fillGraphPartPtRc(
                 // lastGeoIsVertex is supposed to be positive in almost all cases.
                 // If we do not reach the camera, we still vote on the last tetrehedra.
                 // Possible reaisons: the camera is not part of the vertices or we encounter a numerical error in intersectNextGeom
-                boost::atomic_ref<float>{_cellsAttr[lastIntersectedFacet.cellIndex].cellSWeight} = (float)maxint;
+                voteCell(votes, lastIntersectedFacet.cellIndex, CellVote::EField::cellSWeight, (float)maxint);
             }
             // else
             // {
@@ -2176,11 +2433,11 @@ void DelaunayGraphCut::fillGraphPartPtRc(
                 // Vote for the first cell found (only once)
                 if (firstIteration)
                 {
-                    boost::atomic_ref<float>{_cellsAttr[geometry.facet.cellIndex].on} += fWeight;
+                    voteCell(votes, geometry.facet.cellIndex, CellVote::EField::on, fWeight);
                     firstIteration = false;
                 }
 
-                boost::atomic_ref<float>{_cellsAttr[geometry.facet.cellIndex].fullnessScore} += fWeight;
+                voteCell(votes, geometry.facet.cellIndex, CellVote::EField::fullnessScore, fWeight);
 
                 // Take the mirror facet to iterate over the next cell
                 const Facet mFacet = mirrorFacet(geometry.facet);
@@ -2194,8 +2451,7 @@ void DelaunayGraphCut::fillGraphPartPtRc(
 
                 {
                     const float dist = distFcn(maxDist, (originPt - lastIntersectPt).size(), distFcnHeight);
-                    boost::atomic_ref<float>{_cellsAttr[geometry.facet.cellIndex].gEdgeVisWeight[geometry.facet.localVertexIndex]} +=
-                        fWeight * dist;
+                    voteCell(votes, geometry.facet.cellIndex, CellVote::EField::gEdgeVisWeight, fWeight * dist, geometry.facet.localVertexIndex);
                 }
                 if(previousGeometry.type == EGeometryType::Facet && outBehindCount.facets > 1000)
                 {
@@ -2215,7 +2471,7 @@ void DelaunayGraphCut::fillGraphPartPtRc(
                         //throw std::runtime_error("[error] The firstIteration vote could only happen during for the first cell when we come from the first vertex.");
                     }
                     // the information of first intersected cell can only be found by taking intersection of neighbouring cells for both geometries
-                    const std::vector<CellIndex> previousNeighbouring = getNeighboringCellsByVertexIndex(previousGeometry.vertexIndex);
+                    const GC_arrayView<CellIndex> previousNeighbouring = getNeighboringCellsByVertexIndex(previousGeometry.vertexIndex);
                     const std::vector<CellIndex> currentNeigbouring = getNeighboringCellsByGeometry(geometry);
 
                     std::vector<CellIndex> neighboringCells;
@@ -2223,7 +2479,7 @@ void DelaunayGraphCut::fillGraphPartPtRc(
 
                     for (const CellIndex& ci : neighboringCells)
                     {
-                        boost::atomic_ref<float>{_cellsAttr[neighboringCells[0]].on} += fWeight;
+                        voteCell(votes, neighboringCells[0], CellVote::EField::on, fWeight);
                     }
                     firstIteration = false;
                 }
@@ -2232,7 +2488,7 @@ void DelaunayGraphCut::fillGraphPartPtRc(
                 // These geometries do not have a cellIndex, so we use the previousGeometry to retrieve the cell between the previous geometry and the current one.
                 if (previousGeometry.type == EGeometryType::Facet)
                 {
-                    boost::atomic_ref<float>{_cellsAttr[previousGeometry.facet.cellIndex].fullnessScore} += fWeight;
+                    voteCell(votes, previousGeometry.facet.cellIndex, CellVote::EField::fullnessScore, fWeight);
                 }
 
                 if (geometry.type == EGeometryType::Vertex)
@@ -2260,7 +2516,7 @@ void DelaunayGraphCut::fillGraphPartPtRc(
         // Vote for the last intersected facet (farthest from the camera)
         if (lastIntersectedFacet.cellIndex != GEO::NO_CELL)
         {
-            boost::atomic_ref<float>{_cellsAttr[lastIntersectedFacet.cellIndex].cellTWeight} += fWeight;
+            voteCell(votes, lastIntersectedFacet.cellIndex, CellVote::EField::cellTWeight, fWeight);
         }
     }
 }
@@ -2326,7 +2582,7 @@ void DelaunayGraphCut::forceTedgesByGradientIJCV(float nPixelSizeBehind)
         ++totalVertexIsVirtual;
         const Point3d& originPt = _verticesCoords[vertexIndex];
         // For each camera that has visibility over the vertex v (vertexIndex)
-        for(const int cam : v.cams)
+        for(const int cam : _verticesCamerasPool.get(v.cams))
         {
             GeometriesCount geometriesIntersectedFrontCount;
             GeometriesCount geometriesIntersectedBehindCount;
@@ -2543,7 +2799,7 @@ void DelaunayGraphCut::forceTedgesByGradientIJCV(float nPixelSizeBehind)
                                 // throw std::runtime_error("[error] The firstIteration vote could only happen during for the first cell when we come from the first vertex.");
                             }
                             // the information of first intersected cell can only be found by taking intersection of neighbouring cells for both geometries
-                            const std::vector<CellIndex> previousNeighbouring = getNeighboringCellsByVertexIndex(previousGeometry.vertexIndex);
+                            const GC_arrayView<CellIndex> previousNeighbouring = getNeighboringCellsByVertexIndex(previousGeometry.vertexIndex);
                             const std::vector<CellIndex> currentNeigbouring = getNeighboringCellsByGeometry(geometry);
 
                             std::vector<CellIndex> neighboringCells;
@@ -2607,7 +2863,7 @@ void DelaunayGraphCut::forceTedgesByGradientIJCV(float nPixelSizeBehind)
                 boost::atomic_ref<std::size_t>{totalGeometriesIntersectedBehindCount.edges} += totalGeometriesIntersectedBehindCount.edges;
             }
         }
-        totalCamHaveVisibilityOnVertex += v.cams.size();
+        totalCamHaveVisibilityOnVertex += v.getNbCameras();
         totalOfVertex += 1;
     }
 
@@ -2916,12 +3172,12 @@ void DelaunayGraphCut::cellsStatusFilteringBySolidAngleRatio(int nbSolidAngleFil
         const int nbSurfaceFacets = computeIsOnSurface(vertexIsOnSurface);
 
 #pragma omp parallel for reduction(+ : toInvertCount)
-        for(int vi = 0; vi < _neighboringCellsPerVertex.size(); ++vi)
+        for(int vi = 0; vi + 1 < int(_neighboringCellsOffsets.size()); ++vi)
         {
             if(!vertexIsOnSurface[vi])
                 continue;
             // ALICEVISION_LOG_INFO("vertex is on surface: " << vi);
-            const std::vector<CellIndex>& neighboringCells = _neighboringCellsPerVertex[vi];
+            const GC_arrayView<CellIndex> neighboringCells = getNeighboringCellsByVertexIndex(vi);
             std::vector<Facet> neighboringFacets;
             neighboringFacets.reserve(neighboringCells.size());
             bool borderCase = false;
@@ -3035,6 +3291,7 @@ void DelaunayGraphCut::createDensePointCloud(const Point3d hexah[8], const Stati
 {
   assert(sfmData != nullptr || depthMapsFuseParams != nullptr);
 
+  ALICEVISION_MEMORY_STAGE("densePointCloud");
   ALICEVISION_LOG_INFO("Creating dense point cloud.");
 
   const float minDist = hexah ? (hexah[0] - hexah[1]).size() / 1000.0f : 0.00001f;
@@ -3070,8 +3327,12 @@ void DelaunayGraphCut::createDensePointCloud(const Point3d hexah[8], const Stati
       addMaskHelperPoints(hexahExt, cams, *depthMapsFuseParams);
   }
 
+  // release the vertices hash, only used to merge the points added by the densification steps
+  _verticesHash.reset(minDist);
+
   _verticesCoords.shrink_to_fit();
   _verticesAttr.shrink_to_fit();
+  _verticesCamerasPool.shrink_to_fit();
 
   ALICEVISION_LOG_WARNING("Final dense point cloud: " << _verticesCoords.size() << " points.");
 }
@@ -3080,6 +3341,8 @@ void DelaunayGraphCut::createGraphCut(const Point3d hexah[8], const StaticVector
                                       const std::string& folderName, const std::string& tmpCamsPtsFolderName,
                                       bool removeSmallSegments, bool exportDebugTetrahedralization)
 {
+  ALICEVISION_MEMORY_STAGE("graphCut");
+
   // Create tetrahedralization
   computeDelaunay();
   displayStatistics();
@@ -3093,6 +3356,7 @@ void DelaunayGraphCut::createGraphCut(const Point3d hexah[8], const StaticVector
   }
 
   voteFullEmptyScore(cams, folderName);
+  displayStatistics();
 
   if(exportDebugTetrahedralization)
     exportFullScoreMeshs(folderName, "");
@@ -3115,16 +3379,10 @@ void DelaunayGraphCut::addToInfiniteSw(float sW)
     ALICEVISION_LOG_WARNING("DelaunayGraphCut::addToInfiniteSw nbInfinitCells: " << nbInfinitCells);
 }
 
-void DelaunayGraphCut::maxflow()
+template <typename MaxFlowGraph>
+void DelaunayGraphCut::fillMaxFlowGraph(MaxFlowGraph& maxFlowGraph) const
 {
-    long t_maxflow = clock();
-
-    ALICEVISION_LOG_INFO("Maxflow: start allocation.");
     const std::size_t nbCells = _cellsAttr.size();
-    ALICEVISION_LOG_INFO("Number of cells: " << nbCells);
-
-    // MaxFlow_CSR maxFlowGraph(nbCells);
-    MaxFlow_AdjList maxFlowGraph(nbCells);
 
     ALICEVISION_LOG_INFO("Maxflow: add nodes.");
     // fill s-t edges
@@ -3185,6 +3443,28 @@ void DelaunayGraphCut::maxflow()
             maxFlowGraph.addEdge(fu.cellIndex, fv.cellIndex, wFuFv, wFvFu);
         }
     }
+}
+
+template <typename MaxFlowGraph>
+void DelaunayGraphCut::maxflow(bool verify)
+{
+    long t_maxflow = clock();
+
+    ALICEVISION_LOG_INFO("Maxflow: start allocation.");
+    const std::size_t nbCells = _cellsAttr.size();
+    ALICEVISION_LOG_INFO("Number of cells: " << nbCells);
+
+    MaxFlowGraph maxFlowGraph(nbCells);
+    fillMaxFlowGraph(maxFlowGraph);
+
+    // reference solver to verify the labeling
+    std::unique_ptr<MaxFlow_AdjList> referenceMaxFlowGraph;
+    if(verify)
+    {
+        ALICEVISION_LOG_INFO("Maxflow: fill the reference graph.");
+        referenceMaxFlowGraph.reset(new MaxFlow_AdjList(nbCells));
+        fillMaxFlowGraph(*referenceMaxFlowGraph);
+    }
 
     ALICEVISION_LOG_INFO("Maxflow: clear cells info.");
     std::vector<GC_cellInfo>().swap(_cellsAttr); // force clear to free some RAM before maxflow
@@ -3207,11 +3487,47 @@ void DelaunayGraphCut::maxflow()
     }
     ALICEVISION_LOG_WARNING("Maxflow full/nbCells: " << nbFullCells << " / " << nbCells);
 
+    if(verify)
+    {
+        ALICEVISION_LOG_INFO("Maxflow: compute the reference solution.");
+        const float referenceTotalFlow = referenceMaxFlowGraph->compute();
+
+        std::size_t nbDifferentCells = 0;
+        for(CellIndex ci = 0; ci < nbCells; ++ci)
+            nbDifferentCells += (_cellIsFull[ci] != referenceMaxFlowGraph->isTarget(ci));
+
+        ALICEVISION_LOG_INFO("Maxflow verification:" << std::endl
+                             << "\t- reference totalFlow: " << referenceTotalFlow << std::endl
+                             << "\t- totalFlow difference: " << (totalFlow - referenceTotalFlow) << std::endl
+                             << "\t- cells with a different full/empty status: " << nbDifferentCells << " / " << nbCells);
+        if(nbDifferentCells > 0)
+            ALICEVISION_LOG_WARNING("Maxflow verification: the labeling differs from the reference solver on " << nbDifferentCells << " cells.");
+    }
+
     mvsUtils::printfElapsedTime(t_maxflow, "Full maxflow step");
 
     ALICEVISION_LOG_INFO("Maxflow: done.");
 }
 
+void DelaunayGraphCut::maxflow()
+{
+    // "adjList" and "csr" are single-threaded Boykov-Kolmogorov solvers, "pushRelabel" is parallel
+    const std::string solver = _mp.userParams.get<std::string>("delaunaycut.maxflowSolver", "adjList");
+    // also compute the "adjList" solution and compare the labelings
+    const bool verify = _mp.userParams.get<bool>("delaunaycut.maxflowVerify", false) && (solver != "adjList");
+
+    ALICEVISION_LOG_INFO("Maxflow solver: " << solver);
+
+    if(solver == "adjList")
+        maxflow<MaxFlow_AdjList>(verify);
+    else if(solver == "csr")
+        maxflow<MaxFlow_CSR>(verify);
+    else if(solver == "pushRelabel")
+        maxflow<MaxFlow_PushRelabel>(verify);
+    else
+        ALICEVISION_THROW_ERROR("Unknown maxflow solver: " << solver);
+}
+
 void DelaunayGraphCut::voteFullEmptyScore(const StaticVector<int>& cams, const std::string& folderName)
 {
     ALICEVISION_LOG_INFO("DelaunayGraphCut::voteFullEmptyScore");
@@ -3514,7 +3830,7 @@ void DelaunayGraphCut::displayCellsStats() const
         {
             const GC_vertexInfo& vertexAttr = _verticesAttr[vi];
             acc_nrc(vertexAttr.nrc);
-            acc_camSize(vertexAttr.cams.size());
+            acc_camSize(vertexAttr.getNbCameras());
         }
         displayAcc("acc_nrc", acc_nrc);
         displayAcc("acc_camSize", acc_camSize);
@@ -3611,7 +3927,7 @@ mesh::Mesh* DelaunayGraphCut::createTetrahedralMesh(bool filter, const float& do
             {
                 const VertexIndex vi = _tetrahedralization->cell_vertex(ci, k);
                 const GC_vertexInfo& vertexAttr = _verticesAttr[vi];
-                if(filter && vertexAttr.cams.size() <= 3)
+                if(filter && vertexAttr.getNbCameras() <= 3)
                 {
                     ++weakVertex;
                 }
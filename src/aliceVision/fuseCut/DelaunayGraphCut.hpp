@@ -14,6 +14,7 @@
 #include <aliceVision/mvsUtils/common.hpp>
 #include <aliceVision/mesh/Mesh.hpp>
 #include <aliceVision/fuseCut/delaunayGraphCutTypes.hpp>
+#include <aliceVision/fuseCut/PointsVoxelHash.hpp>
 #include <aliceVision/fuseCut/VoxelsGrid.hpp>
 
 #include <geogram/delaunay/delaunay.h>
@@ -21,6 +22,7 @@
 #include <geogram/mesh/mesh.h>
 #include <geogram/basic/geometry_nd.h>
 
+#include <cstdint>
 #include <map>
 #include <set>
 
@@ -204,6 +206,56 @@ public:
         }
     };
 
+    /**
+     * @brief Vote of a ray on one cell attribute, recorded during fillGraph and applied afterwards.
+     */
+    struct CellVote
+    {
+        enum class EField : std::uint8_t
+        {
+            cellSWeight, //< the vote sets the cell weight
+            cellTWeight,
+            fullnessScore,
+            emptinessScore,
+            on,
+            gEdgeVisWeight
+        };
+
+        CellIndex cellIndex;
+        float value;
+        EField field;
+        std::uint8_t localVertexIndex; //< facet index for gEdgeVisWeight
+    };
+
+    /**
+     * @brief Thread-local buffer of the fillGraph cell votes, split by range of cells.
+     *        Each range is merged into the cells attributes by only one thread, without atomics.
+     */
+    struct CellVotesBuffer
+    {
+        std::size_t cellsPerPartition = 1;
+        std::vector<std::vector<CellVote>> partitions;
+
+        void add(CellIndex cellIndex, CellVote::EField field, float value, int localVertexIndex = 0)
+        {
+            partitions[cellIndex / cellsPerPartition].push_back({cellIndex, value, field, static_cast<std::uint8_t>(localVertexIndex)});
+        }
+    };
+
+    /**
+     * @brief Per-phase statistics of the last fillGraph, reported by displayStatistics.
+     */
+    struct FillGraphStats
+    {
+        bool partitioned = false;
+        int nbPartitions = 0;
+        int nbBatches = 0;
+        std::size_t nbRays = 0;
+        std::size_t nbVotes = 0;
+        double rayCastingTime = 0.0; //< seconds
+        double mergeTime = 0.0;      //< seconds
+    };
+
     mvsUtils::MultiViewParams& _mp;
 
     GEO::Delaunay_var _tetrahedralization;
@@ -211,16 +263,25 @@ public:
     std::vector<Point3d> _verticesCoords;
     /// Information attached to each vertex
     std::vector<GC_vertexInfo> _verticesAttr;
+    /// Camera indices of all the vertices, referenced by GC_vertexInfo::cams
+    GC_camerasPool _verticesCamerasPool;
+    /// Voxel hash of the vertices, to merge the points added closer than a minimal distance during the densification
+    PointsVoxelHash _verticesHash;
     /// Information attached to each cell
     std::vector<GC_cellInfo> _cellsAttr;
     /// isFull info per cell: true is full / false is empty
     std::vector<bool> _cellIsFull;
 
     std::vector<int> _camsVertexes;
-    std::vector<std::vector<CellIndex>> _neighboringCellsPerVertex;
+    /// Neighboring cells of all the vertices (CSR layout):
+    /// the sorted cells of vertex vi are in [_neighboringCellsOffsets[vi], _neighboringCellsOffsets[vi+1])
+    std::vector<std::size_t> _neighboringCellsOffsets;
+    std::vector<CellIndex> _neighboringCells;
 
     bool saveTemporaryBinFiles;
 
+    FillGraphStats _fillGraphStats;
+
     static const GEO::index_t NO_TETRAHEDRON = GEO::NO_CELL;
 
     DelaunayGraphCut(mvsUtils::MultiViewParams& mp);
@@ -335,36 +396,11 @@ public:
         return out;
     }
 
-    void updateVertexToCellsCache()
-    {
-        _neighboringCellsPerVertex.clear();
-
-        std::map<VertexIndex, std::set<CellIndex>> neighboringCellsPerVertexTmp;
-        int coutInvalidVertices = 0;
-        for (CellIndex ci = 0; ci < _tetrahedralization->nb_cells(); ++ci)
-        {
-            for(VertexIndex k = 0; k < 4; ++k)
-            {
-                const VertexIndex vi = _tetrahedralization->cell_vertex(ci, k);
-                if(vi == GEO::NO_VERTEX || vi >= _verticesCoords.size())
-                {
-                    ++coutInvalidVertices;
-                    continue;
-                }
-                neighboringCellsPerVertexTmp[vi].insert(ci);
-            }
-        }
-        ALICEVISION_LOG_INFO("coutInvalidVertices: " << coutInvalidVertices);
-        ALICEVISION_LOG_INFO("neighboringCellsPerVertexTmp: " << neighboringCellsPerVertexTmp.size());
-        _neighboringCellsPerVertex.resize(_verticesCoords.size());
-        ALICEVISION_LOG_INFO("verticesCoords: " << _verticesCoords.size());
-        for(const auto& it: neighboringCellsPerVertexTmp)
-        {
-            const std::set<CellIndex>& input = it.second;
-            std::vector<CellIndex>& output = _neighboringCellsPerVertex[it.first];
-            output.assign(input.begin(), input.end());
-        }
-    }
+    /**
+     * @brief Build the cells of each vertex (CSR arrays), in parallel.
+     *        The cells of each vertex are sorted by increasing index.
+     */
+    void updateVertexToCellsCache();
 
     /**
      * @brief vertexToCells
@@ -377,7 +413,7 @@ public:
      */
     inline CellIndex vertexToCells(VertexIndex vi, int lvi) const
     {
-        const std::vector<CellIndex>& localCells = _neighboringCellsPerVertex.at(vi);
+        const GC_arrayView<CellIndex> localCells = getNeighboringCellsByVertexIndex(vi);
         if(lvi >= localCells.size())
             return GEO::NO_CELL;
         return localCells[lvi];
@@ -404,11 +440,23 @@ public:
      * @brief Retrieves the global indexes of neighboring cells using the global index of a vertex.
      * 
      * @param vi the global vertexIndex
-     * @return a vector of neighboring cell indices
+     * @return a view on the sorted neighboring cell indices
      */
-    inline const std::vector<CellIndex>& getNeighboringCellsByVertexIndex(VertexIndex vi) const
+    inline GC_arrayView<CellIndex> getNeighboringCellsByVertexIndex(VertexIndex vi) const
     {
-        return _neighboringCellsPerVertex.at(vi);
+        const CellIndex* cells = _neighboringCells.data();
+        return GC_arrayView<CellIndex>(cells + _neighboringCellsOffsets.at(vi), cells + _neighboringCellsOffsets.at(vi + 1));
+    }
+
+    /**
+     * @brief Retrieves the cameras having a visibility on one vertex.
+     *
+     * @param vi the vertex index
+     * @return a view on the vertex camera indices
+     */
+    inline GC_arrayView<int> getVertexCameras(VertexIndex vi) const
+    {
+        return _verticesCamerasPool.get(_verticesAttr[vi].cams);
     }
 
      /**
@@ -434,6 +482,12 @@ public:
     StaticVector<int> getSortedUsedCams() const;
 
     void addPointsFromSfM(const Point3d hexah[8], const StaticVector<int>& cams, const sfmData::SfMData& sfmData);
+    /**
+     * @brief Insert the vertices added since the last update in the vertices hash.
+     * @param[in] minDist the points closer than minDist are merged, the hash is rebuilt if it changes
+     */
+    void updateVerticesHash(float minDist);
+
     void addPointsFromCameraCenters(const StaticVector<int>& cams, float minDist);
     void addPointsToPreventSingularities(const Point3d Voxel[8], float minDist);
 
@@ -502,8 +556,23 @@ public:
 
     void fillGraph(double nPixelSizeBehind, bool labatutWeights, bool fillOut, float distFcnHeight,
                            float fullWeight);
+    /**
+     * @brief Cast the rays of one (vertex, camera) pair and vote on the intersected cells.
+     * @param[in,out] votes the buffer of the votes, if null the votes are directly added to the cells attributes (atomics)
+     */
     void fillGraphPartPtRc(int& out_nstepsFront, int& out_nstepsBehind, GeometriesCount& outFrontCount, GeometriesCount& outBehindCount, int vertexIndex, int cam, float weight,
-                           float fullWeight, double nPixelSizeBehind, bool fillOut, float distFcnHeight);
+                           float fullWeight, double nPixelSizeBehind, bool fillOut, float distFcnHeight, CellVotesBuffer* votes = nullptr);
+
+    /**
+     * @brief Add a vote to a cell attribute, either in the votes buffer or directly in the cell attributes (atomics).
+     */
+    inline void voteCell(CellVotesBuffer* votes, CellIndex cellIndex, CellVote::EField field, float value, int localVertexIndex = 0);
+
+    /**
+     * @brief Merge the thread-local votes buffers into the cells attributes, one range of cells per thread.
+     * @return the number of merged votes
+     */
+    std::size_t mergeCellVotes(std::vector<CellVotesBuffer>& votesBuffers);
 
     /**
      * @brief Estimate the cells property "on" based on the analysis of the visibility of neigbouring cells.
@@ -516,8 +585,23 @@ public:
 
     void addToInfiniteSw(float sW);
 
+    /**
+     * @brief Compute the full/empty status of the cells with a graph cut.
+     *        The solver is selected by the "delaunaycut.maxflowSolver" parameter (adjList, csr or pushRelabel).
+     */
     void maxflow();
 
+    /**
+     * @brief Compute the graph cut with a given maxflow solver.
+     * @param[in] verify compare the labeling with the MaxFlow_AdjList solver
+     */
+    template <typename MaxFlowGraph>
+    void maxflow(bool verify);
+
+    /// Add the s-t edges and the u-v edges of the cells to the maxflow graph
+    template <typename MaxFlowGraph>
+    void fillMaxFlowGraph(MaxFlowGraph& maxFlowGraph) const;
+
     void voteFullEmptyScore(const StaticVector<int>& cams, const std::string& folderName);
 
     void createDensePointCloud(const Point3d hexah[8], const StaticVector<int>& cams, const sfmData::SfMData* sfmData, const FuseParams* depthMapsFuseParams);
@@ -681,6 +681,55 @@ Voxel Fuser::estimateDimensions(Point3d* vox, Point3d* newSpace, int scale, int
     return maxDim;
 }
 
+void getDepthMapPoints(int rc, const mvsUtils::MultiViewParams& mp, int scale,
+                       StaticVector<Point3d>& out_pts, StaticVector<float>& out_sims, Point2d& out_minMaxDepth,
+                       const Point3d* voxel)
+{
+    const int scaleuse = std::max(1, scale);
+
+    // the points outside of the voxel are not used, only its image region is read
+    const ROI roi = (voxel == nullptr) ? ROI(0, mp.getWidth(rc), 0, mp.getHeight(rc))
+                                       : mp.getHexahedronImageROI(rc, voxel, scaleuse);
+    const ROI mapRoi = downscaleROI(roi, scaleuse);
+
+    image::Image<float> depthMap;
+    image::Image<float> simMap;
+
+    mvsUtils::readDepthSimMapROI(rc, mp, roi, depthMap, simMap, scale);
+
+    const int w = depthMap.Width();
+    const int h = depthMap.Height();
+
+    if(simMap.Width() != w || simMap.Height() != h)
+        throw std::runtime_error("Invalid image size");
+
+    out_pts.clear();
+    out_sims.clear();
+    out_pts.reserve(w * h);
+    out_sims.reserve(w * h);
+    out_minMaxDepth = Point2d(-1.0, -1.0);
+
+    for(int y = 0; y < h; ++y)
+    {
+        for(int x = 0; x < w; ++x)
+        {
+            const double depth = depthMap(y, x);
+            if(depth <= 0.0)
+                continue;
+
+            const double px = double(x + mapRoi.x.begin) * double(scaleuse);
+            const double py = double(y + mapRoi.y.begin) * double(scaleuse);
+            const Point3d p = mp.CArr[rc] + (mp.iCamArr[rc] * Point2d(px, py)).normalize() * depth;
+
+            out_pts.push_back(p);
+            out_sims.push_back(simMap(y, x));
+
+            out_minMaxDepth.x = (out_minMaxDepth.x < 0.0) ? depth : std::min(out_minMaxDepth.x, depth);
+            out_minMaxDepth.y = (out_minMaxDepth.y < 0.0) ? depth : std::max(out_minMaxDepth.y, depth);
+        }
+    }
+}
+
 std::string generateTempPtsSimsFiles(const std::string& tmpDir, mvsUtils::MultiViewParams& mp,
                                      bool addRandomNoise, float percNoisePts,
                                      int noisPixSizeDistHalfThr)
@@ -692,7 +741,7 @@ std::string generateTempPtsSimsFiles(const std::string& tmpDir, mvsUtils::MultiV
     {
         bfs::create_directory(depthMapsPtsSimsTmpDir);
 
-        int scale = 0;
+        int scale = mp.userParams.get<int>("LargeScale.depthMapsScale", 0);
         int scaleuse = std::max(1, scale);
 
         StaticVector<Point2d>* minMaxDepths = new StaticVector<Point2d>();
@@ -702,27 +751,27 @@ std::string generateTempPtsSimsFiles(const std::string& tmpDir, mvsUtils::MultiV
 #pragma omp parallel for
         for(int rc = 0; rc < mp.ncams; rc++)
         {
-            int w = mp.getWidth(rc) / scaleuse;
-            int h = mp.getHeight(rc) / scaleuse;
-
             StaticVector<Point3d>* pts = new StaticVector<Point3d>();
             StaticVector<float>* sims = new StaticVector<float>();
 
-            pts->reserve(w * h);
-            sims->reserve(w * h);
+            if(addRandomNoise)
+            {
+                int w = mp.getWidth(rc) / scaleuse;
+                int h = mp.getHeight(rc) / scaleuse;
+
+                pts->reserve(w * h);
+                sims->reserve(w * h);
 
-            image::Image<float> depthMap;
-            image::Image<float> simMap;
+                image::Image<float> depthMap;
+                image::Image<float> simMap;
 
-            mvsUtils::readDepthSimMap(rc, mp, depthMap, simMap, scale);
+                mvsUtils::readDepthSimMap(rc, mp, depthMap, simMap, scale);
 
-            if (depthMap.size() != (w * h) || simMap.size() != (w * h))
-            {
-                throw std::runtime_error("Invalid image size");
-            }
+                if (depthMap.size() != (w * h) || simMap.size() != (w * h))
+                {
+                    throw std::runtime_error("Invalid image size");
+                }
 
-            if(addRandomNoise)
-            {
                 StaticVector<int>* idsAlive = new StaticVector<int>();
                 idsAlive->reserve(w * h);
                 for(int i = 0; i < w * h; i++)
@@ -795,43 +844,8 @@ std::string generateTempPtsSimsFiles(const std::string& tmpDir, mvsUtils::MultiV
             }
             else
             {
-
                 long t1 = clock();
-                for(int x = 0; x < w; x++)
-                {
-                    for(int y = 0; y < h; y++)
-                    {
-                        int i = x * h + y;
-                        double depth = depthMap(i);
-                        double sim = simMap(i);
-                        if(depth > 0.0f)
-                        {
-                            Point3d p =
-                                mp.CArr[rc] +
-                                (mp.iCamArr[rc] * Point2d((double)x * (double)scaleuse, (double)y * (double)scaleuse))
-                                        .normalize() *
-                                    depth;
-                            pts->push_back(p);
-                            sims->push_back(sim);
-                            if((*minMaxDepths)[rc].x < 0.0f)
-                            {
-                                (*minMaxDepths)[rc].x = depth;
-                            }
-                            else
-                            {
-                                (*minMaxDepths)[rc].x = std::min((*minMaxDepths)[rc].x, depth);
-                            }
-                            if((*minMaxDepths)[rc].y < 0.0f)
-                            {
-                                (*minMaxDepths)[rc].y = depth;
-                            }
-                            else
-                            {
-                                (*minMaxDepths)[rc].y = std::max((*minMaxDepths)[rc].y, depth);
-                            }
-                        }
-                    }
-                }
+                getDepthMapPoints(rc, mp, scale, *pts, *sims, (*minMaxDepths)[rc]);
                 mvsUtils::printfElapsedTime(t1);
             }
 
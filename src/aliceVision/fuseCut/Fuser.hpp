@@ -52,6 +52,20 @@ private:
 
 unsigned long computeNumberOfAllPoints(const mvsUtils::MultiViewParams& mp, int scale);
 
+/**
+ * @brief Read the depth/sim map of a camera and back-project its valid depths.
+ * @param[in] rc the R camera index
+ * @param[in] mp the multi-view parameters
+ * @param[in] scale the depth/sim map downscale factor
+ * @param[out] out_pts the 3d points of the valid depths
+ * @param[out] out_sims the similarity of each 3d point
+ * @param[out] out_minMaxDepth the min/max valid depth, (-1, -1) if no valid depth
+ * @param[in] voxel if not null, only read the depth/sim map region covered by this hexahedron
+ */
+void getDepthMapPoints(int rc, const mvsUtils::MultiViewParams& mp, int scale,
+                       StaticVector<Point3d>& out_pts, StaticVector<float>& out_sims, Point2d& out_minMaxDepth,
+                       const Point3d* voxel = nullptr);
+
 std::string generateTempPtsSimsFiles(const std::string& tmpDir, mvsUtils::MultiViewParams& mp,
                                      bool addRandomNoise = false, float percNoisePts = 0.0,
                                      int noisPixSizeDistHalfThr = 0);
@@ -162,8 +162,14 @@ bool LargeScale::generateSpace(int maxPts, int ocTreeDim, bool generateTracks)
         int addRandomNoiseNoisPixSizeDistHalfThr =
             (float)mp->userParams.get<int>("LargeScale.addRandomNoiseNoisPixSizeDistHalfThr", 10);
 
-        std::string depthMapsPtsSimsTmpDir = generateTempPtsSimsFiles(
-            spaceFolderName, *mp, addRandomNoise, addRandomNoisePercNoisePts, addRandomNoiseNoisPixSizeDistHalfThr);
+        // without temporary files, the octree tracks stream the points from the depth/sim maps
+        const bool useTempPtsSimsFiles = mp->userParams.get<bool>("LargeScale.useTempPtsSimsFiles", true);
+
+        if(addRandomNoise && !useTempPtsSimsFiles)
+            ALICEVISION_LOG_WARNING("Random noise is only added with the temporary pts/sims files.");
+
+        const std::string depthMapsPtsSimsTmpDir = useTempPtsSimsFiles ? generateTempPtsSimsFiles(
+            spaceFolderName, *mp, addRandomNoise, addRandomNoisePercNoisePts, addRandomNoiseNoisPixSizeDistHalfThr) : "";
 
         ALICEVISION_LOG_INFO("Creating tracks: " << dimensions.x << ", " << dimensions.y << ", " << dimensions.z);
         StaticVector<Point3d>* ReconstructionPlan = new StaticVector<Point3d>();
@@ -194,7 +200,8 @@ bool LargeScale::generateSpace(int maxPts, int ocTreeDim, bool generateTracks)
 
         bfs::remove_all(tmpdir);
 
-        deleteTempPtsSimsFiles(*mp, depthMapsPtsSimsTmpDir);
+        if(useTempPtsSimsFiles)
+            deleteTempPtsSimsFiles(*mp, depthMapsPtsSimsTmpDir);
 
         saveArrayToFile<Point3d>(spaceFolderName + "spacePatitioning.bin", ReconstructionPlan);
         delete ReconstructionPlan;
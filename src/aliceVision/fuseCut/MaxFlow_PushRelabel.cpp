@@ -0,0 +1,306 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "MaxFlow_PushRelabel.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <boost/atomic/atomic_ref.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace aliceVision {
+namespace fuseCut {
+
+MaxFlow_PushRelabel::MaxFlow_PushRelabel(std::size_t numNodes)
+    : _numNodes(numNodes + 2)
+    , _S(NodeType(numNodes))
+    , _T(NodeType(numNodes + 1))
+{
+    ALICEVISION_LOG_INFO("MaxFlow constructor.");
+    // 4 facets and 1 terminal edge per node, each edge is stored with its reverse
+    const std::size_t nbEdgesEstimation = numNodes * 4 + numNodes;
+    _edges.reserve(nbEdgesEstimation);
+    _capacities.reserve(nbEdgesEstimation * 2);
+}
+
+void MaxFlow_PushRelabel::buildGraph()
+{
+    const std::size_t nbEdges = _edges.size() * 2;
+    if(nbEdges >= std::numeric_limits<EdgeIndex>::max())
+        ALICEVISION_THROW_ERROR("MaxFlow_PushRelabel: too many edges (" << nbEdges << ").");
+
+    // count the edges of each node
+    _offsets.assign(_numNodes + 1, 0);
+    for(const auto& edge : _edges)
+    {
+        ++_offsets[edge.first + 1];
+        ++_offsets[edge.second + 1];
+    }
+    for(std::size_t n = 0; n < _numNodes; ++n)
+        _offsets[n + 1] += _offsets[n];
+
+    // place each edge and its reverse in the edges of their origin nodes
+    std::vector<EdgeIndex> positions(_offsets.begin(), _offsets.end() - 1);
+    _heads.resize(nbEdges);
+    _reverse.resize(nbEdges);
+    _residuals.resize(nbEdges);
+
+    for(std::size_t i = 0; i < _edges.size(); ++i)
+    {
+        const NodeType n1 = _edges[i].first;
+        const NodeType n2 = _edges[i].second;
+        const EdgeIndex e = positions[n1]++;
+        const EdgeIndex reverseEdge = positions[n2]++;
+
+        _heads[e] = n2;
+        _residuals[e] = _capacities[2 * i];
+        _reverse[e] = reverseEdge;
+
+        _heads[reverseEdge] = n1;
+        _residuals[reverseEdge] = _capacities[2 * i + 1];
+        _reverse[reverseEdge] = e;
+    }
+
+    // force clear to free some RAM before the computation
+    std::vector<std::pair<NodeType, NodeType>>().swap(_edges);
+    std::vector<ValueType>().swap(_capacities);
+}
+
+void MaxFlow_PushRelabel::globalRelabel()
+{
+    const NodeType nbNodes = NodeType(_numNodes);
+
+    std::fill(_labels.begin(), _labels.end(), nbNodes);
+    _labels[_T] = 0;
+
+    // the source label stays the number of nodes
+    std::vector<char> visited(_numNodes, 0);
+    visited[_T] = 1;
+    visited[_S] = 1;
+
+    // reverse breadth-first search from the sink
+    std::vector<NodeType> frontier(1, _T);
+    std::vector<NodeType> nextFrontier;
+    NodeType distance = 0;
+
+    while(!frontier.empty())
+    {
+        ++distance;
+        nextFrontier.clear();
+        const std::ptrdiff_t nbFrontierNodes = static_cast<std::ptrdiff_t>(frontier.size());
+
+        #pragma omp parallel
+        {
+            std::vector<NodeType> localFrontier;
+
+            #pragma omp for schedule(dynamic, 256) nowait
+            for(std::ptrdiff_t i = 0; i < nbFrontierNodes; ++i)
+            {
+                const NodeType v = frontier[i];
+                for(EdgeIndex e = edgesBegin(v); e < edgesEnd(v); ++e)
+                {
+                    // u reaches v if its edge to v is not saturated
+                    if(_residuals[_reverse[e]] <= 0)
+                        continue;
+
+                    const NodeType u = _heads[e];
+                    if(boost::atomic_ref<char>(visited[u]).exchange(1) != 0)
+                        continue;
+
+                    _labels[u] = distance;
+                    localFrontier.push_back(u);
+                }
+            }
+
+            #pragma omp critical
+            nextFrontier.insert(nextFrontier.end(), localFrontier.begin(), localFrontier.end());
+        }
+        frontier.swap(nextFrontier);
+    }
+}
+
+MaxFlow_PushRelabel::ValueType MaxFlow_PushRelabel::compute()
+{
+    ALICEVISION_LOG_INFO("Compute push_relabel_max_flow.");
+
+    buildGraph();
+
+    const NodeType nbNodes = NodeType(_numNodes);
+    const std::size_t nbEdges = _heads.size();
+
+    ALICEVISION_LOG_INFO("# vertices: " << nbNodes);
+    ALICEVISION_LOG_INFO("# edges: " << nbEdges);
+
+    _excess.assign(_numNodes, 0);
+    _labels.assign(_numNodes, 0);
+
+    // saturate the source edges
+    for(EdgeIndex e = edgesBegin(_S); e < edgesEnd(_S); ++e)
+    {
+        const ValueType delta = _residuals[e];
+        _residuals[e] = 0;
+        _residuals[_reverse[e]] += delta;
+        _excess[_heads[e]] += delta;
+    }
+
+    // excess received by each node in the current round
+    std::vector<ValueType> incoming(_numNodes, 0);
+    // the node is active or has received some excess in the current round
+    std::vector<char> isQueued(_numNodes, 0);
+    std::vector<NodeType> active;
+    std::vector<NodeType> candidates;
+    std::vector<NodeType> newLabels;
+
+    const auto globalRelabelAndActivate = [&]()
+    {
+        globalRelabel();
+
+        active.clear();
+        for(NodeType n = 0; n < nbNodes; ++n)
+        {
+            // the source and the sink are never active
+            isQueued[n] = (n == _S || n == _T);
+            if(!isQueued[n] && _excess[n] > 0 && _labels[n] < nbNodes)
+            {
+                isQueued[n] = 1;
+                active.push_back(n);
+            }
+        }
+    };
+
+    // amount of relabeling work between two global relabelings
+    const double globalRelabelWork = 0.5 * (double(nbNodes) + double(nbEdges));
+    double work = 0.0;
+    std::size_t nbRounds = 0;
+    std::size_t nbGlobalRelabels = 1;
+
+    ALICEVISION_LOG_INFO("push_relabel_max_flow: start.");
+    globalRelabelAndActivate();
+
+    while(!active.empty())
+    {
+        ++nbRounds;
+        const std::ptrdiff_t nbActive = static_cast<std::ptrdiff_t>(active.size());
+        candidates.clear();
+
+        // push the excess of the active nodes to their neighbors with a lower label
+        #pragma omp parallel
+        {
+            std::vector<NodeType> localCandidates;
+
+            #pragma omp for schedule(dynamic, 256) nowait
+            for(std::ptrdiff_t i = 0; i < nbActive; ++i)
+            {
+                const NodeType v = active[i];
+                const NodeType label = _labels[v];
+                ValueType excess = _excess[v];
+
+                for(EdgeIndex e = edgesBegin(v); e < edgesEnd(v) && excess > 0; ++e)
+                {
+                    const NodeType u = _heads[e];
+                    // the labels are not modified during the push,
+                    // so the reverse edge cannot be admissible for u in the same round
+                    if(_labels[u] + 1 != label || _residuals[e] <= 0)
+                        continue;
+
+                    const ValueType delta = std::min(excess, _residuals[e]);
+                    _residuals[e] -= delta;
+                    _residuals[_reverse[e]] += delta;
+                    excess -= delta;
+
+                    boost::atomic_ref<ValueType>(incoming[u]).fetch_add(delta);
+                    if(boost::atomic_ref<char>(isQueued[u]).exchange(1) == 0)
+                        localCandidates.push_back(u);
+                }
+                _excess[v] = excess;
+            }
+
+            #pragma omp critical
+            candidates.insert(candidates.end(), localCandidates.begin(), localCandidates.end());
+        }
+
+        // relabel the active nodes which still have some excess,
+        // with the labels of the previous round to keep a valid labeling
+        newLabels.resize(nbActive);
+        double roundWork = 0.0;
+
+        #pragma omp parallel for schedule(dynamic, 256) reduction(+:roundWork)
+        for(std::ptrdiff_t i = 0; i < nbActive; ++i)
+        {
+            const NodeType v = active[i];
+            newLabels[i] = _labels[v];
+            if(_excess[v] <= 0)
+                continue;
+
+            NodeType minLabel = nbNodes;
+            for(EdgeIndex e = edgesBegin(v); e < edgesEnd(v); ++e)
+            {
+                if(_residuals[e] > 0)
+                    minLabel = std::min(minLabel, _labels[_heads[e]]);
+            }
+            newLabels[i] = std::min(nbNodes, minLabel + 1);
+            roundWork += 12.0 + double(edgesEnd(v) - edgesBegin(v));
+        }
+
+        #pragma omp parallel for
+        for(std::ptrdiff_t i = 0; i < nbActive; ++i)
+            _labels[active[i]] = newLabels[i];
+
+        // apply the received excess and keep the nodes which still have some
+        candidates.insert(candidates.end(), active.begin(), active.end());
+        active.clear();
+        const std::ptrdiff_t nbCandidates = static_cast<std::ptrdiff_t>(candidates.size());
+
+        #pragma omp parallel
+        {
+            std::vector<NodeType> localActive;
+
+            #pragma omp for nowait
+            for(std::ptrdiff_t i = 0; i < nbCandidates; ++i)
+            {
+                const NodeType n = candidates[i];
+                _excess[n] += incoming[n];
+                incoming[n] = 0;
+
+                if(_excess[n] > 0 && _labels[n] < nbNodes)
+                    localActive.push_back(n);
+                else
+                    isQueued[n] = 0;
+            }
+
+            #pragma omp critical
+            active.insert(active.end(), localActive.begin(), localActive.end());
+        }
+
+        work += roundWork;
+        if(work > globalRelabelWork && !active.empty())
+        {
+            work = 0.0;
+            ++nbGlobalRelabels;
+            globalRelabelAndActivate();
+        }
+    }
+
+    // the sink is never a candidate, its received excess is the flow
+    _excess[_T] += incoming[_T];
+    const ValueType flow = _excess[_T];
+
+    ALICEVISION_LOG_INFO("push_relabel_max_flow: done (" << nbRounds << " rounds, " << nbGlobalRelabels << " global relabelings).");
+
+    // mincut: the target nodes can still reach the sink in the residual graph
+    globalRelabel();
+    _isTarget.resize(_numNodes);
+    for(std::size_t n = 0; n < _numNodes; ++n)
+        _isTarget[n] = (_labels[n] < nbNodes);
+
+    return flow;
+}
+
+} // namespace fuseCut
+} // namespace aliceVision
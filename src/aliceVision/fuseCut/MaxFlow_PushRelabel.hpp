@@ -0,0 +1,117 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace aliceVision {
+namespace fuseCut {
+
+/**
+ * @brief Parallel maxflow/mincut computation based on a synchronous push-relabel algorithm.
+ *
+ * Same inputs and outputs as MaxFlow_CSR, the graph is stored in a compressed sparse row representation
+ * where the reverse of each edge is known from its insertion, so no temporary map is needed.
+ *
+ * Each round pushes the excess of all active nodes in parallel with the labels of the previous round,
+ * then relabels the nodes which still have some excess. An edge and its reverse can only be pushed
+ * by one of their nodes in a round, so the residuals are updated without synchronization.
+ * The labels are periodically set to the exact distances to the sink (global relabeling).
+ *
+ * Only the first phase of the algorithm is computed (maximum preflow), which is enough to get the mincut:
+ * the target nodes are the ones that can reach the sink in the residual graph.
+ *
+ * @note The labeling can differ from the Boykov-Kolmogorov solvers on nodes where the mincut is not unique.
+ */
+class MaxFlow_PushRelabel
+{
+public:
+    using NodeType = unsigned int;
+    using ValueType = float;
+    using EdgeIndex = unsigned int;
+
+public:
+    explicit MaxFlow_PushRelabel(std::size_t numNodes);
+
+    inline void addNode(NodeType n, ValueType source, ValueType sink)
+    {
+        assert(source >= 0 && sink >= 0);
+        ValueType score = source - sink;
+        if(score > 0)
+        {
+            this->addEdge(_S, n, score, score);
+        }
+        else //if(score <= 0)
+        {
+            this->addEdge(n, _T, -score, -score);
+        }
+    }
+
+    inline void addEdge(NodeType n1, NodeType n2, ValueType capacity, ValueType reverseCapacity)
+    {
+        assert(capacity >= 0 && reverseCapacity >= 0);
+
+        _edges.emplace_back(n1, n2);
+        _capacities.push_back(capacity);
+        _capacities.push_back(reverseCapacity);
+    }
+
+    /**
+     * @brief Compute the maxflow and the mincut labeling.
+     * @return the total flow
+     */
+    ValueType compute();
+
+    /// is empty
+    inline bool isSource(NodeType n) const
+    {
+        return !_isTarget[n];
+    }
+    /// is full
+    inline bool isTarget(NodeType n) const
+    {
+        return _isTarget[n];
+    }
+
+private:
+    /// Build the CSR graph from the added edges and release them
+    void buildGraph();
+
+    /**
+     * @brief Set the label of each node to its distance to the sink in the residual graph
+     *        (number of nodes if the sink cannot be reached).
+     */
+    void globalRelabel();
+
+    inline EdgeIndex edgesBegin(NodeType n) const { return _offsets[n]; }
+    inline EdgeIndex edgesEnd(NodeType n) const { return _offsets[n + 1]; }
+
+    std::size_t _numNodes;
+    /// added edges, edge i is stored with its reverse edge
+    std::vector<std::pair<NodeType, NodeType>> _edges;
+    /// capacities of the added edges and of their reverse edges (interleaved)
+    std::vector<ValueType> _capacities;
+
+    /// CSR graph: the edges of node n are in [_offsets[n], _offsets[n+1])
+    std::vector<EdgeIndex> _offsets;
+    std::vector<NodeType> _heads;
+    std::vector<EdgeIndex> _reverse;
+    std::vector<ValueType> _residuals;
+
+    std::vector<ValueType> _excess;
+    std::vector<NodeType> _labels;
+    std::vector<bool> _isTarget;
+
+    const NodeType _S;  //< emptyness
+    const NodeType _T;  //< fullness
+};
+
+} // namespace fuseCut
+} // namespace aliceVision
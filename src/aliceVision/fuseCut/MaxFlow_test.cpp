@@ -0,0 +1,73 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/fuseCut/MaxFlow_AdjList.hpp>
+#include <aliceVision/fuseCut/MaxFlow_PushRelabel.hpp>
+
+#include <random>
+
+#define BOOST_TEST_MODULE fuseCut
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::fuseCut;
+
+namespace {
+
+/**
+ * @brief Fill a random graph with 4 neighbors per node, like the tetrahedra of the graph cut.
+ *        The capacities are integers to get exact flows in both solvers.
+ */
+template <typename MaxFlowGraph>
+void fillRandomGraph(MaxFlowGraph& graph, std::size_t nbNodes, unsigned int seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<std::size_t> nodeDistribution(0, nbNodes - 1);
+    std::uniform_int_distribution<int> terminalDistribution(0, 20);
+    std::uniform_int_distribution<int> edgeDistribution(0, 10);
+
+    for(std::size_t n = 0; n < nbNodes; ++n)
+        graph.addNode(n, float(terminalDistribution(generator)), float(terminalDistribution(generator)));
+
+    for(std::size_t n = 0; n < nbNodes; ++n)
+    {
+        for(int k = 0; k < 4; ++k)
+        {
+            const std::size_t neighbor = nodeDistribution(generator);
+            const float capacity = float(edgeDistribution(generator));
+            const float reverseCapacity = float(edgeDistribution(generator));
+            if(neighbor != n)
+                graph.addEdge(n, neighbor, capacity, reverseCapacity);
+        }
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(fuseCut_maxflow_pushRelabel)
+{
+    for(unsigned int seed = 0; seed < 10; ++seed)
+    {
+        const std::size_t nbNodes = 1000 + 500 * seed;
+
+        MaxFlow_AdjList referenceGraph(nbNodes);
+        fillRandomGraph(referenceGraph, nbNodes, seed);
+        const float referenceFlow = referenceGraph.compute();
+
+        MaxFlow_PushRelabel graph(nbNodes);
+        fillRandomGraph(graph, nbNodes, seed);
+        const float flow = graph.compute();
+
+        BOOST_CHECK_EQUAL(flow, referenceFlow);
+
+        // the nodes which can reach the sink after the maxflow do not depend on the solver
+        std::size_t nbDifferentLabels = 0;
+        for(std::size_t n = 0; n < nbNodes; ++n)
+            nbDifferentLabels += (graph.isTarget(n) != referenceGraph.isTarget(n));
+        BOOST_CHECK_EQUAL(nbDifferentLabels, 0);
+    }
+}
@@ -492,6 +492,7 @@ OctreeTracks::OctreeTracks(const Point3d* voxel_, mvsUtils::MultiViewParams* mp_
     doUseWeaklySupportedPointCam = _mp.userParams.get<bool>("LargeScale.doUseWeaklySupportedPointCam", false);
     minNumOfConsistentCams = _mp.userParams.get<int>("filter.minNumOfConsistentCams", 2);
     simWspThr = (float)_mp.userParams.get<double>("LargeScale.simWspThr", -0.0f);
+    depthMapsScale = _mp.userParams.get<int>("LargeScale.depthMapsScale", 0);
 
     int maxNumSubVoxs = std::max({numSubVoxsX, numSubVoxsY, numSubVoxsZ});
     size_ = 2;
@@ -670,8 +671,12 @@ void OctreeTracks::filterOctreeTracks2(StaticVector<trackStruct*>* tracks)
 StaticVector<OctreeTracks::trackStruct*>*
     OctreeTracks::fillOctree(int maxPts, const std::string& depthMapsPtsSimsTmpDir)
 {
+    // without temporary files, the points are streamed from the depth/sim maps
+    const bool useTempPtsSimsFiles = !depthMapsPtsSimsTmpDir.empty();
+
     long t1 = clock();
-    StaticVector<int> cams = _mp.findCamsWhichIntersectsHexahedron(vox, depthMapsPtsSimsTmpDir + "minMaxDepths.bin");
+    StaticVector<int> cams = useTempPtsSimsFiles ? _mp.findCamsWhichIntersectsHexahedron(vox, depthMapsPtsSimsTmpDir + "minMaxDepths.bin")
+                                                 : _mp.findCamsWhichIntersectsHexahedron(vox);
     mvsUtils::printfElapsedTime(t1, "findCamsWhichIntersectsHexahedron");
     ALICEVISION_LOG_DEBUG("ncams: " << cams.size());
 
@@ -682,49 +687,70 @@ StaticVector<OctreeTracks::trackStruct*>*
     for(int camid = 0; camid < cams.size(); camid++)
     {
         int rc = cams[camid];
-        StaticVector<Point3d>* pts =
-            loadArrayFromFile<Point3d>(depthMapsPtsSimsTmpDir + std::to_string(_mp.getViewId(rc)) + "pts.bin");
-        StaticVector<float>* sims =
-            loadArrayFromFile<float>(depthMapsPtsSimsTmpDir + std::to_string(_mp.getViewId(rc)) + "sims.bin");
+        StaticVector<Point3d>* pts = nullptr;
+        StaticVector<float>* sims = nullptr;
 
-        // long tpts=initEstimate();
-        for(int i = 0; i < pts->size(); i++)
+        if(useTempPtsSimsFiles)
         {
-            float sim = (*sims)[i];
-            Point3d p = (*pts)[i];
-
-            Voxel otVox;
-            if(((doUseWeaklySupportedPoints) || (sim < simWspThr)) && (getVoxelOfOctreeFor3DPoint(otVox, p))) // doUseWeaklySupportedPoints: false by default
-            {
-                if(doUseWeaklySupportedPointCam)
-                {
-                    if(sim > 1.0f)
-                    {
-                        sim -= 2.0f;
-                    }
-                }
-                float pixSize = _mp.getCamPixelSize(p, rc);
-                addPoint(otVox.x, otVox.y, otVox.z, sim, pixSize, p, rc);
-            }
-            if(leafsNumber_ > 2 * maxPts)
-            {
-                return nullptr;
-            }
-
-            // printfEstimate(i, pts->size(), tpts);
-        } // for i
-          // finishEstimate();
+            pts = loadArrayFromFile<Point3d>(depthMapsPtsSimsTmpDir + std::to_string(_mp.getViewId(rc)) + "pts.bin");
+            sims = loadArrayFromFile<float>(depthMapsPtsSimsTmpDir + std::to_string(_mp.getViewId(rc)) + "sims.bin");
+        }
+        else
+        {
+            pts = new StaticVector<Point3d>();
+            sims = new StaticVector<float>();
+            Point2d minMaxDepth;
+            getDepthMapPoints(rc, _mp, depthMapsScale, *pts, *sims, minMaxDepth, vox);
+        }
 
+        const bool filled = addPoints(rc, *pts, *sims, maxPts);
         delete pts;
         delete sims;
 
+        if(!filled)
+            return nullptr;
+
         // printfEstimate(camid, cams.size(), t1);
     }
     // finishEstimate();
 
-    StaticVector<trackStruct*>* tracks = getAllPoints();
     mvsUtils::printfElapsedTime(t1, "fillOctree fill");
 
+    return getTracks(maxPts);
+}
+
+bool OctreeTracks::addPoints(int rc, const StaticVector<Point3d>& pts, const StaticVector<float>& sims, int maxPts)
+{
+    for(int i = 0; i < pts.size(); i++)
+    {
+        float sim = sims[i];
+        Point3d p = pts[i];
+
+        Voxel otVox;
+        if(((doUseWeaklySupportedPoints) || (sim < simWspThr)) && (getVoxelOfOctreeFor3DPoint(otVox, p))) // doUseWeaklySupportedPoints: false by default
+        {
+            if(doUseWeaklySupportedPointCam)
+            {
+                if(sim > 1.0f)
+                {
+                    sim -= 2.0f;
+                }
+            }
+            float pixSize = _mp.getCamPixelSize(p, rc);
+            addPoint(otVox.x, otVox.y, otVox.z, sim, pixSize, p, rc);
+        }
+        if(leafsNumber_ > 2 * maxPts)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+StaticVector<OctreeTracks::trackStruct*>* OctreeTracks::getTracks(int maxPts)
+{
+    StaticVector<trackStruct*>* tracks = getAllPoints();
+
     // TODO this is not working well ...
     // updateOctreeTracksCams(tracks);
     // if (_mp.verbose) printfElapsedTime(t1,"updateOctreeTracksCams");
@@ -82,6 +82,7 @@ public:
     int numSubVoxsY;
     int numSubVoxsZ;
     bool doUseWeaklySupportedPoints;
+    int depthMapsScale; // downscale of the depth/sim maps streamed without temporary files
     bool doUseWeaklySupportedPointCam;
     bool doFilterOctreeTracks;
     int minNumOfConsistentCams;
@@ -99,6 +100,10 @@ public:
     void updateOctreeTracksCams(StaticVector<trackStruct*>* tracks);
     StaticVector<trackStruct*>* fillOctreeFromTracks(StaticVector<trackStruct*>* tracksIn);
     StaticVector<trackStruct*>* fillOctree(int maxPts, const std::string& depthMapsPtsSimsTmpDir);
+    /// add the points of the R camera in the voxel, false if the octree has too many leaves (more than 2 * maxPts)
+    bool addPoints(int rc, const StaticVector<Point3d>& pts, const StaticVector<float>& sims, int maxPts);
+    /// get the (filtered) tracks of the octree, nullptr if there are more than maxPts tracks
+    StaticVector<trackStruct*>* getTracks(int maxPts);
     StaticVector<int>* getTracksCams(StaticVector<OctreeTracks::trackStruct*>* tracks);
     void getNPointsByLevelsRecursive(Node* node, int level, StaticVector<int>* nptsAtLevel);
 };
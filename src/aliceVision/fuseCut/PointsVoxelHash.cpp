@@ -0,0 +1,129 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "PointsVoxelHash.hpp"
+
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace aliceVision {
+namespace fuseCut {
+
+namespace {
+
+/// power of 2, the shard is selected by the high bits of the mixed voxel key
+constexpr int nbShardsBits = 6;
+constexpr std::size_t nbShards = std::size_t(1) << nbShardsBits;
+
+} // namespace
+
+constexpr std::size_t PointsVoxelHash::npos;
+
+PointsVoxelHash::PointsVoxelHash(double minDist)
+    : _shards(new Shard[nbShards])
+{
+    reset(minDist);
+}
+
+void PointsVoxelHash::reset(double minDist)
+{
+    assert(minDist > 0.0);
+    _minDist = minDist;
+    _invVoxelSize = 1.0 / minDist;
+    for(std::size_t i = 0; i < nbShards; ++i)
+        std::unordered_map<std::uint64_t, std::size_t>().swap(_shards[i].voxels);
+    std::vector<std::size_t>().swap(_next);
+}
+
+std::uint64_t PointsVoxelHash::getVoxelKey(std::int64_t x, std::int64_t y, std::int64_t z) const
+{
+    // 21 bits per axis, the coordinates wrap around so distant voxels can share a key,
+    // which only adds candidates to the distance checks
+    const std::uint64_t mask = (std::uint64_t(1) << 21) - 1;
+    return ((std::uint64_t(x) & mask) << 42) | ((std::uint64_t(y) & mask) << 21) | (std::uint64_t(z) & mask);
+}
+
+std::uint64_t PointsVoxelHash::getVoxelKey(const Point3d& p) const
+{
+    return getVoxelKey(static_cast<std::int64_t>(std::floor(p.x * _invVoxelSize)),
+                       static_cast<std::int64_t>(std::floor(p.y * _invVoxelSize)),
+                       static_cast<std::int64_t>(std::floor(p.z * _invVoxelSize)));
+}
+
+PointsVoxelHash::Shard& PointsVoxelHash::getShard(std::uint64_t key) const
+{
+    return _shards[(key * 0x9E3779B97F4A7C15ull) >> (64 - nbShardsBits)];
+}
+
+void PointsVoxelHash::insert(const Point3d& p, std::size_t index)
+{
+    const std::uint64_t key = getVoxelKey(p);
+    Shard& shard = getShard(key);
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    const auto it = shard.voxels.emplace(key, npos).first;
+    _next[index] = it->second;
+    it->second = index;
+}
+
+void PointsVoxelHash::insertPoints(const std::vector<Point3d>& points, std::size_t from, std::size_t to)
+{
+    assert(from == size() && to <= points.size());
+    if(to <= from)
+        return;
+
+    _next.resize(to);
+
+    #pragma omp parallel for schedule(dynamic, 4096)
+    for(std::ptrdiff_t i = std::ptrdiff_t(from); i < std::ptrdiff_t(to); ++i)
+        insert(points[i], std::size_t(i));
+}
+
+void PointsVoxelHash::insertPoint(const std::vector<Point3d>& points, std::size_t index)
+{
+    assert(index == size() && index < points.size());
+    _next.push_back(npos);
+    insert(points[index], index);
+}
+
+std::size_t PointsVoxelHash::findNearby(const std::vector<Point3d>& points, const Point3d& p) const
+{
+    const std::int64_t x = static_cast<std::int64_t>(std::floor(p.x * _invVoxelSize));
+    const std::int64_t y = static_cast<std::int64_t>(std::floor(p.y * _invVoxelSize));
+    const std::int64_t z = static_cast<std::int64_t>(std::floor(p.z * _invVoxelSize));
+    const double minDist2 = _minDist * _minDist;
+
+    // the smallest index is returned, so the result does not depend on the insertion order
+    std::size_t nearbyIndex = npos;
+    for(std::int64_t dz = -1; dz <= 1; ++dz)
+    {
+        for(std::int64_t dy = -1; dy <= 1; ++dy)
+        {
+            for(std::int64_t dx = -1; dx <= 1; ++dx)
+            {
+                const std::uint64_t key = getVoxelKey(x + dx, y + dy, z + dz);
+                const Shard& shard = getShard(key);
+                const auto it = shard.voxels.find(key);
+                if(it == shard.voxels.end())
+                    continue;
+
+                for(std::size_t i = it->second; i != npos; i = _next[i])
+                {
+                    const Point3d d = points[i] - p;
+                    if(i < nearbyIndex && (d.x * d.x + d.y * d.y + d.z * d.z) <= minDist2)
+                        nearbyIndex = i;
+                }
+            }
+        }
+    }
+    return nearbyIndex;
+}
+
+} // namespace fuseCut
+} // namespace aliceVision
@@ -0,0 +1,91 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mvsData/Point3d.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace aliceVision {
+namespace fuseCut {
+
+/**
+ * @brief Sparse voxel hash of the indexes of a points array, to merge the points closer than a minimal distance.
+ *
+ * The voxel size is the minimal distance, so the points closer than the minimal distance to a point
+ * are in the 27 voxels around it. The points of each voxel are chained through the points indexes,
+ * so the memory is one hash map entry per non-empty voxel and one index per point.
+ * The points are not copied, the hash stores indexes in the points array given as argument.
+ *
+ * @note insertPoints inserts in parallel, the other methods are not thread-safe.
+ */
+class PointsVoxelHash
+{
+public:
+    static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+    explicit PointsVoxelHash(double minDist = 1.0);
+
+    /// Remove all the points and set the minimal distance
+    void reset(double minDist);
+
+    double getMinDist() const { return _minDist; }
+
+    /// Number of inserted points, the points are inserted in increasing order of their indexes
+    std::size_t size() const { return _next.size(); }
+
+    /**
+     * @brief Insert the points [from, to) of the points array in parallel, without merging them.
+     * @param[in] points the points array
+     * @param[in] from the first point index, must be the number of inserted points
+     * @param[in] to the end of the points range
+     */
+    void insertPoints(const std::vector<Point3d>& points, std::size_t from, std::size_t to);
+
+    /**
+     * @brief Insert the next point of the points array.
+     * @param[in] points the points array
+     * @param[in] index the point index, must be the number of inserted points
+     */
+    void insertPoint(const std::vector<Point3d>& points, std::size_t index);
+
+    /**
+     * @brief Find an inserted point closer than the minimal distance.
+     * @param[in] points the points array
+     * @param[in] p the query point
+     * @return the smallest index of the inserted points closer than the minimal distance or npos
+     */
+    std::size_t findNearby(const std::vector<Point3d>& points, const Point3d& p) const;
+
+private:
+    struct Shard
+    {
+        std::mutex mutex;
+        /// voxel key to the last inserted point index of the voxel
+        std::unordered_map<std::uint64_t, std::size_t> voxels;
+    };
+
+    std::uint64_t getVoxelKey(const Point3d& p) const;
+    std::uint64_t getVoxelKey(std::int64_t x, std::int64_t y, std::int64_t z) const;
+    Shard& getShard(std::uint64_t key) const;
+    void insert(const Point3d& p, std::size_t index);
+
+    double _minDist;
+    double _invVoxelSize;
+    std::unique_ptr<Shard[]> _shards;
+    /// previous point index in the voxel of each point (npos for the first point of a voxel)
+    std::vector<std::size_t> _next;
+};
+
+} // namespace fuseCut
+} // namespace aliceVision
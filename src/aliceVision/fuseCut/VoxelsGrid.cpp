@@ -14,6 +14,9 @@
 
 #include <boost/filesystem.hpp>
 
+#include <algorithm>
+#include <set>
+
 namespace aliceVision {
 namespace fuseCut {
 
@@ -269,6 +272,20 @@ void VoxelsGrid::generateTracksForEachVoxel(StaticVector<Point3d>* Reconstructio
     StaticVector<int>* toRecurse = new StaticVector<int>();
     toRecurse->reserve(nvoxs);
 
+    // without temporary files, the depth/sim maps are streamed: each one is read once for all the voxels
+    const bool streamDepthMaps = depthMapsPtsSimsTmpDir.empty();
+    std::vector<OctreeTracks*> otts;
+    std::vector<StaticVector<OctreeTracks::trackStruct*>*> voxelsTracks;
+    if(streamDepthMaps)
+    {
+        long t1 = clock();
+        for(int i = 0; i < nvoxs; i++)
+            otts.push_back(new OctreeTracks(&(*voxels)[i * 8], mp, Voxel(numSubVoxs, numSubVoxs, numSubVoxs)));
+        voxelsTracks = fillOctreesFromDepthMaps(otts, maxPts);
+        if(mp->verbose)
+            mvsUtils::printfElapsedTime(t1, "fillOctreesFromDepthMaps");
+    }
+
 #pragma omp parallel for
     for(int i = 0; i < nvoxs; i++)
     {
@@ -277,8 +294,18 @@ void VoxelsGrid::generateTracksForEachVoxel(StaticVector<Point3d>* Reconstructio
         std::string folderName = getVoxelFolderName(i);
 
         long t1 = clock();
-        OctreeTracks* ott = new OctreeTracks(&(*voxels)[i * 8], mp, Voxel(numSubVoxs, numSubVoxs, numSubVoxs));
-        StaticVector<OctreeTracks::trackStruct*>* tracks = ott->fillOctree(maxPts, depthMapsPtsSimsTmpDir);
+        OctreeTracks* ott = nullptr;
+        StaticVector<OctreeTracks::trackStruct*>* tracks = nullptr;
+        if(streamDepthMaps)
+        {
+            ott = otts[i];
+            tracks = voxelsTracks[i];
+        }
+        else
+        {
+            ott = new OctreeTracks(&(*voxels)[i * 8], mp, Voxel(numSubVoxs, numSubVoxs, numSubVoxs));
+            tracks = ott->fillOctree(maxPts, depthMapsPtsSimsTmpDir);
+        }
         if(mp->verbose)
             mvsUtils::printfElapsedTime(t1, "fillOctree");
         if(tracks == nullptr)
@@ -359,6 +386,66 @@ void VoxelsGrid::generateTracksForEachVoxel(StaticVector<Point3d>* Reconstructio
         vizualize();
 }
 
+std::vector<StaticVector<OctreeTracks::trackStruct*>*> VoxelsGrid::fillOctreesFromDepthMaps(const std::vector<OctreeTracks*>& otts, int maxPts)
+{
+    const int nvoxs = otts.size();
+
+    // the R cameras intersecting each voxel, sorted
+    std::vector<std::vector<int>> camsPerVoxel(nvoxs);
+    std::set<int> allCams;
+    for(int i = 0; i < nvoxs; i++)
+    {
+        const StaticVector<int> cams = mp->findCamsWhichIntersectsHexahedron(otts[i]->vox);
+        camsPerVoxel[i].assign(cams.begin(), cams.end());
+        std::sort(camsPerVoxel[i].begin(), camsPerVoxel[i].end());
+        allCams.insert(cams.begin(), cams.end());
+    }
+    const std::vector<int> cams(allCams.begin(), allCams.end());
+    ALICEVISION_LOG_DEBUG("ncams: " << cams.size());
+
+    // a voxel with too many points is not filled anymore (char instead of bool, written by several threads)
+    std::vector<char> overflow(nvoxs, 0);
+
+    // the depth/sim maps are read by batches, in parallel, then the points are added to the voxels,
+    // each octree by a single thread
+    const int batchSize = std::max(1, omp_get_max_threads());
+    for(int batchBegin = 0; batchBegin < cams.size(); batchBegin += batchSize)
+    {
+        const int batchEnd = std::min(batchBegin + batchSize, int(cams.size()));
+        std::vector<StaticVector<Point3d>> pts(batchEnd - batchBegin);
+        std::vector<StaticVector<float>> sims(batchEnd - batchBegin);
+
+#pragma omp parallel for
+        for(int b = 0; b < batchEnd - batchBegin; b++)
+        {
+            Point2d minMaxDepth;
+            getDepthMapPoints(cams[batchBegin + b], *mp, otts.front()->depthMapsScale, pts[b], sims[b], minMaxDepth, space);
+        }
+
+#pragma omp parallel for
+        for(int i = 0; i < nvoxs; i++)
+        {
+            for(int b = 0; b < batchEnd - batchBegin && !overflow[i]; b++)
+            {
+                const int rc = cams[batchBegin + b];
+                if(!std::binary_search(camsPerVoxel[i].begin(), camsPerVoxel[i].end(), rc))
+                    continue;
+                if(!otts[i]->addPoints(rc, pts[b], sims[b], maxPts))
+                    overflow[i] = 1;
+            }
+        }
+    }
+
+    std::vector<StaticVector<OctreeTracks::trackStruct*>*> voxelsTracks(nvoxs, nullptr);
+#pragma omp parallel for
+    for(int i = 0; i < nvoxs; i++)
+    {
+        if(!overflow[i])
+            voxelsTracks[i] = otts[i]->getTracks(maxPts);
+    }
+    return voxelsTracks;
+}
+
 void VoxelsGrid::generateSpace(VoxelsGrid* vgnew, const Voxel& LU, const Voxel& RD,
                                const std::string& depthMapsPtsSimsTmpDir)
 {
@@ -12,6 +12,8 @@
 #include <aliceVision/mvsData/Voxel.hpp>
 #include <aliceVision/fuseCut/OctreeTracks.hpp>
 
+#include <vector>
+
 namespace aliceVision {
 namespace fuseCut {
 
@@ -45,6 +47,13 @@ public:
     void generateSpace(VoxelsGrid* vgnew, const Voxel& LU, const Voxel& RD, const std::string& depthMapsPtsSimsTmpDir);
     void generateTracksForEachVoxel(StaticVector<Point3d>* ReconstructionPlan, int numSubVoxs, int maxPts, int level,
                                     int& maxlevel, const std::string& depthMapsPtsSimsTmpDir);
+    /**
+     * @brief Fill the octrees of the voxels from the depth/sim maps, each depth/sim map is read once for all the voxels
+     * @param[in,out] otts the octree of each voxel
+     * @param[in] maxPts the maximum number of tracks of a voxel
+     * @return the tracks of each voxel, nullptr if the voxel has too many points
+     */
+    std::vector<StaticVector<OctreeTracks::trackStruct*>*> fillOctreesFromDepthMaps(const std::vector<OctreeTracks*>& otts, int maxPts);
     void vizualize();
 
     void cloneSpaceVoxel(int voxelId, int numSubVoxs, VoxelsGrid* newSpace);
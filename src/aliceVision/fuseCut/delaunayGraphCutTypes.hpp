@@ -10,6 +10,9 @@
 #include <aliceVision/mvsData/StaticVector.hpp>
 
 #include <array>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
 
 namespace aliceVision {
 namespace fuseCut {
@@ -61,52 +64,125 @@ struct GC_Seg
     int segId = -1;
 };
 
+/**
+ * @brief Read-only view on a contiguous range of elements.
+ */
+template <typename T>
+class GC_arrayView
+{
+public:
+    GC_arrayView() = default;
+    GC_arrayView(const T* begin, const T* end)
+        : _begin(begin)
+        , _end(end)
+    {}
+
+    inline const T* begin() const { return _begin; }
+    inline const T* end() const { return _end; }
+    inline std::size_t size() const { return std::size_t(_end - _begin); }
+    inline bool empty() const { return _begin == _end; }
+    inline const T& operator[](std::size_t index) const { return _begin[index]; }
+
+private:
+    const T* _begin = nullptr;
+    const T* _end = nullptr;
+};
+
+/**
+ * @brief Range of the camera indices of one vertex in a GC_camerasPool.
+ */
+struct GC_camerasRange
+{
+    std::size_t offset = 0;
+    std::uint32_t size = 0;
+};
+
+/**
+ * @brief Camera indices of all the vertices, packed in a single array.
+ *        Each vertex refers to its cameras with a GC_camerasRange,
+ *        instead of one heap allocated vector per vertex.
+ */
+class GC_camerasPool
+{
+public:
+    /**
+     * @brief Append the camera indices of one vertex.
+     * @return the range of the vertex cameras in the pool
+     */
+    template <typename InputIt>
+    GC_camerasRange add(InputIt first, InputIt last)
+    {
+        GC_camerasRange range;
+        range.offset = _cameras.size();
+        _cameras.insert(_cameras.end(), first, last);
+        range.size = static_cast<std::uint32_t>(_cameras.size() - range.offset);
+        return range;
+    }
+
+    inline GC_camerasRange add(const StaticVector<int>& cams)
+    {
+        return add(cams.begin(), cams.end());
+    }
+
+    inline GC_arrayView<int> get(const GC_camerasRange& range) const
+    {
+        const int* begin = _cameras.data() + range.offset;
+        return GC_arrayView<int>(begin, begin + range.size);
+    }
+
+    inline std::size_t size() const { return _cameras.size(); }
+    inline void reserve(std::size_t size) { _cameras.reserve(size); }
+    inline void clear() { _cameras.clear(); }
+    inline void shrink_to_fit() { _cameras.shrink_to_fit(); }
+
+private:
+    std::vector<int> _cameras;
+};
+
 struct GC_vertexInfo
 {
     float pixSize = 0.0f;
-    /// Number of cameras which have contributed to the refinement of the vertex position, so nrc >= cams.size().
+    /// Number of cameras which have contributed to the refinement of the vertex position, so nrc >= cams.size.
     int nrc = 0;
-    /// All cameras having a visibility of this vertex. Some of them may not have contributed to the vertex position
-    StaticVector<int> cams;
+    /// All cameras having a visibility of this vertex (range in the vertices cameras pool).
+    /// Some of them may not have contributed to the vertex position
+    GC_camerasRange cams;
 
     /**
      * @brief Is the vertex a virtual point without associated camera? Like helper points or camera points.
      */
-    inline bool isVirtual() const { return cams.empty(); }
-    inline bool isReal() const { return !cams.empty(); }
+    inline bool isVirtual() const { return cams.size == 0; }
+    inline bool isReal() const { return cams.size != 0; }
 
     inline std::size_t getNbCameras() const
     {
-        return cams.size();
-    }
-
-    inline int getCamera(std::size_t index) const
-    {
-        return cams[index];
+        return cams.size;
     }
 
-    void fwriteinfo(FILE* f) const
+    void fwriteinfo(FILE* f, const GC_camerasPool& camerasPool) const
     {
         fwrite(&pixSize, sizeof(float), 1, f);
         fwrite(&nrc, sizeof(int), 1, f);
-        int n = cams.size();
+        int n = cams.size;
         fwrite(&n, sizeof(int), 1, f);
         if(n > 0)
         {
-            fwrite(&cams[0], sizeof(int), n, f);
+            fwrite(camerasPool.get(cams).begin(), sizeof(int), n, f);
         }
     }
 
-    void freadinfo(FILE* f)
+    void freadinfo(FILE* f, GC_camerasPool& camerasPool)
     {
         fread(&pixSize, sizeof(float), 1, f);
         fread(&nrc, sizeof(int), 1, f);
         int n;
         fread(&n, sizeof(int), 1, f);
+        cams = GC_camerasRange();
         if(n > 0)
         {
-            cams.resize(n);
-            fread(&cams[0], sizeof(int), n, f);
+            std::vector<int> vertexCams(n);
+            fread(&vertexCams[0], sizeof(int), n, f);
+            cams = camerasPool.add(vertexCams.begin(), vertexCams.end());
         }
     }
 };
@@ -0,0 +1,289 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "GpuResourceManager.hpp"
+
+#include <aliceVision/config.hpp>
+#include <aliceVision/system/Logger.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/exceptions.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+#include <cuda_runtime.h>
+#endif
+
+namespace aliceVision {
+namespace gpu {
+
+namespace bfs = boost::filesystem;
+
+namespace {
+
+// The file locks are owned by the process: a lock file held by this process must not be opened again,
+// as closing any handle on it would release the lock. So the lock files held by all the managers of the process
+// are registered here and never probed.
+std::mutex heldLocksMutex;
+std::set<std::string> heldLocks;
+
+std::vector<GpuDevice> listCudaDevices()
+{
+    std::vector<GpuDevice> devices;
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+    int nbDevices = 0;
+    if(cudaGetDeviceCount(&nbDevices) != cudaSuccess)
+    {
+        cudaGetLastError(); // clear error
+        return devices;
+    }
+
+    int currentDevice = 0;
+    cudaGetDevice(&currentDevice);
+
+    for(int i = 0; i < nbDevices; ++i)
+    {
+        cudaDeviceProp deviceProperties;
+        if(cudaGetDeviceProperties(&deviceProperties, i) != cudaSuccess)
+        {
+            ALICEVISION_LOG_ERROR("Cannot get properties for CUDA gpu device " << i);
+            cudaGetLastError(); // clear error
+            continue;
+        }
+
+        GpuDevice device;
+        device.id = i;
+        device.name = deviceProperties.name;
+        device.totalMemory = int(deviceProperties.totalGlobalMem / (1024 * 1024));
+        device.freeMemory = device.totalMemory;
+
+        char pciBusId[32];
+        if(cudaDeviceGetPCIBusId(pciBusId, sizeof(pciBusId), i) == cudaSuccess)
+            device.pciBusId = pciBusId;
+        else
+            device.pciBusId = std::to_string(deviceProperties.pciDomainID) + ":" + std::to_string(deviceProperties.pciBusID) + ":" + std::to_string(deviceProperties.pciDeviceID);
+
+        std::size_t avail;
+        std::size_t total;
+        if(cudaSetDevice(i) == cudaSuccess && cudaMemGetInfo(&avail, &total) == cudaSuccess)
+            device.freeMemory = int(avail / (1024 * 1024));
+        else
+            cudaGetLastError(); // clear error, the card does not provide this information
+
+        devices.push_back(device);
+    }
+
+    cudaSetDevice(currentDevice);
+#endif
+    return devices;
+}
+
+} // namespace
+
+GpuResourceManager::GpuResourceManager(int maxJobsPerDevice, const std::string& lockFolder, DevicesLister listDevices)
+  : _maxJobsPerDevice(std::max(maxJobsPerDevice, 1))
+  , _lockFolder(lockFolder)
+  , _listDevices(std::move(listDevices))
+{
+    if(_lockFolder.empty())
+        _lockFolder = (bfs::temp_directory_path() / "aliceVision_gpuLocks").string();
+
+    boost::system::error_code ec;
+    bfs::create_directories(_lockFolder, ec);
+    if(ec)
+        ALICEVISION_LOG_WARNING("Cannot create the GPU lock folder '" << _lockFolder << "': " << ec.message());
+}
+
+GpuResourceManager::GpuResourceManager(const HardwareContext& hContext)
+  : GpuResourceManager(hContext.getMaxJobsPerGpu())
+{}
+
+GpuResourceManager::~GpuResourceManager()
+{
+    releaseDevices();
+}
+
+std::vector<GpuDevice> GpuResourceManager::getDevices() const
+{
+    std::vector<GpuDevice> devices = _listDevices ? _listDevices() : listCudaDevices();
+    for(GpuDevice& device : devices)
+        device.nbJobs = getNbJobs(device);
+    return devices;
+}
+
+std::vector<int> GpuResourceManager::acquireDevices(int nbDevices, int minFreeMemory, double maxWaitTime)
+{
+    std::vector<int> deviceIds;
+    bool waiting = false;
+    const auto startTime = std::chrono::steady_clock::now();
+
+    while(true)
+    {
+        std::vector<GpuDevice> devices = getDevices();
+
+        // the devices without enough memory can never be used
+        devices.erase(std::remove_if(devices.begin(), devices.end(), [&](const GpuDevice& device) {
+            return device.totalMemory < minFreeMemory;
+        }), devices.end());
+
+        if(devices.empty())
+        {
+            ALICEVISION_LOG_WARNING("No CUDA device with " << minFreeMemory << " MB of memory.");
+            return deviceIds;
+        }
+
+        std::stable_sort(devices.begin(), devices.end(), [](const GpuDevice& a, const GpuDevice& b) {
+            return (a.nbJobs != b.nbJobs) ? (a.nbJobs < b.nbJobs) : (a.freeMemory > b.freeMemory);
+        });
+
+        const std::size_t nbWantedDevices = (nbDevices > 0) ? std::min(std::size_t(nbDevices), devices.size()) : devices.size();
+
+        int nbTriedDevices = 0;
+        int nbLockErrors = 0;
+        for(const GpuDevice& device : devices)
+        {
+            if(deviceIds.size() >= nbWantedDevices)
+                break;
+
+            const bool isReserved = std::any_of(_reservations.begin(), _reservations.end(), [&](const Reservation& reservation) {
+                return reservation.deviceId == device.id;
+            });
+
+            if(isReserved || device.nbJobs >= _maxJobsPerDevice || device.freeMemory < minFreeMemory)
+                continue;
+
+            bool lockError = false;
+            ++nbTriedDevices;
+            if(tryAcquire(device, lockError))
+            {
+                ALICEVISION_LOG_INFO("Use CUDA device " << device.id << " (" << device.name << ", " << device.freeMemory << " MB free, "
+                                     << device.nbJobs << " running job(s)).");
+                deviceIds.push_back(device.id);
+            }
+            else if(lockError)
+            {
+                ++nbLockErrors;
+            }
+        }
+
+        if(!deviceIds.empty())
+            return deviceIds;
+
+        // the devices are free but cannot be locked, waiting would never end
+        if(nbTriedDevices > 0 && nbLockErrors == nbTriedDevices)
+        {
+            ALICEVISION_LOG_ERROR("Cannot create the lock files of the CUDA devices in '" << _lockFolder << "'.");
+            return deviceIds;
+        }
+
+        const double waitTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        if(maxWaitTime >= 0.0 && waitTime >= maxWaitTime)
+        {
+            ALICEVISION_LOG_WARNING("No CUDA device released by the other jobs after " << waitTime << " s.");
+            return deviceIds;
+        }
+
+        if(!waiting)
+        {
+            ALICEVISION_LOG_INFO("All the CUDA devices are used by other jobs, waiting for a device.");
+            waiting = true;
+        }
+        std::this_thread::sleep_for(std::chrono::duration<double>(maxWaitTime >= 0.0 ? std::min(1.0, maxWaitTime - waitTime) : 1.0));
+    }
+}
+
+void GpuResourceManager::releaseDevices()
+{
+    std::lock_guard<std::mutex> lock(heldLocksMutex);
+    for(Reservation& reservation : _reservations)
+    {
+        reservation.lock->unlock();
+        heldLocks.erase(reservation.lockPath);
+    }
+    _reservations.clear();
+}
+
+bool GpuResourceManager::tryAcquire(const GpuDevice& device, bool& lockError)
+{
+    std::lock_guard<std::mutex> lock(heldLocksMutex);
+    int nbErrors = 0;
+    int nbSlots = 0;
+    for(int slot = 0; slot < _maxJobsPerDevice; ++slot)
+    {
+        const std::string lockPath = getLockPath(device, slot);
+        if(heldLocks.count(lockPath))
+            continue;
+
+        ++nbSlots;
+        try
+        {
+            // the file lock needs an existing file
+            std::ofstream(lockPath, std::ios::app);
+
+            std::unique_ptr<boost::interprocess::file_lock> fileLock(new boost::interprocess::file_lock(lockPath.c_str()));
+            if(fileLock->try_lock())
+            {
+                heldLocks.insert(lockPath);
+                _reservations.push_back({device.id, lockPath, std::move(fileLock)});
+                return true;
+            }
+        }
+        catch(const boost::interprocess::interprocess_exception& e)
+        {
+            ALICEVISION_LOG_WARNING("Cannot lock '" << lockPath << "': " << e.what());
+            ++nbErrors;
+        }
+    }
+    lockError = (nbSlots > 0 && nbErrors == nbSlots);
+    return false;
+}
+
+std::string GpuResourceManager::getLockPath(const GpuDevice& device, int slot) const
+{
+    std::string deviceName = device.pciBusId;
+    std::replace_if(deviceName.begin(), deviceName.end(), [](char c) { return c == ':' || c == '.'; }, '_');
+    return (bfs::path(_lockFolder) / ("gpu_" + deviceName + "_" + std::to_string(slot) + ".lock")).string();
+}
+
+int GpuResourceManager::getNbJobs(const GpuDevice& device) const
+{
+    std::lock_guard<std::mutex> lock(heldLocksMutex);
+    int nbJobs = 0;
+    for(int slot = 0; slot < _maxJobsPerDevice; ++slot)
+    {
+        const std::string lockPath = getLockPath(device, slot);
+        if(heldLocks.count(lockPath))
+        {
+            ++nbJobs;
+            continue;
+        }
+        if(!bfs::exists(lockPath))
+            continue;
+
+        try
+        {
+            boost::interprocess::file_lock fileLock(lockPath.c_str());
+            if(fileLock.try_lock())
+                fileLock.unlock();
+            else
+                ++nbJobs;
+        }
+        catch(const boost::interprocess::interprocess_exception&)
+        {
+            ++nbJobs;
+        }
+    }
+    return nbJobs;
+}
+
+} // namespace gpu
+} // namespace aliceVision
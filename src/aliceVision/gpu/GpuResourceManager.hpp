@@ -0,0 +1,115 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/system/hardwareContext.hpp>
+
+#include <boost/interprocess/sync/file_lock.hpp>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace gpu {
+
+/**
+ * @brief Resources of a CUDA device
+ */
+struct GpuDevice
+{
+    /// CUDA device index in this process
+    int id = -1;
+    std::string name;
+    /// PCI location, identifies the device in all the processes (whatever CUDA_VISIBLE_DEVICES)
+    std::string pciBusId;
+    /// total and free device memory in MB
+    int totalMemory = 0;
+    int freeMemory = 0;
+    /// number of jobs of all the processes running on the device
+    int nbJobs = 0;
+};
+
+/**
+ * @brief Share the CUDA devices of the machine between the processes.
+ *
+ * Each device has a number of job slots, each slot is an exclusive file lock shared by all the processes
+ * of the machine. A process reserves a device by locking one of its slots, so several pipeline nodes running
+ * at the same time partition the devices instead of all using the first one.
+ * The locks are released when the reservation is released, or by the system when the process ends.
+ */
+class GpuResourceManager
+{
+public:
+    /// List the devices of the machine, without their number of jobs
+    using DevicesLister = std::function<std::vector<GpuDevice>()>;
+
+    /**
+     * @param[in] maxJobsPerDevice maximum number of jobs of all the processes on a device
+     * @param[in] lockFolder folder of the lock files shared by the processes, empty for the system temporary folder
+     * @param[in] listDevices list the devices of the machine, the CUDA devices if empty
+     */
+    explicit GpuResourceManager(int maxJobsPerDevice = 1, const std::string& lockFolder = "", DevicesLister listDevices = DevicesLister());
+
+    /// @param[in] hContext the hardware context with the user limits (maximum number of jobs per device)
+    explicit GpuResourceManager(const HardwareContext& hContext);
+
+    GpuResourceManager(const GpuResourceManager&) = delete;
+    GpuResourceManager& operator=(const GpuResourceManager&) = delete;
+
+    /// Release the reserved devices
+    ~GpuResourceManager();
+
+    /**
+     * @brief Get the CUDA devices with their free memory and their number of jobs
+     * @return the devices, empty without CUDA
+     */
+    std::vector<GpuDevice> getDevices() const;
+
+    /**
+     * @brief Reserve a slot on up to nbDevices devices, the devices with the fewest jobs and the most free memory first.
+     *        It waits while all the devices are full, unless no device has enough memory or the lock files cannot be created.
+     * @param[in] nbDevices the maximum number of devices, 0 for all the devices
+     * @param[in] minFreeMemory the minimum free memory (MB) of a device
+     * @param[in] maxWaitTime the maximum time (s) waiting for a device, negative to wait until a device is released
+     * @return the CUDA indexes of the reserved devices, empty if no device can be used
+     */
+    std::vector<int> acquireDevices(int nbDevices, int minFreeMemory = 0, double maxWaitTime = -1.0);
+
+    /// Release the reserved devices
+    void releaseDevices();
+
+private:
+    struct Reservation
+    {
+        int deviceId;
+        std::string lockPath;
+        std::unique_ptr<boost::interprocess::file_lock> lock;
+    };
+
+    /**
+     * @brief Try to reserve a slot of the device
+     * @param[in] device the device
+     * @param[out] lockError true if no lock file of the device can be created or locked
+     * @return true if a slot is reserved
+     */
+    bool tryAcquire(const GpuDevice& device, bool& lockError);
+
+    std::string getLockPath(const GpuDevice& device, int slot) const;
+
+    /// Number of slots of the device locked by any process
+    int getNbJobs(const GpuDevice& device) const;
+
+    const int _maxJobsPerDevice;
+    std::string _lockFolder;
+    DevicesLister _listDevices;
+    std::vector<Reservation> _reservations;
+};
+
+} // namespace gpu
+} // namespace aliceVision
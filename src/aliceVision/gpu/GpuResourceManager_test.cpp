@@ -0,0 +1,119 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/gpu/GpuResourceManager.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#define BOOST_TEST_MODULE gpuResourceManager
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::gpu;
+
+namespace {
+
+/// two devices of 8 GB, the second one with less free memory
+std::vector<GpuDevice> listTestDevices()
+{
+    std::vector<GpuDevice> devices(2);
+    for(int i = 0; i < 2; ++i)
+    {
+        devices[i].id = i;
+        devices[i].name = "test device " + std::to_string(i);
+        devices[i].pciBusId = "0000:0" + std::to_string(i) + ":00.0";
+        devices[i].totalMemory = 8192;
+        devices[i].freeMemory = 8192 - 1024 * i;
+    }
+    return devices;
+}
+
+struct LockFolder
+{
+    LockFolder()
+      : path((boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string())
+    {}
+    ~LockFolder() { boost::filesystem::remove_all(path); }
+
+    const std::string path;
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(gpuResourceManager_acquireRelease)
+{
+    const LockFolder lockFolder;
+    GpuResourceManager managerA(1, lockFolder.path, listTestDevices);
+    GpuResourceManager managerB(1, lockFolder.path, listTestDevices);
+
+    // the device with the most free memory first
+    const std::vector<int> devicesA = managerA.acquireDevices(1);
+    BOOST_REQUIRE_EQUAL(devicesA.size(), 1);
+    BOOST_CHECK_EQUAL(devicesA.front(), 0);
+
+    // the least used device first
+    const std::vector<int> devicesB = managerB.acquireDevices(1);
+    BOOST_REQUIRE_EQUAL(devicesB.size(), 1);
+    BOOST_CHECK_EQUAL(devicesB.front(), 1);
+
+    for(const GpuDevice& device : managerA.getDevices())
+        BOOST_CHECK_EQUAL(device.nbJobs, 1);
+
+    // all the devices are full
+    GpuResourceManager managerC(1, lockFolder.path, listTestDevices);
+    BOOST_CHECK(managerC.acquireDevices(0, 0, 0.0).empty());
+
+    managerA.releaseDevices();
+    const std::vector<int> devicesC = managerC.acquireDevices(0, 0, 0.0);
+    BOOST_REQUIRE_EQUAL(devicesC.size(), 1);
+    BOOST_CHECK_EQUAL(devicesC.front(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(gpuResourceManager_jobsPerDevice)
+{
+    const LockFolder lockFolder;
+    GpuResourceManager managerA(2, lockFolder.path, listTestDevices);
+    GpuResourceManager managerB(2, lockFolder.path, listTestDevices);
+    GpuResourceManager managerC(2, lockFolder.path, listTestDevices);
+
+    BOOST_CHECK_EQUAL(managerA.acquireDevices(0).size(), 2);
+    BOOST_CHECK_EQUAL(managerB.acquireDevices(0).size(), 2);
+    BOOST_CHECK(managerC.acquireDevices(0, 0, 0.0).empty());
+
+    for(const GpuDevice& device : managerC.getDevices())
+        BOOST_CHECK_EQUAL(device.nbJobs, 2);
+}
+
+BOOST_AUTO_TEST_CASE(gpuResourceManager_noDevice)
+{
+    const LockFolder lockFolder;
+
+    // no device with enough memory: no wait
+    GpuResourceManager manager(1, lockFolder.path, listTestDevices);
+    BOOST_CHECK(manager.acquireDevices(1, 16384).empty());
+
+    // no device at all
+    GpuResourceManager emptyManager(1, lockFolder.path, []() { return std::vector<GpuDevice>(); });
+    BOOST_CHECK(emptyManager.getDevices().empty());
+    BOOST_CHECK(emptyManager.acquireDevices(1).empty());
+}
+
+BOOST_AUTO_TEST_CASE(gpuResourceManager_lockError)
+{
+    // the lock files cannot be created in a regular file: no wait
+    const LockFolder lockFolder;
+    boost::filesystem::create_directories(lockFolder.path);
+    const std::string notAFolder = (boost::filesystem::path(lockFolder.path) / "file").string();
+    std::ofstream(notAFolder) << "not a folder";
+
+    GpuResourceManager manager(1, notAFolder, listTestDevices);
+    BOOST_CHECK(manager.acquireDevices(1).empty());
+}
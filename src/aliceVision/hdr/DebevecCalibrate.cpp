@@ -14,9 +14,12 @@
 
 #include <OpenImageIO/imagebufalgo.h>
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <cassert>
+#include <map>
+#include <utility>
 
 
 namespace aliceVision {
@@ -32,7 +35,6 @@ bool DebevecCalibrate::process(const std::vector<std::vector<ImageSample>>& ldrS
 
 
     // Count really extracted amount of points (observed in multiple brackets)
-    std::vector<size_t> countPointPerGroup;
     size_t totalPoints = 0;
     for(size_t groupId = 0; groupId < ldrSamples.size(); groupId++)
     {
@@ -45,60 +47,89 @@ bool DebevecCalibrate::process(const std::vector<std::vector<ImageSample>>& ldrS
     // Initialize response
     response = rgbCurve(channelQuantization);
 
-    // Store intermediate data for all three channels
-
-    // Initialize intermediate buffers
-    for(unsigned int channel = 0; channel < channelsCount; ++channel)
+    #pragma omp parallel for
+    for(int channel = 0; channel < int(channelsCount); ++channel)
     {
-        Eigen::MatrixXd A(channelQuantization, channelQuantization);
-        Eigen::MatrixXd B(channelQuantization, totalPoints);
-        Eigen::DiagonalMatrix<double, Eigen::Dynamic> Dinv(totalPoints);
-        Eigen::VectorXd h1(channelQuantization);
-        Eigen::VectorXd h2(totalPoints);
-
-        // Initialize
-        A.fill(0);
-        B.fill(0);
-        h1.fill(0);
-        h2.fill(0);
-        Dinv.setZero();
-
-        size_t countPoints = 0;
+        // A point is only described by its observations (log exposure, quantized value),
+        // so the points with the same observations are merged and weighted by their count.
+        std::map<std::vector<std::pair<float, std::size_t>>, std::size_t> uniquePoints;
+        std::vector<std::pair<float, std::size_t>> observations;
+
         for(size_t groupId = 0; groupId < ldrSamples.size(); groupId++)
         {
-            /*Process a group of brackets*/
-            const std::vector<ImageSample>& group = ldrSamples[groupId];
-            const std::vector<double> & local_times = times[groupId];
-
-            for (size_t sampleId = 0; sampleId < group.size(); sampleId++) {
-                
-                const ImageSample & sample = group[sampleId];
-                
-                for (size_t bracketPos = 0; bracketPos < sample.descriptions.size(); bracketPos++) {
-                    
-                    const float time = std::log(sample.descriptions[bracketPos].exposure);
-
-                    const float value = clamp(sample.descriptions[bracketPos].mean(channel), 0.0f, 1.0f);
+            for(const ImageSample & sample : ldrSamples[groupId])
+            {
+                observations.clear();
+                for(const PixelDescription & description : sample.descriptions)
+                {
+                    const float value = clamp(description.mean(channel), 0.0f, 1.0f);
                     const std::size_t quantizedValue = std::round(value * (channelQuantization - 1));
-                    const std::size_t index = quantizedValue;
-
-                    const float w_ij = std::max(1e-6f, weight(value, channel));
-                    
-                    const std::size_t pospoint = countPoints + sampleId;
-
-                    const double w_ij_2 = w_ij * w_ij;
-                    const double w_ij2_time = w_ij_2 * time;
+                    observations.emplace_back(std::log(description.exposure), quantizedValue);
+                }
+                ++uniquePoints[observations];
+            }
+        }
 
-                    Dinv.diagonal()[pospoint] += w_ij_2;
-                    A(index, index) += w_ij_2;
-                    B(index, pospoint) -= w_ij_2;
-                    h1(index) += w_ij2_time;
-                    h2(pospoint) += -w_ij2_time;
+        // The unknowns are the response curve and the log irradiance of each point.
+        // The normal equations are:
+        //
+        // [A  B] [x ] = [h1]
+        // [Bt D] [le]   [h2]
+        //
+        // with D diagonal, so the points are eliminated with the Schur complement:
+        // (A - B D^-1 Bt) x = h1 - B D^-1 h2
+        // The contribution of a point only involves the few curve values it observes,
+        // it is directly accumulated in the reduced system.
+        Eigen::MatrixXd left = Eigen::MatrixXd::Zero(channelQuantization, channelQuantization);
+        Eigen::VectorXd right = Eigen::VectorXd::Zero(channelQuantization);
+
+        std::vector<std::size_t> indices;
+        std::vector<double> b;
+        for(const auto & uniquePoint : uniquePoints)
+        {
+            const double count = double(uniquePoint.second);
+
+            indices.clear();
+            b.clear();
+            double d = 0.0;
+            double h2 = 0.0;
+
+            for(const auto & observation : uniquePoint.first)
+            {
+                const float time = observation.first;
+                const std::size_t index = observation.second;
+
+                const float w_ij = std::max(1e-6f, weight.getValue(index, channel));
+                const double w_ij_2 = count * w_ij * w_ij;
+                const double w_ij2_time = w_ij_2 * time;
+
+                d += w_ij_2;
+                left(index, index) += w_ij_2;
+                right(index) += w_ij2_time;
+                h2 -= w_ij2_time;
+
+                // B is stored as (index, value) pairs, observations of the same value are summed
+                const auto it = std::find(indices.begin(), indices.end(), index);
+                if(it == indices.end())
+                {
+                    indices.push_back(index);
+                    b.push_back(-w_ij_2);
+                }
+                else
+                {
+                    b[it - indices.begin()] -= w_ij_2;
                 }
             }
 
-            countPoints += group.size();
-            
+            const double dinv = 1.0 / d;
+            for(std::size_t i = 0; i < indices.size(); ++i)
+            {
+                right(indices[i]) -= b[i] * dinv * h2;
+                for(std::size_t j = 0; j < indices.size(); ++j)
+                {
+                    left(indices[i], indices[j]) -= b[i] * dinv * b[j];
+                }
+            }
         }
 
         // Make sure the discrete response curve has a minimal second derivative
@@ -112,17 +143,17 @@ bool DebevecCalibrate::process(const std::vector<std::vector<ImageSample>>& ldrS
             const double v2 = -2.0f * lambda * w;
             const double v3 = lambda * w;
 
-            A(k, k) += v1 * v1;
-            A(k, k + 1) += v1 * v2;
-            A(k, k + 2) += v1 * v3;
+            left(k, k) += v1 * v1;
+            left(k, k + 1) += v1 * v2;
+            left(k, k + 2) += v1 * v3;
 
-            A(k + 1, k) += v2 * v1;
-            A(k + 1, k + 1) += v2 * v2;
-            A(k + 1, k + 2) += v2 * v3;
+            left(k + 1, k) += v2 * v1;
+            left(k + 1, k + 1) += v2 * v2;
+            left(k + 1, k + 2) += v2 * v3;
 
-            A(k + 2, k) += v3 * v1;
-            A(k + 2, k + 1) += v3 * v2;
-            A(k + 2, k + 2) += v3 * v3;
+            left(k + 2, k) += v3 * v1;
+            left(k + 2, k + 1) += v3 * v2;
+            left(k + 2, k + 2) += v3 * v3;
         }
 
         //
@@ -130,32 +161,10 @@ bool DebevecCalibrate::process(const std::vector<std::vector<ImageSample>>& ldrS
         // Enforce f(0.5) = 0.0
         //
         const size_t pos_middle = std::floor(channelQuantization / 2);
-        A(pos_middle, pos_middle) += 1.0f;
-
-        // M is
-        //
-        // [ATL ATR]   [[Mgradient       ][     0]]
-        // [ABL ABR] = [[constraintMiddle][     0]]
-        //             [Mleft               Mright]
-        //
-        // [A B] = [Atl Atr]^T [Atl Atr] = [Atl   0]^T [Atl   0]
-        // [C D]   [Abl Abr]   [Abl Abr]   [Abl Abr]   [Abl Abr]
-        // [A B] = [Atl^T Abl^T][Atl   0] = [Atl^TAtl + Abl^TAbl Abl^TAbr]
-        // [C D]   [0     Abr^T][Abl Abr]   [Abr^TAbl            Abr^TAbr]
-        // [h1] = [Atl^T bh + Abl^T bb] = [Abl^T bb]
-        // [h2]   [Atr^T bh + Abr^T bb]   [Abr^T bb]
-        const Eigen::MatrixXd C = B.transpose();
-
-        for(int i = 0; i < Dinv.rows(); i++)
-        {
-            Dinv.diagonal()[i] = 1.0 / Dinv.diagonal()[i];
-        }
-
-        const Eigen::MatrixXd Bdinv = B * Dinv;
-        const Eigen::MatrixXd left = A - Bdinv * C;
-        const Eigen::VectorXd right = h1 - Bdinv * h2;
+        left(pos_middle, pos_middle) += 1.0f;
 
-        const Eigen::VectorXd x = left.lu().solve(right);
+        // The reduced system is symmetric positive definite
+        const Eigen::VectorXd x = left.ldlt().solve(right);
 
         // Copy the result to the response curve
         for(std::size_t k = 0; k < channelQuantization; ++k)
@@ -44,6 +44,16 @@ void GrossbergCalibrate::process(const std::vector<std::vector<ImageSample>>& ld
     // f0(Ba) + sum(c_i * f_i(Ba)) - k*f0(Bb) - k*sum(c_i * f_i(Bb)) = 0
     // sum(c_i * f_i(Ba)) - k*sum(c_i * f_i(Bb)) = k*f0(Bb) - f0(Ba)
 
+    // The curves are the same for the three channels, they are built once
+    rgbCurve f0(channelQuantization);
+    f0.setEmorInv(0);
+
+    std::vector<rgbCurve> fdims(_dimension, rgbCurve(channelQuantization));
+    for(size_t dim = 0; dim < _dimension; dim++)
+    {
+        fdims[dim].setEmorInv(dim + 1);
+    }
+
     size_t count_measures = 0;
     for(size_t group = 0; group < ldrSamples.size(); group++)
     {
@@ -54,50 +64,50 @@ void GrossbergCalibrate::process(const std::vector<std::vector<ImageSample>>& ld
         }
     }
 
-    for(int channel = 0; channel < 3; channel++)
-    {
-        Eigen::MatrixXd E(count_measures, _dimension);
-        Eigen::MatrixXd v(count_measures, 1);
+    ALICEVISION_LOG_INFO("Grossberg calibration with " << count_measures << " measures.");
 
-        rgbCurve f0(channelQuantization);
-        f0.setEmorInv(0);
+    #pragma omp parallel for
+    for(int channel = 0; channel < int(channels); channel++)
+    {
+        // The least squares system E c = -v has one row per measure,
+        // only its normal equations are accumulated: H = Et E and d = Et v
+        Eigen::MatrixXd H = Eigen::MatrixXd::Zero(_dimension, _dimension);
+        Eigen::VectorXd d = Eigen::VectorXd::Zero(_dimension);
+        Eigen::VectorXd row(_dimension);
 
-        for(size_t dim = 0; dim < _dimension; dim++)
+        for(size_t groupId = 0; groupId < ldrSamples.size(); groupId++)
         {
-            rgbCurve fdim(channelQuantization);
-            fdim.setEmorInv(dim + 1);
+            const std::vector<ImageSample>& groupSamples = ldrSamples[groupId];
 
-            size_t rowId = 0;
-            for(size_t groupId = 0; groupId < ldrSamples.size(); groupId++)
+            for(size_t sampleId = 0; sampleId < groupSamples.size(); sampleId++)
             {
-                const std::vector<ImageSample>& groupSamples = ldrSamples[groupId];
+                const ImageSample & sample = groupSamples[sampleId];
 
-                for(size_t sampleId = 0; sampleId < groupSamples.size(); sampleId++)
+                for(size_t bracketPos = 0; bracketPos < sample.descriptions.size() - 1; bracketPos++)
                 {
-                    const ImageSample & sample = groupSamples[sampleId];
+                    image::Rgb<float> Ba = sample.descriptions[bracketPos].mean;
+                    image::Rgb<float> Bb = sample.descriptions[bracketPos + 1].mean;
 
-                    for(size_t bracketPos = 0; bracketPos < sample.descriptions.size() - 1; bracketPos++)
-                    {
-                        image::Rgb<float> Ba = sample.descriptions[bracketPos].mean;
-                        image::Rgb<float> Bb = sample.descriptions[bracketPos + 1].mean;
-
-                        const double k = sample.descriptions[bracketPos].exposure / sample.descriptions[bracketPos + 1].exposure;
+                    const double k = sample.descriptions[bracketPos].exposure / sample.descriptions[bracketPos + 1].exposure;
 
-                        float valA = Ba(channel);
-                        float valB = Bb(channel);
+                    float valA = Ba(channel);
+                    float valB = Bb(channel);
 
-                        E(rowId, dim) = fdim(valA, 0) - k * fdim(valB, 0);
-                        v(rowId, 0) = f0(valA, 0) - k * f0(valB, 0);
-                        rowId++;
+                    for(size_t dim = 0; dim < _dimension; dim++)
+                    {
+                        row(dim) = fdims[dim](valA, 0) - k * fdims[dim](valB, 0);
                     }
+                    const double v = f0(valA, 0) - k * f0(valB, 0);
+
+                    H.selfadjointView<Eigen::Lower>().rankUpdate(row);
+                    d += v * row;
                 }
             }
         }
+        H.triangularView<Eigen::StrictlyUpper>() = H.transpose();
 
         // Get first linear solution
-        Eigen::VectorXd c = (E.transpose() * E).inverse() * E.transpose() * -v;
-        Eigen::MatrixXd H = E.transpose() * E;
-        Eigen::VectorXd d = (E.transpose() * v).col(0);
+        Eigen::VectorXd c = H.ldlt().solve(-d);
 
 
         // d (f0(val) + sum_i(c_i * f_i(val))) d_val > 0
@@ -122,8 +132,7 @@ void GrossbergCalibrate::process(const std::vector<std::vector<ImageSample>>& ld
 
         for(int dim = 0; dim < _dimension; dim++)
         {
-            rgbCurve fdim(channelQuantization);
-            fdim.setEmorInv(dim + 1);
+            const rgbCurve & fdim = fdims[dim];
 
             for(int i = 0; i < channelQuantization - 1; i++)
             {
@@ -154,17 +163,11 @@ void GrossbergCalibrate::process(const std::vector<std::vector<ImageSample>>& ld
         std::vector<float>& curve = response.getCurve(channel);
         for(unsigned int i = 0; i < curve.size(); ++i)
         {
-            rgbCurve f0(channelQuantization);
-            f0.setEmorInv(0);
-
             const double val = double(i) * step;
             double curve_val = f0(val, 0);
-            for(int d = 0; d < _dimension; d++)
+            for(int dim = 0; dim < _dimension; dim++)
             {
-
-                rgbCurve fdim(channelQuantization);
-                fdim.setEmorInv(d + 1);
-                curve_val += c(d) * fdim(val, 0);
+                curve_val += c(dim) * fdims[dim](val, 0);
             }
 
             curve[i] = curve_val;
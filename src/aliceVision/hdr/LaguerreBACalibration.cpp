@@ -14,6 +14,10 @@
 
 #include <ceres/ceres.h>
 
+#include <array>
+#include <cmath>
+#include <map>
+#include <tuple>
 #include <utility>
 #include <iostream>
 #include <cassert>
@@ -73,9 +77,10 @@ double d_laguerreFunction_d_x(double a, double x)
 class HdrResidualAnalytic : public ceres::SizedCostFunction<2, 1, 1>
 {
 public:
-    HdrResidualAnalytic(double a, double b)
+    HdrResidualAnalytic(double a, double b, double weight = 1.0)
         : _colorA(a)
         , _colorB(b)
+        , _weight(weight)
     {
     }
 
@@ -90,9 +95,9 @@ public:
         double errorCost_1 = laguerreFunction(laguerre_param, a) - _colorB;
         double errorCost_2 = laguerreFunction(laguerre_param, b) - _colorA;
 
-        residuals[0] = errorCost_1;
-        residuals[1] = errorCost_2;
- 
+        residuals[0] = _weight * errorCost_1;
+        residuals[1] = _weight * errorCost_2;
+
         if(jacobians == nullptr)
         {
             return true;
@@ -107,14 +112,14 @@ public:
                                                     d_laguerreFunction_d_x(laguerre_param, b) / ratio_expB_over_expA *
                                                         -d_laguerreFunction_d_param(-laguerre_param, _colorB);
 
-            jacobians[0][0] = d_errorCost_1_d_laguerre_param;
-            jacobians[0][1] = d_errorCost_2_d_laguerre_param;
+            jacobians[0][0] = _weight * d_errorCost_1_d_laguerre_param;
+            jacobians[0][1] = _weight * d_errorCost_2_d_laguerre_param;
         }
 
         if(jacobians[1] != nullptr)
         {
-            jacobians[1][0] = d_laguerreFunction_d_x(laguerre_param, a) * laguerreFunctionInv(laguerre_param, _colorA);
-            jacobians[1][1] = d_laguerreFunction_d_x(laguerre_param, b) * laguerreFunctionInv(laguerre_param, _colorB) *
+            jacobians[1][0] = _weight * d_laguerreFunction_d_x(laguerre_param, a) * laguerreFunctionInv(laguerre_param, _colorA);
+            jacobians[1][1] = _weight * d_laguerreFunction_d_x(laguerre_param, b) * laguerreFunctionInv(laguerre_param, _colorB) *
                               (-1.0 / (ratio_expB_over_expA * ratio_expB_over_expA));
         }
 
@@ -124,6 +129,16 @@ public:
 private:
     double _colorA;
     double _colorB;
+    /// Square root of the number of merged observations
+    double _weight;
+};
+
+/// Observations of a pair of consecutive brackets merged in a quantized cell
+struct MergedObservation
+{
+    double sumColorA = 0.0;
+    double sumColorB = 0.0;
+    std::size_t count = 0;
 };
 
 class ExposureConstraint : public ceres::SizedCostFunction<1, 1>
@@ -184,31 +199,60 @@ void LaguerreBACalibration::process(const std::vector<std::vector<ImageSample>>&
         problem.AddParameterBlock(&param.second, 1);
     }
 
-    // Convert selected samples into residual blocks
-    for(int groupId = 0; groupId < ldrSamples.size(); ++groupId)
-    {
-        const std::vector<ImageSample> & group = ldrSamples[groupId];
-
-        for (int sampleId = 0; sampleId < group.size(); sampleId++) {
-
-            const ImageSample & sample = group[sampleId];
-
-            for (int bracketPos = 0; bracketPos < sample.descriptions.size() - 1; bracketPos++) {
-                
-                std::pair<double, double> exposurePair;
-                exposurePair.first = sample.descriptions[bracketPos].exposure;
-                exposurePair.second = sample.descriptions[bracketPos + 1].exposure;
+    // The observations of each channel are merged per exposure pair and quantized colors,
+    // so the problem has one residual block per cell instead of one per observation.
+    using ObservationKey = std::tuple<double, double, int, int>;
+    std::array<std::map<ObservationKey, MergedObservation>, 3> mergedObservations;
 
-                double * expParam = &exposureParameters[exposurePair];
+    #pragma omp parallel for
+    for(int channel = 0; channel < 3; channel++)
+    {
+        std::map<ObservationKey, MergedObservation> & observations = mergedObservations[channel];
 
-                for (int channel = 0; channel < 3; channel++) {
-                    ceres::CostFunction * cost = new HdrResidualAnalytic(sample.descriptions[bracketPos].mean(channel), sample.descriptions[bracketPos + 1].mean(channel));
-                    problem.AddResidualBlock(cost, lossFunction, &(laguerreParam.data()[channel]), expParam);
+        for(const std::vector<ImageSample> & group : ldrSamples)
+        {
+            for(const ImageSample & sample : group)
+            {
+                for(int bracketPos = 0; bracketPos < int(sample.descriptions.size()) - 1; bracketPos++)
+                {
+                    const PixelDescription & descA = sample.descriptions[bracketPos];
+                    const PixelDescription & descB = sample.descriptions[bracketPos + 1];
+                    const double colorA = descA.mean(channel);
+                    const double colorB = descB.mean(channel);
+
+                    const ObservationKey key(descA.exposure, descB.exposure,
+                                             int(std::round(colorA * (channelQuantization - 1))),
+                                             int(std::round(colorB * (channelQuantization - 1))));
+
+                    MergedObservation & observation = observations[key];
+                    observation.sumColorA += colorA;
+                    observation.sumColorB += colorB;
+                    ++observation.count;
                 }
             }
         }
     }
 
+    // Convert merged observations into residual blocks
+    std::size_t nbObservations = 0;
+    for(int channel = 0; channel < 3; channel++)
+    {
+        for(const auto & observation : mergedObservations[channel])
+        {
+            const std::pair<double, double> exposurePair(std::get<0>(observation.first), std::get<1>(observation.first));
+            double * expParam = &exposureParameters[exposurePair];
+
+            const MergedObservation & merged = observation.second;
+            ceres::CostFunction * cost = new HdrResidualAnalytic(merged.sumColorA / merged.count, merged.sumColorB / merged.count,
+                                                                 std::sqrt(double(merged.count)));
+            problem.AddResidualBlock(cost, lossFunction, &(laguerreParam.data()[channel]), expParam);
+            nbObservations += merged.count;
+        }
+    }
+
+    ALICEVISION_LOG_INFO("Laguerre calibration with " << nbObservations << " observations merged in "
+                         << problem.NumResidualBlocks() << " residual blocks.");
+
     if(!refineExposures)
     {
         for(auto& param : exposureParameters)
@@ -234,6 +278,7 @@ void LaguerreBACalibration::process(const std::vector<std::vector<ImageSample>>&
     solverOptions.use_inner_iterations = true;
     solverOptions.use_nonmonotonic_steps = false;
     solverOptions.max_num_iterations = 100;
+    solverOptions.num_threads = omp_get_max_threads();
     solverOptions.function_tolerance = 1e-16;
     solverOptions.parameter_tolerance = 1e-16;
 
@@ -157,10 +157,19 @@ void hdrMerge::postProcessHighlight(const std::vector< image::Image<image::RGBfC
     assert(!images.empty());
     assert(images.size() == times.size());
 
+    postProcessHighlight(images.front(), radiance, targetCameraExposure, highlightCorrectionFactor, highlightTargetLux);
+}
+
+void hdrMerge::postProcessHighlight(const image::Image<image::RGBfColor> &shortestExposure,
+    image::Image<image::RGBfColor> &radiance,
+    float targetCameraExposure,
+    float highlightCorrectionFactor,
+    float highlightTargetLux)
+{
     if (highlightCorrectionFactor == 0.0f)
         return;
 
-    const image::Image<image::RGBfColor>& inputImage = images.front();
+    const image::Image<image::RGBfColor>& inputImage = shortestExposure;
     // Target Camera Exposure = 1 for EV-0 (iso=100, shutter=1, fnumber=1) => 2.5 lux
     float highlightTarget = highlightTargetLux * targetCameraExposure * 2.5;
 
@@ -221,5 +230,102 @@ void hdrMerge::postProcessHighlight(const std::vector< image::Image<image::RGBfC
     }
 }
 
+hdrIncrementalMerge::hdrIncrementalMerge(const rgbCurve &weight, const rgbCurve &response, std::size_t nbExposures)
+  : _weight(weight)
+  , _weightShortestExposure(weight)
+  , _weightLongestExposure(weight)
+  , _response(response)
+  , _nbExposures(nbExposures)
+{
+  assert(!response.isEmpty());
+  assert(nbExposures > 0);
+
+  _weightShortestExposure.freezeSecondPartValues();
+  _weightLongestExposure.freezeFirstPartValues();
+}
+
+const rgbCurve &hdrIncrementalMerge::getWeight(std::size_t exposureIndex) const
+{
+  if(exposureIndex == 0)
+    return _weightShortestExposure;
+  if(exposureIndex == _nbExposures - 1)
+    return _weightLongestExposure;
+  return _weight;
+}
+
+void hdrIncrementalMerge::add(const image::Image<image::RGBfColor> &image, std::size_t exposureIndex, double time)
+{
+  assert(exposureIndex < _nbExposures);
+
+  const std::size_t width = image.Width();
+  const std::size_t height = image.Height();
+
+  if(_wsum.size() == 0)
+  {
+    _wsum.resize(width, height, true, image::RGBfColor(0.f, 0.f, 0.f));
+    _wdiv.resize(width, height, true, image::RGBfColor(0.f, 0.f, 0.f));
+  }
+  else if(_wsum.Width() != width || _wsum.Height() != height)
+  {
+    ALICEVISION_THROW_ERROR("[hdrMerge] The bracket " << exposureIndex << " size (" << width << "x" << height
+                            << ") differs from the previous brackets (" << _wsum.Width() << "x" << _wsum.Height() << ").");
+  }
+
+  ALICEVISION_LOG_TRACE("[hdrMerge] Accumulate " << width << "x" << height << ", time: " << time);
+
+  // with a single bracket, it is both the shortest and the longest exposure
+  std::vector<const rgbCurve*> weights;
+  weights.push_back(&getWeight(exposureIndex));
+  if(_nbExposures == 1)
+    weights.push_back(&_weightLongestExposure);
+
+  #pragma omp parallel for
+  for(int y = 0; y < height; ++y)
+  {
+    for(int x = 0; x < width; ++x)
+    {
+      const image::RGBfColor &color = image(y, x);
+      image::RGBfColor &wsum = _wsum(y, x);
+      image::RGBfColor &wdiv = _wdiv(y, x);
+
+      for(std::size_t channel = 0; channel < 3; ++channel)
+      {
+        const double value = color(channel);
+        const double r = _response(value, channel);
+
+        for(const rgbCurve *weight : weights)
+        {
+          const double w = std::max(0.001f, (*weight)(value, channel));
+          wsum(channel) += w * r / time;
+          wdiv(channel) += w;
+        }
+      }
+    }
+  }
+}
+
+void hdrIncrementalMerge::finalize(image::Image<image::RGBfColor> &radiance, float targetCameraExposure)
+{
+  // the radiance is computed in place in the accumulation buffer
+  #pragma omp parallel for
+  for(int y = 0; y < _wsum.Height(); ++y)
+  {
+    for(int x = 0; x < _wsum.Width(); ++x)
+    {
+      image::RGBfColor &wsum = _wsum(y, x);
+      const image::RGBfColor &wdiv = _wdiv(y, x);
+
+      for(std::size_t channel = 0; channel < 3; ++channel)
+      {
+        wsum(channel) = double(wsum(channel)) / std::max(0.001, double(wdiv(channel))) * targetCameraExposure;
+      }
+    }
+  }
+
+  radiance.swap(_wsum);
+  _wsum = image::Image<image::RGBfColor>();
+  _wdiv = image::Image<image::RGBfColor>();
+}
+
 } // namespace hdr
 } // namespace aliceVision
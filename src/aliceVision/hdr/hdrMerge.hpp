@@ -40,6 +40,58 @@ public:
       float targetCameraExposure,
       float highlightMaxLumimance);
 
+  /**
+   * @brief Highlight correction from the shortest exposure only
+   * @see postProcessHighlight
+   */
+  void postProcessHighlight(const image::Image<image::RGBfColor> &shortestExposure,
+      image::Image<image::RGBfColor> &radiance,
+      float targetCameraExposure,
+      float highlightCorrectionFactor,
+      float highlightTargetLux);
+
+};
+
+/**
+ * @brief Merge the brackets one at a time, with the same weighting as hdrMerge::process.
+ *
+ * The weighted radiance of each bracket is accumulated as soon as it is loaded,
+ * so the memory does not grow with the number of brackets.
+ */
+class hdrIncrementalMerge {
+public:
+
+  /**
+   * @param weight the fusion weight curve
+   * @param response the camera response curve
+   * @param nbExposures the number of brackets, sorted from the shortest exposure
+   */
+  hdrIncrementalMerge(const rgbCurve &weight, const rgbCurve &response, std::size_t nbExposures);
+
+  /**
+   * @brief Accumulate a bracket, all the brackets must have the same size
+   * @param image the bracket image
+   * @param exposureIndex the index of the bracket, from the shortest exposure
+   * @param time the bracket exposure
+   */
+  void add(const image::Image<image::RGBfColor> &image, std::size_t exposureIndex, double time);
+
+  /**
+   * @brief Compute the radiance from the accumulated brackets and reset the accumulation
+   */
+  void finalize(image::Image<image::RGBfColor> &radiance, float targetCameraExposure);
+
+private:
+  const rgbCurve &getWeight(std::size_t exposureIndex) const;
+
+  rgbCurve _weight;
+  rgbCurve _weightShortestExposure;
+  rgbCurve _weightLongestExposure;
+  const rgbCurve &_response;
+  const std::size_t _nbExposures;
+
+  image::Image<image::RGBfColor> _wsum;
+  image::Image<image::RGBfColor> _wdiv;
 };
 
 } // namespace hdr
@@ -0,0 +1,78 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#define BOOST_TEST_MODULE hdr_merge
+
+#include "hdrMerge.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <random>
+
+using namespace aliceVision;
+
+BOOST_AUTO_TEST_CASE(hdr_incrementalMerge)
+{
+    const size_t quantization = pow(2, 10);
+    const int width = 67;
+    const int height = 41;
+
+    hdr::rgbCurve weight(quantization);
+    weight.setFunction(hdr::EFunctionType::GAUSSIAN);
+    hdr::rgbCurve response(quantization);
+    response.setGamma();
+
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+
+    for(int nbExposures = 1; nbExposures <= 5; nbExposures++)
+    {
+        std::vector<image::Image<image::RGBfColor>> images(nbExposures);
+        std::vector<double> times(nbExposures);
+        for(int i = 0; i < nbExposures; i++)
+        {
+            times[i] = std::pow(4.0, i) / 100.0;
+            images[i].resize(width, height);
+            for(int y = 0; y < height; y++)
+            {
+                for(int x = 0; x < width; x++)
+                {
+                    images[i](y, x) = image::RGBfColor(distribution(generator), distribution(generator), distribution(generator));
+                }
+            }
+        }
+
+        hdr::hdrMerge merge;
+        image::Image<image::RGBfColor> expected;
+        merge.process(images, times, weight, response, expected, 1.0f);
+
+        hdr::hdrIncrementalMerge incrementalMerge(weight, response, nbExposures);
+        for(int i = 0; i < nbExposures; i++)
+        {
+            incrementalMerge.add(images[i], i, times[i]);
+        }
+        image::Image<image::RGBfColor> radiance;
+        incrementalMerge.finalize(radiance, 1.0f);
+
+        BOOST_REQUIRE_EQUAL(radiance.Width(), width);
+        BOOST_REQUIRE_EQUAL(radiance.Height(), height);
+
+        double maxRelativeDiff = 0.0;
+        for(int y = 0; y < height; y++)
+        {
+            for(int x = 0; x < width; x++)
+            {
+                for(int c = 0; c < 3; c++)
+                {
+                    const double diff = std::abs(radiance(y, x)(c) - expected(y, x)(c));
+                    maxRelativeDiff = std::max(maxRelativeDiff, diff / std::max(1e-6, double(std::abs(expected(y, x)(c)))));
+                }
+            }
+        }
+
+        BOOST_CHECK_SMALL(maxRelativeDiff, 1e-5);
+    }
+}
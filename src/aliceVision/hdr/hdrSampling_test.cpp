@@ -0,0 +1,92 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#define BOOST_TEST_MODULE hdr_sampling
+
+#include "sampling.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <fstream>
+#include <random>
+
+using namespace aliceVision;
+
+namespace fs = boost::filesystem;
+
+BOOST_AUTO_TEST_CASE(hdr_samplesWriteRead)
+{
+    std::mt19937 generator(3);
+    std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+
+    std::vector<hdr::ImageSample> samples(100);
+    for(std::size_t i = 0; i < samples.size(); ++i)
+    {
+        hdr::ImageSample& sample = samples[i];
+        sample.x = i * 3;
+        sample.y = i * 7 + 1;
+        sample.descriptions.resize(i % 5);
+        for(std::size_t d = 0; d < sample.descriptions.size(); ++d)
+        {
+            hdr::PixelDescription& p = sample.descriptions[d];
+            p.srcId = IndexT(d * 10 + i);
+            p.exposure = distribution(generator);
+            p.mean = image::Rgb<float>(distribution(generator), distribution(generator), distribution(generator));
+            p.variance = image::Rgb<float>(distribution(generator), distribution(generator), distribution(generator));
+        }
+    }
+
+    const std::string path = (fs::temp_directory_path() / fs::unique_path()).string() + ".dat";
+    BOOST_REQUIRE(hdr::writeSamples(path, samples));
+
+    std::vector<hdr::ImageSample> readSamples;
+    BOOST_REQUIRE(hdr::readSamples(path, readSamples));
+
+    BOOST_REQUIRE_EQUAL(readSamples.size(), samples.size());
+    for(std::size_t i = 0; i < samples.size(); ++i)
+    {
+        BOOST_CHECK_EQUAL(readSamples[i].x, samples[i].x);
+        BOOST_CHECK_EQUAL(readSamples[i].y, samples[i].y);
+        BOOST_REQUIRE_EQUAL(readSamples[i].descriptions.size(), samples[i].descriptions.size());
+        for(std::size_t d = 0; d < samples[i].descriptions.size(); ++d)
+        {
+            const hdr::PixelDescription& a = samples[i].descriptions[d];
+            const hdr::PixelDescription& b = readSamples[i].descriptions[d];
+            BOOST_CHECK_EQUAL(a.srcId, b.srcId);
+            BOOST_CHECK_EQUAL(a.exposure, b.exposure);
+            for(int c = 0; c < 3; ++c)
+            {
+                BOOST_CHECK_EQUAL(a.mean(c), b.mean(c));
+                BOOST_CHECK_EQUAL(a.variance(c), b.variance(c));
+            }
+        }
+    }
+
+    // a truncated file is rejected
+    fs::resize_file(path, fs::file_size(path) - 1);
+    BOOST_CHECK(!hdr::readSamples(path, readSamples));
+
+    fs::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(hdr_samplesReadInvalidSize)
+{
+    // a huge number of samples in a small file is rejected before the allocation
+    const std::string path = (fs::temp_directory_path() / fs::unique_path()).string() + ".dat";
+    {
+        std::ofstream file(path, std::ios::binary);
+        const std::size_t size = std::size_t(1) << 60;
+        file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        const std::size_t zeros[3] = {0, 0, 0};
+        file.write(reinterpret_cast<const char*>(zeros), sizeof(zeros));
+    }
+
+    std::vector<hdr::ImageSample> samples;
+    BOOST_CHECK(!hdr::readSamples(path, samples));
+
+    fs::remove(path);
+}
@@ -10,6 +10,12 @@
 #include <aliceVision/system/Logger.hpp>
 
 #include <OpenImageIO/imagebufalgo.h>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
 #include <random>
 
 
@@ -91,6 +97,97 @@ std::istream & operator>>(std::istream& is, PixelDescription & p)
     return is;
 }
 
+bool writeSamples(const std::string & path, const std::vector<ImageSample> & samples)
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    const std::size_t size = samples.size();
+    file.write((const char *)&size, sizeof(size));
+
+    for (const ImageSample & sample : samples)
+    {
+        file << sample;
+    }
+
+    return file.good();
+}
+
+bool readSamples(const std::string & path, std::vector<ImageSample> & samples)
+{
+    boost::iostreams::mapped_file_source file;
+    try
+    {
+        file.open(path);
+    }
+    catch(const std::exception&)
+    {
+        return false;
+    }
+
+    const char * data = file.data();
+    const char * end = data + file.size();
+
+    // Copy a value from the mapped file, as operator>> reads it
+    const auto read = [&](void * value, std::size_t size) {
+        if (std::size_t(end - data) < size)
+        {
+            return false;
+        }
+        std::memcpy(value, data, size);
+        data += size;
+        return true;
+    };
+
+    std::size_t size;
+    if (!read(&size, sizeof(size)))
+    {
+        return false;
+    }
+
+    // x, y and the number of descriptions of each sample
+    const std::size_t minSampleSize = sizeof(ImageSample::x) + sizeof(ImageSample::y) + sizeof(std::size_t);
+    if (std::size_t(end - data) / minSampleSize < size)
+    {
+        return false;
+    }
+
+    samples.resize(size);
+    for (ImageSample & sample : samples)
+    {
+        std::size_t nbDescriptions;
+        if (!read(&sample.x, sizeof(sample.x)) || !read(&sample.y, sizeof(sample.y)) || !read(&nbDescriptions, sizeof(nbDescriptions)))
+        {
+            return false;
+        }
+
+        // srcId, exposure, mean and variance
+        const std::size_t descriptionSize = sizeof(IndexT) + 7 * sizeof(float);
+        if (std::size_t(end - data) / descriptionSize < nbDescriptions)
+        {
+            return false;
+        }
+
+        sample.descriptions.resize(nbDescriptions);
+        for (PixelDescription & p : sample.descriptions)
+        {
+            read(&p.srcId, sizeof(p.srcId));
+            read(&p.exposure, sizeof(p.exposure));
+            read(&p.mean.r(), sizeof(p.mean.r()));
+            read(&p.mean.g(), sizeof(p.mean.g()));
+            read(&p.mean.b(), sizeof(p.mean.b()));
+            read(&p.variance.r(), sizeof(p.variance.r()));
+            read(&p.variance.g(), sizeof(p.variance.g()));
+            read(&p.variance.b(), sizeof(p.variance.b()));
+        }
+    }
+
+    return data == end;
+}
+
 void integral(image::Image<image::Rgb<double>> & dest, const Eigen::Matrix<image::RGBfColor, Eigen::Dynamic, Eigen::Dynamic> & source)
 {
     /*
@@ -148,352 +245,455 @@ void square(image::Image<image::RGBfColor> & dest, const Eigen::Matrix<image::RG
     }
 }
 
-bool Sampling::extractSamplesFromImages(std::vector<ImageSample>& out_samples, const std::vector<std::string>& imagePaths, const std::vector<IndexT>& viewIds, const std::vector<double>& times, const size_t imageWidth, const size_t imageHeight, const size_t channelQuantization, const image::ImageReadOptions & imgReadOptions, const Sampling::Params params, const bool simplified)
+namespace {
+
+/**
+ * @brief Remove the descriptions of a sample which are not usable for the calibration:
+ * all of them if the patch has a high variance on a bracket, the ones outside the monotonic part of the curve otherwise.
+ */
+void filterSample(ImageSample & sample)
 {
-    const int radiusp1 = params.radius + 1;
-    const int diameter = (params.radius * 2) + 1;
-    const double area = double(diameter * diameter);
+    if (sample.descriptions.size() < 2)
+    {
+        return;
+    }
 
-    std::vector<std::pair<int, int>> vec_blocks;
-    const auto step = params.blockSize - diameter;
-    vec_blocks.reserve(int(imageHeight / step) * int(imageWidth / step));
-    for(int cy = 0; cy < imageHeight; cy += step)
+    // Make sure we don't have a patch with high variance on any bracket.
+    // If the variance is too high somewhere, ignore the whole coordinate samples
+    const float maxVariance = 0.05f;
+    for (int k = 0; k < sample.descriptions.size(); ++k)
     {
-        for(int cx = 0; cx < imageWidth; cx += step)
+        if (sample.descriptions[k].variance.r() > maxVariance ||
+            sample.descriptions[k].variance.g() > maxVariance ||
+            sample.descriptions[k].variance.b() > maxVariance)
         {
-            vec_blocks.push_back(std::make_pair(cx, cy));
+            sample.descriptions.clear();
+            return;
         }
     }
 
-    Image<RGBfColor> img;
-
-    // For all brackets, For each pixel, compute image sample
-    image::Image<ImageSample> samples(imageWidth, imageHeight, true);
-    for (unsigned int idBracket = 0; idBracket < imagePaths.size(); ++idBracket)
+    // Makes sure the curve is monotonic
+    int firstvalid = -1;
+    int lastvalid = 0;
+    for (std::size_t k = 1; k < sample.descriptions.size(); ++k)
     {
-        const double exposure = times[idBracket];
+        bool valid = false;
+
+        // Threshold on the max values, to avoid using fully saturated pixels
+        // TODO: on RAW images, values can be higher. May need to be computed dynamically?
+        const float maxValue = 0.99f;
+        if (sample.descriptions[k].mean.r() > maxValue ||
+            sample.descriptions[k].mean.g() > maxValue ||
+            sample.descriptions[k].mean.b() > maxValue)
+        {
+            continue;
+        }
 
-        // Load image
-        readImage(imagePaths[idBracket], img, imgReadOptions);
+        // Ensures that at least one channel is strictly increasing with increasing exposure
+        // TODO: check "exposure" params, we may have the same exposure multiple times
+        const float minIncreaseRatio = 1.004f;
+        if (sample.descriptions[k].mean.r() > minIncreaseRatio * sample.descriptions[k - 1].mean.r() ||
+            sample.descriptions[k].mean.g() > minIncreaseRatio * sample.descriptions[k - 1].mean.g() ||
+            sample.descriptions[k].mean.b() > minIncreaseRatio * sample.descriptions[k - 1].mean.b())
+        {
+            valid = true;
+        }
 
-        if(img.Width() != imageWidth || img.Height() != imageHeight)
+        // Ensures that the values of each channel are increasing with increasing exposure
+        if (sample.descriptions[k].mean.r() < sample.descriptions[k - 1].mean.r() ||
+            sample.descriptions[k].mean.g() < sample.descriptions[k - 1].mean.g() ||
+            sample.descriptions[k].mean.b() < sample.descriptions[k - 1].mean.b())
         {
-            std::stringstream ss;
-            ss << "Failed to extract samples, the images with multi-bracketing do not have the same image resolution.\n"
-               << " Current image resolution is: " << img.Width() << "x" << img.Height()
-               << ", instead of: " << imageWidth<< "x" << imageHeight << ".\n"
-               << "Current image path is: " << imagePaths[idBracket];
-            throw std::runtime_error(ss.str());
+            valid = false;
         }
 
-        if (simplified)
+        // If we have enough information to analyze the chrominance
+        const float minGlobalValue = 0.1f;
+        if (sample.descriptions[k - 1].mean.norm() > minGlobalValue)
         {
-            // Luminance statistics are calculated from a subsampled square, centered and rotated by 45.
-            // 2 vertices of this square are the centers of the longest sides of the image.
-            // Such a shape is suitable for both fisheye and classic images.
+            // Check that both colors are similars
+            const float n1 = sample.descriptions[k - 1].mean.norm();
+            const float n2 = sample.descriptions[k].mean.norm();
+            const float dot = sample.descriptions[k - 1].mean.dot(sample.descriptions[k].mean);
+            const float cosa = dot / (n1 * n2);
+
+            const float maxCosa = 0.95f; // ~ 18deg
+            if (cosa < maxCosa)
+            {
+                valid = false;
+            }
+        }
 
-            const int H = imageHeight;
-            const int W = imageWidth;
-            const int hH = imageHeight / 2;
-            const int hW = imageWidth / 2;
+        if (valid)
+        {
+            if (firstvalid < 0)
+            {
+                firstvalid = int(k) - 1;
+            }
+            lastvalid = int(k);
+        }
+        else
+        {
+            if (lastvalid != 0)
+            {
+                break;
+            }
+        }
+    }
 
-            const int a1 = (H <= W) ? hW : hH;
-            const int a2 = (H <= W) ? hW : W - hH;
-            const int a3 = (H <= W) ? H - hW : hH;
-            const int a4 = (H <= W) ? hW + H : W + hH;
+    if (lastvalid == 0 || firstvalid < 0)
+    {
+        sample.descriptions.clear();
+        return;
+    }
 
-            // All rows must be considered if image orientation is landscape (H < W)
-            // Only imgW rows centered on imgH/2 must be considered if image orientation is portrait (H > W)
-            const int rmin = (H <= W) ? 0 : (H - W) / 2;
-            const int rmax = (H <= W) ? H : (H + W) / 2;
+    if (firstvalid > 0 || lastvalid < int(sample.descriptions.size()) - 1)
+    {
+        sample.descriptions.erase(sample.descriptions.begin() + lastvalid + 1, sample.descriptions.end());
+        sample.descriptions.erase(sample.descriptions.begin(), sample.descriptions.begin() + firstvalid);
+    }
+}
 
-            const int sampling = 16;
+/**
+ * @brief Uniform random selection of at most maxCountSample samples per descriptor over a stream of samples (reservoir sampling).
+ * A sample selected for several descriptors is stored once.
+ */
+class SamplesSelection
+{
+public:
+    SamplesSelection(std::size_t nbDescriptors, std::size_t maxCountSample, std::mt19937 & rng)
+        : _reservoirs(nbDescriptors)
+        , _maxCountSample(maxCountSample)
+        , _rng(rng)
+    {}
+
+    /**
+     * @brief Offer a sample to a descriptor.
+     * @param[in] descriptorIndex The descriptor index
+     * @param[in] sample The sample
+     * @param[in,out] storedIndex The index of the stored copy of the sample, -1 if it is not stored yet
+     */
+    void add(std::size_t descriptorIndex, const ImageSample & sample, std::ptrdiff_t & storedIndex)
+    {
+        Reservoir & reservoir = _reservoirs[descriptorIndex];
+        ++reservoir.nbSamples;
 
-            #pragma omp parallel for
-            for (int r = rmin; r < rmax; r = r + sampling)
-            {
-                const int cmin = (r < hH) ? a1 - r : r - a3;
-                const int cmax = (r < hH) ? a2 + r : a4 - r;
+        if (reservoir.selected.size() < _maxCountSample)
+        {
+            reservoir.selected.push_back(store(sample, storedIndex));
+            return;
+        }
 
-                for (int c = cmin; c < cmax; c = c + sampling)
-                {
-                    PixelDescription pd;
+        std::uniform_int_distribution<std::size_t> distribution(0, reservoir.nbSamples - 1);
+        const std::size_t replacedIndex = distribution(_rng);
+        if (replacedIndex >= _maxCountSample)
+        {
+            return;
+        }
 
-                    pd.srcId = viewIds[idBracket];
-                    pd.exposure = exposure;
-                    pd.mean.r() = img(r, c).r();
-                    pd.mean.g() = img(r, c).g();
-                    pd.mean.b() = img(r, c).b();
-                    pd.variance.r() = 0.0;
-                    pd.variance.g() = 0.0;
-                    pd.variance.b() = 0.0;
+        // store before the release, the replaced sample may be the same one
+        const std::size_t previous = reservoir.selected[replacedIndex];
+        reservoir.selected[replacedIndex] = store(sample, storedIndex);
+        release(previous);
+    }
 
-                    samples(r, c).x = c;
-                    samples(r, c).y = r;
-                    samples(r, c).descriptions.push_back(pd);
+    /// Get the selected samples, in the order of the descriptors
+    void getSamples(std::vector<ImageSample> & out_samples) const
+    {
+        std::vector<char> exported(_samples.size(), 0);
+        for (const Reservoir & reservoir : _reservoirs)
+        {
+            for (std::size_t index : reservoir.selected)
+            {
+                if (!exported[index])
+                {
+                    out_samples.push_back(_samples[index]);
+                    exported[index] = 1;
                 }
             }
         }
-        else
+    }
+
+private:
+    struct Reservoir
+    {
+        std::size_t nbSamples = 0;
+        std::vector<std::size_t> selected;
+    };
+
+    std::size_t store(const ImageSample & sample, std::ptrdiff_t & storedIndex)
+    {
+        if (storedIndex < 0)
         {
-            #pragma omp parallel for
-            for (int idx = 0; idx < vec_blocks.size(); ++idx)
+            if (_freeIndexes.empty())
             {
-                int cx = vec_blocks[idx].first;
-                int cy = vec_blocks[idx].second;
+                storedIndex = _samples.size();
+                _samples.push_back(sample);
+                _refCounts.push_back(0);
+            }
+            else
+            {
+                storedIndex = _freeIndexes.back();
+                _freeIndexes.pop_back();
+                _samples[storedIndex] = sample;
+            }
+        }
 
-                int blockWidth = ((img.Width() - cx) > params.blockSize) ? params.blockSize : img.Width() - cx;
-                int blockHeight = ((img.Height() - cy) > params.blockSize) ? params.blockSize : img.Height() - cy;
+        ++_refCounts[storedIndex];
+        return storedIndex;
+    }
 
-                auto blockInput = img.block(cy, cx, blockHeight, blockWidth);
-                auto blockOutput = samples.block(cy, cx, blockHeight, blockWidth);
+    void release(std::size_t index)
+    {
+        if (--_refCounts[index] == 0)
+        {
+            _freeIndexes.push_back(index);
+        }
+    }
 
-                // Stats for deviation
-                Image<Rgb<double>> imgIntegral, imgIntegralSquare;
-                Image<RGBfColor> imgSquare;
+    std::vector<Reservoir> _reservoirs;
+    const std::size_t _maxCountSample;
+    std::mt19937 & _rng;
 
-                square(imgSquare, blockInput);
-                integral(imgIntegral, blockInput);
-                integral(imgIntegralSquare, imgSquare);
+    std::vector<ImageSample> _samples;
+    std::vector<int> _refCounts;
+    std::vector<std::size_t> _freeIndexes;
+};
 
-                for (int y = radiusp1; y < imgIntegral.Height() - params.radius; ++y)
-                {
-                    for (int x = radiusp1; x < imgIntegral.Width() - params.radius; ++x)
-                    {
-                        image::Rgb<double> S1 = imgIntegral(y + params.radius, x + params.radius) + imgIntegral(y - radiusp1, x - radiusp1) - imgIntegral(y + params.radius, x - radiusp1) - imgIntegral(y - radiusp1, x + params.radius);
-                        image::Rgb<double> S2 = imgIntegralSquare(y + params.radius, x + params.radius) + imgIntegralSquare(y - radiusp1, x - radiusp1) - imgIntegralSquare(y + params.radius, x - radiusp1) - imgIntegralSquare(y - radiusp1, x + params.radius);
-
-                        PixelDescription pd;
-
-                        pd.srcId = viewIds[idBracket];
-                        pd.exposure = exposure;
-                        pd.mean.r() = blockInput(y, x).r();
-                        pd.mean.g() = blockInput(y, x).g();
-                        pd.mean.b() = blockInput(y, x).b();
-                        pd.variance.r() = (S2.r() - (S1.r() * S1.r()) / area) / area;
-                        pd.variance.g() = (S2.g() - (S1.g() * S1.g()) / area) / area;
-                        pd.variance.b() = (S2.b() - (S1.b() * S1.b()) / area) / area;
-
-                        blockOutput(y, x).x = cx + x;
-                        blockOutput(y, x).y = cy + y;
-                        blockOutput(y, x).descriptions.push_back(pd);
-                    }
-                }
-            }
-        }
-    }
+} // namespace
+
+std::size_t Sampling::getMemoryConsumption(std::size_t imageWidth, std::size_t imageHeight, std::size_t nbBrackets, std::size_t channelQuantization, const Params & params)
+{
+    const std::size_t sampleSize = sizeof(ImageSample) + nbBrackets * sizeof(PixelDescription);
+    // one reservoir per unique descriptor (exposure, channel, quantized value), with the indexes of its selected samples
+    const std::size_t nbReservoirs = nbBrackets * 3 * channelQuantization;
+    const std::size_t reservoirSize = sizeof(std::size_t) + sizeof(std::vector<std::size_t>) + params.maxCountSample * sizeof(std::size_t);
+
+    // the brackets images, the samples of one band of blocks, the reservoirs and a bound of the selected samples
+    return nbBrackets * imageWidth * imageHeight * sizeof(RGBfColor) +
+           imageWidth * std::min(std::size_t(params.blockSize), imageHeight) * sampleSize +
+           nbReservoirs * reservoirSize +
+           std::min(imageWidth * imageHeight, nbReservoirs * params.maxCountSample) * sampleSize;
+}
+
+bool Sampling::extractSamplesFromImages(std::vector<ImageSample>& out_samples, const std::vector<std::string>& imagePaths, const std::vector<IndexT>& viewIds, const std::vector<double>& times, const size_t imageWidth, const size_t imageHeight, const size_t channelQuantization, const image::ImageReadOptions & imgReadOptions, const Sampling::Params params, const bool simplified)
+{
+    const int radiusp1 = params.radius + 1;
+    const int diameter = (params.radius * 2) + 1;
+    const double area = double(diameter * diameter);
 
-    if (samples.Width() == 0)
+    if (imageWidth == 0 || imageHeight == 0)
     {
         // Why? just to be sure
         return false;
     }
 
-    if (!simplified)
+    // Load the brackets
+    std::vector<Image<RGBfColor>> images(imagePaths.size());
+    for (unsigned int idBracket = 0; idBracket < imagePaths.size(); ++idBracket)
     {
-        // Create samples image
-        #pragma omp parallel for
-        for (int y = params.radius; y < samples.Height() - params.radius; ++y)
+        Image<RGBfColor> & img = images[idBracket];
+        readImage(imagePaths[idBracket], img, imgReadOptions);
+
+        if(img.Width() != imageWidth || img.Height() != imageHeight)
+        {
+            std::stringstream ss;
+            ss << "Failed to extract samples, the images with multi-bracketing do not have the same image resolution.\n"
+               << " Current image resolution is: " << img.Width() << "x" << img.Height()
+               << ", instead of: " << imageWidth<< "x" << imageHeight << ".\n"
+               << "Current image path is: " << imagePaths[idBracket];
+            throw std::runtime_error(ss.str());
+        }
+    }
+
+    // The samples are selected per unique descriptor (exposure, channel, quantized value),
+    // their index follows the UniqueDescriptor order.
+    std::vector<float> exposures(times.begin(), times.end());
+    std::sort(exposures.begin(), exposures.end());
+    exposures.erase(std::unique(exposures.begin(), exposures.end()), exposures.end());
+
+    std::random_device randomDevice;
+    std::mt19937 rng(randomDevice());
+    SamplesSelection selection(exposures.size() * 3 * channelQuantization, params.maxCountSample, rng);
+
+    const auto addSample = [&](const ImageSample & sample) {
+        // pixels too close to the borders are not used
+        const std::size_t radius = params.radius;
+        if (sample.x < radius || sample.x + radius >= imageWidth ||
+            sample.y < radius || sample.y + radius >= imageHeight)
+        {
+            return;
+        }
+
+        std::ptrdiff_t storedIndex = -1;
+        for (const PixelDescription & pd : sample.descriptions)
         {
-            for (int x = params.radius; x < samples.Width() - params.radius; ++x)
+            const std::size_t exposureIndex = std::lower_bound(exposures.begin(), exposures.end(), pd.exposure) - exposures.begin();
+
+            for (int channel = 0; channel < 3; ++channel)
             {
-                ImageSample& sample = samples(y, x);
-                if (sample.descriptions.size() < 2)
+                // Get quantized value
+                const int quantizedValue = int(std::round(pd.mean(channel) * (channelQuantization - 1)));
+                if (quantizedValue < 0 || quantizedValue >= channelQuantization)
                 {
                     continue;
                 }
 
-                int last_ok = 0;
+                selection.add((exposureIndex * 3 + channel) * channelQuantization + quantizedValue, sample, storedIndex);
+            }
+        }
+    };
 
-                // Make sure we don't have a patch with high variance on any bracket.
-                // If the variance is too high somewhere, ignore the whole coordinate samples
-                bool valid = true;
-                const float maxVariance = 0.05f;
-                for (int k = 0; k < sample.descriptions.size(); ++k)
-                {
-                    if (sample.descriptions[k].variance.r() > maxVariance ||
-                        sample.descriptions[k].variance.g() > maxVariance ||
-                        sample.descriptions[k].variance.b() > maxVariance)
-                    {
-                        valid = false;
-                        break;
-                    }
-                }
+    if (simplified)
+    {
+        // Luminance statistics are calculated from a subsampled square, centered and rotated by 45.
+        // 2 vertices of this square are the centers of the longest sides of the image.
+        // Such a shape is suitable for both fisheye and classic images.
 
-                if (!valid)
-                {
-                    sample.descriptions.clear();
-                    continue;
-                }
+        const int H = imageHeight;
+        const int W = imageWidth;
+        const int hH = imageHeight / 2;
+        const int hW = imageWidth / 2;
 
-                // Makes sure the curve is monotonic
-                int firstvalid = -1;
-                int lastvalid = 0;
-                for (std::size_t k = 1; k < sample.descriptions.size(); ++k)
-                {
-                    bool valid = false;
-
-                    // Threshold on the max values, to avoid using fully saturated pixels
-                    // TODO: on RAW images, values can be higher. May need to be computed dynamically?
-                    const float maxValue = 0.99f;
-                    if (sample.descriptions[k].mean.r() > maxValue ||
-                        sample.descriptions[k].mean.g() > maxValue ||
-                        sample.descriptions[k].mean.b() > maxValue)
-                    {
-                        continue;
-                    }
+        const int a1 = (H <= W) ? hW : hH;
+        const int a2 = (H <= W) ? hW : W - hH;
+        const int a3 = (H <= W) ? H - hW : hH;
+        const int a4 = (H <= W) ? hW + H : W + hH;
 
-                    // Ensures that at least one channel is strictly increasing with increasing exposure
-                    // TODO: check "exposure" params, we may have the same exposure multiple times
-                    const float minIncreaseRatio = 1.004f;
-                    if (sample.descriptions[k].mean.r() > minIncreaseRatio * sample.descriptions[k - 1].mean.r() ||
-                        sample.descriptions[k].mean.g() > minIncreaseRatio * sample.descriptions[k - 1].mean.g() ||
-                        sample.descriptions[k].mean.b() > minIncreaseRatio * sample.descriptions[k - 1].mean.b())
-                    {
-                        valid = true;
-                    }
+        // All rows must be considered if image orientation is landscape (H < W)
+        // Only imgW rows centered on imgH/2 must be considered if image orientation is portrait (H > W)
+        const int rmin = (H <= W) ? 0 : (H - W) / 2;
+        const int rmax = (H <= W) ? H : (H + W) / 2;
 
-                    // Ensures that the values of each channel are increasing with increasing exposure
-                    if (sample.descriptions[k].mean.r() < sample.descriptions[k - 1].mean.r() ||
-                        sample.descriptions[k].mean.g() < sample.descriptions[k - 1].mean.g() ||
-                        sample.descriptions[k].mean.b() < sample.descriptions[k - 1].mean.b())
-                    {
-                        valid = false;
-                    }
+        const int sampling = 16;
 
-                    // If we have enough information to analyze the chrominance
-                    const float minGlobalValue = 0.1f;
-                    if (sample.descriptions[k - 1].mean.norm() > minGlobalValue)
-                    {
-                        // Check that both colors are similars
-                        const float n1 = sample.descriptions[k - 1].mean.norm();
-                        const float n2 = sample.descriptions[k].mean.norm();
-                        const float dot = sample.descriptions[k - 1].mean.dot(sample.descriptions[k].mean);
-                        const float cosa = dot / (n1 * n2);
-
-                        const float maxCosa = 0.95f; // ~ 18deg
-                        if (cosa < maxCosa)
-                        {
-                            valid = false;
-                        }
-                    }
+        ImageSample sample;
+        for (int r = rmin; r < rmax; r = r + sampling)
+        {
+            const int cmin = (r < hH) ? a1 - r : r - a3;
+            const int cmax = (r < hH) ? a2 + r : a4 - r;
 
-                    if (valid)
-                    {
-                        if (firstvalid < 0)
-                        {
-                            firstvalid = int(k) - 1;
-                        }
-                        lastvalid = int(k);
-                    }
-                    else
-                    {
-                        if (lastvalid != 0)
-                        {
-                            break;
-                        }
-                    }
-                }
+            for (int c = cmin; c < cmax; c = c + sampling)
+            {
+                sample.x = c;
+                sample.y = r;
+                sample.descriptions.clear();
 
-                if (lastvalid == 0 || firstvalid < 0)
+                for (unsigned int idBracket = 0; idBracket < images.size(); ++idBracket)
                 {
-                    sample.descriptions.clear();
-                    continue;
-                }
+                    const Image<RGBfColor> & img = images[idBracket];
+                    PixelDescription pd;
 
-                if (firstvalid > 0 || lastvalid < int(sample.descriptions.size()) - 1)
-                {
-                    std::vector<PixelDescription> replace;
-                    for (int pos = firstvalid; pos <= lastvalid; ++pos)
-                    {
-                        replace.push_back(sample.descriptions[pos]);
-                    }
-                    sample.descriptions = replace;
+                    pd.srcId = viewIds[idBracket];
+                    pd.exposure = times[idBracket];
+                    pd.mean.r() = img(r, c).r();
+                    pd.mean.g() = img(r, c).g();
+                    pd.mean.b() = img(r, c).b();
+                    pd.variance.r() = 0.0;
+                    pd.variance.g() = 0.0;
+                    pd.variance.b() = 0.0;
+
+                    sample.descriptions.push_back(pd);
                 }
+
+                addSample(sample);
             }
         }
     }
-
-    // Get a counter for all unique descriptors
-    using Coordinates = std::pair<int, int>;
-    using CoordinatesList = std::vector<Coordinates>;
-    using Counters = std::map<UniqueDescriptor, CoordinatesList>;
-
-    Counters counters;
+    else
     {
-        std::vector<Counters> counters_vec(omp_get_max_threads());
+        const auto step = params.blockSize - diameter;
+
+        std::vector<int> vec_blocksX;
+        for(int cx = 0; cx < imageWidth; cx += step)
+        {
+            vec_blocksX.push_back(cx);
+        }
 
-        #pragma omp parallel for
-        for (int y = params.radius; y < samples.Height() - params.radius; ++y)
+        // The blocks are processed by bands of rows, only the samples of the current band are in memory
+        image::Image<ImageSample> samples;
+        for(int cy = 0; cy < imageHeight; cy += step)
         {
-            Counters & counters_thread = counters_vec[omp_get_thread_num()];
+            const int bandHeight = ((imageHeight - cy) > params.blockSize) ? params.blockSize : imageHeight - cy;
+            samples = image::Image<ImageSample>(imageWidth, bandHeight, true);
 
-            for (int x = params.radius; x < samples.Width() - params.radius; ++x)
+            // For all brackets, For each pixel, compute image sample
+            #pragma omp parallel for
+            for (int idx = 0; idx < vec_blocksX.size(); ++idx)
             {
-                const ImageSample & sample = samples(y, x);
-                UniqueDescriptor desc;
+                const int cx = vec_blocksX[idx];
+                const int blockWidth = ((imageWidth - cx) > params.blockSize) ? params.blockSize : imageWidth - cx;
 
-                for (int k = 0; k < sample.descriptions.size(); ++k)
+                auto blockOutput = samples.block(0, cx, bandHeight, blockWidth);
+
+                // Stats for deviation
+                Image<Rgb<double>> imgIntegral, imgIntegralSquare;
+                Image<RGBfColor> imgSquare;
+
+                for (unsigned int idBracket = 0; idBracket < images.size(); ++idBracket)
                 {
-                    desc.exposure = sample.descriptions[k].exposure;
+                    const double exposure = times[idBracket];
+                    auto blockInput = images[idBracket].block(cy, cx, bandHeight, blockWidth);
+
+                    square(imgSquare, blockInput);
+                    integral(imgIntegral, blockInput);
+                    integral(imgIntegralSquare, imgSquare);
 
-                    for (int channel = 0; channel < 3; ++channel)
+                    for (int y = radiusp1; y < imgIntegral.Height() - params.radius; ++y)
                     {
-                        desc.channel = channel;
-                        // Get quantized value
-                        desc.quantizedValue = int(std::round(sample.descriptions[k].mean(channel)  * (channelQuantization - 1)));
-                        if (desc.quantizedValue < 0 || desc.quantizedValue >= channelQuantization)
+                        for (int x = radiusp1; x < imgIntegral.Width() - params.radius; ++x)
                         {
-                            continue;
-                        }                        
-                        Coordinates coordinates = std::make_pair(sample.x, sample.y);
-                        counters_thread[desc].push_back(coordinates);
+                            image::Rgb<double> S1 = imgIntegral(y + params.radius, x + params.radius) + imgIntegral(y - radiusp1, x - radiusp1) - imgIntegral(y + params.radius, x - radiusp1) - imgIntegral(y - radiusp1, x + params.radius);
+                            image::Rgb<double> S2 = imgIntegralSquare(y + params.radius, x + params.radius) + imgIntegralSquare(y - radiusp1, x - radiusp1) - imgIntegralSquare(y + params.radius, x - radiusp1) - imgIntegralSquare(y - radiusp1, x + params.radius);
+
+                            PixelDescription pd;
+
+                            pd.srcId = viewIds[idBracket];
+                            pd.exposure = exposure;
+                            pd.mean.r() = blockInput(y, x).r();
+                            pd.mean.g() = blockInput(y, x).g();
+                            pd.mean.b() = blockInput(y, x).b();
+                            pd.variance.r() = (S2.r() - (S1.r() * S1.r()) / area) / area;
+                            pd.variance.g() = (S2.g() - (S1.g() * S1.g()) / area) / area;
+                            pd.variance.b() = (S2.b() - (S1.b() * S1.b()) / area) / area;
+
+                            ImageSample & sample = blockOutput(y, x);
+                            if (sample.descriptions.empty())
+                            {
+                                sample.descriptions.reserve(images.size());
+                            }
+                            sample.x = cx + x;
+                            sample.y = cy + y;
+                            sample.descriptions.push_back(pd);
+                        }
                     }
                 }
-            }
-        }
 
-        for(int i = 0; i < counters_vec.size(); ++i)
-        {
-            for (auto & item : counters_vec[i])
-            {
-                auto found = counters.find(item.first);
-                if (found != counters.end())
-                {
-                    found->second.insert(found->second.end(), item.second.begin(), item.second.end());
-                }
-                else
+                for (int y = 0; y < blockOutput.rows(); ++y)
                 {
-                    counters[item.first] = item.second;
+                    for (int x = 0; x < blockOutput.cols(); ++x)
+                    {
+                        filterSample(blockOutput(y, x));
+                    }
                 }
             }
-        }
-    }
 
-    std::random_device randomDevice;
-    std::mt19937 rng(randomDevice());
-
-    for (auto & item : counters)
-    {
-        if (item.second.size() > params.maxCountSample)
-        {
-            // Shuffle and ignore the exceeding samples
-            std::shuffle(item.second.begin(), item.second.end(), rng);
-            item.second.resize(params.maxCountSample);
-        }
-
-        for (std::size_t i = 0; i < item.second.size(); ++i)
-        {
-            const Coordinates& coords = item.second[i];
-
-            if (!samples(coords.second, coords.first).descriptions.empty())
+            for (int y = 0; y < samples.Height(); ++y)
             {
-                out_samples.push_back(samples(coords.second, coords.first));
-                samples(coords.second, coords.first).descriptions.clear();
+                for (int x = 0; x < samples.Width(); ++x)
+                {
+                    const ImageSample & sample = samples(y, x);
+                    if (!sample.descriptions.empty())
+                    {
+                        addSample(sample);
+                    }
+                }
             }
         }
     }
 
+    selection.getSamples(out_samples);
+
     return true;
 }
 
@@ -9,6 +9,8 @@
 #include <aliceVision/image/all.hpp>
 #include <aliceVision/numeric/numeric.hpp>
 #include <set>
+#include <string>
+#include <vector>
 
 namespace aliceVision {
 namespace hdr {
@@ -44,6 +46,18 @@ std::ostream & operator<<(std::ostream& os, const PixelDescription & p);
 std::istream & operator>>(std::istream& os, ImageSample & s);
 std::istream & operator>>(std::istream& os, PixelDescription & p);
 
+/**
+ * @brief Write the samples in a binary file: the number of samples, then the samples as written by operator<<.
+ * @return false if the file cannot be written
+ */
+bool writeSamples(const std::string & path, const std::vector<ImageSample> & samples);
+
+/**
+ * @brief Read the samples of a file written by writeSamples, the file is memory mapped.
+ * @return false if the file cannot be read or is truncated
+ */
+bool readSamples(const std::string & path, std::vector<ImageSample> & samples);
+
 
 class Sampling
 {
@@ -67,8 +81,16 @@ public:
     void filter(size_t maxTotalPoints);
     void extractUsefulSamples(std::vector<ImageSample> & out_samples, const std::vector<ImageSample> & samples, int imageIndex) const;
     
+    /**
+     * @brief Extract the samples of a group of brackets.
+     * The brackets are processed by bands of blocks, and the samples are selected while the bands are processed,
+     * so the memory does not depend on the number of candidate samples.
+     */
     static bool extractSamplesFromImages(std::vector<ImageSample>& out_samples, const std::vector<std::string> & imagePaths, const std::vector<IndexT>& viewIds, const std::vector<double>& times, const size_t imageWidth, const size_t imageHeight, const size_t channelQuantization, const image::ImageReadOptions & imgReadOptions, const Params params, const bool simplified = false);
 
+    /// Estimation of the memory used by extractSamplesFromImages, in bytes
+    static std::size_t getMemoryConsumption(std::size_t imageWidth, std::size_t imageHeight, std::size_t nbBrackets, std::size_t channelQuantization, const Params & params);
+
 private:
     MapSampleRefList _positions;
 };
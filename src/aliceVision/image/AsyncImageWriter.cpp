@@ -0,0 +1,115 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "AsyncImageWriter.hpp"
+
+#include <algorithm>
+
+namespace aliceVision {
+namespace image {
+
+AsyncImageWriter::AsyncImageWriter(std::size_t bufferSize, int nbThreads)
+  : _bufferSize(std::max(bufferSize, std::size_t(1)))
+{
+    const int nbWritingThreads = std::max(nbThreads, 1);
+    _threads.reserve(nbWritingThreads);
+    for(int i = 0; i < nbWritingThreads; ++i)
+        _threads.emplace_back(&AsyncImageWriter::run, this);
+}
+
+AsyncImageWriter::~AsyncImageWriter()
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _jobDone.wait(lock, [this]() { return _jobs.empty() && _nbRunningJobs == 0; });
+        _stop = true;
+    }
+    _jobPushed.notify_all();
+
+    for(std::thread& thread : _threads)
+    {
+        if(thread.joinable())
+            thread.join();
+    }
+}
+
+void AsyncImageWriter::push(Job&& job)
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _jobDone.wait(lock, [this]() { return _jobs.size() < _bufferSize || _error; });
+
+        if(_error)
+            std::rethrow_exception(_error);
+
+        _jobs.push_back(std::move(job));
+    }
+    _jobPushed.notify_one();
+}
+
+void AsyncImageWriter::wait()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _jobDone.wait(lock, [this]() { return (_jobs.empty() && _nbRunningJobs == 0) || _error; });
+
+    if(_error)
+        std::rethrow_exception(_error);
+}
+
+std::size_t AsyncImageWriter::getNbWrittenImages() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _nbWrittenImages;
+}
+
+void AsyncImageWriter::run()
+{
+    while(true)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _jobPushed.wait(lock, [this]() { return !_jobs.empty() || _stop; });
+
+            if(_jobs.empty())
+                return;
+
+            job = std::move(_jobs.front());
+            _jobs.pop_front();
+            ++_nbRunningJobs;
+        }
+
+        std::exception_ptr error;
+        try
+        {
+            job();
+        }
+        catch(...)
+        {
+            error = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            --_nbRunningJobs;
+            if(error)
+            {
+                // keep the first error, the next images are not written
+                if(!_error)
+                    _error = error;
+                _jobs.clear();
+            }
+            else
+            {
+                ++_nbWrittenImages;
+            }
+        }
+        _jobDone.notify_all();
+    }
+}
+
+} // namespace image
+} // namespace aliceVision
@@ -0,0 +1,109 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/image/Image.hpp>
+#include <aliceVision/image/io.hpp>
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace aliceVision {
+namespace image {
+
+/**
+ * @brief Write images in background threads, so the images are encoded while the next ones are computed.
+ *
+ * The images waiting to be written are stored in a buffer of fixed size,
+ * write() waits while the buffer is full so the memory stays bounded.
+ */
+class AsyncImageWriter
+{
+public:
+    /**
+     * @param[in] bufferSize The maximum number of images waiting to be written
+     * @param[in] nbThreads The number of images written in parallel
+     */
+    explicit AsyncImageWriter(std::size_t bufferSize = 4, int nbThreads = 1);
+
+    AsyncImageWriter(const AsyncImageWriter&) = delete;
+    AsyncImageWriter& operator=(const AsyncImageWriter&) = delete;
+
+    /// Wait for the images to be written
+    ~AsyncImageWriter();
+
+    /**
+     * @brief Queue an image to be written with image::writeImage, it waits while the buffer is full.
+     * @param[in] path The image path
+     * @param[in] image The image, moved to the writing thread
+     * @param[in] options The write options
+     * @param[in] metadata The image metadata
+     * @throw the error of a previous write
+     */
+    template<typename TPix>
+    void write(const std::string& path, Image<TPix>&& image, const ImageWriteOptions& options,
+               const oiio::ParamValueList& metadata = oiio::ParamValueList())
+    {
+        const std::shared_ptr<Image<TPix>> imagePtr = std::make_shared<Image<TPix>>(std::move(image));
+        push([path, imagePtr, options, metadata]() { writeImage(path, *imagePtr, options, metadata); });
+    }
+
+    /**
+     * @brief Queue a job computing and writing an image, it waits while the buffer is full.
+     *        The jobs run in the writing threads, so they must not share data with the producer thread.
+     * @param[in] job The job, called without arguments
+     * @throw the error of a previous write
+     */
+    template<typename TJob>
+    void process(TJob&& job)
+    {
+        push(Job(std::forward<TJob>(job)));
+    }
+
+    /**
+     * @brief Wait for the queued images to be written.
+     * @throw the error of the first write that failed
+     */
+    void wait();
+
+    /// Number of images written
+    std::size_t getNbWrittenImages() const;
+
+private:
+    using Job = std::function<void()>;
+
+    void push(Job&& job);
+
+    /// The writing threads loop
+    void run();
+
+    const std::size_t _bufferSize;
+
+    std::deque<Job> _jobs;
+    std::size_t _nbRunningJobs = 0;
+    std::size_t _nbWrittenImages = 0;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _jobPushed;
+    std::condition_variable _jobDone;
+    bool _stop = false;
+    std::exception_ptr _error;
+
+    std::vector<std::thread> _threads;
+};
+
+} // namespace image
+} // namespace aliceVision
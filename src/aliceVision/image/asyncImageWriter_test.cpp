@@ -0,0 +1,95 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/image/AsyncImageWriter.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <stdexcept>
+#include <string>
+
+#define BOOST_TEST_MODULE AsyncImageWriter
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::image;
+
+namespace fs = boost::filesystem;
+
+BOOST_AUTO_TEST_CASE(AsyncImageWriter_write)
+{
+    const fs::path folder = fs::temp_directory_path() / fs::unique_path();
+    fs::create_directories(folder);
+
+    const int nbImages = 8;
+    {
+        // a buffer smaller than the number of images
+        AsyncImageWriter writer(2);
+        for(int i = 0; i < nbImages; ++i)
+        {
+            Image<float> image(4, 3, true, float(i));
+            writer.write((folder / (std::to_string(i) + ".exr")).string(), std::move(image), ImageWriteOptions());
+        }
+        writer.wait();
+        BOOST_CHECK_EQUAL(writer.getNbWrittenImages(), nbImages);
+    }
+
+    for(int i = 0; i < nbImages; ++i)
+    {
+        Image<float> image;
+        readImage((folder / (std::to_string(i) + ".exr")).string(), image, EImageColorSpace::NO_CONVERSION);
+        BOOST_CHECK_EQUAL(image.Width(), 4);
+        BOOST_CHECK_EQUAL(image.Height(), 3);
+        BOOST_CHECK_EQUAL(image(2, 3), float(i));
+    }
+
+    fs::remove_all(folder);
+}
+
+BOOST_AUTO_TEST_CASE(AsyncImageWriter_process)
+{
+    const fs::path folder = fs::temp_directory_path() / fs::unique_path();
+    fs::create_directories(folder);
+
+    const int nbImages = 8;
+    {
+        // the images are computed and written by several threads
+        AsyncImageWriter writer(2, 3);
+        for(int i = 0; i < nbImages; ++i)
+        {
+            const std::string path = (folder / (std::to_string(i) + ".exr")).string();
+            writer.process([path, i]() {
+                Image<float> image(4, 3, true, 0.f);
+                image(2, 3) = float(i);
+                writeImage(path, image, ImageWriteOptions());
+            });
+        }
+        writer.wait();
+        BOOST_CHECK_EQUAL(writer.getNbWrittenImages(), nbImages);
+    }
+
+    for(int i = 0; i < nbImages; ++i)
+    {
+        Image<float> image;
+        readImage((folder / (std::to_string(i) + ".exr")).string(), image, EImageColorSpace::NO_CONVERSION);
+        BOOST_CHECK_EQUAL(image(2, 3), float(i));
+        BOOST_CHECK_EQUAL(image(0, 0), 0.f);
+    }
+
+    fs::remove_all(folder);
+}
+
+BOOST_AUTO_TEST_CASE(AsyncImageWriter_error)
+{
+    const fs::path folder = fs::temp_directory_path() / fs::unique_path();
+
+    AsyncImageWriter writer;
+    writer.write((folder / "missingFolder" / "image.exr").string(), Image<float>(4, 3, true, 0.f), ImageWriteOptions());
+
+    // the write error is reported to the producer thread
+    BOOST_CHECK_THROW(writer.wait(), std::runtime_error);
+}
@@ -1,15 +1,28 @@
 #include "cache.hpp"
 
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/MemoryTracker.hpp>
 
 #include <boost/filesystem.hpp>
 
+#include <zlib.h>
+
+#include <algorithm>
+
 
 namespace aliceVision
 {
 namespace image
 {
 
+namespace
+{
+
+/// the bytes of the tiles data in memory
+system::AllocationCounter cachedTileAllocations("CachedTile");
+
+}
+
 CacheManager::CacheManager(const std::string & pathStorage, size_t blockSize, size_t maxBlocksPerIndex) :
 _blockSize(blockSize),
 _incoreBlockUsageCount(0),
@@ -21,10 +34,20 @@ _basePathStorage(pathStorage)
 }
 
 CacheManager::~CacheManager() {
+  stopIOThreads();
   wipe();
 }
 
 void CacheManager::wipe() {
+  {
+    std::lock_guard<std::mutex> lock(_prefetchMutex);
+    _prefetchTasks.clear();
+    _prefetchLoading.clear();
+    _prefetched.clear();
+    _prefetchedOrder.clear();
+    _prefetchBlockCount = 0;
+  }
+
   deleteIndexFiles();
 
   _mru.clear();
@@ -43,6 +66,178 @@ void CacheManager::setInCoreMaxObjectCount(size_t max) {
   _incoreBlockUsageMax = max;
 }
 
+void CacheManager::setCompression(bool enable) {
+  _compression = enable;
+}
+
+void CacheManager::setPrefetching(size_t threadCount, size_t maxMemorySize) {
+  stopIOThreads();
+
+  {
+    std::lock_guard<std::mutex> lock(_prefetchMutex);
+    _prefetchBlockMax = maxMemorySize / _blockSize;
+  }
+
+  if (threadCount > 0 && _prefetchBlockMax > 0) {
+    startIOThreads(threadCount);
+  }
+}
+
+void CacheManager::startIOThreads(size_t threadCount) {
+  _stopIOThreads = false;
+  for (size_t i = 0; i < threadCount; i++) {
+    _ioThreads.emplace_back(&CacheManager::ioThreadLoop, this);
+  }
+}
+
+void CacheManager::stopIOThreads() {
+  {
+    std::lock_guard<std::mutex> lock(_prefetchMutex);
+    _stopIOThreads = true;
+
+    /*The queued objects will be loaded synchronously when acquired*/
+    for (const PrefetchTask & task : _prefetchTasks) {
+      _prefetchBlockCount -= _prefetchLoading[task.objectId];
+      _prefetchLoading.erase(task.objectId);
+    }
+    _prefetchTasks.clear();
+  }
+  _prefetchTaskCondition.notify_all();
+
+  for (std::thread & thread : _ioThreads) {
+    thread.join();
+  }
+  _ioThreads.clear();
+}
+
+void CacheManager::ioThreadLoop() {
+
+  while (true) {
+
+    PrefetchTask task;
+    {
+      std::unique_lock<std::mutex> lock(_prefetchMutex);
+      _prefetchTaskCondition.wait(lock, [this]() { return _stopIOThreads || !_prefetchTasks.empty(); });
+      if (_stopIOThreads) {
+        return;
+      }
+
+      task = std::move(_prefetchTasks.front());
+      _prefetchTasks.pop_front();
+    }
+
+    /*Read and decompress outside of the lock, the storage of this object is not modified while it is out of core*/
+    std::unique_ptr<unsigned char> data = readBlocks(task.path, task.position, task.length, task.storedSize);
+
+    {
+      std::lock_guard<std::mutex> lock(_prefetchMutex);
+      const size_t countBlock = _prefetchLoading[task.objectId];
+      _prefetchLoading.erase(task.objectId);
+
+      if (data) {
+        _prefetched[task.objectId] = PrefetchedItem{std::move(data), countBlock};
+        _prefetchedOrder.push_back(task.objectId);
+      }
+      else {
+        _prefetchBlockCount -= countBlock;
+      }
+    }
+    _prefetchDoneCondition.notify_all();
+  }
+}
+
+void CacheManager::releasePrefetchedObjects(size_t blockCount) {
+
+  /*Drop the oldest prefetched objects (still valid in the storage) to make room, must be called with the prefetch lock*/
+  while (_prefetchBlockCount + blockCount > _prefetchBlockMax && !_prefetchedOrder.empty()) {
+    const size_t objectId = _prefetchedOrder.front();
+    _prefetchedOrder.pop_front();
+
+    _prefetchBlockCount -= _prefetched[objectId].countBlock;
+    _prefetched.erase(objectId);
+  }
+}
+
+bool CacheManager::prefetchObject(size_t objectId) {
+
+  if (_ioThreads.empty()) {
+    return false;
+  }
+
+  MemoryMap::iterator itfind = _memoryMap.find(objectId);
+  if (itfind == _memoryMap.end()) {
+    return false;
+  }
+
+  /*Nothing to load if the object is in core or was never saved*/
+  const MemoryItem & memitem = itfind->second;
+  if (memitem.startBlockId == ~0 || _mru.get<1>().find(objectId) != _mru.get<1>().end()) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(_prefetchMutex);
+  if (_prefetched.count(objectId) || _prefetchLoading.count(objectId)) {
+    return true;
+  }
+
+  releasePrefetchedObjects(memitem.countBlock);
+  if (_prefetchBlockCount + memitem.countBlock > _prefetchBlockMax) {
+    return false;
+  }
+
+  PrefetchTask task;
+  task.objectId = objectId;
+  task.path = getPathForIndex(memitem.startBlockId / _blockCountPerIndex);
+  task.position = (memitem.startBlockId % _blockCountPerIndex) * _blockSize;
+  task.length = _blockSize * memitem.countBlock;
+  task.storedSize = memitem.storedSize;
+
+  _prefetchTasks.push_back(std::move(task));
+  _prefetchLoading[objectId] = memitem.countBlock;
+  _prefetchBlockCount += memitem.countBlock;
+  _prefetchTaskCondition.notify_one();
+
+  return true;
+}
+
+bool CacheManager::takePrefetchedObject(std::unique_ptr<unsigned char> & data, size_t objectId) {
+
+  std::unique_lock<std::mutex> lock(_prefetchMutex);
+
+  if (_prefetchLoading.count(objectId)) {
+    
+    /*Not started yet, it is faster to load it now than to wait for the queued tasks*/
+    std::deque<PrefetchTask>::iterator ittask = std::find_if(_prefetchTasks.begin(), _prefetchTasks.end(), 
+                                                             [objectId](const PrefetchTask & task) { return task.objectId == objectId; });
+    if (ittask != _prefetchTasks.end()) {
+      _prefetchTasks.erase(ittask);
+      _prefetchBlockCount -= _prefetchLoading[objectId];
+      _prefetchLoading.erase(objectId);
+      return false;
+    }
+
+    _prefetchDoneCondition.wait(lock, [this, objectId]() { return _prefetchLoading.count(objectId) == 0; });
+  }
+
+  std::unordered_map<size_t, PrefetchedItem>::iterator itfind = _prefetched.find(objectId);
+  if (itfind == _prefetched.end()) {
+    return false;
+  }
+
+  data = std::move(itfind->second.data);
+  _prefetchBlockCount -= itfind->second.countBlock;
+  _prefetched.erase(itfind);
+  _prefetchedOrder.remove(objectId);
+
+  return true;
+}
+
+void CacheManager::cancelPrefetch(size_t objectId) {
+
+  std::unique_ptr<unsigned char> data;
+  takePrefetchedObject(data, objectId);
+}
+
 std::string CacheManager::getPathForIndex(size_t indexId) {
 
   if (_indexPaths.find(indexId) == _indexPaths.end()) {
@@ -116,7 +311,7 @@ bool CacheManager::prepareBlockGroup(size_t startBlockId, size_t blocksCount) {
   return true;
 }
 
-std::unique_ptr<unsigned char> CacheManager::load(size_t startBlockId, size_t blockCount) {
+std::unique_ptr<unsigned char> CacheManager::load(size_t startBlockId, size_t blockCount, size_t storedSize) {
     
   const size_t indexId = startBlockId / _blockCountPerIndex;
   const size_t blockIdInIndex = startBlockId % _blockCountPerIndex;
@@ -124,29 +319,52 @@ std::unique_ptr<unsigned char> CacheManager::load(size_t startBlockId, size_t bl
   const size_t groupLength = _blockSize * blockCount;
 
   const std::string path = getPathForIndex(indexId);
-  
+
+  return readBlocks(path, positionInIndex, groupLength, storedSize);
+}
+
+std::unique_ptr<unsigned char> CacheManager::readBlocks(const std::string & path, size_t position, size_t length, size_t storedSize) const {
+
   std::ifstream file_index(path, std::ios::binary);
   if (!file_index.is_open()) {
     return std::unique_ptr<unsigned char>();
   }  
 
-  file_index.seekg(positionInIndex, std::ios::beg);
+  file_index.seekg(position, std::ios::beg);
   if (file_index.fail()) {
     return std::unique_ptr<unsigned char>();
   }
 
-  ALICEVISION_LOG_TRACE("CacheManager::load: read " << groupLength << " bytes from '" << path << "' at position " << positionInIndex << ".");
+  const size_t readLength = (storedSize > 0) ? storedSize : length;
+  ALICEVISION_LOG_TRACE("CacheManager::load: read " << readLength << " bytes from '" << path << "' at position " << position << ".");
+
+  std::unique_ptr<unsigned char> data(new unsigned char[length]);
 
-  std::unique_ptr<unsigned char> data(new unsigned char[groupLength]);
-  file_index.read(reinterpret_cast<char *>(data.get()), groupLength);
+  if (storedSize == 0) {
+    file_index.read(reinterpret_cast<char *>(data.get()), length);
+    if (!file_index) {
+      return std::unique_ptr<unsigned char>();
+    }
+
+    return data;
+  }
+
+  std::unique_ptr<unsigned char[]> compressed(new unsigned char[storedSize]);
+  file_index.read(reinterpret_cast<char *>(compressed.get()), storedSize);
   if (!file_index) {
     return std::unique_ptr<unsigned char>();
   }
 
+  uLongf uncompressedLength = length;
+  if (uncompress(data.get(), &uncompressedLength, compressed.get(), storedSize) != Z_OK || uncompressedLength != length) {
+    ALICEVISION_LOG_ERROR("CacheManager::load: invalid compressed data in '" << path << "' at position " << position << ".");
+    return std::unique_ptr<unsigned char>();
+  }
+
   return data;
 }
 
-bool CacheManager::save(std::unique_ptr<unsigned char> && data, size_t startBlockId, size_t blockCount) {
+bool CacheManager::save(std::unique_ptr<unsigned char> && data, size_t startBlockId, size_t blockCount, size_t & storedSize) {
     
   const size_t indexId = startBlockId / _blockCountPerIndex;
   const size_t blockIdInIndex = startBlockId % _blockCountPerIndex;
@@ -169,12 +387,26 @@ bool CacheManager::save(std::unique_ptr<unsigned char> && data, size_t startBloc
   if (bytesToWrite == nullptr) {
     return false;
   }
-  else {
-    // Write data
-    ALICEVISION_LOG_TRACE("CacheManager::save: write " << groupLength << " bytes to '" << path << "' at position " << positionInIndex << ".");
-    file_index.write(reinterpret_cast<const char*>(bytesToWrite), groupLength);
+
+  size_t writeLength = groupLength;
+  storedSize = 0;
+
+  std::unique_ptr<unsigned char[]> compressed;
+  if (_compression) {
+    // Fast compression, keep the raw data if it does not compress
+    uLongf compressedLength = compressBound(groupLength);
+    compressed.reset(new unsigned char[compressedLength]);
+    if (compress2(compressed.get(), &compressedLength, bytesToWrite, groupLength, Z_BEST_SPEED) == Z_OK && compressedLength < groupLength) {
+      bytesToWrite = compressed.get();
+      writeLength = compressedLength;
+      storedSize = compressedLength;
+    }
   }
 
+  // Write data
+  ALICEVISION_LOG_TRACE("CacheManager::save: write " << writeLength << " bytes to '" << path << "' at position " << positionInIndex << ".");
+  file_index.write(reinterpret_cast<const char*>(bytesToWrite), writeLength);
+
   if (!file_index) {
     return false;
   }
@@ -209,6 +441,7 @@ bool CacheManager::createObject(size_t & objectId, size_t blockCount) {
   MemoryItem item;
   item.startBlockId = ~0;
   item.countBlock = blockCount;
+  item.storedSize = 0;
   _memoryMap[objectId] = item;
 
   return true;
@@ -238,8 +471,8 @@ bool CacheManager::acquireObject(std::unique_ptr<unsigned char> & data, size_t o
       std::unique_ptr<unsigned char> buffer(new unsigned char[_blockSize * memitem.countBlock]);
       data = std::move(buffer);
     }
-    else {
-      data = std::move(load(memitem.startBlockId, memitem.countBlock));
+    else if (!takePrefetchedObject(data, objectId)) {
+      data = std::move(load(memitem.startBlockId, memitem.countBlock, memitem.storedSize));
     }
 
     /*Update memory usage*/
@@ -276,17 +509,16 @@ bool CacheManager::saveObject(std::unique_ptr<unsigned char> && data, size_t obj
     return false;
   }
 
-  MemoryItem item = itfind->second;
+  MemoryItem & item = itfind->second;
 
-  if (itfind->second.startBlockId == ~0) {
+  if (item.startBlockId == ~0) {
     
     item.startBlockId = getFreeBlockId(item.countBlock);
-    _memoryMap[objectId] = item;
 
     prepareBlockGroup(item.startBlockId, item.countBlock);
   }
 
-  if (!save(std::move(data), item.startBlockId, item.countBlock)) {
+  if (!save(std::move(data), item.startBlockId, item.countBlock, item.storedSize)) {
     return false;
   }
 
@@ -303,6 +535,10 @@ size_t CacheManager::getActiveBlocks() const {
 }
 
 CachedTile::~CachedTile() {
+
+  if (_data) {
+    cachedTileAllocations.remove(getDataSize());
+  }
   
   std::shared_ptr<TileCacheManager> manager = _manager.lock();
   if (manager) {
@@ -310,6 +546,25 @@ CachedTile::~CachedTile() {
   }
 }
 
+void CachedTile::setData(std::unique_ptr<unsigned char> && data) {
+
+  if (_data) {
+    cachedTileAllocations.remove(getDataSize());
+  }
+  if (data) {
+    cachedTileAllocations.add(getDataSize());
+  }
+  _data = std::move(data);
+}
+
+std::unique_ptr<unsigned char> CachedTile::getData() {
+
+  if (_data) {
+    cachedTileAllocations.remove(getDataSize());
+  }
+  return std::move(_data);
+}
+
 bool CachedTile::acquire() {
 
   std::shared_ptr<TileCacheManager> manager = _manager.lock();
@@ -323,6 +578,20 @@ bool CachedTile::acquire() {
   return true;
 }
 
+bool CachedTile::prefetch() {
+
+  if (_data) {
+    return false;
+  }
+
+  std::shared_ptr<TileCacheManager> manager = _manager.lock();
+  if (!manager) {
+    return false;
+  }
+
+  return manager->prefetch(_uid);
+}
+
 TileCacheManager::TileCacheManager(const std::string & pathStorage, size_t tileWidth, size_t tileHeight, size_t maxTilesPerIndex) :
 CacheManager(pathStorage, tileWidth * tileHeight, maxTilesPerIndex),
 _tileWidth(tileWidth), _tileHeight(tileHeight)
@@ -389,6 +658,9 @@ void TileCacheManager::notifyDestroy(size_t tileId) {
   /* Remove weak pointer */
   _objectMap.erase(tileId);
 
+  /* Drop the prefetched data, the storage may be reused */
+  cancelPrefetch(tileId);
+
   /* Remove map from object to block id*/
   MemoryMap::iterator it = _memoryMap.find(tileId);
   if (it == _memoryMap.end()) {
@@ -432,6 +704,15 @@ bool TileCacheManager::acquire(size_t tileId) {
   return true;
 }
 
+bool TileCacheManager::prefetch(size_t tileId) {
+
+  if (_objectMap.find(tileId) == _objectMap.end()) {
+    return false;
+  }
+
+  return CacheManager::prefetchObject(tileId);
+}
+
 void TileCacheManager::onRemovedFromMRU(size_t objectId) {
 
   MapCachedTile::iterator itfind = _objectMap.find(objectId);
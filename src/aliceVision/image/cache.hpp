@@ -17,9 +17,13 @@
 #include <boost/multi_index/sequenced_index.hpp>
 #include <boost/multi_index/member.hpp>
 
+#include <condition_variable>
+#include <deque>
 #include <fstream>
 #include <list>
+#include <mutex>
 #include <sstream>
+#include <thread>
 #include <queue>
 
 namespace aliceVision
@@ -79,6 +83,14 @@ public:
   size_t getDepth() const {
     return _depth;
   }
+
+  /**
+   * Get the manager of this tile
+   * @return nullptr if the manager was destroyed
+   */
+  std::shared_ptr<TileCacheManager> getManager() const {
+    return _manager.lock();
+  }
   
   /*
   Tells the system that we need the data for this tile.
@@ -87,14 +99,19 @@ public:
   */
   bool acquire();
 
+  /*
+  Tells the system that we will need the data for this tile soon.
+  If the data is out of core, it is loaded in background (if the manager prefetching is enabled).
+  @return false if the data will not be prefetched.
+  */
+  bool prefetch();
+
   /**
    * Update data with a new buffer
    * Move the data parameter to the _data property.
    * @note the parameter is invalidated !
    */
-  void setData(std::unique_ptr<unsigned char> && data) {
-    _data = std::move(data);
-  }
+  void setData(std::unique_ptr<unsigned char> && data);
 
   /**
    * Get a pointer to the contained data
@@ -113,8 +130,13 @@ public:
    * Move the data.
    * The data is returned and the object property is set to nullptr
    */
-  std::unique_ptr<unsigned char> getData() {
-    return std::move(_data);
+  std::unique_ptr<unsigned char> getData();
+
+  /**
+   * Get the size of the tile data
+   */
+  size_t getDataSize() const {
+    return _tileWidth * _tileHeight * _depth;
   }
 
 private:
@@ -153,6 +175,7 @@ public:
   {
     size_t startBlockId;
     size_t countBlock;
+    size_t storedSize; //< size of the compressed object in the storage, 0 if stored uncompressed
   };
 
   using MemoryMap = std::map<size_t, MemoryItem>;
@@ -199,6 +222,26 @@ public:
    */
   void setInCoreMaxObjectCount(size_t max);
 
+  /**
+   * Compress the objects saved to the storage files
+   * @param enable true to compress the objects saved from now
+   */
+  void setCompression(bool enable);
+
+  /**
+   * Set the background IO threads prefetching the objects from the storage files
+   * @param threadCount the number of IO threads (0 to disable the prefetching)
+   * @param maxMemorySize the maximal memory size of the prefetched objects
+   */
+  void setPrefetching(size_t threadCount, size_t maxMemorySize);
+
+  /**
+   * Load an object from the storage in background, so it is in memory when acquired
+   * @param objectId the object index to prefetch
+   * @return true if the object will be prefetched
+   */
+  bool prefetchObject(size_t objectId);
+
   /**
    * Create a new object of size block count
    * @param objectId the created object index
@@ -221,6 +264,14 @@ public:
    */
   size_t getActiveBlocks() const;
 
+  /**
+   * Get the maximal number of blocks simultaneously in core
+   * @return a block count
+   */
+  size_t getInCoreMaxBlockCount() const {
+    return _incoreBlockUsageMax;
+  }
+
 protected:
 
   std::string getPathForIndex(size_t indexId);
@@ -228,8 +279,8 @@ protected:
   void wipe();
 
   bool prepareBlockGroup(size_t startBlockId, size_t blocksCount);
-  std::unique_ptr<unsigned char> load(size_t startBlockId, size_t blocksCount);
-  bool save(std::unique_ptr<unsigned char> && data, size_t startBlockId, size_t blockCount);
+  std::unique_ptr<unsigned char> load(size_t startBlockId, size_t blocksCount, size_t storedSize);
+  bool save(std::unique_ptr<unsigned char> && data, size_t startBlockId, size_t blockCount, size_t & storedSize);
   bool saveObject(std::unique_ptr<unsigned char> && data, size_t objectId);
 
   virtual void onRemovedFromMRU(size_t objectId) = 0;
@@ -237,7 +288,14 @@ protected:
   void addFreeBlock(size_t blockId, size_t blockCount);
   size_t getFreeBlockId(size_t blockCount);
 
-  
+  std::unique_ptr<unsigned char> readBlocks(const std::string & path, size_t position, size_t length, size_t storedSize) const;
+
+  void startIOThreads(size_t threadCount);
+  void stopIOThreads();
+  void ioThreadLoop();
+  bool takePrefetchedObject(std::unique_ptr<unsigned char> & data, size_t objectId);
+  void cancelPrefetch(size_t objectId);
+  void releasePrefetchedObjects(size_t blockCount);
 
 protected:
   size_t _blockSize{0};
@@ -253,6 +311,43 @@ protected:
 
   MRUType _mru;
   MemoryMap _memoryMap;
+
+  bool _compression{false};
+
+  /*
+  An object to load from the storage by the IO threads
+  */
+  struct PrefetchTask
+  {
+    size_t objectId;
+    std::string path;
+    size_t position;
+    size_t length;
+    size_t storedSize;
+  };
+
+  /*
+  A prefetched object, waiting to be acquired
+  */
+  struct PrefetchedItem
+  {
+    std::unique_ptr<unsigned char> data;
+    size_t countBlock;
+  };
+
+  std::vector<std::thread> _ioThreads;
+  bool _stopIOThreads{false};
+  size_t _prefetchBlockMax{0};
+  size_t _prefetchBlockCount{0}; //< blocks prefetched or being prefetched
+
+  /* protect the prefetching data shared with the IO threads */
+  std::mutex _prefetchMutex;
+  std::condition_variable _prefetchTaskCondition;
+  std::condition_variable _prefetchDoneCondition;
+  std::deque<PrefetchTask> _prefetchTasks;
+  std::unordered_map<size_t, size_t> _prefetchLoading; //< objects queued or being read by an IO thread, to their block count
+  std::unordered_map<size_t, PrefetchedItem> _prefetched;
+  std::list<size_t> _prefetchedOrder; //< prefetched objects, from the oldest
 };
 
 /**
@@ -292,6 +387,13 @@ public:
    */
   bool acquire(size_t tileId);
 
+  /**
+   * Load a given tile in background
+   * @param tileId the tile index to prefetch
+   * @return true if the tile will be prefetched
+   */
+  bool prefetch(size_t tileId);
+
   /**
    * Acquire a given tile
    * @param width the requested tile size (less or equal to the base tile size)
@@ -0,0 +1,106 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/image/cache.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <vector>
+
+#define BOOST_TEST_MODULE ImageCache
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::image;
+
+namespace {
+
+const size_t tileSide = 64;
+const size_t nbTiles = 32;
+
+float getValue(size_t tileIndex, size_t pixelIndex)
+{
+    return float(tileIndex * 1000 + pixelIndex % 16);
+}
+
+/**
+ * @brief Create tiles with 4 tiles in core, write known values, then sweep them twice to swap them in and out.
+ * @return the number of wrong values
+ */
+size_t sweepTiles(bool compression, size_t nbIOThreads)
+{
+    const boost::filesystem::path cachePath = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    boost::filesystem::create_directories(cachePath);
+
+    size_t nbErrors = 0;
+    {
+        std::shared_ptr<TileCacheManager> manager = TileCacheManager::create(cachePath.string(), tileSide, tileSide, 8);
+        BOOST_REQUIRE(manager);
+
+        const size_t tileMemorySize = tileSide * tileSide * sizeof(float);
+        manager->setMaxMemory(4 * tileMemorySize);
+        manager->setCompression(compression);
+        manager->setPrefetching(nbIOThreads, 2 * tileMemorySize);
+
+        std::vector<CachedTile::smart_pointer> tiles;
+        for(size_t t = 0; t < nbTiles; ++t)
+        {
+            CachedTile::smart_pointer tile = manager->requireNewCachedTile<float>(tileSide, tileSide);
+            BOOST_REQUIRE(tile);
+            BOOST_REQUIRE(tile->acquire());
+
+            float* data = reinterpret_cast<float*>(tile->getDataPointer());
+            for(size_t i = 0; i < tileSide * tileSide; ++i)
+                data[i] = getValue(t, i);
+
+            tiles.push_back(tile);
+        }
+
+        for(int sweep = 0; sweep < 2; ++sweep)
+        {
+            for(size_t t = 0; t < nbTiles; ++t)
+            {
+                if(t + 1 < nbTiles)
+                    tiles[t + 1]->prefetch();
+
+                BOOST_REQUIRE(tiles[t]->acquire());
+
+                const float* data = reinterpret_cast<const float*>(tiles[t]->getDataPointer());
+                for(size_t i = 0; i < tileSide * tileSide; ++i)
+                    nbErrors += (data[i] != getValue(t, i));
+            }
+        }
+
+        // destroy some tiles with pending prefetches
+        for(size_t t = 0; t < nbTiles; t += 2)
+        {
+            tiles[t]->prefetch();
+            tiles[t].reset();
+        }
+    }
+
+    boost::filesystem::remove_all(cachePath);
+    return nbErrors;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(TileCacheManager_swap)
+{
+    BOOST_CHECK_EQUAL(sweepTiles(false, 0), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TileCacheManager_compression)
+{
+    BOOST_CHECK_EQUAL(sweepTiles(true, 0), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TileCacheManager_prefetching)
+{
+    BOOST_CHECK_EQUAL(sweepTiles(false, 2), 0);
+    BOOST_CHECK_EQUAL(sweepTiles(true, 2), 0);
+}
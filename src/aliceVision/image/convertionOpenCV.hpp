@@ -16,6 +16,9 @@
 
 #include <opencv2/core.hpp>
 
+#include <stdexcept>
+#include <string>
+
 namespace aliceVision{
 namespace image
 {
@@ -43,6 +46,32 @@ inline void setValueCvMatBGR(cv::Mat& mat, int i, int j, const image::RGBAfColor
 }
 
 
+/**
+ * @brief Implements the conversion of an aliceVision image to an OpenCV image in BGR, the rows are converted in parallel
+ * @tparam VecType - OpenCV vector type to interpret the mat values with
+ * @tparam ValueType - numeric type to cast the color values
+ * @param[in] img - input RGBA aliceVision image
+ * @param[inout] mat - output OpenCV mat, with the size of the input image
+ * @param[in] factor - optional scale factor
+ */
+template <typename VecType, typename ValueType>
+inline void imageRGBAToCvMatBGRImpl(const image::Image<image::RGBAfColor>& img, cv::Mat& mat, float factor = 1.f)
+{
+    #pragma omp parallel for
+    for(int i = 0; i < img.Height(); i++)
+    {
+        VecType* rowPtr = mat.ptr<VecType>(i);
+        for(int j = 0; j < img.Width(); j++)
+        {
+            const image::RGBAfColor& color = img(i, j);
+            rowPtr[j][0] = (ValueType) clamp(color.b() * factor, 0.f, 255.f);
+            rowPtr[j][1] = (ValueType) clamp(color.g() * factor, 0.f, 255.f);
+            rowPtr[j][2] = (ValueType) clamp(color.r() * factor, 0.f, 255.f);
+        }
+    }
+}
+
+
 /**
  * @brief Converts an aliceVision image to an OpenCV image (cv::Mat) in BGR
  * Ignores the alpha channel of the source image
@@ -53,22 +82,16 @@ inline void setValueCvMatBGR(cv::Mat& mat, int i, int j, const image::RGBAfColor
 inline cv::Mat imageRGBAToCvMatBGR(const image::Image<image::RGBAfColor>& img, int cvtype = CV_32FC3)
 {
     cv::Mat mat(img.Height(), img.Width(), cvtype);
-    for(int i = 0; i < img.Height(); i++)
+    switch(cvtype)
     {
-        for(int j = 0; j < img.Width(); j++)
-        {
-            switch(cvtype)
-            {
-                case CV_32FC3:
-                    setValueCvMatBGR<cv::Vec3f, float>(mat, i, j, img(i, j));
-                    break;
-                case CV_8UC3:
-                    setValueCvMatBGR<cv::Vec3b, uint8_t>(mat, i, j, img(i, j), 255.f);
-                    break;
-                default:
-                    std::runtime_error("Cannot handle OpenCV matrix type '" + std::to_string(cvtype) + "'.");
-            }
-        }
+        case CV_32FC3:
+            imageRGBAToCvMatBGRImpl<cv::Vec3f, float>(img, mat);
+            break;
+        case CV_8UC3:
+            imageRGBAToCvMatBGRImpl<cv::Vec3b, uint8_t>(img, mat, 255.f);
+            break;
+        default:
+            throw std::runtime_error("Cannot handle OpenCV matrix type '" + std::to_string(cvtype) + "'.");
     }
     return mat;
 }
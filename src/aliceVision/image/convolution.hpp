@@ -13,6 +13,8 @@
 #include <aliceVision/image/Image.hpp>
 #include <aliceVision/config.hpp>
 
+#include <algorithm>
+#include <type_traits>
 #include <vector>
 #include <cassert>
 
@@ -26,6 +28,11 @@
 namespace aliceVision {
 namespace image {
 
+/// Minimal number of pixels of an image to run the 1d convolutions in parallel
+const int convolution_parallel_min_pixels = 128 * 128 ;
+/// Number of columns of the tiles of the vertical convolution
+const int convolution_tile_width = 1024 ;
+
 /**
  ** General image convolution by a kernel
  ** assume kernel has odd size in both dimensions and (border pixel are copied)
@@ -91,8 +98,12 @@ void ImageHorizontalConvolution( const ImageTypeIn & img , const Kernel & kernel
   const int kernel_width = kernel.size() ;
   const int half_kernel_width = kernel_width / 2 ;
 
+  // rows are processed in parallel, each thread with its own padded line
+  #pragma omp parallel if( rows * cols >= convolution_parallel_min_pixels )
+  {
   std::vector<pix_t, Eigen::aligned_allocator<pix_t> > line( cols + kernel_width );
 
+  #pragma omp for schedule(static)
   for( int row = 0 ; row < rows ; ++row )
   {
     // Copy line
@@ -113,6 +124,7 @@ void ImageHorizontalConvolution( const ImageTypeIn & img , const Kernel & kernel
 
     memcpy(out.data() + row * cols, &line[0], sizeof(pix_t) * cols);
   }
+  }
 }
 
 /**
@@ -126,6 +138,7 @@ template< typename ImageTypeIn , typename ImageTypeOut, typename Kernel >
 void ImageVerticalConvolution( const ImageTypeIn & img , const Kernel & kernel , ImageTypeOut & out)
 {
   typedef typename ImageTypeIn::Tpixel pix_t ;
+  typedef typename std::decay<decltype( pix_t() * kernel.data()[0] )>::type acc_t ;
 
   const int kernel_width = kernel.size() ;
   const int half_kernel_width = kernel_width / 2 ;
@@ -135,32 +148,41 @@ void ImageVerticalConvolution( const ImageTypeIn & img , const Kernel & kernel ,
 
   out.resize( cols , rows ) ;
 
-  std::vector<pix_t, Eigen::aligned_allocator<pix_t> > line( rows + kernel_width );
+  // The output rows are accumulated from the contiguous input rows (instead of copying each column),
+  // by tiles of columns so the input rows of the kernel stay in cache.
+  // The sums are done in the same order as the 1d convolution of a column.
+  const int tile_width = std::min( cols , convolution_tile_width ) ;
+  const int nb_tiles = ( cols + tile_width - 1 ) / tile_width ;
 
-  for( int col = 0 ; col < cols ; ++col )
+  #pragma omp parallel if( rows * cols >= convolution_parallel_min_pixels )
   {
-    // Copy column
-    for( int k = 0 ; k < half_kernel_width ; ++k )
-    {
-      line[ k ] = img.coeffRef( 0 , col ) ;
-    }
-    for( int k = 0 ; k < rows ; ++k )
-    {
-      line[ k + half_kernel_width ] = img.coeffRef( k , col ) ;
-    }
-    for( int k = 0 ; k < half_kernel_width ; ++k )
+  std::vector<acc_t, Eigen::aligned_allocator<acc_t> > sums( tile_width );
+
+  #pragma omp for schedule(static)
+  for( int block = 0 ; block < rows * nb_tiles ; ++block )
+  {
+    const int row = block / nb_tiles ;
+    const int col_begin = ( block % nb_tiles ) * tile_width ;
+    const int width = std::min( tile_width , cols - col_begin ) ;
+
+    std::fill( sums.begin() , sums.begin() + width , acc_t( 0 ) ) ;
+    for( int k = 0 ; k < kernel_width ; ++k )
     {
-      line[ k + half_kernel_width + rows ] = img.coeffRef( rows - 1 , col ) ;
+      const int in_row = std::min( std::max( row + k - half_kernel_width , 0 ) , rows - 1 ) ;
+      const pix_t * in_pix = img.data() + in_row * cols + col_begin ;
+      const auto weight = kernel.data()[ k ] ;
+      for( int col = 0 ; col < width ; ++col )
+      {
+        sums[ col ] += in_pix[ col ] * weight ;
+      }
     }
 
-    // Apply convolution
-    conv_buffer_( &line[0] , kernel.data() , rows , kernel_width );
-
-    for( int row = 0 ; row < rows ; ++row )
+    for( int col = 0 ; col < width ; ++col )
     {
-      out.coeffRef( row , col ) = line[row];
+      out.coeffRef( row , col_begin + col ) = static_cast< pix_t >( sums[ col ] ) ;
     }
   }
+  }
 }
 
 /**
@@ -213,5 +235,20 @@ void ImageSeparableConvolution( const Image<float> & img ,
   SeparableConvolution2d(img.GetMat(), horiz_k_cast, vert_k_cast, &((Image<float>::Base&)out));
 }
 
+// Specialization for Image<RGBfColor>, the channels are weighted by the same scalar kernel
+template<typename Kernel>
+void ImageSeparableConvolution( const Image<RGBfColor> & img ,
+                                const Kernel & horiz_k ,
+                                const Kernel & vert_k ,
+                                Image<RGBfColor> & out)
+{
+  const Eigen::VectorXf horiz_k_cast = horiz_k.template cast< float >();
+  const Eigen::VectorXf vert_k_cast = vert_k.template cast< float >();
+
+  Image<RGBfColor> tmp ;
+  ImageHorizontalConvolution( img , horiz_k_cast , tmp ) ;
+  ImageVerticalConvolution( tmp , vert_k_cast , out ) ;
+}
+
 } // namespace image
 } // namespace aliceVision
@@ -8,6 +8,7 @@
 #pragma once
 
 #include <cstddef>
+#include <type_traits>
 
 namespace aliceVision {
 namespace image {
@@ -21,9 +22,11 @@ namespace image {
   template<class T1, class T2> inline
   void conv_buffer_( T1* buffer, const T2* kernel, int rsize, int ksize )
   {
+    // accumulate in the type of the weighted pixels (the kernel type for scalar pixels)
+    typedef typename std::decay<decltype( buffer[0] * kernel[0] )>::type acc_t;
     for( std::size_t i = 0; i < rsize; ++i )
     {
-      T2 sum( 0 );
+      acc_t sum( 0 );
       for ( std::size_t j = 0; j < ksize; ++j )
       {
         sum += buffer[i + j] * kernel[j];
@@ -11,7 +11,10 @@
 #include <iostream>
 #include <cstdio>
 #include <cstring>
+#include <ctime>
+#include <fstream>
 #include <functional>
+#include <mutex>
 
 namespace aliceVision {
 namespace image {
@@ -274,6 +277,35 @@ const DCPProfile::Matrix xyzD50ToSrgbD50LinearMatrix = { 3.1338561, -1.6168667,
 const DCPProfile::Matrix xyzD50ToACES2065Matrix = { 1.019573375, -0.022815668, 0.048147546, -0.503070253, 1.384421764, 0.121965628, 0.000961591, 0.003054793, 1.207019111 };
 
 const double TINT_SCALE = -3000.0;
+
+/**
+ * @brief Apply a 3x3 color matrix on the first 3 channels of a row of pixels.
+ *        The matrix is converted to float once, so the loop has no conversion and can be vectorized.
+ */
+void applyMatrixOnRow(const DCPProfile::Matrix& matrix, float* pixels, int nbPixels, int nbChannels)
+{
+    const float m00 = matrix[0][0], m01 = matrix[0][1], m02 = matrix[0][2];
+    const float m10 = matrix[1][0], m11 = matrix[1][1], m12 = matrix[1][2];
+    const float m20 = matrix[2][0], m21 = matrix[2][1], m22 = matrix[2][2];
+
+    for (int p = 0; p < nbPixels; ++p)
+    {
+        float* rgb = pixels + p * nbChannels;
+        const float r = rgb[0];
+        const float g = rgb[1];
+        const float b = rgb[2];
+        rgb[0] = m00 * r + m01 * g + m02 * b;
+        rgb[1] = m10 * r + m11 * g + m12 * b;
+        rgb[2] = m20 * r + m21 * g + m22 * b;
+    }
+}
+
+/// ROI of the first 3 channels of a row of an image buffer
+OIIO::ROI getRowRGBRoi(const OIIO::ImageBuf& image, int y)
+{
+    const OIIO::ROI roi = image.roi();
+    return OIIO::ROI(roi.xbegin, roi.xend, y, y + 1, roi.zbegin, roi.zbegin + 1, 0, 3);
+}
 } // namespace
 
 enum class TagType : int
@@ -363,18 +395,6 @@ int sget4(const unsigned char* s, Endianness order)
         return s[0] << 24 | s[1] << 16 | s[2] << 8 | s[3];
     }
 }
-inline unsigned short get2(FILE* f, Endianness order)
-{
-    unsigned char str[2] = {0xff, 0xff};
-    fread(str, 1, 2, f);
-    return sget2(str, order);
-}
-int get4(FILE* f, Endianness order)
-{
-    unsigned char str[4] = {0xff, 0xff, 0xff, 0xff};
-    fread(str, 1, 4, f);
-    return sget4(str, order);
-}
 short int int2_to_signed(short unsigned int i)
 {
     union
@@ -400,7 +420,8 @@ public:
     Endianness order{Endianness::UNKNOWN};
 
     Tag() = default;
-    Tag(unsigned short tag, TagType type, unsigned int datasize, Endianness order, FILE* f);
+    Tag(unsigned short tag, TagType type, unsigned int datasize, Endianness order, const std::vector<unsigned char>& data,
+        std::size_t valueOffset);
 
     ~Tag() = default;
 
@@ -413,27 +434,31 @@ public:
     std::string valueToString() const;
 };
 
-Tag::Tag(unsigned short tag, TagType type, unsigned int datasize, Endianness order, FILE* f)
-    : // file index supposed to be at rigth location to read datasize
+Tag::Tag(unsigned short tag, TagType type, unsigned int datasize, Endianness order, const std::vector<unsigned char>& data,
+         std::size_t valueOffset)
+    : // valueOffset is the position of the value field of the tag entry in the file data
     tagID(tag)
     , type(type)
     , datasize(datasize)
     , order(order)
 {
 
-    // load value field (possibly seek before)
-    const int valuesize = datasize * getTypeSize(type);
+    // the value field contains the value or its offset if it does not fit in 4 bytes
+    const std::size_t valuesize = datasize * getTypeSize(type);
 
+    std::size_t offset = valueOffset;
     if(valuesize > 4)
     {
-        fseek(f, get4(f, order), SEEK_SET);
+        offset = (valueOffset + 4 <= data.size()) ? static_cast<unsigned int>(sget4(&data[valueOffset], order)) : data.size();
     }
 
-    // read value
-    // value = new unsigned char[valuesize + 1];
+    // read value, truncated at the end of the data
+    const std::size_t readSize = (offset < data.size()) ? std::min(valuesize, data.size() - offset) : 0;
     v_value.resize(valuesize + 1);
-    auto readSize = fread(v_value.data(), 1, valuesize, f);
-    // value[readSize] = '\0';
+    if(readSize > 0)
+    {
+        std::memcpy(v_value.data(), &data[offset], readSize);
+    }
     v_value[readSize] = '\0';
 }
 
@@ -821,6 +846,15 @@ float SplineToneCurve::getval(const float idx) const
 }
 
 
+struct DCPProfile::MatrixCache
+{
+    /// key: the quantized neutral and the application flags
+    using Key = std::array<long long, 5>;
+
+    std::mutex mutex;
+    std::map<Key, Matrix> matrices;
+};
+
 DCPProfile::DCPProfile()
     : baseline_exposure_offset(0.0)
     , analogBalance(IdentityMatrix)
@@ -832,6 +866,7 @@ DCPProfile::DCPProfile()
     , forward_matrix_2(IdentityMatrix)
     , ws_sRGB(IdentityMatrix)
     , sRGB_ws(IdentityMatrix)
+    , aces_matrix_cache(std::make_shared<MatrixCache>())
 {}
 
 DCPProfile::DCPProfile(const std::string& filename)
@@ -845,6 +880,7 @@ DCPProfile::DCPProfile(const std::string& filename)
     , forward_matrix_2(IdentityMatrix)
     , ws_sRGB(IdentityMatrix)
     , sRGB_ws(IdentityMatrix)
+    , aces_matrix_cache(std::make_shared<MatrixCache>())
 {
     Load(filename);
 }
@@ -854,6 +890,7 @@ DCPProfile::~DCPProfile() = default;
 void DCPProfile::Load(const std::string& filename)
 {
     delta_info.hue_step = delta_info.val_step = look_info.hue_step = look_info.val_step = 0;
+    aces_matrix_cache = std::make_shared<MatrixCache>();
     constexpr int tiff_float_size = 4;
 
     static const float adobe_camera_raw_default_curve[] = {
@@ -952,39 +989,51 @@ void DCPProfile::Load(const std::string& filename)
         0.99837f, 0.99851f, 0.99865f, 0.99879f, 0.99892f, 0.99906f, 0.99920f, 0.99933f, 0.99947f, 0.99960f, 0.99974f,
         0.99987f, 1.00000f };
 
-    FILE* const file = fopen(filename.c_str(), "rb");
-
-    if (file == nullptr)
+    // the profile is read at once and the tags are parsed from memory
+    std::vector<unsigned char> data;
     {
-        ALICEVISION_THROW_ERROR("Unable to load DCP profile " << filename);
+        std::ifstream file(filename, std::ios::binary | std::ios::ate);
+        if (!file)
+        {
+            ALICEVISION_THROW_ERROR("Unable to load DCP profile " << filename);
+        }
+        data.resize(static_cast<std::size_t>(file.tellg()));
+        file.seekg(0, std::ios::beg);
+        file.read(reinterpret_cast<char*>(data.data()), data.size());
     }
 
     // read tiff header
-    fseek(file, 0, SEEK_SET);
-    unsigned short bo;
-    fread(&bo, 1, 2, file);
-    Endianness order = (Endianness)((int)bo);
-    get2(file, order);
-    int ifdOffset = get4(file, order);
+    if (data.size() < 10)
+    {
+        ALICEVISION_LOG_WARNING("DCP Error: Invalid file " << filename);
+        return;
+    }
+    const Endianness order = (Endianness)((int)(data[0] | data[1] << 8));
+    std::size_t ifdOffset = static_cast<unsigned int>(sget4(&data[4], order));
+    if (ifdOffset + 2 > data.size())
+    {
+        ifdOffset = 8;
+    }
 
     // read tags
-    const int numOfTags = get2(file, order);
+    const int numOfTags = sget2(&data[ifdOffset], order);
 
-    if (numOfTags <= 0 || numOfTags > 1000)
+    if (numOfTags <= 0 || numOfTags > 1000 || ifdOffset + 2 + numOfTags * 12 > data.size())
     {
         ALICEVISION_LOG_WARNING("DCP Error: Tag number out of range.");
-        fclose(file);
         return;
     }
 
     std::vector<Tag> v_tag;
+    v_tag.reserve(numOfTags);
 
     for (int i = 0; i < numOfTags; i++)
     {
-
-        unsigned short tag = get2(file, order);
-        TagType type = (TagType)get2(file, order);
-        unsigned int datasize = get4(file, order);
+        // tag entry: tag id, type, count and value (or value offset)
+        const std::size_t entryOffset = ifdOffset + 2 + i * 12;
+        unsigned short tag = sget2(&data[entryOffset], order);
+        TagType type = (TagType)sget2(&data[entryOffset + 2], order);
+        unsigned int datasize = sget4(&data[entryOffset + 4], order);
 
         if (!datasize)
         {
@@ -997,23 +1046,13 @@ void DCPProfile::Load(const std::string& filename)
         if ((int)type < 1 || (int)type > 14 || datasize > 10 * 1024 * 1024)
         {
             type = TagType::T_INVALID;
-            fclose(file);
             ALICEVISION_LOG_WARNING("ERROR : Invalid Tag in dcp file or file too big : datasize = " << datasize);
             return;
         }
 
-        // store next Tag's position in file
-        int save = ftell(file) + 4;
-
-        Tag t(tag, type, datasize, order, file);
-
-        v_tag.push_back(t);
-
-        fseek(file, save, SEEK_SET);
+        v_tag.emplace_back(tag, type, datasize, order, data, entryOffset + 8);
     }
 
-    fclose(file);
-
     info.filename = filename;
 
     const Tag* tag = findTag(TagKey::CALIBRATION_ILLUMINANT_1, v_tag);
@@ -1283,16 +1322,24 @@ void DCPProfile::Load(const std::string& filename)
         info.profileCalibrationSignature = tag->valueToString();
     }
 
-    std::vector<double> gammatab_srgb_data;
-    std::vector<double> igammatab_srgb_data;
-    for (int i = 0; i < 65536; i++)
+    // the sRGB gamma curves do not depend on the profile, they are computed once
+    static const std::pair<SplineToneCurve, SplineToneCurve> srgbGammaCurves = []()
     {
-        double x = i / 65535.0;
-        gammatab_srgb_data.push_back((x <= 0.003040) ? (x * 12.92310) : (1.055 * exp(log(x) / 2.4) - 0.055)); // from RT
-        igammatab_srgb_data.push_back((x <= 0.039286) ? (x / 12.92310) : (exp(log((x + 0.055) / 1.055) * 2.4))); // from RT
-    }
-    gammatab_srgb.Set(gammatab_srgb_data);
-    igammatab_srgb.Set(igammatab_srgb_data);
+        std::vector<double> gammatab_srgb_data;
+        std::vector<double> igammatab_srgb_data;
+        for (int i = 0; i < 65536; i++)
+        {
+            double x = i / 65535.0;
+            gammatab_srgb_data.push_back((x <= 0.003040) ? (x * 12.92310) : (1.055 * exp(log(x) / 2.4) - 0.055)); // from RT
+            igammatab_srgb_data.push_back((x <= 0.039286) ? (x / 12.92310) : (exp(log((x + 0.055) / 1.055) * 2.4))); // from RT
+        }
+        std::pair<SplineToneCurve, SplineToneCurve> curves;
+        curves.first.Set(gammatab_srgb_data);
+        curves.second.Set(igammatab_srgb_data);
+        return curves;
+    }();
+    gammatab_srgb = srgbGammaCurves.first;
+    igammatab_srgb = srgbGammaCurves.second;
 }
 
 void DCPProfile::Load(const std::map<std::string, std::string>& metadata)
@@ -1398,24 +1445,33 @@ void DCPProfile::apply(OIIO::ImageBuf& image, const DCPProfileApplyParams& param
         }
     }
 
-    // Apply DCP profile
-#pragma omp parallel for
-    for (int i = 0; i < image.spec().height; ++i)
-        for (int j = 0; j < image.spec().width; ++j)
+    // Apply DCP profile, the pixels are read and written by rows
+    const int width = image.spec().width;
+    const int ybegin = image.roi().ybegin;
+#pragma omp parallel
+    {
+        std::vector<float> row(width * 3);
+#pragma omp for
+        for (int i = 0; i < image.spec().height; ++i)
         {
-            float rgb[3];
-            image.getpixel(j, i, rgb, 3);
-            for (int c = 0; c < 3; ++c)
-            {
-                rgb[c] *= 65535.0;
-            }
-            apply(rgb, params);
-            for (int c = 0; c < 3; ++c)
+            const OIIO::ROI rowRoi = getRowRGBRoi(image, ybegin + i);
+            image.get_pixels(rowRoi, OIIO::TypeDesc::FLOAT, row.data());
+            for (int j = 0; j < width; ++j)
             {
-                rgb[c] /= 65535.0;
+                float* rgb = &row[j * 3];
+                for (int c = 0; c < 3; ++c)
+                {
+                    rgb[c] *= 65535.0;
+                }
+                apply(rgb, params);
+                for (int c = 0; c < 3; ++c)
+                {
+                    rgb[c] /= 65535.0;
+                }
             }
-            image.setpixel(j, i, rgb, 3);
+            image.set_pixels(rowRoi, OIIO::TypeDesc::FLOAT, row.data());
         }
+    }
 }
 
 void DCPProfile::apply(float* rgb, const DCPProfileApplyParams& params) const
@@ -2165,6 +2221,31 @@ DCPProfile::Matrix DCPProfile::getCameraToSrgbLinearMatrix(const double x, const
 }
 
 DCPProfile::Matrix DCPProfile::getCameraToACES2065Matrix(const Triple& asShotNeutral, const bool sourceIsRaw, const bool useColorMatrixOnly) const
+{
+    // the images shot with the same white balance share the same matrix
+    // the neutral is quantized so the small numerical differences of the camera multipliers hit the same entry
+    constexpr double neutralQuantization = 1e6;
+    const MatrixCache::Key key = {std::llround(asShotNeutral[0] * neutralQuantization),
+                                  std::llround(asShotNeutral[1] * neutralQuantization),
+                                  std::llround(asShotNeutral[2] * neutralQuantization),
+                                  sourceIsRaw, useColorMatrixOnly};
+    {
+        std::lock_guard<std::mutex> lock(aces_matrix_cache->mutex);
+        const auto it = aces_matrix_cache->matrices.find(key);
+        if (it != aces_matrix_cache->matrices.end())
+        {
+            return it->second;
+        }
+    }
+
+    const Matrix matrix = computeCameraToACES2065Matrix(asShotNeutral, sourceIsRaw, useColorMatrixOnly);
+
+    std::lock_guard<std::mutex> lock(aces_matrix_cache->mutex);
+    aces_matrix_cache->matrices.emplace(key, matrix);
+    return matrix;
+}
+
+DCPProfile::Matrix DCPProfile::computeCameraToACES2065Matrix(const Triple& asShotNeutral, const bool sourceIsRaw, const bool useColorMatrixOnly) const
 {
     const Triple asShotNeutralInv = { 1.0 / asShotNeutral[0] , 1.0 / asShotNeutral[1] , 1.0 / asShotNeutral[2] };
 
@@ -2276,6 +2357,8 @@ void DCPProfile::getMatricesAsStrings(const std::string& type, std::vector<std::
 
 void DCPProfile::setMatrices(const std::string& type, std::vector<Matrix>& v_Mat)
 {
+    aces_matrix_cache = std::make_shared<MatrixCache>();
+
     if (type == "forward")
     {
         info.has_forward_matrix_1 = false;
@@ -2347,24 +2430,20 @@ void DCPProfile::applyLinear(OIIO::ImageBuf& image, const Triple& neutral, const
 
     ALICEVISION_LOG_INFO("cameraToACES2065Matrix : " << cameraToACES2065Matrix);
 
-    #pragma omp parallel for
-    for (int i = 0; i < image.spec().height; ++i)
-        for (int j = 0; j < image.spec().width; ++j)
+    const int width = image.spec().width;
+    const int ybegin = image.roi().ybegin;
+    #pragma omp parallel
+    {
+        std::vector<float> row(width * 3);
+        #pragma omp for
+        for (int i = 0; i < image.spec().height; ++i)
         {
-            float rgb[3];
-            image.getpixel(j, i, rgb, 3);
-
-            float rgbOut[3];
-            for (int r = 0; r < 3; ++r)
-            {
-                rgbOut[r] = 0.0;
-                for (int c = 0; c < 3; ++c)
-                {
-                    rgbOut[r] += cameraToACES2065Matrix[r][c] * rgb[c];
-                }
-            }
-            image.setpixel(j, i, rgbOut, 3);
+            const OIIO::ROI rowRoi = getRowRGBRoi(image, ybegin + i);
+            image.get_pixels(rowRoi, OIIO::TypeDesc::FLOAT, row.data());
+            applyMatrixOnRow(cameraToACES2065Matrix, row.data(), width, 3);
+            image.set_pixels(rowRoi, OIIO::TypeDesc::FLOAT, row.data());
         }
+    }
 }
 
 void DCPProfile::applyLinear(Image<image::RGBAfColor>& image, const Triple& neutral, const bool sourceIsRaw, const bool useColorMatrixOnly) const
@@ -2373,23 +2452,28 @@ void DCPProfile::applyLinear(Image<image::RGBAfColor>& image, const Triple& neut
 
     ALICEVISION_LOG_INFO("cameraToACES2065Matrix : " << cameraToACES2065Matrix);
 
+    // the rows of the image are contiguous RGBA floats
     #pragma omp parallel for
     for (int i = 0; i < image.Height(); ++i)
-        for (int j = 0; j < image.Width(); ++j)
-        {
-            const RGBAfColor rgb = image(i, j);
+        applyMatrixOnRow(cameraToACES2065Matrix, image(i, 0).data(), image.Width(), 4);
+}
 
-            RGBAfColor rgbOut = rgb;
-            for (int r = 0; r < 3; ++r)
-            {
-                rgbOut[r] = 0.0;
-                for (int c = 0; c < 3; ++c)
-                {
-                    rgbOut[r] += cameraToACES2065Matrix[r][c] * rgb[c];
-                }
-            }
-            image(i, j) = rgbOut;
-        }
+std::shared_ptr<const DCPProfile> getCachedDCPProfile(const std::string& filename)
+{
+    static std::mutex cacheMutex;
+    static std::map<std::string, std::pair<std::time_t, std::shared_ptr<const DCPProfile>>> cache;
+
+    boost::system::error_code ec;
+    const std::time_t lastWriteTime = bfs::last_write_time(filename, ec);
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    std::pair<std::time_t, std::shared_ptr<const DCPProfile>>& entry = cache[filename];
+    if (!entry.second || entry.first != lastWriteTime)
+    {
+        entry.second = std::make_shared<const DCPProfile>(filename);
+        entry.first = lastWriteTime;
+    }
+    return entry.second;
 }
 
 DCPDatabase::DCPDatabase(const std::string& databaseDirPath)
@@ -2399,12 +2483,15 @@ DCPDatabase::DCPDatabase(const std::string& databaseDirPath)
 
 int DCPDatabase::load(const std::string& databaseDirPath, bool force)
 {
+    std::lock_guard<std::mutex> lock(dcpMutex);
+
     if (!databaseDirPath.compare(folderName) && !force)
     {
         return dcpFilenamesList.size();
     }
 
-    clear();
+    dcpFilenamesList.clear();
+    dcpStore.clear();
 
     folderName = databaseDirPath;
 
@@ -2428,6 +2515,7 @@ int DCPDatabase::load(const std::string& databaseDirPath, bool force)
 
 void DCPDatabase::clear()
 {
+    std::lock_guard<std::mutex> lock(dcpMutex);
     dcpFilenamesList.clear();
     dcpStore.clear();
     folderName = "";
@@ -2437,6 +2525,8 @@ bool DCPDatabase::retrieveDcpForCamera(const std::string& make, const std::strin
 {
     const std::string dcpKey = make + "_" + model;
 
+    std::lock_guard<std::mutex> lock(dcpMutex);
+
     {
         // Retrieve preloaded DCPProfile
         std::map<std::string, image::DCPProfile>::iterator it = dcpStore.find(dcpKey);
@@ -2454,7 +2544,7 @@ bool DCPDatabase::retrieveDcpForCamera(const std::string& make, const std::strin
 
         if (it != dcpFilenamesList.end())
         {
-            dcpProf.Load(*it);
+            dcpProf = *getCachedDCPProfile(*it);
             dcpStore.insert(std::pair<std::string, image::DCPProfile>(dcpKey, dcpProf));
             return true;
         }
@@ -2467,6 +2557,8 @@ void DCPDatabase::add_or_replace(DCPProfile& dcpProf, const std::string& make, c
 {
     const std::string dcpKey = make + "_" + model;
 
+    std::lock_guard<std::mutex> lock(dcpMutex);
+
     std::map<std::string, image::DCPProfile>::iterator it = dcpStore.find(dcpKey);
     if (it != dcpStore.end())
     {
@@ -4,6 +4,7 @@
 #include <vector>
 #include <array>
 #include <memory>
+#include <mutex>
 #include <string>
 
 #include <OpenImageIO/imagebuf.h>
@@ -279,6 +280,7 @@ private:
     Matrix getCameraToXyzD50Matrix(const double x, const double y) const;
     Matrix getCameraToSrgbLinearMatrix(const double x, const double y) const;
     Matrix getCameraToACES2065Matrix(const Triple& asShotNeutral, const bool sourceIsRaw = false, const bool useColorMatrixOnly = false) const;
+    Matrix computeCameraToACES2065Matrix(const Triple& asShotNeutral, const bool sourceIsRaw, const bool useColorMatrixOnly) const;
 
     Matrix ws_sRGB; // working color space to sRGB
     Matrix sRGB_ws; // sRGB to working color space
@@ -300,8 +302,20 @@ private:
 
     SplineToneCurve gammatab_srgb;
     SplineToneCurve igammatab_srgb;
+
+    struct MatrixCache;
+    /// camera to ACES2065 matrices per neutral, shared by the copies of the profile and reset when the matrices change
+    std::shared_ptr<MatrixCache> aces_matrix_cache;
 };
 
+/**
+ * @brief Get a DCP profile loaded from a file.
+ * The profiles are parsed once per process and shared between the threads, a modified file is parsed again.
+ * param[in] filename The dcp path on disk
+ * return The shared profile
+ */
+std::shared_ptr<const DCPProfile> getCachedDCPProfile(const std::string& filename);
+
 /**
 * @brief DCPDatabase manages DCP profiles loading and caching
 */
@@ -367,6 +381,9 @@ private:
 
     std::map<std::string, DCPProfile> dcpStore;
 
+    /// the database can be queried from parallel loops
+    std::mutex dcpMutex;
+
 };
 
 
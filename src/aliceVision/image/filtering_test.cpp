@@ -62,6 +62,31 @@ BOOST_AUTO_TEST_CASE(Image_Convolution_MeanBoxFilter)
   ImageConvolution(in, meanBoxFilterKernel, out);
 }
 
+BOOST_AUTO_TEST_CASE(Image_Convolution_1d_Parallel)
+{
+  // large enough for the parallel and tiled convolutions
+  Image<float> in(1500, 180);
+  for( int i = 0; i < in.Height(); i++)
+    for( int j = 0; j < in.Width(); j++)
+      in(i,j) = float((i * 7 + j * 13) % 255);
+
+  Vec kernel(5);
+  kernel << 0.1, 0.2, 0.4, 0.2, 0.1;
+
+  Image<float> outHorizontal;
+  ImageHorizontalConvolution( in, kernel, outHorizontal);
+  Image<float> refHorizontal;
+  ImageConvolution( in, Mat(kernel.transpose()), refHorizontal);
+
+  Image<float> outVertical;
+  ImageVerticalConvolution( in, kernel, outVertical);
+  Image<float> refVertical;
+  ImageConvolution( in, Mat(kernel), refVertical);
+
+  BOOST_CHECK_SMALL((outHorizontal.GetMat() - refHorizontal.GetMat()).array().abs().maxCoeff(), 1e-3f);
+  BOOST_CHECK_SMALL((outVertical.GetMat() - refVertical.GetMat()).array().abs().maxCoeff(), 1e-3f);
+}
+
 BOOST_AUTO_TEST_CASE(Image_Convolution_Scharr_X_Y)
 {
   Image<float> in(40,40,true);
@@ -19,7 +19,7 @@ namespace imageAlgo
 float func_XYZtoLAB(float t)
 {
     if(t > 0.008856f)
-        return std::pow(t, 1.0f/3.0f);
+        return std::cbrt(t);
     else
         return t / 0.1284f + 0.1379f;
 }
@@ -27,57 +27,149 @@ float func_XYZtoLAB(float t)
 float func_LABtoXYZ(float t)
 {
     if(t > 0.2069f)
-        return std::pow(t, 3.0f);
+        return t * t * t;
     else
         return 0.1284f * (t - 0.1379f);
 }
 
-void RGBtoXYZ(oiio::ImageBuf::Iterator<float>& pixel)
+namespace {
+
+// Conversions of the 3 first channels of a pixel, in place
+
+inline void pixelRGBtoXYZ(float* pixel)
 {
-    const Eigen::Vector3f rgb(pixel[0], pixel[1], pixel[2]);
-    Eigen::Matrix3f M;
-    M << 0.4124f, 0.3576f, 0.1805f,
-            0.2126f, 0.7152f, 0.0722f,
-            0.0193f, 0.1192f, 0.9504f;
-    const Eigen::Vector3f xyz_vec = M * rgb;
+    const float r = pixel[0];
+    const float g = pixel[1];
+    const float b = pixel[2];
 
-    pixel[0] = xyz_vec[0] * 0.9505f;
-    pixel[1] = xyz_vec[1];
-    pixel[2] = xyz_vec[2] * 1.0890f;
+    pixel[0] = (0.4124f * r + 0.3576f * g + 0.1805f * b) * 0.9505f;
+    pixel[1] = 0.2126f * r + 0.7152f * g + 0.0722f * b;
+    pixel[2] = (0.0193f * r + 0.1192f * g + 0.9504f * b) * 1.0890f;
 }
 
-void XYZtoRGB(oiio::ImageBuf::Iterator<float>& pixel)
+inline void pixelXYZtoRGB(float* pixel)
 {
-    const Eigen::Vector3f xyz(pixel[0] / 0.9505f, pixel[1], pixel[2] / 1.0890f);
-    Eigen::Matrix3f M;
-    M << 3.2406f, -1.5372f, -0.4986f,
-            -0.9689f, 1.8758f, 0.0415f,
-            0.0557f, -0.2040f, 1.0570f;
-    const Eigen::Vector3f rgb_vec = M * xyz;
+    const float x = pixel[0] / 0.9505f;
+    const float y = pixel[1];
+    const float z = pixel[2] / 1.0890f;
 
-    pixel[0] = rgb_vec[0];
-    pixel[1] = rgb_vec[1];
-    pixel[2] = rgb_vec[2];
+    pixel[0] = 3.2406f * x - 1.5372f * y - 0.4986f * z;
+    pixel[1] = -0.9689f * x + 1.8758f * y + 0.0415f * z;
+    pixel[2] = 0.0557f * x - 0.2040f * y + 1.0570f * z;
 }
 
-void XYZtoLAB(oiio::ImageBuf::Iterator<float>& pixel)
+inline void pixelXYZtoLAB(float* pixel)
 {
-    float L = 116.0f * func_XYZtoLAB(pixel[1]) - 16.0f;
-    float A = 500.0f * (func_XYZtoLAB(pixel[0]) - func_XYZtoLAB(pixel[1]));
-    float B = 200.0f * (func_XYZtoLAB(pixel[1]) - func_XYZtoLAB(pixel[2]));
+    const float fx = func_XYZtoLAB(pixel[0]);
+    const float fy = func_XYZtoLAB(pixel[1]);
+    const float fz = func_XYZtoLAB(pixel[2]);
+
+    // L, A and B divided by 100
+    pixel[0] = 1.16f * fy - 0.16f;
+    pixel[1] = 5.0f * (fx - fy);
+    pixel[2] = 2.0f * (fy - fz);
+}
 
-    pixel[0] = L / 100.0f;
-    pixel[1] = A / 100.0f;
-    pixel[2] = B / 100.0f;
+inline void pixelLABtoXYZ(float* pixel)
+{
+    const float L_offset = (pixel[0] * 100.0f + 16.0f) / 116.0f;
+
+    const float x = func_LABtoXYZ(L_offset + pixel[1] * 100.0f / 500.0f);
+    const float y = func_LABtoXYZ(L_offset);
+    const float z = func_LABtoXYZ(L_offset - pixel[2] * 100.0f / 200.0f);
+
+    pixel[0] = x;
+    pixel[1] = y;
+    pixel[2] = z;
 }
 
-void LABtoXYZ(oiio::ImageBuf::Iterator<float>& pixel)
+inline void pixelRGBtoLAB(float* pixel)
+{
+    pixelRGBtoXYZ(pixel);
+    pixelXYZtoLAB(pixel);
+}
+
+inline void pixelLABtoRGB(float* pixel)
+{
+    pixelLABtoXYZ(pixel);
+    pixelXYZtoRGB(pixel);
+}
+
+/**
+ * @brief Apply a pixel conversion on a float image, in parallel by rows.
+ *        The pixels are accessed directly in the rows of the image memory, without iterator nor indirect call.
+ */
+template<typename PixelFunc>
+void convertPixels(oiio::ImageBuf& image, PixelFunc pixelFunc)
 {
-    float L_offset = (pixel[0] * 100.0f + 16.0f) / 116.0f;
+    const oiio::ImageSpec& spec = image.spec();
+    if(spec.nchannels < 3)
+        return;
+
+    if(spec.format != oiio::TypeDesc::FLOAT || image.localpixels() == nullptr)
+    {
+        // not in memory as float, use the generic iterator
+        processImage(image, [&pixelFunc](oiio::ImageBuf::Iterator<float>& it) {
+            float pixel[3] = {it[0], it[1], it[2]};
+            pixelFunc(pixel);
+            it[0] = pixel[0];
+            it[1] = pixel[1];
+            it[2] = pixel[2];
+        });
+        return;
+    }
 
-    pixel[0] = func_LABtoXYZ(L_offset + pixel[1] * 100.0f / 500.0f);
-    pixel[1] = func_LABtoXYZ(L_offset);
-    pixel[2] = func_LABtoXYZ(L_offset - pixel[2] * 100.0f / 200.0f);
+    const oiio::stride_t pixelStride = image.pixel_stride() / oiio::stride_t(sizeof(float));
+
+    oiio::ImageBufAlgo::parallel_image(image.roi(), [&image, &pixelFunc, pixelStride](oiio::ROI roi) {
+        for(int z = roi.zbegin; z < roi.zend; ++z)
+        {
+            for(int y = roi.ybegin; y < roi.yend; ++y)
+            {
+                float* pixel = static_cast<float*>(image.pixeladdr(roi.xbegin, y, z));
+                for(int x = roi.xbegin; x < roi.xend; ++x, pixel += pixelStride)
+                    pixelFunc(pixel);
+            }
+        }
+    });
+}
+
+} // namespace
+
+void RGBtoXYZ(oiio::ImageBuf::Iterator<float>& pixel)
+{
+    float p[3] = {pixel[0], pixel[1], pixel[2]};
+    pixelRGBtoXYZ(p);
+    pixel[0] = p[0];
+    pixel[1] = p[1];
+    pixel[2] = p[2];
+}
+
+void XYZtoRGB(oiio::ImageBuf::Iterator<float>& pixel)
+{
+    float p[3] = {pixel[0], pixel[1], pixel[2]};
+    pixelXYZtoRGB(p);
+    pixel[0] = p[0];
+    pixel[1] = p[1];
+    pixel[2] = p[2];
+}
+
+void XYZtoLAB(oiio::ImageBuf::Iterator<float>& pixel)
+{
+    float p[3] = {pixel[0], pixel[1], pixel[2]};
+    pixelXYZtoLAB(p);
+    pixel[0] = p[0];
+    pixel[1] = p[1];
+    pixel[2] = p[2];
+}
+
+void LABtoXYZ(oiio::ImageBuf::Iterator<float>& pixel)
+{
+    float p[3] = {pixel[0], pixel[1], pixel[2]};
+    pixelLABtoXYZ(p);
+    pixel[0] = p[0];
+    pixel[1] = p[1];
+    pixel[2] = p[2];
 }
 
 void RGBtoLAB(oiio::ImageBuf::Iterator<float>& pixel)
@@ -154,16 +246,16 @@ void colorconvert(oiio::ImageBuf& imgBuf, image::EImageColorSpace fromColorSpace
                                              EImageColorSpace_enumToOIIOString(EImageColorSpace::SRGB),
                                              EImageColorSpace_enumToOIIOString(EImageColorSpace::LINEAR));
         else if(fromColorSpace == EImageColorSpace::XYZ)
-            processImage(imgBuf, &XYZtoRGB);
+            convertPixels(imgBuf, &pixelXYZtoRGB);
         else if(fromColorSpace == EImageColorSpace::LAB)
-            processImage(imgBuf, &LABtoRGB);
+            convertPixels(imgBuf, &pixelLABtoRGB);
     }
     else if(toColorSpace == EImageColorSpace::SRGB)
     {
         if(fromColorSpace == EImageColorSpace::XYZ)
-            processImage(imgBuf, &XYZtoRGB);
+            convertPixels(imgBuf, &pixelXYZtoRGB);
         else if(fromColorSpace == EImageColorSpace::LAB)
-            processImage(imgBuf, &LABtoRGB);
+            convertPixels(imgBuf, &pixelLABtoRGB);
         oiio::ImageBufAlgo::colorconvert(imgBuf, imgBuf,
                                          EImageColorSpace_enumToOIIOString(EImageColorSpace::LINEAR),
                                          EImageColorSpace_enumToOIIOString(EImageColorSpace::SRGB));
@@ -171,30 +263,30 @@ void colorconvert(oiio::ImageBuf& imgBuf, image::EImageColorSpace fromColorSpace
     else if(toColorSpace == EImageColorSpace::XYZ)
     {
         if(fromColorSpace == EImageColorSpace::LINEAR)
-            processImage(imgBuf, &RGBtoXYZ);
+            convertPixels(imgBuf, &pixelRGBtoXYZ);
         else if(fromColorSpace == EImageColorSpace::SRGB)
         {
             oiio::ImageBufAlgo::colorconvert(imgBuf, imgBuf,
                                              EImageColorSpace_enumToOIIOString(EImageColorSpace::SRGB),
                                              EImageColorSpace_enumToOIIOString(EImageColorSpace::LINEAR));
-            processImage(imgBuf, &RGBtoXYZ);
+            convertPixels(imgBuf, &pixelRGBtoXYZ);
         }
         else if(fromColorSpace == EImageColorSpace::LAB)
-            processImage(imgBuf, &LABtoXYZ);
+            convertPixels(imgBuf, &pixelLABtoXYZ);
     }
     else if(toColorSpace == EImageColorSpace::LAB)
     {
         if(fromColorSpace == EImageColorSpace::LINEAR)
-            processImage(imgBuf, &RGBtoLAB);
+            convertPixels(imgBuf, &pixelRGBtoLAB);
         else if(fromColorSpace == EImageColorSpace::SRGB)
         {
             oiio::ImageBufAlgo::colorconvert(imgBuf, imgBuf,
                                              EImageColorSpace_enumToOIIOString(EImageColorSpace::SRGB),
                                              EImageColorSpace_enumToOIIOString(EImageColorSpace::LINEAR));
-            processImage(imgBuf, &RGBtoLAB);
+            convertPixels(imgBuf, &pixelRGBtoLAB);
         }
         else if(fromColorSpace == EImageColorSpace::XYZ)
-            processImage(imgBuf, &XYZtoLAB);
+            convertPixels(imgBuf, &pixelXYZtoLAB);
     }
     ALICEVISION_LOG_TRACE("Convert image from " << EImageColorSpace_enumToString(fromColorSpace) << " to " << EImageColorSpace_enumToString(toColorSpace));
 }
@@ -0,0 +1,185 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "imageCache.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <cstdlib>
+#include <sstream>
+
+namespace fs = boost::filesystem;
+
+namespace aliceVision {
+namespace image {
+
+ImageCache::ImageCache(std::size_t maxSize)
+  : _maxSize(maxSize)
+{
+}
+
+ImageCache& ImageCache::getInstance()
+{
+    static ImageCache instance([]() {
+        const char* sizeMB = std::getenv("ALICEVISION_IMAGE_CACHE_SIZE");
+        return (sizeMB != nullptr) ? std::size_t(std::strtoull(sizeMB, nullptr, 10)) * 1024 * 1024 : std::size_t(0);
+    }());
+    return instance;
+}
+
+std::string ImageCache::getFileKey(const std::string& path)
+{
+    boost::system::error_code ec;
+    const std::time_t writeTime = fs::last_write_time(path, ec);
+    return path + "|" + std::to_string(ec ? std::time_t(0) : writeTime);
+}
+
+std::string ImageCache::getReadKey(const std::string& path, const ImageReadOptions& options)
+{
+    std::ostringstream key;
+    key << getFileKey(path)
+        << "|" << EImageColorSpace_enumToString(options.workingColorSpace)
+        << "|" << ERawColorInterpretation_enumToString(options.rawColorInterpretation)
+        << "|" << options.colorProfileFileName
+        << "|" << options.useDCPColorMatrixOnly << options.doWBAfterDemosaicing
+        << "|" << options.demosaicingAlgo
+        << "|" << options.highlightMode
+        << "|" << options.downscale;
+    return key.str();
+}
+
+std::shared_ptr<void> ImageCache::getGeneric(const std::string& key, const Loader& load, bool* loaded)
+{
+    if(loaded != nullptr)
+        *loaded = false;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    auto it = _entries.find(key);
+    if(it != _entries.end())
+    {
+        ++_nbHits;
+        _lru.splice(_lru.begin(), _lru, it->second.lruIt);
+        const std::shared_future<std::shared_ptr<void>> image = it->second.image;
+        lock.unlock();
+
+        // wait if the image is being decoded by another thread
+        return image.get();
+    }
+
+    ++_nbMisses;
+
+    // register the image as being decoded, so the other requests wait for it
+    std::promise<std::shared_ptr<void>> promise;
+    Entry& entry = _entries[key];
+    entry.image = promise.get_future().share();
+    _lru.push_front(key);
+    entry.lruIt = _lru.begin();
+    lock.unlock();
+
+    std::pair<std::shared_ptr<void>, std::size_t> image;
+    try
+    {
+        image = load();
+    }
+    catch(...)
+    {
+        lock.lock();
+        it = _entries.find(key);
+        if(it != _entries.end() && !it->second.ready)
+        {
+            _lru.erase(it->second.lruIt);
+            _entries.erase(it);
+        }
+        lock.unlock();
+
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+
+    promise.set_value(image.first);
+
+    if(loaded != nullptr)
+        *loaded = true;
+
+    lock.lock();
+    it = _entries.find(key);
+    if(it != _entries.end() && !it->second.ready)
+    {
+        it->second.ready = true;
+        it->second.size = image.second;
+        _size += image.second;
+        evict();
+    }
+
+    return image.first;
+}
+
+bool ImageCache::containsGeneric(const std::string& key) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto it = _entries.find(key);
+    return (it != _entries.end()) && it->second.ready;
+}
+
+void ImageCache::evict()
+{
+    auto lruIt = _lru.end();
+    while(_size > _maxSize && lruIt != _lru.begin())
+    {
+        --lruIt;
+        const auto it = _entries.find(*lruIt);
+        if(!it->second.ready)
+            continue;
+
+        _size -= it->second.size;
+        _entries.erase(it);
+        lruIt = _lru.erase(lruIt);
+    }
+}
+
+void ImageCache::setMaxSize(std::size_t maxSize)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _maxSize = maxSize;
+    evict();
+}
+
+std::size_t ImageCache::getMaxSize() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _maxSize;
+}
+
+std::size_t ImageCache::getSize() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _size;
+}
+
+void ImageCache::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // the images being decoded are kept, their requests wait for them
+    auto lruIt = _lru.begin();
+    while(lruIt != _lru.end())
+    {
+        const auto it = _entries.find(*lruIt);
+        if(!it->second.ready)
+        {
+            ++lruIt;
+            continue;
+        }
+
+        _size -= it->second.size;
+        _entries.erase(it);
+        lruIt = _lru.erase(lruIt);
+    }
+}
+
+} // namespace image
+} // namespace aliceVision
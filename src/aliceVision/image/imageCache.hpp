@@ -0,0 +1,143 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/image/Image.hpp>
+#include <aliceVision/image/io.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+
+namespace aliceVision {
+namespace image {
+
+/**
+ * @brief Thread-safe LRU cache of decoded images, with a memory budget.
+ *
+ * The images are shared through shared_ptr handles: an image evicted from the cache stays valid
+ * for the handles still using it. When several threads request the same image, it is decoded only once.
+ * The process-wide instance is shared by the pipeline stages run in the same process,
+ * its budget is 0 (no image is kept) unless set by the application or by the environment variable
+ * ALICEVISION_IMAGE_CACHE_SIZE (in MB).
+ */
+class ImageCache
+{
+public:
+    /**
+     * @param[in] maxSize the memory budget (bytes)
+     */
+    explicit ImageCache(std::size_t maxSize = 0);
+
+    ImageCache(const ImageCache&) = delete;
+    ImageCache& operator=(const ImageCache&) = delete;
+
+    /// The process-wide cache
+    static ImageCache& getInstance();
+
+    /**
+     * @brief Get an image read with image::readImage.
+     * @param[in] path the image path, the file modification time is part of the key
+     * @param[in] options the read options (color space, raw interpretation, downscale...)
+     * @param[out] loaded true if the image was decoded by this call (optional)
+     */
+    template<typename TPix>
+    std::shared_ptr<Image<TPix>> get(const std::string& path, const ImageReadOptions& options, bool* loaded = nullptr)
+    {
+        return get<TPix>(getReadKey(path, options),
+                         [&path, &options](Image<TPix>& image) { readImage(path, image, options); }, loaded);
+    }
+
+    /**
+     * @brief Get an image decoded by a custom loader.
+     * @param[in] key the image key, it must identify all the decoding parameters
+     * @param[in] load the function decoding the image if it is not in the cache
+     * @param[out] loaded true if the image was decoded by this call (optional)
+     */
+    template<typename TPix>
+    std::shared_ptr<Image<TPix>> get(const std::string& key, const std::function<void(Image<TPix>&)>& load,
+                                     bool* loaded = nullptr)
+    {
+        const std::shared_ptr<void> image = getGeneric(getTypedKey<TPix>(key), [&load]() {
+            std::shared_ptr<Image<TPix>> image = std::make_shared<Image<TPix>>();
+            load(*image);
+            return std::make_pair(std::shared_ptr<void>(image), std::size_t(image->size()) * sizeof(TPix));
+        }, loaded);
+        return std::static_pointer_cast<Image<TPix>>(image);
+    }
+
+    /// Whether the image of a custom key is decoded in the cache
+    template<typename TPix>
+    bool contains(const std::string& key) const
+    {
+        return containsGeneric(getTypedKey<TPix>(key));
+    }
+
+    /// Set the memory budget (bytes), the least recently used images are evicted to fit in it
+    void setMaxSize(std::size_t maxSize);
+
+    std::size_t getMaxSize() const;
+
+    /// Memory used by the cached images (bytes)
+    std::size_t getSize() const;
+
+    /// Remove all the images from the cache
+    void clear();
+
+    /// Key of an image file, with its modification time so a rewritten file is decoded again
+    static std::string getFileKey(const std::string& path);
+
+    /// Number of requests served by a cached image (or by the decoding of another thread)
+    std::size_t getNbHits() const { return _nbHits; }
+    /// Number of images decoded
+    std::size_t getNbMisses() const { return _nbMisses; }
+
+private:
+    using Loader = std::function<std::pair<std::shared_ptr<void>, std::size_t>()>;
+
+    struct Entry
+    {
+        std::shared_future<std::shared_ptr<void>> image;
+        std::size_t size = 0;
+        bool ready = false;
+        std::list<std::string>::iterator lruIt;
+    };
+
+    template<typename TPix>
+    static std::string getTypedKey(const std::string& key)
+    {
+        return std::string(typeid(TPix).name()) + "|" + key;
+    }
+
+    static std::string getReadKey(const std::string& path, const ImageReadOptions& options);
+
+    std::shared_ptr<void> getGeneric(const std::string& key, const Loader& load, bool* loaded);
+    bool containsGeneric(const std::string& key) const;
+
+    /// Evict the least recently used decoded images over the budget, the mutex must be locked
+    void evict();
+
+    mutable std::mutex _mutex;
+    std::size_t _maxSize;
+    std::size_t _size = 0;
+    std::unordered_map<std::string, Entry> _entries;
+    /// keys from the most recently used
+    std::list<std::string> _lru;
+
+    std::atomic<std::size_t> _nbHits{0};
+    std::atomic<std::size_t> _nbMisses{0};
+};
+
+} // namespace image
+} // namespace aliceVision
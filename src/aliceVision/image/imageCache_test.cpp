@@ -0,0 +1,131 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/image/imageCache.hpp>
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#define BOOST_TEST_MODULE ImageDecodedCache
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::image;
+
+namespace {
+
+const int imageSide = 16;
+const std::size_t imageSize = imageSide * imageSide * sizeof(float);
+
+std::function<void(Image<float>&)> makeLoader(float value, std::atomic<int>& nbLoads)
+{
+    return [value, &nbLoads](Image<float>& image) {
+        ++nbLoads;
+        image.resize(imageSide, imageSide, true, value);
+    };
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(ImageCache_hits)
+{
+    ImageCache cache(4 * imageSize);
+    std::atomic<int> nbLoads(0);
+
+    bool loaded = false;
+    std::shared_ptr<Image<float>> image = cache.get<float>("a", makeLoader(1.f, nbLoads), &loaded);
+    BOOST_CHECK(loaded);
+    BOOST_CHECK_EQUAL((*image)(0, 0), 1.f);
+
+    std::shared_ptr<Image<float>> reused = cache.get<float>("a", makeLoader(2.f, nbLoads), &loaded);
+    BOOST_CHECK(!loaded);
+    BOOST_CHECK_EQUAL(image.get(), reused.get());
+
+    BOOST_CHECK_EQUAL(nbLoads, 1);
+    BOOST_CHECK_EQUAL(cache.getNbHits(), 1);
+    BOOST_CHECK_EQUAL(cache.getNbMisses(), 1);
+    BOOST_CHECK_EQUAL(cache.getSize(), imageSize);
+    BOOST_CHECK(cache.contains<float>("a"));
+
+    // the pixel type is part of the key
+    BOOST_CHECK(!cache.contains<unsigned char>("a"));
+}
+
+BOOST_AUTO_TEST_CASE(ImageCache_lruEviction)
+{
+    ImageCache cache(2 * imageSize);
+    std::atomic<int> nbLoads(0);
+
+    std::shared_ptr<Image<float>> a = cache.get<float>("a", makeLoader(1.f, nbLoads));
+    cache.get<float>("b", makeLoader(2.f, nbLoads));
+    cache.get<float>("a", makeLoader(1.f, nbLoads));
+    cache.get<float>("c", makeLoader(3.f, nbLoads));
+
+    // b is the least recently used
+    BOOST_CHECK(cache.contains<float>("a"));
+    BOOST_CHECK(!cache.contains<float>("b"));
+    BOOST_CHECK(cache.contains<float>("c"));
+    BOOST_CHECK_EQUAL(cache.getSize(), 2 * imageSize);
+
+    // an evicted image stays valid for its users
+    cache.setMaxSize(0);
+    BOOST_CHECK_EQUAL(cache.getSize(), 0);
+    BOOST_CHECK(!cache.contains<float>("a"));
+    BOOST_CHECK_EQUAL((*a)(imageSide - 1, imageSide - 1), 1.f);
+}
+
+BOOST_AUTO_TEST_CASE(ImageCache_noBudget)
+{
+    ImageCache cache(0);
+    std::atomic<int> nbLoads(0);
+
+    cache.get<float>("a", makeLoader(1.f, nbLoads));
+    cache.get<float>("a", makeLoader(1.f, nbLoads));
+
+    BOOST_CHECK_EQUAL(nbLoads, 2);
+    BOOST_CHECK_EQUAL(cache.getSize(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(ImageCache_loadError)
+{
+    ImageCache cache(4 * imageSize);
+    std::atomic<int> nbLoads(0);
+
+    BOOST_CHECK_THROW(cache.get<float>("a", [](Image<float>&) { throw std::runtime_error("unreadable"); }),
+                      std::runtime_error);
+    BOOST_CHECK(!cache.contains<float>("a"));
+
+    // the failed load is not cached
+    bool loaded = false;
+    cache.get<float>("a", makeLoader(1.f, nbLoads), &loaded);
+    BOOST_CHECK(loaded);
+    BOOST_CHECK(cache.contains<float>("a"));
+}
+
+BOOST_AUTO_TEST_CASE(ImageCache_concurrentLoads)
+{
+    ImageCache cache(4 * imageSize);
+    std::atomic<int> nbLoads(0);
+    const auto load = [&nbLoads](Image<float>& image) {
+        ++nbLoads;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        image.resize(imageSide, imageSide, true, 1.f);
+    };
+
+    std::vector<std::shared_ptr<Image<float>>> images(8);
+    std::vector<std::thread> threads;
+    for(std::size_t i = 0; i < images.size(); ++i)
+        threads.emplace_back([&cache, &images, &load, i]() { images[i] = cache.get<float>("a", load); });
+    for(std::thread& thread : threads)
+        thread.join();
+
+    BOOST_CHECK_EQUAL(nbLoads, 1);
+    for(const std::shared_ptr<Image<float>>& image : images)
+        BOOST_CHECK_EQUAL(image.get(), images.front().get());
+}
@@ -374,6 +374,75 @@ void readImageSize(const std::string& path, int& width, int& height)
     height = spec.height;
 }
 
+template<typename T>
+void readImageROI(const std::string& path, Image<T>& image, const oiio::ROI& roi, int nchannels)
+{
+    std::unique_ptr<oiio::ImageInput> in(oiio::ImageInput::open(path));
+
+    if(!in)
+        ALICEVISION_THROW_ERROR("Can't find/open image file '" << path << "'.");
+
+    const oiio::ImageSpec& spec = in->spec();
+    const oiio::ROI dataRoi = spec.roi();
+
+    if(!roi.defined() || roi.xbegin < dataRoi.xbegin || roi.ybegin < dataRoi.ybegin ||
+       roi.xend > dataRoi.xend || roi.yend > dataRoi.yend)
+        ALICEVISION_THROW_ERROR("The region of interest is not inside the data window of the image file '" << path << "'.");
+
+    if(spec.nchannels < nchannels)
+        ALICEVISION_THROW_ERROR("The image file '" << path << "' has " << spec.nchannels << " channels, " << nchannels << " are needed.");
+
+    image.resize(roi.width(), roi.height());
+
+    if(roi.width() <= 0 || roi.height() <= 0)
+        return;
+
+    // decoded region, aligned on the file tiles (if any)
+    oiio::ROI readRoi = roi;
+
+    if(spec.tile_width > 0)
+    {
+        readRoi.xbegin = dataRoi.xbegin + ((roi.xbegin - dataRoi.xbegin) / spec.tile_width) * spec.tile_width;
+        readRoi.ybegin = dataRoi.ybegin + ((roi.ybegin - dataRoi.ybegin) / spec.tile_height) * spec.tile_height;
+        readRoi.xend = std::min(dataRoi.xend, dataRoi.xbegin + divideRoundUp(roi.xend - dataRoi.xbegin, spec.tile_width) * spec.tile_width);
+        readRoi.yend = std::min(dataRoi.yend, dataRoi.ybegin + divideRoundUp(roi.yend - dataRoi.ybegin, spec.tile_height) * spec.tile_height);
+    }
+    else
+    {
+        // scanlines are decoded over the full width
+        readRoi.xbegin = dataRoi.xbegin;
+        readRoi.xend = dataRoi.xend;
+    }
+
+    Image<T> buffer(readRoi.width(), readRoi.height());
+
+    const bool success = (spec.tile_width > 0) ?
+        in->read_tiles(0, 0, readRoi.xbegin, readRoi.xend, readRoi.ybegin, readRoi.yend, spec.z, spec.z + 1, 0, nchannels, oiio::TypeDesc::FLOAT, buffer.data()) :
+        in->read_scanlines(0, 0, readRoi.ybegin, readRoi.yend, spec.z, 0, nchannels, oiio::TypeDesc::FLOAT, buffer.data());
+
+    in->close();
+
+    if(!success)
+        ALICEVISION_THROW_ERROR("Failed to read the region of interest of the image file '" << path << "'.");
+
+    // crop the decoded region
+    for(int y = 0; y < roi.height(); ++y)
+    {
+        const T* row = buffer.data() + static_cast<std::size_t>(y + roi.ybegin - readRoi.ybegin) * readRoi.width() + (roi.xbegin - readRoi.xbegin);
+        std::copy(row, row + roi.width(), &image(y, 0));
+    }
+}
+
+void readImageROI(const std::string& path, Image<float>& image, const oiio::ROI& roi)
+{
+    readImageROI(path, image, roi, 1);
+}
+
+void readImageROI(const std::string& path, Image<RGBAfColor>& image, const oiio::ROI& roi)
+{
+    readImageROI(path, image, roi, 4);
+}
+
 template<typename T>
 void getBufferFromImage(Image<T>& image,
                         oiio::TypeDesc format,
@@ -564,9 +633,67 @@ void readImage(const std::string& path,
         }
     }
 
-    oiio::ImageBuf inBuf(path, 0, 0, NULL, &configSpec);
+    // reduced resolution decoding
+    const int downscale = std::max(1, imageReadOptions.downscale);
+    int outWidth = 0;
+    int outHeight = 0;
+    int miplevel = 0;
+    if (downscale > 1)
+    {
+        const oiio::ImageSpec fullSpec = readImageSpec(path);
+        outWidth = fullSpec.width / downscale;
+        outHeight = fullSpec.height / downscale;
+
+        if (isRawImage)
+        {
+            configSpec.attribute("raw:half_size", 1); // LibRaw half size demosaicing
+        }
+        else
+        {
+            // largest multi-resolution level which is not smaller than the output image
+            oiio::ImageBuf levelsBuf(path);
+            if (levelsBuf.init_spec(path, 0, 0))
+            {
+                while (miplevel + 1 < levelsBuf.nmiplevels() && (2 << miplevel) <= downscale)
+                    ++miplevel;
+            }
+        }
+    }
+
+    oiio::ImageBuf inBuf;
+    bool isImageStorage = false; // inBuf wraps the image pixels
+
+    // decode directly in the image pixels if the channels and the size are the requested ones,
+    // the color conversion is then done in place
+    if (!isRawImage && format == oiio::TypeDesc::FLOAT)
+    {
+        std::unique_ptr<oiio::ImageInput> in(oiio::ImageInput::open(path, &configSpec));
+        if (in && in->seek_subimage(0, miplevel))
+        {
+            const oiio::ImageSpec levelSpec = in->spec();
+            if (levelSpec.nchannels == nchannels &&
+                (downscale == 1 || (levelSpec.width == outWidth && levelSpec.height == outHeight)))
+            {
+                image.resize(levelSpec.width, levelSpec.height, false);
+                if (!in->read_image(0, miplevel, 0, nchannels, oiio::TypeDesc::FLOAT, image.data()))
+                    ALICEVISION_THROW_ERROR("Failed to read the image file: '" << path << "'. " << in->geterror());
+
+                oiio::ImageSpec imageSpec = levelSpec;
+                imageSpec.set_format(oiio::TypeDesc::FLOAT);
+                oiio::ImageBuf imageBuf(imageSpec, image.data());
+                inBuf.swap(imageBuf);
+                isImageStorage = true;
+            }
+            in->close();
+        }
+    }
 
-    inBuf.read(0, 0, true, oiio::TypeDesc::FLOAT); // force image convertion to float (for grayscale and color space convertion)
+    if (!isImageStorage)
+    {
+        oiio::ImageBuf fileBuf(path, 0, miplevel, NULL, &configSpec);
+        fileBuf.read(0, miplevel, true, oiio::TypeDesc::FLOAT); // force image convertion to float (for grayscale and color space convertion)
+        inBuf.swap(fileBuf);
+    }
 
     if(!inBuf.initialized())
         ALICEVISION_THROW_ERROR("Failed to open the image file: '" << path << "'.");
@@ -581,7 +708,8 @@ void readImage(const std::string& path,
     if (!imageReadOptions.colorProfileFileName.empty() &&
         imageReadOptions.rawColorInterpretation == ERawColorInterpretation::DcpLinearProcessing)
     {
-        image::DCPProfile dcpProfile(imageReadOptions.colorProfileFileName);
+        // the profile is parsed once and its matrices are cached per neutral
+        const std::shared_ptr<const image::DCPProfile> dcpProfile = image::getCachedDCPProfile(imageReadOptions.colorProfileFileName);
 
         oiio::ParamValueList imgMetadata = readImageMetadata(path);
         std::string cam_mul = "";
@@ -609,7 +737,7 @@ void readImage(const std::string& path,
 
         ALICEVISION_LOG_TRACE("Apply DCP Linear processing with neutral = " << neutral);
 
-        dcpProfile.applyLinear(inBuf, neutral, imageReadOptions.doWBAfterDemosaicing, imageReadOptions.useDCPColorMatrixOnly);
+        dcpProfile->applyLinear(inBuf, neutral, imageReadOptions.doWBAfterDemosaicing, imageReadOptions.useDCPColorMatrixOnly);
     }
 
     // color conversion
@@ -659,6 +787,7 @@ void readImage(const std::string& path,
         fromColorSpaceName = "aces2065-1";
     }
 
+    // the color conversions are done in place, without copy of the pixels
     if ((imageReadOptions.workingColorSpace == EImageColorSpace::NO_CONVERSION) ||
         (imageReadOptions.workingColorSpace == EImageColorSpace_stringToEnum(fromColorSpaceName)))
     {
@@ -673,19 +802,25 @@ void readImage(const std::string& path,
         {
             throw std::runtime_error("ALICEVISION_ROOT is not defined, OCIO config file cannot be accessed.");
         }
-        oiio::ImageBuf colorspaceBuf;
         oiio::ColorConfig colorConfig(colorConfigPath);
-        oiio::ImageBufAlgo::colorconvert(colorspaceBuf, inBuf,
+        oiio::ImageBufAlgo::colorconvert(inBuf, inBuf,
             fromColorSpaceName,
             EImageColorSpace_enumToOIIOString(imageReadOptions.workingColorSpace), true, "", "",
             &colorConfig);
-        inBuf = colorspaceBuf;
     }
     else
     {
-        oiio::ImageBuf colorspaceBuf;
-        oiio::ImageBufAlgo::colorconvert(colorspaceBuf, inBuf, fromColorSpaceName, EImageColorSpace_enumToOIIOString(imageReadOptions.workingColorSpace));
-        inBuf = colorspaceBuf;
+        oiio::ImageBufAlgo::colorconvert(inBuf, inBuf, fromColorSpaceName, EImageColorSpace_enumToOIIOString(imageReadOptions.workingColorSpace));
+    }
+
+    // resize to the requested downscale, after the color conversion like imageAlgo::resizeImage on the full image
+    if (downscale > 1 && (inBuf.spec().width != outWidth || inBuf.spec().height != outHeight))
+    {
+        oiio::ImageSpec resizedSpec(outWidth, outHeight, inBuf.spec().nchannels, oiio::TypeDesc::FLOAT);
+        resizedSpec.extra_attribs = inBuf.spec().extra_attribs;
+        oiio::ImageBuf resizedBuf(resizedSpec);
+        oiio::ImageBufAlgo::resize(resizedBuf, inBuf);
+        inBuf.swap(resizedBuf);
     }
 
     // convert to grayscale if needed
@@ -701,7 +836,7 @@ void readImage(const std::string& path,
         const float weights[3] = {.2126f, .7152f, .0722f}; // To be changed if not sRGB Rec 709 Linear.
         oiio::ImageBuf grayscaleBuf;
         oiio::ImageBufAlgo::channel_sum(grayscaleBuf, inBuf, weights, convertionROI);
-        inBuf.copy(grayscaleBuf);
+        inBuf.swap(grayscaleBuf);
 
         // TODO: if inBuf.spec().nchannels == 4: premult?
     }
@@ -731,6 +866,10 @@ void readImage(const std::string& path,
         inBuf.swap(requestedBuf);
     }
 
+    // the pixels are already in the image if it was decoded in place
+    if (isImageStorage)
+        return;
+
     // copy pixels from oiio to eigen
     image.resize(inBuf.spec().width, inBuf.spec().height, false);
     {
@@ -747,32 +886,28 @@ void readImageNoFloat(const std::string& path,
                oiio::TypeDesc format,
                Image<T>& image)
 {
-  oiio::ImageSpec configSpec;
-
-  oiio::ImageBuf inBuf(path, 0, 0, NULL, &configSpec);
-
-  inBuf.read(0, 0, true, format);
+  std::unique_ptr<oiio::ImageInput> in(oiio::ImageInput::open(path));
 
-  if(!inBuf.initialized())
+  if(!in)
   {
     throw std::runtime_error("Cannot find/open image file '" + path + "'.");
   }
 
   // check picture channels number
-  if(inBuf.spec().nchannels != 1)
+  const oiio::ImageSpec& spec = in->spec();
+  if(spec.nchannels != 1)
   {
     throw std::runtime_error("Can't load channels of image file '" + path + "'.");
   }
-    
-  // copy pixels from oiio to eigen
-  image.resize(inBuf.spec().width, inBuf.spec().height, false);
-  {
-    oiio::ROI exportROI = inBuf.roi();
-    exportROI.chbegin = 0;
-    exportROI.chend = 1;
 
-    inBuf.get_pixels(exportROI, format, image.data());
+  // decode directly in the image pixels
+  image.resize(spec.width, spec.height, false);
+  if(!in->read_image(format, image.data()))
+  {
+    throw std::runtime_error("Cannot read image file '" + path + "': " + in->geterror());
   }
+
+  in->close();
 }
 
 bool containsHalfFloatOverflow(const oiio::ImageBuf& image)
@@ -792,6 +927,68 @@ bool containsHalfFloatOverflow(const oiio::ImageBuf& image)
     return false;
 }
 
+/**
+ * @brief Write an image buffer, as tiles and with the multi-resolution levels if requested for EXR files.
+ */
+bool writeImageBuffer(oiio::ImageBuf& buffer, const std::string& path, const ImageWriteOptions& options, bool isEXR)
+{
+    if(!isEXR)
+        return buffer.write(path);
+
+    if(options.getExrCompressionThreads() > 0)
+        oiio::attribute("exr_threads", options.getExrCompressionThreads());
+
+    const int tileSize = (options.getExrTileSize() > 0) ? options.getExrTileSize() : (options.getExrMipmaps() ? 64 : 0);
+
+    // the levels have no display window, it is kept only for single level files
+    const oiio::ImageSpec& bufferSpec = buffer.spec();
+    const bool isFullWindow = bufferSpec.x == 0 && bufferSpec.y == 0 && bufferSpec.full_x == 0 && bufferSpec.full_y == 0 &&
+                              bufferSpec.full_width == bufferSpec.width && bufferSpec.full_height == bufferSpec.height;
+
+    std::unique_ptr<oiio::ImageOutput> out;
+    if(options.getExrMipmaps() && isFullWindow)
+    {
+        out = oiio::ImageOutput::create(path);
+        if(out && !out->supports("mipmap"))
+            out.reset();
+    }
+
+    // tiled EXR, allows region of interest reads
+    if(tileSize > 0)
+        buffer.set_write_tiles(tileSize, tileSize);
+
+    if(!out)
+        return buffer.write(path);
+
+    oiio::ImageSpec spec = bufferSpec;
+    spec.tile_width = tileSize;
+    spec.tile_height = tileSize;
+    spec.tile_depth = 1;
+
+    if(!out->open(path, spec, oiio::ImageOutput::Create) || !buffer.write(out.get()))
+        return false;
+
+    // each level is the half resolution of the previous one
+    oiio::ImageBuf level;
+    const oiio::ImageBuf* previous = &buffer;
+    while(previous->spec().width > 1 || previous->spec().height > 1)
+    {
+        oiio::ImageSpec levelSpec = spec;
+        levelSpec.width = levelSpec.full_width = std::max(1, previous->spec().width / 2);
+        levelSpec.height = levelSpec.full_height = std::max(1, previous->spec().height / 2);
+
+        oiio::ImageBuf next(levelSpec);
+        if(!oiio::ImageBufAlgo::resize(next, *previous) ||
+           !out->open(path, levelSpec, oiio::ImageOutput::AppendMIPLevel) || !next.write(out.get()))
+            return false;
+
+        level.swap(next);
+        previous = &level;
+    }
+
+    return out->close();
+}
+
 template<typename T>
 void writeImage(const std::string& path,
                 oiio::TypeDesc typeDesc,
@@ -847,8 +1044,8 @@ void writeImage(const std::string& path,
                         (toColorSpace == EImageColorSpace::NO_CONVERSION)
                             ? EImageColorSpace_enumToString(fromColorSpace) : EImageColorSpace_enumToString(toColorSpace));
   
-    const oiio::ImageBuf imgBuf = oiio::ImageBuf(imageSpec, const_cast<T*>(image.data())); // original image buffer
-    const oiio::ImageBuf* outBuf = &imgBuf;  // buffer to write
+    oiio::ImageBuf imgBuf = oiio::ImageBuf(imageSpec, const_cast<T*>(image.data())); // original image buffer
+    oiio::ImageBuf* outBuf = &imgBuf;  // buffer to write
         
     oiio::ImageBuf colorspaceBuf = oiio::ImageBuf(imageSpec, const_cast<T*>(image.data())); // buffer for image colorspace modification
     if ((fromColorSpace == toColorSpace) || (toColorSpace == EImageColorSpace::NO_CONVERSION))
@@ -920,7 +1117,7 @@ void writeImage(const std::string& path,
     }
 
     // write image
-    if(!outBuf->write(tmpPath))
+    if(!writeImageBuffer(*outBuf, tmpPath, options, isEXR))
         ALICEVISION_THROW_ERROR("Can't write output image file '" + path + "'.");
 
     // rename temporary filename
@@ -1095,8 +1292,7 @@ void writeImageWithFloat(const std::string& path, const Image<IndexT>& image,
 }
 
 
-bool tryLoadMask(Image<unsigned char>* mask, const std::vector<std::string>& masksFolders,
-                 const IndexT viewId, const std::string & srcImage)
+std::string findMaskPath(const std::vector<std::string>& masksFolders, const IndexT viewId, const std::string& srcImage)
 {
     for (const auto & masksFolder_str : masksFolders)
     {
@@ -1107,18 +1303,22 @@ bool tryLoadMask(Image<unsigned char>* mask, const std::vector<std::string>& mas
             const auto nameMaskPath = masksFolder / fs::path(srcImage).filename().replace_extension("png");
 
             if (fs::exists(idMaskPath))
-            {
-                readImage(idMaskPath.string(), *mask, EImageColorSpace::LINEAR);
-                return true;
-            }
+                return idMaskPath.string();
             else if (fs::exists(nameMaskPath))
-            {
-                readImage(nameMaskPath.string(), *mask, EImageColorSpace::LINEAR);
-                return true;
-            }
+                return nameMaskPath.string();
         }
     }
-    return false;
+    return std::string();
+}
+
+bool tryLoadMask(Image<unsigned char>* mask, const std::vector<std::string>& masksFolders,
+                 const IndexT viewId, const std::string & srcImage)
+{
+    const std::string maskPath = findMaskPath(masksFolders, viewId, srcImage);
+    if (maskPath.empty())
+        return false;
+    readImage(maskPath, *mask, EImageColorSpace::LINEAR);
+    return true;
 }
 
 static std::string aliceVisionRootOverride;
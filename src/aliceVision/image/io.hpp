@@ -195,7 +195,7 @@ struct ImageReadOptions
         ERawColorInterpretation rawColorInterpretation = ERawColorInterpretation::LibRawWhiteBalancing,
         const std::string& colorProfile = "", const bool useDCPColorMatrixOnly = true, const oiio::ROI& roi = oiio::ROI()) :
         workingColorSpace(colorSpace), rawColorInterpretation(rawColorInterpretation), colorProfileFileName(colorProfile), useDCPColorMatrixOnly(useDCPColorMatrixOnly),
-        doWBAfterDemosaicing(false), demosaicingAlgo("AHD"), highlightMode(0), subROI(roi)
+        doWBAfterDemosaicing(false), demosaicingAlgo("AHD"), highlightMode(0), subROI(roi), downscale(1)
     {
     }
 
@@ -209,6 +209,9 @@ struct ImageReadOptions
     //ROI for this image.
     //If the image contains an roi, this is the roi INSIDE the roi.
     oiio::ROI subROI;
+    //Downscale of the output image (size divided by downscale like imageAlgo::resizeImage).
+    //RAW images are demosaiced at half resolution and multi-resolution images are read from the closest level.
+    int downscale;
 };
 
 /**
@@ -222,6 +225,9 @@ public:
     EImageColorSpace getFromColorSpace() const { return _fromColorSpace; }
     EImageColorSpace getToColorSpace() const { return _toColorSpace; }
     EStorageDataType getStorageDataType() const { return _storageDataType; }
+    int getExrTileSize() const { return _exrTileSize; }
+    bool getExrMipmaps() const { return _exrMipmaps; }
+    int getExrCompressionThreads() const { return _exrCompressionThreads; }
 
     ImageWriteOptions& fromColorSpace(EImageColorSpace colorSpace)
     {
@@ -241,10 +247,44 @@ public:
         return *this;
     }
 
+    /**
+     * @brief Write EXR files as square tiles instead of scanlines (0 for scanlines).
+     *        Tiled files allow to read a region of interest without decoding the full image.
+     */
+    ImageWriteOptions& exrTileSize(int tileSize)
+    {
+        _exrTileSize = tileSize;
+        return *this;
+    }
+
+    /**
+     * @brief Write EXR files with the successive half resolution levels (MIP map).
+     *        The levels are written as tiles (64x64 if no tile size is set),
+     *        they allow reduced resolution reads without decoding the full image.
+     */
+    ImageWriteOptions& exrMipmaps(bool mipmaps)
+    {
+        _exrMipmaps = mipmaps;
+        return *this;
+    }
+
+    /**
+     * @brief Number of threads of the OpenEXR compression (0 for the OpenImageIO default).
+     *        The OpenEXR thread pool is shared by the process, it keeps this size for the next files.
+     */
+    ImageWriteOptions& exrCompressionThreads(int nbThreads)
+    {
+        _exrCompressionThreads = nbThreads;
+        return *this;
+    }
+
 private:
     EImageColorSpace _fromColorSpace{EImageColorSpace::LINEAR};
     EImageColorSpace _toColorSpace{EImageColorSpace::AUTO};
     EStorageDataType _storageDataType{EStorageDataType::Undefined};
+    int _exrTileSize{0};
+    bool _exrMipmaps{false};
+    int _exrCompressionThreads{0};
 };
 
 /**
@@ -300,6 +340,21 @@ oiio::ImageSpec readImageSpec(const std::string& path);
  */
 void readImageSize(const std::string& path, int& width, int& height);
 
+/**
+ * @brief read a region of interest of the first channel of an image, without any conversion
+ * @note only the scanlines (or the tiles for tiled files) intersecting the region are decoded
+ * @param[in] path The given path to the image
+ * @param[out] image The output image buffer, of the region size
+ * @param[in] roi The region of interest in the image pixel coordinates, should be inside the image data window
+ */
+void readImageROI(const std::string& path, Image<float>& image, const oiio::ROI& roi);
+
+/**
+ * @brief read a region of interest of the RGBA channels of an image, without any conversion
+ * @see readImageROI
+ */
+void readImageROI(const std::string& path, Image<RGBAfColor>& image, const oiio::ROI& roi);
+
 /**
  * @brief get OIIO buffer from an AliceVision image
  * @param[in] image Image class
@@ -440,6 +495,12 @@ struct ColorTypeInfo<RGBAfColor>
     static const oiio::TypeDesc::BASETYPE typeDesc = oiio::TypeDesc::FLOAT;
 };
 
+/**
+ * @brief Find the mask of a view in the masks folders, named after the view id or after the source image.
+ * @return the mask path, or an empty string if there is no mask
+ */
+std::string findMaskPath(const std::vector<std::string>& masksFolders, const IndexT viewId, const std::string& srcImage);
+
 bool tryLoadMask(Image<unsigned char>* mask, const std::vector<std::string>& masksFolders,
                  const IndexT viewId, const std::string & srcImage);
 
@@ -0,0 +1,186 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "metadataCache.hpp"
+
+#include <aliceVision/image/io.hpp>
+#include <aliceVision/system/Logger.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include <iomanip>
+#include <sstream>
+
+namespace fs = boost::filesystem;
+namespace bpt = boost::property_tree;
+
+namespace aliceVision {
+namespace image {
+
+/// Increment when the content of the cache files changes
+static const int metadataCacheVersion = 1;
+
+ImageMetadataCache::ImageMetadataCache(const std::string& folder)
+  : _folder(folder)
+{
+    if(!fs::exists(_folder))
+        fs::create_directories(_folder);
+}
+
+std::string ImageMetadataCache::getCacheFilePath(const std::string& imageFolder) const
+{
+    std::ostringstream filename;
+    filename << "metadata_" << std::hex << std::setw(16) << std::setfill('0') << boost::hash<std::string>()(imageFolder) << ".json";
+    return (fs::path(_folder) / filename.str()).string();
+}
+
+ImageMetadataCache::Folder& ImageMetadataCache::getFolder(const std::string& imageFolder)
+{
+    auto it = _folders.find(imageFolder);
+    if(it != _folders.end())
+        return it->second;
+
+    Folder& folder = _folders[imageFolder];
+
+    const std::string cachePath = getCacheFilePath(imageFolder);
+    if(!fs::exists(cachePath))
+        return folder;
+
+    try
+    {
+        bpt::ptree fileTree;
+        bpt::read_json(cachePath, fileTree);
+
+        // the file name hash may collide, the folder is checked
+        if(fileTree.get<int>("version", 0) != metadataCacheVersion || fileTree.get<std::string>("folder", "") != imageFolder)
+            return folder;
+
+        for(const bpt::ptree::value_type& imageNode : fileTree.get_child("images"))
+        {
+            Entry entry;
+            entry.writeTime = imageNode.second.get<std::time_t>("writeTime");
+            entry.fileSize = imageNode.second.get<std::uintmax_t>("fileSize");
+            entry.width = imageNode.second.get<int>("width");
+            entry.height = imageNode.second.get<int>("height");
+
+            // the metadata keys are not parsed as paths, they may contain dots
+            for(const bpt::ptree::value_type& metadataNode : imageNode.second.get_child("metadata"))
+                entry.metadata.emplace(metadataNode.first, metadataNode.second.data());
+
+            folder.entries.emplace(imageNode.second.get<std::string>("filename"), std::move(entry));
+        }
+    }
+    catch(const std::exception& e)
+    {
+        ALICEVISION_LOG_WARNING("Ignore the invalid metadata cache file '" << cachePath << "': " << e.what());
+        folder.entries.clear();
+    }
+
+    return folder;
+}
+
+std::map<std::string, std::string> ImageMetadataCache::readImageMetadata(const std::string& path, int& width, int& height)
+{
+    const fs::path imagePath(path);
+    const std::string imageFolder = fs::absolute(imagePath).parent_path().string();
+    const std::string filename = imagePath.filename().string();
+
+    boost::system::error_code ec;
+    const std::time_t writeTime = fs::last_write_time(imagePath, ec);
+    const std::uintmax_t fileSize = ec ? 0 : fs::file_size(imagePath, ec);
+    const bool isValidFile = !ec;
+
+    if(isValidFile)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        const Folder& folder = getFolder(imageFolder);
+        const auto it = folder.entries.find(filename);
+        if(it != folder.entries.end() && it->second.writeTime == writeTime && it->second.fileSize == fileSize)
+        {
+            ++_nbHits;
+            width = it->second.width;
+            height = it->second.height;
+            return it->second.metadata;
+        }
+    }
+
+    Entry entry;
+    entry.writeTime = writeTime;
+    entry.fileSize = fileSize;
+    entry.metadata = getMapFromMetadata(image::readImageMetadata(path, entry.width, entry.height));
+
+    width = entry.width;
+    height = entry.height;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    ++_nbMisses;
+    if(isValidFile)
+    {
+        Folder& folder = getFolder(imageFolder);
+        folder.entries[filename] = entry;
+        folder.modified = true;
+    }
+    return entry.metadata;
+}
+
+void ImageMetadataCache::save()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    for(auto& folderPair : _folders)
+    {
+        Folder& folder = folderPair.second;
+        if(!folder.modified)
+            continue;
+
+        bpt::ptree fileTree;
+        fileTree.put("version", metadataCacheVersion);
+        fileTree.put("folder", folderPair.first);
+
+        bpt::ptree imagesTree;
+        for(const auto& entryPair : folder.entries)
+        {
+            const Entry& entry = entryPair.second;
+
+            bpt::ptree imageTree;
+            imageTree.put("filename", entryPair.first);
+            imageTree.put("writeTime", entry.writeTime);
+            imageTree.put("fileSize", entry.fileSize);
+            imageTree.put("width", entry.width);
+            imageTree.put("height", entry.height);
+
+            bpt::ptree metadataTree;
+            for(const auto& metadataPair : entry.metadata)
+                metadataTree.push_back(std::make_pair(metadataPair.first, bpt::ptree(metadataPair.second)));
+            imageTree.add_child("metadata", metadataTree);
+
+            imagesTree.push_back(std::make_pair("", imageTree));
+        }
+        fileTree.add_child("images", imagesTree);
+
+        // another process may use the same cache, the file is replaced once complete
+        const std::string cachePath = getCacheFilePath(folderPair.first);
+        const std::string tmpPath = cachePath + "." + fs::unique_path().string() + ".tmp";
+        try
+        {
+            bpt::write_json(tmpPath, fileTree);
+            fs::rename(tmpPath, cachePath);
+            folder.modified = false;
+        }
+        catch(const std::exception& e)
+        {
+            ALICEVISION_LOG_WARNING("Cannot write the metadata cache file '" << cachePath << "': " << e.what());
+            boost::system::error_code ec;
+            fs::remove(tmpPath, ec);
+        }
+    }
+}
+
+} // namespace image
+} // namespace aliceVision
@@ -0,0 +1,85 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace aliceVision {
+namespace image {
+
+/**
+ * @brief Persistent cache of the image files metadata.
+ *
+ * The metadata of the images of a folder are stored in one JSON file of the cache folder.
+ * An entry is valid while the image file keeps the same modification time and size,
+ * so scanning an unchanged dataset again does not open the image files.
+ * The cache is thread-safe.
+ */
+class ImageMetadataCache
+{
+public:
+    /**
+     * @param[in] folder the folder of the cache files, created if needed
+     */
+    explicit ImageMetadataCache(const std::string& folder);
+
+    ImageMetadataCache(const ImageMetadataCache&) = delete;
+    ImageMetadataCache& operator=(const ImageMetadataCache&) = delete;
+
+    /**
+     * @brief Get the metadata of an image file, it is read from the file only if it is not in the cache
+     * @param[in] path the image path
+     * @param[out] width the image header width
+     * @param[out] height the image header height
+     * @return the image metadata, as image::getMapFromMetadata
+     */
+    std::map<std::string, std::string> readImageMetadata(const std::string& path, int& width, int& height);
+
+    /// Write the cache files of the folders with new entries
+    void save();
+
+    /// Number of metadata read from the cache
+    std::size_t getNbHits() const { return _nbHits; }
+    /// Number of metadata read from the image files
+    std::size_t getNbMisses() const { return _nbMisses; }
+
+private:
+    struct Entry
+    {
+        std::time_t writeTime = 0;
+        std::uintmax_t fileSize = 0;
+        int width = 0;
+        int height = 0;
+        std::map<std::string, std::string> metadata;
+    };
+
+    struct Folder
+    {
+        /// entries by file name
+        std::map<std::string, Entry> entries;
+        bool modified = false;
+    };
+
+    /// Get the entries of an image folder, loaded from its cache file at the first use (the mutex must be locked)
+    Folder& getFolder(const std::string& imageFolder);
+
+    std::string getCacheFilePath(const std::string& imageFolder) const;
+
+    std::string _folder;
+    std::mutex _mutex;
+    std::map<std::string, Folder> _folders;
+
+    std::size_t _nbHits = 0;
+    std::size_t _nbMisses = 0;
+};
+
+} // namespace image
+} // namespace aliceVision
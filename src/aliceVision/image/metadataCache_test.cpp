@@ -0,0 +1,55 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/image/metadataCache.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <string>
+
+#define BOOST_TEST_MODULE ImageMetadataCache
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::image;
+
+namespace fs = boost::filesystem;
+
+BOOST_AUTO_TEST_CASE(ImageMetadataCache_persistence)
+{
+    const fs::path cachePath = fs::temp_directory_path() / fs::unique_path();
+    const std::string imagePath = std::string(THIS_SOURCE_DIR) + "/image_test/two_pixels_color.png";
+
+    int width = 0;
+    int height = 0;
+    {
+        ImageMetadataCache cache(cachePath.string());
+        cache.readImageMetadata(imagePath, width, height);
+        BOOST_CHECK_EQUAL(width, 2);
+        BOOST_CHECK_EQUAL(height, 1);
+
+        cache.readImageMetadata(imagePath, width, height);
+        BOOST_CHECK_EQUAL(cache.getNbMisses(), 1);
+        BOOST_CHECK_EQUAL(cache.getNbHits(), 1);
+
+        cache.save();
+    }
+
+    // a new cache reads the saved file
+    {
+        ImageMetadataCache cache(cachePath.string());
+        width = 0;
+        height = 0;
+        cache.readImageMetadata(imagePath, width, height);
+        BOOST_CHECK_EQUAL(width, 2);
+        BOOST_CHECK_EQUAL(height, 1);
+        BOOST_CHECK_EQUAL(cache.getNbMisses(), 0);
+        BOOST_CHECK_EQUAL(cache.getNbHits(), 1);
+    }
+
+    fs::remove_all(cachePath);
+}
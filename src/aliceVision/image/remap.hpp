@@ -0,0 +1,97 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/image/Image.hpp>
+#include <aliceVision/image/Sampler.hpp>
+
+#include <Eigen/Core>
+
+namespace aliceVision {
+namespace image {
+
+/**
+ * @brief Precomputed backward mapping of an output image: the source position of each output pixel.
+ *
+ * The layout is the one of the panorama CoordinatesMap (x, y source coordinates and a validity mask),
+ * so the same table can be reused for all the images sharing an output configuration.
+ */
+struct RemapTable
+{
+    /// source (x, y) position of each output pixel
+    Image<Eigen::Vector2f> coordinates;
+    /// non-zero where the source position is valid
+    Image<unsigned char> mask;
+
+    int Width() const { return coordinates.Width(); }
+    int Height() const { return coordinates.Height(); }
+
+    /**
+     * @brief Compute the table, the rows are computed in parallel
+     * @param[in] width The output image width
+     * @param[in] height The output image height
+     * @param[in] toSource Thread-safe functor bool(int x, int y, Eigen::Vector2f& sourcePosition),
+     *            returns false if the output pixel has no source
+     */
+    template <typename ToSourceFunc>
+    void build(int width, int height, const ToSourceFunc& toSource)
+    {
+        coordinates.resize(width, height, false);
+        mask.resize(width, height, true, 0);
+
+        #pragma omp parallel for
+        for(int y = 0; y < height; ++y)
+        {
+            for(int x = 0; x < width; ++x)
+            {
+                Eigen::Vector2f& sourcePosition = coordinates(y, x);
+                mask(y, x) = toSource(x, y, sourcePosition) ? 255 : 0;
+            }
+        }
+    }
+};
+
+/**
+ * @brief Bilinear resampling of a source image through a remap table, the rows are resampled in parallel
+ * @param[in] source The source image
+ * @param[in] table The remap table, with the output size
+ * @param[in,out] output The output image, resized if needed, the pixels without source are left unchanged
+ * @param[in] apply Functor void(T& outputPixel, const T& sampledPixel), to blend the samples into the output
+ */
+template <typename T, typename ApplyFunc>
+void remap(const Image<T>& source, const RemapTable& table, Image<T>& output, const ApplyFunc& apply)
+{
+    if(output.Width() != table.Width() || output.Height() != table.Height())
+        output.resize(table.Width(), table.Height(), true);
+
+    const Sampler2d<SamplerLinear> sampler;
+
+    #pragma omp parallel for
+    for(int y = 0; y < table.Height(); ++y)
+    {
+        for(int x = 0; x < table.Width(); ++x)
+        {
+            if(!table.mask(y, x))
+                continue;
+
+            const Eigen::Vector2f& sourcePosition = table.coordinates(y, x);
+            apply(output(y, x), sampler(source, sourcePosition(1), sourcePosition(0)));
+        }
+    }
+}
+
+/**
+ * @brief Bilinear resampling of a source image through a remap table, the samples replace the output pixels
+ */
+template <typename T>
+void remap(const Image<T>& source, const RemapTable& table, Image<T>& output)
+{
+    remap(source, table, output, [](T& outputPixel, const T& sampledPixel) { outputPixel = sampledPixel; });
+}
+
+} // namespace image
+} // namespace aliceVision
@@ -0,0 +1,66 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/image/remap.hpp>
+
+#define BOOST_TEST_MODULE ImageRemap
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::image;
+
+BOOST_AUTO_TEST_CASE(Remap_flipAndMask)
+{
+  Image<float> source(16, 8);
+  for(int y = 0; y < source.Height(); ++y)
+    for(int x = 0; x < source.Width(); ++x)
+      source(y, x) = static_cast<float>(y * 100 + x);
+
+  // horizontal flip of the left half, no source for the right half
+  RemapTable table;
+  table.build(16, 8, [](int x, int y, Eigen::Vector2f& sourcePosition) {
+    sourcePosition = Eigen::Vector2f(15 - x, y);
+    return x < 8;
+  });
+
+  Image<float> output(16, 8, true, -1.f);
+  remap(source, table, output);
+
+  for(int y = 0; y < output.Height(); ++y)
+  {
+    for(int x = 0; x < output.Width(); ++x)
+    {
+      if(x < 8)
+        BOOST_CHECK_CLOSE(output(y, x), source(y, 15 - x), 1e-4);
+      else
+        BOOST_CHECK_EQUAL(output(y, x), -1.f);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Remap_bilinearBlend)
+{
+  Image<float> source(4, 4);
+  for(int y = 0; y < source.Height(); ++y)
+    for(int x = 0; x < source.Width(); ++x)
+      source(y, x) = static_cast<float>(x);
+
+  // half a pixel shift, the samples are added to the output
+  RemapTable table;
+  table.build(3, 4, [](int x, int y, Eigen::Vector2f& sourcePosition) {
+    sourcePosition = Eigen::Vector2f(x + 0.5f, y);
+    return true;
+  });
+
+  Image<float> output(3, 4, true, 1.f);
+  remap(source, table, output, [](float& outputPixel, float sampledPixel) { outputPixel += sampledPixel; });
+
+  for(int y = 0; y < output.Height(); ++y)
+    for(int x = 0; x < output.Width(); ++x)
+      BOOST_CHECK_CLOSE(output(y, x), 1.f + x + 0.5f, 1e-4);
+}
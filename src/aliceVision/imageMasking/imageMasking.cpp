@@ -5,7 +5,6 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "imageMasking.hpp"
-#include "eigen2cvHelpers.hpp"
 
 #include <aliceVision/image/Image.hpp>
 #include <aliceVision/image/io.hpp>
@@ -13,7 +12,6 @@
 
 #include <opencv2/opencv.hpp>
 #include <opencv2/core/core.hpp>
-#include <opencv2/core/eigen.hpp>
 #include <opencv2/imgproc.hpp>
 
 namespace aliceVision{
@@ -35,16 +33,33 @@ cv::Mat wrapCvMask(OutImage& result)
     return cv::Mat(result.rows(), result.cols(), CV_8UC1, result.data(), result.rowStride());
 }
 
-void rotateHue(cv::Mat & hsv, uint8_t delta)
+cv::Mat wrapCvImage(image::Image<image::RGBColor>& image)
 {
-    // cannot use cv::add because it saturates the output.
+    static_assert(sizeof(image::RGBColor) == 3, "RGBColor must be packed to be wrapped as CV_8UC3");
+    // Eigen strides are in number of elements, OpenCV steps in bytes
+    return cv::Mat(image.rows(), image.cols(), CV_8UC3, image.data(), image.rowStride() * sizeof(image::RGBColor));
+}
+
+/**
+ * @brief Select the pixels in the HSV range once the hue is rotated by delta.
+ * The rotation and the thresholds are done in a single pass over the image.
+ */
+void rotatedHueInRange(const cv::Mat& hsv, uint8_t delta, const cv::Vec3b& low, const cv::Vec3b& high, cv::Mat& result)
+{
+    // the hue rotation wraps around, it cannot use cv::add because it saturates the output.
     // do not use forEach because this call is already parallelized.
-    for (int r = 0; r < hsv.rows; r++)
+    for(int r = 0; r < hsv.rows; ++r)
     {
-        for ( int c = 0; c < hsv.cols; c++)
+        const cv::Vec3b* hsvRow = hsv.ptr<cv::Vec3b>(r);
+        uint8_t* resultRow = result.ptr<uint8_t>(r);
+        for(int c = 0; c < hsv.cols; ++c)
         {
-            auto & pixel = hsv.at<cv::Point3_<uint8_t>>(r, c);
-            pixel.x += delta;
+            const cv::Vec3b& pixel = hsvRow[c];
+            const uint8_t h = uint8_t(pixel[0] + delta);
+            const bool inRange = h >= low[0] && h <= high[0] &&
+                                 pixel[1] >= low[1] && pixel[1] <= high[1] &&
+                                 pixel[2] >= low[2] && pixel[2] <= high[2];
+            resultRow[c] = inRange ? 255 : 0;
         }
     }
 }
@@ -60,13 +75,13 @@ void hsv(OutImage& result, const std::string& inputPath, float hue, float hueRan
     image::Image<image::RGBColor> input;
     image::readImage(inputPath, input, image::EImageColorSpace::SRGB);
 
+    // wrap the image buffer, the conversion to HSV colorspace writes in its own buffer
+    const cv::Mat input_cv = wrapCvImage(input);
     cv::Mat input_hsv;
-    cv::eigen2cv(input.GetMat(), input_hsv);    // copy the buffer, but a copy is needed to convert to HSV colorspace anyway.
-    cv::cvtColor(input_hsv, input_hsv, cv::COLOR_RGB2HSV_FULL);    // "_FULL" to encode hue in the [0, 255] range.
-    rotateHue(input_hsv, uint8_t((0.5f - hue)*256.f));    // hue == 0 <=> hue == 1
+    cv::cvtColor(input_cv, input_hsv, cv::COLOR_RGB2HSV_FULL);    // "_FULL" to encode hue in the [0, 255] range.
 
     result.resize(input.Width(), input.Height(), false);    // allocate un-initialized
-    const cv::Mat result_cv = wrapCvMask(result);
+    cv::Mat result_cv = wrapCvMask(result);
 
     const uint8_t lowH = remap_float2uint8(0.5f - hueRange);
     const uint8_t highH = remap_float2uint8(0.5f + hueRange);
@@ -74,7 +89,7 @@ void hsv(OutImage& result, const std::string& inputPath, float hue, float hueRan
     const uint8_t highS = remap_float2uint8(maxSaturation);
     const uint8_t lowV = remap_float2uint8(minValue);
     const uint8_t highV = remap_float2uint8(maxValue);
-    cv::inRange(input_hsv, cv::Scalar(lowH, lowS, lowV), cv::Scalar(highH, highS, highV), result_cv);
+    rotatedHueInRange(input_hsv, uint8_t((0.5f - hue)*256.f), {lowH, lowS, lowV}, {highH, highS, highV}, result_cv);    // hue == 0 <=> hue == 1
 };
 
 void autoGrayscaleThreshold(OutImage& result, const std::string& inputPath)
@@ -0,0 +1,369 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "HnswIndex.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <queue>
+#include <stdexcept>
+#include <unordered_set>
+
+namespace fs = boost::filesystem;
+
+namespace aliceVision {
+namespace imageMatching {
+
+namespace {
+
+/// Increment when the content of the index files changes
+const uint32_t hnswIndexVersion = 2;
+
+template<typename T>
+void writeValue(std::ostream& out, T value)
+{
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+T readValue(std::istream& in)
+{
+    T value;
+    in.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return value;
+}
+
+} // namespace
+
+HnswIndex::HnswIndex(std::size_t dimension, std::size_t key, const HnswParams& params)
+  : _dimension(dimension)
+  , _key(key)
+  , _params(params)
+  , _levelFactor(1.0 / std::log(std::max(params.nbLinks, std::size_t(2))))
+  , _generator(params.seed)
+{
+}
+
+float HnswIndex::distance(const float* a, const float* b) const
+{
+    float sum = 0.0f;
+    for(std::size_t d = 0; d < _dimension; ++d)
+    {
+        const float diff = a[d] - b[d];
+        sum += diff * diff;
+    }
+    return sum;
+}
+
+std::vector<HnswIndex::Candidate> HnswIndex::searchLayer(const float* query, const std::vector<uint32_t>& entryPoints,
+                                                         std::size_t ef, int level) const
+{
+    std::unordered_set<uint32_t> visited;
+    visited.reserve(ef * maxLinks(level));
+
+    // the candidates to explore from the closest, and the ef closest found nodes with the farthest on top
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> candidates;
+    std::priority_queue<Candidate> closest;
+
+    for(const uint32_t node : entryPoints)
+    {
+        if(!visited.insert(node).second)
+            continue;
+        const float dist = distance(query, nodeData(node));
+        candidates.emplace(dist, node);
+        closest.emplace(dist, node);
+    }
+    while(closest.size() > ef)
+        closest.pop();
+
+    while(!candidates.empty())
+    {
+        const Candidate current = candidates.top();
+        if(closest.size() >= ef && current.first > closest.top().first)
+            break;
+        candidates.pop();
+
+        for(const uint32_t neighbor : _links[current.second][level])
+        {
+            if(!visited.insert(neighbor).second)
+                continue;
+            const float dist = distance(query, nodeData(neighbor));
+            if(closest.size() < ef || dist < closest.top().first)
+            {
+                candidates.emplace(dist, neighbor);
+                closest.emplace(dist, neighbor);
+                if(closest.size() > ef)
+                    closest.pop();
+            }
+        }
+    }
+
+    std::vector<Candidate> result(closest.size());
+    for(std::size_t i = result.size(); i > 0; --i)
+    {
+        result[i - 1] = closest.top();
+        closest.pop();
+    }
+    return result;
+}
+
+std::vector<uint32_t> HnswIndex::selectNeighbors(const std::vector<Candidate>& candidates, std::size_t nbNeighbors) const
+{
+    // the candidates are sorted from the closest
+    std::vector<uint32_t> neighbors;
+    std::vector<uint32_t> pruned;
+    neighbors.reserve(nbNeighbors);
+
+    for(const Candidate& candidate : candidates)
+    {
+        if(neighbors.size() >= nbNeighbors)
+            break;
+
+        bool isDiverse = true;
+        for(const uint32_t neighbor : neighbors)
+        {
+            if(distance(nodeData(candidate.second), nodeData(neighbor)) < candidate.first)
+            {
+                isDiverse = false;
+                break;
+            }
+        }
+        if(isDiverse)
+            neighbors.push_back(candidate.second);
+        else
+            pruned.push_back(candidate.second);
+    }
+
+    // the links left are filled with the closest pruned candidates
+    for(std::size_t i = 0; i < pruned.size() && neighbors.size() < nbNeighbors; ++i)
+        neighbors.push_back(pruned[i]);
+
+    return neighbors;
+}
+
+uint32_t HnswIndex::descend(const float* query, int level) const
+{
+    uint32_t node = _entryPoint;
+    float nodeDistance = distance(query, nodeData(node));
+
+    for(int l = _maxLevel; l > level; --l)
+    {
+        bool improved = true;
+        while(improved)
+        {
+            improved = false;
+            for(const uint32_t neighbor : _links[node][l])
+            {
+                const float dist = distance(query, nodeData(neighbor));
+                if(dist < nodeDistance)
+                {
+                    nodeDistance = dist;
+                    node = neighbor;
+                    improved = true;
+                }
+            }
+        }
+    }
+    return node;
+}
+
+void HnswIndex::insert(IndexT id, const std::vector<float>& descriptor, std::uint64_t sourceKey)
+{
+    if(descriptor.size() != _dimension)
+        throw std::invalid_argument("The descriptor size " + std::to_string(descriptor.size()) +
+                                    " does not match the index dimension " + std::to_string(_dimension) + ".");
+    if(contains(id))
+        throw std::invalid_argument("The descriptor " + std::to_string(id) + " is already in the index.");
+
+    std::uniform_real_distribution<double> distribution(0.0, 1.0);
+    const int level = static_cast<int>(-std::log(1.0 - distribution(_generator)) * _levelFactor);
+
+    const uint32_t node = _ids.size();
+    _data.insert(_data.end(), descriptor.begin(), descriptor.end());
+    _ids.push_back(id);
+    _sourceKeys.push_back(sourceKey);
+    _indexById[id] = node;
+    _links.emplace_back(level + 1);
+
+    if(_maxLevel < 0)
+    {
+        _maxLevel = level;
+        _entryPoint = node;
+        return;
+    }
+
+    const float* query = nodeData(node);
+    std::vector<uint32_t> entryPoints(1, descend(query, level));
+
+    for(int l = std::min(level, _maxLevel); l >= 0; --l)
+    {
+        const std::vector<Candidate> candidates = searchLayer(query, entryPoints, _params.efConstruction, l);
+        _links[node][l] = selectNeighbors(candidates, _params.nbLinks);
+
+        // link back the neighbors, their links are selected again once too many
+        for(const uint32_t neighbor : _links[node][l])
+        {
+            std::vector<uint32_t>& neighborLinks = _links[neighbor][l];
+            neighborLinks.push_back(node);
+            if(neighborLinks.size() <= maxLinks(l))
+                continue;
+
+            std::vector<Candidate> neighborCandidates;
+            neighborCandidates.reserve(neighborLinks.size());
+            for(const uint32_t other : neighborLinks)
+                neighborCandidates.emplace_back(distance(nodeData(neighbor), nodeData(other)), other);
+            std::sort(neighborCandidates.begin(), neighborCandidates.end());
+            neighborLinks = selectNeighbors(neighborCandidates, maxLinks(l));
+        }
+
+        entryPoints.clear();
+        for(const Candidate& candidate : candidates)
+            entryPoints.push_back(candidate.second);
+    }
+
+    if(level > _maxLevel)
+    {
+        _maxLevel = level;
+        _entryPoint = node;
+    }
+}
+
+std::vector<HnswIndex::Match> HnswIndex::search(const float* query, std::size_t k, std::size_t ef,
+                                                const std::function<bool(IndexT)>& filter) const
+{
+    std::vector<Match> matches;
+    if(_ids.empty() || k == 0)
+        return matches;
+
+    const std::vector<uint32_t> entryPoints(1, descend(query, 0));
+    const std::vector<Candidate> candidates = searchLayer(query, entryPoints, std::max(ef, k), 0);
+
+    for(const Candidate& candidate : candidates)
+    {
+        const IndexT id = _ids[candidate.second];
+        if(filter && !filter(id))
+            continue;
+        matches.emplace_back(id, candidate.first);
+        if(matches.size() == k)
+            break;
+    }
+    return matches;
+}
+
+const float* HnswIndex::getDescriptor(IndexT id) const
+{
+    const auto it = _indexById.find(id);
+    return (it == _indexById.end()) ? nullptr : nodeData(it->second);
+}
+
+std::uint64_t HnswIndex::getSourceKey(IndexT id) const
+{
+    const auto it = _indexById.find(id);
+    return (it == _indexById.end()) ? 0 : _sourceKeys[it->second];
+}
+
+void HnswIndex::save(const std::string& path) const
+{
+    // write in a temporary file and rename it once complete
+    const std::string tmpPath = path + "." + fs::unique_path().string();
+    try
+    {
+        std::ofstream out;
+        out.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+        out.open(tmpPath, std::ios_base::binary);
+
+        writeValue<uint32_t>(out, hnswIndexVersion);
+        writeValue<uint64_t>(out, _dimension);
+        writeValue<uint64_t>(out, _key);
+        writeValue<uint64_t>(out, _params.nbLinks);
+        writeValue<uint64_t>(out, _params.efConstruction);
+        writeValue<uint32_t>(out, _params.seed);
+        writeValue<int32_t>(out, _maxLevel);
+        writeValue<uint32_t>(out, _entryPoint);
+        writeValue<uint64_t>(out, _ids.size());
+
+        if(!_data.empty())
+            out.write(reinterpret_cast<const char*>(_data.data()), _data.size() * sizeof(float));
+        for(std::size_t node = 0; node < _ids.size(); ++node)
+        {
+            writeValue<uint32_t>(out, _ids[node]);
+            writeValue<uint64_t>(out, _sourceKeys[node]);
+            writeValue<uint32_t>(out, _links[node].size());
+            for(const std::vector<uint32_t>& levelLinks : _links[node])
+            {
+                writeValue<uint32_t>(out, levelLinks.size());
+                if(!levelLinks.empty())
+                    out.write(reinterpret_cast<const char*>(levelLinks.data()), levelLinks.size() * sizeof(uint32_t));
+            }
+        }
+        out.close();
+        fs::rename(tmpPath, path);
+    }
+    catch(const std::exception& e)
+    {
+        boost::system::error_code ec;
+        fs::remove(tmpPath, ec);
+        throw std::runtime_error("Cannot write the HNSW index file '" + path + "': " + e.what());
+    }
+}
+
+void HnswIndex::load(const std::string& path)
+{
+    try
+    {
+        std::ifstream in;
+        in.exceptions(std::ifstream::eofbit | std::ifstream::failbit | std::ifstream::badbit);
+        in.open(path, std::ios_base::binary);
+
+        if(readValue<uint32_t>(in) != hnswIndexVersion)
+            throw std::runtime_error("unsupported version");
+
+        _dimension = readValue<uint64_t>(in);
+        _key = readValue<uint64_t>(in);
+        _params.nbLinks = readValue<uint64_t>(in);
+        _params.efConstruction = readValue<uint64_t>(in);
+        _params.seed = readValue<uint32_t>(in);
+        _maxLevel = readValue<int32_t>(in);
+        _entryPoint = readValue<uint32_t>(in);
+        const std::size_t nbNodes = readValue<uint64_t>(in);
+
+        _data.resize(nbNodes * _dimension);
+        if(!_data.empty())
+            in.read(reinterpret_cast<char*>(_data.data()), _data.size() * sizeof(float));
+
+        _ids.resize(nbNodes);
+        _sourceKeys.resize(nbNodes);
+        _indexById.clear();
+        _links.assign(nbNodes, {});
+        for(std::size_t node = 0; node < nbNodes; ++node)
+        {
+            _ids[node] = readValue<uint32_t>(in);
+            _sourceKeys[node] = readValue<uint64_t>(in);
+            _indexById[_ids[node]] = node;
+            _links[node].resize(readValue<uint32_t>(in));
+            for(std::vector<uint32_t>& levelLinks : _links[node])
+            {
+                levelLinks.resize(readValue<uint32_t>(in));
+                if(!levelLinks.empty())
+                    in.read(reinterpret_cast<char*>(levelLinks.data()), levelLinks.size() * sizeof(uint32_t));
+            }
+        }
+    }
+    catch(const std::exception& e)
+    {
+        throw std::runtime_error("Cannot read the HNSW index file '" + path + "': " + e.what());
+    }
+
+    // the levels of the next nodes do not repeat the levels of the loaded ones
+    _levelFactor = 1.0 / std::log(std::max(_params.nbLinks, std::size_t(2)));
+    _generator.seed(_params.seed + _ids.size());
+}
+
+} // namespace imageMatching
+} // namespace aliceVision
@@ -0,0 +1,133 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace aliceVision {
+namespace imageMatching {
+
+/// The graph parameters of an HnswIndex
+struct HnswParams
+{
+    /// the number of links of each node on the upper layers, twice more on the bottom layer
+    std::size_t nbLinks = 16;
+    /// the number of nodes explored to link each inserted node
+    std::size_t efConstruction = 200;
+    /// the seed of the random levels of the nodes
+    unsigned int seed = 42;
+};
+
+/**
+ * @brief Approximate nearest neighbors index of descriptors with a hierarchical navigable small world graph (HNSW).
+ *
+ * Each descriptor is a node of the graph layers up to a random level, linked to its close nodes of each layer.
+ * A query descends greedily the upper layers and explores the bottom layer from the closest node found,
+ * which visits a small part of the descriptors. The distance is the squared L2 distance.
+ * The descriptors are inserted one by one, so the index can be saved and extended later.
+ * The queries are thread-safe, the insertions are not.
+ */
+class HnswIndex
+{
+public:
+    /// A found descriptor: its ID and its squared distance to the query
+    using Match = std::pair<IndexT, float>;
+
+    HnswIndex() = default;
+
+    /**
+     * @param[in] dimension the size of the descriptors
+     * @param[in] key the identifier of the way the descriptors are computed, saved with the index
+     * @param[in] params the graph parameters
+     */
+    HnswIndex(std::size_t dimension, std::size_t key, const HnswParams& params = HnswParams());
+
+    /**
+     * @brief Insert a descriptor
+     * @param[in] id the descriptor ID, not already in the index
+     * @param[in] descriptor the dimension() values of the descriptor
+     * @param[in] sourceKey the identifier of the data the descriptor is computed from, saved with the index
+     */
+    void insert(IndexT id, const std::vector<float>& descriptor, std::uint64_t sourceKey = 0);
+
+    /**
+     * @brief Find the approximate nearest descriptors of a query
+     * @param[in] query the dimension() values of the query
+     * @param[in] k the number of descriptors to find
+     * @param[in] ef the number of nodes explored on the bottom layer, at least k
+     * @param[in] filter if set, only the IDs accepted by the filter are returned
+     * @return the found descriptors, from the closest
+     */
+    std::vector<Match> search(const float* query, std::size_t k, std::size_t ef,
+                              const std::function<bool(IndexT)>& filter = nullptr) const;
+
+    /// Get the values of an indexed descriptor, null if the ID is not in the index
+    const float* getDescriptor(IndexT id) const;
+
+    /// Get the source key of an indexed descriptor, 0 if the ID is not in the index
+    std::uint64_t getSourceKey(IndexT id) const;
+
+    bool contains(IndexT id) const { return _indexById.count(id) != 0; }
+    std::size_t size() const { return _ids.size(); }
+    std::size_t dimension() const { return _dimension; }
+    std::size_t key() const { return _key; }
+
+    /**
+     * @brief Save the index to a binary file
+     * @details The index is written in a temporary file renamed once complete,
+     *          so a reader never sees a partial file.
+     * @throws std::runtime_error if the file cannot be written
+     */
+    void save(const std::string& path) const;
+
+    /**
+     * @brief Load the index from a binary file saved by save()
+     * @throws std::runtime_error if the file cannot be read
+     */
+    void load(const std::string& path);
+
+private:
+    using Candidate = std::pair<float, uint32_t>;
+
+    float distance(const float* a, const float* b) const;
+    const float* nodeData(uint32_t node) const { return &_data[std::size_t(node) * _dimension]; }
+    std::size_t maxLinks(int level) const { return level == 0 ? 2 * _params.nbLinks : _params.nbLinks; }
+
+    /// Get the ef closest nodes of a layer from the entry points, from the closest
+    std::vector<Candidate> searchLayer(const float* query, const std::vector<uint32_t>& entryPoints, std::size_t ef, int level) const;
+    /// Keep the closest candidates which are not closer to an already kept candidate than to the query
+    std::vector<uint32_t> selectNeighbors(const std::vector<Candidate>& candidates, std::size_t nbNeighbors) const;
+    /// Descend greedily from the entry point to the given level
+    uint32_t descend(const float* query, int level) const;
+
+    std::size_t _dimension = 0;
+    std::size_t _key = 0;
+    HnswParams _params;
+    double _levelFactor = 0.0;
+    std::mt19937 _generator;
+
+    std::vector<float> _data;                            // descriptors by node
+    std::vector<IndexT> _ids;                            // descriptor ID by node
+    std::vector<std::uint64_t> _sourceKeys;              // source key by node
+    std::map<IndexT, uint32_t> _indexById;               // node by descriptor ID
+    std::vector<std::vector<std::vector<uint32_t>>> _links; // neighbors by node, by level
+
+    int _maxLevel = -1;
+    uint32_t _entryPoint = 0;
+};
+
+} // namespace imageMatching
+} // namespace aliceVision
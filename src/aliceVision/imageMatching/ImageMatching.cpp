@@ -7,6 +7,20 @@
 #include "ImageMatching.hpp"
 #include <aliceVision/voctree/databaseIO.hpp>
 
+#include <boost/filesystem.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/interprocess/exceptions.hpp>
+#include <boost/interprocess/sync/file_lock.hpp>
+#include <boost/interprocess/sync/scoped_lock.hpp>
+
+#include "nanoflann.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+
+namespace fs = boost::filesystem;
+
 namespace aliceVision {
 namespace imageMatching {
 
@@ -40,6 +54,10 @@ std::string EImageMatchingMethod_enumToString(EImageMatchingMethod m)
             return "Frustum";
         case EImageMatchingMethod::FRUSTUM_OR_VOCABULARYTREE:
             return "FrustumOrVocabularyTree";
+        case EImageMatchingMethod::SPATIAL_VOCABULARYTREE:
+            return "SpatialVocabularyTree";
+        case EImageMatchingMethod::GLOBAL_DESCRIPTOR:
+            return "GlobalDescriptor";
     }
     throw std::out_of_range("Invalid EImageMatchingMethod enum: " + std::to_string(int(m)));
 }
@@ -61,6 +79,10 @@ EImageMatchingMethod EImageMatchingMethod_stringToEnum(const std::string& m)
         return EImageMatchingMethod::FRUSTUM;
     if (mode == "frustumorvocabularytree")
         return EImageMatchingMethod::FRUSTUM_OR_VOCABULARYTREE;
+    if (mode == "spatialvocabularytree")
+        return EImageMatchingMethod::SPATIAL_VOCABULARYTREE;
+    if (mode == "globaldescriptor")
+        return EImageMatchingMethod::GLOBAL_DESCRIPTOR;
 
     throw std::out_of_range("Invalid EImageMatchingMethod: " + m);
 }
@@ -164,6 +186,35 @@ void convertAllMatchesToPairList(const PairList &allMatches, std::size_t numMatc
     }
 }
 
+void convertQueryMatchesToPairList(const PairList& allMatches, std::size_t numMatches,
+                                   OrderedPairList& outPairList)
+{
+    if (numMatches == 0)
+        numMatches = std::numeric_limits<std::size_t>::max();  // disable image matching limit
+
+    for (const auto& match : allMatches)
+    {
+        const ImageID currImageId = match.first;
+        std::size_t nbMatches = 0;
+
+        for (const ImageID currMatchId : match.second)
+        {
+            // avoid self-matching
+            if (currMatchId == currImageId)
+                continue;
+
+            // each pair is stored once, under its lowest image ID
+            if (currMatchId < currImageId)
+                outPairList[currMatchId].insert(currImageId);
+            else
+                outPairList[currImageId].insert(currMatchId);
+
+            if (++nbMatches == numMatches)
+                break;
+        }
+    }
+}
+
 void generateSequentialMatches(const sfmData::SfMData& sfmData, size_t nbMatches,
                                OrderedPairList& outPairList)
 {
@@ -232,13 +283,140 @@ void generateAllMatchesBetweenTwoMap(const std::set<IndexT>& viewIdsA,
     }
 }
 
+namespace {
+
+/// The positions of the views for the KD-tree
+struct ViewPositionsAdaptor
+{
+    using Derived = ViewPositionsAdaptor;
+    using T = double;
+
+    const std::vector<Vec3>& _data;
+    ViewPositionsAdaptor(const std::vector<Vec3>& data)
+        : _data(data)
+    {}
+
+    inline const Derived& derived() const { return *this; }
+    inline       Derived& derived()       { return *this; }
+
+    inline size_t kdtree_get_point_count() const { return _data.size(); }
+
+    inline T kdtree_get_pt(const size_t idx, int dim) const { return _data[idx](dim); }
+
+    template <class BBOX>
+    bool kdtree_get_bbox(BBOX &bb) const { return false; }
+};
+
+using ViewPositionsKdTree = nanoflann::KDTreeSingleIndexAdaptor<
+    nanoflann::L2_Simple_Adaptor<double, ViewPositionsAdaptor>,
+    ViewPositionsAdaptor,
+    3 /* dim */
+    >;
+
+/**
+ * @brief Get the GPS positions of the views, or their pose centers if no view has a GPS position.
+ * A single source is used, the two are not in the same frame.
+ */
+void getViewPositions(const std::vector<const sfmData::SfMData*>& sfmDatas, std::vector<IndexT>& viewIds, std::vector<Vec3>& positions)
+{
+    bool hasGps = false;
+    for (const sfmData::SfMData* sfmData : sfmDatas)
+        for (const auto& viewPair : sfmData->getViews())
+            hasGps = hasGps || viewPair.second->hasGpsMetadata();
+
+    for (const sfmData::SfMData* sfmData : sfmDatas)
+    {
+        for (const auto& viewPair : sfmData->getViews())
+        {
+            const sfmData::View& view = *viewPair.second;
+            if (hasGps)
+            {
+                if (!view.hasGpsMetadata())
+                    continue;
+                try
+                {
+                    positions.push_back(view.getGpsPositionFromMetadata());
+                }
+                catch (const std::exception& e)
+                {
+                    ALICEVISION_LOG_WARNING("Invalid GPS metadata of the view " << viewPair.first << ": " << e.what());
+                    continue;
+                }
+            }
+            else if (sfmData->isPoseAndIntrinsicDefined(&view))
+            {
+                positions.push_back(sfmData->getPose(view).getTransform().center());
+            }
+            else
+            {
+                continue;
+            }
+            viewIds.push_back(viewPair.first);
+        }
+    }
+    ALICEVISION_LOG_INFO(viewIds.size() << " views positioned from their " << (hasGps ? "GPS metadata" : "poses"));
+}
+
+} // namespace
+
+std::size_t generateSpatialNeighbors(const sfmData::SfMData& sfmDataA,
+                                     const sfmData::SfMData& sfmDataB,
+                                     std::size_t nbNeighbors,
+                                     double maxDistance,
+                                     PairList& outNeighbors)
+{
+    outNeighbors.clear();
+
+    std::vector<IndexT> viewIds;
+    std::vector<Vec3> positions;
+    getViewPositions({&sfmDataA, &sfmDataB}, viewIds, positions);
+    if (positions.empty())
+        return 0;
+
+    ViewPositionsAdaptor adaptor(positions);
+    ViewPositionsKdTree kdTree(3 /*dim*/, adaptor, nanoflann::KDTreeSingleIndexAdaptorParams(10 /* max leaf */));
+    kdTree.buildIndex();
+
+    // the view itself is one of its nearest neighbors, 0 means all the views
+    const std::size_t nbSearched = (nbNeighbors == 0) ? positions.size() : std::min(nbNeighbors + 1, positions.size());
+    const double maxSquaredDistance = maxDistance * maxDistance;
+    std::size_t nbPositionedViews = 0;
+
+    std::vector<std::size_t> indices(nbSearched);
+    std::vector<double> squaredDistances(nbSearched);
+    nanoflann::KNNResultSet<double, std::size_t> resultSet(nbSearched);
+
+    for (std::size_t i = 0; i < positions.size(); ++i)
+    {
+        if (!sfmDataA.getViews().count(viewIds[i]))
+            continue;
+        ++nbPositionedViews;
+
+        resultSet.init(indices.data(), squaredDistances.data());
+        kdTree.findNeighbors(resultSet, positions[i].data(), nanoflann::SearchParams());
+        const std::size_t nbFound = resultSet.size();
+
+        ListOfImageID& neighbors = outNeighbors[viewIds[i]];
+        for (std::size_t n = 0; n < nbFound; ++n)
+        {
+            if (viewIds[indices[n]] == viewIds[i] || (maxDistance > 0.0 && squaredDistances[n] > maxSquaredDistance))
+                continue;
+            neighbors.push_back(viewIds[indices[n]]);
+        }
+        std::sort(neighbors.begin(), neighbors.end());
+    }
+    return nbPositionedViews;
+}
+
 void generateFromVoctree(PairList& allMatches,
                          const std::map<IndexT, std::string>& descriptorsFiles,
                          const aliceVision::voctree::Database& db,
                          const aliceVision::voctree::VocabularyTree<DescriptorFloat>& tree,
                          EImageMatchingMode modeMultiSfM,
                          std::size_t nbMaxDescriptors,
-                         std::size_t numImageQuery)
+                         std::size_t numImageQuery,
+                         voctree::VisualWordsCache* wordsCache,
+                         const PairList& spatialNeighbors)
 {
     ALICEVISION_LOG_INFO("Generate matches in mode: " +
                          EImageMatchingMode_enumToString(modeMultiSfM));
@@ -257,41 +435,56 @@ void generateFromVoctree(PairList& allMatches,
             allMatches[descriptorPair.first] = {};
     }
 
-    // query each document
-#pragma omp parallel for
-    for (ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(descriptorsFiles.size()); ++i)
-    {
-        auto itA = descriptorsFiles.cbegin();
-        std::advance(itA, i);
-        const IndexT viewIdA = itA->first;
-        const std::string featuresPathA = itA->second;
+    std::vector<std::map<IndexT, std::string>::const_iterator> queries;
+    queries.reserve(descriptorsFiles.size());
+    for (auto it = descriptorsFiles.cbegin(); it != descriptorsFiles.cend(); ++it)
+        queries.push_back(it);
 
-        aliceVision::voctree::SparseHistogram imageSH;
+    // query each document, each thread reuses its scoring buffer across its queries
+#pragma omp parallel
+    {
+        std::vector<float> scores;
+        std::vector<aliceVision::voctree::DocMatch> matches;
+        aliceVision::voctree::SparseHistogram queryHistogram;
 
-        if (modeMultiSfM != EImageMatchingMode::A_B)
+#pragma omp for schedule(dynamic)
+        for (ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(queries.size()); ++i)
         {
-            // sparse histogram of A is already computed in the DB
-            imageSH = db.getSparseHistogramPerImage().at(viewIdA);
-        }
-        else // mode AB
-        {
-            // compute the sparse histogram of each image A
-            std::vector<DescriptorUChar> descriptors;
-            // read the descriptors
-            loadDescsFromBinFile(featuresPathA, descriptors, false, nbMaxDescriptors);
-            imageSH = tree.quantizeToSparse(descriptors);
-        }
+            const IndexT viewIdA = queries[i]->first;
+            const std::string& featuresPathA = queries[i]->second;
 
-        std::vector<aliceVision::voctree::DocMatch> matches;
+            const aliceVision::voctree::SparseHistogram* imageSH = &queryHistogram;
 
-        db.find(imageSH, numImageQuery, matches);
+            if (modeMultiSfM != EImageMatchingMode::A_B)
+            {
+                // sparse histogram of A is already computed in the DB
+                imageSH = &db.getSparseHistogramPerImage().at(viewIdA);
+            }
+            else // mode AB
+            {
+                // compute the sparse histogram of each image A, or read it from the cache
+                queryHistogram = voctree::quantizeDescriptorsFile<DescriptorUChar>(featuresPathA, tree, nbMaxDescriptors, wordsCache);
+            }
 
-        ListOfImageID& imgMatches = allMatches.at(viewIdA);
-        imgMatches.reserve(imgMatches.size() + matches.size());
+            // only the spatial neighbors of a positioned view are ranked
+            const auto itNeighbors = spatialNeighbors.find(viewIdA);
+            if (itNeighbors != spatialNeighbors.end())
+            {
+                const std::vector<voctree::DocId> candidates(itNeighbors->second.begin(), itNeighbors->second.end());
+                db.find(*imageSH, numImageQuery, candidates, matches, scores);
+            }
+            else
+            {
+                db.find(*imageSH, numImageQuery, matches, scores);
+            }
 
-        for (const aliceVision::voctree::DocMatch& m : matches)
-        {
-            imgMatches.push_back(m.id);
+            ListOfImageID& imgMatches = allMatches.at(viewIdA);
+            imgMatches.reserve(imgMatches.size() + matches.size());
+
+            for (const aliceVision::voctree::DocMatch& m : matches)
+            {
+                imgMatches.push_back(m.id);
+            }
         }
     }
 }
@@ -308,7 +501,10 @@ void conditionVocTree(const std::string& treeName, bool withWeights,
                       bool useMultiSfM,
                       const std::map<IndexT, std::string>& descriptorsFilesA,
                       std::size_t numImageQuery,
-                      OrderedPairList& selectedPairs)
+                      OrderedPairList& selectedPairs,
+                      const std::string& wordsCacheFolder,
+                      const std::set<IndexT>& queryViewIds,
+                      const PairList& spatialNeighbors)
 {
     if (treeName.empty())
     {
@@ -330,6 +526,11 @@ void conditionVocTree(const std::string& treeName, bool withWeights,
         ALICEVISION_LOG_INFO(ss.str());
     }
 
+    // the visual words of the descriptor files are reused across runs and modes
+    std::unique_ptr<voctree::VisualWordsCache> wordsCache;
+    if (!wordsCacheFolder.empty())
+        wordsCache.reset(new voctree::VisualWordsCache(wordsCacheFolder, treeName));
+
     // create the databases
     ALICEVISION_LOG_INFO("Creating the databases...");
 
@@ -370,7 +571,7 @@ void conditionVocTree(const std::string& treeName, bool withWeights,
                 (matchingMode == EImageMatchingMode::A_A))
             {
                 nbFeaturesLoadedInputA = voctree::populateDatabase<DescriptorUChar>(
-                            sfmDataA, featuresFolders, tree, db, nbMaxDescriptors);
+                            sfmDataA, featuresFolders, tree, db, nbMaxDescriptors, wordsCache.get());
                 nbSetDescriptors = db.getSparseHistogramPerImage().size();
 
                 if(nbFeaturesLoadedInputA == 0)
@@ -383,14 +584,14 @@ void conditionVocTree(const std::string& treeName, bool withWeights,
                 (matchingMode == EImageMatchingMode::A_B))
             {
                 nbFeaturesLoadedInputB = voctree::populateDatabase<DescriptorUChar>(
-                            sfmDataB, featuresFolders, tree, db, nbMaxDescriptors);
+                            sfmDataB, featuresFolders, tree, db, nbMaxDescriptors, wordsCache.get());
                 nbSetDescriptors = db.getSparseHistogramPerImage().size();
             }
 
             if (matchingMode == EImageMatchingMode::A_A_AND_A_B)
             {
                 nbFeaturesLoadedInputB = voctree::populateDatabase<DescriptorUChar>(
-                            sfmDataB, featuresFolders, tree, db2, nbMaxDescriptors);
+                            sfmDataB, featuresFolders, tree, db2, nbMaxDescriptors, wordsCache.get());
                 nbSetDescriptors += db2.getSparseHistogramPerImage().size();
             }
 
@@ -421,38 +622,228 @@ void conditionVocTree(const std::string& treeName, bool withWeights,
     {
         PairList allMatches;
 
-        ALICEVISION_LOG_INFO("Query all documents");
+        // the database holds all the documents, only the selected views are queried
+        std::map<IndexT, std::string> queryDescriptorsFilesA;
+        if (queryViewIds.empty())
+        {
+            queryDescriptorsFilesA = descriptorsFilesA;
+            ALICEVISION_LOG_INFO("Query all documents");
+        }
+        else
+        {
+            for (const auto& descriptorPair : descriptorsFilesA)
+                if (queryViewIds.count(descriptorPair.first))
+                    queryDescriptorsFilesA.insert(descriptorPair);
+            ALICEVISION_LOG_INFO("Query " << queryDescriptorsFilesA.size() << " documents");
+        }
 
         auto detect_start = std::chrono::steady_clock::now();
 
         if (matchingMode == EImageMatchingMode::A_A_AND_A_B)
         {
-            generateFromVoctree(allMatches, descriptorsFilesA, db,  tree, EImageMatchingMode::A_A,
-                                nbMaxDescriptors, numImageQuery);
-            generateFromVoctree(allMatches, descriptorsFilesA, db2, tree, EImageMatchingMode::A_B,
-                                nbMaxDescriptors, numImageQuery);
+            generateFromVoctree(allMatches, queryDescriptorsFilesA, db,  tree, EImageMatchingMode::A_A,
+                                nbMaxDescriptors, numImageQuery, wordsCache.get(), spatialNeighbors);
+            generateFromVoctree(allMatches, queryDescriptorsFilesA, db2, tree, EImageMatchingMode::A_B,
+                                nbMaxDescriptors, numImageQuery, wordsCache.get(), spatialNeighbors);
         }
         else
         {
-            generateFromVoctree(allMatches, descriptorsFilesA, db, tree, matchingMode,
-                                nbMaxDescriptors, numImageQuery);
+            generateFromVoctree(allMatches, queryDescriptorsFilesA, db, tree, matchingMode,
+                                nbMaxDescriptors, numImageQuery, wordsCache.get(), spatialNeighbors);
         }
 
         auto detect_elapsed = std::chrono::duration_cast<std::chrono::seconds>(
                     std::chrono::steady_clock::now() - detect_start);
         ALICEVISION_LOG_INFO("Query all documents took " << detect_elapsed.count() << " sec.");
 
+        if (wordsCache)
+            ALICEVISION_LOG_INFO("Visual words: " << wordsCache->getNbHits() << " files from the cache, "
+                                 << wordsCache->getNbMisses() << " files quantized.");
+
         // process pair list
         detect_start = std::chrono::steady_clock::now();
 
         ALICEVISION_LOG_INFO("Convert all matches to pairList");
-        convertAllMatchesToPairList(allMatches, numImageQuery, selectedPairs);
+        if (queryViewIds.empty())
+            convertAllMatchesToPairList(allMatches, numImageQuery, selectedPairs);
+        else
+            convertQueryMatchesToPairList(allMatches, numImageQuery, selectedPairs);
         detect_elapsed = std::chrono::duration_cast<std::chrono::seconds>(
                     std::chrono::steady_clock::now() - detect_start);
         ALICEVISION_LOG_INFO("Convert all matches to pairList took " << detect_elapsed.count() << " sec.");
     }
 }
 
+void generateFromGlobalDescriptors(const std::string& treeName,
+                                   const EImageMatchingMode matchingMode,
+                                   const std::map<IndexT, std::string>& descriptorsFilesA,
+                                   const std::map<IndexT, std::string>& descriptorsFilesB,
+                                   std::size_t nbMaxDescriptors,
+                                   std::size_t numImageQuery,
+                                   const GlobalDescriptorParams& params,
+                                   OrderedPairList& selectedPairs,
+                                   const std::set<IndexT>& queryViewIds)
+{
+    if (treeName.empty())
+    {
+        throw std::runtime_error("No vocabulary tree argument.");
+    }
+
+    ALICEVISION_LOG_INFO("Loading vocabulary tree");
+    const aliceVision::voctree::VocabularyTree<DescriptorFloat> tree(treeName);
+    const std::size_t dimension = tree.vladSize(params.vladLevel);
+
+    // the indexed descriptors depend on the tree, the VLAD level and the number of descriptors
+    std::size_t key = voctree::computeFileHash(treeName);
+    boost::hash_combine(key, params.vladLevel);
+    boost::hash_combine(key, nbMaxDescriptors);
+
+    // the views of the index for this mode
+    std::map<IndexT, std::string> indexedFiles;
+    if (matchingMode != EImageMatchingMode::A_B)
+        indexedFiles.insert(descriptorsFilesA.begin(), descriptorsFilesA.end());
+    if (matchingMode != EImageMatchingMode::A_A)
+        indexedFiles.insert(descriptorsFilesB.begin(), descriptorsFilesB.end());
+
+    // the key of the descriptors file of each view, an indexed view with another key is outdated
+    std::map<IndexT, std::uint64_t> sourceKeys;
+    for (const auto& filePair : indexedFiles)
+    {
+        boost::system::error_code ec;
+        std::size_t sourceKey = fs::file_size(filePair.second, ec);
+        if (!ec)
+            boost::hash_combine(sourceKey, fs::last_write_time(filePair.second, ec));
+        sourceKeys[filePair.first] = ec ? 0 : sourceKey;
+    }
+
+    const auto loadIndex = [&](HnswIndex& index) {
+        if (params.indexFile.empty() || !fs::exists(params.indexFile))
+            return;
+        HnswIndex loadedIndex;
+        loadedIndex.load(params.indexFile);
+        if (loadedIndex.key() != key || loadedIndex.dimension() != dimension)
+        {
+            ALICEVISION_LOG_WARNING("The index '" << params.indexFile << "' was built with other settings, it is rebuilt.");
+            return;
+        }
+        for (const auto& sourceKeyPair : sourceKeys)
+        {
+            if (loadedIndex.contains(sourceKeyPair.first) && loadedIndex.getSourceKey(sourceKeyPair.first) != sourceKeyPair.second)
+            {
+                ALICEVISION_LOG_WARNING("The index '" << params.indexFile << "' contains outdated descriptors of the view "
+                                        << sourceKeyPair.first << ", it is rebuilt.");
+                return;
+            }
+        }
+        index = std::move(loadedIndex);
+    };
+
+    HnswIndex index(dimension, key, params.hnsw);
+    loadIndex(index);
+
+    const auto computeVlad = [&](const std::string& descriptorsPath) {
+        std::vector<DescriptorUChar> descriptors;
+        feature::loadDescsFromBinFile(descriptorsPath, descriptors, false, nbMaxDescriptors);
+        return tree.computeVlad(descriptors, params.vladLevel);
+    };
+
+    // compute the descriptors of the new views in parallel, then insert them in order
+    std::vector<std::pair<IndexT, std::string>> newViews;
+    for (const auto& filePair : indexedFiles)
+        if (!index.contains(filePair.first))
+            newViews.push_back(filePair);
+
+    if (!newViews.empty())
+    {
+        ALICEVISION_LOG_INFO("Index the global descriptors of " << newViews.size() << " new views ("
+                             << index.size() << " views already indexed).");
+        auto index_start = std::chrono::steady_clock::now();
+
+        std::vector<std::vector<float>> newDescriptors(newViews.size());
+#pragma omp parallel for schedule(dynamic)
+        for (ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(newViews.size()); ++i)
+            newDescriptors[i] = computeVlad(newViews[i].second);
+
+        if (params.indexFile.empty())
+        {
+            for (std::size_t i = 0; i < newViews.size(); ++i)
+                index.insert(newViews[i].first, newDescriptors[i], sourceKeys.at(newViews[i].first));
+        }
+        else
+        {
+            // the processes sharing the index file extend it one after the other:
+            // the index saved by another process since the first load is reloaded before the insertions
+            const std::string lockFilepath = params.indexFile + ".lock";
+            try
+            {
+                // the file lock needs an existing file
+                std::ofstream(lockFilepath, std::ios::app);
+                boost::interprocess::file_lock fileLock(lockFilepath.c_str());
+                boost::interprocess::scoped_lock<boost::interprocess::file_lock> lock(fileLock);
+
+                loadIndex(index);
+                for (std::size_t i = 0; i < newViews.size(); ++i)
+                    if (!index.contains(newViews[i].first))
+                        index.insert(newViews[i].first, newDescriptors[i], sourceKeys.at(newViews[i].first));
+                index.save(params.indexFile);
+            }
+            catch (const boost::interprocess::interprocess_exception& e)
+            {
+                throw std::runtime_error("Cannot lock the index file: " + lockFilepath + " (" + e.what() + ")");
+            }
+        }
+
+        ALICEVISION_LOG_INFO("Indexing took " << std::chrono::duration_cast<std::chrono::seconds>(
+                                 std::chrono::steady_clock::now() - index_start).count() << " sec.");
+    }
+
+    // query the views of A, the indexed views of the other datasets are ignored
+    std::vector<std::pair<IndexT, std::string>> queries;
+    for (const auto& filePair : descriptorsFilesA)
+        if (queryViewIds.empty() || queryViewIds.count(filePair.first))
+            queries.push_back(filePair);
+
+    if (numImageQuery == 0)
+        numImageQuery = indexedFiles.size();
+
+    const auto isIndexedView = [&](IndexT viewId) { return indexedFiles.count(viewId) != 0; };
+
+    ALICEVISION_LOG_INFO("Query " << queries.size() << " global descriptors");
+    auto query_start = std::chrono::steady_clock::now();
+
+    PairList allMatches;
+    for (const auto& query : queries)
+        allMatches[query.first] = {};
+
+#pragma omp parallel for schedule(dynamic)
+    for (ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(queries.size()); ++i)
+    {
+        // the descriptor of an indexed view is not computed again
+        std::vector<float> queryDescriptor;
+        const float* descriptor = index.getDescriptor(queries[i].first);
+        if (!descriptor)
+        {
+            queryDescriptor = computeVlad(queries[i].second);
+            descriptor = queryDescriptor.data();
+        }
+
+        const std::vector<HnswIndex::Match> matches = index.search(descriptor, numImageQuery, params.efSearch, isIndexedView);
+
+        ListOfImageID& imgMatches = allMatches.at(queries[i].first);
+        imgMatches.reserve(matches.size());
+        for (const HnswIndex::Match& match : matches)
+            imgMatches.push_back(match.first);
+    }
+
+    ALICEVISION_LOG_INFO("Query all global descriptors took " << std::chrono::duration_cast<std::chrono::milliseconds>(
+                             std::chrono::steady_clock::now() - query_start).count() << " msec.");
+
+    if (queryViewIds.empty())
+        convertAllMatchesToPairList(allMatches, numImageQuery, selectedPairs);
+    else
+        convertQueryMatchesToPairList(allMatches, numImageQuery, selectedPairs);
+}
+
 EImageMatchingMethod selectImageMatchingMethod(EImageMatchingMethod method,
                                                const sfmData::SfMData& sfmDataA,
                                                const sfmData::SfMData& sfmDataB,
@@ -498,7 +889,9 @@ EImageMatchingMethod selectImageMatchingMethod(EImageMatchingMethod method,
 
     // if not enough images to use the VOCABULARYTREE use the EXHAUSTIVE method
     if (method == EImageMatchingMethod::VOCABULARYTREE ||
-        method == EImageMatchingMethod::SEQUENTIAL_AND_VOCABULARYTREE)
+        method == EImageMatchingMethod::SEQUENTIAL_AND_VOCABULARYTREE ||
+        method == EImageMatchingMethod::SPATIAL_VOCABULARYTREE ||
+        method == EImageMatchingMethod::GLOBAL_DESCRIPTOR)
     {
         if ((sfmDataA.getViews().size() + sfmDataB.getViews().size()) < minNbImages)
         {
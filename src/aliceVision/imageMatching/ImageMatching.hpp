@@ -7,8 +7,10 @@
 #pragma once
 
 #include <aliceVision/feature/Descriptor.hpp>
+#include <aliceVision/imageMatching/HnswIndex.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/voctree/Database.hpp>
+#include <aliceVision/voctree/VisualWordsCache.hpp>
 #include <aliceVision/voctree/VocabularyTree.hpp>
 #include <map>
 #include <set>
@@ -55,7 +57,9 @@ enum class EImageMatchingMethod
     SEQUENTIAL = 2,
     SEQUENTIAL_AND_VOCABULARYTREE = 3,
     FRUSTUM = 4,
-    FRUSTUM_OR_VOCABULARYTREE = 5
+    FRUSTUM_OR_VOCABULARYTREE = 5,
+    SPATIAL_VOCABULARYTREE = 6,
+    GLOBAL_DESCRIPTOR = 7
 };
 
 /**
@@ -117,6 +121,18 @@ EImageMatchingMode EImageMatchingMode_stringToEnum(const std::string& modeMultiS
 void convertAllMatchesToPairList(const PairList &allMatches, std::size_t numMatches,
                                  OrderedPairList &outPairList);
 
+/**
+ * It processes a pairlist containing the matching images of some image IDs and adds to a list
+ * their first numMatches matching images, such that each pair only depends on the queries of one image.
+ * The union of the lists of disjoint sets of images does not depend on how the images are split.
+ *
+ * @param[in] allMatches A pairlist containing all the matching images for each queried image
+ * @param[in] numMatches The maximum number of matching images to consider for each image (if 0, consider all matches)
+ * @param[in,out] outPairList The pairs of the queried images, stored under their lowest image ID
+ */
+void convertQueryMatchesToPairList(const PairList& allMatches, std::size_t numMatches,
+                                   OrderedPairList& outPairList);
+
 void generateSequentialMatches(const sfmData::SfMData& sfmData, size_t nbMatches,
                                OrderedPairList& outPairList);
 void generateAllMatchesInOneMap(const std::set<IndexT>& viewIds, OrderedPairList& outPairList);
@@ -124,13 +140,36 @@ void generateAllMatchesBetweenTwoMap(const std::set<IndexT>& viewIdsA,
                                      const std::set<IndexT>& viewIdsB,
                                      OrderedPairList& outPairList);
 
+/**
+ * @brief Find the spatial neighbors of the views, from their GPS positions or else from their known poses.
+ * The positions of the views of both SfMData are used, the views without position have no entry.
+ *
+ * @param[in] sfmDataA the views to find the neighbors of
+ * @param[in] sfmDataB the other views to find as neighbors
+ * @param[in] nbNeighbors the maximum number of neighbors of each view, 0 for no limit
+ * @param[in] maxDistance the maximum distance to the neighbors, 0 for no limit
+ * @param[out] outNeighbors the sorted neighbors of each view with a position
+ * @return the number of views of sfmDataA with a position
+ */
+std::size_t generateSpatialNeighbors(const sfmData::SfMData& sfmDataA,
+                                     const sfmData::SfMData& sfmDataB,
+                                     std::size_t nbNeighbors,
+                                     double maxDistance,
+                                     PairList& outNeighbors);
+
+/**
+ * @brief Query the database with the descriptors of each view.
+ * The views with an entry in spatialNeighbors only rank these documents.
+ */
 void generateFromVoctree(PairList& allMatches,
                          const std::map<IndexT, std::string>& descriptorsFiles,
                          const voctree::Database& db,
                          const voctree::VocabularyTree<DescriptorFloat>& tree,
                          EImageMatchingMode modeMultiSfM,
                          std::size_t nbMaxDescriptors,
-                         std::size_t numImageQuery);
+                         std::size_t numImageQuery,
+                         voctree::VisualWordsCache* wordsCache = nullptr,
+                         const PairList& spatialNeighbors = PairList());
 
 void conditionVocTree(const std::string& treeName, bool withWeights,
                       const std::string& weightsName,
@@ -144,7 +183,42 @@ void conditionVocTree(const std::string& treeName, bool withWeights,
                       bool useMultiSfM,
                       const std::map<IndexT, std::string>& descriptorsFilesA,
                       std::size_t numImageQuery,
-                      OrderedPairList& selectedPairs);
+                      OrderedPairList& selectedPairs,
+                      const std::string& wordsCacheFolder = "",
+                      const std::set<IndexT>& queryViewIds = std::set<IndexT>(),
+                      const PairList& spatialNeighbors = PairList());
+
+/**
+ * @brief The settings of the image retrieval with global descriptors
+ */
+struct GlobalDescriptorParams
+{
+    /// the level of the vocabulary tree centers of the VLAD descriptors, 0 for the children of the root
+    uint32_t vladLevel = 0;
+    /// the graph parameters of the approximate nearest neighbors index
+    HnswParams hnsw;
+    /// the number of nodes explored by each query
+    std::size_t efSearch = 100;
+    /// the index file, loaded and extended with the new views if it exists, then saved. Not saved if empty.
+    std::string indexFile;
+};
+
+/**
+ * @brief Select the image pairs from the nearest VLAD global descriptors, aggregated on the centers
+ * of the vocabulary tree and retrieved with an approximate nearest neighbors index.
+ * The index contains the views of B for the A_B mode, of A for the A_A mode, and of both otherwise.
+ *
+ * @param[in] queryViewIds the views of A which query the index, all of them if empty
+ */
+void generateFromGlobalDescriptors(const std::string& treeName,
+                                   const EImageMatchingMode matchingMode,
+                                   const std::map<IndexT, std::string>& descriptorsFilesA,
+                                   const std::map<IndexT, std::string>& descriptorsFilesB,
+                                   std::size_t nbMaxDescriptors,
+                                   std::size_t numImageQuery,
+                                   const GlobalDescriptorParams& params,
+                                   OrderedPairList& selectedPairs,
+                                   const std::set<IndexT>& queryViewIds = std::set<IndexT>());
 
 EImageMatchingMethod selectImageMatchingMethod(EImageMatchingMethod method,
                                                const sfmData::SfMData& sfmDataA,
@@ -0,0 +1,142 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/imageMatching/HnswIndex.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+
+#define BOOST_TEST_MODULE HnswIndex
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::imageMatching;
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+std::vector<std::vector<float>> randomDescriptors(std::size_t nbDescriptors, std::size_t dimension, std::mt19937& generator)
+{
+    std::normal_distribution<float> distribution;
+    std::vector<std::vector<float>> descriptors(nbDescriptors, std::vector<float>(dimension));
+    for(std::vector<float>& descriptor : descriptors)
+        for(float& value : descriptor)
+            value = distribution(generator);
+    return descriptors;
+}
+
+std::set<IndexT> bruteForceNeighbors(const std::vector<std::vector<float>>& descriptors, const std::vector<float>& query, std::size_t k)
+{
+    std::vector<std::pair<float, IndexT>> distances;
+    for(std::size_t i = 0; i < descriptors.size(); ++i)
+    {
+        float dist = 0.0f;
+        for(std::size_t d = 0; d < query.size(); ++d)
+            dist += (descriptors[i][d] - query[d]) * (descriptors[i][d] - query[d]);
+        distances.emplace_back(dist, i);
+    }
+    std::partial_sort(distances.begin(), distances.begin() + k, distances.end());
+
+    std::set<IndexT> neighbors;
+    for(std::size_t i = 0; i < k; ++i)
+        neighbors.insert(distances[i].second);
+    return neighbors;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(HnswIndex_recall)
+{
+    const std::size_t dimension = 16;
+    const std::size_t k = 10;
+    std::mt19937 generator(42);
+    const std::vector<std::vector<float>> descriptors = randomDescriptors(2000, dimension, generator);
+    const std::vector<std::vector<float>> queries = randomDescriptors(50, dimension, generator);
+
+    HnswIndex index(dimension, 0);
+    for(std::size_t i = 0; i < descriptors.size(); ++i)
+        index.insert(i, descriptors[i]);
+    BOOST_CHECK_EQUAL(index.size(), descriptors.size());
+    BOOST_CHECK_THROW(index.insert(0, descriptors[0]), std::invalid_argument);
+
+    std::size_t nbFound = 0;
+    for(const std::vector<float>& query : queries)
+    {
+        const std::vector<HnswIndex::Match> matches = index.search(query.data(), k, 100);
+        BOOST_REQUIRE_EQUAL(matches.size(), k);
+        for(std::size_t m = 1; m < matches.size(); ++m)
+            BOOST_CHECK_LE(matches[m - 1].second, matches[m].second);
+
+        const std::set<IndexT> neighbors = bruteForceNeighbors(descriptors, query, k);
+        for(const HnswIndex::Match& match : matches)
+            nbFound += neighbors.count(match.first);
+    }
+    BOOST_CHECK_GE(nbFound, 0.9 * k * queries.size());
+
+    // an indexed descriptor is its own nearest neighbor
+    const std::vector<HnswIndex::Match> self = index.search(descriptors[7].data(), 1, 50);
+    BOOST_REQUIRE_EQUAL(self.size(), 1);
+    BOOST_CHECK_EQUAL(self.front().first, 7);
+
+    // the filtered IDs are never returned
+    const std::vector<HnswIndex::Match> filtered = index.search(queries[0].data(), k, 100, [](IndexT id) { return id % 2 == 0; });
+    BOOST_CHECK_EQUAL(filtered.size(), k);
+    for(const HnswIndex::Match& match : filtered)
+        BOOST_CHECK_EQUAL(match.first % 2, 0);
+}
+
+BOOST_AUTO_TEST_CASE(HnswIndex_saveLoad)
+{
+    const std::size_t dimension = 8;
+    std::mt19937 generator(7);
+    const std::vector<std::vector<float>> descriptors = randomDescriptors(500, dimension, generator);
+    const fs::path indexPath = fs::temp_directory_path() / fs::unique_path("%%%%-%%%%.hnsw");
+
+    HnswIndex index(dimension, 1234);
+    for(std::size_t i = 0; i < 300; ++i)
+        index.insert(i, descriptors[i], 1000 + i);
+    index.save(indexPath.string());
+
+    HnswIndex loaded;
+    loaded.load(indexPath.string());
+    BOOST_CHECK_EQUAL(loaded.size(), 300);
+    BOOST_CHECK_EQUAL(loaded.dimension(), dimension);
+    BOOST_CHECK_EQUAL(loaded.key(), 1234);
+    BOOST_CHECK(loaded.contains(299));
+    BOOST_CHECK(!loaded.contains(300));
+    BOOST_CHECK(std::equal(descriptors[10].begin(), descriptors[10].end(), loaded.getDescriptor(10)));
+    BOOST_CHECK_EQUAL(loaded.getSourceKey(10), 1010);
+    BOOST_CHECK_EQUAL(loaded.getSourceKey(300), 0);
+
+    // the temporary file is renamed to the index file
+    std::size_t nbFiles = 0;
+    for(fs::directory_iterator it(indexPath.parent_path()); it != fs::directory_iterator(); ++it)
+        nbFiles += (it->path().string().find(indexPath.string()) == 0);
+    BOOST_CHECK_EQUAL(nbFiles, 1);
+
+    // the loaded graph gives the same results
+    for(std::size_t i = 300; i < 320; ++i)
+    {
+        const std::vector<HnswIndex::Match> matches = index.search(descriptors[i].data(), 5, 40);
+        const std::vector<HnswIndex::Match> loadedMatches = loaded.search(descriptors[i].data(), 5, 40);
+        BOOST_CHECK(matches == loadedMatches);
+    }
+
+    // the loaded index is extended
+    for(std::size_t i = 300; i < descriptors.size(); ++i)
+        loaded.insert(i, descriptors[i]);
+    BOOST_CHECK_EQUAL(loaded.size(), descriptors.size());
+    for(std::size_t i = 300; i < descriptors.size(); i += 50)
+        BOOST_CHECK_EQUAL(loaded.search(descriptors[i].data(), 1, 40).front().first, i);
+
+    fs::remove(indexPath);
+}
@@ -10,7 +10,12 @@
 
 #include <boost/filesystem.hpp>
 
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
 #include <random>
+#include <thread>
 #include <tuple>
 #include <cassert>
 #include <cstdlib>
@@ -63,6 +68,139 @@ double findMedian(const std::vector<double>& vec)
     return 0.0;
 }
 
+/**
+ * @brief Read the current frame of a feed provider into a grayscale OpenCV matrix.
+ * @note The frames used to be read in RGB and converted with cv::COLOR_BGR2GRAY, which swapped the red and blue
+ *       weights (0.114 R + 0.587 G + 0.299 B). The video frames are now converted from their decoded BGR data,
+ *       with the right weights (0.299 R + 0.587 G + 0.114 B), so the scores slightly differ from the previous versions.
+ * @param[in] feed The feed provider
+ * @return An OpenCV Mat object containing the grayscale frame
+ */
+cv::Mat readGrayscaleImage(dataio::FeedProvider& feed)
+{
+    image::Image<unsigned char> image;
+    camera::PinholeRadialK3 queryIntrinsics;
+    bool hasIntrinsics = false;
+    std::string currentImgName;
+
+    if (!feed.readImage(image, queryIntrinsics, currentImgName, hasIntrinsics)) {
+        ALICEVISION_THROW(std::invalid_argument, "Cannot read frame '" << currentImgName << "'!");
+    }
+
+    // Copy the content to OpenCV, the image buffer is released at the end of the function
+    return cv::Mat(cv::Size(image.cols(), image.rows()), CV_8UC1, image.data(), image.cols()).clone();
+}
+
+/**
+ * @brief Rescale a grayscale OpenCV matrix to a smaller width.
+ * @param[in] grayscaleImage The grayscale matrix
+ * @param[in] width The width to resize the image to. The height will be adjusted with respect to the size ratio.
+ *                  There will be no resizing if this parameter is set to 0 or if the image is not wider
+ * @return An OpenCV Mat object containing the rescaled image, which shares the input data if it is not resized
+ */
+cv::Mat rescaleImage(const cv::Mat& grayscaleImage, std::size_t width)
+{
+    if (width == 0 || std::size_t(grayscaleImage.cols) <= width)
+        return grayscaleImage;
+
+    cv::Mat cvRescaled;
+    cv::resize(grayscaleImage, cvRescaled,
+               cv::Size(width, double(grayscaleImage.rows) * double(width) / double(grayscaleImage.cols)));
+    return cvRescaled;
+}
+
+/**
+ * @brief Frame of a feed to score, with the previous valid frame of the same feed for the optical flow computation.
+ * The OpenCV matrices share their data, so each decoded frame is held only once in memory.
+ */
+struct ScoringTask
+{
+    std::size_t mediaIndex = 0;
+    std::size_t frameIndex = 0;
+    cv::Mat matSharpness;     // empty if the sharpness computation is skipped
+    cv::Mat matFlow;
+    cv::Mat previousMatFlow;  // empty for the first valid frame of the feed
+};
+
+/**
+ * @brief Bounded queue of frames between the feed decoding threads and the scoring workers.
+ * The decoding threads wait while the queue is full, so only a few frames are held in memory at once.
+ * The first error, from any thread, stops all the threads and is rethrown by rethrowError().
+ */
+class FrameQueue
+{
+public:
+    FrameQueue(std::size_t capacity, std::size_t nbProducers)
+        : _capacity(capacity)
+        , _nbProducers(nbProducers)
+    {}
+
+    /**
+     * @brief Push a frame, wait while the queue is full
+     * @return false if the computation has been stopped by an error
+     */
+    bool push(ScoringTask&& task)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _notFull.wait(lock, [this]() { return _tasks.size() < _capacity || _error; });
+        if (_error)
+            return false;
+        _tasks.push_back(std::move(task));
+        _notEmpty.notify_one();
+        return true;
+    }
+
+    /// Notify that a decoding thread has pushed all its frames
+    void producerDone()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        --_nbProducers;
+        _notEmpty.notify_all();
+    }
+
+    /**
+     * @brief Pop a frame, wait while the queue is empty
+     * @return false if all the frames have been popped or if the computation has been stopped by an error
+     */
+    bool pop(ScoringTask& task)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _notEmpty.wait(lock, [this]() { return !_tasks.empty() || _nbProducers == 0 || _error; });
+        if (_error || _tasks.empty())
+            return false;
+        task = std::move(_tasks.front());
+        _tasks.pop_front();
+        _notFull.notify_one();
+        return true;
+    }
+
+    /// Stop all the threads, only the first error is kept
+    void setError(std::exception_ptr error)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_error)
+            _error = error;
+        _tasks.clear();
+        _notFull.notify_all();
+        _notEmpty.notify_all();
+    }
+
+    void rethrowError() const
+    {
+        if (_error)
+            std::rethrow_exception(_error);
+    }
+
+private:
+    std::mutex _mutex;
+    std::condition_variable _notFull;
+    std::condition_variable _notEmpty;
+    std::deque<ScoringTask> _tasks;
+    const std::size_t _capacity;
+    std::size_t _nbProducers;
+    std::exception_ptr _error;
+};
+
 KeyframeSelector::KeyframeSelector(const std::vector<std::string>& mediaPaths,
                                    const std::string& sensorDbPath,
                                    const std::string& outputFolder)
@@ -337,83 +475,137 @@ bool KeyframeSelector::computeScores(const std::size_t rescaledWidthSharpness, c
         }
     }
 
-    std::size_t currentFrame = 0;
-    cv::Mat currentMatSharpness;  // OpenCV matrix for the sharpness computation
-    cv::Mat previousMatFlow, currentMatFlow;  // OpenCV matrices for the optical flow computation
-    auto ptrFlow = cv::optflow::createOptFlow_DeepFlow();
+    /* The frames are decoded once, by one thread per feed, and pushed in a bounded queue with their previous frame.
+     * The scores of a frame only depend on the frame and its previous one, so they are computed by several workers
+     * while the next frames are being decoded. */
+    const std::size_t nbWorkers = std::max(1u, std::thread::hardware_concurrency());
+    FrameQueue queue(2 * nbWorkers, feeds.size());
 
-    while (currentFrame < nbFrames) {
-        double minimalSharpness = skipSharpnessComputation ? 1.0f : std::numeric_limits<double>::max();
-        double minimalFlow = std::numeric_limits<double>::max();
+    // Scores of each frame, by feed
+    std::vector<std::vector<double>> sharpnessScores(feeds.size(), std::vector<double>(nbFrames, 1.0));
+    std::vector<std::vector<double>> flowScores(feeds.size(), std::vector<double>(nbFrames, -1.0));
+    std::vector<std::vector<char>> validFrames(feeds.size(), std::vector<char>(nbFrames, 0));
+    std::vector<cv::Size> frameSizes(feeds.size());
 
-        for (std::size_t mediaIndex = 0; mediaIndex < feeds.size(); ++mediaIndex) {
-            auto& feed = *feeds.at(mediaIndex);
+    std::vector<std::thread> threads;
+    threads.reserve(feeds.size() + nbWorkers);
 
-            if (currentFrame > 0) {  // Get currentFrame - 1 for the optical flow computation
-                previousMatFlow = readImage(feed, rescaledWidthFlow);
-                feed.goToNextFrame();
-            }
+    for (std::size_t mediaIndex = 0; mediaIndex < feeds.size(); ++mediaIndex) {
+        threads.emplace_back([&, mediaIndex]() {
+            try {
+                auto& feed = *feeds.at(mediaIndex);
+                feed.goToFrame(0);
+
+                cv::Mat previousMatFlow;  // last valid frame of the feed for the optical flow computation
+                bool isPreviousValid = true;
 
-            /* Handle input feeds that may have invalid or missing frames:
-             *   - catch the "invalid argument" exception thrown by "readImage" if a frame is invalid or missing
-             *   - try reading the next frame instead
-             *   - if the next frame is correctly read, then push dummy scores for the invalid frame and go on with
-             *     the process
-             *   - otherwise (feed not correctly moved to the next frame), throw a runtime error exception as something
-             *     is wrong with the video
-             */
-            if (!skipSharpnessComputation) {
-                try {
-                    // Read image for sharpness and rescale it if requested
-                    currentMatSharpness = readImage(feed, rescaledWidthSharpness);
-                } catch (const std::invalid_argument& ex) {
-                    // currentFrame + 1 = currently evaluated frame with indexing starting at 1, for display reasons
-                    // currentFrame + 2 = next frame to evaluate with indexing starting at 1, for display reasons
-                    ALICEVISION_LOG_WARNING("Invalid or missing frame " << currentFrame + 1
-                                            << ", attempting to read frame " << currentFrame + 2 << ".");
-                    bool success = feed.goToFrame(++currentFrame);
-                    if (success) {
-                        // Will throw an exception if next frame is also invalid
-                        currentMatSharpness = readImage(feed, rescaledWidthSharpness);
-                        // If no exception has been thrown, push dummy scores for the frame that was skipped
-                        _sharpnessScores.push_back(-1.f);
-                        _flowScores.push_back(-1.f);
-                    } else
+                for (std::size_t currentFrame = 0; currentFrame < nbFrames; ++currentFrame) {
+                    if (currentFrame > 0 && !feed.goToNextFrame()) {
                         ALICEVISION_THROW_ERROR("Could not go to frame " << currentFrame + 1
-                                                << " either. The feed might be corrupted.");
+                                                << ". The feed might be corrupted.");
+                    }
+
+                    /* Handle input feeds that may have invalid or missing frames:
+                     *   - the invalid frame gets dummy scores
+                     *   - the optical flow of the next frame is computed with the last valid frame
+                     *   - if the next frame is also invalid, throw a runtime error exception as something is wrong
+                     *     with the video
+                     */
+                    ScoringTask task;
+                    task.mediaIndex = mediaIndex;
+                    task.frameIndex = currentFrame;
+
+                    cv::Mat grayscale;
+                    try {
+                        grayscale = readGrayscaleImage(feed);
+                    } catch (const std::invalid_argument& ex) {
+                        if (!isPreviousValid) {
+                            ALICEVISION_THROW_ERROR("Invalid or missing frame " << currentFrame + 1
+                                                    << " after an invalid frame. The feed might be corrupted.");
+                        }
+                        // currentFrame + 1 = currently evaluated frame with indexing starting at 1, for display reasons
+                        ALICEVISION_LOG_WARNING("Invalid or missing frame " << currentFrame + 1
+                                                << " in media " << _mediaPaths[mediaIndex] << ".");
+                        isPreviousValid = false;
+                        continue;
+                    }
+                    isPreviousValid = true;
+
+                    task.matFlow = rescaleImage(grayscale, rescaledWidthFlow);
+                    if (!skipSharpnessComputation) {
+                        task.matSharpness = (rescaledWidthSharpness == rescaledWidthFlow) ?
+                                                task.matFlow : rescaleImage(grayscale, rescaledWidthSharpness);
+                    }
+                    task.previousMatFlow = previousMatFlow;
+                    previousMatFlow = task.matFlow;
+
+                    if (frameSizes.at(mediaIndex).area() == 0) {
+                        frameSizes.at(mediaIndex) = task.matFlow.size();
+                    }
+
+                    if (!queue.push(std::move(task))) {
+                        break;  // the computation has been stopped
+                    }
                 }
+                queue.producerDone();
+            } catch (...) {
+                queue.setError(std::current_exception());
             }
+        });
+    }
 
-            if (rescaledWidthSharpness == rescaledWidthFlow && !skipSharpnessComputation) {
-                currentMatFlow = currentMatSharpness;
-            } else {
-                currentMatFlow = readImage(feed, rescaledWidthFlow);
-            }
+    std::atomic<std::size_t> nbScoredFrames(0);
+    const std::size_t nbTasks = nbFrames * feeds.size();
 
-            if (_frameWidth == 0 && _frameHeight == 0) {  // Will be used later on to determine the motion accumulation step
-                _frameWidth = currentMatFlow.size().width;
-                _frameHeight = currentMatFlow.size().height;
-            }
+    for (std::size_t workerIndex = 0; workerIndex < nbWorkers; ++workerIndex) {
+        threads.emplace_back([&]() {
+            try {
+                auto ptrFlow = cv::optflow::createOptFlow_DeepFlow();
+                ScoringTask task;
+                while (queue.pop(task)) {
+                    if (!skipSharpnessComputation) {
+                        sharpnessScores[task.mediaIndex][task.frameIndex] =
+                            computeSharpness(task.matSharpness, sharpnessWindowSize);
+                    }
 
-            // Compute sharpness
-            if (!skipSharpnessComputation) {
-                const double sharpness = computeSharpness(currentMatSharpness, sharpnessWindowSize);
-                minimalSharpness = std::min(minimalSharpness, sharpness);
-            }
+                    if (!task.previousMatFlow.empty()) {
+                        flowScores[task.mediaIndex][task.frameIndex] =
+                            estimateFlow(ptrFlow, task.matFlow, task.previousMatFlow, flowCellSize);
+                    }
+                    validFrames[task.mediaIndex][task.frameIndex] = 1;
 
-            // Compute optical flow
-            if (currentFrame > 0) {
-                const double flow = estimateFlow(ptrFlow, currentMatFlow, previousMatFlow, flowCellSize);
-                minimalFlow = std::min(minimalFlow, flow);
+                    ALICEVISION_LOG_INFO("Finished processing frame " << ++nbScoredFrames << "/" << nbTasks);
+                }
+            } catch (...) {
+                queue.setError(std::current_exception());
             }
+        });
+    }
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    queue.rethrowError();
+
+    // Will be used later on to determine the motion accumulation step
+    _frameWidth = frameSizes.front().width;
+    _frameHeight = frameSizes.front().height;
+
+    // Save the minimal scores over all the feeds for each frame
+    for (std::size_t currentFrame = 0; currentFrame < nbFrames; ++currentFrame) {
+        double minimalSharpness = skipSharpnessComputation ? 1.0f : std::numeric_limits<double>::max();
+        double minimalFlow = std::numeric_limits<double>::max();
+        bool isValid = true;
 
-            ALICEVISION_LOG_INFO("Finished processing frame " << currentFrame + 1 << "/" << nbFrames);
+        for (std::size_t mediaIndex = 0; mediaIndex < feeds.size(); ++mediaIndex) {
+            isValid = isValid && validFrames[mediaIndex][currentFrame];
+            minimalSharpness = std::min(minimalSharpness, sharpnessScores[mediaIndex][currentFrame]);
+            minimalFlow = std::min(minimalFlow, flowScores[mediaIndex][currentFrame]);
         }
 
-        // Save scores for the current frame
-        _sharpnessScores.push_back(minimalSharpness);
-        _flowScores.push_back(currentFrame > 0 ? minimalFlow : -1.f);
-        ++currentFrame;
+        // Push dummy scores for the invalid frames
+        _sharpnessScores.push_back(isValid ? minimalSharpness : -1.f);
+        _flowScores.push_back(isValid && currentFrame > 0 ? minimalFlow : -1.f);
     }
 
     return true;
@@ -676,33 +868,7 @@ bool KeyframeSelector::exportFlowVisualisation(const std::size_t rescaledWidth)
 
 cv::Mat KeyframeSelector::readImage(dataio::FeedProvider &feed, std::size_t width)
 {
-    image::Image<image::RGBColor> image;
-    camera::PinholeRadialK3 queryIntrinsics;
-    bool hasIntrinsics = false;
-    std::string currentImgName;
-
-    if (!feed.readImage(image, queryIntrinsics, currentImgName, hasIntrinsics)) {
-        ALICEVISION_THROW(std::invalid_argument, "Cannot read frame '" << currentImgName << "'!");
-    }
-
-    // Convert content to OpenCV
-    cv::Mat cvFrame(cv::Size(image.cols(), image.rows()), CV_8UC3, image.data(), image.cols() * 3);
-
-    // Convert to grayscale
-    cv::Mat cvGrayscale;
-    cv::cvtColor(cvFrame, cvGrayscale, cv::COLOR_BGR2GRAY);
-
-    // Resize to smaller size if requested
-    if (width == 0)
-        return cvGrayscale;
-
-    cv::Mat cvRescaled;
-    if (cvGrayscale.cols > width && width > 0) {
-        cv::resize(cvGrayscale, cvRescaled,
-                   cv::Size(width,double(cvGrayscale.rows) * double(width) / double(cvGrayscale.cols)));
-    }
-
-    return cvRescaled;
+    return rescaleImage(readGrayscaleImage(feed), width);
 }
 
 double KeyframeSelector::computeSharpness(const cv::Mat& grayscaleImage, const std::size_t windowSize)
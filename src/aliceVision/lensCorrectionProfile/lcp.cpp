@@ -1,5 +1,6 @@
 #include "lcp.hpp"
 
+#include <aliceVision/alicevision_omp.hpp>
 #include <aliceVision/system/Logger.hpp>
 
 #include <boost/filesystem.hpp>
@@ -7,6 +8,7 @@
 
 #include <expat.h>
 
+#include <fstream>
 #include <iostream>
 #include <math.h>
 
@@ -1055,7 +1057,70 @@ std::vector<std::string> reduceStrings(const std::vector<std::string>& v_str)
     return v_localStr;
 }
 
+namespace {
+
+/// Identify the index file format
+const std::uint32_t lcpIndexMagic = 0x4c435049; // "LCPI"
+const std::uint32_t lcpIndexVersion = 1;
+
+template<typename T>
+void writeValue(std::ostream& os, const T& value)
+{
+    os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+bool readValue(std::istream& is, T& value)
+{
+    return bool(is.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+void writeString(std::ostream& os, const std::string& str)
+{
+    writeValue(os, std::uint32_t(str.size()));
+    os.write(str.data(), str.size());
+}
+
+/// Get the number of bytes left to read in the stream, 0 if it cannot be known
+std::uint64_t getRemainingSize(std::istream& is)
+{
+    const std::istream::pos_type position = is.tellg();
+    if(position < 0 || !is.seekg(0, std::ios::end))
+        return 0;
+    const std::istream::pos_type end = is.tellg();
+    is.seekg(position);
+    return (end > position) ? std::uint64_t(end - position) : 0;
+}
+
+bool readString(std::istream& is, std::string& str)
+{
+    std::uint32_t size = 0;
+    if(!readValue(is, size) || size > getRemainingSize(is))
+        return false;
+    str.resize(size);
+    return bool(is.read(&str[0], size));
+}
+
+/// Get the size and the modification time of a file, to detect the modified files of the database
+bool getFileStamp(const boost::filesystem::path& p, std::uintmax_t& fileSize, std::int64_t& lastWriteTime)
+{
+    boost::system::error_code ec;
+    fileSize = boost::filesystem::file_size(p, ec);
+    if(ec)
+        return false;
+    lastWriteTime = boost::filesystem::last_write_time(p, ec);
+    return !ec;
+}
+
+} // namespace
+
 LCPinfo* LCPdatabase::retrieveLCP(const std::string& lcpFilepath)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return retrieveLCPNoLock(lcpFilepath);
+}
+
+LCPinfo* LCPdatabase::retrieveLCPNoLock(const std::string& lcpFilepath)
 {
     if (lcpFilepath.empty())
     {
@@ -1067,15 +1132,192 @@ LCPinfo* LCPdatabase::retrieveLCP(const std::string& lcpFilepath)
     if(lcpCacheIt == _lcpCache.end())
     {
         // If not already in the cache, add it.
-        #pragma omp critical
-        _lcpCache[lcpFilepath] = LCPinfo(lcpFilepath, true);
-        lcpCacheIt = _lcpCache.find(lcpFilepath);
+        lcpCacheIt = _lcpCache.emplace(lcpFilepath, LCPinfo(lcpFilepath, true)).first;
     }
 
     // return the LCPinfo from the cache
     return &lcpCacheIt->second;
 }
 
+std::size_t LCPdatabase::buildIndex()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return buildIndexNoLock();
+}
+
+std::size_t LCPdatabase::buildIndexNoLock()
+{
+    // List the files which are not indexed yet
+    std::vector<std::string> filepaths;
+    for(const LcpPath& lcpPath : _lcpFilepaths)
+    {
+        const std::string filepath = lcpPath.path.string();
+        if(_lcpHeaderIndex.find(filepath) == _lcpHeaderIndex.end())
+            filepaths.push_back(filepath);
+    }
+
+    if(filepaths.empty())
+        return 0;
+
+    ALICEVISION_LOG_INFO("Index " << filepaths.size() << " LCP file header(s).");
+
+    std::vector<LcpHeader> headers(filepaths.size());
+
+    #pragma omp parallel for schedule(dynamic)
+    for(int i = 0; i < filepaths.size(); ++i)
+    {
+        LcpHeader& header = headers[i];
+        if(!getFileStamp(filepaths[i], header.fileSize, header.lastWriteTime))
+            continue;
+
+        try
+        {
+            const LCPinfo lcpHeader(filepaths[i], false);
+
+            header.cameraMaker = reduceString(lcpHeader.getCameraMaker());
+            header.cameraModel = reduceString(lcpHeader.getCameraModel());
+            header.cameraPrettyName = reduceString(lcpHeader.getCameraPrettyName());
+            header.lensPrettyName = reduceString(lcpHeader.getLensPrettyName());
+
+            std::vector<std::string> lensModels;
+            lcpHeader.getLensModels(lensModels);
+            header.lensModels = reduceStrings(lensModels);
+            lcpHeader.getLensIDs(header.lensIDs);
+            header.isRaw = lcpHeader.isRawProfile();
+            header.isValid = true;
+        }
+        catch(const std::exception& e)
+        {
+            ALICEVISION_LOG_WARNING("Cannot read the LCP file header \"" << filepaths[i] << "\": " << e.what());
+        }
+    }
+
+    for(std::size_t i = 0; i < filepaths.size(); ++i)
+        _lcpHeaderIndex[filepaths[i]] = std::move(headers[i]);
+
+    return filepaths.size();
+}
+
+bool LCPdatabase::loadIndex(const std::string& filepath)
+{
+    std::ifstream is(filepath, std::ios::binary);
+    if(!is.is_open())
+        return false;
+
+    std::uint32_t magic = 0;
+    std::uint32_t version = 0;
+    std::uint64_t nbHeaders = 0;
+    if(!readValue(is, magic) || !readValue(is, version) || magic != lcpIndexMagic || version != lcpIndexVersion ||
+       !readValue(is, nbHeaders))
+    {
+        ALICEVISION_LOG_WARNING("Invalid LCP index file: \"" << filepath << "\".");
+        return false;
+    }
+
+    // the fixed size part of each header: the file stamp, the flags, the sizes of the strings and of the lists
+    const std::uint64_t minHeaderSize = sizeof(std::uint32_t) + sizeof(std::uintmax_t) + sizeof(std::int64_t) +
+                                        2 * sizeof(bool) + 6 * sizeof(std::uint32_t);
+    if(nbHeaders > getRemainingSize(is) / minHeaderSize)
+    {
+        ALICEVISION_LOG_WARNING("Truncated LCP index file: \"" << filepath << "\".");
+        return false;
+    }
+
+    // Only keep the entries of files which are still in the database and have not been modified
+    std::map<std::string, const LcpPath*> lcpPaths;
+    for(const LcpPath& lcpPath : _lcpFilepaths)
+        lcpPaths.emplace(lcpPath.path.string(), &lcpPath);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    std::size_t nbLoaded = 0;
+    for(std::uint64_t i = 0; i < nbHeaders; ++i)
+    {
+        std::string lcpFilepath;
+        LcpHeader header;
+        std::uint32_t nbLensModels = 0;
+        std::uint32_t nbLensIDs = 0;
+
+        bool ok = readString(is, lcpFilepath) && readValue(is, header.fileSize) && readValue(is, header.lastWriteTime) &&
+                  readValue(is, header.isValid) && readString(is, header.cameraMaker) &&
+                  readString(is, header.cameraModel) && readString(is, header.cameraPrettyName) &&
+                  readString(is, header.lensPrettyName) && readValue(is, header.isRaw) && readValue(is, nbLensModels) &&
+                  nbLensModels <= getRemainingSize(is) / sizeof(std::uint32_t);
+        for(std::uint32_t j = 0; ok && j < nbLensModels; ++j)
+        {
+            header.lensModels.emplace_back();
+            ok = readString(is, header.lensModels.back());
+        }
+        ok = ok && readValue(is, nbLensIDs) && nbLensIDs <= getRemainingSize(is) / sizeof(int);
+        if(ok)
+        {
+            header.lensIDs.resize(nbLensIDs);
+            ok = bool(is.read(reinterpret_cast<char*>(header.lensIDs.data()), nbLensIDs * sizeof(int)));
+        }
+
+        if(!ok)
+        {
+            ALICEVISION_LOG_WARNING("Truncated LCP index file: \"" << filepath << "\".");
+            return false;
+        }
+
+        std::uintmax_t fileSize;
+        std::int64_t lastWriteTime;
+        if(lcpPaths.count(lcpFilepath) && getFileStamp(lcpFilepath, fileSize, lastWriteTime) &&
+           fileSize == header.fileSize && lastWriteTime == header.lastWriteTime)
+        {
+            _lcpHeaderIndex[lcpFilepath] = std::move(header);
+            ++nbLoaded;
+        }
+    }
+
+    ALICEVISION_LOG_INFO(nbLoaded << " LCP file header(s) loaded from the index file: \"" << filepath << "\".");
+    return true;
+}
+
+bool LCPdatabase::saveIndex(const std::string& filepath) const
+{
+    // write in a temporary file and rename it once complete, so a reader never sees a partial index
+    const std::string tmpFilepath = filepath + "." + boost::filesystem::unique_path().string();
+    std::ofstream os(tmpFilepath, std::ios::binary);
+    if(!os.is_open())
+        return false;
+
+    writeValue(os, lcpIndexMagic);
+    writeValue(os, lcpIndexVersion);
+    writeValue(os, std::uint64_t(_lcpHeaderIndex.size()));
+
+    for(const auto& headerPair : _lcpHeaderIndex)
+    {
+        const LcpHeader& header = headerPair.second;
+        writeString(os, headerPair.first);
+        writeValue(os, header.fileSize);
+        writeValue(os, header.lastWriteTime);
+        writeValue(os, header.isValid);
+        writeString(os, header.cameraMaker);
+        writeString(os, header.cameraModel);
+        writeString(os, header.cameraPrettyName);
+        writeString(os, header.lensPrettyName);
+        writeValue(os, header.isRaw);
+        writeValue(os, std::uint32_t(header.lensModels.size()));
+        for(const std::string& lensModel : header.lensModels)
+            writeString(os, lensModel);
+        writeValue(os, std::uint32_t(header.lensIDs.size()));
+        os.write(reinterpret_cast<const char*>(header.lensIDs.data()), header.lensIDs.size() * sizeof(int));
+    }
+    os.close();
+
+    boost::system::error_code ec;
+    if(os.good())
+        boost::filesystem::rename(tmpFilepath, filepath, ec);
+    if(!os.good() || ec)
+    {
+        boost::filesystem::remove(tmpFilepath, ec);
+        return false;
+    }
+    return true;
+}
+
 LCPinfo* LCPdatabase::findLCP(
                  const std::string& cameraMake,
                  const std::string& cameraModel,
@@ -1088,46 +1330,36 @@ LCPinfo* LCPdatabase::findLCP(
     const std::string reducedLensModel = reduceString(lensModel);
 
     const std::string lensUidStr = reducedCameraMake + reducedCameraModel + reducedLensModel;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
     const auto cachetoLcpPathIt = _lcpCameraMappingCache.find(lensUidStr);
     if(cachetoLcpPathIt != _lcpCameraMappingCache.end())
     {
-        return retrieveLCP(cachetoLcpPathIt->second);
+        return retrieveLCPNoLock(cachetoLcpPathIt->second);
     }
 
+    // The headers are parsed once for all the files of the database
+    buildIndexNoLock();
+
     for(const LcpPath& lcpPath : _lcpFilepaths)
     {
         const bool filepathContainsMake = (lcpPath.reducedPath.find(reducedCameraMake) != std::string::npos);
         if(!filepathContainsMake)
             continue;
 
-        auto headerIt = _lcpHeaderCache.find(lcpPath.reducedPath);
-        if(headerIt == _lcpHeaderCache.end())
-        {
-            // If not already in the cache of LCP headers, add it.
-            _lcpHeaderCache[lcpPath.path.string()] = LCPinfo(lcpPath.path.string(), false);
-            headerIt = _lcpHeaderCache.find(lcpPath.path.string());
-        }
-
-        const LCPinfo& lcpHeader = headerIt->second;
-
-        const std::string reducedCameraModelLCP =
-            reduceString(_omitCameraModel ? lcpHeader.getCameraMaker() : lcpHeader.getCameraModel());
-        const std::string reducedCameraPrettyNameLCP = reduceString(lcpHeader.getCameraPrettyName());
-        const std::string reducedLensPrettyNameLCP = reduceString(lcpHeader.getLensPrettyName());
-
-        std::vector<std::string> lensModelsLCP;
-        lcpHeader.getLensModels(lensModelsLCP);
-        const std::vector<std::string> reducedLensModelsLCP = reduceStrings(lensModelsLCP);
+        const LcpHeader& lcpHeader = _lcpHeaderIndex.at(lcpPath.path.string());
+        if(!lcpHeader.isValid)
+            continue;
 
-        std::vector<int> lensIDsLCP;
-        lcpHeader.getLensIDs(lensIDsLCP);
+        const std::string& reducedCameraModelLCP = _omitCameraModel ? lcpHeader.cameraMaker : lcpHeader.cameraModel;
 
         const bool cameraOK =
-            ((reducedCameraModelLCP == reducedCameraModel) || (reducedCameraPrettyNameLCP == reducedCameraModel));
-        const bool lensOK = ((reducedLensPrettyNameLCP.find(reducedLensModel) != std::string::npos) ||
-                       (std::find(reducedLensModelsLCP.begin(), reducedLensModelsLCP.end(), reducedLensModel) != reducedLensModelsLCP.end()));
-        const bool lensIDOK = (std::find(lensIDsLCP.begin(), lensIDsLCP.end(), lensID) != lensIDsLCP.end());
-        const bool isRaw = lcpHeader.isRawProfile();
+            ((reducedCameraModelLCP == reducedCameraModel) || (lcpHeader.cameraPrettyName == reducedCameraModel));
+        const bool lensOK = ((lcpHeader.lensPrettyName.find(reducedLensModel) != std::string::npos) ||
+                       (std::find(lcpHeader.lensModels.begin(), lcpHeader.lensModels.end(), reducedLensModel) != lcpHeader.lensModels.end()));
+        const bool lensIDOK = (std::find(lcpHeader.lensIDs.begin(), lcpHeader.lensIDs.end(), lensID) != lcpHeader.lensIDs.end());
+        const bool isRaw = lcpHeader.isRaw;
 
         const bool lcpFound =
             (cameraOK && lensOK && lensIDOK && ((isRaw && rawMode < 2) || (!isRaw && (rawMode % 2 == 0))));
@@ -1139,14 +1371,11 @@ LCPinfo* LCPdatabase::findLCP(
         _lcpCameraMappingCache[lensUidStr] = lcpPath.path.string();
 
         // Return the LCP from file or cache
-        return retrieveLCP(lcpPath.path.string());
+        return retrieveLCPNoLock(lcpPath.path.string());
     }
 
     // No LCP has been found, add an empty path for that key in order to speed up next search of it
-    if (_lcpCameraMappingCache.find(lensUidStr) == _lcpCameraMappingCache.end())
-    {
-        _lcpCameraMappingCache[lensUidStr] = "";
-    }
+    _lcpCameraMappingCache[lensUidStr] = "";
 
     return nullptr;
 }
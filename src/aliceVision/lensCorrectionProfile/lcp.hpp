@@ -2,10 +2,12 @@
 
 #include <boost/filesystem/path.hpp>
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <sstream>
 #include <map>
+#include <mutex>
 
 enum class LCPCorrectionMode
 {
@@ -577,6 +579,9 @@ std::vector<std::string> reduceStrings(const std::vector<std::string>& v_str);
 
 /**
  * @brief LCPdatabase allows to access all the LCP files in the database.
+ *
+ * The headers of the LCP files are indexed once (camera, lens names and IDs), the index can be saved to a binary file
+ * to be reused by the next runs. The fully loaded LCP files are cached and shared between threads.
  */
 class LCPdatabase
 {
@@ -606,6 +611,27 @@ public:
      */
     LCPinfo* retrieveLCP(const std::string& p);
 
+    /**
+     * @brief Index the headers of the LCP files which are not already indexed, the files are parsed in parallel.
+     * @return the number of parsed files
+     */
+    std::size_t buildIndex();
+
+    /**
+     * @brief Load the headers index from a binary file written by saveIndex.
+     * The entries of files which are no longer in the database or have been modified are ignored.
+     * @param[in] filepath The index file
+     * @return false if the file cannot be read
+     */
+    bool loadIndex(const std::string& filepath);
+
+    /**
+     * @brief Save the headers index to a binary file.
+     * @param[in] filepath The index file
+     * @return false if the file cannot be written
+     */
+    bool saveIndex(const std::string& filepath) const;
+
     /**
      * @brief Try to find an appropriate LCP file for a set of camera and lens information amongst a set of files. If a
      * file is found, load its content.
@@ -635,14 +661,36 @@ private:
         std::string reducedPath;
     };
 
+    /// Reduced names of the LCP header used by findLCP
+    struct LcpHeader
+    {
+        /// File size and modification time, to detect modified files
+        std::uintmax_t fileSize = 0;
+        std::int64_t lastWriteTime = 0;
+        /// false if the header cannot be parsed
+        bool isValid = false;
+        std::string cameraMaker;
+        std::string cameraModel;
+        std::string cameraPrettyName;
+        std::string lensPrettyName;
+        std::vector<std::string> lensModels;
+        std::vector<int> lensIDs;
+        bool isRaw = false;
+    };
+
+    std::size_t buildIndexNoLock();
+    LCPinfo* retrieveLCPNoLock(const std::string& lcpFilepath);
+
     /// List of all LCP files
     std::vector<LcpPath> _lcpFilepaths;
-    /// Cache the header of LCP files
-    std::map<std::string, LCPinfo> _lcpHeaderCache;
+    /// Index of the LCP headers, by filepath
+    std::map<std::string, LcpHeader> _lcpHeaderIndex;
     /// Cache of fully loaded LCP files
     std::map<std::string, LCPinfo> _lcpCache;
     /// Map the label from the camera to the matching LCP filepath
     std::map<std::string, std::string> _lcpCameraMappingCache;
+    /// Protect the index and the caches
+    std::mutex _mutex;
     /// The matching could be strict and fully match the camera Make, Model and Lens.
     /// As we are looking for lens information, we can omit the CameraModel to get generic values valid for more lenses.
     bool _omitCameraModel = false;
@@ -7,6 +7,7 @@
 #include "lightingEstimation.hpp"
 #include "augmentedNormals.hpp"
 
+#include <aliceVision/alicevision_omp.hpp>
 #include <aliceVision/system/Logger.hpp>
 
 #include <Eigen/Dense>
@@ -18,111 +19,106 @@ namespace aliceVision {
 namespace lightingEstimation {
 
 /**
- * @brief Evaluate albedo and normal product for one channel
+ * @brief Accumulate the normal equations of the albedo and normal products for one channel
+ * @param[in] albedoChannel the albedo channel values, with a stride of channelStride floats
+ * @param[in] pictureChannel the picture channel values, with a stride of channelStride floats
  */
-void albedoNormalsProduct(MatrixXf& rhoTimesN, const MatrixXf& albedoChannel, const image::Image<AugmentedNormal>& augmentedNormals)
+void accumulateImageData(const float* albedoChannel,
+                         const float* pictureChannel,
+                         std::size_t channelStride,
+                         const image::Image<AugmentedNormal>& augmentedNormals,
+                         Eigen::MatrixXd& AtA,
+                         Eigen::VectorXd& Atb,
+                         std::size_t& nbPoints)
 {
-    std::size_t validIndex = 0;
-    for (int i = 0; i < augmentedNormals.size(); ++i)
+  AtA = Eigen::MatrixXd::Zero(9, 9);
+  Atb = Eigen::VectorXd::Zero(9);
+  nbPoints = 0;
+
+  const int nbPixels = augmentedNormals.size();
+
+  #pragma omp parallel
+  {
+    Eigen::Matrix<double, 9, 9> localAtA = Eigen::Matrix<double, 9, 9>::Zero();
+    Eigen::Matrix<double, 9, 1> localAtb = Eigen::Matrix<double, 9, 1>::Zero();
+    std::size_t localNbPoints = 0;
+
+    #pragma omp for
+    for(int i = 0; i < nbPixels; ++i)
     {
-      // If the normal is undefined
-      if(augmentedNormals(i).nx() == -1.0f && augmentedNormals(i).ny() == -1.0f && augmentedNormals(i).nz() == -1.0f)
-      {
+      const AugmentedNormal& augmentedNormal = augmentedNormals(i);
+
+      // if the normal is undefined
+      if(augmentedNormal.nx() == -1.0f && augmentedNormal.ny() == -1.0f && augmentedNormal.nz() == -1.0f)
         continue;
-      }
-      rhoTimesN(validIndex, 0) = albedoChannel(i) * augmentedNormals(i).nx();
-      rhoTimesN(validIndex, 1) = albedoChannel(i) * augmentedNormals(i).ny();
-      rhoTimesN(validIndex, 2) = albedoChannel(i) * augmentedNormals(i).nz();
-      rhoTimesN(validIndex, 3) = albedoChannel(i) * augmentedNormals(i).nambiant();
-      rhoTimesN(validIndex, 4) = albedoChannel(i) * augmentedNormals(i).nx_ny();
-      rhoTimesN(validIndex, 5) = albedoChannel(i) * augmentedNormals(i).nx_nz();
-      rhoTimesN(validIndex, 6) = albedoChannel(i) * augmentedNormals(i).ny_nz();
-      rhoTimesN(validIndex, 7) = albedoChannel(i) * augmentedNormals(i).nx2_ny2();
-      rhoTimesN(validIndex, 8) = albedoChannel(i) * augmentedNormals(i).nz2();
-      ++validIndex;
+
+      // row of rhoTimesN: albedo times augmented normal
+      const Eigen::Matrix<double, 9, 1> rhoTimesN = (albedoChannel[i * channelStride] * augmentedNormal).cast<double>();
+
+      localAtA.selfadjointView<Eigen::Lower>().rankUpdate(rhoTimesN);
+      localAtb += rhoTimesN * double(pictureChannel[i * channelStride]);
+      ++localNbPoints;
     }
+
+    #pragma omp critical(lightingEstimation_accumulateImageData)
+    {
+      AtA += localAtA;
+      Atb += localAtb;
+      nbPoints += localNbPoints;
+    }
+  }
+
+  AtA.triangularView<Eigen::StrictlyUpper>() = AtA.transpose();
 }
 
-void prepareImageData(const MatrixXf& albedo,
-                      const MatrixXf& picture,
-                      const image::Image<AugmentedNormal>& augmentedNormals,
-                      MatrixXf& rhoTimesN,
-                      MatrixXf& colors)
+void LighthingEstimator::addChannel(std::size_t channel, const Eigen::MatrixXd& AtA, const Eigen::VectorXd& Atb, std::size_t nbPoints)
 {
-  std::size_t nbValidPoints = 0;
+  std::lock_guard<std::mutex> lock(_mutex);
 
-  for(int i = 0; i < augmentedNormals.size(); ++i)
+  if(_nbPoints.at(channel) == 0)
   {
-    // if the normal is undefined
-    if(augmentedNormals(i).nx() == -1.0f && augmentedNormals(i).ny() == -1.0f && augmentedNormals(i).nz() == -1.0f)
-      continue;
-    ++nbValidPoints;
+    _AtA.at(channel) = AtA;
+    _Atb.at(channel) = Atb;
   }
-
-  rhoTimesN.resize(nbValidPoints, 9);
-  albedoNormalsProduct(rhoTimesN, albedo, augmentedNormals);
-  colors.resize(nbValidPoints, 1);
-
+  else
   {
-    std::size_t validIndex = 0;
-    for(int i = 0; i < augmentedNormals.size(); ++i)
-    {
-      // if the normal is undefined
-      if(augmentedNormals(i).nx() == -1.0f && augmentedNormals(i).ny() == -1.0f && augmentedNormals(i).nz() == -1.0f)
-        continue;
-
-      colors(validIndex++) = picture(i);
-    }
+    _AtA.at(channel) += AtA;
+    _Atb.at(channel) += Atb;
   }
+  _nbPoints.at(channel) += nbPoints;
 }
 
 void LighthingEstimator::addImage(const image::Image<float>& albedo, const image::Image<float>& picture, const image::Image<image::RGBfColor>& normals)
 {
-  using namespace Eigen;
-
   // augmented normales
   image::Image<AugmentedNormal> augmentedNormals(normals.cast<AugmentedNormal>());
 
-  const std::size_t nbPixels = augmentedNormals.Width() * augmentedNormals.Height();
-
-  MatrixXf rhoTimesN;
-  MatrixXf colors;
+  Eigen::MatrixXd AtA;
+  Eigen::VectorXd Atb;
+  std::size_t nbPoints;
 
-  // map albedo, image
-  Map<const MatrixXf> channelAlbedo(albedo.data(), nbPixels, 1);
-  Map<const MatrixXf> channelPicture(picture.data(), nbPixels, 1);
-
-  prepareImageData(channelAlbedo, channelPicture, augmentedNormals, rhoTimesN, colors);
+  accumulateImageData(albedo.data(), picture.data(), 1, augmentedNormals, AtA, Atb, nbPoints);
 
   // store image data
-  _all_rhoTimesN.at(0).push_back(rhoTimesN);
-  _all_pictureChannel.at(0).push_back(colors);
+  addChannel(0, AtA, Atb, nbPoints);
 }
 
 void LighthingEstimator::addImage(const image::Image<image::RGBfColor>& albedo, const image::Image<image::RGBfColor>& picture, const image::Image<image::RGBfColor>& normals)
 {
-  using namespace Eigen;
-
   // augmented normales
   image::Image<AugmentedNormal> augmentedNormals(normals.cast<AugmentedNormal>());
 
-  const std::size_t nbPixels = augmentedNormals.Width() * augmentedNormals.Height();
-
   // estimate lighting per channel
   for(std::size_t channel = 0; channel < 3; ++channel)
   {
-    MatrixXf rhoTimesN;
-    MatrixXf colors;
-
-    // map albedo, image
-    Map<const MatrixXf, 0, InnerStride<3>> channelAlbedo(static_cast<const float*>(&(albedo(0,0)(channel))), nbPixels, 1);
-    Map<const MatrixXf, 0, InnerStride<3>> channelPicture(static_cast<const float*>(&(picture(0,0)(channel))), nbPixels, 1);
+    Eigen::MatrixXd AtA;
+    Eigen::VectorXd Atb;
+    std::size_t nbPoints;
 
-    prepareImageData(channelAlbedo, channelPicture, augmentedNormals, rhoTimesN, colors);
+    accumulateImageData(&(albedo(0,0)(channel)), &(picture(0,0)(channel)), 3, augmentedNormals, AtA, Atb, nbPoints);
 
     // store image data
-    _all_rhoTimesN.at(channel).push_back(rhoTimesN);
-    _all_pictureChannel.at(channel).push_back(colors);
+    addChannel(channel, AtA, Atb, nbPoints);
   }
 }
 
@@ -133,7 +129,7 @@ void LighthingEstimator::estimateLigthing(LightingVector& lighting) const
   // check number of channels
   for(int channel = 0; channel < 3; ++channel)
   {
-    if(_all_rhoTimesN.at(channel).empty())
+    if(_nbPoints.at(channel) == 0)
     {
       nbChannels = channel;
       break;
@@ -143,46 +139,10 @@ void LighthingEstimator::estimateLigthing(LightingVector& lighting) const
   // for each channel
   for(int channel = 0; channel < nbChannels; ++channel)
   {
-    std::size_t nbRows_all_rhoTimesN = 0;
-    std::size_t nbRows_all_pictureChannel = 0;
-
-    // count and check matrices rows
-    {
-      for(const MatrixXf& matrix : _all_rhoTimesN.at(channel))
-        nbRows_all_rhoTimesN += matrix.rows();
-
-      for(const MatrixXf& matrix : _all_pictureChannel.at(channel))
-        nbRows_all_pictureChannel += matrix.rows();
-
-      assert(nbRows_all_rhoTimesN == nbRows_all_pictureChannel);
-    }
-
-    // agglomerate rhoTimesN
-    MatrixXf rhoTimesN(nbRows_all_rhoTimesN, 9);
-    {
-      std::size_t nbRow = 0;
-      for(const MatrixXf& matrix : _all_rhoTimesN.at(channel))
-      {
-        for(int matrixRow = 0; matrixRow < matrix.rows(); ++matrixRow)
-          rhoTimesN.row(nbRow + matrixRow) = matrix.row(matrixRow);
-        nbRow += matrix.rows();
-      }
-    }
-
-    // agglomerate pictureChannel
-    MatrixXf pictureChannel(nbRows_all_pictureChannel, 1);
-    {
-      std::size_t nbRow = 0;
-      for(const MatrixXf& matrix : _all_pictureChannel.at(channel))
-      {
-        for(int matrixRow = 0; matrixRow < matrix.rows(); ++matrixRow)
-          pictureChannel.row(nbRow + matrixRow) = matrix.row(matrixRow);
-        nbRow += matrix.rows();
-      }
-    }
+    ALICEVISION_LOG_INFO("estimate ligthing channel: rhoTimesN(" << _nbPoints.at(channel) << "x9)");
 
-    ALICEVISION_LOG_INFO("estimate ligthing channel: rhoTimesN(" << rhoTimesN.rows() << "x" << rhoTimesN.cols()<< ")");
-    Eigen::Matrix<float, 9, 1> lightingC = rhoTimesN.colPivHouseholderQr().solve(pictureChannel);
+    // the rank revealing decomposition keeps the solution of rank deficient systems
+    const Eigen::Matrix<float, 9, 1> lightingC = _AtA.at(channel).colPivHouseholderQr().solve(_Atb.at(channel)).cast<float>();
 
     // lighting vectors fusion
     lighting.col(channel) = lightingC;
@@ -198,8 +158,10 @@ void LighthingEstimator::estimateLigthing(LightingVector& lighting) const
 
 void LighthingEstimator::clear()
 {
-  _all_rhoTimesN = std::array<std::vector<MatrixXf>, 3>();
-  _all_pictureChannel = std::array<std::vector<MatrixXf>, 3>();
+  std::lock_guard<std::mutex> lock(_mutex);
+  _AtA = std::array<Eigen::MatrixXd, 3>();
+  _Atb = std::array<Eigen::VectorXd, 3>();
+  _nbPoints = {0, 0, 0};
 }
 
 } // namespace lightingEstimation
@@ -13,7 +13,9 @@
 #include <Eigen/Core>
 #include <Eigen/Dense>
 
+#include <array>
 #include <iostream>
+#include <mutex>
 
 namespace aliceVision {
 namespace lightingEstimation {
@@ -29,6 +31,8 @@ using LightingVector = Eigen::Matrix<float, 9, 3>;
 /**
  * @brief The LighthingEstimator class
  * Allows to estimate LightingVector from a single image or multiple images
+ * The images are accumulated in the normal equations of the least squares system of each channel,
+ * so the memory does not depend on the number of images, and images can be added from multiple threads.
  * @warning Image pixel type can be:
  * - RGB (float) for light and color estimation
  * - Greyscale (float) for luminance estimation
@@ -38,7 +42,7 @@ class LighthingEstimator
 public:
 
   /**
-   * @brief Aggregate image data
+   * @brief Aggregate image data, thread safe
    * @param albedo[in] the corresponding albedo image
    * @param picture[in] the corresponding picture
    * @param normals[in] the corresponding normals image
@@ -58,8 +62,17 @@ public:
   void clear();
 
 private:
-  std::array<std::vector<MatrixXf>, 3> _all_rhoTimesN;
-  std::array<std::vector<MatrixXf>, 3> _all_pictureChannel;
+  /**
+   * @brief Add the normal equations of one image channel
+   */
+  void addChannel(std::size_t channel, const Eigen::MatrixXd& AtA, const Eigen::VectorXd& Atb, std::size_t nbPoints);
+
+  /// Normal equations (rhoTimesN^T * rhoTimesN, rhoTimesN^T * pictureChannel) of each channel
+  std::array<Eigen::MatrixXd, 3> _AtA;
+  std::array<Eigen::VectorXd, 3> _Atb;
+  /// Number of valid pixels of each channel
+  std::array<std::size_t, 3> _nbPoints = {0, 0, 0};
+  std::mutex _mutex;
 };
 
 } // namespace lightingEstimation
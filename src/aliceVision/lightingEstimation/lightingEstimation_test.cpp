@@ -9,6 +9,8 @@
 #include <cmath>
 #include <cstdio>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 #define BOOST_TEST_MODULE LIGHTING_ESTIMATION
 
@@ -137,3 +139,121 @@ BOOST_AUTO_TEST_CASE(LIGHTING_ESTIMATION_Lambertian_noise)
 
 
 
+/**
+ * @brief Generate a picture of random albedo and normals under the given lighting,
+ * the normals of the first row are undefined
+ */
+void generateLambertianImage(const LightingVector& lighting,
+                             std::size_t sx, std::size_t sy,
+                             Image<RGBfColor>& albedo,
+                             Image<RGBfColor>& normals,
+                             Image<RGBfColor>& picture)
+{
+  albedo.resize(sx, sy);
+  normals.resize(sx, sy);
+  picture.resize(sx, sy);
+
+  for(std::size_t y = 0; y < sy; ++y)
+  {
+    for(std::size_t x = 0; x < sx; ++x)
+    {
+      albedo(y, x) = RGBfColor(zeroOneRand(), zeroOneRand(), zeroOneRand());
+
+      if(y == 0)
+      {
+        // undefined normal, with a picture value unrelated to the lighting
+        normals(y, x) = RGBfColor(-1.0f, -1.0f, -1.0f);
+        picture(y, x) = RGBfColor(zeroOneRand(), zeroOneRand(), zeroOneRand());
+        continue;
+      }
+
+      RGBfColor n(zeroOneRand(), zeroOneRand(), zeroOneRand());
+      n.normalize();
+      normals(y, x) = n;
+
+      const AugmentedNormal agmNormal(n(0), n(1), n(2));
+      for(std::size_t ch = 0; ch < 3; ++ch)
+        picture(y, x)(ch) = albedo(y, x)(ch) * agmNormal.dot(lighting.col(ch));
+    }
+  }
+}
+
+
+BOOST_AUTO_TEST_CASE(LIGHTING_ESTIMATION_Lambertian_multipleImages_threads)
+{
+  makeRandomOperationsReproducible();
+
+  const std::size_t nbImages = 8;
+  const LightingVector lightingSynt = MatrixXf::Random(9, 3).cwiseAbs();
+
+  std::vector<Image<RGBfColor>> albedos(nbImages);
+  std::vector<Image<RGBfColor>> normals(nbImages);
+  std::vector<Image<RGBfColor>> pictures(nbImages);
+
+  // images of different sizes
+  for(std::size_t i = 0; i < nbImages; ++i)
+    generateLambertianImage(lightingSynt, 40 + 10 * i, 30, albedos.at(i), normals.at(i), pictures.at(i));
+
+  // serial accumulation
+  LighthingEstimator serialEstimator;
+  for(std::size_t i = 0; i < nbImages; ++i)
+    serialEstimator.addImage(albedos.at(i), pictures.at(i), normals.at(i));
+
+  LightingVector lightingSerial;
+  serialEstimator.estimateLigthing(lightingSerial);
+
+  // the images are added concurrently
+  LighthingEstimator threadsEstimator;
+  {
+    std::vector<std::thread> threads;
+    for(std::size_t i = 0; i < nbImages; ++i)
+      threads.emplace_back([&, i]() { threadsEstimator.addImage(albedos.at(i), pictures.at(i), normals.at(i)); });
+    for(std::thread& thread : threads)
+      thread.join();
+  }
+
+  LightingVector lightingThreads;
+  threadsEstimator.estimateLigthing(lightingThreads);
+
+  // only the summation order differs
+  EXPECT_MATRIX_NEAR(lightingThreads, lightingSerial, 1e-4f);
+  // the undefined normals are ignored
+  EXPECT_MATRIX_NEAR(lightingThreads, lightingSynt, 1e-3f);
+
+  // the estimator is reset
+  threadsEstimator.clear();
+  threadsEstimator.addImage(albedos.front(), pictures.front(), normals.front());
+  threadsEstimator.estimateLigthing(lightingThreads);
+  EXPECT_MATRIX_NEAR(lightingThreads, lightingSynt, 1e-3f);
+}
+
+
+BOOST_AUTO_TEST_CASE(LIGHTING_ESTIMATION_Lambertian_luminance)
+{
+  makeRandomOperationsReproducible();
+
+  LightingVector lightingSynt;
+  lightingSynt.col(0) = Matrix<float, 9, 1>::Random().cwiseAbs();
+  lightingSynt.col(1) = lightingSynt.col(0);
+  lightingSynt.col(2) = lightingSynt.col(0);
+
+  Image<RGBfColor> albedoRGB, normals, pictureRGB;
+  generateLambertianImage(lightingSynt, 60, 40, albedoRGB, normals, pictureRGB);
+
+  // grayscale images, from the first channel
+  Image<float> albedo(albedoRGB.Width(), albedoRGB.Height());
+  Image<float> picture(pictureRGB.Width(), pictureRGB.Height());
+  for(int i = 0; i < albedo.size(); ++i)
+  {
+    albedo(i) = albedoRGB(i).r();
+    picture(i) = pictureRGB(i).r();
+  }
+
+  LighthingEstimator estimator;
+  estimator.addImage(albedo, picture, normals);
+
+  // the luminance lighting is copied to the 3 channels
+  LightingVector lightingEst;
+  estimator.estimateLigthing(lightingEst);
+  EXPECT_MATRIX_NEAR(lightingEst, lightingSynt, 1e-3f);
+}
@@ -91,6 +91,10 @@ public:
   /// Get back solution. Call it after solve.
   virtual bool getSolution(std::vector<double> & estimatedParams) = 0;
 
+  /// Start each solve from the basis of the previous one, when the problem keeps the same dimensions.
+  /// Useful for a sequence of close problems, as the bisection steps.
+  virtual void setWarmStart(bool warmStart) {}
+
 protected :
   int _nbParams; // The number of parameter considered in constraint formulation.
 };
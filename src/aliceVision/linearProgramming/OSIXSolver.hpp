@@ -19,6 +19,7 @@
 
 #include "CoinPackedMatrix.hpp"
 #include "CoinPackedVector.hpp"
+#include "CoinWarmStart.hpp"
 
 #include <vector>
 
@@ -45,8 +46,15 @@ public :
 
   bool getSolution(std::vector<double> & estimatedParams);
 
+  void setWarmStart(bool warmStart);
+
 private :
   SOLVERINTERFACE *si;
+
+  bool _warmStart = false;
+  CoinWarmStart *_basis = nullptr; // basis of the last solve
+  int _basisNbRows = 0;
+  int _basisNbCols = 0;
 };
 
 
@@ -82,6 +90,7 @@ OSIXSolver<SOLVERINTERFACE>::~OSIXSolver()
     delete si;
     si = nullptr;
   }
+  delete _basis;
 }
 
 template<typename SOLVERINTERFACE>
@@ -126,7 +135,8 @@ bool OSIXSolver<SOLVERINTERFACE>::setup(const LPConstraints & cstraints) //cstra
       int coef = 1;
       for ( int j = 0; j < A.cols() ; j++ )
       {
-        row.insert(j, coef * temp.data()[j]);
+        if (temp.data()[j] != 0.0)
+          row.insert(j, coef * temp.data()[j]);
       }
       row_lb[indexRow] = -1.0 * si->getInfinity();
       row_ub[indexRow] = coef * cstraints._Cst_objective(i);
@@ -138,7 +148,8 @@ bool OSIXSolver<SOLVERINTERFACE>::setup(const LPConstraints & cstraints) //cstra
       int coef = -1;
       for ( int j = 0; j < A.cols() ; j++ )
       {
-	      row.insert(j, coef * temp.data()[j]);
+        if (temp.data()[j] != 0.0)
+	        row.insert(j, coef * temp.data()[j]);
       }
       row_lb[indexRow] = -1.0 * si->getInfinity();
       row_ub[indexRow] = coef * cstraints._Cst_objective(i);
@@ -202,13 +213,17 @@ bool OSIXSolver<SOLVERINTERFACE>::setup(const LPConstraintsSparse & cstraints) /
 
   CoinPackedMatrix * matrix = new CoinPackedMatrix(false,0,0);
   matrix->setDimensions(0, NUMVAR);
+  // an equality row is appended twice
+  matrix->reserve(nbLine, 2 * A.nonZeros());
 
   //-- Add row-wise constraint
   size_t rowindex = 0;
+  std::vector<int> vec_colno;
+  std::vector<double> vec_value;
   for (int i=0; i < A.rows(); ++i)
   {
-    std::vector<int> vec_colno;
-    std::vector<double> vec_value;
+    vec_colno.clear();
+    vec_value.clear();
     for (sRMat::InnerIterator it(A,i); it; ++it)
     {
       vec_colno.push_back(it.col());
@@ -284,7 +299,24 @@ bool OSIXSolver<SOLVERINTERFACE>::solve()
   if ( si != nullptr )
   {
     si->getModelPtr()->setPerturbation(50);
-    si->initialSolve();
+    if (_warmStart && _basis != nullptr &&
+        _basisNbRows == si->getNumRows() && _basisNbCols == si->getNumCols())
+    {
+      si->setWarmStart(_basis);
+      si->resolve();
+    }
+    else
+    {
+      si->initialSolve();
+    }
+
+    if (_warmStart)
+    {
+      delete _basis;
+      _basis = si->getWarmStart();
+      _basisNbRows = si->getNumRows();
+      _basisNbCols = si->getNumCols();
+    }
     return si->isProvenOptimal();
   }
   return false;
@@ -302,6 +334,17 @@ bool OSIXSolver<SOLVERINTERFACE>::getSolution(std::vector<double> & estimatedPar
   return false;
 }
 
+template<typename SOLVERINTERFACE>
+void OSIXSolver<SOLVERINTERFACE>::setWarmStart(bool warmStart)
+{
+  _warmStart = warmStart;
+  if (!_warmStart)
+  {
+    delete _basis;
+    _basis = nullptr;
+  }
+}
+
 } // namespace linearProgramming
 } // namespace aliceVision
 
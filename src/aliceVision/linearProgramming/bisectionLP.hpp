@@ -22,6 +22,7 @@ namespace linearProgramming  {
 /// http://en.wikipedia.org/wiki/Bisection_method
 /// The bisection algorithm continue as long as
 ///  precision or max iteration number is not reach.
+/// The problems only differ by gamma, so each solve starts from the basis of the previous one.
 ///
 template <typename ConstraintBuilder, typename ConstraintType>
 bool BisectionLP(
@@ -38,6 +39,7 @@ bool BisectionLP(
   int k = 0;
   bool bModelFound = false;
   ConstraintType constraint;
+  solver.setWarmStart(true);
   do
   {
     ++k; // One more iteration
@@ -65,6 +65,8 @@ inline void EncodeTi_from_tij(
   const size_t NVar = 3 * Ncam + Nrelative + 1; // { {X,Y,Z}; {Lambdas}; Gamma }
 
   A.resize(Nconstraint, NVar);
+  // reserve the non-zeros of each row, so the coefficients are inserted without moving the previous ones
+  A.reserve(Eigen::VectorXi::Constant(Nconstraint, 6));
 
   C.resize(Nconstraint, 1);
   C.fill(0.0);
@@ -152,6 +154,7 @@ inline void EncodeTi_from_tij(
       ++rowPos;
     }
   } // end for (k)
+  A.makeCompressed();
 #undef TVAR
 #undef LAMBDAVAR
 #undef GAMMAVAR
@@ -65,6 +65,8 @@ inline void EncodeTi_from_tij_OneLambdaPerTrif(
   const size_t NVar = 3 * Ncam + Nrelative/3 + 1;
 
   A.resize(Nconstraint, NVar);
+  // at most 6 non-zeros per row (2 translations, 1 lambda, gamma)
+  A.reserve(Eigen::VectorXi::Constant(Nconstraint, 6));
 
   C.resize(Nconstraint, 1);
   C.fill(0.0);
@@ -152,6 +154,7 @@ inline void EncodeTi_from_tij_OneLambdaPerTrif(
       ++rowPos;
     }
   } // end for (k)
+  A.makeCompressed();
 #undef TVAR
 #undef LAMBDAVAR
 #undef GAMMAVAR
@@ -57,6 +57,8 @@ inline void EncodeResection(const Mat2X & Pt2D,
   assert(Pt2D.cols() >= 6 && "The problem requires at least 6 points");
 
   A.resize(Nobs * 5, 11);
+  // each row uses at most 7 of the 11 parameters
+  A.reserve(Eigen::VectorXi::Constant(Nobs * 5, 7));
 
   C.resize(Nobs * 5, 1);
   C.fill(0.0);
@@ -134,6 +136,7 @@ inline void EncodeResection(const Mat2X & Pt2D,
     C(cptj) = gamma - pt2d(0);
     C(cptj+1) = gamma - pt2d(1);
   }
+  A.makeCompressed();
 }
 
 /// Kernel that set Linear constraints for the
@@ -62,6 +62,7 @@ inline void EncodeTiXi(const Mat & M, //Scene representation
   assert(Ncam == Ri.size());
 
   A.resize(5 * Nobs, 3 * (N3D + Ncam));
+  A.reserve(Eigen::VectorXi::Constant(5 * Nobs, 5));
 
   C.resize(5 * Nobs, 1);
   C.fill(0.0);
@@ -143,6 +144,7 @@ inline void EncodeTiXi(const Mat & M, //Scene representation
     vec_sign[rowPos] = LPConstraints::LP_LESS_OR_EQUAL;
     ++rowPos;
   }
+  A.makeCompressed();
 # undef TVAR
 # undef XVAR
 }
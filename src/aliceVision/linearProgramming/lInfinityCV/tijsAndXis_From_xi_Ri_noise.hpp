@@ -66,6 +66,7 @@ inline void EncodeTiXi_withNoise(const Mat & M, //Scene representation
   assert(Ncam == Ri.size());
 
   A.resize(5*Nobs+3, 3 * (Ncam + N3D + Nobs));
+  A.reserve(Eigen::VectorXi::Constant(5 * Nobs + 3, 6));
 
   C.resize(5 * Nobs + 3, 1);
   C.fill(0.0);
@@ -174,6 +175,7 @@ inline void EncodeTiXi_withNoise(const Mat & M, //Scene representation
   A.coeffRef(rowPos, TVAR(0, 0)) = 1.0; C(rowPos) = 0.0; vec_sign[rowPos] = LPConstraints::LP_EQUAL; ++rowPos;
   A.coeffRef(rowPos, TVAR(0, 1)) = 1.0; C(rowPos) = 0.0; vec_sign[rowPos] = LPConstraints::LP_EQUAL; ++rowPos;
   A.coeffRef(rowPos, TVAR(0, 2)) = 1.0; C(rowPos) = 0.0; vec_sign[rowPos] = LPConstraints::LP_EQUAL; ++rowPos;
+  A.makeCompressed();
 
 # undef TVAR
 # undef XVAR
@@ -411,20 +411,29 @@ bool CCTagLocalizer::localizeRig(const std::vector<image::Image<float>> & vec_im
   std::vector<feature::MapRegionsPerDesc> vec_queryRegions(numCams);
   std::vector<std::pair<std::size_t, std::size_t> > vec_imageSize;
   
-  //@todo parallelize?
+  // cctag image describer don't support float image
+  std::vector<image::Image<unsigned char>> vec_imageGrayUChar(numCams);
+  std::vector<const image::Image<unsigned char>*> vec_images;
   for(size_t i = 0; i < numCams; ++i)
   {
-    image::Image<unsigned char> imageGrayUChar; // cctag image describer don't support float image
-    imageGrayUChar = (vec_imageGrey.at(i).GetMat() * 255.f).cast<unsigned char>();
-
-    // extract descriptors and features from each image
-    ALICEVISION_LOG_DEBUG("[features]\tExtract CCTag from query image...");
-    _imageDescriber.setConfigurationPreset(param->_featurePreset);
-    _imageDescriber.describe(imageGrayUChar, vec_queryRegions[i][_imageDescriber.getDescriberType()]);
-    ALICEVISION_LOG_DEBUG("[features]\tExtract CCTAG done: found " <<  vec_queryRegions[i].at(_imageDescriber.getDescriberType())->RegionCount() << " features");
+    vec_imageGrayUChar[i] = (vec_imageGrey.at(i).GetMat() * 255.f).cast<unsigned char>();
+    vec_images.push_back(&vec_imageGrayUChar[i]);
     // add the image size for this image
     vec_imageSize.emplace_back(vec_imageGrey[i].Width(), vec_imageGrey[i].Height());
   }
+
+  // extract descriptors and features from the images of all cameras, one CUDA pipe per camera
+  ALICEVISION_LOG_DEBUG("[features]\tExtract CCTag from query images...");
+  std::vector<std::unique_ptr<feature::Regions>> vec_regions;
+  _imageDescriber.setCudaPipe(_cudaPipe);
+  _imageDescriber.setNbCudaPipes(numCams);
+  _imageDescriber.setConfigurationPreset(param->_featurePreset);
+  _imageDescriber.describeBatch(vec_images, vec_regions);
+  for(size_t i = 0; i < numCams; ++i)
+  {
+    ALICEVISION_LOG_DEBUG("[features]\tExtract CCTAG done: found " <<  vec_regions[i]->RegionCount() << " features");
+    vec_queryRegions[i][_imageDescriber.getDescriberType()] = std::move(vec_regions[i]);
+  }
   assert(vec_imageSize.size() == vec_queryRegions.size());
           
   return localizeRig(vec_queryRegions,
@@ -0,0 +1,284 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "PrioritizedSearchLocalizer.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+#include <unordered_set>
+
+namespace aliceVision {
+namespace localization {
+
+PrioritizedSearchLocalizer::PrioritizedSearchLocalizer(const sfmData::SfMData &sfmData,
+                                                       const std::string &descriptorsFolder,
+                                                       const std::string &vocTreeFilepath,
+                                                       const std::string &weightsFilepath,
+                                                       const std::vector<feature::EImageDescriberType>& matchingDescTypes,
+                                                       const std::string &wordsCacheFolder,
+                                                       const std::string &databaseFile)
+  : VoctreeLocalizer(sfmData, descriptorsFolder, vocTreeFilepath, weightsFilepath, matchingDescTypes, wordsCacheFolder, databaseFile)
+{
+  if(!_isInit)
+    return;
+
+  std::vector<IndexT> viewIds;
+  for(const auto& mappingIt : _reconstructedRegionsMappingPerView)
+  {
+    if(mappingIt.second.count(_voctreeDescType) && _regionsPerView.getRegionsPerDesc(mappingIt.first).count(_voctreeDescType))
+      viewIds.push_back(mappingIt.first);
+  }
+
+  // quantize the features of the 3D points of each database image
+  std::vector<std::vector<PointFeature>> pointFeaturesPerView(viewIds.size());
+#pragma omp parallel for schedule(dynamic)
+  for(int i = 0; i < static_cast<int>(viewIds.size()); ++i)
+  {
+    const IndexT viewId = viewIds[i];
+    const feature::Regions& regions = _regionsPerView.getRegions(viewId, _voctreeDescType);
+    const std::vector<IndexT>& associated3dPoints = _reconstructedRegionsMappingPerView.at(viewId).at(_voctreeDescType)._associated3dPoint;
+
+    const voctree::SparseHistogram histogram = _voctree->quantizeToSparse(regions.blindDescriptors());
+    for(const auto& wordIt : histogram)
+    {
+      for(const IndexT featureIndex : wordIt.second)
+        pointFeaturesPerView[i].push_back({associated3dPoints.at(featureIndex), viewId, &regions, featureIndex, wordIt.first});
+    }
+  }
+
+  std::size_t nbPointFeatures = 0;
+  for(std::size_t i = 0; i < viewIds.size(); ++i)
+  {
+    for(const PointFeature& pointFeature : pointFeaturesPerView[i])
+    {
+      _pointFeaturesPerWord[pointFeature.word].push_back(pointFeature);
+      _viewsPerLandmark[pointFeature.landmarkId].push_back(pointFeature.viewId);
+    }
+    nbPointFeatures += pointFeaturesPerView[i].size();
+    _pointFeaturesPerView[viewIds[i]] = std::move(pointFeaturesPerView[i]);
+  }
+
+  ALICEVISION_LOG_INFO("[prioritizedSearch]\tIndexed " << nbPointFeatures << " features of "
+                       << _viewsPerLandmark.size() << " 3D points in " << _pointFeaturesPerWord.size() << " visual words");
+}
+
+bool PrioritizedSearchLocalizer::localize(const feature::MapRegionsPerDesc & queryRegions,
+                                          const std::pair<std::size_t, std::size_t> &imageSize,
+                                          const LocalizerParameters *param,
+                                          std::mt19937 & randomNumberGenerator,
+                                          bool useInputIntrinsics,
+                                          camera::PinholeRadialK3 &queryIntrinsics,
+                                          LocalizationResult & localizationResult,
+                                          const std::string& imagePath)
+{
+  const Parameters *searchParam = dynamic_cast<const Parameters *>(param);
+  if(!searchParam)
+  {
+    throw std::invalid_argument("The parameters are not in the right format!!");
+  }
+
+  localizationResult = LocalizationResult();
+  if(queryRegions.count(_voctreeDescType) == 0)
+  {
+    ALICEVISION_LOG_WARNING("[prioritizedSearch]\tNo feature type " << feature::EImageDescriberType_enumToString(_voctreeDescType) << " in query region.");
+    return false;
+  }
+  const feature::Regions& regions = *queryRegions.at(_voctreeDescType);
+
+  system::Timer timer;
+  std::vector<IndMatch3D2D> associationIDs;
+  std::vector<voctree::DocMatch> matchedImages;
+  findCorrespondences(regions, *searchParam, associationIDs, matchedImages);
+  ALICEVISION_LOG_DEBUG("[prioritizedSearch]\tFound " << associationIDs.size() << " 2D-3D correspondences in " << timer.elapsedMs() << " [ms]");
+
+  sfm::ImageLocalizerMatchData resectionData;
+  resectionData.pt2D = Mat2X(2, associationIDs.size());
+  resectionData.pt3D = Mat3X(3, associationIDs.size());
+  resectionData.vec_descType.assign(associationIDs.size(), _voctreeDescType);
+  for(std::size_t i = 0; i < associationIDs.size(); ++i)
+  {
+    resectionData.pt2D.col(i) = regions.GetRegionPosition(associationIDs[i].featId);
+    resectionData.pt3D.col(i) = _sfm_data.getLandmarks().at(associationIDs[i].landmarkId).X;
+  }
+
+  return estimatePose(resectionData,
+                      associationIDs,
+                      matchedImages,
+                      imageSize,
+                      *searchParam,
+                      randomNumberGenerator,
+                      useInputIntrinsics,
+                      queryIntrinsics,
+                      localizationResult,
+                      imagePath);
+}
+
+void PrioritizedSearchLocalizer::findCorrespondences(const feature::Regions & queryRegions,
+                                                     const Parameters & param,
+                                                     std::vector<IndMatch3D2D> & out_associationIDs,
+                                                     std::vector<voctree::DocMatch> & out_matchedImages) const
+{
+  out_associationIDs.clear();
+  out_matchedImages.clear();
+
+  const voctree::SparseHistogram queryWords = _voctree->quantizeToSparse(queryRegions.blindDescriptors());
+  const uint32_t pointSearchLevel = std::min(param._pointSearchLevel, _voctree->levels() - 1);
+  const double squaredDistRatio = Square(param._fDistRatio);
+
+  // the query features by node of the 3D-2D search level
+  std::unordered_map<uint32_t, std::vector<IndexT>> queryFeaturesPerNode;
+  for(const auto& wordIt : queryWords)
+  {
+    std::vector<IndexT>& nodeFeatures = queryFeaturesPerNode[_voctree->getAncestorNode(wordIt.first, pointSearchLevel)];
+    nodeFeatures.insert(nodeFeatures.end(), wordIt.second.begin(), wordIt.second.end());
+  }
+
+  // a 2D-3D search of a query feature in the 3D points of its word,
+  // or a 3D-2D search of the feature of a 3D point in the query features of its node
+  struct Search
+  {
+    std::size_t cost;
+    std::size_t order;
+    IndexT queryFeature;
+    const std::vector<PointFeature>* pointCandidates;
+    const PointFeature* pointFeature;
+    const std::vector<IndexT>* queryCandidates;
+
+    bool operator>(const Search& other) const
+    {
+      return (cost != other.cost) ? (cost > other.cost) : (order > other.order);
+    }
+  };
+  // the searches with the fewest candidates first
+  std::priority_queue<Search, std::vector<Search>, std::greater<Search>> searches;
+  std::size_t nbSearches = 0;
+
+  for(const auto& wordIt : queryWords)
+  {
+    const auto candidatesIt = _pointFeaturesPerWord.find(wordIt.first);
+    if(candidatesIt == _pointFeaturesPerWord.end())
+      continue;
+    for(const IndexT queryFeature : wordIt.second)
+      searches.push({candidatesIt->second.size(), nbSearches++, queryFeature, &candidatesIt->second, nullptr, nullptr});
+  }
+
+  std::vector<IndexT> landmarkPerQueryFeature(queryRegions.RegionCount(), UndefinedIndexT);
+  std::unordered_set<IndexT> matchedLandmarks;
+  std::unordered_set<IndexT> activatedViews;
+
+  const auto addCorrespondence = [&](IndexT landmarkId, IndexT queryFeature)
+  {
+    landmarkPerQueryFeature[queryFeature] = landmarkId;
+    matchedLandmarks.insert(landmarkId);
+    out_associationIDs.emplace_back(landmarkId, _voctreeDescType, queryFeature);
+
+    // activate the 3D points of the database images seeing this 3D point
+    for(const IndexT viewId : _viewsPerLandmark.at(landmarkId))
+    {
+      if(!activatedViews.insert(viewId).second)
+        continue;
+      for(const PointFeature& pointFeature : _pointFeaturesPerView.at(viewId))
+      {
+        if(matchedLandmarks.count(pointFeature.landmarkId))
+          continue;
+        const auto candidatesIt = queryFeaturesPerNode.find(_voctree->getAncestorNode(pointFeature.word, pointSearchLevel));
+        if(candidatesIt == queryFeaturesPerNode.end())
+          continue;
+        searches.push({candidatesIt->second.size(), nbSearches++, UndefinedIndexT, nullptr, &pointFeature, &candidatesIt->second});
+      }
+    }
+  };
+
+  while(!searches.empty() && out_associationIDs.size() < param._nbCorrespondences)
+  {
+    const Search search = searches.top();
+    searches.pop();
+
+    // the two nearest candidates with the ratio test, the second one of another 3D point for the 2D-3D search
+    double bestDistance = std::numeric_limits<double>::infinity();
+    double secondDistance = std::numeric_limits<double>::infinity();
+
+    if(search.pointFeature == nullptr)
+    {
+      if(landmarkPerQueryFeature[search.queryFeature] != UndefinedIndexT)
+        continue;
+
+      IndexT bestLandmark = UndefinedIndexT;
+      for(const PointFeature& candidate : *search.pointCandidates)
+      {
+        const double distance = queryRegions.SquaredDescriptorDistance(search.queryFeature, candidate.regions, candidate.featureIndex);
+        if(candidate.landmarkId == bestLandmark)
+        {
+          bestDistance = std::min(bestDistance, distance);
+        }
+        else if(distance < bestDistance)
+        {
+          secondDistance = bestDistance;
+          bestDistance = distance;
+          bestLandmark = candidate.landmarkId;
+        }
+        else if(distance < secondDistance)
+        {
+          secondDistance = distance;
+        }
+      }
+
+      if(bestLandmark != UndefinedIndexT && bestDistance < squaredDistRatio * secondDistance && !matchedLandmarks.count(bestLandmark))
+        addCorrespondence(bestLandmark, search.queryFeature);
+    }
+    else
+    {
+      const PointFeature& pointFeature = *search.pointFeature;
+      if(matchedLandmarks.count(pointFeature.landmarkId))
+        continue;
+
+      IndexT bestFeature = UndefinedIndexT;
+      for(const IndexT candidate : *search.queryCandidates)
+      {
+        if(landmarkPerQueryFeature[candidate] != UndefinedIndexT)
+          continue;
+        const double distance = pointFeature.regions->SquaredDescriptorDistance(pointFeature.featureIndex, &queryRegions, candidate);
+        if(distance < bestDistance)
+        {
+          secondDistance = bestDistance;
+          bestDistance = distance;
+          bestFeature = candidate;
+        }
+        else if(distance < secondDistance)
+        {
+          secondDistance = distance;
+        }
+      }
+
+      if(bestFeature != UndefinedIndexT && bestDistance < squaredDistRatio * secondDistance)
+        addCorrespondence(pointFeature.landmarkId, bestFeature);
+    }
+  }
+
+  // the activated database images by number of correspondences they see
+  std::map<IndexT, std::size_t> nbCorrespondencesPerView;
+  for(const IndMatch3D2D& association : out_associationIDs)
+  {
+    for(const IndexT viewId : _viewsPerLandmark.at(association.landmarkId))
+      ++nbCorrespondencesPerView[viewId];
+  }
+  for(const auto& viewIt : nbCorrespondencesPerView)
+    out_matchedImages.emplace_back(viewIt.first, viewIt.second);
+  std::sort(out_matchedImages.begin(), out_matchedImages.end(), [](const voctree::DocMatch& a, const voctree::DocMatch& b)
+  {
+    return a.score > b.score;
+  });
+
+  ALICEVISION_LOG_DEBUG("[prioritizedSearch]\t" << nbSearches << " searches queued, " << activatedViews.size() << " database images activated");
+}
+
+} // namespace localization
+} // namespace aliceVision
@@ -0,0 +1,117 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/localization/VoctreeLocalizer.hpp>
+
+#include <unordered_map>
+#include <vector>
+
+namespace aliceVision {
+namespace localization {
+
+/**
+ * @brief Localize the query images by matching their features directly with the 3D points of the scene.
+ *
+ * The features of the 3D points in the database images are indexed by visual word. The query features
+ * are matched with the 3D points of their word (2D-3D search), from the features whose word has the
+ * fewest candidates. Each new correspondence activates the 3D points seen by the database images of
+ * its 3D point, which are matched with the query features of their coarse node of the vocabulary tree
+ * (3D-2D search). All the searches are done by increasing number of candidates, and they stop once
+ * enough correspondences are found, so no database image is matched entirely.
+ *
+ * Only the features of the vocabulary tree describer type are used. The scene data is loaded by the
+ * VoctreeLocalizer, the localize() calls are thread-safe.
+ */
+class PrioritizedSearchLocalizer : public VoctreeLocalizer
+{
+public:
+  struct Parameters : public VoctreeLocalizer::Parameters
+  {
+    Parameters()
+      : VoctreeLocalizer::Parameters()
+      , _nbCorrespondences(200)
+      , _pointSearchLevel(2)
+    {}
+
+    /// number of 2D-3D correspondences stopping the search
+    std::size_t _nbCorrespondences;
+    /// level of the vocabulary tree of the 3D-2D search, 0 for the children of the root
+    uint32_t _pointSearchLevel;
+  };
+
+  /**
+   * @brief Initialize a localizer with a prioritized search of 2D-3D correspondences.
+   * See the VoctreeLocalizer constructor for the parameters.
+   */
+  PrioritizedSearchLocalizer(const sfmData::SfMData &sfmData,
+                             const std::string &descriptorsFolder,
+                             const std::string &vocTreeFilepath,
+                             const std::string &weightsFilepath,
+                             const std::vector<feature::EImageDescriberType>& matchingDescTypes,
+                             const std::string &wordsCacheFolder = "",
+                             const std::string &databaseFile = "");
+
+  /**
+   * @brief Localize an image with the 2D-3D correspondences found by the prioritized search.
+   * @param[in] queryRegions The input features of the query image
+   * @param[in] imageSize The size of the input image
+   * @param[in] param The parameters for the localization, a PrioritizedSearchLocalizer::Parameters
+   * @param[in] randomNumberGenerator The random seed
+   * @param[in] useInputIntrinsics Uses the \p queryIntrinsics as known calibration.
+   * @param[in,out] queryIntrinsics Intrinsic parameters of the camera, they are used if the
+   * flag useInputIntrinsics is set to true, otherwise they are estimated from the correspondences.
+   * @param[out] localizationResult The localization result containing the pose and the associations.
+   * @param[in] imagePath Optional complete path to the image, used only for debugging purposes.
+   * @return true if the image has been successfully localized.
+   */
+  bool localize(const feature::MapRegionsPerDesc & queryRegions,
+                const std::pair<std::size_t, std::size_t> &imageSize,
+                const LocalizerParameters *param,
+                std::mt19937 & randomNumberGenerator,
+                bool useInputIntrinsics,
+                camera::PinholeRadialK3 &queryIntrinsics,
+                LocalizationResult & localizationResult,
+                const std::string& imagePath = std::string()) override;
+
+  using VoctreeLocalizer::localize;
+
+  /**
+   * @brief Find the 2D-3D correspondences of the query features with the prioritized search.
+   * @param[in] queryRegions The regions of the query image of the vocabulary tree describer type
+   * @param[in] param The parameters for the localization
+   * @param[out] out_associationIDs The (3D point, query feature) correspondences
+   * @param[out] out_matchedImages The database images whose 3D points have been activated,
+   * with their number of correspondences
+   */
+  void findCorrespondences(const feature::Regions & queryRegions,
+                           const Parameters & param,
+                           std::vector<IndMatch3D2D> & out_associationIDs,
+                           std::vector<voctree::DocMatch> & out_matchedImages) const;
+
+private:
+  /// a feature of a database image associated to a 3D point
+  struct PointFeature
+  {
+    IndexT landmarkId;
+    IndexT viewId;
+    /// the regions of the database image and the index of the feature in them
+    const feature::Regions* regions;
+    IndexT featureIndex;
+    voctree::Word word;
+  };
+
+  /// the features of the 3D points by visual word
+  std::unordered_map<voctree::Word, std::vector<PointFeature>> _pointFeaturesPerWord;
+  /// the features of the 3D points by database image
+  std::map<IndexT, std::vector<PointFeature>> _pointFeaturesPerView;
+  /// the database images seeing each 3D point
+  std::unordered_map<IndexT, std::vector<IndexT>> _viewsPerLandmark;
+};
+
+} // namespace localization
+} // namespace aliceVision
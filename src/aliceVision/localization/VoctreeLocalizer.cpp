@@ -25,11 +25,13 @@
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/ProgressDisplay.hpp>
 #include <aliceVision/system/Timer.hpp>
+#include <aliceVision/voctree/VisualWordsCache.hpp>
 
 #include <boost/filesystem.hpp>
 
 #include <algorithm>
 #include <chrono>
+#include <set>
 
 namespace aliceVision {
 namespace localization {
@@ -46,6 +48,8 @@ std::ostream& operator<<(std::ostream& os, VoctreeLocalizer::Algorithm a)
     break;
   case VoctreeLocalizer::Algorithm::Cluster: os << "Cluster";
     break;
+  case VoctreeLocalizer::Algorithm::Direct: os << "Direct";
+    break;
   default: 
     os << "Unknown algorithm!";
     throw std::invalid_argument("Unrecognized algorithm!");
@@ -102,6 +106,8 @@ VoctreeLocalizer::Algorithm VoctreeLocalizer::initFromString(const std::string &
     throw std::invalid_argument("BestResult not yet implemented");
   else if(value=="Cluster")
     throw std::invalid_argument("Cluster not yet implemented");
+  else if(value=="Direct")
+    return VoctreeLocalizer::Algorithm::Direct;
   else
     throw std::invalid_argument("Unrecognized algorithm \"" + value + "\"!");
 }
@@ -111,7 +117,9 @@ VoctreeLocalizer::VoctreeLocalizer(const sfmData::SfMData &sfmData,
                                    const std::string &descriptorsFolder,
                                    const std::string &vocTreeFilepath,
                                    const std::string &weightsFilepath,
-                                   const std::vector<feature::EImageDescriberType>& matchingDescTypes)
+                                   const std::vector<feature::EImageDescriberType>& matchingDescTypes,
+                                   const std::string &wordsCacheFolder,
+                                   const std::string &databaseFile)
   : ILocalizer()
   , _frameBuffer(5)
 {
@@ -131,7 +139,7 @@ VoctreeLocalizer::VoctreeLocalizer(const sfmData::SfMData &sfmData,
   // then we can store only those associated to 3D points
   //? can we use Feature_Provider to load the features and filter them later?
 
-  _isInit = initDatabase(vocTreeFilepath, weightsFilepath, descriptorsFolder);
+  _isInit = initDatabase(vocTreeFilepath, weightsFilepath, descriptorsFolder, wordsCacheFolder, databaseFile);
 }
 
 bool VoctreeLocalizer::localize(const feature::MapRegionsPerDesc & queryRegions,
@@ -172,6 +180,15 @@ bool VoctreeLocalizer::localize(const feature::MapRegionsPerDesc & queryRegions,
                               localizationResult,
                               imagePath);
     case Algorithm::Cluster: throw std::invalid_argument("Cluster not yet implemented");
+    case Algorithm::Direct:
+    return localizeDirect(queryRegions,
+                          imageSize,
+                          *voctreeParam,
+                          randomNumberGenerator,
+                          useInputIntrinsics,
+                          queryIntrinsics,
+                          localizationResult,
+                          imagePath);
     default: throw std::invalid_argument("Unknown algorithm type");
   }
 }
@@ -190,7 +207,10 @@ bool VoctreeLocalizer::localize(const image::Image<float>& imageGrey,
 
   image::Image<unsigned char> imageGrayUChar; // uchar image copy for uchar image describer
 
-  for(const auto& imageDescriber : _imageDescribers)
+  // the feature extractors are not shared with the concurrent queries
+  ImageDescribers imageDescribers = acquireImageDescribers();
+
+  for(const auto& imageDescriber : imageDescribers)
   {
     const auto descType = imageDescriber->getDescriberType();
     auto & queryRegions = queryRegionsPerDesc[descType];
@@ -216,6 +236,8 @@ bool VoctreeLocalizer::localize(const image::Image<float>& imageGrey,
     ALICEVISION_LOG_DEBUG("[features]\tExtract " << feature::EImageDescriberType_enumToString(descType) << " done: found " << queryRegions->RegionCount() << " features in " << timer.elapsedMs() << " [ms]");
   }
 
+  releaseImageDescribers(std::move(imageDescribers));
+
   const std::pair<std::size_t, std::size_t> queryImageSize = std::make_pair(imageGrey.Width(), imageGrey.Height());
 
   // if debugging is enable save the svg image with the extracted features
@@ -246,6 +268,31 @@ bool VoctreeLocalizer::localize(const image::Image<float>& imageGrey,
                   imagePath);
 }
 
+VoctreeLocalizer::ImageDescribers VoctreeLocalizer::acquireImageDescribers()
+{
+  {
+    std::lock_guard<std::mutex> lock(_imageDescribersMutex);
+    if(!_freeImageDescribers.empty())
+    {
+      ImageDescribers imageDescribers = std::move(_freeImageDescribers.back());
+      _freeImageDescribers.pop_back();
+      return imageDescribers;
+    }
+  }
+
+  ImageDescribers imageDescribers;
+  imageDescribers.reserve(_imageDescribers.size());
+  for(const auto& imageDescriber : _imageDescribers)
+    imageDescribers.push_back(feature::createImageDescriber(imageDescriber->getDescriberType()));
+  return imageDescribers;
+}
+
+void VoctreeLocalizer::releaseImageDescribers(ImageDescribers&& imageDescribers)
+{
+  std::lock_guard<std::mutex> lock(_imageDescribersMutex);
+  _freeImageDescribers.push_back(std::move(imageDescribers));
+}
+
 bool VoctreeLocalizer::loadReconstructionDescriptors(const sfmData::SfMData & sfm_data,
                                                      const std::string & feat_directory)
 {
@@ -260,7 +307,9 @@ bool VoctreeLocalizer::loadReconstructionDescriptors(const sfmData::SfMData & sf
  */
 bool VoctreeLocalizer::initDatabase(const std::string & vocTreeFilepath,
                                     const std::string & weightsFilepath,
-                                    const std::string & featFolder)
+                                    const std::string & featFolder,
+                                    const std::string & wordsCacheFolder,
+                                    const std::string & databaseFile)
 {
 
   bool withWeights = !weightsFilepath.empty();
@@ -273,6 +322,11 @@ bool VoctreeLocalizer::initDatabase(const std::string & vocTreeFilepath,
   ALICEVISION_LOG_DEBUG("tree loaded with " << _voctree->levels() << " levels and "
           << _voctree->splits() << " branching factors");
 
+  // the visual words of the scene descriptor files are reused across runs
+  std::unique_ptr<voctree::VisualWordsCache> wordsCache;
+  if(!wordsCacheFolder.empty())
+    wordsCache.reset(new voctree::VisualWordsCache(wordsCacheFolder, vocTreeFilepath));
+
   ALICEVISION_LOG_DEBUG("Creating the database...");
   // Add each object (document) to the database
   _database = voctree::Database(_voctree->words());
@@ -286,6 +340,37 @@ bool VoctreeLocalizer::initDatabase(const std::string & vocTreeFilepath,
     ALICEVISION_LOG_DEBUG("No weights specified, skipping...");
   }
 
+  // the documents of a saved database are reused if it was built with the same tree and weights
+  std::size_t databaseKey = voctree::computeFileHash(vocTreeFilepath);
+  if(withWeights)
+    boost::hash_combine(databaseKey, voctree::computeFileHash(weightsFilepath));
+
+  std::set<IndexT> storedViews;
+  if(!databaseFile.empty() && boost::filesystem::exists(databaseFile))
+  {
+    try
+    {
+      voctree::Database storedDatabase;
+      if(storedDatabase.load(databaseFile, databaseKey))
+      {
+        _database = std::move(storedDatabase);
+        for(const auto& document : _database.getSparseHistogramPerImage())
+          storedViews.insert(document.first);
+        ALICEVISION_LOG_INFO(storedViews.size() << " views loaded from the database file " << databaseFile);
+      }
+      else
+      {
+        ALICEVISION_LOG_WARNING("The database file " << databaseFile << " was built with another vocabulary tree or weights, it is rebuilt.");
+      }
+    }
+    catch(const std::exception& e)
+    {
+      ALICEVISION_LOG_WARNING(e.what());
+    }
+  }
+  std::set<IndexT> databaseViews;
+  std::size_t nbInsertedViews = 0;
+
   // Load the descriptors and the features related to the images
   // for every image, pass the descriptors through the vocabulary tree and
   // add its visual words to the database.
@@ -355,12 +440,40 @@ bool VoctreeLocalizer::initDatabase(const std::string & vocTreeFilepath,
       // Load from files
       std::unique_ptr<feature::Regions> currRegions = sfm::loadRegions(featuresFolders, id_view, *imageDescriber);
 
-      if(descType == _voctreeDescType)
+      if(descType == _voctreeDescType && storedViews.count(id_view))
+      {
+#pragma omp critical
+        {
+          databaseViews.insert(id_view);
+        }
+      }
+      else if(descType == _voctreeDescType)
       {
-        voctree::SparseHistogram histo = _voctree->quantizeToSparse(currRegions->blindDescriptors());
+        // the descriptor file of the regions, from the last folder containing it as sfm::loadRegions
+        std::string descriptorsPath;
+        if(wordsCache)
+        {
+          namespace bfs = boost::filesystem;
+          for(const std::string& folder : featuresFolders)
+          {
+            const bfs::path path = bfs::path(folder) / (std::to_string(id_view) + "." + feature::EImageDescriberType_enumToString(descType) + ".desc");
+            if(bfs::exists(path))
+              descriptorsPath = path.string();
+          }
+        }
+
+        voctree::SparseHistogram histo;
+        if(descriptorsPath.empty() || !wordsCache->load(descriptorsPath, 0, histo))
+        {
+          histo = _voctree->quantizeToSparse(currRegions->blindDescriptors());
+          if(!descriptorsPath.empty())
+            wordsCache->save(descriptorsPath, 0, histo);
+        }
 #pragma omp critical
         {
           _database.insert(id_view, histo);
+          databaseViews.insert(id_view);
+          ++nbInsertedViews;
         }
       }
 
@@ -375,6 +488,28 @@ bool VoctreeLocalizer::initDatabase(const std::string & vocTreeFilepath,
     }
     ++progressDisplay;
   }
+
+  if(wordsCache)
+    ALICEVISION_LOG_INFO("Visual words: " << wordsCache->getNbHits() << " views from the cache, "
+                         << wordsCache->getNbMisses() << " views quantized.");
+
+  // the stored views which are not reconstructed anymore
+  std::size_t nbRemovedViews = 0;
+  for(const IndexT viewId : storedViews)
+  {
+    if(databaseViews.count(viewId) == 0)
+    {
+      _database.remove(viewId);
+      ++nbRemovedViews;
+    }
+  }
+
+  if(!databaseFile.empty() && (nbInsertedViews > 0 || nbRemovedViews > 0 || storedViews.empty()))
+  {
+    ALICEVISION_LOG_INFO("Save the database file " << databaseFile << ": " << nbInsertedViews << " views added, "
+                         << nbRemovedViews << " views removed.");
+    _database.save(databaseFile, databaseKey);
+  }
   return true;
 }
 
@@ -412,8 +547,13 @@ bool VoctreeLocalizer::localizeFirstBestResult(const feature::MapRegionsPerDesc
 //            << " features with 3D points");
 //  }
 
-  ALICEVISION_LOG_DEBUG("[matching]\tBuilding the matcher");
-  matching::RegionsDatabaseMatcherPerDesc matchers(randomNumberGenerator, _matcherType, queryRegions);
+  // the query matchers are not needed when the matchers of the database images are reused
+  std::unique_ptr<matching::RegionsDatabaseMatcherPerDesc> matchers;
+  if(!param._reuseViewMatchers)
+  {
+    ALICEVISION_LOG_DEBUG("[matching]\tBuilding the matcher");
+    matchers.reset(new matching::RegionsDatabaseMatcherPerDesc(randomNumberGenerator, param._matcherType, queryRegions));
+  }
 
   sfm::ImageLocalizerMatchData resectionData;
   std::vector<IndMatch3D2D> associationIDs;
@@ -449,7 +589,10 @@ bool VoctreeLocalizer::localizeFirstBestResult(const feature::MapRegionsPerDesc
     const camera::Pinhole *matchedIntrinsics = (const camera::Pinhole*)(matchedIntrinsicsBase);
     
     matching::MatchesPerDescType featureMatches;
-    bool matchWorked = robustMatching(matchers,
+    matching::MatchesPerDescType putativeFeatureMatches;
+    bool matchWorked = getPutativeMatches(matchers.get(), queryRegions, matchedViewId, param, putativeFeatureMatches) &&
+                       robustMatching(queryRegions,
+                                      putativeFeatureMatches,
                                       // pass the input intrinsic if they are valid, null otherwise
                                       (useInputIntrinsics) ? &queryIntrinsics : nullptr,
                                       _regionsPerView.getRegionsPerDesc(matchedViewId),
@@ -643,6 +786,145 @@ bool VoctreeLocalizer::localizeAllResults(const feature::MapRegionsPerDesc &quer
   assert(resectionData.pt2D.cols() == numCollectedPts);
   assert(resectionData.pt3D.cols() == numCollectedPts);
 
+  if(!estimatePose(resectionData,
+                   associationIDs,
+                   matchedImages,
+                   queryImageSize,
+                   param,
+                   randomNumberGenerator,
+                   useInputIntrinsics,
+                   queryIntrinsics,
+                   localizationResult,
+                   imagePath))
+  {
+    return false;
+  }
+
+  if(param._nbFrameBufferMatching > 0)
+  {
+    // add everything to the buffer
+    auto frame = std::make_shared<const FrameData>(localizationResult, queryRegions);
+    std::lock_guard<std::mutex> lock(_frameBufferMutex);
+    _frameBuffer.emplace_back(std::move(frame));
+  }
+
+  return localizationResult.isValid();
+}
+
+bool VoctreeLocalizer::initLandmarksDescriptors(const std::string & sfmDataFilepath, std::size_t maxDescriptorsPerLandmark)
+{
+  _landmarksDescriptorsPerDesc.clear();
+
+  for(const auto& imageDescriber : _imageDescribers)
+  {
+    const feature::EImageDescriberType descType = imageDescriber->getDescriberType();
+    const std::string filepath = sfm::getLandmarksDescriptorsPath(sfmDataFilepath, descType);
+    const std::uint64_t key = sfm::computeLandmarksDescriptorsKey(_sfm_data, descType, maxDescriptorsPerLandmark);
+
+    auto landmarksDescriptors = std::make_shared<sfm::LandmarksDescriptors>();
+    if(landmarksDescriptors->load(filepath, key))
+    {
+      ALICEVISION_LOG_INFO("3D points descriptors of " << feature::EImageDescriberType_enumToString(descType)
+                           << " loaded from " << filepath);
+    }
+    else
+    {
+      // the regions of the database images only contain the features of the 3D points
+      const std::vector<sfm::LandmarksDescriptors::Observation> observations = sfm::getLandmarksObservations(_sfm_data, descType,
+        [&](IndexT viewId) -> const feature::Regions* {
+          const auto viewIt = _regionsPerView.getData().find(viewId);
+          if(viewIt == _regionsPerView.getData().end())
+            return nullptr;
+          const auto regionsIt = viewIt->second.find(descType);
+          return (regionsIt == viewIt->second.end()) ? nullptr : regionsIt->second.get();
+        },
+        [&](IndexT viewId, IndexT landmarkId, IndexT featureId) {
+          const ReconstructedRegionsMapping& mapping = _reconstructedRegionsMappingPerView.at(viewId).at(descType);
+          const auto featureIt = mapping._mapFullToLocal.find(featureId);
+          return (featureIt == mapping._mapFullToLocal.end()) ? UndefinedIndexT : featureIt->second;
+        });
+
+      if(!landmarksDescriptors->build(observations, maxDescriptorsPerLandmark, key))
+        continue;
+      landmarksDescriptors->save(filepath);
+    }
+    _landmarksDescriptorsPerDesc[descType] = std::move(landmarksDescriptors);
+  }
+  return !_landmarksDescriptorsPerDesc.empty();
+}
+
+bool VoctreeLocalizer::localizeDirect(const feature::MapRegionsPerDesc &queryRegions,
+                                      const std::pair<std::size_t, std::size_t> & queryImageSize,
+                                      const Parameters &param,
+                                      std::mt19937 & randomNumberGenerator,
+                                      bool useInputIntrinsics,
+                                      camera::PinholeRadialK3 &queryIntrinsics,
+                                      LocalizationResult &localizationResult,
+                                      const std::string& imagePath) const
+{
+  if(_landmarksDescriptorsPerDesc.empty())
+    throw std::logic_error("The descriptors of the 3D points are not initialized for the direct localization.");
+
+  // (query feature, landmark) matches for each describer type
+  matching::MatchesPerDescType matchesPerDesc;
+  std::size_t nbMatches = 0;
+  for(const auto& regionsPerDescIt : queryRegions)
+  {
+    const auto landmarksDescIt = _landmarksDescriptorsPerDesc.find(regionsPerDescIt.first);
+    if(landmarksDescIt == _landmarksDescriptorsPerDesc.end())
+      continue;
+    matching::IndMatches& matches = matchesPerDesc[regionsPerDescIt.first];
+    landmarksDescIt->second->match(*regionsPerDescIt.second, param._fDistRatio, matches);
+    nbMatches += matches.size();
+  }
+  ALICEVISION_LOG_DEBUG("[matching]\tFound " << nbMatches << " direct 2D-3D matches");
+
+  sfm::ImageLocalizerMatchData resectionData;
+  resectionData.pt2D = Mat(2, nbMatches);
+  resectionData.pt3D = Mat(3, nbMatches);
+  resectionData.vec_descType.reserve(nbMatches);
+  std::vector<IndMatch3D2D> associationIDs;
+  associationIDs.reserve(nbMatches);
+
+  for(const auto& matchesPerDescIt : matchesPerDesc)
+  {
+    const feature::EImageDescriberType descType = matchesPerDescIt.first;
+    const feature::Regions& regions = *queryRegions.at(descType);
+    for(const matching::IndMatch& match : matchesPerDescIt.second)
+    {
+      const std::size_t index = associationIDs.size();
+      resectionData.pt2D.col(index) = regions.GetRegionPosition(match._i);
+      resectionData.pt3D.col(index) = _sfm_data.getLandmarks().at(match._j).X;
+      resectionData.vec_descType.push_back(descType);
+      associationIDs.emplace_back(match._j, descType, match._i);
+    }
+  }
+
+  // no database image is matched
+  const std::vector<voctree::DocMatch> matchedImages;
+  return estimatePose(resectionData,
+                      associationIDs,
+                      matchedImages,
+                      queryImageSize,
+                      param,
+                      randomNumberGenerator,
+                      useInputIntrinsics,
+                      queryIntrinsics,
+                      localizationResult,
+                      imagePath);
+}
+
+bool VoctreeLocalizer::estimatePose(sfm::ImageLocalizerMatchData & resectionData,
+                                    const std::vector<IndMatch3D2D> & associationIDs,
+                                    const std::vector<voctree::DocMatch> & matchedImages,
+                                    const std::pair<std::size_t, std::size_t> & queryImageSize,
+                                    const LocalizerParameters & param,
+                                    std::mt19937 & randomNumberGenerator,
+                                    bool useInputIntrinsics,
+                                    camera::PinholeRadialK3 & queryIntrinsics,
+                                    LocalizationResult & localizationResult,
+                                    const std::string & imagePath) const
+{
   geometry::Pose3 pose;
   
   // estimate the pose
@@ -669,7 +951,7 @@ bool VoctreeLocalizer::localizeAllResults(const feature::MapRegionsPerDesc &quer
                                  param._visualDebug + "/" + bfs::path(imagePath).stem().string() + ".associations.svg");
     }
     localizationResult = LocalizationResult(resectionData, associationIDs, pose, queryIntrinsics, matchedImages, bResection);
-    return localizationResult.isValid();
+    return false;
   }
   ALICEVISION_LOG_DEBUG("[poseEstimation]\tResection SUCCEDED");
 
@@ -729,12 +1011,6 @@ bool VoctreeLocalizer::localizeAllResults(const feature::MapRegionsPerDesc &quer
                 << " max = " << std::sqrt(sqrErrors.maxCoeff()));
   }
 
-  if(param._nbFrameBufferMatching > 0)
-  {
-    // add everything to the buffer
-    _frameBuffer.emplace_back(localizationResult, queryRegions);
-  }
-
   return localizationResult.isValid();
 }
 
@@ -780,8 +1056,13 @@ void VoctreeLocalizer::getAllAssociations(const feature::MapRegionsPerDesc &quer
 //            << " features with 3D points");
 //  }
 
-  ALICEVISION_LOG_DEBUG("[matching]\tBuilding the matcher");
-  matching::RegionsDatabaseMatcherPerDesc matchers(randomNumberGenerator, _matcherType, queryRegions);
+  // the query matchers are not needed when the matchers of the database images are reused
+  std::unique_ptr<matching::RegionsDatabaseMatcherPerDesc> matchers;
+  if(!param._reuseViewMatchers)
+  {
+    ALICEVISION_LOG_DEBUG("[matching]\tBuilding the matcher");
+    matchers.reset(new matching::RegionsDatabaseMatcherPerDesc(randomNumberGenerator, param._matcherType, queryRegions));
+  }
 
   std::map< std::pair<IndexT, IndexT>, std::size_t > repeated;
   
@@ -823,7 +1104,10 @@ void VoctreeLocalizer::getAllAssociations(const feature::MapRegionsPerDesc &quer
     const camera::Pinhole *matchedIntrinsics = (const camera::Pinhole*)(matchedIntrinsicsBase);
 
     matching::MatchesPerDescType featureMatches;
-    const bool matchWorked = robustMatching(matchers,
+    matching::MatchesPerDescType putativeFeatureMatches;
+    const bool matchWorked = getPutativeMatches(matchers.get(), queryRegions, matchedViewId, param, putativeFeatureMatches) &&
+                             robustMatching(queryRegions,
+                                      putativeFeatureMatches,
                                       // pass the input intrinsic if they are valid, null otherwise
                                       (useInputIntrinsics) ? &queryIntrinsics : nullptr,
                                       matchedRegions,
@@ -926,7 +1210,10 @@ void VoctreeLocalizer::getAllAssociations(const feature::MapRegionsPerDesc &quer
   {
     ALICEVISION_LOG_DEBUG("[matching]\tUsing frameBuffer matching: matching with the past " 
             << param._nbFrameBufferMatching << " frames" );
-    getAssociationsFromBuffer(matchers, imageSize, param, useInputIntrinsics, queryIntrinsics, out_occurences, randomNumberGenerator);
+    // the past frames are matched with the query matchers
+    if(!matchers)
+      matchers.reset(new matching::RegionsDatabaseMatcherPerDesc(randomNumberGenerator, param._matcherType, queryRegions));
+    getAssociationsFromBuffer(*matchers, imageSize, param, useInputIntrinsics, queryIntrinsics, out_occurences, randomNumberGenerator);
   }
   
   const std::size_t numCollectedPts = out_occurences.size();
@@ -985,19 +1272,33 @@ void VoctreeLocalizer::getAssociationsFromBuffer(matching::RegionsDatabaseMatche
                                                  std::mt19937 & randomNumberGenerator,
                                                  const std::string& imagePath) const
 {
+  // the frames added by the concurrent queries are not matched
+  std::vector<std::shared_ptr<const FrameData>> frames;
+  {
+    std::lock_guard<std::mutex> lock(_frameBufferMutex);
+    frames.assign(_frameBuffer.begin(), _frameBuffer.end());
+  }
+
   std::size_t frameCounter = 0;
   // for all the past frames
-  for(const auto& frame : _frameBuffer)
+  for(const auto& frame : frames)
   {
     // gather the data
-    const auto &frameReconstructedRegions = frame._regionsWith3D;
-    const auto &frameRegions = frame._regions;
-    const auto &frameIntrinsics = frame._locResult.getIntrinsics();
+    const auto &frameReconstructedRegions = frame->_regionsWith3D;
+    const auto &frameRegions = frame->_regions;
+    const auto &frameIntrinsics = frame->_locResult.getIntrinsics();
     const auto frameImageSize = std::make_pair(frameIntrinsics.w(), frameIntrinsics.h());
     matching::MatchesPerDescType featureMatches;
     
     // match the query image with the current frame
-    bool matchWorked = robustMatching(matchers,
+    matching::MatchesPerDescType putativeFeatureMatches;
+    if(!matchers.Match(param._fDistRatio, frameRegions, putativeFeatureMatches))
+    {
+      ALICEVISION_LOG_DEBUG("[matching]\tPutative matching failed.");
+      continue;
+    }
+    bool matchWorked = robustMatching(matchers.getDatabaseRegionsPerDesc(),
+                                      putativeFeatureMatches,
                                       // pass the input intrinsic if they are valid, null otherwise
                                       (useInputIntrinsics) ? &queryIntrinsics : nullptr,
                                       frameRegions,
@@ -1050,7 +1351,61 @@ void VoctreeLocalizer::getAssociationsFromBuffer(matching::RegionsDatabaseMatche
   }
 }
 
-bool VoctreeLocalizer::robustMatching(matching::RegionsDatabaseMatcherPerDesc & matchers,
+bool VoctreeLocalizer::getPutativeMatches(matching::RegionsDatabaseMatcherPerDesc * queryMatchers,
+                                          const feature::MapRegionsPerDesc & queryRegions,
+                                          IndexT matchedViewId,
+                                          const Parameters & param,
+                                          matching::MatchesPerDescType & out_putativeFeatureMatches) const
+{
+  bool matchWorked = false;
+  if(queryMatchers != nullptr)
+  {
+    matchWorked = queryMatchers->Match(param._fDistRatio, _regionsPerView.getRegionsPerDesc(matchedViewId), out_putativeFeatureMatches);
+  }
+  else
+  {
+    matchWorked = getViewMatchers(matchedViewId, param._matcherType).Match(param._fDistRatio, queryRegions, out_putativeFeatureMatches);
+
+    // the matchers of the database image give the (database image, query) matches
+    for(auto& featureMatchesIt : out_putativeFeatureMatches)
+    {
+      for(matching::IndMatch& featureMatch : featureMatchesIt.second)
+        std::swap(featureMatch._i, featureMatch._j);
+    }
+  }
+
+  if(!matchWorked)
+  {
+    ALICEVISION_LOG_DEBUG("[matching]\tPutative matching failed.");
+    return false;
+  }
+  assert(!out_putativeFeatureMatches.empty());
+  return true;
+}
+
+matching::RegionsDatabaseMatcherPerDesc & VoctreeLocalizer::getViewMatchers(IndexT viewId, matching::EMatcherType matcherType) const
+{
+  ViewMatchers* viewMatchers = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(_matchersPerViewMutex);
+    std::unique_ptr<ViewMatchers>& entry = _matchersPerView[std::make_pair(viewId, matcherType)];
+    if(!entry)
+      entry.reset(new ViewMatchers);
+    viewMatchers = entry.get();
+  }
+
+  // the concurrent queries of the same image wait for the first one to build the matchers
+  std::call_once(viewMatchers->built, [&]()
+  {
+    // the random trees of the matchers do not depend on the order of the queries
+    std::mt19937 generator(viewId);
+    viewMatchers->matchers.reset(new matching::RegionsDatabaseMatcherPerDesc(generator, matcherType, _regionsPerView.getRegionsPerDesc(viewId)));
+  });
+  return *viewMatchers->matchers;
+}
+
+bool VoctreeLocalizer::robustMatching(const feature::MapRegionsPerDesc & queryRegions,
+                                      matching::MatchesPerDescType & putativeFeatureMatches,
                                       const camera::IntrinsicBase * queryIntrinsicsBase,   // the intrinsics of the image we are using as reference
                                       const feature::MapRegionsPerDesc & matchedRegions,
                                       const camera::IntrinsicBase * matchedIntrinsicsBase,
@@ -1085,13 +1440,6 @@ bool VoctreeLocalizer::robustMatching(matching::RegionsDatabaseMatcherPerDesc &
   const bool canBeUndistorted = (queryIntrinsicsBase != nullptr) && (matchedIntrinsicsBase != nullptr);
 
   // A. Putative Features Matching
-  matching::MatchesPerDescType putativeFeatureMatches;
-  const bool matchWorked = matchers.Match(fDistRatio, matchedRegions, putativeFeatureMatches);
-  if (!matchWorked)
-  {
-    ALICEVISION_LOG_DEBUG("[matching]\tPutative matching failed.");
-    return false;
-  }
   assert(!putativeFeatureMatches.empty());
   
   if(!useGeometricFiltering)
@@ -1106,7 +1454,7 @@ bool VoctreeLocalizer::robustMatching(matching::RegionsDatabaseMatcherPerDesc &
 
   matching::MatchesPerDescType geometricInliersPerType;
   EstimationStatus estimationState = geometricFilter.geometricEstimation(
-        matchers.getDatabaseRegionsPerDesc(),
+        queryRegions,
         matchedRegions,
         queryIntrinsics,
         matchedIntrinsics,
@@ -1144,7 +1492,7 @@ bool VoctreeLocalizer::robustMatching(matching::RegionsDatabaseMatcherPerDesc &
   matching::guidedMatching<robustEstimation::Mat3Model, multiview::relativePose::FundamentalEpipolarDistanceError>(
         model,
         queryIntrinsicsBase,                  // camera::IntrinsicBase of the matched image
-        matchers.getDatabaseRegionsPerDesc(), // feature::Regions
+        queryRegions,                         // feature::Regions
         matchedIntrinsicsBase,                // camera::IntrinsicBase of the query image
         matchedRegions,                       // feature::Regions
         Square(geometricFilter.m_dPrecision_robust),
@@ -10,6 +10,7 @@
 #include <aliceVision/feature/ImageDescriber.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/sfm/pipeline/localization/SfMLocalizer.hpp>
+#include <aliceVision/sfm/pipeline/localization/LandmarksDescriptors.hpp>
 #include <aliceVision/stl/mapUtils.hpp>
 #include <aliceVision/voctree/VocabularyTree.hpp>
 #include <aliceVision/voctree/Database.hpp>
@@ -22,6 +23,10 @@
 
 #include <flann/algorithms/dist.h>
 
+#include <map>
+#include <memory>
+#include <mutex>
+
 namespace aliceVision {
 namespace localization {
 
@@ -34,10 +39,19 @@ struct FrameData
   feature::MapRegionsPerDesc _regions;
 };
 
+/**
+ * @brief Localize the query images in a scene with a vocabulary tree.
+ *
+ * The scene data (the regions of the views, their 3D associations and the voctree database)
+ * is not modified once the localizer is initialized. The localize() calls are thread-safe:
+ * each query uses its own feature extractors and query matchers, so many queries can be localized
+ * concurrently with the same localizer. The matchers of the database images are built by the first
+ * query using them and shared by the next ones. The frame buffer is shared by the concurrent queries.
+ */
 class VoctreeLocalizer : public ILocalizer
 {
 public:
-  enum Algorithm : int {FirstBest=0, BestResult=1, AllResults=2, Cluster=3};
+  enum Algorithm : int {FirstBest=0, BestResult=1, AllResults=2, Cluster=3, Direct=4};
   static Algorithm initFromString(const std::string &value);
   
 public:
@@ -55,6 +69,8 @@ public:
       , _ccTagUseCuda(true)
       , _matchingError(std::numeric_limits<double>::infinity())
       , _nbFrameBufferMatching(10)
+      , _matcherType(matching::ANN_L2)
+      , _reuseViewMatchers(false)
     {}
     
     /// Enable/disable guided matching when matching images
@@ -75,6 +91,11 @@ public:
     double _matchingError;
     /// maximum capacity of the frame buffer
     std::size_t _nbFrameBufferMatching;
+    /// matcher used to match the query image with the database images
+    matching::EMatcherType _matcherType;
+    /// match the query regions with the matchers built once on the regions of each database image,
+    /// instead of building a matcher on the query regions for each query
+    bool _reuseViewMatchers;
   };
   
 public:
@@ -92,6 +113,11 @@ public:
    * when all the documents are added.
    * @param[in] matchingDescTypes List of descriptor types to use for feature matching.
    * @param[in] voctreeDescType Descriptor type used for image matching with voctree.
+   * @param[in] wordsCacheFolder Optional folder of the cache of the visual words of the
+   * scene descriptor files (see voctree::VisualWordsCache).
+   * @param[in] databaseFile Optional file of the voctree database of the scene. If it exists and was built
+   * with the same vocabulary tree and weights, only the views missing from it are quantized and the views
+   * not in the scene anymore are removed from it, then it is saved.
    *
    * It enable the use of combined SIFT and CCTAG features.
    */
@@ -99,7 +125,9 @@ public:
                    const std::string &descriptorsFolder,
                    const std::string &vocTreeFilepath,
                    const std::string &weightsFilepath,
-                   const std::vector<feature::EImageDescriberType>& matchingDescTypes
+                   const std::vector<feature::EImageDescriberType>& matchingDescTypes,
+                   const std::string &wordsCacheFolder = "",
+                   const std::string &databaseFile = ""
                   );
   
   void setCudaPipe( int i ) override
@@ -246,6 +274,41 @@ public:
                           camera::PinholeRadialK3 &queryIntrinsics,
                           LocalizationResult &localizationResult,
                           const std::string& imagePath = std::string());
+
+  /**
+   * @brief Load the descriptors of the 3D points saved next to the scene file, for the direct 2D-3D matching.
+   * If the file is missing or was saved for another scene, the descriptors are built from the regions
+   * of the database images and saved. The file is shared with the sfmLocalization software.
+   *
+   * @param[in] sfmDataFilepath The path to the scene file
+   * @param[in] maxDescriptorsPerLandmark The maximum number of observation descriptors kept by 3D point
+   * @return true if the descriptors of at least one describer type are available
+   */
+  bool initLandmarksDescriptors(const std::string & sfmDataFilepath, std::size_t maxDescriptorsPerLandmark = 3);
+
+  /**
+   * @brief Try to localize an image by matching its features directly with the descriptors of the 3D points,
+   * without querying the database images. initLandmarksDescriptors() must have been called.
+   *
+   * @param[in] queryRegions The input features of the query image
+   * @param[in] imageSize The size of the input image
+   * @param[in] param The parameters for the localization
+   * @param[in] randomNumberGenerator The random seed
+   * @param[in] useInputIntrinsics Uses the \p queryIntrinsics as known calibration
+   * @param[in,out] queryIntrinsics Intrinsic parameters of the camera, they are used if the
+   * flag useInputIntrinsics is set to true, otherwise they are estimated from the correspondences.
+   * @param[out] localizationResult The localization result containing the pose and the associations.
+   * @param[in] imagePath Optional complete path to the image, used only for debugging purposes.
+   * @return true if the localization is successful
+   */
+  bool localizeDirect(const feature::MapRegionsPerDesc & queryRegions,
+                      const std::pair<std::size_t, std::size_t> & imageSize,
+                      const Parameters &param,
+                      std::mt19937 & randomNumberGenerator,
+                      bool useInputIntrinsics,
+                      camera::PinholeRadialK3 &queryIntrinsics,
+                      LocalizationResult &localizationResult,
+                      const std::string& imagePath = std::string()) const;
   
   
   /**
@@ -277,6 +340,34 @@ public:
                           std::vector<voctree::DocMatch>& out_matchedImages,
                           const std::string& imagePath = std::string()) const;
 
+protected:
+  /**
+   * @brief Estimate the pose of the query camera from 2D-3D correspondences and refine it.
+   *
+   * @param[in,out] resectionData The 2D-3D correspondences, the inliers and the projection matrix are set
+   * @param[in] associationIDs The ids of the 2D-3D correspondences
+   * @param[in] matchedImages The database images the correspondences come from
+   * @param[in] queryImageSize The size of the query image
+   * @param[in] param The parameters for the localization
+   * @param[in] randomNumberGenerator The random seed
+   * @param[in] useInputIntrinsics Uses the \p queryIntrinsics as known calibration
+   * @param[in,out] queryIntrinsics Intrinsic parameters of the camera, estimated from the
+   * correspondences if \p useInputIntrinsics is false
+   * @param[out] localizationResult The localization result
+   * @param[in] imagePath Optional complete path to the image, used only for debugging purposes
+   * @return true if the pose is estimated and refined
+   */
+  bool estimatePose(sfm::ImageLocalizerMatchData & resectionData,
+                    const std::vector<IndMatch3D2D> & associationIDs,
+                    const std::vector<voctree::DocMatch> & matchedImages,
+                    const std::pair<std::size_t, std::size_t> & queryImageSize,
+                    const LocalizerParameters & param,
+                    std::mt19937 & randomNumberGenerator,
+                    bool useInputIntrinsics,
+                    camera::PinholeRadialK3 & queryIntrinsics,
+                    LocalizationResult & localizationResult,
+                    const std::string & imagePath = std::string()) const;
+
 private:
   /**
    * @brief Load the vocabulary tree.
@@ -288,16 +379,21 @@ private:
    * when all the documents are added.
    * @param[in] feat_directory The path to the directory containing the features 
    * of the scene (.desc and .feat files).
+   * @param[in] wordsCacheFolder Optional folder of the cache of the visual words.
+   * @param[in] databaseFile Optional file of the voctree database, updated with the scene views.
    * @return true if everything went ok
    */
   bool initDatabase(const std::string & vocTreeFilepath,
                     const std::string & weightsFilepath,
-                    const std::string & featFolder);
+                    const std::string & featFolder,
+                    const std::string & wordsCacheFolder = "",
+                    const std::string & databaseFile = "");
 
   /**
    * @brief robustMatching
    *
-   * @param[?] matchers
+   * @param[in] queryRegions
+   * @param[in,out] putativeFeatureMatches the (query, matched) putative matches, consumed
    * @param[in] queryIntrinsics
    * @param[in] regionsToMatch
    * @param[in] matchedIntrinsics
@@ -311,7 +407,8 @@ private:
    * @param[in] estimator
    * @return
    */
-  bool robustMatching(matching::RegionsDatabaseMatcherPerDesc & matchers,
+  bool robustMatching(const feature::MapRegionsPerDesc & queryRegions,
+                      matching::MatchesPerDescType & putativeFeatureMatches,
                       const camera::IntrinsicBase * queryIntrinsics,// the intrinsics of the image we are using as reference
                       const feature::MapRegionsPerDesc & regionsToMatch,
                       const camera::IntrinsicBase * matchedIntrinsics,
@@ -324,6 +421,28 @@ private:
                       std::mt19937 & randomNumberGenerator,
                       matching::MatchesPerDescType & out_featureMatches,
                       robustEstimation::ERobustEstimator estimator = robustEstimation::ERobustEstimator::ACRANSAC) const;
+
+  /**
+   * @brief Get the putative matches between the query image and a database image.
+   *
+   * @param[in] queryMatchers The matchers built on the query regions, null to use the matchers
+   * built once on the regions of the database image
+   * @param[in] queryRegions The regions of the query image
+   * @param[in] matchedViewId The view of the database image
+   * @param[in] param The parameters for the localization
+   * @param[out] out_putativeFeatureMatches The (query, database image) putative matches
+   * @return true if some putative matches are found
+   */
+  bool getPutativeMatches(matching::RegionsDatabaseMatcherPerDesc * queryMatchers,
+                          const feature::MapRegionsPerDesc & queryRegions,
+                          IndexT matchedViewId,
+                          const Parameters & param,
+                          matching::MatchesPerDescType & out_putativeFeatureMatches) const;
+
+  /**
+   * @brief Get the matchers built on the regions of a database image, built by the first call.
+   */
+  matching::RegionsDatabaseMatcherPerDesc & getViewMatchers(IndexT viewId, matching::EMatcherType matcherType) const;
   
   void getAssociationsFromBuffer(matching::RegionsDatabaseMatcherPerDesc& matchers,
                                  const std::pair<std::size_t, std::size_t> & imageSize,
@@ -341,6 +460,17 @@ private:
   bool loadReconstructionDescriptors(
     const sfmData::SfMData & sfm_data,
     const std::string & feat_directory);
+
+  using ImageDescribers = std::vector<std::unique_ptr<feature::ImageDescriber>>;
+
+  /**
+   * @brief Get feature extractors for a query, from the ones released by the previous queries
+   * or new ones when they are all in use.
+   */
+  ImageDescribers acquireImageDescribers();
+
+  /// Give back the feature extractors of a query for the next queries
+  void releaseImageDescribers(ImageDescribers&& imageDescribers);
   
   
 public:
@@ -352,6 +482,26 @@ public:
   
   /// the feature extractor
   std::vector<std::unique_ptr<feature::ImageDescriber>> _imageDescribers;
+
+private:
+  /// the feature extractors not used by a query, one set by concurrent query
+  std::vector<ImageDescribers> _freeImageDescribers;
+  std::mutex _imageDescribersMutex;
+
+  /// the matchers of a database image, built once
+  struct ViewMatchers
+  {
+    std::once_flag built;
+    std::unique_ptr<matching::RegionsDatabaseMatcherPerDesc> matchers;
+  };
+  /// the matchers by database image and matcher type
+  mutable std::map<std::pair<IndexT, matching::EMatcherType>, std::unique_ptr<ViewMatchers>> _matchersPerView;
+  mutable std::mutex _matchersPerViewMutex;
+
+  /// the descriptors of the 3D points by describer type, for the direct 2D-3D matching
+  std::map<feature::EImageDescriberType, std::shared_ptr<const sfm::LandmarksDescriptors>> _landmarksDescriptorsPerDesc;
+
+public:
   
   // CUDA CCTag supports several parallel pipelines, where each one can
   // processing different image dimensions.
@@ -366,10 +516,9 @@ public:
   /// the original dataset
   voctree::Database _database;
   
-  /// Last frames buffer
-  BoundedBuffer<FrameData> _frameBuffer;
-
-  matching::EMatcherType _matcherType = matching::ANN_L2;
+  /// Last frames buffer, the frames are shared with the queries reading them
+  BoundedBuffer<std::shared_ptr<const FrameData>> _frameBuffer;
+  mutable std::mutex _frameBufferMutex;
 };
 
 /**
@@ -77,19 +77,19 @@ EstimationStatus rigResection(const std::vector<Mat> &pts2d,
     numTotalPoints += numPts;
   }
   // transform the points into bearingVectors
-  opengv::bearingVectors_t bearingVectors;  // this contains the bearing vector associated to each image feature
-  opengv::points_t points;                  // this contains the 3d points
-  points.reserve(numTotalPoints);
-  std::vector<int> camCorrespondences;      // this is to keep track, for each bearing vector, whose camera it belongs
+  opengv::bearingVectors_t bearingVectors(numTotalPoints);  // this contains the bearing vector associated to each image feature
+  opengv::points_t points(numTotalPoints);                  // this contains the 3d points
+  std::vector<int> camCorrespondences(numTotalPoints);      // this is to keep track, for each bearing vector, whose camera it belongs
   
-  // this map is used to remap the indices of the flatten structure containing
+  // this vector is used to remap the indices of the flatten structure containing
   // the points (points, bearingvector) to the original local index of each pts2d/pts3d: 
   // eg 
   // localIdx = absoluteToLocal[absoluteID]; such that
   // pts3d[localIdx.first].col(localIdx.second) == points[absoluteID];
-  std::map<std::size_t, std::pair<std::size_t,std::size_t>> absoluteToLocal;   
-  
+  // the points are stored camera after camera, so a flat vector replaces the map
+  std::vector<std::pair<std::size_t,std::size_t>> absoluteToLocal(numTotalPoints);
   
+  std::size_t offset = 0;
   for(std::size_t cam = 0; cam < numCameras; ++cam)
   {
     const std::size_t numPts = pts2d[cam].cols();
@@ -97,30 +97,27 @@ EstimationStatus rigResection(const std::vector<Mat> &pts2d,
     
     for(std::size_t i = 0; i < numPts; ++i)
     {
+      const std::size_t absoluteID = offset + i;
+
       // store the 3D point
-      points.push_back(pts3d[cam].col(i));
+      points[absoluteID] = pts3d[cam].col(i);
       
       // we first remove the distortion and then we transform the undistorted point in
       // normalized camera coordinates (inv(K)*undistortedPoint)
-      auto pt = currCamera.ima2cam(currCamera.get_ud_pixel(pts2d[cam].col(i)));
-      
-      opengv::bearingVector_t bearing(pt(0), pt(1), 1.0);
+      const auto pt = currCamera.ima2cam(currCamera.get_ud_pixel(pts2d[cam].col(i)));
       
       // normalize the bearing-vector to 1
-      bearing = bearing / bearing.norm();
-
-      bearingVectors.push_back(bearing);
+      bearingVectors[absoluteID] = opengv::bearingVector_t(pt(0), pt(1), 1.0).normalized();
       
-      camCorrespondences.push_back(cam);
+      camCorrespondences[absoluteID] = cam;
       
       // fill the indices map
-      absoluteToLocal[points.size()-1] = std::make_pair(cam, i);
+      absoluteToLocal[absoluteID] = std::make_pair(cam, i);
     }
+    offset += numPts;
   }
 
-  assert(points.size() == numTotalPoints);
-  assert(bearingVectors.size() == numTotalPoints);
-  assert(camCorrespondences.size() == numTotalPoints);
+  assert(offset == numTotalPoints);
 
   using namespace opengv;
   //create a non-central absolute adapter
@@ -184,7 +181,7 @@ EstimationStatus rigResection(const std::vector<Mat> &pts2d,
   // remap the inliers
   for(std::size_t i = 0; i < numInliers; i++)
   {
-    const auto idx = absoluteToLocal.at(ransac.inliers_[i]);
+    const auto& idx = absoluteToLocal[ransac.inliers_[i]];
     inliers[idx.first].emplace_back(idx.second);
   }
 //  for(size_t i = 0; i < ransac.inliers_.size(); i++)
@@ -12,6 +12,7 @@
 
 #include <vector>
 #include <random>
+#include <type_traits>
 
 namespace aliceVision {
 namespace matching {
@@ -71,5 +72,12 @@ class ArrayMatcher
                                   size_t NN)=0;
 };
 
+/**
+ * @brief Traits telling if an ArrayMatcher provides a SearchNeighboursRatio method
+ *        that performs the 2-NN search and the distance ratio test in a single pass.
+ */
+template <class ArrayMatcherT>
+struct hasFusedRatioTest : std::false_type {};
+
 }  // namespace matching
 }  // namespace aliceVision
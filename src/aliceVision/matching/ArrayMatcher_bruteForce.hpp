@@ -10,6 +10,7 @@
 #include <aliceVision/numeric/numeric.hpp>
 #include <aliceVision/matching/ArrayMatcher.hpp>
 #include <aliceVision/feature/metric.hpp>
+#include <aliceVision/feature/metricSIMD.hpp>
 #include <aliceVision/stl/indexedSort.hpp>
 
 #include <aliceVision/config.hpp>
@@ -21,6 +22,82 @@
 namespace aliceVision {
 namespace matching {
 
+namespace detail {
+
+/// Compute the distances between a query and all the rows of a dataset with the given metric
+template <typename Scalar, typename Metric>
+void computeDistances(const Scalar* query, const Scalar* dataset, int nbRows, int dimension,
+                      typename Metric::ResultType* distances)
+{
+  Metric metric;
+  const Scalar* rowPtr = dataset;
+  for(int i = 0; i < nbRows; ++i)
+  {
+    distances[i] = metric(query, rowPtr, dimension);
+    rowPtr += dimension;
+  }
+}
+
+/**
+ * @brief Compute the distances between a query and all the rows of a dataset.
+ *        Specialized for the metrics that have a runtime-dispatched SIMD kernel
+ *        (results are bit-identical to the generic metric).
+ */
+template <typename Scalar, typename Metric>
+struct BruteForceDistances
+{
+  typedef typename Metric::ResultType DistanceType;
+
+  static void compute(const Scalar* query, const Scalar* dataset, int nbRows, int dimension, DistanceType* distances)
+  {
+    computeDistances<Scalar, Metric>(query, dataset, nbRows, dimension, distances);
+  }
+};
+
+template <>
+struct BruteForceDistances<unsigned char, feature::L2_Vectorized<unsigned char>>
+{
+  typedef feature::L2_Vectorized<unsigned char>::ResultType DistanceType;
+
+  static void compute(const unsigned char* query, const unsigned char* dataset, int nbRows, int dimension, DistanceType* distances)
+  {
+    // float accumulation of the generic metric is only exact up to maxL2UCharLength
+    if(static_cast<std::size_t>(dimension) > feature::simd::maxL2UCharLength)
+    {
+      computeDistances<unsigned char, feature::L2_Vectorized<unsigned char>>(query, dataset, nbRows, dimension, distances);
+      return;
+    }
+    feature::simd::squaredL2Distances(query, dataset, nbRows, dimension, distances);
+  }
+};
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_SSE)
+// same summation order as the SSE L2_Vectorized<float>
+template <>
+struct BruteForceDistances<float, feature::L2_Vectorized<float>>
+{
+  typedef feature::L2_Vectorized<float>::ResultType DistanceType;
+
+  static void compute(const float* query, const float* dataset, int nbRows, int dimension, DistanceType* distances)
+  {
+    feature::simd::squaredL2Distances(query, dataset, nbRows, dimension, distances);
+  }
+};
+#endif
+
+template <>
+struct BruteForceDistances<unsigned char, feature::Hamming<unsigned char>>
+{
+  typedef feature::Hamming<unsigned char>::ResultType DistanceType;
+
+  static void compute(const unsigned char* query, const unsigned char* dataset, int nbRows, int dimension, DistanceType* distances)
+  {
+    feature::simd::hammingDistances(query, dataset, nbRows, dimension, distances);
+  }
+};
+
+} // namespace detail
+
 // By default compute square(L2 distance).
 template < typename Scalar = float, typename Metric = feature::L2_Simple<Scalar> >
 class ArrayMatcher_bruteForce  : public ArrayMatcher<Scalar, Metric>
@@ -69,13 +146,10 @@ class ArrayMatcher_bruteForce  : public ArrayMatcher<Scalar, Metric>
 
       //matrix representation of the input data;
       Eigen::Map<BaseMat> mat_query((Scalar*)query, 1, (*memMapping).cols() );
-      Metric metric;
       std::vector<DistanceType> vec_dist((*memMapping).rows(), 0.0);
-    for (int i = 0; i < (*memMapping).rows(); ++i)
-    {
-        // Compute Distance Metric
-        vec_dist[i] = metric( (Scalar*)query, (*memMapping).row(i).data(), (*memMapping).cols() );
-      }
+      // Compute Distance Metric
+      detail::BruteForceDistances<Scalar, Metric>::compute(query, (*memMapping).data(),
+        (*memMapping).rows(), (*memMapping).cols(), vec_dist.data());
       if (!vec_dist.empty())
       {
         // Find the minimum distance :
@@ -119,7 +193,6 @@ class ArrayMatcher_bruteForce  : public ArrayMatcher<Scalar, Metric>
 
     //matrix representation of the input data;
     Eigen::Map<BaseMat> mat_query((Scalar*)query, nbQuery, (*memMapping).cols());
-    Metric metric;
 
     pvec_distances->resize(nbQuery * NN);
     pvec_indices->resize(nbQuery * NN);
@@ -129,13 +202,8 @@ class ArrayMatcher_bruteForce  : public ArrayMatcher<Scalar, Metric>
     {
       std::vector<DistanceType> vec_distance((*memMapping).rows(), 0.0);
       const Scalar * queryPtr = mat_query.row(queryIndex).data();
-      const Scalar * rowPtr = (*memMapping).data();
-      for (int i = 0; i < (*memMapping).rows(); ++i)
-      {
-        vec_distance[i] = metric( queryPtr,
-          rowPtr, (*memMapping).cols() );
-        rowPtr += (*memMapping).cols();
-      }
+      detail::BruteForceDistances<Scalar, Metric>::compute(queryPtr, (*memMapping).data(),
+        (*memMapping).rows(), (*memMapping).cols(), vec_distance.data());
 
       // Find the N minimum distances:
       const int maxMinFound = (int) std::min( size_t(NN), vec_distance.size());
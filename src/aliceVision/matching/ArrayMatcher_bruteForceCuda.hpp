@@ -0,0 +1,163 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/matching/ArrayMatcher.hpp>
+#include <aliceVision/matching/cuda/DeviceBruteForceMatcher.hpp>
+#include <aliceVision/feature/metric.hpp>
+
+#include <type_traits>
+#include <vector>
+
+namespace aliceVision {
+namespace matching {
+
+/**
+ * @brief Implement ArrayMatcher as a GPU brute-force matcher (squared L2 metric).
+ *        The dataset is kept in device memory, the 2-NN search and the distance ratio test
+ *        are done in a single pass on the GPU (see SearchNeighboursRatio).
+ * @note Only available if AliceVision is built with CUDA.
+ */
+template <typename Scalar = float>
+class ArrayMatcher_bruteForceCuda : public ArrayMatcher<Scalar, feature::L2_Simple<Scalar>>
+{
+  static_assert(std::is_same<Scalar, unsigned char>::value || std::is_same<Scalar, float>::value,
+                "GPU brute-force matcher only supports unsigned char and float descriptors");
+
+public:
+  typedef typename feature::L2_Simple<Scalar>::ResultType DistanceType;
+
+  ArrayMatcher_bruteForceCuda() = default;
+  virtual ~ArrayMatcher_bruteForceCuda() = default;
+
+  /**
+   * Build the matching structure (upload the dataset in device memory)
+   *
+   * \param[in] dataset   Input data.
+   * \param[in] nbRows    The number of component.
+   * \param[in] dimension Length of the data contained in the dataset.
+   *
+   * \return True if success.
+   */
+  bool Build(std::mt19937 & randomNumberGenerator, const Scalar * dataset, int nbRows, int dimension)
+  {
+    if(nbRows < 1)
+      return false;
+    _matcher.build(dataset, nbRows, dimension);
+    return true;
+  }
+
+  /**
+   * Search the nearest Neighbor of the scalar array query.
+   *
+   * \param[in]   query     The query array
+   * \param[out]  indice    The indice of array in the dataset that
+   *  have been computed as the nearest array.
+   * \param[out]  distance  The distance between the two arrays.
+   *
+   * \return True if success.
+   */
+  bool SearchNeighbour(const Scalar * query, int * indice, DistanceType * distance)
+  {
+    if(_matcher.nbRows() < 1)
+      return false;
+
+    std::vector<int> nnIndices;
+    std::vector<float> nnDistances;
+    std::vector<unsigned char> ratioOk;
+    _matcher.search(query, 1, 0.f, nnIndices, nnDistances, ratioOk);
+    *indice = nnIndices[0];
+    *distance = nnDistances[0];
+    return true;
+  }
+
+  /**
+   * Search the N nearest Neighbor of the scalar array query.
+   *
+   * \param[in]   query     The query array
+   * \param[in]   nbQuery   The number of query rows
+   * \param[out]  indices   The corresponding (query, neighbor) indices
+   * \param[out]  distances The distances between the matched arrays.
+   * \param[out]  NN        The number of maximal neighbor that will be searched (1 or 2).
+   *
+   * \return True if success.
+   */
+  bool SearchNeighbours(const Scalar * query, int nbQuery,
+                        IndMatches * pvec_indices,
+                        std::vector<DistanceType> * pvec_distances,
+                        size_t NN)
+  {
+    if(_matcher.nbRows() < 1 || nbQuery < 1 || NN < 1 || NN > 2 || NN > static_cast<size_t>(_matcher.nbRows()))
+      return false;
+
+    std::vector<int> nnIndices;
+    std::vector<float> nnDistances;
+    std::vector<unsigned char> ratioOk;
+    _matcher.search(query, nbQuery, 0.f, nnIndices, nnDistances, ratioOk);
+
+    pvec_indices->resize(nbQuery * NN);
+    pvec_distances->resize(nbQuery * NN);
+    for(int queryIndex = 0; queryIndex < nbQuery; ++queryIndex)
+    {
+      for(size_t i = 0; i < NN; ++i)
+      {
+        (*pvec_indices)[queryIndex * NN + i] = IndMatch(queryIndex, nnIndices[queryIndex * 2 + i]);
+        (*pvec_distances)[queryIndex * NN + i] = nnDistances[queryIndex * 2 + i];
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Search the 2 nearest Neighbors of the scalar array query and keep the
+   * queries that respect the distance ratio test.
+   *
+   * \param[in]   query          The query array
+   * \param[in]   nbQuery        The number of query rows
+   * \param[in]   ratio          The distance ratio threshold (on the metric distance)
+   * \param[out]  indices        The (query, nearest neighbor) indices of the kept queries
+   * \param[out]  distances      The distances to the nearest neighbor of the kept queries
+   * \param[out]  distanceRatios The ratio between the 2 nearest distance of the kept queries
+   *
+   * \return True if success.
+   */
+  bool SearchNeighboursRatio(const Scalar * query, int nbQuery, float ratio,
+                             IndMatches * indices,
+                             std::vector<DistanceType> * distances,
+                             std::vector<float> * distanceRatios)
+  {
+    if(_matcher.nbRows() < 2 || nbQuery < 1)
+      return false;
+
+    std::vector<int> nnIndices;
+    std::vector<float> nnDistances;
+    std::vector<unsigned char> ratioOk;
+    _matcher.search(query, nbQuery, ratio, nnIndices, nnDistances, ratioOk);
+
+    indices->clear();
+    distances->clear();
+    distanceRatios->clear();
+    for(int queryIndex = 0; queryIndex < nbQuery; ++queryIndex)
+    {
+      if(!ratioOk[queryIndex])
+        continue;
+      indices->emplace_back(queryIndex, nnIndices[queryIndex * 2]);
+      distances->push_back(nnDistances[queryIndex * 2]);
+      distanceRatios->push_back(nnDistances[queryIndex * 2] / nnDistances[queryIndex * 2 + 1]);
+    }
+    return true;
+  }
+
+private:
+  cuda::DeviceBruteForceMatcher _matcher;
+};
+
+template <typename Scalar>
+struct hasFusedRatioTest<ArrayMatcher_bruteForceCuda<Scalar>> : std::true_type {};
+
+}  // namespace matching
+}  // namespace aliceVision
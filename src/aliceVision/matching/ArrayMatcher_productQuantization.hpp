@@ -0,0 +1,380 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/feature/metric.hpp>
+#include <aliceVision/matching/ArrayMatcher.hpp>
+#include <aliceVision/matching/IndMatch.hpp>
+#include <aliceVision/numeric/numeric.hpp>
+
+#include <aliceVision/system/Logger.hpp>
+
+#include <Eigen/Eigenvalues>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace aliceVision {
+namespace matching {
+
+//------------------
+//-- Bibliography --
+//------------------
+//- [1] "Product Quantization for Nearest Neighbor Search"
+//- Authors: Herve Jegou, Matthijs Douze, Cordelia Schmid.
+//- Date: 2011.
+//- Journal: IEEE TPAMI.
+//
+
+/**
+ * @brief Parameters of the product quantization of the descriptors
+ */
+struct ProductQuantizationParams
+{
+  /// Dimension of the descriptors after the PCA reduction (no reduction if <= 0 or >= the descriptors dimension)
+  int reducedDimension = 64;
+  /// Number of sub-spaces, each one of them is encoded on one byte
+  int nbSubQuantizers = 16;
+  /// Number of k-means iterations to train the codebooks
+  int nbIterations = 10;
+  /// Maximum number of descriptors used to train the PCA and the codebooks (40 per centroid)
+  int maxTrainingSize = 40 * 256;
+};
+
+// Implementation of descriptor matching with the asymmetric distance computation of [1].
+// The database descriptors are reduced with a PCA and product quantized, only their codes are kept.
+// The queries are not quantized: a lookup table of the distances to the centroids of each sub-space
+// is computed for each query, and the distance to a database descriptor is the sum of its code entries.
+// The codebooks are trained on the database descriptors.
+// template Metric parameter is ignored (compute an approximation of the square(L2 distance)).
+template < typename Scalar = float, typename Metric = feature::L2_Simple<float> >
+class ArrayMatcher_productQuantization : public ArrayMatcher<Scalar, Metric>
+{
+  public:
+  typedef typename Metric::ResultType DistanceType;
+
+  /// Number of centroids of each sub-space codebook (one byte codes)
+  static const int maxNbCentroids = 256;
+
+  explicit ArrayMatcher_productQuantization(const ProductQuantizationParams& params = ProductQuantizationParams())
+    : _params(params)
+  {}
+
+  virtual ~ArrayMatcher_productQuantization() {}
+
+  /**
+   * Build the matching structure
+   *
+   * \param[in] dataset   Input data.
+   * \param[in] nbRows    The number of component.
+   * \param[in] dimension Length of the data contained in the dataset.
+   *
+   * \return True if success.
+   */
+  bool Build(std::mt19937 & randomNumberGenerator, const Scalar * dataset, int nbRows, int dimension)
+  {
+    _nbRows = 0;
+    _codes.clear();
+    if (nbRows < 1 || dimension < 1)
+      return false;
+
+    _dimension = dimension;
+    const Eigen::Map<const BaseMat> data(dataset, nbRows, dimension);
+
+    // training subset of the dataset
+    std::vector<int> trainingIndexes(nbRows);
+    std::iota(trainingIndexes.begin(), trainingIndexes.end(), 0);
+    if (nbRows > _params.maxTrainingSize)
+    {
+      std::shuffle(trainingIndexes.begin(), trainingIndexes.end(), randomNumberGenerator);
+      trainingIndexes.resize(_params.maxTrainingSize);
+    }
+
+    Eigen::MatrixXf training(trainingIndexes.size(), dimension);
+    for (std::size_t i = 0; i < trainingIndexes.size(); ++i)
+      training.row(i) = data.row(trainingIndexes[i]).template cast<float>();
+
+    buildProjection(training);
+    const Eigen::MatrixXf projectedTraining = project(training);
+
+    // split the reduced space in sub-spaces of (almost) equal dimensions
+    const int reducedDimension = _projection.rows();
+    const int nbSubQuantizers = std::max(1, std::min(_params.nbSubQuantizers, reducedDimension));
+    _subSpaceBegin.resize(nbSubQuantizers + 1);
+    for (int m = 0; m <= nbSubQuantizers; ++m)
+      _subSpaceBegin[m] = m * reducedDimension / nbSubQuantizers;
+
+    _nbCentroids = std::min<int>(maxNbCentroids, projectedTraining.rows());
+    _codebooks.resize(nbSubQuantizers);
+
+    std::vector<std::mt19937> generators;
+    for (int m = 0; m < nbSubQuantizers; ++m)
+      generators.emplace_back(randomNumberGenerator());
+
+    #pragma omp parallel for
+    for (int m = 0; m < nbSubQuantizers; ++m)
+    {
+      const RowMatrixXf subSpaceTraining = projectedTraining.middleCols(_subSpaceBegin[m], subSpaceDimension(m));
+      trainCodebook(generators[m], subSpaceTraining, _codebooks[m]);
+    }
+
+    // encode the whole dataset, by blocks to bound the memory of the projected descriptors
+    _nbRows = nbRows;
+    _codes.resize(std::size_t(nbRows) * nbSubQuantizers);
+    const int blockSize = 4096;
+    for (int blockBegin = 0; blockBegin < nbRows; blockBegin += blockSize)
+    {
+      const int blockRows = std::min(blockSize, nbRows - blockBegin);
+      const Eigen::MatrixXf projected = project(data.middleRows(blockBegin, blockRows).template cast<float>());
+
+      #pragma omp parallel for
+      for (int m = 0; m < nbSubQuantizers; ++m)
+      {
+        std::vector<int> nearest;
+        const RowMatrixXf subVectors = projected.middleCols(_subSpaceBegin[m], subSpaceDimension(m));
+        findNearestCentroids(subVectors, _codebooks[m], nearest);
+        for (int i = 0; i < blockRows; ++i)
+          _codes[std::size_t(blockBegin + i) * nbSubQuantizers + m] = static_cast<std::uint8_t>(nearest[i]);
+      }
+    }
+
+    ALICEVISION_LOG_TRACE("Product quantization: " << nbRows << " descriptors of dimension " << dimension
+                          << " encoded on " << nbSubQuantizers << " bytes (PCA dimension: " << reducedDimension << ").");
+    return true;
+  };
+
+  /**
+   * Search the nearest Neighbor of the scalar array query.
+   *
+   * \param[in]   query     The query array
+   * \param[out]  indice    The indice of array in the dataset that
+   *  have been computed as the nearest array.
+   * \param[out]  distance  The distance between the two arrays.
+   *
+   * \return True if success.
+   */
+  bool SearchNeighbour( const Scalar * query,
+                        int * indice, DistanceType * distance)
+  {
+    IndMatches indices;
+    std::vector<DistanceType> distances;
+    if (!SearchNeighbours(query, 1, &indices, &distances, 1))
+      return false;
+    *indice = indices.front()._j;
+    *distance = distances.front();
+    return true;
+  }
+
+/**
+   * Search the N nearest Neighbor of the scalar array query.
+   *
+   * \param[in]   query     The query array
+   * \param[in]   nbQuery   The number of query rows
+   * \param[out]  indices   The corresponding (query, neighbor) indices
+   * \param[out]  distances  The distances between the matched arrays.
+   * \param[out]  NN        The number of maximal neighbor that will be searched.
+   *
+   * \return True if success.
+   */
+  bool SearchNeighbours
+  (
+    const Scalar * query, int nbQuery,
+    IndMatches * pvec_indices,
+    std::vector<DistanceType> * pvec_distances,
+    size_t NN
+  )
+  {
+    if (_nbRows == 0)
+      return false;
+
+    if (NN > std::size_t(_nbRows) || nbQuery < 1)
+      return false;
+
+    const Eigen::Map<const BaseMat> queries(query, nbQuery, _dimension);
+    const int nbSubQuantizers = _codebooks.size();
+
+    pvec_distances->resize(nbQuery * NN);
+    pvec_indices->resize(nbQuery * NN);
+
+    #pragma omp parallel
+    {
+      // distance lookup table: nbSubQuantizers x nbCentroids
+      std::vector<float> table(std::size_t(nbSubQuantizers) * _nbCentroids);
+      std::vector<std::pair<float, int>> nearest;
+
+      #pragma omp for schedule(dynamic)
+      for (int queryIndex = 0; queryIndex < nbQuery; ++queryIndex)
+      {
+        const Eigen::RowVectorXf projected = project(queries.row(queryIndex).template cast<float>());
+        for (int m = 0; m < nbSubQuantizers; ++m)
+        {
+          Eigen::Map<Eigen::VectorXf>(&table[std::size_t(m) * _nbCentroids], _nbCentroids) =
+            (_codebooks[m].rowwise() - projected.segment(_subSpaceBegin[m], subSpaceDimension(m))).rowwise().squaredNorm();
+        }
+
+        // keep the NN smallest distances, sorted
+        nearest.assign(NN, std::make_pair(std::numeric_limits<float>::max(), -1));
+        const std::uint8_t * code = _codes.data();
+        for (int i = 0; i < _nbRows; ++i, code += nbSubQuantizers)
+        {
+          float distance = 0.f;
+          for (int m = 0; m < nbSubQuantizers; ++m)
+            distance += table[std::size_t(m) * _nbCentroids + code[m]];
+
+          if (distance < nearest.back().first)
+          {
+            std::size_t k = NN - 1;
+            for (; k > 0 && nearest[k - 1].first > distance; --k)
+              nearest[k] = nearest[k - 1];
+            nearest[k] = std::make_pair(distance, i);
+          }
+        }
+
+        for (std::size_t k = 0; k < NN; ++k)
+        {
+          (*pvec_distances)[queryIndex * NN + k] = static_cast<DistanceType>(nearest[k].first);
+          (*pvec_indices)[queryIndex * NN + k] = IndMatch(queryIndex, nearest[k].second);
+        }
+      }
+    }
+    return true;
+  };
+
+  /// Memory used by the encoded database, in bytes
+  std::size_t getCodesSize() const { return _codes.size(); }
+
+private:
+  typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> BaseMat;
+  typedef Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> RowMatrixXf;
+
+  int subSpaceDimension(int m) const { return _subSpaceBegin[m + 1] - _subSpaceBegin[m]; }
+
+  /// Compute the mean and the PCA projection of the training descriptors
+  void buildProjection(const Eigen::MatrixXf & training)
+  {
+    _mean = training.colwise().mean();
+
+    const int dimension = training.cols();
+    if (_params.reducedDimension <= 0 || _params.reducedDimension >= dimension || training.rows() < 2)
+    {
+      _projection = Eigen::MatrixXf::Identity(dimension, dimension);
+      return;
+    }
+
+    const Eigen::MatrixXf centered = training.rowwise() - _mean;
+    const Eigen::MatrixXf covariance = (centered.transpose() * centered) / float(training.rows() - 1);
+    const Eigen::SelfAdjointEigenSolver<Eigen::MatrixXf> solver(covariance);
+
+    // eigen values are sorted in increasing order, keep the last eigen vectors
+    _projection = solver.eigenvectors().rightCols(_params.reducedDimension).transpose();
+  }
+
+  /// Center and project descriptors (one per row) in the reduced space
+  template <typename Derived>
+  Eigen::MatrixXf project(const Eigen::MatrixBase<Derived> & descriptors) const
+  {
+    return (descriptors.rowwise() - _mean) * _projection.transpose();
+  }
+
+  /// Find the nearest centroid of each vector (one per row)
+  static void findNearestCentroids(const RowMatrixXf & vectors, const RowMatrixXf & codebook, std::vector<int> & nearest)
+  {
+    const int dimension = vectors.cols();
+    nearest.resize(vectors.rows());
+    for (int i = 0; i < vectors.rows(); ++i)
+    {
+      const float * x = vectors.row(i).data();
+      const float * centroid = codebook.data();
+      float bestDistance = std::numeric_limits<float>::max();
+      for (int c = 0; c < codebook.rows(); ++c, centroid += dimension)
+      {
+        float distance = 0.f;
+        for (int k = 0; k < dimension; ++k)
+          distance += Square(x[k] - centroid[k]);
+        if (distance < bestDistance)
+        {
+          bestDistance = distance;
+          nearest[i] = c;
+        }
+      }
+    }
+  }
+
+  /// Train the codebook of a sub-space with the k-means algorithm
+  void trainCodebook(std::mt19937 & randomNumberGenerator, const RowMatrixXf & training, RowMatrixXf & codebook) const
+  {
+    const int nbTraining = training.rows();
+    std::uniform_int_distribution<int> randomSample(0, nbTraining - 1);
+
+    // initialize the centroids with distinct training samples
+    std::vector<int> samples(nbTraining);
+    std::iota(samples.begin(), samples.end(), 0);
+    std::shuffle(samples.begin(), samples.end(), randomNumberGenerator);
+    codebook.resize(_nbCentroids, training.cols());
+    for (int c = 0; c < _nbCentroids; ++c)
+      codebook.row(c) = training.row(samples[c]);
+
+    std::vector<int> assignment(nbTraining, -1);
+    std::vector<int> nearest;
+    RowMatrixXf sums(_nbCentroids, training.cols());
+    std::vector<int> counts(_nbCentroids);
+
+    for (int iteration = 0; iteration < _params.nbIterations; ++iteration)
+    {
+      findNearestCentroids(training, codebook, nearest);
+      bool changed = false;
+      for (int i = 0; i < nbTraining; ++i)
+      {
+        if (assignment[i] != nearest[i])
+        {
+          assignment[i] = nearest[i];
+          changed = true;
+        }
+      }
+      if (!changed)
+        break;
+
+      sums.setZero();
+      std::fill(counts.begin(), counts.end(), 0);
+      for (int i = 0; i < nbTraining; ++i)
+      {
+        sums.row(assignment[i]) += training.row(i);
+        ++counts[assignment[i]];
+      }
+      for (int c = 0; c < _nbCentroids; ++c)
+      {
+        if (counts[c] > 0)
+          codebook.row(c) = sums.row(c) / float(counts[c]);
+        else
+          codebook.row(c) = training.row(randomSample(randomNumberGenerator)); // empty cluster
+      }
+    }
+  }
+
+  ProductQuantizationParams _params;
+
+  int _dimension = 0;
+  int _nbRows = 0;
+  int _nbCentroids = 0;
+
+  Eigen::RowVectorXf _mean;
+  /// PCA projection: reduced dimension x dimension
+  Eigen::MatrixXf _projection;
+  /// First dimension of each sub-space, and the end of the last one
+  std::vector<int> _subSpaceBegin;
+  /// Centroids of each sub-space: nbCentroids x sub-space dimension
+  std::vector<RowMatrixXf> _codebooks;
+  /// Codes of the dataset descriptors: nbRows x nbSubQuantizers
+  std::vector<std::uint8_t> _codes;
+};
+
+}  // namespace matching
+}  // namespace aliceVision
@@ -198,23 +198,46 @@ public:
       }
     }
     // Build the Buckets
+    BuildBuckets(hashed_descriptions);
+    return hashed_descriptions;
+  }
+
+  // Build the buckets of hashed descriptions from their bucket ids
+  // (e.g. for hashed descriptions loaded from disk).
+  void BuildBuckets(HashedDescriptions & hashed_descriptions) const
+  {
+    hashed_descriptions.buckets.clear();
+    hashed_descriptions.buckets.resize(nb_bucket_groups_);
+    for (int i = 0; i < nb_bucket_groups_; ++i)
     {
-      hashed_descriptions.buckets.resize(nb_bucket_groups_);
-      for (int i = 0; i < nb_bucket_groups_; ++i)
-      {
-        hashed_descriptions.buckets[i].resize(nb_buckets_per_group_);
+      hashed_descriptions.buckets[i].resize(nb_buckets_per_group_);
 
-        // Add the descriptor ID to the proper bucket group and id.
-        for (int j = 0; j < hashed_descriptions.hashed_desc.size(); ++j)
-        {
-          const uint16_t bucket_id = hashed_descriptions.hashed_desc[j].bucket_ids[i];
-          hashed_descriptions.buckets[i][bucket_id].push_back(j);
-        }
+      // Add the descriptor ID to the proper bucket group and id.
+      for (int j = 0; j < hashed_descriptions.hashed_desc.size(); ++j)
+      {
+        const uint16_t bucket_id = hashed_descriptions.hashed_desc[j].bucket_ids[i];
+        hashed_descriptions.buckets[i][bucket_id].push_back(j);
       }
     }
-    return hashed_descriptions;
   }
 
+  int getNbHashCode() const { return nb_hash_code_; }
+  int getNbBucketGroups() const { return nb_bucket_groups_; }
+  int getNbBitsPerBucket() const { return nb_bits_per_bucket_; }
+
+  /**
+   * @brief Preallocated containers used by Match_HashedDescriptions.
+   * They can be reused between successive calls (typically when matching several
+   * query images against the same database image) to avoid per-pair allocations.
+   */
+  struct MatchingBuffers
+  {
+    std::vector<int> candidate_descriptors;
+    Eigen::MatrixXi candidate_hamming_distances;
+    Eigen::VectorXi num_descriptors_with_hamming_distance;
+    std::vector<bool> used_descriptor;
+  };
+
   // Matches two collection of hashed descriptions with a fast matching scheme
   // based on the hash codes previously generated.
   template <typename MatrixT, typename DistanceType>
@@ -228,23 +251,52 @@ public:
     std::vector<DistanceType> * pvec_distances,
     const int NN = 2
   ) const
+  {
+    MatchingBuffers buffers;
+    Match_HashedDescriptions(hashed_descriptions1, descriptions1,
+                             hashed_descriptions2, descriptions2,
+                             buffers, pvec_indices, pvec_distances, NN);
+  }
+
+  // Matches two collection of hashed descriptions with a fast matching scheme
+  // based on the hash codes previously generated, using preallocated buffers.
+  template <typename MatrixT, typename DistanceType>
+  void Match_HashedDescriptions
+  (
+    const HashedDescriptions& hashed_descriptions1,
+    const MatrixT & descriptions1,
+    const HashedDescriptions& hashed_descriptions2,
+    const MatrixT & descriptions2,
+    MatchingBuffers & buffers,
+    IndMatches * pvec_indices,
+    std::vector<DistanceType> * pvec_distances,
+    const int NN = 2
+  ) const
   {
     typedef feature::L2_Vectorized<typename MatrixT::Scalar> MetricT;
     MetricT metric;
 
     static const int kNumTopCandidates = 10;
 
+    const int nbDescriptions2 = static_cast<int>(hashed_descriptions2.hashed_desc.size());
+
     // Preallocate the candidate descriptors container.
-    std::vector<int> candidate_descriptors;
-    candidate_descriptors.reserve(hashed_descriptions2.hashed_desc.size());
+    std::vector<int>& candidate_descriptors = buffers.candidate_descriptors;
+    candidate_descriptors.reserve(nbDescriptions2);
 
     // Preallocated hamming distances. Each column indicates the hamming distance
     // and the rows collect the descriptor ids with that
     // distance. num_descriptors_with_hamming_distance keeps track of how many
     // descriptors have that distance.
-    Eigen::MatrixXi candidate_hamming_distances(
-      hashed_descriptions2.hashed_desc.size(), nb_hash_code_ + 1);
-    Eigen::VectorXi num_descriptors_with_hamming_distance(nb_hash_code_ + 1);
+    // Buffers only grow, so that they can be reused for the next calls.
+    Eigen::MatrixXi& candidate_hamming_distances = buffers.candidate_hamming_distances;
+    if (candidate_hamming_distances.rows() < nbDescriptions2 ||
+        candidate_hamming_distances.cols() != nb_hash_code_ + 1)
+    {
+      candidate_hamming_distances.resize(nbDescriptions2, nb_hash_code_ + 1);
+    }
+    Eigen::VectorXi& num_descriptors_with_hamming_distance = buffers.num_descriptors_with_hamming_distance;
+    num_descriptors_with_hamming_distance.resize(nb_hash_code_ + 1);
 
     // Preallocate the container for keeping euclidean distances.
     std::vector<std::pair<DistanceType, int> > candidate_euclidean_distances;
@@ -252,7 +304,9 @@ public:
 
     // A preallocated vector to determine if we have already used a particular
     // feature for matching (i.e., prevents duplicates).
-    std::vector<bool> used_descriptor(hashed_descriptions2.hashed_desc.size());
+    std::vector<bool>& used_descriptor = buffers.used_descriptor;
+    if (used_descriptor.size() < hashed_descriptions2.hashed_desc.size())
+      used_descriptor.resize(hashed_descriptions2.hashed_desc.size());
 
     typedef feature::Hamming<stl::dynamic_bitset::BlockType> HammingMetricType;
     static const HammingMetricType metricH = {};
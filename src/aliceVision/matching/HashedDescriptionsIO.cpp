@@ -0,0 +1,191 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "HashedDescriptionsIO.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <cstring>
+#include <fstream>
+
+namespace fs = boost::filesystem;
+
+namespace aliceVision {
+namespace matching {
+
+namespace {
+
+struct HashedDescriptionsHeader
+{
+  static constexpr std::uint32_t currentVersion = 1;
+
+  char magic[8] = {'A', 'V', 'H', 'D', 'E', 'S', 'C', '\0'};
+  std::uint32_t version = currentVersion;
+  std::uint32_t nbBitsPerHashCode = 0;
+  std::uint64_t nbDescriptions = 0;
+  HashedDescriptionsCacheKey key;
+};
+
+struct ZeroMeanHeader
+{
+  static constexpr std::uint32_t currentVersion = 1;
+
+  char magic[8] = {'A', 'V', 'Z', 'M', 'E', 'A', 'N', '\0'};
+  std::uint32_t version = currentVersion;
+  std::uint32_t dimension = 0;
+};
+
+template <typename HeaderT>
+bool isValidHeader(const HeaderT& header)
+{
+  return std::memcmp(header.magic, HeaderT().magic, sizeof(header.magic)) == 0 &&
+         header.version == HeaderT::currentVersion;
+}
+
+/// write in a temporary file and rename it once complete
+template <typename WriteFunction>
+bool writeAtomically(const std::string& filepath, WriteFunction write)
+{
+  const std::string tmpFilepath = filepath + "." + fs::unique_path().string();
+  {
+    std::ofstream stream(tmpFilepath, std::ios::out | std::ios::binary);
+    if(!stream.is_open())
+    {
+      ALICEVISION_LOG_WARNING("Can't write cache file '" << filepath << "'.");
+      return false;
+    }
+    write(stream);
+    if(!stream.good())
+    {
+      stream.close();
+      fs::remove(tmpFilepath);
+      ALICEVISION_LOG_WARNING("Can't write cache file '" << filepath << "'.");
+      return false;
+    }
+  }
+
+  boost::system::error_code ec;
+  fs::rename(tmpFilepath, filepath, ec);
+  if(ec)
+  {
+    fs::remove(tmpFilepath, ec);
+    ALICEVISION_LOG_WARNING("Can't write cache file '" << filepath << "'.");
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+std::uint64_t computeDataHash(const void* data, std::size_t size)
+{
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  std::uint64_t hash = 14695981039346656037ULL;
+  for(std::size_t i = 0; i < size; ++i)
+  {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+bool saveHashedDescriptions(const std::string& filepath,
+                            const HashedDescriptionsCacheKey& key,
+                            const HashedDescriptions& hashedDescriptions)
+{
+  HashedDescriptionsHeader header;
+  header.key = key;
+  header.nbDescriptions = hashedDescriptions.hashed_desc.size();
+  header.nbBitsPerHashCode = hashedDescriptions.hashed_desc.empty() ? 0 : hashedDescriptions.hashed_desc.front().hash_code.size();
+
+  return writeAtomically(filepath, [&](std::ofstream& stream)
+  {
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for(const HashedDescription& hashedDescription : hashedDescriptions.hashed_desc)
+    {
+      stream.write(reinterpret_cast<const char*>(hashedDescription.hash_code.data()),
+                   hashedDescription.hash_code.num_blocks() * sizeof(stl::dynamic_bitset::BlockType));
+      stream.write(reinterpret_cast<const char*>(hashedDescription.bucket_ids.data()),
+                   hashedDescription.bucket_ids.size() * sizeof(std::uint16_t));
+    }
+  });
+}
+
+bool loadHashedDescriptions(const std::string& filepath,
+                            const HashedDescriptionsCacheKey& key,
+                            const CascadeHasher& cascadeHasher,
+                            HashedDescriptions& hashedDescriptions)
+{
+  std::ifstream stream(filepath, std::ios::in | std::ios::binary);
+  if(!stream.is_open())
+    return false;
+
+  HashedDescriptionsHeader header;
+  stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if(!stream || !isValidHeader(header) || !(header.key == key))
+    return false;
+
+  const std::size_t nbBucketGroups = key.nbBucketGroups;
+
+  HashedDescriptions loaded;
+  loaded.hashed_desc.resize(header.nbDescriptions);
+  for(HashedDescription& hashedDescription : loaded.hashed_desc)
+  {
+    hashedDescription.hash_code = stl::dynamic_bitset(header.nbBitsPerHashCode);
+    hashedDescription.bucket_ids.resize(nbBucketGroups);
+    stream.read(reinterpret_cast<char*>(hashedDescription.hash_code.data()),
+                hashedDescription.hash_code.num_blocks() * sizeof(stl::dynamic_bitset::BlockType));
+    stream.read(reinterpret_cast<char*>(hashedDescription.bucket_ids.data()),
+                nbBucketGroups * sizeof(std::uint16_t));
+  }
+
+  if(!stream)
+  {
+    ALICEVISION_LOG_WARNING("Invalid hashed descriptions cache file '" << filepath << "', it will be recomputed.");
+    return false;
+  }
+
+  cascadeHasher.BuildBuckets(loaded);
+  hashedDescriptions = std::move(loaded);
+  return true;
+}
+
+bool saveZeroMeanDescriptor(const std::string& filepath, const Eigen::VectorXf& zeroMeanDescriptor)
+{
+  ZeroMeanHeader header;
+  header.dimension = static_cast<std::uint32_t>(zeroMeanDescriptor.size());
+
+  return writeAtomically(filepath, [&](std::ofstream& stream)
+  {
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    stream.write(reinterpret_cast<const char*>(zeroMeanDescriptor.data()), zeroMeanDescriptor.size() * sizeof(float));
+  });
+}
+
+bool loadZeroMeanDescriptor(const std::string& filepath, std::size_t dimension, Eigen::VectorXf& zeroMeanDescriptor)
+{
+  std::ifstream stream(filepath, std::ios::in | std::ios::binary);
+  if(!stream.is_open())
+    return false;
+
+  ZeroMeanHeader header;
+  stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if(!stream || !isValidHeader(header) || header.dimension != dimension)
+    return false;
+
+  Eigen::VectorXf loaded(dimension);
+  stream.read(reinterpret_cast<char*>(loaded.data()), dimension * sizeof(float));
+  if(!stream)
+    return false;
+
+  zeroMeanDescriptor = std::move(loaded);
+  return true;
+}
+
+} // namespace matching
+} // namespace aliceVision
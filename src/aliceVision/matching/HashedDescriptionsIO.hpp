@@ -0,0 +1,93 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/matching/CascadeHasher.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace aliceVision {
+namespace matching {
+
+/**
+ * @brief Identify the inputs used to compute cached hashed descriptions.
+ *        A cached file is only reused if all the fields are identical.
+ */
+struct HashedDescriptionsCacheKey
+{
+  /// hash of the raw descriptors data of the view
+  std::uint64_t descriptorsHash = 0;
+  /// hash of the zero mean descriptor used to center the descriptors
+  std::uint64_t zeroMeanHash = 0;
+  /// seed used to generate the cascade hasher projections
+  std::uint32_t hasherSeed = 0;
+  /// cascade hasher layout
+  std::uint16_t nbHashCode = 0;
+  std::uint8_t nbBucketGroups = 0;
+  std::uint8_t nbBitsPerBucket = 0;
+
+  bool operator==(const HashedDescriptionsCacheKey& other) const
+  {
+    return descriptorsHash == other.descriptorsHash &&
+           zeroMeanHash == other.zeroMeanHash &&
+           hasherSeed == other.hasherSeed &&
+           nbHashCode == other.nbHashCode &&
+           nbBucketGroups == other.nbBucketGroups &&
+           nbBitsPerBucket == other.nbBitsPerBucket;
+  }
+};
+
+/**
+ * @brief Compute a stable 64-bit hash (FNV-1a) of a memory buffer.
+ */
+std::uint64_t computeDataHash(const void* data, std::size_t size);
+
+/**
+ * @brief Save hashed descriptions in a binary file.
+ *        The file is written in a temporary file and then renamed,
+ *        so that concurrent processes never read a partial file.
+ * @param[in] filepath The output file path
+ * @param[in] key The cache key of the hashed descriptions
+ * @param[in] hashedDescriptions The hashed descriptions (buckets are not saved)
+ * @return true if the file has been written
+ */
+bool saveHashedDescriptions(const std::string& filepath,
+                            const HashedDescriptionsCacheKey& key,
+                            const HashedDescriptions& hashedDescriptions);
+
+/**
+ * @brief Load hashed descriptions from a binary file if its key matches the expected one.
+ *        The buckets are rebuilt with the given cascade hasher.
+ * @param[in] filepath The input file path
+ * @param[in] key The expected cache key
+ * @param[in] cascadeHasher The cascade hasher used to rebuild the buckets
+ * @param[out] hashedDescriptions The loaded hashed descriptions
+ * @return false if the file does not exist, is invalid or outdated
+ */
+bool loadHashedDescriptions(const std::string& filepath,
+                            const HashedDescriptionsCacheKey& key,
+                            const CascadeHasher& cascadeHasher,
+                            HashedDescriptions& hashedDescriptions);
+
+/**
+ * @brief Save the zero mean descriptor used for hashing in a binary file (see saveHashedDescriptions).
+ */
+bool saveZeroMeanDescriptor(const std::string& filepath, const Eigen::VectorXf& zeroMeanDescriptor);
+
+/**
+ * @brief Load the zero mean descriptor used for hashing.
+ * @param[in] filepath The input file path
+ * @param[in] dimension The expected descriptor dimension
+ * @param[out] zeroMeanDescriptor The loaded zero mean descriptor
+ * @return false if the file does not exist or is invalid
+ */
+bool loadZeroMeanDescriptor(const std::string& filepath, std::size_t dimension, Eigen::VectorXf& zeroMeanDescriptor);
+
+} // namespace matching
+} // namespace aliceVision
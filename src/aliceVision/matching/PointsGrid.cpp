@@ -0,0 +1,157 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "PointsGrid.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace aliceVision {
+namespace matching {
+
+namespace {
+
+/// Maximal number of cells per side, the cells are enlarged beyond
+const int maxNbCellsPerSide = 4096;
+
+} // namespace
+
+PointsGrid::PointsGrid(const std::vector<Vec2>& points, double cellSize)
+  : _cellStart(1, 0)
+{
+  if(points.empty())
+    return;
+
+  Vec2 maxPoint = points.front();
+  _origin = points.front();
+  for(const Vec2& point : points)
+  {
+    _origin = _origin.cwiseMin(point);
+    maxPoint = maxPoint.cwiseMax(point);
+  }
+
+  const Vec2 extent = maxPoint - _origin;
+  _cellSize = std::max(cellSize, extent.maxCoeff() / maxNbCellsPerSide);
+  if(!(_cellSize > 0.0))
+    _cellSize = 1.0;
+
+  _nbCols = static_cast<int>(extent(0) / _cellSize) + 1;
+  _nbRows = static_cast<int>(extent(1) / _cellSize) + 1;
+
+  // sort the points by cell
+  std::vector<std::size_t> cellPerPoint(points.size());
+  _cellStart.assign(static_cast<std::size_t>(_nbCols) * _nbRows + 1, 0);
+  for(std::size_t i = 0; i < points.size(); ++i)
+  {
+    const int col = std::min(static_cast<int>((points[i](0) - _origin(0)) / _cellSize), _nbCols - 1);
+    const int row = std::min(static_cast<int>((points[i](1) - _origin(1)) / _cellSize), _nbRows - 1);
+    cellPerPoint[i] = static_cast<std::size_t>(row) * _nbCols + col;
+    ++_cellStart[cellPerPoint[i] + 1];
+  }
+  std::partial_sum(_cellStart.begin(), _cellStart.end(), _cellStart.begin());
+
+  std::vector<std::size_t> cellEnd(_cellStart.begin(), _cellStart.end() - 1);
+  _points.resize(points.size());
+  for(std::size_t i = 0; i < points.size(); ++i)
+    _points[cellEnd[cellPerPoint[i]]++] = static_cast<IndexT>(i);
+}
+
+double PointsGrid::getCellSize(const std::vector<Vec2>& points, double searchDistance)
+{
+  double cellSize = 2.0 * searchDistance;
+  if(!points.empty())
+  {
+    Vec2 minPoint = points.front();
+    Vec2 maxPoint = points.front();
+    for(const Vec2& point : points)
+    {
+      minPoint = minPoint.cwiseMin(point);
+      maxPoint = maxPoint.cwiseMax(point);
+    }
+    // about 4 points per cell
+    const Vec2 extent = maxPoint - minPoint;
+    cellSize = std::max(cellSize, std::sqrt(4.0 * extent(0) * extent(1) / points.size()));
+  }
+  return (cellSize > 0.0) ? cellSize : 1.0;
+}
+
+int PointsGrid::toCell(double value, double origin, int nbCells) const
+{
+  const double cell = std::floor((value - origin) / _cellSize);
+  return static_cast<int>(std::max(-1.0, std::min(cell, static_cast<double>(nbCells))));
+}
+
+void PointsGrid::addCellsPoints(int rowMin, int rowMax, int colMin, int colMax, std::vector<IndexT>& out_points) const
+{
+  rowMin = std::max(rowMin, 0);
+  rowMax = std::min(rowMax, _nbRows - 1);
+  colMin = std::max(colMin, 0);
+  colMax = std::min(colMax, _nbCols - 1);
+
+  for(int row = rowMin; row <= rowMax; ++row)
+  {
+    if(colMin > colMax)
+      break;
+    // the cells of a row are contiguous
+    const std::size_t first = _cellStart[static_cast<std::size_t>(row) * _nbCols + colMin];
+    const std::size_t last = _cellStart[static_cast<std::size_t>(row) * _nbCols + colMax + 1];
+    out_points.insert(out_points.end(), _points.begin() + first, _points.begin() + last);
+  }
+}
+
+void PointsGrid::getPointsInDisk(const Vec2& center, double radius, std::vector<IndexT>& out_points) const
+{
+  out_points.clear();
+  addCellsPoints(toCell(center(1) - radius, _origin(1), _nbRows), toCell(center(1) + radius, _origin(1), _nbRows),
+                 toCell(center(0) - radius, _origin(0), _nbCols), toCell(center(0) + radius, _origin(0), _nbCols),
+                 out_points);
+}
+
+void PointsGrid::getPointsNearLine(const Vec3& line, double halfWidth, std::vector<IndexT>& out_points) const
+{
+  out_points.clear();
+
+  const double a = line(0);
+  const double b = line(1);
+  const double c = line(2);
+  const double norm = std::hypot(a, b);
+  if(!(norm > 0.0))
+    return;
+
+  if(std::abs(b) >= std::abs(a))
+  {
+    // mostly horizontal line: the band rows in each column
+    const double halfHeight = halfWidth * norm / std::abs(b);
+    for(int col = 0; col < _nbCols; ++col)
+    {
+      const double x0 = _origin(0) + col * _cellSize;
+      const double y0 = -(a * x0 + c) / b;
+      const double y1 = -(a * (x0 + _cellSize) + c) / b;
+      addCellsPoints(toCell(std::min(y0, y1) - halfHeight, _origin(1), _nbRows),
+                     toCell(std::max(y0, y1) + halfHeight, _origin(1), _nbRows),
+                     col, col, out_points);
+    }
+  }
+  else
+  {
+    // mostly vertical line: the band columns in each row
+    const double halfLength = halfWidth * norm / std::abs(a);
+    for(int row = 0; row < _nbRows; ++row)
+    {
+      const double y0 = _origin(1) + row * _cellSize;
+      const double x0 = -(b * y0 + c) / a;
+      const double x1 = -(b * (y0 + _cellSize) + c) / a;
+      addCellsPoints(row, row,
+                     toCell(std::min(x0, x1) - halfLength, _origin(0), _nbCols),
+                     toCell(std::max(x0, x1) + halfLength, _origin(0), _nbCols),
+                     out_points);
+    }
+  }
+}
+
+} // namespace matching
+} // namespace aliceVision
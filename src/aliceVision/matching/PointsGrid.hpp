@@ -0,0 +1,77 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/numeric/numeric.hpp>
+#include <aliceVision/types.hpp>
+
+#include <vector>
+
+namespace aliceVision {
+namespace matching {
+
+/**
+ * @brief Grid of square cells over 2D points, to find the points close to a location or a line
+ *        without testing all of them.
+ *
+ * The queries return the points of the cells intersecting the searched area:
+ * a superset of the points in the area, to check with the exact distance.
+ */
+class PointsGrid
+{
+public:
+  /**
+   * @param[in] points The point positions
+   * @param[in] cellSize The size of the cells, in the unit of the positions
+   */
+  PointsGrid(const std::vector<Vec2>& points, double cellSize);
+
+  /**
+   * @brief Get the cell size for points distributed on an area, so that a search at the given
+   *        distance tests a few cells of a few points.
+   * @param[in] points The point positions
+   * @param[in] searchDistance The distance of the queries
+   */
+  static double getCellSize(const std::vector<Vec2>& points, double searchDistance);
+
+  /**
+   * @brief Get the points of the cells intersecting a disk
+   * @param[in] center The center of the disk
+   * @param[in] radius The radius of the disk
+   * @param[out] out_points The indices of the points
+   */
+  void getPointsInDisk(const Vec2& center, double radius, std::vector<IndexT>& out_points) const;
+
+  /**
+   * @brief Get the points of the cells intersecting a band around a line
+   * @param[in] line The line (a, b, c) of equation a*x + b*y + c = 0
+   * @param[in] halfWidth The distance to the line
+   * @param[out] out_points The indices of the points
+   */
+  void getPointsNearLine(const Vec3& line, double halfWidth, std::vector<IndexT>& out_points) const;
+
+  /// Get the number of points
+  std::size_t size() const { return _points.size(); }
+
+private:
+  /// Get the cell coordinate of a position coordinate, clamped in [-1, nbCells]
+  int toCell(double value, double origin, int nbCells) const;
+
+  /// Add the points of the cells in [rowMin, rowMax] x [colMin, colMax], clamped to the grid
+  void addCellsPoints(int rowMin, int rowMax, int colMin, int colMax, std::vector<IndexT>& out_points) const;
+
+  Vec2 _origin = Vec2::Zero();
+  double _cellSize = 1.0;
+  int _nbCols = 0;
+  int _nbRows = 0;
+  /// points of the cell c in _points[_cellStart[c], _cellStart[c+1]), cells by rows
+  std::vector<std::size_t> _cellStart;
+  std::vector<IndexT> _points;
+};
+
+} // namespace matching
+} // namespace aliceVision
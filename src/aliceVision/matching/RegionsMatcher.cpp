@@ -10,8 +10,15 @@
 #include "aliceVision/matching/ArrayMatcher_bruteForce.hpp"
 #include "aliceVision/matching/ArrayMatcher_kdtreeFlann.hpp"
 #include "aliceVision/matching/ArrayMatcher_cascadeHashing.hpp"
+#include "aliceVision/matching/ArrayMatcher_productQuantization.hpp"
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+#include "aliceVision/matching/ArrayMatcher_bruteForceCuda.hpp"
+#endif
 
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/config.hpp>
+
+#include <stdexcept>
 
 namespace aliceVision {
 namespace matching {
@@ -68,6 +75,11 @@ std::unique_ptr<IRegionsMatcher> createRegionsMatcher(std::mt19937 & randomNumbe
   if (regions.IsBinary() && matcherType != BRUTE_FORCE_HAMMING)
     return out;
 
+#if !ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+  if (matcherType == GPU_BRUTE_FORCE_L2)
+    throw std::runtime_error("Matcher type " + EMatcherType_enumToString(matcherType) + " requires AliceVision to be built with CUDA.");
+#endif
+
   // Switch regions type ID, matcher & Metric: initialize the Matcher interface
   if (regions.IsScalar())
   {
@@ -96,6 +108,20 @@ std::unique_ptr<IRegionsMatcher> createRegionsMatcher(std::mt19937 & randomNumbe
           out.reset(new matching::RegionsMatcher<MatcherT>(randomNumberGenerator, regions, true));
         }
         break;
+        case PRODUCT_QUANTIZATION_L2:
+        {
+          typedef ArrayMatcher_productQuantization<unsigned char> MatcherT;
+          out.reset(new matching::RegionsMatcher<MatcherT>(randomNumberGenerator, regions, true));
+        }
+        break;
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+        case GPU_BRUTE_FORCE_L2:
+        {
+          typedef ArrayMatcher_bruteForceCuda<unsigned char> MatcherT;
+          out.reset(new matching::RegionsMatcher<MatcherT>(randomNumberGenerator, regions, true));
+        }
+        break;
+#endif
         default:
           ALICEVISION_LOG_WARNING("Using unknown matcher type");
       }
@@ -125,6 +151,20 @@ std::unique_ptr<IRegionsMatcher> createRegionsMatcher(std::mt19937 & randomNumbe
           out.reset(new matching::RegionsMatcher<MatcherT>(randomNumberGenerator, regions, true));
         }
         break;
+        case PRODUCT_QUANTIZATION_L2:
+        {
+          typedef ArrayMatcher_productQuantization<float> MatcherT;
+          out.reset(new matching::RegionsMatcher<MatcherT>(randomNumberGenerator, regions, true));
+        }
+        break;
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+        case GPU_BRUTE_FORCE_L2:
+        {
+          typedef ArrayMatcher_bruteForceCuda<float> MatcherT;
+          out.reset(new matching::RegionsMatcher<MatcherT>(randomNumberGenerator, regions, true));
+        }
+        break;
+#endif
         default:
           ALICEVISION_LOG_WARNING("Using unknown matcher type");
       }
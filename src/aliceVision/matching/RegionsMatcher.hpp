@@ -8,6 +8,7 @@
 #pragma once
 
 #include "aliceVision/matching/matcherType.hpp"
+#include "aliceVision/matching/ArrayMatcher.hpp"
 #include "aliceVision/matching/IndMatch.hpp"
 #include "aliceVision/matching/IndMatchDecorator.hpp"
 #include "aliceVision/matching/filters.hpp"
@@ -18,6 +19,7 @@
 
 #include <vector>
 #include <random>
+#include <type_traits>
 
 namespace aliceVision {
 namespace matching {
@@ -139,18 +141,61 @@ public:
 
     const Scalar * queries = reinterpret_cast<const Scalar *>(queryregions_.DescriptorRawData());
 
-    const size_t NNN__ = 2;
     matching::IndMatches vec_nIndice;
     std::vector<DistanceType> vec_fDistance;
+    std::vector<float> vec_distanceRatio;
 
     // Search the 2 closest features neighbours for each query descriptor
-    if (!matcher_.SearchNeighbours(queries, queryregions_.RegionCount(), &vec_nIndice, &vec_fDistance, NNN__))
+    // and keep the ones that respect the distance ratio test
+    if (!searchRatioMatches(hasFusedRatioTest<ArrayMatcherT>(), queries, queryregions_.RegionCount(),
+                            b_squared_metric_ ? Square(f_dist_ratio) : f_dist_ratio,
+                            vec_nIndice, vec_fDistance, vec_distanceRatio))
+      return false;
+
+    vec_putative_matches.reserve(vec_nIndice.size());
+    for (size_t k=0; k < vec_nIndice.size(); ++k)
+    {
+      vec_putative_matches.emplace_back(vec_nIndice[k]._j, vec_nIndice[k]._i
+          , vec_distanceRatio[k]
+  #ifdef ALICEVISION_DEBUG_MATCHING
+          , (float) vec_fDistance[k]
+  #endif
+      );
+    }
+
+    // Remove duplicates
+    matching::IndMatch::getDeduplicated(vec_putative_matches);
+
+    // Remove matches that have the same (X,Y) coordinates
+    matching::IndMatchDecorator<float> matchDeduplicator(vec_putative_matches,
+      regions_.GetRegionsPositions(), queryregions_.GetRegionsPositions());
+    matchDeduplicator.getDeduplicated(vec_putative_matches);
+
+    return (!vec_putative_matches.empty());
+  }
+
+private:
+  /**
+   * @brief Generic 2-NN search followed by the distance ratio test.
+   * @param[out] matches The (query, database) indices of the queries that respect the ratio test
+   * @param[out] distances The corresponding nearest distances
+   * @param[out] distanceRatios The corresponding ratios between the 2 nearest distances
+   */
+  bool searchRatioMatches(std::false_type, const Scalar * queries, int nbQueries, float ratio,
+                          matching::IndMatches & matches,
+                          std::vector<DistanceType> & distances,
+                          std::vector<float> & distanceRatios)
+  {
+    const size_t NNN__ = 2;
+    matching::IndMatches vec_nIndice;
+    std::vector<DistanceType> vec_fDistance;
+
+    if (!matcher_.SearchNeighbours(queries, nbQueries, &vec_nIndice, &vec_fDistance, NNN__))
       return false;
 
     assert(vec_nIndice.size() == vec_fDistance.size());
 
     std::vector<int> vec_nn_ratio_idx;
-    std::vector<float> vec_distanceRatio;
     // Filter the matches using a distance ratio test:
     //   The probability that a match is correct is determined by taking
     //   the ratio of distance from the closest neighbor to the distance
@@ -160,32 +205,30 @@ public:
       vec_fDistance.end(),   // distance end
       NNN__, // Number of neighbor in iterator sequence (minimum required 2)
       vec_nn_ratio_idx, // output (indices that respect the distance Ratio)
-      b_squared_metric_ ? Square(f_dist_ratio) : f_dist_ratio,
-      &vec_distanceRatio);
+      ratio,
+      &distanceRatios);
 
-    vec_putative_matches.reserve(vec_nn_ratio_idx.size());
+    matches.reserve(vec_nn_ratio_idx.size());
+    distances.reserve(vec_nn_ratio_idx.size());
     for (size_t k=0; k < vec_nn_ratio_idx.size(); ++k)
     {
       const size_t index = vec_nn_ratio_idx[k] * NNN__;
-      vec_putative_matches.emplace_back(vec_nIndice[index]._j, vec_nIndice[index]._i
-          , vec_distanceRatio[k]
-  #ifdef ALICEVISION_DEBUG_MATCHING
-          , (float) vec_fDistance[index]
-  #endif
-      );
+      matches.push_back(vec_nIndice[index]);
+      distances.push_back(vec_fDistance[index]);
     }
-
-    // Remove duplicates
-    matching::IndMatch::getDeduplicated(vec_putative_matches);
-
-    // Remove matches that have the same (X,Y) coordinates
-    matching::IndMatchDecorator<float> matchDeduplicator(vec_putative_matches,
-      regions_.GetRegionsPositions(), queryregions_.GetRegionsPositions());
-    matchDeduplicator.getDeduplicated(vec_putative_matches);
-
-    return (!vec_putative_matches.empty());
+    return true;
   }
 
+  /**
+   * @brief 2-NN search and distance ratio test done in a single pass by the ArrayMatcher.
+   */
+  bool searchRatioMatches(std::true_type, const Scalar * queries, int nbQueries, float ratio,
+                          matching::IndMatches & matches,
+                          std::vector<DistanceType> & distances,
+                          std::vector<float> & distanceRatios)
+  {
+    return matcher_.SearchNeighboursRatio(queries, nbQueries, ratio, &matches, &distances, &distanceRatios);
+  }
 };
 
 
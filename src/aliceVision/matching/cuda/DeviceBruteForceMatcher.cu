@@ -0,0 +1,249 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "DeviceBruteForceMatcher.hpp"
+
+#include <cuda_runtime.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <stdexcept>
+#include <string>
+
+namespace aliceVision {
+namespace matching {
+namespace cuda {
+
+namespace {
+
+/// number of queries processed per block (one warp per query)
+constexpr int warpsPerBlock = 8;
+/// maximum number of dataset descriptors loaded in shared memory per tile
+constexpr int maxTileRows = 32;
+/// shared memory budget per block (bytes)
+constexpr int sharedMemoryBudget = 48 * 1024;
+
+void throwOnCudaError(cudaError_t err, const std::string& message)
+{
+  if(err != cudaSuccess)
+    throw std::runtime_error(message + ": " + cudaGetErrorString(err));
+}
+
+inline unsigned int divUp(unsigned int a, unsigned int b)
+{
+  return (a % b != 0) ? (a / b + 1) : (a / b);
+}
+
+/**
+ * @brief Brute-force 2-NN search with ratio test.
+ *        Each warp handles one query, the dataset is streamed through shared memory by tiles
+ *        shared by all the warps of the block.
+ */
+template <typename T>
+__global__ void bruteForce2NN_kernel(const T* dataset_d, int nbRows,
+                                     const T* queries_d, int nbQueries,
+                                     int dimension, int tileRows, float squaredRatio,
+                                     int2* nnIndices_d, float2* nnDistances_d, unsigned char* ratioOk_d)
+{
+  extern __shared__ float shared[];
+  float* tile = shared;                                    // tileRows * dimension
+  float* queries = shared + tileRows * dimension;          // warpsPerBlock * dimension
+
+  const int warpId = threadIdx.x / 32;
+  const int lane = threadIdx.x % 32;
+  const int queryIndex = blockIdx.x * warpsPerBlock + warpId;
+  const bool validQuery = (queryIndex < nbQueries);
+
+  float* query = queries + warpId * dimension;
+  if(validQuery)
+  {
+    for(int d = lane; d < dimension; d += 32)
+      query[d] = float(queries_d[size_t(queryIndex) * dimension + d]);
+  }
+
+  float bestDistance = FLT_MAX;
+  float secondDistance = FLT_MAX;
+  int bestIndex = -1;
+  int secondIndex = -1;
+
+  for(int tileStart = 0; tileStart < nbRows; tileStart += tileRows)
+  {
+    const int rowsInTile = min(tileRows, nbRows - tileStart);
+
+    __syncthreads();
+    const T* tile_d = dataset_d + size_t(tileStart) * dimension;
+    for(int k = threadIdx.x; k < rowsInTile * dimension; k += blockDim.x)
+      tile[k] = float(tile_d[k]);
+    __syncthreads();
+
+    if(!validQuery)
+      continue;
+
+    for(int r = 0; r < rowsInTile; ++r)
+    {
+      const float* row = tile + r * dimension;
+      float partial = 0.f;
+      for(int d = lane; d < dimension; d += 32)
+      {
+        const float diff = query[d] - row[d];
+        partial += diff * diff;
+      }
+      // all the lanes get the full sum
+      for(int offset = 16; offset > 0; offset /= 2)
+        partial += __shfl_xor_sync(0xffffffff, partial, offset);
+
+      if(partial < bestDistance)
+      {
+        secondDistance = bestDistance;
+        secondIndex = bestIndex;
+        bestDistance = partial;
+        bestIndex = tileStart + r;
+      }
+      else if(partial < secondDistance)
+      {
+        secondDistance = partial;
+        secondIndex = tileStart + r;
+      }
+    }
+  }
+
+  if(validQuery && lane == 0)
+  {
+    nnIndices_d[queryIndex] = make_int2(bestIndex, secondIndex);
+    nnDistances_d[queryIndex] = make_float2(bestDistance, secondDistance);
+    ratioOk_d[queryIndex] = (secondIndex >= 0 && bestDistance < squaredRatio * secondDistance) ? 1 : 0;
+  }
+}
+
+template <typename T>
+void launchBruteForce2NN(const void* dataset_d, int nbRows, const void* queries_d, int nbQueries, int dimension,
+                         float squaredRatio, int2* nnIndices_d, float2* nnDistances_d, unsigned char* ratioOk_d)
+{
+  const int queriesBytes = warpsPerBlock * dimension * int(sizeof(float));
+  const int rowBytes = dimension * int(sizeof(float));
+  const int tileRows = std::max(1, std::min(maxTileRows, (sharedMemoryBudget - queriesBytes) / rowBytes));
+  if(tileRows * rowBytes + queriesBytes > sharedMemoryBudget)
+    throw std::runtime_error("Descriptor dimension " + std::to_string(dimension) + " is too large for the GPU matcher.");
+
+  const dim3 block(warpsPerBlock * 32, 1, 1);
+  const dim3 grid(divUp(nbQueries, warpsPerBlock), 1, 1);
+  const size_t sharedBytes = size_t(tileRows * rowBytes + queriesBytes);
+
+  bruteForce2NN_kernel<T><<<grid, block, sharedBytes>>>(static_cast<const T*>(dataset_d), nbRows,
+                                                         static_cast<const T*>(queries_d), nbQueries,
+                                                         dimension, tileRows, squaredRatio,
+                                                         nnIndices_d, nnDistances_d, ratioOk_d);
+  throwOnCudaError(cudaGetLastError(), "GPU brute-force matching kernel failed");
+}
+
+} // namespace
+
+DeviceBruteForceMatcher::DeviceBruteForceMatcher() = default;
+
+DeviceBruteForceMatcher::~DeviceBruteForceMatcher()
+{
+  release();
+}
+
+void DeviceBruteForceMatcher::release()
+{
+  if(_dataset_d != nullptr)
+    cudaFree(_dataset_d);
+  _dataset_d = nullptr;
+  _nbRows = 0;
+  _dimension = 0;
+}
+
+void DeviceBruteForceMatcher::upload(const void* dataset, int nbRows, int dimension, bool isFloat)
+{
+  release();
+
+  const size_t bytes = size_t(nbRows) * dimension * (isFloat ? sizeof(float) : sizeof(unsigned char));
+  throwOnCudaError(cudaMalloc(&_dataset_d, bytes), "Cannot allocate the GPU matcher dataset");
+  throwOnCudaError(cudaMemcpy(_dataset_d, dataset, bytes, cudaMemcpyHostToDevice), "Cannot upload the GPU matcher dataset");
+
+  _nbRows = nbRows;
+  _dimension = dimension;
+  _isFloat = isFloat;
+}
+
+void DeviceBruteForceMatcher::build(const unsigned char* dataset, int nbRows, int dimension)
+{
+  upload(dataset, nbRows, dimension, false);
+}
+
+void DeviceBruteForceMatcher::build(const float* dataset, int nbRows, int dimension)
+{
+  upload(dataset, nbRows, dimension, true);
+}
+
+void DeviceBruteForceMatcher::search(const unsigned char* queries, int nbQueries, float squaredRatio,
+                                     std::vector<int>& nnIndices, std::vector<float>& nnDistances, std::vector<unsigned char>& ratioOk) const
+{
+  searchImpl(queries, nbQueries, squaredRatio, false, nnIndices, nnDistances, ratioOk);
+}
+
+void DeviceBruteForceMatcher::search(const float* queries, int nbQueries, float squaredRatio,
+                                     std::vector<int>& nnIndices, std::vector<float>& nnDistances, std::vector<unsigned char>& ratioOk) const
+{
+  searchImpl(queries, nbQueries, squaredRatio, true, nnIndices, nnDistances, ratioOk);
+}
+
+void DeviceBruteForceMatcher::searchImpl(const void* queries, int nbQueries, float squaredRatio, bool isFloat,
+                                         std::vector<int>& nnIndices, std::vector<float>& nnDistances, std::vector<unsigned char>& ratioOk) const
+{
+  if(isFloat != _isFloat)
+    throw std::runtime_error("GPU matcher: query and dataset descriptor types mismatch.");
+
+  nnIndices.assign(2 * size_t(nbQueries), -1);
+  nnDistances.assign(2 * size_t(nbQueries), FLT_MAX);
+  ratioOk.assign(size_t(nbQueries), 0);
+
+  if(_dataset_d == nullptr || nbQueries < 1)
+    return;
+
+  const size_t queriesBytes = size_t(nbQueries) * _dimension * (isFloat ? sizeof(float) : sizeof(unsigned char));
+
+  void* queries_d = nullptr;
+  int2* nnIndices_d = nullptr;
+  float2* nnDistances_d = nullptr;
+  unsigned char* ratioOk_d = nullptr;
+
+  try
+  {
+    throwOnCudaError(cudaMalloc(&queries_d, queriesBytes), "Cannot allocate the GPU matcher queries");
+    throwOnCudaError(cudaMalloc(&nnIndices_d, nbQueries * sizeof(int2)), "Cannot allocate the GPU matcher results");
+    throwOnCudaError(cudaMalloc(&nnDistances_d, nbQueries * sizeof(float2)), "Cannot allocate the GPU matcher results");
+    throwOnCudaError(cudaMalloc(&ratioOk_d, nbQueries * sizeof(unsigned char)), "Cannot allocate the GPU matcher results");
+    throwOnCudaError(cudaMemcpy(queries_d, queries, queriesBytes, cudaMemcpyHostToDevice), "Cannot upload the GPU matcher queries");
+
+    if(isFloat)
+      launchBruteForce2NN<float>(_dataset_d, _nbRows, queries_d, nbQueries, _dimension, squaredRatio, nnIndices_d, nnDistances_d, ratioOk_d);
+    else
+      launchBruteForce2NN<unsigned char>(_dataset_d, _nbRows, queries_d, nbQueries, _dimension, squaredRatio, nnIndices_d, nnDistances_d, ratioOk_d);
+
+    throwOnCudaError(cudaMemcpy(nnIndices.data(), nnIndices_d, nbQueries * sizeof(int2), cudaMemcpyDeviceToHost), "Cannot download the GPU matcher results");
+    throwOnCudaError(cudaMemcpy(nnDistances.data(), nnDistances_d, nbQueries * sizeof(float2), cudaMemcpyDeviceToHost), "Cannot download the GPU matcher results");
+    throwOnCudaError(cudaMemcpy(ratioOk.data(), ratioOk_d, nbQueries * sizeof(unsigned char), cudaMemcpyDeviceToHost), "Cannot download the GPU matcher results");
+  }
+  catch(...)
+  {
+    cudaFree(queries_d);
+    cudaFree(nnIndices_d);
+    cudaFree(nnDistances_d);
+    cudaFree(ratioOk_d);
+    throw;
+  }
+
+  cudaFree(queries_d);
+  cudaFree(nnIndices_d);
+  cudaFree(nnDistances_d);
+  cudaFree(ratioOk_d);
+}
+
+} // namespace cuda
+} // namespace matching
+} // namespace aliceVision
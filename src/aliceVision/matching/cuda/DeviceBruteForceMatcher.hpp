@@ -0,0 +1,76 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <vector>
+
+namespace aliceVision {
+namespace matching {
+namespace cuda {
+
+/**
+ * @brief Brute-force squared L2 2-NN search on the GPU.
+ *
+ * The dataset descriptors are uploaded once in device memory by build()
+ * and kept there for all the subsequent searches.
+ * The search computes the 2 nearest neighbours and the Lowe ratio test in a single kernel pass.
+ *
+ * @note This class does not depend on the CUDA headers, so it can be used from host code.
+ * @note search() can be called concurrently, build() cannot.
+ */
+class DeviceBruteForceMatcher
+{
+public:
+  DeviceBruteForceMatcher();
+  ~DeviceBruteForceMatcher();
+
+  DeviceBruteForceMatcher(const DeviceBruteForceMatcher&) = delete;
+  DeviceBruteForceMatcher& operator=(const DeviceBruteForceMatcher&) = delete;
+
+  /**
+   * @brief Upload the dataset descriptors in device memory.
+   * @param[in] dataset The row-major descriptors
+   * @param[in] nbRows The number of descriptors
+   * @param[in] dimension The descriptor length
+   * @throw std::runtime_error on CUDA error
+   */
+  void build(const unsigned char* dataset, int nbRows, int dimension);
+  void build(const float* dataset, int nbRows, int dimension);
+
+  int nbRows() const { return _nbRows; }
+  int dimension() const { return _dimension; }
+
+  /**
+   * @brief Search the 2 nearest neighbours of each query and apply the distance ratio test.
+   * @param[in] queries The row-major query descriptors (same type and dimension as the dataset)
+   * @param[in] nbQueries The number of queries
+   * @param[in] squaredRatio The ratio test threshold on squared distances (a match is kept if d1 < ratio * d2)
+   * @param[out] nnIndices The 2 nearest dataset indices per query (-1 if not enough dataset descriptors)
+   * @param[out] nnDistances The 2 nearest squared distances per query
+   * @param[out] ratioOk For each query, 1 if the best neighbour respects the ratio test, 0 otherwise
+   * @throw std::runtime_error on CUDA error or type mismatch
+   */
+  void search(const unsigned char* queries, int nbQueries, float squaredRatio,
+              std::vector<int>& nnIndices, std::vector<float>& nnDistances, std::vector<unsigned char>& ratioOk) const;
+  void search(const float* queries, int nbQueries, float squaredRatio,
+              std::vector<int>& nnIndices, std::vector<float>& nnDistances, std::vector<unsigned char>& ratioOk) const;
+
+private:
+  void release();
+  void upload(const void* dataset, int nbRows, int dimension, bool isFloat);
+  void searchImpl(const void* queries, int nbQueries, float squaredRatio, bool isFloat,
+                  std::vector<int>& nnIndices, std::vector<float>& nnDistances, std::vector<unsigned char>& ratioOk) const;
+
+  void* _dataset_d = nullptr;
+  int _nbRows = 0;
+  int _dimension = 0;
+  bool _isFloat = false;
+};
+
+} // namespace cuda
+} // namespace matching
+} // namespace aliceVision
@@ -9,15 +9,76 @@
 
 #include <aliceVision/numeric/numeric.hpp>
 #include <aliceVision/matching/IndMatch.hpp>
+#include <aliceVision/matching/PointsGrid.hpp>
 #include <aliceVision/feature/RegionsPerView.hpp>
 #include <aliceVision/feature/Regions.hpp>
 #include <aliceVision/camera/IntrinsicBase.hpp>
 
+#include <cmath>
+#include <numeric>
 #include <vector>
 
 namespace aliceVision {
 namespace matching {
 
+namespace detail {
+
+/**
+ * @brief Get the right points which may be under the error threshold of a left point:
+ *        the points near the transfer line of the left point, for the errors providing a transferLine().
+ */
+template<typename ErrorT, typename ModelT>
+auto getCandidates(const ErrorT& errorEstimator, const ModelT& mod, const Vec2& xLeft, double errorTh,
+                   const PointsGrid& rightGrid, std::vector<IndexT>& out_candidates, int)
+  -> decltype(errorEstimator.transferLine(mod, xLeft), void())
+{
+  rightGrid.getPointsNearLine(errorEstimator.transferLine(mod, xLeft), std::sqrt(errorTh), out_candidates);
+}
+
+/**
+ * @brief Get the right points which may be under the error threshold of a left point:
+ *        the points near the transfer point of the left point, for the errors providing a transferPoint().
+ */
+template<typename ErrorT, typename ModelT>
+auto getCandidates(const ErrorT& errorEstimator, const ModelT& mod, const Vec2& xLeft, double errorTh,
+                   const PointsGrid& rightGrid, std::vector<IndexT>& out_candidates, int)
+  -> decltype(errorEstimator.transferPoint(mod, xLeft), void())
+{
+  rightGrid.getPointsInDisk(errorEstimator.transferPoint(mod, xLeft), std::sqrt(errorTh), out_candidates);
+}
+
+/**
+ * @brief Get the right points which may be under the error threshold of a left point:
+ *        all of them for the other errors.
+ */
+template<typename ErrorT, typename ModelT>
+void getCandidates(const ErrorT& errorEstimator, const ModelT& mod, const Vec2& xLeft, double errorTh,
+                   const PointsGrid& rightGrid, std::vector<IndexT>& out_candidates, long)
+{
+  out_candidates.resize(rightGrid.size());
+  std::iota(out_candidates.begin(), out_candidates.end(), 0);
+}
+
+} // namespace detail
+
+/**
+ * @brief Get the right points which may be under the error threshold of a left point,
+ *        from a grid of the right points when the error gives the area of the valid points.
+ *
+ * @param[in] errorEstimator The metric to compute distance to the model
+ * @param[in] mod The model
+ * @param[in] xLeft The left point
+ * @param[in] errorTh Maximal authorized error threshold (a squared distance)
+ * @param[in] rightGrid The grid of the right points
+ * @param[out] out_candidates The indices of the candidate right points
+ */
+template<typename ErrorT, typename ModelT>
+void getGuidedMatchingCandidates(const ErrorT& errorEstimator, const ModelT& mod, const Vec2& xLeft, double errorTh,
+                                 const PointsGrid& rightGrid, std::vector<IndexT>& out_candidates)
+{
+  detail::getCandidates(errorEstimator, mod, xLeft, errorTh, rightGrid, out_candidates, 0);
+}
+
 /**
  * @brief Guided Matching (features only):
  *        Use a model to find valid correspondences:
@@ -40,16 +101,26 @@ void guidedMatching(const ModelT& mod, const Mat& xLeft, const Mat& xRight, doub
 
   const ErrorT errorEstimator = ErrorT();
 
+  // the right points are only tested near their location predicted by the model
+  std::vector<Vec2> rightPoints(xRight.cols());
+  for(Mat::Index j = 0; j < xRight.cols(); ++j)
+    rightPoints[j] = xRight.col(j);
+  const PointsGrid rightGrid(rightPoints, PointsGrid::getCellSize(rightPoints, std::sqrt(errorTh)));
+  std::vector<IndexT> candidates;
+
   // looking for the corresponding points that have
   // the smallest distance (smaller than the provided Threshold)
   for(Mat::Index i = 0; i < xLeft.cols(); ++i)
   {
+    const Vec2 leftPoint = xLeft.col(i);
+    getGuidedMatchingCandidates(errorEstimator, mod, leftPoint, errorTh, rightGrid, candidates);
+
     double min = std::numeric_limits<double>::max();
     matching::IndMatch match;
-    for(Mat::Index j = 0; j < xRight.cols(); ++j)
+    for(const IndexT j : candidates)
     {
       // compute the geometric error: error to the model
-      const double err = errorEstimator.error(mod, xLeft.col(i), xRight.col(j));
+      const double err = errorEstimator.error(mod, leftPoint, rightPoints[j]);
 
       // if smaller error update corresponding index
       if(err < errorTh && err < min)
@@ -251,10 +322,16 @@ void guidedMatching(const ModelT& mod,
       rRegionsPos[i] = rRegions.GetRegionPosition(i);
   }
 
+  // the right regions are only tested near their location predicted by the model
+  const PointsGrid rightGrid(rRegionsPos, PointsGrid::getCellSize(rRegionsPos, std::sqrt(errorTh)));
+  std::vector<IndexT> candidates;
+
   for(std::size_t i = 0; i < lRegions.RegionCount(); ++i)
   {
+    getGuidedMatchingCandidates(errorEstimator, mod, lRegionsPos[i], errorTh, rightGrid, candidates);
+
     distanceRatio<double> dR;
-    for(std::size_t j = 0; j < rRegions.RegionCount(); ++j)
+    for(const IndexT j : candidates)
     {
       // compute the geometric error: error to the model
       const double geomErr = errorEstimator.error(mod, lRegionsPos[i], rRegionsPos[j]);
@@ -108,6 +108,109 @@ BOOST_AUTO_TEST_CASE(IndMatch_IO)
   boost::filesystem::remove_all(testFolder);
 }
 
+BOOST_AUTO_TEST_CASE(IndMatch_IO_Binary)
+{
+  const std::string testFolder = "matchingBinTest";
+  boost::filesystem::create_directory(testFolder);
+  {
+    PairwiseMatches matches;
+    matches[std::make_pair(0,1)][EImageDescriberType::UNKNOWN] = {{0,0},{1,1}};
+    matches[std::make_pair(0,1)][EImageDescriberType::SIFT] = {{5,6}};
+    matches[std::make_pair(1,2)][EImageDescriberType::UNKNOWN] = {{0,0},{1,1}, {2,2}};
+    matches[std::make_pair(2,3)][EImageDescriberType::UNKNOWN] = {{7,8}};
+
+    BOOST_CHECK(Save(matches, testFolder, "bin", false));
+
+    // load all the pairs
+    PairwiseMatches loadedMatches;
+    BOOST_CHECK(Load(loadedMatches, {}, {testFolder}, {}));
+    BOOST_CHECK_EQUAL(matches.size(), loadedMatches.size());
+    for(const auto& pairMatches : matches)
+    {
+      for(const auto& descMatches : pairMatches.second)
+        BOOST_CHECK(descMatches.second == loadedMatches.at(pairMatches.first).at(descMatches.first));
+    }
+
+    // load only the pairs of a view subset
+    loadedMatches.clear();
+    BOOST_CHECK(LoadMatchFile(loadedMatches, (fs::path(testFolder) / "matches.bin").string(), {1, 2, 3}));
+    BOOST_CHECK_EQUAL(2, loadedMatches.size());
+    BOOST_CHECK_EQUAL(1, loadedMatches.count(std::make_pair(1,2)));
+    BOOST_CHECK_EQUAL(1, loadedMatches.count(std::make_pair(2,3)));
+    BOOST_CHECK(matches.at(std::make_pair(1,2)).at(EImageDescriberType::UNKNOWN) ==
+                loadedMatches.at(std::make_pair(1,2)).at(EImageDescriberType::UNKNOWN));
+  }
+  boost::filesystem::remove_all(testFolder);
+  boost::filesystem::create_directory(testFolder);
+  {
+    // one file per image
+    PairwiseMatches matches;
+    matches[std::make_pair(0,1)][EImageDescriberType::UNKNOWN] = {{0,0},{1,1}};
+    matches[std::make_pair(1,2)][EImageDescriberType::UNKNOWN] = {{0,0},{1,1}, {2,2}};
+
+    BOOST_CHECK(Save(matches, testFolder, "bin", true));
+    PairwiseMatches loadedMatches;
+    BOOST_CHECK(Load(loadedMatches, {0, 1, 2}, {testFolder}, {EImageDescriberType::UNKNOWN}));
+    BOOST_CHECK_EQUAL(2, loadedMatches.size());
+    BOOST_CHECK_EQUAL(3, loadedMatches.at(std::make_pair(1,2)).at(EImageDescriberType::UNKNOWN).size());
+  }
+  boost::filesystem::remove_all(testFolder);
+}
+
+BOOST_AUTO_TEST_CASE(IndMatch_IO_Writer)
+{
+  const std::string testFolder = "matchingWriterTest";
+  boost::filesystem::create_directory(testFolder);
+  {
+    // one file per image, written once all the pairs of the image are added
+    const PairSet pairs = {{0, 1}, {0, 2}, {1, 2}};
+    PairwiseMatchesWriter writer(pairs, testFolder, "bin", true);
+
+    MatchesPerDescType matches01;
+    matches01[EImageDescriberType::UNKNOWN] = {{0,0},{1,1}};
+    writer.add(std::make_pair(0,1), std::move(matches01));
+    BOOST_CHECK(!fs::exists(fs::path(testFolder) / "0.matches.bin"));
+
+    // a discarded pair
+    writer.add(std::make_pair(0,2), MatchesPerDescType());
+    BOOST_CHECK(fs::exists(fs::path(testFolder) / "0.matches.bin"));
+    BOOST_CHECK_EQUAL(1, writer.getNbWrittenPairs());
+
+    MatchesPerDescType matches12;
+    matches12[EImageDescriberType::UNKNOWN] = {{0,0},{1,1},{2,2}};
+    writer.add(std::make_pair(1,2), std::move(matches12));
+    writer.finish();
+    BOOST_CHECK_EQUAL(2, writer.getNbWrittenPairs());
+
+    PairwiseMatches loadedMatches;
+    BOOST_CHECK(Load(loadedMatches, {0, 1, 2}, {testFolder}, {EImageDescriberType::UNKNOWN}));
+    BOOST_CHECK_EQUAL(2, loadedMatches.size());
+    BOOST_CHECK_EQUAL(0, loadedMatches.count(std::make_pair(0,2)));
+    BOOST_CHECK_EQUAL(2, loadedMatches.at(std::make_pair(0,1)).at(EImageDescriberType::UNKNOWN).size());
+    BOOST_CHECK_EQUAL(3, loadedMatches.at(std::make_pair(1,2)).at(EImageDescriberType::UNKNOWN).size());
+  }
+  boost::filesystem::remove_all(testFolder);
+  boost::filesystem::create_directory(testFolder);
+  {
+    // a global file written by finish
+    const PairSet pairs = {{0, 1}, {1, 2}};
+    PairwiseMatchesWriter writer(pairs, testFolder, "txt", false);
+
+    MatchesPerDescType matches01;
+    matches01[EImageDescriberType::UNKNOWN] = {{0,0},{1,1}};
+    writer.add(std::make_pair(0,1), std::move(matches01));
+    writer.add(std::make_pair(1,2), MatchesPerDescType());
+    BOOST_CHECK(!fs::exists(fs::path(testFolder) / "matches.txt"));
+    writer.finish();
+
+    PairwiseMatches loadedMatches;
+    BOOST_CHECK(Load(loadedMatches, {0, 1, 2}, {testFolder}, {EImageDescriberType::UNKNOWN}));
+    BOOST_CHECK_EQUAL(1, loadedMatches.size());
+    BOOST_CHECK_EQUAL(2, loadedMatches.at(std::make_pair(0,1)).at(EImageDescriberType::UNKNOWN).size());
+  }
+  boost::filesystem::remove_all(testFolder);
+}
+
 BOOST_AUTO_TEST_CASE(IndMatch_DuplicateRemoval_NoRemoval)
 {
   std::vector<IndMatch> vec_indMatch;
@@ -11,8 +11,10 @@
 #include <aliceVision/system/Logger.hpp>
 
 #include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 #include <boost/range/iterator_range.hpp>
 
+#include <cstring>
 #include <map>
 #include <fstream>
 #include <iterator>
@@ -24,52 +26,173 @@ namespace fs = boost::filesystem;
 namespace aliceVision {
 namespace matching {
 
-bool LoadMatchFile(PairwiseMatches& matches, const std::string& filepath)
+bool MatchFileHeader::isValid() const
 {
-  const std::string ext = fs::extension(filepath);
+  return std::memcmp(magic, MatchFileHeader().magic, sizeof(magic)) == 0;
+}
 
-  if(!fs::exists(filepath))
+namespace {
+
+bool isPairInViews(std::size_t I, std::size_t J, const std::set<IndexT>& viewsKeysFilter)
+{
+  return viewsKeysFilter.empty() ||
+         (viewsKeysFilter.count(I) && viewsKeysFilter.count(J));
+}
+
+bool loadTxtMatchFile(PairwiseMatches& matches, const std::string& filepath, const std::set<IndexT>& viewsKeysFilter)
+{
+  std::ifstream stream(filepath);
+  if (!stream.is_open())
     return false;
 
-  if(ext == ".txt")
+  // Read from the text file
+  // I J
+  // nbDescType
+  // descType matchesCount
+  // idx idx
+  // ...
+  // descType matchesCount
+  // idx idx
+  // ...
+  std::size_t I = 0;
+  std::size_t J = 0;
+  std::size_t nbDescType = 0;
+  while(stream >> I >> J >> nbDescType)
   {
-    std::ifstream stream(filepath);
-    if (!stream.is_open())
-      return false;
-
-    // Read from the text file
-    // I J
-    // nbDescType
-    // descType matchesCount
-    // idx idx
-    // ...
-    // descType matchesCount
-    // idx idx
-    // ...
-    std::size_t I = 0;
-    std::size_t J = 0;
-    std::size_t nbDescType = 0;
-    while(stream >> I >> J >> nbDescType)
+    const bool keepPair = isPairInViews(I, J, viewsKeysFilter);
+    for(std::size_t i = 0; i < nbDescType; ++i)
     {
-      for(std::size_t i = 0; i < nbDescType; ++i)
+      std::string descTypeStr;
+      std::size_t nbMatches = 0;
+      // Read descType and number of matches
+      stream >> descTypeStr >> nbMatches;
+
+      feature::EImageDescriberType descType = feature::EImageDescriberType_stringToEnum(descTypeStr);
+      std::vector<IndMatch> matchesPerDesc(nbMatches);
+      // Read all matches
+      for(std::size_t i = 0; i < nbMatches; ++i)
       {
-        std::string descTypeStr;
-        std::size_t nbMatches = 0;
-        // Read descType and number of matches
-        stream >> descTypeStr >> nbMatches;
-
-        feature::EImageDescriberType descType = feature::EImageDescriberType_stringToEnum(descTypeStr);
-        std::vector<IndMatch> matchesPerDesc(nbMatches);
-        // Read all matches
-        for(std::size_t i = 0; i < nbMatches; ++i)
-        {
-          stream >> matchesPerDesc[i];
-        }
-        matches[std::make_pair(I,J)][descType] = std::move(matchesPerDesc);
+        stream >> matchesPerDesc[i];
       }
+      if(keepPair)
+        matches[std::make_pair(I,J)][descType] = std::move(matchesPerDesc);
+    }
+  }
+  stream.close();
+  return true;
+}
+
+/// Read a value from a memory block, return false if the block is too small
+template <typename T>
+bool readValue(const char*& data, const char* dataEnd, T& value)
+{
+  if(static_cast<std::size_t>(dataEnd - data) < sizeof(T))
+    return false;
+  std::memcpy(&value, data, sizeof(T));
+  data += sizeof(T);
+  return true;
+}
+
+bool loadBinMatchBlock(MatchesPerDescType& matchesPerDesc, const char* data, const char* dataEnd)
+{
+  std::uint32_t nbDescType = 0;
+  if(!readValue(data, dataEnd, nbDescType))
+    return false;
+
+  for(std::uint32_t d = 0; d < nbDescType; ++d)
+  {
+    std::uint32_t nameLength = 0;
+    if(!readValue(data, dataEnd, nameLength) || static_cast<std::size_t>(dataEnd - data) < nameLength)
+      return false;
+    const std::string descTypeStr(data, nameLength);
+    data += nameLength;
+
+    std::uint64_t nbMatches = 0;
+    if(!readValue(data, dataEnd, nbMatches) || static_cast<std::uint64_t>(dataEnd - data) / (2 * sizeof(std::uint32_t)) < nbMatches)
+      return false;
+
+    IndMatches& pairMatches = matchesPerDesc[feature::EImageDescriberType_stringToEnum(descTypeStr)];
+    pairMatches.resize(nbMatches);
+    for(IndMatch& match : pairMatches)
+    {
+      std::uint32_t indexes[2];
+      std::memcpy(indexes, data, sizeof(indexes));
+      data += sizeof(indexes);
+      match = IndMatch(indexes[0], indexes[1]);
+    }
+  }
+  return true;
+}
+
+bool loadBinMatchFile(PairwiseMatches& matches, const std::string& filepath, const std::set<IndexT>& viewsKeysFilter)
+{
+  boost::iostreams::mapped_file_source file;
+  try
+  {
+    file.open(filepath);
+  }
+  catch(const std::exception&)
+  {
+    return false;
+  }
+
+  MatchFileHeader header;
+  if(file.size() < sizeof(MatchFileHeader))
+  {
+    ALICEVISION_LOG_WARNING("Invalid matching file: " << filepath);
+    return false;
+  }
+  std::memcpy(&header, file.data(), sizeof(MatchFileHeader));
+
+  if(!header.isValid() ||
+     header.version > MatchFileHeader::currentVersion ||
+     header.indexOffset > file.size() ||
+     (file.size() - header.indexOffset) / sizeof(MatchFileEntry) < header.pairCount)
+  {
+    ALICEVISION_LOG_WARNING("Invalid matching file: " << filepath);
+    return false;
+  }
+
+  std::vector<MatchFileEntry> entries(header.pairCount);
+  std::memcpy(entries.data(), file.data() + header.indexOffset, entries.size() * sizeof(MatchFileEntry));
+
+  for(const MatchFileEntry& entry : entries)
+  {
+    if(!isPairInViews(entry.I, entry.J, viewsKeysFilter))
+      continue;
+
+    if(entry.offset > file.size() || entry.size > file.size() - entry.offset)
+    {
+      ALICEVISION_LOG_WARNING("Invalid matching file: " << filepath << " (pair " << entry.I << "-" << entry.J << ")");
+      return false;
+    }
+
+    const char* block = file.data() + entry.offset;
+    if(!loadBinMatchBlock(matches[std::make_pair(entry.I, entry.J)], block, block + entry.size))
+    {
+      ALICEVISION_LOG_WARNING("Invalid matching file: " << filepath << " (pair " << entry.I << "-" << entry.J << ")");
+      return false;
     }
-    stream.close();
-    return true;
+  }
+  return true;
+}
+
+} // namespace
+
+bool LoadMatchFile(PairwiseMatches& matches, const std::string& filepath, const std::set<IndexT>& viewsKeysFilter)
+{
+  const std::string ext = fs::extension(filepath);
+
+  if(!fs::exists(filepath))
+    return false;
+
+  if(ext == ".txt")
+  {
+    return loadTxtMatchFile(matches, filepath, viewsKeysFilter);
+  }
+  else if(ext == ".bin")
+  {
+    return loadBinMatchFile(matches, filepath, viewsKeysFilter);
   }
   else
   {
@@ -167,21 +290,30 @@ std::size_t LoadMatchFilePerImage(PairwiseMatches& matches,
 }
 
 /**
- * Load and add pair-wise matches to \p matches from all files in \p folder matching \p pattern.
+ * Load and add pair-wise matches to \p matches from all files in \p folder matching one of the \p patterns.
  * @param[out] matches PairwiseMatches to add loaded matches to
  * @param[in] folder Folder to load matches files from
- * @param[in] pattern Pattern that files must respect to be loaded
+ * @param[in] patterns Patterns that files must respect to be loaded (one is enough)
+ * @param[in] viewsKeysFilter Only load the pairs with both views in this set (empty loads all the pairs)
  */
-std::size_t loadMatchesFromFolder(PairwiseMatches& matches, const std::string& folder, const std::string& pattern)
+std::size_t loadMatchesFromFolder(PairwiseMatches& matches,
+                                  const std::string& folder,
+                                  const std::vector<std::string>& patterns,
+                                  const std::set<IndexT>& viewsKeysFilter)
 {
   std::size_t nbLoadedMatchFiles = 0;
   std::vector<std::string> matchFiles;
-  // list all matches files in 'folder' matching (i.e containing) 'pattern'
+  // list all matches files in 'folder' matching (i.e containing) one of the 'patterns'
   for(const auto& entry : boost::make_iterator_range(fs::directory_iterator(folder), {}))
   {
-    if(entry.path().string().find(pattern) != std::string::npos)
+    const std::string path = entry.path().string();
+    for(const std::string& pattern : patterns)
     {
-      matchFiles.push_back(entry.path().string());
+      if(path.find(pattern) != std::string::npos)
+      {
+        matchFiles.push_back(path);
+        break;
+      }
     }
   }
 
@@ -191,7 +323,7 @@ std::size_t loadMatchesFromFolder(PairwiseMatches& matches, const std::string& f
     const std::string& matchFile = matchFiles[i];
     PairwiseMatches fileMatches;
     ALICEVISION_LOG_DEBUG("Loading match file: " << matchFile);
-    if(!LoadMatchFile(fileMatches, matchFile))
+    if(!LoadMatchFile(fileMatches, matchFile, viewsKeysFilter))
     {
       ALICEVISION_LOG_WARNING("Unable to load match file: " << matchFile);
       continue;
@@ -230,7 +362,7 @@ bool Load(PairwiseMatches& matches,
           int minNbMatches)
 {
   std::size_t nbLoadedMatchFiles = 0;
-  const std::string pattern = "matches.txt";
+  const std::vector<std::string> patterns = {"matches.txt", "matches.bin"};
 
   // build up a set with normalized paths to remove duplicates
   std::set<std::string> foldersSet;
@@ -244,7 +376,7 @@ bool Load(PairwiseMatches& matches,
 
   for(const auto& folder : foldersSet)
   {
-    nbLoadedMatchFiles += loadMatchesFromFolder(matches, folder, pattern);
+    nbLoadedMatchFiles += loadMatchesFromFolder(matches, folder, patterns, viewsKeysFilter);
   }
 
   if(!nbLoadedMatchFiles)
@@ -315,6 +447,85 @@ private:
     fs::rename(tmpPath, filepath);
   }
 
+  void saveBin(
+    const std::string& filepath,
+    const PairwiseMatches::const_iterator& matchBegin,
+    const PairwiseMatches::const_iterator& matchEnd)
+  {
+    const fs::path bPath = fs::path(filepath);
+    const std::string tmpPath = (bPath.parent_path() / bPath.stem()).string() + "." + fs::unique_path().string() + bPath.extension().string();
+
+    // write temporary file
+    {
+      std::ofstream stream(tmpPath, std::ios::out | std::ios::binary);
+      if(!stream.is_open())
+        throw std::runtime_error("Can't save matches, can't open '" + tmpPath + "' !");
+
+      MatchFileHeader header;
+      stream.write(reinterpret_cast<const char*>(&header), sizeof(MatchFileHeader));
+
+      std::vector<MatchFileEntry> entries;
+      std::vector<std::uint32_t> indexes;
+      for(PairwiseMatches::const_iterator match = matchBegin;
+        match != matchEnd;
+        ++match)
+      {
+        MatchFileEntry entry;
+        entry.I = static_cast<std::uint32_t>(match->first.first);
+        entry.J = static_cast<std::uint32_t>(match->first.second);
+        entry.offset = static_cast<std::uint64_t>(stream.tellp());
+
+        const MatchesPerDescType & matchesPerDesc = match->second;
+        const std::uint32_t nbDescType = static_cast<std::uint32_t>(matchesPerDesc.size());
+        stream.write(reinterpret_cast<const char*>(&nbDescType), sizeof(nbDescType));
+        for(const auto& m: matchesPerDesc)
+        {
+          const std::string descTypeStr = feature::EImageDescriberType_enumToString(m.first);
+          const std::uint32_t nameLength = static_cast<std::uint32_t>(descTypeStr.size());
+          const std::uint64_t nbMatches = m.second.size();
+          stream.write(reinterpret_cast<const char*>(&nameLength), sizeof(nameLength));
+          stream.write(descTypeStr.data(), nameLength);
+          stream.write(reinterpret_cast<const char*>(&nbMatches), sizeof(nbMatches));
+
+          indexes.resize(2 * m.second.size());
+          for(std::size_t i = 0; i < m.second.size(); ++i)
+          {
+            indexes[2 * i] = m.second[i]._i;
+            indexes[2 * i + 1] = m.second[i]._j;
+          }
+          stream.write(reinterpret_cast<const char*>(indexes.data()), indexes.size() * sizeof(std::uint32_t));
+        }
+        entry.size = static_cast<std::uint64_t>(stream.tellp()) - entry.offset;
+        entries.push_back(entry);
+      }
+
+      header.pairCount = entries.size();
+      header.indexOffset = static_cast<std::uint64_t>(stream.tellp());
+      stream.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(MatchFileEntry));
+      stream.seekp(0);
+      stream.write(reinterpret_cast<const char*>(&header), sizeof(MatchFileHeader));
+
+      if(!stream.good())
+        throw std::runtime_error("Can't save matches, '" + tmpPath + "' is incorrect !");
+    }
+
+    // rename temporary file
+    fs::rename(tmpPath, filepath);
+  }
+
+  void save(
+    const std::string& filepath,
+    const PairwiseMatches::const_iterator& matchBegin,
+    const PairwiseMatches::const_iterator& matchEnd)
+  {
+    if(m_ext == ".txt")
+      saveTxt(filepath, matchBegin, matchEnd);
+    else if(m_ext == ".bin")
+      saveBin(filepath, matchBegin, matchEnd);
+    else
+      throw std::runtime_error(std::string("Unknown matching file format: ") + m_ext);
+  }
+
 public:
   MatchExporter(
     const PairwiseMatches& matches,
@@ -331,11 +542,7 @@ public:
   void saveGlobalFile()
   {
     const std::string filepath = (fs::path(m_directory) / m_filename).string();
-
-    if(m_ext == ".txt")
-      saveTxt(filepath, m_matches.begin(), m_matches.end());
-    else
-      throw std::runtime_error(std::string("Unknown matching file format: ") + m_ext);
+    save(filepath, m_matches.begin(), m_matches.end());
   }
 
   /// Export matches into separate files, one for each image.
@@ -356,11 +563,7 @@ public:
         ++match;
       const std::string filepath = (fs::path(m_directory) / (std::to_string(key) + "." + m_filename)).string();
       ALICEVISION_LOG_DEBUG("Export Matches in: " << filepath);
-      
-      if(m_ext == ".txt")
-        saveTxt(filepath, matchBegin, match);
-      else
-        throw std::runtime_error(std::string("Unknown matching file format: ") + m_ext);
+      save(filepath, matchBegin, match);
 
       matchBegin = match;
     }
@@ -390,5 +593,74 @@ bool Save(const PairwiseMatches& matches,
   return true;
 }
 
+PairwiseMatchesWriter::PairwiseMatchesWriter(const PairSet& pairs,
+                                             const std::string& folder,
+                                             const std::string& extension,
+                                             bool matchFilePerImage,
+                                             const std::string& prefix)
+  : _folder(folder)
+  , _extension(extension)
+  , _matchFilePerImage(matchFilePerImage)
+  , _prefix(prefix)
+{
+  for(const Pair& pair : pairs)
+    ++_nbPairsLeftPerImage[pair.first];
+}
+
+void PairwiseMatchesWriter::add(const Pair& pair, MatchesPerDescType&& matches)
+{
+  PairwiseMatches imageMatches;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if(!matches.empty())
+      _matches.emplace(pair, std::move(matches));
+
+    if(!_matchFilePerImage)
+      return;
+
+    const auto nbPairsLeftIt = _nbPairsLeftPerImage.find(pair.first);
+    if(nbPairsLeftIt == _nbPairsLeftPerImage.end())
+      throw std::runtime_error("Can't save matches, unexpected image pair (" + std::to_string(pair.first) + ", " + std::to_string(pair.second) + ").");
+    if(--nbPairsLeftIt->second > 0)
+      return;
+    _nbPairsLeftPerImage.erase(nbPairsLeftIt);
+
+    // all the pairs of the image are added, its matches are written outside the lock
+    const auto imageBegin = _matches.lower_bound(Pair(pair.first, 0));
+    const auto imageEnd = _matches.lower_bound(Pair(pair.first + 1, 0));
+    imageMatches.insert(imageBegin, imageEnd);
+    _matches.erase(imageBegin, imageEnd);
+    _nbWrittenPairs += imageMatches.size();
+  }
+  save(imageMatches);
+}
+
+void PairwiseMatchesWriter::finish()
+{
+  PairwiseMatches matches;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::swap(matches, _matches);
+    _nbPairsLeftPerImage.clear();
+    _nbWrittenPairs += matches.size();
+  }
+  save(matches);
+}
+
+std::size_t PairwiseMatchesWriter::getNbWrittenPairs() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _nbWrittenPairs;
+}
+
+void PairwiseMatchesWriter::save(const PairwiseMatches& matches) const
+{
+  // the global file is written even without matches, as Save does
+  if(matches.empty() && _matchFilePerImage)
+    return;
+  Save(matches, _folder, _extension, _matchFilePerImage, _prefix);
+}
+
 }  // namespace matching
 }  // namespace aliceVision
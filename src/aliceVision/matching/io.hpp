@@ -9,6 +9,10 @@
 
 #include <aliceVision/matching/IndMatch.hpp>
 
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
 #include <string>
 
 namespace aliceVision {
@@ -16,12 +20,49 @@ namespace matching {
 
 
 /**
- * @brief Load a match file.
+ * @brief Binary match file layout (.bin).
+ *
+ * - a MatchFileHeader,
+ * - for each pair, a block with:
+ *   - the number of describer types (uint32),
+ *   - for each describer type: the name length (uint32), the name,
+ *     the number of matches (uint64) and the (i, j) feature indexes (2 x uint32 per match),
+ * - an index of MatchFileEntry sorted by pair, located at MatchFileHeader::indexOffset.
+ *
+ * The index allows to only decode the blocks of the requested pairs.
+ */
+struct MatchFileHeader
+{
+  static constexpr std::uint32_t currentVersion = 1;
+
+  char magic[8] = {'A', 'V', 'M', 'A', 'T', 'C', 'H', '\0'};
+  std::uint32_t version = currentVersion;
+  std::uint32_t reserved = 0;
+  std::uint64_t pairCount = 0;
+  std::uint64_t indexOffset = 0;
+
+  bool isValid() const;
+};
+
+struct MatchFileEntry
+{
+  std::uint32_t I = 0;
+  std::uint32_t J = 0;
+  std::uint64_t offset = 0;
+  std::uint64_t size = 0;
+};
+
+/**
+ * @brief Load a match file (.txt or .bin).
  *
  * @param[out] matches container for the output matches
  * @param[in] filepath the match file to load
+ * @param[in] viewsKeysFilter only load the pairs with both views in this set (empty loads all the pairs).
+ *            With the binary format, the other pairs are not even read.
  */
-bool LoadMatchFile(PairwiseMatches& matches, const std::string& filepath);
+bool LoadMatchFile(PairwiseMatches& matches,
+                   const std::string& filepath,
+                   const std::set<IndexT>& viewsKeysFilter = std::set<IndexT>());
 
 /**
  * @brief Load the match file for each image.
@@ -39,6 +80,7 @@ std::size_t LoadMatchFilePerImage(PairwiseMatches& matches,
 /**
  * @brief Load all the matches from the folder. Optionally filter the view, the type of descriptors
  * and the number of matches.
+ * Both text (*matches.txt) and binary (*matches.bin) match files are loaded.
  *
  * @param[out] matches container for the output matches.
  * @param[in] viewsKeysFilter Restrict the matches to these views.
@@ -88,5 +130,56 @@ bool Save(const PairwiseMatches& matches,
           bool matchFilePerImage,
           const std::string& prefix = "");
 
+/**
+ * @brief Write the match files while the matches of the image pairs are computed.
+ *
+ * With one match file per image, the file of an image is written as soon as all its pairs
+ * are added, and its matches are released, so the matches of all the pairs are never kept
+ * in memory together. With a global match file, the matches are written by finish().
+ * The add() calls are thread-safe.
+ */
+class PairwiseMatchesWriter
+{
+public:
+  /**
+   * @param[in] pairs: the image pairs which will be added
+   * @see Save for the other parameters
+   */
+  PairwiseMatchesWriter(const PairSet& pairs,
+                        const std::string& folder,
+                        const std::string& extension,
+                        bool matchFilePerImage,
+                        const std::string& prefix = "");
+
+  /**
+   * @brief Add the matches of an image pair.
+   * @param[in] pair: one of the image pairs given to the constructor
+   * @param[in] matches: the matches of the pair, empty if the pair is discarded
+   */
+  void add(const Pair& pair, MatchesPerDescType&& matches);
+
+  /**
+   * @brief Write the matches left, of the images whose pairs have not all been added.
+   */
+  void finish();
+
+  /// the number of written image pairs
+  std::size_t getNbWrittenPairs() const;
+
+private:
+  void save(const PairwiseMatches& matches) const;
+
+  const std::string _folder;
+  const std::string _extension;
+  const bool _matchFilePerImage;
+  const std::string _prefix;
+
+  mutable std::mutex _mutex;
+  PairwiseMatches _matches;
+  /// the number of pairs to add by first image of the pairs
+  std::map<IndexT, std::size_t> _nbPairsLeftPerImage;
+  std::size_t _nbWrittenPairs = 0;
+};
+
 }  // namespace matching
 }  // namespace aliceVision
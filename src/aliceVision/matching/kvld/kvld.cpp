@@ -15,7 +15,10 @@
 
 #include "kvld.h"
 #include "algorithm.h"
+#include <algorithm>
+#include <atomic>
 #include <functional>
+#include <limits>
 #include <numeric>
 #include <aliceVision/image/all.hpp>
 #include <aliceVision/config.hpp>
@@ -119,7 +122,7 @@ VLD::VLD( const ImageScale& series, T const& P1, T const& P2 ) : contrast( 0.0 )
   distance = std::hypot( dy, dx );
 
   if( distance == 0 )
-    std::cerr << "Two SIFT points have the same coordinate" << std::endl;
+    ALICEVISION_LOG_WARNING("Two SIFT points have the same coordinate");
 
   const float radius = std::max( distance / float( dimension + 1 ), 2.0f );//at least 2
 
@@ -135,8 +138,11 @@ VLD::VLD( const ImageScale& series, T const& P1, T const& P2 ) : contrast( 0.0 )
   const int h = m.Height();
   const float r = float( radius / ratio );
   const float sigma2 = r * r;
+  const double twoPi = 2 * constants::pi<double>();
   //======calculating the descriptor=====//
 
+  // the gaussian weight is separable, the column and row terms are computed once per disc
+  std::vector< double > columnWeights;
   double statistic[ binNum ];
   for( int i = 0; i < dimension; i++ )
   {
@@ -147,42 +153,65 @@ VLD::VLD( const ImageScale& series, T const& P1, T const& P2 ) : contrast( 0.0 )
     xi /= float( ratio );
     yi /= float( ratio );
 
-    for( int y = int( yi - r ); y <= int( yi + r + 0.5 ); y++ )
+    // disc bounding box, restricted to the pixels with a gradient
+    const int xBegin = std::max( int( xi - r ), 1 );
+    const int xEnd   = std::min( int( xi + r + 0.5 ), w - 2 );
+    const int yBegin = std::max( int( yi - r ), 1 );
+    const int yEnd   = std::min( int( yi + r + 0.5 ), h - 2 );
+    if( xBegin > xEnd || yBegin > yEnd )
+      continue;
+
+    columnWeights.resize( xEnd - xBegin + 1 );
+    for( int x = xBegin; x <= xEnd; x++ )
+    {
+      const float ddx = xi - float( x );
+      columnWeights[ x - xBegin ] = exp( -ddx * ddx / 4.5 / sigma2 );
+    }
+
+    for( int y = yBegin; y <= yEnd; y++ )
     {
-      for( int x = int( xi - r ); x <= int( xi + r + 0.5 ); x++ )
+      const float ddy = yi - float( y );
+      const float ddy2 = ddy * ddy;
+      if( ddy2 > sigma2 )
+        continue;
+      const double rowWeight = exp( -ddy2 / 4.5 / sigma2 );
+      const float* angRow = &ang( y, 0 );
+      const float* mRow = &m( y, 0 );
+
+      for( int x = xBegin; x <= xEnd; x++ )
       {
-        float d = point_distance( xi, yi, float( x ), float( y ) );
-        if( d <= r && inside( w, h, x, y, 1 ) )
+        const float ddx = xi - float( x );
+        if( ddx * ddx + ddy2 > sigma2 )
+          continue;
+
+        //================angle and magnitude==========================//
+        // both orientations are in [0, 2*PI[, the relative angle is wrapped once
+        double angle = 0.0;
+        if( angRow[ x ] >= 0 )
         {
-          //================angle and magnitude==========================//
-          double angle;
-          if( ang( y, x ) >= 0 )
-            angle = ang( y, x ) - mainAngle;//relative angle
-          else angle = 0.0;
-
-          //cout<<angle<<endl;
-          while( angle < 0 )
-              angle += 2 * constants::pi<double>();
-          while(angle >= 2 * constants::pi<double>())
-              angle -= 2 * constants::pi<double>();
-
-          //===============principle angle==============================//
-          const int index = int(angle * binNum / (2 * constants::pi<double>()) + 0.5);
-
-          double Gweight = exp( -d * d / 4.5 / sigma2 ) * ( m( y, x ) );
-          if( index < binNum )
-            statistic[ index ] += Gweight;
-          else // possible since the 0.5
-            statistic[ 0 ] += Gweight;
-
-          //==============the descriptor===============================//
-          const int index2 = int(angle * subdirection / (2 * constants::pi<double>()) + 0.5);
-          assert( index2 >= 0 && index2 <= subdirection );
-
-          if( index2 < subdirection )
-            descriptor[ subdirection * i + index2 ] += Gweight;
-          else descriptor[ subdirection * i ] += Gweight;// possible since the 0.5
+          angle = angRow[ x ] - mainAngle;//relative angle
+          if( angle < 0 )
+            angle += twoPi;
+          if( angle >= twoPi )
+            angle -= twoPi;
         }
+
+        //===============principle angle==============================//
+        const int index = int( angle * binNum / twoPi + 0.5 );
+
+        const double Gweight = rowWeight * columnWeights[ x - xBegin ] * mRow[ x ];
+        if( index < binNum )
+          statistic[ index ] += Gweight;
+        else // possible since the 0.5
+          statistic[ 0 ] += Gweight;
+
+        //==============the descriptor===============================//
+        const int index2 = int( angle * subdirection / twoPi + 0.5 );
+        assert( index2 >= 0 && index2 <= subdirection );
+
+        if( index2 < subdirection )
+          descriptor[ subdirection * i + index2 ] += Gweight;
+        else descriptor[ subdirection * i ] += Gweight;// possible since the 0.5
       }
     }
     //=====================find the biggest angle of ith SIFT==================//
@@ -199,239 +228,413 @@ VLD::VLD( const ImageScale& series, T const& P1, T const& P2 ) : contrast( 0.0 )
   normalize_weight( weight );
 }
 
-float KVLD( const Image< float >& I1,
-            const Image< float >& I2,
-            const std::vector<feature::PointFeature> & F1,
-            const std::vector<feature::PointFeature> & F2,
-            const std::vector< Pair >& matches,
-            std::vector< Pair >& matchesFiltered,
-            std::vector< double >& score,
-            aliceVision::Mat& E,
-            std::vector< bool >& valide,
-            KvldParameters& kvldParameters )
+namespace {
+
+//====== Uniform grid on the keypoints of the matches in one image, to search the neighbor matches ======//
+class MatchesGrid
+{
+public:
+  MatchesGrid( const std::vector< feature::PointFeature >& features, const std::vector< Pair >& matches, bool first, float cellSize )
+    : _cellSize( cellSize )
+  {
+    _positions.resize( matches.size() );
+    Vec2f minPosition = Vec2f::Constant( std::numeric_limits< float >::max() );
+    Vec2f maxPosition = Vec2f::Constant( std::numeric_limits< float >::lowest() );
+    for( std::size_t i = 0; i < matches.size(); ++i )
+    {
+      _positions[ i ] = features[ first ? matches[ i ].first : matches[ i ].second ].coords();
+      minPosition = minPosition.cwiseMin( _positions[ i ] );
+      maxPosition = maxPosition.cwiseMax( _positions[ i ] );
+    }
+    if( matches.empty() )
+      minPosition = maxPosition = Vec2f::Zero();
+
+    _origin = minPosition;
+    _width  = int( ( maxPosition.x() - minPosition.x() ) / _cellSize ) + 1;
+    _height = int( ( maxPosition.y() - minPosition.y() ) / _cellSize ) + 1;
+
+    // counting sort of the matches by cell
+    std::vector< int > cells( matches.size() );
+    _cellOffsets.assign( std::size_t( _width ) * _height + 1, 0 );
+    for( std::size_t i = 0; i < matches.size(); ++i )
+    {
+      cells[ i ] = cellIndex( cellX( _positions[ i ].x() ), cellY( _positions[ i ].y() ) );
+      ++_cellOffsets[ cells[ i ] + 1 ];
+    }
+    std::partial_sum( _cellOffsets.begin(), _cellOffsets.end(), _cellOffsets.begin() );
+    _cellMatches.resize( matches.size() );
+    std::vector< int > cursor( _cellOffsets.begin(), _cellOffsets.end() - 1 );
+    for( std::size_t i = 0; i < matches.size(); ++i )
+      _cellMatches[ cursor[ cells[ i ] ]++ ] = int( i );
+  }
+
+  /// append the matches whose keypoint is closer than the cell size to the keypoint of match i
+  void neighbors( int i, std::vector< int >& out ) const
+  {
+    const Vec2f& position = _positions[ i ];
+    const int cx = cellX( position.x() );
+    const int cy = cellY( position.y() );
+    for( int y = std::max( cy - 1, 0 ); y <= std::min( cy + 1, _height - 1 ); ++y )
+      for( int x = std::max( cx - 1, 0 ); x <= std::min( cx + 1, _width - 1 ); ++x )
+      {
+        const int cell = cellIndex( x, y );
+        for( int k = _cellOffsets[ cell ]; k < _cellOffsets[ cell + 1 ]; ++k )
+        {
+          const int j = _cellMatches[ k ];
+          if( j != i && ( _positions[ j ] - position ).norm() < _cellSize )
+            out.push_back( j );
+        }
+      }
+  }
+
+private:
+  int cellX( float x ) const { return std::min( int( ( x - _origin.x() ) / _cellSize ), _width - 1 ); }
+  int cellY( float y ) const { return std::min( int( ( y - _origin.y() ) / _cellSize ), _height - 1 ); }
+  int cellIndex( int x, int y ) const { return y * _width + x; }
+
+  float _cellSize;
+  Vec2f _origin;
+  int _width;
+  int _height;
+  std::vector< Vec2f > _positions;
+  std::vector< int > _cellOffsets;
+  std::vector< int > _cellMatches;
+};
+
+float kvldImpl( const ImageScale& Chaine1,
+                const ImageScale& Chaine2,
+                const std::vector<feature::PointFeature> & F1,
+                const std::vector<feature::PointFeature> & F2,
+                const std::vector< Pair >& matches,
+                std::vector< Pair >& matchesFiltered,
+                std::vector< double >& score,
+                aliceVision::Mat* E,
+                std::vector< bool >& valide,
+                KvldParameters& kvldParameters )
 {
   matchesFiltered.clear();
   score.clear();
-  ImageScale Chaine1( I1 );
-  ImageScale Chaine2( I2 );
 
-  std::cout << "Image scale-space complete..." << std::endl;
+  const int size = int( matches.size() );
+  valide.assign( size, true );
+  if( size == 0 )
+    return 0.f;
 
-  const float range1 = getRange( I1, std::min( F1.size(), matches.size() ), kvldParameters.inlierRate );
-  const float range2 = getRange( I2, std::min( F2.size(), matches.size() ), kvldParameters.inlierRate );
+  const float range1 = getRange( Chaine1.angles[ 0 ], std::min( F1.size(), matches.size() ), kvldParameters.inlierRate );
+  const float range2 = getRange( Chaine2.angles[ 0 ], std::min( F2.size(), matches.size() ), kvldParameters.inlierRate );
 
-  const size_t size = matches.size();
+  //================neighbors search, the matches closer than the range in one of the images===============//
+  // a match is a neighbor if it is closer than the range in one of the images, and not too close in both images
+  const MatchesGrid grid1( F1, matches, true, range1 );
+  const MatchesGrid grid2( F2, matches, false, range2 );
 
-  //================distance map construction, foruse of selecting neighbors===============//
-  std::cout << "computing distance maps" << std::endl;
+  std::vector< std::vector< int > > neighbors( size );
 
-  bool bPrecomputedDist = false;
-
-  aliceVision::Matf dist1, dist2;
-  if( bPrecomputedDist )
+  #pragma omp parallel for schedule(dynamic, 64)
+  for( int it1 = 0; it1 < size; it1++ )
   {
-    dist1 = aliceVision::Matf::Zero( F1.size(), F1.size() );
-    dist2 = aliceVision::Matf::Zero( F2.size(), F2.size() );
+    const size_t a1 = matches[ it1 ].first, b1 = matches[ it1 ].second;
+
+    std::vector< int > candidates;
+    grid1.neighbors( it1, candidates );
+    grid2.neighbors( it1, candidates );
+    std::sort( candidates.begin(), candidates.end() );
+    candidates.erase( std::unique( candidates.begin(), candidates.end() ), candidates.end() );
+
+    // the neighbors are sorted from the nearest, relatively to the ranges
+    std::vector< std::pair< float, int > > sortedNeighbors;
+    sortedNeighbors.reserve( candidates.size() );
+    for( const int it2 : candidates )
+    {
+      const size_t a2 = matches[ it2 ].first, b2 = matches[ it2 ].second;
+      const float d1 = point_distance( F1[ a1 ], F1[ a2 ] );
+      const float d2 = point_distance( F2[ b1 ], F2[ b2 ] );
+      if( d1 > min_dist && d2 > min_dist )
+        sortedNeighbors.emplace_back( std::min( d1 / range1, d2 / range2 ), it2 );
+    }
+    if( kvldParameters.maxNeighbors > 0 && sortedNeighbors.size() > kvldParameters.maxNeighbors )
+    {
+      std::nth_element( sortedNeighbors.begin(), sortedNeighbors.begin() + kvldParameters.maxNeighbors, sortedNeighbors.end() );
+      sortedNeighbors.resize( kvldParameters.maxNeighbors );
+    }
+    std::sort( sortedNeighbors.begin(), sortedNeighbors.end() );
 
-    for( int a1 = 0; a1 < F1.size(); ++a1 )
-      for( int a2 = a1; a2 < F1.size(); ++a2 )
-        dist1( a1, a2 ) = dist1( a2, a1 ) = point_distance( F1[ a1 ], F1[ a2 ] );
+    neighbors[ it1 ].reserve( sortedNeighbors.size() );
+    for( const auto& neighbor : sortedNeighbors )
+      neighbors[ it1 ].push_back( neighbor.second );
+  }
 
-    for( int b1 = 0; b1 < F2.size(); ++b1 )
-      for( int b2 = b1; b2 < F2.size(); ++b2 )
-        dist2( b1, b2 ) = dist2( b2, b1 ) = point_distance( F2[ b1 ], F2[ b2 ] );
+  //================gvld-consistency of the neighbor pairs, -1=unknown, -2=false, >=0 consistency value===============//
+  // a pair of matches is verified once, even if both matches are neighbors of each other
+  std::vector< std::pair< int, int > > edges;
+  for( int it1 = 0; it1 < size; it1++ )
+    for( const int it2 : neighbors[ it1 ] )
+      edges.emplace_back( std::min( it1, it2 ), std::max( it1, it2 ) );
+  std::sort( edges.begin(), edges.end() );
+  edges.erase( std::unique( edges.begin(), edges.end() ), edges.end() );
+
+  std::vector< std::vector< int > > neighborEdges( size );
+  for( int it1 = 0; it1 < size; it1++ )
+  {
+    neighborEdges[ it1 ].reserve( neighbors[ it1 ].size() );
+    for( const int it2 : neighbors[ it1 ] )
+    {
+      const std::pair< int, int > edge( std::min( it1, it2 ), std::max( it1, it2 ) );
+      neighborEdges[ it1 ].push_back( int( std::lower_bound( edges.begin(), edges.end(), edge ) - edges.begin() ) );
+    }
   }
 
-  std::fill( valide.begin(), valide.end(), true );
+  std::vector< std::atomic< float > > edgeErrors( edges.size() );
+  for( std::size_t e = 0; e < edges.size(); ++e )
+    edgeErrors[ e ] = ( E != nullptr ) ? float( ( *E )( edges[ e ].first, edges[ e ].second ) ) : -1.f;
+
+  // std::vector<bool> cannot be read while being written from several threads
+  std::vector< char > valid( size, 1 );
   std::vector< double > scoretable( size, 0.0 );
   std::vector< size_t > result( size, 0 );
 
-
 //============main iteration formatch verification==========//
-//    cout<<"main iteration";
   bool change = true;
 
   while( change )
   {
     change = false;
 
-    std::fill( scoretable.begin(), scoretable.end(), 0.0 );
-    std::fill( result.begin(), result.end(), 0 );
-    //========substep 1: search foreach match its neighbors and verify if they are gvld-consistent ============//
-    for( int it1 = 0; it1 < size - 1; it1++ )
+    //========substep 1: verify foreach match if its neighbors, from the nearest, are gvld-consistent ============//
+    // a pair of matches may be verified concurrently by both matches, they store the same value
+    #pragma omp parallel for schedule(dynamic, 64)
+    for( int it1 = 0; it1 < size; it1++ )
     {
-      if( valide[ it1 ] )
-      {
-        size_t a1 = matches[ it1 ].first, b1 = matches[ it1 ].second;
+      result[ it1 ] = 0;
+      scoretable[ it1 ] = 0.0;
+      if( !valid[ it1 ] )
+        continue;
 
-        for( int it2 = it1 + 1; it2 < size; it2++ )
-          if(valide[ it2 ])
+      const size_t a1 = matches[ it1 ].first, b1 = matches[ it1 ].second;
+      for( std::size_t k = 0; k < neighbors[ it1 ].size(); ++k )
+      {
+        const int it2 = neighbors[ it1 ][ k ];
+        if( !valid[ it2 ] )
+          continue;
+
+        std::atomic< float >& edgeError = edgeErrors[ neighborEdges[ it1 ][ k ] ];
+        float error = edgeError.load( std::memory_order_relaxed );
+        if( error == -1 )
+        { //update E ifunknow
+          error = -2;
+          const size_t a2 = matches[ it2 ].first, b2 = matches[ it2 ].second;
+          if( !kvldParameters.geometry || consistent( F1[ a1 ], F1[ a2 ], F2[ b1 ], F2[ b2 ] ) < distance_thres )
           {
-            size_t a2 = matches[ it2 ].first, b2 = matches[ it2 ].second;
-
-            bool bOk = false;
-            if( bPrecomputedDist )
-              bOk = ( dist1( a1, a2 ) > min_dist && dist2( b1, b2 ) > min_dist
-                 && ( dist1( a1, a2 ) < range1   || dist2( b1, b2 ) < range2 ) );
-            else
-              bOk = ( point_distance( F1[ a1 ], F1[ a2 ] ) > min_dist && point_distance( F2[ b1 ], F2[ b2 ] ) > min_dist &&
-                    ( point_distance( F1[ a1 ], F1[ a2 ] ) < range1   || point_distance( F2[ b1 ], F2[ b2 ] ) < range2 ) );
-            if( bOk )
-            {
-              if( E( it1, it2 ) == -1 )
-              { //update E ifunknow
-                E( it1, it2 ) = -2;
-                E( it2, it1 ) = -2;
-
-                if( !kvldParameters.geometry || consistent( F1[ a1 ], F1[ a2 ], F2[ b1 ], F2[ b2 ] ) < distance_thres )
-                {
-                  VLD vld1( Chaine1, F1[ a1 ], F1[ a2 ] );
-                  VLD vld2( Chaine2, F2[ b1 ], F2[ b2 ] );
-                  //vld1.test();
-                  double error = vld1.difference( vld2 );
-                  //cout<<endl<<it1<<" "<<it2<<" "<<dist1(a1,a2)<<" "<< dist2(b1,b2)<<" "<<error<<endl;
-                  if( error < juge )
-                  {
-                    E( it1, it2 ) = ( float ) error;
-                    E( it2, it1 ) = ( float ) error;
-                    //cout<<E(it2,it1)<<endl;
-                  }
-                }
-              }
-              if( E( it1, it2 ) >= 0 )
-              {
-                result[ it1 ] += 1;
-                result[ it2 ] += 1;
-                scoretable[ it1 ] += double( E( it1, it2 ) );
-                scoretable[ it2 ] += double( E( it1, it2 ) );
-                if( result[ it1 ] >= max_connection )
-                  break;
-              }
-            }
+            const VLD vld1( Chaine1, F1[ a1 ], F1[ a2 ] );
+            const VLD vld2( Chaine2, F2[ b1 ], F2[ b2 ] );
+            const double difference = vld1.difference( vld2 );
+            if( difference < juge )
+              error = float( difference );
           }
+          edgeError.store( error, std::memory_order_relaxed );
+        }
+        if( error >= 0 )
+        {
+          result[ it1 ] += 1;
+          scoretable[ it1 ] += double( error );
+          if( result[ it1 ] >= max_connection )
+            break;
+        }
       }
     }
 
     //========substep 2: remove false matches by K gvld-consistency criteria ============//
     for( int it = 0; it < size; it++ )
     {
-      if( valide[ it ] && result[ it ] < kvldParameters.K )
+      if( valid[ it ] && result[ it ] < kvldParameters.K )
       {
-        valide[ it ] = false;
+        valid[ it ] = 0;
         change = true;
       }
     }
     //========substep 3: remove multiple matches to a same point by keeping the one with the best average gvld-consistency score ============//
+    // two matches conflict if they share a keypoint or a keypoint position in one image, but not in the other image.
+    // the candidates are the matches with a same keypoint position, grouped by sorting the positions.
     if( uniqueMatch )
-      for( int it1 = 0; it1 < size - 1; it1++ )
-        if( valide[ it1 ]) {
-          size_t a1 = matches[ it1 ].first;
-          size_t b1 = matches[ it1 ].second;
-
-          for( int it2 = it1 + 1; it2 < size; it2++ )
-            if( valide[ it2 ] )
+    {
+      std::vector< std::vector< int > > conflicts( size );
+      const auto samePosition = [&]( const feature::PointFeature& p1, const feature::PointFeature& p2 )
+      {
+        return p1.x() == p2.x() && p1.y() == p2.y();
+      };
+      const auto addConflicts = [&]( bool first )
+      {
+        std::vector< int > order;
+        for( int it = 0; it < size; it++ )
+          if( valid[ it ] )
+            order.push_back( it );
+        const auto position = [&]( int it ) -> const feature::PointFeature&
+        {
+          return first ? F1[ matches[ it ].first ] : F2[ matches[ it ].second ];
+        };
+        std::sort( order.begin(), order.end(), [&]( int i, int j )
+        {
+          const feature::PointFeature& pi = position( i );
+          const feature::PointFeature& pj = position( j );
+          return std::make_pair( pi.x(), pi.y() ) < std::make_pair( pj.x(), pj.y() );
+        });
+        for( std::size_t begin = 0, end = 0; begin < order.size(); begin = end )
+        {
+          end = begin + 1;
+          while( end < order.size() && samePosition( position( order[ begin ] ), position( order[ end ] ) ) )
+            ++end;
+          for( std::size_t i = begin; i < end; ++i )
+            for( std::size_t j = begin; j < end; ++j )
             {
-              size_t a2 = matches[ it2 ].first;
-              size_t b2 = matches[ it2 ].second;
-
-              if( a1 == a2 || b1 == b2
-                  || ( F1[ a1 ].x() == F1[ a2 ].x() && F1[ a1 ].y() == F1[ a2 ].y() &&
-                     ( F2[ b1 ].x() != F2[ b2 ].x() || F2[ b1 ].y() != F2[ b2 ].y() ) )
-                  || ( ( F1[ a1 ].x() != F1[ a2 ].x() || F1[ a1 ].y() != F1[ a2 ].y() ) &&
-                         F2[ b1 ].x() == F2[ b2 ].x() && F2[ b1 ].y() == F2[ b2 ].y() ) )
-              {
-                //cardinal comparison
-                if( result[ it1 ] > result[ it2 ] )
-                {
-                  valide[ it2 ] = false;
-                  change = true;
-                }
-                else if( result[ it1 ] < result[ it2 ] )
-                {
-                  valide[ it1 ] = false;
-                  change = true;
-                }
-                else if( result[ it1 ] == result[ it2 ] )
-                {
-                  //score comparison
-                  if( scoretable[ it1 ] > scoretable[ it2 ] )
-                  {
-                    valide[ it1 ] = false;
-                    change = true;
-                  }
-                  else if( scoretable[ it1 ] < scoretable[ it2 ] )
-                  {
-                    valide[ it2 ] = false;
-                    change = true;
-                  }
-                }
-              }
+              const int it1 = order[ i ], it2 = order[ j ];
+              if( it1 >= it2 )
+                continue;
+              const bool sameKeypoint = first ? matches[ it1 ].first == matches[ it2 ].first : matches[ it1 ].second == matches[ it2 ].second;
+              const bool sameOtherPosition = first ?
+                samePosition( F2[ matches[ it1 ].second ], F2[ matches[ it2 ].second ] ) :
+                samePosition( F1[ matches[ it1 ].first ], F1[ matches[ it2 ].first ] );
+              const bool sameOtherKeypoint = first ? matches[ it1 ].second == matches[ it2 ].second : matches[ it1 ].first == matches[ it2 ].first;
+              if( sameKeypoint || sameOtherKeypoint || !sameOtherPosition )
+                conflicts[ it1 ].push_back( it2 );
             }
         }
-    //========substep 4: ifgeometric verification is set, re-score matches by geometric-consistency, and remove poorly scored ones ============================//
-    if( uniqueMatch && kvldParameters.geometry )
-    {
-      for( int i = 0; i < size; i++ )
-        scoretable[ i ]=0;
-
-      std::vector< bool > switching;
-      for( int i = 0; i < size; i++ )
-        switching.push_back( false );
+      };
+      addConflicts( true );
+      addConflicts( false );
 
+      // the conflicts are resolved in the order of the matches
       for( int it1 = 0; it1 < size; it1++ )
       {
-        if( valide[ it1 ] )
+        if( !valid[ it1 ] )
+          continue;
+        std::vector< int >& it1Conflicts = conflicts[ it1 ];
+        std::sort( it1Conflicts.begin(), it1Conflicts.end() );
+        it1Conflicts.erase( std::unique( it1Conflicts.begin(), it1Conflicts.end() ), it1Conflicts.end() );
+
+        for( const int it2 : it1Conflicts )
         {
-          size_t a1 = matches[ it1 ].first, b1 = matches[ it1 ].second;
-          float index = 0.0f;
-          int good_index = 0;
-          for( int it2 = 0; it2 < size; it2++ )
+          if( !valid[ it2 ] )
+            continue;
+          //cardinal comparison
+          if( result[ it1 ] > result[ it2 ] )
           {
-            if( it1 != it2 && valide[ it2 ] )
-            {
-              size_t a2 = matches[ it2 ].first;
-              size_t b2 = matches[ it2 ].second;
-
-              bool bOk = false;
-              if( bPrecomputedDist )
-                bOk = ( dist1( a1, a2 ) > min_dist && dist2( b1, b2 ) > min_dist &&
-                      ( dist1( a1, a2 ) < range1   || dist2( b1, b2 ) < range2 ) );
-              else
-                bOk = ( point_distance( F1[ a1 ], F1[ a2 ] ) > min_dist && point_distance( F2[ b1 ], F2[ b2 ] ) > min_dist &&
-                      ( point_distance( F1[ a1 ], F1[ a2 ] ) < range1   || point_distance( F2[ b1 ], F2[ b2 ] ) < range2 ) );
-              if( bOk )
-              {
-                float d = consistent( F1[ a1 ], F1[ a2 ], F2[ b1 ], F2[ b2 ] );
-                scoretable[ it1 ] += d;
-                index += 1;
-                if( d < distance_thres )
-                  good_index++;
-              }
-            }
+            valid[ it2 ] = 0;
+            change = true;
           }
-          scoretable[ it1 ] /= index;
-          if( good_index < 0.3f * float( index ) && scoretable[ it1 ] > 1.2 )
+          else if( result[ it1 ] < result[ it2 ] )
           {
-            switching[ it1 ] = true;
+            valid[ it1 ] = 0;
             change = true;
           }
+          else
+          {
+            //score comparison
+            if( scoretable[ it1 ] > scoretable[ it2 ] )
+            {
+              valid[ it1 ] = 0;
+              change = true;
+            }
+            else if( scoretable[ it1 ] < scoretable[ it2 ] )
+            {
+              valid[ it2 ] = 0;
+              change = true;
+            }
+          }
         }
       }
+    }
+    //========substep 4: ifgeometric verification is set, re-score matches by geometric-consistency, and remove poorly scored ones ============================//
+    if( uniqueMatch && kvldParameters.geometry )
+    {
+      std::vector< char > switching( size, 0 );
+
+      #pragma omp parallel for schedule(dynamic, 64)
+      for( int it1 = 0; it1 < size; it1++ )
+      {
+        scoretable[ it1 ] = 0;
+        if( !valid[ it1 ] )
+          continue;
+
+        const size_t a1 = matches[ it1 ].first, b1 = matches[ it1 ].second;
+        float index = 0.0f;
+        int good_index = 0;
+        for( const int it2 : neighbors[ it1 ] )
+        {
+          if( !valid[ it2 ] )
+            continue;
+          const size_t a2 = matches[ it2 ].first;
+          const size_t b2 = matches[ it2 ].second;
+          const float d = consistent( F1[ a1 ], F1[ a2 ], F2[ b1 ], F2[ b2 ] );
+          scoretable[ it1 ] += d;
+          index += 1;
+          if( d < distance_thres )
+            good_index++;
+        }
+        if( index > 0 )
+          scoretable[ it1 ] /= index;
+        if( good_index < 0.3f * float( index ) && scoretable[ it1 ] > 1.2 )
+          switching[ it1 ] = 1;
+      }
       for( int it1 = 0; it1 < size; it1++ )
         if( switching[ it1 ] )
-          valide[ it1 ] = false;
+        {
+          valid[ it1 ] = 0;
+          change = true;
+        }
     }
   }
+
+  if( E != nullptr )
+    for( std::size_t e = 0; e < edges.size(); ++e )
+      ( *E )( edges[ e ].first, edges[ e ].second ) = ( *E )( edges[ e ].second, edges[ e ].first ) = edgeErrors[ e ].load();
+
   //=============== generating output list ===================//
   for( int it = 0; it < size; it++ )
-    if( valide[ it ] )
+  {
+    valide[ it ] = valid[ it ];
+    if( valid[ it ] )
     {
       matchesFiltered.push_back( matches[ it ] );
       score.push_back( scoretable[ it ] );
     }
+  }
   return float( matchesFiltered.size() ) / matches.size();
 }
 
+} // namespace
+
+float KVLD( const Image< float >& I1,
+            const Image< float >& I2,
+            const std::vector<feature::PointFeature> & F1,
+            const std::vector<feature::PointFeature> & F2,
+            const std::vector< Pair >& matches,
+            std::vector< Pair >& matchesFiltered,
+            std::vector< double >& score,
+            aliceVision::Mat& E,
+            std::vector< bool >& valide,
+            KvldParameters& kvldParameters )
+{
+  const ImageScale Chaine1( I1 );
+  const ImageScale Chaine2( I2 );
+
+  ALICEVISION_LOG_TRACE("Image scale-space complete...");
+
+  return kvldImpl( Chaine1, Chaine2, F1, F2, matches, matchesFiltered, score, &E, valide, kvldParameters );
+}
+
+float KVLD( const ImageScale& scale1,
+            const ImageScale& scale2,
+            const std::vector<feature::PointFeature> & F1,
+            const std::vector<feature::PointFeature> & F2,
+            const std::vector< Pair >& matches,
+            std::vector< Pair >& matchesFiltered,
+            std::vector< double >& score,
+            std::vector< bool >& valide,
+            KvldParameters& kvldParameters )
+{
+  return kvldImpl( scale1, scale2, F1, F2, matches, matchesFiltered, score, nullptr, valide, kvldParameters );
+}
+
 double VLD::get_orientation() const
 {
     const float dy = end_point[1] - begin_point[1];
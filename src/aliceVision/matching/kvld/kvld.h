@@ -44,12 +44,14 @@
 // K: the minimum number of gvld-consistent (or vld-consistent) neighbors to select a match as correct one
 // geometry: if true, KVLD will also take geometric verification into account. c.f. paper
 //           if false, KVLD execute a pure photometric verification
+// maxNeighbors: if not 0, only the maxNeighbors nearest neighbor matches of a match are verified, which bounds the cost on dense matches
 struct KvldParameters
 {
   float inlierRate;
   size_t K;
   bool geometry;
-  KvldParameters(): inlierRate( 0.04 ), K( 3 ), geometry( true ){};
+  size_t maxNeighbors;
+  KvldParameters(): inlierRate( 0.04 ), K( 3 ), geometry( true ), maxNeighbors( 0 ){};
 };
 
 //====== Pyramid of scale images ======//
@@ -155,7 +157,9 @@ public:
 //valide: indices of whether the i th match in the initial match list is selected, for illustration reason, it has been externalized as an input of KVLD. it should be initialized to be a
 //    matches.size vector with all equal to true.  e.g.  std::vector<bool> valide(size, true);
 //
-//kvldParameters: container of minimum inlier rate, the value of K (=3 initially) and geometric verification flag (true initially)
+//kvldParameters: container of minimum inlier rate, the value of K (=3 initially), geometric verification flag (true initially) and neighbors limit
+//
+//The neighbors of each match are found with a grid on the keypoints of both images, and the matches are verified in parallel.
 
 float KVLD(const aliceVision::image::Image< float >& I1,
   const aliceVision::image::Image< float >& I2,
@@ -168,4 +172,16 @@ float KVLD(const aliceVision::image::Image< float >& I1,
   std::vector< bool >& valide,
   KvldParameters& kvldParameters );
 
+//Same as above, with the scale images precomputed, e.g. to share the scale images of a view between its image pairs.
+//The gvld-consistency is only kept for the neighbor matches, so there is no size*size consistency matrix.
+float KVLD(const ImageScale& scale1,
+  const ImageScale& scale2,
+  const std::vector<aliceVision::feature::PointFeature> & F1,
+  const std::vector<aliceVision::feature::PointFeature> & F2,
+  const std::vector< aliceVision::Pair >& matches,
+  std::vector< aliceVision::Pair >& matchesFiltered,
+  std::vector< double >& score,
+  std::vector< bool >& valide,
+  KvldParameters& kvldParameters );
+
 #endif //KVLD_H
@@ -0,0 +1,114 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/matching/kvld/kvld.h>
+
+#include <random>
+
+#define BOOST_TEST_MODULE kvld
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+
+namespace {
+
+// textured image, shifted by (dx, dy)
+image::Image<float> texture(int width, int height, float dx, float dy)
+{
+  image::Image<float> image(width, height);
+  for(int y = 0; y < height; ++y)
+  {
+    for(int x = 0; x < width; ++x)
+    {
+      const float u = x - dx;
+      const float v = y - dy;
+      image(y, x) = 128.f + 40.f * std::sin(0.21f * u) * std::cos(0.13f * v) + 30.f * std::sin(0.07f * u + 0.17f * v)
+                    + 20.f * std::cos(0.31f * u * std::sin(0.05f * v));
+    }
+  }
+  return image;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(KVLD_rejectOutliers)
+{
+  const float dx = 7.f;
+  const float dy = 4.f;
+  const image::Image<float> image1 = texture(320, 240, 0.f, 0.f);
+  const image::Image<float> image2 = texture(320, 240, dx, dy);
+
+  std::vector<feature::PointFeature> features1, features2;
+  for(int y = 20; y < 220; y += 13)
+  {
+    for(int x = 20; x < 300; x += 13)
+    {
+      features1.emplace_back(x, y, 2.f, 0.f);
+      features2.emplace_back(x + dx, y + dy, 2.f, 0.f);
+    }
+  }
+
+  // the first matches are inliers, the last ones are random pairs
+  const std::size_t nbInliers = features1.size();
+  std::vector<Pair> matches;
+  for(std::size_t i = 0; i < nbInliers; ++i)
+    matches.emplace_back(i, i);
+
+  std::mt19937 randomNumberGenerator(0);
+  std::uniform_int_distribution<std::size_t> featureDistribution(0, features1.size() - 1);
+  const std::size_t nbOutliers = nbInliers / 5;
+  for(std::size_t i = 0; i < nbOutliers; ++i)
+  {
+    const std::size_t a = featureDistribution(randomNumberGenerator);
+    std::size_t b = featureDistribution(randomNumberGenerator);
+    if(a == b)
+      b = (b + 1) % features1.size();
+    matches.emplace_back(a, b);
+  }
+
+  // dense consistency matrix
+  {
+    KvldParameters parameters;
+    std::vector<Pair> matchesFiltered;
+    std::vector<double> score;
+    Mat E = Mat::Ones(matches.size(), matches.size()) * (-1);
+    std::vector<bool> valide(matches.size(), true);
+
+    KVLD(image1, image2, features1, features2, matches, matchesFiltered, score, E, valide, parameters);
+
+    std::size_t nbValidInliers = 0;
+    for(std::size_t i = 0; i < nbInliers; ++i)
+      nbValidInliers += valide[i];
+    for(std::size_t i = nbInliers; i < matches.size(); ++i)
+      BOOST_CHECK(!valide[i]);
+    BOOST_CHECK_GT(nbValidInliers, nbInliers * 0.8);
+    BOOST_CHECK_EQUAL(matchesFiltered.size(), nbValidInliers);
+    BOOST_CHECK_EQUAL(score.size(), matchesFiltered.size());
+  }
+
+  // precomputed scale images and limited neighbors
+  {
+    const ImageScale scale1(image1);
+    const ImageScale scale2(image2);
+
+    KvldParameters parameters;
+    parameters.maxNeighbors = 8;
+    std::vector<Pair> matchesFiltered;
+    std::vector<double> score;
+    std::vector<bool> valide;
+
+    KVLD(scale1, scale2, features1, features2, matches, matchesFiltered, score, valide, parameters);
+
+    BOOST_REQUIRE_EQUAL(valide.size(), matches.size());
+    std::size_t nbValidInliers = 0;
+    for(std::size_t i = 0; i < nbInliers; ++i)
+      nbValidInliers += valide[i];
+    for(std::size_t i = nbInliers; i < matches.size(); ++i)
+      BOOST_CHECK(!valide[i]);
+    BOOST_CHECK_GT(nbValidInliers, nbInliers * 0.8);
+  }
+}
@@ -9,6 +9,8 @@
 #include "aliceVision/matching/ArrayMatcher_bruteForce.hpp"
 #include "aliceVision/matching/ArrayMatcher_kdtreeFlann.hpp"
 #include "aliceVision/matching/ArrayMatcher_cascadeHashing.hpp"
+#include "aliceVision/matching/ArrayMatcher_productQuantization.hpp"
+#include "aliceVision/matching/HashedDescriptionsIO.hpp"
 #include <iostream>
 
 #define BOOST_TEST_MODULE matching
@@ -169,3 +171,143 @@ BOOST_AUTO_TEST_CASE(Matching_Cascade_Hashing_Simple_EmptyArrays)
   float fDistance = -1.0f;
   BOOST_CHECK(! matcher.SearchNeighbour( &array[0], &nIndice, &fDistance) );
 }
+
+BOOST_AUTO_TEST_CASE(Matching_Cascade_Hashing_ReusedBuffers)
+{
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<float> distribution(0.f, 1.f);
+  typedef Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> MatrixT;
+
+  const int dimension = 128;
+  MatrixT database(500, dimension);
+  for(int i = 0; i < database.size(); ++i)
+    database.data()[i] = distribution(gen);
+
+  CascadeHasher cascadeHasher;
+  cascadeHasher.Init(gen, dimension);
+  const Eigen::VectorXf zeroMean = CascadeHasher::GetZeroMeanDescriptor(database);
+  const HashedDescriptions hashedDatabase = cascadeHasher.CreateHashedDescriptions(database, zeroMean);
+
+  // the same buffers are reused for queries of different sizes
+  CascadeHasher::MatchingBuffers buffers;
+  for(const int nbQueries : {50, 300, 10})
+  {
+    MatrixT queries(nbQueries, dimension);
+    for(int i = 0; i < nbQueries; ++i)
+      queries.row(i) = database.row(i * 7 % database.rows()) + 0.01f * MatrixT::Random(1, dimension);
+    const HashedDescriptions hashedQueries = cascadeHasher.CreateHashedDescriptions(queries, zeroMean);
+
+    IndMatches indices, indicesReused;
+    std::vector<float> distances, distancesReused;
+    cascadeHasher.Match_HashedDescriptions<MatrixT, float>(hashedQueries, queries, hashedDatabase, database, &indices, &distances);
+    cascadeHasher.Match_HashedDescriptions<MatrixT, float>(hashedQueries, queries, hashedDatabase, database, buffers, &indicesReused, &distancesReused);
+
+    BOOST_CHECK(!indices.empty());
+    BOOST_CHECK(indices == indicesReused);
+    BOOST_CHECK(distances == distancesReused);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Matching_Cascade_Hashing_SaveLoadHashedDescriptions)
+{
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<float> distribution(0.f, 1.f);
+  typedef Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> MatrixT;
+
+  const int dimension = 128;
+  MatrixT descriptors(200, dimension);
+  for(int i = 0; i < descriptors.size(); ++i)
+    descriptors.data()[i] = distribution(gen);
+
+  CascadeHasher cascadeHasher;
+  cascadeHasher.Init(gen, dimension);
+  const Eigen::VectorXf zeroMean = CascadeHasher::GetZeroMeanDescriptor(descriptors);
+  const HashedDescriptions hashed = cascadeHasher.CreateHashedDescriptions(descriptors, zeroMean);
+
+  HashedDescriptionsCacheKey key;
+  key.descriptorsHash = computeDataHash(descriptors.data(), descriptors.size() * sizeof(float));
+  key.zeroMeanHash = computeDataHash(zeroMean.data(), zeroMean.size() * sizeof(float));
+  key.hasherSeed = 0;
+  key.nbHashCode = cascadeHasher.getNbHashCode();
+  key.nbBucketGroups = cascadeHasher.getNbBucketGroups();
+  key.nbBitsPerBucket = cascadeHasher.getNbBitsPerBucket();
+
+  const std::string filepath = "tempHashedDescriptions.hashedDesc";
+  BOOST_CHECK(saveHashedDescriptions(filepath, key, hashed));
+
+  HashedDescriptions loaded;
+  BOOST_CHECK(loadHashedDescriptions(filepath, key, cascadeHasher, loaded));
+  BOOST_CHECK_EQUAL(loaded.hashed_desc.size(), hashed.hashed_desc.size());
+  BOOST_CHECK(loaded.buckets == hashed.buckets);
+  for(std::size_t i = 0; i < hashed.hashed_desc.size(); ++i)
+  {
+    BOOST_CHECK(loaded.hashed_desc[i].bucket_ids == hashed.hashed_desc[i].bucket_ids);
+    BOOST_CHECK_EQUAL(loaded.hashed_desc[i].hash_code.size(), hashed.hashed_desc[i].hash_code.size());
+    for(std::size_t b = 0; b < hashed.hashed_desc[i].hash_code.num_blocks(); ++b)
+      BOOST_CHECK_EQUAL(loaded.hashed_desc[i].hash_code.data()[b], hashed.hashed_desc[i].hash_code.data()[b]);
+  }
+
+  // an outdated cache is not loaded
+  HashedDescriptionsCacheKey otherKey = key;
+  otherKey.hasherSeed = 1;
+  BOOST_CHECK(!loadHashedDescriptions(filepath, otherKey, cascadeHasher, loaded));
+
+  Eigen::VectorXf loadedZeroMean;
+  BOOST_CHECK(saveZeroMeanDescriptor("tempHashedDescriptions.zeroMean", zeroMean));
+  BOOST_CHECK(loadZeroMeanDescriptor("tempHashedDescriptions.zeroMean", dimension, loadedZeroMean));
+  BOOST_CHECK(loadedZeroMean == zeroMean);
+  BOOST_CHECK(!loadZeroMeanDescriptor("tempHashedDescriptions.zeroMean", dimension + 1, loadedZeroMean));
+}
+
+BOOST_AUTO_TEST_CASE(Matching_ProductQuantization_Simple_EmptyArrays)
+{
+  std::mt19937 gen(0);
+
+  std::vector<float> array;
+  ArrayMatcher_productQuantization<float> matcher;
+  BOOST_CHECK(! matcher.Build(gen, array.data(), 0, 4) );
+
+  int nIndice = -1;
+  float fDistance = -1.0f;
+  BOOST_CHECK(! matcher.SearchNeighbour( array.data(), &nIndice, &fDistance) );
+}
+
+BOOST_AUTO_TEST_CASE(Matching_ProductQuantization_NN)
+{
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<float> distribution(0.f, 1.f);
+  typedef Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> MatrixT;
+
+  const int dimension = 128;
+  MatrixT database(1000, dimension);
+  for(int i = 0; i < database.size(); ++i)
+    database.data()[i] = distribution(gen);
+
+  ArrayMatcher_productQuantization<float> matcher;
+  BOOST_CHECK( matcher.Build(gen, database.data(), database.rows(), dimension) );
+
+  // 16 bytes per descriptor
+  BOOST_CHECK_EQUAL(matcher.getCodesSize(), database.rows() * 16);
+
+  // the queries are noisy copies of the database descriptors
+  const int nbQueries = 100;
+  MatrixT queries(nbQueries, dimension);
+  for(int i = 0; i < nbQueries; ++i)
+    queries.row(i) = database.row(i * 7) + 0.01f * MatrixT::Random(1, dimension);
+
+  IndMatches indices;
+  std::vector<float> distances;
+  BOOST_CHECK( matcher.SearchNeighbours(queries.data(), nbQueries, &indices, &distances, 2) );
+  BOOST_CHECK_EQUAL(indices.size(), nbQueries * 2);
+  BOOST_CHECK_EQUAL(distances.size(), nbQueries * 2);
+
+  int nbFound = 0;
+  for(int i = 0; i < nbQueries; ++i)
+  {
+    BOOST_CHECK_EQUAL(indices[2 * i]._i, i);
+    BOOST_CHECK_LE(distances[2 * i], distances[2 * i + 1]);
+    if(indices[2 * i]._j == i * 7)
+      ++nbFound;
+  }
+  BOOST_CHECK_GE(nbFound, 90);
+}
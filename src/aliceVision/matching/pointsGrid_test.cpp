@@ -0,0 +1,93 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/matching/PointsGrid.hpp>
+
+#include <random>
+#include <set>
+#include <vector>
+
+#define BOOST_TEST_MODULE PointsGrid
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::matching;
+
+namespace {
+
+std::vector<Vec2> randomPoints(std::size_t nbPoints, double width, double height, std::mt19937& generator)
+{
+  std::uniform_real_distribution<double> distributionX(0.0, width);
+  std::uniform_real_distribution<double> distributionY(0.0, height);
+  std::vector<Vec2> points(nbPoints);
+  for(Vec2& point : points)
+    point = Vec2(distributionX(generator), distributionY(generator));
+  return points;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(PointsGrid_disk)
+{
+  std::mt19937 generator(42);
+  const std::vector<Vec2> points = randomPoints(5000, 1920.0, 1080.0, generator);
+  const double radius = 4.0;
+  const PointsGrid grid(points, PointsGrid::getCellSize(points, radius));
+  BOOST_CHECK_EQUAL(grid.size(), points.size());
+
+  std::vector<IndexT> candidates;
+  for(std::size_t q = 0; q < 100; ++q)
+  {
+    const Vec2 center = points[q] + Vec2(1.0, -2.0);
+    grid.getPointsInDisk(center, radius, candidates);
+
+    const std::set<IndexT> candidatesSet(candidates.begin(), candidates.end());
+    BOOST_CHECK_EQUAL(candidatesSet.size(), candidates.size());
+    BOOST_CHECK_LT(candidates.size(), points.size() / 10);
+
+    // all the points in the disk are candidates
+    for(std::size_t i = 0; i < points.size(); ++i)
+    {
+      if((points[i] - center).norm() <= radius)
+        BOOST_CHECK(candidatesSet.count(i));
+    }
+  }
+
+  // a disk out of the points
+  grid.getPointsInDisk(Vec2(-100.0, -100.0), radius, candidates);
+  BOOST_CHECK(candidates.empty());
+}
+
+BOOST_AUTO_TEST_CASE(PointsGrid_line)
+{
+  std::mt19937 generator(7);
+  const std::vector<Vec2> points = randomPoints(5000, 1920.0, 1080.0, generator);
+  const double halfWidth = 2.0;
+  const PointsGrid grid(points, PointsGrid::getCellSize(points, halfWidth));
+
+  std::uniform_real_distribution<double> distributionAngle(0.0, M_PI);
+  std::vector<IndexT> candidates;
+  for(std::size_t q = 0; q < 100; ++q)
+  {
+    // a line through a point, horizontal and vertical ones included
+    const double angle = (q < 2) ? q * M_PI / 2.0 : distributionAngle(generator);
+    const Vec2 normal(std::cos(angle), std::sin(angle));
+    const Vec3 line(normal(0), normal(1), -normal.dot(points[q]));
+    grid.getPointsNearLine(3.0 * line, halfWidth, candidates);
+
+    const std::set<IndexT> candidatesSet(candidates.begin(), candidates.end());
+    BOOST_CHECK_EQUAL(candidatesSet.size(), candidates.size());
+    BOOST_CHECK_LT(candidates.size(), points.size() / 4);
+
+    // all the points of the band are candidates
+    for(std::size_t i = 0; i < points.size(); ++i)
+    {
+      if(std::abs(line.dot(Vec3(points[i](0), points[i](1), 1.0))) <= halfWidth)
+        BOOST_CHECK(candidatesSet.count(i));
+    }
+  }
+}
@@ -9,6 +9,17 @@
 namespace aliceVision {
 namespace matchingImageCollection {
 
+bool isPoorlyOverlappingImagePair(const MatchesPerDescType& geometricMatches,
+                                  const MatchesPerDescType& putativeMatches,
+                                  float minimumRatio,
+                                  std::size_t minimumGeometricCount)
+{
+    const size_t photometricCount = putativeMatches.getNbAllMatches();
+    const size_t geometricCount = geometricMatches.getNbAllMatches();
+    const float ratio = geometricCount / (float)photometricCount;
+    return geometricCount < minimumGeometricCount || ratio < minimumRatio;
+}
+
 void removePoorlyOverlappingImagePairs(PairwiseMatches& geometricMatches,
                                        const PairwiseMatches& putativeMatches,
                                        float minimumRatio,
@@ -17,10 +28,7 @@ void removePoorlyOverlappingImagePairs(PairwiseMatches& geometricMatches,
     std::vector<PairwiseMatches::key_type> toRemoveVec;
     for (const auto& match : geometricMatches)
     {
-        const size_t photometricCount = putativeMatches.find(match.first)->second.getNbAllMatches();
-        const size_t geometricCount = match.second.getNbAllMatches();
-        const float ratio = geometricCount / (float)photometricCount;
-        if (geometricCount < minimumGeometricCount || ratio < minimumRatio) {
+        if (isPoorlyOverlappingImagePair(match.second, putativeMatches.find(match.first)->second, minimumRatio, minimumGeometricCount)) {
             toRemoveVec.push_back(match.first); // the image pair will be removed
         }
     }
@@ -12,9 +12,13 @@
 #include <aliceVision/feature/RegionsPerView.hpp>
 #include <aliceVision/matching/IndMatch.hpp>
 #include <aliceVision/matchingImageCollection/GeometricFilterMatrix.hpp>
+#include <aliceVision/system/Profiler.hpp>
 #include <aliceVision/system/ProgressDisplay.hpp>
 
+#include <algorithm>
+#include <functional>
 #include <map>
+#include <mutex>
 #include <random>
 #include <vector>
 
@@ -28,7 +32,14 @@ using namespace aliceVision::matching;
  * or all the pairs and regions correspondences contained in the putativeMatches set.
  * Allow to keep only geometrically coherent matches.
  * It discards pairs that do not lead to a valid robust model estimation.
- * @param[out] geometricMatches
+ *
+ * The pairs are estimated in parallel from the pair with the most putative matches, so the
+ * longest estimations do not end the loop. Each pair has its own random number generator
+ * seeded from \p randomNumberGenerator, so the results do not depend on the scheduling.
+ *
+ * @param[in] onPairFiltered called for each pair as soon as it is estimated, with its inliers or
+ *            no matches if the pair is discarded. It is called from the worker threads,
+ *            so it must be thread-safe, and it may move the inliers.
  * @param[in] sfmData
  * @param[in] regionsPerView
  * @param[in] functor
@@ -39,7 +50,7 @@ using namespace aliceVision::matching;
  */
 template<typename GeometryFunctor>
 void robustModelEstimation(
-  PairwiseMatches& out_geometricMatches,
+  const std::function<void(const Pair&, MatchesPerDescType&)>& onPairFiltered,
   const sfmData::SfMData* sfmData,
   const feature::RegionsPerView& regionsPerView,
   const GeometryFunctor& functor,
@@ -49,27 +60,40 @@ void robustModelEstimation(
   const double distanceRatio = 0.6
   )
 {
-  out_geometricMatches.clear();
+  ALICEVISION_PROFILE_ZONE("geometricFiltering");
+
+  // the pairs from the most putative matches, with the seed of their estimation
+  std::vector<std::pair<PairwiseMatches::const_iterator, std::size_t>> pairs;
+  pairs.reserve(putativeMatches.size());
+  for(auto it = putativeMatches.begin(); it != putativeMatches.end(); ++it)
+    pairs.emplace_back(it, it->second.getNbAllMatches());
+  std::stable_sort(pairs.begin(), pairs.end(), [](const std::pair<PairwiseMatches::const_iterator, std::size_t>& a,
+                                                  const std::pair<PairwiseMatches::const_iterator, std::size_t>& b)
+  {
+    return a.second > b.second;
+  });
+
+  std::vector<std::mt19937::result_type> seeds(pairs.size());
+  for(std::size_t i = 0; i < pairs.size(); ++i)
+    seeds[i] = randomNumberGenerator();
 
   auto progressDisplay =
           system::createConsoleProgressDisplay(putativeMatches.size(), std::cout,
                                                "Robust Model Estimation\n");
   
-#pragma omp parallel for schedule(dynamic)
-  for (int i = 0; i < (int)putativeMatches.size(); ++i)
+  // a single pair is filtered outside of a parallel region, its robust estimation can use the threads
+#pragma omp parallel for schedule(dynamic, 1) if(pairs.size() > 1)
+  for (int i = 0; i < (int)pairs.size(); ++i)
   {
-    PairwiseMatches::const_iterator iter = putativeMatches.begin();
-    std::advance(iter, i);
-
-    const Pair currentPair = iter->first;
-    const MatchesPerDescType& putativeMatchesPerType = iter->second;
-    const Pair& imagePair = iter->first;
+    const Pair& imagePair = pairs[i].first->first;
+    const MatchesPerDescType& putativeMatchesPerType = pairs[i].first->second;
+    std::mt19937 pairRandomNumberGenerator(seeds[i]);
 
     // apply the geometric filter (robust model estimation)
     {
       MatchesPerDescType inliers;
       GeometryFunctor geometricFilter = functor; // use a copy since we are in a multi-thread context
-      const EstimationStatus state = geometricFilter.geometricEstimation(sfmData, regionsPerView, imagePair, putativeMatchesPerType, randomNumberGenerator, inliers);
+      const EstimationStatus state = geometricFilter.geometricEstimation(sfmData, regionsPerView, imagePair, putativeMatchesPerType, pairRandomNumberGenerator, inliers);
       if(state.hasStrongSupport)
       {
         if(guidedMatching)
@@ -79,18 +103,62 @@ void robustModelEstimation(
           //ALICEVISION_LOG_DEBUG("#before/#after: " << putative_inliers.size() << "/" << guided_geometric_inliers.size());
           std::swap(inliers, guidedGeometricInliers);
         }
-
-#pragma omp critical
-        {
-          out_geometricMatches.emplace(currentPair, std::move(inliers));
-        }
-
       }
+      else
+      {
+        inliers.clear();
+      }
+      onPairFiltered(imagePair, inliers);
     }
     ++progressDisplay;
   }
 }
 
+/**
+ * @brief Perform robust model estimation (with optional guided_matching)
+ * or all the pairs and regions correspondences contained in the putativeMatches set,
+ * and collect the geometrically coherent matches of the valid pairs.
+ * @param[out] geometricMatches
+ * @see robustModelEstimation above for the other parameters
+ */
+template<typename GeometryFunctor>
+void robustModelEstimation(
+  PairwiseMatches& out_geometricMatches,
+  const sfmData::SfMData* sfmData,
+  const feature::RegionsPerView& regionsPerView,
+  const GeometryFunctor& functor,
+  const PairwiseMatches& putativeMatches,
+  std::mt19937 & randomNumberGenerator,
+  const bool guidedMatching = false,
+  const double distanceRatio = 0.6
+  )
+{
+  out_geometricMatches.clear();
+
+  std::mutex geometricMatchesMutex;
+  robustModelEstimation(
+    [&](const Pair& imagePair, MatchesPerDescType& inliers)
+    {
+      if(inliers.empty())
+        return;
+      std::lock_guard<std::mutex> lock(geometricMatchesMutex);
+      out_geometricMatches.emplace(imagePair, std::move(inliers));
+    },
+    sfmData, regionsPerView, functor, putativeMatches, randomNumberGenerator, guidedMatching, distanceRatio);
+}
+
+/**
+ * @brief Check if an image pair has a poor overlap according to the supplied criteria.
+ * @param geometricMatches The geometric matches of the image pair
+ * @param putativeMatches The putative matches of the image pair
+ * @param minimumRatio Minimum ratio of geometric to putative matches for image pair
+ * @param minimumCount Minimum count of geometric matches for image pair
+ */
+bool isPoorlyOverlappingImagePair(const MatchesPerDescType& geometricMatches,
+                                  const MatchesPerDescType& putativeMatches,
+                                  float minimumRatio,
+                                  std::size_t minimumGeometricCount);
+
 /**
  * @brief removePoorlyOverlappingImagePairs Removes image pairs from the given list of geometric
  *  matches that have poor overlap according to the supplied criteria.
@@ -0,0 +1,131 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "GeometricFilterKVLD.hpp"
+#include <aliceVision/image/io.hpp>
+#include <aliceVision/matching/kvld/kvld.h>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/ProgressDisplay.hpp>
+
+#include <exception>
+#include <vector>
+
+namespace aliceVision {
+namespace matchingImageCollection {
+
+namespace {
+
+/// the KVLD thresholds are set for 8-bit intensities
+image::Image<float> readKvldImage(const sfmData::View& view)
+{
+  image::Image<unsigned char> image;
+  image::readImage(view.getImagePath(), image, image::EImageColorSpace::SRGB);
+  return image::Image<float>(image.GetMat().cast<float>());
+}
+
+void filterPair(const ImageScale& scale1,
+                const ImageScale& scale2,
+                const feature::RegionsPerView& regionsPerView,
+                const Pair& imagePair,
+                const matching::MatchesPerDescType& putativeMatchesPerDesc,
+                std::size_t maxNeighbors,
+                matching::MatchesPerDescType& filteredMatchesPerDesc)
+{
+  for(const auto& putativeMatches : putativeMatchesPerDesc)
+  {
+    const feature::EImageDescriberType descType = putativeMatches.first;
+    const std::vector<feature::PointFeature>& features1 = regionsPerView.getRegions(imagePair.first, descType).Features();
+    const std::vector<feature::PointFeature>& features2 = regionsPerView.getRegions(imagePair.second, descType).Features();
+
+    std::vector<Pair> matches;
+    matches.reserve(putativeMatches.second.size());
+    for(const matching::IndMatch& match : putativeMatches.second)
+      matches.emplace_back(match._i, match._j);
+
+    std::vector<Pair> matchesFiltered;
+    std::vector<double> score;
+    std::vector<bool> valid;
+
+    // same relaxation as the color harmonization when the inlier rate is low
+    KvldParameters kvldParameters;
+    kvldParameters.maxNeighbors = maxNeighbors;
+    for(int iteration = 0; iteration < 5 &&
+        kvldParameters.inlierRate > KVLD(scale1, scale2, features1, features2, matches, matchesFiltered, score, valid, kvldParameters);
+        ++iteration)
+    {
+      kvldParameters.inlierRate /= 2;
+      kvldParameters.K = 2;
+    }
+
+    matching::IndMatches& filteredMatches = filteredMatchesPerDesc[descType];
+    for(std::size_t i = 0; i < matches.size(); ++i)
+      if(valid[i])
+        filteredMatches.push_back(putativeMatches.second[i]);
+    if(filteredMatches.empty())
+      filteredMatchesPerDesc.erase(descType);
+  }
+}
+
+} // namespace
+
+void kvldFiltering(const std::function<void(const Pair&, matching::MatchesPerDescType&)>& onPairFiltered,
+                   const sfmData::SfMData& sfmData,
+                   const feature::RegionsPerView& regionsPerView,
+                   const matching::PairwiseMatches& putativeMatches,
+                   std::size_t maxNeighbors)
+{
+  auto progressDisplay = system::createConsoleProgressDisplay(putativeMatches.size(), std::cout, "KVLD filtering\n");
+
+  // the pairs are sorted, the pairs sharing a first view are consecutive
+  for(auto groupBegin = putativeMatches.begin(); groupBegin != putativeMatches.end();)
+  {
+    std::vector<matching::PairwiseMatches::const_iterator> group;
+    auto groupEnd = groupBegin;
+    for(; groupEnd != putativeMatches.end() && groupEnd->first.first == groupBegin->first.first; ++groupEnd)
+      group.push_back(groupEnd);
+
+    const ImageScale scale1(readKvldImage(sfmData.getView(groupBegin->first.first)));
+
+    std::exception_ptr error;
+
+    // with a single pair, the scale images and the KVLD are parallelized instead
+    #pragma omp parallel for schedule(dynamic) if(group.size() > 1)
+    for(int i = 0; i < static_cast<int>(group.size()); ++i)
+    {
+      const Pair& imagePair = group[i]->first;
+      try
+      {
+        const ImageScale scale2(readKvldImage(sfmData.getView(imagePair.second)));
+
+        matching::MatchesPerDescType filteredMatches;
+        filterPair(scale1, scale2, regionsPerView, imagePair, group[i]->second, maxNeighbors, filteredMatches);
+
+        ALICEVISION_LOG_DEBUG("KVLD filtering of the image pair (" << imagePair.first << ", " << imagePair.second << "): "
+                              << filteredMatches.getNbAllMatches() << " / " << group[i]->second.getNbAllMatches() << " matches kept.");
+        onPairFiltered(imagePair, filteredMatches);
+      }
+      catch(...)
+      {
+        ALICEVISION_LOG_ERROR("KVLD filtering of the image pair (" << imagePair.first << ", " << imagePair.second << ") failed.");
+        #pragma omp critical(kvldFilteringError)
+        {
+          if(!error)
+            error = std::current_exception();
+        }
+      }
+      ++progressDisplay;
+    }
+
+    // exceptions cannot leave the OpenMP region
+    if(error)
+      std::rethrow_exception(error);
+
+    groupBegin = groupEnd;
+  }
+}
+
+} // namespace matchingImageCollection
+} // namespace aliceVision
@@ -0,0 +1,42 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/feature/RegionsPerView.hpp>
+#include <aliceVision/matching/IndMatch.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+
+#include <cstddef>
+#include <functional>
+
+namespace aliceVision {
+namespace matchingImageCollection {
+
+/**
+ * @brief Photometric and geometric filtering of the putative matches of all the pairs with KVLD
+ * (K-Virtual Line Descriptor [Z.Liu, 2012]): a match is kept if the virtual lines to K of its neighbor
+ * matches have similar descriptors in both images.
+ *
+ * The pairs sharing a first view are filtered in parallel, the gradient scale images of this view are computed once for all of them.
+ *
+ * @param[in] onPairFiltered called for each pair with its kept matches, or no matches if none are kept.
+ *            It is called from the worker threads, so it must be thread-safe, and it may move the matches.
+ * @param[in] sfmData the views of the pairs, to read their images
+ * @param[in] regionsPerView
+ * @param[in] putativeMatches
+ * @param[in] maxNeighbors the number of nearest neighbor matches verified for each match, 0 for all the matches in the KVLD range
+ *            (the KvldParameters default)
+ * @throw the first image reading error, after the other pairs of the group are filtered
+ */
+void kvldFiltering(const std::function<void(const Pair&, matching::MatchesPerDescType&)>& onPairFiltered,
+                   const sfmData::SfMData& sfmData,
+                   const feature::RegionsPerView& regionsPerView,
+                   const matching::PairwiseMatches& putativeMatches,
+                   std::size_t maxNeighbors = 0);
+
+} // namespace matchingImageCollection
+} // namespace aliceVision
@@ -30,10 +30,14 @@ struct GeometricFilterMatrix
 {
   GeometricFilterMatrix(double precision,
                         double precisionRobust,
-                        std::size_t stIteration)
+                        std::size_t stIteration,
+                        bool bailOut = false,
+                        bool prosac = false)
     : m_dPrecision(precision)
     , m_dPrecision_robust(precisionRobust)
     , m_stIteration(stIteration)
+    , m_bailOut(bailOut)
+    , m_prosac(prosac)
   {}
 
   /**
@@ -58,6 +62,8 @@ struct GeometricFilterMatrix
   double m_dPrecision;  //upper_bound precision used for robust estimation
   double m_dPrecision_robust;
   std::size_t m_stIteration; //maximal number of iteration for robust estimation
+  bool m_bailOut; //reject early the unlikely models in the A Contrario ransac
+  bool m_prosac; //sample progressively the matches by distance ratio in the robust estimation
 };
 
 
@@ -31,8 +31,10 @@ namespace matchingImageCollection {
 struct GeometricFilterMatrix_E_AC : public GeometricFilterMatrix
 {
   GeometricFilterMatrix_E_AC(double dPrecision = std::numeric_limits<double>::infinity(),
-                             std::size_t iteration = 1024)
-    : GeometricFilterMatrix(dPrecision, std::numeric_limits<double>::infinity(), iteration)
+                             std::size_t iteration = 1024,
+                             bool bailOut = false,
+                             bool prosac = false)
+    : GeometricFilterMatrix(dPrecision, std::numeric_limits<double>::infinity(), iteration, bailOut, prosac)
     , m_E(Mat3::Identity())
   {}
 
@@ -95,9 +97,12 @@ struct GeometricFilterMatrix_E_AC : public GeometricFilterMatrix
     // robustly estimate the Essential matrix with A Contrario ransac
     const double upperBoundPrecision = Square(m_dPrecision);
 
+    const std::vector<std::size_t> sortedMatches = m_prosac ? sortMatchesByDistanceRatio(putativeMatchesPerType, descTypes) : std::vector<std::size_t>();
+
     std::vector<std::size_t> inliers;
     robustEstimation::Mat3Model model;
-    const std::pair<double,double> ACRansacOut = robustEstimation::ACRANSAC(kernel, randomNumberGenerator, inliers, m_stIteration, &model, upperBoundPrecision);
+    const std::pair<double,double> ACRansacOut = robustEstimation::ACRANSAC(kernel, randomNumberGenerator, inliers, m_stIteration, &model, upperBoundPrecision, m_bailOut,
+                                                                            sortedMatches.empty() ? nullptr : &sortedMatches);
     m_E = model.getMatrix();
 
     if (inliers.empty())
@@ -37,11 +37,15 @@ struct GeometricFilterMatrix_F_AC : public GeometricFilterMatrix
   GeometricFilterMatrix_F_AC(double dPrecision = std::numeric_limits<double>::infinity(),
                              std::size_t iteration = 1024,
                              robustEstimation::ERobustEstimator estimator = robustEstimation::ERobustEstimator::ACRANSAC,
-                             bool estimateDistortion = false)
-    : GeometricFilterMatrix(dPrecision, std::numeric_limits<double>::infinity(), iteration)
+                             bool estimateDistortion = false,
+                             bool bailOut = false,
+                             bool prosac = false,
+                             std::size_t ransacBatchSize = 1)
+    : GeometricFilterMatrix(dPrecision, std::numeric_limits<double>::infinity(), iteration, bailOut, prosac)
     , m_F(Mat3::Identity())
     , m_estimator(estimator)
     , m_estimateDistortion(estimateDistortion)
+    , m_ransacBatchSize(ransacBatchSize)
   {}
 
   /**
@@ -108,6 +112,10 @@ struct GeometricFilterMatrix_F_AC : public GeometricFilterMatrix
                                              regionI, regionJ,
                                              descTypes, xI, xJ);
 
+    // the matches by distance ratio for the progressive sampling
+    const std::vector<std::size_t> sortedMatches = m_prosac ? sortMatchesByDistanceRatio(putativeMatchesPerType, descTypes) : std::vector<std::size_t>();
+    const std::vector<std::size_t>* sortedMatchesPtr = sortedMatches.empty() ? nullptr : &sortedMatches;
+
     std::vector<std::size_t> inliers;
     const camera::EquiDistant * cam_I_equidistant = dynamic_cast<const camera::EquiDistant *>(camI);
     const camera::EquiDistant * cam_J_equidistant = dynamic_cast<const camera::EquiDistant *>(camJ);
@@ -119,15 +127,15 @@ struct GeometricFilterMatrix_F_AC : public GeometricFilterMatrix
       {
         if (cam_I_equidistant && cam_J_equidistant)
         {
-          estimationPair = geometricEstimation_Spherical_Mat(xI, xJ, cam_I_equidistant, cam_J_equidistant, imageSizeI, imageSizeJ, randomNumberGenerator, inliers);
+          estimationPair = geometricEstimation_Spherical_Mat(xI, xJ, cam_I_equidistant, cam_J_equidistant, imageSizeI, imageSizeJ, randomNumberGenerator, inliers, sortedMatchesPtr);
         }
         else if(m_estimateDistortion)
         {
-          estimationPair = geometricEstimation_Mat_ACRANSAC<multiview::relativePose::Fundamental10PSolver, multiview::relativePose::Fundamental10PModel>(xI, xJ, imageSizeI, imageSizeJ, randomNumberGenerator, inliers);
+          estimationPair = geometricEstimation_Mat_ACRANSAC<multiview::relativePose::Fundamental10PSolver, multiview::relativePose::Fundamental10PModel>(xI, xJ, imageSizeI, imageSizeJ, randomNumberGenerator, inliers, sortedMatchesPtr);
         }
         else
         {
-          estimationPair = geometricEstimation_Mat_ACRANSAC<multiview::relativePose::Fundamental7PSolver, robustEstimation::Mat3Model>(xI, xJ, imageSizeI, imageSizeJ, randomNumberGenerator, inliers);
+          estimationPair = geometricEstimation_Mat_ACRANSAC<multiview::relativePose::Fundamental7PSolver, robustEstimation::Mat3Model>(xI, xJ, imageSizeI, imageSizeJ, randomNumberGenerator, inliers, sortedMatchesPtr);
         }
       }
       break;
@@ -142,7 +150,7 @@ struct GeometricFilterMatrix_F_AC : public GeometricFilterMatrix
           throw std::invalid_argument("["+std::string(__func__)+"] Using fundamental matrix and equidistant cameras solver with LO_RANSAC is not yet implemented");
         }
 
-        estimationPair = geometricEstimation_Mat_LORANSAC<multiview::relativePose::Fundamental7PSolver, multiview::relativePose::Fundamental8PSolver>(xI, xJ, imageSizeI, imageSizeJ, randomNumberGenerator, inliers);
+        estimationPair = geometricEstimation_Mat_LORANSAC<multiview::relativePose::Fundamental7PSolver, multiview::relativePose::Fundamental8PSolver>(xI, xJ, imageSizeI, imageSizeJ, randomNumberGenerator, inliers, sortedMatchesPtr);
       }
       break;
 
@@ -173,6 +181,7 @@ struct GeometricFilterMatrix_F_AC : public GeometricFilterMatrix
    * @param[in] imageSizeI The size of the first image (used for normalizing the points)
    * @param[in] imageSizeJ The size of the second image
    * @param[out] geometric_inliers A vector containing the indices of the inliers
+   * @param[in] sortedMatches if set, the indices of the points sorted by match quality for the progressive sampling
    * @return true if geometric_inliers is not empty
    */
   std::pair<bool, std::size_t>
@@ -182,7 +191,8 @@ struct GeometricFilterMatrix_F_AC : public GeometricFilterMatrix
                                     const std::pair<size_t, size_t>& imageSizeI, // size of the first image
                                     const std::pair<size_t, size_t>& imageSizeJ, // size of the first image
                                     std::mt19937 &randomNumberGenerator,
-                                    std::vector<size_t>& out_inliers)
+                                    std::vector<size_t>& out_inliers,
+                                    const std::vector<std::size_t>* sortedMatches = nullptr)
   {
       using namespace aliceVision;
       using namespace aliceVision::robustEstimation;
@@ -232,7 +242,7 @@ struct GeometricFilterMatrix_F_AC : public GeometricFilterMatrix
       const double upper_bound_precision = Square(m_dPrecision);
 
       robustEstimation::Mat3Model model;
-      const std::pair<double, double> ACRansacOut = ACRANSAC(kernel, randomNumberGenerator, out_inliers, m_stIteration, &model, upper_bound_precision);
+      const std::pair<double, double> ACRansacOut = ACRANSAC(kernel, randomNumberGenerator, out_inliers, m_stIteration, &model, upper_bound_precision, m_bailOut, sortedMatches);
 
       m_F = model.getMatrix();
 
@@ -253,6 +263,7 @@ struct GeometricFilterMatrix_F_AC : public GeometricFilterMatrix
    * @param[in] imageSizeI The size of the first image (used for normalizing the points)
    * @param[in] imageSizeJ The size of the second image
    * @param[out] geometric_inliers A vector containing the indices of the inliers
+   * @param[in] sortedMatches if set, the indices of the points sorted by match quality for the progressive sampling
    * @return true if geometric_inliers is not empty
    */
   template<class SolverT_, class ModelT_>
@@ -261,7 +272,8 @@ struct GeometricFilterMatrix_F_AC : public GeometricFilterMatrix
                                                                 const std::pair<std::size_t, std::size_t>& imageSizeI, // size of the first image
                                                                 const std::pair<std::size_t, std::size_t>& imageSizeJ, // size of the first image
                                                                 std::mt19937 randomNumberGenerator,
-                                                                std::vector<std::size_t>& out_inliers)
+                                                                std::vector<std::size_t>& out_inliers,
+                                                                const std::vector<std::size_t>* sortedMatches = nullptr)
   {
     out_inliers.clear();
 
@@ -280,7 +292,7 @@ struct GeometricFilterMatrix_F_AC : public GeometricFilterMatrix
     const double upperBoundPrecision = Square(m_dPrecision);
 
     ModelT_ model;
-    const std::pair<double,double> ACRansacOut = robustEstimation::ACRANSAC(kernel, randomNumberGenerator, out_inliers, m_stIteration, &model, upperBoundPrecision);
+    const std::pair<double,double> ACRansacOut = robustEstimation::ACRANSAC(kernel, randomNumberGenerator, out_inliers, m_stIteration, &model, upperBoundPrecision, m_bailOut, sortedMatches);
     m_F = model.getMatrix();
 
     if(out_inliers.empty())
@@ -299,6 +311,7 @@ struct GeometricFilterMatrix_F_AC : public GeometricFilterMatrix
    * @param[in] imageSizeI The size of the first image (used for normalizing the points)
    * @param[in] imageSizeJ The size of the second image
    * @param[out] geometric_inliers A vector containing the indices of the inliers
+   * @param[in] sortedMatches if set, the indices of the points sorted by match quality for the progressive sampling
    * @return true if geometric_inliers is not empty
    */
   template<class SolverT_, class SolverLsT_>
@@ -307,7 +320,8 @@ struct GeometricFilterMatrix_F_AC : public GeometricFilterMatrix
                                                                 const std::pair<std::size_t, std::size_t>& imageSizeI, // size of the first image
                                                                 const std::pair<std::size_t, std::size_t>& imageSizeJ, // size of the first image
                                                                 std::mt19937 &randomNumberGenerator,
-                                                                std::vector<std::size_t>& out_inliers)
+                                                                std::vector<std::size_t>& out_inliers,
+                                                                const std::vector<std::size_t>* sortedMatches = nullptr)
   {
     out_inliers.clear();
 
@@ -329,7 +343,7 @@ struct GeometricFilterMatrix_F_AC : public GeometricFilterMatrix
     const double normalizedThreshold = Square(m_dPrecision * kernel.normalizer2()(0, 0));
     robustEstimation::ScoreEvaluator<KernelT> scorer(normalizedThreshold);
 
-    robustEstimation::Mat3Model model = robustEstimation::LO_RANSAC(kernel, scorer, randomNumberGenerator, &out_inliers);
+    robustEstimation::Mat3Model model = robustEstimation::LO_RANSAC(kernel, scorer, randomNumberGenerator, &out_inliers, nullptr, false, 100, 1e-2, sortedMatches, m_ransacBatchSize);
     m_F = model.getMatrix();
 
     if(out_inliers.empty())
@@ -389,6 +403,7 @@ struct GeometricFilterMatrix_F_AC : public GeometricFilterMatrix
   Mat3 m_F;
   robustEstimation::ERobustEstimator m_estimator;
   bool m_estimateDistortion;
+  std::size_t m_ransacBatchSize; //number of LO_RANSAC hypotheses estimated and scored in parallel
 };
 
 } // namespace matchingImageCollection
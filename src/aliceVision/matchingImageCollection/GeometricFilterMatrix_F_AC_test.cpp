@@ -0,0 +1,72 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/matchingImageCollection/GeometricFilterMatrix_F_AC.hpp>
+#include <aliceVision/multiview/NViewDataSet.hpp>
+
+#include <random>
+#include <vector>
+
+#define BOOST_TEST_MODULE GeometricFilterMatrix_F_AC
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::matchingImageCollection;
+
+BOOST_AUTO_TEST_CASE(GeometricFilterMatrix_F_AC_batchLoRansac)
+{
+  makeRandomOperationsReproducible();
+
+  const std::size_t nbInliers = 200;
+  const std::size_t nbOutliers = 60;
+  const std::pair<std::size_t, std::size_t> imageSize(1000, 1000);
+
+  // two views of the same points, followed by random matches
+  const NViewDataSet d = NRealisticCamerasRing(2, nbInliers, NViewDatasetConfigurator(1000, 1000, 500, 500, 5, 0));
+  Mat xI(2, nbInliers + nbOutliers);
+  Mat xJ(2, nbInliers + nbOutliers);
+  xI.leftCols(nbInliers) = d._x[0];
+  xJ.leftCols(nbInliers) = d._x[1];
+
+  std::mt19937 generator(std::mt19937::default_seed);
+  std::uniform_real_distribution<double> pixel(0.0, 1000.0);
+  for(std::size_t i = nbInliers; i < nbInliers + nbOutliers; ++i)
+  {
+    xI.col(i) << pixel(generator), pixel(generator);
+    xJ.col(i) << pixel(generator), pixel(generator);
+  }
+
+  for(std::size_t batchSize : {1, 8})
+  {
+    std::vector<std::size_t> inliers;
+    {
+      GeometricFilterMatrix_F_AC filter(2.0, 1024, robustEstimation::ERobustEstimator::LORANSAC, false, false, false, batchSize);
+      std::mt19937 randomNumberGenerator(42);
+      const std::pair<bool, std::size_t> estimation =
+        filter.geometricEstimation_Mat_LORANSAC<multiview::relativePose::Fundamental7PSolver, multiview::relativePose::Fundamental8PSolver>(
+          xI, xJ, imageSize, imageSize, randomNumberGenerator, inliers);
+      BOOST_REQUIRE(estimation.first);
+    }
+
+    // all the matches of the views are found, a few random matches may lie close to their epipolar line
+    std::size_t nbFoundInliers = 0;
+    for(std::size_t i : inliers)
+      nbFoundInliers += (i < nbInliers);
+    BOOST_CHECK_EQUAL(nbFoundInliers, nbInliers);
+    BOOST_CHECK_LE(inliers.size() - nbFoundInliers, nbOutliers / 10);
+
+    // the same seed gives the same result with the same batch size
+    {
+      std::vector<std::size_t> otherInliers;
+      GeometricFilterMatrix_F_AC filter(2.0, 1024, robustEstimation::ERobustEstimator::LORANSAC, false, false, false, batchSize);
+      std::mt19937 randomNumberGenerator(42);
+      filter.geometricEstimation_Mat_LORANSAC<multiview::relativePose::Fundamental7PSolver, multiview::relativePose::Fundamental8PSolver>(
+        xI, xJ, imageSize, imageSize, randomNumberGenerator, otherInliers);
+      BOOST_CHECK(otherInliers == inliers);
+    }
+  }
+}
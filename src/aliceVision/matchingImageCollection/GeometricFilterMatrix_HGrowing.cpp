@@ -5,8 +5,11 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include <aliceVision/matching/svgVisualization.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 #include "GeometricFilterMatrix_HGrowing.hpp"
 
+#include <algorithm>
+
 namespace aliceVision {
 namespace matchingImageCollection {
 
@@ -123,48 +126,73 @@ void filterMatchesByHGrowing(const std::vector<feature::PointFeature>& siofeatur
   using namespace aliceVision::matching;
 
   IndMatches remainingMatches = putativeMatches;
-  GeometricFilterMatrix_HGrowing dummy;
+
+  // the seeds are grown by chunks in parallel, one seed at a time if already in a parallel region
+  const int nbThreads = omp_in_parallel() ? 1 : omp_get_max_threads();
+  const std::size_t chunkSize = (nbThreads > 1) ? 4 * nbThreads : 1;
+
+  // the homography grown from each seed of a chunk
+  struct GrownHomography
+  {
+    bool valid = false;
+    std::set<IndexT> planarMatchesId; // be careful: it contains the id. in the 'remainingMatches' vector not 'putativeMatches' vector.
+    Mat3 homography;
+  };
+  std::vector<GrownHomography> grownHomographies(chunkSize);
 
   for(IndexT iH = 0; iH < param._maxNbHomographies; ++iH)
   {
-    std::set<IndexT> usedMatchesId, bestMatchesId;
+    std::vector<bool> usedMatches(remainingMatches.size(), false);
+    std::set<IndexT> bestMatchesId;
     Mat3 bestHomography;
 
     // -- Estimate H using homography-growing approach
-    #pragma omp parallel for // (huge optimization but modify results a little)
-    for(int iMatch = 0; iMatch < remainingMatches.size(); ++iMatch)
+    for(std::size_t chunkStart = 0; chunkStart < remainingMatches.size(); chunkStart += chunkSize)
     {
-      // Growing a homography from one match ([F.Srajer, 2016] algo. 1, p. 20)
-      // each match is used once only per homography estimation (increases computation time) [1st improvement ([F.Srajer, 2016] p. 20) ]
-      if (usedMatchesId.find(iMatch) != usedMatchesId.end())
-        continue;
-      std::set<IndexT> planarMatchesId; // be careful: it contains the id. in the 'remainingMatches' vector not 'putativeMatches' vector.
-      Mat3 homography;
-
-      if (!growHomography(siofeatures_I,
-                          siofeatures_J,
-                          remainingMatches,
-                          iMatch,
-                          planarMatchesId,
-                          homography,
-                          param._growParam))
+      const int nbSeeds = static_cast<int>(std::min(chunkSize, remainingMatches.size() - chunkStart));
+
+      // the seeds grow independently
+      #pragma omp parallel for schedule(dynamic) if(nbSeeds > 1)
+      for(int iSeed = 0; iSeed < nbSeeds; ++iSeed)
       {
-        continue;
+        const IndexT iMatch = chunkStart + iSeed;
+        GrownHomography& grown = grownHomographies[iSeed];
+
+        // each match is used once only per homography estimation (increases computation time) [1st improvement ([F.Srajer, 2016] p. 20) ]
+        // the matches used by the seeds of the same chunk are only known in the reduction
+        grown.valid = !usedMatches[iMatch];
+        if (!grown.valid)
+          continue;
+
+        // Growing a homography from one match ([F.Srajer, 2016] algo. 1, p. 20)
+        grown.valid = growHomography(siofeatures_I,
+                                     siofeatures_J,
+                                     remainingMatches,
+                                     iMatch,
+                                     grown.planarMatchesId,
+                                     grown.homography,
+                                     param._growParam);
       }
 
-      #pragma omp critical
-      usedMatchesId.insert(planarMatchesId.begin(), planarMatchesId.end());
-
-      if (planarMatchesId.size() > bestMatchesId.size())
+      // reduction in the seed order: the same result as growing the seeds one by one
+      for(int iSeed = 0; iSeed < nbSeeds; ++iSeed)
       {
-        #pragma omp critical
+        const IndexT iMatch = chunkStart + iSeed;
+        GrownHomography& grown = grownHomographies[iSeed];
+
+        if (!grown.valid || usedMatches[iMatch])
+          continue;
+
+        for (IndexT id : grown.planarMatchesId)
+          usedMatches[id] = true;
+
+        if (grown.planarMatchesId.size() > bestMatchesId.size())
         {
-          // if(iH == 3) { std::cout << "best iMatch" << iMatch << std::endl; }
-          bestMatchesId = planarMatchesId; // be careful: it contains the id. in the 'remainingMatches' vector not 'putativeMatches' vector.
-          bestHomography = homography;
+          bestMatchesId.swap(grown.planarMatchesId);
+          bestHomography = grown.homography;
         }
       }
-    } // 'iMatch'
+    } // 'chunkStart'
 
     // -- Refine H using Ceres minimizer
     refineHomography(siofeatures_I, siofeatures_J, remainingMatches, bestHomography, bestMatchesId, param._growParam._homographyTolerance);
@@ -28,8 +28,10 @@ namespace matchingImageCollection {
 struct GeometricFilterMatrix_H_AC : public GeometricFilterMatrix
 {
   GeometricFilterMatrix_H_AC(double dPrecision = std::numeric_limits<double>::infinity(),
-                             std::size_t iteration = 1024)
-    : GeometricFilterMatrix(dPrecision, std::numeric_limits<double>::infinity(), iteration)
+                             std::size_t iteration = 1024,
+                             bool bailOut = false,
+                             bool prosac = false)
+    : GeometricFilterMatrix(dPrecision, std::numeric_limits<double>::infinity(), iteration, bailOut, prosac)
     , m_H(Mat3::Identity())
   {}
 
@@ -76,9 +78,12 @@ struct GeometricFilterMatrix_H_AC : public GeometricFilterMatrix
     // robustly estimate the Homography matrix with A Contrario ransac
     const double upperBoundPrecision = Square(m_dPrecision);
 
+    const std::vector<std::size_t> sortedMatches = m_prosac ? sortMatchesByDistanceRatio(putativeMatchesPerType, descTypes) : std::vector<std::size_t>();
+
     std::vector<std::size_t> inliers;
     robustEstimation::Mat3Model model;
-    const std::pair<double,double> ACRansacOut = robustEstimation::ACRANSAC(kernel, randomNumberGenerator, inliers, m_stIteration, &model, upperBoundPrecision);
+    const std::pair<double,double> ACRansacOut = robustEstimation::ACRANSAC(kernel, randomNumberGenerator, inliers, m_stIteration, &model, upperBoundPrecision, m_bailOut,
+                                                                            sortedMatches.empty() ? nullptr : &sortedMatches);
     m_H = model.getMatrix();
 
     if (inliers.empty())
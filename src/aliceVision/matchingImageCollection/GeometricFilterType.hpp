@@ -22,6 +22,7 @@ enum class EGeometricFilterType
   , ESSENTIAL_MATRIX
   , HOMOGRAPHY_MATRIX
   , HOMOGRAPHY_GROWING
+  , KVLD
 };
 
 /**
@@ -36,7 +37,8 @@ inline std::string EGeometricFilterType_informations()
          "* fundamental_with_distortion: fundamental matrix with F10 solver [Z.Kukelova, 2015]\n"
          "* essential_matrix:            essential matrix\n"
          "* homography_matrix:           homography matrix\n"
-         "* homography_growing:          multiple homography matrices [F.Srajer, 2016]\n";
+         "* homography_growing:          multiple homography matrices [F.Srajer, 2016]\n"
+         "* kvld:                        K-Virtual Line Descriptor photometric and geometric consistency [Z.Liu, 2012]\n";
 }
 
 /**
@@ -54,6 +56,7 @@ inline std::string EGeometricFilterType_enumToString(EGeometricFilterType geomet
     case EGeometricFilterType::ESSENTIAL_MATRIX:             return "essential_matrix";
     case EGeometricFilterType::HOMOGRAPHY_MATRIX:            return "homography_matrix";
     case EGeometricFilterType::HOMOGRAPHY_GROWING:           return "homography_growing";
+    case EGeometricFilterType::KVLD:                         return "kvld";
   }
   throw std::out_of_range("Invalid geometricFilterType enum");
 }
@@ -74,6 +77,7 @@ inline EGeometricFilterType EGeometricFilterType_stringToEnum(const std::string&
   if(model == "essential_matrix")             return EGeometricFilterType::ESSENTIAL_MATRIX;
   if(model == "homography_matrix")            return EGeometricFilterType::HOMOGRAPHY_MATRIX;
   if(model == "homography_growing")           return EGeometricFilterType::HOMOGRAPHY_GROWING;
+  if(model == "kvld")                         return EGeometricFilterType::KVLD;
 
   throw std::out_of_range("Invalid geometricFilterType: " + geometricFilterType);
 }
@@ -7,11 +7,16 @@
 
 #include <aliceVision/matchingImageCollection/ImageCollectionMatcher_cascadeHashing.hpp>
 #include <aliceVision/matching/ArrayMatcher_cascadeHashing.hpp>
+#include <aliceVision/matching/HashedDescriptionsIO.hpp>
 #include <aliceVision/matching/IndMatchDecorator.hpp>
 #include <aliceVision/matching/filters.hpp>
 #include <aliceVision/system/ProgressDisplay.hpp>
 #include <aliceVision/config.hpp>
 
+#include <boost/filesystem.hpp>
+
+namespace fs = boost::filesystem;
+
 namespace aliceVision {
 namespace matchingImageCollection {
 
@@ -28,6 +33,25 @@ ImageCollectionMatcher_cascadeHashing
 
 namespace impl
 {
+
+/**
+ * @brief Get the hashed descriptions cache file of a view, next to its descriptors file.
+ * @return an empty string if the descriptors file of the view can't be found
+ */
+std::string getHashedDescriptionsCachePath(const std::vector<std::string>& featuresFolders, IndexT viewId, EImageDescriberType descType)
+{
+  const std::string basename = std::to_string(viewId) + "." + EImageDescriberType_enumToString(descType);
+  std::string cachePath;
+
+  // same lookup order as the regions loading: the last folder containing the descriptors wins
+  for(const std::string& folder : featuresFolders)
+  {
+    if(fs::exists(fs::path(folder) / (basename + ".desc")))
+      cachePath = (fs::path(folder) / (basename + ".hashedDesc")).string();
+  }
+  return cachePath;
+}
+
 template <typename ScalarT>
 void Match
 (
@@ -36,9 +60,13 @@ void Match
   const PairSet & pairs,
   EImageDescriberType descType,
   float fDistRatio,
+  const std::vector<std::string>& cacheFeaturesFolders,
+  std::uint32_t cacheHasherSeed,
   PairwiseMatches & map_PutativesMatches // the pairwise photometric corresponding points
 )
 {
+  const bool useCache = !cacheFeaturesFolders.empty();
+
   auto progressDisplay = system::createConsoleProgressDisplay(pairs.size(), std::cout);
 
   // Collect used view indexes
@@ -62,13 +90,28 @@ void Match
     const IndexT I = *used_index.begin();
     const feature::Regions &regionsI = regionsPerView.getRegions(I, descType);
     const size_t dimension = regionsI.DescriptorLength();
-    cascade_hasher.Init(gen, dimension);
+    if (useCache)
+    {
+      // the hashing projections must be the same for all the chunks to share the cache
+      std::mt19937 hasherGenerator(cacheHasherSeed);
+      cascade_hasher.Init(hasherGenerator, dimension);
+    }
+    else
+    {
+      cascade_hasher.Init(gen, dimension);
+    }
   }
 
   std::map<IndexT, HashedDescriptions> hashed_base_;
 
-  // Compute the zero mean descriptor that will be used for hashing (one for all the image regions)
+  // Compute the zero mean descriptor that will be used for hashing (one for all the image regions).
+  // With the cache, the first computed zero mean descriptor is stored and reused by all the chunks.
   Eigen::VectorXf zero_mean_descriptor;
+  const std::string zeroMeanPath = useCache ?
+    (fs::path(cacheFeaturesFolders.front()) / (EImageDescriberType_enumToString(descType) + ".zeroMean")).string() : "";
+
+  if (!useCache || used_index.empty() ||
+      !loadZeroMeanDescriptor(zeroMeanPath, regionsPerView.getRegions(*used_index.begin(), descType).DescriptorLength(), zero_mean_descriptor))
   {
     Eigen::MatrixXf matForZeroMean;
     for (int i =0; i < used_index.size(); ++i)
@@ -92,6 +135,19 @@ void Match
       }
     }
     zero_mean_descriptor = CascadeHasher::GetZeroMeanDescriptor(matForZeroMean);
+
+    if (useCache && zero_mean_descriptor.size() > 0)
+      saveZeroMeanDescriptor(zeroMeanPath, zero_mean_descriptor);
+  }
+
+  HashedDescriptionsCacheKey cacheKey;
+  if (useCache)
+  {
+    cacheKey.zeroMeanHash = computeDataHash(zero_mean_descriptor.data(), zero_mean_descriptor.size() * sizeof(float));
+    cacheKey.hasherSeed = cacheHasherSeed;
+    cacheKey.nbHashCode = static_cast<std::uint16_t>(cascade_hasher.getNbHashCode());
+    cacheKey.nbBucketGroups = static_cast<std::uint8_t>(cascade_hasher.getNbBucketGroups());
+    cacheKey.nbBitsPerBucket = static_cast<std::uint8_t>(cascade_hasher.getNbBitsPerBucket());
   }
 
   // Index the input regions
@@ -107,42 +163,74 @@ void Match
     const size_t dimension = regionsI.DescriptorLength();
 
     Eigen::Map<BaseMat> mat_I( (ScalarT*)tabI, regionsI.RegionCount(), dimension);
-    HashedDescriptions hashed_description = cascade_hasher.CreateHashedDescriptions(mat_I,
-      zero_mean_descriptor);
+    HashedDescriptions hashed_description;
+
+    std::string cachePath;
+    HashedDescriptionsCacheKey viewCacheKey = cacheKey;
+    if (useCache)
+    {
+      cachePath = getHashedDescriptionsCachePath(cacheFeaturesFolders, I, descType);
+      viewCacheKey.descriptorsHash = computeDataHash(tabI, regionsI.RegionCount() * dimension * sizeof(ScalarT));
+    }
+
+    if (cachePath.empty() || !loadHashedDescriptions(cachePath, viewCacheKey, cascade_hasher, hashed_description))
+    {
+      hashed_description = cascade_hasher.CreateHashedDescriptions(mat_I, zero_mean_descriptor);
+      if (!cachePath.empty())
+        saveHashedDescriptions(cachePath, viewCacheKey, hashed_description);
+    }
     #pragma omp critical
     {
       hashed_base_[I] = std::move(hashed_description);
     }
   }
 
-  // Perform matching between all the pairs
-  for (Map_vectorT::const_iterator iter = map_Pairs.begin();
-    iter != map_Pairs.end(); ++iter)
+  // Perform matching between all the pairs:
+  // each database image I is matched against all its partners J in a single sweep,
+  // reusing the same matching buffers. Threads are split by database image.
+  const std::vector<std::pair<IndexT, std::vector<IndexT>>> vec_Pairs(map_Pairs.begin(), map_Pairs.end());
+
+  #pragma omp parallel for schedule(dynamic)
+  for (int p = 0; p < (int)vec_Pairs.size(); ++p)
   {
-    const IndexT I = iter->first;
-    const std::vector<IndexT> & indexToCompare = iter->second;
+    const IndexT I = vec_Pairs[p].first;
+    const std::vector<IndexT> & indexToCompare = vec_Pairs[p].second;
 
     const feature::Regions &regionsI = regionsPerView.getRegions(I, descType);
     if (regionsI.RegionCount() == 0)
     {
+      #pragma omp critical
       progressDisplay += indexToCompare.size();
       continue;
     }
 
-    const std::vector<feature::PointFeature> pointFeaturesI = regionsI.GetRegionsPositions();
+    const std::vector<feature::PointFeature>& pointFeaturesI = regionsI.Features();
     const ScalarT * tabI =
       reinterpret_cast<const ScalarT*>(regionsI.DescriptorRawData());
     const size_t dimension = regionsI.DescriptorLength();
     Eigen::Map<BaseMat> mat_I( (ScalarT*)tabI, regionsI.RegionCount(), dimension);
-    #pragma omp parallel for schedule(dynamic)
-    for (int j = 0; j < (int)indexToCompare.size(); ++j)
+    const HashedDescriptions& hashedI = hashed_base_.at(I);
+
+    CascadeHasher::MatchingBuffers matchingBuffers;
+    typedef typename Accumulator<ScalarT>::Type ResultType;
+    IndMatches pvec_indices;
+    std::vector<ResultType> pvec_distances;
+    std::vector<int> vec_nn_ratio_idx;
+
+    for (const IndexT J : indexToCompare)
     {
-      size_t J = indexToCompare[j];
-      const feature::Regions &regionsJ = regionsPerView.getRegions(I, descType);
+      if (!regionsPerView.viewExist(J))
+      {
+        #pragma omp critical
+        ++progressDisplay;
+        continue;
+      }
+
+      const feature::Regions &regionsJ = regionsPerView.getRegions(J, descType);
 
-      if (!regionsPerView.viewExist(J)
-          || regionsI.Type_id() != regionsJ.Type_id())
+      if (regionsI.Type_id() != regionsJ.Type_id())
       {
+        #pragma omp critical
         ++progressDisplay;
         continue;
       }
@@ -151,19 +239,18 @@ void Match
       const ScalarT * tabJ = reinterpret_cast<const ScalarT*>(regionsJ.DescriptorRawData());
       Eigen::Map<BaseMat> mat_J( (ScalarT*)tabJ, regionsJ.RegionCount(), dimension);
 
-      IndMatches pvec_indices;
-      typedef typename Accumulator<ScalarT>::Type ResultType;
-      std::vector<ResultType> pvec_distances;
+      pvec_indices.clear();
+      pvec_distances.clear();
       pvec_distances.reserve(regionsJ.RegionCount() * 2);
       pvec_indices.reserve(regionsJ.RegionCount() * 2);
 
       // Match the query descriptors to the database
       cascade_hasher.Match_HashedDescriptions<BaseMat, ResultType>(
-        hashed_base_[J], mat_J,
-        hashed_base_[I], mat_I,
+        hashed_base_.at(J), mat_J,
+        hashedI, mat_I,
+        matchingBuffers,
         &pvec_indices, &pvec_distances);
 
-      std::vector<int> vec_nn_ratio_idx;
       // Filter the matches using a distance ratio test:
       //   The probability that a match is correct is determined by taking
       //   the ratio of distance from the closest neighbor to the distance
@@ -187,9 +274,8 @@ void Match
       matching::IndMatch::getDeduplicated(vec_putative_matches);
 
       // Remove matches that have the same (X,Y) coordinates
-      const std::vector<feature::PointFeature> pointFeaturesJ = regionsJ.GetRegionsPositions();
       matching::IndMatchDecorator<float> matchDeduplicator(vec_putative_matches,
-        pointFeaturesI, pointFeaturesJ);
+        pointFeaturesI, regionsJ.Features());
       matchDeduplicator.getDeduplicated(vec_putative_matches);
 
       #pragma omp critical
@@ -236,6 +322,8 @@ void ImageCollectionMatcher_cascadeHashing::Match
       pairs,
       descType,
       f_dist_ratio_,
+      _cacheFeaturesFolders,
+      _cacheHasherSeed,
       map_PutativesMatches);
   }
   else
@@ -247,6 +335,8 @@ void ImageCollectionMatcher_cascadeHashing::Match
       pairs,
       descType,
       f_dist_ratio_,
+      _cacheFeaturesFolders,
+      _cacheHasherSeed,
       map_PutativesMatches);
   }
   else
@@ -9,6 +9,10 @@
 
 #include "aliceVision/matchingImageCollection/IImageCollectionMatcher.hpp"
 
+#include <cstdint>
+#include <string>
+#include <vector>
+
 namespace aliceVision {
 namespace matchingImageCollection {
 
@@ -19,6 +23,7 @@ namespace matchingImageCollection {
  * a threshold over the distance ratio of the 2 nearest neighbours.
  *
  * @note: Cascade hashing tables are computed once and used for all the regions.
+ *        They can be cached on disk to be reused by other chunks or later runs (see setHashedDescriptionsCache).
  * @warning: all descriptors are loaded in memory. You need to ensure that it can fit in RAM.
  */
 class ImageCollectionMatcher_cascadeHashing : public IImageCollectionMatcher
@@ -38,9 +43,26 @@ class ImageCollectionMatcher_cascadeHashing : public IImageCollectionMatcher
     matching::PairwiseMatches & map_PutativesMatches // the pairwise photometric corresponding points
   ) const;
 
+  /**
+   * @brief Enable the on-disk cache of the hashed descriptions.
+   *        The hashed descriptions of a view are saved next to its descriptors file
+   *        and reused as long as the descriptors, the zero mean descriptor and the hasher seed are unchanged.
+   * @param[in] featuresFolders The folders containing the descriptors files
+   * @param[in] hasherSeed The seed used to generate the hashing projections (same for all the chunks)
+   */
+  void setHashedDescriptionsCache(const std::vector<std::string>& featuresFolders, std::uint32_t hasherSeed)
+  {
+    _cacheFeaturesFolders = featuresFolders;
+    _cacheHasherSeed = hasherSeed;
+  }
+
   private:
   // Distance ratio used to discard spurious correspondence
   float f_dist_ratio_;
+  // Folders of the descriptors files used for the hashed descriptions cache (empty if disabled)
+  std::vector<std::string> _cacheFeaturesFolders;
+  // Seed of the hashing projections used with the hashed descriptions cache
+  std::uint32_t _cacheHasherSeed = 0;
 };
 
 } // namespace aliceVision
@@ -7,15 +7,124 @@
 
 #include "ImagePairListIO.hpp"
 #include <aliceVision/system/Logger.hpp>
-#include <boost/algorithm/string/split.hpp>
-#include <boost/algorithm/string/trim.hpp>
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
 #include <fstream>
+#include <map>
 
 namespace aliceVision {
 namespace matchingImageCollection {
 
+namespace {
+
+/// magic number of the binary pair lists, followed by the number of pairs and the pairs
+const char binaryPairsMagic[8] = {'A', 'V', 'P', 'A', 'I', 'R', 'S', '1'};
+
+template <class PairIterator>
+void savePairsText(std::ostream& stream, PairIterator begin, PairIterator end)
+{
+    if (begin == end)
+    {
+        return;
+    }
+    stream << begin->first << " " << begin->second;
+    IndexT previousIndex = begin->first;
+
+    // Pairs is sorted so we will always receive elements with the same first pair ID in
+    // continuous blocks.
+    for (auto it = std::next(begin); it != end; ++it)
+    {
+        if (it->first == previousIndex)
+        {
+            stream << " " << it->second;
+        }
+        else
+        {
+            stream << "\n" << it->first << " " << it->second;
+            previousIndex = it->first;
+        }
+    }
+    stream << "\n";
+}
+
+template <class PairIterator>
+bool savePairsBinary(const std::string& sFileName, PairIterator begin, PairIterator end, std::uint64_t nbPairs)
+{
+    std::ofstream outStream(sFileName, std::ios::binary);
+    if (!outStream.is_open())
+    {
+        ALICEVISION_LOG_WARNING("savePairsToFile: Impossible to open the output specified file: \""
+                                << sFileName << "\".");
+        return false;
+    }
+
+    outStream.write(binaryPairsMagic, sizeof(binaryPairsMagic));
+    outStream.write(reinterpret_cast<const char*>(&nbPairs), sizeof(nbPairs));
+
+    // write by blocks to avoid a stream call per pair
+    std::vector<IndexT> buffer;
+    buffer.reserve(2 * 65536);
+    for (auto it = begin; it != end; ++it)
+    {
+        buffer.push_back(it->first);
+        buffer.push_back(it->second);
+        if (buffer.size() == buffer.capacity())
+        {
+            outStream.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(IndexT));
+            buffer.clear();
+        }
+    }
+    outStream.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(IndexT));
+
+    return !outStream.bad();
+}
+
+bool loadPairsBinary(std::istream& stream, PairVec& pairs, int rangeStart, int rangeSize)
+{
+    std::uint64_t nbPairs = 0;
+    stream.read(reinterpret_cast<char*>(&nbPairs), sizeof(nbPairs));
+    if (!stream)
+        return false;
+
+    // check the number of pairs against the file size before allocating
+    const std::istream::pos_type dataBegin = stream.tellg();
+    stream.seekg(0, std::ios::end);
+    const std::istream::pos_type dataEnd = stream.tellg();
+    stream.seekg(dataBegin);
+    if (dataBegin < 0 || dataEnd < dataBegin ||
+        nbPairs != static_cast<std::uint64_t>(dataEnd - dataBegin) / sizeof(Pair))
+    {
+        ALICEVISION_LOG_WARNING("loadPairs: Invalid binary file, " << nbPairs
+                                << " pairs do not match the file size.");
+        return false;
+    }
+
+    std::uint64_t first = 0;
+    std::uint64_t last = nbPairs;
+    if (rangeStart != -1 && rangeSize != 0)
+    {
+        first = std::min<std::uint64_t>(rangeStart, nbPairs);
+        last = std::min<std::uint64_t>(first + rangeSize, nbPairs);
+    }
+
+    static_assert(sizeof(Pair) == 2 * sizeof(IndexT), "The pairs are read as contiguous indexes.");
+    stream.seekg(first * sizeof(Pair), std::ios::cur);
+
+    const std::size_t offset = pairs.size();
+    pairs.resize(offset + (last - first));
+    stream.read(reinterpret_cast<char*>(pairs.data() + offset), (last - first) * sizeof(Pair));
+
+    return static_cast<bool>(stream);
+}
+
+} // namespace
+
 bool loadPairs(std::istream& stream,
-               PairSet & pairs,
+               PairVec& pairs,
                int rangeStart,
                int rangeSize)
 {
@@ -32,77 +141,98 @@ bool loadPairs(std::istream& stream,
                 break;
         }
 
-        std::vector<std::string> vec_str;
-        boost::trim(sValue);
-        boost::split(vec_str, sValue, boost::is_any_of("\t "), boost::token_compress_on);
-
-        const size_t str_size = vec_str.size();
-        if (str_size < 2)
-        {
-            ALICEVISION_LOG_WARNING("loadPairs: Invalid input file.");
-            return false;
-        }
-        std::stringstream oss;
-        oss.clear(); oss.str(vec_str[0]);
-        size_t I, J;
-        oss >> I;
-        for (size_t i=1; i<str_size ; ++i)
+        // parse the indexes in place, this is the bottleneck of the large pair lists
+        const char* ptr = sValue.c_str();
+        std::size_t nbValues = 0;
+        IndexT I = UndefinedIndexT;
+        while (true)
         {
-            oss.clear(); oss.str(vec_str[i]);
-            oss >> J;
-            if( I == J )
+            char* valueEnd = nullptr;
+            const unsigned long value = std::strtoul(ptr, &valueEnd, 10);
+            if (valueEnd == ptr)
+                break;
+            ptr = valueEnd;
+
+            const IndexT J = static_cast<IndexT>(value);
+            if (nbValues++ == 0)
+            {
+                I = J;
+                continue;
+            }
+            if (I == J)
             {
                 ALICEVISION_LOG_WARNING("loadPairs: Invalid input file. Image " << I
                                         << " sees itself.");
                 return false;
             }
-            Pair pairToInsert = (I < J) ? std::make_pair(I, J) : std::make_pair(J, I);
-            if(pairs.find(pairToInsert) != pairs.end())
-            {
-                // There is no reason to have the same image pair twice in the list of image pairs
-                //to match.
-                ALICEVISION_LOG_WARNING("loadPairs: image pair (" << I << ", " << J
-                                        << ") already added.");
-            }
-            ALICEVISION_LOG_INFO("loadPairs: image pair (" << I << ", " << J << ") added.");
-            pairs.insert(pairToInsert);
+            pairs.emplace_back(std::min(I, J), std::max(I, J));
+        }
+
+        while (std::isspace(static_cast<unsigned char>(*ptr)))
+            ++ptr;
+
+        if (nbValues < 2 || *ptr != '\0')
+        {
+            ALICEVISION_LOG_WARNING("loadPairs: Invalid input file.");
+            return false;
         }
     }
     return true;
 }
 
+bool loadPairs(std::istream& stream,
+               PairSet & pairs,
+               int rangeStart,
+               int rangeSize)
+{
+    PairVec loadedPairs;
+    if (!loadPairs(stream, loadedPairs, rangeStart, rangeSize))
+        return false;
+
+    const std::size_t previousSize = pairs.size();
+    pairs.insert(loadedPairs.begin(), loadedPairs.end());
+
+    // There is no reason to have the same image pair twice in the list of image pairs to match.
+    const std::size_t nbDuplicates = previousSize + loadedPairs.size() - pairs.size();
+    if (nbDuplicates > 0)
+        ALICEVISION_LOG_WARNING("loadPairs: " << nbDuplicates << " image pairs already added.");
+    return true;
+}
+
 void savePairs(std::ostream& stream, const PairSet & pairs)
 {
-    if (pairs.empty())
-    {
-        return;
-    }
-    stream << pairs.begin()->first << " " << pairs.begin()->second;
-    IndexT previousIndex = pairs.begin()->first;
+    savePairsText(stream, pairs.begin(), pairs.end());
+}
 
-    // Pairs is sorted so we will always receive elements with the same first pair ID in
-    // continuous blocks.
-    for (auto it = std::next(pairs.begin()); it != pairs.end(); ++it)
+void savePairs(std::ostream& stream, const PairVec& pairs)
+{
+    savePairsText(stream, pairs.begin(), pairs.end());
+}
+
+void sortAndDeduplicatePairs(PairVec& pairs)
+{
+    for (Pair& pair : pairs)
     {
-        if (it->first == previousIndex)
-        {
-            stream << " " << it->second;
-        }
-        else
-        {
-            stream << "\n" << it->first << " " << it->second;
-            previousIndex = it->first;
-        }
+        if (pair.first > pair.second)
+            std::swap(pair.first, pair.second);
     }
-    stream << "\n";
+    std::sort(pairs.begin(), pairs.end());
+    pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+}
+
+bool isBinaryPairsFile(const std::string& sFileName)
+{
+    std::ifstream in(sFileName, std::ios::binary);
+    char magic[sizeof(binaryPairsMagic)];
+    return in.read(magic, sizeof(magic)) && std::equal(magic, magic + sizeof(magic), binaryPairsMagic);
 }
 
 bool loadPairsFromFile(const std::string& sFileName, // filename of the list file,
-                       PairSet& pairs,
+                       PairVec& pairs,
                        int rangeStart,
                        int rangeSize)
 {
-    std::ifstream in(sFileName);
+    std::ifstream in(sFileName, std::ios::binary);
     if (!in.is_open())
     {
         ALICEVISION_LOG_WARNING("loadPairsFromFile: Impossible to read the specified file: \""
@@ -110,16 +240,74 @@ bool loadPairsFromFile(const std::string& sFileName, // filename of the list fil
         return false;
     }
 
-    if (!loadPairs(in, pairs, rangeStart, rangeSize))
+    char magic[sizeof(binaryPairsMagic)] = {};
+    in.read(magic, sizeof(magic));
+    const bool isBinary = in && std::equal(magic, magic + sizeof(magic), binaryPairsMagic);
+    if (!isBinary)
+    {
+        in.clear();
+        in.seekg(0);
+    }
+
+    const std::size_t previousSize = pairs.size();
+    if (!(isBinary ? loadPairsBinary(in, pairs, rangeStart, rangeSize) : loadPairs(in, pairs, rangeStart, rangeSize)))
     {
         ALICEVISION_LOG_WARNING("loadPairsFromFile: Failed to read file: \"" << sFileName << "\".");
         return false;
     }
+
+    // the binary pairs are already sorted, only the concatenation with other lists needs a sort
+    if (!isBinary || previousSize > 0)
+        sortAndDeduplicatePairs(pairs);
     return true;
 }
 
+bool loadPairsFromFile(const std::string& sFileName, // filename of the list file,
+                       PairSet& pairs,
+                       int rangeStart,
+                       int rangeSize)
+{
+    PairVec loadedPairs;
+    if (!loadPairsFromFile(sFileName, loadedPairs, rangeStart, rangeSize))
+        return false;
+
+    pairs.insert(loadedPairs.begin(), loadedPairs.end());
+    return true;
+}
+
+bool savePairsToFile(const std::string& sFileName, const PairVec& pairs)
+{
+    if (boost::filesystem::path(sFileName).extension() == ".bin")
+    {
+        // the readers of the binary lists rely on sorted pairs without duplicates
+        PairVec sortedPairs(pairs);
+        sortAndDeduplicatePairs(sortedPairs);
+        return savePairsBinary(sFileName, sortedPairs.begin(), sortedPairs.end(), sortedPairs.size());
+    }
+
+    std::ofstream outStream(sFileName);
+    if (!outStream.is_open())
+    {
+        ALICEVISION_LOG_WARNING("savePairsToFile: Impossible to open the output specified file: \""
+                                << sFileName << "\".");
+        return false;
+    }
+
+    savePairs(outStream, pairs);
+
+    return !outStream.bad();
+}
+
 bool savePairsToFile(const std::string& sFileName, const PairSet& pairs)
 {
+    if (boost::filesystem::path(sFileName).extension() == ".bin")
+    {
+        // the pairs of the set may not be ordered as (min, max)
+        PairVec sortedPairs(pairs.begin(), pairs.end());
+        sortAndDeduplicatePairs(sortedPairs);
+        return savePairsBinary(sFileName, sortedPairs.begin(), sortedPairs.end(), sortedPairs.size());
+    }
+
     std::ofstream outStream(sFileName);
     if (!outStream.is_open())
     {
@@ -133,5 +321,73 @@ bool savePairsToFile(const std::string& sFileName, const PairSet& pairs)
     return !outStream.bad();
 }
 
+std::vector<Pair> reorderPairsForLocality(const PairSet& pairs)
+{
+    std::map<IndexT, std::vector<IndexT>> adjacency;
+    for (const Pair& pair : pairs)
+    {
+        adjacency[pair.first].push_back(pair.second);
+        adjacency[pair.second].push_back(pair.first);
+    }
+
+    const auto lessDegree = [&adjacency](IndexT a, IndexT b)
+    {
+        const std::size_t degreeA = adjacency.at(a).size();
+        const std::size_t degreeB = adjacency.at(b).size();
+        return (degreeA == degreeB) ? (a < b) : (degreeA < degreeB);
+    };
+
+    std::vector<IndexT> views;
+    views.reserve(adjacency.size());
+    for (const auto& it : adjacency)
+        views.push_back(it.first);
+    std::sort(views.begin(), views.end(), lessDegree);
+
+    // Cuthill-McKee ordering of the views (one traversal per connected component)
+    std::map<IndexT, std::size_t> rank;
+    for (const IndexT startView : views)
+    {
+        if (rank.count(startView))
+            continue;
+
+        std::deque<IndexT> queue = {startView};
+        rank.emplace(startView, rank.size());
+
+        while (!queue.empty())
+        {
+            const IndexT viewId = queue.front();
+            queue.pop_front();
+
+            std::vector<IndexT> neighbors;
+            for (const IndexT neighbor : adjacency.at(viewId))
+            {
+                if (!rank.count(neighbor))
+                    neighbors.push_back(neighbor);
+            }
+            std::sort(neighbors.begin(), neighbors.end(), lessDegree);
+
+            for (const IndexT neighbor : neighbors)
+            {
+                if (rank.emplace(neighbor, rank.size()).second)
+                    queue.push_back(neighbor);
+            }
+        }
+    }
+
+    // schedule each pair as soon as its last view is reached
+    std::vector<Pair> orderedPairs(pairs.begin(), pairs.end());
+    std::stable_sort(orderedPairs.begin(), orderedPairs.end(), [&rank](const Pair& a, const Pair& b)
+    {
+        const std::size_t rankA1 = rank.at(a.first);
+        const std::size_t rankA2 = rank.at(a.second);
+        const std::size_t rankB1 = rank.at(b.first);
+        const std::size_t rankB2 = rank.at(b.second);
+        return std::make_pair(std::max(rankA1, rankA2), std::min(rankA1, rankA2)) <
+               std::make_pair(std::max(rankB1, rankB2), std::min(rankB1, rankB2));
+    });
+
+    return orderedPairs;
+}
+
 } // namespace matchingImageCollection
 } // namespace aliceVision
@@ -7,6 +7,8 @@
 
 #include <aliceVision/types.hpp>
 #include <iosfwd>
+#include <string>
+#include <vector>
 
 namespace aliceVision {
 namespace matchingImageCollection {
@@ -18,19 +20,65 @@ bool loadPairs(std::istream& stream,
                int rangeStart=-1,
                int rangeSize=0);
 
+/// Same as loadPairs, but appends the pairs (I < J) to a vector, without sorting nor removing the duplicates
+bool loadPairs(std::istream& stream,
+               PairVec& pairs,
+               int rangeStart=-1,
+               int rangeSize=0);
+
 /// Save a set of PairSet to a stream (one pair per line)
 /// I J
 /// I K
 void savePairs(std::ostream& stream, const PairSet& pairs);
 
+/// Same as savePairs, for a sorted vector of pairs
+void savePairs(std::ostream& stream, const PairVec& pairs);
+
+/**
+ * @brief Order the pairs as (I < J), sort them and remove the duplicates.
+ *        A sorted vector of pairs is a compact alternative to PairSet for the large pair lists.
+ * @param[in,out] pairs The pairs
+ */
+void sortAndDeduplicatePairs(PairVec& pairs);
+
+/**
+ * @brief Check if the file is a binary pair list.
+ *        The binary pair list contains the sorted pairs without duplicates,
+ *        so the ranges of pairs of the chunks are read directly.
+ * @param[in] sFileName The pair list file
+ */
+bool isBinaryPairsFile(const std::string& sFileName);
+
 /// Same as loadPairs, but loads from a given file
+/// The text files are ranged by line, the binary files by pair.
 bool loadPairsFromFile(const std::string& sFileName, // filename of the list file,
                        PairSet& pairs,
                        int rangeStart = -1,
                        int rangeSize = 0);
 
+/// Same as loadPairs, but loads from a given file and returns the sorted pairs without duplicates
+bool loadPairsFromFile(const std::string& sFileName,
+                       PairVec& pairs,
+                       int rangeStart = -1,
+                       int rangeSize = 0);
+
 /// Same as savePairs, but saves to a given file
+/// The pairs are saved in the binary format if the file extension is ".bin".
 bool savePairsToFile(const std::string& sFileName, const PairSet& pairs);
 
+/// Same as savePairs, but saves the sorted pairs without duplicates to a given file
+/// The pairs are saved in the binary format if the file extension is ".bin".
+bool savePairsToFile(const std::string& sFileName, const PairVec& pairs);
+
+/**
+ * @brief Reorder the pairs to maximize the reuse of the views between consecutive pairs.
+ *        The views are ordered with a Cuthill-McKee traversal of the pair graph
+ *        and each pair is scheduled as soon as its two views have been reached,
+ *        so each view is only needed during a short window of the pair list.
+ * @param[in] pairs The pairs to reorder
+ * @return the ordered list of pairs
+ */
+std::vector<Pair> reorderPairsForLocality(const PairSet& pairs);
+
 } // namespace matchingImageCollection
 } // namespace aliceVision
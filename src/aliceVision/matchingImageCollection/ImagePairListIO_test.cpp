@@ -12,6 +12,8 @@
 
 #include "ImagePairListIO.hpp"
 
+#include <boost/filesystem.hpp>
+
 using namespace aliceVision;
 using namespace aliceVision::matchingImageCollection;
 
@@ -69,3 +71,84 @@ BOOST_AUTO_TEST_CASE(load_multiple_pairs_per_line)
     BOOST_CHECK(loadedPairs == expectedPairs);
 }
 
+
+BOOST_AUTO_TEST_CASE(reorder_pairs_for_locality)
+{
+    // a chain of views 0-1-2-3-4 with shortcut pairs of length 2
+    const PairSet pairs = {
+        {0, 1}, {1, 2}, {2, 3}, {3, 4},
+        {0, 2}, {1, 3}, {2, 4}
+    };
+
+    const std::vector<Pair> orderedPairs = reorderPairsForLocality(pairs);
+
+    BOOST_CHECK_EQUAL(orderedPairs.size(), pairs.size());
+    BOOST_CHECK(PairSet(orderedPairs.begin(), orderedPairs.end()) == pairs);
+
+    // once a view is left behind, no later pair should need it again
+    // (the chain traversal only keeps a window of 3 consecutive views alive)
+    for (std::size_t i = 0; i < orderedPairs.size(); ++i)
+    {
+        const IndexT lastView = std::max(orderedPairs[i].first, orderedPairs[i].second);
+        for (std::size_t j = i + 1; j < orderedPairs.size(); ++j)
+        {
+            BOOST_CHECK(std::max(orderedPairs[j].first, orderedPairs[j].second) >= lastView);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(read_write_binary_pairs)
+{
+    PairVec pairs = {{5, 9}, {2, 8}, {0, 4}, {0, 1}, {4, 0}, {0, 2}, {0, 5}};
+    sortAndDeduplicatePairs(pairs);
+
+    const PairVec expectedPairs = {{0, 1}, {0, 2}, {0, 4}, {0, 5}, {2, 8}, {5, 9}};
+    BOOST_CHECK(pairs == expectedPairs);
+
+    BOOST_CHECK(savePairsToFile("pairsT_IO.bin", pairs));
+    BOOST_CHECK(isBinaryPairsFile("pairsT_IO.bin"));
+
+    PairVec loadedPairs;
+    BOOST_CHECK(loadPairsFromFile("pairsT_IO.bin", loadedPairs));
+    BOOST_CHECK(loadedPairs == expectedPairs);
+
+    // the binary lists are ranged by pair
+    PairVec rangePairs;
+    BOOST_CHECK(loadPairsFromFile("pairsT_IO.bin", rangePairs, 2, 3));
+    BOOST_CHECK(rangePairs == PairVec(expectedPairs.begin() + 2, expectedPairs.begin() + 5));
+
+    PairSet loadedPairSet;
+    BOOST_CHECK(loadPairsFromFile("pairsT_IO.bin", loadedPairSet));
+    BOOST_CHECK(loadedPairSet == PairSet(expectedPairs.begin(), expectedPairs.end()));
+    std::remove("pairsT_IO.bin");
+
+    // the text lists are sorted and deduplicated when loaded in a vector
+    BOOST_CHECK(savePairsToFile("pairsT_IO.txt", PairSet{{0, 2}, {2, 0}, {1, 3}}));
+    BOOST_CHECK(!isBinaryPairsFile("pairsT_IO.txt"));
+    PairVec loadedTextPairs;
+    BOOST_CHECK(loadPairsFromFile("pairsT_IO.txt", loadedTextPairs));
+    BOOST_CHECK(loadedTextPairs == PairVec({{0, 2}, {1, 3}}));
+    std::remove("pairsT_IO.txt");
+}
+
+BOOST_AUTO_TEST_CASE(read_write_binary_pairs_checks)
+{
+    // the binary lists are sorted and deduplicated when saved
+    BOOST_CHECK(savePairsToFile("pairsT_IO.bin", PairVec{{5, 9}, {4, 0}, {0, 4}, {0, 1}}));
+    PairVec loadedPairs;
+    BOOST_CHECK(loadPairsFromFile("pairsT_IO.bin", loadedPairs));
+    BOOST_CHECK(loadedPairs == PairVec({{0, 1}, {0, 4}, {5, 9}}));
+
+    BOOST_CHECK(savePairsToFile("pairsT_IO.bin", PairSet{{2, 0}, {0, 2}, {1, 3}}));
+    loadedPairs.clear();
+    BOOST_CHECK(loadPairsFromFile("pairsT_IO.bin", loadedPairs));
+    BOOST_CHECK(loadedPairs == PairVec({{0, 2}, {1, 3}}));
+
+    // a truncated file is rejected instead of allocating the announced number of pairs
+    const auto fileSize = boost::filesystem::file_size("pairsT_IO.bin");
+    boost::filesystem::resize_file("pairsT_IO.bin", fileSize - sizeof(IndexT));
+    loadedPairs.clear();
+    BOOST_CHECK(!loadPairsFromFile("pairsT_IO.bin", loadedPairs));
+    BOOST_CHECK(loadedPairs.empty());
+    std::remove("pairsT_IO.bin");
+}
@@ -7,6 +7,9 @@
 #include "geometricFilterUtils.hpp"
 #include <ceres/ceres.h>
 
+#include <algorithm>
+#include <numeric>
+
 namespace aliceVision {
 namespace matchingImageCollection {
 
@@ -36,6 +39,40 @@ void copyInlierMatches(const std::vector<size_t> &inliers,
   }
 }
 
+std::vector<std::size_t> sortMatchesByDistanceRatio(const matching::MatchesPerDescType &putativeMatchesPerType,
+                                                    const std::vector<feature::EImageDescriberType> &descTypes)
+{
+  // distance ratio by index, in the order of fillMatricesWithUndistortFeaturesMatches
+  std::vector<float> distanceRatios;
+  distanceRatios.reserve(putativeMatchesPerType.getNbAllMatches());
+  bool hasDistanceRatio = false;
+
+  for(const auto& descType : descTypes)
+  {
+    if(!putativeMatchesPerType.count(descType))
+      continue;
+
+    for(const matching::IndMatch& match : putativeMatchesPerType.at(descType))
+    {
+      // a null ratio is not computed, as bad as the ratio test limit
+      distanceRatios.push_back(match._distanceRatio > 0.f ? match._distanceRatio : 1.f);
+      hasDistanceRatio = hasDistanceRatio || match._distanceRatio > 0.f;
+    }
+  }
+
+  std::vector<std::size_t> sortedIndices;
+  if(!hasDistanceRatio)
+    return sortedIndices;
+
+  sortedIndices.resize(distanceRatios.size());
+  std::iota(sortedIndices.begin(), sortedIndices.end(), 0);
+  std::stable_sort(sortedIndices.begin(), sortedIndices.end(), [&](std::size_t a, std::size_t b)
+  {
+    return distanceRatios[a] < distanceRatios[b];
+  });
+  return sortedIndices;
+}
+
 void centerMatrix(const Eigen::Matrix2Xf & points2d, Mat3 & t)
 {
   t = Mat3::Identity();
@@ -173,6 +173,16 @@ void copyInlierMatches(const std::vector<size_t> &inliers,
                        const std::vector<feature::EImageDescriberType> &descTypes,
                        matching::MatchesPerDescType &out_geometricInliersPerType);
 
+/**
+ * @brief Get the indices of the matches in the matrices of fillMatricesWithUndistortFeaturesMatches
+ * sorted by increasing distance ratio, the matches without distance ratio last.
+ * @param[in] putativeMatchesPerType
+ * @param[in] descTypes
+ * @return the sorted indices, empty if no match has a distance ratio
+ */
+std::vector<std::size_t> sortMatchesByDistanceRatio(const matching::MatchesPerDescType &putativeMatchesPerType,
+                                                    const std::vector<feature::EImageDescriberType> &descTypes);
+
 /**
  * @brief Compute the transformation that standardize the input points so that
  * they are z-scores (i.e. zero mean and unit standard deviation).
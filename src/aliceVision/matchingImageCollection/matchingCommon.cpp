@@ -28,6 +28,8 @@ std::unique_ptr<IImageCollectionMatcher> createImageCollectionMatcher(matching::
     case matching::CASCADE_HASHING_L2:      matcherPtr.reset(new ImageCollectionMatcher_generic(distRatio, crossMatching, matching::CASCADE_HASHING_L2)); break;
     case matching::FAST_CASCADE_HASHING_L2: matcherPtr.reset(new ImageCollectionMatcher_cascadeHashing(distRatio)); break;
     case matching::BRUTE_FORCE_HAMMING:     matcherPtr.reset(new ImageCollectionMatcher_generic(distRatio, crossMatching, matching::BRUTE_FORCE_HAMMING)); break;
+    case matching::GPU_BRUTE_FORCE_L2:      matcherPtr.reset(new ImageCollectionMatcher_generic(distRatio, crossMatching, matching::GPU_BRUTE_FORCE_L2)); break;
+    case matching::PRODUCT_QUANTIZATION_L2: matcherPtr.reset(new ImageCollectionMatcher_generic(distRatio, crossMatching, matching::PRODUCT_QUANTIZATION_L2)); break;
     
     default: throw std::out_of_range("Invalid matcherType enum");
   }
@@ -6,6 +6,8 @@
 
 #include "Mesh.hpp"
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+#include <aliceVision/mesh/meshFilter.hpp>
 #include <aliceVision/mesh/meshVisibility.hpp>
 #include <aliceVision/mvsData/geometry.hpp>
 #include <aliceVision/mvsData/OrientedPoint.hpp>
@@ -15,6 +17,7 @@
 
 #include <boost/atomic/atomic_ref.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 #include <boost/algorithm/string/case_conv.hpp> 
 
 #include <assimp/Importer.hpp>
@@ -23,8 +26,14 @@
 #include <assimp/scene.h>
 #include <Eigen/Dense>
 
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
+#include <limits>
 #include <map>
+#include <sstream>
+#include <unordered_map>
 
 namespace aliceVision {
 namespace mesh {
@@ -86,6 +95,24 @@ std::istream& operator>>(std::istream& in, EFileType& meshFileType)
 void Mesh::save(const std::string& filepath)
 {
     const std::string fileTypeStr = boost::filesystem::path(filepath).extension().string().substr(1);
+
+    const std::string fileTypeLower = boost::algorithm::to_lower_copy(fileTypeStr);
+    if(fileTypeLower == "bin")
+    {
+        saveToBin(filepath);
+        return;
+    }
+    if(fileTypeLower == "obj")
+    {
+        saveToObj(filepath);
+        return;
+    }
+    if(fileTypeLower == "ply")
+    {
+        saveToPly(filepath);
+        return;
+    }
+
     const EFileType fileType = mesh::EFileType_stringToEnum(fileTypeStr);
 
     ALICEVISION_LOG_INFO("Save " << fileTypeStr << " mesh file");
@@ -108,106 +135,1307 @@ void Mesh::save(const std::string& filepath)
     aiMesh * aimesh = scene.mMeshes[0];
     aimesh->mMaterialIndex = 0;
 
-    aimesh->mNumVertices = pts.size();
-    aimesh->mVertices = new aiVector3D[pts.size()];
+    aimesh->mNumVertices = pts.size();
+    aimesh->mVertices = new aiVector3D[pts.size()];
+
+    int index = 0;
+    for (const auto & p : pts)
+    {
+        aimesh->mVertices[index].x = p.x;
+        aimesh->mVertices[index].y = -p.y;
+        aimesh->mVertices[index].z = -p.z;
+
+        ++index;
+    }
+
+    aimesh->mNumFaces = tris.size();
+    aimesh->mFaces = new aiFace[tris.size()];
+
+    for(int i = 0; i < tris.size(); ++i)
+    {
+        aimesh->mFaces[i].mNumIndices = 3;
+        aimesh->mFaces[i].mIndices = new unsigned int[3];
+
+        for (int k = 0; k < 3; ++k)
+        {
+            aimesh->mFaces[i].mIndices[k] = tris[i].v[k];
+        }
+    }
+
+    std::string formatId = fileTypeStr;
+    unsigned int pPreprocessing = 0u;
+    // If gltf, use gltf 2.0
+    if (fileType == EFileType::GLTF)
+    {
+        formatId = "gltf2";
+        // gen normals in order to have correct shading in Qt 3D Scene
+        // but cause problems with assimp importer
+        pPreprocessing |= aiProcess_GenNormals;
+    }
+
+    Assimp::Exporter exporter;
+    exporter.Export(&scene, formatId, filepath, pPreprocessing);
+
+    ALICEVISION_LOG_INFO("Save mesh to " << fileTypeStr << " done.");
+
+    ALICEVISION_LOG_DEBUG("Vertices: " << pts.size());
+    ALICEVISION_LOG_DEBUG("Triangles: " << tris.size());
+    ALICEVISION_LOG_DEBUG("UVs: " << uvCoords.size());  
+    ALICEVISION_LOG_DEBUG("Normals: " << normals.size());
+}
+
+namespace {
+
+/**
+ * @brief Binary mesh file layout.
+ *
+ * A MeshBinHeader followed by the sections of the mesh arrays, each section starting on an 8 bytes boundary.
+ * The vertices visibilities are stored as a compressed sparse row: the cameras of vertex i
+ * are in [visibilitiesOffsets[i], visibilitiesOffsets[i+1]) of the visibilities cameras section.
+ * Empty optional sections (visibilities, normals, UVs, colors, materials) have a zero count.
+ */
+enum EMeshBinSection
+{
+    eMeshBinPoints = 0,
+    eMeshBinTriangles,
+    eMeshBinVisibilitiesOffsets,
+    eMeshBinVisibilitiesCameras,
+    eMeshBinNormals,
+    eMeshBinTrisNormalsIds,
+    eMeshBinUVCoords,
+    eMeshBinTrisUvIds,
+    eMeshBinColors,
+    eMeshBinTrisMtlIds,
+    eMeshBinNbSections
+};
+
+struct MeshBinSection
+{
+    std::uint64_t offset = 0;
+    std::uint64_t count = 0;
+};
+
+struct MeshBinHeader
+{
+    static constexpr std::uint32_t currentVersion = 1;
+
+    char magic[8] = {'A', 'V', 'M', 'E', 'S', 'H', '\0', '\0'};
+    std::uint32_t version = currentVersion;
+    std::int32_t nmtls = 0;
+    MeshBinSection sections[eMeshBinNbSections];
+
+    bool isValid() const { return std::memcmp(magic, MeshBinHeader().magic, sizeof(magic)) == 0; }
+};
+
+class MeshBinWriter
+{
+public:
+    MeshBinWriter(const std::string& filepath)
+        : _filepath(filepath)
+        , _file(filepath, std::ios::out | std::ios::binary)
+    {
+        if(!_file.is_open())
+            ALICEVISION_THROW_ERROR("Can't create mesh file, can't open '" << filepath << "'.");
+
+        // placeholder header, updated in close()
+        _file.write(reinterpret_cast<const char*>(&_header), sizeof(MeshBinHeader));
+    }
+
+    template <typename T>
+    void writeSection(EMeshBinSection section, const T* data, std::size_t count)
+    {
+        // align the sections to allow a direct access to the mapped file
+        const std::uint64_t position = static_cast<std::uint64_t>(_file.tellp());
+        const char padding[8] = {0};
+        _file.write(padding, (8 - position % 8) % 8);
+
+        _header.sections[section].offset = static_cast<std::uint64_t>(_file.tellp());
+        _header.sections[section].count = count;
+        if(count > 0)
+            _file.write(reinterpret_cast<const char*>(data), count * sizeof(T));
+    }
+
+    void close(int nmtls)
+    {
+        _header.nmtls = nmtls;
+        _file.seekp(0);
+        _file.write(reinterpret_cast<const char*>(&_header), sizeof(MeshBinHeader));
+
+        if(!_file.good())
+            ALICEVISION_THROW_ERROR("Can't write mesh file, '" << _filepath << "' is incorrect.");
+        _file.close();
+    }
+
+private:
+    std::string _filepath;
+    std::ofstream _file;
+    MeshBinHeader _header;
+};
+
+template <typename T>
+void readSection(const boost::iostreams::mapped_file_source& file, const MeshBinHeader& header,
+                 EMeshBinSection section, std::vector<T>& out)
+{
+    const MeshBinSection& s = header.sections[section];
+    out.resize(s.count);
+    if(s.count > 0)
+        std::memcpy(out.data(), file.data() + s.offset, s.count * sizeof(T));
+}
+
+} // namespace
+
+bool Mesh::loadFromBin(const std::string& binFilepath)
+{
+    boost::iostreams::mapped_file_source file;
+    try
+    {
+        file.open(binFilepath);
+    }
+    catch(const std::exception&)
+    {
+        return false;
+    }
+
+    MeshBinHeader header;
+    if(file.size() >= sizeof(MeshBinHeader))
+        std::memcpy(&header, file.data(), sizeof(MeshBinHeader));
+
+    if(file.size() < sizeof(MeshBinHeader) || !header.isValid())
+    {
+        // legacy layout: points and triangles only
+        file.close();
+        return loadFromLegacyBin(binFilepath);
+    }
+
+    if(header.version > MeshBinHeader::currentVersion)
+    {
+        ALICEVISION_LOG_ERROR("Can't load mesh file, '" << binFilepath << "' has an unsupported version (" << header.version << ").");
+        return false;
+    }
+
+    const std::size_t elementSizes[eMeshBinNbSections] = {
+        sizeof(Point3d), sizeof(Mesh::triangle), sizeof(std::uint64_t), sizeof(int), sizeof(Point3d),
+        sizeof(Voxel), sizeof(Point2d), sizeof(Voxel), sizeof(rgb), sizeof(int)};
+
+    for(int i = 0; i < eMeshBinNbSections; ++i)
+    {
+        const MeshBinSection& s = header.sections[i];
+        if(s.offset > file.size() || s.count > (file.size() - s.offset) / elementSizes[i])
+        {
+            ALICEVISION_LOG_ERROR("Can't load mesh file, '" << binFilepath << "' is truncated.");
+            return false;
+        }
+    }
+
+    readSection(file, header, eMeshBinPoints, pts.getDataWritable());
+    readSection(file, header, eMeshBinTriangles, tris.getDataWritable());
+    readSection(file, header, eMeshBinNormals, normals.getDataWritable());
+    readSection(file, header, eMeshBinTrisNormalsIds, trisNormalsIds.getDataWritable());
+    readSection(file, header, eMeshBinUVCoords, uvCoords.getDataWritable());
+    readSection(file, header, eMeshBinTrisUvIds, trisUvIds.getDataWritable());
+    readSection(file, header, eMeshBinColors, _colors);
+    readSection(file, header, eMeshBinTrisMtlIds, _trisMtlIds);
+    nmtls = header.nmtls;
+
+    // vertices visibilities
+    pointsVisibilities.clear();
+    const MeshBinSection& offsetsSection = header.sections[eMeshBinVisibilitiesOffsets];
+    if(offsetsSection.count > 0)
+    {
+        const MeshBinSection& camerasSection = header.sections[eMeshBinVisibilitiesCameras];
+        const std::uint64_t* offsets = reinterpret_cast<const std::uint64_t*>(file.data() + offsetsSection.offset);
+        const int* cameras = reinterpret_cast<const int*>(file.data() + camerasSection.offset);
+
+        if(offsetsSection.count != std::uint64_t(pts.size()) + 1 || offsets[offsetsSection.count - 1] != camerasSection.count)
+        {
+            ALICEVISION_LOG_ERROR("Can't load mesh file, '" << binFilepath << "' has invalid visibilities.");
+            return false;
+        }
+
+        pointsVisibilities.resize(pts.size());
+        for(int i = 0; i < pts.size(); ++i)
+        {
+            if(offsets[i] > offsets[i + 1])
+            {
+                ALICEVISION_LOG_ERROR("Can't load mesh file, '" << binFilepath << "' has invalid visibilities.");
+                pointsVisibilities.clear();
+                return false;
+            }
+            pointsVisibilities[i].getDataWritable().assign(cameras + offsets[i], cameras + offsets[i + 1]);
+        }
+    }
+    return true;
+}
+
+bool Mesh::loadFromLegacyBin(const std::string& binFilepath)
+{
+    FILE* f = fopen(binFilepath.c_str(), "rb");
+
+    if(f == nullptr)
+        return false;
+
+    int npts;
+    fread(&npts, sizeof(int), 1, f);
+    pts = StaticVector<Point3d>();
+    pts.resize(npts);
+    fread(&pts[0], sizeof(Point3d), npts, f);
+
+    int ntris;
+    fread(&ntris, sizeof(int), 1, f);
+    tris = StaticVector<Mesh::triangle>();
+    tris.resize(ntris);
+    fread(&tris[0], sizeof(Mesh::triangle), ntris, f);
+
+    fclose(f);
+    return true;
+}
+
+void Mesh::saveToBin(const std::string& binFilepath) const
+{
+    long t = std::clock();
+    ALICEVISION_LOG_DEBUG("Save mesh to bin.");
+
+    MeshBinWriter writer(binFilepath);
+
+    writer.writeSection(eMeshBinPoints, pts.getData().data(), pts.size());
+    writer.writeSection(eMeshBinTriangles, tris.getData().data(), tris.size());
+
+    // vertices visibilities as a compressed sparse row
+    if(!pointsVisibilities.empty())
+    {
+        if(pointsVisibilities.size() != pts.size())
+            ALICEVISION_THROW_ERROR("Can't save mesh file '" << binFilepath << "': " << pointsVisibilities.size()
+                                    << " visibilities for " << pts.size() << " vertices.");
+
+        std::vector<std::uint64_t> offsets(pts.size() + 1, 0);
+        for(int i = 0; i < pts.size(); ++i)
+            offsets[i + 1] = offsets[i] + pointsVisibilities[i].size();
+
+        std::vector<int> cameras;
+        cameras.reserve(offsets.back());
+        for(int i = 0; i < pts.size(); ++i)
+            cameras.insert(cameras.end(), pointsVisibilities[i].begin(), pointsVisibilities[i].end());
+
+        writer.writeSection(eMeshBinVisibilitiesOffsets, offsets.data(), offsets.size());
+        writer.writeSection(eMeshBinVisibilitiesCameras, cameras.data(), cameras.size());
+    }
+
+    writer.writeSection(eMeshBinNormals, normals.getData().data(), normals.size());
+    writer.writeSection(eMeshBinTrisNormalsIds, trisNormalsIds.getData().data(), trisNormalsIds.size());
+    writer.writeSection(eMeshBinUVCoords, uvCoords.getData().data(), uvCoords.size());
+    writer.writeSection(eMeshBinTrisUvIds, trisUvIds.getData().data(), trisUvIds.size());
+    writer.writeSection(eMeshBinColors, _colors.data(), _colors.size());
+    writer.writeSection(eMeshBinTrisMtlIds, _trisMtlIds.data(), _trisMtlIds.size());
+    writer.close(nmtls);
+
+    mvsUtils::printfElapsedTime(t, "Save mesh to bin ");
+}
+
+namespace {
+
+/// Powers of 10 exactly representable in double
+const double exactPowersOf10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+inline bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+inline void skipSpaces(const char*& p, const char* end)
+{
+    while(p < end && isSpace(*p))
+        ++p;
+}
+
+/**
+ * @brief Parse a decimal number (locale independent), p is moved after the number.
+ *        The result is correctly rounded up to 15 significant digits with a decimal exponent in [-22, 22],
+ *        within a few ulps otherwise.
+ */
+bool parseDouble(const char*& p, const char* end, double& out)
+{
+    const char* s = p;
+    bool negative = false;
+    if(s < end && (*s == '-' || *s == '+'))
+        negative = (*s++ == '-');
+
+    std::uint64_t mantissa = 0;
+    int nbSignificantDigits = 0;
+    int exponent = 0;
+    bool hasDigits = false;
+    for(; s < end && *s >= '0' && *s <= '9'; ++s)
+    {
+        hasDigits = true;
+        if(nbSignificantDigits < 19)
+        {
+            mantissa = mantissa * 10 + (*s - '0');
+            nbSignificantDigits += (mantissa != 0);
+        }
+        else
+            ++exponent;
+    }
+    if(s < end && *s == '.')
+    {
+        for(++s; s < end && *s >= '0' && *s <= '9'; ++s)
+        {
+            hasDigits = true;
+            if(nbSignificantDigits < 19)
+            {
+                mantissa = mantissa * 10 + (*s - '0');
+                nbSignificantDigits += (mantissa != 0);
+                --exponent;
+            }
+        }
+    }
+    if(!hasDigits)
+        return false;
+
+    if(s < end && (*s == 'e' || *s == 'E'))
+    {
+        const char* e = s + 1;
+        bool negativeExponent = false;
+        if(e < end && (*e == '-' || *e == '+'))
+            negativeExponent = (*e++ == '-');
+        if(e < end && *e >= '0' && *e <= '9')
+        {
+            int exponentValue = 0;
+            for(; e < end && *e >= '0' && *e <= '9'; ++e)
+                exponentValue = std::min(exponentValue * 10 + (*e - '0'), 100000);
+            exponent += negativeExponent ? -exponentValue : exponentValue;
+            s = e;
+        }
+    }
+
+    double value = static_cast<double>(mantissa);
+    if(mantissa != 0 && exponent != 0)
+    {
+        if(exponent > 0 && exponent <= 22)
+            value *= exactPowersOf10[exponent];
+        else if(exponent < 0 && exponent >= -22)
+            value /= exactPowersOf10[-exponent];
+        else if(exponent < 0)
+            value = value / std::pow(10.0, -exponent / 2) / std::pow(10.0, -exponent + exponent / 2); // avoid the underflow of 10^exponent
+        else
+            value *= std::pow(10.0, exponent);
+    }
+    out = negative ? -value : value;
+    p = s;
+    return true;
+}
+
+bool parseInt(const char*& p, const char* end, long long& out)
+{
+    const char* s = p;
+    bool negative = false;
+    if(s < end && (*s == '-' || *s == '+'))
+        negative = (*s++ == '-');
+    if(s == end || *s < '0' || *s > '9')
+        return false;
+    long long value = 0;
+    for(; s < end && *s >= '0' && *s <= '9'; ++s)
+        value = value * 10 + (*s - '0');
+    out = negative ? -value : value;
+    p = s;
+    return true;
+}
+
+/// Write a number with 9 significant digits, like "%.9g" without the exponent notation in the usual range
+char* writeDouble(char* out, double value)
+{
+    const double absValue = std::abs(value);
+    if(absValue == 0.0)
+    {
+        *out++ = '0';
+        return out;
+    }
+    if(!(absValue >= 1e-4 && absValue < 1e9))
+        return out + std::sprintf(out, "%.9g", value);
+
+    static const std::uint64_t integerPowersOf10[] = {1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull,
+                                                      10000000ull, 100000000ull, 1000000000ull, 10000000000ull,
+                                                      100000000000ull, 1000000000000ull};
+    const int decimals = std::max(0, 8 - static_cast<int>(std::floor(std::log10(absValue))));
+    const std::uint64_t scaled = static_cast<std::uint64_t>(std::llround(absValue * exactPowersOf10[decimals]));
+    const std::uint64_t integerPart = scaled / integerPowersOf10[decimals];
+    std::uint64_t fractionalPart = scaled % integerPowersOf10[decimals];
+
+    if(value < 0)
+        *out++ = '-';
+    char digits[20];
+    int nbDigits = 0;
+    std::uint64_t v = integerPart;
+    do
+    {
+        digits[nbDigits++] = char('0' + v % 10);
+        v /= 10;
+    } while(v != 0);
+    while(nbDigits > 0)
+        *out++ = digits[--nbDigits];
+
+    if(fractionalPart != 0)
+    {
+        int nbDecimals = decimals;
+        while(fractionalPart % 10 == 0)
+        {
+            fractionalPart /= 10;
+            --nbDecimals;
+        }
+        *out++ = '.';
+        for(int i = nbDecimals - 1; i >= 0; --i)
+        {
+            out[i] = char('0' + fractionalPart % 10);
+            fractionalPart /= 10;
+        }
+        out += nbDecimals;
+    }
+    return out;
+}
+
+char* writeInt(char* out, long long value)
+{
+    if(value < 0)
+    {
+        *out++ = '-';
+        value = -value;
+    }
+    char digits[20];
+    int nbDigits = 0;
+    do
+    {
+        digits[nbDigits++] = char('0' + value % 10);
+        value /= 10;
+    } while(value != 0);
+    while(nbDigits > 0)
+        *out++ = digits[--nbDigits];
+    return out;
+}
+
+/**
+ * @brief Vertices and triangulated faces read from a mesh file, the triangle corners reference
+ *        a point and a texture coordinate of the file (-1 if none).
+ */
+struct MeshFileData
+{
+    std::vector<Point3d> points;
+    std::vector<rgb> colors; //< empty or one per point
+    std::vector<Point2d> uvs;
+    std::vector<int> cornersPoint;
+    std::vector<int> cornersUv;  //< empty or one per corner
+    std::vector<int> trisMtl;    //< empty or one per triangle
+};
+
+/**
+ * @brief Convert the data of a mesh file to the mesh arrays, like the generic importer the vertices are
+ *        the distinct (point, texture coordinates) pairs, the degenerate triangles are removed and the Y and Z axes are flipped.
+ *        The vertices of the used points are in the file order, followed by the vertices of the points used with
+ *        other texture coordinates, so a mesh saved without texture coordinates is loaded identically.
+ */
+void convertMeshFileData(const MeshFileData& data, std::vector<Point3d>& pts, std::vector<Mesh::triangle>& tris,
+                         std::vector<Point2d>& uvCoords, std::vector<Voxel>& trisUvIds, std::vector<rgb>& colors,
+                         std::vector<int>& trisMtlIds)
+{
+    const bool hasUvs = !data.cornersUv.empty();
+    const bool hasColors = !data.colors.empty();
+    const std::size_t nbTris = data.cornersPoint.size() / 3;
+    const auto isDegenerate = [&](std::size_t t) {
+        const int* corners = &data.cornersPoint[3 * t];
+        return corners[0] == corners[1] || corners[1] == corners[2] || corners[0] == corners[2];
+    };
+    const int unused = -2;
+
+    // the texture coordinates of the first use of each point
+    std::vector<int> pointUv(data.points.size(), unused);
+    for(std::size_t t = 0; t < nbTris; ++t)
+    {
+        if(isDegenerate(t))
+            continue;
+        for(int k = 0; k < 3; ++k)
+        {
+            int& uv = pointUv[data.cornersPoint[3 * t + k]];
+            if(uv == unused)
+                uv = hasUvs ? data.cornersUv[3 * t + k] : -1;
+        }
+    }
+
+    pts.clear();
+    tris.clear();
+    uvCoords.clear();
+    trisUvIds.clear();
+    colors.clear();
+    trisMtlIds.clear();
+    tris.reserve(nbTris);
+    trisUvIds.reserve(nbTris);
+    trisMtlIds.reserve(nbTris);
+
+    const auto addVertex = [&](int point, int uv) {
+        const Point3d& p = data.points[point];
+        pts.emplace_back(p.x, -p.y, -p.z);
+        if(hasColors)
+            colors.push_back(data.colors[point]);
+        if(hasUvs)
+            uvCoords.push_back(uv >= 0 ? data.uvs[uv] : Point2d(0.0, 0.0));
+        return int(pts.size() - 1);
+    };
+
+    std::vector<int> pointVertex(data.points.size(), -1);
+    for(std::size_t point = 0; point < data.points.size(); ++point)
+    {
+        if(pointUv[point] != unused)
+            pointVertex[point] = addVertex(int(point), pointUv[point]);
+    }
+
+    std::unordered_map<std::uint64_t, int> otherVertices; // vertices of the points used with other texture coordinates
+    for(std::size_t t = 0; t < nbTris; ++t)
+    {
+        if(isDegenerate(t))
+            continue;
+
+        Mesh::triangle triangle;
+        for(int k = 0; k < 3; ++k)
+        {
+            const int point = data.cornersPoint[3 * t + k];
+            const int uv = hasUvs ? data.cornersUv[3 * t + k] : -1;
+            if(pointUv[point] == uv)
+            {
+                triangle.v[k] = pointVertex[point];
+                continue;
+            }
+            const std::uint64_t key = (std::uint64_t(std::uint32_t(point)) << 32) | std::uint32_t(uv);
+            const auto it = otherVertices.find(key);
+            triangle.v[k] = (it != otherVertices.end()) ? it->second : (otherVertices[key] = addVertex(point, uv));
+        }
+        tris.push_back(triangle);
+        trisUvIds.push_back(hasUvs ? Voxel(triangle.v[0], triangle.v[1], triangle.v[2]) : Voxel());
+        trisMtlIds.push_back(data.trisMtl.empty() ? 0 : data.trisMtl[t]);
+    }
+}
+
+/// The data of a chunk of lines of an OBJ file
+struct ObjChunk
+{
+    std::vector<Point3d> points;
+    std::vector<rgb> colors; //< one per point, black if the point has no color
+    std::vector<Point2d> uvs;
+    std::vector<int> cornersPoint;
+    std::vector<int> cornersUv;
+    std::vector<std::size_t> relativePointCorners; //< corners relative to the first point of the chunk
+    std::vector<std::size_t> relativeUvCorners;
+    std::vector<std::pair<std::size_t, std::string>> materials; //< first triangle of each "usemtl"
+    bool hasColors = false;
+    bool hasUvCorners = false;
+    bool valid = true;
+};
+
+void parseObjChunk(const char* p, const char* end, ObjChunk& chunk)
+{
+    std::vector<std::pair<long long, long long>> faceCorners;
+
+    while(p < end && chunk.valid)
+    {
+        const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if(lineEnd == nullptr)
+            lineEnd = end;
+        const char* s = p;
+        p = lineEnd + 1;
+
+        skipSpaces(s, lineEnd);
+        if(lineEnd - s < 2)
+            continue;
+
+        if(s[0] == 'v' && isSpace(s[1]))
+        {
+            s += 2;
+            double values[6];
+            int nbValues = 0;
+            for(; nbValues < 6; ++nbValues)
+            {
+                skipSpaces(s, lineEnd);
+                if(!parseDouble(s, lineEnd, values[nbValues]))
+                    break;
+            }
+            if(nbValues < 3)
+            {
+                chunk.valid = false;
+                break;
+            }
+            chunk.points.emplace_back(values[0], values[1], values[2]);
+            if(nbValues == 6)
+            {
+                const auto toUChar = [](double c) { return static_cast<unsigned char>(std::min(std::max(c * 255.0, 0.0), 255.0)); };
+                chunk.colors.emplace_back(toUChar(values[3]), toUChar(values[4]), toUChar(values[5]));
+                chunk.hasColors = true;
+            }
+            else
+                chunk.colors.emplace_back();
+        }
+        else if(s[0] == 'v' && s[1] == 't')
+        {
+            s += 2;
+            double u = 0.0, v = 0.0;
+            skipSpaces(s, lineEnd);
+            if(!parseDouble(s, lineEnd, u))
+            {
+                chunk.valid = false;
+                break;
+            }
+            skipSpaces(s, lineEnd);
+            parseDouble(s, lineEnd, v);
+            chunk.uvs.emplace_back(u, v);
+        }
+        else if(s[0] == 'f' && isSpace(s[1]))
+        {
+            s += 2;
+            faceCorners.clear();
+            while(true)
+            {
+                skipSpaces(s, lineEnd);
+                long long point = 0;
+                long long uv = 0; // 0: no texture coordinate
+                if(!parseInt(s, lineEnd, point))
+                    break;
+                if(s < lineEnd && *s == '/')
+                {
+                    ++s;
+                    parseInt(s, lineEnd, uv);
+                    if(s < lineEnd && *s == '/')
+                    {
+                        long long normal;
+                        ++s;
+                        parseInt(s, lineEnd, normal);
+                    }
+                }
+                if(point == 0 || (s < lineEnd && !isSpace(*s)))
+                {
+                    chunk.valid = false;
+                    break;
+                }
+                faceCorners.emplace_back(point, uv);
+            }
+            if(!chunk.valid)
+                break;
+
+            // triangle fan
+            for(std::size_t i = 1; i + 1 < faceCorners.size(); ++i)
+            {
+                for(const std::size_t c : {std::size_t(0), i, i + 1})
+                {
+                    const long long point = faceCorners[c].first;
+                    const long long uv = faceCorners[c].second;
+                    if(point < 0)
+                        chunk.relativePointCorners.push_back(chunk.cornersPoint.size());
+                    chunk.cornersPoint.push_back(int(point < 0 ? (long long)(chunk.points.size()) + point : point - 1));
+                    if(uv < 0)
+                        chunk.relativeUvCorners.push_back(chunk.cornersUv.size());
+                    chunk.cornersUv.push_back(int(uv < 0 ? (long long)(chunk.uvs.size()) + uv : uv - 1));
+                    chunk.hasUvCorners |= (uv != 0);
+                }
+            }
+        }
+        else if(lineEnd - s > 7 && std::strncmp(s, "usemtl", 6) == 0 && isSpace(s[6]))
+        {
+            s += 7;
+            skipSpaces(s, lineEnd);
+            const char* nameEnd = lineEnd;
+            while(nameEnd > s && isSpace(nameEnd[-1]))
+                --nameEnd;
+            chunk.materials.emplace_back(chunk.cornersPoint.size() / 3, std::string(s, nameEnd));
+        }
+        // the normals, the groups, the lines and the other statements are ignored
+    }
+}
+
+/// Format the elements [0, nbElements) by blocks in parallel and write the blocks in order
+template <typename FormatBlockFunc>
+void writeBlocks(std::ofstream& file, std::size_t nbElements, FormatBlockFunc formatBlock)
+{
+    const std::size_t blockSize = 1 << 16;
+    const std::size_t nbBlocks = (nbElements + blockSize - 1) / blockSize;
+    const std::size_t nbBatchBlocks = 4 * std::size_t(omp_get_max_threads());
+    std::vector<std::string> buffers(nbBatchBlocks);
+
+    for(std::size_t batchBegin = 0; batchBegin < nbBlocks; batchBegin += nbBatchBlocks)
+    {
+        const int nbBlocksInBatch = int(std::min(nbBatchBlocks, nbBlocks - batchBegin));
+
+        #pragma omp parallel for
+        for(int b = 0; b < nbBlocksInBatch; ++b)
+        {
+            const std::size_t begin = (batchBegin + b) * blockSize;
+            buffers[b].clear();
+            formatBlock(buffers[b], begin, std::min(begin + blockSize, nbElements));
+        }
+        for(int b = 0; b < nbBlocksInBatch; ++b)
+            file.write(buffers[b].data(), buffers[b].size());
+    }
+}
+
+enum class EPlyType
+{
+    Int8, UInt8, Int16, UInt16, Int32, UInt32, Float32, Float64, Unknown
+};
+
+EPlyType plyTypeFromString(const std::string& type)
+{
+    if(type == "char" || type == "int8") return EPlyType::Int8;
+    if(type == "uchar" || type == "uint8") return EPlyType::UInt8;
+    if(type == "short" || type == "int16") return EPlyType::Int16;
+    if(type == "ushort" || type == "uint16") return EPlyType::UInt16;
+    if(type == "int" || type == "int32") return EPlyType::Int32;
+    if(type == "uint" || type == "uint32") return EPlyType::UInt32;
+    if(type == "float" || type == "float32") return EPlyType::Float32;
+    if(type == "double" || type == "float64") return EPlyType::Float64;
+    return EPlyType::Unknown;
+}
+
+std::size_t plyTypeSize(EPlyType type)
+{
+    switch(type)
+    {
+        case EPlyType::Int8:
+        case EPlyType::UInt8: return 1;
+        case EPlyType::Int16:
+        case EPlyType::UInt16: return 2;
+        case EPlyType::Int32:
+        case EPlyType::UInt32:
+        case EPlyType::Float32: return 4;
+        case EPlyType::Float64: return 8;
+        case EPlyType::Unknown: break;
+    }
+    return 0;
+}
+
+/// Read a little-endian scalar of a binary PLY file
+double readPlyScalar(const char* data, EPlyType type)
+{
+    switch(type)
+    {
+        case EPlyType::Int8: { std::int8_t v; std::memcpy(&v, data, sizeof(v)); return v; }
+        case EPlyType::UInt8: { std::uint8_t v; std::memcpy(&v, data, sizeof(v)); return v; }
+        case EPlyType::Int16: { std::int16_t v; std::memcpy(&v, data, sizeof(v)); return v; }
+        case EPlyType::UInt16: { std::uint16_t v; std::memcpy(&v, data, sizeof(v)); return v; }
+        case EPlyType::Int32: { std::int32_t v; std::memcpy(&v, data, sizeof(v)); return v; }
+        case EPlyType::UInt32: { std::uint32_t v; std::memcpy(&v, data, sizeof(v)); return v; }
+        case EPlyType::Float32: { float v; std::memcpy(&v, data, sizeof(v)); return v; }
+        case EPlyType::Float64: { double v; std::memcpy(&v, data, sizeof(v)); return v; }
+        case EPlyType::Unknown: break;
+    }
+    return 0.0;
+}
+
+struct PlyProperty
+{
+    std::string name;
+    EPlyType type = EPlyType::Unknown;
+    bool isList = false;
+    EPlyType countType = EPlyType::Unknown;
+    std::size_t offset = 0; //< offset in the element record (scalar properties only)
+};
+
+struct PlyElement
+{
+    std::string name;
+    std::size_t count = 0;
+    std::vector<PlyProperty> properties;
+
+    bool hasListProperty() const
+    {
+        return std::any_of(properties.begin(), properties.end(), [](const PlyProperty& p) { return p.isList; });
+    }
+    /// record size of the scalar properties
+    std::size_t scalarsSize() const
+    {
+        std::size_t size = 0;
+        for(const PlyProperty& p : properties)
+            if(!p.isList)
+                size += plyTypeSize(p.type);
+        return size;
+    }
+    const PlyProperty* find(std::initializer_list<const char*> names) const
+    {
+        for(const char* name : names)
+            for(const PlyProperty& p : properties)
+                if(!p.isList && p.name == name)
+                    return &p;
+        return nullptr;
+    }
+};
+
+} // namespace
+
+bool Mesh::loadFromObj(const std::string& objFilepath)
+{
+    long t = std::clock();
+    boost::iostreams::mapped_file_source file;
+    try
+    {
+        file.open(objFilepath);
+    }
+    catch(const std::exception&)
+    {
+        return false;
+    }
+    const char* data = file.data();
+    const std::size_t size = file.size();
+
+    // chunks of whole lines, parsed in parallel
+    const std::size_t nbChunks = std::max(std::size_t(1), std::min(4 * std::size_t(omp_get_max_threads()), size / (1 << 20)));
+    std::vector<const char*> chunksBegin(nbChunks + 1, data + size);
+    chunksBegin[0] = data;
+    for(std::size_t i = 1; i < nbChunks; ++i)
+    {
+        const char* begin = std::max(chunksBegin[i - 1], data + i * (size / nbChunks));
+        const char* lineEnd = static_cast<const char*>(std::memchr(begin, '\n', data + size - begin));
+        chunksBegin[i] = (lineEnd == nullptr) ? data + size : lineEnd + 1;
+    }
+
+    std::vector<ObjChunk> chunks(nbChunks);
+    #pragma omp parallel for schedule(dynamic)
+    for(int i = 0; i < int(nbChunks); ++i)
+        parseObjChunk(chunksBegin[i], chunksBegin[i + 1], chunks[i]);
+
+    // concatenate the chunks
+    std::vector<std::size_t> pointsOffset(nbChunks + 1, 0), uvsOffset(nbChunks + 1, 0), cornersOffset(nbChunks + 1, 0);
+    bool hasColors = false;
+    bool hasUvs = false;
+    for(std::size_t i = 0; i < nbChunks; ++i)
+    {
+        if(!chunks[i].valid)
+        {
+            ALICEVISION_LOG_WARNING("Unsupported OBJ syntax in mesh file: " << objFilepath);
+            return false;
+        }
+        pointsOffset[i + 1] = pointsOffset[i] + chunks[i].points.size();
+        uvsOffset[i + 1] = uvsOffset[i] + chunks[i].uvs.size();
+        cornersOffset[i + 1] = cornersOffset[i] + chunks[i].cornersPoint.size();
+        hasColors |= chunks[i].hasColors;
+        hasUvs |= chunks[i].hasUvCorners;
+    }
+    if(pointsOffset.back() > std::size_t(std::numeric_limits<int>::max()) || uvsOffset.back() > std::size_t(std::numeric_limits<int>::max()))
+        return false;
+
+    MeshFileData meshData;
+    meshData.points.resize(pointsOffset.back());
+    meshData.colors.resize(hasColors ? pointsOffset.back() : 0);
+    meshData.uvs.resize(uvsOffset.back());
+    meshData.cornersPoint.resize(cornersOffset.back());
+    meshData.cornersUv.resize(hasUvs ? cornersOffset.back() : 0);
+
+    bool validIndices = true;
+    #pragma omp parallel for reduction(&& : validIndices)
+    for(int i = 0; i < int(nbChunks); ++i)
+    {
+        ObjChunk& chunk = chunks[i];
+        for(const std::size_t c : chunk.relativePointCorners)
+            chunk.cornersPoint[c] += int(pointsOffset[i]);
+        for(const std::size_t c : chunk.relativeUvCorners)
+            chunk.cornersUv[c] += int(uvsOffset[i]);
+        for(const int point : chunk.cornersPoint)
+            validIndices = validIndices && point >= 0 && std::size_t(point) < pointsOffset.back();
+        if(hasUvs)
+        {
+            for(const int uv : chunk.cornersUv)
+                validIndices = validIndices && uv >= -1 && (uv < 0 || std::size_t(uv) < uvsOffset.back());
+        }
+
+        std::copy(chunk.points.begin(), chunk.points.end(), meshData.points.begin() + pointsOffset[i]);
+        if(hasColors)
+            std::copy(chunk.colors.begin(), chunk.colors.end(), meshData.colors.begin() + pointsOffset[i]);
+        std::copy(chunk.uvs.begin(), chunk.uvs.end(), meshData.uvs.begin() + uvsOffset[i]);
+        std::copy(chunk.cornersPoint.begin(), chunk.cornersPoint.end(), meshData.cornersPoint.begin() + cornersOffset[i]);
+        if(hasUvs)
+            std::copy(chunk.cornersUv.begin(), chunk.cornersUv.end(), meshData.cornersUv.begin() + cornersOffset[i]);
+        // release the chunk buffers as soon as they are copied
+        std::vector<Point3d>().swap(chunk.points);
+        std::vector<int>().swap(chunk.cornersPoint);
+        std::vector<int>().swap(chunk.cornersUv);
+    }
+    if(!validIndices)
+    {
+        ALICEVISION_LOG_WARNING("Invalid vertex index in mesh file: " << objFilepath);
+        return false;
+    }
+
+    // materials in the order of their first use
+    bool hasMaterials = false;
+    for(const ObjChunk& chunk : chunks)
+        hasMaterials |= !chunk.materials.empty();
+    if(hasMaterials)
+    {
+        meshData.trisMtl.resize(cornersOffset.back() / 3, 0);
+        std::map<std::string, int> materialsIds;
+        int currentMaterial = 0;
+        for(std::size_t i = 0; i < nbChunks; ++i)
+        {
+            std::size_t begin = cornersOffset[i] / 3;
+            for(const auto& material : chunks[i].materials)
+            {
+                const std::size_t end = cornersOffset[i] / 3 + material.first;
+                std::fill(meshData.trisMtl.begin() + begin, meshData.trisMtl.begin() + end, currentMaterial);
+                currentMaterial = materialsIds.emplace(material.second, int(materialsIds.size())).first->second;
+                begin = end;
+            }
+            std::fill(meshData.trisMtl.begin() + begin, meshData.trisMtl.begin() + cornersOffset[i + 1] / 3, currentMaterial);
+        }
+    }
+    chunks.clear();
+
+    convertMeshFileData(meshData, pts.getDataWritable(), tris.getDataWritable(), uvCoords.getDataWritable(),
+                        trisUvIds.getDataWritable(), _colors, _trisMtlIds);
 
-    int index = 0;
-    for (const auto & p : pts)
-    {
-        aimesh->mVertices[index].x = p.x;
-        aimesh->mVertices[index].y = -p.y;
-        aimesh->mVertices[index].z = -p.z;
+    mvsUtils::printfElapsedTime(t, "Load mesh from obj ");
+    return true;
+}
 
-        ++index;
+bool Mesh::loadFromPly(const std::string& plyFilepath)
+{
+    long t = std::clock();
+    boost::iostreams::mapped_file_source file;
+    try
+    {
+        file.open(plyFilepath);
+    }
+    catch(const std::exception&)
+    {
+        return false;
     }
+    const char* data = file.data();
+    const char* dataEnd = data + file.size();
 
-    aimesh->mNumFaces = tris.size();
-    aimesh->mFaces = new aiFace[tris.size()];
+    // header
+    std::vector<PlyElement> elements;
+    bool isBinaryLittleEndian = false;
+    const char* p = data;
+    const char* body = nullptr;
+    for(bool firstLine = true; p < dataEnd && body == nullptr; firstLine = false)
+    {
+        const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', dataEnd - p));
+        if(lineEnd == nullptr)
+            return false;
+        std::istringstream line(std::string(p, lineEnd));
+        p = lineEnd + 1;
 
-    for(int i = 0; i < tris.size(); ++i)
+        std::string keyword;
+        line >> keyword;
+        if(firstLine && keyword != "ply")
+            return false;
+        if(keyword == "format")
+        {
+            std::string format;
+            line >> format;
+            isBinaryLittleEndian = (format == "binary_little_endian");
+        }
+        else if(keyword == "element")
+        {
+            PlyElement element;
+            line >> element.name >> element.count;
+            elements.push_back(element);
+        }
+        else if(keyword == "property" && !elements.empty())
+        {
+            PlyProperty property;
+            std::string type;
+            line >> type;
+            if(type == "list")
+            {
+                std::string countType, itemType;
+                line >> countType >> itemType;
+                property.isList = true;
+                property.countType = plyTypeFromString(countType);
+                property.type = plyTypeFromString(itemType);
+            }
+            else
+                property.type = plyTypeFromString(type);
+            line >> property.name;
+            if(property.type == EPlyType::Unknown || (property.isList && property.countType == EPlyType::Unknown))
+                return false;
+            elements.back().properties.push_back(property);
+        }
+        else if(keyword == "end_header")
+            body = p;
+    }
+    if(body == nullptr || !isBinaryLittleEndian)
     {
-        aimesh->mFaces[i].mNumIndices = 3;
-        aimesh->mFaces[i].mIndices = new unsigned int[3];
+        ALICEVISION_LOG_INFO("PLY mesh file '" << plyFilepath << "' is not binary little-endian, it is read with the generic importer.");
+        return false;
+    }
 
-        for (int k = 0; k < 3; ++k)
+    // vertices and faces, the elements with lists before the faces are not supported
+    const PlyElement* vertexElement = nullptr;
+    const PlyElement* faceElement = nullptr;
+    const char* vertexData = nullptr;
+    const char* faceData = nullptr;
+    const char* elementData = body;
+    for(PlyElement& element : elements)
+    {
+        std::size_t offset = 0;
+        for(PlyProperty& property : element.properties)
         {
-            aimesh->mFaces[i].mIndices[k] = tris[i].v[k];
+            property.offset = offset;
+            if(!property.isList)
+                offset += plyTypeSize(property.type);
         }
+        if(element.name == "face")
+        {
+            faceElement = &element;
+            faceData = elementData;
+            break;
+        }
+        if(element.hasListProperty())
+            return false;
+        if(element.name == "vertex")
+        {
+            vertexElement = &element;
+            vertexData = elementData;
+        }
+        if(element.count > std::size_t(dataEnd - elementData) / std::max(std::size_t(1), element.scalarsSize()))
+            return false;
+        elementData += element.count * element.scalarsSize();
+    }
+    if(vertexElement == nullptr || faceElement == nullptr)
+        return false;
+    if(vertexElement->count > std::size_t(std::numeric_limits<int>::max()))
+        return false;
+
+    const PlyProperty* x = vertexElement->find({"x"});
+    const PlyProperty* y = vertexElement->find({"y"});
+    const PlyProperty* z = vertexElement->find({"z"});
+    if(x == nullptr || y == nullptr || z == nullptr)
+        return false;
+    const PlyProperty* colorProperties[3] = {vertexElement->find({"red", "diffuse_red", "r"}),
+                                             vertexElement->find({"green", "diffuse_green", "g"}),
+                                             vertexElement->find({"blue", "diffuse_blue", "b"})};
+    const bool hasColors = colorProperties[0] && colorProperties[1] && colorProperties[2];
+    const PlyProperty* u = vertexElement->find({"texture_u", "u", "s"});
+    const PlyProperty* v = vertexElement->find({"texture_v", "v", "t"});
+    const bool hasUvs = u && v;
+
+    // face records: one list of vertex indices and scalar properties
+    const PlyProperty* indicesProperty = nullptr;
+    for(const PlyProperty& property : faceElement->properties)
+    {
+        if(!property.isList)
+            continue;
+        if(indicesProperty != nullptr || (property.name != "vertex_indices" && property.name != "vertex_index"))
+            return false;
+        indicesProperty = &property;
     }
+    if(indicesProperty == nullptr)
+        return false;
 
-    std::string formatId = fileTypeStr;
-    unsigned int pPreprocessing = 0u;
-    // If gltf, use gltf 2.0
-    if (fileType == EFileType::GLTF)
+    MeshFileData meshData;
+    const int nbVertices = int(vertexElement->count);
+    const std::size_t vertexStride = vertexElement->scalarsSize();
+    meshData.points.resize(nbVertices);
+    meshData.colors.resize(hasColors ? nbVertices : 0);
+    meshData.uvs.resize(hasUvs ? nbVertices : 0);
+
+    #pragma omp parallel for
+    for(int i = 0; i < nbVertices; ++i)
     {
-        formatId = "gltf2";
-        // gen normals in order to have correct shading in Qt 3D Scene
-        // but cause problems with assimp importer
-        pPreprocessing |= aiProcess_GenNormals;
+        const char* record = vertexData + i * vertexStride;
+        meshData.points[i] = Point3d(readPlyScalar(record + x->offset, x->type),
+                                     readPlyScalar(record + y->offset, y->type),
+                                     readPlyScalar(record + z->offset, z->type));
+        if(hasColors)
+        {
+            unsigned char c[3];
+            for(int k = 0; k < 3; ++k)
+            {
+                const double value = readPlyScalar(record + colorProperties[k]->offset, colorProperties[k]->type);
+                const bool isFloat = (colorProperties[k]->type == EPlyType::Float32 || colorProperties[k]->type == EPlyType::Float64);
+                c[k] = static_cast<unsigned char>(std::min(std::max(isFloat ? value * 255.0 : value, 0.0), 255.0));
+            }
+            meshData.colors[i] = rgb(c[0], c[1], c[2]);
+        }
+        if(hasUvs)
+            meshData.uvs[i] = Point2d(readPlyScalar(record + u->offset, u->type), readPlyScalar(record + v->offset, v->type));
     }
-    // If obj, do not use material
-    else if (fileType == EFileType::OBJ)
+
+    // the scalar properties before and after the list of indices
+    std::size_t sizeBeforeList = 0;
+    for(const PlyProperty& property : faceElement->properties)
     {
-        formatId = "objnomtl";
+        if(&property == indicesProperty)
+            break;
+        sizeBeforeList += plyTypeSize(property.type);
     }
+    const std::size_t sizeAfterList = faceElement->scalarsSize() - sizeBeforeList;
+    const std::size_t countSize = plyTypeSize(indicesProperty->countType);
+    const std::size_t indexSize = plyTypeSize(indicesProperty->type);
+    const std::size_t nbFaces = faceElement->count;
 
-    Assimp::Exporter exporter;
-    exporter.Export(&scene, formatId, filepath, pPreprocessing);
+    bool validIndices = true;
+    const std::size_t triangleStride = sizeBeforeList + countSize + 3 * indexSize + sizeAfterList;
+    bool onlyTriangles = nbFaces <= std::size_t(dataEnd - faceData) / triangleStride;
+    if(onlyTriangles)
+    {
+        // fixed size records, decoded in parallel
+        #pragma omp parallel for reduction(&& : onlyTriangles)
+        for(long long f = 0; f < (long long)nbFaces; ++f)
+            onlyTriangles = onlyTriangles && readPlyScalar(faceData + f * triangleStride + sizeBeforeList, indicesProperty->countType) == 3;
+    }
+    if(onlyTriangles)
+    {
+        meshData.cornersPoint.resize(3 * nbFaces);
+        #pragma omp parallel for reduction(&& : validIndices)
+        for(long long f = 0; f < (long long)nbFaces; ++f)
+        {
+            const char* indices = faceData + f * triangleStride + sizeBeforeList + countSize;
+            for(int k = 0; k < 3; ++k)
+            {
+                const double index = readPlyScalar(indices + k * indexSize, indicesProperty->type);
+                validIndices = validIndices && index >= 0 && index < nbVertices;
+                meshData.cornersPoint[3 * f + k] = int(index);
+            }
+        }
+    }
+    else
+    {
+        // polygons, triangle fans
+        const char* record = faceData;
+        for(std::size_t f = 0; f < nbFaces && validIndices; ++f)
+        {
+            if(std::size_t(dataEnd - record) < sizeBeforeList + countSize)
+                return false;
+            const std::size_t count = std::size_t(readPlyScalar(record + sizeBeforeList, indicesProperty->countType));
+            const char* indices = record + sizeBeforeList + countSize;
+            record = indices + count * indexSize + sizeAfterList;
+            if(record > dataEnd)
+                return false;
+            for(std::size_t i = 1; i + 1 < count; ++i)
+            {
+                for(const std::size_t c : {std::size_t(0), i, i + 1})
+                {
+                    const double index = readPlyScalar(indices + c * indexSize, indicesProperty->type);
+                    validIndices = validIndices && index >= 0 && index < nbVertices;
+                    meshData.cornersPoint.push_back(int(index));
+                }
+            }
+        }
+    }
+    if(!validIndices)
+    {
+        ALICEVISION_LOG_WARNING("Invalid vertex index in mesh file: " << plyFilepath);
+        return false;
+    }
+    if(hasUvs)
+        meshData.cornersUv = meshData.cornersPoint;
 
-    ALICEVISION_LOG_INFO("Save mesh to " << fileTypeStr << " done.");
+    convertMeshFileData(meshData, pts.getDataWritable(), tris.getDataWritable(), uvCoords.getDataWritable(),
+                        trisUvIds.getDataWritable(), _colors, _trisMtlIds);
 
-    ALICEVISION_LOG_DEBUG("Vertices: " << pts.size());
-    ALICEVISION_LOG_DEBUG("Triangles: " << tris.size());
-    ALICEVISION_LOG_DEBUG("UVs: " << uvCoords.size());  
-    ALICEVISION_LOG_DEBUG("Normals: " << normals.size());
+    mvsUtils::printfElapsedTime(t, "Load mesh from ply ");
+    return true;
 }
 
-bool Mesh::loadFromBin(const std::string& binFilepath)
+void Mesh::saveToObj(const std::string& objFilepath) const
 {
-    FILE* f = fopen(binFilepath.c_str(), "rb");
-
-    if(f == nullptr)
-        return false;
+    long t = std::clock();
+    std::ofstream file(objFilepath, std::ios::out | std::ios::binary);
+    if(!file.is_open())
+        ALICEVISION_THROW_ERROR("Can't create mesh file, can't open '" << objFilepath << "'.");
+
+    file << "# " << pts.size() << " vertices, " << tris.size() << " triangles\n";
+
+    writeBlocks(file, pts.size(), [this](std::string& buffer, std::size_t begin, std::size_t end) {
+        char line[128];
+        for(std::size_t i = begin; i < end; ++i)
+        {
+            const Point3d& p = pts[i];
+            char* out = line;
+            *out++ = 'v';
+            *out++ = ' ';
+            out = writeDouble(out, p.x);
+            *out++ = ' ';
+            out = writeDouble(out, -p.y);
+            *out++ = ' ';
+            out = writeDouble(out, -p.z);
+            *out++ = '\n';
+            buffer.append(line, out);
+        }
+    });
 
-    int npts;
-    fread(&npts, sizeof(int), 1, f);
-    pts = StaticVector<Point3d>();
-    pts.resize(npts);
-    fread(&pts[0], sizeof(Point3d), npts, f);
+    writeBlocks(file, tris.size(), [this](std::string& buffer, std::size_t begin, std::size_t end) {
+        char line[128];
+        for(std::size_t i = begin; i < end; ++i)
+        {
+            const Mesh::triangle& triangle = tris[i];
+            char* out = line;
+            *out++ = 'f';
+            for(int k = 0; k < 3; ++k)
+            {
+                *out++ = ' ';
+                out = writeInt(out, (long long)(triangle.v[k]) + 1);
+            }
+            *out++ = '\n';
+            buffer.append(line, out);
+        }
+    });
 
-    int ntris;
-    fread(&ntris, sizeof(int), 1, f);
-    tris = StaticVector<Mesh::triangle>();
-    tris.resize(ntris);
-    fread(&tris[0], sizeof(Mesh::triangle), ntris, f);
+    file.close();
+    if(!file)
+        ALICEVISION_THROW_ERROR("Can't write mesh file '" << objFilepath << "'.");
 
-    fclose(f);
-    return true;
+    mvsUtils::printfElapsedTime(t, "Save mesh to obj ");
 }
 
-void Mesh::saveToBin(const std::string& binFilepath)
+void Mesh::saveToPly(const std::string& plyFilepath) const
 {
     long t = std::clock();
-    ALICEVISION_LOG_DEBUG("Save mesh to bin.");
-    // printf("open\n");
-    FILE* f = fopen(binFilepath.c_str(), "wb");
-
-    int npts = pts.size();
-    // printf("write npts %i\n",npts);
-    fwrite(&npts, sizeof(int), 1, f);
-    // printf("write pts\n");
-    fwrite(&pts[0], sizeof(Point3d), npts, f);
-
-    int ntris = tris.size();
-    // printf("write ntris %i\n",ntris);
-    fwrite(&ntris, sizeof(int), 1, f);
-    // printf("write tris\n");
-    fwrite(&tris[0], sizeof(Mesh::triangle), ntris, f);
-
-    // printf("close\n");
-    fclose(f);
-    // printf("done\n");
-    mvsUtils::printfElapsedTime(t, "Save mesh to bin ");
+    std::ofstream file(plyFilepath, std::ios::out | std::ios::binary);
+    if(!file.is_open())
+        ALICEVISION_THROW_ERROR("Can't create mesh file, can't open '" << plyFilepath << "'.");
+
+    const bool hasColors = (_colors.size() == pts.size()) && !_colors.empty();
+
+    file << "ply\n"
+         << "format binary_little_endian 1.0\n"
+         << "element vertex " << pts.size() << "\n"
+         << "property float x\n"
+         << "property float y\n"
+         << "property float z\n";
+    if(hasColors)
+        file << "property uchar red\n"
+             << "property uchar green\n"
+             << "property uchar blue\n";
+    file << "element face " << tris.size() << "\n"
+         << "property list uchar int vertex_indices\n"
+         << "end_header\n";
+
+    writeBlocks(file, pts.size(), [this, hasColors](std::string& buffer, std::size_t begin, std::size_t end) {
+        const std::size_t stride = 3 * sizeof(float) + (hasColors ? 3 : 0);
+        buffer.resize((end - begin) * stride);
+        char* out = &buffer[0];
+        for(std::size_t i = begin; i < end; ++i)
+        {
+            const float p[3] = {float(pts[i].x), float(-pts[i].y), float(-pts[i].z)};
+            std::memcpy(out, p, sizeof(p));
+            out += sizeof(p);
+            if(hasColors)
+            {
+                *out++ = char(_colors[i].r);
+                *out++ = char(_colors[i].g);
+                *out++ = char(_colors[i].b);
+            }
+        }
+    });
+
+    writeBlocks(file, tris.size(), [this](std::string& buffer, std::size_t begin, std::size_t end) {
+        const std::size_t stride = 1 + 3 * sizeof(std::int32_t);
+        buffer.resize((end - begin) * stride);
+        char* out = &buffer[0];
+        for(std::size_t i = begin; i < end; ++i)
+        {
+            *out++ = 3;
+            const std::int32_t v[3] = {tris[i].v[0], tris[i].v[1], tris[i].v[2]};
+            std::memcpy(out, v, sizeof(v));
+            out += sizeof(v);
+        }
+    });
+
+    file.close();
+    if(!file)
+        ALICEVISION_THROW_ERROR("Can't write mesh file '" << plyFilepath << "'.");
+
+    mvsUtils::printfElapsedTime(t, "Save mesh to ply ");
 }
 
 void Mesh::addMesh(const Mesh& mesh)
@@ -559,54 +1787,16 @@ bool Mesh::doesTriangleIntersectsRectangle(Mesh::triangle_proj& tp, Mesh::rectan
 
 void Mesh::getPtsNeighborTriangles(StaticVector<StaticVector<int>>& out_ptsNeighTris) const
 {
-    // array of tuples <x: vertexIndex, y: triangleIndex, z: numberOfNeighbors>
-    StaticVector<Voxel> vertexNeighborhoodPairs;
-    vertexNeighborhoodPairs.reserve(tris.size() * 3);
-    for(int i = 0; i < tris.size(); ++i)
-    {
-        vertexNeighborhoodPairs.push_back(Voxel(tris[i].v[0], i, 0));
-        vertexNeighborhoodPairs.push_back(Voxel(tris[i].v[1], i, 0));
-        vertexNeighborhoodPairs.push_back(Voxel(tris[i].v[2], i, 0));
-    }
-    qsort(&vertexNeighborhoodPairs[0], vertexNeighborhoodPairs.size(), sizeof(Voxel), qSortCompareVoxelByXAsc);
+    MeshAdjacency adjacency;
+    computePtsNeighborTrianglesCSR(adjacency);
 
-    int i = 0; // index of the unique pair of <vertex, neighborhood>
-    int j = 0; // index of the vertex
-    int k = 0; // number of neighbors
-    int firstid = 0;
-    while(i < vertexNeighborhoodPairs.size())
-    {
-        ++k;
-        // (*vertexNeighborhoodPairs)[i].z = j;
-        if((i == vertexNeighborhoodPairs.size() - 1) || (vertexNeighborhoodPairs[i].x != vertexNeighborhoodPairs[i + 1].x))
-        {
-            vertexNeighborhoodPairs[firstid].z = k; // store the number of neighbors
-            ++j;
-            firstid = i + 1;
-            k = 0;
-        }
-        ++i;
-    }
-    int npts = j;
-
-    out_ptsNeighTris.reserve(pts.size());
     out_ptsNeighTris.resize(pts.size());
 
-    i = 0;
-    for(j = 0; j < npts; ++j)
+    #pragma omp parallel for
+    for(int i = 0; i < pts.size(); ++i)
     {
-        int middlePtId = vertexNeighborhoodPairs[i].x;
-        int nbNeighbors = vertexNeighborhoodPairs[i].z;
-        int i0 = i;
-        int i1 = i + nbNeighbors;
-        i = i1;
-
-        StaticVector<int>& triTmp = out_ptsNeighTris[middlePtId];
-        triTmp.reserve(nbNeighbors);
-        for(int l = i0; l < i1; ++l)
-        {
-            triTmp.push_back(vertexNeighborhoodPairs[l].y); // index of triangle
-        }
+        const int* neighborTris = adjacency.neighborTris(i);
+        out_ptsNeighTris[i].getDataWritable().assign(neighborTris, neighborTris + adjacency.getNbNeighborTris(i));
     }
 }
 
@@ -631,85 +1821,143 @@ void Mesh::getPtsNeighbors(std::vector<std::vector<int>>& out_ptsNeigh) const
 
 void Mesh::getPtsNeighPtsOrdered(StaticVector<StaticVector<int>>& out_ptsNeighPts) const
 {
-    StaticVector<StaticVector<int>> ptsNeighborTriangles;
-    getPtsNeighborTriangles(ptsNeighborTriangles);
+    MeshAdjacency adjacency;
+    computePtsAdjacency(adjacency);
 
     out_ptsNeighPts.resize(pts.size());
 
-    for(int middlePtId = 0; middlePtId < pts.size(); ++middlePtId)
+    #pragma omp parallel for
+    for(int i = 0; i < pts.size(); ++i)
     {
-        StaticVector<int>& neighborTriangles = ptsNeighborTriangles[middlePtId];
-        if(neighborTriangles.empty())
-            continue;
+        const int* neighborPts = adjacency.neighborPts(i);
+        out_ptsNeighPts[i].getDataWritable().assign(neighborPts, neighborPts + adjacency.getNbNeighborPts(i));
+    }
+}
+
+void Mesh::computePtsNeighborTrianglesCSR(MeshAdjacency& out_adjacency) const
+{
+    const int nbPts = pts.size();
+    const int nbTris = tris.size();
+
+    // counting sort of the <vertex, triangle> pairs, the triangles of each vertex stay in ascending order
+    std::vector<int>& offsets = out_adjacency.trisOffsets;
+    offsets.assign(nbPts + 1, 0);
+
+    #pragma omp parallel for
+    for(int i = 0; i < nbTris; ++i)
+    {
+        for(int k = 0; k < 3; ++k)
+            boost::atomic_ref<int>(offsets[tris[i].v[k] + 1]).fetch_add(1, boost::memory_order_relaxed);
+    }
+    for(int i = 0; i < nbPts; ++i)
+        offsets[i + 1] += offsets[i];
 
-        StaticVector<int> vhid;
-        vhid.reserve(neighborTriangles.size() * 2);
-        int currentTriPtId = tris[neighborTriangles[0]].v[0];
-        int firstTriPtId = currentTriPtId;
-        vhid.push_back(currentTriPtId);
+    std::vector<int> positions(offsets.begin(), offsets.end() - 1);
+    out_adjacency.tris.resize(offsets.back());
+    for(int i = 0; i < nbTris; ++i)
+    {
+        for(int k = 0; k < 3; ++k)
+            out_adjacency.tris[positions[tris[i].v[k]]++] = i;
+    }
+}
+
+void Mesh::computePtsAdjacency(MeshAdjacency& out_adjacency) const
+{
+    computePtsNeighborTrianglesCSR(out_adjacency);
+
+    const int nbPts = pts.size();
+
+    // each vertex has at most 2 neighbor vertices per neighbor triangle,
+    // so the ordered neighbors are first written in these bounds then compacted
+    std::vector<int> nbNeighborPts(nbPts, 0);
+    std::vector<int> neighborPtsBuffer(2 * out_adjacency.tris.size());
 
-        bool isThereTWithCurrentTriPtId = true;
-        while(!neighborTriangles.empty() && isThereTWithCurrentTriPtId)
+    #pragma omp parallel
+    {
+        std::vector<int> neighborTriangles;
+        std::vector<int> vhid;
+
+        #pragma omp for schedule(dynamic, 1024)
+        for(int middlePtId = 0; middlePtId < nbPts; ++middlePtId)
         {
-            isThereTWithCurrentTriPtId = false;
+            if(out_adjacency.getNbNeighborTris(middlePtId) == 0)
+                continue;
+
+            const int* firstNeighborTri = out_adjacency.neighborTris(middlePtId);
+            neighborTriangles.assign(firstNeighborTri, firstNeighborTri + out_adjacency.getNbNeighborTris(middlePtId));
 
-            // find triangle with middlePtId and currentTriPtId and get remaining point id
-            for(int n = 0; n < neighborTriangles.size(); ++n)
+            // walk around the vertex from triangle to triangle through their common edges
+            vhid.clear();
+            int currentTriPtId = tris[neighborTriangles[0]].v[0];
+            const int firstTriPtId = currentTriPtId;
+            vhid.push_back(currentTriPtId);
+
+            bool isThereTWithCurrentTriPtId = true;
+            while(!neighborTriangles.empty() && isThereTWithCurrentTriPtId)
             {
-                bool ok_middlePtId = false;
-                bool ok_actTriPtId = false;
-                int remainingPtId = -1; // remaining pt id
-                for(int k = 0; k < 3; ++k)
+                isThereTWithCurrentTriPtId = false;
+
+                // find triangle with middlePtId and currentTriPtId and get remaining point id
+                for(std::size_t n = 0; n < neighborTriangles.size(); ++n)
                 {
-                    int triPtId = tris[neighborTriangles[n]].v[k];
-                    double length = (pts[middlePtId] - pts[triPtId]).size();
-                    if((triPtId != middlePtId) && (triPtId != currentTriPtId) && (length > 0.0) && (!std::isnan(length)))
-                    {
-                        remainingPtId = triPtId;
-                    }
-                    if(triPtId == middlePtId)
+                    bool ok_middlePtId = false;
+                    bool ok_actTriPtId = false;
+                    int remainingPtId = -1; // remaining pt id
+                    for(int k = 0; k < 3; ++k)
                     {
-                        ok_middlePtId = true;
+                        const int triPtId = tris[neighborTriangles[n]].v[k];
+                        const double length = (pts[middlePtId] - pts[triPtId]).size();
+                        if((triPtId != middlePtId) && (triPtId != currentTriPtId) && (length > 0.0) && (!std::isnan(length)))
+                            remainingPtId = triPtId;
+                        if(triPtId == middlePtId)
+                            ok_middlePtId = true;
+                        if(triPtId == currentTriPtId)
+                            ok_actTriPtId = true;
                     }
-                    if(triPtId == currentTriPtId)
+
+                    if(ok_middlePtId && ok_actTriPtId && (remainingPtId > -1))
                     {
-                        ok_actTriPtId = true;
+                        currentTriPtId = remainingPtId;
+                        neighborTriangles.erase(neighborTriangles.begin() + n);
+                        vhid.push_back(currentTriPtId);
+                        isThereTWithCurrentTriPtId = true; // we removed one, so we try again
+                        break;
                     }
                 }
-
-                if(ok_middlePtId && ok_actTriPtId && (remainingPtId > -1))
-                {
-                    currentTriPtId = remainingPtId;
-                    neighborTriangles.remove(n);
-                    vhid.push_back(currentTriPtId);
-                    isThereTWithCurrentTriPtId = true; // we removed one, so we try again
-                    break;
-                }
             }
-        }
 
-        if(!vhid.empty())
-        {
             if(currentTriPtId == firstTriPtId)
-            {
-                vhid.pop(); // remove last ... which is first
-            }
+                vhid.pop_back(); // remove last ... which is first
 
             // remove duplicates
-            StaticVector<int>& vhid1 = out_ptsNeighPts[middlePtId];
-            vhid1.reserve(vhid.size());
-            for(int k1 = 0; k1 < vhid.size(); ++k1)
+            int* neighborPts = neighborPtsBuffer.data() + 2 * out_adjacency.trisOffsets[middlePtId];
+            int nbNeighbors = 0;
+            for(const int ptId : vhid)
             {
-                if(vhid1.indexOf(vhid[k1]) == -1)
-                {
-                    vhid1.push_back(vhid[k1]);
-                }
+                if(std::find(neighborPts, neighborPts + nbNeighbors, ptId) == neighborPts + nbNeighbors)
+                    neighborPts[nbNeighbors++] = ptId;
             }
+            nbNeighborPts[middlePtId] = nbNeighbors;
         }
     }
+
+    std::vector<int>& offsets = out_adjacency.ptsOffsets;
+    offsets.resize(nbPts + 1);
+    offsets[0] = 0;
+    for(int i = 0; i < nbPts; ++i)
+        offsets[i + 1] = offsets[i] + nbNeighborPts[i];
+
+    out_adjacency.pts.resize(offsets.back());
+
+    #pragma omp parallel for
+    for(int i = 0; i < nbPts; ++i)
+    {
+        const int* neighborPts = neighborPtsBuffer.data() + 2 * out_adjacency.trisOffsets[i];
+        std::copy(neighborPts, neighborPts + nbNeighborPts[i], out_adjacency.pts.begin() + offsets[i]);
+    }
 }
 
-void Mesh::getTrisMap(StaticVector<StaticVector<int>>& out, const mvsUtils::MultiViewParams& mp, int rc, int  /*scale*/, int w, int h)
+void Mesh::getTrisMap(StaticVector2D<int>& out, const mvsUtils::MultiViewParams& mp, int rc, int  /*scale*/, int w, int h)
 {
     long tstart = clock();
 
@@ -741,16 +1989,8 @@ void Mesh::getTrisMap(StaticVector<StaticVector<int>>& out, const mvsUtils::Mult
     } // for i ntris
     mvsUtils::finishEstimate();
 
-    // allocate
-    out.reserve(w * h);
-    out.resize(w * h);
-    for(int i = 0; i < w * h; ++i)
-    {
-        if(nmap[i] > 0)
-        {
-            out[i].reserve(nmap[i]);
-        }
-    }
+    // allocate all the pixels lists in a single buffer
+    out.allocate(nmap);
 
     // fill
     t1 = mvsUtils::initEstimate();
@@ -767,7 +2007,7 @@ void Mesh::getTrisMap(StaticVector<StaticVector<int>>& out, const mvsUtils::Mult
                     Mesh::rectangle re = Mesh::rectangle(pix, 1);
                     if(doesTriangleIntersectsRectangle(tp, re))
                     {
-                        out[pix.x * h + pix.y].push_back(i);
+                        out.push_back(pix.x * h + pix.y, i);
                     }
                 } // for y
             }     // for x
@@ -779,7 +2019,7 @@ void Mesh::getTrisMap(StaticVector<StaticVector<int>>& out, const mvsUtils::Mult
     mvsUtils::printfElapsedTime(tstart);
 }
 
-void Mesh::getTrisMap(StaticVector<StaticVector<int>>& out, StaticVector<int>& visTris, const mvsUtils::MultiViewParams& mp, int rc,
+void Mesh::getTrisMap(StaticVector2D<int>& out, StaticVector<int>& visTris, const mvsUtils::MultiViewParams& mp, int rc,
                                                       int  /*scale*/, int w, int h)
 {
     long tstart = clock();
@@ -813,15 +2053,8 @@ void Mesh::getTrisMap(StaticVector<StaticVector<int>>& out, StaticVector<int>& v
     } // for i ntris
     mvsUtils::finishEstimate();
 
-    // allocate
-    out.resize(w * h);
-    for(int i = 0; i < w * h; ++i)
-    {
-        if(nmap[i] > 0)
-        {
-            out[i].reserve(nmap[i]);
-        }
-    }
+    // allocate all the pixels lists in a single buffer
+    out.allocate(nmap);
 
     // fill
     t1 = mvsUtils::initEstimate();
@@ -839,7 +2072,7 @@ void Mesh::getTrisMap(StaticVector<StaticVector<int>>& out, StaticVector<int>& v
                     Mesh::rectangle re = Mesh::rectangle(pix, 1);
                     if(doesTriangleIntersectsRectangle(tp, re))
                     {
-                        out[pix.x * h + pix.y].push_back(i);
+                        out.push_back(pix.x * h + pix.y, i);
                     }
                 } // for y
             }     // for x
@@ -853,12 +2086,12 @@ void Mesh::getTrisMap(StaticVector<StaticVector<int>>& out, StaticVector<int>& v
 
 void Mesh::getDepthMap(StaticVector<float>& depthMap, const mvsUtils::MultiViewParams& mp, int rc, int scale, int w, int h)
 {
-    StaticVector<StaticVector<int>> tmp;
+    StaticVector2D<int> tmp;
     getTrisMap(tmp, mp, rc, scale, w, h);
     getDepthMap(depthMap, tmp, mp, rc, scale, w, h);
 }
 
-void Mesh::getDepthMap(StaticVector<float>& depthMap, StaticVector<StaticVector<int>>& tmp, const mvsUtils::MultiViewParams& mp,
+void Mesh::getDepthMap(StaticVector<float>& depthMap, const StaticVector2D<int>& tmp, const mvsUtils::MultiViewParams& mp,
                           int rc, int scale, int w, int h)
 {
     depthMap.resize_with(w * h, -1.0f);
@@ -869,8 +2102,9 @@ void Mesh::getDepthMap(StaticVector<float>& depthMap, StaticVector<StaticVector<
         for(pix.y = 0; pix.y < h; ++pix.y)
         {
 
-            StaticVector<int>& ti = tmp[pix.x * h + pix.y];
-            if(!ti.empty())
+            const int* ti = tmp.begin(pix.x * h + pix.y);
+            const int nbTi = tmp.size(pix.x * h + pix.y);
+            if(nbTi > 0)
             {
                 Point2d p;
                 p.x = (double)pix.x;
@@ -878,7 +2112,7 @@ void Mesh::getDepthMap(StaticVector<float>& depthMap, StaticVector<StaticVector<
 
                 double mindepth = 10000000.0;
 
-                for(int i = 0; i < ti.size(); ++i)
+                for(int i = 0; i < nbTi; ++i)
                 {
                     int idTri = ti[i];
                     OrientedPoint tri;
@@ -961,7 +2195,7 @@ void Mesh::getVisibleTrianglesIndexes(StaticVector<int>& out_visTri, const std::
 {
     StaticVector<float> depthMap;
     loadArrayFromFile<float>(depthMap, depthMapFilepath);
-    StaticVector<StaticVector<int>> trisMap;
+    StaticVector2D<int> trisMap;
     loadArrayOfArraysFromFile<int>(trisMap, trisMapFilepath);
 
     getVisibleTrianglesIndexes(out_visTri, trisMap, depthMap, mp, rc, w, h);
@@ -974,7 +2208,7 @@ void Mesh::getVisibleTrianglesIndexes(StaticVector<int>& out_visTri, const std::
 
     StaticVector<float> depthMap;
     loadArrayFromFile<float>(depthMap, depthMapFilepath);
-    StaticVector<StaticVector<int>> trisMap;
+    StaticVector2D<int> trisMap;
     loadArrayOfArraysFromFile<int>(trisMap, trisMapFilepath);
 
     getVisibleTrianglesIndexes(out_visTri, trisMap, depthMap, mp, rc, w, h);
@@ -1008,7 +2242,7 @@ void Mesh::getVisibleTrianglesIndexes(StaticVector<int>& out_visTri, StaticVecto
     }
 }
 
-void Mesh::getVisibleTrianglesIndexes(StaticVector<int>& out_visTri, StaticVector<StaticVector<int>>& trisMap,
+void Mesh::getVisibleTrianglesIndexes(StaticVector<int>& out_visTri, const StaticVector2D<int>& trisMap,
                                                        StaticVector<float>& depthMap, const mvsUtils::MultiViewParams& mp, int rc,
                                                        int w, int h)
 {
@@ -1024,15 +2258,16 @@ void Mesh::getVisibleTrianglesIndexes(StaticVector<int>& out_visTri, StaticVecto
     {
         for(pix.y = 0; pix.y < h; ++pix.y)
         {
-            StaticVector<int>& ti = trisMap[pix.x * h + pix.y];
-            if(!ti.empty())
+            const int* ti = trisMap.begin(pix.x * h + pix.y);
+            const int nbTi = trisMap.size(pix.x * h + pix.y);
+            if(nbTi > 0)
             {
                 Point2d p;
                 p.x = (float)pix.x;
                 p.y = (float)pix.y;
 
                 float depth = depthMap[pix.x * h + pix.y];
-                for(int i = 0; i < ti.size(); ++i)
+                for(int i = 0; i < nbTi; ++i)
                 {
                     int idTri = ti[i];
                     OrientedPoint tri;
@@ -1203,84 +2438,83 @@ void Mesh::getNotOrientedEdges(StaticVector<StaticVector<int>>& edgesNeighTris,
     mvsUtils::finishEstimate();
 }
 
-void Mesh::getLaplacianSmoothingVectors(StaticVector<StaticVector<int>>& ptsNeighPts, StaticVector<Point3d>& out_nms,
+namespace {
+
+/// Laplacian smoothing vector of a vertex, null if a neighbor is further than maximalNeighDist (if positive)
+Point3d computeLaplacianSmoothingVector(const MeshAdjacency& adjacency, const StaticVector<Point3d>& pts, int ptId,
                                         double maximalNeighDist)
 {
-    out_nms.reserve(pts.size());
+    const Point3d& p = pts[ptId];
+    const int* nei = adjacency.neighborPts(ptId);
+    const int nneighs = adjacency.getNbNeighborPts(ptId);
 
-    for(int i = 0; i < pts.size(); ++i)
+    if(nneighs == 0)
+        return Point3d(0.0, 0.0, 0.0);
+
+    double maxNeighDist = 0.0f;
+    // laplacian smoothing vector
+    Point3d n = Point3d(0.0, 0.0, 0.0);
+    for(int j = 0; j < nneighs; ++j)
     {
-        Point3d& p = pts[i];
-        StaticVector<int>& nei = ptsNeighPts[i];
-        int nneighs = 0;
-        if(!nei.empty())
-        {
-            nneighs = nei.size();
-        }
+        n = n + pts[nei[j]];
+        maxNeighDist = std::max(maxNeighDist, (p - pts[nei[j]]).size());
+    }
+    n = (n / (float)nneighs) - p;
 
-        if(nneighs == 0)
-        {
-            out_nms.push_back(Point3d(0.0, 0.0, 0.0));
-        }
-        else
-        {
-            double maxNeighDist = 0.0f;
-            // laplacian smoothing vector
-            Point3d n = Point3d(0.0, 0.0, 0.0);
-            for(int j = 0; j < nneighs; ++j)
-            {
-                n = n + pts[nei[j]];
-                maxNeighDist = std::max(maxNeighDist, (p - pts[nei[j]]).size());
-            }
-            n = (n / (float)nneighs) - p;
+    float d = n.size();
+    n = n.normalize();
 
-            float d = n.size();
-            n = n.normalize();
+    if(std::isnan(d) || std::isnan(n.x) || std::isnan(n.y) || std::isnan(n.z)) // check if is not NaN
+    {
+        n = Point3d(0.0, 0.0, 0.0);
+    }
+    else
+    {
+        n = n * d;
+    }
 
-            if(std::isnan(d) || std::isnan(n.x) || std::isnan(n.y) || std::isnan(n.z)) // check if is not NaN
-            {
-                n = Point3d(0.0, 0.0, 0.0);
-            }
-            else
-            {
-                n = n * d;
-            }
+    if(std::isnan(d) || std::isnan(n.x) || std::isnan(n.y) || std::isnan(n.z)) // check if is not NaN
+    {
+        n = Point3d(0.0, 0.0, 0.0);
+    }
 
-            if(std::isnan(d) || std::isnan(n.x) || std::isnan(n.y) || std::isnan(n.z)) // check if is not NaN
-            {
-                n = Point3d(0.0, 0.0, 0.0);
-            }
+    if((maximalNeighDist > 0.0f) && (maxNeighDist > maximalNeighDist))
+    {
+        n = Point3d(0.0, 0.0, 0.0);
+    }
 
-            if((maximalNeighDist > 0.0f) && (maxNeighDist > maximalNeighDist))
-            {
-                n = Point3d(0.0, 0.0, 0.0);
-            }
+    return n;
+}
 
-            out_nms.push_back(n);
-        }
+} // namespace
+
+void Mesh::getLaplacianSmoothingVectors(const MeshAdjacency& adjacency, StaticVector<Point3d>& out_nms,
+                                        double maximalNeighDist) const
+{
+    out_nms.resize(pts.size());
+
+    #pragma omp parallel for
+    for(int i = 0; i < pts.size(); ++i)
+    {
+        out_nms[i] = computeLaplacianSmoothingVector(adjacency, pts, i, maximalNeighDist);
     }
 }
 
 void Mesh::laplacianSmoothPts(float maximalNeighDist)
 {
-    StaticVector<StaticVector<int>> ptsNei;
-    getPtsNeighPtsOrdered(ptsNei);
-    laplacianSmoothPts(ptsNei, maximalNeighDist);
+    MeshAdjacency adjacency;
+    computePtsAdjacency(adjacency);
+    laplacianSmoothPts(adjacency, maximalNeighDist);
 }
 
-void Mesh::laplacianSmoothPts(StaticVector<StaticVector<int>>& ptsNeighPts, double maximalNeighDist)
+void Mesh::laplacianSmoothPts(const MeshAdjacency& adjacency, double maximalNeighDist, int nbIterations)
 {
-    StaticVector<Point3d> nms;
-    getLaplacianSmoothingVectors(ptsNeighPts, nms, maximalNeighDist);
-
-    // smooth
-    for(int i = 0; i < pts.size(); ++i)
-    {
-        pts[i] = pts[i] + nms[i];
-    }
+    filterVertices(pts, nbIterations, [&](int i, const StaticVector<Point3d>& iterPts, Point3d& out_pt) {
+        out_pt = iterPts[i] + computeLaplacianSmoothingVector(adjacency, iterPts, i, maximalNeighDist);
+    });
 }
 
-Point3d Mesh::computeTriangleNormal(int idTri)
+Point3d Mesh::computeTriangleNormal(int idTri) const
 {
     const Mesh::triangle& t = tris[idTri];
     return cross((pts[t.v[1]] - pts[t.v[0]]).normalize(),
@@ -1310,32 +2544,33 @@ double Mesh::computeTriangleMinEdgeLength(int idTri) const
                      (pts[t.v[2]] - pts[t.v[0]]).size()});
 }
 
-void Mesh::computeNormalsForPts(StaticVector<Point3d>& out_nms)
+void Mesh::computeNormalsForPts(StaticVector<Point3d>& out_nms) const
 {
-    StaticVector<StaticVector<int>> ptsNeighTris;
-    getPtsNeighborTriangles(ptsNeighTris);
-    computeNormalsForPts(ptsNeighTris, out_nms);
+    MeshAdjacency adjacency;
+    computePtsNeighborTrianglesCSR(adjacency);
+    computeNormalsForPts(adjacency, out_nms);
 }
 
-void Mesh::computeNormalsForPts(StaticVector<StaticVector<int>>& ptsNeighTris, StaticVector<Point3d>& out_nms)
+void Mesh::computeNormalsForPts(const MeshAdjacency& adjacency, StaticVector<Point3d>& out_nms) const
 {
-    out_nms.reserve(pts.size());
-    out_nms.resize_with(pts.size(), Point3d(0.0f, 0.0f, 0.0f));
+    out_nms.resize(pts.size());
 
+    #pragma omp parallel for
     for(int i = 0; i < pts.size(); ++i)
     {
-        StaticVector<int>& triTmp = ptsNeighTris[i];
-        if(!triTmp.empty())
+        const int* triTmp = adjacency.neighborTris(i);
+        const int nbTris = adjacency.getNbNeighborTris(i);
+
+        Point3d n = Point3d(0.0f, 0.0f, 0.0f);
+        if(nbTris > 0)
         {
-            Point3d n = Point3d(0.0f, 0.0f, 0.0f);
             float nn = 0.0f;
-            for(int j = 0; j < triTmp.size(); ++j)
+            for(int j = 0; j < nbTris; ++j)
             {
-                Point3d n1 = computeTriangleNormal(triTmp[j]);
-                n1 = n1.normalize();
-                if(!std::isnan(n1.x) && !std::isnan(n1.y) && std::isnan(n1.z)) // check if is not NaN
+                const Point3d n1 = computeTriangleNormal(triTmp[j]);
+                if(!std::isnan(n1.x) && !std::isnan(n1.y) && !std::isnan(n1.z)) // check if is not NaN
                 {
-                    n = n + computeTriangleNormal(triTmp[j]);
+                    n = n + n1;
                     nn += 1.0f;
                 }
             }
@@ -1346,31 +2581,33 @@ void Mesh::computeNormalsForPts(StaticVector<StaticVector<int>>& ptsNeighTris, S
             {
                 n = Point3d(0.0f, 0.0f, 0.0f);
             }
-
-            out_nms[i] = n;
         }
+        out_nms[i] = n;
     }
 }
 
-void Mesh::smoothNormals(StaticVector<Point3d>& nms, StaticVector<StaticVector<int>>& ptsNeighPts)
+void Mesh::smoothNormals(StaticVector<Point3d>& nms, const MeshAdjacency& adjacency) const
 {
-    for(int i = 0; i < pts.size(); ++i)
-    {
-        Point3d& n = nms[i];
-        for(int j = 0; j < sizeOfStaticVector<int>(ptsNeighPts[i]); ++j)
+    filterVertices(nms, 1, [&](int i, const StaticVector<Point3d>& iterNms, Point3d& out_n) {
+        const int* nei = adjacency.neighborPts(i);
+        const int nneighs = adjacency.getNbNeighborPts(i);
+
+        Point3d n = iterNms[i];
+        for(int j = 0; j < nneighs; ++j)
         {
-            n = n + nms[ptsNeighPts[i][j]];
+            n = n + iterNms[nei[j]];
         }
-        if(sizeOfStaticVector<int>(ptsNeighPts[i]) > 0)
+        if(nneighs > 0)
         {
-            n = n / (float)sizeOfStaticVector<int>(ptsNeighPts[i]);
+            n = n / (float)nneighs;
         }
         n = n.normalize();
         if(std::isnan(n.x) || std::isnan(n.y) || std::isnan(n.z))
         {
             n = Point3d(0.0f, 0.0f, 0.0f);
         }
-    }
+        out_n = n;
+    });
 }
 
 void Mesh::removeFreePointsFromMesh(StaticVector<int>& out_ptIdToNewPtId)
@@ -2278,8 +3515,8 @@ bool Mesh::isTriangleObtuse(int triId) const
 
 void Mesh::getLargestConnectedComponentTrisIds(StaticVector<int>& out) const
 {
-    StaticVector<StaticVector<int>> ptsNeighPtsOrdered;
-    getPtsNeighPtsOrdered(ptsNeighPtsOrdered);
+    MeshAdjacency adjacency;
+    computePtsAdjacency(adjacency);
 
     StaticVector<int> colors;
     colors.reserve(pts.size());
@@ -2314,9 +3551,9 @@ void Mesh::getLargestConnectedComponentTrisIds(StaticVector<int>& out) const
                     throw std::runtime_error("getLargestConnectedComponentTrisIds: bad condition.");
                 }
             }
-            for(int j = 0; j < sizeOfStaticVector<int>(ptsNeighPtsOrdered[ptid]); ++j)
+            for(int j = 0; j < adjacency.getNbNeighborPts(ptid); ++j)
             {
-                int nptid = ptsNeighPtsOrdered[ptid][j];
+                int nptid = adjacency.neighborPts(ptid)[j];
                 if((nptid > -1) && (colors[nptid] == -1))
                 {
                     if(buff.size() >= buff.capacity()) // should not happen but no problem
@@ -2370,6 +3607,19 @@ void Mesh::load(const std::string& filepath)
         ALICEVISION_THROW_ERROR("Mesh::load: no such file: " << filepath);
     }
 
+    const std::string extension = boost::algorithm::to_lower_copy(boost::filesystem::path(filepath).extension().string());
+    if(extension == ".bin")
+    {
+        if(!loadFromBin(filepath))
+            ALICEVISION_THROW_ERROR("Mesh::load: invalid binary mesh file: " << filepath);
+        return;
+    }
+    // the generic importer is used for the other formats and when the OBJ or PLY file is not supported by the fast path
+    if(extension == ".obj" && loadFromObj(filepath))
+        return;
+    if(extension == ".ply" && loadFromPly(filepath))
+        return;
+
     // see https://github.com/assimp/assimp/blob/master/include/assimp/postprocess.h#L85
     const unsigned int pFlags =
         // If this flag is not specified, no vertices are referenced by more than one face
@@ -57,6 +57,26 @@ std::string EFileType_enumToString(const EFileType filetype);
 std::istream& operator>>(std::istream& in, EFileType& meshFileType);
 std::ostream& operator<<(std::ostream& os, EFileType meshFileType);
 
+/**
+ * @brief Vertices adjacency of a mesh in compressed sparse row arrays.
+ *        It is computed once with Mesh::computePtsAdjacency and reused by the smoothing and normals
+ *        computations across iterations, as long as the triangles are not modified.
+ */
+struct MeshAdjacency
+{
+    /// neighbor triangles of vertex i in [trisOffsets[i], trisOffsets[i+1]), sorted in ascending order
+    std::vector<int> trisOffsets;
+    std::vector<int> tris;
+    /// neighbor vertices of vertex i in [ptsOffsets[i], ptsOffsets[i+1]), ordered around the vertex
+    std::vector<int> ptsOffsets;
+    std::vector<int> pts;
+
+    int getNbPts() const { return trisOffsets.empty() ? 0 : static_cast<int>(trisOffsets.size()) - 1; }
+    int getNbNeighborTris(int ptId) const { return trisOffsets[ptId + 1] - trisOffsets[ptId]; }
+    int getNbNeighborPts(int ptId) const { return ptsOffsets[ptId + 1] - ptsOffsets[ptId]; }
+    const int* neighborTris(int ptId) const { return tris.data() + trisOffsets[ptId]; }
+    const int* neighborPts(int ptId) const { return pts.data() + ptsOffsets[ptId]; }
+};
 
 class Mesh
 {
@@ -150,6 +170,12 @@ protected:
     /// Per triangle material id
     std::vector<int> _trisMtlIds;
 
+    /// Load the binary layout of the previous versions (points and triangles only)
+    bool loadFromLegacyBin(const std::string& binFilepath);
+
+    /// Compute the neighbor triangles of each vertex only (MeshAdjacency::trisOffsets and MeshAdjacency::tris)
+    void computePtsNeighborTrianglesCSR(MeshAdjacency& out_adjacency) const;
+
 public:
     StaticVector<Point3d> pts;
     StaticVector<Mesh::triangle> tris;
@@ -166,14 +192,54 @@ public:
 
     void save(const std::string& filepath);
 
+    /**
+     * @brief Load a binary mesh file, the file is memory-mapped and each array is copied without decoding.
+     *        The files written by previous versions (points and triangles only) are still supported.
+     * @param[in] binFilepath the binary mesh file path
+     * @return false if the file cannot be opened or is invalid
+     */
     bool loadFromBin(const std::string& binFilepath);
-    void saveToBin(const std::string& binFilepath);
+
+    /**
+     * @brief Save the mesh in a binary file: points, triangles, vertices visibilities (compressed sparse row),
+     *        normals, UVs, colors and materials.
+     * @param[in] binFilepath the binary mesh file path
+     */
+    void saveToBin(const std::string& binFilepath) const;
+
+    /**
+     * @brief Load an OBJ file, the file is memory-mapped and parsed by chunks of lines in parallel.
+     *        The polygons are triangulated, the normals are ignored and the vertices are the distinct
+     *        (position, texture coordinates) pairs, like with the generic importer, in the order of the file.
+     * @param[in] objFilepath the OBJ file path
+     * @return false if the file cannot be opened or uses an unsupported syntax
+     */
+    bool loadFromObj(const std::string& objFilepath);
+
+    /**
+     * @brief Load a binary little-endian PLY file (positions, colors, texture coordinates and faces),
+     *        the vertices and the triangles are decoded in parallel from the memory-mapped file.
+     * @param[in] plyFilepath the PLY file path
+     * @return false if the file cannot be opened, is not binary little-endian or has an unsupported layout
+     */
+    bool loadFromPly(const std::string& plyFilepath);
+
+    /// Save the vertices and the triangles in an OBJ file, the lines are formatted by blocks in parallel
+    void saveToObj(const std::string& objFilepath) const;
+
+    /// Save the vertices, their colors and the triangles in a binary little-endian PLY file
+    void saveToPly(const std::string& plyFilepath) const;
+
+    /**
+     * @brief Load a mesh file: binary, OBJ and binary PLY files are read directly,
+     *        the other formats with the generic importer.
+     */
     void load(const std::string& filepath);
 
     void addMesh(const Mesh& mesh);
 
-    void getTrisMap(StaticVector<StaticVector<int>>& out, const mvsUtils::MultiViewParams& mp, int rc, int scale, int w, int h);
-    void getTrisMap(StaticVector<StaticVector<int>>& out, StaticVector<int>& visTris, const mvsUtils::MultiViewParams& mp, int rc, int scale,
+    void getTrisMap(StaticVector2D<int>& out, const mvsUtils::MultiViewParams& mp, int rc, int scale, int w, int h);
+    void getTrisMap(StaticVector2D<int>& out, StaticVector<int>& visTris, const mvsUtils::MultiViewParams& mp, int rc, int scale,
                     int w, int h);
     /// Per-vertex color data const accessor
     const std::vector<rgb>& colors() const { return _colors; }
@@ -185,17 +251,24 @@ public:
     std::vector<int>& trisMtlIds() { return _trisMtlIds; }
 
     void getDepthMap(StaticVector<float>& depthMap, const mvsUtils::MultiViewParams& mp, int rc, int scale, int w, int h);
-    void getDepthMap(StaticVector<float>& depthMap, StaticVector<StaticVector<int>>& tmp, const mvsUtils::MultiViewParams& mp, int rc,
+    void getDepthMap(StaticVector<float>& depthMap, const StaticVector2D<int>& tmp, const mvsUtils::MultiViewParams& mp, int rc,
                      int scale, int w, int h);
 
     void getPtsNeighbors(std::vector<std::vector<int>>& out_ptsNeighTris) const;
+    /// Neighbor triangles of each vertex, sorted in ascending order
     void getPtsNeighborTriangles(StaticVector<StaticVector<int>>& out_ptsNeighTris) const;
     void getPtsNeighPtsOrdered(StaticVector<StaticVector<int>>& out_ptsNeighTris) const;
 
+    /**
+     * @brief Compute the neighbor triangles and the ordered neighbor vertices of each vertex in parallel.
+     * @param[out] out_adjacency the vertices adjacency
+     */
+    void computePtsAdjacency(MeshAdjacency& out_adjacency) const;
+
     void getVisibleTrianglesIndexes(StaticVector<int>& out_visTri, const std::string& tmpDir, const mvsUtils::MultiViewParams& mp, int rc, int w, int h);
     void getVisibleTrianglesIndexes(StaticVector<int>& out_visTri, const std::string& depthMapFilepath, const std::string& trisMapFilepath,
                                                   const mvsUtils::MultiViewParams& mp, int rc, int w, int h);
-    void getVisibleTrianglesIndexes(StaticVector<int>& out_visTri, StaticVector<StaticVector<int>>& trisMap,
+    void getVisibleTrianglesIndexes(StaticVector<int>& out_visTri, const StaticVector2D<int>& trisMap,
                                                   StaticVector<float>& depthMap, const mvsUtils::MultiViewParams& mp, int rc, int w,
                                                   int h);
     void getVisibleTrianglesIndexes(StaticVector<int>& out_visTri, StaticVector<float>& depthMap, const mvsUtils::MultiViewParams& mp, int rc, int w,
@@ -206,14 +279,18 @@ public:
     void getNotOrientedEdges(StaticVector<StaticVector<int>>& edgesNeighTris, StaticVector<Pixel>& edgesPointsPairs);
     void getTrianglesEdgesIds(const StaticVector<StaticVector<int>>& edgesNeighTris, StaticVector<Voxel>& out) const;
 
-    void getLaplacianSmoothingVectors(StaticVector<StaticVector<int>>& ptsNeighPts, StaticVector<Point3d>& out_nms,
-                                      double maximalNeighDist = -1.0f);
+    void getLaplacianSmoothingVectors(const MeshAdjacency& adjacency, StaticVector<Point3d>& out_nms,
+                                      double maximalNeighDist = -1.0f) const;
     void laplacianSmoothPts(float maximalNeighDist = -1.0f);
-    void laplacianSmoothPts(StaticVector<StaticVector<int>>& ptsNeighPts, double maximalNeighDist = -1.0f);
-    void computeNormalsForPts(StaticVector<Point3d>& out_nms);
-    void computeNormalsForPts(StaticVector<StaticVector<int>>& ptsNeighTris, StaticVector<Point3d>& out_nms);
-    void smoothNormals(StaticVector<Point3d>& nms, StaticVector<StaticVector<int>>& ptsNeighPts);
-    Point3d computeTriangleNormal(int idTri);
+    /**
+     * @brief Laplacian smoothing of the vertices, the adjacency is reused for all the iterations.
+     *        Each iteration computes the smoothing vectors from the previous positions.
+     */
+    void laplacianSmoothPts(const MeshAdjacency& adjacency, double maximalNeighDist = -1.0f, int nbIterations = 1);
+    void computeNormalsForPts(StaticVector<Point3d>& out_nms) const;
+    void computeNormalsForPts(const MeshAdjacency& adjacency, StaticVector<Point3d>& out_nms) const;
+    void smoothNormals(StaticVector<Point3d>& nms, const MeshAdjacency& adjacency) const;
+    Point3d computeTriangleNormal(int idTri) const;
     Point3d computeTriangleCenterOfGravity(int idTri) const;
     double computeTriangleMaxEdgeLength(int idTri) const;
     double computeTriangleMinEdgeLength(int idTri) const;
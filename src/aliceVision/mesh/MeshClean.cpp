@@ -635,15 +635,8 @@ void MeshClean::init()
 {
     deallocateCleaningAttributes();
 
+    // already sorted in ascending order
     getPtsNeighborTriangles(ptsNeighTrisSortedAsc);
-    for(int i = 0; i < pts.size(); i++)
-    {
-        StaticVector<int>& ptNeigTris = ptsNeighTrisSortedAsc[i];
-        if(sizeOfStaticVector<int>(ptNeigTris) > 1)
-        {
-            qsort(&ptNeigTris[0], ptNeigTris.size(), sizeof(int), qSortCompareIntAsc);
-        }
-    }
 
     ptsNeighPtsOrdered.reserve(pts.size());
     ptsNeighPtsOrdered.resize(pts.size());
@@ -0,0 +1,662 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "MeshDecimation.hpp"
+
+#include <aliceVision/alicevision_omp.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/mvsData/Point3d.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace aliceVision {
+namespace mesh {
+
+namespace {
+
+/**
+ * @brief Symmetric 4x4 error quadric, stored as its upper triangle:
+ *        xx, xy, xz, xw, yy, yz, yw, zz, zw, ww
+ */
+struct Quadric
+{
+    double q[10] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+
+    void addPlane(const Point3d& n, double d, double weight)
+    {
+        q[0] += weight * n.x * n.x;
+        q[1] += weight * n.x * n.y;
+        q[2] += weight * n.x * n.z;
+        q[3] += weight * n.x * d;
+        q[4] += weight * n.y * n.y;
+        q[5] += weight * n.y * n.z;
+        q[6] += weight * n.y * d;
+        q[7] += weight * n.z * n.z;
+        q[8] += weight * n.z * d;
+        q[9] += weight * d * d;
+    }
+
+    Quadric& operator+=(const Quadric& other)
+    {
+        for(int i = 0; i < 10; ++i)
+            q[i] += other.q[i];
+        return *this;
+    }
+
+    double error(const Point3d& p) const
+    {
+        return q[0] * p.x * p.x + 2.0 * q[1] * p.x * p.y + 2.0 * q[2] * p.x * p.z + 2.0 * q[3] * p.x +
+               q[4] * p.y * p.y + 2.0 * q[5] * p.y * p.z + 2.0 * q[6] * p.y +
+               q[7] * p.z * p.z + 2.0 * q[8] * p.z + q[9];
+    }
+
+    /// Position of minimal error, false if the 3x3 system is (nearly) singular
+    bool minimizer(Point3d& out) const
+    {
+        const double c00 = q[4] * q[7] - q[5] * q[5];
+        const double c01 = q[2] * q[5] - q[1] * q[7];
+        const double c02 = q[1] * q[5] - q[2] * q[4];
+        const double c11 = q[0] * q[7] - q[2] * q[2];
+        const double c12 = q[1] * q[2] - q[0] * q[5];
+        const double c22 = q[0] * q[4] - q[1] * q[1];
+        const double det = q[0] * c00 + q[1] * c01 + q[2] * c02;
+        const double trace = q[0] + q[4] + q[7];
+
+        if(std::abs(det) <= 1e-10 * trace * trace * trace)
+            return false;
+
+        out.x = -(c00 * q[3] + c01 * q[6] + c02 * q[8]) / det;
+        out.y = -(c01 * q[3] + c11 * q[6] + c12 * q[8]) / det;
+        out.z = -(c02 * q[3] + c12 * q[6] + c22 * q[8]) / det;
+        return true;
+    }
+};
+
+/// An edge collapse, valid as long as the versions of its vertices are unchanged
+struct Collapse
+{
+    double cost;
+    int ptIdKept;
+    int ptIdRemoved;
+    int versionKept;
+    int versionRemoved;
+    Point3d position;
+
+    bool operator>(const Collapse& other) const { return cost > other.cost; }
+};
+
+using CollapseQueue = std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>>;
+
+class Decimater
+{
+public:
+    Decimater(Mesh& mesh, double minNormalCos);
+
+    int getNbUsedPts() const { return _nbUsedPts; }
+
+    /**
+     * @brief Dispatch the vertices in a grid of about nbBlocks spatial blocks.
+     * @param[out] out_blocksPts the vertices of each block
+     */
+    void initBlocks(int nbBlocks, std::vector<std::vector<int>>& out_blocksPts);
+
+    /// Collapse the edges inside a block, the blocks can be processed concurrently
+    int decimateBlock(int block, const std::vector<int>& blockPts, int nbPtsToRemove);
+
+    /**
+     * @brief Collapse the edges around the block borders, then the remaining edges of the mesh
+     *        if the border edges are not enough to reach the target.
+     */
+    int decimateBorders(int nbPtsToRemove);
+
+    /// Remove the collapsed vertices and triangles from the mesh
+    void compact();
+
+private:
+    bool isMovable(int ptId, int block) const
+    {
+        if(_ptRemoved[ptId] || _ptLocked[ptId])
+            return false;
+        // the border pass can move all the vertices
+        return block < 0 || (_ptBlock[ptId] == block && !_ptOnBlockBorder[ptId]);
+    }
+
+    void getNeighborPts(int ptId, std::vector<int>& out) const;
+    Collapse computeCollapse(int ptIdKept, int ptIdRemoved) const;
+    void pushCollapses(int ptId, int block, CollapseQueue& queue, std::vector<int>& neighbors) const;
+    bool isFlipped(int triId, int movedPtId, const Point3d& position) const;
+    bool applyCollapse(const Collapse& collapse, std::vector<int>& sharedTris, std::vector<int>& neighborsKept,
+                       std::vector<int>& neighborsRemoved);
+    int processQueue(CollapseQueue& queue, int block, int nbPtsToRemove);
+
+    Mesh& _mesh;
+    const double _minNormalCos;
+    const bool _hasVisibilities;
+    int _nbUsedPts = 0;
+
+    std::vector<std::vector<int>> _ptTris;
+    std::vector<Quadric> _ptQuadrics;
+    std::vector<int> _ptVersion;
+    std::vector<int> _ptBlock;
+    std::vector<char> _ptOnBlockBorder;
+    std::vector<char> _ptLocked;
+    std::vector<char> _ptRemoved;
+};
+
+Decimater::Decimater(Mesh& mesh, double minNormalCos)
+  : _mesh(mesh)
+  , _minNormalCos(minNormalCos)
+  , _hasVisibilities(mesh.pointsVisibilities.size() == mesh.pts.size())
+{
+    const int nbPts = _mesh.pts.size();
+
+    _ptTris.resize(nbPts);
+    for(int triId = 0; triId < _mesh.tris.size(); ++triId)
+    {
+        const Mesh::triangle& tri = _mesh.tris[triId];
+        if(!tri.alive)
+            continue;
+        for(int k = 0; k < 3; ++k)
+            _ptTris[tri.v[k]].push_back(triId);
+    }
+
+    _ptQuadrics.resize(nbPts);
+    _ptVersion.resize(nbPts, 0);
+    _ptBlock.resize(nbPts, -1);
+    _ptOnBlockBorder.resize(nbPts, 0);
+    _ptLocked.resize(nbPts, 0);
+    _ptRemoved.resize(nbPts, 0);
+
+    int nbUsedPts = 0;
+
+#pragma omp parallel for reduction(+:nbUsedPts)
+    for(int ptId = 0; ptId < nbPts; ++ptId)
+    {
+        const std::vector<int>& ptTris = _ptTris[ptId];
+        if(ptTris.empty())
+            continue;
+        ++nbUsedPts;
+
+        // area weighted planes of the neighbor triangles
+        Quadric& quadric = _ptQuadrics[ptId];
+        std::vector<std::pair<int, int>> edgesCount;
+        for(int triId : ptTris)
+        {
+            const Mesh::triangle& tri = _mesh.tris[triId];
+            const Point3d& p0 = _mesh.pts[tri.v[0]];
+            Point3d n = cross(_mesh.pts[tri.v[1]] - p0, _mesh.pts[tri.v[2]] - p0);
+            const double doubleArea = n.size();
+            if(doubleArea > 0.0)
+            {
+                n = n / doubleArea;
+                quadric.addPlane(n, -dot(n, p0), 0.5 * doubleArea);
+            }
+
+            for(int k = 0; k < 3; ++k)
+            {
+                if(tri.v[k] == ptId)
+                    continue;
+                auto it = std::find_if(edgesCount.begin(), edgesCount.end(),
+                                       [&](const std::pair<int, int>& e) { return e.first == tri.v[k]; });
+                if(it == edgesCount.end())
+                    edgesCount.emplace_back(tri.v[k], 1);
+                else
+                    ++it->second;
+            }
+        }
+
+        // lock the vertices on the mesh boundaries and on non-manifold edges
+        for(const auto& edgeCount : edgesCount)
+        {
+            if(edgeCount.second != 2)
+            {
+                _ptLocked[ptId] = 1;
+                break;
+            }
+        }
+    }
+
+    _nbUsedPts = nbUsedPts;
+}
+
+void Decimater::initBlocks(int nbBlocks, std::vector<std::vector<int>>& out_blocksPts)
+{
+    const int nbPts = _mesh.pts.size();
+    const double inf = std::numeric_limits<double>::max();
+    Point3d bbMin(inf, inf, inf);
+    Point3d bbMax(-inf, -inf, -inf);
+    for(int ptId = 0; ptId < nbPts; ++ptId)
+    {
+        if(_ptTris[ptId].empty())
+            continue;
+        const Point3d& p = _mesh.pts[ptId];
+        bbMin = Point3d(std::min(bbMin.x, p.x), std::min(bbMin.y, p.y), std::min(bbMin.z, p.z));
+        bbMax = Point3d(std::max(bbMax.x, p.x), std::max(bbMax.y, p.y), std::max(bbMax.z, p.z));
+    }
+
+    const double extent[3] = {bbMax.x - bbMin.x, bbMax.y - bbMin.y, bbMax.z - bbMin.z};
+    double cellSize = std::max({extent[0], extent[1], extent[2]}) / std::cbrt(std::max(nbBlocks, 1));
+    int dims[3] = {1, 1, 1};
+
+    if(cellSize > 0.0)
+    {
+        // shrink the cells until the grid has enough blocks, for the flat or elongated meshes
+        for(int iter = 0; iter < 10; ++iter)
+        {
+            for(int d = 0; d < 3; ++d)
+                dims[d] = std::max(1, static_cast<int>(std::ceil(extent[d] / cellSize)));
+            if(dims[0] * dims[1] * dims[2] >= nbBlocks)
+                break;
+            cellSize *= 0.8;
+        }
+    }
+
+    out_blocksPts.assign(dims[0] * dims[1] * dims[2], std::vector<int>());
+
+    for(int ptId = 0; ptId < nbPts; ++ptId)
+    {
+        if(_ptTris[ptId].empty())
+            continue;
+        const Point3d& p = _mesh.pts[ptId];
+        const double coords[3] = {p.x - bbMin.x, p.y - bbMin.y, p.z - bbMin.z};
+        int cell[3] = {0, 0, 0};
+        if(cellSize > 0.0)
+        {
+            for(int d = 0; d < 3; ++d)
+                cell[d] = std::min(dims[d] - 1, static_cast<int>(coords[d] / cellSize));
+        }
+        const int block = (cell[2] * dims[1] + cell[1]) * dims[0] + cell[0];
+        _ptBlock[ptId] = block;
+        out_blocksPts[block].push_back(ptId);
+    }
+
+    // the vertices of the triangles spanning several blocks are locked until the border pass
+#pragma omp parallel for
+    for(int ptId = 0; ptId < nbPts; ++ptId)
+    {
+        for(int triId : _ptTris[ptId])
+        {
+            const Mesh::triangle& tri = _mesh.tris[triId];
+            if(_ptBlock[tri.v[0]] != _ptBlock[ptId] || _ptBlock[tri.v[1]] != _ptBlock[ptId] ||
+               _ptBlock[tri.v[2]] != _ptBlock[ptId])
+            {
+                _ptOnBlockBorder[ptId] = 1;
+                break;
+            }
+        }
+    }
+}
+
+void Decimater::getNeighborPts(int ptId, std::vector<int>& out) const
+{
+    out.clear();
+    for(int triId : _ptTris[ptId])
+    {
+        const Mesh::triangle& tri = _mesh.tris[triId];
+        for(int k = 0; k < 3; ++k)
+        {
+            if(tri.v[k] != ptId)
+                out.push_back(tri.v[k]);
+        }
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+}
+
+Collapse Decimater::computeCollapse(int ptIdKept, int ptIdRemoved) const
+{
+    Quadric quadric = _ptQuadrics[ptIdKept];
+    quadric += _ptQuadrics[ptIdRemoved];
+
+    Collapse collapse;
+    collapse.ptIdKept = ptIdKept;
+    collapse.ptIdRemoved = ptIdRemoved;
+    collapse.versionKept = _ptVersion[ptIdKept];
+    collapse.versionRemoved = _ptVersion[ptIdRemoved];
+
+    if(quadric.minimizer(collapse.position))
+    {
+        collapse.cost = quadric.error(collapse.position);
+        return collapse;
+    }
+
+    // singular quadric (flat or linear neighborhood): best of the edge extremities and middle
+    const Point3d& pKept = _mesh.pts[ptIdKept];
+    const Point3d& pRemoved = _mesh.pts[ptIdRemoved];
+    const Point3d candidates[3] = {pKept, pRemoved, (pKept + pRemoved) * 0.5};
+    collapse.cost = std::numeric_limits<double>::max();
+    for(const Point3d& candidate : candidates)
+    {
+        const double cost = quadric.error(candidate);
+        if(cost < collapse.cost)
+        {
+            collapse.cost = cost;
+            collapse.position = candidate;
+        }
+    }
+    return collapse;
+}
+
+void Decimater::pushCollapses(int ptId, int block, CollapseQueue& queue, std::vector<int>& neighbors) const
+{
+    getNeighborPts(ptId, neighbors);
+    for(int neighborPtId : neighbors)
+    {
+        if(isMovable(neighborPtId, block))
+            queue.push(computeCollapse(ptId, neighborPtId));
+    }
+}
+
+bool Decimater::isFlipped(int triId, int movedPtId, const Point3d& position) const
+{
+    const Mesh::triangle& tri = _mesh.tris[triId];
+    Point3d before[3];
+    Point3d after[3];
+    for(int k = 0; k < 3; ++k)
+    {
+        before[k] = _mesh.pts[tri.v[k]];
+        after[k] = (tri.v[k] == movedPtId) ? position : before[k];
+    }
+    const Point3d nBefore = cross(before[1] - before[0], before[2] - before[0]);
+    const Point3d nAfter = cross(after[1] - after[0], after[2] - after[0]);
+    const double sizeBefore = nBefore.size();
+    const double sizeAfter = nAfter.size();
+
+    if(sizeAfter <= 0.0)
+        return true;
+    if(sizeBefore <= 0.0)
+        return false;
+    return dot(nBefore, nAfter) < _minNormalCos * sizeBefore * sizeAfter;
+}
+
+bool Decimater::applyCollapse(const Collapse& collapse, std::vector<int>& sharedTris, std::vector<int>& neighborsKept,
+                              std::vector<int>& neighborsRemoved)
+{
+    const int ptIdKept = collapse.ptIdKept;
+    const int ptIdRemoved = collapse.ptIdRemoved;
+
+    sharedTris.clear();
+    for(int triId : _ptTris[ptIdRemoved])
+    {
+        const Mesh::triangle& tri = _mesh.tris[triId];
+        if(tri.v[0] == ptIdKept || tri.v[1] == ptIdKept || tri.v[2] == ptIdKept)
+            sharedTris.push_back(triId);
+    }
+    // the locked vertices guarantee a manifold edge
+    if(sharedTris.size() != 2)
+        return false;
+
+    // link condition: the only common neighbors are the opposite vertices of the edge triangles
+    getNeighborPts(ptIdKept, neighborsKept);
+    getNeighborPts(ptIdRemoved, neighborsRemoved);
+    std::size_t nbCommonNeighbors = 0;
+    for(int neighborPtId : neighborsRemoved)
+    {
+        if(std::binary_search(neighborsKept.begin(), neighborsKept.end(), neighborPtId))
+            ++nbCommonNeighbors;
+    }
+    if(nbCommonNeighbors != sharedTris.size())
+        return false;
+
+    const auto isShared = [&](int triId) {
+        return std::find(sharedTris.begin(), sharedTris.end(), triId) != sharedTris.end();
+    };
+
+    for(int ptId : {ptIdKept, ptIdRemoved})
+    {
+        for(int triId : _ptTris[ptId])
+        {
+            if(!isShared(triId) && isFlipped(triId, ptId, collapse.position))
+                return false;
+        }
+    }
+
+    // remove the edge triangles
+    for(int triId : sharedTris)
+    {
+        Mesh::triangle& tri = _mesh.tris[triId];
+        tri.alive = false;
+        for(int k = 0; k < 3; ++k)
+        {
+            if(tri.v[k] == ptIdKept || tri.v[k] == ptIdRemoved)
+                continue;
+            std::vector<int>& oppositeTris = _ptTris[tri.v[k]];
+            oppositeTris.erase(std::find(oppositeTris.begin(), oppositeTris.end(), triId));
+        }
+    }
+
+    // move the triangles of the removed vertex to the kept vertex
+    std::vector<int>& keptTris = _ptTris[ptIdKept];
+    keptTris.erase(std::remove_if(keptTris.begin(), keptTris.end(), isShared), keptTris.end());
+    for(int triId : _ptTris[ptIdRemoved])
+    {
+        if(isShared(triId))
+            continue;
+        Mesh::triangle& tri = _mesh.tris[triId];
+        for(int k = 0; k < 3; ++k)
+        {
+            if(tri.v[k] == ptIdRemoved)
+                tri.v[k] = ptIdKept;
+        }
+        keptTris.push_back(triId);
+    }
+    std::vector<int>().swap(_ptTris[ptIdRemoved]);
+
+    _mesh.pts[ptIdKept] = collapse.position;
+    _ptQuadrics[ptIdKept] += _ptQuadrics[ptIdRemoved];
+    _ptRemoved[ptIdRemoved] = 1;
+    ++_ptVersion[ptIdKept];
+
+    if(_hasVisibilities)
+    {
+        PointVisibility& visibility = _mesh.pointsVisibilities[ptIdKept];
+        for(int camIndex : _mesh.pointsVisibilities[ptIdRemoved])
+            visibility.push_back_distinct(camIndex);
+        PointVisibility().swap(_mesh.pointsVisibilities[ptIdRemoved]);
+    }
+    return true;
+}
+
+int Decimater::processQueue(CollapseQueue& queue, int block, int nbPtsToRemove)
+{
+    std::vector<int> sharedTris;
+    std::vector<int> neighborsKept;
+    std::vector<int> neighborsRemoved;
+    int nbRemoved = 0;
+
+    while(nbRemoved < nbPtsToRemove && !queue.empty())
+    {
+        const Collapse collapse = queue.top();
+        queue.pop();
+
+        // outdated collapse
+        if(_ptRemoved[collapse.ptIdKept] || _ptRemoved[collapse.ptIdRemoved] ||
+           _ptVersion[collapse.ptIdKept] != collapse.versionKept ||
+           _ptVersion[collapse.ptIdRemoved] != collapse.versionRemoved)
+            continue;
+
+        if(!applyCollapse(collapse, sharedTris, neighborsKept, neighborsRemoved))
+            continue;
+
+        ++nbRemoved;
+        pushCollapses(collapse.ptIdKept, block, queue, neighborsKept);
+    }
+    return nbRemoved;
+}
+
+int Decimater::decimateBlock(int block, const std::vector<int>& blockPts, int nbPtsToRemove)
+{
+    if(nbPtsToRemove <= 0)
+        return 0;
+
+    CollapseQueue queue;
+    std::vector<int> neighbors;
+    for(int ptId : blockPts)
+    {
+        if(!isMovable(ptId, block))
+            continue;
+        getNeighborPts(ptId, neighbors);
+        for(int neighborPtId : neighbors)
+        {
+            if(neighborPtId > ptId && isMovable(neighborPtId, block))
+                queue.push(computeCollapse(ptId, neighborPtId));
+        }
+    }
+    return processQueue(queue, block, nbPtsToRemove);
+}
+
+int Decimater::decimateBorders(int nbPtsToRemove)
+{
+    if(nbPtsToRemove <= 0)
+        return 0;
+
+    CollapseQueue queue;
+    std::vector<int> neighbors;
+    for(int ptId = 0; ptId < _mesh.pts.size(); ++ptId)
+    {
+        if(!_ptOnBlockBorder[ptId] || !isMovable(ptId, -1))
+            continue;
+        getNeighborPts(ptId, neighbors);
+        for(int neighborPtId : neighbors)
+        {
+            // the edges between two border vertices are only pushed once
+            if(_ptOnBlockBorder[neighborPtId] && neighborPtId < ptId)
+                continue;
+            if(isMovable(neighborPtId, -1))
+                queue.push(computeCollapse(ptId, neighborPtId));
+        }
+    }
+    int nbRemoved = processQueue(queue, -1, nbPtsToRemove);
+    if(nbRemoved >= nbPtsToRemove)
+        return nbRemoved;
+
+    // the blocks stopped at their share of the collapses, so their inner edges can still be collapsed
+    for(int ptId = 0; ptId < _mesh.pts.size(); ++ptId)
+    {
+        if(!isMovable(ptId, -1))
+            continue;
+        getNeighborPts(ptId, neighbors);
+        for(int neighborPtId : neighbors)
+        {
+            if(neighborPtId > ptId && isMovable(neighborPtId, -1))
+                queue.push(computeCollapse(ptId, neighborPtId));
+        }
+    }
+    nbRemoved += processQueue(queue, -1, nbPtsToRemove - nbRemoved);
+    return nbRemoved;
+}
+
+void Decimater::compact()
+{
+    const int nbPts = _mesh.pts.size();
+    std::vector<int> newPtIds(nbPts, -1);
+    int nbNewPts = 0;
+    for(int ptId = 0; ptId < nbPts; ++ptId)
+    {
+        if(!_ptRemoved[ptId] && !_ptTris[ptId].empty())
+            newPtIds[ptId] = nbNewPts++;
+    }
+
+    const bool hasColors = _mesh.colors().size() == static_cast<std::size_t>(nbPts);
+    StaticVector<Point3d> pts;
+    pts.reserve(nbNewPts);
+    std::vector<rgb> colors;
+    PointsVisibility visibilities;
+    if(hasColors)
+        colors.reserve(nbNewPts);
+    if(_hasVisibilities)
+        visibilities.resize(nbNewPts);
+
+    for(int ptId = 0; ptId < nbPts; ++ptId)
+    {
+        if(newPtIds[ptId] < 0)
+            continue;
+        pts.push_back(_mesh.pts[ptId]);
+        if(hasColors)
+            colors.push_back(_mesh.colors()[ptId]);
+        if(_hasVisibilities)
+            visibilities[newPtIds[ptId]].swap(_mesh.pointsVisibilities[ptId]);
+    }
+
+    const bool hasMaterials = _mesh.trisMtlIds().size() == static_cast<std::size_t>(_mesh.tris.size());
+    StaticVector<Mesh::triangle> tris;
+    std::vector<int> trisMtlIds;
+    for(int triId = 0; triId < _mesh.tris.size(); ++triId)
+    {
+        const Mesh::triangle& tri = _mesh.tris[triId];
+        if(!tri.alive)
+            continue;
+        tris.push_back(Mesh::triangle(newPtIds[tri.v[0]], newPtIds[tri.v[1]], newPtIds[tri.v[2]]));
+        if(hasMaterials)
+            trisMtlIds.push_back(_mesh.trisMtlIds()[triId]);
+    }
+
+    _mesh.pts.swap(pts);
+    _mesh.tris.swap(tris);
+    if(hasColors)
+        _mesh.colors().swap(colors);
+    if(_hasVisibilities)
+        _mesh.pointsVisibilities.swap(visibilities);
+    if(hasMaterials)
+        _mesh.trisMtlIds().swap(trisMtlIds);
+
+    // the collapses invalidate the uv coordinates and the normals
+    _mesh.uvCoords.clear();
+    _mesh.trisUvIds.clear();
+    _mesh.normals.clear();
+    _mesh.trisNormalsIds.clear();
+}
+
+} // namespace
+
+int decimateMesh(Mesh& mesh, const MeshDecimationParams& params)
+{
+    Decimater decimater(mesh, params.minNormalCos);
+
+    const int nbPts = decimater.getNbUsedPts();
+    if(params.nbVertices <= 0 || nbPts <= params.nbVertices)
+    {
+        ALICEVISION_LOG_INFO("Mesh decimation: nothing to do, " << nbPts << " vertices for a target of "
+                             << params.nbVertices << ".");
+        return mesh.pts.size();
+    }
+
+    const int nbBlocks = (params.nbBlocks > 0) ? params.nbBlocks : 8 * omp_get_max_threads();
+    std::vector<std::vector<int>> blocksPts;
+    decimater.initBlocks(nbBlocks, blocksPts);
+
+    ALICEVISION_LOG_INFO("Mesh decimation from " << nbPts << " to " << params.nbVertices << " vertices in "
+                         << blocksPts.size() << " blocks.");
+
+    const double removeRatio = 1.0 - static_cast<double>(params.nbVertices) / nbPts;
+    int nbRemovedPts = 0;
+
+#pragma omp parallel for schedule(dynamic) reduction(+:nbRemovedPts)
+    for(int block = 0; block < blocksPts.size(); ++block)
+    {
+        const int nbBlockPtsToRemove = static_cast<int>(removeRatio * blocksPts[block].size());
+        nbRemovedPts += decimater.decimateBlock(block, blocksPts[block], nbBlockPtsToRemove);
+    }
+
+    ALICEVISION_LOG_DEBUG("Mesh decimation: " << nbRemovedPts << " vertices removed inside the blocks.");
+
+    nbRemovedPts += decimater.decimateBorders(nbPts - params.nbVertices - nbRemovedPts);
+
+    decimater.compact();
+
+    ALICEVISION_LOG_INFO("Mesh decimation done: " << mesh.pts.size() << " vertices and " << mesh.tris.size()
+                         << " triangles.");
+    return mesh.pts.size();
+}
+
+} // namespace mesh
+} // namespace aliceVision
@@ -0,0 +1,43 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mesh/Mesh.hpp>
+
+namespace aliceVision {
+namespace mesh {
+
+struct MeshDecimationParams
+{
+    /// number of vertices of the decimated mesh
+    int nbVertices = 0;
+    /// number of spatial blocks decimated in parallel, 0 to use 8 blocks per thread
+    int nbBlocks = 0;
+    /// minimal cosine between the normals of a triangle before and after a collapse
+    double minNormalCos = 0.2;
+};
+
+/**
+ * @brief Decimate the mesh with quadric error edge collapses.
+ *
+ * The vertices are dispatched in a grid of spatial blocks decimated in parallel. The triangles spanning
+ * several blocks are locked during this pass, then a serial pass collapses the edges around the block borders
+ * and, if the target is not reached yet, the other edges of the mesh.
+ * The vertices on the mesh boundaries and on non-manifold edges are never moved.
+ *
+ * The visibilities of a collapsed vertex are merged into the remaining vertex, so the decimated mesh
+ * does not need a visibilities remapping. The vertex colors and the triangles materials are kept,
+ * the uv coordinates and the normals are cleared.
+ *
+ * @param[in,out] mesh the mesh to decimate
+ * @param[in] params the decimation parameters
+ * @return the number of vertices of the decimated mesh
+ */
+int decimateMesh(Mesh& mesh, const MeshDecimationParams& params);
+
+} // namespace mesh
+} // namespace aliceVision
@@ -0,0 +1,102 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/mesh/Mesh.hpp>
+#include <aliceVision/mesh/MeshDecimation.hpp>
+
+#include <cmath>
+
+#define BOOST_TEST_MODULE meshDecimation
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+
+namespace {
+
+/// a wavy grid of nbSide x nbSide vertices starting at (originX, originY), two triangles per cell
+void addGridMesh(int nbSide, double originX, double originY, mesh::Mesh& mesh)
+{
+    const int firstPtId = mesh.pts.size();
+    for(int y = 0; y < nbSide; ++y)
+        for(int x = 0; x < nbSide; ++x)
+            mesh.pts.push_back(Point3d(originX + x, originY + y, 2.0 * std::sin(x * 0.3) * std::cos(y * 0.2)));
+
+    for(int y = 0; y + 1 < nbSide; ++y)
+    {
+        for(int x = 0; x + 1 < nbSide; ++x)
+        {
+            const int v = firstPtId + y * nbSide + x;
+            mesh.tris.push_back(mesh::Mesh::triangle(v, v + 1, v + nbSide));
+            mesh.tris.push_back(mesh::Mesh::triangle(v + 1, v + nbSide + 1, v + nbSide));
+        }
+    }
+}
+
+bool isGridBorder(const Point3d& p, int nbSide)
+{
+    return p.x == 0.0 || p.y == 0.0 || p.x == nbSide - 1 || p.y == nbSide - 1;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(meshDecimation_targetAndBorders)
+{
+    const int nbSide = 60;
+    const int nbBorderPts = 4 * (nbSide - 1);
+
+    for(int nbBlocks : {1, 16, 64})
+    {
+        mesh::Mesh mesh;
+        addGridMesh(nbSide, 0.0, 0.0, mesh);
+
+        mesh::MeshDecimationParams params;
+        params.nbVertices = nbBorderPts + 200;
+        params.nbBlocks = nbBlocks;
+
+        // the target is reached even if the blocks stop at their share of the collapses
+        BOOST_CHECK_EQUAL(mesh::decimateMesh(mesh, params), params.nbVertices);
+        BOOST_CHECK_EQUAL(mesh.pts.size(), params.nbVertices);
+
+        // the mesh boundary vertices are kept in place
+        int nbKeptBorderPts = 0;
+        for(int i = 0; i < mesh.pts.size(); ++i)
+        {
+            if(isGridBorder(mesh.pts[i], nbSide))
+                ++nbKeptBorderPts;
+        }
+        BOOST_CHECK_EQUAL(nbKeptBorderPts, nbBorderPts);
+
+        // a closed disk: V - E + F = 1 and 2E = 3F + boundary edges
+        BOOST_CHECK_EQUAL(mesh.tris.size(), 2 * mesh.pts.size() - nbBorderPts - 2);
+        for(int i = 0; i < mesh.tris.size(); ++i)
+        {
+            for(int k = 0; k < 3; ++k)
+            {
+                BOOST_CHECK_GE(mesh.tris[i].v[k], 0);
+                BOOST_CHECK_LT(mesh.tris[i].v[k], mesh.pts.size());
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(meshDecimation_targetWithoutBlockBorders)
+{
+    // one patch per block, so there is no triangle spanning several blocks
+    mesh::Mesh mesh;
+    addGridMesh(10, 0.0, 0.0, mesh);
+    addGridMesh(11, 100.0, 0.0, mesh);
+    addGridMesh(12, 0.0, 100.0, mesh);
+    addGridMesh(13, 100.0, 100.0, mesh);
+
+    mesh::MeshDecimationParams params;
+    params.nbVertices = 250;
+    params.nbBlocks = 4;
+
+    // the blocks only remove their rounded share of the vertices, the last pass completes it
+    BOOST_CHECK_EQUAL(mesh::decimateMesh(mesh, params), params.nbVertices);
+    BOOST_CHECK_EQUAL(mesh.pts.size(), params.nbVertices);
+}
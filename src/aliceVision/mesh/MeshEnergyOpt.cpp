@@ -5,6 +5,7 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "MeshEnergyOpt.hpp"
+#include <aliceVision/mesh/meshFilter.hpp>
 #include <aliceVision/system/Logger.hpp>
 
 #include <boost/filesystem.hpp>
@@ -25,55 +26,19 @@ MeshEnergyOpt::~MeshEnergyOpt() = default;
 
 void MeshEnergyOpt::computeLaplacianPtsParallel(StaticVector<Point3d>& out_lapPts)
 {
-    out_lapPts.reserve(pts.size());
-    out_lapPts.resize_with(pts.size(), Point3d(0.0f, 0.0f, 0.f));
-    int nlabpts = 0;
+    out_lapPts.resize(pts.size());
 
 #pragma omp parallel for
     for(int i = 0; i < pts.size(); i++)
     {
         Point3d lapPt;
         if(getLaplacianSmoothingVector(i, lapPt))
-        {
             out_lapPts[i] = lapPt;
-            nlabpts++;
-        }
+        else
+            out_lapPts[i] = Point3d(0.0f, 0.0f, 0.f);
     }
 }
 
-void MeshEnergyOpt::updateGradientParallel(float lambda, const Point3d& LU,
-                                                const Point3d& RD, StaticVectorBool& ptsCanMove)
-{
-    // printf("nlabpts %i of %i\n",nlabpts,pts->size());
-    StaticVector<Point3d> lapPts;
-    computeLaplacianPtsParallel(lapPts);
-
-    StaticVector<Point3d> newPts;
-    newPts.reserve(pts.size());
-    newPts.push_back_arr(&pts);
-
-#pragma omp parallel for
-    for(int i = 0; i < pts.size(); ++i)
-    {
-        if( ptsCanMove.empty() || ptsCanMove[i] )
-        {
-            Point3d n;
-
-            if(getBiLaplacianSmoothingVector(i, lapPts, n))
-            {
-                Point3d p = newPts[i] + n * lambda;
-                if((p.x > LU.x) && (p.y > LU.y) && (p.z > LU.z) && (p.x < RD.x) && (p.y < RD.y) && (p.z < RD.z))
-                {
-                    newPts[i] = p;
-                }
-            }
-        }
-    }
-
-    pts.clear();
-    pts.swap(newPts);
-}
-
 bool MeshEnergyOpt::optimizeSmooth(float lambda, int niter, StaticVectorBool& ptsCanMove)
 {
     if(pts.size() <= 4)
@@ -100,13 +65,32 @@ bool MeshEnergyOpt::optimizeSmooth(float lambda, int niter, StaticVectorBool& pt
                          << "\t- lamda: " << lambda << std::endl
                          << "\t- niters: " << niter << std::endl);
 
-    for(int i = 0; i < niter; i++)
-    {
-        ALICEVISION_LOG_INFO("Optimizing mesh smooth: iteration " << i);
-        updateGradientParallel(lambda, LU, RD, ptsCanMove);
-        //if(saveDebug)
-        //    save(folder + "mesh_smoothed_" + std::to_string(i));
-    }
+    // the laplacian of each vertex, computed at the start of each iteration
+    StaticVector<Point3d> lapPts;
+    int iter = 0;
+
+    filterVertices(pts, niter,
+        [&](const StaticVector<Point3d>&) {
+            ALICEVISION_LOG_INFO("Optimizing mesh smooth: iteration " << iter++);
+            computeLaplacianPtsParallel(lapPts);
+        },
+        [&](int i, const StaticVector<Point3d>& iterPts, Point3d& out_pt) {
+            out_pt = iterPts[i];
+
+            if(ptsCanMove.empty() || ptsCanMove[i])
+            {
+                Point3d n;
+
+                if(getBiLaplacianSmoothingVector(i, lapPts, n))
+                {
+                    const Point3d p = iterPts[i] + n * lambda;
+                    if((p.x > LU.x) && (p.y > LU.y) && (p.z > LU.z) && (p.x < RD.x) && (p.y < RD.y) && (p.z < RD.z))
+                    {
+                        out_pt = p;
+                    }
+                }
+            }
+        });
 
     return true;
 }
@@ -22,8 +22,8 @@ public:
     bool optimizeSmooth(float lambda, int niter, StaticVectorBool& ptsCanMove);
 
 private:
+    /// Laplacian of each vertex from the current vertices positions
     void computeLaplacianPtsParallel(StaticVector<Point3d>& out_lapPts);
-    void updateGradientParallel(float lambda, const Point3d& LU, const Point3d& RD, StaticVectorBool& ptsCanMove);
 };
 
 } // namespace mesh
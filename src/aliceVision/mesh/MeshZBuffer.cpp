@@ -0,0 +1,138 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "MeshZBuffer.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace aliceVision {
+namespace mesh {
+
+/// Depth of the near plane the triangles are clipped against
+static const double nearDepth = 1e-6;
+
+MeshZBuffer::MeshZBuffer(const Mesh& mesh, const mvsUtils::MultiViewParams& mp, int camId, int downscale)
+  : _mp(mp)
+  , _camId(camId)
+  , _downscale(std::max(downscale, 1))
+{
+    _width = (mp.getWidth(camId) + _downscale - 1) / _downscale;
+    _height = (mp.getHeight(camId) + _downscale - 1) / _downscale;
+    _depths.assign(static_cast<std::size_t>(_width) * _height, -1.0f);
+
+    const Matrix3x4& P = mp.camArr[camId];
+
+    for(int triId = 0; triId < mesh.tris.size(); ++triId)
+    {
+        const Mesh::triangle& tri = mesh.tris[triId];
+        Point3d XT[3];
+        for(int k = 0; k < 3; ++k)
+            XT[k] = P * mesh.pts[tri.v[k]];
+
+        // clip the triangle against the near plane, the homogeneous coordinates are linear along the edges
+        Point3d clipped[4];
+        int nbClipped = 0;
+        for(int k = 0; k < 3; ++k)
+        {
+            const Point3d& current = XT[k];
+            const Point3d& next = XT[(k + 1) % 3];
+            const bool isCurrentInFront = (current.z >= nearDepth);
+            const bool isNextInFront = (next.z >= nearDepth);
+            if(isCurrentInFront)
+                clipped[nbClipped++] = current;
+            if(isCurrentInFront != isNextInFront)
+                clipped[nbClipped++] = current + (next - current) * ((nearDepth - current.z) / (next.z - current.z));
+        }
+        if(nbClipped < 3)
+            continue;
+
+        Point3d projected[4];
+        for(int k = 0; k < nbClipped; ++k)
+            projected[k] = Point3d(clipped[k].x / (clipped[k].z * _downscale), clipped[k].y / (clipped[k].z * _downscale), clipped[k].z);
+
+        // the clipped polygon is a triangle or a quad
+        rasterizeTriangle(projected[0], projected[1], projected[2]);
+        if(nbClipped == 4)
+            rasterizeTriangle(projected[0], projected[2], projected[3]);
+    }
+}
+
+void MeshZBuffer::rasterizeTriangle(const Point3d& a, const Point3d& b, const Point3d& c)
+{
+    // the vertices of the clipped triangles can project far outside the buffer, clamp before the integer conversion
+    const double xMinF = std::floor(std::min({a.x, b.x, c.x}));
+    const double xMaxF = std::ceil(std::max({a.x, b.x, c.x}));
+    const double yMinF = std::floor(std::min({a.y, b.y, c.y}));
+    const double yMaxF = std::ceil(std::max({a.y, b.y, c.y}));
+    if(xMaxF < 0.0 || yMaxF < 0.0 || xMinF > _width - 1 || yMinF > _height - 1)
+        return;
+
+    const int xMin = static_cast<int>(std::max(xMinF, 0.0));
+    const int xMax = static_cast<int>(std::min(xMaxF, double(_width - 1)));
+    const int yMin = static_cast<int>(std::max(yMinF, 0.0));
+    const int yMax = static_cast<int>(std::min(yMaxF, double(_height - 1)));
+
+    const auto edge = [](const Point3d& p0, const Point3d& p1, double x, double y) {
+        return (p1.x - p0.x) * (y - p0.y) - (p1.y - p0.y) * (x - p0.x);
+    };
+
+    const double area = edge(a, b, c.x, c.y);
+    if(std::abs(area) < 1e-12)
+        return;
+
+    // the inverse of the depth is linear in the image
+    const double invDepths[3] = {1.0 / a.z, 1.0 / b.z, 1.0 / c.z};
+
+    for(int y = yMin; y <= yMax; ++y)
+    {
+        const double py = y + 0.5;
+        for(int x = xMin; x <= xMax; ++x)
+        {
+            const double px = x + 0.5;
+            const double wa = edge(b, c, px, py) / area;
+            const double wb = edge(c, a, px, py) / area;
+            const double wc = 1.0 - wa - wb;
+            if(wa < 0.0 || wb < 0.0 || wc < 0.0)
+                continue;
+
+            const float depth = static_cast<float>(1.0 / (wa * invDepths[0] + wb * invDepths[1] + wc * invDepths[2]));
+            float& bufferDepth = _depths[y * _width + x];
+            if(bufferDepth < 0.0f || depth < bufferDepth)
+                bufferDepth = depth;
+        }
+    }
+}
+
+bool MeshZBuffer::isPointVisible(const Point3d& p, double relativeTolerance) const
+{
+    const Point3d XT = _mp.camArr[_camId] * p;
+    if(XT.z <= 0.0)
+        return false;
+
+    const double u = XT.x / (XT.z * _downscale);
+    const double v = XT.y / (XT.z * _downscale);
+    if(u < 0.0 || v < 0.0 || u >= _width || v >= _height)
+        return false;
+
+    const int x = static_cast<int>(u);
+    const int y = static_cast<int>(v);
+    float maxDepth = -1.0f;
+    for(int yy = std::max(0, y - 1); yy <= std::min(_height - 1, y + 1); ++yy)
+    {
+        for(int xx = std::max(0, x - 1); xx <= std::min(_width - 1, x + 1); ++xx)
+            maxDepth = std::max(maxDepth, getDepth(xx, yy));
+    }
+
+    // no triangle around the point
+    if(maxDepth < 0.0f)
+        return true;
+
+    return XT.z <= maxDepth * (1.0 + relativeTolerance);
+}
+
+} // namespace mesh
+} // namespace aliceVision
@@ -0,0 +1,63 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mesh/Mesh.hpp>
+#include <aliceVision/mvsData/Point3d.hpp>
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+
+#include <vector>
+
+namespace aliceVision {
+namespace mesh {
+
+/**
+ * @brief Depth of the closest triangles of a mesh seen by a camera, rasterized with a z-buffer.
+ *        It replaces the ray casts to test the occlusions of many points in the same camera.
+ */
+class MeshZBuffer
+{
+public:
+    /**
+     * @brief Rasterize the mesh triangles in the camera.
+     *        The triangles crossing the camera plane are clipped against a near plane.
+     * @param[in] mesh the mesh
+     * @param[in] mp the multi-view parameters
+     * @param[in] camId the camera index
+     * @param[in] downscale the buffer resolution is the camera resolution divided by downscale
+     */
+    MeshZBuffer(const Mesh& mesh, const mvsUtils::MultiViewParams& mp, int camId, int downscale = 1);
+
+    int getWidth() const { return _width; }
+    int getHeight() const { return _height; }
+
+    /// Depth of the closest triangle at a buffer pixel, negative if the pixel sees no triangle
+    float getDepth(int x, int y) const { return _depths[y * _width + x]; }
+
+    /**
+     * @brief Check if a 3D point projects in the camera image and is not hidden by the mesh.
+     *        The point is compared to the farthest depth of its 3x3 neighborhood in the buffer,
+     *        so the vertices on the depth discontinuities of the mesh are kept.
+     * @param[in] p the 3D point
+     * @param[in] relativeTolerance the point depth can exceed the buffer depth by this ratio of the depth
+     */
+    bool isPointVisible(const Point3d& p, double relativeTolerance = 0.01) const;
+
+private:
+    /// Rasterize a triangle given in buffer pixels coordinates and camera depth
+    void rasterizeTriangle(const Point3d& a, const Point3d& b, const Point3d& c);
+
+    const mvsUtils::MultiViewParams& _mp;
+    const int _camId;
+    const int _downscale;
+    int _width;
+    int _height;
+    std::vector<float> _depths;
+};
+
+} // namespace mesh
+} // namespace aliceVision
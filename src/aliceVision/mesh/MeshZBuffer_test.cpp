@@ -0,0 +1,102 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/mesh/Mesh.hpp>
+#include <aliceVision/mesh/MeshZBuffer.hpp>
+#include <aliceVision/camera/Pinhole.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+
+#define BOOST_TEST_MODULE meshZBuffer
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+
+namespace {
+
+/// a 1000x1000 camera at the origin, looking at +Z
+sfmData::SfMData makeCamera()
+{
+    sfmData::SfMData sfmData;
+    sfmData.intrinsics[0] = std::make_shared<camera::Pinhole>(1000, 1000, 1000.0, 1000.0, 0.0, 0.0);
+    sfmData.views[0] = std::make_shared<sfmData::View>("", 0, 0, 0, 1000, 1000);
+    sfmData.setPose(*sfmData.views[0], sfmData::CameraPose(geometry::Pose3(Mat3::Identity(), Vec3::Zero())));
+    return sfmData;
+}
+
+void addTriangle(const Point3d& a, const Point3d& b, const Point3d& c, mesh::Mesh& mesh)
+{
+    const int firstPtId = mesh.pts.size();
+    mesh.pts.push_back(a);
+    mesh.pts.push_back(b);
+    mesh.pts.push_back(c);
+    mesh.tris.push_back(mesh::Mesh::triangle(firstPtId, firstPtId + 1, firstPtId + 2));
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(meshZBuffer_occlusion)
+{
+    const sfmData::SfMData sfmData = makeCamera();
+    const mvsUtils::MultiViewParams mp(sfmData);
+
+    // a wall at depth 10 in front of the whole image
+    mesh::Mesh mesh;
+    addTriangle(Point3d(-100.0, -100.0, 10.0), Point3d(100.0, -100.0, 10.0), Point3d(-100.0, 100.0, 10.0), mesh);
+    addTriangle(Point3d(100.0, -100.0, 10.0), Point3d(100.0, 100.0, 10.0), Point3d(-100.0, 100.0, 10.0), mesh);
+
+    const mesh::MeshZBuffer zBuffer(mesh, mp, 0);
+    BOOST_REQUIRE_EQUAL(zBuffer.getWidth(), 1000);
+    BOOST_CHECK_CLOSE(zBuffer.getDepth(500, 500), 10.0f, 1e-3);
+
+    BOOST_CHECK(zBuffer.isPointVisible(Point3d(0.5, 0.5, 5.0)));
+    BOOST_CHECK(zBuffer.isPointVisible(Point3d(0.5, 0.5, 10.0)));
+    BOOST_CHECK(!zBuffer.isPointVisible(Point3d(0.5, 0.5, 20.0)));
+    // behind the camera or outside the image
+    BOOST_CHECK(!zBuffer.isPointVisible(Point3d(0.5, 0.5, -5.0)));
+    BOOST_CHECK(!zBuffer.isPointVisible(Point3d(50.0, 0.5, 5.0)));
+
+    // the buffer is downscaled
+    const mesh::MeshZBuffer zBufferDownscaled(mesh, mp, 0, 2);
+    BOOST_CHECK_EQUAL(zBufferDownscaled.getWidth(), 500);
+    BOOST_CHECK(!zBufferDownscaled.isPointVisible(Point3d(0.5, 0.5, 20.0)));
+}
+
+BOOST_AUTO_TEST_CASE(meshZBuffer_nearPlaneClipping)
+{
+    const sfmData::SfMData sfmData = makeCamera();
+    const mvsUtils::MultiViewParams mp(sfmData);
+
+    // a floor 1m under the camera, from behind the camera to far in front of it
+    mesh::Mesh mesh;
+    addTriangle(Point3d(-100.0, 1.0, -10.0), Point3d(100.0, 1.0, -10.0), Point3d(0.0, 1.0, 100.0), mesh);
+
+    const mesh::MeshZBuffer zBuffer(mesh, mp, 0);
+
+    // the part of the triangle in front of the camera is rasterized:
+    // the ray of the pixel (500, 700) reaches the floor at depth 5
+    BOOST_CHECK_CLOSE(zBuffer.getDepth(500, 700), 5.0f, 1.0);
+    // the pixels above the horizon see no triangle
+    BOOST_CHECK_LT(zBuffer.getDepth(500, 400), 0.0f);
+
+    // a point on the floor is visible, a point under the floor is hidden by it
+    BOOST_CHECK(zBuffer.isPointVisible(Point3d(0.0, 1.0, 10.0)));
+    BOOST_CHECK(!zBuffer.isPointVisible(Point3d(0.0, 2.0, 10.0)));
+
+    // two vertices behind the camera
+    mesh::Mesh mesh2;
+    addTriangle(Point3d(-100.0, 1.0, -10.0), Point3d(0.0, 1.0, 100.0), Point3d(100.0, 1.0, -20.0), mesh2);
+    const mesh::MeshZBuffer zBuffer2(mesh2, mp, 0);
+    BOOST_CHECK(!zBuffer2.isPointVisible(Point3d(0.0, 2.0, 10.0)));
+
+    // a triangle fully behind the camera is ignored
+    mesh::Mesh mesh3;
+    addTriangle(Point3d(-100.0, 1.0, -10.0), Point3d(100.0, 1.0, -10.0), Point3d(0.0, 1.0, -100.0), mesh3);
+    const mesh::MeshZBuffer zBuffer3(mesh3, mp, 0);
+    BOOST_CHECK_LT(zBuffer3.getDepth(500, 700), 0.0f);
+    BOOST_CHECK(zBuffer3.isPointVisible(Point3d(0.0, 2.0, 10.0)));
+}
@@ -10,12 +10,18 @@
 
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/MemoryInfo.hpp>
+#include <aliceVision/system/MemoryTracker.hpp>
 #include <aliceVision/image/io.hpp>
 #include <aliceVision/image/pixelTypes.hpp>
 #include <aliceVision/numeric/numeric.hpp>
 #include <aliceVision/mvsData/geometry.hpp>
 #include <aliceVision/mvsData/Pixel.hpp>
 #include <aliceVision/image/imageAlgo.hpp>
+#include <aliceVision/config.hpp>
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+#include <aliceVision/mesh/cuda/DeviceTexturing.hpp>
+#endif
 
 #include <geogram/basic/common.h>
 #include <geogram/basic/geometry_nd.h>
@@ -37,7 +43,10 @@
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
+#include <algorithm>
+#include <iterator>
 #include <map>
+#include <memory>
 #include <set>
 
 // Debug mode: save atlases decomposition in frequency bands and
@@ -287,6 +296,8 @@ void Texturing::generateTextures(const mvsUtils::MultiViewParams& mp,
                                  const boost::filesystem::path& outPath,
                                  image::EImageFileType textureFileType)
 {
+    ALICEVISION_MEMORY_STAGE("texturing");
+
     // Ensure that contribution levels do not contain 0 and are sorted (as each frequency band contributes to lower bands).
     auto& m = texParams.multiBandNbContrib;
     m.erase(std::remove(std::begin(m), std::end(m), 0), std::end(m));
@@ -316,12 +327,30 @@ void Texturing::generateTextures(const mvsUtils::MultiViewParams& mp,
     const std::size_t imageMaxMemSize =
             mp.getMaxImageWidth() * mp.getMaxImageHeight() * sizeof(image::RGBfColor) / std::pow(2,20); //MB
     const std::size_t imagePyramidMaxMemSize = texParams.nbBand * imageMaxMemSize;
+    // an atlas texture to fill and write
     const std::size_t atlasContribMemSize =
             texParams.textureSide * texParams.textureSide * (sizeof(image::RGBfColor)+sizeof(float)) / std::pow(2,20); //MB
-    const std::size_t atlasPyramidMaxMemSize = texParams.nbBand * atlasContribMemSize;
+    // the accumulation pyramid of an atlas: only the tiles covered by its charts, in half-float
+    std::size_t atlasMaxNbTiles = 1;
+    for(std::size_t atlasID = 0; atlasID < _atlases.size(); ++atlasID)
+    {
+        const std::vector<bool> tilesMask = getAtlasTilesMask(atlasID);
+        atlasMaxNbTiles = std::max(atlasMaxNbTiles, std::size_t(std::count(tilesMask.begin(), tilesMask.end(), true)));
+    }
+    const std::size_t accuTileMemSize = AccuImage::tileSide * AccuImage::tileSide * (3 * sizeof(half) + sizeof(float));
+    const std::size_t atlasPyramidMaxMemSize =
+            std::ceil(texParams.nbBand * atlasMaxNbTiles * accuTileMemSize / std::pow(2,20)); //MB
 
-    const int availableRam = int(memInfo.availableRam / std::pow(2,20));
-    const int availableMem = availableRam - 2 * (imagePyramidMaxMemSize + imageMaxMemSize); // keep some memory for the 2 input images in cache and one laplacian pyramid
+    int availableRam = int(memInfo.availableRam / std::pow(2,20));
+    if(texParams.maxMemory > 0 && texParams.maxMemory < availableRam)
+    {
+        ALICEVISION_LOG_INFO("Texturing memory limited to " << texParams.maxMemory << " MB (" << availableRam << " MB available).");
+        availableRam = texParams.maxMemory;
+    }
+    // the atlases written in the background: one per writing thread and as many waiting in the queue
+    const int nbWrittenAtlases = 2 * std::max(texParams.nbWriteThreads, 0);
+    const int availableMem = availableRam - 2 * (imagePyramidMaxMemSize + imageMaxMemSize) // keep some memory for the 2 input images in cache and one laplacian pyramid
+                             - (nbWrittenAtlases + 1) * atlasContribMemSize; // and the atlas textures being filled and written
 
     const int nbAtlas = _atlases.size();
     // Memory needed to process each attlas = input + input pyramid + output atlas pyramid
@@ -346,43 +375,284 @@ void Texturing::generateTextures(const mvsUtils::MultiViewParams& mp,
         nbAtlasMax -= 1;
     nbAtlasMax = std::max(1, nbAtlasMax); //if not enough memory, do it one by one
 
+    cuda::DeviceTexturing* deviceTexturing = nullptr;
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+    std::unique_ptr<cuda::DeviceTexturing> deviceTexturingPtr;
+    if(texParams.useGpu)
+    {
+        deviceTexturingPtr.reset(new cuda::DeviceTexturing(texParams.nbBand, texParams.textureSide,
+                                                           texParams.multiBandDownscale, texParams.maxNbCachedCameras));
+        deviceTexturing = deviceTexturingPtr.get();
+
+        // the accumulation buffers of all the atlases of a chunk are in device memory,
+        // keep some device memory for the cached cameras (image + laplacian pyramid)
+        const std::size_t deviceAvailableMem = cuda::DeviceTexturing::getAvailableMemory();
+        const std::size_t deviceCamerasMem = texParams.maxNbCachedCameras * (imageMaxMemSize + imagePyramidMaxMemSize);
+        const std::size_t deviceAtlasMem = std::max(std::size_t(1), deviceTexturing->getAtlasMemorySize());
+        const int nbAtlasMaxDevice = (deviceAvailableMem > deviceCamerasMem) ? int((deviceAvailableMem - deviceCamerasMem) / deviceAtlasMem) : 0;
+
+        if(nbAtlasMaxDevice < 1)
+        {
+            ALICEVISION_THROW_ERROR("Not enough GPU memory for texturing: " << deviceAvailableMem << " MB available, "
+                                    << deviceAtlasMem << " MB needed per atlas and " << deviceCamerasMem << " MB for the cached cameras.");
+        }
+        ALICEVISION_LOG_INFO("Total amount of available GPU memory: " << deviceAvailableMem << " MB.");
+        nbAtlasMax = std::min(nbAtlasMax, nbAtlasMaxDevice);
+    }
+#else
+    if(texParams.useGpu)
+        ALICEVISION_LOG_WARNING("AliceVision is built without CUDA, texturing on the CPU.");
+#endif
+
     ALICEVISION_LOG_INFO("Total amount of available RAM: " << availableRam << " MB.");
     ALICEVISION_LOG_INFO("Total amount of memory remaining for the computation: " << availableMem << " MB.");
     ALICEVISION_LOG_INFO("Total amount of an image in memory: " << imageMaxMemSize << " MB.");
     ALICEVISION_LOG_INFO("Total amount of an atlas pyramid in memory: " << atlasPyramidMaxMemSize << " MB.");
     ALICEVISION_LOG_INFO("Processing " << nbAtlas << " atlases by chunks of " << nbAtlasMax);
 
-    //generateTexture for the maximum number of atlases, and iterate
-    const std::div_t divresult = div(nbAtlas, nbAtlasMax);
-    std::vector<size_t> atlasIDs;
-    atlasIDs.reserve(nbAtlasMax);
-    for(int n = 0; n <= divresult.quot; ++n)
+    // group the atlases seen by the same cameras, to load each image as few times as possible
+    const std::vector<std::vector<int>> atlasesCameras = getAtlasesCameras(mp.ncams);
+    const std::vector<std::vector<size_t>> atlasesBatches = getAtlasesBatches(atlasesCameras, nbAtlasMax);
+
+    // fill and write the textures while the next atlases are computed
+    std::unique_ptr<image::AsyncImageWriter> imageWriter;
+    if(texParams.nbWriteThreads > 0)
+        imageWriter.reset(new image::AsyncImageWriter(texParams.nbWriteThreads, texParams.nbWriteThreads));
+
+    //generateTexture for each batch of atlases
+    for(std::size_t n = 0; n < atlasesBatches.size(); ++n)
+    {
+        const std::vector<size_t>& atlasIDs = atlasesBatches[n];
+
+        std::set<int> batchCameras;
+        for(const size_t atlasID : atlasIDs)
+            batchCameras.insert(atlasesCameras[atlasID].begin(), atlasesCameras[atlasID].end());
+
+        const std::size_t batchMemSize = atlasIDs.size() * atlasPyramidMaxMemSize + 2 * (imagePyramidMaxMemSize + imageMaxMemSize);
+        const int nbLoadedImages = imageCache.getNbLoadedImages();
+        const int nbReusedImages = imageCache.getNbReusedImages();
+
+        ALICEVISION_LOG_INFO("Generating texture for the batch " << n + 1 << "/" << atlasesBatches.size() << ": "
+                             << atlasIDs.size() << " atlases seen by " << batchCameras.size() << " cameras, "
+                             << "estimated memory: " << batchMemSize << " MB.");
+        generateTexturesSubSet(mp, atlasIDs, imageCache, outPath, textureFileType, deviceTexturing, imageWriter.get());
+
+        ALICEVISION_LOG_INFO("Batch " << n + 1 << "/" << atlasesBatches.size() << ": "
+                             << imageCache.getNbLoadedImages() - nbLoadedImages << " images loaded, "
+                             << imageCache.getNbReusedImages() - nbReusedImages << " images reused from the cache.");
+    }
+    if(imageWriter)
     {
-        atlasIDs.clear();
-        int imax = (n < divresult.quot ? nbAtlasMax : divresult.rem);
-        if(!imax)
+        ALICEVISION_LOG_INFO("Waiting for the textures to be written.");
+        imageWriter->wait();
+    }
+    ALICEVISION_LOG_INFO("Texturing: " << imageCache.getNbLoadedImages() << " images loaded, "
+                         << imageCache.getNbReusedImages() << " images reused from the cache.");
+}
+
+constexpr int Texturing::AccuImage::tileSide;
+
+void Texturing::AccuImage::init(int imgWidth, int imgHeight, const std::vector<bool>& tilesMask)
+{
+    width = imgWidth;
+    height = imgHeight;
+    nbTilesX = divideRoundUp(width, tileSide);
+    const int nbTiles = nbTilesX * divideRoundUp(height, tileSide);
+    if(tilesMask.size() != std::size_t(nbTiles))
+        throw std::runtime_error("Invalid accumulation tiles mask.");
+
+    tiles.clear();
+    tiles.resize(nbTiles);
+    for(int t = 0; t < nbTiles; ++t)
+    {
+        if(!tilesMask[t])
             continue;
-        for(int i = 0; i < imax; ++i)
+        tiles[t].colors.assign(3 * tileSide * tileSide, half(0.f));
+        tiles[t].weights.assign(tileSide * tileSide, 0.f);
+    }
+}
+
+void Texturing::AccuImage::set(int x, int y, const image::RGBfColor& color, float weight)
+{
+    Tile& tile = tiles[(y / tileSide) * nbTilesX + x / tileSide];
+    if(tile.weights.empty())
+        return;
+    const int i = (y % tileSide) * tileSide + x % tileSide;
+    for(int c = 0; c < 3; ++c)
+        tile.colors[3 * i + c] = color(c);
+    tile.weights[i] = weight;
+}
+
+float Texturing::AccuImage::get(int x, int y, image::RGBfColor& color) const
+{
+    const Tile& tile = tiles[(y / tileSide) * nbTilesX + x / tileSide];
+    if(tile.weights.empty())
+    {
+        color = image::RGBfColor(0.f, 0.f, 0.f);
+        return 0.f;
+    }
+    const int i = (y % tileSide) * tileSide + x % tileSide;
+    color = image::RGBfColor(tile.colors[3 * i], tile.colors[3 * i + 1], tile.colors[3 * i + 2]);
+    return tile.weights[i];
+}
+
+std::size_t Texturing::AccuImage::getMemorySize() const
+{
+    std::size_t size = tiles.size() * sizeof(Tile);
+    for(const Tile& tile : tiles)
+        size += tile.colors.size() * sizeof(half) + tile.weights.size() * sizeof(float);
+    return size;
+}
+
+std::vector<bool> Texturing::getAtlasTilesMask(std::size_t atlasID) const
+{
+    const int texSide = static_cast<int>(texParams.textureSide);
+    const int nbTilesSide = divideRoundUp(texSide, AccuImage::tileSide);
+    std::vector<bool> tilesMask(nbTilesSide * nbTilesSide, false);
+
+    const StaticVector<Point2d>& uvCoords = mesh->uvCoords;
+    for(const int triangleID : _atlases[atlasID])
+    {
+        const auto& triangleUvIds = mesh->trisUvIds[triangleID];
+        const Point2d& uv0 = uvCoords[triangleUvIds.m[0]];
+        const Point2d& uv1 = uvCoords[triangleUvIds.m[1]];
+        const Point2d& uv2 = uvCoords[triangleUvIds.m[2]];
+
+        // same bounding box as the rasterization, in the UDIM [0,1] range
+        const double minX = std::min({uv0.x, uv1.x, uv2.x});
+        const double minY = std::min({uv0.y, uv1.y, uv2.y});
+        const double udimBLx = std::floor(minX);
+        const double udimBLy = std::floor(minY);
+        const int LUx = clamp(static_cast<int>(std::floor((minX - udimBLx) * texSide)), 0, texSide);
+        const int LUy = clamp(static_cast<int>(std::floor((minY - udimBLy) * texSide)), 0, texSide);
+        const int RDx = clamp(static_cast<int>(std::ceil((std::max({uv0.x, uv1.x, uv2.x}) - udimBLx) * texSide)), 0, texSide);
+        const int RDy = clamp(static_cast<int>(std::ceil((std::max({uv0.y, uv1.y, uv2.y}) - udimBLy) * texSide)), 0, texSide);
+        if(LUx >= RDx || LUy >= RDy)
+            continue;
+
+        // the texel rows are flipped (inverted Y axis)
+        const int firstRow = texSide - RDy;
+        const int lastRow = texSide - 1 - LUy;
+        for(int ty = firstRow / AccuImage::tileSide; ty <= lastRow / AccuImage::tileSide; ++ty)
+            for(int tx = LUx / AccuImage::tileSide; tx <= (RDx - 1) / AccuImage::tileSide; ++tx)
+                tilesMask[ty * nbTilesSide + tx] = true;
+    }
+    return tilesMask;
+}
+
+std::vector<std::vector<int>> Texturing::getAtlasesCameras(int nbCameras) const
+{
+    std::vector<std::vector<int>> atlasesCameras(_atlases.size());
+
+    #pragma omp parallel for
+    for(int atlasID = 0; atlasID < _atlases.size(); ++atlasID)
+    {
+        std::vector<bool> isAtlasCamera(nbCameras, false);
+        for(const int triangleID : _atlases[atlasID])
+        {
+            for(int k = 0; k < 3; ++k)
+            {
+                for(const int camId : mesh->pointsVisibilities[mesh->tris[triangleID].v[k]])
+                    isAtlasCamera[camId] = true;
+            }
+        }
+        for(int camId = 0; camId < nbCameras; ++camId)
+        {
+            if(isAtlasCamera[camId])
+                atlasesCameras[atlasID].push_back(camId);
+        }
+    }
+    return atlasesCameras;
+}
+
+std::vector<std::vector<size_t>> Texturing::getAtlasesBatches(const std::vector<std::vector<int>>& atlasesCameras, int nbAtlasMax)
+{
+    const std::size_t nbAtlas = atlasesCameras.size();
+    const std::size_t batchSizeMax = std::size_t(std::max(1, nbAtlasMax));
+
+    const auto getNbSharedCameras = [](const std::vector<int>& a, const std::vector<int>& b) {
+        std::size_t nbShared = 0;
+        for(auto itA = a.begin(), itB = b.begin(); itA != a.end() && itB != b.end();)
+        {
+            if(*itA < *itB)
+                ++itA;
+            else if(*itB < *itA)
+                ++itB;
+            else
+            {
+                ++nbShared;
+                ++itA;
+                ++itB;
+            }
+        }
+        return nbShared;
+    };
+
+    std::vector<std::vector<size_t>> batches;
+    std::vector<bool> isAssigned(nbAtlas, false);
+    std::vector<int> previousBatchCameras;
+    std::size_t nbAssigned = 0;
+
+    while(nbAssigned < nbAtlas)
+    {
+        std::vector<size_t> batch;
+        std::vector<int> batchCameras;
+
+        while(batch.size() < batchSizeMax && nbAssigned < nbAtlas)
         {
-            size_t atlasID = size_t(n*nbAtlasMax + i);
-            atlasIDs.push_back(atlasID);
+            // the first atlas of a batch shares the most cameras with the previous batch (still in the caches),
+            // then add the atlases adding the fewest new cameras to the batch
+            std::size_t bestAtlas = nbAtlas;
+            std::size_t bestNbShared = 0;
+            std::size_t bestNbNew = 0;
+            for(std::size_t atlasID = 0; atlasID < nbAtlas; ++atlasID)
+            {
+                if(isAssigned[atlasID])
+                    continue;
+
+                const std::vector<int>& cameras = atlasesCameras[atlasID];
+                const std::size_t nbShared = getNbSharedCameras(cameras, batch.empty() ? previousBatchCameras : batchCameras);
+                const std::size_t nbNew = cameras.size() - nbShared;
+
+                const bool isBetter = batch.empty() ? (nbShared > bestNbShared)
+                                                    : (nbNew < bestNbNew || (nbNew == bestNbNew && nbShared > bestNbShared));
+                if(bestAtlas == nbAtlas || isBetter)
+                {
+                    bestAtlas = atlasID;
+                    bestNbShared = nbShared;
+                    bestNbNew = nbNew;
+                }
+            }
+
+            std::vector<int> mergedCameras;
+            std::set_union(batchCameras.begin(), batchCameras.end(),
+                           atlasesCameras[bestAtlas].begin(), atlasesCameras[bestAtlas].end(), std::back_inserter(mergedCameras));
+            batchCameras.swap(mergedCameras);
+
+            batch.push_back(bestAtlas);
+            isAssigned[bestAtlas] = true;
+            ++nbAssigned;
         }
-        ALICEVISION_LOG_INFO("Generating texture for atlases " << n*nbAtlasMax + 1 << " to " << n*nbAtlasMax+imax );
-        generateTexturesSubSet(mp, atlasIDs, imageCache, outPath, textureFileType);
+
+        // keep the atlases order in the batch, for the logs and the output files
+        std::sort(batch.begin(), batch.end());
+        batches.push_back(std::move(batch));
+        previousBatchCameras.swap(batchCameras);
     }
+    return batches;
 }
 
 void Texturing::generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
                                        const std::vector<size_t>& atlasIDs,
                                        mvsUtils::ImagesCache<image::Image<image::RGBfColor>>& imageCache,
                                        const bfs::path& outPath,
-                                       image::EImageFileType textureFileType)
+                                       image::EImageFileType textureFileType,
+                                       cuda::DeviceTexturing* deviceTexturing,
+                                       image::AsyncImageWriter* imageWriter)
 {
     if(atlasIDs.size() > _atlases.size())
         throw std::runtime_error("Invalid atlas IDs ");
 
-    unsigned int textureSize = texParams.textureSide * texParams.textureSide;
-
     // We select the best cameras for each triangle and store it per camera for each output texture files.
     // Triangles contributions are stored per frequency bands for multi-band blending.
     using AtlasIndex = size_t;
@@ -521,18 +791,150 @@ void Texturing::generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
     //pyramid of atlases frequency bands
     std::map<AtlasIndex, AccuPyramid> accuPyramids;
     for(std::size_t atlasID: atlasIDs)
-        accuPyramids[atlasID].init(texParams.nbBand, texParams.textureSide, texParams.textureSide);
+        accuPyramids[atlasID].init(texParams.nbBand, texParams.textureSide, texParams.textureSide, getAtlasTilesMask(atlasID));
+    {
+        std::size_t accuMemSize = 0;
+        for(const auto& accuPyramid : accuPyramids)
+            for(const AccuImage& accuImage : accuPyramid.second.pyramid)
+                accuMemSize += accuImage.getMemorySize();
+        ALICEVISION_LOG_INFO("Accumulation buffers: " << accuMemSize / std::pow(2,20) << " MB.");
+    }
 
-    //for each camera, for each texture, iterate over triangles and fill the accuPyramids map
-    for(int camId = 0; camId < contributionsPerCamera.size(); ++camId)
+    // process first the cameras already in memory, so they are reused before being released from the caches
+    std::vector<int> camerasOrder;
     {
-        const std::map<AtlasIndex, std::vector<ScorePerTriangle>>& cameraContributions = contributionsPerCamera[camId];
+        std::vector<bool> isOrdered(contributionsPerCamera.size(), false);
+        const auto addCamera = [&](int camId) {
+            if(isOrdered[camId] || contributionsPerCamera[camId].empty())
+                return;
+            camerasOrder.push_back(camId);
+            isOrdered[camId] = true;
+        };
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+        if(deviceTexturing != nullptr)
+        {
+            for(const int camId : deviceTexturing->getCachedCameras())
+                addCamera(camId);
+        }
+#endif
+        for(int camId = 0; camId < contributionsPerCamera.size(); ++camId)
+        {
+            if(imageCache.isImageInCache(camId))
+                addCamera(camId);
+        }
+        for(int camId = 0; camId < contributionsPerCamera.size(); ++camId)
+            addCamera(camId);
+    }
+    ALICEVISION_LOG_INFO(camerasOrder.size() << " cameras contribute to the texture files, " << mp.ncams - camerasOrder.size() << " cameras unused.");
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+    if(deviceTexturing != nullptr)
+    {
+        deviceTexturing->initAtlases(atlasIDs.size());
 
-        if(cameraContributions.empty())
+        std::map<AtlasIndex, int> atlasIndexes; // atlasID to the atlas index in the subset
+        for(std::size_t i = 0; i < atlasIDs.size(); ++i)
+            atlasIndexes[atlasIDs[i]] = int(i);
+
+        std::vector<cuda::DeviceTexturingTriangle> triangles;
+        for(const int camId : camerasOrder)
         {
-            ALICEVISION_LOG_INFO("- camera " << mp.getViewId(camId) << " (" << camId + 1 << "/" << mp.ncams << ") unused.");
-            continue;
+            const std::map<AtlasIndex, std::vector<ScorePerTriangle>>& cameraContributions = contributionsPerCamera[camId];
+            ALICEVISION_LOG_INFO("- camera " << mp.getViewId(camId) << " (" << camId + 1 << "/" << mp.ncams << ") with contributions to " << cameraContributions.size() << " texture files.");
+
+            if(!deviceTexturing->selectCamera(camId))
+            {
+                // Load camera image from cache and calculate laplacianPyramid
+                auto imgPtr = imageCache.getImg_sync(camId);
+                const image::Image<image::RGBfColor>& camImg = *imgPtr;
+                std::vector<image::Image<image::RGBfColor>> pyramidL;
+                imageAlgo::laplacianPyramid(pyramidL, camImg, texParams.nbBand, texParams.multiBandDownscale);
+
+                const auto toDeviceImage = [](const image::Image<image::RGBfColor>& img) {
+                    cuda::DeviceTexturingImage deviceImage;
+                    deviceImage.data = reinterpret_cast<const float*>(img.data());
+                    deviceImage.width = img.Width();
+                    deviceImage.height = img.Height();
+                    return deviceImage;
+                };
+                std::vector<cuda::DeviceTexturingImage> devicePyramid;
+                for(const auto& level : pyramidL)
+                    devicePyramid.push_back(toDeviceImage(level));
+
+                deviceTexturing->addCamera(camId, toDeviceImage(camImg), devicePyramid, mp.camArr[camId].m, mp.g_border);
+            }
+
+            // all the contributions of the camera to all the atlases of the subset
+            triangles.clear();
+            for(const auto& c : cameraContributions)
+            {
+                const int atlasIndex = atlasIndexes.at(c.first);
+                for(int band = 0; band < c.second.size(); ++band)
+                {
+                    for(const auto& triangleScore : c.second[band])
+                    {
+                        const unsigned int triangleId = triangleScore.first;
+                        const auto& triangleUvIds = mesh->trisUvIds[triangleId];
+                        const StaticVector<Point2d>& uvCoords = mesh->uvCoords;
+
+                        // compute the Bottom-Left minima of the current UDIM for [0,1] range remapping
+                        const double udimBLx = std::floor(std::min({uvCoords[triangleUvIds.m[0]].x, uvCoords[triangleUvIds.m[1]].x, uvCoords[triangleUvIds.m[2]].x}));
+                        const double udimBLy = std::floor(std::min({uvCoords[triangleUvIds.m[0]].y, uvCoords[triangleUvIds.m[1]].y, uvCoords[triangleUvIds.m[2]].y}));
+
+                        cuda::DeviceTexturingTriangle triangle;
+                        for(int k = 0; k < 3; ++k)
+                        {
+                            const Point3d& pt = mesh->pts[mesh->tris[triangleId].v[k]];
+                            const Point2d& uv = uvCoords[triangleUvIds.m[k]];
+                            triangle.uv[k][0] = float((uv.x - udimBLx) * texParams.textureSide);
+                            triangle.uv[k][1] = float((uv.y - udimBLy) * texParams.textureSide);
+                            triangle.pts[k][0] = pt.x;
+                            triangle.pts[k][1] = pt.y;
+                            triangle.pts[k][2] = pt.z;
+                        }
+                        triangle.score = texParams.useScore ? triangleScore.second : 1.0f;
+                        triangle.atlasIndex = atlasIndex;
+                        triangle.band = band;
+                        triangles.push_back(triangle);
+                    }
+                }
+            }
+            ALICEVISION_LOG_INFO("  - " << triangles.size() << " triangles contributions.");
+            deviceTexturing->accumulate(triangles);
+        }
+
+        // the device accumulates the weighted sums, download them in a dense buffer and store their means
+        AtlasTexture downloadBuffer;
+        downloadBuffer.resize(texParams.textureSide, texParams.textureSide);
+        for(const auto& atlasIndex : atlasIndexes)
+        {
+            AccuPyramid& accuPyramid = accuPyramids.at(atlasIndex.first);
+            for(int band = 0; band < texParams.nbBand; ++band)
+            {
+                AccuImage& accuImage = accuPyramid.pyramid[band];
+                deviceTexturing->download(atlasIndex.second, band, reinterpret_cast<float*>(downloadBuffer.img.data()), downloadBuffer.imgCount.data());
+
+                #pragma omp parallel for
+                for(int y = 0; y < int(texParams.textureSide); ++y)
+                {
+                    for(int x = 0; x < int(texParams.textureSide); ++x)
+                    {
+                        const unsigned int xyoffset = y * texParams.textureSide + x;
+                        const float weight = downloadBuffer.imgCount[xyoffset];
+                        if(weight > 0.f)
+                            accuImage.set(x, y, downloadBuffer.img(xyoffset) / weight, weight);
+                    }
+                }
+            }
         }
+    }
+    else
+#endif
+    //for each camera, for each texture, iterate over triangles and fill the accuPyramids map
+    for(const int camId : camerasOrder)
+    {
+        const std::map<AtlasIndex, std::vector<ScorePerTriangle>>& cameraContributions = contributionsPerCamera[camId];
+
         ALICEVISION_LOG_INFO("- camera " << mp.getViewId(camId) << " (" << camId + 1 << "/" << mp.ncams << ") with contributions to " << cameraContributions.size() << " texture files:");
 
         // Load camera image from cache
@@ -619,8 +1021,6 @@ void Texturing::generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
 
                            // remap 'y' to image coordinates system (inverted Y axis)
                            const unsigned int y_ = (texParams.textureSide - 1) - y;
-                           // 1D pixel index
-                           unsigned int xyoffset = y_ * texParams.textureSide + x;
                            // get 3D coordinates
                            Point3d pt3d = barycentricToCartesian(triPts, barycCoords);
                            // get 2D coordinates in source image
@@ -644,8 +1044,7 @@ void Texturing::generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
 
                                // fill the accumulated color map for this pixel
                                const auto pixDownscaled = pixRC / downscaleCoef;
-                               accuImage.img(xyoffset) += getInterpolateColor(pyramidL[bandContrib], pixDownscaled.y, pixDownscaled.x) * triangleScore;
-                               accuImage.imgCount[xyoffset] += triangleScore;
+                               accuImage.add(x, y_, getInterpolateColor(pyramidL[bandContrib], pixDownscaled.y, pixDownscaled.x), triangleScore);
                            }
                        }
                     }
@@ -654,36 +1053,32 @@ void Texturing::generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
         }
     }
 
-    //calculate atlas texture in the first level of the pyramid (avoid creating a new buffer)
+    //fuse the frequency bands of each atlas pyramid into its texture
     //debug mode : write all the frequencies levels for each texture
     for(std::size_t atlasID : atlasIDs)
     {
         AccuPyramid& accuPyramid = accuPyramids.at(atlasID);
-        AccuImage& atlasTexture = accuPyramid.pyramid[0];
         ALICEVISION_LOG_INFO("Create texture " << atlasID + 1);
 
 #if TEXTURING_MBB_DEBUG
         {
-            // write the number of contribution per atlas frequency bands
-            if(!texParams.useScore)
+            //write each frequency band and its number of contributions, for each texture
+            for(std::size_t level = 0; level < accuPyramid.pyramid.size(); ++level)
             {
-                for(std::size_t level = 0; level < accuPyramid.pyramid.size(); ++level)
+                const AccuImage& accuImage = accuPyramid.pyramid[level];
+                AtlasTexture atlasLevelTexture;
+                atlasLevelTexture.resize(texParams.textureSide, texParams.textureSide);
+                for(unsigned int yp = 0; yp < texParams.textureSide; ++yp)
                 {
-                    AccuImage& atlasLevelTexture =  accuPyramid.pyramid[level];
-
-                    //write the number of contributions for each texture
-                    std::vector<float> imgContrib(textureSize);
-
-                    for(unsigned int yp = 0; yp < texParams.textureSide; ++yp)
+                    for(unsigned int xp = 0; xp < texParams.textureSide; ++xp)
                     {
-                        unsigned int yoffset = yp * texParams.textureSide;
-                        for(unsigned int xp = 0; xp < texParams.textureSide; ++xp)
-                        {
-                            unsigned int xyoffset = yoffset + xp;
-                            imgContrib[xyoffset] = atlasLevelTexture.imgCount[xyoffset];
-                        }
+                        const unsigned int xyoffset = yp * texParams.textureSide + xp;
+                        atlasLevelTexture.imgCount[xyoffset] = accuImage.get(xp, yp, atlasLevelTexture.img(xyoffset));
                     }
+                }
 
+                if(!texParams.useScore)
+                {
                     const std::string textureName = "contrib_" + std::to_string(1001 + atlasID) + std::string("_") + std::to_string(level) + std::string(".") + EImageFileType_enumToString(textureFileType); // starts at '1001' for UDIM compatibility
                     bfs::path texturePath = outPath / textureName;
 
@@ -691,62 +1086,56 @@ void Texturing::generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
                     OutputFileColorSpace colorspace(EImageColorSpace::SRGB, EImageColorSpace::AUTO);
                     if(texParams.convertLAB)
                         colorspace.from = EImageColorSpace::LAB;
-                    writeImage(texturePath.string(), texParams.textureSide, texParams.textureSide, imgContrib, EImageQuality::OPTIMIZED, colorspace);
+                    writeImage(texturePath.string(), texParams.textureSide, texParams.textureSide, atlasLevelTexture.imgCount, EImageQuality::OPTIMIZED, colorspace);
                 }
+                writeTexture(atlasLevelTexture, atlasID, outPath, textureFileType, level);
             }
         }
 #endif
 
-        ALICEVISION_LOG_INFO("  - Computing final (average) color.");
-        for(unsigned int yp = 0; yp < texParams.textureSide; ++yp)
+        ALICEVISION_LOG_INFO("  - Computing final color.");
+        // the accumulation buffers store the mean color of each band, the texture is their sum
+        std::shared_ptr<AtlasTexture> atlasTexture = std::make_shared<AtlasTexture>();
+        atlasTexture->resize(texParams.textureSide, texParams.textureSide);
+
+        #pragma omp parallel for
+        for(int yp = 0; yp < int(texParams.textureSide); ++yp)
         {
-            unsigned int yoffset = yp * texParams.textureSide;
-            for(unsigned int xp = 0; xp < texParams.textureSide; ++xp)
+            for(int xp = 0; xp < int(texParams.textureSide); ++xp)
             {
-                unsigned int xyoffset = yoffset + xp;
+                const unsigned int xyoffset = yp * texParams.textureSide + xp;
+                image::RGBfColor& color = atlasTexture->img(xyoffset);
 
-                // If the imgCount is valid on the first band, it will be valid on all the other bands
-                if(atlasTexture.imgCount[xyoffset] == 0)
+                // If the weight is valid on the first band, it will be valid on all the other bands
+                if(accuPyramid.pyramid[0].get(xp, yp, color) <= 0.f)
+                {
+                    color = image::RGBfColor(0.f, 0.f, 0.f);
                     continue;
-
-                atlasTexture.img(xyoffset) /= atlasTexture.imgCount[xyoffset];
-                atlasTexture.imgCount[xyoffset] = 1;
+                }
+                atlasTexture->imgCount[xyoffset] = 1;
 
                 for(std::size_t level = 1; level < accuPyramid.pyramid.size(); ++level)
                 {
-                    AccuImage& atlasLevelTexture =  accuPyramid.pyramid[level];
-                    atlasLevelTexture.img(xyoffset) /= atlasLevelTexture.imgCount[xyoffset];
+                    image::RGBfColor levelColor;
+                    accuPyramid.pyramid[level].get(xp, yp, levelColor);
+                    color += levelColor;
                 }
             }
         }
+        // the accumulation buffers are released before the texture is filled and written
+        accuPyramids.erase(atlasID);
 
-#if TEXTURING_MBB_DEBUG
+        if(imageWriter)
         {
-            //write each frequency band, for each texture
-            for(std::size_t level = 0; level < accuPyramid.pyramid.size(); ++level)
-            {
-                AccuImage& atlasLevelTexture =  accuPyramid.pyramid[level];
-                writeTexture(atlasLevelTexture, atlasID, outPath, textureFileType, level);
-            }
-
+            // fill and write the texture in the background
+            imageWriter->process([this, atlasTexture, atlasID, outPath, textureFileType]() {
+                writeTexture(*atlasTexture, atlasID, outPath, textureFileType, -1);
+            });
         }
-#endif
-
-        // Fuse frequency bands into the first buffer, calculate final texture
-        for(unsigned int yp = 0; yp < texParams.textureSide; ++yp)
+        else
         {
-            unsigned int yoffset = yp * texParams.textureSide;
-            for(unsigned int xp = 0; xp < texParams.textureSide; ++xp)
-            {
-                unsigned int xyoffset = yoffset + xp;
-                for(std::size_t level = 1; level < accuPyramid.pyramid.size(); ++level)
-                {
-                    AccuImage& atlasLevelTexture =  accuPyramid.pyramid[level];
-                    atlasTexture.img(xyoffset) += atlasLevelTexture.img(xyoffset);
-                }
-            }
+            writeTexture(*atlasTexture, atlasID, outPath, textureFileType, -1);
         }
-        writeTexture(atlasTexture, atlasID, outPath, textureFileType, -1);
     }
 }
 
@@ -770,8 +1159,8 @@ void Texturing::generateNormalAndHeightMaps(const mvsUtils::MultiViewParams& mp,
 
 
 
-void Texturing::writeTexture(AccuImage& atlasTexture, const std::size_t atlasID, const boost::filesystem::path &outPath,
-                             image::EImageFileType textureFileType, const int level)
+void Texturing::writeTexture(AtlasTexture& atlasTexture, const std::size_t atlasID, const boost::filesystem::path &outPath,
+                             image::EImageFileType textureFileType, const int level) const
 {
     unsigned int outTextureSide = texParams.textureSide;
     // WARNING: we modify the "imgCount" to apply the padding (to avoid the creation of a new buffer)
@@ -6,8 +6,9 @@
 
 #pragma once
 
+#include <aliceVision/half.hpp>
 #include <aliceVision/image/io.hpp>
-#include <aliceVision/image/io.hpp>
+#include <aliceVision/image/AsyncImageWriter.hpp>
 #include <aliceVision/mvsData/Point2d.hpp>
 #include <aliceVision/mvsData/Point3d.hpp>
 #include <aliceVision/mvsData/StaticVector.hpp>
@@ -29,6 +30,10 @@ namespace GEO {
 namespace aliceVision {
 namespace mesh {
 
+namespace cuda {
+    class DeviceTexturing;
+}
+
 /**
  * @brief Available mesh unwrapping methods
  */
@@ -97,6 +102,13 @@ struct TexturingParams
     EVisibilityRemappingMethod visibilityRemappingMethod = EVisibilityRemappingMethod::PullPush;
 
     float subdivisionTargetRatio = 0.8;
+
+    int maxMemory = 0; //< RAM ceiling (MB) for the atlases batches, 0 to use all the available RAM
+
+    bool useGpu = false; //< rasterize and project the texture atlases on the GPU
+    int maxNbCachedCameras = 8; //< number of camera images (and laplacian pyramids) kept in GPU memory
+
+    int nbWriteThreads = 2; //< number of texture atlases post-processed and written in parallel with the texturing, 0 to write them in the texturing thread
 };
 
 struct Texturing
@@ -166,8 +178,8 @@ public:
      */
     void updateAtlases();
 
-    // Create buffer for the set of output textures
-    struct AccuImage
+    /// Texture of an atlas and the weight of each texel (0 outside the charts)
+    struct AtlasTexture
     {
         image::Image<image::RGBfColor> img;
         std::vector<float> imgCount;
@@ -178,29 +190,106 @@ public:
             imgCount.resize(width * height);
         }
     };
+
+    /**
+     * @brief Accumulation buffer of a frequency band of a texture atlas
+     *
+     * Each texel stores the weighted mean of its contributions in half-float and the sum of their weights,
+     * the mean color stays in the range of the input colors so the half precision is enough.
+     * The texels are stored by tiles, only the tiles covered by the charts of the atlas are allocated.
+     */
+    struct AccuImage
+    {
+        static constexpr int tileSide = 64;
+
+        struct Tile
+        {
+            std::vector<half> colors; //< RGB mean color of each texel
+            std::vector<float> weights;
+        };
+
+        int width = 0;
+        int height = 0;
+        int nbTilesX = 0;
+        std::vector<Tile> tiles;
+
+        /// Initialize the buffer, only the tiles of tilesMask are allocated
+        void init(int imgWidth, int imgHeight, const std::vector<bool>& tilesMask);
+
+        /// Add a contribution to a texel of an allocated tile (not thread-safe for the same texel)
+        void add(int x, int y, const image::RGBfColor& color, float weight)
+        {
+            Tile& tile = tiles[(y / tileSide) * nbTilesX + x / tileSide];
+            const int i = (y % tileSide) * tileSide + x % tileSide;
+            const float sumWeights = tile.weights[i] + weight;
+            if(sumWeights <= 0.f)
+                return;
+            const float ratio = weight / sumWeights;
+            half* mean = &tile.colors[3 * i];
+            for(int c = 0; c < 3; ++c)
+                mean[c] = float(mean[c]) + (color(c) - float(mean[c])) * ratio;
+            tile.weights[i] = sumWeights;
+        }
+
+        /// Set the mean color and the weight of a texel, ignored outside the allocated tiles
+        void set(int x, int y, const image::RGBfColor& color, float weight);
+
+        /// Get the mean color and the weight of a texel, 0 outside the allocated tiles
+        float get(int x, int y, image::RGBfColor& color) const;
+
+        std::size_t getMemorySize() const;
+    };
+
     struct AccuPyramid
     {
         std::vector<AccuImage> pyramid;
 
-        void init(int nbLevels, int imgWidth, int imgHeight)
+        void init(int nbLevels, int imgWidth, int imgHeight, const std::vector<bool>& tilesMask)
         {
             pyramid.resize(nbLevels);
             for(auto& accuImage : pyramid)
-                accuImage.resize(imgWidth, imgHeight);
+                accuImage.init(imgWidth, imgHeight, tilesMask);
         }
     };
 
+    /**
+     * @brief Get the accumulation tiles covered by the triangles of a texture atlas
+     * @param[in] atlasID the texture atlas
+     * @return the mask of the tiles of AccuImage::tileSide texels
+     */
+    std::vector<bool> getAtlasTilesMask(std::size_t atlasID) const;
+
+    /**
+     * @brief Get the cameras seeing the triangles of each texture atlas (union of the vertices visibilities)
+     * @param[in] nbCameras the number of cameras
+     * @return the sorted camera indexes of each atlas
+     */
+    std::vector<std::vector<int>> getAtlasesCameras(int nbCameras) const;
+
+    /**
+     * @brief Group the texture atlases in batches of atlases sharing the same cameras,
+     *        the batches are ordered so consecutive batches share as many cameras as possible.
+     * @param[in] atlasesCameras the sorted camera indexes of each atlas
+     * @param[in] nbAtlasMax the maximum number of atlases per batch
+     * @return the atlases indexes of each batch
+     */
+    static std::vector<std::vector<size_t>> getAtlasesBatches(const std::vector<std::vector<int>>& atlasesCameras, int nbAtlasMax);
+
     /// Generate texture files for all texture atlases
     void generateTextures(const mvsUtils::MultiViewParams& mp,
                           const bfs::path &outPath,
                           image::EImageFileType textureFileType = image::EImageFileType::PNG);
 
     /// Generate texture files for the given sub-set of texture atlases
+    /// (the texture projection is done on the GPU if a deviceTexturing is given,
+    ///  the textures are filled and written in the background if an imageWriter is given)
     void generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
                                 const std::vector<size_t>& atlasIDs,
                                 mvsUtils::ImagesCache<image::Image<image::RGBfColor>>& imageCache,
                                 const bfs::path &outPath,
-                                image::EImageFileType textureFileType = image::EImageFileType::PNG);
+                                image::EImageFileType textureFileType = image::EImageFileType::PNG,
+                                cuda::DeviceTexturing* deviceTexturing = nullptr,
+                                image::AsyncImageWriter* imageWriter = nullptr);
 
     void generateNormalAndHeightMaps(const mvsUtils::MultiViewParams& mp, const Mesh& denseMesh,
                                      const bfs::path& outPath, const mesh::BumpMappingParams& bumpMappingParams);
@@ -210,9 +299,10 @@ public:
                                       mvsUtils::ImagesCache<image::Image<image::RGBfColor> >& imageCache,
                                       const bfs::path& outPath, const mesh::BumpMappingParams& bumpMappingParams);
 
-    ///Fill holes and write texture files for the given texture atlas
-    void writeTexture(AccuImage& atlasTexture, const std::size_t atlasID, const bfs::path& outPath,
-                      image::EImageFileType textureFileType, const int level);
+    /// Fill holes and write texture files for the given texture atlas
+    /// (thread-safe, only texParams is read)
+    void writeTexture(AtlasTexture& atlasTexture, const std::size_t atlasID, const bfs::path& outPath,
+                      image::EImageFileType textureFileType, const int level) const;
 
     /// Save textured mesh as an OBJ + MTL file
     void saveAs(const bfs::path& dir, const std::string& basename,
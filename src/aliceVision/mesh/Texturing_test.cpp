@@ -0,0 +1,178 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/mesh/Mesh.hpp>
+#include <aliceVision/mesh/Texturing.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+#define BOOST_TEST_MODULE texturing
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+
+namespace {
+
+void addUvTriangle(const Point2d& a, const Point2d& b, const Point2d& c, mesh::Mesh& mesh)
+{
+    const int firstUvId = mesh.uvCoords.size();
+    mesh.uvCoords.push_back(a);
+    mesh.uvCoords.push_back(b);
+    mesh.uvCoords.push_back(c);
+
+    Voxel triangleUvIds;
+    triangleUvIds.x = firstUvId;
+    triangleUvIds.y = firstUvId + 1;
+    triangleUvIds.z = firstUvId + 2;
+    mesh.trisUvIds.push_back(triangleUvIds);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(texturing_accuImageTiles)
+{
+    using AccuImage = mesh::Texturing::AccuImage;
+
+    // 3x2 tiles, the last column and row are partial tiles
+    const int width = 2 * AccuImage::tileSide + 2;
+    const int height = AccuImage::tileSide + 6;
+    const std::vector<bool> tilesMask = {true, false, false,
+                                         false, false, true};
+
+    AccuImage accuImage;
+    BOOST_CHECK_THROW(accuImage.init(width, height, std::vector<bool>(5, true)), std::runtime_error);
+
+    accuImage.init(width, height, tilesMask);
+    BOOST_CHECK_EQUAL(accuImage.nbTilesX, 3);
+    BOOST_REQUIRE_EQUAL(accuImage.tiles.size(), 6);
+    BOOST_CHECK_EQUAL(accuImage.getMemorySize(),
+                      6 * sizeof(AccuImage::Tile) + 2 * AccuImage::tileSide * AccuImage::tileSide * (3 * sizeof(half) + sizeof(float)));
+
+    // allocated tiles
+    image::RGBfColor color;
+    BOOST_CHECK_EQUAL(accuImage.get(10, 10, color), 0.f);
+
+    accuImage.add(10, 10, image::RGBfColor(0.25f, 0.5f, 1.f), 2.f);
+    accuImage.add(10, 10, image::RGBfColor(0.75f, 0.f, 0.f), 2.f);
+    BOOST_CHECK_EQUAL(accuImage.get(10, 10, color), 4.f);
+    BOOST_CHECK_CLOSE(color.r(), 0.5f, 1e-3);
+    BOOST_CHECK_CLOSE(color.g(), 0.25f, 1e-3);
+    BOOST_CHECK_CLOSE(color.b(), 0.5f, 1e-3);
+
+    // a contribution without weight is ignored
+    accuImage.add(11, 10, image::RGBfColor(1.f, 1.f, 1.f), 0.f);
+    BOOST_CHECK_EQUAL(accuImage.get(11, 10, color), 0.f);
+    BOOST_CHECK_EQUAL(color.r(), 0.f);
+
+    accuImage.set(width - 1, height - 1, image::RGBfColor(0.5f, -0.5f, 0.125f), 3.f);
+    BOOST_CHECK_EQUAL(accuImage.get(width - 1, height - 1, color), 3.f);
+    BOOST_CHECK_EQUAL(color.g(), -0.5f);
+
+    // the texels of the unallocated tiles are empty, and stay empty
+    accuImage.set(AccuImage::tileSide, 0, image::RGBfColor(1.f, 1.f, 1.f), 1.f);
+    BOOST_CHECK_EQUAL(accuImage.get(AccuImage::tileSide, 0, color), 0.f);
+    BOOST_CHECK_EQUAL(color.r(), 0.f);
+    BOOST_CHECK_EQUAL(accuImage.get(0, AccuImage::tileSide, color), 0.f);
+    BOOST_CHECK_EQUAL(accuImage.get(width - 1, 0, color), 0.f);
+}
+
+BOOST_AUTO_TEST_CASE(texturing_accuImageMeanPrecision)
+{
+    using AccuImage = mesh::Texturing::AccuImage;
+
+    // the band values of the laplacian pyramid are in [-1, 1], the weights are triangle scores (image areas)
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<float> colorDistribution(-1.f, 1.f);
+    std::uniform_real_distribution<float> weightDistribution(0.01f, 1000.f);
+
+    const int side = AccuImage::tileSide;
+    AccuImage accuImage;
+    accuImage.init(side, side, std::vector<bool>(1, true));
+
+    for(const int nbContributions : {1, 5, 10, 50, 200})
+    {
+        double maxError = 0.0;
+
+        for(int y = 0; y < side; ++y)
+        {
+            for(int x = 0; x < side; ++x)
+            {
+                accuImage.set(x, y, image::RGBfColor(0.f, 0.f, 0.f), 0.f);
+
+                // float reference of the weighted mean
+                double sumColors[3] = {0.0, 0.0, 0.0};
+                double sumWeights = 0.0;
+                for(int k = 0; k < nbContributions; ++k)
+                {
+                    const image::RGBfColor color(colorDistribution(generator), colorDistribution(generator), colorDistribution(generator));
+                    const float weight = weightDistribution(generator);
+                    accuImage.add(x, y, color, weight);
+
+                    for(int c = 0; c < 3; ++c)
+                        sumColors[c] += double(weight) * color(c);
+                    sumWeights += weight;
+                }
+
+                image::RGBfColor mean;
+                BOOST_CHECK_CLOSE(accuImage.get(x, y, mean), sumWeights, 1e-2);
+                for(int c = 0; c < 3; ++c)
+                    maxError = std::max(maxError, std::abs(mean(c) - sumColors[c] / sumWeights));
+            }
+        }
+
+        // below one 8-bit level
+        BOOST_TEST_MESSAGE(nbContributions << " contributions, max error: " << maxError);
+        BOOST_CHECK_LT(maxError, 1.0 / 255.0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(texturing_atlasTilesMask)
+{
+    using AccuImage = mesh::Texturing::AccuImage;
+
+    mesh::Texturing texturing;
+    texturing.texParams.textureSide = 4 * AccuImage::tileSide;
+    texturing.mesh = new mesh::Mesh();
+
+    // a small triangle in the first tile column, the texel rows are flipped: last tile row
+    addUvTriangle(Point2d(0.1, 0.1), Point2d(0.2, 0.1), Point2d(0.1, 0.2), *texturing.mesh);
+    // the same triangle in the second UDIM tile
+    addUvTriangle(Point2d(1.1, 0.1), Point2d(1.2, 0.1), Point2d(1.1, 0.2), *texturing.mesh);
+    // a triangle over the 4 center tiles
+    addUvTriangle(Point2d(0.4, 0.4), Point2d(0.6, 0.4), Point2d(0.5, 0.6), *texturing.mesh);
+
+    texturing._atlases = {{0, 1}, {2}, {}};
+
+    const std::vector<bool> tilesMask0 = texturing.getAtlasTilesMask(0);
+    BOOST_REQUIRE_EQUAL(tilesMask0.size(), 16);
+    for(int t = 0; t < 16; ++t)
+        BOOST_CHECK_EQUAL(tilesMask0[t], t == 3 * 4 + 0);
+
+    const std::vector<bool> tilesMask1 = texturing.getAtlasTilesMask(1);
+    for(int t = 0; t < 16; ++t)
+    {
+        const int tx = t % 4;
+        const int ty = t / 4;
+        BOOST_CHECK_EQUAL(tilesMask1[t], (tx == 1 || tx == 2) && (ty == 1 || ty == 2));
+    }
+
+    // an empty atlas
+    const std::vector<bool> tilesMask2 = texturing.getAtlasTilesMask(2);
+    BOOST_CHECK_EQUAL(std::count(tilesMask2.begin(), tilesMask2.end(), true), 0);
+
+    // the mask allocates the tiles of the accumulation buffer
+    AccuImage accuImage;
+    accuImage.init(texturing.texParams.textureSide, texturing.texParams.textureSide, tilesMask0);
+    accuImage.add(10, 4 * AccuImage::tileSide - 10, image::RGBfColor(1.f, 1.f, 1.f), 1.f);
+    image::RGBfColor color;
+    BOOST_CHECK_EQUAL(accuImage.get(10, 4 * AccuImage::tileSide - 10, color), 1.f);
+    BOOST_CHECK_EQUAL(accuImage.get(10, 10, color), 0.f);
+}
@@ -7,6 +7,8 @@
 #include "UVAtlas.hpp"
 #include <aliceVision/system/Logger.hpp>
 
+#include <algorithm>
+#include <array>
 #include <iostream>
 
 namespace aliceVision {
@@ -102,52 +104,29 @@ void UVAtlas::packCharts(std::vector<Chart>& charts, mvsUtils::MultiViewParams&
         return cid;
     };
 
-    // list mesh edges (with duplicates)
-    std::vector<Edge> alledges;
+    // list mesh edges as (lower vertex, upper vertex, triangle), sorted to find the triangles sharing an edge
+    std::vector<std::array<int, 3>> edgesTriangles;
+    edgesTriangles.reserve(_mesh.tris.size() * 3);
     for(int i = 0; i < _mesh.tris.size(); ++i)
     {
-        int a = _mesh.tris[i].v[0];
-        int b = _mesh.tris[i].v[1];
-        int c = _mesh.tris[i].v[2];
-        Edge e1;
-        e1.pointIDs = std::make_pair(std::min(a, b), std::max(a, b));
-        e1.triangleIDs.emplace_back(i);
-        alledges.emplace_back(e1);
-        Edge e2;
-        e2.pointIDs = std::make_pair(std::min(b, c), std::max(b, c));
-        e2.triangleIDs.emplace_back(i);
-        alledges.emplace_back(e2);
-        Edge e3;
-        e3.pointIDs = std::make_pair(std::min(c, a), std::max(c, a));
-        e3.triangleIDs.emplace_back(i);
-        alledges.emplace_back(e3);
-    }
-    std::sort(alledges.begin(), alledges.end());
-
-    // merge edges (no duplicate)
-    std::vector<Edge> edges;
-    auto eit = alledges.begin() + 1;
-    while(eit != alledges.end())
-    {
-        auto& a = *(eit-1);
-        auto& b = *eit;
-        if(a == b)
+        for(int k = 0; k < 3; ++k)
         {
-            a.triangleIDs.insert(a.triangleIDs.end(), b.triangleIDs.begin(), b.triangleIDs.end());
-            sort(a.triangleIDs.begin(), a.triangleIDs.end());
-            edges.push_back(a);
+            const int a = _mesh.tris[i].v[k];
+            const int b = _mesh.tris[i].v[(k + 1) % 3];
+            edgesTriangles.push_back({std::min(a, b), std::max(a, b), i});
         }
-        ++eit;
     }
-    alledges.clear();
+    std::sort(edgesTriangles.begin(), edgesTriangles.end());
 
-    // merge charts
-    for(auto& e : edges)
+    // merge charts of the consecutive triangles sharing an edge
+    for(std::size_t e = 1; e < edgesTriangles.size(); ++e)
     {
-        if(e.triangleIDs.size() != 2)
+        const std::array<int, 3>& edgeA = edgesTriangles[e - 1];
+        const std::array<int, 3>& edgeB = edgesTriangles[e];
+        if(edgeA[0] != edgeB[0] || edgeA[1] != edgeB[1])
             continue;
-        int chartIDA = findChart(e.triangleIDs[0]);
-        int chartIDB = findChart(e.triangleIDs[1]);
+        int chartIDA = findChart(edgeA[2]);
+        int chartIDB = findChart(edgeB[2]);
         if(chartIDA == chartIDB)
             continue;
         Chart& a = charts[chartIDA];
@@ -174,7 +153,6 @@ void UVAtlas::packCharts(std::vector<Chart>& charts, mvsUtils::MultiViewParams&
             a.mergedWith = chartIDB;
         }
     }
-    edges.clear();
 
     // remove merged charts
     charts.erase(remove_if(charts.begin(), charts.end(), [](Chart& c)
@@ -260,16 +238,19 @@ void UVAtlas::createTextureAtlases(std::vector<Chart>& charts, mvsUtils::MultiVi
         ALICEVISION_LOG_INFO("\t- texture atlas " << texCount);
         std::vector<Chart> atlas;
         // create a tree root
-        ChartRect* root = new ChartRect();
+        std::deque<ChartRect> nodes;
+        nodes.emplace_back();
+        ChartRect* root = &nodes.back();
         root->LU.x = 0;
         root->LU.y = 0;
         root->RD.x = _textureSide - 1;
         root->RD.y = _textureSide - 1;
+        root->updateMaxFreeSize();
 
         const auto insertChart = [&](size_t idx) -> bool
         {
             Chart& chart = charts[idx];
-            ChartRect* rect = root->insert(chart, _gutterSize);
+            ChartRect* rect = root->insert(chart, _gutterSize, nodes);
             if(!rect)
                 return false;
 
@@ -277,8 +258,8 @@ void UVAtlas::createTextureAtlases(std::vector<Chart>& charts, mvsUtils::MultiVi
             chart.targetLU = rect->LU;
             chart.targetLU.x += _gutterSize;
             chart.targetLU.y += _gutterSize;
-            // add to the current texture atlas
-            atlas.emplace_back(chart);
+            // add to the current texture atlas, the chart is not used anymore
+            atlas.emplace_back(std::move(chart));
             return true;
         };
         // insert as many charts as possible in forward direction (largest to smallest)
@@ -292,39 +273,63 @@ void UVAtlas::createTextureAtlases(std::vector<Chart>& charts, mvsUtils::MultiVi
         // atlas is full or all charts have been handled
         ALICEVISION_LOG_INFO("Filled with " << atlas.size() << " charts.");
         // store this texture
-        _atlases.emplace_back(atlas);
-        // clear the whole tree
-        root->clear();
-        delete root;
+        _atlases.emplace_back(std::move(atlas));
     }
 }
 
-void UVAtlas::ChartRect::clear()
+void UVAtlas::ChartRect::updateMaxFreeSize()
 {
-    if(child[0])
-        child[0]->clear();
-    if(child[1])
-        child[1]->clear();
-    delete child[0];
-    delete child[1];
+    if(!child[0] && !child[1])
+    {
+        maxFreeWidth = c ? 0 : (RD.x - LU.x);
+        maxFreeHeight = c ? 0 : (RD.y - LU.y);
+        return;
+    }
+    maxFreeWidth = 0;
+    maxFreeHeight = 0;
+    for(const ChartRect* rect : child)
+    {
+        if(!rect)
+            continue;
+        maxFreeWidth = std::max(maxFreeWidth, rect->maxFreeWidth);
+        maxFreeHeight = std::max(maxFreeHeight, rect->maxFreeHeight);
+    }
 }
 
-UVAtlas::ChartRect* UVAtlas::ChartRect::insert(Chart& chart, size_t gutter)
+UVAtlas::ChartRect* UVAtlas::ChartRect::insert(Chart& chart, size_t gutter, std::deque<ChartRect>& nodes)
 {
+    size_t chartWidth = chart.targetWidth() + gutter * 2;
+    size_t chartHeight = chart.targetHeight() + gutter * 2;
+
+    // no leaf of this subtree is large enough
+    if(chartWidth > static_cast<size_t>(maxFreeWidth) || chartHeight > static_cast<size_t>(maxFreeHeight))
+        return nullptr;
+
+    const auto newChild = [&](int x0, int y0, int x1, int y1)
+    {
+        nodes.emplace_back();
+        ChartRect* rect = &nodes.back();
+        rect->LU.x = x0;
+        rect->LU.y = y0;
+        rect->RD.x = x1;
+        rect->RD.y = y1;
+        rect->updateMaxFreeSize();
+        return rect;
+    };
+
     if(child[0] || child[1]) // not a leaf
     {
+        ChartRect* rect = nullptr;
         if(child[0])
-            if(ChartRect* rect = child[0]->insert(chart, gutter))
-                return rect;
-        if(child[1])
-            if(ChartRect* rect = child[1]->insert(chart, gutter))
-                return rect;
-        return nullptr;
+            rect = child[0]->insert(chart, gutter, nodes);
+        if(!rect && child[1])
+            rect = child[1]->insert(chart, gutter, nodes);
+        if(rect)
+            updateMaxFreeSize();
+        return rect;
     }
     else
     {
-        size_t chartWidth = chart.targetWidth() + gutter * 2;
-        size_t chartHeight = chart.targetHeight() + gutter * 2;
         // if there is already a chart here
         if(c) return nullptr;
         // not enough space
@@ -336,43 +341,20 @@ UVAtlas::ChartRect* UVAtlas::ChartRect::insert(Chart& chart, size_t gutter)
         if(chartWidth >= chartHeight)
         {
             if(chartWidth < (RD.x - LU.x))
-            {
-                child[0] = new ChartRect();
-                child[0]->LU.x = LU.x + chartWidth;
-                child[0]->LU.y = LU.y;
-                child[0]->RD.x = RD.x;
-                child[0]->RD.y = LU.y + chartHeight;
-            }
+                child[0] = newChild(LU.x + chartWidth, LU.y, RD.x, LU.y + chartHeight);
             if(chartHeight < (RD.y - LU.y))
-            {
-                child[1] = new ChartRect();
-                child[1]->LU.x = LU.x;
-                child[1]->LU.y = LU.y + chartHeight;
-                child[1]->RD.x = RD.x;
-                child[1]->RD.y = RD.y;
-            }
+                child[1] = newChild(LU.x, LU.y + chartHeight, RD.x, RD.y);
         }
         else 
         {
             if(chartHeight < (RD.y - LU.y))
-            {
-                child[0] = new ChartRect();
-                child[0]->LU.x = LU.x;
-                child[0]->LU.y = LU.y + chartHeight;
-                child[0]->RD.x = LU.x + chartWidth;
-                child[0]->RD.y = RD.y;
-            }
+                child[0] = newChild(LU.x, LU.y + chartHeight, LU.x + chartWidth, RD.y);
             if(chartWidth < (RD.x - LU.x))
-            {
-                child[1] = new ChartRect();
-                child[1]->LU.x = LU.x + chartWidth;
-                child[1]->LU.y = LU.y;
-                child[1]->RD.x = RD.x;
-                child[1]->RD.y = RD.y;
-            }
+                child[1] = newChild(LU.x + chartWidth, LU.y, RD.x, RD.y);
         }
         // insert chart
         c = &chart;
+        updateMaxFreeSize();
         return this;
     }
 }
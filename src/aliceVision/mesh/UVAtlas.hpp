@@ -9,6 +9,7 @@
 #include <aliceVision/mvsData/StaticVector.hpp>
 #include <aliceVision/mesh/Mesh.hpp>
 
+#include <deque>
 #include <vector>
 
 namespace aliceVision {
@@ -17,14 +18,6 @@ namespace mesh {
 class UVAtlas
 {
 public:
-    struct Edge
-    {
-        std::pair<int, int> pointIDs;
-        std::vector<int> triangleIDs;
-        bool operator<(const Edge& other) const { return pointIDs < other.pointIDs; }
-        bool operator==(const Edge& other) const { return pointIDs == other.pointIDs; }
-    };
-
     struct Chart
     {
         int refCameraID = -1;                                   // refCamera, used to project all contained triangles
@@ -52,8 +45,15 @@ public:
         ChartRect* child[2] {nullptr, nullptr};
         Pixel LU;
         Pixel RD;
-        void clear();
-        ChartRect* insert(Chart& chart, size_t gutter);
+        /// largest free width and height of the leaves of this subtree, to skip the subtrees where a chart can't fit
+        int maxFreeWidth = 0;
+        int maxFreeHeight = 0;
+        void updateMaxFreeSize();
+        /**
+         * @brief Insert a chart in the first free leaf large enough.
+         * @param[in,out] nodes storage of the tree nodes, the new nodes are appended
+         */
+        ChartRect* insert(Chart& chart, size_t gutter, std::deque<ChartRect>& nodes);
     };
 
 public:
@@ -0,0 +1,440 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "DeviceTexturing.hpp"
+
+#include <cuda_runtime.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <stdexcept>
+#include <string>
+
+namespace aliceVision {
+namespace mesh {
+namespace cuda {
+
+namespace {
+
+/// maximum number of frequency bands supported by the kernel
+constexpr int maxNbBands = 8;
+/// block side of the rasterization kernel, each block rasterizes one triangle
+constexpr int blockSide = 16;
+
+void throwOnCudaError(cudaError_t err, const std::string& message)
+{
+    if(err != cudaSuccess)
+        throw std::runtime_error(message + ": " + cudaGetErrorString(err));
+}
+
+inline unsigned int divUp(unsigned int a, unsigned int b)
+{
+    return (a % b != 0) ? (a / b + 1) : (a / b);
+}
+
+struct DeviceImage
+{
+    const float* data;
+    int width;
+    int height;
+};
+
+/**
+ * @brief Camera data given by value to the accumulation kernel.
+ */
+struct DeviceCameraParams
+{
+    double P[12];
+    int border;
+    int multiBandDownscale;
+    int nbBands;
+    DeviceImage image;
+    DeviceImage pyramid[maxNbBands];
+};
+
+/**
+ * @brief Bilinear interpolation of a RGB image, same as image::getInterpolateColor.
+ */
+__device__ float3 getInterpolateColor(const DeviceImage& img, float y, float x)
+{
+    const int xp = min(static_cast<int>(x), img.width - 2);
+    const int yp = min(static_cast<int>(y), img.height - 2);
+
+    const float ui = x - static_cast<float>(xp);
+    const float vi = y - static_cast<float>(yp);
+
+    const float* lu = img.data + 3 * (size_t(yp) * img.width + xp);
+    const float* ru = lu + 3;
+    const float* ld = lu + 3 * size_t(img.width);
+    const float* rd = ld + 3;
+
+    float out[3];
+    for(int c = 0; c < 3; ++c)
+    {
+        const float u = lu[c] + (ru[c] - lu[c]) * ui;
+        const float d = ld[c] + (rd[c] - ld[c]) * ui;
+        out[c] = u + (d - u) * vi;
+    }
+    return make_float3(out[0], out[1], out[2]);
+}
+
+/**
+ * @brief Closest point of a segment [a, b] to p.
+ * @return the squared distance, t is the position of the closest point on the segment
+ */
+__device__ float pointSegmentSquaredDistance(float2 p, float2 a, float2 b, float& t)
+{
+    const float2 ab = make_float2(b.x - a.x, b.y - a.y);
+    const float2 ap = make_float2(p.x - a.x, p.y - a.y);
+    const float l2 = ab.x * ab.x + ab.y * ab.y;
+    t = (l2 > 0.f) ? fminf(fmaxf((ap.x * ab.x + ap.y * ab.y) / l2, 0.f), 1.f) : 0.f;
+    const float dx = ap.x - t * ab.x;
+    const float dy = ap.y - t * ab.y;
+    return dx * dx + dy * dy;
+}
+
+/**
+ * @brief Squared distance from p to the triangle (v0, v1, v2) and barycentric coordinates of the closest point,
+ *        same as GEO::Geom::point_triangle_squared_distance used by the CPU texturing.
+ */
+__device__ float pointTriangleSquaredDistance(float2 p, float2 v0, float2 v1, float2 v2, float& l1, float& l2, float& l3)
+{
+    const float2 e1 = make_float2(v1.x - v0.x, v1.y - v0.y);
+    const float2 e2 = make_float2(v2.x - v0.x, v2.y - v0.y);
+    const float det = e1.x * e2.y - e1.y * e2.x;
+    if(fabsf(det) > FLT_EPSILON)
+    {
+        const float2 d = make_float2(p.x - v0.x, p.y - v0.y);
+        const float b1 = (d.x * e2.y - d.y * e2.x) / det;
+        const float b2 = (e1.x * d.y - e1.y * d.x) / det;
+        if(b1 >= 0.f && b2 >= 0.f && b1 + b2 <= 1.f)
+        {
+            l1 = 1.f - b1 - b2;
+            l2 = b1;
+            l3 = b2;
+            return 0.f;
+        }
+    }
+
+    // the closest point is on an edge
+    float t;
+    float best = pointSegmentSquaredDistance(p, v0, v1, t);
+    l1 = 1.f - t;
+    l2 = t;
+    l3 = 0.f;
+
+    float dist = pointSegmentSquaredDistance(p, v1, v2, t);
+    if(dist < best)
+    {
+        best = dist;
+        l1 = 0.f;
+        l2 = 1.f - t;
+        l3 = t;
+    }
+    dist = pointSegmentSquaredDistance(p, v2, v0, t);
+    if(dist < best)
+    {
+        best = dist;
+        l1 = t;
+        l2 = 0.f;
+        l3 = 1.f - t;
+    }
+    return best;
+}
+
+/**
+ * @brief Rasterize the atlases triangles, project each texel in the camera
+ *        and accumulate the camera laplacian pyramid colors in the multi-band buffers.
+ *        Each block rasterizes one triangle, the texels shared by adjacent triangles are accumulated atomically.
+ */
+__global__ void accumulateTriangles_kernel(const DeviceTexturingTriangle* triangles_d, int nbTriangles,
+                                           DeviceCameraParams camera, int textureSide, float4* accumulation_d)
+{
+    const int triangleIndex = blockIdx.x;
+    if(triangleIndex >= nbTriangles)
+        return;
+
+    const DeviceTexturingTriangle& tri = triangles_d[triangleIndex];
+    const float2 v0 = make_float2(tri.uv[0][0], tri.uv[0][1]);
+    const float2 v1 = make_float2(tri.uv[1][0], tri.uv[1][1]);
+    const float2 v2 = make_float2(tri.uv[2][0], tri.uv[2][1]);
+
+    // triangle bounding box in pixel indexes, clamped to [0; textureSide]
+    const int luX = min(max(static_cast<int>(floorf(fminf(v0.x, fminf(v1.x, v2.x)))), 0), textureSide);
+    const int luY = min(max(static_cast<int>(floorf(fminf(v0.y, fminf(v1.y, v2.y)))), 0), textureSide);
+    const int rdX = min(max(static_cast<int>(ceilf(fmaxf(v0.x, fmaxf(v1.x, v2.x)))), 0), textureSide);
+    const int rdY = min(max(static_cast<int>(ceilf(fmaxf(v0.y, fmaxf(v1.y, v2.y)))), 0), textureSide);
+
+    const size_t bandSize = size_t(textureSide) * textureSide;
+
+    for(int y = luY + threadIdx.y; y < rdY; y += blockSide)
+    {
+        for(int x = luX + threadIdx.x; x < rdX; x += blockSide)
+        {
+            // test the pixel center with a tolerance of 1/2 pixel for the pixels on the edges of the triangle
+            float l1, l2, l3;
+            const float dist = pointTriangleSquaredDistance(make_float2(x + 0.5f, y + 0.5f), v0, v1, v2, l1, l2, l3);
+            if(dist >= 0.5f + FLT_EPSILON)
+                continue;
+
+            // 3D point from the barycentric coordinates
+            double pt[3];
+            for(int k = 0; k < 3; ++k)
+                pt[k] = tri.pts[0][k] + (tri.pts[2][k] - tri.pts[0][k]) * l3 + (tri.pts[1][k] - tri.pts[0][k]) * l2;
+
+            // project in the camera
+            const double* P = camera.P;
+            const double pz = P[8] * pt[0] + P[9] * pt[1] + P[10] * pt[2] + P[11];
+            if(pz <= 0.0)
+                continue;
+            const double px = (P[0] * pt[0] + P[1] * pt[1] + P[2] * pt[2] + P[3]) / pz;
+            const double py = (P[4] * pt[0] + P[5] * pt[1] + P[6] * pt[2] + P[7]) / pz;
+
+            // exclude out of bounds pixels
+            const int pixX = static_cast<int>(floor(px + 0.5));
+            const int pixY = static_cast<int>(floor(py + 0.5));
+            if(pixX < camera.border || pixX >= camera.image.width - camera.border ||
+               pixY < camera.border || pixY >= camera.image.height - camera.border)
+                continue;
+
+            // if the color is pure zero (ie. no contributions), we consider it as an invalid pixel
+            const float3 color = getInterpolateColor(camera.image, float(py), float(px));
+            if(color.x == 0.f && color.y == 0.f && color.z == 0.f)
+                continue;
+
+            // remap 'y' to image coordinates system (inverted Y axis)
+            const size_t xyoffset = size_t(textureSide - 1 - y) * textureSide + x;
+
+            // each frequency band also contributes to lower frequencies (higher band indexes)
+            double downscaleCoef = 1.0;
+            for(int b = 0; b < camera.nbBands; ++b)
+            {
+                if(b >= tri.band)
+                {
+                    const float3 c = getInterpolateColor(camera.pyramid[b], float(py / downscaleCoef), float(px / downscaleCoef));
+                    float4* texel = accumulation_d + (size_t(tri.atlasIndex) * camera.nbBands + b) * bandSize + xyoffset;
+                    atomicAdd(&texel->x, c.x * tri.score);
+                    atomicAdd(&texel->y, c.y * tri.score);
+                    atomicAdd(&texel->z, c.z * tri.score);
+                    atomicAdd(&texel->w, tri.score);
+                }
+                downscaleCoef *= camera.multiBandDownscale;
+            }
+        }
+    }
+}
+
+__global__ void splitAccumulation_kernel(const float4* accumulation_d, size_t size, float* colors_d, float* counts_d)
+{
+    const size_t i = size_t(blockIdx.x) * blockDim.x + threadIdx.x;
+    if(i >= size)
+        return;
+
+    const float4 v = accumulation_d[i];
+    colors_d[3 * i + 0] = v.x;
+    colors_d[3 * i + 1] = v.y;
+    colors_d[3 * i + 2] = v.z;
+    counts_d[i] = v.w;
+}
+
+float* uploadImage(const DeviceTexturingImage& image)
+{
+    float* image_d = nullptr;
+    const size_t bytes = size_t(image.width) * image.height * 3 * sizeof(float);
+    throwOnCudaError(cudaMalloc(&image_d, bytes), "Cannot allocate a texturing camera image");
+    const cudaError_t err = cudaMemcpy(image_d, image.data, bytes, cudaMemcpyHostToDevice);
+    if(err != cudaSuccess)
+    {
+        cudaFree(image_d);
+        throwOnCudaError(err, "Cannot upload a texturing camera image");
+    }
+    return image_d;
+}
+
+} // namespace
+
+struct DeviceTexturing::DeviceCamera
+{
+    int camId = -1;
+    DeviceCameraParams params;
+    std::vector<float*> buffers_d;
+
+    ~DeviceCamera()
+    {
+        for(float* buffer_d : buffers_d)
+            cudaFree(buffer_d);
+    }
+};
+
+DeviceTexturing::DeviceTexturing(int nbBands, int textureSide, int multiBandDownscale, int maxNbCameras)
+    : _nbBands(nbBands)
+    , _textureSide(textureSide)
+    , _multiBandDownscale(multiBandDownscale)
+    , _maxNbCameras(std::max(1, maxNbCameras))
+{
+    if(nbBands < 1 || nbBands > maxNbBands)
+        throw std::runtime_error("GPU texturing supports from 1 to " + std::to_string(maxNbBands) + " frequency bands.");
+}
+
+DeviceTexturing::~DeviceTexturing()
+{
+    releaseAtlases();
+    for(DeviceCamera* camera : _cameras)
+        delete camera;
+}
+
+std::size_t DeviceTexturing::getAtlasMemorySize() const
+{
+    return std::size_t(_nbBands) * _textureSide * _textureSide * sizeof(float4) / (1024 * 1024);
+}
+
+std::size_t DeviceTexturing::getAvailableMemory()
+{
+    size_t freeMemory = 0;
+    size_t totalMemory = 0;
+    throwOnCudaError(cudaMemGetInfo(&freeMemory, &totalMemory), "Cannot get the GPU memory information");
+    return freeMemory / (1024 * 1024);
+}
+
+void DeviceTexturing::releaseAtlases()
+{
+    if(_accumulation_d != nullptr)
+        cudaFree(_accumulation_d);
+    _accumulation_d = nullptr;
+    _nbAtlases = 0;
+}
+
+void DeviceTexturing::initAtlases(int nbAtlases)
+{
+    const size_t bytes = size_t(nbAtlases) * _nbBands * _textureSide * _textureSide * sizeof(float4);
+
+    if(nbAtlases != _nbAtlases)
+    {
+        releaseAtlases();
+        throwOnCudaError(cudaMalloc(&_accumulation_d, bytes), "Cannot allocate the GPU texture atlases");
+        _nbAtlases = nbAtlases;
+    }
+    throwOnCudaError(cudaMemset(_accumulation_d, 0, bytes), "Cannot clear the GPU texture atlases");
+}
+
+bool DeviceTexturing::selectCamera(int camId)
+{
+    for(DeviceCamera* camera : _cameras)
+    {
+        if(camera->camId != camId)
+            continue;
+
+        _camerasOrder.remove(camId);
+        _camerasOrder.push_front(camId);
+        _selectedCamera = camera;
+        return true;
+    }
+    return false;
+}
+
+void DeviceTexturing::addCamera(int camId, const DeviceTexturingImage& image, const std::vector<DeviceTexturingImage>& pyramid,
+                                const double P[12], int border)
+{
+    if(static_cast<int>(pyramid.size()) != _nbBands)
+        throw std::runtime_error("GPU texturing: invalid laplacian pyramid for camera " + std::to_string(camId) + ".");
+
+    if(selectCamera(camId))
+        return;
+
+    // release the least recently used camera
+    if(static_cast<int>(_cameras.size()) >= _maxNbCameras)
+    {
+        const int lruCamId = _camerasOrder.back();
+        _camerasOrder.pop_back();
+        const auto it = std::find_if(_cameras.begin(), _cameras.end(), [lruCamId](const DeviceCamera* c) { return c->camId == lruCamId; });
+        delete *it;
+        _cameras.erase(it);
+    }
+
+    DeviceCamera* camera = new DeviceCamera();
+    try
+    {
+        camera->buffers_d.push_back(uploadImage(image));
+        camera->params.image = {camera->buffers_d.back(), image.width, image.height};
+
+        for(int b = 0; b < _nbBands; ++b)
+        {
+            camera->buffers_d.push_back(uploadImage(pyramid[b]));
+            camera->params.pyramid[b] = {camera->buffers_d.back(), pyramid[b].width, pyramid[b].height};
+        }
+    }
+    catch(...)
+    {
+        delete camera;
+        throw;
+    }
+
+    camera->camId = camId;
+    std::copy(P, P + 12, camera->params.P);
+    camera->params.border = border;
+    camera->params.multiBandDownscale = _multiBandDownscale;
+    camera->params.nbBands = _nbBands;
+
+    _cameras.push_back(camera);
+    _camerasOrder.push_front(camId);
+    _selectedCamera = camera;
+}
+
+void DeviceTexturing::accumulate(const std::vector<DeviceTexturingTriangle>& triangles)
+{
+    if(_selectedCamera == nullptr)
+        throw std::runtime_error("GPU texturing: no camera selected.");
+    if(triangles.empty())
+        return;
+
+    DeviceTexturingTriangle* triangles_d = nullptr;
+    const size_t bytes = triangles.size() * sizeof(DeviceTexturingTriangle);
+    throwOnCudaError(cudaMalloc(&triangles_d, bytes), "Cannot allocate the GPU texturing triangles");
+
+    cudaError_t err = cudaMemcpy(triangles_d, triangles.data(), bytes, cudaMemcpyHostToDevice);
+    if(err == cudaSuccess)
+    {
+        const dim3 block(blockSide, blockSide, 1);
+        const dim3 grid(static_cast<unsigned int>(triangles.size()), 1, 1);
+        accumulateTriangles_kernel<<<grid, block>>>(triangles_d, static_cast<int>(triangles.size()), _selectedCamera->params,
+                                                    _textureSide, static_cast<float4*>(_accumulation_d));
+        err = cudaGetLastError();
+        if(err == cudaSuccess)
+            err = cudaDeviceSynchronize();
+    }
+    cudaFree(triangles_d);
+    throwOnCudaError(err, "GPU texturing kernel failed");
+}
+
+void DeviceTexturing::download(int atlasIndex, int band, float* colors, float* counts) const
+{
+    const size_t size = size_t(_textureSide) * _textureSide;
+    const float4* band_d = static_cast<const float4*>(_accumulation_d) + (size_t(atlasIndex) * _nbBands + band) * size;
+
+    float* colors_d = nullptr;
+    float* counts_d = nullptr;
+    throwOnCudaError(cudaMalloc(&colors_d, size * 3 * sizeof(float)), "Cannot allocate the GPU texture download buffer");
+    cudaError_t err = cudaMalloc(&counts_d, size * sizeof(float));
+
+    if(err == cudaSuccess)
+    {
+        const unsigned int blockSize = 256;
+        splitAccumulation_kernel<<<divUp(static_cast<unsigned int>(size), blockSize), blockSize>>>(band_d, size, colors_d, counts_d);
+        err = cudaGetLastError();
+    }
+    if(err == cudaSuccess)
+        err = cudaMemcpy(colors, colors_d, size * 3 * sizeof(float), cudaMemcpyDeviceToHost);
+    if(err == cudaSuccess)
+        err = cudaMemcpy(counts, counts_d, size * sizeof(float), cudaMemcpyDeviceToHost);
+
+    cudaFree(colors_d);
+    cudaFree(counts_d);
+    throwOnCudaError(err, "Cannot download the GPU texture atlas");
+}
+
+} // namespace cuda
+} // namespace mesh
+} // namespace aliceVision
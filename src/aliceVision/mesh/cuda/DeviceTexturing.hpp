@@ -0,0 +1,148 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <vector>
+
+namespace aliceVision {
+namespace mesh {
+namespace cuda {
+
+/**
+ * @brief Contribution of a camera to a texture atlas triangle.
+ */
+struct DeviceTexturingTriangle
+{
+    /// triangle vertices in the texture atlas (pixels)
+    float uv[3][2];
+    /// triangle vertices in 3D
+    double pts[3][3];
+    /// contribution weight of the camera
+    float score;
+    /// index of the atlas in the current atlases subset
+    int atlasIndex;
+    /// first frequency band of the contribution (it also contributes to the lower frequencies)
+    int band;
+};
+
+/**
+ * @brief Host view of a RGB float image (row-major, interleaved channels)
+ */
+struct DeviceTexturingImage
+{
+    const float* data = nullptr;
+    int width = 0;
+    int height = 0;
+};
+
+/**
+ * @brief Texture atlases rasterization and camera images projective sampling on the GPU.
+ *
+ * The multi-band accumulation buffers of a subset of atlases stay in device memory while all the cameras are processed,
+ * all the contributions of a camera to all the atlases are accumulated by a single kernel launch.
+ * Like the depthMap DeviceCache, the last used cameras (image + laplacian pyramid) are kept in device memory,
+ * so a camera used by consecutive atlases subsets is uploaded only once.
+ *
+ * @note This class does not depend on the CUDA headers, so it can be used from host code.
+ */
+class DeviceTexturing
+{
+public:
+    /**
+     * @param[in] nbBands the number of frequency bands of the multi-band blending
+     * @param[in] textureSide the texture atlases side (pixels)
+     * @param[in] multiBandDownscale the downscale between two frequency bands
+     * @param[in] maxNbCameras the maximum number of cameras kept in device memory
+     */
+    DeviceTexturing(int nbBands, int textureSide, int multiBandDownscale, int maxNbCameras);
+    ~DeviceTexturing();
+
+    DeviceTexturing(const DeviceTexturing&) = delete;
+    DeviceTexturing& operator=(const DeviceTexturing&) = delete;
+
+    /**
+     * @brief Get the device memory needed by the accumulation buffers of one atlas (MB).
+     */
+    std::size_t getAtlasMemorySize() const;
+
+    /**
+     * @brief Get the available device memory (MB).
+     */
+    static std::size_t getAvailableMemory();
+
+    /**
+     * @brief Allocate and clear the accumulation buffers of a subset of atlases.
+     * @param[in] nbAtlases the number of atlases in the subset
+     * @throw std::runtime_error on CUDA error
+     */
+    void initAtlases(int nbAtlases);
+
+    /**
+     * @brief The cameras in device memory, from the most recently used.
+     */
+    const std::list<int>& getCachedCameras() const { return _camerasOrder; }
+
+    /**
+     * @brief Select a camera already in device memory.
+     * @return false if the camera is not in device memory
+     */
+    bool selectCamera(int camId);
+
+    /**
+     * @brief Upload and select a camera, the least recently used camera is released if the cache is full.
+     * @param[in] camId the camera index
+     * @param[in] image the camera image, used to discard the pixels without color
+     * @param[in] pyramid the laplacian pyramid of the camera image (one level per band)
+     * @param[in] P the camera projection matrix (3x4 row-major)
+     * @param[in] border the camera image border (pixels)
+     * @throw std::runtime_error on CUDA error
+     */
+    void addCamera(int camId, const DeviceTexturingImage& image, const std::vector<DeviceTexturingImage>& pyramid,
+                   const double P[12], int border);
+
+    /**
+     * @brief Accumulate the contributions of the selected camera to the atlases triangles.
+     * @param[in] triangles the triangles contributions of the selected camera
+     * @throw std::runtime_error on CUDA error
+     */
+    void accumulate(const std::vector<DeviceTexturingTriangle>& triangles);
+
+    /**
+     * @brief Download the accumulation buffers of an atlas band.
+     * @param[in] atlasIndex the index of the atlas in the current subset
+     * @param[in] band the frequency band
+     * @param[out] colors the accumulated colors (RGB interleaved, textureSide x textureSide)
+     * @param[out] counts the accumulated weights (textureSide x textureSide)
+     * @throw std::runtime_error on CUDA error
+     */
+    void download(int atlasIndex, int band, float* colors, float* counts) const;
+
+private:
+    struct DeviceCamera;
+
+    void releaseAtlases();
+
+    const int _nbBands;
+    const int _textureSide;
+    const int _multiBandDownscale;
+    const int _maxNbCameras;
+
+    /// accumulation buffers (r, g, b, weight) of each atlas and band
+    void* _accumulation_d = nullptr;
+    int _nbAtlases = 0;
+
+    std::vector<DeviceCamera*> _cameras;
+    /// camera indexes in device memory, from the most recently used
+    std::list<int> _camerasOrder;
+    DeviceCamera* _selectedCamera = nullptr;
+};
+
+} // namespace cuda
+} // namespace mesh
+} // namespace aliceVision
@@ -0,0 +1,55 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/alicevision_omp.hpp>
+#include <aliceVision/mvsData/StaticVector.hpp>
+
+namespace aliceVision {
+namespace mesh {
+
+/**
+ * @brief Iterative per-vertex filter with Jacobi updates.
+ *
+ * Each iteration computes the new value of every vertex in parallel from the values of the previous
+ * iteration only, in a second buffer swapped at the end of the iteration. So the result does not depend
+ * on the number of threads nor on the order of the vertices.
+ *
+ * @param[in,out] values the per-vertex values, filtered in place
+ * @param[in] nbIterations the number of iterations
+ * @param[in] beforeIteration called as beforeIteration(values) at the start of each iteration,
+ *            to compute the per-vertex data shared by the vertices filters
+ * @param[in] filter the vertex filter, called as filter(ptId, values, out_value)
+ */
+template <typename T, typename BeforeIteration, typename Filter>
+void filterVertices(StaticVector<T>& values, int nbIterations, BeforeIteration&& beforeIteration, Filter&& filter)
+{
+    StaticVector<T> newValues;
+    newValues.resize(values.size());
+
+    for(int iter = 0; iter < nbIterations; ++iter)
+    {
+        beforeIteration(static_cast<const StaticVector<T>&>(values));
+
+        #pragma omp parallel for
+        for(int i = 0; i < values.size(); ++i)
+        {
+            filter(i, static_cast<const StaticVector<T>&>(values), newValues[i]);
+        }
+        values.swap(newValues);
+    }
+}
+
+/// Iterative per-vertex filter with Jacobi updates, without per-iteration data
+template <typename T, typename Filter>
+void filterVertices(StaticVector<T>& values, int nbIterations, Filter&& filter)
+{
+    filterVertices(values, nbIterations, [](const StaticVector<T>&) {}, filter);
+}
+
+} // namespace mesh
+} // namespace aliceVision
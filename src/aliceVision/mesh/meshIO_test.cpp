@@ -0,0 +1,177 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/mesh/Mesh.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+#include <random>
+
+#define BOOST_TEST_MODULE meshIO
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+
+namespace {
+
+std::string getTemporaryPath(const std::string& extension)
+{
+    return (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string() + extension;
+}
+
+/// a grid of nbSide x nbSide vertices with random heights and colors, two triangles per cell
+void makeGridMesh(int nbSide, mesh::Mesh& mesh)
+{
+    std::mt19937 generator(3);
+    std::uniform_real_distribution<double> height(-100.0, 100.0);
+    std::uniform_int_distribution<int> color(0, 255);
+
+    for(int y = 0; y < nbSide; ++y)
+        for(int x = 0; x < nbSide; ++x)
+            mesh.pts.push_back(Point3d(x * 0.125, y * 1e-3 - 3.0, height(generator)));
+
+    std::vector<rgb> colors;
+    for(int i = 0; i < mesh.pts.size(); ++i)
+        colors.emplace_back(color(generator), color(generator), color(generator));
+    mesh.colors() = colors;
+
+    for(int y = 0; y + 1 < nbSide; ++y)
+    {
+        for(int x = 0; x + 1 < nbSide; ++x)
+        {
+            const int v = y * nbSide + x;
+            mesh.tris.push_back(mesh::Mesh::triangle(v, v + 1, v + nbSide));
+            mesh.tris.push_back(mesh::Mesh::triangle(v + 1, v + nbSide + 1, v + nbSide));
+        }
+    }
+}
+
+void checkSameGeometry(const mesh::Mesh& a, const mesh::Mesh& b, double relativeTolerance)
+{
+    BOOST_REQUIRE_EQUAL(a.pts.size(), b.pts.size());
+    BOOST_REQUIRE_EQUAL(a.tris.size(), b.tris.size());
+    for(int i = 0; i < a.pts.size(); ++i)
+    {
+        BOOST_CHECK_SMALL((a.pts[i] - b.pts[i]).size(), relativeTolerance * std::max(1.0, a.pts[i].size()));
+    }
+    for(int i = 0; i < a.tris.size(); ++i)
+    {
+        for(int k = 0; k < 3; ++k)
+            BOOST_CHECK_EQUAL(a.tris[i].v[k], b.tris[i].v[k]);
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(meshIO_objSyntax)
+{
+    const std::string filepath = getTemporaryPath(".obj");
+    {
+        std::ofstream file(filepath);
+        file << "# comment\r\n"
+             << "mtllib mesh.mtl\n"
+             << "v 0 0 0\n"
+             << "v 1.5 0 0 1 0 0\n"
+             << "v 1 1e1 0\n"
+             << "v 0 1 -2.5E-1\n"
+             << "vt 0 0\n"
+             << "vt 1 0\n"
+             << "vt 1 1\n"
+             << "vn 0 0 1\n"
+             << "usemtl a\n"
+             << "f 1/1/1 2/2/1 3/3/1 4/1/1\n"
+             << "usemtl b\n"
+             << "f -4/2 -3/2 -1/2\n"
+             << "f 1 1 2\n"
+             << "l 1 2\n";
+    }
+
+    mesh::Mesh mesh;
+    mesh.load(filepath);
+    boost::filesystem::remove(filepath);
+
+    // the quad is split in 2 triangles, the degenerate triangle is removed
+    BOOST_REQUIRE_EQUAL(mesh.tris.size(), 3);
+    // 4 vertices with their first texture coordinates, 2 vertices with other texture coordinates
+    BOOST_REQUIRE_EQUAL(mesh.pts.size(), 6);
+    BOOST_REQUIRE_EQUAL(mesh.uvCoords.size(), 6);
+    BOOST_REQUIRE_EQUAL(mesh.colors().size(), 6);
+
+    // Y and Z axes are flipped
+    BOOST_CHECK_CLOSE(mesh.pts[1].x, 1.5, 1e-12);
+    BOOST_CHECK_CLOSE(mesh.pts[2].y, -10.0, 1e-12);
+    BOOST_CHECK_CLOSE(mesh.pts[3].z, 0.25, 1e-12);
+    BOOST_CHECK_EQUAL(int(mesh.colors()[1].r), 255);
+    BOOST_CHECK_EQUAL(int(mesh.colors()[0].r), 0);
+
+    BOOST_CHECK_EQUAL(mesh.tris[1].v[0], 0);
+    BOOST_CHECK_EQUAL(mesh.tris[1].v[1], 2);
+    BOOST_CHECK_EQUAL(mesh.tris[1].v[2], 3);
+    BOOST_CHECK_EQUAL(mesh.trisUvIds[1].y, 2);
+    BOOST_CHECK_CLOSE(mesh.uvCoords[mesh.tris[1].v[1]].x, 1.0, 1e-12);
+
+    // the relative indices reference the points 1, 2 and 4 with the second texture coordinates
+    BOOST_CHECK_EQUAL(mesh.tris[2].v[0], 4);
+    BOOST_CHECK_EQUAL(mesh.tris[2].v[1], 1);
+    BOOST_CHECK_EQUAL(mesh.tris[2].v[2], 5);
+
+    BOOST_CHECK_EQUAL(mesh.trisMtlIds()[0], 0);
+    BOOST_CHECK_EQUAL(mesh.trisMtlIds()[1], 0);
+    BOOST_CHECK_EQUAL(mesh.trisMtlIds()[2], 1);
+}
+
+BOOST_AUTO_TEST_CASE(meshIO_objSaveLoad)
+{
+    mesh::Mesh mesh;
+    makeGridMesh(300, mesh);
+
+    const std::string filepath = getTemporaryPath(".obj");
+    mesh.save(filepath);
+
+    mesh::Mesh loaded;
+    loaded.load(filepath);
+    boost::filesystem::remove(filepath);
+
+    checkSameGeometry(mesh, loaded, 1e-8);
+}
+
+BOOST_AUTO_TEST_CASE(meshIO_plySaveLoad)
+{
+    mesh::Mesh mesh;
+    makeGridMesh(300, mesh);
+
+    const std::string filepath = getTemporaryPath(".ply");
+    mesh.save(filepath);
+
+    mesh::Mesh loaded;
+    BOOST_REQUIRE(loaded.loadFromPly(filepath));
+    boost::filesystem::remove(filepath);
+
+    // the positions are saved in single precision
+    checkSameGeometry(mesh, loaded, 1e-6);
+    BOOST_REQUIRE_EQUAL(loaded.colors().size(), mesh.colors().size());
+    for(std::size_t i = 0; i < mesh.colors().size(); ++i)
+    {
+        BOOST_CHECK_EQUAL(int(loaded.colors()[i].r), int(mesh.colors()[i].r));
+        BOOST_CHECK_EQUAL(int(loaded.colors()[i].b), int(mesh.colors()[i].b));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(meshIO_plyUnsupported)
+{
+    const std::string filepath = getTemporaryPath(".ply");
+    {
+        std::ofstream file(filepath);
+        file << "ply\nformat ascii 1.0\nelement vertex 0\nproperty float x\nproperty float y\nproperty float z\n"
+             << "element face 0\nproperty list uchar int vertex_indices\nend_header\n";
+    }
+    mesh::Mesh mesh;
+    BOOST_CHECK(!mesh.loadFromPly(filepath));
+    boost::filesystem::remove(filepath);
+}
@@ -6,7 +6,9 @@
 
 #include "meshVisibility.hpp"
 #include "geoMesh.hpp"
+#include "MeshZBuffer.hpp"
 
+#include <aliceVision/alicevision_omp.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/mvsData/geometry.hpp>
 
@@ -16,6 +18,9 @@
 #include <geogram/mesh/mesh_AABB.h>
 #include <geogram/mesh/mesh_reorder.h>
 
+#include <algorithm>
+#include <memory>
+
 
 namespace aliceVision {
 namespace mesh {
@@ -44,8 +49,8 @@ void remapMeshVisibilities_pullVerticesVisibility(const Mesh& refMesh, Mesh& mes
     const PointsVisibility& refPtsVisibilities = refMesh.pointsVisibilities;
     PointsVisibility& out_ptsVisibilities = mesh.pointsVisibilities;
 
-    GEO::AdaptiveKdTree refMesh_kdTree(3);
-    refMesh_kdTree.set_points(refMesh.pts.size(), refMesh.pts.front().m);
+    StaticVector<int> nearestVertices;
+    getNearestVertices(refMesh, mesh, nearestVertices);
 
     out_ptsVisibilities.resize(mesh.pts.size());
 
@@ -54,7 +59,7 @@ void remapMeshVisibilities_pullVerticesVisibility(const Mesh& refMesh, Mesh& mes
     {
         PointVisibility& pOut = out_ptsVisibilities[i];
 
-        int iRef = refMesh_kdTree.get_nearest_neighbor(mesh.pts[i].m);
+        const int iRef = nearestVertices[i];
         if(iRef == -1)
             continue;
         const PointVisibility& pRef = refPtsVisibilities[iRef];
@@ -145,56 +150,57 @@ void remapMeshVisibilities_meshItself(const mvsUtils::MultiViewParams& mp, Mesh&
 
     PointsVisibility& out_ptsVisibilities = mesh.pointsVisibilities;
 
-    GEO::initialize();
-    GEO::Mesh meshG;
-    toGeoMesh(mesh, meshG);
-
-    // MeshFacetAABB will reorder the mesh, so we need to keep indices
-    GEO::Attribute<GEO::index_t> reorderedVerticesAttr(meshG.vertices.attributes(), "reorder");
-    for(int i = 0; i < meshG.vertices.nb(); ++i)
-        reorderedVerticesAttr[i] = i;
-
-    GEO::MeshFacetsAABB meshAABB(meshG); // warning: mesh_reorder called inside
-
-    GEO::vector<GEO::index_t> reorderedVertices = reorderedVerticesAttr.get_vector();
-
     if(out_ptsVisibilities.size() != mesh.pts.size())
     {
         out_ptsVisibilities.resize(mesh.pts.size());
     }
-    const std::size_t nbCameras = mp.CArr.size();
+    const int nbCameras = mp.CArr.size();
 
     StaticVector<Point3d> normalsPerVertex;
     mesh.computeNormalsForPts(normalsPerVertex);
 
-#pragma omp parallel for
-    for(int vi = 0; vi < mesh.pts.size(); ++vi)
+    // the occlusions are tested in z-buffers at half the cameras resolution, rasterized in parallel
+    // by batches of cameras to bound the memory, then the vertices are tested in the cameras order
+    const int zBufferDownscale = 2;
+    const int batchSize = omp_get_max_threads();
+    std::vector<std::unique_ptr<MeshZBuffer>> zBuffers(batchSize);
+
+    for(int batchStart = 0; batchStart < nbCameras; batchStart += batchSize)
     {
-        const Point3d& v = mesh.pts[vi];
-        PointVisibility& vertexVisibility = out_ptsVisibilities[vi];
-        const Point3d& n = normalsPerVertex[vi];
+        const int batchEnd = std::min(nbCameras, batchStart + batchSize);
 
-        // Check by which camera the vertex is visible
-        for(std::size_t camIndex = 0; camIndex < nbCameras; ++camIndex)
+        #pragma omp parallel for
+        for(int camIndex = batchStart; camIndex < batchEnd; ++camIndex)
         {
-            const Point3d& c = mp.CArr[camIndex];
-
-            // check vertex normal (another solution would be to check each neighboring triangle)
-            const double angle = angleBetwV1andV2((c - v).normalize(), normalsPerVertex[vi]);
-            if(angle > 90.0)
-                continue;
-
-            const GEO::vec3 gv(v.x, v.y, v.z);
-            const GEO::vec3 gc(c.x, c.y, c.z);
-            const GEO::vec3 vc = gc - gv;
-            // check if there is an occlusion on the segment between the current mesh vertex and the camera
-            const bool occlusion = meshAABB.ray_intersection(GEO::Ray(gv + (vc * 0.00001), vc), 1.0);
-            if(occlusion)
-                continue;
-
-            vertexVisibility.push_back(camIndex);
+            zBuffers[camIndex - batchStart].reset(new MeshZBuffer(mesh, mp, camIndex, zBufferDownscale));
+        }
+
+        #pragma omp parallel for
+        for(int vi = 0; vi < mesh.pts.size(); ++vi)
+        {
+            const Point3d& v = mesh.pts[vi];
+            PointVisibility& vertexVisibility = out_ptsVisibilities[vi];
+
+            // Check by which camera the vertex is visible
+            for(int camIndex = batchStart; camIndex < batchEnd; ++camIndex)
+            {
+                const Point3d& c = mp.CArr[camIndex];
+
+                // check vertex normal (another solution would be to check each neighboring triangle)
+                const double angle = angleBetwV1andV2((c - v).normalize(), normalsPerVertex[vi]);
+                if(angle > 90.0)
+                    continue;
+
+                // check if the vertex is in the image and not hidden by the mesh
+                if(!zBuffers[camIndex - batchStart]->isPointVisible(v))
+                    continue;
+
+                vertexVisibility.push_back(camIndex);
+            }
         }
     }
+
+    ALICEVISION_LOG_INFO("remapMeshVisibility based on triangles normals done.");
 }
 
 } // namespace mesh
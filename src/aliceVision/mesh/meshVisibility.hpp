@@ -41,6 +41,13 @@ void remapMeshVisibilities_pullVerticesVisibility(const Mesh& refMesh, Mesh &mes
 */
 void remapMeshVisibilities_pushVerticesVisibilityToTriangles(const Mesh& refMesh, Mesh& mesh);
 
+/**
+ * @brief Compute the visibility per vertex from the mesh itself.
+ * A vertex is visible by a camera if its normal faces the camera and it is not hidden by the mesh in the camera z-buffer.
+ *
+ * @param[in] mp the multi-view parameters
+ * @param[in,out] mesh input mesh, its visibilities are updated
+ */
 void remapMeshVisibilities_meshItself(const mvsUtils::MultiViewParams& mp, Mesh& mesh);
 
 } // namespace mesh
@@ -41,6 +41,13 @@ public:
     return Square(KernelBase::error(sample, model));
   }
 
+  void errors(const ModelT_& model, std::vector<double>& errors) const override
+  {
+    KernelBase::errors(model, errors);
+    for(double& error : errors)
+      error = Square(error);
+  }
+
   void unnormalize(ModelT_& model) const override
   {
     // do nothing, no normalization in the angular case
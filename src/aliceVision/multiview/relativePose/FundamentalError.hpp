@@ -15,6 +15,21 @@ namespace aliceVision {
 namespace multiview {
 namespace relativePose {
 
+namespace detail {
+
+/**
+ * @brief Compute the epipolar lines F * x1 and F^t * x2 and the epipolar constraints x2^t * F * x1
+ *        of all the correspondences with matrix products over the packed points
+ */
+inline void epipolarLines(const Mat3& F, const Mat& x1, const Mat& x2, Mat3X& F_x, Mat3X& Ft_y, Eigen::ArrayXd& y_F_x)
+{
+  F_x = (F.leftCols<2>() * x1).colwise() + F.col(2);
+  Ft_y = (F.transpose().leftCols<2>() * x2).colwise() + F.row(2).transpose();
+  y_F_x = ((x2.array() * F_x.topRows<2>().array()).colwise().sum() + F_x.row(2).array()).transpose();
+}
+
+} // namespace detail
+
 /**
  * @brief Compute FundamentalSampsonError related to the Fundamental matrix and 2 correspondences
  */
@@ -31,6 +46,17 @@ struct FundamentalSampsonError : public ISolverErrorRelativePose<robustEstimatio
 
     return Square(y.dot(F_x)) / (  F_x.head<2>().squaredNorm() + Ft_y.head<2>().squaredNorm());
   }
+
+  void errors(const robustEstimation::Mat3Model& F, const Mat& x1, const Mat& x2, std::vector<double>& errors) const override
+  {
+    Mat3X F_x, Ft_y;
+    Eigen::ArrayXd y_F_x;
+    detail::epipolarLines(F.getMatrix(), x1, x2, F_x, Ft_y, y_F_x);
+
+    errors.resize(x1.cols());
+    Eigen::Map<Eigen::ArrayXd>(errors.data(), errors.size()) =
+      y_F_x.square() / (F_x.topRows<2>().colwise().squaredNorm() + Ft_y.topRows<2>().colwise().squaredNorm()).transpose().array();
+  }
 };
 
 struct FundamentalSymmetricEpipolarDistanceError: public ISolverErrorRelativePose<robustEstimation::Mat3Model>
@@ -47,6 +73,18 @@ struct FundamentalSymmetricEpipolarDistanceError: public ISolverErrorRelativePos
     // @note the divide by 4 is to make this match the Sampson distance.
     return Square(y.dot(F_x)) * ( 1.0 / F_x.head<2>().squaredNorm() + 1.0 / Ft_y.head<2>().squaredNorm()) / 4.0;
   }
+
+  void errors(const robustEstimation::Mat3Model& F, const Mat& x1, const Mat& x2, std::vector<double>& errors) const override
+  {
+    Mat3X F_x, Ft_y;
+    Eigen::ArrayXd y_F_x;
+    detail::epipolarLines(F.getMatrix(), x1, x2, F_x, Ft_y, y_F_x);
+
+    errors.resize(x1.cols());
+    Eigen::Map<Eigen::ArrayXd>(errors.data(), errors.size()) =
+      y_F_x.square() * (F_x.topRows<2>().colwise().squaredNorm().transpose().array().inverse() +
+                        Ft_y.topRows<2>().colwise().squaredNorm().transpose().array().inverse()) / 4.0;
+  }
 };
 
 struct FundamentalEpipolarDistanceError : public ISolverErrorRelativePose<robustEstimation::Mat3Model>
@@ -61,6 +99,24 @@ struct FundamentalEpipolarDistanceError : public ISolverErrorRelativePose<robust
 
     return Square(F_x.dot(y)) /  F_x.head<2>().squaredNorm();
   }
+
+  /**
+   * @brief The epipolar line of x1 in image 2: the error is the squared distance of x2 to this line
+   */
+  Vec3 transferLine(const robustEstimation::Mat3Model& F, const Vec2& x1) const
+  {
+    return F.getMatrix() * Vec3(x1(0), x1(1), 1.0);
+  }
+
+  void errors(const robustEstimation::Mat3Model& F, const Mat& x1, const Mat& x2, std::vector<double>& errors) const override
+  {
+    const Mat3X F_x = (F.getMatrix().leftCols<2>() * x1).colwise() + F.getMatrix().col(2);
+    const Eigen::ArrayXd y_F_x = ((x2.array() * F_x.topRows<2>().array()).colwise().sum() + F_x.row(2).array()).transpose();
+
+    errors.resize(x1.cols());
+    Eigen::Map<Eigen::ArrayXd>(errors.data(), errors.size()) =
+      y_F_x.square() / F_x.topRows<2>().colwise().squaredNorm().transpose().array();
+  }
 };
 
 
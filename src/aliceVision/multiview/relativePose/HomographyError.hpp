@@ -28,6 +28,25 @@ struct HomographyAsymmetricError : ISolverErrorRelativePose<robustEstimation::Ma
         const Vec2 x2_est = x2h_est.head<2>() / x2h_est[2];
         return (x2 - x2_est).squaredNorm();
     }
+
+    /**
+     * @brief The transfer of x1 in image 2: the error is the squared distance of x2 to this point
+     */
+    inline Vec2 transferPoint(const robustEstimation::Mat3Model& H, const Vec2& x1) const
+    {
+        const Vec3 x2h_est = H.getMatrix() * euclideanToHomogeneous(x1);
+        return x2h_est.head<2>() / x2h_est[2];
+    }
+
+    void errors(const robustEstimation::Mat3Model& H, const Mat& x1, const Mat& x2, std::vector<double>& errors) const override
+    {
+        // transfer all the points with one matrix product over the packed points
+        const Mat3X x2h_est = (H.getMatrix().leftCols<2>() * x1).colwise() + H.getMatrix().col(2);
+        const Mat2X x2_est = x2h_est.topRows<2>().array().rowwise() / x2h_est.row(2).array();
+
+        errors.resize(x1.cols());
+        Eigen::Map<Vec>(errors.data(), errors.size()) = (x2 - x2_est).colwise().squaredNorm().transpose();
+    }
 };
 
 }  // namespace relativePose
@@ -8,6 +8,8 @@
 
 #include <aliceVision/numeric/numeric.hpp>
 
+#include <vector>
+
 
 namespace aliceVision {
 namespace multiview {
@@ -20,6 +22,20 @@ template <typename ModelT>
 struct ISolverErrorRelativePose
 {
   virtual double error(const ModelT& model, const Vec2& x1, const Vec2& x2) const = 0;
+
+  /**
+   * @brief Compute the errors of all the correspondences at once
+   * @param[in] model The model to consider
+   * @param[in] x1 The points of the first image, one per column
+   * @param[in] x2 The corresponding points of the second image
+   * @param[out] errors The error of each correspondence
+   */
+  virtual void errors(const ModelT& model, const Mat& x1, const Mat& x2, std::vector<double>& errors) const
+  {
+    errors.resize(x1.cols());
+    for(Mat::Index i = 0; i < x1.cols(); ++i)
+      errors[i] = error(model, x1.col(i), x2.col(i));
+  }
 };
 
 }  // namespace relativePose
@@ -9,6 +9,7 @@
 #include <aliceVision/numeric/projection.hpp>
 #include <aliceVision/robustEstimation/ISolver.hpp>
 #include <aliceVision/multiview/relativePose/FundamentalKernel.hpp>
+#include <aliceVision/multiview/relativePose/HomographyError.hpp>
 
 #define BOOST_TEST_MODULE fundamentalKernelSolver
 #include <boost/test/unit_test.hpp>
@@ -133,3 +134,41 @@ BOOST_AUTO_TEST_CASE(NormalizedFundamental8PKernel_EasyCase)
 
   BOOST_CHECK(expectKernelProperties<relativePose::NormalizedFundamental8PKernel>(x1, x2));
 }
+
+// check that the batch errors over the packed points match the errors of each correspondence
+template<typename ErrorT>
+void expectBatchErrors(const robustEstimation::Mat3Model& model, const Mat& x1, const Mat& x2)
+{
+  const ErrorT errorEstimator;
+  std::vector<double> errors;
+  errorEstimator.errors(model, x1, x2, errors);
+
+  BOOST_REQUIRE_EQUAL(errors.size(), x1.cols());
+  for(std::size_t i = 0; i < errors.size(); ++i)
+    BOOST_CHECK_CLOSE(errors[i], errorEstimator.error(model, x1.col(i), x2.col(i)), 1e-8);
+}
+
+BOOST_AUTO_TEST_CASE(FundamentalError_BatchErrors)
+{
+  const Mat x1 = Mat::Random(2, 50) * 100.0;
+  const Mat x2 = Mat::Random(2, 50) * 100.0;
+
+  Mat3 F;
+  F << 0.1, -0.3, 2.0,
+       0.25, 0.05, -1.0,
+       -1.5, 0.8, 1.0;
+  const robustEstimation::Mat3Model model(F);
+
+  expectBatchErrors<relativePose::FundamentalSampsonError>(model, x1, x2);
+  expectBatchErrors<relativePose::FundamentalSymmetricEpipolarDistanceError>(model, x1, x2);
+  expectBatchErrors<relativePose::FundamentalEpipolarDistanceError>(model, x1, x2);
+  expectBatchErrors<relativePose::HomographyAsymmetricError>(model, x1, x2);
+
+  // the kernel errors are the batch errors
+  const relativePose::Fundamental8PKernel kernel(x1, x2);
+  std::vector<double> errors;
+  kernel.errors(model, errors);
+  BOOST_REQUIRE_EQUAL(errors.size(), x1.cols());
+  for(std::size_t i = 0; i < errors.size(); ++i)
+    BOOST_CHECK_CLOSE(errors[i], kernel.error(i, model), 1e-8);
+}
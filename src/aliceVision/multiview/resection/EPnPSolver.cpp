@@ -8,6 +8,8 @@
 #include "EPnPSolver.hpp"
 #include <aliceVision/numeric/projection.hpp>
 
+#include <limits>
+
 namespace aliceVision {
 namespace multiview {
 namespace resection {
@@ -18,23 +20,23 @@ namespace resection {
  * @param[out] xCentered
  * @param[out] xControlPoints
  */
-void selectControlPoints(const Mat3X& x3d, Mat* xCentered, Mat34* xControlPoints)
+void selectControlPoints(const Mat3X& x3d, Mat3X* xCentered, Mat34* xControlPoints)
 {
   const std::size_t nbPoints = x3d.cols();
 
   // the first virtual control point, C0, is the centroid.
-  Vec mean, variance;
-  MeanAndVarianceAlongRows(x3d, &mean, &variance);
+  const Vec3 mean = x3d.rowwise().mean();
   xControlPoints->col(0) = mean;
 
   // computes PCA
   xCentered->resize (3, nbPoints);
+  Mat3 xCenteredSQ = Mat3::Zero();
   for(std::size_t c = 0; c < nbPoints; ++c)
   {
     xCentered->col(c) = x3d.col (c) - mean;
+    xCenteredSQ += xCentered->col(c) * xCentered->col(c).transpose();
   }
 
-  Mat3 xCenteredSQ = (*xCentered) * xCentered->transpose();
   Eigen::JacobiSVD<Mat3> xCenteredSQsvd(xCenteredSQ, Eigen::ComputeFullU);
   const Vec3 w = xCenteredSQsvd.singularValues();
   const Mat3 u = xCenteredSQsvd.matrixU();
@@ -62,16 +64,13 @@ void computeBarycentricCoordinates(const Mat3X& xWorldCentered, const Mat34& xCo
     C2.col(c-1) = xControlPoints.col(c) - xControlPoints.col(0);
   }
 
-  Mat3 C2inv = C2.inverse();
-  Mat3X a = C2inv * xWorldCentered;
+  const Mat3 C2inv = C2.inverse();
 
   alphas->resize(4, nbPoints);
-  alphas->setZero();
-  alphas->block(1, 0, 3, nbPoints) = a;
-
   for(std::size_t c = 0; c < nbPoints; ++c)
   {
-    (*alphas)(0, c) = 1.0 - alphas->col(c).sum();
+    const Vec3 a = C2inv * xWorldCentered.col(c);
+    alphas->col(c) << 1.0 - a.sum(), a;
   }
 }
 
@@ -135,25 +134,23 @@ void absoluteOrientation(const Mat3X& X, const Mat3X& Xp, Mat3* R, Vec3* t)
   Vec3 C  = X.rowwise().sum() / nbPoints;   // centroid of X.
   Vec3 Cp = Xp.rowwise().sum() / nbPoints;  // centroid of Xp.
 
-  // normalize the two point sets.
-  Mat3X Xn(3, nbPoints), Xpn(3, nbPoints);
-
+  // cross-covariance of the normalized point sets.
+  Mat3 S = Mat3::Zero();
   for(int i = 0; i < nbPoints; ++i)
   {
-    Xn.col(i)  = X.col(i) - C;
-    Xpn.col(i) = Xp.col(i) - Cp;
+    S += (X.col(i) - C) * (Xp.col(i) - Cp).transpose();
   }
 
   // construct the N matrix (pg. 635).
-  const double Sxx = Xn.row(0).dot(Xpn.row(0));
-  const double Syy = Xn.row(1).dot(Xpn.row(1));
-  const double Szz = Xn.row(2).dot(Xpn.row(2));
-  const double Sxy = Xn.row(0).dot(Xpn.row(1));
-  const double Syx = Xn.row(1).dot(Xpn.row(0));
-  const double Sxz = Xn.row(0).dot(Xpn.row(2));
-  const double Szx = Xn.row(2).dot(Xpn.row(0));
-  const double Syz = Xn.row(1).dot(Xpn.row(2));
-  const double Szy = Xn.row(2).dot(Xpn.row(1));
+  const double Sxx = S(0, 0);
+  const double Syy = S(1, 1);
+  const double Szz = S(2, 2);
+  const double Sxy = S(0, 1);
+  const double Syx = S(1, 0);
+  const double Sxz = S(0, 2);
+  const double Szx = S(2, 0);
+  const double Syz = S(1, 2);
+  const double Szy = S(2, 1);
 
   Mat4 N;
   N << Sxx + Syy + Szz, Syz - Szy,        Szx - Sxz,        Sxy - Syx,
@@ -195,6 +192,24 @@ void absoluteOrientation(const Mat3X& X, const Mat3X& Xp, Mat3* R, Vec3* t)
   *t = Cp - *R * C;
 }
 
+/**
+ * @brief Root mean square reprojection error of the points with a pose, in normalized camera coordinates
+ * @param[in] x2d
+ * @param[in] x3d
+ * @param[in] R
+ * @param[in] t
+ */
+double poseReprojectionRMSE(const Mat2X& x2d, const Mat3X& x3d, const Mat3& R, const Vec3& t)
+{
+  double squaredErrors = 0.0;
+  for(Mat3X::Index c = 0; c < x3d.cols(); ++c)
+  {
+    const Vec3 xCamera = R * x3d.col(c) + t;
+    squaredErrors += (xCamera.hnormalized() - x2d.col(c)).squaredNorm();
+  }
+  return std::sqrt(squaredErrors / x3d.cols());
+}
+
 bool EPnPSolver::resection(const Mat2X& x2d, const Mat3X& x3d, Mat3* R, Vec3* t) const
 {
   assert(x2d.cols() == x3d.cols());
@@ -204,7 +219,7 @@ bool EPnPSolver::resection(const Mat2X& x2d, const Mat3X& x3d, Mat3* R, Vec3* t)
 
   // select the control points.
   Mat34 xControlPoints;
-  Mat xCentered;
+  Mat3X xCentered;
 
   selectControlPoints(x3d, &xCentered, &xControlPoints);
 
@@ -212,8 +227,9 @@ bool EPnPSolver::resection(const Mat2X& x2d, const Mat3X& x3d, Mat3* R, Vec3* t)
   Mat4X alphas(4, nbPoints);
   computeBarycentricCoordinates(xCentered, xControlPoints, &alphas);
 
-  // estimates the M matrix with the barycentric coordinates
-  Mat M(2 * nbPoints, 12);
+  // estimates the MtM matrix with the barycentric coordinates, M is not stored
+  Eigen::Matrix<double, 12, 12> MtM = Eigen::Matrix<double, 12, 12>::Zero();
+  Eigen::Matrix<double, 2, 12> M;
 
   for(std::size_t c = 0; c < nbPoints; ++c)
   {
@@ -224,19 +240,20 @@ bool EPnPSolver::resection(const Mat2X& x2d, const Mat3X& x3d, Mat3* R, Vec3* t)
     const double ui = x2d(0, c);
     const double vi = x2d(1, c);
 
-    M.block(2*c, 0, 2, 12) << a0, 0,
-                              a0*(-ui), a1, 0,
-                              a1*(-ui), a2, 0,
-                              a2*(-ui), a3, 0,
-                              a3*(-ui), 0,
-                              a0, a0*(-vi), 0,
-                              a1, a1*(-vi), 0,
-                              a2, a2*(-vi), 0,
-                              a3, a3*(-vi);
+    M << a0, 0,
+         a0*(-ui), a1, 0,
+         a1*(-ui), a2, 0,
+         a2*(-ui), a3, 0,
+         a3*(-ui), 0,
+         a0, a0*(-vi), 0,
+         a1, a1*(-vi), 0,
+         a2, a2*(-vi), 0,
+         a3, a3*(-vi);
+    MtM.noalias() += M.transpose() * M;
   }
 
   // @todo: avoid the transpose by rewriting the u2.block() calls.
-  Eigen::JacobiSVD<Mat> MtMsvd(M.transpose()*M, Eigen::ComputeFullU);
+  Eigen::JacobiSVD<Eigen::Matrix<double, 12, 12>> MtMsvd(MtM, Eigen::ComputeFullU);
   Eigen::Matrix<double, 12, 12> u2 = MtMsvd.matrixU().transpose();
 
   // estimate the L matrix.
@@ -285,8 +302,7 @@ bool EPnPSolver::resection(const Mat2X& x2d, const Mat3X& x3d, Mat3* R, Vec3* t)
                 dv4.row(r).dot(dv4.row(r));
   }
 
-  Vec rho;
-  rho.resize(6);
+  Vec6 rho;
   rho << (xControlPoints.col(0) - xControlPoints.col(1)).squaredNorm(),
          (xControlPoints.col(0) - xControlPoints.col(2)).squaredNorm(),
          (xControlPoints.col(0) - xControlPoints.col(3)).squaredNorm(),
@@ -296,11 +312,10 @@ bool EPnPSolver::resection(const Mat2X& x2d, const Mat3X& x3d, Mat3* R, Vec3* t)
 
   // there are three possible solutions based on the three approximations of L
   // (betas). below, each one is solved for then the best one is chosen.
-  Mat3X xCamera;
-  Mat3 K;  K.setIdentity();
-  std::vector<Mat3> Rs(3);
-  std::vector<Vec3> ts(3);
-  Vec rmse(3);
+  Mat3X xCamera(3, nbPoints);
+  Mat3 Rs[3];
+  Vec3 ts[3];
+  Vec3 rmse;
 
   bool bSol = false;
 
@@ -315,7 +330,7 @@ bool EPnPSolver::resection(const Mat2X& x2d, const Mat3X& x3d, Mat3* R, Vec3* t)
     l_6x4.row(r) << L(r, 0), L(r, 1), L(r, 3), L(r, 6);
   }
 
-  Eigen::JacobiSVD<Mat> svd_of_l4(l_6x4, Eigen::ComputeFullU | Eigen::ComputeFullV);
+  Eigen::JacobiSVD<Eigen::Matrix<double, 6, 4>> svd_of_l4(l_6x4, Eigen::ComputeFullU | Eigen::ComputeFullV);
   Vec4 b4 = svd_of_l4.solve(rho);
 
   if((l_6x4 * b4).isApprox(rho, 1e-3))
@@ -329,7 +344,7 @@ bool EPnPSolver::resection(const Mat2X& x2d, const Mat3X& x3d, Mat3* R, Vec3* t)
     betas << b4(0), b4(1) / b4(0), b4(2) / b4(0), b4(3) / b4(0);
     computePointsCoordinatesInCameraFrame(alphas, betas, u2, &xCamera);
     absoluteOrientation(x3d, xCamera, &Rs[0], &ts[0]);
-    rmse(0) = reprojectionErrorRMSE(x2d, x3d, K, Rs[0], ts[0]);
+    rmse(0) = poseReprojectionRMSE(x2d, x3d, Rs[0], ts[0]);
     bSol = true;
   }
   else
@@ -345,7 +360,7 @@ bool EPnPSolver::resection(const Mat2X& x2d, const Mat3X& x3d, Mat3* R, Vec3* t)
   betas.setZero();
   Eigen::Matrix<double, 6, 3> l_6x3;
   l_6x3 = L.block(0, 0, 6, 3);
-  Eigen::JacobiSVD<Mat> svdOfL3(l_6x3, Eigen::ComputeFullU | Eigen::ComputeFullV);
+  Eigen::JacobiSVD<Eigen::Matrix<double, 6, 3>> svdOfL3(l_6x3, Eigen::ComputeFullU | Eigen::ComputeFullV);
   Vec3 b3 = svdOfL3.solve(rho);
 
   if((l_6x3 * b3).isApprox(rho, 1e-3))
@@ -368,7 +383,7 @@ bool EPnPSolver::resection(const Mat2X& x2d, const Mat3X& x3d, Mat3* R, Vec3* t)
     betas(3) = 0;
     computePointsCoordinatesInCameraFrame(alphas, betas, u2, &xCamera);
     absoluteOrientation(x3d, xCamera, &Rs[1], &ts[1]);
-    rmse(1) = reprojectionErrorRMSE(x2d, x3d, K, Rs[1], ts[1]);
+    rmse(1) = poseReprojectionRMSE(x2d, x3d, Rs[1], ts[1]);
     bSol = true;
   }
   else
@@ -384,8 +399,8 @@ bool EPnPSolver::resection(const Mat2X& x2d, const Mat3X& x3d, Mat3* R, Vec3* t)
   betas.setZero();
   Eigen::Matrix<double, 6, 5> l_6x5;
   l_6x5 = L.block(0, 0, 6, 5);
-  Eigen::JacobiSVD<Mat> svdOfL5(l_6x5, Eigen::ComputeFullU | Eigen::ComputeFullV);
-  Vec b5 = svdOfL5.solve(rho);
+  Eigen::JacobiSVD<Eigen::Matrix<double, 6, 5>> svdOfL5(l_6x5, Eigen::ComputeFullU | Eigen::ComputeFullV);
+  Eigen::Matrix<double, 5, 1> b5 = svdOfL5.solve(rho);
 
   if((l_6x5 * b5).isApprox(rho, 1e-3))
   {
@@ -424,7 +439,7 @@ bool EPnPSolver::resection(const Mat2X& x2d, const Mat3X& x3d, Mat3* R, Vec3* t)
     betas(3) = 0;
     computePointsCoordinatesInCameraFrame(alphas, betas, u2, &xCamera);
     absoluteOrientation(x3d, xCamera, &Rs[2], &ts[2]);
-    rmse(2) = reprojectionErrorRMSE(x2d, x3d, K, Rs[2], ts[2]);
+    rmse(2) = poseReprojectionRMSE(x2d, x3d, Rs[2], ts[2]);
     bSol = true;
   }
   else
@@ -77,10 +77,8 @@ void solveQuartic(const Vec5& factors, Vec4& realRoots)
  * @return true if correct execution, false if world points aligned
  * @author: Laurent Kneip, adapted to the project by Pierre Moulon
  */
-bool computeP3PPoses(const Mat3& featureVectors, const Mat3& worldPoints, Mat& solutions)
+bool computeP3PPoses(const Mat3& featureVectors, const Mat3& worldPoints, Eigen::Matrix<double, 3, 16>& solutions)
 {
-  solutions = Mat(3, 4 * 4);
-
   // extraction of world points
 
   Vec3 P1 = worldPoints.col(0);
@@ -256,11 +254,16 @@ void P3PSolver::solve(const Mat& x2d, const Mat& x3d, std::vector<robustEstimati
   assert(3 == x3d.rows());
   assert(x2d.cols() == x3d.cols());
 
+  solveFixed(x2d, x3d, models);
+}
+
+void P3PSolver::solveFixed(const FixedX1& x2d, const FixedX2& x3d, std::vector<robustEstimation::Mat34Model>& models) const
+{
   Mat3 R;
   Vec3 t;
   Mat34 P;
 
-  Mat solutions = Mat(3, 16);
+  Eigen::Matrix<double, 3, 16> solutions;
 
   Mat3 pt2D_3x3;
   pt2D_3x3.block<2, 3>(0, 0) = x2d;
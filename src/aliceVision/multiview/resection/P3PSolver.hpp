@@ -20,6 +20,10 @@ class P3PSolver : public robustEstimation::ISolver<robustEstimation::Mat34Model>
 {
 public:
 
+  /// the fixed-size points of the minimal problem
+  using FixedX1 = Mat23;
+  using FixedX2 = Mat3;
+
   /**
    * @brief Return the minimum number of required samples
    * @return minimum number of required samples
@@ -47,6 +51,15 @@ public:
    */
    void solve(const Mat& x2d, const Mat& x3d, std::vector<robustEstimation::Mat34Model>& models) const override;
 
+   /**
+    * @brief Solve the problem of camera pose without heap allocation.
+    *
+    * @param[in] x2d The 3 2d points in the first image. One per column.
+    * @param[in] x3d The 3 corresponding 3d points in the second image. One per column.
+    * @param[out] models A list of at most 4 candidate solutions.
+    */
+   void solveFixed(const FixedX1& x2d, const FixedX2& x3d, std::vector<robustEstimation::Mat34Model>& models) const;
+
    /**
     * @brief Solve the problem.
     *
@@ -1066,12 +1066,11 @@ void computeP4pfPoses(const double *glab, const double *a1, const double *b1, co
  * @brief isNan
  * @param[in] A matrix
  */
-bool isNan(const Eigen::MatrixXcd &A)
+bool isNan(const Eigen::Matrix<std::complex<double>, 4, 10> &A)
 {
-  const Mat B = A.real();
-  for(Mat::Index i = 0; i < B.cols() * B.rows(); ++i)
+  for(Eigen::Index i = 0; i < A.size(); ++i)
   {
-    if(std::isnan(B.data()[i])) return true;
+    if(std::isnan(A.data()[i].real())) return true;
   }
   return false;
 }
@@ -1081,17 +1080,15 @@ bool isNan(const Eigen::MatrixXcd &A)
  * @param[in] sol
  * @param[out] vSol
  */
-bool validSol(const Eigen::MatrixXcd &sol, Mat &vSol)
+bool validSol(const Eigen::Matrix<std::complex<double>, 4, 10> &sol, Eigen::Matrix<double, 4, Eigen::Dynamic, Eigen::ColMajor, 4, 10> &vSol)
 {
-  assert(sol.cols() == 10 && sol.rows() == 4);
-
-  Mat imSol = sol.imag();
-  Mat reSol = sol.real();
-  std::vector<Mat::Index> correct;
-  for(Mat::Index i = 0; i < 10; ++i)
+  const Eigen::Matrix<double, 4, 10> imSol = sol.imag();
+  const Eigen::Matrix<double, 4, 10> reSol = sol.real();
+  vSol.resize(4, 0);
+  for(Eigen::Index i = 0; i < 10; ++i)
   {
     bool isReal = true;
-    for(Mat::Index j = 0; j < 4; ++j)
+    for(Eigen::Index j = 0; j < 4; ++j)
     {
       if(imSol(j, i) != 0)
       {
@@ -1101,22 +1098,11 @@ bool validSol(const Eigen::MatrixXcd &sol, Mat &vSol)
     }
     if(isReal && reSol(3, i) > 0)
     {
-      correct.push_back(i);
-    }
-  }
-  if(correct.empty())
-  {
-    return false;
-  }
-  else
-  {
-    vSol = Mat(4, correct.size());
-    for(std::size_t i = 0; i < correct.size(); ++i)
-    {
-      vSol.block(0, i, 4, 1) = reSol.block(0, correct.at(i), 4, 1);
+      vSol.conservativeResize(4, vSol.cols() + 1);
+      vSol.col(vSol.cols() - 1) = reSol.col(i);
     }
   }
-  return true;
+  return vSol.cols() > 0;
 }
 
 /**
@@ -1126,30 +1112,27 @@ bool validSol(const Eigen::MatrixXcd &sol, Mat &vSol)
  * @param[out] R
  * @param[out] t
  */
-void getRigidTransform(const Mat &pp1, const Mat &pp2, Mat &R, Vec3 &t)
+void getRigidTransform(const Mat34 &pp1, const Mat34 &pp2, Mat3 &R, Vec3 &t)
 {
-  Mat p1(pp1);
-  Mat p2(pp2);
+  Mat34 p1(pp1);
+  Mat34 p2(pp2);
 
   // shift centers of gravity to the origin
-  const Mat p1mean = p1.rowwise().sum() * 0.25;
-  const Mat p2mean = p2.rowwise().sum() * 0.25;
-  for(Mat::Index i = 0; i < 4; i++)
-  {
-    p1.block(0, i, 3, 1) -= p1mean;
-    p2.block(0, i, 3, 1) -= p2mean;
-  }
+  const Vec3 p1mean = p1.rowwise().sum() * 0.25;
+  const Vec3 p2mean = p2.rowwise().sum() * 0.25;
+  p1.colwise() -= p1mean;
+  p2.colwise() -= p2mean;
 
   // normalize to unit size
-  const Mat u1 = p1 * p1.colwise().norm().cwiseInverse().asDiagonal();
-  const Mat u2 = p2 * p2.colwise().norm().cwiseInverse().asDiagonal();
+  const Mat34 u1 = p1 * p1.colwise().norm().cwiseInverse().asDiagonal();
+  const Mat34 u2 = p2 * p2.colwise().norm().cwiseInverse().asDiagonal();
 
   // calc rotation
-  const Mat C = u2 * u1.transpose();
-  Eigen::JacobiSVD<Mat> svd(C, Eigen::ComputeThinU | Eigen::ComputeThinV);
-  const Mat U = svd.matrixU();
-  const Mat V = svd.matrixV();
-  Mat S = svd.singularValues();
+  const Mat3 C = u2 * u1.transpose();
+  Eigen::JacobiSVD<Mat3> svd(C, Eigen::ComputeFullU | Eigen::ComputeFullV);
+  const Mat3 U = svd.matrixU();
+  const Mat3 V = svd.matrixV();
+  Vec3 S = svd.singularValues();
 
   // fit to rotation space
   S(0) = (S(0) >= 0 ? 1 : -1);
@@ -1162,16 +1145,21 @@ void getRigidTransform(const Mat &pp1, const Mat &pp2, Mat &R, Vec3 &t)
 
 void P4PfSolver::solve(const Mat& x2d, const Mat& x3d, std::vector<P4PfModel>& models) const
 {
-  Mat pt2D(x2d);
-  Mat pt3D(x3d);
+  assert(2 == x2d.rows());
+  assert(3 == x3d.rows());
+  assert(x2d.cols() == x3d.cols());
+
+  solveFixed(x2d, x3d, models);
+}
 
-  assert(2 == pt2D.rows());
-  assert(3 == pt3D.rows());
-  assert(pt2D.cols() == pt3D.cols());
+void P4PfSolver::solveFixed(const FixedX1& x2d, const FixedX2& x3d, std::vector<P4PfModel>& models) const
+{
+  FixedX1 pt2D(x2d);
+  FixedX2 pt3D(x3d);
 
   const Vec3 mean3d = pt3D.rowwise().mean();
 
-  pt3D -= (mean3d * Mat::Constant(1, 4, 1.0));
+  pt3D.colwise() -= mean3d;
 
   const double var = pt3D.colwise().norm().sum() / 4;
   const double var2d = pt2D.colwise().norm().sum() / 4;
@@ -1191,7 +1179,7 @@ void P4PfSolver::solve(const Mat& x2d, const Mat& x3d, std::vector<P4PfModel>& m
   if(glab * glac * glad * glbc * glbd * glcd < tol)
     return;
 
-  Mat A = Mat::Zero(10, 10);
+  Eigen::Matrix<double, 10, 10> A = Eigen::Matrix<double, 10, 10>::Zero();
   {
     const double gl[] = {glab, glac, glad, glbc, glbd, glcd};
     const double *a1 = pt2D.col(0).data();
@@ -1202,13 +1190,11 @@ void P4PfSolver::solve(const Mat& x2d, const Mat& x3d, std::vector<P4PfModel>& m
     computeP4pfPoses(gl, a1, b1, c1, d1, A.data());
   }
 
-  Mat vSol;
+  Eigen::Matrix<double, 4, Eigen::Dynamic, Eigen::ColMajor, 4, 10> vSol;
   {
-    Eigen::EigenSolver<Mat> es(A.transpose());
-    Eigen::MatrixXcd sol = es.eigenvectors();
-    Eigen::MatrixXcd diag = sol.row(0).cwiseInverse().asDiagonal();
-
-    sol = sol.block(1, 0, 4, 10) * diag;
+    Eigen::EigenSolver<Eigen::Matrix<double, 10, 10>> es(A.transpose());
+    const Eigen::Matrix<std::complex<double>, 10, 10> eigenvectors = es.eigenvectors();
+    const Eigen::Matrix<std::complex<double>, 4, 10> sol = eigenvectors.block<4, 10>(1, 0) * eigenvectors.row(0).cwiseInverse().asDiagonal();
 
     // contain at least one NaN
     if(isNan(sol))
@@ -1220,7 +1206,7 @@ void P4PfSolver::solve(const Mat& x2d, const Mat& x3d, std::vector<P4PfModel>& m
   }
 
   // recover camera rotation and translation
-  for(Mat::Index i = 0; i < vSol.cols(); ++i)
+  for(Eigen::Index i = 0; i < vSol.cols(); ++i)
   {
     const double f = sqrt(vSol(3, i));
     const double zd = vSol(0, i);
@@ -1228,19 +1214,19 @@ void P4PfSolver::solve(const Mat& x2d, const Mat& x3d, std::vector<P4PfModel>& m
     const double zb = vSol(2, i);
 
     // create p3d points in a camera coordinate system(using depths)
-    Mat p3dc = Mat(3, 4);
+    Mat34 p3dc;
     p3dc << pt2D(0, 0), zb * pt2D(0, 1), zc * pt2D(0, 2), zd * pt2D(0, 3),
             pt2D(1, 0), zb * pt2D(1, 1), zc * pt2D(1, 2), zd * pt2D(1, 3),
             f, zb * f, zc * f, zd * f;
 
     // fix scale(recover 'za')
-    Mat d = Mat(6, 1);
-    d(0, 0) = sqrt(glab / (p3dc.col(0) - p3dc.col(1)).squaredNorm());
-    d(1, 0) = sqrt(glac / (p3dc.col(0) - p3dc.col(2)).squaredNorm());
-    d(2, 0) = sqrt(glad / (p3dc.col(0) - p3dc.col(3)).squaredNorm());
-    d(3, 0) = sqrt(glbc / (p3dc.col(1) - p3dc.col(2)).squaredNorm());
-    d(4, 0) = sqrt(glbd / (p3dc.col(1) - p3dc.col(3)).squaredNorm());
-    d(5, 0) = sqrt(glcd / (p3dc.col(2) - p3dc.col(3)).squaredNorm());
+    Vec6 d;
+    d(0) = sqrt(glab / (p3dc.col(0) - p3dc.col(1)).squaredNorm());
+    d(1) = sqrt(glac / (p3dc.col(0) - p3dc.col(2)).squaredNorm());
+    d(2) = sqrt(glad / (p3dc.col(0) - p3dc.col(3)).squaredNorm());
+    d(3) = sqrt(glbc / (p3dc.col(1) - p3dc.col(2)).squaredNorm());
+    d(4) = sqrt(glbd / (p3dc.col(1) - p3dc.col(3)).squaredNorm());
+    d(5) = sqrt(glcd / (p3dc.col(2) - p3dc.col(3)).squaredNorm());
     // all d(i) should be equal...
 
     //gta = median(d);
@@ -1248,7 +1234,7 @@ void P4PfSolver::solve(const Mat& x2d, const Mat& x3d, std::vector<P4PfModel>& m
     p3dc = gta * p3dc;
 
     // calc camera
-    Mat Rr;
+    Mat3 Rr;
     Vec3 tt;
     getRigidTransform(pt3D, p3dc, Rr, tt);
     const Vec3 t = var * tt - Rr * mean3d;
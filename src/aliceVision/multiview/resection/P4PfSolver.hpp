@@ -19,7 +19,7 @@ namespace resection {
  */
 struct P4PfModel
 {
-  P4PfModel(Mat R, Vec3 t, double f)
+  P4PfModel(const Mat3& R, const Vec3& t, double f)
     : _R(R)
     , _t(t)
     , _f(f)
@@ -28,7 +28,7 @@ struct P4PfModel
   Mat34 getP() const
   {
     Mat34 P;
-    Mat K = Mat(3, 3);
+    Mat3 K;
 
     K << _f, 0, 0,
          0, _f, 0,
@@ -41,7 +41,7 @@ struct P4PfModel
   }
 
   /// rotation matrix
-  Mat _R;
+  Mat3 _R;
   /// translation vector
   Vec3 _t;
   /// focal length
@@ -73,6 +73,10 @@ class P4PfSolver : public robustEstimation::ISolver<P4PfModel>
 {
 public:
 
+  /// the fixed-size points of the minimal problem
+  using FixedX1 = Eigen::Matrix<double, 2, 4>;
+  using FixedX2 = Mat34;
+
   /**
    * @brief Return the minimum number of required samples
    * @return minimum number of required samples
@@ -101,6 +105,14 @@ public:
    */
   void solve(const Mat& x2d, const Mat& x3d, std::vector<P4PfModel>& models)  const override;
 
+  /**
+   * @brief Solve the problem of camera pose without heap allocation.
+   * @param[in] x2d featureVectors 2 x 4 matrix with feature vectors with subtracted principal point (each column is a vector)
+   * @param[in] x3d worldPoints 3 x 4 matrix with corresponding 3D world points (each column is a point)
+   * @param[out] models the solutions, see solve()
+   */
+  void solveFixed(const FixedX1& x2d, const FixedX2& x3d, std::vector<P4PfModel>& models) const;
+
   /**
    * @brief Solve the problem.
    *
@@ -16,6 +16,21 @@ namespace aliceVision {
 namespace multiview {
 namespace resection {
 
+namespace detail {
+
+/**
+ * @brief Compute the squared projection distances of all the correspondences
+ *        with one matrix product over the packed points
+ */
+inline Vec projectionSquaredDistances(const Mat34& P, const Mat& x2d, const Mat& x3d)
+{
+  const Mat3X x = (P.leftCols<3>() * x3d).colwise() + P.col(3);
+  const Mat2X projected = x.topRows<2>().array().rowwise() / x.row(2).array();
+  return (projected - x2d).colwise().squaredNorm().transpose();
+}
+
+} // namespace detail
+
 /**
  * @brief Compute the residual of the projection distance
  *        (pt2D, project(P,pt3D))
@@ -26,6 +41,12 @@ struct ProjectionDistanceError : public ISolverErrorResection<robustEstimation::
   {
     return (project(P.getMatrix(), p3d) - p2d).norm();
   }
+
+  void errors(const robustEstimation::Mat34Model& P, const Mat& x2d, const Mat& x3d, std::vector<double>& errors) const override
+  {
+    errors.resize(x2d.cols());
+    Eigen::Map<Vec>(errors.data(), errors.size()) = detail::projectionSquaredDistances(P.getMatrix(), x2d, x3d).cwiseSqrt();
+  }
 };
 
 /**
@@ -38,6 +59,12 @@ struct ProjectionDistanceSquaredError : public ISolverErrorResection<robustEstim
   {
     return (project(P.getMatrix(), p3d) - p2d).squaredNorm();
   }
+
+  void errors(const robustEstimation::Mat34Model& P, const Mat& x2d, const Mat& x3d, std::vector<double>& errors) const override
+  {
+    errors.resize(x2d.cols());
+    Eigen::Map<Vec>(errors.data(), errors.size()) = detail::projectionSquaredDistances(P.getMatrix(), x2d, x3d);
+  }
 };
 
 }  // namespace resection
@@ -7,6 +7,9 @@
 
 #include "l1.hpp"
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <Eigen/SparseCholesky>
 
 #ifdef ALICEVISION_ROTATION_AVERAGING_WITH_BOOST
 #include <boost/graph/adjacency_list.hpp>
@@ -44,6 +47,22 @@ namespace aliceVision   {
 namespace rotationAveraging  {
 namespace l1  {
 
+// The normal equations At*W*A of the solvers below are factorized with a dense Cholesky
+// for the dense matrices and with a sparse Cholesky for the sparse ones, the latter
+// keeping the memory and the time linear in the number of views for the sparse view graphs.
+template<typename MATRIX_TYPE>
+struct NormalEquations
+{
+  typedef Eigen::Matrix<REAL, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> Matrix;
+  typedef Eigen::LDLT<Matrix> Solver;
+};
+template<>
+struct NormalEquations<Eigen::SparseMatrix<REAL, Eigen::ColMajor> >
+{
+  typedef Eigen::SparseMatrix<REAL, Eigen::ColMajor> Matrix;
+  typedef Eigen::SimplicialLDLT<Matrix> Solver;
+};
+
 // Minimum l1 error approximation:
 //
 // Let A be a M x N matrix with full rank. Given y of R^M, the problem
@@ -67,7 +86,6 @@ inline bool TRobustRegressionL1PD(
   Eigen::Matrix<REAL, Eigen::Dynamic, 1>& xp,
   REAL pdtol, unsigned pdmaxiter)
 {
-  typedef Eigen::Matrix<REAL, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> Matrix;
   typedef Eigen::Matrix<REAL, Eigen::Dynamic, 1> Vector;
   const unsigned M = (unsigned)y.size();
   const unsigned N = (unsigned)xp.size();
@@ -100,7 +118,8 @@ inline bool TRobustRegressionL1PD(
   Vector w2(M), sig1(M), sig2(M), sigx(M), dx(N), up(N), Atdv(N);
   Vector Axp(M), Atvp(M);
   Vector &Adx(sigx), &du(w2), &w1p(dx);
-  Matrix H11p(N,N);
+  typename NormalEquations<MATRIX_TYPE>::Matrix H11p(N,N);
+  typename NormalEquations<MATRIX_TYPE>::Solver H11pSolver;
   Vector &dlamu1(tmpM3), &dlamu2(tmpM4);
   for (unsigned pditer=0; pditer<pdmaxiter; ++pditer) {
     // surrogate duality gap
@@ -131,7 +150,13 @@ inline bool TRobustRegressionL1PD(
     w1p = At*(tmpM4 - tmpM3 - (sig2.cwiseQuotient(sig1).cwiseProduct(w2)));
 
     // optimized solver as A is positive definite and symmetric
-    dx = H11p.ldlt().solve(w1p);
+    H11pSolver.compute(H11p);
+    if (H11pSolver.info() != Eigen::Success) {
+      //("error: decomposing linear system failed, returning last iterate");
+      xp = x;
+      return false;
+    }
+    dx = H11pSolver.solve(w1p);
 
     Adx = A*dx;
 
@@ -232,7 +257,6 @@ inline bool TIterativelyReweightedLeastSquares(
   Eigen::Matrix<REAL, Eigen::Dynamic, 1>& x,
   REAL sigma, REAL eps)
 {
-  typedef Eigen::Matrix<REAL, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> Matrix;
   typedef Eigen::Matrix<REAL, Eigen::Dynamic, 1> Vector;
   const unsigned m = (unsigned)b.size();
   const unsigned n = (unsigned)x.size();
@@ -243,6 +267,7 @@ inline bool TIterativelyReweightedLeastSquares(
   const REAL sigmaSq(Square(sigma));
   unsigned iter = 0;
   REAL delta = std::numeric_limits<REAL>::max(), deltap;
+  typename NormalEquations<MATRIX_TYPE>::Solver solver;
   do {
     xp = x;
     // compute error vector
@@ -255,7 +280,7 @@ inline bool TIterativelyReweightedLeastSquares(
     }
     // solve the linear system using l2 norm
     const MATRIX_TYPE AtF(A.transpose()*e.asDiagonal());
-    const Eigen::LDLT<Matrix> solver(AtF*A); // compute the Cholesky decomposition
+    solver.compute(typename NormalEquations<MATRIX_TYPE>::Matrix(AtF*A)); // compute the Cholesky decomposition
     if (solver.info() != Eigen::Success) {
       ALICEVISION_LOG_WARNING("error: decomposing linear system failed");
       return false;
@@ -605,7 +630,8 @@ inline void _FillErrorMatrix(
   const Matrix3x3Arr& Rs,
   Eigen::Matrix<REAL,Eigen::Dynamic,1>& b)
 {
-  for (size_t r = 0; r < RelRs.size(); ++r) {
+  #pragma omp parallel for
+  for (int r = 0; r < (int)RelRs.size(); ++r) {
     const RelativeRotation& relR = RelRs[r];
     const Matrix3x3& Ri = Rs[relR.i];
     const Matrix3x3& Rj = Rs[relR.j];
@@ -315,6 +315,78 @@ BOOST_AUTO_TEST_CASE ( rotationAveraging_RefineRotationsAvgL1IRLS_CompleteGraph_
   }
 }
 
+// The sparse normal equations of the L1RA and IRLS solvers are factorized with a sparse Cholesky,
+// they must give the same solutions as the dense normal equations
+BOOST_AUTO_TEST_CASE ( rotationAveraging_RegressionDenseSparse)
+{
+  makeRandomOperationsReproducible();
+
+  typedef Eigen::Matrix<REAL, Eigen::Dynamic, Eigen::Dynamic> Matrix;
+  typedef Eigen::SparseMatrix<REAL, Eigen::ColMajor> SparseMatrix;
+  typedef Eigen::Matrix<REAL, Eigen::Dynamic, 1> Vector;
+
+  // a view graph: a loop of views and some random edges,
+  // each edge gives 3 rows x_j - x_i and the first view is fixed by 3 more rows
+  const int nbViews = 30;
+  std::vector<std::pair<int, int>> edges;
+  for (int i = 0; i < nbViews; ++i)
+    edges.emplace_back(i, (i + 1) % nbViews);
+  for (int i = 0; i < 2 * nbViews; ++i)
+  {
+    const int a = rand() % nbViews;
+    const int b = rand() % nbViews;
+    if (a != b)
+      edges.emplace_back(a, b);
+  }
+
+  const int m = 3 * (edges.size() + 1);
+  const int n = 3 * nbViews;
+  std::vector<Eigen::Triplet<REAL>> coefficients;
+  for (std::size_t e = 0; e < edges.size(); ++e)
+  {
+    for (int k = 0; k < 3; ++k)
+    {
+      coefficients.emplace_back(3 * e + k, 3 * edges[e].first + k, REAL(-1));
+      coefficients.emplace_back(3 * e + k, 3 * edges[e].second + k, REAL(1));
+    }
+  }
+  for (int k = 0; k < 3; ++k)
+    coefficients.emplace_back(3 * edges.size() + k, k, REAL(1));
+
+  SparseMatrix sparseA(m, n);
+  sparseA.setFromTriplets(coefficients.begin(), coefficients.end());
+  const Matrix denseA(sparseA);
+
+  // the measurements of the ground truth, with noise and 10% of outliers
+  Vector x0 = Vector::Random(n);
+  x0.head(3).setZero();
+  Vector b = sparseA * x0 + 1e-3 * Vector::Random(m);
+  for (int i = 0; i < m / 10; ++i)
+    b(rand() % (m - 3)) = Vector::Random(1)(0);
+
+  // L1RA, from the least squares solution as in RefineRotationsAvgL1IRLS
+  const Vector leastSquaresX = (denseA.transpose() * denseA).ldlt().solve(denseA.transpose() * b);
+  {
+    Vector denseX = leastSquaresX;
+    Vector sparseX = leastSquaresX;
+    BOOST_CHECK(RobustRegressionL1PD(denseA, b, denseX));
+    BOOST_CHECK(RobustRegressionL1PD(sparseA, b, sparseX));
+    EXPECT_MATRIX_NEAR(denseX, sparseX, 1e-8);
+    BOOST_TEST_MESSAGE("least squares error: " << (leastSquaresX - x0).norm() << ", L1 error: " << (denseX - x0).norm());
+    // the outliers are down-weighted
+    BOOST_CHECK_LT((denseX - x0).norm(), (leastSquaresX - x0).norm());
+  }
+
+  // IRLS
+  {
+    Vector denseX = Vector::Zero(n);
+    Vector sparseX = Vector::Zero(n);
+    BOOST_CHECK(IterativelyReweightedLeastSquares(denseA, b, denseX, REAL(0.1)));
+    BOOST_CHECK(IterativelyReweightedLeastSquares(sparseA, b, sparseX, REAL(0.1)));
+    EXPECT_MATRIX_NEAR(denseX, sparseX, 1e-8);
+  }
+}
+
 /*
 template<typename TYPE, int N>
 inline REAL ComputePSNR(const Eigen::Matrix<REAL, N,1>& x0, const Eigen::Matrix<REAL, N,1>& x)
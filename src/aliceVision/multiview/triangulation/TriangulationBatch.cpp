@@ -0,0 +1,146 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "TriangulationBatch.hpp"
+
+#include <Eigen/Eigenvalues>
+
+#include <cmath>
+
+namespace aliceVision {
+namespace multiview {
+
+std::size_t TriangulationBatch::addCamera(const Mat34& P, const Mat3& R, const Vec3& center)
+{
+  Camera camera;
+  camera.P = P;
+  camera.invKR = P.block<3, 3>(0, 0).inverse();
+  camera.center = center;
+  camera.axis = R.row(2).transpose();
+  cameras.push_back(camera);
+  return cameras.size() - 1;
+}
+
+void TriangulationBatch::clearPoints()
+{
+  observationOffsets.assign(1, 0);
+  observationCameras.clear();
+  observationPoints.clear();
+}
+
+void TriangulationBatch::triangulateDLT(std::vector<Vec3>& X) const
+{
+  X.resize(nbPoints());
+
+#pragma omp parallel for schedule(dynamic, 256)
+  for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(nbPoints()); ++i)
+  {
+    if(nbObservations(i) < 2)
+    {
+      X[i].setZero();
+      continue;
+    }
+
+    // normal matrix of the design matrix (two rows per observation)
+    Mat4 AtA = Mat4::Zero();
+    for(std::size_t o = observationOffsets[i]; o < observationOffsets[i + 1]; ++o)
+    {
+      const Mat34& P = cameras[observationCameras[o]].P;
+      const Vec2& x = observationPoints[o];
+
+      const Vec4 row0 = x(0) * P.row(2) - P.row(0);
+      const Vec4 row1 = x(1) * P.row(2) - P.row(1);
+      AtA.selfadjointView<Eigen::Lower>().rankUpdate(row0 / row0.norm());
+      AtA.selfadjointView<Eigen::Lower>().rankUpdate(row1 / row1.norm());
+    }
+
+    // eigen values are sorted in increasing order
+    const Eigen::SelfAdjointEigenSolver<Mat4> solver(AtA);
+    const Vec4 XHomogeneous = solver.eigenvectors().col(0);
+    X[i] = XHomogeneous.head<3>() / XHomogeneous(3);
+  }
+}
+
+void TriangulationBatch::triangulateMidpoint(std::vector<Vec3>& X) const
+{
+  X.resize(nbPoints());
+
+#pragma omp parallel for schedule(dynamic, 256)
+  for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(nbPoints()); ++i)
+  {
+    if(nbObservations(i) < 2)
+    {
+      X[i].setZero();
+      continue;
+    }
+
+    // sum of the projections orthogonal to each ray
+    Mat3 A = Mat3::Zero();
+    Vec3 b = Vec3::Zero();
+    for(std::size_t o = observationOffsets[i]; o < observationOffsets[i + 1]; ++o)
+    {
+      const Camera& camera = cameras[observationCameras[o]];
+      const Vec3 ray = (camera.invKR * observationPoints[o].homogeneous()).normalized();
+      const Mat3 orthogonal = Mat3::Identity() - ray * ray.transpose();
+      A += orthogonal;
+      b += orthogonal * camera.center;
+    }
+    X[i] = A.ldlt().solve(b);
+  }
+}
+
+void TriangulationBatch::checkChieralities(const std::vector<Vec3>& X, std::vector<char>& valid) const
+{
+  assert(X.size() == nbPoints());
+  valid.resize(nbPoints(), true);
+
+#pragma omp parallel for schedule(dynamic, 256)
+  for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(nbPoints()); ++i)
+  {
+    for(std::size_t o = observationOffsets[i]; o < observationOffsets[i + 1]; ++o)
+    {
+      const Camera& camera = cameras[observationCameras[o]];
+      if(camera.axis.dot(X[i] - camera.center) < 0)
+      {
+        valid[i] = false;
+        break;
+      }
+    }
+  }
+}
+
+void TriangulationBatch::checkAngles(const std::vector<Vec3>& X, double minAngle, std::vector<char>& valid) const
+{
+  assert(X.size() == nbPoints());
+  valid.resize(nbPoints(), true);
+
+  // compare the cosines to avoid an acos per pair of rays
+  const double maxCosAngle = std::cos(degreeToRadian(minAngle));
+
+#pragma omp parallel for schedule(dynamic, 256)
+  for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(nbPoints()); ++i)
+  {
+    bool isValid = false;
+    for(std::size_t oA = observationOffsets[i]; oA < observationOffsets[i + 1] && !isValid; ++oA)
+    {
+      const Vec3 rayA = (X[i] - cameras[observationCameras[oA]].center).normalized();
+      for(std::size_t oB = oA + 1; oB < observationOffsets[i + 1]; ++oB)
+      {
+        const Vec3 rayB = (X[i] - cameras[observationCameras[oB]].center).normalized();
+        if(rayA.dot(rayB) <= maxCosAngle)
+        {
+          isValid = true;
+          break;
+        }
+      }
+    }
+    if(!isValid)
+      valid[i] = false;
+  }
+}
+
+} // namespace multiview
+} // namespace aliceVision
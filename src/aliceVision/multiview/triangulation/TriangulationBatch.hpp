@@ -0,0 +1,119 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/numeric/numeric.hpp>
+
+#include <vector>
+
+namespace aliceVision {
+namespace multiview {
+
+/**
+ * @brief Batch of multi-view triangulation problems.
+ *
+ * Cameras and observations are stored in contiguous arrays,
+ * the observations of point i are in [observationOffsets[i], observationOffsets[i+1]).
+ * Observations are undistorted image points.
+ *
+ * Points are solved and checked in parallel with fixed-size matrices,
+ * there is no dynamic allocation per point.
+ */
+struct TriangulationBatch
+{
+  /**
+   * @brief Camera of the batch.
+   */
+  struct Camera
+  {
+    /// projection matrix P = K [R|t]
+    Mat34 P;
+    /// inverse of the left 3x3 block of P (image point to world ray direction)
+    Mat3 invKR;
+    /// camera center
+    Vec3 center;
+    /// optical axis (third row of the rotation), used for the depth
+    Vec3 axis;
+  };
+
+  /**
+   * @brief Add a camera.
+   * @param[in] P The projection matrix
+   * @param[in] R The camera rotation
+   * @param[in] center The camera center
+   * @return the camera index
+   */
+  std::size_t addCamera(const Mat34& P, const Mat3& R, const Vec3& center);
+
+  /**
+   * @brief Start a new point, the next observations are added to it.
+   */
+  void addPoint() { observationOffsets.push_back(observationOffsets.back()); }
+
+  /**
+   * @brief Add an observation to the last point.
+   * @param[in] cameraIndex The camera index
+   * @param[in] x The undistorted image point
+   */
+  void addObservation(std::size_t cameraIndex, const Vec2& x)
+  {
+    observationCameras.push_back(cameraIndex);
+    observationPoints.push_back(x);
+    ++observationOffsets.back();
+  }
+
+  /// Remove all the points, keep the cameras
+  void clearPoints();
+
+  /// Number of points
+  std::size_t nbPoints() const { return observationOffsets.size() - 1; }
+
+  /// Number of observations of a point
+  std::size_t nbObservations(std::size_t pointIndex) const
+  {
+    return observationOffsets[pointIndex + 1] - observationOffsets[pointIndex];
+  }
+
+  /**
+   * @brief Linear DLT triangulation of all the points.
+   *        Each observation row of the design matrix is normalized,
+   *        the solution is the smallest eigen vector of the 4x4 normal matrix.
+   * @param[out] X The 3D points (one per point, points with less than 2 observations are set to zero)
+   */
+  void triangulateDLT(std::vector<Vec3>& X) const;
+
+  /**
+   * @brief Midpoint triangulation of all the points:
+   *        3D point minimizing the sum of the squared distances to the observation rays.
+   * @param[out] X The 3D points (one per point, points with less than 2 observations are set to zero)
+   */
+  void triangulateMidpoint(std::vector<Vec3>& X) const;
+
+  /**
+   * @brief Check that each point is in front of all the cameras observing it.
+   * @param[in] X The 3D points (one per point)
+   * @param[in,out] valid Set to false for the points behind one camera (or more)
+   */
+  void checkChieralities(const std::vector<Vec3>& X, std::vector<char>& valid) const;
+
+  /**
+   * @brief Check that the maximal angle formed by each point and two of its cameras exceeds a min. angle.
+   * @param[in] X The 3D points (one per point)
+   * @param[in] minAngle The angle limit (degree)
+   * @param[in,out] valid Set to false for the points that do not exceed the limit
+   */
+  void checkAngles(const std::vector<Vec3>& X, double minAngle, std::vector<char>& valid) const;
+
+  std::vector<Camera> cameras;
+
+  std::vector<std::size_t> observationOffsets = {0};
+  std::vector<std::size_t> observationCameras;
+  std::vector<Vec2> observationPoints;
+};
+
+} // namespace multiview
+} // namespace aliceVision
@@ -7,6 +7,7 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include <aliceVision/multiview/triangulation/Triangulation.hpp>
+#include <aliceVision/multiview/triangulation/TriangulationBatch.hpp>
 #include <aliceVision/multiview/NViewDataSet.hpp>
 
 #define BOOST_TEST_MODULE Triangulation
@@ -233,3 +234,57 @@ BOOST_AUTO_TEST_CASE(Triangulate_NViewIterative_LORANSAC)
   }
 }
 
+BOOST_AUTO_TEST_CASE(Triangulate_Batch_FiveViews)
+{
+  const int nviews = 5;
+  const int npoints = 6;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints);
+
+  multiview::TriangulationBatch batch;
+  for(int j = 0; j < nviews; ++j)
+    batch.addCamera(d.P(j), d._R[j], d._C[j]);
+
+  // point i is seen by the cameras [0, 2 + i % (nviews - 1)]
+  for(int i = 0; i < npoints; ++i)
+  {
+    batch.addPoint();
+    for(int j = 0; j < 2 + i % (nviews - 1); ++j)
+      batch.addObservation(j, d._x[j].col(i));
+  }
+  BOOST_CHECK_EQUAL(batch.nbPoints(), npoints);
+
+  std::vector<Vec3> XDLT;
+  std::vector<Vec3> XMidpoint;
+  batch.triangulateDLT(XDLT);
+  batch.triangulateMidpoint(XMidpoint);
+
+  for(int i = 0; i < npoints; ++i)
+  {
+    BOOST_CHECK_SMALL((XDLT[i] - d._X.col(i)).norm(), 1e-9);
+    BOOST_CHECK_SMALL((XMidpoint[i] - d._X.col(i)).norm(), 1e-9);
+  }
+
+  // all the points are in front of the cameras
+  std::vector<char> valid;
+  batch.checkChieralities(XDLT, valid);
+  for(int i = 0; i < npoints; ++i)
+    BOOST_CHECK(valid[i]);
+
+  // the ring cameras see the points with large angles
+  batch.checkAngles(XDLT, 2.0, valid);
+  for(int i = 0; i < npoints; ++i)
+    BOOST_CHECK(valid[i]);
+
+  batch.checkAngles(XDLT, 179.0, valid);
+  for(int i = 0; i < npoints; ++i)
+    BOOST_CHECK(!valid[i]);
+
+  // a point behind the cameras (symmetric to the first camera center)
+  std::vector<Vec3> XBehind = XDLT;
+  XBehind[0] = 2.0 * d._C[0] - XDLT[0];
+  valid.assign(npoints, true);
+  batch.checkChieralities(XBehind, valid);
+  BOOST_CHECK(!valid[0]);
+  for(int i = 1; i < npoints; ++i)
+    BOOST_CHECK(valid[i]);
+}
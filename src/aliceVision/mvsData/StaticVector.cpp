@@ -10,6 +10,14 @@
 
 namespace aliceVision {
 
+#ifdef ALICEVISION_STATICVECTOR_MEMORY_ACCOUNTING
+system::AllocationCounter& staticVectorAllocations()
+{
+    static system::AllocationCounter counter("StaticVector");
+    return counter;
+}
+#endif
+
 int getArrayLengthFromFile(const std::string& fileName)
 {
     FILE* f = fopen(fileName.c_str(), "rb");
@@ -7,6 +7,9 @@
 #pragma once
 
 #include <aliceVision/system/Logger.hpp>
+#ifdef ALICEVISION_STATICVECTOR_MEMORY_ACCOUNTING
+#include <aliceVision/system/MemoryTracker.hpp>
+#endif
 
 #include <algorithm>
 #include <assert.h>
@@ -22,6 +25,13 @@
 
 namespace aliceVision {
 
+#ifdef ALICEVISION_STATICVECTOR_MEMORY_ACCOUNTING
+/**
+ * @brief The memory allocated by the StaticVector containers.
+ */
+system::AllocationCounter& staticVectorAllocations();
+#endif
+
 template <class T>
 class StaticVector
 {
@@ -32,17 +42,71 @@ class StaticVector
     typedef typename std::vector<T>::reference Reference;
     typedef typename std::vector<T>::const_reference ConstReference;
 
+#ifdef ALICEVISION_STATICVECTOR_MEMORY_ACCOUNTING
+    // the bytes of the data given to the allocation counter, updated after each operation that can
+    // change the capacity (a capacity changed through getDataWritable() is only accounted at the next one)
+    std::size_t _accountedBytes = 0;
+
+    void updateAllocation()
+    {
+        const std::size_t bytes = _data.capacity() * sizeof(T);
+        if(bytes == _accountedBytes)
+            return;
+        staticVectorAllocations().add(static_cast<std::int64_t>(bytes) - static_cast<std::int64_t>(_accountedBytes));
+        _accountedBytes = bytes;
+    }
+#else
+    void updateAllocation() {}
+#endif
+
 public:
     StaticVector()
     {}
 
     StaticVector( int n )
         : _data( n )
-    {}
+    {
+        updateAllocation();
+    }
 
     StaticVector( int n, const T& value )
         : _data( n, value )
-    {}
+    {
+        updateAllocation();
+    }
+
+#ifdef ALICEVISION_STATICVECTOR_MEMORY_ACCOUNTING
+    StaticVector( const StaticVector& other )
+        : _data( other._data )
+    {
+        updateAllocation();
+    }
+
+    StaticVector( StaticVector&& other ) noexcept
+        : _data( std::move(other._data) )
+        , _accountedBytes( other._accountedBytes )
+    {
+        other._accountedBytes = 0;
+    }
+
+    StaticVector& operator=( const StaticVector& other )
+    {
+        _data = other._data;
+        updateAllocation();
+        return *this;
+    }
+
+    StaticVector& operator=( StaticVector&& other ) noexcept
+    {
+        swap(other);
+        return *this;
+    }
+
+    ~StaticVector()
+    {
+        staticVectorAllocations().remove(_accountedBytes);
+    }
+#endif
 
     const T& operator[](int index) const
     {
@@ -73,16 +137,23 @@ public:
     int size() const { return _data.size(); }
     bool empty() const { return _data.empty(); }
     size_t capacity() const { return _data.capacity(); }
-    void reserve(int n) { _data.reserve(n); }
-    void resize(int n) { _data.resize(n); }
-    void resize(int n, T value) { _data.resize(n, value); }
-    void resize_with(int n, const T& val) { _data.resize(n, val); }
-    void swap( StaticVector& other ) { _data.swap(other._data); }
-    void assign(int n, T value) { _data.assign(n, value); }
+    void reserve(int n) { _data.reserve(n); updateAllocation(); }
+    void resize(int n) { _data.resize(n); updateAllocation(); }
+    void resize(int n, T value) { _data.resize(n, value); updateAllocation(); }
+    void resize_with(int n, const T& val) { _data.resize(n, val); updateAllocation(); }
+    void swap( StaticVector& other )
+    {
+        _data.swap(other._data);
+#ifdef ALICEVISION_STATICVECTOR_MEMORY_ACCOUNTING
+        std::swap(_accountedBytes, other._accountedBytes);
+#endif
+    }
+    void assign(int n, T value) { _data.assign(n, value); updateAllocation(); }
 
     void shrink_to_fit()
     {
         _data.shrink_to_fit();
+        updateAllocation();
     }
 
     void reserveAddIfNeeded(int nplanned, int ntoallocated)
@@ -96,26 +167,31 @@ public:
     void reserveAdd(int ntoallocated)
     {
         _data.reserve(capacity() + ntoallocated);
+        updateAllocation();
     }
 
     void push_back(const T& val)
     {
         _data.push_back(val);
+        updateAllocation();
     }
 
     void push_front(const T& val)
     {
         _data.insert(_data.begin(), val);
+        updateAllocation();
     }
 
     void push_back_arr(StaticVector<T>* arr)
     {
         _data.insert(_data.end(), arr->getData().begin(), arr->getData().end());
+        updateAllocation();
     }
 
     void push_back_arr(StaticVector<T>& arr)
     {
         _data.insert(_data.end(), arr.getData().begin(), arr.getData().end());
+        updateAllocation();
     }
 
     void remove(int i)
@@ -127,7 +203,10 @@ public:
     {
         int id = indexOf(val);
         if(id == -1)
+        {
             _data.push_back(val);
+            updateAllocation();
+        }
         return id;
     }
 
@@ -184,6 +263,95 @@ public:
 // Avoid the problematic case of std::vector<bool>::operator[]
 using StaticVectorBool = StaticVector<char>;
 
+/**
+ * @brief Jagged array stored in a single contiguous buffer (compressed rows), to replace
+ *        StaticVector<StaticVector<T>> when the number of rows is large.
+ *
+ * The rows are built in two passes: the size of each row is set with allocate(),
+ * then the elements are added with push_back(row, value) in any row order.
+ */
+template <class T>
+class StaticVector2D
+{
+    /// elements of row i in [_offsets[i], _offsets[i+1])
+    std::vector<int> _offsets;
+    /// number of elements already added in each row, only used while filling
+    std::vector<int> _fill;
+    StaticVector<T> _data;
+
+public:
+    StaticVector2D() = default;
+
+    /// Number of rows
+    int size() const { return _offsets.empty() ? 0 : static_cast<int>(_offsets.size()) - 1; }
+    bool empty() const { return size() == 0; }
+    /// Total number of elements
+    int nbElements() const { return _data.size(); }
+
+    int size(int row) const { return _offsets[row + 1] - _offsets[row]; }
+    bool empty(int row) const { return _offsets[row + 1] == _offsets[row]; }
+
+    const T* begin(int row) const { return _data.getData().data() + _offsets[row]; }
+    const T* end(int row) const { return _data.getData().data() + _offsets[row + 1]; }
+    T* begin(int row) { return _data.getDataWritable().data() + _offsets[row]; }
+    T* end(int row) { return _data.getDataWritable().data() + _offsets[row + 1]; }
+
+    const T& operator()(int row, int i) const { return _data[_offsets[row] + i]; }
+    T& operator()(int row, int i) { return _data[_offsets[row] + i]; }
+
+    /**
+     * @brief Allocate the rows, their elements are then added with push_back().
+     * @param[in] rowSizes The final size of each row
+     */
+    void allocate(const StaticVector<int>& rowSizes)
+    {
+        const int nbRows = rowSizes.size();
+        _offsets.resize(nbRows + 1);
+        _offsets[0] = 0;
+        for(int i = 0; i < nbRows; ++i)
+            _offsets[i + 1] = _offsets[i] + rowSizes[i];
+        _data.resize(_offsets[nbRows]);
+        _fill.assign(nbRows, 0);
+    }
+
+    /// Add an element to a row allocated with allocate(), not thread safe
+    void push_back(int row, const T& value)
+    {
+        assert(_offsets[row] + _fill[row] < _offsets[row + 1]);
+        _data[_offsets[row] + _fill[row]++] = value;
+    }
+
+    /// Add a row after the last one
+    void push_back_row(const T* values, int n)
+    {
+        if(_offsets.empty())
+            _offsets.push_back(0);
+        _data.getDataWritable().insert(_data.getDataWritable().end(), values, values + n);
+        _offsets.push_back(_offsets.back() + n);
+    }
+
+    /// Release the memory used while filling the rows
+    void shrink()
+    {
+        _fill.clear();
+        _fill.shrink_to_fit();
+    }
+
+    void clear()
+    {
+        _offsets.clear();
+        _fill.clear();
+        _data.clear();
+    }
+
+    void swap(StaticVector2D& other)
+    {
+        _offsets.swap(other._offsets);
+        _fill.swap(other._fill);
+        _data.swap(other._data);
+    }
+};
+
 template <class T>
 int sizeOfStaticVector(const StaticVector<T>* a)
 {
@@ -365,6 +533,67 @@ void loadArrayOfArraysFromFile(StaticVector<StaticVector<T>>& out_aa, const std:
     fclose(f);
 }
 
+template <class T>
+void saveArrayOfArraysToFile(const std::string& fileName, const StaticVector2D<T>& aa)
+{
+    ALICEVISION_LOG_DEBUG("[IO] saveArrayOfArraysToFile: " << fileName);
+    FILE* f = fopen(fileName.c_str(), "wb");
+    int n = aa.size();
+    fwrite(&n, sizeof(int), 1, f);
+    for(int i = 0; i < n; i++)
+    {
+        int m = aa.size(i);
+        fwrite(&m, sizeof(int), 1, f);
+        if(m > 0)
+            fwrite(aa.begin(i), sizeof(T), m, f);
+    }
+    fclose(f);
+}
+
+template <class T>
+void loadArrayOfArraysFromFile(StaticVector2D<T>& out_aa, const std::string& fileName)
+{
+    ALICEVISION_LOG_DEBUG("[IO] loadArrayOfArraysFromFile: " << fileName);
+    FILE* f = fopen(fileName.c_str(), "rb");
+    if(f == nullptr)
+    {
+        ALICEVISION_THROW_ERROR("[IO] loadArrayOfArraysFromFile: can't open file " << fileName);
+    }
+
+    int n = 0;
+    size_t retval = fread(&n, sizeof(int), 1, f);
+    if( retval != 1 )
+    {
+        fclose(f);
+        ALICEVISION_THROW_ERROR("[IO] loadArrayOfArraysFromFile: can't read outer array size");
+    }
+
+    out_aa.clear();
+    std::vector<T> row;
+    for(int i = 0; i < n; i++)
+    {
+        int m = 0;
+        retval = fread(&m, sizeof(int), 1, f);
+        if( retval != 1 )
+        {
+            fclose(f);
+            ALICEVISION_THROW_ERROR("[IO] loadArrayOfArraysFromFile: can't read inner array size");
+        }
+        row.resize(m);
+        if(m > 0)
+        {
+            retval = fread(row.data(), sizeof(T), m, f);
+            if( retval != m )
+            {
+                fclose(f);
+                ALICEVISION_THROW_ERROR("[IO] loadArrayOfArraysFromFile: can't read vector element");
+            }
+        }
+        out_aa.push_back_row(row.data(), m);
+    }
+    fclose(f);
+}
+
 
 template <class T>
 void saveArrayToFile(const std::string& fileName, const StaticVector<T>& a, bool docompress = true)
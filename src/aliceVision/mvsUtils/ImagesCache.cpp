@@ -7,6 +7,7 @@
 #include "ImagesCache.hpp"
 #include <aliceVision/mvsUtils/common.hpp>
 #include <aliceVision/mvsUtils/fileIO.hpp>
+#include <aliceVision/image/imageCache.hpp>
 
 #include <future>
 
@@ -64,73 +65,95 @@ void ImagesCache<Image>::initIC( std::vector<std::string>& imagesNames )
         _imagesNames.push_back(imagesNames[rc]);
     }
 
-    _camIdMapId.resize( _mp.ncams, -1 );
+    _imgs.resize(_mp.ncams);
     setCacheSize(npreload);
+}
 
+template<typename Image>
+void ImagesCache<Image>::setCacheSize(int nbPreload)
+{
+    std::lock_guard<std::mutex> lock(_imgsMutex);
+    _N_PRELOADED_IMAGES = nbPreload;
+    while(_imgsOrder.size() > std::max(_N_PRELOADED_IMAGES, 0))
     {
-        // Cannot resize the vector<mutex> directly, as mutex class is not move-constructible.
-        // imagesMutexes.resize(mp->ncams); // cannot compile
-        // So, we do the same with a new vector and swap.
-        std::vector<std::mutex> imagesMutexesTmp(_mp.ncams);
-        _imagesMutexes.swap(imagesMutexesTmp);
+        _imgs[_imgsOrder.back()].reset();
+        _imgsOrder.pop_back();
     }
+}
 
-
+template<typename Image>
+std::string ImagesCache<Image>::getImageKey(int camId) const
+{
+    return image::ImageCache::getFileKey(_imagesNames.at(camId)) + "|mvsUtils|" +
+           image::EImageColorSpace_enumToString(_colorspace) + "|" + ECorrectEV_enumToString(_correctEV) + "|" +
+           std::to_string(_mp.getProcessDownscale());
 }
 
 template<typename Image>
-void ImagesCache<Image>::setCacheSize(int nbPreload)
+bool ImagesCache<Image>::isImageInCache(int camId) const
 {
-    _N_PRELOADED_IMAGES = nbPreload;
-    _imgs.resize(_N_PRELOADED_IMAGES);
-    _mapIdCamId.resize( _N_PRELOADED_IMAGES, -1 );
-    _mapIdClock.resize( _N_PRELOADED_IMAGES, clock() );
+    {
+        std::lock_guard<std::mutex> lock(_imgsMutex);
+        if(_imgs[camId] != nullptr)
+            return true;
+    }
+    return image::ImageCache::getInstance().contains<Color>(getImageKey(camId));
 }
 
 template<typename Image>
-void ImagesCache<Image>::refreshData(int camId)
+typename ImagesCache<Image>::ImgSharedPtr ImagesCache<Image>::refreshData(int camId)
 {
-    // printf("camId %i\n",camId);
-    // test if the image is in the memory
-    if(_camIdMapId[camId] == -1)
     {
-        // remove the oldest one
-        int mapId = _mapIdClock.minValId();
-        int oldCamId = _mapIdCamId[mapId];
-        if(oldCamId>=0)
-            _camIdMapId[oldCamId] = -1;
-            // TODO: oldCamId should be protected if already used
-
-        // replace with new new
-        _camIdMapId[camId] = mapId;
-        _mapIdCamId[mapId] = camId;
-        _mapIdClock[mapId] = clock();
-
-        // reload data from files
-        long t1 = clock();
-        if (_imgs[mapId] == nullptr)
+        std::lock_guard<std::mutex> lock(_imgsMutex);
+        if(_imgs[camId] != nullptr)
         {
-            const int maxWidth = _mp.getMaxImageWidth();
-            const int maxHeight = _mp.getMaxImageHeight();
-            _imgs[mapId] = std::make_shared<Image>(maxWidth, maxHeight);
+            _imgsOrder.remove(camId);
+            _imgsOrder.push_front(camId);
+            ++_nbReusedImages;
+            ALICEVISION_LOG_DEBUG("Reuse " << _imagesNames.at(camId) << " from image cache. ");
+            return _imgs[camId];
         }
+    }
 
-        const std::string imagePath = _imagesNames.at(camId);
-        loadImage(imagePath, _mp, camId, *(_imgs[mapId]), _colorspace, _correctEV);
+    // the image may be shared with the other users of the process-wide cache
+    long t1 = clock();
+    const std::string imagePath = _imagesNames.at(camId);
+    bool loaded = false;
+    ImgSharedPtr img = image::ImageCache::getInstance().get<Color>(getImageKey(camId),
+        [this, &imagePath, camId](Image& img) { loadImage(imagePath, _mp, camId, img, _colorspace, _correctEV); },
+        &loaded);
 
+    if(loaded)
+    {
+        ++_nbLoadedImages;
         ALICEVISION_LOG_DEBUG("Add " << imagePath << " to image cache. " << formatElapsedTime(t1));
     }
     else
     {
-      ALICEVISION_LOG_DEBUG("Reuse " << _imagesNames.at(camId) << " from image cache. ");
+        ++_nbReusedImages;
+        ALICEVISION_LOG_DEBUG("Reuse " << imagePath << " from the process image cache. ");
+    }
+
+    // add the image to the working set and release the least recently used one
+    std::lock_guard<std::mutex> lock(_imgsMutex);
+    if(_imgs[camId] == nullptr)
+    {
+        _imgs[camId] = img;
+        _imgsOrder.push_front(camId);
+        while(_imgsOrder.size() > std::max(_N_PRELOADED_IMAGES, 1))
+        {
+            _imgs[_imgsOrder.back()].reset();
+            _imgsOrder.pop_back();
+        }
     }
+
+    return img;
 }
 
 template<typename Image>
 void ImagesCache<Image>::refreshImage_sync(int camId)
 {
-  std::lock_guard<std::mutex> lock(_imagesMutexes[camId]);
-  refreshData(camId);
+    refreshData(camId);
 }
 
 template<typename Image>
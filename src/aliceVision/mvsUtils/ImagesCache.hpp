@@ -14,7 +14,9 @@
 #include <aliceVision/mvsData/StaticVector.hpp>
 #include <aliceVision/mvsUtils/MultiViewParams.hpp>
 
+#include <atomic>
 #include <future>
+#include <list>
 #include <mutex>
 
 namespace aliceVision {
@@ -29,6 +31,12 @@ enum class ECorrectEV
 std::string ECorrectEV_enumToString(const ECorrectEV correctEV);
 
 
+/**
+ * @brief Working set of the camera images, over the process-wide image::ImageCache.
+ *
+ * The last used images are kept whatever the image::ImageCache budget,
+ * so the images shared with the other stages of the process are decoded once.
+ */
 template<typename Image>
 class ImagesCache
 {
@@ -42,13 +50,12 @@ private:
     const MultiViewParams& _mp;
 
     int _N_PRELOADED_IMAGES;
+    /// images of the working set, per camera
     std::vector<ImgSharedPtr> _imgs;
+    /// cameras of the working set, from the most recently used
+    std::list<int> _imgsOrder;
+    mutable std::mutex _imgsMutex;
 
-    std::vector<int> _camIdMapId;
-    std::vector<int> _mapIdCamId;
-    StaticVector<long> _mapIdClock;
-
-    std::vector<std::mutex> _imagesMutexes;
     std::vector<std::string> _imagesNames;
 
     std::list<std::future<void>> _asyncObjects;
@@ -56,6 +63,11 @@ private:
     image::EImageColorSpace _colorspace{image::EImageColorSpace::AUTO};
     ECorrectEV _correctEV{ECorrectEV::NO_CORRECTION};
 
+    std::atomic<int> _nbLoadedImages{0};
+    std::atomic<int> _nbReusedImages{0};
+
+    std::string getImageKey(int camId) const;
+
 public:
     ImagesCache(const MultiViewParams& mp, image::EImageColorSpace colorspace,
                 ECorrectEV correctEV = ECorrectEV::NO_CORRECTION);
@@ -71,12 +83,18 @@ public:
 
     inline ImgSharedPtr getImg_sync( int camId )
     {
-        refreshImage_sync(camId);
-        const int imageId = _camIdMapId[camId];
-        return _imgs[imageId];
+        return refreshData(camId);
     }
 
-    void refreshData(int camId);
+    /// Whether the image of the camera is in the cache (no load is needed)
+    bool isImageInCache(int camId) const;
+
+    /// Number of images loaded from files since the cache creation
+    inline int getNbLoadedImages() const { return _nbLoadedImages; }
+    /// Number of images requests served from the cache since the cache creation
+    inline int getNbReusedImages() const { return _nbReusedImages; }
+
+    ImgSharedPtr refreshData(int camId);
     void refreshImage_sync(int camId);
 
     void refreshImage_async(int camId);
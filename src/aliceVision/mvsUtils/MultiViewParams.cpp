@@ -27,6 +27,8 @@
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/lexical_cast.hpp>
 
+#include <algorithm>
+#include <fstream>
 #include <iostream>
 #include <set>
 
@@ -63,6 +65,8 @@ MultiViewParams::MultiViewParams(const sfmData::SfMData& sfmData,
             continue;
 
           std::string path = view.getImagePath();
+          std::string maskPath;
+          bool undistortOnRead = false;
 
           if(readFromDepthMaps)
           {
@@ -85,24 +89,44 @@ MultiViewParams::MultiViewParams(const sfmData::SfMData& sfmData,
             // if path was not found
             if(paths.empty())
             {
-                throw std::runtime_error("Cannot find image file coresponding to the view '" + 
-                    std::to_string(view.getViewId()) + "' in folder '" + _imagesFolder + "'.");
+                // prepareDenseScene without output images: the source image and its mask are undistorted when they are read
+                const std::string sourceFilepath = _imagesFolder + std::to_string(view.getViewId()) + "_source.txt";
+                std::ifstream sourceFile(sourceFilepath);
+                if(!sourceFile.is_open() || !std::getline(sourceFile, path) || path.empty())
+                {
+                    throw std::runtime_error("Cannot find image file coresponding to the view '" + 
+                        std::to_string(view.getViewId()) + "' in folder '" + _imagesFolder + "'.");
+                }
+                std::getline(sourceFile, maskPath);
+                undistortOnRead = true;
             }
             else if(paths.size() > 1)
             {
                 throw std::runtime_error("Ambiguous case: Multiple image file found for the view '" + 
                     std::to_string(view.getViewId()) + "' in folder '" + _imagesFolder + "'.");
             }
-
-            path = _imagesFolder + std::to_string(view.getViewId()) + fs::path(paths[0]).extension().string();
+            else
+            {
+                path = _imagesFolder + std::to_string(view.getViewId()) + fs::path(paths[0]).extension().string();
+            }
           }
 
           dimensions.emplace(view.getWidth(), view.getHeight());
           _imagesParams.emplace_back(view.getViewId(), view.getWidth(), view.getHeight(), path);
           _imageIdsPerViewId[view.getViewId()] = i;
+          _imagesUndistortedOnRead.push_back(undistortOnRead);
+          _imagesMaskPaths.push_back(maskPath);
           ++i;
         }
 
+        const int nbUndistortedOnRead = std::count(_imagesUndistortedOnRead.begin(), _imagesUndistortedOnRead.end(), true);
+        if(nbUndistortedOnRead > 0)
+        {
+            ALICEVISION_LOG_INFO(nbUndistortedOnRead << " image(s) not written in folder '" << _imagesFolder << "', "
+                                 "the source images are undistorted when they are read.");
+            _medianCameraExposure = sfmData.getMedianCameraExposureSetting().getExposure();
+        }
+
         ALICEVISION_LOG_INFO("Found " << dimensions.size() << " image dimension(s): ");
         for(const auto& dim : dimensions)
             ALICEVISION_LOG_INFO("\t- [" << dim.first << "x" << dim.second << "]");
@@ -229,6 +253,19 @@ MultiViewParams::MultiViewParams(const sfmData::SfMData& sfmData,
     }
 
     ALICEVISION_LOG_INFO("Overall maximum dimension: [" << _maxImageWidth << "x" << _maxImageHeight << "]");
+
+    // load the neighbor cameras graph of prepareDenseScene
+    if(_imagesFolder != "/")
+    {
+        const std::string neighborCamsGraphPath = _imagesFolder + sfmData::neighborCamsGraphFilename;
+        if(fs::exists(neighborCamsGraphPath))
+            loadNeighborCamsGraph(neighborCamsGraphPath);
+    }
+}
+
+bool MultiViewParams::loadNeighborCamsGraph(const std::string& path)
+{
+    return _neighborCamsGraph.load(path, _sfmData);
 }
 
 
@@ -522,9 +559,72 @@ void MultiViewParams::decomposeProjectionMatrix(Point3d& Co, Matrix3x3& Ro, Matr
 }
 
 
+ROI MultiViewParams::getHexahedronImageROI(int rc, const Point3d hexah[8], int margin) const
+{
+    const ROI imageRoi(0, getWidth(rc), 0, getHeight(rc));
+
+    double minX = std::numeric_limits<double>::max();
+    double minY = std::numeric_limits<double>::max();
+    double maxX = std::numeric_limits<double>::lowest();
+    double maxY = std::numeric_limits<double>::lowest();
+
+    for(int i = 0; i < 8; ++i)
+    {
+        const Point3d XT = camArr[rc] * hexah[i];
+
+        // the projection of the hexahedron is unbounded
+        if(XT.z <= 0)
+            return imageRoi;
+
+        const double x = XT.x / XT.z;
+        const double y = XT.y / XT.z;
+
+        minX = std::min(minX, x);
+        minY = std::min(minY, y);
+        maxX = std::max(maxX, x);
+        maxY = std::max(maxY, y);
+    }
+
+    const int beginX = std::max(0, static_cast<int>(std::floor(minX)) - margin);
+    const int beginY = std::max(0, static_cast<int>(std::floor(minY)) - margin);
+    const int endX = std::min(getWidth(rc), static_cast<int>(std::ceil(maxX)) + 1 + margin);
+    const int endY = std::min(getHeight(rc), static_cast<int>(std::ceil(maxY)) + 1 + margin);
+
+    if(beginX >= endX || beginY >= endY)
+        return ROI();
+
+    return ROI(beginX, endX, beginY, endY);
+}
+
 StaticVector<int> MultiViewParams::findNearestCamsFromLandmarks(int rc, int nbNearestCams) const
 {
   StaticVector<int> out;
+
+  if(!_neighborCamsGraph.empty() && _neighborCamsGraph.hasViewAngles(_minViewAngle, _maxViewAngle))
+  {
+    // the neighbors are sorted by decreasing number of shared landmarks
+    out.reserve(std::min(getNbCameras(), nbNearestCams));
+
+    for(const sfmData::NeighborCam& neighbor : _neighborCamsGraph.getNeighbors(getViewId(rc)))
+    {
+      if(out.size() >= nbNearestCams)
+        break;
+
+      // a minimum of 10 common points is required (see below)
+      if(neighbor.nbSharedLandmarks <= (10 * 2))
+        break;
+
+      const auto it = _imageIdsPerViewId.find(neighbor.viewId);
+      if(it != _imageIdsPerViewId.end())
+        out.push_back(it->second);
+    }
+
+    if(out.size() < nbNearestCams)
+      ALICEVISION_LOG_INFO("Found only " << out.size() << "/" << nbNearestCams << " nearest cameras for view id: " << getViewId(rc));
+
+    return out;
+  }
+
   std::vector<SortedId> ids;
   ids.reserve(getNbCameras());
 
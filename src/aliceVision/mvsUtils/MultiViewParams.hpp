@@ -13,6 +13,7 @@
 #include <aliceVision/mvsData/ROI.hpp>
 #include <aliceVision/mvsData/StaticVector.hpp>
 #include <aliceVision/mvsData/structures.hpp>
+#include <aliceVision/sfmData/NeighborCamsGraph.hpp>
 
 #include <boost/property_tree/ptree.hpp>
 
@@ -160,6 +161,31 @@ public:
         return _imagesParams.at(index).size / getDownscaleFactor(index);
     }
 
+    /**
+     * @return true if the image is the source image of the view, undistorted when it is read
+     * @note Only for the views listed by prepareDenseScene without output images (<viewId>_source.txt files)
+     */
+    inline bool isImageUndistortedOnRead(int index) const
+    {
+        return _imagesUndistortedOnRead.at(index);
+    }
+
+    /**
+     * @return the mask of the source image undistorted on read, or an empty string if there is no mask
+     */
+    inline const std::string& getImageMaskPath(int index) const
+    {
+        return _imagesMaskPaths.at(index);
+    }
+
+    /**
+     * @return the median exposure of the cameras, for the exposure compensation of the images undistorted on read
+     */
+    inline double getMedianCameraExposure() const
+    {
+        return _medianCameraExposure;
+    }
+
     inline const std::vector<ImageParams>& getImagesParams() const
     {
         return _imagesParams;
@@ -288,8 +314,33 @@ public:
      */
     StaticVector<int> findCamsWhichIntersectsHexahedron(const Point3d hexah[8]) const;
 
+    /**
+     * @brief Get the image region of interest covered by the projection of an hexahedron
+     * @param[in] rc the camera index
+     * @param[in] hexah 0-3 frontal face, 4-7 back face
+     * @param[in] margin the region margin (pixels)
+     * @return the bounding box of the projected hexahedron clamped to the image,
+     *         the full image if the hexahedron is partially behind the camera
+     */
+    ROI getHexahedronImageROI(int rc, const Point3d hexah[8], int margin = 0) const;
+
+    /**
+     * @brief Load the neighbor cameras graph used by findNearestCamsFromLandmarks.
+     * @note The graph of the images folder is loaded by the constructor if it exists.
+     * @param[in] path the neighbor cameras graph file path
+     * @return false if the file cannot be read or was built from other cameras or landmarks than the input sfmData
+     */
+    bool loadNeighborCamsGraph(const std::string& path);
+
+    inline const sfmData::NeighborCamsGraph& getNeighborCamsGraph() const
+    {
+        return _neighborCamsGraph;
+    }
+
     /**
      * @brief findNearestCamsFromLandmarks
+     * @note Use the neighbor cameras graph if it was built with the current view angles,
+     *       scan the landmarks otherwise.
      * @param rc
      * @param nbNearestCams
      * @return
@@ -321,6 +372,12 @@ private:
     std::vector<ImageParams> _imagesParams;
     /// image id per view id
     std::map<IndexT, int> _imageIdsPerViewId;
+    /// whether each image is the source image of the view, undistorted when it is read
+    std::vector<bool> _imagesUndistortedOnRead;
+    /// mask of each source image undistorted on read (empty if none)
+    std::vector<std::string> _imagesMaskPaths;
+    /// median exposure of the cameras, if images are undistorted on read
+    double _medianCameraExposure = 1.0;
     /// image scale list
     std::vector<int> _imagesScale;
     /// downscale apply to input images during process
@@ -341,6 +398,8 @@ private:
     float _maxViewAngle = 70.0f;  // WARNING: may be too low, especially when using seeds from SfM
     /// input sfmData
     const sfmData::SfMData& _sfmData;
+    /// neighbor cameras of each view, precomputed by prepareDenseScene
+    sfmData::NeighborCamsGraph _neighborCamsGraph;
 
     void loadMatricesFromTxtFile(int index, const std::string& fileNameP, const std::string& fileNameD);
     void loadMatricesFromRawProjectionMatrix(int index, const double* rawProjMatix);
@@ -19,6 +19,9 @@ namespace fs = boost::filesystem;
 namespace aliceVision {
 namespace mvsUtils {
 
+// full size depth/sim maps are written as tiled EXR files for region of interest reads
+constexpr int fullSizeMapTileSize = 256;
+
 /**
  * @brief Get tile map ROI from file metadata
  * @param[in] mapTilePath the tile map file path
@@ -165,11 +168,23 @@ void weightTileBorder(int a, int b, int c, int d,
     }
 }
 
+/**
+ * @brief Add a tile to a map region with weighting
+ * @param[in] rc the related R camera index
+ * @param[in] mp the multi-view parameters
+ * @param[in] tileParams tile workflow parameters
+ * @param[in] roi the 2d region of interest of the tile without any downscale apply
+ * @param[in] downscale the depth/sim map downscale factor
+ * @param[in] mapRoi the downscaled 2d region of interest of the output map
+ * @param[in] in_tileMap the tile map to add
+ * @param[in,out] inout_map the output map region
+ */
 void addTileMapWeighted(int rc,
-                         const MultiViewParams& mp, 
+                         const MultiViewParams& mp,
                          const TileParams& tileParams,
-                         const ROI& roi, 
+                         const ROI& roi,
                          int downscale,
+                         const ROI& mapRoi,
                          image::Image<float>& in_tileMap,
                          image::Image<float>& inout_map)
 {
@@ -251,35 +266,76 @@ void addTileMapWeighted(int rc,
         weightTileBorder(1, 0, 0, 1, tilePadding, tileHeight - 2 * tilePadding, lu, in_tileMap);
     }
 
-    // add weighted tile to the depth/sim map
-    for(int x = downscaledRoi.x.begin; x < downscaledRoi.x.end; ++x)
+    // add weighted tile to the depth/sim map region
+    const ROI addRoi = intersect(downscaledRoi, mapRoi);
+
+    for(int x = addRoi.x.begin; x < addRoi.x.end; ++x)
     {
-        for(int y = downscaledRoi.y.begin; y < downscaledRoi.y.end; ++y)
+        for(int y = addRoi.y.begin; y < addRoi.y.end; ++y)
         {
             const int tx = x - downscaledRoi.x.begin;
             const int ty = y - downscaledRoi.y.begin;
 
-            inout_map(y, x) += in_tileMap(ty, tx);
+            inout_map(y - mapRoi.y.begin, x - mapRoi.x.begin) += in_tileMap(ty, tx);
         }
     }
 }
 
-void readMapFromTiles(int rc, 
-                      const MultiViewParams& mp, 
+void addTileMapWeighted(int rc,
+                         const MultiViewParams& mp, 
+                         const TileParams& tileParams,
+                         const ROI& roi, 
+                         int downscale,
+                         image::Image<float>& in_tileMap,
+                         image::Image<float>& inout_map)
+{
+    const ROI mapRoi(0, inout_map.Width(), 0, inout_map.Height()); // full map
+    addTileMapWeighted(rc, mp, tileParams, roi, downscale, mapRoi, in_tileMap, inout_map);
+}
+
+/**
+ * @brief Get the downscaled region of interest of a map file
+ * @param[in] rc the related R camera index
+ * @param[in] mp the multi-view parameters
+ * @param[in] roi the 2d region of interest without any downscale apply
+ * @param[in] scaleStep the depth/sim map downscale factor
+ * @return the downscaled region of interest, clamped to the map size
+ */
+ROI getDownscaledMapROI(int rc, const MultiViewParams& mp, const ROI& roi, int scaleStep)
+{
+    const int width  = divideRoundUp(mp.getWidth(rc) , scaleStep);
+    const int height = divideRoundUp(mp.getHeight(rc), scaleStep);
+    const ROI mapRoi = intersect(downscaleROI(roi, scaleStep), ROI(0, width, 0, height));
+    return mapRoi.isEmpty() ? ROI() : mapRoi;
+}
+
+/**
+ * @brief Read a region of interest of a map from its tile files
+ * @param[in] rc the related R camera index
+ * @param[in] mp the multi-view parameters
+ * @param[in] fileType the map file type
+ * @param[in] roi the 2d region of interest without any downscale apply
+ * @param[out] out_map the output map region
+ * @param[in] scale the depth/sim map downscale factor
+ * @param[in] step the depth/sim map step factor
+ * @param[in] customSuffix the filename custom suffix
+ */
+void readMapFromTiles(int rc,
+                      const MultiViewParams& mp,
                       EFileType fileType,
-                      image::Image<float>& out_map, 
+                      const ROI& roi,
+                      image::Image<float>& out_map,
                       int scale,
-                      int step, 
+                      int step,
                       const std::string& customSuffix)
 {
     const ROI imageRoi(Range(0, mp.getWidth(rc)), Range(0, mp.getHeight(rc)));
 
     const int scaleStep = std::max(scale, 1) * step; // avoid 0 special case (reserved for depth map filtering)
-    const int width  = divideRoundUp(mp.getWidth(rc) , scaleStep);
-    const int height = divideRoundUp(mp.getHeight(rc), scaleStep);
+    const ROI mapRoi = getDownscaledMapROI(rc, mp, roi, scaleStep);
 
-    // the output full map
-    out_map.resize(width, height, true, 0.f); // should be initialized, additive process
+    // the output map region
+    out_map.resize(mapRoi.width(), mapRoi.height(), true, 0.f); // should be initialized, additive process
 
     // get tile map path list for the given R camera
     std::vector<std::string> mapTilePathList;
@@ -304,13 +360,13 @@ void readMapFromTiles(int rc,
       getRoiFromMetadata(mapTilePathList.at(i), tileRoiList.at(i));
     }
 
-    // read and add each tile to the full map
+    // read and add each tile intersecting the region of interest to the output map
     for(size_t i = 0; i < tileRoiList.size(); ++i)
     {
-        const ROI roi = intersect(tileRoiList.at(i), imageRoi);
-        const std::string mapTilePath = getFileNameFromIndex(mp, rc, fileType, scale, customSuffix, roi.x.begin, roi.y.begin);
+        const ROI tileRoi = intersect(tileRoiList.at(i), imageRoi);
+        const std::string mapTilePath = getFileNameFromIndex(mp, rc, fileType, scale, customSuffix, tileRoi.x.begin, tileRoi.y.begin);
 
-        if(roi.isEmpty())
+        if(tileRoi.isEmpty() || intersect(downscaleROI(tileRoi, scaleStep), mapRoi).isEmpty())
             continue;
 
         try
@@ -319,8 +375,8 @@ void readMapFromTiles(int rc,
             image::Image<float> tileMap;
             image::readImage(mapTilePath, tileMap, image::EImageColorSpace::NO_CONVERSION);
 
-            // add tile to the full map
-            addTileMapWeighted(rc, mp, tileParams, roi, scaleStep, tileMap, out_map);
+            // add tile to the output map
+            addTileMapWeighted(rc, mp, tileParams, tileRoi, scaleStep, mapRoi, tileMap, out_map);
         }
         catch(const std::exception& e)
         {
@@ -329,6 +385,53 @@ void readMapFromTiles(int rc,
     }
 }
 
+void readMapFromTiles(int rc, 
+                      const MultiViewParams& mp, 
+                      EFileType fileType,
+                      image::Image<float>& out_map, 
+                      int scale,
+                      int step, 
+                      const std::string& customSuffix)
+{
+    const ROI imageRoi(Range(0, mp.getWidth(rc)), Range(0, mp.getHeight(rc)));
+    readMapFromTiles(rc, mp, fileType, imageRoi, out_map, scale, step, customSuffix);
+}
+
+/**
+ * @brief Read a region of interest of a map from its full size file or from its tile files
+ * @param[in] rc the related R camera index
+ * @param[in] mp the multi-view parameters
+ * @param[in] fileType the map file type
+ * @param[in] roi the 2d region of interest without any downscale apply
+ * @param[out] out_map the output map region
+ * @param[in] scale the depth/sim map downscale factor
+ * @param[in] step the depth/sim map step factor
+ * @param[in] customSuffix the filename custom suffix
+ */
+void readMapROI(int rc,
+                const MultiViewParams& mp,
+                EFileType fileType,
+                const ROI& roi,
+                image::Image<float>& out_map,
+                int scale,
+                int step,
+                const std::string& customSuffix)
+{
+    const std::string mapPath = getFileNameFromIndex(mp, rc, fileType, scale, customSuffix);
+
+    if(fs::exists(mapPath))
+    {
+        const int scaleStep = std::max(scale, 1) * step; // avoid 0 special case (reserved for depth map filtering)
+        const ROI mapRoi = getDownscaledMapROI(rc, mp, roi, scaleStep);
+
+        image::readImageROI(mapPath, out_map, oiio::ROI(mapRoi.x.begin, mapRoi.x.end, mapRoi.y.begin, mapRoi.y.end));
+    }
+    else
+    {
+        readMapFromTiles(rc, mp, fileType, roi, out_map, scale, step, customSuffix);
+    }
+}
+
 void writeDepthSimMap(int rc, 
                       const MultiViewParams& mp, 
                       const TileParams& tileParams, 
@@ -359,7 +462,9 @@ void writeDepthSimMap(int rc,
     std::string depthMapPath;
     std::string simMapPath;
 
-    if(downscaledROI.width() != imageWidth || downscaledROI.height() != imageHeight) // is a tile
+    const bool isTile = (downscaledROI.width() != imageWidth || downscaledROI.height() != imageHeight);
+
+    if(isTile)
     {
         // tiled depth/sim map
         depthMapPath = getFileNameFromIndex(mp, rc, EFileType::depthMap, scale, customSuffix, roi.x.begin, roi.y.begin);
@@ -450,7 +555,8 @@ void writeDepthSimMap(int rc,
                           depthMap,
                           image::ImageWriteOptions()
                               .toColorSpace(image::EImageColorSpace::NO_CONVERSION)
-                              .storageDataType(image::EStorageDataType::Float),
+                              .storageDataType(image::EStorageDataType::Float)
+                              .exrTileSize(isTile ? 0 : fullSizeMapTileSize),
                           metadata, 
                           displayRoi,
                           pixelRoi);
@@ -463,7 +569,8 @@ void writeDepthSimMap(int rc,
                           simMap,
                           image::ImageWriteOptions()
                               .toColorSpace(image::EImageColorSpace::NO_CONVERSION)
-                              .storageDataType(image::EStorageDataType::Half),
+                              .storageDataType(image::EStorageDataType::Half)
+                              .exrTileSize(isTile ? 0 : fullSizeMapTileSize),
                           metadata, 
                           displayRoi,
                           pixelRoi);
@@ -558,6 +665,41 @@ void readSimMap(int rc,
     }
 }
 
+void readDepthSimMapROI(int rc,
+                        const MultiViewParams& mp,
+                        const ROI& roi,
+                        image::Image<float>& out_depthMap,
+                        image::Image<float>& out_simMap,
+                        int scale,
+                        int step,
+                        const std::string& customSuffix)
+{
+    readMapROI(rc, mp, EFileType::depthMap, roi, out_depthMap, scale, step, customSuffix);
+    readMapROI(rc, mp, EFileType::simMap, roi, out_simMap, scale, step, customSuffix);
+}
+
+void readDepthMapROI(int rc,
+                     const MultiViewParams& mp,
+                     const ROI& roi,
+                     image::Image<float>& out_depthMap,
+                     int scale,
+                     int step,
+                     const std::string& customSuffix)
+{
+    readMapROI(rc, mp, EFileType::depthMap, roi, out_depthMap, scale, step, customSuffix);
+}
+
+void readSimMapROI(int rc,
+                   const MultiViewParams& mp,
+                   const ROI& roi,
+                   image::Image<float>& out_simMap,
+                   int scale,
+                   int step,
+                   const std::string& customSuffix)
+{
+    readMapROI(rc, mp, EFileType::simMap, roi, out_simMap, scale, step, customSuffix);
+}
+
 unsigned long getNbDepthValuesFromDepthMap(int rc, 
                                            const MultiViewParams& mp,
                                            int scale,
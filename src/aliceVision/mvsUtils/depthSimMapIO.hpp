@@ -139,6 +139,63 @@ void readSimMap(int rc,
                 int step = 1,
                 const std::string& customSuffix = "");
 
+/**
+ * @brief read a region of interest of the depth map and the similarity map from files
+ * @note only the parts of the files intersecting the region are read
+ * @param[in] rc the related R camera index
+ * @param[in] mp the multi-view parameters
+ * @param[in] roi the 2d region of interest without any downscale apply
+ * @param[out] out_depthMap the corresponding depth map region
+ * @param[out] out_simMap the corresponding similarity map region
+ * @param[in] scale the depth/sim map downscale factor
+ * @param[in] step the depth/sim map step factor
+ * @param[in] customSuffix the filename custom suffix
+ */
+void readDepthSimMapROI(int rc,
+                        const MultiViewParams& mp,
+                        const ROI& roi,
+                        image::Image<float>& out_depthMap,
+                        image::Image<float>& out_simMap,
+                        int scale = 1,
+                        int step = 1,
+                        const std::string& customSuffix = "");
+
+/**
+ * @brief read a region of interest of the depth map from file(s)
+ * @param[in] rc the related R camera index
+ * @param[in] mp the multi-view parameters
+ * @param[in] roi the 2d region of interest without any downscale apply
+ * @param[out] out_depthMap the corresponding depth map region
+ * @param[in] scale the depth/sim map downscale factor
+ * @param[in] step the depth/sim map step factor
+ * @param[in] customSuffix the filename custom suffix
+ */
+void readDepthMapROI(int rc,
+                     const MultiViewParams& mp,
+                     const ROI& roi,
+                     image::Image<float>& out_depthMap,
+                     int scale = 1,
+                     int step = 1,
+                     const std::string& customSuffix = "");
+
+/**
+ * @brief read a region of interest of the similarity map from file(s)
+ * @param[in] rc the related R camera index
+ * @param[in] mp the multi-view parameters
+ * @param[in] roi the 2d region of interest without any downscale apply
+ * @param[out] out_simMap the corresponding similarity map region
+ * @param[in] scale the depth/sim map downscale factor
+ * @param[in] step the depth/sim map step factor
+ * @param[in] customSuffix the filename custom suffix
+ */
+void readSimMapROI(int rc,
+                   const MultiViewParams& mp,
+                   const ROI& roi,
+                   image::Image<float>& out_simMap,
+                   int scale = 1,
+                   int step = 1,
+                   const std::string& customSuffix = "");
+
 /**
  * @brief Get depth map number of depth values from metadata or count
  * @param[in] rc the related R camera index
@@ -6,11 +6,13 @@
 
 #include "fileIO.hpp"
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/camera/cameraUndistortImage.hpp>
 #include <aliceVision/image/Image.hpp>
 #include <aliceVision/image/imageAlgo.hpp>
 #include <aliceVision/image/io.hpp>
 #include <aliceVision/mvsUtils/common.hpp>
 #include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
 
 #include <boost/filesystem/operations.hpp>
 #include <boost/filesystem/path.hpp>
@@ -348,18 +350,101 @@ Matrix3x4 load3x4MatrixFromFile(std::istream& in)
     return m;
 }
 
+/// The mask is stored in the alpha channel, as in the images written by prepareDenseScene
+void applyMask(image::Image<image::RGBAfColor>& img, const image::Image<unsigned char>& mask)
+{
+    for(int pix = 0; pix < img.Width() * img.Height(); ++pix)
+        img(pix).a() = (mask(pix) == 0) ? 0.f : 1.f;
+}
+
+/// Without alpha channel, the mask is not used (as when reading the images written by prepareDenseScene)
+void applyMask(image::Image<image::RGBfColor>& img, const image::Image<unsigned char>& mask)
+{
+}
+
+/**
+ * @brief Read the source image of a view and its mask and undistort them, as prepareDenseScene does,
+ *        for the images prepareDenseScene did not write.
+ */
+template<class Image>
+void loadUndistortedSourceImage(const std::string& path, const MultiViewParams& mp, int camId, Image& img,
+                                image::EImageColorSpace colorspace, ECorrectEV correctEV)
+{
+    // the undistortion maps are shared by the images of the same intrinsic
+    static camera::UndistortionMapCache undistortionMapCache;
+
+    const sfmData::SfMData& sfmData = mp.getInputSfMData();
+    const sfmData::View& view = sfmData.getView(mp.getViewId(camId));
+    const camera::IntrinsicBase* intrinsicPtr = sfmData.getIntrinsicPtr(view.getIntrinsicId());
+
+    // the undistortion is done at full resolution, in the working color space of the exposure correction
+    const bool correctExposure = (correctEV == ECorrectEV::APPLY_CORRECTION);
+    Image sourceImage;
+    image::readImage(path, sourceImage, correctExposure ? image::EImageColorSpace::LINEAR : colorspace);
+
+    const std::string& maskPath = mp.getImageMaskPath(camId);
+    if(!maskPath.empty())
+    {
+        image::Image<unsigned char> mask;
+        image::readImage(maskPath, mask, image::EImageColorSpace::LINEAR);
+        if(mask.Width() != sourceImage.Width() || mask.Height() != sourceImage.Height())
+            ALICEVISION_LOG_WARNING("Invalid image mask size: mask '" << maskPath << "' is ignored.");
+        else
+            applyMask(sourceImage, mask);
+    }
+
+    Image undistortedImage;
+    if(intrinsicPtr->isValid() && intrinsicPtr->hasDistortion())
+    {
+        using Pix = typename Image::Tpixel;
+        camera::UndistortImage(sourceImage, intrinsicPtr, undistortedImage, Pix(Pix::Zero()), undistortionMapCache);
+        sourceImage = Image();
+    }
+    else
+    {
+        undistortedImage.swap(sourceImage);
+    }
+
+    if(correctExposure)
+    {
+        const float exposureCompensation = float(mp.getMedianCameraExposure() / view.getCameraExposureSetting().getExposure());
+        ALICEVISION_LOG_INFO("  exposure compensation for image " << camId + 1 << ": " << exposureCompensation);
+
+        for(std::size_t i = 0; i < undistortedImage.size(); ++i)
+            undistortedImage(i) = undistortedImage(i) * exposureCompensation;
+
+        imageAlgo::colorconvert(undistortedImage, image::EImageColorSpace::LINEAR, colorspace);
+    }
+
+    const int processScale = mp.getProcessDownscale();
+    if(processScale > 1)
+        imageAlgo::resizeImage(processScale, undistortedImage, img);
+    else
+        img.swap(undistortedImage);
+}
+
 template<class Image>
 void loadImage(const std::string& path, const MultiViewParams& mp, int camId, Image& img,
                image::EImageColorSpace colorspace, ECorrectEV correctEV)
 {
+    if(mp.isImageUndistortedOnRead(camId))
+    {
+        loadUndistortedSourceImage(path, mp, camId, img, colorspace, correctEV);
+        return;
+    }
+
+    // scale choosed by the user and apply during the process,
+    // the image is decoded at the reduced resolution when possible
+    const int processScale = mp.getProcessDownscale();
+
     // check image size
-    auto checkImageSize = [&path, &mp, camId, &img](){
-        if((mp.getOriginalWidth(camId) != img.Width()) || (mp.getOriginalHeight(camId) != img.Height()))
+    auto checkImageSize = [&path, &mp, camId, &img, processScale](){
+        if((mp.getOriginalWidth(camId) / processScale != img.Width()) || (mp.getOriginalHeight(camId) / processScale != img.Height()))
         {
             std::stringstream s;
             s << "Bad image dimension for camera : " << camId << "\n";
             s << "\t- image path : " << path << "\n";
-            s << "\t- expected dimension : " << mp.getOriginalWidth(camId) << "x" << mp.getOriginalHeight(camId) << "\n";
+            s << "\t- expected dimension : " << mp.getOriginalWidth(camId) / processScale << "x" << mp.getOriginalHeight(camId) / processScale << "\n";
             s << "\t- real dimension : " << img.Width() << "x" << img.Height() << "\n";
             throw std::runtime_error(s.str());
         }
@@ -367,13 +452,17 @@ void loadImage(const std::string& path, const MultiViewParams& mp, int camId, Im
 
     if(correctEV == ECorrectEV::NO_CORRECTION)
     {
-        image::readImage(path, img, colorspace);
+        image::ImageReadOptions options(colorspace);
+        options.downscale = processScale;
+        image::readImage(path, img, options);
         checkImageSize();
     }
     // if exposure correction, apply it in linear colorspace and then convert colorspace
     else
     {
-        image::readImage(path, img, image::EImageColorSpace::LINEAR);
+        image::ImageReadOptions options(image::EImageColorSpace::LINEAR);
+        options.downscale = processScale;
+        image::readImage(path, img, options);
         checkImageSize();
 
         const auto metadata = image::readImageMetadata(path);
@@ -395,17 +484,6 @@ void loadImage(const std::string& path, const MultiViewParams& mp, int camId, Im
             imageAlgo::colorconvert(img, image::EImageColorSpace::LINEAR, colorspace);
         }
     }
-
-    // scale choosed by the user and apply during the process
-    const int processScale = mp.getProcessDownscale();
-
-    if(processScale > 1)
-    {
-        ALICEVISION_LOG_DEBUG("Downscale (x" << processScale << ") image: " << mp.getViewId(camId) << ".");
-        Image bmpr;
-        imageAlgo::resizeImage(processScale, img, bmpr);
-        img.swap(bmpr);
-    }
 }
 
 template void loadImage<image::Image<image::RGBfColor>>(const std::string& path, const MultiViewParams& mp, int camId,
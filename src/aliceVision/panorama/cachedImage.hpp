@@ -5,11 +5,147 @@
 #include <aliceVision/panorama/boundingBox.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/types.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 #include <iterator>
+#include <limits>
 
 namespace aliceVision
 {
 
+/**
+ * Run jobs on tiles in parallel.
+ * The tiles of the jobs run concurrently are acquired first, sequentially as the cache manager is not thread-safe,
+ * so the number of concurrent jobs is bounded by the memory ceiling of the cache manager.
+ * @param jobsTiles the tiles needed by each job (null tiles are ignored), all from the same cache manager
+ * @param f the job function, called with the job index once its tiles are in core. It must not acquire tiles.
+ * @return false if a tile cannot be acquired or a job failed
+ */
+template <class JobFunction>
+bool parallelTilesOperation(const std::vector<std::vector<image::CachedTile::smart_pointer>> & jobsTiles, JobFunction f)
+{
+    size_t maxBlockCount = std::numeric_limits<size_t>::max();
+    for(const auto & jobTiles : jobsTiles)
+    {
+        bool found = false;
+        for(const image::CachedTile::smart_pointer & tile : jobTiles)
+        {
+            std::shared_ptr<image::TileCacheManager> manager = tile ? tile->getManager() : nullptr;
+            if(manager)
+            {
+                maxBlockCount = manager->getInCoreMaxBlockCount();
+                found = true;
+                break;
+            }
+        }
+
+        if(found)
+        {
+            break;
+        }
+    }
+
+    const auto acquireJobTiles = [&jobsTiles](size_t job) -> bool
+    {
+        for(const image::CachedTile::smart_pointer & tile : jobsTiles[job])
+        {
+            if(tile && !tile->acquire())
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    const auto isJobInCore = [&jobsTiles](size_t job) -> bool
+    {
+        for(const image::CachedTile::smart_pointer & tile : jobsTiles[job])
+        {
+            if(tile && tile->getDataPointer() == nullptr)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    size_t jobStart = 0;
+    while(jobStart < jobsTiles.size())
+    {
+        // group the next jobs while their tiles fit in core together
+        size_t jobEnd = jobStart;
+        size_t blockCount = 0;
+        while(jobEnd < jobsTiles.size())
+        {
+            size_t jobBlockCount = 0;
+            for(const image::CachedTile::smart_pointer & tile : jobsTiles[jobEnd])
+            {
+                if(tile)
+                {
+                    jobBlockCount += tile->getDepth();
+                }
+            }
+
+            if(jobEnd > jobStart && blockCount + jobBlockCount > maxBlockCount)
+            {
+                break;
+            }
+
+            blockCount += jobBlockCount;
+            jobEnd++;
+        }
+
+        for(size_t job = jobStart; job < jobEnd; job++)
+        {
+            if(!acquireJobTiles(job))
+            {
+                return false;
+            }
+        }
+
+        // the jobs whose tiles were swapped out by the acquisition of the other jobs tiles are run sequentially
+        std::vector<int> parallelJobs;
+        std::vector<size_t> sequentialJobs;
+        for(size_t job = jobStart; job < jobEnd; job++)
+        {
+            if(isJobInCore(job))
+            {
+                parallelJobs.push_back(int(job));
+            }
+            else
+            {
+                sequentialJobs.push_back(job);
+            }
+        }
+
+        int nbFailures = 0;
+        #pragma omp parallel for schedule(dynamic) reduction(+:nbFailures)
+        for(int k = 0; k < int(parallelJobs.size()); k++)
+        {
+            if(!f(size_t(parallelJobs[k])))
+            {
+                nbFailures++;
+            }
+        }
+
+        if(nbFailures > 0)
+        {
+            return false;
+        }
+
+        for(size_t job : sequentialJobs)
+        {
+            if(!acquireJobTiles(job) || !isJobInCore(job) || !f(job))
+            {
+                return false;
+            }
+        }
+
+        jobStart = jobEnd;
+    }
+
+    return true;
+}
+
 template <class T>
 class CachedImage
 {
@@ -76,8 +212,31 @@ public:
     }
 
     template <class UnaryFunction>
-    bool perPixelOperation(UnaryFunction f)
+    bool perPixelOperation(UnaryFunction f, bool parallel = false)
     {
+        if(parallel)
+        {
+            std::vector<RowType> jobsTiles;
+            for(RowType & row : _tilesArray)
+            {
+                for(image::CachedTile::smart_pointer & ptr : row)
+                {
+                    if(ptr)
+                    {
+                        jobsTiles.push_back({ptr});
+                    }
+                }
+            }
+
+            return parallelTilesOperation(jobsTiles, [&jobsTiles, &f](size_t job) -> bool
+            {
+                image::CachedTile::smart_pointer & ptr = jobsTiles[job][0];
+                T* data = (T*)ptr->getDataPointer();
+
+                std::transform(data, data + ptr->getTileWidth() * ptr->getTileHeight(), data, f);
+                return true;
+            });
+        }
 
         for(int i = 0; i < _tilesArray.size(); i++)
         {
@@ -87,6 +246,9 @@ public:
             for(int j = 0; j < _tilesArray[i].size(); j++)
             {
 
+                // row-major sweep, load the next tiles in background
+                prefetchNextTiles(getGridBoundingBox(), i, j, prefetchDistance);
+
                 image::CachedTile::smart_pointer ptr = row[j];
                 if(!ptr)
                 {
@@ -108,13 +270,40 @@ public:
     }
 
     template <class T2, class BinaryFunction>
-    bool perPixelOperation(CachedImage<T2> & other,  BinaryFunction f)
+    bool perPixelOperation(CachedImage<T2> & other,  BinaryFunction f, bool parallel = false)
     {
         if (other.getWidth() != _width || other.getHeight() != _height) 
         {
             return false;
         }
 
+        if(parallel)
+        {
+            std::vector<RowType> jobsTiles;
+            for(int i = 0; i < _tilesArray.size(); i++)
+            {
+                for(int j = 0; j < _tilesArray[i].size(); j++)
+                {
+                    image::CachedTile::smart_pointer ptr = _tilesArray[i][j];
+                    image::CachedTile::smart_pointer ptrOther = other.getTiles()[i][j];
+                    if(ptr && ptrOther)
+                    {
+                        jobsTiles.push_back({ptr, ptrOther});
+                    }
+                }
+            }
+
+            return parallelTilesOperation(jobsTiles, [&jobsTiles, &f](size_t job) -> bool
+            {
+                image::CachedTile::smart_pointer & ptr = jobsTiles[job][0];
+                T* data = (T*)ptr->getDataPointer();
+                T2* dataOther = (T2*)jobsTiles[job][1]->getDataPointer();
+
+                std::transform(data, data + ptr->getTileWidth() * ptr->getTileHeight(), dataOther, data, f);
+                return true;
+            });
+        }
+
         for(int i = 0; i < _tilesArray.size(); i++)
         {
             RowType& row = _tilesArray[i];
@@ -122,6 +311,9 @@ public:
 
             for(int j = 0; j < _tilesArray[i].size(); j++)
             {
+                // row-major sweep, load the next tiles of both images in background
+                prefetchNextTiles(getGridBoundingBox(), i, j, prefetchDistance);
+                other.prefetchNextTiles(other.getGridBoundingBox(), i, j, prefetchDistance);
 
                 image::CachedTile::smart_pointer ptr = row[j];
                 if(!ptr)
@@ -155,12 +347,39 @@ public:
         return true;
     }
 
-    bool deepCopy(CachedImage<T> & source)
+    bool deepCopy(CachedImage<T> & source, bool parallel = false)
     {
         if (source._memoryWidth != _memoryWidth) return false;
         if (source._memoryHeight != _memoryHeight) return false;
         if (source._tileSize != _tileSize) return false;
 
+        if(parallel)
+        {
+            std::vector<RowType> jobsTiles;
+            for(int i = 0; i < _tilesArray.size(); i++)
+            {
+                for(int j = 0; j < _tilesArray[i].size(); j++)
+                {
+                    image::CachedTile::smart_pointer ptr = _tilesArray[i][j];
+                    image::CachedTile::smart_pointer ptrSource = source._tilesArray[i][j];
+                    if(ptr && ptrSource)
+                    {
+                        jobsTiles.push_back({ptr, ptrSource});
+                    }
+                }
+            }
+
+            const int tileSize = _tileSize;
+            return parallelTilesOperation(jobsTiles, [&jobsTiles, tileSize](size_t job) -> bool
+            {
+                T * data = (T*)jobsTiles[job][0]->getDataPointer();
+                T * dataSource = (T*)jobsTiles[job][1]->getDataPointer();
+
+                std::memcpy(data, dataSource, tileSize * tileSize * sizeof(T));
+                return true;
+            });
+        }
+
         for(int i = 0; i < _tilesArray.size(); i++)
         {
             RowType & row = _tilesArray[i];
@@ -201,7 +420,7 @@ public:
         return true;
     }
 
-    bool assign(const aliceVision::image::Image<T>& input, const BoundingBox & inputBb, const BoundingBox & outputBb)
+    bool assign(const aliceVision::image::Image<T>& input, const BoundingBox & inputBb, const BoundingBox & outputBb, bool parallel = false)
     {
         BoundingBox outputMemoryBb;
         outputMemoryBb.left = 0;
@@ -250,20 +469,62 @@ public:
         int delta_y = outputBb.top - snapedBb.top;
         int delta_x = outputBb.left - snapedBb.left;
 
+        // copy the input pixels in the tile (i, j) of the grid bounding box
+        const auto assignTile = [&](int i, int j, T* data)
+        {
+            int oy = (gridBb.top + i) * _tileSize;
+            int sy = inputBb.top - delta_y + i * _tileSize;
+            int ox = (gridBb.left + j) * _tileSize;
+            int sx = inputBb.left - delta_x + j * _tileSize;
+
+            for(int y = 0; y < _tileSize; y++)
+            {
+                for(int x = 0; x < _tileSize; x++)
+                {
+                    if (sy + y < inputBb.top || sy + y > inputBb.getBottom()) continue;
+                    if (sx + x < inputBb.left || sx + x > inputBb.getRight()) continue;
+                    if (oy + y < outputBb.top || oy + y > outputBb.getBottom()) continue;
+                    if (ox + x < outputBb.left || ox + x > outputBb.getRight()) continue;
+
+                    data[y * _tileSize + x] = input(sy + y, sx + x);
+                }
+            }
+        };
+
+        if(parallel)
+        {
+            std::vector<RowType> jobsTiles;
+            std::vector<std::pair<int, int>> jobsCoords;
+            for(int i = 0; i < gridBb.height; i++)
+            {
+                for(int j = 0; j < gridBb.width; j++)
+                {
+                    image::CachedTile::smart_pointer ptr = _tilesArray[gridBb.top + i][gridBb.left + j];
+                    if(ptr)
+                    {
+                        jobsTiles.push_back({ptr});
+                        jobsCoords.emplace_back(i, j);
+                    }
+                }
+            }
+
+            return parallelTilesOperation(jobsTiles, [&](size_t job) -> bool
+            {
+                assignTile(jobsCoords[job].first, jobsCoords[job].second, (T*)jobsTiles[job][0]->getDataPointer());
+                return true;
+            });
+        }
+
         for(int i = 0; i < gridBb.height; i++)
         {
-            //ibb.top + i * tileSize --> snapedBb.top + delta + i * tileSize
             int ti = gridBb.top + i;
-            int oy = ti * _tileSize;
-            int sy = inputBb.top - delta_y + i * _tileSize;
-            
             RowType & row = _tilesArray[ti];
 
             for(int j = 0; j < gridBb.width; j++)
             {
                 int tj = gridBb.left + j;
-                int ox = tj * _tileSize;
-                int sx = inputBb.left - delta_x + j * _tileSize;
+
+                prefetchNextTiles(gridBb, ti, tj, prefetchDistance);
 
                 image::CachedTile::smart_pointer ptr = row[tj];
                 if(!ptr)
@@ -276,20 +537,7 @@ public:
                     continue;
                 }
 
-                T* data = (T*)ptr->getDataPointer();
-
-                for(int y = 0; y < _tileSize; y++)
-                {
-                    for(int x = 0; x < _tileSize; x++)
-                    {
-                        if (sy + y < inputBb.top || sy + y > inputBb.getBottom()) continue;
-                        if (sx + x < inputBb.left || sx + x > inputBb.getRight()) continue;
-                        if (oy + y < outputBb.top || oy + y > outputBb.getBottom()) continue;
-                        if (ox + x < outputBb.left || ox + x > outputBb.getRight()) continue;
-
-                        data[y * _tileSize + x] = input(sy + y, sx + x);
-                    }
-                }
+                assignTile(i, j, (T*)ptr->getDataPointer());
             }
         }
 
@@ -358,6 +606,8 @@ public:
                 int ox = tj * _tileSize;
                 int sx = outputBb.left - delta_x + j * _tileSize;
 
+                prefetchNextTiles(gridBb, ti, tj, prefetchDistance);
+
                 image::CachedTile::smart_pointer ptr = row[tj];
                 if(!ptr)
                 {
@@ -401,6 +651,34 @@ public:
             return false;
         }
 
+        return copyTileToImage(ret, tile);
+    }
+
+    static bool setTileWithImage(image::CachedTile::smart_pointer tile, const image::Image<T> & ret) 
+    {
+        if(!tile)
+        {
+            return false;
+        }
+
+        if(!tile->acquire())
+        {
+            return false;
+        }
+
+        return copyImageToTile(tile, ret);
+    }
+
+    /**
+     * Copy the data of a tile already in core (does not acquire the tile, so it can be called from the parallel jobs)
+     */
+    static bool copyTileToImage(image::Image<T> & ret, const image::CachedTile::smart_pointer & tile) 
+    {
+        if(!tile || tile->getDataPointer() == nullptr)
+        {
+            return false;
+        }
+
         ret.resize(tile->getTileWidth(), tile->getTileHeight());
         T * data = (T*)tile->getDataPointer();
         for (int i = 0; i < tile->getTileHeight(); i++)
@@ -415,24 +693,22 @@ public:
         return true;
     }
 
-    static bool setTileWithImage(image::CachedTile::smart_pointer tile, const image::Image<T> & ret) 
+    /**
+     * Copy an image to a tile already in core (does not acquire the tile, so it can be called from the parallel jobs)
+     */
+    static bool copyImageToTile(const image::CachedTile::smart_pointer & tile, const image::Image<T> & ret) 
     {
-        if (ret.Width() != tile->getTileWidth())
+        if(!tile || tile->getDataPointer() == nullptr)
         {
             return false;
         }
 
-        if (ret.Height() != tile->getTileHeight())
-        {
-            return false;
-        }
-
-        if(!tile)
+        if (ret.Width() != tile->getTileWidth())
         {
             return false;
         }
 
-        if(!tile->acquire())
+        if (ret.Height() != tile->getTileHeight())
         {
             return false;
         }
@@ -450,13 +726,13 @@ public:
         return true;
     }
 
-    bool fill(const T & val) 
+    bool fill(const T & val, bool parallel = false) 
     {
         if (!perPixelOperation(
             [val](T) -> T
             { 
                 return val; 
-            })
+            }, parallel)
         )
         {
             return false;
@@ -473,7 +749,54 @@ public:
 
     int getTileSize() const { return _tileSize; }
 
+    /**
+     * Get the bounding box of the tiles grid (in tiles)
+     */
+    BoundingBox getGridBoundingBox() const
+    {
+        BoundingBox gridBb;
+        gridBb.left = 0;
+        gridBb.top = 0;
+        gridBb.width = _tilesArray.empty() ? 0 : int(_tilesArray[0].size());
+        gridBb.height = int(_tilesArray.size());
+        return gridBb;
+    }
+
+    /**
+     * Ask the cache to load in background the tiles following the tile (ti, tj) in a row-major sweep of a grid bounding box
+     * @param gridBb the swept tiles (in tiles)
+     * @param ti the current tile row
+     * @param tj the current tile column
+     * @param count the number of tiles to prefetch
+     */
+    void prefetchNextTiles(const BoundingBox & gridBb, int ti, int tj, int count)
+    {
+        for(int k = 0; k < count; k++)
+        {
+            tj++;
+            if(tj >= gridBb.left + gridBb.width)
+            {
+                tj = gridBb.left;
+                ti++;
+            }
+
+            if(ti >= gridBb.top + gridBb.height)
+            {
+                return;
+            }
+
+            image::CachedTile::smart_pointer & ptr = _tilesArray[ti][tj];
+            if(ptr)
+            {
+                ptr->prefetch();
+            }
+        }
+    }
+
 private:
+    /// number of tiles loaded in background ahead of the sweeps
+    static constexpr int prefetchDistance = 2;
+
     int _width;
     int _height;
     int _memoryWidth;
@@ -80,6 +80,53 @@ bool CoordinatesMap::build(const std::pair<int, int>& panoramaSize, const geomet
     return true;
 }
 
+bool CoordinatesMap::build(const BoundingBox& coarseBbox, const aliceVision::image::Image<Eigen::Vector2f>& coordinates,
+                           const aliceVision::image::Image<unsigned char>& mask)
+{
+    if(coordinates.Width() != coarseBbox.width || coordinates.Height() != coarseBbox.height ||
+       mask.Width() != coarseBbox.width || mask.Height() != coarseBbox.height)
+    {
+        return false;
+    }
+
+    _coordinates = coordinates;
+    _mask = mask;
+
+    int max_x = 0;
+    int max_y = 0;
+    int min_x = std::numeric_limits<int>::max();
+    int min_y = std::numeric_limits<int>::max();
+
+    for(int y = 0; y < coarseBbox.height; y++)
+    {
+        for(int x = 0; x < coarseBbox.width; x++)
+        {
+            if(!_mask(y, x))
+            {
+                continue;
+            }
+
+            const int cx = x + coarseBbox.left;
+            const int cy = y + coarseBbox.top;
+
+            min_x = std::min(cx, min_x);
+            min_y = std::min(cy, min_y);
+            max_x = std::max(cx, max_x);
+            max_y = std::max(cy, max_y);
+        }
+    }
+
+    _offset_x = coarseBbox.left;
+    _offset_y = coarseBbox.top;
+
+    _boundingBox.left = min_x;
+    _boundingBox.top = min_y;
+    _boundingBox.width = std::max(0, max_x - min_x + 1);
+    _boundingBox.height = std::max(0, max_y - min_y + 1);
+
+    return true;
+}
+
 bool CoordinatesMap::computeScale(double& result, float ratioUpscale)
 {
 
@@ -20,6 +20,15 @@ public:
     bool build(const std::pair<int, int>& panoramaSize, const geometry::Pose3& pose,
                const aliceVision::camera::IntrinsicBase& intrinsics, const BoundingBox& coarseBbox);
 
+    /**
+     * Build coordinates map from precomputed coordinates (e.g. read from a cache)
+     * @param coarseBbox the panorama bounding box of the coordinates
+     * @param coordinates the source image coordinates of the panorama pixels
+     * @param mask the pixels where the coordinates are valid
+     */
+    bool build(const BoundingBox& coarseBbox, const aliceVision::image::Image<Eigen::Vector2f>& coordinates,
+               const aliceVision::image::Image<unsigned char>& mask);
+
     bool computeScale(double& result, float ratioUpscale);
 
     size_t getOffsetX() const { return _offset_x; }
@@ -0,0 +1,281 @@
+#include "coordinatesMapCache.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/stl/hash.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+namespace fs = boost::filesystem;
+
+namespace aliceVision
+{
+
+/// Increment when the content of the cached maps changes
+static const int coordinatesMapCacheVersion = 1;
+
+CoordinatesMapCache::CoordinatesMapCache(const std::string& folder, int tileSize)
+    : _folder(folder)
+    , _tileSize(tileSize)
+{
+    if(!fs::exists(_folder))
+    {
+        fs::create_directories(_folder);
+    }
+}
+
+CoordinatesMapCache::~CoordinatesMapCache() { close(); }
+
+std::string CoordinatesMapCache::computeKey(const std::pair<int, int>& panoramaSize, const geometry::Pose3& pose,
+                                            const camera::IntrinsicBase& intrinsics) const
+{
+    std::size_t seed = 0;
+    stl::hash_combine(seed, coordinatesMapCacheVersion);
+    stl::hash_combine(seed, intrinsics.hashValue());
+    stl::hash_combine(seed, panoramaSize.first);
+    stl::hash_combine(seed, panoramaSize.second);
+    stl::hash_combine(seed, _tileSize);
+
+    const Mat3& rotation = pose.rotation();
+    const Vec3& center = pose.center();
+    for(int i = 0; i < 9; i++)
+    {
+        stl::hash_combine(seed, rotation(i));
+    }
+    for(int i = 0; i < 3; i++)
+    {
+        stl::hash_combine(seed, center(i));
+    }
+
+    std::ostringstream ss;
+    ss << std::hex << std::setw(16) << std::setfill('0') << seed;
+    return ss.str();
+}
+
+std::string CoordinatesMapCache::getPath(const std::string& key, int subMapId) const
+{
+    return (fs::path(_folder) / (key + "_" + std::to_string(subMapId) + ".exr")).string();
+}
+
+int CoordinatesMapCache::getSubMapsCount(const std::string& key) const
+{
+    const std::string path = getPath(key, 0);
+    if(!fs::exists(path))
+    {
+        return 0;
+    }
+
+    std::unique_ptr<oiio::ImageInput> input = oiio::ImageInput::open(path);
+    if(!input)
+    {
+        return 0;
+    }
+
+    const oiio::ImageSpec& spec = input->spec();
+    if(spec.get_string_attribute("AliceVision:coordinatesMapKey") != key)
+    {
+        return 0;
+    }
+
+    // All the sub maps are needed, a missing one invalidates the camera
+    const int subMapsCount = std::max(0, spec.get_int_attribute("AliceVision:subMapsCount", 0));
+    for(int subMapId = 1; subMapId < subMapsCount; subMapId++)
+    {
+        if(!fs::exists(getPath(key, subMapId)))
+        {
+            return 0;
+        }
+    }
+
+    return subMapsCount;
+}
+
+bool CoordinatesMapCache::openForReading(const std::string& key, int subMapId, BoundingBox& globalBbox)
+{
+    close();
+
+    const std::string path = getPath(key, subMapId);
+    if(!fs::exists(path))
+    {
+        return false;
+    }
+
+    _input = oiio::ImageInput::open(path);
+    if(!_input)
+    {
+        return false;
+    }
+
+    const oiio::ImageSpec& spec = _input->spec();
+    if(spec.nchannels != 2 || spec.tile_width != _tileSize || spec.tile_height != _tileSize ||
+       spec.get_string_attribute("AliceVision:coordinatesMapKey") != key)
+    {
+        ALICEVISION_LOG_WARNING("Ignore incompatible cached coordinates map " << path);
+        _input.reset();
+        return false;
+    }
+
+    globalBbox.left = spec.get_int_attribute("AliceVision:offsetX");
+    globalBbox.top = spec.get_int_attribute("AliceVision:offsetY");
+    globalBbox.width = spec.get_int_attribute("AliceVision:width");
+    globalBbox.height = spec.get_int_attribute("AliceVision:height");
+
+    return true;
+}
+
+bool CoordinatesMapCache::openForWriting(const std::string& key, int subMapId, int subMapsCount,
+                                         const BoundingBox& globalBbox)
+{
+    close();
+
+    if(globalBbox.isEmpty())
+    {
+        return false;
+    }
+
+    // Another process may write the same map, the temporary file is unique and renamed once complete
+    const std::string path = getPath(key, subMapId);
+    const std::string tmpPath = path + "." + fs::unique_path().string() + ".tmp.exr";
+
+    _output = oiio::ImageOutput::create(tmpPath);
+    if(!_output)
+    {
+        return false;
+    }
+
+    // Round the size to full tiles, so all the tiles have the tile size
+    const int tilesX = (globalBbox.width + _tileSize - 1) / _tileSize;
+    const int tilesY = (globalBbox.height + _tileSize - 1) / _tileSize;
+
+    oiio::ImageSpec spec(tilesX * _tileSize, tilesY * _tileSize, 2, oiio::TypeDesc::FLOAT);
+    spec.tile_width = _tileSize;
+    spec.tile_height = _tileSize;
+    spec.attribute("compression", "zip");
+    spec.attribute("AliceVision:coordinatesMapKey", key);
+    spec.attribute("AliceVision:subMapsCount", subMapsCount);
+    spec.attribute("AliceVision:offsetX", globalBbox.left);
+    spec.attribute("AliceVision:offsetY", globalBbox.top);
+    spec.attribute("AliceVision:width", globalBbox.width);
+    spec.attribute("AliceVision:height", globalBbox.height);
+
+    if(!_output->open(tmpPath, spec))
+    {
+        _output.reset();
+        return false;
+    }
+
+    _outputPath = path;
+    _tmpOutputPath = tmpPath;
+    _writtenTiles = 0;
+    _tilesCount = tilesX * tilesY;
+
+    return true;
+}
+
+bool CoordinatesMapCache::readTile(CoordinatesMap& map, const BoundingBox& tileBbox, int x, int y)
+{
+    if(tileBbox.width != _tileSize || tileBbox.height != _tileSize)
+    {
+        return false;
+    }
+
+    std::vector<Eigen::Vector2f> buffer(_tileSize * _tileSize);
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if(!_input || !_input->read_tile(x, y, 0, oiio::TypeDesc::FLOAT, buffer.data()))
+        {
+            return false;
+        }
+    }
+
+    aliceVision::image::Image<Eigen::Vector2f> coordinates(_tileSize, _tileSize, true, Eigen::Vector2f::Zero());
+    aliceVision::image::Image<unsigned char> mask(_tileSize, _tileSize, true, 0);
+
+    for(int i = 0; i < _tileSize; i++)
+    {
+        for(int j = 0; j < _tileSize; j++)
+        {
+            const Eigen::Vector2f& value = buffer[i * _tileSize + j];
+            if(std::isnan(value.x()))
+            {
+                continue;
+            }
+
+            coordinates(i, j) = value;
+            mask(i, j) = 1;
+        }
+    }
+
+    return map.build(tileBbox, coordinates, mask);
+}
+
+bool CoordinatesMapCache::writeTile(const CoordinatesMap& map, int x, int y)
+{
+    const aliceVision::image::Image<Eigen::Vector2f>& coordinates = map.getCoordinates();
+    const aliceVision::image::Image<unsigned char>& mask = map.getMask();
+    if(coordinates.Width() != _tileSize || coordinates.Height() != _tileSize)
+    {
+        return false;
+    }
+
+    const float invalid = std::numeric_limits<float>::quiet_NaN();
+    std::vector<Eigen::Vector2f> buffer(_tileSize * _tileSize, Eigen::Vector2f(invalid, invalid));
+
+    for(int i = 0; i < _tileSize; i++)
+    {
+        for(int j = 0; j < _tileSize; j++)
+        {
+            if(mask(i, j))
+            {
+                buffer[i * _tileSize + j] = coordinates(i, j);
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if(!_output || !_output->write_tile(x, y, 0, oiio::TypeDesc::FLOAT, buffer.data()))
+    {
+        return false;
+    }
+
+    _writtenTiles++;
+
+    return true;
+}
+
+bool CoordinatesMapCache::close()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _input.reset();
+
+    if(!_output)
+    {
+        return true;
+    }
+
+    const bool complete = _output->close() && _writtenTiles == _tilesCount;
+    _output.reset();
+
+    boost::system::error_code ec;
+    if(complete)
+    {
+        fs::rename(_tmpOutputPath, _outputPath, ec);
+    }
+
+    if(!complete || ec)
+    {
+        ALICEVISION_LOG_WARNING("The coordinates map " << _outputPath << " was not added to the cache.");
+        fs::remove(_tmpOutputPath, ec);
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace aliceVision
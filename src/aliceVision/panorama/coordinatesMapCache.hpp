@@ -0,0 +1,100 @@
+#pragma once
+
+#include "boundingBox.hpp"
+#include "coordinatesMap.hpp"
+
+#include <aliceVision/image/all.hpp>
+#include <aliceVision/camera/camera.hpp>
+
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace aliceVision
+{
+
+/**
+ * On disk cache of the warping coordinates maps.
+ *
+ * The maps only depend on the camera intrinsics, the camera pose and the panorama resolution,
+ * so the frames of a fixed rig share the same maps. Each map is a tiled EXR with the source image
+ * coordinates of the panorama pixels (NaN where the source is not visible), with the bounding box in its metadata.
+ * The coordinates are stored in float, half floats are not precise enough for the large source images.
+ *
+ * A map is written tile by tile while it is computed, to a temporary file renamed once complete,
+ * and read tile by tile when warping the next frames. The tiles may be read or written from several threads.
+ */
+class CoordinatesMapCache
+{
+public:
+    /**
+     * @param folder the cache folder
+     * @param tileSize the size of the warping tiles
+     */
+    CoordinatesMapCache(const std::string& folder, int tileSize);
+
+    ~CoordinatesMapCache();
+
+    /**
+     * Compute the cache key of a camera
+     * @param panoramaSize the panorama size
+     * @param pose the camera pose
+     * @param intrinsics the camera intrinsics
+     */
+    std::string computeKey(const std::pair<int, int>& panoramaSize, const geometry::Pose3& pose,
+                           const camera::IntrinsicBase& intrinsics) const;
+
+    /**
+     * Get the number of sub maps of a camera in the cache
+     * @return 0 if the camera is not in the cache
+     */
+    int getSubMapsCount(const std::string& key) const;
+
+    /**
+     * Open a cached map for reading
+     * @param globalBbox the panorama bounding box of the map
+     * @return false if the map is not in the cache
+     */
+    bool openForReading(const std::string& key, int subMapId, BoundingBox& globalBbox);
+
+    /**
+     * Start writing a map, the map is added to the cache when closed
+     * @param subMapsCount the number of sub maps of this camera
+     * @param globalBbox the panorama bounding box of the map
+     */
+    bool openForWriting(const std::string& key, int subMapId, int subMapsCount, const BoundingBox& globalBbox);
+
+    /**
+     * Read the map of a tile of the opened map
+     * @param map the tile map
+     * @param tileBbox the panorama bounding box of the tile, the tile is at (x, y) in the map
+     */
+    bool readTile(CoordinatesMap& map, const BoundingBox& tileBbox, int x, int y);
+
+    /**
+     * Write the map of a tile of the opened map, at (x, y) in the map
+     */
+    bool writeTile(const CoordinatesMap& map, int x, int y);
+
+    /**
+     * Close the opened map, a written map is added to the cache if all its tiles were written
+     */
+    bool close();
+
+private:
+    std::string getPath(const std::string& key, int subMapId) const;
+
+    const std::string _folder;
+    const int _tileSize;
+
+    std::unique_ptr<oiio::ImageInput> _input;
+    std::unique_ptr<oiio::ImageOutput> _output;
+    std::string _outputPath;
+    std::string _tmpOutputPath;
+    int _writtenTiles = 0;
+    int _tilesCount = 0;
+
+    std::mutex _mutex;
+};
+
+} // namespace aliceVision
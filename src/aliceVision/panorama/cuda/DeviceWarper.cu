@@ -0,0 +1,309 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "DeviceWarper.hpp"
+
+#include <cuda_runtime.h>
+
+#include <stdexcept>
+#include <string>
+
+namespace aliceVision {
+namespace cuda {
+
+namespace {
+
+/// maximum number of pyramid levels supported by the kernel
+constexpr int maxNbLevels = 16;
+/// block side of the warping kernel
+constexpr int blockSide = 16;
+/// largest half float value, used to clamp the colors
+constexpr float halfMax = 65504.0f;
+
+void throwOnCudaError(cudaError_t err, const std::string& message)
+{
+    if(err != cudaSuccess)
+        throw std::runtime_error(message + ": " + cudaGetErrorString(err));
+}
+
+inline unsigned int divUp(unsigned int a, unsigned int b)
+{
+    return (a % b != 0) ? (a / b + 1) : (a / b);
+}
+
+struct DeviceImage
+{
+    const float* data;
+    int width;
+    int height;
+};
+
+/**
+ * @brief Pyramid given by value to the warping kernel.
+ */
+struct DevicePyramid
+{
+    DeviceImage levels[maxNbLevels];
+    int nbLevels;
+};
+
+__device__ float3 getPixel(const DeviceImage& img, int y, int x)
+{
+    const float* p = img.data + 3 * (size_t(y) * img.width + x);
+    return make_float3(p[0], p[1], p[2]);
+}
+
+/**
+ * @brief Bilinear interpolation of a RGB image, same as image::Sampler2d<image::SamplerLinear>.
+ */
+__device__ float3 sampleLinear(const DeviceImage& img, float y, float x)
+{
+    const float fx = floorf(x);
+    const float fy = floorf(y);
+    const int gridX = static_cast<int>(fx);
+    const int gridY = static_cast<int>(fy);
+
+    const float coefsX[2] = {1.0f - (x - fx), x - fx};
+    const float coefsY[2] = {1.0f - (y - fy), y - fy};
+
+    float3 res = make_float3(0.0f, 0.0f, 0.0f);
+    float totalWeight = 0.0f;
+    for(int i = 0; i < 2; ++i)
+    {
+        const int curI = gridY + i;
+        if(curI < 0 || curI >= img.height)
+            continue;
+
+        for(int j = 0; j < 2; ++j)
+        {
+            const int curJ = gridX + j;
+            if(curJ < 0 || curJ >= img.width)
+                continue;
+
+            const float w = coefsX[j] * coefsY[i];
+            const float3 pix = getPixel(img, curI, curJ);
+            res.x += pix.x * w;
+            res.y += pix.y * w;
+            res.z += pix.z * w;
+            totalWeight += w;
+        }
+    }
+
+    // too unstable, return the nearest pixel
+    if(totalWeight <= 0.2f)
+        return getPixel(img, min(max(gridY, 0), img.height - 1), min(max(gridX, 0), img.width - 1));
+
+    if(totalWeight != 1.0f)
+    {
+        res.x /= totalWeight;
+        res.y /= totalWeight;
+        res.z /= totalWeight;
+    }
+
+    return res;
+}
+
+/**
+ * @brief One thread per map pixel, reproduces GaussianWarper::warp.
+ */
+__global__ void warp_kernel(DevicePyramid pyramid, const float2* coordinates, const unsigned char* mask, int width,
+                            int height, bool clamp, float* color)
+{
+    const int j = blockIdx.x * blockDim.x + threadIdx.x;
+    const int i = blockIdx.y * blockDim.y + threadIdx.y;
+
+    if(i >= height || j >= width)
+        return;
+
+    float* out = color + 3 * (size_t(i) * width + j);
+    const size_t index = size_t(i) * width + j;
+
+    if(!mask[index])
+    {
+        out[0] = 1.0f;
+        out[1] = 0.0f;
+        out[2] = 0.0f;
+        return;
+    }
+
+    const int nextI = (i == height - 1) ? max(i - 1, 0) : i + 1;
+    const int nextJ = (j == width - 1) ? max(j - 1, 0) : j + 1;
+
+    const float2 coordMM = coordinates[index];
+    float3 pixel;
+
+    if(!mask[size_t(nextI) * width + j] || !mask[size_t(i) * width + nextJ])
+    {
+        pixel = sampleLinear(pyramid.levels[0], coordMM.y, coordMM.x);
+    }
+    else
+    {
+        const float2 coordMP = coordinates[size_t(i) * width + nextJ];
+        const float2 coordPM = coordinates[size_t(nextI) * width + j];
+
+        const float dxx = coordPM.x - coordMM.x;
+        const float dxy = coordMP.x - coordMM.x;
+        const float dyx = coordPM.y - coordMM.y;
+        const float dyy = coordMP.y - coordMM.y;
+        const float scale = fabsf(dxx * dyy - dxy * dyx);
+
+        const float flevel = fmaxf(0.0f, 0.5f * log2f(scale));
+        const int blevel = min(pyramid.nbLevels - 1, static_cast<int>(floorf(flevel)));
+
+        const float dscale = exp2f(static_cast<float>(-blevel));
+        const float x = coordMM.x * dscale;
+        const float y = coordMM.y * dscale;
+        const DeviceImage& level = pyramid.levels[blevel];
+
+        // fallback to the first level if outside
+        if(x >= level.width - 1 || y >= level.height - 1)
+        {
+            pixel = sampleLinear(pyramid.levels[0], coordMM.y, coordMM.x);
+        }
+        else
+        {
+            pixel = sampleLinear(level, y, x);
+
+            if(clamp)
+            {
+                pixel.x = fminf(pixel.x, halfMax);
+                pixel.y = fminf(pixel.y, halfMax);
+                pixel.z = fminf(pixel.z, halfMax);
+            }
+        }
+    }
+
+    out[0] = pixel.x;
+    out[1] = pixel.y;
+    out[2] = pixel.z;
+}
+
+} // namespace
+
+DeviceWarper::~DeviceWarper()
+{
+    releasePyramid();
+
+    if(_coordinates_d != nullptr)
+        cudaFree(_coordinates_d);
+    if(_mask_d != nullptr)
+        cudaFree(_mask_d);
+    if(_color_d != nullptr)
+        cudaFree(_color_d);
+}
+
+std::size_t DeviceWarper::getAvailableMemory()
+{
+    size_t freeMemory = 0;
+    size_t totalMemory = 0;
+    throwOnCudaError(cudaMemGetInfo(&freeMemory, &totalMemory), "Cannot get the GPU memory information");
+    return freeMemory / (1024 * 1024);
+}
+
+void DeviceWarper::releasePyramid()
+{
+    for(DeviceLevel& level : _levels)
+        cudaFree(level.data);
+    _levels.clear();
+}
+
+void DeviceWarper::setPyramid(const std::vector<DeviceWarperImage>& levels)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    releasePyramid();
+
+    if(levels.empty() || levels.size() > maxNbLevels)
+        throw std::runtime_error("Unsupported number of pyramid levels: " + std::to_string(levels.size()));
+
+    std::size_t pyramidSize = 0;
+    for(const DeviceWarperImage& level : levels)
+        pyramidSize += std::size_t(level.width) * level.height * 3 * sizeof(float);
+
+    if(pyramidSize / (1024 * 1024) >= getAvailableMemory())
+        throw std::runtime_error("Not enough GPU memory for the source pyramid (" +
+                                 std::to_string(pyramidSize / (1024 * 1024)) + " MB)");
+
+    for(const DeviceWarperImage& level : levels)
+    {
+        const std::size_t size = std::size_t(level.width) * level.height * 3 * sizeof(float);
+
+        DeviceLevel deviceLevel;
+        deviceLevel.width = level.width;
+        deviceLevel.height = level.height;
+        throwOnCudaError(cudaMalloc(&deviceLevel.data, size), "Cannot allocate the pyramid level");
+        _levels.push_back(deviceLevel);
+
+        throwOnCudaError(cudaMemcpy(deviceLevel.data, level.data, size, cudaMemcpyHostToDevice),
+                         "Cannot upload the pyramid level");
+    }
+}
+
+void DeviceWarper::reserveTile(int nbPixels)
+{
+    if(nbPixels <= _tileCapacity)
+        return;
+
+    if(_coordinates_d != nullptr)
+        cudaFree(_coordinates_d);
+    if(_mask_d != nullptr)
+        cudaFree(_mask_d);
+    if(_color_d != nullptr)
+        cudaFree(_color_d);
+    _coordinates_d = nullptr;
+    _mask_d = nullptr;
+    _color_d = nullptr;
+    _tileCapacity = 0;
+
+    throwOnCudaError(cudaMalloc(&_coordinates_d, std::size_t(nbPixels) * 2 * sizeof(float)),
+                     "Cannot allocate the coordinates buffer");
+    throwOnCudaError(cudaMalloc(&_mask_d, std::size_t(nbPixels)), "Cannot allocate the mask buffer");
+    throwOnCudaError(cudaMalloc(&_color_d, std::size_t(nbPixels) * 3 * sizeof(float)),
+                     "Cannot allocate the color buffer");
+    _tileCapacity = nbPixels;
+}
+
+void DeviceWarper::warp(const float* coordinates, const unsigned char* mask, int width, int height, bool clamp,
+                        float* color)
+{
+    if(width <= 0 || height <= 0)
+        return;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if(_levels.empty())
+        throw std::runtime_error("No source pyramid in device memory");
+
+    const int nbPixels = width * height;
+    reserveTile(nbPixels);
+
+    throwOnCudaError(cudaMemcpy(_coordinates_d, coordinates, std::size_t(nbPixels) * 2 * sizeof(float),
+                                cudaMemcpyHostToDevice),
+                     "Cannot upload the coordinates map");
+    throwOnCudaError(cudaMemcpy(_mask_d, mask, std::size_t(nbPixels), cudaMemcpyHostToDevice),
+                     "Cannot upload the mask");
+
+    DevicePyramid pyramid;
+    pyramid.nbLevels = static_cast<int>(_levels.size());
+    for(int l = 0; l < pyramid.nbLevels; ++l)
+    {
+        pyramid.levels[l].data = _levels[l].data;
+        pyramid.levels[l].width = _levels[l].width;
+        pyramid.levels[l].height = _levels[l].height;
+    }
+
+    const dim3 block(blockSide, blockSide, 1);
+    const dim3 grid(divUp(width, blockSide), divUp(height, blockSide), 1);
+    warp_kernel<<<grid, block>>>(pyramid, reinterpret_cast<const float2*>(_coordinates_d), _mask_d, width, height,
+                                 clamp, _color_d);
+    throwOnCudaError(cudaGetLastError(), "Warping kernel failed");
+
+    throwOnCudaError(cudaMemcpy(color, _color_d, std::size_t(nbPixels) * 3 * sizeof(float), cudaMemcpyDeviceToHost),
+                     "Cannot download the warped colors");
+}
+
+} // namespace cuda
+} // namespace aliceVision
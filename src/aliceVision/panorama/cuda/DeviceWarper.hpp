@@ -0,0 +1,91 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace aliceVision {
+namespace cuda {
+
+/**
+ * @brief Host view of a RGB float image (row-major, interleaved channels)
+ */
+struct DeviceWarperImage
+{
+    const float* data = nullptr;
+    int width = 0;
+    int height = 0;
+};
+
+/**
+ * @brief Gaussian pyramid sampling of the panorama warping on the GPU.
+ *
+ * The gaussian pyramid of a source image is uploaded once, then each coordinates map tile is sampled
+ * with the same level selection and bilinear interpolation as GaussianWarper.
+ * The tiles can be warped from several threads, the device calls are serialized.
+ *
+ * @note This class does not depend on the CUDA headers, so it can be used from host code.
+ */
+class DeviceWarper
+{
+public:
+    DeviceWarper() = default;
+    ~DeviceWarper();
+
+    DeviceWarper(const DeviceWarper&) = delete;
+    DeviceWarper& operator=(const DeviceWarper&) = delete;
+
+    /**
+     * @brief Get the available device memory (MB).
+     */
+    static std::size_t getAvailableMemory();
+
+    /**
+     * @brief Upload the gaussian pyramid of the source image, the previous pyramid is released.
+     * @param[in] levels the pyramid levels, from the full resolution
+     * @throw std::runtime_error on CUDA error or if the pyramid does not fit in device memory
+     */
+    void setPyramid(const std::vector<DeviceWarperImage>& levels);
+
+    /**
+     * @brief Sample the source pyramid at the coordinates of a map.
+     * @param[in] coordinates the source image coordinates of each pixel (x, y interleaved)
+     * @param[in] mask the valid pixels of the map
+     * @param[in] width the map width
+     * @param[in] height the map height
+     * @param[in] clamp clamp the colors to the half float range
+     * @param[out] color the warped colors (RGB interleaved, width x height)
+     * @throw std::runtime_error on CUDA error
+     */
+    void warp(const float* coordinates, const unsigned char* mask, int width, int height, bool clamp, float* color);
+
+private:
+    void releasePyramid();
+    void reserveTile(int nbPixels);
+
+    struct DeviceLevel
+    {
+        float* data = nullptr;
+        int width = 0;
+        int height = 0;
+    };
+
+    std::vector<DeviceLevel> _levels;
+
+    /// tile buffers, reused while the tiles are not larger
+    float* _coordinates_d = nullptr;
+    unsigned char* _mask_d = nullptr;
+    float* _color_d = nullptr;
+    int _tileCapacity = 0;
+
+    std::mutex _mutex;
+};
+
+} // namespace cuda
+} // namespace aliceVision
@@ -1,5 +1,7 @@
 #include "feathering.hpp"
 
+#include <functional>
+
 namespace aliceVision
 {
 
@@ -163,7 +165,7 @@ bool feathering(aliceVision::image::Image<image::RGBfColor>& output,
 }
 
 
-bool feathering(CachedImage<image::RGBfColor> & input_output, CachedImage<unsigned char> & inputMask) 
+bool feathering(CachedImage<image::RGBfColor> & input_output, CachedImage<unsigned char> & inputMask, bool parallel) 
 {
     if (input_output.getTileSize() < 2) 
     {
@@ -202,242 +204,285 @@ bool feathering(CachedImage<image::RGBfColor> & input_output, CachedImage<unsign
     gridHeight = pow(2.0, std::ceil(std::log2(float(gridHeight))));
     int gridSize = std::max(gridWidth, gridHeight);
 
-    image::Image<image::RGBfColor> colorTile;
-    image::Image<unsigned char> maskTile;
-
     image::Image<image::RGBfColor> featheredGrid(gridSize, gridSize);
     image::Image<image::RGBfColor> colorGrid(gridSize, gridSize);
     image::Image<unsigned char> maskGrid(gridSize, gridSize, true, 0);
 
-    /*Build the grid color image */
+    /*Each job processes one tile, with its color and mask data*/
+    std::vector<std::vector<image::CachedTile::smart_pointer>> jobsTiles;
+    std::vector<std::pair<int, int>> jobsCoords;
     for (int i = 0; i < tilesColor.size(); i++)
-    {   
-        std::vector<image::CachedTile::smart_pointer> rowColor = tilesColor[i];
-        std::vector<image::CachedTile::smart_pointer> rowMask = tilesMask[i];
+    {
+        for (int j = 0; j < tilesColor[i].size(); j++)
+        {
+            jobsTiles.push_back({tilesColor[i][j], tilesMask[i][j]});
+            jobsCoords.emplace_back(i, j);
+        }
+    }
 
-        for (int j = 0; j < rowColor.size(); j++)
+    const auto runJobs = [&](const std::function<bool(int, int)> & tileFunction) -> bool
+    {
+        if (parallel) 
         {
-            if (!CachedImage<image::RGBfColor>::getTileAsImage(colorTile, rowColor[j])) 
+            return parallelTilesOperation(jobsTiles, [&](size_t job) -> bool
             {
-                return false;
-            }
+                return tileFunction(jobsCoords[job].first, jobsCoords[job].second);
+            });
+        }
 
-            if (!CachedImage<unsigned char>::getTileAsImage(maskTile, rowMask[j])) 
+        for (size_t job = 0; job < jobsTiles.size(); job++)
+        {
+            if (!tileFunction(jobsCoords[job].first, jobsCoords[job].second))
             {
                 return false;
             }
+        }
 
-            while (1) 
-            {
-                image::Image<image::RGBfColor> smallerTile(colorTile.Width() / 2, colorTile.Height() / 2);
-                image::Image<unsigned char> smallerMask(maskTile.Width() / 2, maskTile.Height() / 2);
+        return true;
+    };
 
-                for(int y = 0; y < smallerTile.Height(); y++)
-                {
-                    int dy = y * 2;
-                    for(int x = 0; x < smallerTile.Width(); x++)
-                    {
-                        int dx = x * 2;
+    /*The parallel jobs tiles are already in core, the sequential jobs acquire them*/
+    const auto getColorTile = [parallel](image::Image<image::RGBfColor> & colorTile, const image::CachedTile::smart_pointer & tile)
+    {
+        return parallel ? CachedImage<image::RGBfColor>::copyTileToImage(colorTile, tile) : CachedImage<image::RGBfColor>::getTileAsImage(colorTile, tile);
+    };
 
-                        int count = 0;
+    const auto getMaskTile = [parallel](image::Image<unsigned char> & maskTile, const image::CachedTile::smart_pointer & tile)
+    {
+        return parallel ? CachedImage<unsigned char>::copyTileToImage(maskTile, tile) : CachedImage<unsigned char>::getTileAsImage(maskTile, tile);
+    };
 
-                        smallerTile(y, x) = image::RGBfColor(0.0, 0.0, 0.0);
+    /*Build the grid color image */
+    const auto reduceTile = [&](int ti, int tj) -> bool
+    {
+        image::Image<image::RGBfColor> colorTile;
+        image::Image<unsigned char> maskTile;
 
-                        if(maskTile(dy, dx))
-                        {
-                            smallerTile(y, x) += colorTile(dy, dx);
-                            count++;
-                        }
+        if (!getColorTile(colorTile, tilesColor[ti][tj])) 
+        {
+            return false;
+        }
 
-                        if(maskTile(dy, dx + 1))
-                        {
-                            smallerTile(y, x) += colorTile(dy, dx + 1);
-                            count++;
-                        }
+        if (!getMaskTile(maskTile, tilesMask[ti][tj])) 
+        {
+            return false;
+        }
 
-                        if(maskTile(dy + 1, dx))
-                        {
-                            smallerTile(y, x) += colorTile(dy + 1, dx);
-                            count++;
-                        }
+        while (1) 
+        {
+            image::Image<image::RGBfColor> smallerTile(colorTile.Width() / 2, colorTile.Height() / 2);
+            image::Image<unsigned char> smallerMask(maskTile.Width() / 2, maskTile.Height() / 2);
 
-                        if(maskTile(dy + 1, dx + 1))
-                        {
-                            smallerTile(y, x) += colorTile(dy + 1, dx + 1);
-                            count++;
-                        }
+            for(int y = 0; y < smallerTile.Height(); y++)
+            {
+                int dy = y * 2;
+                for(int x = 0; x < smallerTile.Width(); x++)
+                {
+                    int dx = x * 2;
 
-                        if(count > 0)
-                        {
-                            smallerTile(y, x) /= float(count);
-                            smallerMask(y, x) = 1;
-                        }
-                        else
-                        {
-                            smallerMask(y, x) = 0;
-                        }
+                    int count = 0;
+
+                    smallerTile(y, x) = image::RGBfColor(0.0, 0.0, 0.0);
+
+                    if(maskTile(dy, dx))
+                    {
+                        smallerTile(y, x) += colorTile(dy, dx);
+                        count++;
                     }
-                }
 
-                colorTile = smallerTile;
-                maskTile = smallerMask;
-                if (colorTile.Width() < 2 || colorTile.Height() < 2)
-                {
-                    break;
+                    if(maskTile(dy, dx + 1))
+                    {
+                        smallerTile(y, x) += colorTile(dy, dx + 1);
+                        count++;
+                    }
+
+                    if(maskTile(dy + 1, dx))
+                    {
+                        smallerTile(y, x) += colorTile(dy + 1, dx);
+                        count++;
+                    }
+
+                    if(maskTile(dy + 1, dx + 1))
+                    {
+                        smallerTile(y, x) += colorTile(dy + 1, dx + 1);
+                        count++;
+                    }
+
+                    if(count > 0)
+                    {
+                        smallerTile(y, x) /= float(count);
+                        smallerMask(y, x) = 1;
+                    }
+                    else
+                    {
+                        smallerMask(y, x) = 0;
+                    }
                 }
             }
 
-            maskGrid(i, j) = maskTile(0, 0);
-            colorGrid(i, j) = colorTile(0, 0);
+            colorTile = smallerTile;
+            maskTile = smallerMask;
+            if (colorTile.Width() < 2 || colorTile.Height() < 2)
+            {
+                break;
+            }
         }
-    }
 
+        maskGrid(ti, tj) = maskTile(0, 0);
+        colorGrid(ti, tj) = colorTile(0, 0);
+
+        return true;
+    };
+
+    if (!runJobs(reduceTile)) 
+    {
+        return false;
+    }
 
     if (!feathering(featheredGrid, colorGrid, maskGrid)) 
     {
         return false;
     }
-    
-    for (int i = 0; i < tilesColor.size(); i++)
-    {   
-        std::vector<image::CachedTile::smart_pointer> rowColor = tilesColor[i];
-        std::vector<image::CachedTile::smart_pointer> rowMask = tilesMask[i];
 
-        for (int j = 0; j < rowColor.size(); j++)
+    const auto expandTile = [&](int ti, int tj) -> bool
+    {
+        image::Image<image::RGBfColor> colorTile;
+        image::Image<unsigned char> maskTile;
+
+        if (!getColorTile(colorTile, tilesColor[ti][tj])) 
         {
-            if (!CachedImage<image::RGBfColor>::getTileAsImage(colorTile, rowColor[j])) 
-            {
-                return false;
-            }
+            return false;
+        }
 
-            if (!CachedImage<unsigned char>::getTileAsImage(maskTile, rowMask[j])) 
-            {
-                return false;
-            }
+        if (!getMaskTile(maskTile, tilesMask[ti][tj])) 
+        {
+            return false;
+        }
 
-            std::vector<image::Image<image::RGBfColor>> pyramid_colors;
-            std::vector<image::Image<unsigned char>> pyramid_masks;
+        std::vector<image::Image<image::RGBfColor>> pyramid_colors;
+        std::vector<image::Image<unsigned char>> pyramid_masks;
 
-            pyramid_colors.push_back(colorTile);
-            pyramid_masks.push_back(maskTile);
+        pyramid_colors.push_back(colorTile);
+        pyramid_masks.push_back(maskTile);
 
-            while (1) 
-            {
-                image::Image<image::RGBfColor> & largerTile = pyramid_colors[pyramid_colors.size() - 1];
-                image::Image<unsigned char> & largerMask = pyramid_masks[pyramid_masks.size() - 1];
+        while (1) 
+        {
+            image::Image<image::RGBfColor> & largerTile = pyramid_colors[pyramid_colors.size() - 1];
+            image::Image<unsigned char> & largerMask = pyramid_masks[pyramid_masks.size() - 1];
 
-                image::Image<image::RGBfColor> smallerTile(largerTile.Width() / 2, largerTile.Height() / 2);
-                image::Image<unsigned char> smallerMask(largerMask.Width() / 2, largerMask.Height() / 2);
+            image::Image<image::RGBfColor> smallerTile(largerTile.Width() / 2, largerTile.Height() / 2);
+            image::Image<unsigned char> smallerMask(largerMask.Width() / 2, largerMask.Height() / 2);
 
-                for(int y = 0; y < smallerTile.Height(); y++)
+            for(int y = 0; y < smallerTile.Height(); y++)
+            {
+                int dy = y * 2;
+                for(int x = 0; x < smallerTile.Width(); x++)
                 {
-                    int dy = y * 2;
-                    for(int x = 0; x < smallerTile.Width(); x++)
-                    {
-                        int dx = x * 2;
+                    int dx = x * 2;
 
-                        int count = 0;
+                    int count = 0;
 
-                        smallerTile(y, x) = image::RGBfColor(0.0, 0.0, 0.0);
+                    smallerTile(y, x) = image::RGBfColor(0.0, 0.0, 0.0);
 
-                        if(largerMask(dy, dx))
-                        {
-                            smallerTile(y, x) += largerTile(dy, dx);
-                            count++;
-                        }
-
-                        if(largerMask(dy, dx + 1))
-                        {
-                            smallerTile(y, x) += largerTile(dy, dx + 1);
-                            count++;
-                        }
-
-                        if(largerMask(dy + 1, dx))
-                        {
-                            smallerTile(y, x) += largerTile(dy + 1, dx);
-                            count++;
-                        }
+                    if(largerMask(dy, dx))
+                    {
+                        smallerTile(y, x) += largerTile(dy, dx);
+                        count++;
+                    }
 
-                        if(largerMask(dy + 1, dx + 1))
-                        {
-                            smallerTile(y, x) += largerTile(dy + 1, dx + 1);
-                            count++;
-                        }
+                    if(largerMask(dy, dx + 1))
+                    {
+                        smallerTile(y, x) += largerTile(dy, dx + 1);
+                        count++;
+                    }
 
-                        if(count > 0)
-                        {
-                            smallerTile(y, x) /= float(count);
-                            smallerMask(y, x) = 1;
-                        }
-                        else
-                        {
-                            smallerMask(y, x) = 0;
-                        }
+                    if(largerMask(dy + 1, dx))
+                    {
+                        smallerTile(y, x) += largerTile(dy + 1, dx);
+                        count++;
                     }
-                }
 
+                    if(largerMask(dy + 1, dx + 1))
+                    {
+                        smallerTile(y, x) += largerTile(dy + 1, dx + 1);
+                        count++;
+                    }
 
-                pyramid_colors.push_back(smallerTile);
-                pyramid_masks.push_back(smallerMask);
-                
-                if (smallerTile.Width() < 2 || smallerTile.Height() < 2)
-                {
-                    break;
+                    if(count > 0)
+                    {
+                        smallerTile(y, x) /= float(count);
+                        smallerMask(y, x) = 1;
+                    }
+                    else
+                    {
+                        smallerMask(y, x) = 0;
+                    }
                 }
             }
 
-            image::Image<image::RGBfColor> & img = pyramid_colors[pyramid_colors.size() - 1];
-            image::Image<unsigned char> & mask = pyramid_masks[pyramid_masks.size() - 1];
 
-            if (!mask(0, 0)) 
+            pyramid_colors.push_back(smallerTile);
+            pyramid_masks.push_back(smallerMask);
+            
+            if (smallerTile.Width() < 2 || smallerTile.Height() < 2)
             {
-                mask(0, 0) = 255;
-                img(0, 0) = featheredGrid(i, j);
+                break;
             }
-            
+        }
 
-            for(int lvl = pyramid_colors.size() - 2; lvl >= 0; lvl--)
-            {
+        image::Image<image::RGBfColor> & img = pyramid_colors[pyramid_colors.size() - 1];
+        image::Image<unsigned char> & mask = pyramid_masks[pyramid_masks.size() - 1];
 
-                image::Image<image::RGBfColor> & src = pyramid_colors[lvl];
-                image::Image<unsigned char> & src_mask = pyramid_masks[lvl];
-                image::Image<image::RGBfColor> & ref = pyramid_colors[lvl + 1];
-                image::Image<unsigned char> & ref_mask = pyramid_masks[lvl + 1];
+        if (!mask(0, 0)) 
+        {
+            mask(0, 0) = 255;
+            img(0, 0) = featheredGrid(ti, tj);
+        }
+        
+
+        for(int lvl = pyramid_colors.size() - 2; lvl >= 0; lvl--)
+        {
 
-                for(int i = 0; i < src_mask.Height(); i++)
+            image::Image<image::RGBfColor> & src = pyramid_colors[lvl];
+            image::Image<unsigned char> & src_mask = pyramid_masks[lvl];
+            image::Image<image::RGBfColor> & ref = pyramid_colors[lvl + 1];
+            image::Image<unsigned char> & ref_mask = pyramid_masks[lvl + 1];
+
+            for(int i = 0; i < src_mask.Height(); i++)
+            {
+                for(int j = 0; j < src_mask.Width(); j++)
                 {
-                    for(int j = 0; j < src_mask.Width(); j++)
+                    if(!src_mask(i, j))
                     {
-                        if(!src_mask(i, j))
-                        {
-                            int mi = i / 2;
-                            int mj = j / 2;
-
-                            if(mi >= ref_mask.Height())
-                            {
-                                mi = ref_mask.Height() - 1;
-                            }
+                        int mi = i / 2;
+                        int mj = j / 2;
 
-                            if(mj >= ref_mask.Width())
-                            {
-                                mj = ref_mask.Width() - 1;
-                            }
+                        if(mi >= ref_mask.Height())
+                        {
+                            mi = ref_mask.Height() - 1;
+                        }
 
-                            src_mask(i, j) = ref_mask(mi, mj);
-                            src(i, j) = ref(mi, mj);
+                        if(mj >= ref_mask.Width())
+                        {
+                            mj = ref_mask.Width() - 1;
                         }
+
+                        src_mask(i, j) = ref_mask(mi, mj);
+                        src(i, j) = ref(mi, mj);
                     }
                 }
             }
+        }
 
-            if (!CachedImage<image::RGBfColor>::setTileWithImage(rowColor[j], pyramid_colors[0])) 
-            {
-                return false;
-            }
+        if (parallel) 
+        {
+            return CachedImage<image::RGBfColor>::copyImageToTile(tilesColor[ti][tj], pyramid_colors[0]);
         }
-    }
 
-    return true;
+        return CachedImage<image::RGBfColor>::setTileWithImage(tilesColor[ti][tj], pyramid_colors[0]);
+    };
+
+    return runJobs(expandTile);
 }
 
 } // namespace aliceVision
\ No newline at end of file
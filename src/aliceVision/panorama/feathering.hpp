@@ -11,7 +11,10 @@ bool feathering(aliceVision::image::Image<image::RGBfColor>& output,
                 const aliceVision::image::Image<image::RGBfColor>& color,
                 const aliceVision::image::Image<unsigned char>& inputMask);
 
+/**
+ * Feathering of a cached image, the tiles are processed in parallel if parallel is true
+ */
 bool feathering(CachedImage<image::RGBfColor>& input_output,
-                CachedImage<unsigned char>& inputMask);
+                CachedImage<unsigned char>& inputMask, bool parallel = false);
 
 }
\ No newline at end of file
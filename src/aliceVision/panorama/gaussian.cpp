@@ -1,10 +1,164 @@
 #include "gaussian.hpp"
 
+#include <aliceVision/config.hpp>
+
 #include <OpenImageIO/imagebufalgo.h>
 
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_SSE)
+#include <xmmintrin.h>
+#endif
+
+#include <cstring>
+#include <vector>
+
 namespace aliceVision
 {
 
+namespace
+{
+
+// Normalized binomial kernel 1 4 6 4 1
+const float gaussianWeight0 = 1.0f / 16.0f;
+const float gaussianWeight1 = 4.0f / 16.0f;
+const float gaussianWeight2 = 6.0f / 16.0f;
+
+/**
+ * output[x] = w0 * (r0[x] + r4[x]) + w1 * (r1[x] + r3[x]) + w2 * r2[x]
+ */
+inline void convolve5Taps(float* output, const float* r0, const float* r1, const float* r2, const float* r3,
+                          const float* r4, int count)
+{
+    int x = 0;
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_SSE)
+    const __m128 w0 = _mm_set1_ps(gaussianWeight0);
+    const __m128 w1 = _mm_set1_ps(gaussianWeight1);
+    const __m128 w2 = _mm_set1_ps(gaussianWeight2);
+
+    for(; x + 4 <= count; x += 4)
+    {
+        const __m128 s0 = _mm_add_ps(_mm_loadu_ps(r0 + x), _mm_loadu_ps(r4 + x));
+        const __m128 s1 = _mm_add_ps(_mm_loadu_ps(r1 + x), _mm_loadu_ps(r3 + x));
+        const __m128 s = _mm_add_ps(_mm_add_ps(_mm_mul_ps(w0, s0), _mm_mul_ps(w1, s1)),
+                                    _mm_mul_ps(w2, _mm_loadu_ps(r2 + x)));
+        _mm_storeu_ps(output + x, s);
+    }
+#endif
+
+    for(; x < count; x++)
+    {
+        output[x] = gaussianWeight0 * (r0[x] + r4[x]) + gaussianWeight1 * (r1[x] + r3[x]) + gaussianWeight2 * r2[x];
+    }
+}
+
+/**
+ * Horizontal pass of a row, the padded row has 2 pixels on each side
+ */
+inline void convolveRowFloats(float* output, float* paddedRow, const float* inputRow, int width, int channels,
+                              bool loop)
+{
+    const size_t pixelSize = sizeof(float) * channels;
+
+    std::memcpy(paddedRow + 2 * channels, inputRow, pixelSize * width);
+
+    /* mirror 5432 | 123456 | 5432 */
+    for(int k = 1; k <= 2; k++)
+    {
+        const int left = loop ? width - k : k;
+        const int right = loop ? k - 1 : width - 1 - k;
+
+        std::memcpy(paddedRow + (2 - k) * channels, inputRow + left * channels, pixelSize);
+        std::memcpy(paddedRow + (width + 1 + k) * channels, inputRow + right * channels, pixelSize);
+    }
+
+    convolve5Taps(output, paddedRow, paddedRow + channels, paddedRow + 2 * channels, paddedRow + 3 * channels,
+                  paddedRow + 4 * channels, width * channels);
+}
+
+} // namespace
+
+void convolveGaussian5x5Floats(float* output, const float* input, int width, int height, int channels, bool loop)
+{
+    const int rowSize = width * channels;
+
+    std::vector<float> paddedRow((width + 4) * channels);
+
+    // The last 5 horizontally filtered rows, row y is stored in slot y % 5
+    std::vector<float> rows(5 * rowSize);
+
+    int nextRow = 0;
+    for(int i = 0; i < height; i++)
+    {
+        // The input rows are consumed before the output row i is written, so the filter works in place
+        for(; nextRow < height && nextRow <= i + 2; nextRow++)
+        {
+            convolveRowFloats(&rows[(nextRow % 5) * rowSize], paddedRow.data(), input + nextRow * rowSize, width,
+                              channels, loop);
+        }
+
+        const float* r[5];
+        for(int k = 0; k < 5; k++)
+        {
+            int y = i + k - 2;
+
+            /* mirror rows like columns */
+            if(y < 0)
+            {
+                y = -y;
+            }
+
+            if(y >= height)
+            {
+                y = 2 * height - 2 - y;
+            }
+
+            r[k] = &rows[(y % 5) * rowSize];
+        }
+
+        convolve5Taps(output + i * rowSize, r[0], r[1], r[2], r[3], r[4], rowSize);
+    }
+}
+
+template <>
+bool convolveGaussian5x5<float>(image::Image<float>& output, const image::Image<float>& input, bool loop)
+{
+    if(output.size() != input.size())
+    {
+        return false;
+    }
+
+    if(input.Width() < 3 || input.Height() < 3)
+    {
+        return convolveGaussian5x5Generic<float>(output, input, loop);
+    }
+
+    convolveGaussian5x5Floats(output.data(), input.data(), input.Width(), input.Height(), 1, loop);
+
+    return true;
+}
+
+template <>
+bool convolveGaussian5x5<image::RGBfColor>(image::Image<image::RGBfColor>& output,
+                                           const image::Image<image::RGBfColor>& input, bool loop)
+{
+    static_assert(sizeof(image::RGBfColor) == 3 * sizeof(float), "RGBfColor must be 3 contiguous floats");
+
+    if(output.size() != input.size())
+    {
+        return false;
+    }
+
+    if(input.Width() < 3 || input.Height() < 3)
+    {
+        return convolveGaussian5x5Generic<image::RGBfColor>(output, input, loop);
+    }
+
+    convolveGaussian5x5Floats(reinterpret_cast<float*>(output.data()), reinterpret_cast<const float*>(input.data()),
+                              input.Width(), input.Height(), 3, loop);
+
+    return true;
+}
+
 GaussianPyramidNoMask::GaussianPyramidNoMask(const size_t width_base, const size_t height_base,
                                              const size_t limit_scales)
     : _width_base(width_base)
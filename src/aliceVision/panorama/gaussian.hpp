@@ -105,8 +105,12 @@ inline void convolveColumns(typename image::Image<T>::RowXpr output_row, const i
     }
 }
 
+/**
+ * Reference 5x5 gaussian filter working on any pixel type, one pixel at a time.
+ * The borders are mirrored, or wrapped horizontally if loop is true.
+ */
 template <class T>
-bool convolveGaussian5x5(image::Image<T>& output, const image::Image<T>& input, bool loop = false)
+bool convolveGaussian5x5Generic(image::Image<T>& output, const image::Image<T>& input, bool loop = false)
 {
 
     if(output.size() != input.size())
@@ -168,4 +172,32 @@ bool convolveGaussian5x5(image::Image<T>& output, const image::Image<T>& input,
     return true;
 }
 
+/**
+ * 5x5 gaussian filter on an image made of float channels (row-major, interleaved channels).
+ * The filter is separable, each 5-tap pass processes several floats per instruction (SSE if available).
+ * @param[out] output the filtered image, may be the input image
+ * @param[in] input the input image, at least 3x3 pixels
+ * @param[in] width the image width (pixels)
+ * @param[in] height the image height (pixels)
+ * @param[in] channels the number of floats per pixel
+ * @param[in] loop wrap the columns instead of mirroring them
+ */
+void convolveGaussian5x5Floats(float* output, const float* input, int width, int height, int channels, bool loop);
+
+template <class T>
+bool convolveGaussian5x5(image::Image<T>& output, const image::Image<T>& input, bool loop = false)
+{
+    return convolveGaussian5x5Generic<T>(output, input, loop);
+}
+
+/**
+ * The float and RGB float images use the vectorized filter
+ */
+template <>
+bool convolveGaussian5x5<float>(image::Image<float>& output, const image::Image<float>& input, bool loop);
+
+template <>
+bool convolveGaussian5x5<image::RGBfColor>(image::Image<image::RGBfColor>& output,
+                                           const image::Image<image::RGBfColor>& input, bool loop);
+
 } // namespace aliceVision
\ No newline at end of file
@@ -49,7 +49,7 @@ public:
     using VertexIterator = typename boost::graph_traits<Graph>::vertex_iterator;
 
 public:
-    explicit MaxFlow_AdjList(size_t numNodes)
+    explicit MaxFlow_AdjList(size_t numNodes = 0)
         : _graph(numNodes + 2)
         , _S(NodeType(numNodes))
         , _T(NodeType(numNodes + 1))
@@ -63,6 +63,34 @@ public:
         _graph.m_vertices[numNodes + 1].m_out_edges.reserve(numNodes);
     }
 
+    /**
+     * @brief Remove all the edges and set the number of nodes.
+     * The vertices and their edges lists are kept allocated, so a graph solved repeatedly is only allocated once.
+     */
+    void reset(size_t numNodes)
+    {
+        // The terminals have one edge per node, don't keep them as oversized nodes
+        decltype(_graph.m_vertices[0].m_out_edges)().swap(_graph.m_vertices[_S].m_out_edges);
+        decltype(_graph.m_vertices[0].m_out_edges)().swap(_graph.m_vertices[_T].m_out_edges);
+
+        for(auto& vertex : _graph.m_vertices)
+        {
+            vertex.m_out_edges.clear();
+        }
+        _graph.m_edges.clear();
+        _graph.m_vertices.resize(numNodes + 2);
+
+        _S = NodeType(numNodes);
+        _T = NodeType(numNodes + 1);
+
+        for(int i = 0; i < _S; ++i)
+        {
+            _graph.m_vertices[i].m_out_edges.reserve(9);
+        }
+        _graph.m_vertices[_S].m_out_edges.reserve(numNodes);
+        _graph.m_vertices[_T].m_out_edges.reserve(numNodes);
+    }
+
     inline void addNodeToSource(NodeType n, ValueType source)
     {
         assert(source >= 0);
@@ -108,7 +136,7 @@ public:
     inline ValueType compute()
     {
         vertex_size_type nbVertices(boost::num_vertices(_graph));
-        _color.resize(nbVertices, boost::white_color);
+        _color.assign(nbVertices, boost::white_color);
         std::vector<edge_descriptor> pred(nbVertices);
         std::vector<vertex_size_type> dist(nbVertices);
 
@@ -128,8 +156,8 @@ public:
 protected:
     Graph _graph;
     std::vector<boost::default_color_type> _color;
-    const NodeType _S; //< emptyness
-    const NodeType _T; //< fullness
+    NodeType _S; //< emptyness
+    NodeType _T; //< fullness
 };
 
 
@@ -228,7 +256,10 @@ public:
         _maximal_distance_change = dist; 
     }
 
-    bool createInputOverlappingObservations(image::Image<PixelInfo> & graphCutInput, const BoundingBox & interestBbox)
+    /**
+     * Gather the inputs observations of the pixels of interestBbox which are inside the corridor
+     */
+    bool createInputOverlappingObservations(image::Image<PixelInfo> & graphCutInput, const BoundingBox & interestBbox, const image::Image<unsigned char> & corridor)
     {
         for (auto  & otherInput : _inputs)
         {
@@ -238,10 +269,6 @@ public:
             BoundingBox otherBboxLoopRight = otherInput.second.rect;
             otherBboxLoopRight.left = otherBbox.left + _outputWidth;
 
-            BoundingBox otherInputBbox = otherBbox;
-            otherInputBbox.left = 0;
-            otherInputBbox.top = 0;
-
             BoundingBox intersection = interestBbox.intersectionWith(otherBbox);
             BoundingBox intersectionLoop = interestBbox.intersectionWith(otherBboxLoop);
             BoundingBox intersectionLoopRight = interestBbox.intersectionWith(otherBboxLoopRight);
@@ -250,11 +277,8 @@ public:
                 continue;
             }
             
-            image::Image<image::RGBfColor> otherColor(otherInputBbox.width, otherInputBbox.height);
-            otherColor.block(otherInputBbox.top, otherInputBbox.left, otherInputBbox.height, otherInputBbox.width) = otherInput.second.color.block(otherInputBbox.top, otherInputBbox.left, otherInputBbox.height, otherInputBbox.width);
-
-            image::Image<unsigned char> otherMask(otherInputBbox.width, otherInputBbox.height);
-            otherMask.block(otherInputBbox.top, otherInputBbox.left, otherInputBbox.height, otherInputBbox.width) = otherInput.second.mask.block(otherInputBbox.top, otherInputBbox.left, otherInputBbox.height, otherInputBbox.width);
+            const image::Image<image::RGBfColor> & otherColor = otherInput.second.color;
+            const image::Image<unsigned char> & otherMask = otherInput.second.mask;
  
             if (!intersection.isEmpty())
             {        
@@ -277,7 +301,7 @@ public:
                         int x_current = interestThis.left + x;
                         
 
-                        if (!otherMask(y_other, x_other))
+                        if (!otherMask(y_other, x_other) || !corridor(y_current, x_current))
                         {
                             continue;
                         }
@@ -309,7 +333,7 @@ public:
                         int x_other = interestOther.left + x;
                         int x_current = interestThis.left + x;
 
-                        if (!otherMask(y_other, x_other))
+                        if (!otherMask(y_other, x_other) || !corridor(y_current, x_current))
                         {
                             continue;
                         }
@@ -341,7 +365,7 @@ public:
                         int x_other = interestOther.left + x;
                         int x_current = interestThis.left + x;
 
-                        if (!otherMask(y_other, x_other))
+                        if (!otherMask(y_other, x_other) || !corridor(y_current, x_current))
                         {
                             continue;
                         }
@@ -356,17 +380,18 @@ public:
         return true;
     }
 
-    bool fixUpscaling(image::Image<IndexT> & labels, const image::Image<PixelInfo> & graphCutInput) 
+    bool fixUpscaling(image::Image<IndexT> & labels, const image::Image<PixelInfo> & graphCutInput, const image::Image<unsigned char> & corridor) 
     {
         //Because of upscaling, some labels may be incorrect
         //Some pixels may be affected to labels they don't see.
+        //Those pixels are on the borders of their label, so they are fixed when their own label's corridor is processed.
         for (int y = 0; y < graphCutInput.Height(); y++) 
         {
             for (int x = 0; x < graphCutInput.Width(); x++) 
             {
                 IndexT label = labels(y, x);
 
-                if (label == UndefinedIndexT)
+                if (label == UndefinedIndexT || !corridor(y, x))
                 {
                     continue;
                 }
@@ -496,15 +521,33 @@ public:
             return false;
         }   
 
+        // Only the pixels close to the input seams may change.
+        // The observations and the graph are limited to this corridor (with a margin for the upscaling fix).
+        image::Image<int> distanceMap(localLabels.Width(), localLabels.Height());
+        if (!computeInputDistanceMap(distanceMap, localLabels, input.id))
+        {
+            return false;
+        }
+
+        const float corridorDistance = _maximal_distance_change + 3.0f;
+        image::Image<unsigned char> corridor(localLabels.Width(), localLabels.Height());
+        for (int i = 0; i < corridor.Height(); i++) 
+        {
+            for (int j = 0; j < corridor.Width(); j++)
+            {
+                corridor(i, j) = (sqrt(float(distanceMap(i, j))) <= corridorDistance) ? 1 : 0;
+            }
+        }
+
         //Build the input
         image::Image<PixelInfo> graphCutInput(localBbox.width, localBbox.height, true);
-        if (!createInputOverlappingObservations(graphCutInput, localBbox))
+        if (!createInputOverlappingObservations(graphCutInput, localBbox, corridor))
         {
             return false;
         }
 
         // Fix upscaling induced bad labeling
-        if (!fixUpscaling(localLabels, graphCutInput))
+        if (!fixUpscaling(localLabels, graphCutInput, corridor))
         {
             return false;
         }
@@ -518,8 +561,7 @@ public:
             return false;
         }
 
-        // Compute distance map to borders of the input seams
-        image::Image<int> distanceMap(localLabels.Width(), localLabels.Height());
+        // Compute distance map to borders of the fixed input seams
         if (!computeInputDistanceMap(distanceMap, localLabels, input.id))
         {
             return false;
@@ -605,6 +647,9 @@ public:
             }
         }
 
+        // The graph was reused by all the expansions of this level
+        _maxflow = MaxFlow_AdjList();
+
         return true;
     }
 
@@ -818,8 +863,9 @@ public:
             }
         }  
 
-        //Create graph
-        MaxFlow_AdjList gc(count);
+        //Create graph, reusing the previous expansion allocations
+        MaxFlow_AdjList & gc = _maxflow;
+        gc.reset(count);
         size_t countValid = 0;
 
         for(int y = 0; y < labels.Height(); y++)
@@ -1002,6 +1048,7 @@ private:
     int _outputHeight;
     size_t _maximal_distance_change;
     image::Image<IndexT> _labels;
+    MaxFlow_AdjList _maxflow;
 };
 
 } // namespace aliceVision
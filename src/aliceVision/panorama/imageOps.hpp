@@ -4,20 +4,26 @@
 #include <aliceVision/image/all.hpp>
 #include <aliceVision/half.hpp>
 
+#include <algorithm>
+
 namespace aliceVision {
 
 template <class T>
 bool downscale(aliceVision::image::Image<T>& outputColor, const aliceVision::image::Image<T>& inputColor)
 {
+    if (outputColor.Width() == 0)
+    {
+        return true;
+    }
+
     for(int i = 0; i < outputColor.Height(); i++)
     {
-        int di = i * 2;
+        const T* inputRow = &inputColor(i * 2, 0);
+        T* outputRow = &outputColor(i, 0);
 
         for(int j = 0; j < outputColor.Width(); j++)
         {
-            int dj = j * 2;
-
-            outputColor(i, j) = inputColor(di, dj);
+            outputRow[j] = inputRow[j * 2];
         }
     }
 
@@ -28,72 +34,37 @@ bool downscale(aliceVision::image::Image<T>& outputColor, const aliceVision::ima
 template <class T>
 bool upscale(aliceVision::image::Image<T>& outputColor, const aliceVision::image::Image<T>& inputColor)
 {
+    const int dwidth = std::min<int>(outputColor.Width(), inputColor.Width() * 2);
+    const int dheight = std::min<int>(outputColor.Height(), inputColor.Height() * 2);
 
-    size_t width = inputColor.Width();
-    size_t height = inputColor.Height();
-    size_t dwidth = outputColor.Width();
-    size_t dheight = outputColor.Height();
-
-    for(int i = 0; i < height - 1; i++)
+    if (dwidth == 0)
     {
-        int di = i * 2;
-
-        for(int j = 0; j < width - 1; j++)
-        {
-            int dj = j * 2;
-
-            outputColor(di, dj) = inputColor(i, j);
-            outputColor(di, dj + 1) = T();
-            outputColor(di + 1, dj) = T();
-            outputColor(di + 1, dj + 1) = T();
-        }
+        return true;
     }
 
-    for (int i = 0; i < height; i++)
+    // Input pixels go to the even rows and columns, everything else is filled with 0
+    for(int di = 0; di < dheight; di++)
     {
-        int j = width - 1;
-        int di = i * 2;
-        int dj = j * 2;
-
-        outputColor(di, dj) = inputColor(i, j);
+        T* outputRow = &outputColor(di, 0);
 
-        if (dj < dwidth - 1)
+        if (di % 2)
         {
-            outputColor(di, dj + 1) = T();
+            std::fill(outputRow, outputRow + dwidth, T());
+            continue;
         }
 
-        if (di < dheight - 1)
-        {
-            outputColor(di + 1, dj) = T();
+        const T* inputRow = &inputColor(di / 2, 0);
 
-            if (dj < dwidth - 1)
-            {
-                outputColor(di + 1, dj + 1) = T();
-            }
-        }
-    }
-
-    for (int j = 0; j < width; j++)
-    {
-        int i = height - 1;
-        int di = i * 2;
-        int dj = j * 2;
-
-        outputColor(di, dj) = inputColor(i, j);
-
-        if (dj < dwidth - 1)
+        int dj = 0;
+        for(; dj + 1 < dwidth; dj += 2)
         {
-            outputColor(di, dj + 1) = T();
+            outputRow[dj] = inputRow[dj / 2];
+            outputRow[dj + 1] = T();
         }
 
-        if (di < dheight - 1)
+        if (dj < dwidth)
         {
-            outputColor(di + 1, dj) = T();
-
-            if (dj < dwidth - 1)
-            {
-                outputColor(di + 1, dj + 1) = T();
-            }
+            outputRow[dj] = inputRow[dj / 2];
         }
     }
 
@@ -4,6 +4,8 @@
 #include "gaussian.hpp"
 #include "compositer.hpp"
 
+#include <algorithm>
+
 namespace aliceVision
 {
 
@@ -12,12 +14,20 @@ _baseWidth(base_width),
 _baseHeight(base_height),
 _maxLevels(max_levels)
 {
-    omp_init_lock(&_merge_lock);
+    omp_init_lock(&_inputInfosLock);
 }
 
 LaplacianPyramid::~LaplacianPyramid()
 {
-    omp_destroy_lock(&_merge_lock);
+    omp_destroy_lock(&_inputInfosLock);
+
+    for(std::vector<omp_lock_t>& locks : _bandsLocks)
+    {
+        for(omp_lock_t& lock : locks)
+        {
+            omp_destroy_lock(&lock);
+        }
+    }
 }
 
 bool LaplacianPyramid::initialize() 
@@ -37,6 +47,12 @@ bool LaplacianPyramid::initialize()
         _levels.push_back(color);
         _weights.push_back(weights);
 
+        _bandsLocks.emplace_back((height + _mergeBandHeight - 1) / _mergeBandHeight);
+        for(omp_lock_t& lock : _bandsLocks.back())
+        {
+            omp_init_lock(&lock);
+        }
+
         width = int(ceil(float(width) / 2.0f));
         height = int(ceil(float(height) / 2.0f));
     }
@@ -200,11 +216,7 @@ bool LaplacianPyramid::apply(aliceVision::image::Image<image::RGBfColor>& source
         }
 
         //Merge this view with previous ones
-        omp_set_lock(&_merge_lock);
-        bool res = merge(currentColor, currentWeights, l, offsetX, offsetY);
-        omp_unset_lock(&_merge_lock);
-
-        if (!res)
+        if (!concurrentMerge(currentColor, currentWeights, l, offsetX, offsetY))
         {
             return false;
         }
@@ -229,9 +241,9 @@ bool LaplacianPyramid::apply(aliceVision::image::Image<image::RGBfColor>& source
     iinfo.mask = currentMask;
     iinfo.weights = currentWeights;
 
-    omp_set_lock(&_merge_lock);
+    omp_set_lock(&_inputInfosLock);
     _inputInfos.push_back(iinfo);
-    omp_unset_lock(&_merge_lock);
+    omp_unset_lock(&_inputInfosLock);
     
 
     return true;
@@ -240,11 +252,81 @@ bool LaplacianPyramid::apply(aliceVision::image::Image<image::RGBfColor>& source
 bool LaplacianPyramid::merge(const aliceVision::image::Image<image::RGBfColor>& oimg,
                              const aliceVision::image::Image<float>& oweight, 
                              size_t level, int offsetX, int offsetY)
+{
+    mergeRows(oimg, oweight, level, offsetX, offsetY, 0, _levels[level].Height());
+
+    return true;
+}
+
+bool LaplacianPyramid::concurrentMerge(const aliceVision::image::Image<image::RGBfColor>& oimg,
+                                       const aliceVision::image::Image<float>& oweight,
+                                       size_t level, int offsetX, int offsetY)
+{
+    std::vector<omp_lock_t>& locks = _bandsLocks[level];
+    const int height = _levels[level].Height();
+
+    const int rowStart = std::max(0, offsetY);
+    const int rowEnd = std::min(height, offsetY + int(oimg.Height()));
+    if (rowStart >= rowEnd)
+    {
+        return true;
+    }
+
+    std::vector<int> pendingBands;
+    for (int band = rowStart / _mergeBandHeight; band <= (rowEnd - 1) / _mergeBandHeight; band++)
+    {
+        pendingBands.push_back(band);
+    }
+
+    while (!pendingBands.empty())
+    {
+        // Merge all the bands no other source is currently merging into
+        std::vector<int> busyBands;
+        for (int band : pendingBands)
+        {
+            if (!omp_test_lock(&locks[band]))
+            {
+                busyBands.push_back(band);
+                continue;
+            }
+
+            mergeRows(oimg, oweight, level, offsetX, offsetY, 
+                      std::max(rowStart, band * _mergeBandHeight), 
+                      std::min(rowEnd, (band + 1) * _mergeBandHeight));
+            omp_unset_lock(&locks[band]);
+        }
+
+        if (busyBands.empty())
+        {
+            break;
+        }
+
+        // Everything left is busy, wait for the first band
+        const int band = busyBands.front();
+        omp_set_lock(&locks[band]);
+        mergeRows(oimg, oweight, level, offsetX, offsetY, 
+                  std::max(rowStart, band * _mergeBandHeight), 
+                  std::min(rowEnd, (band + 1) * _mergeBandHeight));
+        omp_unset_lock(&locks[band]);
+
+        busyBands.erase(busyBands.begin());
+        pendingBands.swap(busyBands);
+    }
+
+    return true;
+}
+
+void LaplacianPyramid::mergeRows(const aliceVision::image::Image<image::RGBfColor>& oimg,
+                                 const aliceVision::image::Image<float>& oweight, 
+                                 size_t level, int offsetX, int offsetY, int rowStart, int rowEnd)
 {
     image::Image<image::RGBfColor> & img = _levels[level];
     image::Image<float> & weight = _weights[level];
 
-    for(int i = 0; i < oimg.Height(); i++)
+    const int iStart = std::max(0, rowStart - offsetY);
+    const int iEnd = std::min(int(oimg.Height()), rowEnd - offsetY);
+
+    for(int i = iStart; i < iEnd; i++)
     {   
         int y = i + offsetY;
         if (y < 0 || y >= img.Height()) continue;
@@ -260,9 +342,6 @@ bool LaplacianPyramid::merge(const aliceVision::image::Image<image::RGBfColor>&
             weight(y, x) += oweight(i, j);
         }
     }
-
-
-    return true;
 }
 
 bool LaplacianPyramid::rebuild(image::Image<image::RGBAfColor>& output, const BoundingBox & roi)
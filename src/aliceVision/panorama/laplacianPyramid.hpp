@@ -35,13 +35,31 @@ public:
                const aliceVision::image::Image<float>& oweight,
                size_t level, int offset_x, int offset_y);
 
+    /**
+     * Thread-safe merge, the level rows are split in bands with one lock per band.
+     * The free bands are merged first, so concurrent sources over disjoint regions
+     * of the pyramid do not wait for each other.
+     */
+    bool concurrentMerge(const aliceVision::image::Image<image::RGBfColor>& oimg,
+                         const aliceVision::image::Image<float>& oweight,
+                         size_t level, int offset_x, int offset_y);
+
     bool rebuild(image::Image<image::RGBAfColor>& output, const BoundingBox & roi);
 
 private:
+    void mergeRows(const aliceVision::image::Image<image::RGBfColor>& oimg,
+                   const aliceVision::image::Image<float>& oweight,
+                   size_t level, int offset_x, int offset_y, int rowStart, int rowEnd);
+
+private:
+    /// Number of rows of a level locked together by concurrentMerge
+    static const int _mergeBandHeight = 64;
+
     int _baseWidth;
     int _baseHeight;
     int _maxLevels;
-    omp_lock_t _merge_lock;
+    omp_lock_t _inputInfosLock;
+    std::vector<std::vector<omp_lock_t>> _bandsLocks;
 
     std::vector<image::Image<image::RGBfColor>> _levels;
     std::vector<image::Image<float>> _weights;
@@ -1,6 +1,8 @@
 #include "panoramaMap.hpp"
 
+#include <algorithm>
 #include <iostream>
+#include <iterator>
 #include <list>
 
 namespace aliceVision
@@ -169,38 +171,83 @@ bool PanoramaMap::getIntersectionsList(std::vector<BoundingBox> & intersections,
     return true;
 }
 
-bool PanoramaMap::optimizeChunks(std::vector<std::vector<IndexT>> & chunks, int chunkSize) {
+double PanoramaMap::estimateCompositingCost(IndexT reference) const
+{
+    std::vector<IndexT> overlaps;
+    if (!getOverlaps(overlaps, reference))
+    {
+        return 0.0;
+    }
+
+    double area = 0.0;
+    for (IndexT other : overlaps)
+    {
+        std::vector<BoundingBox> intersections;
+        std::vector<BoundingBox> currentBoundingBoxes;
+        if (!getIntersectionsList(intersections, currentBoundingBoxes, reference, other))
+        {
+            continue;
+        }
+
+        for (const BoundingBox & intersection : intersections)
+        {
+            area += double(intersection.area());
+        }
+    }
+
+    // the base level and each pyramid level
+    return area * double(1 + _scale);
+}
+
+bool PanoramaMap::optimizeChunks(std::vector<std::vector<IndexT>> & chunks, int chunkSize, std::vector<double> * chunksCosts) const
+{
+    if (chunkSize <= 0)
+    {
+        return false;
+    }
 
     int countViews = _map.size();
     int countChunks = divideRoundUp(countViews, chunkSize);
 
+    std::vector<std::pair<double, IndexT>> costs;
+    for (const auto & item : _map)
+    {
+        costs.push_back(std::make_pair(estimateCompositingCost(item.first), item.first));
+    }
+
+    // Longest processing time first: the most expensive views are assigned first, each to the cheapest chunk.
+    // Ties are broken by index so all the chunk processes compute the same distribution.
+    std::sort(costs.begin(), costs.end(), 
+        [](const std::pair<double, IndexT> & first, const std::pair<double, IndexT> & second)
+        {
+            if (first.first != second.first)
+            {
+                return first.first > second.first;
+            }
+
+            return first.second < second.second;
+        }
+    );
+
     chunks.clear();
     chunks.resize(countChunks);
+    std::vector<double> totalCosts(countChunks, 0.0);
 
-    for (auto item : _map) 
+    for (const auto & item : costs)
     {
-        std::sort(chunks.begin(), chunks.end(), 
-            [this](const std::vector<IndexT> & first, const std::vector<IndexT> & second)
-            {
-                size_t size_first = 0;
-                for (int i = 0; i < first.size(); i++) 
-                {
-                    IndexT curIndex = first[i];
-                    size_first += _map.at(curIndex).area();
-                }
-
-                size_t size_second = 0;
-                for (int i = 0; i < second.size(); i++) 
-                {
-                    IndexT curIndex = second[i];
-                    size_second += _map.at(curIndex).area();
-                }
-
-                return (size_first < size_second);
-            }
-        );
+        const int chunkId = std::distance(totalCosts.begin(), std::min_element(totalCosts.begin(), totalCosts.end()));
+        chunks[chunkId].push_back(item.second);
+        totalCosts[chunkId] += item.first;
+    }
 
-        chunks[0].push_back(item.first);
+    for (std::vector<IndexT> & chunk : chunks)
+    {
+        std::sort(chunk.begin(), chunk.end());
+    }
+
+    if (chunksCosts)
+    {
+        *chunksCosts = totalCosts;
     }
 
     return true;
@@ -64,7 +64,19 @@ public:
     
     bool getIntersectionsList(std::vector<BoundingBox> & intersections, std::vector<BoundingBox> & currentBoundingBoxes, const BoundingBox & referenceBoundingBox, const IndexT & otherIndex) const;
 
-    bool optimizeChunks(std::vector<std::vector<IndexT>> & chunks, int chunkSize);
+    /**
+     * Estimate the compositing cost of a reference view:
+     * the area of all the intersections composited in its bounding box times the number of pyramid levels
+     */
+    double estimateCompositingCost(IndexT reference) const;
+
+    /**
+     * Distribute the views in chunks of balanced estimated compositing costs
+     * @param chunks the views of each chunk, sorted by index
+     * @param chunkSize the average number of views per chunk, which defines the number of chunks
+     * @param chunksCosts the estimated compositing cost of each chunk (optional)
+     */
+    bool optimizeChunks(std::vector<std::vector<IndexT>> & chunks, int chunkSize, std::vector<double> * chunksCosts = nullptr) const;
 
 private:
     bool intersect(const BoundingBox & box1, const BoundingBox & box2) const;
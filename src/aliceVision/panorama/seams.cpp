@@ -429,6 +429,11 @@ bool HierarchicalGraphcutSeams::process()
         {
             _graphcuts[level].setMaximalDistance(sqrt(w*w + h*h));
         }
+        else if (_refinementCorridor > 0)
+        {
+            // Only re-solve a band around the upscaled coarser seams
+            _graphcuts[level].setMaximalDistance(_refinementCorridor);
+        }
         else 
         {
             double sw = double(0.2 * w);
@@ -69,6 +69,15 @@ public:
 
     bool process();
 
+    /**
+     * Half width (in pixels) of the corridor around the coarser seams re-solved at the finer levels.
+     * 0 lets the seams move over 20% of the level diagonal.
+     */
+    void setRefinementCorridor(int corridor)
+    {
+        _refinementCorridor = corridor;
+    }
+
     image::Image<IndexT>& getLabels() 
     { 
         return _graphcuts[0].getLabels();
@@ -77,6 +86,8 @@ public:
 private:
     std::vector<GraphcutSeams> _graphcuts;
 
+    int _refinementCorridor = 20;
+
     size_t _countLevels;
     size_t _outputWidth;
     size_t _outputHeight;
@@ -1,5 +1,11 @@
 #include "warper.hpp"
 #include <aliceVision/half.hpp>
+#include <aliceVision/config.hpp>
+#include <aliceVision/system/Logger.hpp>
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+#include <aliceVision/panorama/cuda/DeviceWarper.hpp>
+#endif
 
 namespace aliceVision {
 
@@ -151,4 +157,38 @@ bool GaussianWarper::warp(const CoordinatesMap& map, const GaussianPyramidNoMask
     return true;
 }
 
+bool GaussianWarper::warp(const CoordinatesMap& map, cuda::DeviceWarper& deviceWarper, bool clamp)
+{
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+    static_assert(sizeof(Eigen::Vector2f) == 2 * sizeof(float), "Coordinates must be 2 contiguous floats");
+    static_assert(sizeof(image::RGBfColor) == 3 * sizeof(float), "RGBfColor must be 3 contiguous floats");
+
+    /**
+     * Copy additional info from map
+     */
+    _offset_x = map.getOffsetX();
+    _offset_y = map.getOffsetY();
+    _mask = map.getMask();
+
+    const aliceVision::image::Image<Eigen::Vector2f>& coordinates = map.getCoordinates();
+    _color = aliceVision::image::Image<image::RGBfColor>(coordinates.Width(), coordinates.Height());
+
+    try
+    {
+        deviceWarper.warp(reinterpret_cast<const float*>(coordinates.data()), _mask.data(), coordinates.Width(),
+                          coordinates.Height(), clamp, reinterpret_cast<float*>(_color.data()));
+    }
+    catch(const std::exception& e)
+    {
+        ALICEVISION_LOG_ERROR("GPU warping failed: " << e.what());
+        return false;
+    }
+
+    return true;
+#else
+    ALICEVISION_LOG_ERROR("GPU warping is not available, AliceVision is built without CUDA.");
+    return false;
+#endif
+}
+
 } // namespace aliceVision
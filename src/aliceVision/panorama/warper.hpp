@@ -7,6 +7,10 @@
 namespace aliceVision
 {
 
+namespace cuda {
+class DeviceWarper;
+}
+
 class Warper
 {
 public:
@@ -32,6 +36,12 @@ class GaussianWarper : public Warper
 {
 public:
     virtual bool warp(const CoordinatesMap& map, const GaussianPyramidNoMask& pyramid, bool clamp);
+
+    /**
+     * Same as the pyramid warp, the sampling runs on the GPU (only available with CUDA)
+     * @param deviceWarper holds the source pyramid in device memory
+     */
+    bool warp(const CoordinatesMap& map, cuda::DeviceWarper& deviceWarper, bool clamp);
 };
 
 } // namespace aliceVision
\ No newline at end of file
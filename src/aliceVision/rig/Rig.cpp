@@ -8,6 +8,7 @@
 #include "ResidualError.hpp"
 #include <aliceVision/sfm/BundleAdjustmentCeres.hpp>
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <ceres/rotation.h>
 
@@ -136,7 +137,8 @@ bool Rig::initializeCalibration()
   for(std::size_t iRelativePose = 0 ; iRelativePose < _vRelativePoses.size() ; ++iRelativePose )
   {
     std::size_t iRes = iRelativePose+1;
-    for(std::size_t iView = 0 ; iView < _vLocalizationResults[iRes].size() ; ++iView )
+    #pragma omp parallel for
+    for(int iView = 0 ; iView < static_cast<int>(_vLocalizationResults[iRes].size()) ; ++iView )
     {
       if(  _vLocalizationResults[0][iView].isValid() )
       {
@@ -165,12 +167,13 @@ void Rig::findBestRelativePose(
   const std::vector<localization::LocalizationResult> & resMainCamera = _vLocalizationResults[0];
   const std::vector<localization::LocalizationResult> & resWitnessCamera = _vLocalizationResults[iLocalizer];
   
-  double minReprojError = std::numeric_limits<double>::max();
-  std::size_t iMin = 0;
-  
   assert(vPoses.size() > 0);
   
-  for(std::size_t i=0 ; i < vPoses.size() ; ++i)
+  // each candidate is evaluated over all the frames, the candidates are independent
+  std::vector<double> errors(vPoses.size(), 0.0);
+
+  #pragma omp parallel for schedule(dynamic)
+  for(int i = 0; i < static_cast<int>(vPoses.size()); ++i)
   {
     const geometry::Pose3 & relativePose = vPoses[i];
 
@@ -185,10 +188,18 @@ void Rig::findBestRelativePose(
         error += reprojectionError(resWitnessCamera[j], poseWitnessCamera);
       }
     }
-    if ( error < minReprojError )
+    errors[i] = error;
+  }
+
+  // keep the first minimum, as the sequential search did
+  double minReprojError = std::numeric_limits<double>::max();
+  std::size_t iMin = 0;
+  for(std::size_t i=0 ; i < errors.size() ; ++i)
+  {
+    if ( errors[i] < minReprojError )
     {
       iMin = i;
-      minReprojError = error;
+      minReprojError = errors[i];
     }           
   }
   result = vPoses[iMin];
@@ -328,7 +339,7 @@ bool Rig::optimizeCalibration()
 
   for(auto &elem : vMainPoses)
   {
-    auto pose = elem.second;
+    std::vector<double>& pose = elem.second;
     double * parameter_block = &pose[0];
     assert(parameter_block && "parameter_block is null in vMainPoses");
     problem.AddParameterBlock(parameter_block, 6);
@@ -397,7 +408,9 @@ bool Rig::optimizeCalibration()
   ceres::LossFunction * p_LossFunction = nullptr;//new ceres::HuberLoss(Square(4.0));
   // todo: make the LOSS function and the parameter an option
 
-  // For all visibility add reprojections errors:
+  // List the localization results of the problem, the main camera pose of
+  // the view has to be known for all of them
+  std::vector<std::pair<std::size_t, std::size_t>> vLocalizations;
   for(std::size_t iLocalizer = 0 ; iLocalizer < _vLocalizationResults.size() ; ++iLocalizer)
   {
     const std::vector<localization::LocalizationResult> & currentResult = _vLocalizationResults[iLocalizer];
@@ -412,60 +425,78 @@ bool Rig::optimizeCalibration()
       // main camera, skip it
       if( (iLocalizer != 0) && (!_vLocalizationResults[0][iView].isValid()) )
         continue;
-      
-      // Get the inliers 3D points
-      const Mat & points3D = currentResult[iView].getPt3D();
-      // Get their image locations (also referred as observations)
-      const Mat & points2D = currentResult[iView].getPt2D();
-      
-      // Add a residual block for all inliers
-      for(const IndexT iPoint : currentResult[iView].getInliers() )
+
+      vLocalizations.emplace_back(iLocalizer, iView);
+    }
+  }
+
+  // The cost functions of the inliers are created in parallel, they are added
+  // to the problem sequentially afterwards as ceres::Problem is not thread-safe
+  std::vector<std::vector<ceres::CostFunction*>> vCostFunctions(vLocalizations.size());
+
+  #pragma omp parallel for schedule(dynamic)
+  for(int iLocalization = 0 ; iLocalization < static_cast<int>(vLocalizations.size()) ; ++iLocalization)
+  {
+    const std::size_t iLocalizer = vLocalizations[iLocalization].first;
+    const std::size_t iView = vLocalizations[iLocalization].second;
+    const localization::LocalizationResult & currentResult = _vLocalizationResults[iLocalizer][iView];
+
+    // Get the inliers 3D points
+    const Mat & points3D = currentResult.getPt3D();
+    // Get their image locations (also referred as observations)
+    const Mat & points2D = currentResult.getPt2D();
+
+    std::vector<ceres::CostFunction*> & costFunctions = vCostFunctions[iLocalization];
+    costFunctions.reserve(currentResult.getInliers().size());
+
+    // Add a residual block for all inliers
+    for(const IndexT iPoint : currentResult.getInliers() )
+    {
+      // Each Residual block takes a point and a camera as input and outputs a 2
+      // dimensional residual. Internally, the cost function stores the observations
+      // and the 3D point and compares the reprojection against the observation.
+      if ( iLocalizer == 0 )
       {
-        // Each Residual block takes a point and a camera as input and outputs a 2
-        // dimensional residual. Internally, the cost function stores the observations
-        // and the 3D point and compares the reprojection against the observation.
-        ceres::CostFunction* cost_function;
+        // Vector-2 residual, pose of the rig parameterized by 6 parameters
+        costFunctions.push_back(new ceres::AutoDiffCostFunction<ResidualErrorMainCameraFunctor, 2, 6>(
+          new ResidualErrorMainCameraFunctor(currentResult.getIntrinsics(), points2D.col(iPoint), points3D.col(iPoint))));
+      }
+      else
+      {
+        // Vector-2 residual, pose of the rig parameterized by 6 parameters
+        //                  + relative pose of the secondary camera parameterized by 6 parameters
+        costFunctions.push_back(new ceres::AutoDiffCostFunction<ResidualErrorSecondaryCameraFunctor, 2, 6, 6>(
+          new ResidualErrorSecondaryCameraFunctor(currentResult.getIntrinsics(), points2D.col(iPoint), points3D.col(iPoint))));
+      }
+    }
+  }
 
+  // For all visibility add reprojections errors:
+  for(std::size_t iLocalization = 0 ; iLocalization < vLocalizations.size() ; ++iLocalization)
+  {
+    const std::size_t iLocalizer = vLocalizations[iLocalization].first;
+    const std::size_t iView = vLocalizations[iLocalization].second;
+
+    assert(vMainPoses.find(iView) != vMainPoses.end());
+    double * mainPose = &vMainPoses[iView][0];
+
+    for(ceres::CostFunction * cost_function : vCostFunctions[iLocalization])
+    {
+      if ( iLocalizer == 0 )
+      {
         // Add a residual block for the main camera
-        if ( iLocalizer == 0 )
-        {
-          // Vector-2 residual, pose of the rig parameterized by 6 parameters
-          cost_function = new ceres::AutoDiffCostFunction<ResidualErrorMainCameraFunctor, 2, 6>(
-          new ResidualErrorMainCameraFunctor(currentResult[iView].getIntrinsics(), points2D.col(iPoint), points3D.col(iPoint) ));
-            
-          if (cost_function)
-          {
-            assert(vMainPoses.find(iView) != vMainPoses.end());
-            problem.AddResidualBlock( cost_function,
-                                      p_LossFunction,
-                                      &vMainPoses[iView][0]);
-          }else
-          {
-            ALICEVISION_CERR("Fail in adding residual block for the main camera");
-          }
-
-        }else
+        problem.AddResidualBlock( cost_function,
+                                  p_LossFunction,
+                                  mainPose);
+      }
+      else
+      {
         // Add a residual block for a secondary camera
-        {
-            // Vector-2 residual, pose of the rig parameterized by 6 parameters
-            //                  + relative pose of the secondary camera parameterized by 6 parameters
-            
-            cost_function = new ceres::AutoDiffCostFunction<ResidualErrorSecondaryCameraFunctor, 2, 6, 6>(
-          new ResidualErrorSecondaryCameraFunctor(currentResult[iView].getIntrinsics(), points2D.col(iPoint), points3D.col(iPoint)));
-          
-          if (cost_function)
-          {
-            assert(vMainPoses.find(iView) != vMainPoses.end());
-            assert(iLocalizer-1 < vRelativePoses.size());
-            problem.AddResidualBlock( cost_function,
-                                      p_LossFunction,
-                                      &vMainPoses[iView][0],
-                                      &vRelativePoses[iLocalizer-1][0]);
-          }else
-          {
-            ALICEVISION_CERR("Fail in adding residual block for a secondary camera");
-          }
-        }
+        assert(iLocalizer-1 < vRelativePoses.size());
+        problem.AddResidualBlock( cost_function,
+                                  p_LossFunction,
+                                  mainPose,
+                                  &vRelativePoses[iLocalizer-1][0]);
       }
     }
   }
@@ -481,9 +512,9 @@ bool Rig::optimizeCalibration()
   options.sparse_linear_algebra_library_type = aliceVision_options.sparseLinearAlgebraLibraryType;
   options.minimizer_progress_to_stdout = aliceVision_options.verbose;
   options.logging_type = ceres::SILENT;
-  options.num_threads = 1;//aliceVision_options._nbThreads;
+  options.num_threads = aliceVision_options.nbThreads;
 #if CERES_VERSION_MAJOR < 2
-  options.num_linear_solver_threads = 1;//aliceVision_options._nbThreads;
+  options.num_linear_solver_threads = aliceVision_options.nbThreads;
 #endif
   
   // Solve BA
@@ -549,7 +580,8 @@ bool Rig::optimizeCalibration()
   {
     const std::size_t iLocalizer = iRelativePose+1;
     // Loop over all views
-    for(std::size_t iView = 0; iView < _vLocalizationResults[iLocalizer].size(); ++iView)
+    #pragma omp parallel for
+    for(int iView = 0; iView < static_cast<int>(_vLocalizationResults[iLocalizer].size()); ++iView)
     {
       // If the localization has succeeded then if the witness camera localization succeeded 
       // then update the pose else continue.
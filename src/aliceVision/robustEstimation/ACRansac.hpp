@@ -17,6 +17,7 @@
 #include <iostream>
 #include <iterator>
 #include <limits>
+#include <memory>
 #include <numeric>
 #include <vector>
 
@@ -135,6 +136,11 @@ inline ErrorIndex bestNFA(int startIndex, //number of point required for estimat
  * @param[in] nIter maximum number of consecutive iterations
  * @param[out] model returned model if found
  * @param[in] precision upper bound of the precision (squared error)
+ * @param[in] bailOut reject early the models which are unlikely to beat the best one:
+ *            their errors are first computed on a subset of the data, and the models with
+ *            far less inliers of the best threshold than the best model are not scored.
+ * @param[in] sortedSamples if set, the data indices from the best quality to the worst:
+ *            the data is sampled progressively (PROSAC) until the optimization phase.
  *
  * @return (errorMax, minNFA)
  */
@@ -144,7 +150,9 @@ std::pair<double, double> ACRANSAC(const Kernel& kernel,
                                    std::vector<size_t>& vec_inliers,
                                    std::size_t nIter = 1024,
                                    typename Kernel::ModelT* model = nullptr,
-                                   double precision = std::numeric_limits<double>::infinity())
+                                   double precision = std::numeric_limits<double>::infinity(),
+                                   bool bailOut = false,
+                                   const std::vector<std::size_t>* sortedSamples = nullptr)
 {
   vec_inliers.clear();
 
@@ -157,13 +165,33 @@ std::pair<double, double> ACRANSAC(const Kernel& kernel,
     std::numeric_limits<double>::infinity() :
     precision * kernel.normalizer2()(0,0) * kernel.normalizer2()(0,0);
 
-  std::vector<ErrorIndex> vec_residuals(nData); // [residual,index]
+  std::vector<ErrorIndex> vec_residuals; // [residual,index] of the residuals under the upper bound
+  vec_residuals.reserve(nData);
   std::vector<double> vec_residuals_(nData);
 
   // Possible sampling indices [0,..,nData] (will change in the optimization phase)
   std::vector<size_t> vec_index(nData);
   std::iota(vec_index.begin(), vec_index.end(), 0);
 
+  // Progressive sampling of the data sorted by quality, uniform in the optimization phase
+  std::unique_ptr<ProsacSampler> prosacSampler;
+  if(sortedSamples)
+  {
+    assert(sortedSamples->size() == nData);
+    prosacSampler.reset(new ProsacSampler(*sortedSamples, sizeSample));
+  }
+
+  // Bail-out test: the data in a random order, checked by consecutive subsets
+  const std::size_t bailOutSize = std::max<std::size_t>(10 * sizeSample, nData / 10);
+  const bool useBailOut = bailOut && 2 * bailOutSize <= nData;
+  std::vector<size_t> vec_bailOutIndex;
+  std::size_t bailOutOffset = 0;
+  if(useBailOut)
+  {
+    vec_bailOutIndex = vec_index;
+    std::shuffle(vec_bailOutIndex.begin(), vec_bailOutIndex.end(), randomNumberGenerator);
+  }
+
   // Precompute log combi
   const double loge0 = log10((double)kernel.getMaximumNbModels() * (nData-sizeSample));
   std::vector<float> vec_logc_n, vec_logc_k;
@@ -179,22 +207,45 @@ std::pair<double, double> ACRANSAC(const Kernel& kernel,
 
   bool bACRansacMode = (precision == std::numeric_limits<double>::infinity());
 
+  // Sample indices and models of an iteration, allocated once for all the iterations
+  std::vector<std::size_t> vec_sample(sizeSample);
+  std::vector<typename Kernel::ModelT> vec_models; // Up to max_models solutions
+
   // Main estimation loop.
   for(std::size_t iter = 0; iter < nIter; ++iter)
   {
-    std::vector<std::size_t> vec_sample(sizeSample); // Sample indices
-    if (bACRansacMode)
+    if (prosacSampler)
+      prosacSampler->sample(randomNumberGenerator, vec_sample);
+    else if (bACRansacMode)
       uniformSample(randomNumberGenerator, sizeSample, vec_index, vec_sample); // Get random sample
     else
       uniformSample(randomNumberGenerator, sizeSample, nData, vec_sample); // Get random sample
 
-    std::vector<typename Kernel::ModelT> vec_models; // Up to max_models solutions
+    vec_models.clear();
     kernel.fit(vec_sample, vec_models);
 
     // Evaluate models
     bool better = false;
     for (std::size_t k = 0; k < vec_models.size(); ++k)
     {
+      // Reject the model if it has far less inliers of the best threshold than the best model on a subset
+      if (useBailOut && bACRansacMode && !vec_inliers.empty())
+      {
+        std::size_t nSubsetInliers = 0;
+        for (std::size_t i = 0; i < bailOutSize; ++i)
+        {
+          if (kernel.error(vec_bailOutIndex[(bailOutOffset + i) % nData], vec_models[k]) <= errorMax)
+            ++nSubsetInliers;
+        }
+        bailOutOffset = (bailOutOffset + bailOutSize) % nData;
+
+        // the best model would have more inliers on the subset with a probability close to 1 (3 sigma)
+        const double inlierRatio = vec_inliers.size() / double(nData);
+        const double expectedInliers = bailOutSize * inlierRatio;
+        if (nSubsetInliers < expectedInliers - 3.0 * std::sqrt(expectedInliers * (1.0 - inlierRatio)))
+          continue;
+      }
+
       // Residuals computation and ordering
       kernel.errors(vec_models[k], vec_residuals_);
 
@@ -211,10 +262,13 @@ std::pair<double, double> ACRANSAC(const Kernel& kernel,
       }
       if (bACRansacMode)
       {
+        // only the residuals under the upper bound can be inliers, they are the only ones sorted
+        vec_residuals.clear();
         for (size_t i = 0; i < nData; ++i)
         {
           const double error = vec_residuals_[i];
-          vec_residuals[i] = ErrorIndex(error, i);
+          if (error <= maxThreshold)
+            vec_residuals.emplace_back(error, i);
         }
         std::sort(vec_residuals.begin(), vec_residuals.end());
 
@@ -268,6 +322,7 @@ std::pair<double, double> ACRANSAC(const Kernel& kernel,
       {
         // ACRANSAC optimization: draw samples among best set of inliers so far
         vec_index = vec_inliers;
+        prosacSampler.reset();
         if(nIterReserve)
         {
           nIter = iter + 1 + nIterReserve;
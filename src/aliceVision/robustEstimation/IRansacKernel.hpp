@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <aliceVision/alicevision_omp.hpp>
 #include <aliceVision/numeric/numeric.hpp>
 
 #include <vector>
@@ -52,6 +53,24 @@ class IRansacKernel
    */
   virtual void fit(const std::vector<std::size_t>& samples, std::vector<ModelT>& models) const = 0;
 
+  /**
+   * @brief Estimate the models of several samples with the minimal solver.
+   * The samples are fitted in parallel outside of a parallel region, fit() must be thread-safe.
+   * @param[in] samples The samples, each one a vector of the indices of the data to be used
+   * for the minimal estimation.
+   * @param[out] models The model(s) estimated by the minimal solver for each sample.
+   */
+  virtual void fitBatch(const std::vector<std::vector<std::size_t>>& samples, std::vector<std::vector<ModelT>>& models) const
+  {
+    models.resize(samples.size());
+    #pragma omp parallel for if(samples.size() > 1 && !omp_in_parallel())
+    for(int i = 0; i < static_cast<int>(samples.size()); ++i)
+    {
+      models[i].clear();
+      fit(samples[i], models[i]);
+    }
+  }
+
   /**
    * @brief This function is called to estimate the model using a least squared
    * algorithm from a minumum of \p minSampleLS.
@@ -11,10 +11,12 @@
 #include <aliceVision/robustEstimation/ransacTools.hpp>
 #include <aliceVision/robustEstimation/IRansacKernel.hpp>
 #include <limits>
+#include <memory>
 #include <numeric>
 #include <iostream>
 #include <vector>
 #include <iterator>
+#include <utility>
 
 namespace aliceVision {
 namespace robustEstimation{
@@ -301,6 +303,11 @@ double localOptimization(const Kernel& kernel,
  * @param[in] bVerbose Enable/Disable log messages
  * @param[in] max_iterations Maximum number of iterations for the ransac part.
  * @param[in] outliers_probability The wanted probability of picking outliers.
+ * @param[in] sortedSamples if set, the data indices from the best quality to the worst:
+ * the data is sampled progressively (PROSAC).
+ * @param[in] batchSize The number of samples drawn at once: their models are estimated and scored
+ * in parallel, then the best ones are locally optimized in the sampling order.
+ * The result only depends on the batch size, not on the number of threads.
  * @return The best model found.
  */
 template<typename Kernel, typename Scorer>
@@ -311,7 +318,9 @@ typename Kernel::ModelT LO_RANSAC(const Kernel& kernel,
                                   double* best_score = NULL,
                                   bool bVerbose = false,
                                   std::size_t max_iterations = 100,
-                                  double outliers_probability = 1e-2)
+                                  double outliers_probability = 1e-2,
+                                  const std::vector<std::size_t>* sortedSamples = nullptr,
+                                  std::size_t batchSize = 1)
 {
   assert(outliers_probability < 1.0);
   assert(outliers_probability > 0.0);
@@ -339,19 +348,58 @@ typename Kernel::ModelT LO_RANSAC(const Kernel& kernel,
   std::vector<std::size_t> all_samples(total_samples);
   std::iota(all_samples.begin(), all_samples.end(), 0);
 
-  for(iteration = 0; iteration < max_iterations; ++iteration) 
+  std::unique_ptr<ProsacSampler> prosacSampler;
+  if(sortedSamples)
   {
-    std::vector<std::size_t> sample;
-    uniformSample(randomNumberGenerator, min_samples, total_samples, sample);
+    assert(sortedSamples->size() == total_samples);
+    prosacSampler.reset(new ProsacSampler(*sortedSamples, min_samples));
+  }
+
+  batchSize = std::max<std::size_t>(batchSize, 1);
+  std::vector<std::vector<std::size_t>> batchSamples;
+  std::vector<std::vector<typename Kernel::ModelT>> batchModels;
+  std::vector<std::pair<std::size_t, std::size_t>> batchModelIds; // (sample, model) of each model of the batch
+  std::vector<std::vector<std::size_t>> batchInliers;
+  std::vector<double> batchScores;
+
+  for(iteration = 0; iteration < max_iterations; iteration += batchSamples.size())
+  {
+    // the samples of the batch are drawn before the local optimizations of its models
+    batchSamples.resize(std::min(batchSize, max_iterations - iteration));
+    for(std::vector<std::size_t>& sample : batchSamples)
+    {
+      if(prosacSampler)
+        prosacSampler->sample(randomNumberGenerator, sample);
+      else
+        uniformSample(randomNumberGenerator, min_samples, total_samples, sample);
+    }
 
-    std::vector<typename Kernel::ModelT> models;
-    kernel.fit(sample, models);
+    kernel.fitBatch(batchSamples, batchModels);
 
     // Compute the inlier list for each fit.
-    for(std::size_t i = 0; i < models.size(); ++i) 
+    batchModelIds.clear();
+    for(std::size_t s = 0; s < batchModels.size(); ++s)
+    {
+      for(std::size_t i = 0; i < batchModels[s].size(); ++i)
+        batchModelIds.emplace_back(s, i);
+    }
+    batchInliers.assign(batchModelIds.size(), std::vector<std::size_t>());
+    batchScores.resize(batchModelIds.size());
+
+    #pragma omp parallel for if(batchModelIds.size() > 1 && batchSize > 1 && !omp_in_parallel())
+    for(int m = 0; m < static_cast<int>(batchModelIds.size()); ++m)
+    {
+      const auto& modelId = batchModelIds[m];
+      batchScores[m] = scorer.score(kernel, batchModels[modelId.first][modelId.second], all_samples, batchInliers[m]);
+    }
+
+    for(std::size_t m = 0; m < batchModelIds.size(); ++m)
     {
-      std::vector<std::size_t> inliers;
-      double score = scorer.score(kernel, models.at(i), all_samples, inliers);
+      const std::vector<std::size_t>& sample = batchSamples[batchModelIds[m].first];
+      const std::vector<typename Kernel::ModelT>& models = batchModels[batchModelIds[m].first];
+      const std::size_t i = batchModelIds[m].second;
+      std::vector<std::size_t>& inliers = batchInliers[m];
+      double score = batchScores[m];
       if(bVerbose)
       {
         ALICEVISION_LOG_DEBUG("sample=" << sample);
@@ -395,7 +443,7 @@ typename Kernel::ModelT LO_RANSAC(const Kernel& kernel,
         if(bVerbose)
         {
           ALICEVISION_LOG_DEBUG(" inliers=" << bestNumInliers << "/" << total_samples
-                    << " (iter=" << iteration
+                    << " (iter=" << iteration + batchModelIds[m].first
                     << " ,i=" << i
                     << " ,sample=" << sample
                     << ")");
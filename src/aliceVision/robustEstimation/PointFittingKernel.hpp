@@ -14,6 +14,7 @@
 
 #include <vector>
 #include <cassert>
+#include <utility>
 
 namespace aliceVision {
 namespace robustEstimation {
@@ -77,15 +78,14 @@ public:
   }
 
   /**
-   * @brief Extract required sample and fit model(s) to the sample
+   * @brief Extract required sample and fit model(s) to the sample.
+   *        The sample is copied on the stack if the solver has a fixed-size solveFixed() of its size.
    * @param[in] samples
    * @param[out] models
    */
   inline virtual void fit(const std::vector<std::size_t>& samples, std::vector<ModelT>& models) const
   {
-    const Mat x1 = ExtractColumns(_x1, samples);
-    const Mat x2 = ExtractColumns(_x2, samples);
-    _kernelSolver.solve(x1, x2, models);
+    fitSamples(_kernelSolver, samples, models, 0);
   }
 
   /**
@@ -100,15 +100,15 @@ public:
   }
 
   /**
-   * @brief Return the errors associated to the model and each sample point
+   * @brief Return the errors associated to the model and each sample point.
+   *        They are computed at once over the packed points if the error estimator has a batch errors().
+   * @note A kernel overriding error() must also override errors().
    * @param[in] model
    * @param[out] errors
    */
   inline virtual void errors(const ModelT& model, std::vector<double>& errors) const
   {
-    errors.resize(_x1.cols());
-    for(std::size_t sample = 0; sample < _x1.cols(); ++sample)
-      errors.at(sample) = error(sample, model);
+    computeErrors(_errorEstimator, model, errors, 0);
   }
 
   /**
@@ -122,6 +122,60 @@ public:
 
 protected:
 
+  /// sample fitted by the fixed-size solveFixed() of the solver, without heap allocation
+  template<typename S>
+  auto fitSamples(const S& solver, const std::vector<std::size_t>& samples, std::vector<ModelT>& models, int) const
+    -> decltype(solver.solveFixed(std::declval<const typename S::FixedX1&>(), std::declval<const typename S::FixedX2&>(), models), void())
+  {
+    using FixedX1 = typename S::FixedX1;
+    using FixedX2 = typename S::FixedX2;
+    static_assert(FixedX1::ColsAtCompileTime == FixedX2::ColsAtCompileTime, "The fixed-size points must have the same number of columns.");
+
+    if(samples.size() != FixedX1::ColsAtCompileTime)
+    {
+      fitSamples(solver, samples, models, 0L);
+      return;
+    }
+
+    assert(_x1.rows() == FixedX1::RowsAtCompileTime);
+    assert(_x2.rows() == FixedX2::RowsAtCompileTime);
+
+    FixedX1 x1;
+    FixedX2 x2;
+    for(std::size_t i = 0; i < samples.size(); ++i)
+    {
+      x1.col(i) = _x1.col(samples[i]);
+      x2.col(i) = _x2.col(samples[i]);
+    }
+    solver.solveFixed(x1, x2, models);
+  }
+
+  /// sample extracted in dynamic matrices for the solvers without fixed-size solveFixed()
+  template<typename S>
+  void fitSamples(const S& solver, const std::vector<std::size_t>& samples, std::vector<ModelT>& models, long) const
+  {
+    const Mat x1 = ExtractColumns(_x1, samples);
+    const Mat x2 = ExtractColumns(_x2, samples);
+    solver.solve(x1, x2, models);
+  }
+
+  /// errors computed by the batch errors() of the error estimator
+  template<typename E>
+  auto computeErrors(const E& errorEstimator, const ModelT& model, std::vector<double>& errors, int) const
+    -> decltype(errorEstimator.errors(model, std::declval<const Mat&>(), std::declval<const Mat&>(), errors), void())
+  {
+    errorEstimator.errors(model, _x1, _x2, errors);
+  }
+
+  /// errors computed one sample at a time for the error estimators without batch errors()
+  template<typename E>
+  void computeErrors(const E& errorEstimator, const ModelT& model, std::vector<double>& errors, long) const
+  {
+    errors.resize(_x1.cols());
+    for(std::size_t sample = 0; sample < _x1.cols(); ++sample)
+      errors[sample] = errorEstimator.error(model, _x1.col(sample), _x2.col(sample));
+  }
+
   /// left corresponding data
   const Mat& _x1;
   /// right corresponding data
@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <vector>
+
 namespace aliceVision {
 namespace robustEstimation{
 
@@ -28,10 +30,16 @@ public:
                std::vector<T>& inliers,
                double threshold) const
   {
+    // the errors of all the samples are computed at once by the kernel
+    std::vector<double> errors;
+    const bool allSamples = (samples.size() == kernel.nbSamples());
+    if(allSamples)
+      kernel.errors(model, errors);
+
     double cost = 0.0;
     for(std::size_t j = 0; j < samples.size(); ++j)
     {
-      double error = kernel.error(samples.at(j), model);
+      double error = allSamples ? errors[samples[j]] : kernel.error(samples.at(j), model);
       if (error < threshold) 
       {
         cost += error;
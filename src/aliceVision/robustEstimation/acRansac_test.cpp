@@ -271,3 +271,73 @@ BOOST_AUTO_TEST_CASE(RansacLineFitter_ACRANSACSimu)
 
   }
 }
+
+// test the bail-out test of ACRANSAC on a large dataset with outliers:
+// it finds the line and about as many inliers as the complete scoring of the models
+BOOST_AUTO_TEST_CASE(RansacLineFitter_ACRANSACBailOut)
+{
+  const int S = 100;
+  Vec2 GTModel;
+  GTModel << -2, .3;
+  std::mt19937 gen;
+
+  const std::size_t numPoints = 2000;
+  Mat2X points(2, numPoints);
+  std::vector<std::size_t> vec_inliersGT;
+  generateLine(numPoints, 0.5, 0.5, GTModel, gen, points, vec_inliersGT);
+
+  LineKernel lineKernel(points, S, S);
+
+  std::mt19937 randomNumberGenerator(42);
+  robustEstimation::MatrixModel<Vec2> model;
+  std::vector<std::size_t> vec_inliers;
+  ACRANSAC(lineKernel, randomNumberGenerator, vec_inliers, 1000, &model);
+
+  std::mt19937 bailOutRandomNumberGenerator(42);
+  robustEstimation::MatrixModel<Vec2> bailOutModel;
+  std::vector<std::size_t> vec_bailOutInliers;
+  ACRANSAC(lineKernel, bailOutRandomNumberGenerator, vec_bailOutInliers, 1000, &bailOutModel,
+           std::numeric_limits<double>::infinity(), true);
+
+  BOOST_CHECK(vec_bailOutInliers.size() <= vec_inliersGT.size());
+  BOOST_CHECK_GE(vec_bailOutInliers.size(), 0.95 * vec_inliers.size());
+  BOOST_CHECK_SMALL(GTModel(0) - bailOutModel.getMatrix()[0], 1.0);
+  BOOST_CHECK_SMALL(GTModel(1) - bailOutModel.getMatrix()[1], 0.05);
+}
+
+BOOST_AUTO_TEST_CASE(RansacLineFitter_ACRANSACProsac)
+{
+  const int S = 100;
+  Vec2 GTModel;
+  GTModel << -2, .3;
+  std::mt19937 gen;
+
+  const std::size_t numPoints = 1000;
+  Mat2X points(2, numPoints);
+  std::vector<std::size_t> vec_inliersGT;
+  generateLine(numPoints, 0.7, 0.5, GTModel, gen, points, vec_inliersGT);
+
+  // the inliers sorted first, as the matches of good quality: few iterations are needed
+  std::vector<std::size_t> sortedSamples = vec_inliersGT;
+  std::vector<bool> isInlier(numPoints, false);
+  for(const std::size_t i : vec_inliersGT)
+    isInlier[i] = true;
+  for(std::size_t i = 0; i < numPoints; ++i)
+  {
+    if(!isInlier[i])
+      sortedSamples.push_back(i);
+  }
+
+  LineKernel lineKernel(points, S, S);
+
+  std::mt19937 randomNumberGenerator(42);
+  robustEstimation::MatrixModel<Vec2> model;
+  std::vector<std::size_t> vec_inliers;
+  ACRANSAC(lineKernel, randomNumberGenerator, vec_inliers, 50, &model,
+           std::numeric_limits<double>::infinity(), false, &sortedSamples);
+
+  BOOST_CHECK(vec_inliers.size() <= vec_inliersGT.size());
+  BOOST_CHECK_GE(vec_inliers.size(), 0.9 * vec_inliersGT.size());
+  BOOST_CHECK_SMALL(GTModel(0) - model.getMatrix()[0], 1.0);
+  BOOST_CHECK_SMALL(GTModel(1) - model.getMatrix()[1], 0.05);
+}
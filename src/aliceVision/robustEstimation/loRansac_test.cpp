@@ -113,3 +113,33 @@ BOOST_AUTO_TEST_CASE(LoRansacLineFitter_RealCaseLoRansac)
     BOOST_CHECK_EQUAL(expectedInliers, inliers.size());
   }
 }
+
+BOOST_AUTO_TEST_CASE(LoRansacLineFitter_BatchLoRansac)
+{
+  const std::size_t numPoints = 300;
+  const double outlierRatio = .3;
+  const double gaussianNoiseLevel = 0.01;
+  const std::size_t numTrials = 10;
+
+  Vec2 GTModel; // y = 2x + 1
+  GTModel << -2, .3;
+
+  std::mt19937 gen;
+
+  for(std::size_t trial = 0; trial < numTrials; ++trial)
+  {
+    Mat2X xy(2, numPoints);
+    std::vector<std::size_t> vec_inliersGT;
+    generateLine(numPoints, outlierRatio, gaussianNoiseLevel, GTModel, gen, xy, vec_inliersGT);
+
+    LineKernel kernel(xy);
+    const ScoreEvaluator<LineKernel> scorer(3 * gaussianNoiseLevel);
+
+    // the models of the samples of a batch are estimated and scored at once
+    std::vector<std::size_t> inliers;
+    LO_RANSAC(kernel, scorer, gen, &inliers, nullptr, false, 100, 1e-2, nullptr, 16);
+
+    const std::size_t expectedInliers = numPoints - (std::size_t) numPoints * outlierRatio;
+    BOOST_CHECK_EQUAL(expectedInliers, inliers.size());
+  }
+}
@@ -10,11 +10,13 @@
 #include <set>
 #include <unordered_set>
 #include <algorithm>
+#include <cmath>
 #include <cstdlib>
 #include <numeric>
 #include <random>
 #include <numeric>
 #include <cassert>
+#include <vector>
 
 namespace aliceVision {
 namespace robustEstimation{
@@ -164,5 +166,90 @@ inline void uniformSample(std::mt19937 & randomNumberGenerator,
   }
 }
 
+/**
+ * @brief Progressive sampling of the data sorted by quality (PROSAC).
+ *
+ * The samples are drawn from a subset of the best data which grows with the iterations:
+ * each sample contains the last element of the subset and random elements before it.
+ * The subset grows so that the samples are drawn as often as in a uniform sampling of
+ * the subset after growthIterations iterations, then the samples are uniform on all the data.
+ * The first models are thus estimated from the best data, likely to be inliers.
+ *
+ * @ref Ondrej Chum, Jiri Matas.
+ *      Matching with PROSAC - Progressive Sample Consensus.
+ *      CVPR 2005.
+ */
+class ProsacSampler
+{
+public:
+  /**
+   * @param[in] sortedIndices The data indices from the best quality to the worst.
+   * @param[in] sampleSize The size of the samples.
+   * @param[in] growthIterations The number of iterations after which the samples are uniform on all the data.
+   */
+  ProsacSampler(const std::vector<std::size_t>& sortedIndices,
+                std::size_t sampleSize,
+                std::size_t growthIterations = 200000)
+    : _sortedIndices(sortedIndices)
+    , _sampleSize(sampleSize)
+    , _subsetSize(sampleSize)
+  {
+    assert(sampleSize > 0 && sampleSize <= sortedIndices.size());
+
+    // number of the growthIterations uniform samples of all the data drawn from the first sampleSize elements
+    _subsetNbSamples = static_cast<double>(growthIterations);
+    for(std::size_t i = 0; i < sampleSize; ++i)
+      _subsetNbSamples *= static_cast<double>(sampleSize - i) / static_cast<double>(sortedIndices.size() - i);
+  }
+
+  /**
+   * @brief Draw the sample of the next iteration.
+   * @param[in] randomNumberGenerator the random number generator to use
+   * @param[out] sample The sampleSize data indices of the sample.
+   */
+  void sample(std::mt19937 & randomNumberGenerator, std::vector<std::size_t>& sample)
+  {
+    ++_iteration;
+
+    // grow the subset once its samples are drawn
+    if(_iteration > _subsetIteration && _subsetSize < _sortedIndices.size())
+    {
+      const double nextNbSamples = _subsetNbSamples * (_subsetSize + 1) / (_subsetSize + 1 - _sampleSize);
+      _subsetIteration += static_cast<std::size_t>(std::ceil(nextNbSamples - _subsetNbSamples));
+      _subsetNbSamples = nextNbSamples;
+      ++_subsetSize;
+    }
+
+    if(_iteration > _subsetIteration)
+    {
+      // all the data is used: uniform sampling
+      sample = randSample<std::size_t>(randomNumberGenerator, 0, _subsetSize, _sampleSize);
+    }
+    else
+    {
+      // the last element of the subset and random elements before it
+      sample = randSample<std::size_t>(randomNumberGenerator, 0, _subsetSize - 1, _sampleSize - 1);
+      sample.push_back(_subsetSize - 1);
+    }
+
+    for(auto& s : sample)
+      s = _sortedIndices[s];
+  }
+
+  /// The number of the best data elements the samples are currently drawn from
+  std::size_t getSubsetSize() const { return _subsetSize; }
+
+private:
+  std::vector<std::size_t> _sortedIndices;
+  std::size_t _sampleSize;
+  /// size of the subset of the best data elements
+  std::size_t _subsetSize;
+  /// number of samples of the subset drawn by a uniform sampling of growthIterations iterations
+  double _subsetNbSamples = 0.0;
+  /// iteration until which the samples contain the last element of the subset
+  std::size_t _subsetIteration = 1;
+  std::size_t _iteration = 0;
+};
+
 } // namespace robustEstimation
 } // namespace aliceVision
@@ -120,3 +120,43 @@ BOOST_AUTO_TEST_CASE(UniformSampleTest_randSample) {
     }
   }
 }
+
+BOOST_AUTO_TEST_CASE(ProsacSamplerTest_progressiveSubset) {
+  std::mt19937 randomNumberGenerator;
+
+  const std::size_t nData = 100;
+  const std::size_t sampleSize = 4;
+  const std::size_t growthIterations = 1000;
+
+  // the best data last
+  std::vector<std::size_t> sortedIndices(nData);
+  for(std::size_t i = 0; i < nData; ++i)
+    sortedIndices[i] = nData - 1 - i;
+
+  ProsacSampler sampler(sortedIndices, sampleSize, growthIterations);
+  std::vector<std::size_t> sample;
+
+  // the first sample is the best data
+  sampler.sample(randomNumberGenerator, sample);
+  BOOST_CHECK_EQUAL(sampler.getSubsetSize(), sampleSize);
+  BOOST_CHECK_EQUAL(std::set<std::size_t>(sample.begin(), sample.end()).size(), sampleSize);
+  for(const auto& s : sample)
+    BOOST_CHECK(s >= nData - sampleSize);
+
+  std::size_t subsetSize = sampler.getSubsetSize();
+  // the growth iterations are rounded up at each subset size
+  for(std::size_t iter = 1; iter < growthIterations + nData; ++iter)
+  {
+    sampler.sample(randomNumberGenerator, sample);
+    BOOST_CHECK(sampler.getSubsetSize() >= subsetSize);
+    subsetSize = sampler.getSubsetSize();
+
+    // no repetitions, only the data of the subset
+    BOOST_CHECK_EQUAL(std::set<std::size_t>(sample.begin(), sample.end()).size(), sampleSize);
+    for(const auto& s : sample)
+      BOOST_CHECK(s >= nData - subsetSize);
+  }
+
+  // all the data is sampled at the end of the growth
+  BOOST_CHECK_EQUAL(subsetSize, nData);
+}
@@ -33,8 +33,24 @@ struct Datasheet
     , _sensorWidth(sensorWidth)
   {}
 
+  /**
+   * @brief Fuzzy comparison of the brand and model names (see normalizeName),
+   *        a name may be a prefix (brand) or a suffix (model) of the other
+   */
   bool operator==(const Datasheet& other) const;
 
+  /**
+   * @brief Normalize a brand or model name for the comparisons:
+   *        lower case without punctuation nor spaces
+   */
+  static std::string normalizeName(const std::string& name);
+
+  /**
+   * @brief Fuzzy comparison of normalized brand and model names
+   */
+  static bool isMatching(const std::string& normalizedBrandA, const std::string& normalizedModelA,
+                         const std::string& normalizedBrandB, const std::string& normalizedModelB);
+
   std::string _brand;
   std::string _model;
   double _sensorWidth;
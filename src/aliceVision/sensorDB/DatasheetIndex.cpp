@@ -0,0 +1,53 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "DatasheetIndex.hpp"
+
+namespace aliceVision {
+namespace sensorDB {
+
+DatasheetIndex::DatasheetIndex(const std::vector<Datasheet>& databaseStructure)
+  : _datasheets(databaseStructure)
+{
+  _normalizedNames.reserve(_datasheets.size());
+  _index.reserve(_datasheets.size());
+
+  for(std::size_t i = 0; i < _datasheets.size(); ++i)
+  {
+    const std::string brand = Datasheet::normalizeName(_datasheets[i]._brand);
+    const std::string model = Datasheet::normalizeName(_datasheets[i]._model);
+    _index.emplace(getKey(brand, model), i); // keep the first datasheet of the same names
+    _normalizedNames.emplace_back(brand, model);
+  }
+}
+
+bool DatasheetIndex::getInfo(const std::string& brand, const std::string& model, Datasheet& datasheetContent) const
+{
+  const std::string normalizedBrand = Datasheet::normalizeName(brand);
+  const std::string normalizedModel = Datasheet::normalizeName(model);
+
+  const auto it = _index.find(getKey(normalizedBrand, normalizedModel));
+  if(it != _index.end())
+  {
+    datasheetContent = _datasheets[it->second];
+    return true;
+  }
+
+  // fuzzy fallback, the first matching datasheet like sensorDB::getInfo
+  for(std::size_t i = 0; i < _datasheets.size(); ++i)
+  {
+    if(Datasheet::isMatching(_normalizedNames[i].first, _normalizedNames[i].second, normalizedBrand, normalizedModel))
+    {
+      datasheetContent = _datasheets[i];
+      return true;
+    }
+  }
+
+  return false;
+}
+
+} // namespace sensorDB
+} // namespace aliceVision
@@ -0,0 +1,61 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/sensorDB/Datasheet.hpp>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace aliceVision {
+namespace sensorDB {
+
+/**
+ * @brief Sensor database indexed by normalized brand / model names.
+ *
+ * An exact match of the normalized names is found in constant time,
+ * the fuzzy comparison of Datasheet is the fallback (on the names normalized once).
+ * The lookups are const and can be done from several threads.
+ */
+class DatasheetIndex
+{
+public:
+  DatasheetIndex() = default;
+
+  /**
+   * @param[in] databaseStructure The database in memory
+   */
+  explicit DatasheetIndex(const std::vector<Datasheet>& databaseStructure);
+
+  /**
+   * @brief Get information for the given camera brand / model
+   * @param[in] brand The camera brand
+   * @param[in] model The camera model
+   * @param[out] datasheetContent The corresponding datasheet
+   * @return True if ok
+   */
+  bool getInfo(const std::string& brand, const std::string& model, Datasheet& datasheetContent) const;
+
+  std::size_t size() const { return _datasheets.size(); }
+  bool empty() const { return _datasheets.empty(); }
+
+private:
+  static std::string getKey(const std::string& normalizedBrand, const std::string& normalizedModel)
+  {
+    return normalizedBrand + '\n' + normalizedModel;
+  }
+
+  std::vector<Datasheet> _datasheets;
+  /// normalized brand and model of the datasheets
+  std::vector<std::pair<std::string, std::string>> _normalizedNames;
+  /// first datasheet index of the normalized names
+  std::unordered_map<std::string, std::size_t> _index;
+};
+
+} // namespace sensorDB
+} // namespace aliceVision
@@ -65,5 +65,28 @@ bool getInfo(const std::string& brand, const std::string& model, const std::vect
   return true;
 }
 
+std::map<std::pair<std::string, std::string>, Datasheet> getInfos(const std::set<std::pair<std::string, std::string>>& cameras,
+                                                                  const DatasheetIndex& databaseIndex)
+{
+  const std::vector<std::pair<std::string, std::string>> camerasVec(cameras.begin(), cameras.end());
+  std::vector<int> found(camerasVec.size(), 0);
+  std::vector<Datasheet> datasheets(camerasVec.size());
+
+  // the cameras without exact match are compared to all the database entries
+  #pragma omp parallel for schedule(dynamic)
+  for(int i = 0; i < camerasVec.size(); ++i)
+  {
+    found[i] = databaseIndex.getInfo(camerasVec[i].first, camerasVec[i].second, datasheets[i]);
+  }
+
+  std::map<std::pair<std::string, std::string>, Datasheet> datasheetsMap;
+  for(int i = 0; i < camerasVec.size(); ++i)
+  {
+    if(found[i])
+      datasheetsMap.emplace(camerasVec[i], datasheets[i]);
+  }
+  return datasheetsMap;
+}
+
 } // namespace sensorDB
 } // namespace aliceVision
@@ -8,7 +8,10 @@
 #pragma once
 
 #include <aliceVision/sensorDB/Datasheet.hpp>
+#include <aliceVision/sensorDB/DatasheetIndex.hpp>
 
+#include <map>
+#include <set>
 #include <vector>
 #include <string>
 
@@ -33,5 +36,14 @@ bool parseDatabase(const std::string& databaseFilePath, std::vector<Datasheet>&
  */
 bool getInfo(const std::string& brand, const std::string& model, const std::vector<Datasheet>& databaseStructure, Datasheet& datasheetContent);
 
+/**
+ * @brief Get information for several camera brand / model at once
+ * @param[in] cameras The camera brands and models
+ * @param[in] databaseIndex The indexed database
+ * @return The datasheets of the cameras found in the database
+ */
+std::map<std::pair<std::string, std::string>, Datasheet> getInfos(const std::set<std::pair<std::string, std::string>>& cameras,
+                                                                  const DatasheetIndex& databaseIndex);
+
 } // namespace sensorDB
 } // namespace aliceVision
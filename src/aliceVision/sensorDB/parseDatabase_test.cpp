@@ -112,3 +112,45 @@ BOOST_AUTO_TEST_CASE(ParseDatabaseCanon_EOS_1100D)
   BOOST_CHECK( getInfo( sBrand, sModel, vec_database, datasheet ) );
   BOOST_CHECK_EQUAL( 22.2, datasheet._sensorWidth );
 }
+
+BOOST_AUTO_TEST_CASE(ParseDatabaseBulk)
+{
+  std::vector<Datasheet> vec_database;
+  BOOST_CHECK( parseDatabase( sDatabase, vec_database ) );
+
+  const std::set<std::pair<std::string, std::string>> cameras = {
+    {"Canon", "Canon PowerShot SD900"},
+    {"Canon", "Canon PowerShot A710 IS"},
+    {"NotExistBrand", "NotExistModel"}};
+
+  const auto datasheets = getInfos( cameras, DatasheetIndex( vec_database ) );
+  BOOST_CHECK_EQUAL( 2, datasheets.size() );
+  BOOST_CHECK_EQUAL( 7.144, datasheets.at({"Canon", "Canon PowerShot SD900"})._sensorWidth );
+  BOOST_CHECK_EQUAL( 5.744, datasheets.at({"Canon", "Canon PowerShot A710 IS"})._sensorWidth );
+  BOOST_CHECK( datasheets.find({"NotExistBrand", "NotExistModel"}) == datasheets.end() );
+}
+
+BOOST_AUTO_TEST_CASE(DatasheetIndexFuzzy)
+{
+  std::vector<Datasheet> vec_database;
+  BOOST_CHECK( parseDatabase( sDatabase, vec_database ) );
+  const DatasheetIndex index( vec_database );
+  BOOST_CHECK_EQUAL( vec_database.size(), index.size() );
+
+  // same results as the linear search, for exact and fuzzy names
+  const std::vector<std::pair<std::string, std::string>> cameras = {
+    {"Canon", "Canon PowerShot SD900"},
+    {"CANON", "canon powershot sd-900"},
+    {"Canon Inc.", "PowerShot A710 IS"},
+    {"NotExistBrand", "NotExistModel"}};
+
+  for( const auto& camera : cameras )
+  {
+    Datasheet linearDatasheet;
+    Datasheet indexDatasheet;
+    const bool linearFound = getInfo( camera.first, camera.second, vec_database, linearDatasheet );
+    BOOST_CHECK_EQUAL( linearFound, index.getInfo( camera.first, camera.second, indexDatasheet ) );
+    if( linearFound )
+      BOOST_CHECK_EQUAL( linearDatasheet._model, indexDatasheet._model );
+  }
+}
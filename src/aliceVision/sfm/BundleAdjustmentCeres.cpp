@@ -11,6 +11,9 @@
 #include <aliceVision/sfm/ResidualErrorRotationPriorFunctor.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/utils/CeresUtils.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/system/Metrics.hpp>
+#include <aliceVision/system/Profiler.hpp>
 #include <aliceVision/alicevision_omp.hpp>
 #include <aliceVision/config.hpp>
 #include <aliceVision/camera/Equidistant.hpp>
@@ -357,7 +360,7 @@ bool BundleAdjustmentCeres::Statistics::exportToFile(const std::string& folder,
           "ResidualBlocks;SuccessIteration;BadIteration;"
           "InitRMSE;FinalRMSE;"
           "d=-1;d=0;d=1;d=2;d=3;d=4;"
-          "d=5;d=6;d=7;d=8;d=9;d=10+;\n";
+          "d=5;d=6;d=7;d=8;d=9;d=10+;Time/Setup(s);\n";
   }
 
   std::map<EParameter, std::map<EParameterState, std::size_t>> states = parametersStates;
@@ -392,7 +395,8 @@ bool BundleAdjustmentCeres::Statistics::exportToFile(const std::string& folder,
          os << "0;";
      }
 
-     os << posesWithDistUpperThanTen << ";\n";
+     os << posesWithDistUpperThanTen << ";"
+        << problemSetupTime << ";\n";
 
   os.close();
   return true;
@@ -436,6 +440,7 @@ void BundleAdjustmentCeres::Statistics::show() const
 
   ALICEVISION_LOG_INFO("Bundle Adjustment Statistics:\n"
                         << ss.str()
+                        << "\t- problem setup duration: " << problemSetupTime << " s\n"
                         << "\t- adjustment duration: " << time << " s\n"
                         << "\t- poses:\n"
                         << "\t    - # refined:  " << states[EParameter::POSE][EParameterState::REFINED]  << "\n"
@@ -469,6 +474,37 @@ void BundleAdjustmentCeres::setSolverOptions(ceres::Solver::Options& solverOptio
   solverOptions.num_linear_solver_threads = _ceresOptions.nbThreads;
 #endif
 
+  if(_ceresOptions.useGPU)
+  {
+    bool gpuEnabled = false;
+
+    if(_ceresOptions.linearSolverType == ceres::DENSE_SCHUR)
+    {
+#if ALICEVISION_CERES_HAS_CUDA_DENSE
+      if(ceres::IsDenseLinearAlgebraLibraryTypeAvailable(ceres::CUDA))
+      {
+        solverOptions.dense_linear_algebra_library_type = ceres::CUDA;
+        gpuEnabled = true;
+      }
+#endif
+    }
+    else if(_ceresOptions.linearSolverType == ceres::SPARSE_SCHUR)
+    {
+#if ALICEVISION_CERES_HAS_CUDA_SPARSE
+      if(ceres::IsSparseLinearAlgebraLibraryTypeAvailable(ceres::CUDA_SPARSE))
+      {
+        solverOptions.sparse_linear_algebra_library_type = ceres::CUDA_SPARSE;
+        gpuEnabled = true;
+      }
+#endif
+    }
+
+    if(gpuEnabled)
+      ALICEVISION_LOG_DEBUG("BundleAdjustment[Ceres]: solve the Schur complement on the GPU.");
+    else
+      ALICEVISION_LOG_WARNING("BundleAdjustment[Ceres]: no GPU linear solver available for this configuration, fallback to the CPU.");
+  }
+
   if(_ceresOptions.useParametersOrdering)
   {
     // copy ParameterBlockOrdering
@@ -476,74 +512,106 @@ void BundleAdjustmentCeres::setSolverOptions(ceres::Solver::Options& solverOptio
   }
 }
 
-void BundleAdjustmentCeres::addExtrinsicsToProblem(const sfmData::SfMData& sfmData, BundleAdjustment::ERefineOptions refineOptions, ceres::Problem& problem)
+/**
+ * @brief Fill a pose parameter block according to the Ceres format: [Rx, Ry, Rz, tx, ty, tz]
+ * @param[in] pose The camera pose transform
+ * @param[out] poseBlock The pose parameter block
+ */
+void poseToParameterBlock(const geometry::Pose3& pose, std::array<double,6>& poseBlock)
+{
+  const Mat3& R = pose.rotation();
+  const Vec3& t = pose.translation();
+
+  double angleAxis[3];
+  ceres::RotationMatrixToAngleAxis(static_cast<const double *>(R.data()), angleAxis);
+  poseBlock.at(0) = angleAxis[0];
+  poseBlock.at(1) = angleAxis[1];
+  poseBlock.at(2) = angleAxis[2];
+  poseBlock.at(3) = t(0);
+  poseBlock.at(4) = t(1);
+  poseBlock.at(5) = t(2);
+}
+
+/**
+ * @brief Count the number of reconstructed views per intrinsic
+ * @param[in] sfmData The input SfMData
+ * @return the number of reconstructed views of each intrinsic referenced by a view
+ */
+std::map<IndexT, std::size_t> countIntrinsicsUsage(const sfmData::SfMData& sfmData)
+{
+  std::map<IndexT, std::size_t> intrinsicsUsage;
+
+  for(const auto& viewPair: sfmData.getViews())
+  {
+    const sfmData::View& view = *(viewPair.second);
+
+    if(intrinsicsUsage.find(view.getIntrinsicId()) == intrinsicsUsage.end())
+      intrinsicsUsage[view.getIntrinsicId()] = 0;
+
+    if(sfmData.isPoseAndIntrinsicDefined(&view))
+      ++intrinsicsUsage.at(view.getIntrinsicId());
+  }
+  return intrinsicsUsage;
+}
+
+void BundleAdjustmentCeres::addPoseToProblem(const sfmData::CameraPose& cameraPose, bool isConstant, ERefineOptions refineOptions, std::array<double,6>& poseBlock, ceres::Problem& problem)
 {
   const bool refineTranslation = refineOptions & BundleAdjustment::REFINE_TRANSLATION;
   const bool refineRotation = refineOptions & BundleAdjustment::REFINE_ROTATION;
 
-  const auto addPose = [&](const sfmData::CameraPose& cameraPose, bool isConstant, std::array<double,6>& poseBlock)
-  {
-    const Mat3& R = cameraPose.getTransform().rotation();
-    const Vec3& t = cameraPose.getTransform().translation();
-
-    double angleAxis[3];
-    ceres::RotationMatrixToAngleAxis(static_cast<const double *>(R.data()), angleAxis);
-    poseBlock.at(0) = angleAxis[0];
-    poseBlock.at(1) = angleAxis[1];
-    poseBlock.at(2) = angleAxis[2];
-    poseBlock.at(3) = t(0);
-    poseBlock.at(4) = t(1);
-    poseBlock.at(5) = t(2);
-
-    double* poseBlockPtr = poseBlock.data();
-    problem.AddParameterBlock(poseBlockPtr, 6);
-
-    // add pose parameter to the all parameters blocks pointers list
-    _allParametersBlocks.push_back(poseBlockPtr);
+  poseToParameterBlock(cameraPose.getTransform(), poseBlock);
 
-    // keep the camera extrinsics constants
-    if(cameraPose.isLocked() || isConstant || (!refineTranslation && !refineRotation))
-    {
-      // set the whole parameter block as constant.
-      _statistics.addState(EParameter::POSE, EParameterState::CONSTANT);
-      problem.SetParameterBlockConstant(poseBlockPtr);
-      return;
-    }
+  double* poseBlockPtr = poseBlock.data();
+  problem.AddParameterBlock(poseBlockPtr, 6);
 
-    // constant parameters
-    std::vector<int> constantExtrinsic;
+  // add pose parameter to the all parameters blocks pointers list
+  _allParametersBlocks.push_back(poseBlockPtr);
 
-    // don't refine rotations
-    if(!refineRotation)
-    {
-      constantExtrinsic.push_back(0);
-      constantExtrinsic.push_back(1);
-      constantExtrinsic.push_back(2);
-    }
+  // keep the camera extrinsics constants
+  if(cameraPose.isLocked() || isConstant || (!refineTranslation && !refineRotation))
+  {
+    // set the whole parameter block as constant.
+    _statistics.addState(EParameter::POSE, EParameterState::CONSTANT);
+    problem.SetParameterBlockConstant(poseBlockPtr);
+    return;
+  }
 
-    // don't refine translations
-    if(!refineTranslation)
-    {
-      constantExtrinsic.push_back(3);
-      constantExtrinsic.push_back(4);
-      constantExtrinsic.push_back(5);
-    }
+  // constant parameters
+  std::vector<int> constantExtrinsic;
 
-    // subset parametrization
-    if(!constantExtrinsic.empty())
-    {
+  // don't refine rotations
+  if(!refineRotation)
+  {
+    constantExtrinsic.push_back(0);
+    constantExtrinsic.push_back(1);
+    constantExtrinsic.push_back(2);
+  }
+
+  // don't refine translations
+  if(!refineTranslation)
+  {
+    constantExtrinsic.push_back(3);
+    constantExtrinsic.push_back(4);
+    constantExtrinsic.push_back(5);
+  }
+
+  // subset parametrization
+  if(!constantExtrinsic.empty())
+  {
 #if ALICEVISION_CERES_HAS_MANIFOLD
-      auto* subsetManifold = new ceres::SubsetManifold(6, constantExtrinsic);
-      problem.SetManifold(poseBlockPtr, subsetManifold);
+    auto* subsetManifold = new ceres::SubsetManifold(6, constantExtrinsic);
+    problem.SetManifold(poseBlockPtr, subsetManifold);
 #else
-      ceres::SubsetParameterization* subsetParameterization = new ceres::SubsetParameterization(6, constantExtrinsic);
-      problem.SetParameterization(poseBlockPtr, subsetParameterization);
+    ceres::SubsetParameterization* subsetParameterization = new ceres::SubsetParameterization(6, constantExtrinsic);
+    problem.SetParameterization(poseBlockPtr, subsetParameterization);
 #endif
-    }
+  }
 
-    _statistics.addState(EParameter::POSE, EParameterState::REFINED);
-  };
+  _statistics.addState(EParameter::POSE, EParameterState::REFINED);
+}
 
+void BundleAdjustmentCeres::addExtrinsicsToProblem(const sfmData::SfMData& sfmData, BundleAdjustment::ERefineOptions refineOptions, ceres::Problem& problem)
+{
   // setup poses data
   for(const auto& posePair : sfmData.getPoses())
   {
@@ -559,7 +627,7 @@ void BundleAdjustmentCeres::addExtrinsicsToProblem(const sfmData::SfMData& sfmDa
 
     const bool isConstant = (getPoseState(poseId) == EParameterState::CONSTANT);
 
-    addPose(pose, isConstant, _posesBlocks[poseId]);
+    addPoseToProblem(pose, isConstant, refineOptions, _posesBlocks[poseId], problem);
   }
 
   // setup sub-poses data
@@ -578,7 +646,7 @@ void BundleAdjustmentCeres::addExtrinsicsToProblem(const sfmData::SfMData& sfmDa
 
       const bool isConstant = (rigSubPose.status == sfmData::ERigSubPoseStatus::CONSTANT);
 
-      addPose(sfmData::CameraPose(rigSubPose.pose), isConstant, _rigBlocks[rigId][subPoseId]);
+      addPoseToProblem(sfmData::CameraPose(rigSubPose.pose), isConstant, refineOptions, _rigBlocks[rigId][subPoseId], problem);
     }
   }
 }
@@ -591,19 +659,8 @@ void BundleAdjustmentCeres::addIntrinsicsToProblem(const sfmData::SfMData& sfmDa
   const bool refineIntrinsics = refineIntrinsicsDistortion || refineIntrinsicsFocalLength || refineIntrinsicsOpticalCenter;
   const bool fixFocalRatio = true;
 
-  std::map<IndexT, std::size_t> intrinsicsUsage;
-
   // count the number of reconstructed views per intrinsic
-  for(const auto& viewPair: sfmData.getViews())
-  {
-    const sfmData::View& view = *(viewPair.second);
-
-    if(intrinsicsUsage.find(view.getIntrinsicId()) == intrinsicsUsage.end())
-      intrinsicsUsage[view.getIntrinsicId()] = 0;
-
-    if(sfmData.isPoseAndIntrinsicDefined(&view))
-      ++intrinsicsUsage.at(view.getIntrinsicId());
-  }
+  const std::map<IndexT, std::size_t> intrinsicsUsage = countIntrinsicsUsage(sfmData);
 
   for(const auto& intrinsicPair: sfmData.getIntrinsics())
   {
@@ -735,7 +792,31 @@ void BundleAdjustmentCeres::addLandmarksToProblem(const sfmData::SfMData& sfmDat
   // note: set it to NULL if you don't want use a lossFunction.
   ceres::LossFunction* lossFunction = _ceresOptions.lossFunction.get();
 
-  // build the residual blocks corresponding to the track observations
+  /// landmark with its first residual block index
+  struct LandmarkResiduals
+  {
+    IndexT landmarkId;
+    const sfmData::Landmark* landmark;
+    double* landmarkBlockPtr;
+    std::size_t firstResidual;
+  };
+
+  /// residual block of an observation, created in parallel and added to the problem afterwards
+  struct ObservationResidual
+  {
+    IndexT viewId = UndefinedIndexT;
+    IndexT featId = UndefinedIndexT;
+    ceres::CostFunction* costFunction = nullptr;
+    double* intrinsicBlockPtr = nullptr;
+    double* poseBlockPtr = nullptr;
+    double* rigBlockPtr = nullptr;
+  };
+
+  std::vector<LandmarkResiduals> landmarksResiduals;
+  landmarksResiduals.reserve(sfmData.getLandmarks().size());
+  std::size_t nbResiduals = 0;
+
+  // create the landmarks parameter blocks (the blocks container can't be modified in parallel)
   for(const auto& landmarkPair: sfmData.getLandmarks())
   {
     const IndexT landmarkId = landmarkPair.first;
@@ -749,20 +830,38 @@ void BundleAdjustmentCeres::addLandmarksToProblem(const sfmData::SfMData& sfmDat
       continue;
     }
 
-    std::array<double,3>& landmarkBlock = _landmarksBlocks[landmarkId];
-    for(std::size_t i = 0; i < 3; ++i)
-      landmarkBlock.at(i) = landmark.X(Eigen::Index(i));
-
-    double* landmarkBlockPtr = landmarkBlock.data();
+    double* landmarkBlockPtr = _landmarksBlocks[landmarkId].data();
 
     // add landmark parameter to the all parameters blocks pointers list
     _allParametersBlocks.push_back(landmarkBlockPtr);
 
+    landmarksResiduals.push_back({landmarkId, &landmark, landmarkBlockPtr, nbResiduals});
+    nbResiduals += landmark.observations.size();
+  }
+
+  // build the cost functions corresponding to the track observations in parallel
+  std::vector<ObservationResidual> residuals(nbResiduals);
+  std::string errorMessage;
+
+  #pragma omp parallel for schedule(dynamic, 256)
+  for(int i = 0; i < landmarksResiduals.size(); ++i)
+  {
+    const LandmarkResiduals& landmarkResiduals = landmarksResiduals[i];
+    const sfmData::Landmark& landmark = *landmarkResiduals.landmark;
+
+    for(std::size_t p = 0; p < 3; ++p)
+      landmarkResiduals.landmarkBlockPtr[p] = landmark.X(Eigen::Index(p));
+
+    std::size_t r = landmarkResiduals.firstResidual;
+
     // iterate over 2D observation associated to the 3D landmark
     for(const auto& observationPair: landmark.observations)
     {
       const sfmData::View& view = sfmData.getView(observationPair.first);
       const sfmData::Observation& observation = observationPair.second;
+      ObservationResidual& residual = residuals[r++];
+      residual.viewId = observationPair.first;
+      residual.featId = observation.id_feat;
 
       // each residual block takes a point and a camera as input and outputs a 2
       // dimensional residual. Internally, the cost function stores the observed
@@ -772,43 +871,81 @@ void BundleAdjustmentCeres::addLandmarksToProblem(const sfmData::SfMData& sfmDat
       assert(getIntrinsicState(view.getIntrinsicId()) != EParameterState::IGNORED);
 
       // needed parameters to create a residual block (K, pose)
-      double* poseBlockPtr = _posesBlocks.at(view.getPoseId()).data();
-      double* intrinsicBlockPtr = _intrinsicsBlocks.at(view.getIntrinsicId()).data();
+      residual.poseBlockPtr = _posesBlocks.at(view.getPoseId()).data();
+      residual.intrinsicBlockPtr = _intrinsicsBlocks.at(view.getIntrinsicId()).data();
+
+      try
+      {
+        if(view.isPartOfRig() && !view.isPoseIndependant())
+        {
+          residual.costFunction = createRigCostFunctionFromIntrinsics(sfmData.getIntrinsicPtr(view.getIntrinsicId()), observation);
+          residual.rigBlockPtr = _rigBlocks.at(view.getRigId()).at(view.getSubPoseId()).data();
+        }
+        else
+        {
+          residual.costFunction = createCostFunctionFromIntrinsics(sfmData.getIntrinsicPtr(view.getIntrinsicId()), observation);
+        }
+      }
+      catch(const std::exception& e)
+      {
+        #pragma omp critical
+        errorMessage = e.what();
+      }
+    }
+  }
+
+  if(!errorMessage.empty())
+  {
+    for(ObservationResidual& residual : residuals)
+      delete residual.costFunction;
+    throw std::logic_error(errorMessage);
+  }
+
+  // add the residual blocks to the problem in the landmarks order
+  for(const LandmarkResiduals& landmarkResiduals : landmarksResiduals)
+  {
+    double* landmarkBlockPtr = landmarkResiduals.landmarkBlockPtr;
+    const std::size_t lastResidual = landmarkResiduals.firstResidual + landmarkResiduals.landmark->observations.size();
+
+    for(std::size_t r = landmarkResiduals.firstResidual; r < lastResidual; ++r)
+    {
+      const ObservationResidual& residual = residuals[r];
 
       // apply a specific parameter ordering:
       if(_ceresOptions.useParametersOrdering)
       {
         _linearSolverOrdering.AddElementToGroup(landmarkBlockPtr, 0);
-        _linearSolverOrdering.AddElementToGroup(poseBlockPtr, 1);
-        _linearSolverOrdering.AddElementToGroup(intrinsicBlockPtr, 2);
+        _linearSolverOrdering.AddElementToGroup(residual.poseBlockPtr, 1);
+        _linearSolverOrdering.AddElementToGroup(residual.intrinsicBlockPtr, 2);
       }
 
-      if(view.isPartOfRig() && !view.isPoseIndependant())
-      {
-        ceres::CostFunction* costFunction = createRigCostFunctionFromIntrinsics(sfmData.getIntrinsicPtr(view.getIntrinsicId()), observation);
+      ceres::ResidualBlockId residualBlockId;
 
-        double* rigBlockPtr = _rigBlocks.at(view.getRigId()).at(view.getSubPoseId()).data();
-        _linearSolverOrdering.AddElementToGroup(rigBlockPtr, 1);
+      if(residual.rigBlockPtr != nullptr)
+      {
+        _linearSolverOrdering.AddElementToGroup(residual.rigBlockPtr, 1);
 
-        problem.AddResidualBlock(costFunction,
+        residualBlockId = problem.AddResidualBlock(residual.costFunction,
             lossFunction,
-            intrinsicBlockPtr,
-            poseBlockPtr,
-            rigBlockPtr, // subpose of the cameras rig
+            residual.intrinsicBlockPtr,
+            residual.poseBlockPtr,
+            residual.rigBlockPtr, // subpose of the cameras rig
             landmarkBlockPtr); // do we need to copy 3D point to avoid false motion, if failure ?
       }
       else
       {
-        ceres::CostFunction* costFunction = createCostFunctionFromIntrinsics(sfmData.getIntrinsicPtr(view.getIntrinsicId()), observation);
-
-        problem.AddResidualBlock(costFunction,
+        residualBlockId = problem.AddResidualBlock(residual.costFunction,
             lossFunction,
-            intrinsicBlockPtr,
-            poseBlockPtr,
+            residual.intrinsicBlockPtr,
+            residual.poseBlockPtr,
             landmarkBlockPtr); //do we need to copy 3D point to avoid false motion, if failure ?
       }
 
-      if(!refineStructure || getLandmarkState(landmarkId) == EParameterState::CONSTANT)
+      // keep track of the residual blocks to update the problem on the next adjustment
+      if(_incrementalProblem)
+        _landmarksResidualBlocks[landmarkResiduals.landmarkId][residual.viewId] = {residual.featId, residualBlockId};
+
+      if(!refineStructure || getLandmarkState(landmarkResiduals.landmarkId) == EParameterState::CONSTANT)
       {
         // set the whole landmark parameter block as constant.
         _statistics.addState(EParameter::LANDMARK, EParameterState::CONSTANT);
@@ -901,6 +1038,243 @@ void BundleAdjustmentCeres::createProblem(const sfmData::SfMData& sfmData,
   addRotationPriorsToProblem(sfmData, refineOptions, problem);
 }
 
+std::map<IndexT, int> BundleAdjustmentCeres::getIntrinsicsConfiguration(const sfmData::SfMData& sfmData, ERefineOptions refineOptions) const
+{
+  std::map<IndexT, int> configuration;
+
+  for(const auto& usagePair : countIntrinsicsUsage(sfmData))
+  {
+    const auto intrinsicIt = sfmData.getIntrinsics().find(usagePair.first);
+    if(intrinsicIt == sfmData.getIntrinsics().end())
+      continue;
+
+    // everything that changes the parameter block setup in addIntrinsicsToProblem: state, lock, usage and optical center refinement
+    const bool isUsed = (usagePair.second > 0);
+    const bool hasEnoughData = (_minNbImagesToRefineOpticalCenter > 0 && usagePair.second >= _minNbImagesToRefineOpticalCenter);
+
+    configuration[usagePair.first] = static_cast<int>(getIntrinsicState(usagePair.first)) |
+                                     (intrinsicIt->second->isLocked() << 2) |
+                                     (isUsed << 3) |
+                                     (hasEnoughData << 4);
+  }
+  return configuration;
+}
+
+bool BundleAdjustmentCeres::canUpdateProblem(const sfmData::SfMData& sfmData, ERefineOptions refineOptions) const
+{
+  const bool refineTranslation = refineOptions & REFINE_TRANSLATION;
+  const bool refineRotation = refineOptions & REFINE_ROTATION;
+
+  // rigs, 2D constraints, rotation priors and partial pose refinement (subset manifolds) are not handled by the incremental update
+  return _incrementalProblem &&
+         _problem != nullptr &&
+         _problemRefineOptions == refineOptions &&
+         refineTranslation == refineRotation &&
+         _problemLossFunction == _ceresOptions.lossFunction &&
+         sfmData.getRigs().empty() &&
+         sfmData.getConstraints2D().empty() &&
+         sfmData.getRotationPriors().empty() &&
+         _problemIntrinsicsConfiguration == getIntrinsicsConfiguration(sfmData, refineOptions);
+}
+
+void BundleAdjustmentCeres::updateProblem(const sfmData::SfMData& sfmData, ERefineOptions refineOptions)
+{
+  ceres::Problem& problem = *_problem;
+  const bool refinePoses = (refineOptions & REFINE_ROTATION) || (refineOptions & REFINE_TRANSLATION);
+  const bool refineStructure = refineOptions & REFINE_STRUCTURE;
+  ceres::LossFunction* lossFunction = _ceresOptions.lossFunction.get();
+
+  _statistics = Statistics();
+  _allParametersBlocks.clear();
+  _linearSolverOrdering.Clear();
+
+  const auto isPoseInProblem = [&](IndexT poseId)
+  {
+    return sfmData.getPoses().count(poseId) && getPoseState(poseId) != EParameterState::IGNORED;
+  };
+
+  // remove the residual blocks of the removed landmarks and observations
+  for(auto landmarkIt = _landmarksResidualBlocks.begin(); landmarkIt != _landmarksResidualBlocks.end();)
+  {
+    const IndexT landmarkId = landmarkIt->first;
+    const auto structureIt = sfmData.getLandmarks().find(landmarkId);
+
+    if(structureIt == sfmData.getLandmarks().end() || getLandmarkState(landmarkId) == EParameterState::IGNORED)
+    {
+      // also removes all the residual blocks of the landmark
+      problem.RemoveParameterBlock(_landmarksBlocks.at(landmarkId).data());
+      _landmarksBlocks.erase(landmarkId);
+      landmarkIt = _landmarksResidualBlocks.erase(landmarkIt);
+      continue;
+    }
+
+    const sfmData::Observations& observations = structureIt->second.observations;
+    auto& residualBlocks = landmarkIt->second;
+
+    for(auto residualIt = residualBlocks.begin(); residualIt != residualBlocks.end();)
+    {
+      const auto observationIt = observations.find(residualIt->first);
+
+      if(observationIt == observations.end() ||
+         observationIt->second.id_feat != residualIt->second.featId ||
+         !isPoseInProblem(sfmData.getView(residualIt->first).getPoseId()))
+      {
+        problem.RemoveResidualBlock(residualIt->second.residualBlockId);
+        residualIt = residualBlocks.erase(residualIt);
+      }
+      else
+      {
+        ++residualIt;
+      }
+    }
+    ++landmarkIt;
+  }
+
+  // remove the poses that are no longer in the problem
+  for(auto poseIt = _posesBlocks.begin(); poseIt != _posesBlocks.end();)
+  {
+    if(!isPoseInProblem(poseIt->first))
+    {
+      problem.RemoveParameterBlock(poseIt->second.data());
+      poseIt = _posesBlocks.erase(poseIt);
+    }
+    else
+    {
+      ++poseIt;
+    }
+  }
+
+  // update or add poses
+  for(const auto& posePair : sfmData.getPoses())
+  {
+    const IndexT poseId = posePair.first;
+    const sfmData::CameraPose& pose = posePair.second;
+
+    if(getPoseState(poseId) == EParameterState::IGNORED)
+    {
+      _statistics.addState(EParameter::POSE, EParameterState::IGNORED);
+      continue;
+    }
+
+    const bool isConstant = (getPoseState(poseId) == EParameterState::CONSTANT);
+    const auto poseBlockIt = _posesBlocks.find(poseId);
+
+    if(poseBlockIt == _posesBlocks.end())
+    {
+      addPoseToProblem(pose, isConstant, refineOptions, _posesBlocks[poseId], problem);
+      continue;
+    }
+
+    // the problem may contain values of a previous unusable solution, restart from the SfMData values
+    poseToParameterBlock(pose.getTransform(), poseBlockIt->second);
+    double* poseBlockPtr = poseBlockIt->second.data();
+    _allParametersBlocks.push_back(poseBlockPtr);
+
+    if(pose.isLocked() || isConstant || !refinePoses)
+    {
+      _statistics.addState(EParameter::POSE, EParameterState::CONSTANT);
+      problem.SetParameterBlockConstant(poseBlockPtr);
+    }
+    else
+    {
+      _statistics.addState(EParameter::POSE, EParameterState::REFINED);
+      problem.SetParameterBlockVariable(poseBlockPtr);
+    }
+  }
+
+  // intrinsics configuration is unchanged, only restore the values
+  for(auto& intrinsicBlockPair : _intrinsicsBlocks)
+  {
+    std::vector<double>& intrinsicBlock = intrinsicBlockPair.second;
+    const std::vector<double> params = sfmData.getIntrinsics().at(intrinsicBlockPair.first)->getParams();
+    assert(params.size() == intrinsicBlock.size());
+    std::copy(params.begin(), params.end(), intrinsicBlock.begin());
+    _allParametersBlocks.push_back(intrinsicBlock.data());
+
+    _statistics.addState(EParameter::INTRINSIC, problem.IsParameterBlockConstant(intrinsicBlock.data()) ? EParameterState::CONSTANT : EParameterState::REFINED);
+  }
+  for(const auto& intrinsicState : _problemIntrinsicsConfiguration)
+  {
+    if(!_intrinsicsBlocks.count(intrinsicState.first))
+      _statistics.addState(EParameter::INTRINSIC, EParameterState::IGNORED);
+  }
+
+  // update or add landmarks and observations
+  for(const auto& landmarkPair : sfmData.getLandmarks())
+  {
+    const IndexT landmarkId = landmarkPair.first;
+    const sfmData::Landmark& landmark = landmarkPair.second;
+
+    if(getLandmarkState(landmarkId) == EParameterState::IGNORED)
+    {
+      _statistics.addState(EParameter::LANDMARK, EParameterState::IGNORED);
+      continue;
+    }
+
+    std::array<double,3>& landmarkBlock = _landmarksBlocks[landmarkId];
+    for(std::size_t i = 0; i < 3; ++i)
+      landmarkBlock.at(i) = landmark.X(Eigen::Index(i));
+
+    double* landmarkBlockPtr = landmarkBlock.data();
+    _allParametersBlocks.push_back(landmarkBlockPtr);
+
+    auto& residualBlocks = _landmarksResidualBlocks[landmarkId];
+
+    for(const auto& observationPair : landmark.observations)
+    {
+      if(residualBlocks.count(observationPair.first))
+        continue;
+
+      const sfmData::View& view = sfmData.getView(observationPair.first);
+
+      assert(getPoseState(view.getPoseId()) != EParameterState::IGNORED);
+      assert(getIntrinsicState(view.getIntrinsicId()) != EParameterState::IGNORED);
+
+      ceres::CostFunction* costFunction = createCostFunctionFromIntrinsics(sfmData.getIntrinsicPtr(view.getIntrinsicId()), observationPair.second);
+
+      const ceres::ResidualBlockId residualBlockId = problem.AddResidualBlock(costFunction,
+          lossFunction,
+          _intrinsicsBlocks.at(view.getIntrinsicId()).data(),
+          _posesBlocks.at(view.getPoseId()).data(),
+          landmarkBlockPtr);
+
+      residualBlocks[observationPair.first] = {observationPair.second.id_feat, residualBlockId};
+    }
+
+    if(residualBlocks.empty())
+    {
+      if(problem.HasParameterBlock(landmarkBlockPtr))
+        problem.RemoveParameterBlock(landmarkBlockPtr);
+      _landmarksResidualBlocks.erase(landmarkId);
+      _landmarksBlocks.erase(landmarkId);
+      _allParametersBlocks.pop_back();
+      continue;
+    }
+
+    const bool isConstant = (!refineStructure || getLandmarkState(landmarkId) == EParameterState::CONSTANT);
+
+    if(isConstant)
+      problem.SetParameterBlockConstant(landmarkBlockPtr);
+    else
+      problem.SetParameterBlockVariable(landmarkBlockPtr);
+
+    for(std::size_t i = 0; i < residualBlocks.size(); ++i)
+      _statistics.addState(EParameter::LANDMARK, isConstant ? EParameterState::CONSTANT : EParameterState::REFINED);
+
+    // apply a specific parameter ordering:
+    if(_ceresOptions.useParametersOrdering)
+      _linearSolverOrdering.AddElementToGroup(landmarkBlockPtr, 0);
+  }
+
+  if(_ceresOptions.useParametersOrdering)
+  {
+    for(auto& poseBlockPair : _posesBlocks)
+      _linearSolverOrdering.AddElementToGroup(poseBlockPair.second.data(), 1);
+    for(auto& intrinsicBlockPair : _intrinsicsBlocks)
+      _linearSolverOrdering.AddElementToGroup(intrinsicBlockPair.second.data(), 2);
+  }
+}
+
  void BundleAdjustmentCeres::resetProblem()
 {
   _statistics = Statistics();
@@ -910,6 +1284,7 @@ void BundleAdjustmentCeres::createProblem(const sfmData::SfMData& sfmData,
   _intrinsicsBlocks.clear();
   _landmarksBlocks.clear();
   _rigBlocks.clear();
+  _landmarksResidualBlocks.clear();
 
   _linearSolverOrdering.Clear();
 }
@@ -996,10 +1371,25 @@ void BundleAdjustmentCeres::updateFromSolution(sfmData::SfMData& sfmData, ERefin
   }
 }
 
+void BundleAdjustmentCeres::setIncrementalProblem(bool enable)
+{
+  _incrementalProblem = enable;
+
+  if(!enable)
+  {
+    _problem.reset();
+    _problemLossFunction.reset();
+    _landmarksResidualBlocks.clear();
+  }
+}
+
 void BundleAdjustmentCeres::createJacobian(const sfmData::SfMData& sfmData,
                                            ERefineOptions refineOptions,
                                            ceres::CRSMatrix& jacobian)
 {
+  // the parameter blocks are rebuilt for the jacobian problem, the kept problem can't be updated anymore
+  _problem.reset();
+
   // create problem
   ceres::Problem::Options problemOptions;
   problemOptions.loss_function_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
@@ -1019,11 +1409,34 @@ void BundleAdjustmentCeres::createJacobian(const sfmData::SfMData& sfmData,
 
 bool BundleAdjustmentCeres::adjust(sfmData::SfMData& sfmData, ERefineOptions refineOptions)
 {
-  // create problem
-  ceres::Problem::Options problemOptions;
-  problemOptions.loss_function_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
-  ceres::Problem problem(problemOptions);
-  createProblem(sfmData, refineOptions, problem);
+  ALICEVISION_PROFILE_ZONE("bundleAdjustment");
+
+  system::Timer setupTimer;
+
+  if(canUpdateProblem(sfmData, refineOptions))
+  {
+    // update the problem of the previous adjustment
+    updateProblem(sfmData, refineOptions);
+  }
+  else
+  {
+    // create problem
+    ceres::Problem::Options problemOptions;
+    problemOptions.loss_function_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
+    problemOptions.enable_fast_removal = _incrementalProblem;
+    _problem.reset(new ceres::Problem(problemOptions));
+    createProblem(sfmData, refineOptions, *_problem);
+
+    if(_incrementalProblem)
+    {
+      _problemRefineOptions = refineOptions;
+      _problemLossFunction = _ceresOptions.lossFunction;
+      _problemIntrinsicsConfiguration = getIntrinsicsConfiguration(sfmData, refineOptions);
+    }
+  }
+
+  ceres::Problem& problem = *_problem;
+  const double problemSetupTime = setupTimer.elapsed();
 
   // configure a Bundle Adjustment engine and run it
   // make Ceres automatically detect the bundle structure.
@@ -1041,6 +1454,9 @@ bool BundleAdjustmentCeres::adjust(sfmData::SfMData& sfmData, ERefineOptions ref
   // solution is not usable
   if(!summary.IsSolutionUsable())
   {
+    if(!_incrementalProblem)
+      _problem.reset();
+
     ALICEVISION_LOG_WARNING("Bundle Adjustment failed, the solution is not usable.");
     return false;
   }
@@ -1048,15 +1464,27 @@ bool BundleAdjustmentCeres::adjust(sfmData::SfMData& sfmData, ERefineOptions ref
   // update input sfmData with the solution
   updateFromSolution(sfmData, refineOptions);
 
+  // release the problem memory if it will not be reused
+  if(!_incrementalProblem)
+    _problem.reset();
+
 
   // store some statitics from the summary
   _statistics.time = summary.total_time_in_seconds;
+  _statistics.problemSetupTime = problemSetupTime;
   _statistics.nbSuccessfullIterations = summary.num_successful_steps;
   _statistics.nbUnsuccessfullIterations = summary.num_unsuccessful_steps;
   _statistics.nbResidualBlocks = summary.num_residuals;
   _statistics.RMSEinitial = std::sqrt(summary.initial_cost / summary.num_residuals);
   _statistics.RMSEfinal = std::sqrt(summary.final_cost / summary.num_residuals);
 
+  system::Metrics& metrics = system::Metrics::get();
+  metrics.addCounter("bundleAdjustment.runs");
+  metrics.addSample("bundleAdjustment.time", _statistics.time);
+  metrics.addSample("bundleAdjustment.problemSetupTime", _statistics.problemSetupTime);
+  metrics.addSample("bundleAdjustment.iterations", _statistics.nbSuccessfullIterations + _statistics.nbUnsuccessfullIterations);
+  metrics.setGauge("bundleAdjustment.RMSEfinal", _statistics.RMSEfinal);
+
   //store distance histogram for local strategy
   if(useLocalStrategy())
     _statistics.nbCamerasPerDistance = _localGraph->getDistancesHistogram();
@@ -15,6 +15,7 @@
 
 #include <ceres/ceres.h>
 
+#include <map>
 #include <memory>
 
 
@@ -22,6 +23,7 @@ namespace aliceVision {
 
 namespace sfmData {
 class SfMData;
+class CameraPose;
 } // namespace sfmData
 
 namespace sfm {
@@ -52,6 +54,8 @@ public:
     std::shared_ptr<ceres::LossFunction> lossFunction;
     unsigned int nbThreads;
     bool useParametersOrdering = true;
+    /// solve the Schur complement system on the GPU (CUDA) if the Ceres build supports it
+    bool useGPU = false;
     bool summary = false;
     bool verbose = true;
   };
@@ -104,6 +108,8 @@ public:
     double RMSEfinal = 0.0;
     /// time spent to solve the BA (s)
     double time = 0.0;
+    /// time spent to build the Ceres problem (s)
+    double problemSetupTime = 0.0;
     /// number of states per parameter
     std::map<EParameter, std::map<EParameterState, std::size_t>> parametersStates;
     /// The distribution of the cameras for each graph distance <distance, numOfCam>
@@ -148,6 +154,34 @@ public:
     _localGraph = localGraph;
   }
 
+  /**
+   * @brief Set the user Ceres options used by the next adjustments
+   * @param[in] options The user Ceres options
+   */
+  inline void setCeresOptions(const CeresOptions& options)
+  {
+    _ceresOptions = options;
+  }
+
+  /**
+   * @brief Get the user Ceres options
+   * @return the user Ceres options
+   */
+  inline const CeresOptions& getCeresOptions() const
+  {
+    return _ceresOptions;
+  }
+
+  /**
+   * @brief Keep the Ceres problem alive between two adjustments.
+   *        The next adjustment only adds the new parameter/residual blocks, removes the blocks of
+   *        the removed poses, landmarks and observations and updates the parameters states,
+   *        instead of rebuilding the whole problem.
+   *        The problem is rebuilt if the refine options, the loss function or the intrinsics setup changed.
+   * @param[in] enable True to keep the problem between adjustments
+   */
+  void setIncrementalProblem(bool enable);
+
   /**
    * @brief Get bundle adjustment statistics structure
    * @return statistics structure const ptr
@@ -187,6 +221,16 @@ private:
    */
   void addExtrinsicsToProblem(const sfmData::SfMData& sfmData, ERefineOptions refineOptions, ceres::Problem& problem);
 
+  /**
+   * @brief Create a parameter block for a pose according to the Ceres format: [Rx, Ry, Rz, tx, ty, tz]
+   * @param[in] cameraPose The camera pose
+   * @param[in] isConstant True if the pose is constant in the local strategy
+   * @param[in] refineOptions The chosen refine flag
+   * @param[out] poseBlock The pose parameter block
+   * @param[out] problem The Ceres bundle adjustement problem
+   */
+  void addPoseToProblem(const sfmData::CameraPose& cameraPose, bool isConstant, ERefineOptions refineOptions, std::array<double,6>& poseBlock, ceres::Problem& problem);
+
   /**
    * @brief Create a parameter block for each intrinsic according to the Ceres format
    * @param[in] sfmData The input SfMData contains all the information about the reconstruction, notably the intrinsics
@@ -229,6 +273,28 @@ private:
    */
   void createProblem(const sfmData::SfMData& sfmData, ERefineOptions refineOptions, ceres::Problem& problem);
 
+  /**
+   * @brief Get the intrinsics setup used to create their parameter blocks (state, lock, usage)
+   * @param[in] sfmData The input SfMData contains all the information about the reconstruction
+   * @param[in] refineOptions The chosen refine flag
+   * @return the setup code of each intrinsic
+   */
+  std::map<IndexT, int> getIntrinsicsConfiguration(const sfmData::SfMData& sfmData, ERefineOptions refineOptions) const;
+
+  /**
+   * @brief Return true if the problem of the previous adjustment can be updated instead of rebuilt
+   * @param[in] sfmData The input SfMData contains all the information about the reconstruction
+   * @param[in] refineOptions The chosen refine flag
+   */
+  bool canUpdateProblem(const sfmData::SfMData& sfmData, ERefineOptions refineOptions) const;
+
+  /**
+   * @brief Update the problem of the previous adjustment with the SfMData changes
+   * @param[in] sfmData The input SfMData contains all the information about the reconstruction
+   * @param[in] refineOptions The chosen refine flag
+   */
+  void updateProblem(const sfmData::SfMData& sfmData, ERefineOptions refineOptions);
+
   /**
    * @brief Update The given SfMData with the solver solution
    * @param[in,out] sfmData The input SfMData contains all the information about the reconstruction, notably the poses and sub-poses
@@ -298,6 +364,28 @@ private:
   /// block: ceres angleAxis(3) + translation(3)
   HashMap<IndexT, HashMap<IndexT, std::array<double,6>>> _rigBlocks;
 
+  // incremental problem
+
+  /// residual block of an observation in the kept problem
+  struct ObservationResidualBlock
+  {
+    IndexT featId;
+    ceres::ResidualBlockId residualBlockId;
+  };
+
+  /// keep the problem between two adjustments
+  bool _incrementalProblem = false;
+  /// the problem of the last adjustment (only kept in incremental mode)
+  std::unique_ptr<ceres::Problem> _problem;
+  /// refine options of the kept problem
+  ERefineOptions _problemRefineOptions = REFINE_NONE;
+  /// loss function referenced by the kept problem residual blocks
+  std::shared_ptr<ceres::LossFunction> _problemLossFunction;
+  /// intrinsics setup of the kept problem
+  std::map<IndexT, int> _problemIntrinsicsConfiguration;
+  /// residual blocks of the kept problem per landmark and per view
+  HashMap<IndexT, std::map<IndexT, ObservationResidualBlock>> _landmarksResidualBlocks;
+
   /// hinted order for ceres to eliminate blocks when solving.
   /// note: this ceres parameter is built internally and must be reset on each call to the solver.
   ceres::ParameterBlockOrdering _linearSolverOrdering;
@@ -576,13 +576,62 @@ void BundleAdjustmentPanoramaCeres::addIntrinsicsToProblem(const sfmData::SfMDat
 }
 
 
+void BundleAdjustmentPanoramaCeres::updateConstraints2DCostFunctions(const sfmData::SfMData& sfmData)
+{
+  const sfmData::Constraints2D& constraints2d = sfmData.getConstraints2D();
+  _constraints2DCostFunctions.resize(constraints2d.size());
+
+  #pragma omp parallel for schedule(dynamic, 1000)
+  for(int i = 0; i < constraints2d.size(); ++i)
+  {
+    const sfmData::Constraint2D& constraint = constraints2d[i];
+    Constraint2DCostFunctions& costFunctions = _constraints2DCostFunctions[i];
+
+    const sfmData::View& view_1 = sfmData.getView(constraint.ViewFirst);
+    std::shared_ptr<IntrinsicBase> intrinsic = sfmData.getIntrinsicsharedPtr(view_1.getIntrinsicId());
+
+    // reuse the cost functions of the previous adjustment
+    if(costFunctions.firstToSecond && costFunctions.intrinsic == intrinsic.get() && costFunctions.constraint == constraint)
+      continue;
+
+    costFunctions.constraint = constraint;
+    costFunctions.intrinsic = intrinsic.get();
+
+    std::shared_ptr<camera::EquiDistant> equidistant = std::dynamic_pointer_cast<camera::EquiDistant>(intrinsic);
+    std::shared_ptr<camera::Pinhole> pinhole = std::dynamic_pointer_cast<camera::Pinhole>(intrinsic);
+
+    if (equidistant != nullptr)
+    {
+      costFunctions.firstToSecond.reset(new CostEquiDistant(constraint.ObservationFirst.x, constraint.ObservationSecond.x, equidistant));
+      /* Symmetry */
+      costFunctions.secondToFirst.reset(new CostEquiDistant(constraint.ObservationSecond.x, constraint.ObservationFirst.x, equidistant));
+    }
+    else if (pinhole != nullptr)
+    {
+      costFunctions.firstToSecond.reset(new CostPinHole(constraint.ObservationFirst.x, constraint.ObservationSecond.x, pinhole));
+      /* Symmetry */
+      costFunctions.secondToFirst.reset(new CostPinHole(constraint.ObservationSecond.x, constraint.ObservationFirst.x, pinhole));
+    }
+    else
+    {
+      // incompatible camera
+      costFunctions.firstToSecond.reset();
+      costFunctions.secondToFirst.reset();
+    }
+  }
+}
+
 void BundleAdjustmentPanoramaCeres::addConstraints2DToProblem(const sfmData::SfMData& sfmData, ERefineOptions refineOptions, ceres::Problem& problem)
 {
   // set a LossFunction to be less penalized by false measurements.
   // note: set it to NULL if you don't want use a lossFunction.
   ceres::LossFunction* lossFunction = new ceres::HuberLoss(Square(8.0)); // TODO: make the LOSS function and the parameter an option
 
-  for (const auto & constraint : sfmData.getConstraints2D()) {
+  // the cost functions are built in parallel, only the residual blocks insertion is sequential
+  updateConstraints2DCostFunctions(sfmData);
+
+  for (const Constraint2DCostFunctions& costFunctions : _constraints2DCostFunctions) {
+    const sfmData::Constraint2D& constraint = costFunctions.constraint;
     const sfmData::View& view_1 = sfmData.getView(constraint.ViewFirst);
     const sfmData::View& view_2 = sfmData.getView(constraint.ViewSecond);
 
@@ -602,31 +651,14 @@ void BundleAdjustmentPanoramaCeres::addConstraints2DToProblem(const sfmData::SfM
     /* For the moment assume a unique camera */
     assert(intrinsicBlockPtr_1 == intrinsicBlockPtr_2);
 
-    std::shared_ptr<IntrinsicBase> intrinsic = sfmData.getIntrinsicsharedPtr(view_1.getIntrinsicId());
-    std::shared_ptr<camera::EquiDistant> equidistant = std::dynamic_pointer_cast<camera::EquiDistant>(intrinsic);
-    std::shared_ptr<camera::Pinhole> pinhole = std::dynamic_pointer_cast<camera::Pinhole>(intrinsic);
-
-    if (equidistant != nullptr)  
-    {
-      ceres::CostFunction* costFunction = new CostEquiDistant(constraint.ObservationFirst.x, constraint.ObservationSecond.x, equidistant);
-      problem.AddResidualBlock(costFunction, lossFunction, poseBlockPtr_1, poseBlockPtr_2, intrinsicBlockPtr_1);
-
-      /* Symmetry */
-      costFunction = new CostEquiDistant(constraint.ObservationSecond.x, constraint.ObservationFirst.x, equidistant);
-      problem.AddResidualBlock(costFunction, lossFunction, poseBlockPtr_2, poseBlockPtr_1, intrinsicBlockPtr_1);
-    }
-    else if (pinhole != nullptr)  
-    {
-      ceres::CostFunction* costFunction = new CostPinHole(constraint.ObservationFirst.x, constraint.ObservationSecond.x, pinhole);
-      problem.AddResidualBlock(costFunction, lossFunction, poseBlockPtr_1, poseBlockPtr_2, intrinsicBlockPtr_1);
-      /* Symmetry */
-      costFunction = new CostPinHole(constraint.ObservationSecond.x, constraint.ObservationFirst.x, pinhole);
-      problem.AddResidualBlock(costFunction, lossFunction, poseBlockPtr_2, poseBlockPtr_1, intrinsicBlockPtr_1);
-    }
-    else {
+    if (!costFunctions.firstToSecond) {
       ALICEVISION_LOG_ERROR("Incompatible camera for a 2D constraint");
       return;
     }
+
+    problem.AddResidualBlock(costFunctions.firstToSecond.get(), lossFunction, poseBlockPtr_1, poseBlockPtr_2, intrinsicBlockPtr_1);
+    /* Symmetry */
+    problem.AddResidualBlock(costFunctions.secondToFirst.get(), lossFunction, poseBlockPtr_2, poseBlockPtr_1, intrinsicBlockPtr_1);
   }
 }
 
@@ -636,6 +668,8 @@ void BundleAdjustmentPanoramaCeres::addRotationPriorsToProblem(const sfmData::Sf
   // note: set it to NULL if you don't want use a lossFunction.
   ceres::LossFunction* lossFunction = nullptr;
 
+  _rotationPriorsCostFunctions.reserve(sfmData.getRotationPriors().size());
+
   for (const auto & prior : sfmData.getRotationPriors()) {
 
     const sfmData::View& view_1 = sfmData.getView(prior.ViewFirst);
@@ -647,8 +681,8 @@ void BundleAdjustmentPanoramaCeres::addRotationPriorsToProblem(const sfmData::Sf
     double * poseBlockPtr_1 = _posesBlocks.at(view_1.getPoseId()).data();
     double * poseBlockPtr_2 = _posesBlocks.at(view_2.getPoseId()).data();
 
-    ceres::CostFunction* costFunction = new CostRotationPrior(prior._second_R_first);
-    problem.AddResidualBlock(costFunction, lossFunction, poseBlockPtr_1, poseBlockPtr_2);
+    _rotationPriorsCostFunctions.emplace_back(new CostRotationPrior(prior._second_R_first));
+    problem.AddResidualBlock(_rotationPriorsCostFunctions.back().get(), lossFunction, poseBlockPtr_1, poseBlockPtr_2);
   }
 }
 
@@ -717,7 +751,10 @@ void BundleAdjustmentPanoramaCeres::updateFromSolution(sfmData::SfMData& sfmData
 bool BundleAdjustmentPanoramaCeres::adjust(sfmData::SfMData& sfmData, ERefineOptions refineOptions)
 {
   // create problem
-  ceres::Problem problem;
+  // note: the cost functions are owned by this object, the 2D constraints ones are reused by the next adjustments
+  ceres::Problem::Options problemOptions;
+  problemOptions.cost_function_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
+  ceres::Problem problem(problemOptions);
   createProblem(sfmData, refineOptions, problem);
   
   // configure a Bundle Adjustment engine and run it
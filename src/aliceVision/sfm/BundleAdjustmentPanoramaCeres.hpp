@@ -11,10 +11,14 @@
 #include <aliceVision/alicevision_omp.hpp>
 #include <aliceVision/sfm/BundleAdjustment.hpp>
 #include <aliceVision/sfm/LocalBundleAdjustmentGraph.hpp>
+#include <aliceVision/sfmData/Constraint2D.hpp>
 
 #include <ceres/ceres.h>
 #include "liealgebra.hpp"
 
+#include <memory>
+#include <vector>
+
 
 namespace aliceVision {
 
@@ -23,6 +27,10 @@ namespace sfmData {
 class SfMData;
 } // namespace sfmData
 
+namespace camera {
+class IntrinsicBase;
+} // namespace camera
+
 namespace sfm {
 
 class BundleAdjustmentPanoramaCeres : public BundleAdjustment
@@ -155,6 +163,7 @@ private:
     _statistics = Statistics();
     _posesBlocks.clear();
     _intrinsicsBlocks.clear();
+    _rotationPriorsCostFunctions.clear();
   }
 
   /**
@@ -179,6 +188,13 @@ private:
    */
   void addIntrinsicsToProblem(const sfmData::SfMData& sfmData, ERefineOptions refineOptions, ceres::Problem& problem);
 
+  /**
+   * @brief Build the cost functions of the 2D constraints, in parallel.
+   *        The cost functions of the previous adjustment are kept for the unchanged constraints.
+   * @param[in] sfmData The input SfMData contains all the information about the reconstruction, notably the intrinsics
+   */
+  void updateConstraints2DCostFunctions(const sfmData::SfMData& sfmData);
+
   /**
    * @brief Create a residual block for each 2D constraints
    * @param[in] sfmData The input SfMData contains all the information about the reconstruction, notably the intrinsics
@@ -252,6 +268,22 @@ private:
   /// block: intrinsics params
   HashMap<IndexT, std::vector<double>> _intrinsicsBlocks;
 
+  /// the cost functions of a 2D constraint, in both directions
+  struct Constraint2DCostFunctions
+  {
+    sfmData::Constraint2D constraint;
+    /// the intrinsic the cost functions were built with
+    const camera::IntrinsicBase* intrinsic = nullptr;
+    std::unique_ptr<ceres::CostFunction> firstToSecond;
+    std::unique_ptr<ceres::CostFunction> secondToFirst;
+  };
+
+  /// cost functions of the 2D constraints, kept from one adjustment to the next
+  /// note: the Ceres problem does not take the ownership of the cost functions
+  std::vector<Constraint2DCostFunctions> _constraints2DCostFunctions;
+
+  /// cost functions of the rotation priors of the current problem
+  std::vector<std::unique_ptr<ceres::CostFunction>> _rotationPriorsCostFunctions;
 };
 
 } // namespace sfm
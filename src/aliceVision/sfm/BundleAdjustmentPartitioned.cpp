@@ -0,0 +1,309 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "BundleAdjustmentPartitioned.hpp"
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <queue>
+
+namespace aliceVision {
+namespace sfm {
+
+namespace {
+
+/// pose graph: for each pose, the number of landmarks shared with each neighbor pose
+using PoseGraph = std::map<IndexT, std::map<IndexT, std::size_t>>;
+
+PoseGraph buildPoseGraph(const sfmData::SfMData& sfmData)
+{
+  PoseGraph poseGraph;
+
+  for(const auto& posePair : sfmData.getPoses())
+    poseGraph[posePair.first];
+
+  std::vector<IndexT> landmarkPoses;
+  for(const auto& landmarkPair : sfmData.getLandmarks())
+  {
+    landmarkPoses.clear();
+    for(const auto& observationPair : landmarkPair.second.observations)
+    {
+      const sfmData::View& view = sfmData.getView(observationPair.first);
+      if(sfmData.isPoseAndIntrinsicDefined(&view))
+        landmarkPoses.push_back(view.getPoseId());
+    }
+    std::sort(landmarkPoses.begin(), landmarkPoses.end());
+    landmarkPoses.erase(std::unique(landmarkPoses.begin(), landmarkPoses.end()), landmarkPoses.end());
+
+    for(std::size_t i = 0; i < landmarkPoses.size(); ++i)
+    {
+      for(std::size_t j = i + 1; j < landmarkPoses.size(); ++j)
+      {
+        ++poseGraph[landmarkPoses[i]][landmarkPoses[j]];
+        ++poseGraph[landmarkPoses[j]][landmarkPoses[i]];
+      }
+    }
+  }
+  return poseGraph;
+}
+
+/**
+ * @brief Create the scene adjusted by a cluster: its views, poses (overlap poses locked),
+ *        a copy of their intrinsics and the landmarks with at least 2 observations in the cluster.
+ */
+void buildClusterScene(const sfmData::SfMData& sfmData, const BundleAdjustmentPartitioned::PoseCluster& cluster, sfmData::SfMData& clusterData)
+{
+  for(const auto& viewPair : sfmData.getViews())
+  {
+    const sfmData::View& view = *viewPair.second;
+
+    if(!sfmData.isPoseAndIntrinsicDefined(&view))
+      continue;
+
+    const IndexT poseId = view.getPoseId();
+    const bool isAdjusted = (cluster.poses.count(poseId) > 0);
+
+    if(!isAdjusted && cluster.overlapPoses.count(poseId) == 0)
+      continue;
+
+    clusterData.views[viewPair.first] = viewPair.second;
+
+    // intrinsics are modified by the adjustment, each cluster works on its own copy
+    if(clusterData.intrinsics.count(view.getIntrinsicId()) == 0)
+      clusterData.intrinsics[view.getIntrinsicId()] = std::shared_ptr<camera::IntrinsicBase>(sfmData.getIntrinsics().at(view.getIntrinsicId())->clone());
+
+    if(clusterData.getPoses().count(poseId) == 0)
+    {
+      sfmData::CameraPose pose = sfmData.getPoses().at(poseId);
+      if(!isAdjusted)
+        pose.lock();
+      clusterData.getPoses().emplace(poseId, pose);
+    }
+  }
+
+  for(const auto& landmarkPair : sfmData.getLandmarks())
+  {
+    const sfmData::Landmark& landmark = landmarkPair.second;
+    sfmData::Observations observations;
+
+    for(const auto& observationPair : landmark.observations)
+    {
+      if(clusterData.views.count(observationPair.first))
+        observations.insert(observations.end(), observationPair);
+    }
+
+    if(observations.size() >= 2)
+      clusterData.structure[landmarkPair.first] = sfmData::Landmark(landmark.X, landmark.descType, observations, landmark.rgb);
+  }
+}
+
+} // namespace
+
+std::vector<BundleAdjustmentPartitioned::PoseCluster> BundleAdjustmentPartitioned::computePoseClusters(const sfmData::SfMData& sfmData, const PartitionOptions& partitionOptions)
+{
+  const PoseGraph poseGraph = buildPoseGraph(sfmData);
+  const std::size_t maxNbPoses = std::max<std::size_t>(1, partitionOptions.maxNbPosesPerCluster);
+
+  std::vector<PoseCluster> clusters;
+  std::set<IndexT> assignedPoses;
+
+  // grow each cluster from the first unassigned pose, adding its most connected neighbors first
+  for(const auto& seedPair : poseGraph)
+  {
+    if(assignedPoses.count(seedPair.first))
+      continue;
+
+    PoseCluster cluster;
+    std::map<IndexT, std::size_t> frontierScores;
+    // (score, -poseId): most connected pose first, smallest id on equality
+    std::priority_queue<std::pair<std::size_t, std::int64_t>> frontier;
+    frontier.emplace(0, -static_cast<std::int64_t>(seedPair.first));
+    frontierScores[seedPair.first] = 0;
+
+    while(!frontier.empty() && cluster.poses.size() < maxNbPoses)
+    {
+      const std::size_t score = frontier.top().first;
+      const IndexT poseId = static_cast<IndexT>(-frontier.top().second);
+      frontier.pop();
+
+      // skip outdated entries
+      if(assignedPoses.count(poseId) || frontierScores.at(poseId) != score)
+        continue;
+
+      cluster.poses.insert(poseId);
+      assignedPoses.insert(poseId);
+
+      for(const auto& neighborPair : poseGraph.at(poseId))
+      {
+        if(assignedPoses.count(neighborPair.first))
+          continue;
+        std::size_t& neighborScore = frontierScores[neighborPair.first];
+        neighborScore += neighborPair.second;
+        frontier.emplace(neighborScore, -static_cast<std::int64_t>(neighborPair.first));
+      }
+    }
+    clusters.push_back(cluster);
+  }
+
+  // add the most connected neighbor poses of each cluster
+  for(PoseCluster& cluster : clusters)
+  {
+    std::map<IndexT, std::size_t> neighborScores;
+    for(const IndexT poseId : cluster.poses)
+    {
+      for(const auto& neighborPair : poseGraph.at(poseId))
+      {
+        if(cluster.poses.count(neighborPair.first) == 0)
+          neighborScores[neighborPair.first] += neighborPair.second;
+      }
+    }
+
+    std::vector<std::pair<std::size_t, IndexT>> neighbors;
+    neighbors.reserve(neighborScores.size());
+    for(const auto& neighborPair : neighborScores)
+      neighbors.emplace_back(neighborPair.second, neighborPair.first);
+
+    std::sort(neighbors.begin(), neighbors.end(), [](const std::pair<std::size_t, IndexT>& a, const std::pair<std::size_t, IndexT>& b)
+    {
+      return (a.first != b.first) ? (a.first > b.first) : (a.second < b.second);
+    });
+
+    const std::size_t nbOverlapPoses = std::min(neighbors.size(), static_cast<std::size_t>(std::ceil(partitionOptions.overlapRatio * cluster.poses.size())));
+    for(std::size_t i = 0; i < nbOverlapPoses; ++i)
+      cluster.overlapPoses.insert(neighbors[i].second);
+  }
+
+  return clusters;
+}
+
+bool BundleAdjustmentPartitioned::adjust(sfmData::SfMData& sfmData, ERefineOptions refineOptions)
+{
+  if(sfmData.getPoses().size() <= _partitionOptions.maxNbPosesPerCluster ||
+     !sfmData.getRigs().empty() ||
+     !sfmData.getConstraints2D().empty() ||
+     !sfmData.getRotationPriors().empty())
+  {
+    // adjust the whole scene
+    BundleAdjustmentCeres BA(_ceresOptions, _minNbImagesToRefineOpticalCenter);
+    return BA.adjust(sfmData, refineOptions);
+  }
+
+  const bool refineIntrinsics = (refineOptions & REFINE_INTRINSICS_FOCAL) ||
+                                (refineOptions & REFINE_INTRINSICS_DISTORTION) ||
+                                (refineOptions & REFINE_INTRINSICS_OPTICALOFFSET_ALWAYS) ||
+                                (refineOptions & REFINE_INTRINSICS_OPTICALOFFSET_IF_ENOUGH_DATA);
+
+  const std::vector<PoseCluster> clusters = computePoseClusters(sfmData, _partitionOptions);
+
+  ALICEVISION_LOG_INFO("Partitioned bundle adjustment: " << sfmData.getPoses().size() << " poses split in " << clusters.size() << " clusters.");
+
+  // share the threads between the clusters adjusted in parallel
+  BundleAdjustmentCeres::CeresOptions clusterOptions = _ceresOptions;
+  clusterOptions.nbThreads = std::max(1, static_cast<int>(_ceresOptions.nbThreads) / std::max(1, std::min(omp_get_max_threads(), static_cast<int>(clusters.size()))));
+  clusterOptions.summary = false;
+
+  for(std::size_t iteration = 0; iteration < std::max<std::size_t>(1, _partitionOptions.nbConsensusIterations); ++iteration)
+  {
+    system::Timer timer;
+
+    // consensus data: adjusted poses, sum of the weighted landmarks positions and intrinsics parameters
+    std::map<IndexT, geometry::Pose3> adjustedPoses;
+    HashMap<IndexT, std::pair<Vec3, double>> landmarksSum;
+    std::map<IndexT, std::pair<std::vector<double>, double>> intrinsicsSum;
+    std::size_t nbAdjustedClusters = 0;
+
+    #pragma omp parallel for schedule(dynamic)
+    for(int c = 0; c < clusters.size(); ++c)
+    {
+      const PoseCluster& cluster = clusters.at(c);
+
+      sfmData::SfMData clusterData;
+      buildClusterScene(sfmData, cluster, clusterData);
+
+      BundleAdjustmentCeres BA(clusterOptions, _minNbImagesToRefineOpticalCenter);
+      if(!BA.adjust(clusterData, refineOptions))
+      {
+        ALICEVISION_LOG_WARNING("Partitioned bundle adjustment: cluster " << c << " failed, its poses are not updated.");
+        continue;
+      }
+
+      // number of views of each intrinsic in the cluster
+      std::map<IndexT, std::size_t> intrinsicsUsage;
+      for(const auto& viewPair : clusterData.getViews())
+        ++intrinsicsUsage[viewPair.second->getIntrinsicId()];
+
+      #pragma omp critical
+      {
+        ++nbAdjustedClusters;
+
+        for(const IndexT poseId : cluster.poses)
+          adjustedPoses[poseId] = clusterData.getPoses().at(poseId).getTransform();
+
+        for(const auto& landmarkPair : clusterData.getLandmarks())
+        {
+          const double weight = static_cast<double>(landmarkPair.second.observations.size());
+          auto it = landmarksSum.find(landmarkPair.first);
+          if(it == landmarksSum.end())
+            landmarksSum.emplace(landmarkPair.first, std::make_pair(Vec3(weight * landmarkPair.second.X), weight));
+          else
+          {
+            it->second.first += weight * landmarkPair.second.X;
+            it->second.second += weight;
+          }
+        }
+
+        if(refineIntrinsics)
+        {
+          for(const auto& usagePair : intrinsicsUsage)
+          {
+            const std::vector<double> params = clusterData.getIntrinsics().at(usagePair.first)->getParams();
+            const double weight = static_cast<double>(usagePair.second);
+            std::pair<std::vector<double>, double>& sum = intrinsicsSum[usagePair.first];
+            sum.first.resize(params.size(), 0.0);
+            for(std::size_t i = 0; i < params.size(); ++i)
+              sum.first[i] += weight * params[i];
+            sum.second += weight;
+          }
+        }
+      }
+    }
+
+    if(nbAdjustedClusters == 0)
+    {
+      ALICEVISION_LOG_WARNING("Partitioned bundle adjustment failed, no cluster solution is usable.");
+      return false;
+    }
+
+    // reconcile the clusters solutions
+    for(const auto& posePair : adjustedPoses)
+      sfmData.getPoses().at(posePair.first).setTransform(posePair.second);
+
+    for(const auto& landmarkPair : landmarksSum)
+      sfmData.getLandmarks().at(landmarkPair.first).X = landmarkPair.second.first / landmarkPair.second.second;
+
+    for(auto& intrinsicPair : intrinsicsSum)
+    {
+      std::vector<double>& params = intrinsicPair.second.first;
+      for(double& param : params)
+        param /= intrinsicPair.second.second;
+      sfmData.getIntrinsics().at(intrinsicPair.first)->updateFromParams(params);
+    }
+
+    ALICEVISION_LOG_INFO("Partitioned bundle adjustment iteration " << iteration << ": " << nbAdjustedClusters << "/" << clusters.size()
+                         << " clusters adjusted in " << timer.elapsed() << " s.");
+  }
+
+  return true;
+}
+
+} // namespace sfm
+} // namespace aliceVision
@@ -0,0 +1,102 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+#include <aliceVision/sfm/BundleAdjustment.hpp>
+#include <aliceVision/sfm/BundleAdjustmentCeres.hpp>
+
+#include <set>
+#include <vector>
+
+namespace aliceVision {
+
+namespace sfmData {
+class SfMData;
+} // namespace sfmData
+
+namespace sfm {
+
+/**
+ * @brief Bundle adjustment of large scenes by overlapping clusters of poses.
+ *
+ * The poses are split into clusters grown on the pose graph (edges weighted by the number of shared landmarks).
+ * Each cluster is extended with its most connected neighbor poses, which are kept constant in the cluster adjustment.
+ * The clusters are adjusted in parallel with BundleAdjustmentCeres, then the results are reconciled:
+ * each pose is owned by one cluster, shared landmarks and intrinsics are averaged.
+ * Repeating this consensus step propagates the corrections between the clusters.
+ */
+class BundleAdjustmentPartitioned : public BundleAdjustment
+{
+public:
+
+  /**
+   * @brief Contains the partition parameters.
+   */
+  struct PartitionOptions
+  {
+    PartitionOptions()
+    {}
+
+    /// maximum number of poses adjusted by a cluster (without the overlap)
+    std::size_t maxNbPosesPerCluster = 1000;
+    /// number of constant neighbor poses added to a cluster, relative to its number of poses
+    double overlapRatio = 0.25;
+    /// number of adjustment / consensus iterations
+    std::size_t nbConsensusIterations = 3;
+  };
+
+  /**
+   * @brief Cluster of poses.
+   */
+  struct PoseCluster
+  {
+    /// poses adjusted by the cluster
+    std::set<IndexT> poses;
+    /// neighbor poses, constant in the cluster adjustment
+    std::set<IndexT> overlapPoses;
+  };
+
+  /**
+   * @brief Partitioned bundle adjustment constructor
+   * @param[in] partitionOptions The partition parameters
+   * @param[in] ceresOptions The Ceres options used to adjust each cluster
+   * @param[in] minNbImagesToRefineOpticalCenter see BundleAdjustmentCeres
+   */
+  explicit BundleAdjustmentPartitioned(const PartitionOptions& partitionOptions = PartitionOptions(),
+                                       const BundleAdjustmentCeres::CeresOptions& ceresOptions = BundleAdjustmentCeres::CeresOptions(),
+                                       int minNbImagesToRefineOpticalCenter = 3)
+    : _partitionOptions(partitionOptions)
+    , _ceresOptions(ceresOptions)
+    , _minNbImagesToRefineOpticalCenter(minNbImagesToRefineOpticalCenter)
+  {}
+
+  /**
+   * @brief Perform a Bundle Adjustment on the SfM scene with refinement of the requested parameters.
+   *        Small scenes and scenes with rigs, 2D constraints or rotation priors are adjusted in one piece.
+   * @param[in,out] sfmData The input SfMData contains all the information about the reconstruction
+   * @param[in] refineOptions The chosen refine flag
+   * @return false if the bundle adjustment failed else true
+   */
+  bool adjust(sfmData::SfMData& sfmData, ERefineOptions refineOptions = REFINE_ALL) override;
+
+  /**
+   * @brief Split the poses into overlapping clusters
+   * @param[in] sfmData The input SfMData
+   * @param[in] partitionOptions The partition parameters
+   * @return the pose clusters, each pose is in the poses of exactly one cluster
+   */
+  static std::vector<PoseCluster> computePoseClusters(const sfmData::SfMData& sfmData, const PartitionOptions& partitionOptions);
+
+private:
+  PartitionOptions _partitionOptions;
+  BundleAdjustmentCeres::CeresOptions _ceresOptions;
+  int _minNbImagesToRefineOpticalCenter = 3;
+};
+
+} // namespace sfm
+} // namespace aliceVision
@@ -7,9 +7,11 @@
 
 #include <aliceVision/sfm/BundleAdjustmentSymbolicCeres.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/system/Profiler.hpp>
 #include <aliceVision/alicevision_omp.hpp>
 #include <aliceVision/config.hpp>
 #include <aliceVision/camera/Equidistant.hpp>
+#include <aliceVision/camera/IntrinsicsScaleOffsetDisto.hpp>
 #include <aliceVision/utils/CeresUtils.hpp>
 
 #include <boost/filesystem.hpp>
@@ -17,6 +19,8 @@
 #include <ceres/rotation.h>
 
 #include <fstream>
+#include <map>
+#include <memory>
 
 
 namespace fs = boost::filesystem;
@@ -188,6 +192,38 @@ class IntrinsicsManifoldSymbolic : public utils::CeresManifold {
 };
 
 
+namespace {
+
+/**
+ * @brief Get a copy of the intrinsics owned by the calling thread.
+ * @details The cost functions update the intrinsics with the evaluated parameters and
+ *          Ceres evaluates the residual blocks in parallel, so each thread works on its own copy
+ *          (with its own distortion object). The copy is made again if the source has been destroyed.
+ */
+camera::IntrinsicBase& getThreadIntrinsics(const std::shared_ptr<camera::IntrinsicBase>& intrinsics)
+{
+  struct ThreadIntrinsics
+  {
+    std::weak_ptr<camera::IntrinsicBase> source;
+    std::unique_ptr<camera::IntrinsicBase> copy;
+  };
+  thread_local std::map<const camera::IntrinsicBase*, ThreadIntrinsics> threadIntrinsics;
+
+  ThreadIntrinsics& entry = threadIntrinsics[intrinsics.get()];
+  if(entry.copy == nullptr || entry.source.expired())
+  {
+    entry.source = intrinsics;
+    entry.copy.reset(intrinsics->clone());
+
+    camera::IntrinsicsScaleOffsetDisto* intrinsicsDisto = dynamic_cast<camera::IntrinsicsScaleOffsetDisto*>(entry.copy.get());
+    if(intrinsicsDisto != nullptr && intrinsicsDisto->getDistortion() != nullptr)
+      intrinsicsDisto->setDistortionObject(std::shared_ptr<camera::Distortion>(intrinsicsDisto->getDistortion()->clone()));
+  }
+  return *entry.copy;
+}
+
+} // namespace
+
 class CostProjection : public ceres::CostFunction {
 public:
   CostProjection(const sfmData::Observation& measured, const std::shared_ptr<camera::IntrinsicBase> & intrinsics, bool withRig) : _measured(measured), _intrinsics(intrinsics), _withRig(withRig)
@@ -211,20 +247,19 @@ public:
     const Eigen::Map<const SE3::Matrix> cTr(parameter_rig);
     const Eigen::Map<const Vec3> pt(parameter_landmark);
 
-    /*Update intrinsics object with estimated parameters*/
-    size_t params_size = _intrinsics->getParams().size();
-    std::vector<double> params;
-    for (size_t param_id = 0; param_id < params_size; param_id++) {
-      params.push_back(parameter_intrinsics[param_id]);
-    }
-    _intrinsics->updateFromParams(params);
+    /*Update the thread copy of the intrinsics object with estimated parameters*/
+    camera::IntrinsicBase& intrinsics = getThreadIntrinsics(_intrinsics);
+    const size_t params_size = parameter_block_sizes()[2];
+    thread_local std::vector<double> params;
+    params.assign(parameter_intrinsics, parameter_intrinsics + params_size);
+    intrinsics.updateFromParams(params);
 
     const SE3::Matrix T = cTr * rTo;
     const geometry::Pose3 T_pose3(T.block<3, 4>(0, 0));
 
     const Vec4 pth = pt.homogeneous();
 
-    const Vec2 pt_est = _intrinsics->project(T_pose3, pth, true);
+    const Vec2 pt_est = intrinsics.project(T_pose3, pth, true);
     const double scale = (_measured.scale > 1e-12) ? _measured.scale : 1.0;
 
     residuals[0] = (pt_est(0) - _measured.x(0)) / scale;
@@ -239,26 +274,26 @@ public:
     if (jacobians[0] != nullptr) {
       Eigen::Map<Eigen::Matrix<double, 2, 16, Eigen::RowMajor>> J(jacobians[0]);
 
-      J = d_res_d_pt_est * _intrinsics->getDerivativeProjectWrtPose(T_pose3, pth) * getJacobian_AB_wrt_B<4, 4, 4>(cTr, rTo) * getJacobian_AB_wrt_A<4, 4, 4>(Eigen::Matrix4d::Identity(), rTo);
+      J = d_res_d_pt_est * intrinsics.getDerivativeProjectWrtPose(T_pose3, pth) * getJacobian_AB_wrt_B<4, 4, 4>(cTr, rTo) * getJacobian_AB_wrt_A<4, 4, 4>(Eigen::Matrix4d::Identity(), rTo);
     }
 
     if (jacobians[1] != nullptr) {
       Eigen::Map<Eigen::Matrix<double, 2, 16, Eigen::RowMajor>> J(jacobians[1]);
       
-      J = d_res_d_pt_est * _intrinsics->getDerivativeProjectWrtPose(T_pose3, pth) * getJacobian_AB_wrt_A<4, 4, 4>(cTr, rTo) * getJacobian_AB_wrt_A<4, 4, 4>(Eigen::Matrix4d::Identity(), cTr);
+      J = d_res_d_pt_est * intrinsics.getDerivativeProjectWrtPose(T_pose3, pth) * getJacobian_AB_wrt_A<4, 4, 4>(cTr, rTo) * getJacobian_AB_wrt_A<4, 4, 4>(Eigen::Matrix4d::Identity(), cTr);
     }
 
     if (jacobians[2] != nullptr) {
       Eigen::Map<Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>> J(jacobians[2], 2, params_size);
       
-      J = d_res_d_pt_est * _intrinsics->getDerivativeProjectWrtParams(T_pose3, pth);
+      J = d_res_d_pt_est * intrinsics.getDerivativeProjectWrtParams(T_pose3, pth);
     }
 
     if (jacobians[3] != nullptr) {
       Eigen::Map<Eigen::Matrix<double, 2, 3, Eigen::RowMajor>> J(jacobians[3]);
 
 
-      J = d_res_d_pt_est * _intrinsics->getDerivativeProjectWrtPoint(T_pose3, pth) * Eigen::Matrix<double, 4, 3>::Identity();
+      J = d_res_d_pt_est * intrinsics.getDerivativeProjectWrtPoint(T_pose3, pth) * Eigen::Matrix<double, 4, 3>::Identity();
     }
 
     return true;
@@ -891,6 +926,8 @@ void BundleAdjustmentSymbolicCeres::createJacobian(const sfmData::SfMData& sfmDa
 
 bool BundleAdjustmentSymbolicCeres::adjust(sfmData::SfMData& sfmData, ERefineOptions refineOptions)
 {
+  ALICEVISION_PROFILE_ZONE("bundleAdjustment");
+
   // create problem
   ceres::Problem::Options problemOptions;
   problemOptions.loss_function_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
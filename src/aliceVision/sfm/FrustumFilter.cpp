@@ -14,7 +14,9 @@
 #include <aliceVision/geometry/HalfPlane.hpp>
 #include <aliceVision/config.hpp>
 
+#include <algorithm>
 #include <fstream>
+#include <limits>
 
 namespace aliceVision {
 namespace sfm {
@@ -23,6 +25,147 @@ using namespace aliceVision::camera;
 using namespace aliceVision::geometry;
 using namespace aliceVision::geometry::halfPlane;
 
+namespace {
+
+/// Axis aligned bounding box of a bounded frustum
+struct BoundingBox
+{
+  Vec3 min = Vec3::Constant(std::numeric_limits<double>::max());
+  Vec3 max = Vec3::Constant(std::numeric_limits<double>::lowest());
+
+  BoundingBox() = default;
+
+  explicit BoundingBox(const std::vector<Vec3>& points)
+  {
+    for(const Vec3& point : points)
+      extend(point);
+  }
+
+  void extend(const Vec3& point)
+  {
+    min = min.cwiseMin(point);
+    max = max.cwiseMax(point);
+  }
+
+  void extend(const BoundingBox& box)
+  {
+    min = min.cwiseMin(box.min);
+    max = max.cwiseMax(box.max);
+  }
+
+  bool overlaps(const BoundingBox& box) const
+  {
+    return (min.array() <= box.max.array()).all() && (box.min.array() <= max.array()).all();
+  }
+
+  Vec3 center() const
+  {
+    return 0.5 * (min + max);
+  }
+};
+
+/**
+ * @brief Bounding volume hierarchy of the frustum boxes, split at the median of the box centers
+ *        along the largest axis. It is built once and queried concurrently.
+ */
+class BoundingBoxTree
+{
+public:
+  BoundingBoxTree(const std::vector<BoundingBox>& boxes, const std::vector<int>& indexes)
+    : _boxes(boxes)
+    , _indexes(indexes)
+  {
+    if(!_indexes.empty())
+      build(0, _indexes.size());
+  }
+
+  /// Append the indexes greater than index of the boxes overlapping the given box
+  void query(const BoundingBox& box, int index, std::vector<int>& overlapping) const
+  {
+    if(_nodes.empty())
+      return;
+
+    std::vector<int> stack(1, 0);
+    while(!stack.empty())
+    {
+      const Node& node = _nodes[stack.back()];
+      stack.pop_back();
+
+      if(!node.box.overlaps(box))
+        continue;
+
+      if(node.left < 0)
+      {
+        for(std::size_t i = node.begin; i < node.end; ++i)
+        {
+          const int j = _indexes[i];
+          if(j > index && _boxes[j].overlaps(box))
+            overlapping.push_back(j);
+        }
+      }
+      else
+      {
+        stack.push_back(node.left);
+        stack.push_back(node.right);
+      }
+    }
+  }
+
+private:
+  struct Node
+  {
+    BoundingBox box;
+    /// range of the leaf in _indexes
+    std::size_t begin = 0;
+    std::size_t end = 0;
+    /// children of an inner node, -1 for a leaf
+    int left = -1;
+    int right = -1;
+  };
+
+  static const std::size_t maxLeafSize = 4;
+
+  int build(std::size_t begin, std::size_t end)
+  {
+    const int nodeId = _nodes.size();
+    _nodes.emplace_back();
+
+    BoundingBox box;
+    BoundingBox centers;
+    for(std::size_t i = begin; i < end; ++i)
+    {
+      box.extend(_boxes[_indexes[i]]);
+      centers.extend(_boxes[_indexes[i]].center());
+    }
+    _nodes[nodeId].box = box;
+    _nodes[nodeId].begin = begin;
+    _nodes[nodeId].end = end;
+
+    if(end - begin <= maxLeafSize)
+      return nodeId;
+
+    int axis;
+    (centers.max - centers.min).maxCoeff(&axis);
+
+    const std::size_t middle = begin + (end - begin) / 2;
+    std::nth_element(_indexes.begin() + begin, _indexes.begin() + middle, _indexes.begin() + end,
+      [&](int a, int b) { return _boxes[a].center()(axis) < _boxes[b].center()(axis); });
+
+    // the vector of nodes may be reallocated by the recursive calls
+    const int left = build(begin, middle);
+    const int right = build(middle, end);
+    _nodes[nodeId].left = left;
+    _nodes[nodeId].right = right;
+    return nodeId;
+  }
+
+  const std::vector<BoundingBox>& _boxes;
+  std::vector<int> _indexes;
+  std::vector<Node> _nodes;
+};
+
+} // namespace
+
 // Constructor
 FrustumFilter::FrustumFilter(const sfmData::SfMData& sfmData, const double zNear, const double zFar)
 {
@@ -60,32 +203,69 @@ void FrustumFilter::initFrustum(const sfmData::SfMData& sfmData)
 
 PairSet FrustumFilter::getFrustumIntersectionPairs() const
 {
-  PairSet pairs;
-  // List active view Id
+  // List active view Id (sorted to get the same pairs whatever the hash order)
   std::vector<IndexT> viewIds;
-  viewIds.reserve(z_near_z_far_perView.size());
-  std::transform(z_near_z_far_perView.begin(), z_near_z_far_perView.end(),
+  viewIds.reserve(frustum_perView.size());
+  std::transform(frustum_perView.begin(), frustum_perView.end(),
     std::back_inserter(viewIds), stl::RetrieveKey());
+  std::sort(viewIds.begin(), viewIds.end());
+
+  std::vector<const Frustum*> frustums;
+  frustums.reserve(viewIds.size());
+  for(const IndexT viewId : viewIds)
+    frustums.push_back(&frustum_perView.at(viewId));
 
-  auto progressDisplay = system::createConsoleProgressDisplay(viewIds.size() * (viewIds.size()-1)/2,
+  // Only the frustums with a far plane are bounded, the others are tested against all the frustums
+  std::vector<BoundingBox> boxes(frustums.size());
+  std::vector<int> boundedFrustums;
+  std::vector<int> unboundedFrustums;
+  for(int i = 0; i < (int)frustums.size(); ++i)
+  {
+    if(frustums[i]->z_far > 0)
+    {
+      boxes[i] = BoundingBox(frustums[i]->frustum_points());
+      boundedFrustums.push_back(i);
+    }
+    else
+      unboundedFrustums.push_back(i);
+  }
+
+  const BoundingBoxTree tree(boxes, boundedFrustums);
+
+  auto progressDisplay = system::createConsoleProgressDisplay(viewIds.size(),
                                                               std::cout, "\nCompute frustum intersection\n");
 
-  // Exhaustive comparison (use the fact that the intersect function is symmetric)
-  #pragma omp parallel for
-  for (int i = 0; i < (int)viewIds.size(); ++i)
+  // Candidate pairs from the overlapping bounding boxes, refined by the exact intersection test.
+  // The intersect function is symmetric, so a pair is only tested from its lowest index.
+  std::vector<std::vector<int>> intersectingFrustums(frustums.size());
+
+  #pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < (int)frustums.size(); ++i)
   {
-    for (size_t j = i+1; j < viewIds.size(); ++j)
+    std::vector<int> candidates;
+    if(frustums[i]->z_far > 0)
+      tree.query(boxes[i], i, candidates);
+    else
+      for(int j = i + 1; j < (int)frustums.size(); ++j)
+        if(frustums[j]->z_far > 0)
+          candidates.push_back(j);
+
+    for(const int j : unboundedFrustums)
+      if(j > i)
+        candidates.push_back(j);
+
+    for(const int j : candidates)
     {
-      if (frustum_perView.at(viewIds[i]).intersect(frustum_perView.at(viewIds[j])))
-      {
-        #pragma omp critical
-        {
-          pairs.insert(std::make_pair(viewIds[i], viewIds[j]));
-        }
-      }
-      ++progressDisplay;
+      if(frustums[i]->intersect(*frustums[j]))
+        intersectingFrustums[i].push_back(j);
     }
+    ++progressDisplay;
   }
+
+  PairSet pairs;
+  for(int i = 0; i < (int)frustums.size(); ++i)
+    for(const int j : intersectingFrustums[i])
+      pairs.insert(std::make_pair(viewIds[i], viewIds[j]));
   return pairs;
 }
 
@@ -30,6 +30,7 @@ public:
   void initFrustum(const sfmData::SfMData& sfmData);
 
   /// return intersecting View frustum pairs
+  /// (only the pairs with overlapping bounding boxes are tested when the frustums have a far plane)
   PairSet getFrustumIntersectionPairs() const;
 
   /// export defined frustum in PLY file for viewing
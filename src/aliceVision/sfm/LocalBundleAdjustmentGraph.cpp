@@ -9,10 +9,9 @@
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <boost/filesystem.hpp>
 
-#include <lemon/bfs.h>
-
 #include <fstream>
 #include <algorithm>
+#include <cstdint>
 
 namespace fs = boost::filesystem;
 
@@ -41,12 +40,12 @@ std::map<int, std::size_t> LocalBundleAdjustmentGraph::getDistancesHistogram() c
   std::map<int, std::size_t> histogram;
 
   for(const auto& x : _distancePerViewId)
-  {
-    if(histogram.find(x.second) == histogram.end())
-      histogram[x.second] = 1;
-    else
-      histogram.at(x.second)++;
-  }
+    ++histogram[x.second];
+
+  // the views without distance are not connected to the new views or farther than the constant ones
+  if(!_distancePerViewId.empty() && _nodePerViewId.size() > _distancePerViewId.size())
+    histogram[-1] += _nodePerViewId.size() - _distancePerViewId.size();
+
   return histogram;
 }
 
@@ -134,6 +133,68 @@ void LocalBundleAdjustmentGraph::exportIntrinsicsHistory(const std::string& fold
   os.close();
 }
 
+void LocalBundleAdjustmentGraph::saveIntrinsicsState(std::ostream& stream) const
+{
+  const auto write = [&](const auto& value) { stream.write(reinterpret_cast<const char*>(&value), sizeof(value)); };
+
+  write(static_cast<std::uint64_t>(_intrinsicsHistory.size()));
+  for(const auto& intrinsicHistoryPair : _intrinsicsHistory)
+  {
+    write(static_cast<std::uint32_t>(intrinsicHistoryPair.first));
+    write(static_cast<std::uint8_t>(_mapFocalIsConstant.at(intrinsicHistoryPair.first)));
+    write(static_cast<std::uint64_t>(intrinsicHistoryPair.second.size()));
+    for(const IntrinsicHistory& intrinsicHistory : intrinsicHistoryPair.second)
+    {
+      write(static_cast<std::uint64_t>(intrinsicHistory.nbPoses));
+      write(intrinsicHistory.focalLength);
+      write(static_cast<std::uint8_t>(intrinsicHistory.isConstant));
+    }
+  }
+}
+
+bool LocalBundleAdjustmentGraph::loadIntrinsicsState(std::istream& stream)
+{
+  const auto read = [&](auto& value) { stream.read(reinterpret_cast<char*>(&value), sizeof(value)); return bool(stream); };
+
+  IntrinsicsHistory intrinsicsHistory;
+  std::map<IndexT, bool> mapFocalIsConstant;
+
+  std::uint64_t nbIntrinsics = 0;
+  if(!read(nbIntrinsics))
+    return false;
+
+  for(std::uint64_t i = 0; i < nbIntrinsics; ++i)
+  {
+    std::uint32_t intrinsicId;
+    std::uint8_t isConstant;
+    std::uint64_t historySize;
+    if(!read(intrinsicId) || !read(isConstant) || !read(historySize))
+      return false;
+
+    mapFocalIsConstant[intrinsicId] = isConstant;
+    std::vector<IntrinsicHistory>& history = intrinsicsHistory[intrinsicId];
+    for(std::uint64_t j = 0; j < historySize; ++j)
+    {
+      std::uint64_t nbPoses;
+      std::uint8_t isHistoryConstant;
+      IntrinsicHistory intrinsicHistory;
+      if(!read(nbPoses) || !read(intrinsicHistory.focalLength) || !read(isHistoryConstant))
+        return false;
+      intrinsicHistory.nbPoses = nbPoses;
+      intrinsicHistory.isConstant = isHistoryConstant;
+      history.push_back(intrinsicHistory);
+    }
+  }
+
+  // the intrinsics of the scene which are not in the state keep their initial history
+  for(auto& intrinsicHistoryPair : intrinsicsHistory)
+  {
+    _intrinsicsHistory[intrinsicHistoryPair.first] = std::move(intrinsicHistoryPair.second);
+    _mapFocalIsConstant[intrinsicHistoryPair.first] = mapFocalIsConstant.at(intrinsicHistoryPair.first);
+  }
+  return true;
+}
+
 bool LocalBundleAdjustmentGraph::removeViews(const sfmData::SfMData& sfmData, const std::set<IndexT>& removedViewsId)
 {
   std::size_t numRemovedNode = 0;
@@ -200,22 +261,18 @@ bool LocalBundleAdjustmentGraph::removeViews(const sfmData::SfMData& sfmData, co
 
 int LocalBundleAdjustmentGraph::getPoseDistance(const IndexT poseId) const
 {
-  if(_distancePerPoseId.find(poseId) == _distancePerPoseId.end())
-  {
-    ALICEVISION_LOG_DEBUG("The pose #" << poseId << " does not exist in the '_mapDistancePerPoseId' (map size: " << _distancePerPoseId.size() << ") \n");
+  const auto it = _distancePerPoseId.find(poseId);
+  if(it == _distancePerPoseId.end())
     return -1;
-  }
-  return _distancePerPoseId.at(poseId);
+  return it->second;
 }
 
 int LocalBundleAdjustmentGraph::getViewDistance(const IndexT viewId) const
 {
-  if(_distancePerViewId.find(viewId) == _distancePerViewId.end())
-  {
-    ALICEVISION_LOG_DEBUG("Cannot get the graph-distance of the view #" << viewId << ": does not exist in the '_mapDistancePerViewId':\n");
+  const auto it = _distancePerViewId.find(viewId);
+  if(it == _distancePerViewId.end())
     return -1;
-  }
-  return _distancePerViewId.at(viewId);
+  return it->second;
 }
 
 BundleAdjustment::EParameterState LocalBundleAdjustmentGraph::getStateFromDistance(int distance) const
@@ -311,35 +368,37 @@ void LocalBundleAdjustmentGraph::computeGraphDistances(const sfmData::SfMData& s
   // reset the maps
   _distancePerViewId.clear();
   _distancePerPoseId.clear();
-  
-  // setup Breadth First Search using Lemon
-  lemon::Bfs<lemon::ListGraph> bfs(_graph);
-  bfs.init();
-  
+
+  // Breadth First Search from the new views, limited to the distances giving a refined or constant state ([0; D+1]):
+  // the farther views are ignored in the same way as the views not connected to the new views,
+  // so only the neighborhood of the new views is explored.
+  const int maxDistance = static_cast<int>(_graphDistanceLimit) + 1;
+  std::vector<lemon::ListGraph::Node> frontier;
+  std::vector<lemon::ListGraph::Node> nextFrontier;
+
   // add source views for the bfs visit of the _graph
   for(const IndexT viewId: newReconstructedViews)
   {
     auto it = _nodePerViewId.find(viewId);
     if(it == _nodePerViewId.end())
       ALICEVISION_LOG_WARNING("The reconstructed view #" << viewId << " cannot be added as source for the BFS: does not exist in the graph.");
-    else
-      bfs.addSource(it->second);
+    else if(_distancePerViewId.emplace(viewId, 0).second)
+      frontier.push_back(it->second);
   }
-  bfs.start();
-  
-  // handle bfs results (distances)
-  for(const auto& x : _nodePerViewId) // each node in the graph
+
+  for(int distance = 1; distance <= maxDistance && !frontier.empty(); ++distance)
   {
-    auto& node = x.second;
-    int d = -1; 
-    
-    if(bfs.reached(node))
+    nextFrontier.clear();
+    for(const lemon::ListGraph::Node& node : frontier)
     {
-      d = bfs.dist(node);
-      // dist(): "If node v is not reached from the root(s), then the return value of this function is undefined."
-      // this is why the distance is previously set to -1.
+      for(lemon::ListGraph::IncEdgeIt edge(_graph, node); edge != lemon::INVALID; ++edge)
+      {
+        const lemon::ListGraph::Node neighbor = _graph.oppositeNode(node, edge);
+        if(_distancePerViewId.emplace(_viewIdPerNode.at(neighbor), distance).second)
+          nextFrontier.push_back(neighbor);
+      }
     }
-    _distancePerViewId[x.first] = d;
+    frontier.swap(nextFrontier);
   }
   
   // re-mapping from <ViewId, distance> to <PoseId, distance>:
@@ -433,6 +492,93 @@ void LocalBundleAdjustmentGraph::convertDistancesToStates(const sfmData::SfMData
   }
 }
 
+void LocalBundleAdjustmentGraph::setWindowStates(const sfmData::SfMData& sfmData, const track::TracksPerView& tracksPerView, const std::set<IndexT>& windowViewIds)
+{
+  // reset the maps
+  _statePerPoseId.clear();
+  _statePerIntrinsicId.clear();
+  _statePerLandmarkId.clear();
+
+  for(const auto& posePair : sfmData.getPoses())
+    _statePerPoseId[posePair.first] = BundleAdjustment::EParameterState::IGNORED;
+
+  for(const auto& intrinsicPair : sfmData.getIntrinsics())
+    _statePerIntrinsicId[intrinsicPair.first] = BundleAdjustment::EParameterState::CONSTANT;
+
+  for(const auto& landmarkPair : sfmData.getLandmarks())
+    _statePerLandmarkId[landmarkPair.first] = BundleAdjustment::EParameterState::IGNORED;
+
+  for(const IndexT viewId : windowViewIds)
+  {
+    const sfmData::View& view = sfmData.getView(viewId);
+    if(!sfmData.isPoseAndIntrinsicDefined(&view))
+      continue;
+    _statePerPoseId[view.getPoseId()] = BundleAdjustment::EParameterState::REFINED;
+    _statePerIntrinsicId[view.getIntrinsicId()] = BundleAdjustment::EParameterState::REFINED;
+  }
+
+  // the landmarks seen by the window are refined, the other poses observing them anchor the window
+  for(const IndexT viewId : windowViewIds)
+  {
+    const auto viewTracksIt = tracksPerView.find(viewId);
+    if(viewTracksIt == tracksPerView.end())
+      continue;
+
+    for(const IndexT trackId : viewTracksIt->second)
+    {
+      const auto landmarkIt = sfmData.getLandmarks().find(trackId);
+      if(landmarkIt == sfmData.getLandmarks().end())
+        continue;
+
+      // the observations of the landmarks already seen by another view of the window are not visited again
+      BundleAdjustment::EParameterState& landmarkState = _statePerLandmarkId.at(trackId);
+      if(landmarkState == BundleAdjustment::EParameterState::REFINED ||
+         landmarkIt->second.observations.count(viewId) == 0)
+        continue;
+
+      landmarkState = BundleAdjustment::EParameterState::REFINED;
+      for(const auto& observationPair : landmarkIt->second.observations)
+      {
+        BundleAdjustment::EParameterState& poseState = _statePerPoseId.at(sfmData.getView(observationPair.first).getPoseId());
+        if(poseState == BundleAdjustment::EParameterState::IGNORED)
+          poseState = BundleAdjustment::EParameterState::CONSTANT;
+      }
+    }
+  }
+}
+
+std::vector<IndexT> LocalBundleAdjustmentGraph::getLandmarksAffectedByRefinement(const sfmData::SfMData& sfmData) const
+{
+  // views with a refined pose or intrinsic, states unknown to the graph are considered as refined
+  HashMap<IndexT, bool> isViewRefined;
+  for(const auto& viewPair : sfmData.getViews())
+  {
+    const sfmData::View& view = *viewPair.second;
+    if(!sfmData.isPoseAndIntrinsicDefined(&view))
+      continue;
+
+    const auto poseStateIt = _statePerPoseId.find(view.getPoseId());
+    const auto intrinsicStateIt = _statePerIntrinsicId.find(view.getIntrinsicId());
+    isViewRefined[viewPair.first] = (poseStateIt == _statePerPoseId.end() || poseStateIt->second == BundleAdjustment::EParameterState::REFINED) ||
+                                    (intrinsicStateIt == _statePerIntrinsicId.end() || intrinsicStateIt->second == BundleAdjustment::EParameterState::REFINED);
+  }
+
+  std::vector<IndexT> landmarkIds;
+  for(const auto& landmarkPair : sfmData.getLandmarks())
+  {
+    for(const auto& observationPair : landmarkPair.second.observations)
+    {
+      const auto isViewRefinedIt = isViewRefined.find(observationPair.first);
+      if(isViewRefinedIt == isViewRefined.end() || isViewRefinedIt->second)
+      {
+        landmarkIds.push_back(landmarkPair.first);
+        break;
+      }
+    }
+  }
+  return landmarkIds;
+}
+
 std::vector<Pair> LocalBundleAdjustmentGraph::getNewEdges(
     const sfmData::SfMData& sfmData,
     const track::TracksPerView& tracksPerView,
@@ -613,7 +759,7 @@ void LocalBundleAdjustmentGraph::drawGraph(const sfmData::SfMData& sfmData, cons
   for(lemon::ListGraph::NodeIt n(_graph); n!=lemon::INVALID; ++n)
   {
     const IndexT viewId = _viewIdPerNode[n];
-    const int viewDist = _distancePerViewId[viewId];
+    const int viewDist = getViewDistance(viewId);
     
     std::string color = ", color=";
     if(viewDist == 0) color += "red";
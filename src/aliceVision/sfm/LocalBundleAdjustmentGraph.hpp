@@ -12,6 +12,9 @@
 
 #include <lemon/list_graph.h>
 
+#include <istream>
+#include <ostream>
+
 
 namespace aliceVision {
 
@@ -34,6 +37,7 @@ public:
 
   /**
    * @brief Return the number of posed views for each graph-distance
+   * @details The views farther than the graph-distance limit + 1 are counted as not connected (-1).
    * @return map<distance, numViews>
    */
   std::map<int, std::size_t> getDistancesHistogram() const;
@@ -147,6 +151,19 @@ public:
    */
   void exportIntrinsicsHistory(const std::string& folder, const std::string& filename);
 
+  /**
+   * @brief Write the intrinsics history and the stable focal lengths, they cannot be recomputed from a scene.
+   * @param[in,out] stream The binary output stream
+   */
+  void saveIntrinsicsState(std::ostream& stream) const;
+
+  /**
+   * @brief Restore the intrinsics state written by saveIntrinsicsState, before adding the views to the graph.
+   * @param[in,out] stream The binary input stream
+   * @return false if the stream is invalid
+   */
+  bool loadIntrinsicsState(std::istream& stream);
+
   /**
    * @brief Remove specific views from the LocalBA graph. 
    * @details Delete the nodes corresponding to those views and all their incident edges.
@@ -170,7 +187,8 @@ public:
   
   /**
    * @brief Compute the intragraph-distance between all the nodes of the graph (posed views) and the newly resected views.
-   * @details The graph-distances are computed using a Breadth-first Search (BFS) method.
+   * @details The graph-distances are computed using a Breadth-first Search (BFS) method,
+   *          stopped at the graph-distance limit + 1 as the farther views are ignored by the local BA.
    * @param[in] sfmData contains all the information about the reconstruction, notably the posed views
    * @param[in] newReconstructedViews The list of the newly resected views used (used as source in the BFS algorithm)
    */
@@ -199,6 +217,28 @@ public:
    */
   void convertDistancesToStates(const sfmData::SfMData& sfmData);
 
+  /**
+   * @brief Set the states of the parameters to refine a window of views instead of using the graph-distances:
+   *      - a Pose is set to Refined if one of its views is in the window,
+   *        Constant if it observes a refined landmark, Ignored otherwise.
+   *      - an Intrinsic is set to Refined if it is used by a view of the window, Constant otherwise.
+   *      - a Landmark is set to Refined if it is observed by a view of the window, Ignored otherwise.
+   *      Only the landmarks of the tracks of the window views are visited (the landmark ids are the track ids).
+   * @param[in] sfmData contains all the information about the reconstruction
+   * @param[in] tracksPerView the tracks of each view
+   * @param[in] windowViewIds the views to refine
+   */
+  void setWindowStates(const sfmData::SfMData& sfmData, const track::TracksPerView& tracksPerView, const std::set<IndexT>& windowViewIds);
+
+  /**
+   * @brief Get the landmarks whose reprojections can be changed by a bundle adjustment using the current states:
+   *        the landmarks observed by a view with a refined pose or a refined intrinsic.
+   *        The other landmarks keep the residuals and angles of the previous outliers filtering.
+   * @param[in] sfmData contains all the information about the reconstruction
+   * @return the ids of the landmarks
+   */
+  std::vector<IndexT> getLandmarksAffectedByRefinement(const sfmData::SfMData& sfmData) const;
+
   /**
    * @brief Update rigs edges.
    * @param[in] sfmData contains all the information about the reconstruction
@@ -223,14 +263,14 @@ private:
   /**
    * @brief Return the distance between a specific pose and the new posed views.
    * @param[in] poseId is the index of the poseId
-   * @return Return \c -1 if the pose is not connected to any new posed view.
+   * @return Return \c -1 if the pose is not connected to any new posed view or farther than the graph-distance limit + 1.
    */
   int getPoseDistance(const IndexT poseId) const;
 
   /**
    * @brief Return the distance between a specific view and the new posed views.
    * @param[in] viewId is the index of the view
-   * @return Return \c -1 if the view is not connected to any new posed view.
+   * @return Return \c -1 if the view is not connected to any new posed view or farther than the graph-distance limit + 1.
    */
   int getViewDistance(const IndexT viewId) const;
 
@@ -324,16 +364,17 @@ private:
   std::map<IndexT, lemon::ListGraph::Node> _nodePerViewId;
   /// Associates each node (in the graph) to its corresponding view.
   std::map<lemon::ListGraph::Node, IndexT> _viewIdPerNode;
-  /// Store the graph-distances from the new views (0: is a new view, -1: is not connected to the new views)
-  std::map<IndexT, int> _distancePerViewId;
-  /// Store the graph-distances from the new poses (0: is a new pose, -1: is not connected to the new poses)
-  std::map<IndexT, int> _distancePerPoseId;
+  /// Store the graph-distances from the new views, up to the graph-distance limit + 1 (0: is a new view).
+  /// The views not connected to the new views, or farther, have no distance.
+  HashMap<IndexT, int> _distancePerViewId;
+  /// Store the graph-distances from the new poses, up to the graph-distance limit + 1 (0: is a new pose)
+  HashMap<IndexT, int> _distancePerPoseId;
   /// Store the \c EParameterState of each pose in the scene.
-  std::map<IndexT, BundleAdjustment::EParameterState> _statePerPoseId;
+  HashMap<IndexT, BundleAdjustment::EParameterState> _statePerPoseId;
   /// Store the \c EParameterState of each intrinsic in the scene.
-  std::map<IndexT, BundleAdjustment::EParameterState> _statePerIntrinsicId;
+  HashMap<IndexT, BundleAdjustment::EParameterState> _statePerIntrinsicId;
   /// Store the \c EParameterState of each landmark in the scene.
-  std::map<IndexT, BundleAdjustment::EParameterState> _statePerLandmarkId;
+  HashMap<IndexT, BundleAdjustment::EParameterState> _statePerLandmarkId;
   
   // Intrinsics data
   // - Local BA needs to know the evolution of all the intrinsics parameters.
@@ -137,6 +137,75 @@ BOOST_AUTO_TEST_CASE(BUNDLE_ADJUSTMENT_EffectiveMinimization_PinholeFisheye)
   BOOST_CHECK_LT(dResidual_after, dResidual_before);
 }
 
+BOOST_AUTO_TEST_CASE(BUNDLE_ADJUSTMENT_IncrementalProblem_Pinhole)
+{
+  const int nviews = 4;
+  const int npoints = 8;
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  // Translate the input dataset to a SfMData scene
+  SfMData sfmData = getInputScene(d, config, EINTRINSIC::PINHOLE_CAMERA);
+
+  const double dResidual_before = RMSE(sfmData);
+
+  BundleAdjustmentCeres ba;
+  ba.setIncrementalProblem(true);
+  BOOST_CHECK(ba.adjust(sfmData));
+
+  const double dResidual_first = RMSE(sfmData);
+  BOOST_CHECK_LT(dResidual_first, dResidual_before);
+  BOOST_CHECK_EQUAL(ba.getStatistics().nbResidualBlocks, 2 * nviews * npoints);
+
+  // remove a landmark and an observation, the kept problem is updated
+  sfmData.getLandmarks().erase(0);
+  sfmData.getLandmarks().at(1).observations.erase(0);
+
+  BOOST_CHECK(ba.adjust(sfmData));
+  BOOST_CHECK_EQUAL(ba.getStatistics().nbResidualBlocks, 2 * (nviews * (npoints - 1) - 1));
+  BOOST_CHECK_LT(RMSE(sfmData), dResidual_before);
+}
+
+BOOST_AUTO_TEST_CASE(PARTITIONED_BUNDLE_ADJUSTMENT_EffectiveMinimization_Pinhole)
+{
+  const int nviews = 8;
+  const int npoints = 12;
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  // Translate the input dataset to a SfMData scene
+  SfMData sfmData = getInputScene(d, config, EINTRINSIC::PINHOLE_CAMERA);
+
+  BundleAdjustmentPartitioned::PartitionOptions partitionOptions;
+  partitionOptions.maxNbPosesPerCluster = 3;
+  partitionOptions.overlapRatio = 0.5;
+
+  // each pose is adjusted by exactly one cluster
+  const std::vector<BundleAdjustmentPartitioned::PoseCluster> clusters = BundleAdjustmentPartitioned::computePoseClusters(sfmData, partitionOptions);
+  BOOST_CHECK_EQUAL(clusters.size(), 3);
+
+  std::set<IndexT> clusteredPoses;
+  for(const auto& cluster : clusters)
+  {
+    BOOST_CHECK_LE(cluster.poses.size(), partitionOptions.maxNbPosesPerCluster);
+    BOOST_CHECK(!cluster.overlapPoses.empty());
+    for(const IndexT poseId : cluster.poses)
+    {
+      BOOST_CHECK(cluster.overlapPoses.count(poseId) == 0);
+      BOOST_CHECK(clusteredPoses.insert(poseId).second);
+    }
+  }
+  BOOST_CHECK_EQUAL(clusteredPoses.size(), sfmData.getPoses().size());
+
+  const double dResidual_before = RMSE(sfmData);
+
+  BundleAdjustmentPartitioned ba(partitionOptions);
+  BOOST_CHECK(ba.adjust(sfmData));
+
+  const double dResidual_after = RMSE(sfmData);
+  BOOST_CHECK_LT(dResidual_after, dResidual_before);
+}
+
 BOOST_AUTO_TEST_CASE(LOCAL_BUNDLE_ADJUSTMENT_EffectiveMinimization_Pinhole_CamerasRing)
 {
   const int nviews = 4;
@@ -7,6 +7,8 @@
 
 #include "generateReport.hpp"
 #include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfmData/LandmarksColumns.hpp>
+#include <aliceVision/sfm/sfmStatistics.hpp>
 
 #include <aliceVision/utils/Histogram.hpp>
 #include <dependencies/htmlDoc/htmlDoc.hpp>
@@ -23,26 +25,19 @@ bool generateSfMReport(const sfmData::SfMData& sfmData,
                        const std::string& htmlFilename)
 {
   // Compute mean,max,median residual values per View
-  IndexT residualCount = 0;
+  const sfmData::LandmarksColumns columns(sfmData.getLandmarks());
+  const sfmData::ObservationCameras cameras(sfmData, columns);
+  Mat2X residuals;
+  computeObservationsResiduals(columns, cameras, residuals);
+
+  const IndexT residualCount = columns.nbObservations();
   HashMap< IndexT, std::vector<double> > residuals_per_view;
-  for(sfmData::Landmarks::const_iterator iterTracks = sfmData.getLandmarks().begin();
-    iterTracks != sfmData.getLandmarks().end();
-    ++iterTracks
-  )
+  for(std::size_t o = 0; o < columns.nbObservations(); ++o)
   {
-    const sfmData::Observations & observations = iterTracks->second.observations;
-    for(sfmData::Observations::const_iterator itObs = observations.begin();
-      itObs != observations.end(); ++itObs)
-    {
-      const sfmData::View * view = sfmData.getViews().at(itObs->first).get();
-      const geometry::Pose3 pose = sfmData.getPose(*view).getTransform();
-      const camera::IntrinsicBase * intrinsic = sfmData.getIntrinsics().at(view->getIntrinsicId()).get();
-      // Use absolute values
-      const Vec2 residual = intrinsic->residual(pose, iterTracks->second.X.homogeneous(), itObs->second.x).array().abs();
-      residuals_per_view[itObs->first].push_back(residual(0));
-      residuals_per_view[itObs->first].push_back(residual(1));
-      ++residualCount;
-    }
+    // Use absolute values
+    std::vector<double>& viewResiduals = residuals_per_view[columns.observationViewIds[o]];
+    viewResiduals.push_back(std::abs(residuals(0, o)));
+    viewResiduals.push_back(std::abs(residuals(1, o)));
   }
   using namespace htmlDocument;
   // extract directory from htmlFilename
@@ -0,0 +1,214 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "LazyRegionsPerView.hpp"
+
+#include <aliceVision/sfm/pipeline/regionsIO.hpp>
+#include <aliceVision/system/Logger.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <set>
+
+namespace aliceVision {
+namespace sfm {
+
+namespace fs = boost::filesystem;
+
+LazyRegionsPerView::LazyRegionsPerView(const sfmData::SfMData& sfmData,
+                                       const std::vector<std::string>& folders,
+                                       const std::vector<feature::EImageDescriberType>& imageDescriberTypes,
+                                       std::size_t memoryBudget)
+  : _sfmData(sfmData)
+  , _imageDescriberTypes(imageDescriberTypes)
+  , _memoryBudget(memoryBudget)
+{
+  _featuresFolders = sfmData.getFeaturesFolders(); // add sfm features folders
+  _featuresFolders.insert(_featuresFolders.end(), folders.begin(), folders.end()); // add user features folders
+  auto last = std::unique(_featuresFolders.begin(), _featuresFolders.end());
+  _featuresFolders.erase(last, _featuresFolders.end());
+
+  _imageDescribers.resize(imageDescriberTypes.size());
+  _regionsPacks.resize(imageDescriberTypes.size());
+
+  for(std::size_t i = 0; i < imageDescriberTypes.size(); ++i)
+  {
+    _imageDescribers.at(i) = feature::createImageDescriber(imageDescriberTypes.at(i));
+    _regionsPacks.at(i) = openRegionsPack(_featuresFolders, imageDescriberTypes.at(i));
+  }
+}
+
+void LazyRegionsPerView::setPairs(const std::vector<Pair>& orderedPairs)
+{
+  _pairs = orderedPairs;
+  _nextPair = 0;
+  _remainingPairsPerView.clear();
+
+  for(const Pair& pair : _pairs)
+  {
+    ++_remainingPairsPerView[pair.first];
+    ++_remainingPairsPerView[pair.second];
+  }
+
+  // the first batch is sized from the descriptors files, before any view is loaded
+  _estimatedViewMemory.clear();
+  for(const auto& remainingPairs : _remainingPairsPerView)
+    _estimatedViewMemory[remainingPairs.first] = estimateViewDescriptorsMemory(remainingPairs.first);
+}
+
+std::size_t LazyRegionsPerView::estimateViewDescriptorsMemory(IndexT viewId) const
+{
+  std::size_t memory = 0;
+  for(std::size_t d = 0; d < _imageDescriberTypes.size(); ++d)
+  {
+    const std::string descFilename = std::to_string(viewId) + "." + feature::EImageDescriberType_enumToString(_imageDescriberTypes.at(d)) + ".desc";
+
+    // same lookup as loadRegions: the last folder containing the file, then the regions pack
+    std::size_t descSize = 0;
+    bool found = false;
+    for(const std::string& folder : _featuresFolders)
+    {
+      const fs::path descPath = fs::path(folder) / descFilename;
+      boost::system::error_code ec;
+      const auto size = fs::file_size(descPath, ec);
+      if(!ec)
+      {
+        descSize = static_cast<std::size_t>(size);
+        found = true;
+      }
+    }
+    if(!found && _regionsPacks.at(d))
+      descSize = _regionsPacks.at(d)->getDescriptorsSize(viewId);
+
+    memory += descSize;
+  }
+  return memory;
+}
+
+std::size_t LazyRegionsPerView::viewDescriptorsMemory(IndexT viewId) const
+{
+  std::size_t memory = 0;
+  for(const auto& regionsPerDesc : _regionsPerView.getRegionsPerDesc(viewId))
+    memory += regionsPerDesc.second->DescriptorsMemorySize();
+  return memory;
+}
+
+bool LazyRegionsPerView::loadNextBatch(PairSet& batch)
+{
+  batch.clear();
+
+  if(_nextPair >= _pairs.size())
+    return false;
+
+  const std::size_t averageViewMemory = (_nbLoadedViews > 0) ? (_totalLoadedMemory / _nbLoadedViews) : 0;
+  const auto predictViewMemory = [&](IndexT viewId) {
+    const auto it = _estimatedViewMemory.find(viewId);
+    return (it != _estimatedViewMemory.end() && it->second > 0) ? it->second : averageViewMemory;
+  };
+
+  // select the pairs of the batch
+  std::set<IndexT> viewsToLoad;
+  std::size_t viewsToLoadMemory = 0;
+  for(; _nextPair < _pairs.size(); ++_nextPair)
+  {
+    const Pair& pair = _pairs.at(_nextPair);
+
+    std::size_t newViewsMemory = 0;
+    for(const IndexT viewId : {pair.first, pair.second})
+    {
+      if(!_loadedViews.count(viewId) && !viewsToLoad.count(viewId))
+        newViewsMemory += predictViewMemory(viewId);
+    }
+
+    const std::size_t predictedMemory = _descriptorsMemory + viewsToLoadMemory + newViewsMemory;
+    if(!batch.empty() && predictedMemory > _memoryBudget)
+      break;
+
+    for(const IndexT viewId : {pair.first, pair.second})
+    {
+      if(!_loadedViews.count(viewId))
+        viewsToLoad.insert(viewId);
+    }
+    viewsToLoadMemory += newViewsMemory;
+    batch.insert(pair);
+  }
+
+  // load the regions of the new views
+  const std::vector<IndexT> viewIds(viewsToLoad.begin(), viewsToLoad.end());
+  std::vector<std::vector<std::unique_ptr<feature::Regions>>> regionsPerViewPerDesc(viewIds.size());
+  std::atomic_bool invalid(false);
+
+#pragma omp parallel for schedule(dynamic)
+  for(int i = 0; i < viewIds.size(); ++i)
+  {
+    regionsPerViewPerDesc.at(i).resize(_imageDescriberTypes.size());
+    for(std::size_t d = 0; d < _imageDescriberTypes.size(); ++d)
+    {
+      try
+      {
+        regionsPerViewPerDesc.at(i).at(d) = loadRegions(_featuresFolders, viewIds.at(i), *_imageDescribers.at(d), _regionsPacks.at(d).get());
+      }
+      catch(const std::exception& e)
+      {
+        invalid = true;
+      }
+    }
+  }
+
+  if(invalid)
+    throw std::runtime_error("Cannot load the regions of the next batch of pairs");
+
+  for(std::size_t i = 0; i < viewIds.size(); ++i)
+  {
+    const IndexT viewId = viewIds.at(i);
+    for(std::size_t d = 0; d < _imageDescriberTypes.size(); ++d)
+      _regionsPerView.addRegions(viewId, _imageDescriberTypes.at(d), regionsPerViewPerDesc.at(i).at(d).release());
+
+    const std::size_t memory = viewDescriptorsMemory(viewId);
+    _loadedViews[viewId] = memory;
+    _descriptorsMemory += memory;
+    _totalLoadedMemory += memory;
+    ++_nbLoadedViews;
+  }
+
+  _peakDescriptorsMemory = std::max(_peakDescriptorsMemory, _descriptorsMemory);
+
+  ALICEVISION_LOG_DEBUG("Regions batch: " << batch.size() << " pairs, " << viewIds.size() << " views loaded, "
+                        << _loadedViews.size() << " views in memory (" << (_descriptorsMemory / (1024 * 1024)) << " MB).");
+  return true;
+}
+
+void LazyRegionsPerView::releaseBatch(const PairSet& batch)
+{
+  for(const Pair& pair : batch)
+  {
+    for(const IndexT viewId : {pair.first, pair.second})
+    {
+      std::size_t& remainingPairs = _remainingPairsPerView.at(viewId);
+      --remainingPairs;
+
+      if(remainingPairs > 0)
+        continue;
+
+      const auto loadedIt = _loadedViews.find(viewId);
+      if(loadedIt == _loadedViews.end())
+        continue;
+
+      // keep the features (needed for the geometric filtering), release the descriptors
+      for(auto& regionsPerDesc : _regionsPerView.getData().at(viewId))
+        regionsPerDesc.second->clearDescriptors();
+
+      _descriptorsMemory -= loadedIt->second;
+      _loadedViews.erase(loadedIt);
+    }
+  }
+}
+
+} // namespace sfm
+} // namespace aliceVision
@@ -0,0 +1,103 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/feature/ImageDescriber.hpp>
+#include <aliceVision/feature/RegionsPack.hpp>
+#include <aliceVision/feature/RegionsPerView.hpp>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace sfm {
+
+/**
+ * @brief Provide the regions of the views on demand while processing an ordered list of pairs.
+ *
+ * The descriptors of a view are loaded when the first pair using this view is scheduled
+ * and released once all the pairs using this view have been processed.
+ * The features (positions) are kept in memory as they are needed by the geometric filtering.
+ * Batches of pairs are built so that the loaded descriptors stay within the memory budget
+ * (a batch always contains at least one pair).
+ */
+class LazyRegionsPerView
+{
+public:
+  /**
+   * @param[in] sfmData The provided SfMData container
+   * @param[in] folders The feature Folders
+   * @param[in] imageDescriberTypes The imageDescriber types
+   * @param[in] memoryBudget The maximum memory (in bytes) used by the loaded descriptors
+   */
+  LazyRegionsPerView(const sfmData::SfMData& sfmData,
+                     const std::vector<std::string>& folders,
+                     const std::vector<feature::EImageDescriberType>& imageDescriberTypes,
+                     std::size_t memoryBudget);
+
+  /**
+   * @brief Set the ordered list of pairs to process.
+   * @param[in] orderedPairs The pairs, ideally ordered to maximize the reuse of the views
+   */
+  void setPairs(const std::vector<Pair>& orderedPairs);
+
+  /**
+   * @brief Load the regions needed by the next batch of pairs.
+   * @param[out] batch The pairs of the batch
+   * @return false if there is no more pair to process
+   * @throw std::runtime_error if the regions cannot be loaded
+   */
+  bool loadNextBatch(PairSet& batch);
+
+  /**
+   * @brief Notify that the pairs of a batch have been processed.
+   *        The descriptors of the views that are not needed by the next pairs are released.
+   * @param[in] batch The processed pairs
+   */
+  void releaseBatch(const PairSet& batch);
+
+  const feature::RegionsPerView& getRegionsPerView() const { return _regionsPerView; }
+  feature::RegionsPerView& getRegionsPerView() { return _regionsPerView; }
+
+  /// Return the peak memory size (in bytes) used by the loaded descriptors
+  std::size_t getPeakDescriptorsMemory() const { return _peakDescriptorsMemory; }
+
+private:
+  std::size_t viewDescriptorsMemory(IndexT viewId) const;
+
+  /// Estimate the descriptors memory of a view from the size of its descriptors file (0 if not found)
+  std::size_t estimateViewDescriptorsMemory(IndexT viewId) const;
+
+  const sfmData::SfMData& _sfmData;
+  std::vector<std::string> _featuresFolders;
+  std::vector<feature::EImageDescriberType> _imageDescriberTypes;
+  std::vector<std::unique_ptr<feature::ImageDescriber>> _imageDescribers;
+  std::vector<std::unique_ptr<feature::RegionsPackReader>> _regionsPacks;
+  std::size_t _memoryBudget;
+
+  feature::RegionsPerView _regionsPerView;
+  std::vector<Pair> _pairs;
+  std::size_t _nextPair = 0;
+  /// number of pairs not yet processed per view
+  std::map<IndexT, std::size_t> _remainingPairsPerView;
+  /// views with loaded descriptors and their memory size
+  std::map<IndexT, std::size_t> _loadedViews;
+  std::size_t _descriptorsMemory = 0;
+  std::size_t _peakDescriptorsMemory = 0;
+  /// descriptors memory of the views estimated from their files, before loading them
+  std::map<IndexT, std::size_t> _estimatedViewMemory;
+  /// statistics used to predict the memory size of the views without estimation
+  std::size_t _nbLoadedViews = 0;
+  std::size_t _totalLoadedMemory = 0;
+};
+
+} // namespace sfm
+} // namespace aliceVision
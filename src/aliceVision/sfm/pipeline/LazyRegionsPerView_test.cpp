@@ -0,0 +1,92 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfm/pipeline/LazyRegionsPerView.hpp>
+#include <aliceVision/feature/regionsFactory.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <random>
+
+#define BOOST_TEST_MODULE LazyRegionsPerView
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+/// write the SIFT regions files of nbViews views with nbRegions random regions each
+void writeRegions(const std::string& folder, IndexT nbViews, std::size_t nbRegions)
+{
+  std::mt19937 generator(5);
+  std::uniform_int_distribution<int> value(0, 255);
+
+  for(IndexT viewId = 0; viewId < nbViews; ++viewId)
+  {
+    feature::SIFT_Regions regions;
+    for(std::size_t i = 0; i < nbRegions; ++i)
+    {
+      regions.Features().emplace_back(float(i), float(viewId), 1.0f, 0.0f);
+      feature::SIFT_Regions::DescriptorT descriptor;
+      for(std::size_t d = 0; d < descriptor.size(); ++d)
+        descriptor[d] = static_cast<unsigned char>(value(generator));
+      regions.Descriptors().push_back(descriptor);
+    }
+
+    const std::string basename = (fs::path(folder) / std::to_string(viewId)).string() + ".sift";
+    regions.Save(basename + ".feat", basename + ".desc");
+  }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(LazyRegionsPerView_budgetExceededOnFirstBatch)
+{
+  const IndexT nbViews = 4;
+  const std::size_t nbRegions = 1000;
+  const std::size_t viewMemory = nbRegions * sizeof(feature::SIFT_Regions::DescriptorT);
+
+  const fs::path folder = fs::temp_directory_path() / fs::unique_path();
+  fs::create_directories(folder);
+  writeRegions(folder.string(), nbViews, nbRegions);
+
+  sfmData::SfMData sfmData;
+  sfmData.addFeaturesFolder(folder.string());
+
+  // the budget fits 2 views but not 3: loading all the views of the pairs at once exceeds it
+  const std::size_t memoryBudget = 2 * viewMemory + viewMemory / 2;
+  sfm::LazyRegionsPerView lazyRegions(sfmData, {}, {feature::EImageDescriberType::SIFT}, memoryBudget);
+  lazyRegions.setPairs({{0, 1}, {1, 2}, {2, 3}});
+
+  std::size_t nbBatches = 0;
+  std::size_t nbPairs = 0;
+  PairSet batch;
+  while(lazyRegions.loadNextBatch(batch))
+  {
+    // the first batch is limited before any view has been loaded
+    if(nbBatches == 0)
+      BOOST_CHECK_EQUAL(batch.size(), 1);
+
+    for(const Pair& pair : batch)
+    {
+      BOOST_CHECK_EQUAL(lazyRegions.getRegionsPerView().getRegions(pair.first, feature::EImageDescriberType::SIFT).RegionCount(), nbRegions);
+      BOOST_CHECK_EQUAL(lazyRegions.getRegionsPerView().getRegions(pair.second, feature::EImageDescriberType::SIFT).RegionCount(), nbRegions);
+    }
+
+    nbPairs += batch.size();
+    ++nbBatches;
+    lazyRegions.releaseBatch(batch);
+  }
+
+  fs::remove_all(folder);
+
+  BOOST_CHECK_EQUAL(nbPairs, 3);
+  BOOST_CHECK_EQUAL(nbBatches, 3);
+  BOOST_CHECK_LE(lazyRegions.getPeakDescriptorsMemory(), memoryBudget);
+}
@@ -0,0 +1,243 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "PipelineRunner.hpp"
+
+#include <aliceVision/feature/FeatureExtractor.hpp>
+#include <aliceVision/feature/FeaturesPerView.hpp>
+#include <aliceVision/matching/io.hpp>
+#include <aliceVision/matching/matchesFiltering.hpp>
+#include <aliceVision/matchingImageCollection/matchingCommon.hpp>
+#include <aliceVision/matchingImageCollection/IImageCollectionMatcher.hpp>
+#include <aliceVision/matchingImageCollection/GeometricFilter.hpp>
+#include <aliceVision/matchingImageCollection/GeometricFilterMatrix_F_AC.hpp>
+#include <aliceVision/matchingImageCollection/GeometricFilterMatrix_E_AC.hpp>
+#include <aliceVision/matchingImageCollection/GeometricFilterMatrix_H_AC.hpp>
+#include <aliceVision/matchingImageCollection/GeometricFilterMatrix_HGrowing.hpp>
+#include <aliceVision/matchingImageCollection/GeometricFilterKVLD.hpp>
+#include <aliceVision/matchingImageCollection/pairBuilder.hpp>
+#include <aliceVision/sfmDataIO/sfmDataIO.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <mutex>
+
+namespace aliceVision {
+namespace sfm {
+
+namespace fs = boost::filesystem;
+
+PipelineRunner::PipelineRunner(const sfmData::SfMData& sfmData, const std::string& outputFolder, const Params& params)
+  : _sfmData(sfmData)
+  , _outputFolder(outputFolder)
+  , _params(params)
+  , _randomNumberGenerator(params.randomSeed == -1 ? std::random_device()() : params.randomSeed)
+{}
+
+std::vector<feature::EImageDescriberType> PipelineRunner::getDescriberTypes() const
+{
+  std::vector<feature::EImageDescriberType> describerTypes;
+  for(const auto& imageDescriber : _imageDescribers)
+    describerTypes.push_back(imageDescriber->getDescriberType());
+  return describerTypes;
+}
+
+bool PipelineRunner::extractFeatures(const HardwareContext& hContext)
+{
+  if(_imageDescribers.empty())
+  {
+    ALICEVISION_LOG_ERROR("No image describer to extract the features.");
+    return false;
+  }
+
+  system::Timer timer;
+
+  feature::FeatureExtractor extractor(_sfmData);
+  for(auto imageDescriber : _imageDescribers)
+    extractor.addImageDescriber(imageDescriber);
+
+  if(!_params.featuresFolder.empty())
+  {
+    fs::create_directories(_params.featuresFolder);
+    extractor.setOutputFolder(_params.featuresFolder);
+    _sfmData.addFeaturesFolder(_params.featuresFolder);
+  }
+
+  _regionsPerView.getData().clear();
+  extractor.setRegionsPerView(&_regionsPerView);
+  extractor.process(hContext);
+
+  ALICEVISION_LOG_INFO("Features of " << _regionsPerView.getData().size() << " views extracted in (s): " << timer.elapsed());
+  return !_regionsPerView.isEmpty();
+}
+
+bool PipelineRunner::matchFeatures(const PairSet& pairs)
+{
+  using namespace matchingImageCollection;
+
+  system::Timer timer;
+
+  const PairSet pairsToMatch = pairs.empty() ? exhaustivePairs(_sfmData.getViews()) : pairs;
+  ALICEVISION_LOG_INFO("Match the features of " << pairsToMatch.size() << " image pairs.");
+
+  // putative matches
+  matching::PairwiseMatches putativeMatches;
+  std::unique_ptr<IImageCollectionMatcher> imageCollectionMatcher = createImageCollectionMatcher(_params.matcherType, _params.distRatio, _params.crossMatching);
+  for(const feature::EImageDescriberType descType : getDescriberTypes())
+    imageCollectionMatcher->Match(_randomNumberGenerator, _regionsPerView, pairsToMatch, descType, putativeMatches);
+
+  matching::filterMatchesByMin2DMotion(putativeMatches, _regionsPerView, _params.minRequired2DMotion);
+
+  if(putativeMatches.empty())
+  {
+    ALICEVISION_LOG_ERROR("No putative feature matches.");
+    return false;
+  }
+
+  if(_params.geometricFilterType == EGeometricFilterType::HOMOGRAPHY_GROWING)
+  {
+    // the seeds of the homographies growing are the first putative matches
+    for(auto& putativeMatchesPerDesc : putativeMatches)
+      for(auto& descMatches : putativeMatchesPerDesc.second)
+        matching::sortMatches_byDistanceRatio(descMatches.second);
+  }
+
+  ALICEVISION_LOG_INFO(putativeMatches.size() << " putative image pair matches.");
+
+  // geometric filtering, the filtered matches of each pair are grid filtered as soon as they are found
+  _pairwiseMatches.clear();
+  std::mutex pairwiseMatchesMutex;
+
+  const bool removePoorlyOverlappingPairs = (_params.geometricFilterType == EGeometricFilterType::ESSENTIAL_MATRIX);
+
+  const auto onPairFiltered = [&](const Pair& imagePair, matching::MatchesPerDescType& geometricMatches)
+  {
+    if(geometricMatches.empty() ||
+       (removePoorlyOverlappingPairs && isPoorlyOverlappingImagePair(geometricMatches, putativeMatches.at(imagePair), 0.3f, 50)))
+      return;
+
+    matching::PairwiseMatches pairGeometricMatches;
+    pairGeometricMatches.emplace(imagePair, std::move(geometricMatches));
+    matching::PairwiseMatches pairMatches;
+    matching::matchesGridFilteringForAllPairs(pairGeometricMatches, _sfmData, _regionsPerView, _params.useGridSort,
+                                              _params.numMatchesToKeep, pairMatches);
+    if(pairMatches.empty())
+      return;
+
+    std::lock_guard<std::mutex> lock(pairwiseMatchesMutex);
+    _pairwiseMatches.emplace(imagePair, std::move(pairMatches.begin()->second));
+  };
+
+  switch(_params.geometricFilterType)
+  {
+    case EGeometricFilterType::NO_FILTERING:
+      for(const auto& pairPutativeMatches : putativeMatches)
+      {
+        matching::MatchesPerDescType geometricMatches = pairPutativeMatches.second;
+        onPairFiltered(pairPutativeMatches.first, geometricMatches);
+      }
+      break;
+    case EGeometricFilterType::FUNDAMENTAL_MATRIX:
+      robustModelEstimation(onPairFiltered, &_sfmData, _regionsPerView,
+        GeometricFilterMatrix_F_AC(_params.geometricErrorMax, _params.maxIteration, _params.geometricEstimator, false),
+        putativeMatches, _randomNumberGenerator, _params.guidedMatching);
+      break;
+    case EGeometricFilterType::FUNDAMENTAL_WITH_DISTORTION:
+      robustModelEstimation(onPairFiltered, &_sfmData, _regionsPerView,
+        GeometricFilterMatrix_F_AC(_params.geometricErrorMax, _params.maxIteration, _params.geometricEstimator, true),
+        putativeMatches, _randomNumberGenerator, _params.guidedMatching);
+      break;
+    case EGeometricFilterType::ESSENTIAL_MATRIX:
+      robustModelEstimation(onPairFiltered, &_sfmData, _regionsPerView,
+        GeometricFilterMatrix_E_AC(_params.geometricErrorMax, _params.maxIteration),
+        putativeMatches, _randomNumberGenerator, _params.guidedMatching);
+      break;
+    case EGeometricFilterType::HOMOGRAPHY_MATRIX:
+      robustModelEstimation(onPairFiltered, &_sfmData, _regionsPerView,
+        GeometricFilterMatrix_H_AC(_params.geometricErrorMax, _params.maxIteration),
+        putativeMatches, _randomNumberGenerator, _params.guidedMatching, -1.0);
+      break;
+    case EGeometricFilterType::HOMOGRAPHY_GROWING:
+      robustModelEstimation(onPairFiltered, &_sfmData, _regionsPerView,
+        GeometricFilterMatrix_HGrowing(_params.geometricErrorMax, _params.maxIteration),
+        putativeMatches, _randomNumberGenerator, _params.guidedMatching);
+      break;
+    case EGeometricFilterType::KVLD:
+      kvldFiltering(onPairFiltered, _sfmData, _regionsPerView, putativeMatches);
+      break;
+  }
+
+  ALICEVISION_LOG_INFO(_pairwiseMatches.size() << " geometric image pair matches found in (s): " << timer.elapsed());
+
+  if(!_params.matchesFolder.empty())
+  {
+    fs::create_directories(_params.matchesFolder);
+    if(!matching::Save(_pairwiseMatches, _params.matchesFolder, _params.matchesFileExtension, false))
+      ALICEVISION_LOG_WARNING("Cannot write the matches checkpoint in '" << _params.matchesFolder << "'.");
+    _sfmData.addMatchesFolder(_params.matchesFolder);
+  }
+
+  return !_pairwiseMatches.empty();
+}
+
+bool PipelineRunner::reconstruct()
+{
+  system::Timer timer;
+
+  // the SfM only needs the positions of the features
+  feature::FeaturesPerView featuresPerView;
+  for(auto& regionsPerDesc : _regionsPerView.getData())
+  {
+    for(auto& regions : regionsPerDesc.second)
+    {
+      featuresPerView.addFeatures(regionsPerDesc.first, regions.first, regions.second->GetRegionsPositions());
+      regions.second->clearDescriptors();
+    }
+  }
+
+  if(!fs::exists(_outputFolder))
+    fs::create_directories(_outputFolder);
+
+  ReconstructionEngine_sequentialSfM sfmEngine(_sfmData, _params.sfmParams, _outputFolder,
+                                               (fs::path(_outputFolder) / "sfm_log.html").string());
+  sfmEngine.initRandomSeed(_params.randomSeed);
+
+  // the engine builds the tracks from the in-memory matches
+  sfmEngine.setFeatures(&featuresPerView);
+  sfmEngine.setMatches(&_pairwiseMatches);
+
+  if(!sfmEngine.process())
+    return false;
+
+  if(_params.computeStructureColor)
+    sfmEngine.colorize();
+  sfmEngine.retrieveMarkersId();
+
+  _sfmData = sfmEngine.getSfMData();
+
+  ALICEVISION_LOG_INFO("Structure from motion took (s): " << timer.elapsed() << std::endl
+    << "\t- # cameras calibrated: " << _sfmData.getValidViews().size() << std::endl
+    << "\t- # landmarks: " << _sfmData.getLandmarks().size());
+
+  if(!_params.outputSfMData.empty())
+  {
+    _sfmData.setAbsolutePath(_params.outputSfMData);
+    if(!sfmDataIO::Save(_sfmData, _params.outputSfMData, sfmDataIO::ESfMData::ALL))
+      ALICEVISION_LOG_WARNING("Cannot write the SfMData checkpoint '" << _params.outputSfMData << "'.");
+  }
+
+  return true;
+}
+
+bool PipelineRunner::process(const HardwareContext& hContext)
+{
+  return extractFeatures(hContext) && matchFeatures() && reconstruct();
+}
+
+} // namespace sfm
+} // namespace aliceVision
@@ -0,0 +1,136 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/feature/ImageDescriber.hpp>
+#include <aliceVision/feature/RegionsPerView.hpp>
+#include <aliceVision/matching/IndMatch.hpp>
+#include <aliceVision/matching/matcherType.hpp>
+#include <aliceVision/matchingImageCollection/GeometricFilterType.hpp>
+#include <aliceVision/robustEstimation/estimators.hpp>
+#include <aliceVision/sfm/pipeline/sequential/ReconstructionEngine_sequentialSfM.hpp>
+#include <aliceVision/system/hardwareContext.hpp>
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace sfm {
+
+/**
+ * @brief Chain the feature extraction, the feature matching and the incremental SfM in the same process.
+ *
+ * The regions, the matches and the SfMData are passed in memory from one stage to the next, instead of being
+ * written by a pipeline binary and parsed by the next one. The files of the separate binaries are only written
+ * as checkpoints, when their folder is set, so they can be inspected or reused by the separate binaries.
+ */
+class PipelineRunner
+{
+public:
+  struct Params
+  {
+    // Feature matching
+
+    matching::EMatcherType matcherType = matching::EMatcherType::ANN_L2;
+    float distRatio = 0.8f;
+    bool crossMatching = false;
+    matchingImageCollection::EGeometricFilterType geometricFilterType = matchingImageCollection::EGeometricFilterType::FUNDAMENTAL_MATRIX;
+    robustEstimation::ERobustEstimator geometricEstimator = robustEstimation::ERobustEstimator::ACRANSAC;
+    /// maximum error (in pixels) of the geometric filtering, 0 for the a contrario estimation
+    double geometricErrorMax = 0.0;
+    int maxIteration = 2048;
+    bool guidedMatching = false;
+    bool useGridSort = true;
+    /// maximum number of matches per pair, 0 to keep all of them
+    std::size_t numMatchesToKeep = 0;
+    /// minimum 2D motion of a match, -1 to disable this filter
+    double minRequired2DMotion = -1.0;
+
+    // Incremental SfM
+
+    ReconstructionEngine_sequentialSfM::Params sfmParams;
+    bool computeStructureColor = true;
+    int randomSeed = std::mt19937::default_seed;
+
+    // Checkpoints, nothing is written if empty
+
+    /// folder of the features and descriptors files, the up-to-date files are loaded instead of extracted
+    std::string featuresFolder;
+    /// folder of the matches files
+    std::string matchesFolder;
+    std::string matchesFileExtension = "txt";
+    /// path of the reconstructed SfMData file
+    std::string outputSfMData;
+  };
+
+  /**
+   * @param[in] sfmData the views and intrinsics to reconstruct
+   * @param[in] outputFolder the folder of the logs and reports of the reconstruction
+   * @param[in] params the parameters of the stages
+   */
+  PipelineRunner(const sfmData::SfMData& sfmData, const std::string& outputFolder, const Params& params);
+
+  void addImageDescriber(const std::shared_ptr<feature::ImageDescriber>& imageDescriber)
+  {
+    _imageDescribers.push_back(imageDescriber);
+  }
+
+  /**
+   * @brief Extract the regions of all the views
+   * @param[in] hContext the hardware limits of the extraction
+   */
+  bool extractFeatures(const HardwareContext& hContext);
+
+  /**
+   * @brief Match the regions of the image pairs and filter the matches geometrically
+   * @param[in] pairs the image pairs to match, all the pairs if empty
+   */
+  bool matchFeatures(const PairSet& pairs = PairSet());
+
+  /**
+   * @brief Reconstruct the scene from the matches, the regions descriptors are released first
+   */
+  bool reconstruct();
+
+  /**
+   * @brief Run all the stages
+   */
+  bool process(const HardwareContext& hContext);
+
+  const feature::RegionsPerView& getRegionsPerView() const
+  {
+    return _regionsPerView;
+  }
+
+  const matching::PairwiseMatches& getPairwiseMatches() const
+  {
+    return _pairwiseMatches;
+  }
+
+  const sfmData::SfMData& getSfMData() const
+  {
+    return _sfmData;
+  }
+
+private:
+  std::vector<feature::EImageDescriberType> getDescriberTypes() const;
+
+  sfmData::SfMData _sfmData;
+  const std::string _outputFolder;
+  const Params _params;
+  std::mt19937 _randomNumberGenerator;
+  std::vector<std::shared_ptr<feature::ImageDescriber>> _imageDescribers;
+  feature::RegionsPerView _regionsPerView;
+  matching::PairwiseMatches _pairwiseMatches;
+};
+
+} // namespace sfm
+} // namespace aliceVision
@@ -0,0 +1,139 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfm/pipeline/PipelineRunner.hpp>
+#include <aliceVision/sfm/utils/statistics.hpp>
+#include <aliceVision/sfm/utils/syntheticScene.hpp>
+#include <aliceVision/feature/regionsFactory.hpp>
+#include <aliceVision/image/io.hpp>
+#include <aliceVision/multiview/NViewDataSet.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <cmath>
+#include <memory>
+#include <string>
+
+#define BOOST_TEST_MODULE PipelineRunner
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+/**
+ * @brief Detect the pixels of the image which are not black, the value of a pixel is the index of its point + 1.
+ * The descriptor of a point is non-zero only at its index, so the matching is only done between the same points.
+ */
+class ImageDescriber_Synthetic : public feature::ImageDescriber
+{
+public:
+  bool useCuda() const override { return false; }
+  bool useFloatImage() const override { return true; }
+  feature::EImageDescriberType getDescriberType() const override { return feature::EImageDescriberType::SIFT; }
+  std::size_t getMemoryConsumption(std::size_t width, std::size_t height) const override { return width * height * sizeof(float); }
+  void setConfigurationPreset(feature::ConfigurationPreset preset) override {}
+
+  bool describe(const image::Image<float>& image,
+                std::unique_ptr<feature::Regions>& regions,
+                const image::Image<unsigned char>* mask = nullptr) override
+  {
+    allocate(regions);
+    feature::SIFT_Regions* siftRegions = dynamic_cast<feature::SIFT_Regions*>(regions.get());
+
+    for(int y = 0; y < image.Height(); ++y)
+    {
+      for(int x = 0; x < image.Width(); ++x)
+      {
+        const int value = static_cast<int>(std::round(image(y, x) * 255.f));
+        if(value == 0)
+          continue;
+
+        feature::SIFT_Regions::DescriptorT descriptor(0);
+        descriptor[value - 1] = 255;
+        siftRegions->Features().emplace_back(x, y, 1.f, 0.f);
+        siftRegions->Descriptors().push_back(descriptor);
+      }
+    }
+    return true;
+  }
+
+  void allocate(std::unique_ptr<feature::Regions>& regions) const override
+  {
+    regions.reset(new feature::SIFT_Regions);
+  }
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(PipelineRunner_inMemory)
+{
+  makeRandomOperationsReproducible();
+
+  // one pixel per point, its value is the index of the point + 1
+  const int nbViews = 6;
+  const int nbPoints = 120;
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nbViews, nbPoints, config);
+
+  sfmData::SfMData inputSfmData = sfm::getInputScene(d, config, camera::EINTRINSIC::PINHOLE_CAMERA);
+  inputSfmData.getPoses().clear();
+  inputSfmData.structure.clear();
+
+  const fs::path folder = fs::temp_directory_path() / fs::unique_path();
+  fs::create_directories(folder);
+
+  for(int i = 0; i < nbViews; ++i)
+  {
+    image::Image<unsigned char> image(config._cx * 2, config._cy * 2, true, 0);
+    for(int j = 0; j < nbPoints; ++j)
+    {
+      const int x = static_cast<int>(std::round(d._x[i](0, j)));
+      const int y = static_cast<int>(std::round(d._x[i](1, j)));
+      if(image.Contains(y, x))
+        image(y, x) = static_cast<unsigned char>(j + 1);
+    }
+
+    const std::string imagePath = (folder / (std::to_string(i) + ".png")).string();
+    image::writeImage(imagePath, image, image::ImageWriteOptions().toColorSpace(image::EImageColorSpace::NO_CONVERSION));
+    inputSfmData.getViews().at(i)->setImagePath(imagePath);
+  }
+
+  // no checkpoint folder, the regions and the matches are only passed in memory
+  sfm::PipelineRunner::Params params;
+  params.sfmParams.lockAllIntrinsics = true;
+  params.computeStructureColor = false;
+
+  sfm::PipelineRunner runner(inputSfmData, (folder / "sfm").string(), params);
+  runner.addImageDescriber(std::make_shared<ImageDescriber_Synthetic>());
+
+  BOOST_REQUIRE(runner.extractFeatures(HardwareContext()));
+  BOOST_CHECK_EQUAL(runner.getRegionsPerView().getData().size(), std::size_t(nbViews));
+
+  BOOST_REQUIRE(runner.matchFeatures());
+  BOOST_CHECK_EQUAL(runner.getPairwiseMatches().size(), std::size_t(nbViews * (nbViews - 1) / 2));
+
+  BOOST_REQUIRE(runner.reconstruct());
+
+  const sfmData::SfMData& sfmData = runner.getSfMData();
+  BOOST_CHECK_EQUAL(sfmData.getValidViews().size(), std::size_t(nbViews));
+  BOOST_CHECK_GE(sfmData.getLandmarks().size(), std::size_t(nbPoints * 9 / 10));
+  // the detected positions are rounded to the pixel
+  BOOST_CHECK_LT(sfm::RMSE(sfmData), 1.0);
+
+  // no features or matches file is written
+  for(fs::recursive_directory_iterator it(folder), end; it != end; ++it)
+  {
+    const std::string extension = it->path().extension().string();
+    BOOST_CHECK_MESSAGE(extension != ".feat" && extension != ".desc" &&
+                        it->path().filename().string().find("matches") == std::string::npos, it->path().string());
+  }
+
+  fs::remove_all(folder);
+}
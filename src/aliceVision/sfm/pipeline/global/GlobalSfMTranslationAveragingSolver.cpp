@@ -11,7 +11,6 @@
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
 #include <aliceVision/sfm/BundleAdjustmentCeres.hpp>
 #include <aliceVision/sfm/pipeline/global/reindexGlobalSfM.hpp>
-#include <aliceVision/sfm/pipeline/global/MutexSet.hpp>
 #include <aliceVision/matching/IndMatch.hpp>
 #include <aliceVision/multiview/translationAveraging/common.hpp>
 #include <aliceVision/multiview/translationAveraging/solver.hpp>
@@ -31,6 +30,9 @@
 
 #include <aliceVision/utils/Histogram.hpp>
 
+#include <algorithm>
+#include <atomic>
+
 namespace aliceVision {
 namespace sfm {
 
@@ -344,44 +346,49 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
     graph::tripletListing(rotation_pose_id_graph);
   ALICEVISION_LOG_DEBUG("#Triplets: " << vec_triplets.size());
 
+  // List the pairwise matches per pair of poses, to list the matches of a triplet without a pass over all the matches
+  std::map<Pair, std::vector<matching::PairwiseMatches::const_iterator>> matchesPerPosePair;
+  for (auto match_iterator = pairwiseMatches.begin(); match_iterator != pairwiseMatches.end(); ++match_iterator)
+  {
+    const IndexT poseI = sfmData.getViews().at(match_iterator->first.first)->getPoseId();
+    const IndexT poseJ = sfmData.getViews().at(match_iterator->first.second)->getPoseId();
+    if (poseI != poseJ)
+      matchesPerPosePair[std::minmax(poseI, poseJ)].push_back(match_iterator);
+  }
+
+  // List the matches that belong to the triplet of poses
+  const auto listTripletMatches = [&matchesPerPosePair](const graph::Triplet& triplet, matching::PairwiseMatches& tripletMatches)
+  {
+    const Pair posePairs[3] = {std::minmax(triplet.i, triplet.j), std::minmax(triplet.i, triplet.k), std::minmax(triplet.j, triplet.k)};
+    for (const Pair& posePair : posePairs)
+    {
+      const auto it = matchesPerPosePair.find(posePair);
+      if (it == matchesPerPosePair.end())
+        continue;
+      for (const auto& match_iterator : it->second)
+        tripletMatches.insert(*match_iterator);
+    }
+  };
+
   {
     // Compute triplets of translations
     // Avoid to cover each edge of the graph by using an edge coverage algorithm
     // An estimated triplets of translation mark three edges as estimated.
 
     //-- precompute the number of track per triplet:
-    HashMap<IndexT, IndexT> map_tracksPerTriplets;
+    std::vector<std::size_t> tracksPerTriplet(vec_triplets.size(), 0);
 
     #pragma omp parallel for schedule(dynamic)
     for (int i = 0; i < (int)vec_triplets.size(); ++i)
     {
-      // List matches that belong to the triplet of poses
-      const graph::Triplet & triplet = vec_triplets[i];
       matching::PairwiseMatches map_triplet_matches;
-      const std::set<IndexT> set_triplet_pose_ids = {triplet.i, triplet.j, triplet.k};
-      // List shared correspondences (pairs) between the triplet poses
-      for (const auto & match_iterator : pairwiseMatches)
-      {
-        const Pair pair = match_iterator.first;
-        const View * v1 = sfmData.getViews().at(pair.first).get();
-        const View * v2 = sfmData.getViews().at(pair.second).get();
-        if (// Consider the pair iff it is supported by the triplet graph & 2 different pose id
-            (v1->getPoseId() != v2->getPoseId())
-            && set_triplet_pose_ids.count(v1->getPoseId())
-            && set_triplet_pose_ids.count(v2->getPoseId()))
-        {
-          map_triplet_matches.insert( match_iterator );
-        }
-      }
-      // Compute tracks:
-      {
-        aliceVision::track::TracksBuilder tracksBuilder;
-        tracksBuilder.build(map_triplet_matches);
-        tracksBuilder.filter(true,3);
+      listTripletMatches(vec_triplets[i], map_triplet_matches);
 
-        #pragma omp critical
-        map_tracksPerTriplets[i] = tracksBuilder.nbTracks(); //count the # of matches in the UF tree
-      }
+      // Compute tracks:
+      aliceVision::track::TracksBuilder tracksBuilder;
+      tracksBuilder.build(map_triplet_matches);
+      tracksBuilder.filter(true,3);
+      tracksPerTriplet[i] = tracksBuilder.nbTracks(); //count the # of matches in the UF tree
     }
 
     typedef Pair myEdge;
@@ -400,23 +407,36 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
     std::vector<myEdge > vec_edges;
     std::transform(map_tripletIds_perEdge.begin(), map_tripletIds_perEdge.end(), std::back_inserter(vec_edges), stl::RetrieveKey());
 
-    aliceVision::sfm::MutexSet<myEdge> m_mutexSet;
+    // the edges are sorted, the estimated ones are flagged without lock
+    const auto edgeIndex = [&vec_edges](const myEdge& edge)
+    {
+      return std::lower_bound(vec_edges.begin(), vec_edges.end(), edge) - vec_edges.begin();
+    };
+    std::vector<std::atomic<bool>> isEdgeEstimated(vec_edges.size());
+    for (std::atomic<bool>& isEstimated : isEdgeEstimated)
+      isEstimated = false;
+    std::atomic<std::size_t> nbEstimatedEdges(0);
+
+    // each triplet estimation draws its samples from its own generator, seeded from the triplet index
+    const std::mt19937::result_type tripletSeed = randomNumberGenerator();
 
     auto progressDisplay = system::createConsoleProgressDisplay(
                 vec_edges.size(), std::cout,
                 "\nRelative translations computation (edge coverage algorithm)\n");
 
-    // set number of threads, 1 if openMP is not enabled  
+    // the results of each thread, merged after the estimation
+    // set number of threads, 1 if openMP is not enabled
     std::vector<translationAveraging::RelativeInfoVec> initial_estimates(omp_get_max_threads());
-    const bool bVerbose = false;
+    std::vector<matching::PairwiseMatches> newpairMatchesPerThread(omp_get_max_threads());
 
     #pragma omp parallel for schedule(dynamic)
     for (int k = 0; k < vec_edges.size(); ++k)
     {
-      const myEdge & edge = vec_edges[k];
       ++progressDisplay;
-      if (m_mutexSet.count(edge) == 0 && m_mutexSet.size() != vec_edges.size())
+      if (!isEdgeEstimated[k] && nbEstimatedEdges != vec_edges.size())
       {
+        const myEdge & edge = vec_edges[k];
+
         // Find the triplets that support the given edge
         const auto & vec_possibleTripletIndexes = map_tripletIds_perEdge.at(edge);
 
@@ -424,7 +444,7 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
         std::vector<size_t> vec_commonTracksPerTriplets;
         for (const size_t triplet_index : vec_possibleTripletIndexes)
         {
-          vec_commonTracksPerTriplets.push_back(map_tracksPerTriplets[triplet_index]);
+          vec_commonTracksPerTriplets.push_back(tracksPerTriplet[triplet_index]);
         }
 
         using namespace stl::indexed_sort;
@@ -440,11 +460,14 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
         for (const size_t triplet_index : vec_triplet_ordered)
         {
           const graph::Triplet & triplet = vec_triplets[triplet_index];
+          const std::size_t tripletEdges[3] = {static_cast<std::size_t>(edgeIndex(Pair(triplet.i, triplet.j))),
+                                               static_cast<std::size_t>(edgeIndex(Pair(triplet.j, triplet.k))),
+                                               static_cast<std::size_t>(edgeIndex(Pair(triplet.i, triplet.k)))};
 
           // If the triplet is already estimated by another thread; try the next one
-          if (m_mutexSet.count(Pair(triplet.i, triplet.j)) &&
-              m_mutexSet.count(Pair(triplet.i, triplet.k)) &&
-              m_mutexSet.count(Pair(triplet.j, triplet.k)))
+          if (isEdgeEstimated[tripletEdges[0]] &&
+              isEdgeEstimated[tripletEdges[1]] &&
+              isEdgeEstimated[tripletEdges[2]])
           {
             break;
           }
@@ -457,15 +480,18 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
           std::vector<Vec3> vec_tis(3);
           std::vector<size_t> vec_inliers;
           aliceVision::track::TracksMap pose_triplet_tracks;
+          matching::PairwiseMatches map_triplet_matches;
+          listTripletMatches(triplet, map_triplet_matches);
+          std::mt19937 tripletRandomNumberGenerator(tripletSeed + triplet_index);
 
           const std::string sOutDirectory = "./";
           const bool bTriplet_estimation = Estimate_T_triplet(
               sfmData,
               map_globalR,
               normalizedFeaturesPerView,
-              pairwiseMatches,
+              map_triplet_matches,
               triplet,
-              randomNumberGenerator,
+              tripletRandomNumberGenerator,
               vec_tis,
               dPrecision,
               vec_inliers,
@@ -475,9 +501,11 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
           if (bTriplet_estimation)
           {
             // Since new translation edges have been computed, mark their corresponding edges as estimated
-            m_mutexSet.insert(std::make_pair(triplet.i, triplet.j));
-            m_mutexSet.insert(std::make_pair(triplet.j, triplet.k));
-            m_mutexSet.insert(std::make_pair(triplet.i, triplet.k));
+            for (const std::size_t tripletEdge : tripletEdges)
+            {
+              if (!isEdgeEstimated[tripletEdge].exchange(true))
+                ++nbEstimatedEdges;
+            }
 
             // Compute the triplet relative motions (IJ, JK, IK)
             {
@@ -512,40 +540,37 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
               initial_estimates[thread_id].emplace_back(
                 std::make_pair(triplet.i, triplet.k), std::make_pair(Rik, tik));
 
-              //--- ATOMIC
-              #pragma omp critical
+              // Add inliers as valid pairwise matches
+              matching::PairwiseMatches& threadNewpairMatches = newpairMatchesPerThread[thread_id];
+              for (std::vector<size_t>::const_iterator iterInliers = vec_inliers.begin();
+                iterInliers != vec_inliers.end(); ++iterInliers)
               {
-                // Add inliers as valid pairwise matches
-                for (std::vector<size_t>::const_iterator iterInliers = vec_inliers.begin();
-                  iterInliers != vec_inliers.end(); ++iterInliers)
+                using namespace aliceVision::track;
+                TracksMap::iterator it_tracks = pose_triplet_tracks.begin();
+                std::advance(it_tracks, *iterInliers);
+                const Track & track = it_tracks->second;
+
+                // create pairwise matches from inlier track
+                for (size_t index_I = 0; index_I < track.featPerView.size() ; ++index_I)
                 {
-                  using namespace aliceVision::track;
-                  TracksMap::iterator it_tracks = pose_triplet_tracks.begin();
-                  std::advance(it_tracks, *iterInliers);
-                  const Track & track = it_tracks->second;
+                  Track::FeatureIdPerView::const_iterator iter_I = track.featPerView.begin();
+                  std::advance(iter_I, index_I);
+
+                  // extract camera indexes
+                  const size_t id_view_I = iter_I->first;
+                  const size_t id_feat_I = iter_I->second;
 
-                  // create pairwise matches from inlier track
-                  for (size_t index_I = 0; index_I < track.featPerView.size() ; ++index_I)
+                  // loop on subtracks
+                  for (size_t index_J = index_I+1; index_J < track.featPerView.size() ; ++index_J)
                   {
-                    Track::FeatureIdPerView::const_iterator iter_I = track.featPerView.begin();
-                    std::advance(iter_I, index_I);
+                    Track::FeatureIdPerView::const_iterator iter_J = track.featPerView.begin();
+                    std::advance(iter_J, index_J);
 
                     // extract camera indexes
-                    const size_t id_view_I = iter_I->first;
-                    const size_t id_feat_I = iter_I->second;
+                    const size_t id_view_J = iter_J->first;
+                    const size_t id_feat_J = iter_J->second;
 
-                    // loop on subtracks
-                    for (size_t index_J = index_I+1; index_J < track.featPerView.size() ; ++index_J)
-                    {
-                      Track::FeatureIdPerView::const_iterator iter_J = track.featPerView.begin();
-                      std::advance(iter_J, index_J);
-
-                      // extract camera indexes
-                      const size_t id_view_J = iter_J->first;
-                      const size_t id_feat_J = iter_J->second;
-
-                      newpairMatches[std::make_pair(id_view_I, id_view_J)][track.descType].emplace_back(id_feat_I, id_feat_J);
-                    }
+                    threadNewpairMatches[std::make_pair(id_view_I, id_view_J)][track.descType].emplace_back(id_feat_I, id_feat_J);
                   }
                 }
               }
@@ -558,13 +583,24 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
       }
     }
     // Merge thread estimates
-    for(const auto vec : initial_estimates)
+    for(const auto& vec : initial_estimates)
     {
-      for(const auto val : vec)
+      for(const auto& val : vec)
       {
         vec_initialEstimates.emplace_back(val);
       }
     }
+    for(const matching::PairwiseMatches& threadNewpairMatches : newpairMatchesPerThread)
+    {
+      for(const auto& pairMatches : threadNewpairMatches)
+      {
+        for(const auto& descMatches : pairMatches.second)
+        {
+          matching::IndMatches& matches = newpairMatches[pairMatches.first][descMatches.first];
+          matches.insert(matches.end(), descMatches.second.begin(), descMatches.second.end());
+        }
+      }
+    }
   }
 
 
@@ -585,7 +621,7 @@ bool GlobalSfMTranslationAveragingSolver::Estimate_T_triplet(
   const SfMData& sfmData,
   const HashMap<IndexT, Mat3>& map_globalR,
   const feature::FeaturesPerView& normalizedFeaturesPerView,
-  const matching::PairwiseMatches& pairwiseMatches,
+  const matching::PairwiseMatches& map_triplet_matches,
   const graph::Triplet& poses_id,
   std::mt19937 & randomNumberGenerator,
   std::vector<Vec3>& vec_tis,
@@ -594,24 +630,6 @@ bool GlobalSfMTranslationAveragingSolver::Estimate_T_triplet(
   aliceVision::track::TracksMap& tracks,
   const std::string& outDirectory) const
 {
-  // List matches that belong to the triplet of poses
-  matching::PairwiseMatches map_triplet_matches;
-  const std::set<IndexT> set_pose_ids = {poses_id.i, poses_id.j, poses_id.k};
-  // List shared correspondences (pairs) between poses
-  for (const auto & match_iterator : pairwiseMatches)
-  {
-    const Pair& pair = match_iterator.first;
-    const View* v1 = sfmData.getViews().at(pair.first).get();
-    const View* v2 = sfmData.getViews().at(pair.second).get();
-    if (// Consider the pair iff it is supported by the triplet graph & 2 different pose id
-        (v1->getPoseId() != v2->getPoseId())
-        && set_pose_ids.count(v1->getPoseId())
-        && set_pose_ids.count(v2->getPoseId()))
-    {
-      map_triplet_matches.insert( match_iterator );
-    }
-  }
-
   aliceVision::track::TracksBuilder tracksBuilder;
   tracksBuilder.build(map_triplet_matches);
   tracksBuilder.filter(true,3);
@@ -17,10 +17,15 @@
 #include <aliceVision/multiview/essential.hpp>
 #include <aliceVision/track/TracksBuilder.hpp>
 #include <aliceVision/track/tracksUtils.hpp>
+#include <aliceVision/sfm/BundleAdjustmentPartitioned.hpp>
 #include <aliceVision/config.hpp>
 
 #include <dependencies/htmlDoc/htmlDoc.hpp>
 
+#include <algorithm>
+#include <memory>
+#include <numeric>
+
 #ifdef _MSC_VER
 #pragma warning( once : 4267 ) //warning C4267: 'argument' : conversion from 'size_t' to 'const int', possible loss of data
 #endif
@@ -367,17 +372,29 @@ bool ReconstructionEngine_globalSfM::Adjust()
   // refine sfm  scene (in a 3 iteration process (free the parameters regarding their incertainty order)):
   BundleAdjustmentCeres::CeresOptions options; 
   options.useParametersOrdering = false; // disable parameters ordering
+  options.useGPU = _useGPUBundleAdjustment;
+
+  std::unique_ptr<BundleAdjustment> BA;
+  if(_partitionedBAMaxNbPoses > 0)
+  {
+    BundleAdjustmentPartitioned::PartitionOptions partitionOptions;
+    partitionOptions.maxNbPosesPerCluster = _partitionedBAMaxNbPoses;
+    BA.reset(new BundleAdjustmentPartitioned(partitionOptions, options));
+  }
+  else
+  {
+    BA.reset(new BundleAdjustmentCeres(options));
+  }
 
-  BundleAdjustmentCeres BA(options);
   // - refine only Structure and translations
-  bool success = BA.adjust(_sfmData, BundleAdjustment::REFINE_TRANSLATION | BundleAdjustment::REFINE_STRUCTURE);
+  bool success = BA->adjust(_sfmData, BundleAdjustment::REFINE_TRANSLATION | BundleAdjustment::REFINE_STRUCTURE);
   if(success)
   {
     if(!_loggingFile.empty())
       sfmDataIO::Save(_sfmData, (fs::path(_loggingFile).parent_path() / "structure_00_refine_T_Xi.ply").string(), sfmDataIO::ESfMData(sfmDataIO::EXTRINSICS | sfmDataIO::STRUCTURE));
 
     // refine only structure and rotations & translations
-    success = BA.adjust(_sfmData, BundleAdjustment::REFINE_ROTATION | BundleAdjustment::REFINE_TRANSLATION | BundleAdjustment::REFINE_STRUCTURE);
+    success = BA->adjust(_sfmData, BundleAdjustment::REFINE_ROTATION | BundleAdjustment::REFINE_TRANSLATION | BundleAdjustment::REFINE_STRUCTURE);
 
     if(success && !_loggingFile.empty())
       sfmDataIO::Save(_sfmData, (fs::path(_loggingFile).parent_path() / "structure_01_refine_RT_Xi.ply").string(), sfmDataIO::ESfMData(sfmDataIO::EXTRINSICS | sfmDataIO::STRUCTURE));
@@ -386,7 +403,7 @@ bool ReconstructionEngine_globalSfM::Adjust()
   if(success && !_lockAllIntrinsics)
   {
     // refine all: Structure, motion:{rotations, translations} and optics:{intrinsics}
-    success = BA.adjust(_sfmData, BundleAdjustment::REFINE_ALL);
+    success = BA->adjust(_sfmData, BundleAdjustment::REFINE_ALL);
     if(success && !_loggingFile.empty())
       sfmDataIO::Save(_sfmData, (fs::path(_loggingFile).parent_path() / "structure_02_refine_KRT_Xi.ply").string(), sfmDataIO::ESfMData(sfmDataIO::EXTRINSICS | sfmDataIO::STRUCTURE));
   }
@@ -420,7 +437,7 @@ bool ReconstructionEngine_globalSfM::Adjust()
   BundleAdjustment::ERefineOptions refineOptions = BundleAdjustment::REFINE_ROTATION | BundleAdjustment::REFINE_TRANSLATION | BundleAdjustment::REFINE_STRUCTURE;
   if(!_lockAllIntrinsics)
     refineOptions |= BundleAdjustment::REFINE_INTRINSICS_ALL;
-  success = BA.adjust(_sfmData, refineOptions);
+  success = BA->adjust(_sfmData, refineOptions);
 
   if(success && !_loggingFile.empty())
     sfmDataIO::Save(_sfmData, (fs::path(_loggingFile).parent_path() / "structure_04_outlier_removed.ply").string(), sfmDataIO::ESfMData(sfmDataIO::EXTRINSICS | sfmDataIO::STRUCTURE));
@@ -447,17 +464,44 @@ void ReconstructionEngine_globalSfM::Compute_Relative_Rotations(rotationAveragin
     poseWiseMatches[Pair(v1->getPoseId(), v2->getPoseId())].insert(pair);
   }
 
+  // the pose pairs with the most matches first, so the longest estimations do not end the parallel loop alone
+  std::vector<PoseWiseMatches::const_iterator> poseWiseMatchesIts;
+  std::vector<std::size_t> nbMatchesPerPosePair;
+  poseWiseMatchesIts.reserve(poseWiseMatches.size());
+  for (PoseWiseMatches::const_iterator iter = poseWiseMatches.begin(); iter != poseWiseMatches.end(); ++iter)
+  {
+    std::size_t nbMatches = 0;
+    for (const Pair& pair : iter->second)
+      nbMatches += _pairwiseMatches->at(pair).getNbAllMatches();
+    poseWiseMatchesIts.push_back(iter);
+    nbMatchesPerPosePair.push_back(nbMatches);
+  }
+  std::vector<std::size_t> posePairOrder(poseWiseMatchesIts.size());
+  std::iota(posePairOrder.begin(), posePairOrder.end(), 0);
+  std::stable_sort(posePairOrder.begin(), posePairOrder.end(), [&](std::size_t a, std::size_t b)
+  {
+    return nbMatchesPerPosePair[a] > nbMatchesPerPosePair[b];
+  });
+
+  // the relative rotation and the estimation time of each pose pair,
+  // collected in the pose pairs order after the parallel loop
+  std::vector<std::unique_ptr<rotationAveraging::RelativeRotation>> relativeRotationPerPosePair(poseWiseMatchesIts.size());
+  std::vector<double> timePerPosePair(poseWiseMatchesIts.size(), 0.0);
+
+  // each pair estimation draws its samples from its own generator, seeded from the pose pair index
+  const std::mt19937::result_type pairSeed = _randomNumberGenerator();
+
   auto progressDisplay = system::createConsoleProgressDisplay(poseWiseMatches.size(), std::cout,
                                                               "\n- Relative pose computation -\n" );
   #pragma omp parallel for schedule(dynamic)
   // Compute the relative pose from pairwise point matches:
-  for (int i = 0; i < poseWiseMatches.size(); ++i)
+  for (int o = 0; o < posePairOrder.size(); ++o)
   {
     ++progressDisplay;
+    const std::size_t i = posePairOrder[o];
+    const system::Timer pairTimer;
     {
-      PoseWiseMatches::const_iterator iter (poseWiseMatches.begin());
-      std::advance(iter, i);
-      const auto& relative_pose_iterator(*iter);
+      const auto& relative_pose_iterator(*poseWiseMatchesIts[i]);
       const Pair relative_pose_pair = relative_pose_iterator.first;
       const PairSet& match_pairs = relative_pose_iterator.second;
 
@@ -533,8 +577,10 @@ void ReconstructionEngine_globalSfM::Compute_Relative_Rotations(rotationAveragin
       const Mat3 K  = Mat3::Identity();
 
 
-      if(!robustRelativePose(K, K, x1, x2, _randomNumberGenerator, relativePose_info, imageSize, imageSize, 256))
+      std::mt19937 pairRandomNumberGenerator(pairSeed + i);
+      if(!robustRelativePose(K, K, x1, x2, pairRandomNumberGenerator, relativePose_info, imageSize, imageSize, 256))
       {
+        timePerPosePair[i] = pairTimer.elapsed();
         continue;
       }
 
@@ -614,17 +660,30 @@ void ReconstructionEngine_globalSfM::Compute_Relative_Rotations(rotationAveragin
           relativePose_info.relativePose = Pose3(Rrel, -Rrel.transpose() * trel);
         }
       }
-      #pragma omp critical
-      {
-        // Add the relative rotation to the relative 'rotation' pose graph
-        using namespace aliceVision::rotationAveraging;
-          vec_relatives_R.emplace_back(
+      // Add the relative rotation to the relative 'rotation' pose graph
+      relativeRotationPerPosePair[i].reset(new rotationAveraging::RelativeRotation(
             relative_pose_pair.first, relative_pose_pair.second,
-            relativePose_info.relativePose.rotation(), relativePose_info.vec_inliers.size());
-      }
+            relativePose_info.relativePose.rotation(), relativePose_info.vec_inliers.size()));
     }
+    timePerPosePair[i] = pairTimer.elapsed();
   } // for all relative pose
 
+  for (const auto& relativeRotation : relativeRotationPerPosePair)
+  {
+    if (relativeRotation)
+      vec_relatives_R.push_back(*relativeRotation);
+  }
+
+  if (!timePerPosePair.empty())
+  {
+    const auto maxTimeIt = std::max_element(timePerPosePair.begin(), timePerPosePair.end());
+    const double totalTime = std::accumulate(timePerPosePair.begin(), timePerPosePair.end(), 0.0);
+    ALICEVISION_LOG_DEBUG("Relative pose computation: " << vec_relatives_R.size() << " relative rotations from " << timePerPosePair.size() << " pose pairs\n"
+                          << "\t- total time of the pairs: " << totalTime << " s\n"
+                          << "\t- mean time per pair: " << totalTime / timePerPosePair.size() << " s\n"
+                          << "\t- max time: " << *maxTimeIt << " s (" << nbMatchesPerPosePair[maxTimeIt - timePerPosePair.begin()] << " matches)");
+  }
+
   // Re-weight rotation in [0,1]
   if (vec_relatives_R.size() > 1)
   {
@@ -35,6 +35,9 @@ public:
   void SetTranslationAveragingMethod(ETranslationAveragingMethod eTranslationAveragingMethod);
 
   void setLockAllIntrinsics(bool v) { _lockAllIntrinsics = v; }
+  void setUseGPUBundleAdjustment(bool v) { _useGPUBundleAdjustment = v; }
+  /// use a partitioned bundle adjustment above the given number of poses per cluster (0 to disable)
+  void setPartitionedBundleAdjustment(std::size_t maxNbPosesPerCluster) { _partitionedBAMaxNbPoses = maxNbPosesPerCluster; }
 
   virtual bool process();
 
@@ -65,6 +68,8 @@ private:
   ERotationAveragingMethod _eRotationAveragingMethod;
   ETranslationAveragingMethod _eTranslationAveragingMethod;
   bool _lockAllIntrinsics = false;
+  bool _useGPUBundleAdjustment = false;
+  std::size_t _partitionedBAMaxNbPoses = 0;
   EFeatureConstraint _featureConstraint = EFeatureConstraint::BASIC;
 
   // Data provider
@@ -0,0 +1,664 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "ReconstructionEngine_hierarchicalSfM.hpp"
+#include <aliceVision/sfm/BundleAdjustmentCeres.hpp>
+#include <aliceVision/sfm/BundleAdjustmentPartitioned.hpp>
+#include <aliceVision/sfm/sfmFilters.hpp>
+#include <aliceVision/sfm/utils/alignment.hpp>
+#include <aliceVision/sfmDataIO/sfmDataIO.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <tuple>
+
+namespace aliceVision {
+namespace sfm {
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+/// view graph: for each view, the number of matches with each neighbor view
+using ViewGraph = std::map<IndexT, std::map<IndexT, double>>;
+
+ViewGraph buildViewGraph(const matching::PairwiseMatches& pairwiseMatches)
+{
+  ViewGraph viewGraph;
+  for(const auto& matchesPair : pairwiseMatches)
+  {
+    std::size_t nbMatches = 0;
+    for(const auto& descMatches : matchesPair.second)
+      nbMatches += descMatches.second.size();
+
+    if(nbMatches == 0 || matchesPair.first.first == matchesPair.first.second)
+      continue;
+
+    viewGraph[matchesPair.first.first][matchesPair.first.second] += nbMatches;
+    viewGraph[matchesPair.first.second][matchesPair.first.first] += nbMatches;
+  }
+  return viewGraph;
+}
+
+/// Split the views into the connected components of the view graph
+std::vector<std::vector<IndexT>> getConnectedComponents(const ViewGraph& viewGraph)
+{
+  std::vector<std::vector<IndexT>> components;
+  std::set<IndexT> visited;
+
+  for(const auto& nodePair : viewGraph)
+  {
+    if(!visited.insert(nodePair.first).second)
+      continue;
+
+    std::vector<IndexT> component(1, nodePair.first);
+    for(std::size_t i = 0; i < component.size(); ++i)
+    {
+      for(const auto& neighborPair : viewGraph.at(component[i]))
+      {
+        if(visited.insert(neighborPair.first).second)
+          component.push_back(neighborPair.first);
+      }
+    }
+    components.push_back(std::move(component));
+  }
+  return components;
+}
+
+/**
+ * @brief Split the views in two parts minimizing the normalized cut [Shi & Malik 2000].
+ *        The views are ordered by the Fiedler vector of the normalized Laplacian of their subgraph,
+ *        computed by power iterations, and the best balanced cut of this order is kept.
+ */
+void splitNormalizedCut(const ViewGraph& viewGraph, const std::vector<IndexT>& views,
+                        std::vector<IndexT>& partA, std::vector<IndexT>& partB)
+{
+  const std::size_t n = views.size();
+
+  std::map<IndexT, std::size_t> indexPerView;
+  for(std::size_t i = 0; i < n; ++i)
+    indexPerView[views[i]] = i;
+
+  // adjacency of the subgraph
+  std::vector<std::vector<std::pair<std::size_t, double>>> neighbors(n);
+  Vec degrees = Vec::Zero(n);
+  for(std::size_t i = 0; i < n; ++i)
+  {
+    for(const auto& neighborPair : viewGraph.at(views[i]))
+    {
+      const auto it = indexPerView.find(neighborPair.first);
+      if(it == indexPerView.end())
+        continue;
+      neighbors[i].emplace_back(it->second, neighborPair.second);
+      degrees(i) += neighborPair.second;
+    }
+  }
+  const Vec sqrtDegrees = degrees.cwiseMax(1e-12).cwiseSqrt();
+  const Vec trivialVector = sqrtDegrees.normalized();
+
+  // the second largest eigenvector of I + D^-1/2 W D^-1/2, the largest one is the trivial vector D^1/2 1
+  Vec x(n);
+  for(std::size_t i = 0; i < n; ++i)
+    x(i) = std::cos(static_cast<double>(i));
+
+  const int maxNbIterations = 300;
+  for(int iteration = 0; iteration < maxNbIterations; ++iteration)
+  {
+    x -= x.dot(trivialVector) * trivialVector;
+    x.normalize();
+
+    const Vec scaled = x.cwiseQuotient(sqrtDegrees);
+    Vec y = x;
+    for(std::size_t i = 0; i < n; ++i)
+    {
+      double sum = 0.0;
+      for(const auto& neighbor : neighbors[i])
+        sum += neighbor.second * scaled(neighbor.first);
+      y(i) += sum / sqrtDegrees(i);
+    }
+    y -= y.dot(trivialVector) * trivialVector;
+    y.normalize();
+
+    const double change = (y - x).norm();
+    x = y;
+    if(change < 1e-6)
+      break;
+  }
+
+  const Vec fiedler = x.cwiseQuotient(sqrtDegrees);
+  std::vector<std::size_t> order(n);
+  for(std::size_t i = 0; i < n; ++i)
+    order[i] = i;
+  std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return fiedler(a) < fiedler(b); });
+
+  // sweep the order, moving the views one by one from the part B to the part A
+  const std::size_t minPartSize = std::max<std::size_t>(1, n / 4);
+  const double totalVolume = degrees.sum();
+  std::vector<bool> isInA(n, false);
+  double cut = 0.0;
+  double volumeA = 0.0;
+  double bestNormalizedCut = std::numeric_limits<double>::max();
+  std::size_t bestSize = n / 2;
+
+  for(std::size_t k = 0; k + 1 < n; ++k)
+  {
+    const std::size_t i = order[k];
+    for(const auto& neighbor : neighbors[i])
+      cut += isInA[neighbor.first] ? -neighbor.second : neighbor.second;
+    isInA[i] = true;
+    volumeA += degrees(i);
+
+    const std::size_t sizeA = k + 1;
+    if(sizeA < minPartSize || n - sizeA < minPartSize)
+      continue;
+
+    const double volumeB = totalVolume - volumeA;
+    const double normalizedCut = cut / std::max(volumeA, 1e-12) + cut / std::max(volumeB, 1e-12);
+    if(normalizedCut < bestNormalizedCut)
+    {
+      bestNormalizedCut = normalizedCut;
+      bestSize = sizeA;
+    }
+  }
+
+  partA.clear();
+  partB.clear();
+  for(std::size_t k = 0; k < n; ++k)
+    (k < bestSize ? partA : partB).push_back(views[order[k]]);
+}
+
+/**
+ * @brief Create the scene of a cluster: copies of its views and their intrinsics.
+ */
+void buildClusterScene(const sfmData::SfMData& sfmData, const ReconstructionEngine_hierarchicalSfM::ViewCluster& cluster,
+                       sfmData::SfMData& clusterData)
+{
+  std::set<IndexT> clusterViews = cluster.views;
+  clusterViews.insert(cluster.overlapViews.begin(), cluster.overlapViews.end());
+
+  for(const IndexT viewId : clusterViews)
+  {
+    const auto viewIt = sfmData.getViews().find(viewId);
+    if(viewIt == sfmData.getViews().end())
+      continue;
+
+    // the clusters are reconstructed concurrently and update their views and intrinsics
+    clusterData.getViews()[viewId] = std::make_shared<sfmData::View>(*viewIt->second);
+
+    const IndexT intrinsicId = viewIt->second->getIntrinsicId();
+    const auto intrinsicIt = sfmData.getIntrinsics().find(intrinsicId);
+    if(intrinsicIt != sfmData.getIntrinsics().end() && clusterData.getIntrinsics().count(intrinsicId) == 0)
+      clusterData.getIntrinsics()[intrinsicId].reset(intrinsicIt->second->clone());
+  }
+}
+
+std::size_t countCommonCameras(const sfmData::SfMData& sfmDataA, const sfmData::SfMData& sfmDataB)
+{
+  std::vector<IndexT> commonViewIds;
+  getCommonViewsWithPoses(sfmDataA, sfmDataB, commonViewIds);
+  return commonViewIds.size();
+}
+
+} // namespace
+
+ReconstructionEngine_hierarchicalSfM::ReconstructionEngine_hierarchicalSfM(const sfmData::SfMData& sfmData,
+                                                                           const Params& params,
+                                                                           const std::string& outputFolder)
+  : ReconstructionEngine(sfmData, outputFolder)
+  , _params(params)
+{}
+
+std::vector<ReconstructionEngine_hierarchicalSfM::ViewCluster> ReconstructionEngine_hierarchicalSfM::computeViewClusters(
+  const matching::PairwiseMatches& pairwiseMatches,
+  std::size_t maxNbViewsPerCluster,
+  double overlapRatio)
+{
+  const ViewGraph viewGraph = buildViewGraph(pairwiseMatches);
+  maxNbViewsPerCluster = std::max<std::size_t>(maxNbViewsPerCluster, 2);
+
+  // recursive normalized cuts of the connected components
+  std::vector<std::vector<IndexT>> parts = getConnectedComponents(viewGraph);
+  std::vector<ViewCluster> clusters;
+
+  while(!parts.empty())
+  {
+    std::vector<IndexT> part = std::move(parts.back());
+    parts.pop_back();
+
+    if(part.size() <= maxNbViewsPerCluster)
+    {
+      ViewCluster cluster;
+      cluster.views.insert(part.begin(), part.end());
+      clusters.push_back(std::move(cluster));
+      continue;
+    }
+
+    std::vector<IndexT> partA;
+    std::vector<IndexT> partB;
+    splitNormalizedCut(viewGraph, part, partA, partB);
+
+    // a cut can disconnect a part
+    for(std::vector<IndexT>* subPart : {&partA, &partB})
+    {
+      ViewGraph subGraph;
+      const std::set<IndexT> subPartViews(subPart->begin(), subPart->end());
+      for(const IndexT viewId : *subPart)
+      {
+        std::map<IndexT, double>& subNeighbors = subGraph[viewId];
+        for(const auto& neighborPair : viewGraph.at(viewId))
+          if(subPartViews.count(neighborPair.first))
+            subNeighbors.insert(neighborPair);
+      }
+      for(std::vector<IndexT>& component : getConnectedComponents(subGraph))
+        parts.push_back(std::move(component));
+    }
+  }
+
+  // largest clusters first
+  std::stable_sort(clusters.begin(), clusters.end(), [](const ViewCluster& a, const ViewCluster& b) {
+    return a.views.size() > b.views.size();
+  });
+
+  // extend each cluster with the neighbor views the most connected to it
+  for(ViewCluster& cluster : clusters)
+  {
+    std::map<IndexT, double> neighborWeights;
+    for(const IndexT viewId : cluster.views)
+      for(const auto& neighborPair : viewGraph.at(viewId))
+        if(cluster.views.count(neighborPair.first) == 0)
+          neighborWeights[neighborPair.first] += neighborPair.second;
+
+    std::vector<std::pair<double, IndexT>> sortedNeighbors;
+    for(const auto& neighborPair : neighborWeights)
+      sortedNeighbors.emplace_back(neighborPair.second, neighborPair.first);
+    std::sort(sortedNeighbors.rbegin(), sortedNeighbors.rend());
+
+    const std::size_t nbOverlapViews = std::min(sortedNeighbors.size(),
+      static_cast<std::size_t>(std::ceil(overlapRatio * cluster.views.size())));
+    for(std::size_t i = 0; i < nbOverlapViews; ++i)
+      cluster.overlapViews.insert(sortedNeighbors[i].second);
+  }
+
+  return clusters;
+}
+
+std::string ReconstructionEngine_hierarchicalSfM::getClusterFilename(std::size_t clusterIndex) const
+{
+  std::ostringstream os;
+  os << "cluster_" << std::setw(4) << std::setfill('0') << clusterIndex << ".sfmb";
+  return (fs::path(_outputFolder) / "clusters" / os.str()).string();
+}
+
+std::string ReconstructionEngine_hierarchicalSfM::getClusterKeyFilename(std::size_t clusterIndex) const
+{
+  return fs::path(getClusterFilename(clusterIndex)).replace_extension(".key").string();
+}
+
+std::string ReconstructionEngine_hierarchicalSfM::getClusterKey(const ViewCluster& cluster, int seed) const
+{
+  std::size_t nbMatches = 0;
+  for(const auto& matchesPair : *_pairwiseMatches)
+  {
+    const IndexT viewA = matchesPair.first.first;
+    const IndexT viewB = matchesPair.first.second;
+    if((cluster.views.count(viewA) || cluster.overlapViews.count(viewA)) &&
+       (cluster.views.count(viewB) || cluster.overlapViews.count(viewB)))
+    {
+      for(const auto& descMatches : matchesPair.second)
+        nbMatches += descMatches.second.size();
+    }
+  }
+
+  const ReconstructionEngine_sequentialSfM::Params& p = _params.sfmParams;
+  std::ostringstream os;
+  os << std::setprecision(17);
+  os << "views";
+  for(const IndexT viewId : cluster.views)
+    os << " " << viewId;
+  os << "\noverlapViews";
+  for(const IndexT viewId : cluster.overlapViews)
+    os << " " << viewId;
+  os << "\nnbMatches " << nbMatches
+     << "\nseed " << seed
+     << "\nsfmParams " << p.userInitialImagePair.first << " " << p.userInitialImagePair.second
+     << " " << p.minInputTrackLength << " " << p.minTrackLength << " " << p.minPointsPerPose
+     << " " << p.useLocalBundleAdjustment << " " << p.localBundelAdjustementGraphDistanceLimit
+     << " " << p.partitionedBundleAdjustmentMaxNbPoses
+     << " " << p.slidingWindowSize << " " << p.slidingWindowGlobalBAInterval
+     << " " << p.lockAllIntrinsics << " " << p.minNbCamerasToRefinePrincipalPoint
+     << " " << p.minNbObservationsForTriangulation << " " << p.minAngleForTriangulation
+     << " " << p.minAngleForLandmark << " " << p.maxReprojectionError
+     << " " << static_cast<int>(p.featureConstraint) << " " << p.minAngleInitialPair << " " << p.maxAngleInitialPair
+     << " " << p.filterTrackForks << " " << static_cast<int>(p.localizerEstimator)
+     << " " << p.localizerEstimatorError << " " << p.localizerEstimatorMaxIterations
+     << "\n";
+  return os.str();
+}
+
+bool ReconstructionEngine_hierarchicalSfM::process()
+{
+  if(_featuresPerView == nullptr || _pairwiseMatches == nullptr)
+    throw std::runtime_error("The hierarchical SfM needs the features and the matches.");
+
+  if(!_sfmData.getRigs().empty())
+    throw std::runtime_error("The hierarchical SfM does not support rigs, use the sequential SfM.");
+
+  if(!_sfmData.getPoses().empty())
+    ALICEVISION_LOG_WARNING("The hierarchical SfM ignores the input poses and landmarks.");
+
+  aliceVision::system::Timer timer;
+
+  const std::vector<ViewCluster> clusters = computeViewClusters(*_pairwiseMatches, _params.maxNbViewsPerCluster, _params.overlapRatio);
+
+  {
+    std::stringstream ss;
+    ss << "Hierarchical SfM: " << clusters.size() << " clusters of views:";
+    for(std::size_t i = 0; i < clusters.size(); ++i)
+      ss << std::endl << "\t- cluster " << i << ": " << clusters[i].views.size() << " views + " << clusters[i].overlapViews.size() << " overlap views";
+    ALICEVISION_LOG_INFO(ss.str());
+  }
+
+  fs::create_directories(fs::path(_outputFolder) / "clusters");
+
+  // a seed per cluster, so the reconstruction of a cluster does not depend on the other ones
+  std::vector<int> seeds(clusters.size());
+  for(int& seed : seeds)
+    seed = static_cast<int>(_randomNumberGenerator() >> 1);
+
+  if(_params.clusterIndex >= 0)
+  {
+    if(_params.clusterIndex >= static_cast<int>(clusters.size()))
+      throw std::runtime_error("Invalid cluster index " + std::to_string(_params.clusterIndex) + ", there are " + std::to_string(clusters.size()) + " clusters.");
+
+    sfmData::SfMData clusterData;
+    if(!reconstructCluster(_params.clusterIndex, clusters.at(_params.clusterIndex), seeds.at(_params.clusterIndex), clusterData))
+      return false;
+
+    _sfmData = clusterData;
+    return true;
+  }
+
+  // clusters reconstruction, each sequential SfM runs on a single thread
+  std::vector<sfmData::SfMData> clusterScenes(clusters.size());
+
+  #pragma omp parallel for schedule(dynamic)
+  for(int i = 0; i < static_cast<int>(clusters.size()); ++i)
+  {
+    // the nested OpenMP regions and the bundle adjustments (Ceres threads) of this cluster use the current thread only,
+    // this only changes the setting of the current thread inside this parallel region
+    if(omp_get_num_threads() > 1)
+      omp_set_num_threads(1);
+
+    const std::string clusterFilename = getClusterFilename(i);
+    const std::string keyFilename = getClusterKeyFilename(i);
+    if(fs::exists(clusterFilename) && fs::exists(keyFilename))
+    {
+      std::ifstream keyFile(keyFilename);
+      const std::string key((std::istreambuf_iterator<char>(keyFile)), std::istreambuf_iterator<char>());
+      if(key != getClusterKey(clusters[i], seeds[i]))
+      {
+        ALICEVISION_LOG_INFO("The reconstruction of the cluster " << i << " was computed from other views or parameters, recompute it.");
+      }
+      else if(sfmDataIO::Load(clusterScenes[i], clusterFilename, sfmDataIO::ESfMData::ALL))
+      {
+        ALICEVISION_LOG_INFO("Reuse the reconstruction of the cluster " << i << ": " << clusterFilename);
+        continue;
+      }
+    }
+    reconstructCluster(i, clusters[i], seeds[i], clusterScenes[i]);
+  }
+
+  ALICEVISION_LOG_INFO("Clusters reconstructed in " << timer.elapsed() << " s.");
+
+  if(!mergeClusters(clusterScenes))
+    return false;
+
+  const bool success = adjust();
+
+  ALICEVISION_LOG_INFO("Hierarchical SfM completed in " << timer.elapsed() << " s:" << std::endl
+                       << "\t- # poses: " << _sfmData.getPoses().size() << std::endl
+                       << "\t- # landmarks: " << _sfmData.getLandmarks().size());
+
+  return success && !_sfmData.getPoses().empty();
+}
+
+bool ReconstructionEngine_hierarchicalSfM::reconstructCluster(std::size_t clusterIndex, const ViewCluster& cluster, int seed,
+                                                              sfmData::SfMData& clusterData) const
+{
+  clusterData = sfmData::SfMData();
+  buildClusterScene(_sfmData, cluster, clusterData);
+
+  // the previous reconstruction of this cluster is not valid anymore
+  fs::remove(getClusterKeyFilename(clusterIndex));
+
+  // matches between the views of the cluster
+  matching::PairwiseMatches clusterMatches;
+  for(const auto& matchesPair : *_pairwiseMatches)
+  {
+    if(clusterData.getViews().count(matchesPair.first.first) && clusterData.getViews().count(matchesPair.first.second))
+      clusterMatches.insert(matchesPair);
+  }
+
+  ReconstructionEngine_sequentialSfM::Params sfmParams = _params.sfmParams;
+  if(clusterData.getViews().count(sfmParams.userInitialImagePair.first) == 0 ||
+     clusterData.getViews().count(sfmParams.userInitialImagePair.second) == 0)
+    sfmParams.userInitialImagePair = {UndefinedIndexT, UndefinedIndexT};
+
+  std::ostringstream clusterName;
+  clusterName << "cluster_" << std::setw(4) << std::setfill('0') << clusterIndex;
+  const fs::path clusterFolder = fs::path(_outputFolder) / "clusters" / clusterName.str();
+  fs::create_directories(clusterFolder);
+
+  try
+  {
+    ReconstructionEngine_sequentialSfM sfmEngine(clusterData, sfmParams, clusterFolder.string());
+    sfmEngine.initRandomSeed(seed);
+    sfmEngine.setFeatures(_featuresPerView);
+    sfmEngine.setMatches(&clusterMatches);
+
+    if(!sfmEngine.process())
+    {
+      ALICEVISION_LOG_WARNING("The cluster " << clusterIndex << " cannot be reconstructed.");
+      return false;
+    }
+    clusterData = sfmEngine.getSfMData();
+  }
+  catch(const std::exception& e)
+  {
+    ALICEVISION_LOG_WARNING("The cluster " << clusterIndex << " cannot be reconstructed: " << e.what());
+    clusterData = sfmData::SfMData();
+    return false;
+  }
+
+  if(sfmDataIO::Save(clusterData, getClusterFilename(clusterIndex), sfmDataIO::ESfMData::ALL))
+  {
+    // the key is written after the reconstruction, so an interrupted write is not reused
+    std::ofstream keyFile(getClusterKeyFilename(clusterIndex));
+    keyFile << getClusterKey(cluster, seed);
+  }
+  else
+  {
+    ALICEVISION_LOG_WARNING("Cannot write the reconstruction of the cluster " << clusterIndex << ".");
+  }
+
+  ALICEVISION_LOG_INFO("Cluster " << clusterIndex << " reconstructed: " << clusterData.getPoses().size() << " poses, "
+                       << clusterData.getLandmarks().size() << " landmarks.");
+  return true;
+}
+
+bool ReconstructionEngine_hierarchicalSfM::mergeClusters(std::vector<sfmData::SfMData>& clusterScenes)
+{
+  _sfmData.getPoses().clear();
+  _sfmData.getLandmarks().clear();
+
+  // landmark of the merged scene of each observation, to fuse the landmarks reconstructed by several clusters
+  using ObsKey = std::tuple<IndexT, IndexT, feature::EImageDescriberType>;
+  std::map<ObsKey, IndexT> landmarkPerObservation;
+  IndexT nextLandmarkId = 0;
+  std::set<IndexT> mergedIntrinsics;
+
+  const auto addCluster = [&](const sfmData::SfMData& clusterData)
+  {
+    for(const auto& viewPair : clusterData.getViews())
+    {
+      const sfmData::View& view = *viewPair.second;
+      if(!clusterData.isPoseAndIntrinsicDefined(&view) || _sfmData.isPoseAndIntrinsicDefined(view.getViewId()))
+        continue;
+
+      _sfmData.getViews().at(view.getViewId())->setResectionId(view.getResectionId());
+      _sfmData.setPose(*_sfmData.getViews().at(view.getViewId()), clusterData.getAbsolutePose(view.getPoseId()));
+
+      // the first reconstruction of an intrinsic is kept, the final bundle adjustment refines it
+      if(mergedIntrinsics.insert(view.getIntrinsicId()).second)
+        _sfmData.getIntrinsics()[view.getIntrinsicId()].reset(clusterData.getIntrinsics().at(view.getIntrinsicId())->clone());
+    }
+
+    for(const auto& landmarkPair : clusterData.getLandmarks())
+    {
+      const sfmData::Landmark& landmark = landmarkPair.second;
+
+      IndexT landmarkId = UndefinedIndexT;
+      for(const auto& observationPair : landmark.observations)
+      {
+        const auto it = landmarkPerObservation.find(ObsKey(observationPair.first, observationPair.second.id_feat, landmark.descType));
+        if(it != landmarkPerObservation.end())
+        {
+          landmarkId = it->second;
+          break;
+        }
+      }
+
+      if(landmarkId == UndefinedIndexT)
+      {
+        landmarkId = nextLandmarkId++;
+        sfmData::Landmark& newLandmark = _sfmData.getLandmarks()[landmarkId];
+        newLandmark = landmark;
+        newLandmark.observations.clear();
+      }
+
+      sfmData::Landmark& mergedLandmark = _sfmData.getLandmarks().at(landmarkId);
+      for(const auto& observationPair : landmark.observations)
+      {
+        if(mergedLandmark.observations.count(observationPair.first))
+          continue;
+        mergedLandmark.observations[observationPair.first] = observationPair.second;
+        landmarkPerObservation.emplace(ObsKey(observationPair.first, observationPair.second.id_feat, landmark.descType), landmarkId);
+      }
+    }
+  };
+
+  std::set<std::size_t> remainingClusters;
+  for(std::size_t i = 0; i < clusterScenes.size(); ++i)
+  {
+    if(!clusterScenes[i].getPoses().empty())
+      remainingClusters.insert(i);
+  }
+
+  if(remainingClusters.empty())
+  {
+    ALICEVISION_LOG_ERROR("No cluster reconstructed.");
+    return false;
+  }
+
+  // the largest reconstruction defines the coordinate system
+  const std::size_t referenceCluster = *std::max_element(remainingClusters.begin(), remainingClusters.end(), [&](std::size_t a, std::size_t b) {
+    return clusterScenes[a].getPoses().size() < clusterScenes[b].getPoses().size();
+  });
+  addCluster(clusterScenes[referenceCluster]);
+  remainingClusters.erase(referenceCluster);
+
+  // then the cluster with the most cameras in common with the merged scene
+  while(!remainingClusters.empty())
+  {
+    std::size_t bestCluster = 0;
+    std::size_t bestNbCommonCameras = 0;
+    for(const std::size_t i : remainingClusters)
+    {
+      const std::size_t nbCommonCameras = countCommonCameras(clusterScenes[i], _sfmData);
+      if(nbCommonCameras > bestNbCommonCameras)
+      {
+        bestNbCommonCameras = nbCommonCameras;
+        bestCluster = i;
+      }
+    }
+
+    if(bestNbCommonCameras < _params.minNbCommonCameras)
+    {
+      ALICEVISION_LOG_WARNING(remainingClusters.size() << " cluster(s) cannot be merged, not enough cameras in common with the merged scene.");
+      break;
+    }
+    remainingClusters.erase(bestCluster);
+
+    double S;
+    Mat3 R;
+    Vec3 t;
+    if(!computeSimilarityFromCommonCameras_viewId(clusterScenes[bestCluster], _sfmData, _randomNumberGenerator, &S, &R, &t))
+    {
+      ALICEVISION_LOG_WARNING("The cluster " << bestCluster << " cannot be merged, no similarity found on its " << bestNbCommonCameras << " common cameras.");
+      continue;
+    }
+
+    applyTransform(clusterScenes[bestCluster], S, R, t);
+    addCluster(clusterScenes[bestCluster]);
+
+    ALICEVISION_LOG_INFO("Cluster " << bestCluster << " merged with " << bestNbCommonCameras << " common cameras (scale: " << S << "): "
+                         << _sfmData.getPoses().size() << " poses, " << _sfmData.getLandmarks().size() << " landmarks.");
+  }
+
+  return true;
+}
+
+bool ReconstructionEngine_hierarchicalSfM::adjust()
+{
+  const ReconstructionEngine_sequentialSfM::Params& sfmParams = _params.sfmParams;
+
+  BundleAdjustmentCeres::CeresOptions options;
+  options.useGPU = sfmParams.useGPUBundleAdjustment;
+
+  std::unique_ptr<BundleAdjustment> BA;
+  if(sfmParams.partitionedBundleAdjustmentMaxNbPoses > 0)
+  {
+    BundleAdjustmentPartitioned::PartitionOptions partitionOptions;
+    partitionOptions.maxNbPosesPerCluster = sfmParams.partitionedBundleAdjustmentMaxNbPoses;
+    BA.reset(new BundleAdjustmentPartitioned(partitionOptions, options, sfmParams.minNbCamerasToRefinePrincipalPoint));
+  }
+  else
+  {
+    BA.reset(new BundleAdjustmentCeres(options, sfmParams.minNbCamerasToRefinePrincipalPoint));
+  }
+
+  BundleAdjustment::ERefineOptions refineOptions = BundleAdjustment::REFINE_ROTATION | BundleAdjustment::REFINE_TRANSLATION | BundleAdjustment::REFINE_STRUCTURE;
+  if(!sfmParams.lockAllIntrinsics)
+    refineOptions |= BundleAdjustment::REFINE_INTRINSICS_ALL;
+
+  // the overlap of the clusters is adjusted first, then the outliers of the merge are removed
+  if(!BA->adjust(_sfmData, refineOptions))
+    return false;
+
+  const std::size_t nbLandmarks = _sfmData.getLandmarks().size();
+  RemoveOutliers_PixelResidualError(_sfmData, sfmParams.featureConstraint, sfmParams.maxReprojectionError);
+  RemoveOutliers_AngleError(_sfmData, sfmParams.minAngleForLandmark);
+  eraseUnstablePosesAndObservations(_sfmData, sfmParams.minPointsPerPose, sfmParams.minTrackLength);
+
+  ALICEVISION_LOG_INFO("Global bundle adjustment: " << nbLandmarks - _sfmData.getLandmarks().size() << " outlier landmarks removed.");
+
+  return BA->adjust(_sfmData, refineOptions);
+}
+
+} // namespace sfm
+} // namespace aliceVision
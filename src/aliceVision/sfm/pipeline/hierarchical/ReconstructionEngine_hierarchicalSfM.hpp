@@ -0,0 +1,137 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/sfm/pipeline/ReconstructionEngine.hpp>
+#include <aliceVision/sfm/pipeline/sequential/ReconstructionEngine_sequentialSfM.hpp>
+#include <aliceVision/feature/FeaturesPerView.hpp>
+#include <aliceVision/matching/IndMatch.hpp>
+
+#include <set>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace sfm {
+
+/**
+ * @brief Hierarchical (divide and conquer) SfM Pipeline Reconstruction Engine.
+ *
+ * The view graph (edges weighted by the number of matches) is split by recursive normalized cuts into clusters
+ * of bounded size, each one extended with its most connected neighbor views. The clusters are reconstructed
+ * independently by the sequential SfM, in parallel or by separate processes (see Params::clusterIndex).
+ * Then they are merged one by one, with the similarity estimated on the cameras shared with the merged scene,
+ * and the whole scene is refined by a global bundle adjustment.
+ */
+class ReconstructionEngine_hierarchicalSfM : public ReconstructionEngine
+{
+public:
+  struct Params
+  {
+    /// parameters of the sequential SfM of each cluster and of the final bundle adjustment
+    ReconstructionEngine_sequentialSfM::Params sfmParams;
+    /// maximum number of views of a cluster (without the overlap)
+    std::size_t maxNbViewsPerCluster = 500;
+    /// number of neighbor views added to a cluster, relative to its number of views
+    double overlapRatio = 0.25;
+    /// minimum number of cameras shared by a cluster and the merged scene to merge it
+    std::size_t minNbCommonCameras = 4;
+    /// only reconstruct this cluster, to distribute the clusters over several processes (-1 to reconstruct and merge all of them)
+    int clusterIndex = -1;
+  };
+
+  /**
+   * @brief Cluster of views.
+   */
+  struct ViewCluster
+  {
+    /// views of the cluster
+    std::set<IndexT> views;
+    /// neighbor views shared with the other clusters, used to merge the reconstructions
+    std::set<IndexT> overlapViews;
+  };
+
+  /**
+   * @param[in] sfmData the views and intrinsics to reconstruct
+   * @param[in] params the parameters of the reconstruction
+   * @param[in] outputFolder the folder of the cluster reconstructions
+   */
+  ReconstructionEngine_hierarchicalSfM(const sfmData::SfMData& sfmData,
+                                       const Params& params,
+                                       const std::string& outputFolder);
+
+  void setFeatures(feature::FeaturesPerView* featuresPerView)
+  {
+    _featuresPerView = featuresPerView;
+  }
+
+  void setMatches(matching::PairwiseMatches* pairwiseMatches)
+  {
+    _pairwiseMatches = pairwiseMatches;
+  }
+
+  /**
+   * @brief Process the entire hierarchical reconstruction
+   *        The reconstruction of a cluster already written in the output folder (by another process) is reused
+   *        if it was computed from the same views and parameters.
+   * @return true if done
+   */
+  virtual bool process();
+
+  /**
+   * @brief Split the view graph into overlapping clusters
+   * @param[in] pairwiseMatches the matches defining the view graph
+   * @param[in] maxNbViewsPerCluster the maximum number of views of a cluster (without the overlap)
+   * @param[in] overlapRatio the number of neighbor views added to a cluster, relative to its number of views
+   * @return the clusters, each view with matches is in the views of exactly one cluster
+   */
+  static std::vector<ViewCluster> computeViewClusters(const matching::PairwiseMatches& pairwiseMatches,
+                                                      std::size_t maxNbViewsPerCluster,
+                                                      double overlapRatio);
+
+private:
+  /**
+   * @brief Reconstruct a cluster with the sequential SfM, the cluster scene works on copies of the views and intrinsics
+   * @param[in] clusterIndex the index of the cluster
+   * @param[in] cluster the views of the cluster
+   * @param[in] seed the random seed of the cluster reconstruction
+   * @param[out] clusterData the reconstructed cluster scene
+   * @return false if the cluster cannot be reconstructed
+   */
+  bool reconstructCluster(std::size_t clusterIndex, const ViewCluster& cluster, int seed, sfmData::SfMData& clusterData) const;
+
+  /**
+   * @brief Merge the cluster reconstructions in the scene, starting from the largest one
+   * @param[in,out] clusterScenes the cluster reconstructions, transformed in the scene coordinate system
+   * @return false if no cluster is reconstructed
+   */
+  bool mergeClusters(std::vector<sfmData::SfMData>& clusterScenes);
+
+  /**
+   * @brief Global bundle adjustment and outliers removal of the merged scene
+   */
+  bool adjust();
+
+  std::string getClusterFilename(std::size_t clusterIndex) const;
+
+  /**
+   * @brief Get the key of a cluster reconstruction, to only reuse a reconstruction of the same views with the same parameters
+   * @param[in] cluster the views of the cluster
+   * @param[in] seed the random seed of the cluster reconstruction
+   * @return the key, written next to the cluster reconstruction
+   */
+  std::string getClusterKey(const ViewCluster& cluster, int seed) const;
+
+  std::string getClusterKeyFilename(std::size_t clusterIndex) const;
+
+  Params _params;
+  feature::FeaturesPerView* _featuresPerView = nullptr;
+  matching::PairwiseMatches* _pairwiseMatches = nullptr;
+};
+
+} // namespace sfm
+} // namespace aliceVision
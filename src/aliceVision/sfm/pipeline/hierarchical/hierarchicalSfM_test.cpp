@@ -0,0 +1,103 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/feature/imageDescriberCommon.hpp>
+#include <aliceVision/sfm/utils/statistics.hpp>
+#include <aliceVision/sfm/utils/syntheticScene.hpp>
+#include <aliceVision/sfm/sfm.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <map>
+
+#define BOOST_TEST_MODULE HIERARCHICAL_SFM
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::camera;
+using namespace aliceVision::sfm;
+using namespace aliceVision::sfmData;
+
+BOOST_AUTO_TEST_CASE(HIERARCHICAL_SFM_ViewClusters)
+{
+  const int nviews = 16;
+  const int npoints = 64;
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+  const SfMData sfmData = getInputScene(d, config, EINTRINSIC::PINHOLE_CAMERA);
+
+  matching::PairwiseMatches pairwiseMatches;
+  generateSyntheticMatches(pairwiseMatches, sfmData, feature::EImageDescriberType::UNKNOWN);
+
+  const std::size_t maxNbViewsPerCluster = 5;
+  const std::vector<ReconstructionEngine_hierarchicalSfM::ViewCluster> clusters =
+    ReconstructionEngine_hierarchicalSfM::computeViewClusters(pairwiseMatches, maxNbViewsPerCluster, 0.5);
+
+  BOOST_CHECK_GE(clusters.size(), 4);
+
+  // each view is in exactly one cluster, the overlap views come from the other clusters
+  std::map<IndexT, int> nbClustersPerView;
+  for(const auto& cluster : clusters)
+  {
+    BOOST_CHECK_LE(cluster.views.size(), maxNbViewsPerCluster);
+    BOOST_CHECK(!cluster.overlapViews.empty());
+    for(const IndexT viewId : cluster.views)
+      ++nbClustersPerView[viewId];
+    for(const IndexT viewId : cluster.overlapViews)
+      BOOST_CHECK_EQUAL(cluster.views.count(viewId), 0);
+  }
+  BOOST_CHECK_EQUAL(nbClustersPerView.size(), nviews);
+  for(const auto& viewPair : nbClustersPerView)
+    BOOST_CHECK_EQUAL(viewPair.second, 1);
+}
+
+BOOST_AUTO_TEST_CASE(HIERARCHICAL_SFM_Known_Intrinsics)
+{
+  const int nviews = 12;
+  const int npoints = 128;
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  // Translate the input dataset to a SfMData scene
+  const SfMData sfmData = getInputScene(d, config, EINTRINSIC::PINHOLE_CAMERA);
+
+  // Remove poses and structure
+  SfMData sfmData2 = sfmData;
+  sfmData2.getPoses().clear();
+  sfmData2.structure.clear();
+
+  ReconstructionEngine_hierarchicalSfM::Params params;
+  params.sfmParams.lockAllIntrinsics = true;
+  params.maxNbViewsPerCluster = 6;
+  params.overlapRatio = 0.5;
+
+  const boost::filesystem::path outputFolder = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+  ReconstructionEngine_hierarchicalSfM sfmEngine(sfmData2, params, outputFolder.string());
+
+  // Add a tiny noise in 2D observations to make data more realistic
+  std::normal_distribution<double> distribution(0.0, 0.5);
+
+  feature::FeaturesPerView featuresPerView;
+  generateSyntheticFeatures(featuresPerView, feature::EImageDescriberType::UNKNOWN, sfmData, distribution);
+
+  matching::PairwiseMatches pairwiseMatches;
+  generateSyntheticMatches(pairwiseMatches, sfmData, feature::EImageDescriberType::UNKNOWN);
+
+  sfmEngine.setFeatures(&featuresPerView);
+  sfmEngine.setMatches(&pairwiseMatches);
+
+  BOOST_CHECK(sfmEngine.process());
+  boost::filesystem::remove_all(outputFolder);
+
+  const double residual = RMSE(sfmEngine.getSfMData());
+  ALICEVISION_LOG_DEBUG("RMSE residual: " << residual);
+  BOOST_CHECK_LT(residual, 0.5);
+  BOOST_CHECK_EQUAL(sfmEngine.getSfMData().getPoses().size(), nviews);
+  // the landmarks reconstructed by several clusters are fused
+  BOOST_CHECK_LE(sfmEngine.getSfMData().getLandmarks().size(), npoints);
+}
@@ -0,0 +1,510 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "LandmarksDescriptors.hpp"
+
+#include <aliceVision/matching/HashedDescriptionsIO.hpp>
+#include <aliceVision/system/Logger.hpp>
+
+#include <flann/flann.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <typeinfo>
+#include <unordered_map>
+
+namespace fs = boost::filesystem;
+
+namespace aliceVision {
+namespace sfm {
+
+namespace {
+
+struct LandmarksDescriptorsHeader
+{
+  static constexpr std::uint32_t currentVersion = 1;
+
+  char magic[8] = {'A', 'V', 'L', 'D', 'E', 'S', 'C', '\0'};
+  std::uint32_t version = currentVersion;
+  std::uint32_t scalarType = 0;
+  std::uint32_t dimension = 0;
+  std::uint32_t maxDescriptorsPerLandmark = 0;
+  std::uint64_t key = 0;
+  std::uint64_t nbDescriptors = 0;
+  /// the kd-tree is at the end of the file, after the landmark ids and the descriptors
+  std::uint64_t kdtreeOffset = 0;
+};
+
+static_assert(sizeof(LandmarksDescriptorsHeader) % 8 == 0, "The sections of the file are aligned on 8 bytes.");
+static_assert(sizeof(IndexT) == sizeof(std::uint32_t), "The landmark ids are saved as 32 bits integers.");
+
+template <typename T>
+struct ScalarType;
+template <>
+struct ScalarType<unsigned char> { static constexpr std::uint32_t value = 0; };
+template <>
+struct ScalarType<float> { static constexpr std::uint32_t value = 1; };
+
+inline std::size_t alignedSize(std::size_t size)
+{
+  return (size + 7) & ~std::size_t(7);
+}
+
+template <typename T, typename U>
+inline float squaredDistance(const T* a, const U* b, std::size_t dimension)
+{
+  float distance = 0.f;
+  for(std::size_t d = 0; d < dimension; ++d)
+  {
+    const float diff = static_cast<float>(a[d]) - static_cast<float>(b[d]);
+    distance += diff * diff;
+  }
+  return distance;
+}
+
+} // namespace
+
+struct LandmarksDescriptors::Index
+{
+  virtual ~Index() = default;
+
+  virtual bool save(std::FILE* file) const = 0;
+  virtual void match(const feature::Regions& queryRegions, float distRatio, matching::IndMatches& out_matches) const = 0;
+
+  std::uint32_t scalarType = 0;
+  std::size_t dimension = 0;
+  std::size_t maxDescriptorsPerLandmark = 0;
+  std::size_t nbDescriptors = 0;
+  std::uint64_t key = 0;
+};
+
+template <typename T>
+struct LandmarksDescriptors::TypedIndex : public LandmarksDescriptors::Index
+{
+  using KDTree = flann::KDTreeIndex<flann::L2<T>>;
+  using DistanceType = typename flann::L2<T>::ResultType;
+
+  /// the descriptors and their landmark ids, in the memory-mapped file or in the owned vectors
+  const T* descriptors = nullptr;
+  const IndexT* landmarkIds = nullptr;
+  std::vector<T> ownedDescriptors;
+  std::vector<IndexT> ownedLandmarkIds;
+  boost::iostreams::mapped_file_source mappedFile;
+  std::unique_ptr<KDTree> kdtree;
+
+  TypedIndex() { scalarType = ScalarType<T>::value; }
+
+  void createKDTree()
+  {
+    const flann::Matrix<T> dataset(const_cast<T*>(descriptors), nbDescriptors, dimension);
+    kdtree.reset(new KDTree(dataset, flann::KDTreeIndexParams(4)));
+  }
+
+  void build(const std::vector<Observation>& observations)
+  {
+    const auto getDescriptor = [&](const Observation& observation) {
+      return static_cast<const T*>(observation.regions->DescriptorRawData()) + observation.featureIndex * dimension;
+    };
+
+    // the observations grouped by landmark
+    std::vector<std::size_t> order(observations.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+      return observations[a].landmarkId < observations[b].landmarkId;
+    });
+    std::vector<std::size_t> groupBegins;
+    for(std::size_t i = 0; i < order.size(); ++i)
+    {
+      if(i == 0 || observations[order[i]].landmarkId != observations[order[i - 1]].landmarkId)
+        groupBegins.push_back(i);
+    }
+    groupBegins.push_back(order.size());
+    const int nbLandmarks = static_cast<int>(groupBegins.size()) - 1;
+
+    // the selected observations of each landmark, in place at the beginning of its group
+    std::vector<std::size_t> nbSelected(nbLandmarks, 0);
+
+    #pragma omp parallel for schedule(dynamic, 64)
+    for(int l = 0; l < nbLandmarks; ++l)
+    {
+      std::size_t* const group = order.data() + groupBegins[l];
+      const std::size_t groupSize = groupBegins[l + 1] - groupBegins[l];
+
+      // the observation closest to the mean descriptor
+      std::vector<float> mean(dimension, 0.f);
+      for(std::size_t i = 0; i < groupSize; ++i)
+      {
+        const T* descriptor = getDescriptor(observations[group[i]]);
+        for(std::size_t d = 0; d < dimension; ++d)
+          mean[d] += static_cast<float>(descriptor[d]);
+      }
+      for(float& value : mean)
+        value /= static_cast<float>(groupSize);
+
+      std::size_t best = 0;
+      float bestDistance = std::numeric_limits<float>::max();
+      for(std::size_t i = 0; i < groupSize; ++i)
+      {
+        const float distance = squaredDistance(getDescriptor(observations[group[i]]), mean.data(), dimension);
+        if(distance < bestDistance)
+        {
+          bestDistance = distance;
+          best = i;
+        }
+      }
+      std::swap(group[0], group[best]);
+      std::size_t selected = 1;
+
+      // then the observations farthest from the selected ones
+      std::vector<float> minDistances(groupSize, std::numeric_limits<float>::max());
+      while(selected < maxDescriptorsPerLandmark && selected < groupSize)
+      {
+        const T* last = getDescriptor(observations[group[selected - 1]]);
+        std::size_t farthest = selected;
+        float farthestDistance = -1.f;
+        for(std::size_t i = selected; i < groupSize; ++i)
+        {
+          minDistances[i] = std::min(minDistances[i], squaredDistance(getDescriptor(observations[group[i]]), last, dimension));
+          if(minDistances[i] > farthestDistance)
+          {
+            farthestDistance = minDistances[i];
+            farthest = i;
+          }
+        }
+        // the remaining descriptors are duplicates of the selected ones
+        if(farthestDistance <= 0.f)
+          break;
+        std::swap(group[selected], group[farthest]);
+        std::swap(minDistances[selected], minDistances[farthest]);
+        ++selected;
+      }
+      nbSelected[l] = selected;
+    }
+
+    nbDescriptors = std::accumulate(nbSelected.begin(), nbSelected.end(), std::size_t(0));
+    ownedDescriptors.resize(nbDescriptors * dimension);
+    ownedLandmarkIds.resize(nbDescriptors);
+    std::size_t row = 0;
+    for(int l = 0; l < nbLandmarks; ++l)
+    {
+      for(std::size_t i = 0; i < nbSelected[l]; ++i, ++row)
+      {
+        const Observation& observation = observations[order[groupBegins[l] + i]];
+        std::copy_n(getDescriptor(observation), dimension, ownedDescriptors.data() + row * dimension);
+        ownedLandmarkIds[row] = observation.landmarkId;
+      }
+    }
+    descriptors = ownedDescriptors.data();
+    landmarkIds = ownedLandmarkIds.data();
+
+    createKDTree();
+    kdtree->buildIndex();
+  }
+
+  bool load(const std::string& filepath, const LandmarksDescriptorsHeader& header)
+  {
+    mappedFile.open(filepath);
+    const std::size_t idsSize = alignedSize(nbDescriptors * sizeof(IndexT));
+    const std::size_t descriptorsSize = alignedSize(nbDescriptors * dimension * sizeof(T));
+    if(header.kdtreeOffset != sizeof(LandmarksDescriptorsHeader) + idsSize + descriptorsSize ||
+       header.kdtreeOffset > mappedFile.size())
+      return false;
+
+    landmarkIds = reinterpret_cast<const IndexT*>(mappedFile.data() + sizeof(LandmarksDescriptorsHeader));
+    descriptors = reinterpret_cast<const T*>(mappedFile.data() + sizeof(LandmarksDescriptorsHeader) + idsSize);
+
+    // the kd-tree nodes are read, they refer to the memory-mapped descriptors
+    std::FILE* file = std::fopen(filepath.c_str(), "rb");
+    if(file == nullptr)
+      return false;
+    bool valid = std::fseek(file, static_cast<long>(header.kdtreeOffset), SEEK_SET) == 0;
+    if(valid)
+    {
+      try
+      {
+        createKDTree();
+        kdtree->loadIndex(file);
+      }
+      catch(const std::exception& e)
+      {
+        ALICEVISION_LOG_WARNING("Invalid kd-tree in the landmarks descriptors file '" << filepath << "': " << e.what());
+        valid = false;
+      }
+    }
+    std::fclose(file);
+    return valid;
+  }
+
+  bool save(std::FILE* file) const override
+  {
+    const char padding[8] = {};
+    const std::size_t idsBytes = nbDescriptors * sizeof(IndexT);
+    const std::size_t descriptorsBytes = nbDescriptors * dimension * sizeof(T);
+
+    LandmarksDescriptorsHeader header;
+    header.scalarType = scalarType;
+    header.dimension = static_cast<std::uint32_t>(dimension);
+    header.maxDescriptorsPerLandmark = static_cast<std::uint32_t>(maxDescriptorsPerLandmark);
+    header.key = key;
+    header.nbDescriptors = nbDescriptors;
+    header.kdtreeOffset = sizeof(header) + alignedSize(idsBytes) + alignedSize(descriptorsBytes);
+
+    std::fwrite(&header, sizeof(header), 1, file);
+    std::fwrite(landmarkIds, 1, idsBytes, file);
+    std::fwrite(padding, 1, alignedSize(idsBytes) - idsBytes, file);
+    std::fwrite(descriptors, 1, descriptorsBytes, file);
+    std::fwrite(padding, 1, alignedSize(descriptorsBytes) - descriptorsBytes, file);
+    kdtree->saveIndex(file);
+    return std::ferror(file) == 0;
+  }
+
+  void match(const feature::Regions& queryRegions, float distRatio, matching::IndMatches& out_matches) const override
+  {
+    out_matches.clear();
+    const std::size_t nbQueries = queryRegions.RegionCount();
+    if(nbQueries == 0 || nbDescriptors == 0)
+      return;
+
+    // enough neighbors to find another landmark than the nearest one
+    const std::size_t knn = std::min(nbDescriptors, maxDescriptorsPerLandmark + 1);
+    std::vector<std::size_t> indices(nbQueries * knn);
+    std::vector<DistanceType> distances(nbQueries * knn);
+    const flann::Matrix<T> queries(static_cast<T*>(const_cast<void*>(queryRegions.DescriptorRawData())), nbQueries, dimension);
+    flann::Matrix<std::size_t> indicesMatrix(indices.data(), nbQueries, knn);
+    flann::Matrix<DistanceType> distancesMatrix(distances.data(), nbQueries, knn);
+    kdtree->knnSearch(queries, indicesMatrix, distancesMatrix, knn, flann::SearchParams(128));
+
+    // the squared distances are compared
+    const float squaredRatio = distRatio * distRatio;
+
+    // the nearest query feature of each landmark
+    std::unordered_map<IndexT, std::pair<IndexT, float>> matchPerLandmark;
+    for(std::size_t q = 0; q < nbQueries; ++q)
+    {
+      const std::size_t* neighbors = indices.data() + q * knn;
+      const DistanceType* neighborDistances = distances.data() + q * knn;
+      if(neighbors[0] >= nbDescriptors)
+        continue;
+
+      const IndexT landmarkId = landmarkIds[neighbors[0]];
+      const float distance = static_cast<float>(neighborDistances[0]);
+      bool valid = true;
+      for(std::size_t k = 1; k < knn && neighbors[k] < nbDescriptors; ++k)
+      {
+        if(landmarkIds[neighbors[k]] != landmarkId)
+        {
+          valid = distance < squaredRatio * static_cast<float>(neighborDistances[k]);
+          break;
+        }
+      }
+      if(!valid)
+        continue;
+
+      auto it = matchPerLandmark.emplace(landmarkId, std::make_pair(static_cast<IndexT>(q), distance)).first;
+      if(distance < it->second.second)
+        it->second = std::make_pair(static_cast<IndexT>(q), distance);
+    }
+
+    out_matches.reserve(matchPerLandmark.size());
+    for(const auto& matchPair : matchPerLandmark)
+      out_matches.emplace_back(matchPair.second.first, matchPair.first);
+    std::sort(out_matches.begin(), out_matches.end());
+  }
+};
+
+LandmarksDescriptors::LandmarksDescriptors() = default;
+LandmarksDescriptors::~LandmarksDescriptors() = default;
+
+std::size_t LandmarksDescriptors::getNbDescriptors() const
+{
+  return _index ? _index->nbDescriptors : 0;
+}
+
+std::size_t LandmarksDescriptors::getMaxDescriptorsPerLandmark() const
+{
+  return _index ? _index->maxDescriptorsPerLandmark : 0;
+}
+
+bool LandmarksDescriptors::build(const std::vector<Observation>& observations, std::size_t maxDescriptorsPerLandmark, std::uint64_t key)
+{
+  _index.reset();
+  if(observations.empty() || maxDescriptorsPerLandmark == 0)
+    return false;
+
+  const feature::Regions& firstRegions = *observations.front().regions;
+  for(const Observation& observation : observations)
+  {
+    if(observation.regions->Type_id() != firstRegions.Type_id() ||
+       observation.regions->DescriptorLength() != firstRegions.DescriptorLength())
+    {
+      ALICEVISION_LOG_WARNING("The landmarks descriptors must have the same type.");
+      return false;
+    }
+  }
+
+  std::unique_ptr<Index> index;
+  if(firstRegions.IsScalar() && firstRegions.Type_id() == typeid(unsigned char).name())
+    index.reset(new TypedIndex<unsigned char>());
+  else if(firstRegions.IsScalar() && firstRegions.Type_id() == typeid(float).name())
+    index.reset(new TypedIndex<float>());
+  else
+  {
+    ALICEVISION_LOG_WARNING("Unsupported descriptor type for the landmarks descriptors.");
+    return false;
+  }
+
+  index->dimension = firstRegions.DescriptorLength();
+  index->maxDescriptorsPerLandmark = maxDescriptorsPerLandmark;
+  index->key = key;
+  if(index->scalarType == ScalarType<unsigned char>::value)
+    static_cast<TypedIndex<unsigned char>&>(*index).build(observations);
+  else
+    static_cast<TypedIndex<float>&>(*index).build(observations);
+
+  _index = std::move(index);
+  return true;
+}
+
+bool LandmarksDescriptors::save(const std::string& filepath) const
+{
+  if(!_index)
+    return false;
+
+  // write in a temporary file and rename it once complete
+  const std::string tmpFilepath = filepath + "." + fs::unique_path().string();
+  std::FILE* file = std::fopen(tmpFilepath.c_str(), "wb");
+  if(file == nullptr)
+  {
+    ALICEVISION_LOG_WARNING("Can't write landmarks descriptors file '" << filepath << "'.");
+    return false;
+  }
+  const bool written = _index->save(file);
+  const bool closed = std::fclose(file) == 0;
+
+  boost::system::error_code ec;
+  if(written && closed)
+    fs::rename(tmpFilepath, filepath, ec);
+  if(!written || !closed || ec)
+  {
+    fs::remove(tmpFilepath, ec);
+    ALICEVISION_LOG_WARNING("Can't write landmarks descriptors file '" << filepath << "'.");
+    return false;
+  }
+  return true;
+}
+
+bool LandmarksDescriptors::load(const std::string& filepath, std::uint64_t key)
+{
+  _index.reset();
+
+  LandmarksDescriptorsHeader header;
+  {
+    std::FILE* file = std::fopen(filepath.c_str(), "rb");
+    if(file == nullptr)
+      return false;
+    const bool read = std::fread(&header, sizeof(header), 1, file) == 1;
+    std::fclose(file);
+    if(!read || std::memcmp(header.magic, LandmarksDescriptorsHeader().magic, sizeof(header.magic)) != 0 ||
+       header.version != LandmarksDescriptorsHeader::currentVersion)
+    {
+      ALICEVISION_LOG_WARNING("Invalid landmarks descriptors file '" << filepath << "', it will be recomputed.");
+      return false;
+    }
+  }
+  if(header.key != key)
+    return false;
+
+  std::unique_ptr<Index> index;
+  if(header.scalarType == ScalarType<unsigned char>::value)
+    index.reset(new TypedIndex<unsigned char>());
+  else if(header.scalarType == ScalarType<float>::value)
+    index.reset(new TypedIndex<float>());
+  else
+    return false;
+
+  index->dimension = header.dimension;
+  index->maxDescriptorsPerLandmark = header.maxDescriptorsPerLandmark;
+  index->nbDescriptors = header.nbDescriptors;
+  index->key = header.key;
+
+  bool loaded = false;
+  try
+  {
+    if(header.scalarType == ScalarType<unsigned char>::value)
+      loaded = static_cast<TypedIndex<unsigned char>&>(*index).load(filepath, header);
+    else
+      loaded = static_cast<TypedIndex<float>&>(*index).load(filepath, header);
+  }
+  catch(const std::exception& e)
+  {
+    ALICEVISION_LOG_WARNING("Can't read landmarks descriptors file '" << filepath << "': " << e.what());
+  }
+  if(!loaded)
+  {
+    ALICEVISION_LOG_WARNING("Invalid landmarks descriptors file '" << filepath << "', it will be recomputed.");
+    return false;
+  }
+
+  _index = std::move(index);
+  return true;
+}
+
+void LandmarksDescriptors::match(const feature::Regions& queryRegions, float distRatio, matching::IndMatches& out_matches) const
+{
+  out_matches.clear();
+  if(!_index || queryRegions.RegionCount() == 0)
+    return;
+
+  if(queryRegions.DescriptorLength() != _index->dimension ||
+     queryRegions.Type_id() != (_index->scalarType == ScalarType<unsigned char>::value ? typeid(unsigned char).name() : typeid(float).name()))
+  {
+    ALICEVISION_LOG_WARNING("The query descriptors do not have the type of the landmarks descriptors.");
+    return;
+  }
+  _index->match(queryRegions, distRatio, out_matches);
+}
+
+std::uint64_t computeLandmarksDescriptorsKey(const sfmData::SfMData& sfmData,
+                                             feature::EImageDescriberType descType,
+                                             std::size_t maxDescriptorsPerLandmark)
+{
+  std::vector<std::uint64_t> values;
+  values.push_back(static_cast<std::uint64_t>(descType));
+  values.push_back(maxDescriptorsPerLandmark);
+  for(const auto& landmarkPair : sfmData.getLandmarks())
+  {
+    const sfmData::Landmark& landmark = landmarkPair.second;
+    if(landmark.descType != descType)
+      continue;
+
+    values.push_back(landmarkPair.first);
+    for(int i = 0; i < 3; ++i)
+    {
+      std::uint64_t bits;
+      std::memcpy(&bits, &landmark.X(i), sizeof(bits));
+      values.push_back(bits);
+    }
+    for(const auto& observationPair : landmark.observations)
+      values.push_back((static_cast<std::uint64_t>(observationPair.first) << 32) | observationPair.second.id_feat);
+  }
+  return matching::computeDataHash(values.data(), values.size() * sizeof(std::uint64_t));
+}
+
+std::string getLandmarksDescriptorsPath(const std::string& sfmDataFilepath, feature::EImageDescriberType descType)
+{
+  const fs::path sfmDataPath(sfmDataFilepath);
+  return (sfmDataPath.parent_path() / (sfmDataPath.stem().string() + "." +
+          feature::EImageDescriberType_enumToString(descType) + ".landmarksDesc")).string();
+}
+
+} // namespace sfm
+} // namespace aliceVision
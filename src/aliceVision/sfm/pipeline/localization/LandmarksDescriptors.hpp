@@ -0,0 +1,153 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+#include <aliceVision/feature/imageDescriberCommon.hpp>
+#include <aliceVision/feature/Regions.hpp>
+#include <aliceVision/matching/IndMatch.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace sfm {
+
+/**
+ * @brief The descriptors of the landmarks of one describer type and the kd-tree indexing them,
+ * for a direct matching of the query features with the 3D points of a scene.
+ *
+ * Each landmark keeps a few descriptors of its observations: the one closest to the mean descriptor,
+ * then the ones farthest from the already selected descriptors.
+ * Once built, the descriptors and the kd-tree are saved next to the scene file.
+ * The saved descriptors are memory-mapped and the saved kd-tree is read instead of being rebuilt,
+ * so the same file is shared by all the localizers of the scene.
+ * Only the scalar descriptors of unsigned char or float are supported.
+ * The match() calls are thread-safe.
+ */
+class LandmarksDescriptors
+{
+public:
+  /// a descriptor of a landmark: a feature of the regions of an observation
+  struct Observation
+  {
+    Observation(IndexT landmarkId, const feature::Regions* regions, IndexT featureIndex)
+      : landmarkId(landmarkId)
+      , regions(regions)
+      , featureIndex(featureIndex)
+    {}
+
+    IndexT landmarkId;
+    const feature::Regions* regions;
+    IndexT featureIndex;
+  };
+
+  LandmarksDescriptors();
+  ~LandmarksDescriptors();
+
+  /**
+   * @brief Select the descriptors of each landmark among its observations and build the kd-tree
+   * @param[in] observations The observations of the landmarks, all with the same descriptor type
+   * @param[in] maxDescriptorsPerLandmark The maximum number of descriptors kept by landmark
+   * @param[in] key The key of the scene, checked when the file is loaded
+   * @return false if there is no observation or if the descriptor type is not supported
+   */
+  bool build(const std::vector<Observation>& observations, std::size_t maxDescriptorsPerLandmark, std::uint64_t key);
+
+  /**
+   * @brief Save the descriptors and the kd-tree, the file is written atomically
+   * @return false if the file cannot be written
+   */
+  bool save(const std::string& filepath) const;
+
+  /**
+   * @brief Memory-map the descriptors and read the kd-tree of a saved file
+   * @param[in] filepath The saved file
+   * @param[in] key The key of the scene
+   * @return false if the file does not exist, is invalid or was saved with another key
+   */
+  bool load(const std::string& filepath, std::uint64_t key);
+
+  /**
+   * @brief Match the query features with the landmarks
+   *
+   * The nearest landmark of a query feature is kept if its distance passes the ratio test
+   * with the nearest other landmark. A landmark is matched with one query feature at most, the nearest one.
+   *
+   * @param[in] queryRegions The query regions, of the same descriptor type
+   * @param[in] distRatio The distance ratio of the ratio test
+   * @param[out] out_matches The matches (query feature index, landmark id)
+   */
+  void match(const feature::Regions& queryRegions, float distRatio, matching::IndMatches& out_matches) const;
+
+  bool isEmpty() const { return getNbDescriptors() == 0; }
+  std::size_t getNbDescriptors() const;
+  std::size_t getMaxDescriptorsPerLandmark() const;
+
+private:
+  struct Index;
+  template <typename T>
+  struct TypedIndex;
+
+  std::unique_ptr<Index> _index;
+};
+
+/**
+ * @brief Compute the key of the landmarks descriptors of a scene: it changes with the landmarks
+ * of the describer type, their positions or their observations
+ */
+std::uint64_t computeLandmarksDescriptorsKey(const sfmData::SfMData& sfmData,
+                                             feature::EImageDescriberType descType,
+                                             std::size_t maxDescriptorsPerLandmark);
+
+/**
+ * @brief Get the observations of the landmarks of a describer type
+ * @param[in] sfmData The scene
+ * @param[in] descType The describer type
+ * @param[in] getRegions Functor const feature::Regions*(IndexT viewId) giving the regions of a view,
+ *            or nullptr if the regions of the view are not available
+ * @param[in] getFeatureIndex Functor IndexT(IndexT viewId, IndexT landmarkId, IndexT featureId) giving the index
+ *            of an observation feature in the regions of its view, or UndefinedIndexT
+ */
+template <typename GetRegionsFunc, typename GetFeatureIndexFunc>
+std::vector<LandmarksDescriptors::Observation> getLandmarksObservations(const sfmData::SfMData& sfmData,
+                                                                        feature::EImageDescriberType descType,
+                                                                        GetRegionsFunc getRegions,
+                                                                        GetFeatureIndexFunc getFeatureIndex)
+{
+  std::vector<LandmarksDescriptors::Observation> observations;
+  for(const auto& landmarkPair : sfmData.getLandmarks())
+  {
+    if(landmarkPair.second.descType != descType)
+      continue;
+
+    for(const auto& observationPair : landmarkPair.second.observations)
+    {
+      if(observationPair.second.id_feat == UndefinedIndexT)
+        continue;
+      const feature::Regions* regions = getRegions(observationPair.first);
+      if(regions == nullptr)
+        continue;
+      const IndexT featureIndex = getFeatureIndex(observationPair.first, landmarkPair.first, observationPair.second.id_feat);
+      if(featureIndex == UndefinedIndexT || featureIndex >= regions->RegionCount())
+        continue;
+      observations.emplace_back(landmarkPair.first, regions, featureIndex);
+    }
+  }
+  return observations;
+}
+
+/**
+ * @brief Get the path of the landmarks descriptors file of a scene, next to the scene file
+ */
+std::string getLandmarksDescriptorsPath(const std::string& sfmDataFilepath, feature::EImageDescriberType descType);
+
+} // namespace sfm
+} // namespace aliceVision
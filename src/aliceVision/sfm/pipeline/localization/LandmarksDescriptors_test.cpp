@@ -0,0 +1,119 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfm/pipeline/localization/LandmarksDescriptors.hpp>
+#include <aliceVision/feature/regionsFactory.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <random>
+
+#define BOOST_TEST_MODULE LandmarksDescriptors
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+
+namespace {
+
+/// regions of the observations of nbLandmarks landmarks seen by nbViews views, with noisy descriptors
+void makeObservations(std::size_t nbLandmarks,
+                      std::size_t nbViews,
+                      std::vector<feature::SIFT_Regions>& regionsPerView,
+                      std::vector<feature::SIFT_Regions::DescriptorT>& landmarksDescriptors)
+{
+  std::mt19937 generator(7);
+  std::uniform_int_distribution<int> value(0, 255);
+  std::uniform_int_distribution<int> noise(-3, 3);
+
+  landmarksDescriptors.resize(nbLandmarks);
+  for(auto& descriptor : landmarksDescriptors)
+    for(std::size_t d = 0; d < descriptor.size(); ++d)
+      descriptor[d] = static_cast<unsigned char>(value(generator));
+
+  regionsPerView.resize(nbViews);
+  for(feature::SIFT_Regions& regions : regionsPerView)
+  {
+    for(const auto& landmarkDescriptor : landmarksDescriptors)
+    {
+      feature::SIFT_Regions::DescriptorT descriptor;
+      for(std::size_t d = 0; d < descriptor.size(); ++d)
+        descriptor[d] = static_cast<unsigned char>(std::max(0, std::min(255, landmarkDescriptor[d] + noise(generator))));
+      regions.Features().emplace_back(0.f, 0.f, 1.f, 0.f);
+      regions.Descriptors().push_back(descriptor);
+    }
+  }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(LandmarksDescriptors_buildMatchSaveLoad)
+{
+  const std::size_t nbLandmarks = 200;
+  std::vector<feature::SIFT_Regions> regionsPerView;
+  std::vector<feature::SIFT_Regions::DescriptorT> landmarksDescriptors;
+  makeObservations(nbLandmarks, 5, regionsPerView, landmarksDescriptors);
+
+  // the landmark ids are not contiguous
+  std::vector<sfm::LandmarksDescriptors::Observation> observations;
+  for(const feature::SIFT_Regions& regions : regionsPerView)
+    for(IndexT l = 0; l < nbLandmarks; ++l)
+      observations.emplace_back(10 * l, &regions, l);
+
+  sfm::LandmarksDescriptors landmarksDesc;
+  BOOST_CHECK(landmarksDesc.isEmpty());
+  BOOST_REQUIRE(landmarksDesc.build(observations, 2, 42));
+  BOOST_CHECK_EQUAL(landmarksDesc.getNbDescriptors(), 2 * nbLandmarks);
+
+  // the query features are the landmarks descriptors, in reverse order
+  feature::SIFT_Regions queryRegions;
+  for(std::size_t l = nbLandmarks; l-- > 0;)
+  {
+    queryRegions.Features().emplace_back(0.f, 0.f, 1.f, 0.f);
+    queryRegions.Descriptors().push_back(landmarksDescriptors[l]);
+  }
+
+  matching::IndMatches matches;
+  landmarksDesc.match(queryRegions, 0.8f, matches);
+  BOOST_CHECK_EQUAL(matches.size(), nbLandmarks);
+  for(const matching::IndMatch& match : matches)
+    BOOST_CHECK_EQUAL(match._j, 10 * (nbLandmarks - 1 - match._i));
+
+  const std::string filepath = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+  BOOST_REQUIRE(landmarksDesc.save(filepath));
+
+  sfm::LandmarksDescriptors loaded;
+  BOOST_CHECK(!loaded.load(filepath, 43));
+  BOOST_REQUIRE(loaded.load(filepath, 42));
+  BOOST_CHECK_EQUAL(loaded.getNbDescriptors(), landmarksDesc.getNbDescriptors());
+  BOOST_CHECK_EQUAL(loaded.getMaxDescriptorsPerLandmark(), 2);
+
+  matching::IndMatches loadedMatches;
+  loaded.match(queryRegions, 0.8f, loadedMatches);
+  BOOST_CHECK(loadedMatches == matches);
+
+  boost::filesystem::remove(filepath);
+}
+
+BOOST_AUTO_TEST_CASE(LandmarksDescriptors_ambiguousMatches)
+{
+  // two landmarks with the same descriptor
+  std::vector<feature::SIFT_Regions> regionsPerView;
+  std::vector<feature::SIFT_Regions::DescriptorT> landmarksDescriptors;
+  makeObservations(2, 1, regionsPerView, landmarksDescriptors);
+  regionsPerView[0].Descriptors()[1] = regionsPerView[0].Descriptors()[0];
+
+  std::vector<sfm::LandmarksDescriptors::Observation> observations;
+  observations.emplace_back(0, &regionsPerView[0], 0);
+  observations.emplace_back(1, &regionsPerView[0], 1);
+
+  sfm::LandmarksDescriptors landmarksDesc;
+  BOOST_REQUIRE(landmarksDesc.build(observations, 1, 0));
+
+  matching::IndMatches matches;
+  landmarksDesc.match(regionsPerView[0], 0.8f, matches);
+  BOOST_CHECK(matches.empty());
+}
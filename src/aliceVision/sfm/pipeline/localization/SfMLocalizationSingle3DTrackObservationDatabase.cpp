@@ -7,15 +7,14 @@
 
 #include "SfMLocalizationSingle3DTrackObservationDatabase.hpp"
 #include <aliceVision/matching/IndMatch.hpp>
-#include <aliceVision/matching/RegionsMatcher.hpp>
 
 namespace aliceVision {
 namespace sfm {
 
-  SfMLocalizationSingle3DTrackObservationDatabase::SfMLocalizationSingle3DTrackObservationDatabase()
+  SfMLocalizationSingle3DTrackObservationDatabase::SfMLocalizationSingle3DTrackObservationDatabase(std::size_t maxDescriptorsPerLandmark)
     : SfMLocalizer()
     , _sfmData(nullptr)
-    , _matchingInterface(nullptr)
+    , _maxDescriptorsPerLandmark(maxDescriptorsPerLandmark)
   {}
 
   bool SfMLocalizationSingle3DTrackObservationDatabase::Init(const sfmData::SfMData& sfmData,
@@ -32,40 +31,45 @@ namespace sfm {
       return false;
     }
 
-    /*
-    TODO: DELI
-
     // Setup the database
-    // A collection of regions
-    // - each view observation leads to a new regions
-    // - link each observation region to a track id to ease 2D-3D correspondences search
+    // - each landmark keeps a few descriptors of its observations
+    // - the descriptors are linked to their landmark id to ease 2D-3D correspondences search
+    const feature::MapRegionsPerDesc& firstViewRegions = regionsPerView.getData().begin()->second;
+    if (firstViewRegions.empty())
+      return false;
+    const feature::EImageDescriberType descType = firstViewRegions.begin()->first;
+
+    const std::vector<LandmarksDescriptors::Observation> observations = getLandmarksObservations(sfmData, descType,
+      [&](IndexT viewId) -> const feature::Regions* {
+        const auto viewIt = regionsPerView.getData().find(viewId);
+        if (viewIt == regionsPerView.getData().end())
+          return nullptr;
+        const auto regionsIt = viewIt->second.find(descType);
+        return (regionsIt == viewIt->second.end()) ? nullptr : regionsIt->second.get();
+      },
+      [](IndexT viewId, IndexT landmarkId, IndexT featureId) { return featureId; });
 
-    const feature::Regions& regionsType = regionsPerView.getFirstViewRegions();
-    landmark_observations_descriptors_.reset(regionsType.EmptyClone());
-    for (const auto & landmark : sfm_data.getLandmarks())
-    {
-      for (const auto & observation : landmark.second.obs)
-      {
-        if (observation.second.id_feat != UndefinedIndexT)
-        {
-          // copy the feature/descriptor to landmark_observations_descriptors
-          const feature::Regions& viewRegions = regionsPerView.getRegions(observation.first, landmark.second.descType);
-          viewRegions.CopyRegion(observation.second.id_feat, landmark_observations_descriptors_.get());
-          // link this descriptor to the track Id
-          index_to_landmark_id_.push_back(landmark.first);
-        }
-      }
-    }
     ALICEVISION_LOG_DEBUG("Init retrieval database ... ");
-    matching_interface_.reset(new
-      matching::Matcher_Regions_Database(matching::ANN_L2, *landmark_observations_descriptors_));
-    ALICEVISION_LOG_DEBUG("Retrieval database initialized\n"
-      "#landmark: " << sfm_data.getLandmarks().size() << "\n"
-      "#descriptor initialized: " << landmark_observations_descriptors_->RegionCount());
+    auto landmarksDescriptors = std::make_shared<LandmarksDescriptors>();
+    if (!landmarksDescriptors->build(observations, _maxDescriptorsPerLandmark,
+                                     computeLandmarksDescriptorsKey(sfmData, descType, _maxDescriptorsPerLandmark)))
+      return false;
 
-    sfm_data_ = &sfm_data;
-    */
+    return Init(sfmData, std::move(landmarksDescriptors));
+  }
 
+  bool SfMLocalizationSingle3DTrackObservationDatabase::Init(const sfmData::SfMData& sfmData,
+                                                             std::shared_ptr<const LandmarksDescriptors> landmarksDescriptors)
+  {
+    if (landmarksDescriptors == nullptr || landmarksDescriptors->isEmpty())
+      return false;
+
+    _landmarksDescriptors = std::move(landmarksDescriptors);
+    _sfmData = &sfmData;
+
+    ALICEVISION_LOG_DEBUG("Retrieval database initialized\n"
+      "#landmark: " << sfmData.getLandmarks().size() << "\n"
+      "#descriptor initialized: " << _landmarksDescriptors->getNbDescriptors());
     return true;
   }
 
@@ -76,11 +80,13 @@ namespace sfm {
                                geometry::Pose3& pose,
                                ImageLocalizerMatchData* resectionDataPtr) const
   {
-    if(_sfmData == nullptr || _matchingInterface == nullptr)
+    if(_sfmData == nullptr || _landmarksDescriptors == nullptr)
       return false;
 
+    // (query feature, landmark) putative matches
     matching::IndMatches putativeMatches;
-    if(!_matchingInterface->Match(0.8, queryRegions, putativeMatches))
+    _landmarksDescriptors->match(queryRegions, 0.8f, putativeMatches);
+    if(putativeMatches.empty())
       return false;
 
     ALICEVISION_LOG_DEBUG("#3D2d putative correspondences: " << putativeMatches.size());
@@ -96,8 +102,8 @@ namespace sfm {
 
     for(std::size_t i = 0; i < putativeMatches.size(); ++i)
     {
-      resectionData.pt3D.col(i) = _sfmData->getLandmarks().at(_indexToLandmarkId[putativeMatches[i]._i]).X;
-      resectionData.pt2D.col(i) = queryRegions.GetRegionPosition(putativeMatches[i]._j);
+      resectionData.pt3D.col(i) = _sfmData->getLandmarks().at(putativeMatches[i]._j).X;
+      resectionData.pt2D.col(i) = queryRegions.GetRegionPosition(putativeMatches[i]._i);
     }
 
     const bool resection =  SfMLocalizer::Localize(imageSize, optionalIntrinsics, randomNumberGenerator, resectionData, pose);
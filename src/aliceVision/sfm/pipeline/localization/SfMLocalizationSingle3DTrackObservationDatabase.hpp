@@ -8,15 +8,18 @@
 #pragma once
 
 #include <aliceVision/sfm/pipeline/localization/SfMLocalizer.hpp>
+#include <aliceVision/sfm/pipeline/localization/LandmarksDescriptors.hpp>
 #include <aliceVision/feature/FeaturesPerView.hpp>
-#include <aliceVision/matching/RegionsMatcher.hpp>
+
+#include <memory>
 
 namespace aliceVision {
 namespace sfm {
 
 // Implementation of a naive method:
 // - init the database of descriptor from the structure and the observations.
-// - create a large array with all the used descriptors and init a Matcher with it
+// - keep a few descriptors per landmark and index them with a kd-tree (see LandmarksDescriptors),
+//   the database can be saved and shared with the other localizers of the scene
 // - to localize an input image compare it's regions to the database and robust estimate
 //   the pose from found 2d-3D correspondences
 
@@ -24,18 +27,36 @@ class SfMLocalizationSingle3DTrackObservationDatabase : public SfMLocalizer
 {
 public:
 
-  SfMLocalizationSingle3DTrackObservationDatabase();
+  /**
+  * @param[in] maxDescriptorsPerLandmark the maximum number of observation descriptors kept by landmark
+  */
+  explicit SfMLocalizationSingle3DTrackObservationDatabase(std::size_t maxDescriptorsPerLandmark = 3);
 
   /**
   * @brief Build the retrieval database (3D points descriptors)
   *
   * @param[in] sfmData the SfM scene that have to be described
-  * @param[in] regionPerView regions provider
+  * @param[in] regionPerView regions provider, the landmarks of the describer type of the first view are used
   * @return True if the database has been correctly setup
   */
   bool Init(const sfmData::SfMData& sfmData,
             const feature::RegionsPerView& regionsPerView) override;
 
+  /**
+  * @brief Setup the retrieval database with already built 3D points descriptors
+  *
+  * @param[in] sfmData the SfM scene described by the landmarks descriptors
+  * @param[in] landmarksDescriptors the landmarks descriptors, loaded from a file or shared with another localizer
+  * @return True if the database has been correctly setup
+  */
+  bool Init(const sfmData::SfMData& sfmData,
+            std::shared_ptr<const LandmarksDescriptors> landmarksDescriptors);
+
+  /// the retrieval database, null before the initialization
+  const std::shared_ptr<const LandmarksDescriptors>& getLandmarksDescriptors() const { return _landmarksDescriptors; }
+
+  std::size_t getMaxDescriptorsPerLandmark() const { return _maxDescriptorsPerLandmark; }
+
   /**
   * @brief Try to localize an image in the database
   *
@@ -58,13 +79,10 @@ public:
 private:
   // Reference to the scene
   const sfmData::SfMData* _sfmData;
-  /// Association of a regions to a landmark observation
-  std::unique_ptr<feature::Regions> _landmarkObservationsDescriptors;
-  /// Association of a track observation to a track Id (used for retrieval)
-  std::vector<IndexT> _indexToLandmarkId;
-  /// A matching interface to find matches between 2D descriptor matches
-  ///  and 3D points observation descriptors
-  std::unique_ptr<matching::RegionsDatabaseMatcher> _matchingInterface;
+  /// The maximum number of descriptors by landmark of the built database
+  std::size_t _maxDescriptorsPerLandmark;
+  /// The 3D points descriptors and the kd-tree to find matches between 2D descriptors and 3D points
+  std::shared_ptr<const LandmarksDescriptors> _landmarksDescriptors;
 };
 
 } // namespace sfm
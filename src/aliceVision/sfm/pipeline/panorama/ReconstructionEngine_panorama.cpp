@@ -37,6 +37,9 @@
 
 #include <dependencies/htmlDoc/htmlDoc.hpp>
 
+#include <memory>
+#include <numeric>
+
 #ifdef _MSC_VER
 #pragma warning( once : 4267 ) //warning C4267: 'argument' : conversion from 'size_t' to 'const int', possible loss of data
 #endif
@@ -492,17 +495,41 @@ void ReconstructionEngine_panorama::Compute_Relative_Rotations(rotationAveraging
     poseWiseMatches[Pair(v1->getPoseId(), v2->getPoseId())].insert(pair);
   }
 
-  sfm::Constraints2D & constraints2d = _sfmData.getConstraints2D();
-  std::map<IndexT, size_t> connection_size;
+  // the pose pairs with the most matches first, so the longest estimations do not end the parallel loop alone
+  std::vector<PoseWiseMatches::const_iterator> poseWiseMatchesIts;
+  std::vector<std::size_t> nbMatchesPerPosePair;
+  poseWiseMatchesIts.reserve(poseWiseMatches.size());
+  for (PoseWiseMatches::const_iterator iter = poseWiseMatches.begin(); iter != poseWiseMatches.end(); ++iter)
+  {
+    std::size_t nbMatches = 0;
+    for (const Pair& pair : iter->second)
+      nbMatches += _pairwiseMatches->at(pair).getNbAllMatches();
+    poseWiseMatchesIts.push_back(iter);
+    nbMatchesPerPosePair.push_back(nbMatches);
+  }
+  std::vector<std::size_t> posePairOrder(poseWiseMatchesIts.size());
+  std::iota(posePairOrder.begin(), posePairOrder.end(), 0);
+  std::stable_sort(posePairOrder.begin(), posePairOrder.end(), [&](std::size_t a, std::size_t b)
+  {
+    return nbMatchesPerPosePair[a] > nbMatchesPerPosePair[b];
+  });
+
+  // the relative rotation and the inlier constraints of each pose pair,
+  // collected in the pose pairs order after the parallel loop
+  std::vector<std::unique_ptr<rotationAveraging::RelativeRotation>> relativeRotationPerPosePair(poseWiseMatchesIts.size());
+  std::vector<sfm::Constraints2D> constraints2dPerPosePair(poseWiseMatchesIts.size());
+
+  // each pair estimation draws its samples from its own generator, seeded from the pose pair index
+  const std::mt19937::result_type pairSeed = _randomNumberGenerator();
 
   ALICEVISION_LOG_INFO("Relative pose computation:");
   // For each pair of matching views, compute the relative pose
-  for (int i = 0; i < poseWiseMatches.size(); ++i)
+  #pragma omp parallel for schedule(dynamic)
+  for (int o = 0; o < posePairOrder.size(); ++o)
   {
+    const std::size_t i = posePairOrder[o];
     {
-      PoseWiseMatches::const_iterator iter (poseWiseMatches.begin());
-      std::advance(iter, i);
-      const auto& relative_pose_iterator(*iter);
+      const auto& relative_pose_iterator(*poseWiseMatchesIts[i]);
       const Pair relative_pose_pair = relative_pose_iterator.first;
       const PairSet& match_pairs = relative_pose_iterator.second;
 
@@ -525,8 +552,8 @@ void ReconstructionEngine_panorama::Compute_Relative_Rotations(rotationAveraging
       const Pair pairIterator = *(match_pairs.begin());
       const IndexT I = pairIterator.first;
       const IndexT J = pairIterator.second;
-      const View* view_I = _sfmData.views[I].get();
-      const View* view_J = _sfmData.views[J].get();
+      const View* view_I = _sfmData.getViews().at(I).get();
+      const View* view_J = _sfmData.getViews().at(J).get();
 
       //Check that valid cameras are existing for the pair of view
       if (_sfmData.getIntrinsics().count(view_I->getIntrinsicId()) == 0 || _sfmData.getIntrinsics().count(view_J->getIntrinsicId()) == 0)
@@ -617,12 +644,13 @@ void ReconstructionEngine_panorama::Compute_Relative_Rotations(rotationAveraging
       // Since we use normalized features, we will use unit image size and intrinsic matrix:
       const std::pair<size_t, size_t> imageSize(1., 1.);
       const Mat3 K  = Mat3::Identity();
+      std::mt19937 pairRandomNumberGenerator(pairSeed + i);
 
       switch(_params.eRelativeRotationMethod)
       {
         case RELATIVE_ROTATION_FROM_E:
         {
-          if(!robustRelativeRotation_fromE(K, K, x1, x2, imageSize, imageSize, _randomNumberGenerator, relativePose_info))
+          if(!robustRelativeRotation_fromE(K, K, x1, x2, imageSize, imageSize, pairRandomNumberGenerator, relativePose_info))
           {
             ALICEVISION_LOG_INFO("Relative pose computation: i: " << i << ", (" << I << ", " << J <<") => FAILED");
             continue;
@@ -635,7 +663,7 @@ void ReconstructionEngine_panorama::Compute_Relative_Rotations(rotationAveraging
           relativeRotation_info._initialResidualTolerance =
                   std::sqrt(cam_I->imagePlaneToCameraPlaneError(2.5) * cam_J->imagePlaneToCameraPlaneError(2.5));
           
-          if(!robustRelativeRotation_fromH(x1, x2, imageSize, imageSize, _randomNumberGenerator, relativeRotation_info))
+          if(!robustRelativeRotation_fromH(x1, x2, imageSize, imageSize, pairRandomNumberGenerator, relativeRotation_info))
           {
             ALICEVISION_LOG_INFO("Relative pose computation: i: " << i << ", (" << I << ", " << J <<") => FAILED");
             continue;
@@ -653,7 +681,7 @@ void ReconstructionEngine_panorama::Compute_Relative_Rotations(rotationAveraging
           relativeRotation_info._initialResidualTolerance =
                   std::sqrt(cam_I->imagePlaneToCameraPlaneError(2.5) * cam_J->imagePlaneToCameraPlaneError(2.5));
           
-          if(!robustRelativeRotation_fromR(x1, x2, imageSize, imageSize, _randomNumberGenerator, relativeRotation_info))
+          if(!robustRelativeRotation_fromR(x1, x2, imageSize, imageSize, pairRandomNumberGenerator, relativeRotation_info))
           {
             ALICEVISION_LOG_INFO("Relative pose computation: i: " << i << ", (" << I << ", " << J <<") => FAILED");
             ALICEVISION_LOG_INFO("I: " << view_I->getImagePath() << ", J: " << view_J->getImagePath());
@@ -692,18 +720,6 @@ void ReconstructionEngine_panorama::Compute_Relative_Rotations(rotationAveraging
         }
       }
 
-      // Add connection to find best constraints
-      if (connection_size.find(I) == connection_size.end())
-      {
-        connection_size[I] = 0;
-      }
-      connection_size[I] += relativePose_info.vec_inliers.size();
-      if (connection_size.find(J) == connection_size.end())
-      {
-        connection_size[J] = 0;
-      }
-      connection_size[J] += relativePose_info.vec_inliers.size();
-
       // Sort all inliers by increasing ids
       if (!relativePose_info.vec_inliers.empty())
       {
@@ -711,6 +727,8 @@ void ReconstructionEngine_panorama::Compute_Relative_Rotations(rotationAveraging
 
           size_t index = 0;
           size_t index_inlier = 0;
+          sfm::Constraints2D& constraints2d = constraints2dPerPosePair[i];
+          constraints2d.reserve(relativePose_info.vec_inliers.size());
 
           for(const auto& match_pair : match_pairs)
           {
@@ -746,16 +764,21 @@ void ReconstructionEngine_panorama::Compute_Relative_Rotations(rotationAveraging
           }
       }
 
-      // #pragma omp critical
-      {
-        // Add the relative rotation to the relative 'rotation' pose graph
-        using namespace aliceVision::rotationAveraging;
-        vec_relatives_R.emplace_back(relative_pose_pair.first, relative_pose_pair.second,
-                                     relativePose_info.relativePose.rotation(), weight);
-      }
+      relativeRotationPerPosePair[i].reset(new rotationAveraging::RelativeRotation(
+        relative_pose_pair.first, relative_pose_pair.second, relativePose_info.relativePose.rotation(), weight));
     }
   } // for all relative pose
 
+  // Add the relative rotations to the relative 'rotation' pose graph and the inliers to the 2D constraints,
+  // in the pose pairs order to keep the result independent of the number of threads
+  sfm::Constraints2D & constraints2d = _sfmData.getConstraints2D();
+  for (std::size_t i = 0; i < poseWiseMatchesIts.size(); ++i)
+  {
+    if (relativeRotationPerPosePair[i])
+      vec_relatives_R.push_back(*relativeRotationPerPosePair[i]);
+    constraints2d.insert(constraints2d.end(), constraints2dPerPosePair[i].begin(), constraints2dPerPosePair[i].end());
+  }
+
   // Debug result
   ALICEVISION_LOG_DEBUG("Compute_Relative_Rotations: vec_relatives_R.size(): " << vec_relatives_R.size());
   for(rotationAveraging::RelativeRotation& rotation: vec_relatives_R)
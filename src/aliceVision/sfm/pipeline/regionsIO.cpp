@@ -20,6 +20,76 @@ namespace sfm {
 
 using namespace sfmData;
 
+std::unique_ptr<feature::RegionsPackReader> openRegionsPack(const std::vector<std::string>& folders, feature::EImageDescriberType imageDescriberType)
+{
+  std::unique_ptr<feature::RegionsPackReader> regionsPack;
+
+  for(const std::string& folder : folders)
+  {
+    const std::string packPath = feature::getRegionsPackPath(folder, imageDescriberType);
+    if(fs::exists(packPath))
+      regionsPack.reset(new feature::RegionsPackReader(packPath));
+  }
+
+  if(regionsPack)
+    ALICEVISION_LOG_DEBUG("Regions pack: " << regionsPack->getFilepath() << " (" << regionsPack->getNbViews() << " views)");
+
+  return regionsPack;
+}
+
+/**
+ * @brief Load regions or features of one view from a regions pack.
+ */
+std::unique_ptr<feature::Regions> loadFromRegionsPack(const feature::RegionsPackReader& regionsPack,
+                                                      IndexT viewId,
+                                                      const feature::ImageDescriber& imageDescriber,
+                                                      bool onlyFeatures)
+{
+  std::unique_ptr<feature::Regions> regionsPtr;
+  imageDescriber.allocate(regionsPtr);
+
+  try
+  {
+    if(onlyFeatures)
+      regionsPack.loadFeatures(viewId, *regionsPtr);
+    else
+      regionsPack.loadRegions(viewId, *regionsPtr);
+  }
+  catch(const std::exception& e)
+  {
+    std::stringstream ss;
+    ss << "Invalid " << feature::EImageDescriberType_enumToString(imageDescriber.getDescriberType()) << " regions for the view " << viewId << " : \n";
+    ss << "\t- Regions pack : " << regionsPack.getFilepath() << "\n";
+    ss << "\t  " << e.what() << "\n";
+    ALICEVISION_LOG_ERROR(ss.str());
+
+    throw std::runtime_error(e.what());
+  }
+
+  ALICEVISION_LOG_TRACE("Region count: " << regionsPtr->RegionCount());
+  return regionsPtr;
+}
+
+std::unique_ptr<feature::Regions> loadRegions(const std::vector<std::string>& folders,
+                                              IndexT viewId,
+                                              const feature::ImageDescriber& imageDescriber,
+                                              const feature::RegionsPackReader* regionsPack)
+{
+  if(regionsPack != nullptr && regionsPack->hasView(viewId))
+    return loadFromRegionsPack(*regionsPack, viewId, imageDescriber, false);
+  return loadRegions(folders, viewId, imageDescriber);
+}
+
+std::unique_ptr<feature::Regions> loadFeatures(const std::vector<std::string>& folders,
+                                               IndexT viewId,
+                                               const feature::ImageDescriber& imageDescriber,
+                                               const feature::RegionsPackReader* regionsPack)
+{
+  if(regionsPack != nullptr && regionsPack->hasView(viewId))
+    return loadFromRegionsPack(*regionsPack, viewId, imageDescriber, true);
+  return loadFeatures(folders, viewId, imageDescriber);
+}
+
 std::unique_ptr<feature::Regions> loadRegions(const std::vector<std::string>& folders,
                                               IndexT viewId,
                                               const feature::ImageDescriber& imageDescriber)
@@ -45,7 +115,13 @@ std::unique_ptr<feature::Regions> loadRegions(const std::vector<std::string>& fo
   }
 
   if(featFilename.empty() || descFilename.empty())
+  {
+    const std::unique_ptr<feature::RegionsPackReader> regionsPack = openRegionsPack(folders, imageDescriber.getDescriberType());
+    if(regionsPack && regionsPack->hasView(viewId))
+      return loadFromRegionsPack(*regionsPack, viewId, imageDescriber, false);
+
     throw std::runtime_error("Can't find view " + basename + " region files");
+  }
 
   ALICEVISION_LOG_TRACE("Features filename: "    << featFilename);
   ALICEVISION_LOG_TRACE("Descriptors filename: " << descFilename);
@@ -102,7 +178,14 @@ std::unique_ptr<feature::Regions> loadFeatures(const std::vector<std::string>& f
   }
 
   if(featFilename.empty())
+  {
+    const std::vector<std::string> foldersList(foldersSet.begin(), foldersSet.end());
+    const std::unique_ptr<feature::RegionsPackReader> regionsPack = openRegionsPack(foldersList, imageDescriber.getDescriberType());
+    if(regionsPack && regionsPack->hasView(viewId))
+      return loadFromRegionsPack(*regionsPack, viewId, imageDescriber, true);
+
     throw std::runtime_error("Can't find view " + basename + " features file");
+  }
 
   ALICEVISION_LOG_TRACE("Features filename: " << featFilename);
 
@@ -163,12 +246,14 @@ bool loadFeaturesPerDescPerView(std::vector<std::vector<std::unique_ptr<feature:
     std::vector<std::unique_ptr<feature::Regions>>& featuresPerView = featuresPerDescPerView.at(descIdx);
     featuresPerView.resize(viewIds.size());
 
+    const std::unique_ptr<feature::RegionsPackReader> regionsPack = openRegionsPack(folders, imageDescriberTypes.at(descIdx));
+
 #pragma omp parallel for
     for(int viewIdx = 0; viewIdx < viewIds.size(); ++viewIdx)
     {
       try
       {
-        featuresPerView.at(viewIdx) = loadFeatures(folders, viewIds.at(viewIdx), *imageDescribers.at(descIdx));
+        featuresPerView.at(viewIdx) = loadFeatures(folders, viewIds.at(viewIdx), *imageDescribers.at(descIdx), regionsPack.get());
       }
       catch(const std::exception& e)
       {
@@ -200,8 +285,13 @@ bool loadRegionsPerView(feature::RegionsPerView& regionsPerView,
   std::vector<std::unique_ptr<feature::ImageDescriber>> imageDescribers;
   imageDescribers.resize(imageDescriberTypes.size());
 
+  std::vector<std::unique_ptr<feature::RegionsPackReader>> regionsPacks(imageDescriberTypes.size());
+
   for(std::size_t i = 0; i < imageDescriberTypes.size(); ++i)
+  {
     imageDescribers.at(i) = createImageDescriber(imageDescriberTypes.at(i));
+    regionsPacks.at(i) = openRegionsPack(featuresFolders, imageDescriberTypes.at(i));
+  }
 
 #pragma omp parallel num_threads(3)
  for(auto iter = sfmData.getViews().begin(); iter != sfmData.getViews().end() && !invalid; ++iter)
@@ -212,7 +302,7 @@ bool loadRegionsPerView(feature::RegionsPerView& regionsPerView,
      {
        if(viewIdFilter.empty() || viewIdFilter.find(iter->second.get()->getViewId()) != viewIdFilter.end())
        {
-         std::unique_ptr<feature::Regions> regionsPtr = loadRegions(featuresFolders, iter->second.get()->getViewId(), *(imageDescribers.at(i)));
+         std::unique_ptr<feature::Regions> regionsPtr = loadRegions(featuresFolders, iter->second.get()->getViewId(), *(imageDescribers.at(i)), regionsPacks.at(i).get());
          if(regionsPtr)
          {
 #pragma omp critical
@@ -250,8 +340,13 @@ bool loadFeaturesPerView(feature::FeaturesPerView& featuresPerView,
   std::vector< std::unique_ptr<feature::ImageDescriber> > imageDescribers;
   imageDescribers.resize(imageDescriberTypes.size());
 
+  std::vector<std::unique_ptr<feature::RegionsPackReader>> regionsPacks(imageDescriberTypes.size());
+
   for(std::size_t i = 0; i < imageDescriberTypes.size(); ++i)
+  {
     imageDescribers.at(i) = createImageDescriber(imageDescriberTypes.at(i));
+    regionsPacks.at(i) = openRegionsPack(featuresFolders, imageDescriberTypes.at(i));
+  }
 
 #pragma omp parallel
   for (auto iter = sfmData.getViews().begin(); (iter != sfmData.getViews().end()) && (!invalid); ++iter)
@@ -260,7 +355,7 @@ bool loadFeaturesPerView(feature::FeaturesPerView& featuresPerView,
     {
       for(std::size_t i = 0; i < imageDescriberTypes.size(); ++i)
       {
-        std::unique_ptr<feature::Regions> regionsPtr = loadFeatures(featuresFolders, iter->second.get()->getViewId(), *imageDescribers.at(i));
+        std::unique_ptr<feature::Regions> regionsPtr = loadFeatures(featuresFolders, iter->second.get()->getViewId(), *imageDescribers.at(i), regionsPacks.at(i).get());
 
 #pragma omp critical
         {
@@ -13,14 +13,24 @@
 #include <aliceVision/feature/imageDescriberCommon.hpp>
 #include <aliceVision/feature/RegionsPerView.hpp>
 #include <aliceVision/feature/FeaturesPerView.hpp>
+#include <aliceVision/feature/RegionsPack.hpp>
 
 #include <memory>
 
 namespace aliceVision {
 namespace sfm {
 
+/**
+ * @brief Open the regions pack of the given describer type if one of the folders contains it.
+ * @param[in] folders The list of featureFolders
+ * @param[in] imageDescriberType The imageDescriber type
+ * @return the regions pack reader or nullptr if there is no regions pack
+ */
+std::unique_ptr<feature::RegionsPackReader> openRegionsPack(const std::vector<std::string>& folders, feature::EImageDescriberType imageDescriberType);
+
 /**
  * @brief Load Regions (Features & Descriptors) for one view.
+ * @note If the per-view regions files are not found, the regions pack is used (if any).
  * @param[in] folders The list of featureFolders
  * @param[in] viewId The view id
  * @param[in] imageDescriber The imageDescriber type
@@ -28,6 +38,18 @@ namespace sfm {
  */
 std::unique_ptr<feature::Regions> loadRegions(const std::vector<std::string>& folders, IndexT viewId, const feature::ImageDescriber& imageDescriber);
 
+/**
+ * @brief Load Regions (Features & Descriptors) for one view from an opened regions pack
+ *        or from the per-view regions files if the view is not in the regions pack.
+ * @param[in] folders The list of featureFolders
+ * @param[in] viewId The view id
+ * @param[in] imageDescriber The imageDescriber type
+ * @param[in] regionsPack The regions pack of the imageDescriber type (could be nullptr)
+ * @return loaded Regions
+ */
+std::unique_ptr<feature::Regions> loadRegions(const std::vector<std::string>& folders, IndexT viewId, const feature::ImageDescriber& imageDescriber,
+                                              const feature::RegionsPackReader* regionsPack);
+
 /**
  * @brief Load Features for one view.
  * @param[in] folders The list of featureFolders
@@ -37,6 +59,18 @@ std::unique_ptr<feature::Regions> loadRegions(const std::vector<std::string>& fo
  */
 std::unique_ptr<feature::Regions> loadFeatures(const std::vector<std::string>& folders, IndexT viewId, const feature::ImageDescriber& imageDescriber);
 
+/**
+ * @brief Load Features for one view from an opened regions pack
+ *        or from the per-view features file if the view is not in the regions pack.
+ * @param[in] folders The list of featureFolders
+ * @param[in] viewId The view id
+ * @param[in] imageDescriber The imageDescriber type
+ * @param[in] regionsPack The regions pack of the imageDescriber type (could be nullptr)
+ * @return loaded Regions (with only features)
+ */
+std::unique_ptr<feature::Regions> loadFeatures(const std::vector<std::string>& folders, IndexT viewId, const feature::ImageDescriber& imageDescriber,
+                                               const feature::RegionsPackReader* regionsPack);
+
 /**
  * @brief Load Features for each given view.
  * @param[in,out] featuresPerDescPerView
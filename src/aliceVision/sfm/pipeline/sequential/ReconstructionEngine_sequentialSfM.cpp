@@ -10,6 +10,7 @@
 #include <aliceVision/sfm/utils/statistics.hpp>
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
 #include <aliceVision/sfm/BundleAdjustmentCeres.hpp>
+#include <aliceVision/sfm/BundleAdjustmentPartitioned.hpp>
 #include <aliceVision/sfm/BundleAdjustmentSymbolicCeres.hpp>
 #include <aliceVision/sfm/sfmFilters.hpp>
 #include <aliceVision/sfm/sfmStatistics.hpp>
@@ -20,6 +21,7 @@
 #include <aliceVision/multiview/essential.hpp>
 #include <aliceVision/multiview/triangulation/triangulationDLT.hpp>
 #include <aliceVision/multiview/triangulation/Triangulation.hpp>
+#include <aliceVision/multiview/triangulation/TriangulationBatch.hpp>
 #include <aliceVision/multiview/triangulation/NViewsTriangulationLORansac.hpp>
 #include <aliceVision/robustEstimation/LORansac.hpp>
 #include <aliceVision/robustEstimation/ScoreEvaluator.hpp>
@@ -40,6 +42,10 @@
 #include <tuple>
 #include <iostream>
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
 
 #ifdef _MSC_VER
 #pragma warning( once : 4267 ) //warning C4267: 'argument' : conversion from 'size_t' to 'const int', possible loss of data
@@ -54,6 +60,22 @@ using namespace aliceVision::geometry;
 using namespace aliceVision::camera;
 using namespace aliceVision::sfmData;
 
+namespace {
+
+const char checkpointMagic[8] = {'A', 'V', 'S', 'F', 'M', 'C', 'K', 'P'};
+const std::uint32_t checkpointVersion = 1;
+
+const sfmDataIO::ESfMData checkpointSfMDataParts = sfmDataIO::ESfMData(
+  sfmDataIO::VIEWS |
+  sfmDataIO::EXTRINSICS |
+  sfmDataIO::INTRINSICS |
+  sfmDataIO::STRUCTURE |
+  sfmDataIO::OBSERVATIONS |
+  sfmDataIO::OBSERVATIONS_WITH_FEATURES |
+  sfmDataIO::CONTROL_POINTS);
+
+} // namespace
+
 /**
  * @brief Compute indexes of all features in a fixed size pyramid grid.
  * These precomputed values are useful to the next best view selection for incremental SfM.
@@ -134,9 +156,11 @@ ReconstructionEngine_sequentialSfM::ReconstructionEngine_sequentialSfM(
   : ReconstructionEngine(sfmData, outputFolder),
     _params(params),
     _htmlLogFile(loggingFile),
-    _sfmStepFolder((fs::path(outputFolder) / "intermediate_steps").string())
+    _sfmStepFolder((fs::path(outputFolder) / "intermediate_steps").string()),
+    _checkpointFolder((fs::path(outputFolder) / "checkpoint").string())
 {
-  if (_params.useLocalBundleAdjustment)
+  // the sliding window uses the states of the local BA graph to restrict the adjustment
+  if (_params.useLocalBundleAdjustment || _params.slidingWindowSize > 0)
   {
     _localStrategyGraph = std::make_shared<LocalBundleAdjustmentGraph>(_sfmData);
     if (_params.useLocalBundleAdjustment)
@@ -167,6 +191,8 @@ bool ReconstructionEngine_sequentialSfM::process()
     throw std::runtime_error("No valid tracks.");
   }
 
+  const bool isResumed = _params.resumeFromCheckpoint && loadCheckpoint();
+
   if (!_sfmData.getLandmarks().empty())
   {
       if (_sfmData.getPoses().empty())
@@ -195,7 +221,7 @@ bool ReconstructionEngine_sequentialSfM::process()
     std::vector<Pair> initialImagePairCandidates = getInitialImagePairsCandidates();
     createInitialReconstruction(initialImagePairCandidates);
   }
-  else
+  else if(!isResumed)
   {
     // If we don't have any landmark, we need to triangulate them from the known poses.
     // But even if we already have landmarks, we need to try to triangulate new points with the current set of parameters.
@@ -212,7 +238,9 @@ bool ReconstructionEngine_sequentialSfM::process()
   }
 
   // reconstruction
+  _checkpointTimer.reset();
   const double elapsedTime = incrementalReconstruction();
+  _checkpointGroup.wait();
 
   exportStatistics(elapsedTime);
 
@@ -341,6 +369,8 @@ void ReconstructionEngine_sequentialSfM::createInitialReconstruction(const std::
 
 void ReconstructionEngine_sequentialSfM::registerChanges(const std::set<IndexT>& newReconstructedViews)
 {
+   updateCandidateScores();
+
    _registeredCandidatesViews.clear();
 
   const sfmData::Landmarks & landmarks = _sfmData.getLandmarks();
@@ -378,6 +408,82 @@ void ReconstructionEngine_sequentialSfM::registerChanges(const std::set<IndexT>&
   }
 }
 
+void ReconstructionEngine_sequentialSfM::updateCandidateScores()
+{
+  const sfmData::Landmarks& landmarks = _sfmData.getLandmarks();
+
+  std::size_t nbCells = 0;
+  for(std::size_t level = 0; level < _params.pyramidDepth; ++level)
+    nbCells += Square(std::pow(_params.pyramidBase, level + 1));
+
+  // add (step = 1) or remove (step = -1) a track from the scores of the views observing it
+  const auto updateTrack = [&](std::size_t trackId, int step)
+  {
+    const auto trackIt = _map_tracks.find(trackId);
+    if(trackIt == _map_tracks.end())
+      return;
+
+    for(const auto& featPerView : trackIt->second.featPerView)
+    {
+      const IndexT viewId = featPerView.first;
+      CandidateScore& candidateScore = _candidateScores[viewId];
+      if(candidateScore.nbTracksPerCell.empty())
+      {
+        candidateScore.nbTracksPerCell.assign(nbCells, 0);
+        candidateScore.nbFilledCellsPerLevel.assign(_params.pyramidDepth, 0);
+      }
+
+      candidateScore.nbTracks += step;
+
+      const auto& featsPyramid = _map_featsPyramidPerView.at(viewId);
+      for(std::size_t level = 0; level < _params.pyramidDepth; ++level)
+      {
+        unsigned int& nbTracksInCell = candidateScore.nbTracksPerCell.at(featsPyramid.at(trackId * _params.pyramidDepth + level));
+
+        if(step > 0 && nbTracksInCell++ == 0)
+          ++candidateScore.nbFilledCellsPerLevel[level];
+        else if(step < 0 && --nbTracksInCell == 0)
+          --candidateScore.nbFilledCellsPerLevel[level];
+      }
+    }
+  };
+
+  // the tracks are indexed by id, the landmarks ids are the tracks ids
+  if(_isTrackScored.empty() && !_map_tracks.empty())
+    _isTrackScored.assign(_map_tracks.rbegin()->first + 1, false);
+
+  // added landmarks
+  std::size_t nbAddedTracks = 0;
+  std::size_t nbLandmarkTracks = 0;
+  for(const auto& landmarkPair : landmarks)
+  {
+    const std::size_t trackId = landmarkPair.first;
+    if(trackId >= _isTrackScored.size())
+      continue;
+    ++nbLandmarkTracks;
+    if(_isTrackScored[trackId])
+      continue;
+    _isTrackScored[trackId] = true;
+    ++_nbScoredTracks;
+    updateTrack(trackId, 1);
+    ++nbAddedTracks;
+  }
+
+  // removed landmarks, only searched if some scored tracks are not landmarks anymore
+  std::size_t nbRemovedTracks = 0;
+  for(std::size_t trackId = 0; trackId < _isTrackScored.size() && _nbScoredTracks > nbLandmarkTracks; ++trackId)
+  {
+    if(!_isTrackScored[trackId] || landmarks.find(trackId) != landmarks.end())
+      continue;
+    _isTrackScored[trackId] = false;
+    --_nbScoredTracks;
+    updateTrack(trackId, -1);
+    ++nbRemovedTracks;
+  }
+
+  ALICEVISION_LOG_DEBUG("Update candidate scores: " << nbAddedTracks << " added and " << nbRemovedTracks << " removed tracks.");
+}
+
 void ReconstructionEngine_sequentialSfM::remapLandmarkIdsToTrackIds()
 {
   using namespace track;
@@ -482,15 +588,57 @@ double ReconstructionEngine_sequentialSfM::incrementalReconstruction()
     ALICEVISION_LOG_INFO(ss.str());
   }
 
+  if(_params.slidingWindowSize > 0)
+  {
+    computeSequenceOrder();
+
+    // start the window with the last resected views
+    std::vector<std::pair<IndexT, std::size_t>> reconstructedViews;
+    for(const IndexT viewId : _sfmData.getValidViews())
+      reconstructedViews.emplace_back(_sfmData.getView(viewId).getResectionId(), _sequencePositionPerViewId.at(viewId));
+    std::sort(reconstructedViews.begin(), reconstructedViews.end());
+    _slidingWindowViewIds.clear();
+    for(const auto& reconstructedView : reconstructedViews)
+      updateSlidingWindow({_sequenceViewIds.at(reconstructedView.second)});
+    ALICEVISION_LOG_INFO("Sliding window of " << _params.slidingWindowSize << " views, bundle adjustment of the whole scene every "
+                         << _params.slidingWindowGlobalBAInterval << " resected views.");
+  }
+
   aliceVision::system::Timer timer;
   std::size_t nbValidPoses = 0;
   std::size_t globalIteration = 0;
 
-  do
+  // compute the intersection of available views and views with potential changes,
+  // restricted to the neighborhood of the sliding window in the sequence if possible
+  const auto updateCandidateViewIds = [&]()
   {
-     //Compute intersection of available views and views with potential changes
     candidateViewIds.clear();
+    if(_params.slidingWindowSize > 0)
+    {
+      getSlidingWindowCandidates(remainingViewIds, candidateViewIds);
+      if(!candidateViewIds.empty())
+        return;
+    }
     std::set_intersection(remainingViewIds.begin(), remainingViewIds.end(), _registeredCandidatesViews.begin(), _registeredCandidatesViews.end(), std::inserter(candidateViewIds, candidateViewIds.end()));
+  };
+
+  // when the sequence is lost around the sliding window, relocalize the next views against the whole scene
+  const auto resetSlidingWindow = [&]()
+  {
+    if(_params.slidingWindowSize == 0 || _slidingWindowViewIds.empty())
+      return false;
+    ALICEVISION_LOG_INFO("No view can be resected around the sliding window, search the next views in the whole scene.");
+    _slidingWindowViewIds.clear();
+    updateCandidateViewIds();
+    return true;
+  };
+
+  do
+  {
+    updateCandidateViewIds();
+
+    // the rig calibration of the previous iteration can change the landmarks
+    updateCandidateScores();
 
     nbValidPoses = _sfmData.getPoses().size();
     ALICEVISION_LOG_INFO("Incremental Reconstruction start iteration " << globalIteration << ":" << std::endl
@@ -501,7 +649,8 @@ double ReconstructionEngine_sequentialSfM::incrementalReconstruction()
                          );
 
     // compute robust resection of remaining images
-    while (findNextBestViews(bestViewCandidates, candidateViewIds))
+    while (findNextBestViews(bestViewCandidates, candidateViewIds) ||
+           (resetSlidingWindow() && findNextBestViews(bestViewCandidates, candidateViewIds)))
     {
       ALICEVISION_LOG_INFO("Update Reconstruction:" << std::endl
         << "\t- resection id: " << resectionId << std::endl
@@ -514,12 +663,15 @@ double ReconstructionEngine_sequentialSfM::incrementalReconstruction()
       std::set<IndexT> newReconstructedViews = resection(resectionId, bestViewCandidates, prevReconstructedViews, candidateViewIds);
       if(newReconstructedViews.empty())
       {
-        candidateViewIds.clear();
+        if(!resetSlidingWindow())
+          candidateViewIds.clear();
         continue;
       }
 
 
       triangulate(prevReconstructedViews, newReconstructedViews);
+      if(_params.slidingWindowSize > 0)
+        updateSlidingWindow(newReconstructedViews);
       bundleAdjustment(newReconstructedViews);
 
 
@@ -532,9 +684,7 @@ double ReconstructionEngine_sequentialSfM::incrementalReconstruction()
       //Compute the connected views to inform we have new information !
       registerChanges(newReconstructedViews);
 
-      //Compute intersection of available views and views with potential changes
-      candidateViewIds.clear();
-      std::set_intersection(remainingViewIds.begin(), remainingViewIds.end(), _registeredCandidatesViews.begin(), _registeredCandidatesViews.end(), std::inserter(candidateViewIds, candidateViewIds.end()));
+      updateCandidateViewIds();
 
       // scene logging for visual debug
       if((resectionId % 3) == 0)
@@ -547,6 +697,12 @@ double ReconstructionEngine_sequentialSfM::incrementalReconstruction()
       }
 
       ++resectionId;
+
+      if(_params.checkpointInterval > 0.0 && _checkpointTimer.elapsed() >= _params.checkpointInterval)
+      {
+        saveCheckpoint();
+        _checkpointTimer.reset();
+      }
     }
 
     if(_params.rig.useRigConstraint && !_sfmData.getRigs().empty())
@@ -575,6 +731,15 @@ double ReconstructionEngine_sequentialSfM::incrementalReconstruction()
   }
   while(nbValidPoses != _sfmData.getPoses().size());
 
+  if(_params.slidingWindowSize > 0 && _nbViewsSinceGlobalBA > 0)
+  {
+    // the last poses have only been refined in the sliding window
+    ALICEVISION_LOG_INFO("Final bundle adjustment of the whole scene.");
+    std::set<IndexT> noNewViews;
+    _slidingWindowViewIds.clear();
+    bundleAdjustment(noNewViews);
+  }
+
   ALICEVISION_LOG_INFO("Incremental Reconstruction completed with " << globalIteration << " iterations:" << std::endl
                        << "\t- # number of resection groups: " << resectionId << std::endl
                        << "\t- # number of poses: " << nbValidPoses << std::endl
@@ -592,68 +757,100 @@ double ReconstructionEngine_sequentialSfM::incrementalReconstruction()
 {
   auto chrono_start = std::chrono::steady_clock::now();
 
-  // add images to the 3D reconstruction
-#pragma omp parallel for
+  // a view part of a rig can only be localized if its rig pose or its sub-pose is known
+  const auto canBeResected = [&](const View& view, const char* message)
+  {
+    if(!view.isPartOfRig())
+      return true;
+
+    // some views can become indirectly localized when the sub-pose becomes defined
+    if(_sfmData.isPoseAndIntrinsicDefined(view.getViewId()))
+    {
+      ALICEVISION_LOG_DEBUG("Resection of view " << view.getViewId() << " " << message << "." << std::endl
+        << "View indirectly localized, sub-pose and pose already defined." << std::endl
+        << "\t- rig id: " << view.getRigId() << std::endl
+        << "\t- sub-pose id: " << view.getSubPoseId());
+      return false;
+    }
+
+    // we cannot localize a view if it is part of an initialized rig with unknown rig pose and unknown sub-pose
+    const bool knownPose = _sfmData.existsPose(view);
+    const Rig& rig = _sfmData.getRig(view);
+    const RigSubPose& subpose = rig.getSubPose(view.getSubPoseId());
+
+    if(rig.isInitialized() && !knownPose && (subpose.status == ERigSubPoseStatus::UNINITIALIZED))
+    {
+      ALICEVISION_LOG_DEBUG("Resection of view " << view.getViewId() << " " << message << "." << std::endl
+        << "Rig initialized but unkown pose and sub-pose." << std::endl
+        << "\t- rig id: " << view.getRigId() << std::endl
+        << "\t- sub-pose id: " << view.getSubPoseId());
+      return false;
+    }
+    return true;
+  };
+
+  // draw one seed per view to keep the result independent of the number of threads
+  std::vector<std::mt19937::result_type> seeds(bestViewIds.size());
+  for(auto& seed : seeds)
+    seed = _randomNumberGenerator();
+
+  // A. resect all the candidate views in parallel against the current scene,
+  //    the scene is not modified until all the resections are done
+  std::vector<ResectionData> resectionsData(bestViewIds.size());
+  std::vector<char> hasResected(bestViewIds.size(), false);
+
+#pragma omp parallel for schedule(dynamic)
   for(int i = 0; i < bestViewIds.size(); ++i)
   {
     const IndexT viewId = bestViewIds.at(i);
     const View& view = *_sfmData.getViews().at(viewId);
 
-    if(view.isPartOfRig())
+    if(!canBeResected(view, "was skipped"))
     {
-      // some views can become indirectly localized when the sub-pose becomes defined
-      if(_sfmData.isPoseAndIntrinsicDefined(view.getViewId()))
-      {
-        ALICEVISION_LOG_DEBUG("Resection of image " << i << " was skipped." << std::endl
-          << "View indirectly localized, sub-pose and pose already defined." << std::endl
-          << "\t- view id: " << viewId << std::endl
-          << "\t- rig id: " << view.getRigId() << std::endl
-          << "\t- sub-pose id: " << view.getSubPoseId());
-
 #pragma omp critical
-        remainingViewIds.erase(viewId);
+      remainingViewIds.erase(viewId);
 
-        continue;
-      }
+      continue;
+    }
 
-      // we cannot localize a view if it is part of an initialized rig with unknown rig pose and unknown sub-pose
-      const bool knownPose = _sfmData.existsPose(view);
-      const Rig& rig = _sfmData.getRig(view);
-      const RigSubPose& subpose = rig.getSubPose(view.getSubPoseId());
+    ResectionData& resectionData = resectionsData.at(i);
+    resectionData.error_max = _params.localizerEstimatorError;
+    resectionData.max_iteration = _params.localizerEstimatorMaxIterations;
 
-      if(rig.isInitialized() && !knownPose && (subpose.status == ERigSubPoseStatus::UNINITIALIZED))
-      {
-        ALICEVISION_LOG_DEBUG("Resection of image " << i << " was skipped." << std::endl
-          << "Rig initialized but unkown pose and sub-pose." << std::endl
-          << "\t- view id: " << viewId << std::endl
-          << "\t- rig id: " << view.getRigId() << std::endl
-          << "\t- sub-pose id: " << view.getSubPoseId());
+    std::mt19937 randomNumberGenerator(seeds.at(i));
+    hasResected.at(i) = computeResection(viewId, resectionData, randomNumberGenerator);
 
-#pragma omp critical
-        remainingViewIds.erase(viewId);
+    if(!hasResected.at(i))
+      ALICEVISION_LOG_DEBUG("Resection of image " << i << " ( view id: " << viewId << " ) was not possible.");
+  }
 
-        continue;
-      }
-    }
+  // B. commit the accepted views in one pass, in the candidates order
+  std::set<IndexT> updatedIntrinsics;
+  for(int i = 0; i < bestViewIds.size(); ++i)
+  {
+    const IndexT viewId = bestViewIds.at(i);
+    View& view = *_sfmData.getViews().at(viewId);
 
-    ResectionData newResectionData;
-    newResectionData.error_max = _params.localizerEstimatorError;
-    newResectionData.max_iteration = _params.localizerEstimatorMaxIterations;
-    const bool hasResected = computeResection(viewId, newResectionData);
+    if(!hasResected.at(i))
+      continue;
 
-#pragma omp critical
+    // a previously committed view of the same rig can define the pose of this view
+    if(!canBeResected(view, "was not committed"))
     {
-      if(hasResected)
-      {
-        updateScene(viewId, newResectionData);
-        ALICEVISION_LOG_DEBUG("Resection of image " << i << " ( view id: " << viewId << " ) succeed.");
-        _sfmData.getViews().at(viewId)->setResectionId(resectionId);
-      }
-      else
-      {
-        ALICEVISION_LOG_DEBUG("Resection of image " << i << " ( view id: " << viewId << " ) was not possible.");
-      }
+      remainingViewIds.erase(viewId);
+      continue;
     }
+
+    ResectionData& resectionData = resectionsData.at(i);
+
+    // the resection is done on a copy of the intrinsic,
+    // the first accepted view of the batch initializes the scene intrinsic
+    if(resectionData.isRefinedIntrinsic && updatedIntrinsics.insert(view.getIntrinsicId()).second)
+      _sfmData.getIntrinsicPtr(view.getIntrinsicId())->assign(*resectionData.optionalIntrinsic);
+
+    updateScene(viewId, resectionData);
+    view.setResectionId(resectionId);
+    ALICEVISION_LOG_DEBUG("Resection of image " << i << " ( view id: " << viewId << " ) succeed.");
   }
 
   ALICEVISION_LOG_DEBUG("Resection of " << bestViewIds.size() << " new images took " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - chrono_start).count() << " msec.");
@@ -704,8 +901,30 @@ bool ReconstructionEngine_sequentialSfM::bundleAdjustment(std::set<IndexT>& newR
   std::size_t nbOutliers = 0;
   bool enableLocalStrategy = false;
 
+  // refine the sliding window only, except periodically to distribute the drift over the whole scene
+  bool enableWindowStrategy = false;
+  if(_params.slidingWindowSize > 0 && !isInitialPair)
+  {
+    _nbViewsSinceGlobalBA += newReconstructedViews.size();
+    if(_slidingWindowViewIds.empty() ||
+       (_params.slidingWindowGlobalBAInterval > 0 && _nbViewsSinceGlobalBA >= _params.slidingWindowGlobalBAInterval))
+    {
+      ALICEVISION_LOG_INFO("Bundle adjustment of the whole scene (" << _nbViewsSinceGlobalBA << " views resected since the last one).");
+      _nbViewsSinceGlobalBA = 0;
+    }
+    else
+    {
+      enableWindowStrategy = true;
+    }
+  }
+
   // enable Sparse solver and local strategy
-  if(_sfmData.getPoses().size() > 100)
+  if(enableWindowStrategy)
+  {
+    options.setSparseBA();
+    enableLocalStrategy = true;
+  }
+  else if(_sfmData.getPoses().size() > 100)
   {
     options.setSparseBA();
     if(_params.useLocalBundleAdjustment) // local strategy enable if more than 100 poses
@@ -716,12 +935,25 @@ bool ReconstructionEngine_sequentialSfM::bundleAdjustment(std::set<IndexT>& newR
     options.setDenseBA();
   }
 
+  options.useGPU = _params.useGPUBundleAdjustment;
+
   // add the new reconstructed views to the graph
   if(_params.useLocalBundleAdjustment)
     _localStrategyGraph->updateGraphWithNewViews(_sfmData, _map_tracksPerView, newReconstructedViews, _params.kMinNbOfMatches);
 
 
-  if(enableLocalStrategy)
+  if(enableWindowStrategy)
+  {
+    _localStrategyGraph->setWindowStates(_sfmData, _map_tracksPerView, std::set<IndexT>(_slidingWindowViewIds.begin(), _slidingWindowViewIds.end()));
+
+    const std::size_t nbRefinedPoses = _localStrategyGraph->getNbPosesPerState(BundleAdjustment::EParameterState::REFINED);
+    const std::size_t nbConstantPoses = _localStrategyGraph->getNbPosesPerState(BundleAdjustment::EParameterState::CONSTANT);
+    if(nbRefinedPoses + nbConstantPoses <= 20)
+      options.setDenseBA();
+
+    ALICEVISION_LOG_INFO("Sliding window bundle adjustment: " << nbRefinedPoses << " refined poses, " << nbConstantPoses << " constant poses.");
+  }
+  else if(enableLocalStrategy)
   {
     // compute the graph-distance between each newly reconstructed views and all the reconstructed views
     _localStrategyGraph->computeGraphDistances(_sfmData, newReconstructedViews);
@@ -747,11 +979,22 @@ bool ReconstructionEngine_sequentialSfM::bundleAdjustment(std::set<IndexT>& newR
     }
   }
 
-  BundleAdjustmentCeres BA(options, _params.minNbCamerasToRefinePrincipalPoint);
+  if(_bundleAdjustment == nullptr || !_params.reuseBundleAdjustmentProblem)
+  {
+    _bundleAdjustment.reset(new BundleAdjustmentCeres(options, _params.minNbCamerasToRefinePrincipalPoint));
+    _bundleAdjustment->setIncrementalProblem(_params.reuseBundleAdjustmentProblem);
+  }
+  else
+  {
+    // keep the loss function referenced by the problem of the previous adjustment
+    options.lossFunction = _bundleAdjustment->getCeresOptions().lossFunction;
+    _bundleAdjustment->setCeresOptions(options);
+  }
+
+  BundleAdjustmentCeres& BA = *_bundleAdjustment;
 
   // give the local strategy graph is local strategy is enable
-  if(enableLocalStrategy)
-    BA.useLocalStrategyGraph(_localStrategyGraph);
+  BA.useLocalStrategyGraph(enableLocalStrategy ? _localStrategyGraph : nullptr);
 
   // perform BA until all point are under the given precision
   do
@@ -761,7 +1004,23 @@ bool ReconstructionEngine_sequentialSfM::bundleAdjustment(std::set<IndexT>& newR
 
     // bundle adjustment iteration
     {
-      const bool success = BA.adjust(_sfmData, refineOptions);
+      // the local strategy already bounds the problem size, partition only the full bundle adjustments
+      const bool usePartitionedBA = !enableLocalStrategy &&
+                                    _params.partitionedBundleAdjustmentMaxNbPoses > 0 &&
+                                    _sfmData.getPoses().size() > _params.partitionedBundleAdjustmentMaxNbPoses;
+
+      bool success = false;
+      if(usePartitionedBA)
+      {
+        BundleAdjustmentPartitioned::PartitionOptions partitionOptions;
+        partitionOptions.maxNbPosesPerCluster = _params.partitionedBundleAdjustmentMaxNbPoses;
+        BundleAdjustmentPartitioned partitionedBA(partitionOptions, options, _params.minNbCamerasToRefinePrincipalPoint);
+        success = partitionedBA.adjust(_sfmData, refineOptions);
+      }
+      else
+      {
+        success = BA.adjust(_sfmData, refineOptions);
+      }
 
       if(!success)
         return false; // not usable solution
@@ -771,12 +1030,16 @@ bool ReconstructionEngine_sequentialSfM::bundleAdjustment(std::set<IndexT>& newR
         _localStrategyGraph->saveIntrinsicsToHistory(_sfmData);
 
       // export and print information about the refinement
-      const BundleAdjustmentCeres::Statistics& statistics = BA.getStatistics();
-      statistics.exportToFile(_outputFolder, "bundle_adjustment.csv");
-      statistics.show();
+      if(!usePartitionedBA)
+      {
+        const BundleAdjustmentCeres::Statistics& statistics = BA.getStatistics();
+        statistics.exportToFile(_outputFolder, "bundle_adjustment.csv");
+        statistics.show();
+      }
     }
 
-    nbOutliers = removeOutliers();
+    // with the local strategy, only the landmarks of the refined region can become outliers
+    nbOutliers = removeOutliers(enableLocalStrategy);
 
     std::set<IndexT> removedViewsIdIteration;
     eraseUnstablePosesAndObservations(this->_sfmData, _params.minPointsPerPose, _params.minTrackLength, &removedViewsIdIteration);
@@ -784,6 +1047,13 @@ bool ReconstructionEngine_sequentialSfM::bundleAdjustment(std::set<IndexT>& newR
     for(IndexT v : removedViewsIdIteration)
       newReconstructedViews.erase(v);
 
+    if(!removedViewsIdIteration.empty() && !_slidingWindowViewIds.empty())
+    {
+      _slidingWindowViewIds.erase(std::remove_if(_slidingWindowViewIds.begin(), _slidingWindowViewIds.end(),
+                                                 [&](IndexT viewId) { return removedViewsIdIteration.count(viewId) > 0; }),
+                                  _slidingWindowViewIds.end());
+    }
+
     if(_params.useLocalBundleAdjustment && !removedViewsIdIteration.empty())
     {
       // remove views from localBA graph
@@ -944,12 +1214,6 @@ bool ReconstructionEngine_sequentialSfM::findConnectedViews(
   if (remainingViewIds.empty() || _sfmData.getLandmarks().empty())
     return false;
 
-  // Collect tracksIds
-  std::set<size_t> reconstructed_trackId;
-  std::transform(_sfmData.getLandmarks().begin(), _sfmData.getLandmarks().end(),
-                 std::inserter(reconstructed_trackId, reconstructed_trackId.begin()),
-                 stl::RetrieveKey());
-
   const std::set<IndexT> reconstructedIntrinsics = _sfmData.getReconstructedIntrinsics();
 
 #pragma omp parallel for
@@ -992,20 +1256,26 @@ bool ReconstructionEngine_sequentialSfM::findConnectedViews(
       }
     }
 
-    // Count the common possible putative point
-    //  with the already 3D reconstructed trackId
-    std::vector<std::size_t> vec_trackIdForResection;
-    vec_trackIdForResection.reserve(set_tracksIds.size());
-    std::set_intersection(set_tracksIds.begin(), set_tracksIds.end(),
-                          reconstructed_trackId.begin(),
-                          reconstructed_trackId.end(),
-                          std::back_inserter(vec_trackIdForResection));
+    // The number of common possible putative points with the already 3D reconstructed tracks
+    // and their repartition in the image are maintained by updateCandidateScores
+    const auto candidateScoreIt = _candidateScores.find(viewId);
+    if(candidateScoreIt == _candidateScores.end())
+      continue;
+    const CandidateScore& candidateScore = candidateScoreIt->second;
+
     // Compute an image score based on the number of matches to the 3D scene
     // and the repartition of these features in the image.
-    std::size_t score = computeCandidateImageScore(viewId, vec_trackIdForResection);
+#ifdef ALICEVISION_NEXTBESTVIEW_WITHOUT_SCORE
+    const std::size_t score = candidateScore.nbTracks;
+#else
+    std::size_t score = 0;
+    for(std::size_t level = 0; level < _params.pyramidDepth; ++level)
+      score += candidateScore.nbFilledCellsPerLevel[level] * _pyramidWeights[level];
+#endif
+
 #pragma omp critical
     {
-      out_connectedViews.emplace_back(viewId, vec_trackIdForResection.size(), score, isIntrinsicsReconstructed);
+      out_connectedViews.emplace_back(viewId, candidateScore.nbTracks, score, isIntrinsicsReconstructed);
     }
   }
 
@@ -1017,6 +1287,65 @@ bool ReconstructionEngine_sequentialSfM::findConnectedViews(
   return !out_connectedViews.empty();
 }
 
+void ReconstructionEngine_sequentialSfM::computeSequenceOrder()
+{
+  _sequenceViewIds.clear();
+  _sequencePositionPerViewId.clear();
+
+  // the views of a rig captured at the same time share the same frame id
+  std::vector<const View*> views;
+  views.reserve(_sfmData.getViews().size());
+  for(const auto& viewPair : _sfmData.getViews())
+    views.push_back(viewPair.second.get());
+
+  std::sort(views.begin(), views.end(), [](const View* a, const View* b)
+  {
+    return std::make_tuple(a->getFrameId(), a->getImagePath(), a->getViewId()) <
+           std::make_tuple(b->getFrameId(), b->getImagePath(), b->getViewId());
+  });
+
+  for(const View* view : views)
+  {
+    _sequencePositionPerViewId[view->getViewId()] = _sequenceViewIds.size();
+    _sequenceViewIds.push_back(view->getViewId());
+  }
+}
+
+void ReconstructionEngine_sequentialSfM::getSlidingWindowCandidates(const std::set<IndexT>& remainingViewIds, std::set<IndexT>& candidateViewIds) const
+{
+  const std::size_t windowSize = _params.slidingWindowSize;
+
+  // only the sequence positions around the window are visited, the cost does not depend on the number of views
+  for(const IndexT viewId : _slidingWindowViewIds)
+  {
+    const std::size_t position = _sequencePositionPerViewId.at(viewId);
+    const std::size_t begin = (position > windowSize) ? position - windowSize : 0;
+    const std::size_t end = std::min(position + windowSize + 1, _sequenceViewIds.size());
+
+    for(std::size_t i = begin; i < end; ++i)
+    {
+      const IndexT candidateViewId = _sequenceViewIds[i];
+      if(remainingViewIds.count(candidateViewId) && _registeredCandidatesViews.count(candidateViewId))
+        candidateViewIds.insert(candidateViewId);
+    }
+  }
+}
+
+void ReconstructionEngine_sequentialSfM::updateSlidingWindow(const std::set<IndexT>& newReconstructedViews)
+{
+  // add the new views in the sequence order
+  std::vector<std::size_t> positions;
+  for(const IndexT viewId : newReconstructedViews)
+    positions.push_back(_sequencePositionPerViewId.at(viewId));
+  std::sort(positions.begin(), positions.end());
+
+  for(const std::size_t position : positions)
+    _slidingWindowViewIds.push_back(_sequenceViewIds[position]);
+
+  while(_slidingWindowViewIds.size() > _params.slidingWindowSize)
+    _slidingWindowViewIds.pop_front();
+}
+
 bool ReconstructionEngine_sequentialSfM::findNextBestViews(
   std::vector<IndexT> & out_selectedViewIds,
   const std::set<IndexT>& remainingViewIds) const
@@ -1319,6 +1648,10 @@ bool ReconstructionEngine_sequentialSfM::getBestInitialImagePairs(std::vector<Pa
   std::vector<ImagePairScore> bestImagePairs;
   bestImagePairs.reserve(_pairwiseMatches->size());
   
+  // each view is intersected with all its matched views, the densest ones are tested with a bitset
+  track::TracksBitsetPerView tracksBitsetPerView;
+  track::computeDenseTracksBitsetPerView(_map_tracksPerView, tracksBitsetPerView);
+
   // Compute the relative pose & the 'baseline score'
   auto progressDisplay = system::createConsoleProgressDisplay(_pairwiseMatches->size(), std::cout,
                                                               "Automatic selection of an initial pair:\n" );
@@ -1352,31 +1685,25 @@ bool ReconstructionEngine_sequentialSfM::getBestInitialImagePairs(std::vector<Pa
     if (camI == nullptr || camJ == nullptr)
       continue;
 
-    aliceVision::track::TracksMap map_tracksCommon;
-    const std::set<size_t> set_imageIndex= {I, J};
-    track::getCommonTracksInImagesFast(set_imageIndex, _map_tracks, _map_tracksPerView, map_tracksCommon);
+    std::vector<std::size_t> commonTracksIds;
+    track::getCommonTracksInImages({I, J}, _map_tracksPerView, tracksBitsetPerView, commonTracksIds);
 
     // Copy points correspondences to arrays for relative pose estimation
-    const size_t n = map_tracksCommon.size();
+    const size_t n = commonTracksIds.size();
     ALICEVISION_LOG_DEBUG("Automatic initial pair choice test - I: " << I << ", J: " << J << ", common tracks: " << n);
     Mat xI(2,n), xJ(2,n);
-    size_t cptIndex = 0;
-    std::vector<std::size_t> commonTracksIds(n);
-    for (aliceVision::track::TracksMap::const_iterator
-      iterT = map_tracksCommon.begin(); iterT != map_tracksCommon.end();
-      ++iterT, ++cptIndex)
+    std::vector<const track::Track*> commonTracks(n);
+    for(size_t cptIndex = 0; cptIndex < n; ++cptIndex)
     {
-      auto iter = iterT->second.featPerView.begin();
-      const size_t i = iter->second;
-      const size_t j = (++iter)->second;
-      commonTracksIds[cptIndex] = iterT->first;
-      
-      const auto& viewI = _featuresPerView->getFeatures(I, iterT->second.descType); 
-      const auto& viewJ = _featuresPerView->getFeatures(J, iterT->second.descType);
-      
-      Vec2 feat = viewI[i].coords().cast<double>();
+      const track::Track& track = _map_tracks.at(commonTracksIds[cptIndex]);
+      commonTracks[cptIndex] = &track;
+
+      const auto& viewI = _featuresPerView->getFeatures(I, track.descType);
+      const auto& viewJ = _featuresPerView->getFeatures(J, track.descType);
+
+      Vec2 feat = viewI[track.featPerView.at(I)].coords().cast<double>();
       xI.col(cptIndex) = camI->get_ud_pixel(feat);
-      feat = viewJ[j].coords().cast<double>();
+      feat = viewJ[track.featPerView.at(J)].coords().cast<double>();
       xJ.col(cptIndex) = camJ->get_ud_pixel(feat);
     }
     
@@ -1405,9 +1732,9 @@ bool ReconstructionEngine_sequentialSfM::getBestInitialImagePairs(std::vector<Pa
         Vec3 X;
         multiview::TriangulateDLT(PI, xI.col(inlier_idx), PJ, xJ.col(inlier_idx), &X);
         IndexT trackId = commonTracksIds[inlier_idx];
-        auto iter = map_tracksCommon[trackId].featPerView.begin();
-        const Vec2 featI = _featuresPerView->getFeatures(I, map_tracksCommon[trackId].descType)[iter->second].coords().cast<double>();
-        const Vec2 featJ = _featuresPerView->getFeatures(J, map_tracksCommon[trackId].descType)[(++iter)->second].coords().cast<double>();
+        const track::Track& track = *commonTracks[inlier_idx];
+        const Vec2 featI = _featuresPerView->getFeatures(I, track.descType)[track.featPerView.at(I)].coords().cast<double>();
+        const Vec2 featJ = _featuresPerView->getFeatures(J, track.descType)[track.featPerView.at(J)].coords().cast<double>();
         vec_angles[i] = angleBetweenRays(pose_I, camI, pose_J, camJ, featI, featJ);
         validCommonTracksIds[i] = trackId;
         ++i;
@@ -1493,7 +1820,7 @@ std::size_t ReconstructionEngine_sequentialSfM::computeCandidateImageScore(Index
  * C. Do the resectioning: compute the camera pose.
  * D. Refine the pose of the found camera
  */
-bool ReconstructionEngine_sequentialSfM::computeResection(const IndexT viewId, ResectionData& resectionData)
+bool ReconstructionEngine_sequentialSfM::computeResection(const IndexT viewId, ResectionData& resectionData, std::mt19937& randomNumberGenerator) const
 {
   using namespace track;
 
@@ -1534,7 +1861,12 @@ bool ReconstructionEngine_sequentialSfM::computeResection(const IndexT viewId, R
   
   // B. Look if intrinsic data is known or not
   const View * view_I = _sfmData.getViews().at(viewId).get();
-  resectionData.optionalIntrinsic = _sfmData.getIntrinsicsharedPtr(view_I->getIntrinsicId());
+  // work on a copy of the intrinsic, the scene is shared by the concurrent resections
+  {
+    const camera::IntrinsicBase* intrinsic = _sfmData.getIntrinsicPtr(view_I->getIntrinsicId());
+    if(intrinsic != nullptr)
+      resectionData.optionalIntrinsic.reset(intrinsic->clone());
+  }
   
   std::size_t cpt = 0;
   std::set<std::size_t>::const_iterator iterTrackId = resectionData.tracksId.begin();
@@ -1554,7 +1886,7 @@ bool ReconstructionEngine_sequentialSfM::computeResection(const IndexT viewId, R
   const bool bResection = sfm::SfMLocalizer::Localize(
       Pair(view_I->getWidth(), view_I->getHeight()),
       resectionData.optionalIntrinsic.get(),
-      _randomNumberGenerator,
+      randomNumberGenerator,
       resectionData,
       resectionData.pose, 
       _params.localizerEstimator
@@ -1619,9 +1951,11 @@ bool ReconstructionEngine_sequentialSfM::computeResection(const IndexT viewId, R
     // If we use a camera intrinsic for the first time we need to refine it.
     const bool intrinsicsFirstUsage = (reconstructedIntrinsics.count(view_I->getIntrinsicId()) == 0);
 
+    resectionData.isRefinedIntrinsic = resectionData.isNewIntrinsic || intrinsicsFirstUsage;
+
     if(!sfm::SfMLocalizer::RefinePose(
       resectionData.optionalIntrinsic.get(), resectionData.pose,
-      resectionData, true, resectionData.isNewIntrinsic || intrinsicsFirstUsage))
+      resectionData, true, resectionData.isRefinedIntrinsic))
     {
       ALICEVISION_LOG_INFO("Resection of view " << viewId << " failed during pose refinement.");
       return false;
@@ -1737,45 +2071,6 @@ void ReconstructionEngine_sequentialSfM::getTracksToTriangulate(const std::set<I
   }
 }
 
-namespace {
-
-struct ObservationData
-{
-    std::shared_ptr<camera::Pinhole> cam;
-    Pose3 pose;
-    Mat34 P;
-    Vec2 x;
-    Vec2 xUd;
-
-    bool isEmpty() const { return cam == nullptr; }
-};
-
-ObservationData getObservationData(const SfMData& scene,
-                                   feature::FeaturesPerView* featuresPerView,
-                                   IndexT viewId, const track::Track& track)
-{
-    const View* view = scene.getViews().at(viewId).get();
-
-    std::shared_ptr<camera::IntrinsicBase> cam = scene.getIntrinsics().at(view->getIntrinsicId());
-    std::shared_ptr<camera::Pinhole> camPinHole = std::dynamic_pointer_cast<camera::Pinhole>(cam);
-
-    if (!camPinHole) {
-        ALICEVISION_LOG_ERROR("Camera is not pinhole in triangulate_multiViewsLORANSAC");
-        return {nullptr, {}, {}, {}, {}};
-    }
-
-    Pose3 pose = scene.getPose(*view).getTransform();
-    Mat34 P = camPinHole->getProjectiveEquivalent(pose);
-
-    const auto& feature = featuresPerView->getFeatures(viewId, track.descType)[track.featPerView.at(viewId)];
-    Vec2 x = feature.coords().cast<double>();
-    Vec2 xUd = cam->get_ud_pixel(x); // undistorted 2D point
-
-    return {camPinHole, pose, P, x, xUd};
-}
-
-} // namespace
-
 void ReconstructionEngine_sequentialSfM::triangulate_multiViewsLORANSAC(SfMData& scene, const std::set<IndexT>& previousReconstructedViews, const std::set<IndexT>& newReconstructedViews)
 {
   ALICEVISION_LOG_DEBUG("Triangulating (mode: multi-view LO-RANSAC)... ");
@@ -1785,143 +2080,217 @@ void ReconstructionEngine_sequentialSfM::triangulate_multiViewsLORANSAC(SfMData&
   // These tracks are seen by at least one new reconstructed view.  
   std::map<IndexT, std::set<IndexT>> mapTracksToTriangulate; // <trackId, observations> 
   getTracksToTriangulate(previousReconstructedViews, newReconstructedViews, mapTracksToTriangulate);
-  
-  std::vector<IndexT> setTracksId; // <trackId>
-  std::transform(mapTracksToTriangulate.begin(), mapTracksToTriangulate.end(),
-                 std::inserter(setTracksId, setTracksId.begin()),
-                 stl::RetrieveKey());
 
-#pragma omp parallel for 
-  for (int i = 0; i < setTracksId.size(); i++) // each track (already reconstructed or not)
+  // -- Prepare the cameras of the reconstructed views once for all the tracks
+  multiview::TriangulationBatch batch;
+  std::map<IndexT, std::size_t> cameraIndexPerView;
+  std::vector<const camera::Pinhole*> cameraIntrinsics;
+  std::vector<Pose3> cameraPoses;
   {
-    const IndexT trackId = setTracksId.at(i);
-    bool isValidTrack = true;
-    const track::Track& track = _map_tracks.at(trackId);
-    std::set<IndexT>& observations = mapTracksToTriangulate.at(trackId); // all the posed views possessing the track
-    
-    // The track needs to be seen by a min. number of views to be triangulated
-    if (observations.size() < _params.minNbObservationsForTriangulation)
+    std::set<IndexT> reconstructedViews = previousReconstructedViews;
+    reconstructedViews.insert(newReconstructedViews.begin(), newReconstructedViews.end());
+
+    for(const IndexT viewId : reconstructedViews)
+    {
+      const View& view = *scene.getViews().at(viewId);
+      const camera::Pinhole* pinholeCam = dynamic_cast<const camera::Pinhole*>(scene.getIntrinsicPtr(view.getIntrinsicId()));
+      if(pinholeCam == nullptr)
+      {
+        ALICEVISION_LOG_ERROR("Camera is not pinhole in triangulate_multiViewsLORANSAC");
+        continue;
+      }
+      const Pose3 pose = scene.getPose(view).getTransform();
+      cameraIndexPerView[viewId] = batch.addCamera(pinholeCam->getProjectiveEquivalent(pose), pose.rotation(), pose.center());
+      cameraIntrinsics.push_back(pinholeCam);
+      cameraPoses.push_back(pose);
+    }
+  }
+
+  // -- Pack the observations of the tracks
+  // The track needs to be seen by a min. number of views to be triangulated
+  std::vector<IndexT> trackIds;
+  std::vector<IndexT> observationViewIds; // view id of each packed observation
+  for(const auto& trackPair : mapTracksToTriangulate)
+  {
+    const std::set<IndexT>& observations = trackPair.second; // all the posed views possessing the track
+
+    if(observations.size() < _params.minNbObservationsForTriangulation ||
+       std::any_of(observations.begin(), observations.end(), [&](IndexT viewId) { return cameraIndexPerView.count(viewId) == 0; }))
       continue;
-    
-    Vec3 X_euclidean = Vec3::Zero();
-    std::set<IndexT> inliers;
-    
-    if (observations.size() == 2) 
+
+    trackIds.push_back(trackPair.first);
+    batch.addPoint();
+    for(const IndexT viewId : observations)
     {
-      /* --------------------------------------------
-       *    2 observations : triangulation using DLT
-       * -------------------------------------------- */ 
-       
-      inliers = observations;
-      
-      // -- Prepare:
-      IndexT I =  *(observations.begin());
-      IndexT J =  *(observations.rbegin());
+      batch.addObservation(cameraIndexPerView.at(viewId), Vec2::Zero());
+      observationViewIds.push_back(viewId);
+    }
+  }
+
+  // -- Undistort the 2D observations
+#pragma omp parallel for schedule(dynamic, 256)
+  for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(trackIds.size()); ++i)
+  {
+    const track::Track& track = _map_tracks.at(trackIds[i]);
+    for(std::size_t o = batch.observationOffsets[i]; o < batch.observationOffsets[i + 1]; ++o)
+    {
+      const IndexT viewId = observationViewIds[o];
+      const Vec2 x = _featuresPerView->getFeatures(viewId, track.descType)[track.featPerView.at(viewId)].coords().cast<double>();
+      batch.observationPoints[o] = cameraIntrinsics[batch.observationCameras[o]]->get_ud_pixel(x);
+    }
+  }
 
-      const auto oi = getObservationData(scene, _featuresPerView, I, track);
-      const auto oj = getObservationData(scene, _featuresPerView, J, track);
+  // -- Triangulate:
+  //  - 2 observations: DLT (computed in batch for all the tracks)
+  //  - N observations (N>2): LO-RANSAC
+  std::vector<Vec3> X;
+  batch.triangulateDLT(X);
 
-      if (oi.isEmpty() || oj.isEmpty()) {
-        continue;
-      }
+  std::vector<char> validTracks(trackIds.size(), true);
+  std::vector<std::vector<std::size_t>> inliersPerTrack(trackIds.size()); // packed observation indexes
 
-      // -- Triangulate:
-      multiview::TriangulateDLT(oi.P, oi.xUd, oj.P, oj.xUd, &X_euclidean);
+  // draw one seed per track to keep the result independent of the number of threads
+  std::vector<std::mt19937::result_type> seeds(trackIds.size());
+  for(auto& seed : seeds)
+    seed = _randomNumberGenerator();
+
+#pragma omp parallel for schedule(dynamic)
+  for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(trackIds.size()); ++i)
+  {
+    const std::size_t firstObservation = batch.observationOffsets[i];
+    const std::size_t nbObservations = batch.nbObservations(i);
+    std::vector<std::size_t>& inliers = inliersPerTrack[i];
+
+    if(nbObservations == 2)
+    {
+      inliers = {firstObservation, firstObservation + 1};
 
       // -- Check:
       //  - angle (small angle leads imprecise triangulation)
       //  - positive depth
       //  - residual values
-      // TODO assert(acThresholdIt != _map_ACThreshold.end());
-      const auto& acThresholdItI = _map_ACThreshold.find(I);
-      const auto& acThresholdItJ = _map_ACThreshold.find(J);
-      const double& acThresholdI = (acThresholdItI != _map_ACThreshold.end()) ? acThresholdItI->second : 4.0;
-      const double& acThresholdJ = (acThresholdItJ != _map_ACThreshold.end()) ? acThresholdItJ->second : 4.0;
-      
-      if (angleBetweenRays(oi.pose, oi.cam.get(), oj.pose, oj.cam.get(), oi.x, oj.x) < _params.minAngleForTriangulation ||
-          oi.pose.depth(X_euclidean) < 0 ||
-          oj.pose.depth(X_euclidean) < 0 ||
-          oi.cam->residual(oi.pose, X_euclidean.homogeneous(), oi.x).norm() > acThresholdI ||
-          oj.cam->residual(oj.pose, X_euclidean.homogeneous(), oj.x).norm() > acThresholdJ)
-        isValidTrack = false;
-    }
-    else 
-    {
-      /* -------------------------------------------------------
-       *    N obsevations (N>2) : triangulation using LORANSAC 
-       * ------------------------------------------------------- */ 
-     
-      // -- Prepare:
-      Mat2X features(2, observations.size()); // undistorted 2D features (one per pose)
-      std::vector<Mat34> Ps; // projective matrices (one per pose)
+      const track::Track& track = _map_tracks.at(trackIds[i]);
+      Vec2 x[2];
+      for(int k = 0; k < 2; ++k)
       {
-        const track::Track& track = _map_tracks.at(trackId);
-        
-        int i = 0;
-        for (const IndexT& viewId : observations)
-        {
-          const auto o = getObservationData(scene, _featuresPerView, viewId, track);
+        const IndexT viewId = observationViewIds[firstObservation + k];
+        x[k] = _featuresPerView->getFeatures(viewId, track.descType)[track.featPerView.at(viewId)].coords().cast<double>();
+      }
 
-          if (o.isEmpty()) {
-            continue;
-          }
+      const std::size_t cameraI = batch.observationCameras[firstObservation];
+      const std::size_t cameraJ = batch.observationCameras[firstObservation + 1];
 
-          features(0,i) = o.xUd(0);
-          features(1,i) = o.xUd(1);
-          Ps.push_back(o.P);
-          i++;
-        }
+      if(angleBetweenRays(cameraPoses[cameraI], cameraIntrinsics[cameraI], cameraPoses[cameraJ], cameraIntrinsics[cameraJ], x[0], x[1]) < _params.minAngleForTriangulation)
+      {
+        validTracks[i] = false;
+        continue;
       }
-      
-      // -- Triangulate: 
-      Vec4 X_homogeneous = Vec4::Zero();
-      std::vector<std::size_t> inliersIndex;
-      
-      multiview::TriangulateNViewLORANSAC(features, Ps, _randomNumberGenerator, &X_homogeneous, &inliersIndex, 8.0);
-      
-      homogeneousToEuclidean(X_homogeneous, &X_euclidean);     
-      
-      // observations = {350, 380, 442} | inliersIndex = [0, 1] | inliers = {350, 380}
-      for (const auto & id : inliersIndex)
-        inliers.insert(*std::next(observations.begin(), id));
 
-      // -- Check:
-      //  - nb of cameras validing the track 
-      //  - angle (small angle leads imprecise triangulation)
-      //  - positive depth (chierality)
-      if (inliers.size() < _params.minNbObservationsForTriangulation ||
-          !checkAngles(X_euclidean, inliers, scene, _params.minAngleForTriangulation) ||
-          !checkChieralities(X_euclidean, inliers, scene))
-        isValidTrack = false;
-    }  
-
-    // -- Add the tringulated point to the scene
-    if (isValidTrack)
-    {
-      Landmark landmark;
-      landmark.X = X_euclidean;
-      landmark.descType = track.descType;
-      for (const IndexT & viewId : inliers) // add inliers as observations
+      for(int k = 0; k < 2; ++k)
       {
-        const Vec2 x = _featuresPerView->getFeatures(viewId, track.descType)[track.featPerView.at(viewId)].coords().cast<double>();
-        const feature::PointFeature& p = _featuresPerView->getFeatures(viewId, track.descType)[track.featPerView.at(viewId)];
-        const double scale = (_params.featureConstraint == EFeatureConstraint::BASIC) ? 0.0 : p.scale();
-        landmark.observations[viewId] = Observation(x, track.featPerView.at(viewId), scale);
+        const std::size_t cameraIndex = batch.observationCameras[firstObservation + k];
+        const Pose3& pose = cameraPoses[cameraIndex];
+
+        // TODO assert(acThresholdIt != _map_ACThreshold.end());
+        const auto& acThresholdIt = _map_ACThreshold.find(observationViewIds[firstObservation + k]);
+        const double acThreshold = (acThresholdIt != _map_ACThreshold.end()) ? acThresholdIt->second : 4.0;
+
+        if(pose.depth(X[i]) < 0 ||
+           cameraIntrinsics[cameraIndex]->residual(pose, X[i].homogeneous(), x[k]).norm() > acThreshold)
+          validTracks[i] = false;
       }
-#pragma omp critical
-      {
-        scene.structure[trackId] = landmark;
-      }      
     }
     else
     {
-#pragma omp critical
+      // -- Prepare:
+      Mat2X features(2, nbObservations); // undistorted 2D features (one per pose)
+      std::vector<Mat34> Ps(nbObservations); // projective matrices (one per pose)
+      for(std::size_t k = 0; k < nbObservations; ++k)
       {
-        if (scene.structure.find(trackId) != scene.structure.end()) 
-          scene.structure.erase(trackId);
+        features.col(k) = batch.observationPoints[firstObservation + k];
+        Ps[k] = batch.cameras[batch.observationCameras[firstObservation + k]].P;
       }
+
+      // -- Triangulate:
+      Vec4 X_homogeneous = Vec4::Zero();
+      std::vector<std::size_t> inliersIndex;
+      std::mt19937 randomNumberGenerator(seeds[i]);
+
+      multiview::TriangulateNViewLORANSAC(features, Ps, randomNumberGenerator, &X_homogeneous, &inliersIndex, 8.0);
+
+      homogeneousToEuclidean(X_homogeneous, &X[i]);
+
+      for(const std::size_t id : inliersIndex)
+        inliers.push_back(firstObservation + id);
+
+      // -- Check the nb of cameras validing the track
+      if(inliers.size() < _params.minNbObservationsForTriangulation)
+        validTracks[i] = false;
+    }
+  }
+
+  // -- Check the inliers of the N-view tracks in bulk:
+  //  - angle (small angle leads imprecise triangulation)
+  //  - positive depth (chierality)
+  {
+    multiview::TriangulationBatch inliersBatch;
+    inliersBatch.cameras = batch.cameras;
+
+    std::vector<std::size_t> nViewTracks;
+    std::vector<Vec3> nViewX;
+    for(std::size_t i = 0; i < trackIds.size(); ++i)
+    {
+      if(batch.nbObservations(i) == 2 || !validTracks[i])
+        continue;
+
+      nViewTracks.push_back(i);
+      nViewX.push_back(X[i]);
+      inliersBatch.addPoint();
+      for(const std::size_t o : inliersPerTrack[i])
+        inliersBatch.addObservation(batch.observationCameras[o], batch.observationPoints[o]);
+    }
+
+    std::vector<char> nViewValid(nViewTracks.size(), true);
+    inliersBatch.checkAngles(nViewX, _params.minAngleForTriangulation, nViewValid);
+    inliersBatch.checkChieralities(nViewX, nViewValid);
+
+    for(std::size_t k = 0; k < nViewTracks.size(); ++k)
+    {
+      if(!nViewValid[k])
+        validTracks[nViewTracks[k]] = false;
     }
-  } // for all shared tracks 
+  }
+
+  // -- Build the triangulated landmarks
+  std::vector<Landmark> landmarks(trackIds.size());
+
+#pragma omp parallel for schedule(dynamic, 256)
+  for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(trackIds.size()); ++i)
+  {
+    if(!validTracks[i])
+      continue;
+
+    const track::Track& track = _map_tracks.at(trackIds[i]);
+    Landmark& landmark = landmarks[i];
+    landmark.X = X[i];
+    landmark.descType = track.descType;
+    for(const std::size_t o : inliersPerTrack[i]) // add inliers as observations
+    {
+      const IndexT viewId = observationViewIds[o];
+      const feature::PointFeature& p = _featuresPerView->getFeatures(viewId, track.descType)[track.featPerView.at(viewId)];
+      const double scale = (_params.featureConstraint == EFeatureConstraint::BASIC) ? 0.0 : p.scale();
+      landmark.observations[viewId] = Observation(p.coords().cast<double>(), track.featPerView.at(viewId), scale);
+    }
+  }
+
+  // -- Add the triangulated points to the scene, remove the invalid ones
+  for(std::size_t i = 0; i < trackIds.size(); ++i)
+  {
+    if(validTracks[i])
+      scene.structure[trackIds[i]] = std::move(landmarks[i]);
+    else
+      scene.structure.erase(trackIds[i]);
+  }
 }
 
 void ReconstructionEngine_sequentialSfM::triangulate_2Views(SfMData& scene, const std::set<IndexT>& previousReconstructedViews, const std::set<IndexT>& newReconstructedViews)
@@ -2103,10 +2472,193 @@ void ReconstructionEngine_sequentialSfM::triangulate_2Views(SfMData& scene, cons
   }
 }
 
-std::size_t ReconstructionEngine_sequentialSfM::removeOutliers()
+void ReconstructionEngine_sequentialSfM::saveCheckpoint()
 {
-  const std::size_t nbOutliersResidualErr = RemoveOutliers_PixelResidualError(_sfmData, _params.featureConstraint, _params.maxReprojectionError, 2);
-  const std::size_t nbOutliersAngleErr = RemoveOutliers_AngleError(_sfmData, _params.minAngleForLandmark);
+  // only one checkpoint at a time, the reconstruction waits if the previous one is still being written
+  _checkpointGroup.wait();
+
+  aliceVision::system::Timer timer;
+
+  // deep copy of the scene, the views and the intrinsics are updated in place by the reconstruction
+  auto scene = std::make_shared<SfMData>(_sfmData);
+  for(auto& viewPair : scene->getViews())
+    viewPair.second = std::make_shared<View>(*viewPair.second);
+  for(auto& intrinsicPair : scene->getIntrinsics())
+    intrinsicPair.second.reset(intrinsicPair.second->clone());
+
+  // reconstruction state which cannot be recomputed from the scene
+  std::ostringstream stateStream(std::ios::binary);
+  {
+    const auto write = [&](const auto& value) { stateStream.write(reinterpret_cast<const char*>(&value), sizeof(value)); };
+
+    stateStream.write(checkpointMagic, sizeof(checkpointMagic));
+    write(checkpointVersion);
+    write(static_cast<std::uint64_t>(_map_tracks.size()));
+
+    write(static_cast<std::uint64_t>(_registeredCandidatesViews.size()));
+    for(const IndexT viewId : _registeredCandidatesViews)
+      write(static_cast<std::uint32_t>(viewId));
+
+    write(static_cast<std::uint64_t>(_map_ACThreshold.size()));
+    for(const auto& acThresholdPair : _map_ACThreshold)
+    {
+      write(static_cast<std::uint32_t>(acThresholdPair.first));
+      write(acThresholdPair.second);
+    }
+
+    write(static_cast<std::uint8_t>(_localStrategyGraph != nullptr));
+    if(_localStrategyGraph)
+      _localStrategyGraph->saveIntrinsicsState(stateStream);
+  }
+
+  ALICEVISION_LOG_DEBUG("Checkpoint of " << scene->getPoses().size() << " poses copied in " << timer.elapsedMs() << " msec.");
+
+  const fs::path checkpointFolder(_checkpointFolder);
+  _checkpointGroup.runIO([scene, state = stateStream.str(), checkpointFolder]()
+  {
+    aliceVision::system::Timer writeTimer;
+    const fs::path newFolder = checkpointFolder.string() + "_new";
+    const fs::path oldFolder = checkpointFolder.string() + "_old";
+
+    try
+    {
+      fs::remove_all(newFolder);
+      fs::create_directories(newFolder);
+
+      if(!sfmDataIO::Save(*scene, (newFolder / "sfmData.sfmb").string(), checkpointSfMDataParts))
+        throw std::runtime_error("Cannot write the checkpoint scene.");
+
+      std::ofstream stateFile((newFolder / "state.bin").string(), std::ios::binary);
+      stateFile.write(state.data(), state.size());
+      stateFile.close();
+      if(!stateFile)
+        throw std::runtime_error("Cannot write the checkpoint state.");
+
+      // keep the previous checkpoint until the new one is in place
+      fs::remove_all(oldFolder);
+      if(fs::exists(checkpointFolder))
+        fs::rename(checkpointFolder, oldFolder);
+      fs::rename(newFolder, checkpointFolder);
+      fs::remove_all(oldFolder);
+    }
+    catch(const std::exception& e)
+    {
+      ALICEVISION_LOG_WARNING("Checkpoint of the reconstruction failed: " << e.what());
+      return;
+    }
+
+    ALICEVISION_LOG_INFO("Checkpoint of the reconstruction (" << scene->getPoses().size() << " poses, "
+                         << scene->getLandmarks().size() << " landmarks) written in " << writeTimer.elapsed() << " s.");
+  });
+}
+
+bool ReconstructionEngine_sequentialSfM::loadCheckpoint()
+{
+  // after an interruption between the renames of saveCheckpoint, the last complete checkpoint is the previous one
+  fs::path checkpointFolder(_checkpointFolder);
+  if(!fs::exists(checkpointFolder / "state.bin"))
+    checkpointFolder = _checkpointFolder + "_old";
+
+  if(!fs::exists(checkpointFolder / "state.bin"))
+  {
+    ALICEVISION_LOG_INFO("No checkpoint to resume the reconstruction from in: " << _checkpointFolder);
+    return false;
+  }
+
+  SfMData scene;
+  if(!sfmDataIO::Load(scene, (checkpointFolder / "sfmData.sfmb").string(), checkpointSfMDataParts))
+  {
+    ALICEVISION_LOG_WARNING("Cannot load the checkpoint scene in: " << checkpointFolder.string());
+    return false;
+  }
+
+  std::ifstream stateStream((checkpointFolder / "state.bin").string(), std::ios::binary);
+  const auto read = [&](auto& value) { stateStream.read(reinterpret_cast<char*>(&value), sizeof(value)); return bool(stateStream); };
+
+  char magic[sizeof(checkpointMagic)];
+  std::uint32_t version = 0;
+  stateStream.read(magic, sizeof(magic));
+  if(!read(version) || std::memcmp(magic, checkpointMagic, sizeof(magic)) != 0 || version != checkpointVersion)
+  {
+    ALICEVISION_LOG_WARNING("Invalid checkpoint state in: " << checkpointFolder.string());
+    return false;
+  }
+
+  std::uint64_t nbTracks = 0;
+  std::uint64_t nbRegisteredViews = 0;
+  std::set<IndexT> registeredCandidatesViews;
+  read(nbTracks);
+  read(nbRegisteredViews);
+  for(std::uint64_t i = 0; i < nbRegisteredViews && stateStream; ++i)
+  {
+    std::uint32_t viewId;
+    if(read(viewId))
+      registeredCandidatesViews.insert(viewId);
+  }
+
+  std::uint64_t nbACThresholds = 0;
+  HashMap<IndexT, double> acThresholds;
+  read(nbACThresholds);
+  for(std::uint64_t i = 0; i < nbACThresholds && stateStream; ++i)
+  {
+    std::uint32_t viewId;
+    double acThreshold;
+    if(read(viewId) && read(acThreshold))
+      acThresholds[viewId] = acThreshold;
+  }
+
+  std::uint8_t hasLocalBAState = 0;
+  read(hasLocalBAState);
+  if(hasLocalBAState && _localStrategyGraph && !_localStrategyGraph->loadIntrinsicsState(stateStream))
+    stateStream.setstate(std::ios::failbit);
+
+  if(!stateStream)
+  {
+    ALICEVISION_LOG_WARNING("Truncated checkpoint state in: " << checkpointFolder.string());
+    return false;
+  }
+
+  // the landmark ids are the track ids of the checkpoint, they are remapped to the current tracks afterwards
+  if(nbTracks != _map_tracks.size())
+    ALICEVISION_LOG_WARNING("The tracks differ from the ones of the checkpoint (" << _map_tracks.size() << " vs " << nbTracks << ").");
+
+  // the features and matches folders of the input scene are kept
+  std::swap(_sfmData.getViews(), scene.getViews());
+  std::swap(_sfmData.getIntrinsics(), scene.getIntrinsics());
+  std::swap(_sfmData.getPoses(), scene.getPoses());
+  std::swap(_sfmData.getRigs(), scene.getRigs());
+  std::swap(_sfmData.getLandmarks(), scene.getLandmarks());
+  std::swap(_sfmData.getControlPoints(), scene.getControlPoints());
+  std::swap(_registeredCandidatesViews, registeredCandidatesViews);
+  std::swap(_map_ACThreshold, acThresholds);
+
+  ALICEVISION_LOG_INFO("Resume the reconstruction from the checkpoint: " << checkpointFolder.string() << std::endl
+                       << "\t- # poses: " << _sfmData.getPoses().size() << std::endl
+                       << "\t- # landmarks: " << _sfmData.getLandmarks().size());
+  return true;
+}
+
+std::size_t ReconstructionEngine_sequentialSfM::removeOutliers(bool onlyRefinedLandmarks)
+{
+  // the landmarks not affected by the local bundle adjustment have already been filtered
+  std::vector<IndexT> landmarkIds;
+  if(onlyRefinedLandmarks)
+  {
+    landmarkIds = _localStrategyGraph->getLandmarksAffectedByRefinement(_sfmData);
+    ALICEVISION_LOG_DEBUG("Remove outliers on " << landmarkIds.size() << " / " << _sfmData.getLandmarks().size() << " landmarks.");
+  }
+  const std::vector<IndexT>* landmarkIdsPtr = onlyRefinedLandmarks ? &landmarkIds : nullptr;
+
+  const std::size_t nbOutliersResidualErr = RemoveOutliers_PixelResidualError(_sfmData, _params.featureConstraint, _params.maxReprojectionError, 2, landmarkIdsPtr);
+
+  // the landmarks removed by the residual filter are not evaluated again
+  if(onlyRefinedLandmarks)
+  {
+    landmarkIds.erase(std::remove_if(landmarkIds.begin(), landmarkIds.end(),
+                                     [this](IndexT landmarkId) { return _sfmData.getLandmarks().count(landmarkId) == 0; }),
+                      landmarkIds.end());
+  }
+  const std::size_t nbOutliersAngleErr = RemoveOutliers_AngleError(_sfmData, _params.minAngleForLandmark, landmarkIdsPtr);
 
   ALICEVISION_LOG_INFO("Remove outliers: " << std::endl
                         << "\t- # outliers residual error: " << nbOutliersResidualErr << std::endl
@@ -9,6 +9,7 @@
 
 #include <aliceVision/sfm/pipeline/ReconstructionEngine.hpp>
 #include <aliceVision/sfm/LocalBundleAdjustmentGraph.hpp>
+#include <aliceVision/sfm/BundleAdjustmentCeres.hpp>
 #include <aliceVision/sfm/pipeline/localization/SfMLocalizer.hpp>
 #include <aliceVision/sfm/pipeline/pairwiseMatchesIO.hpp>
 #include <aliceVision/sfm/pipeline/RigSequence.hpp>
@@ -17,10 +18,14 @@
 #include <aliceVision/track/TracksBuilder.hpp>
 #include <dependencies/htmlDoc/htmlDoc.hpp>
 #include <aliceVision/utils/Histogram.hpp>
+#include <aliceVision/system/TaskScheduler.hpp>
+#include <aliceVision/system/Timer.hpp>
 
 #include <boost/filesystem.hpp>
 #include <boost/property_tree/ptree.hpp>
 
+#include <deque>
+
 namespace fs = boost::filesystem;
 namespace pt = boost::property_tree;
 
@@ -44,6 +49,19 @@ public:
     int minPointsPerPose = 30;
     bool useLocalBundleAdjustment = false;
     int localBundelAdjustementGraphDistanceLimit = 1;
+    /// keep the bundle adjustment problem between iterations instead of rebuilding it
+    bool reuseBundleAdjustmentProblem = true;
+    /// solve the bundle adjustment linear systems on the GPU if available
+    bool useGPUBundleAdjustment = false;
+    /// use a partitioned bundle adjustment above this number of poses per cluster (0 to disable)
+    std::size_t partitionedBundleAdjustmentMaxNbPoses = 0;
+
+    // Sliding window for time-ordered captures (video, drone strips)
+
+    /// number of last resected views refined by the bundle adjustment, the next views are searched around them (0 to disable)
+    std::size_t slidingWindowSize = 0;
+    /// number of resected views between two bundle adjustments of the whole scene (0 to only adjust it at the end)
+    std::size_t slidingWindowGlobalBAInterval = 100;
 
     RigParams rig;
 
@@ -86,6 +104,12 @@ public:
       sfmDataIO::STRUCTURE |
       sfmDataIO::OBSERVATIONS |
       sfmDataIO::CONTROL_POINTS);
+
+    // Checkpoints
+    /// minimum interval (in seconds) between two checkpoints of the reconstruction, 0 to disable them
+    double checkpointInterval = 0.0;
+    /// resume the reconstruction from the last checkpoint of the output folder, if any
+    bool resumeFromCheckpoint = false;
   };
 
 public:
@@ -147,7 +171,9 @@ public:
   double incrementalReconstruction();
 
   /**
-   * @brief Update the reconstruction with a new resection group of images
+   * @brief Update the reconstruction with a new resection group of images.
+   *        All the views of the group are resected in parallel against the current scene,
+   *        then the accepted views are committed to the scene in one pass.
    * @param[in] resectionId The resection id
    * @param[in] bestViewIds The best remaining view ids
    * @param[in] prevReconstructedViews The previously reconstructed view ids
@@ -227,6 +253,8 @@ private:
     std::shared_ptr<camera::IntrinsicBase> optionalIntrinsic = nullptr;
     /// the instrinsic already exists in the scene or not.
     bool isNewIntrinsic;
+    /// the intrinsic has been refined by the resection and should be copied back to the scene.
+    bool isRefinedIntrinsic = false;
   };
 
   /**
@@ -266,11 +294,14 @@ private:
 
   /**
    * @brief Apply the resection on a single view.
+   *        The scene is not modified, the resection works on a copy of the view intrinsic,
+   *        so several views can be resected concurrently.
    * @param[in] viewIndex: image index to add to the reconstruction.
    * @param[out] resectionData: contains the result (P) and all the data used during the resection.
+   * @param[in,out] randomNumberGenerator: random number generator used by the robust estimation.
    * @return false if resection failed
    */
-  bool computeResection(const IndexT viewIndex, ResectionData& resectionData);
+  bool computeResection(const IndexT viewIndex, ResectionData& resectionData, std::mt19937& randomNumberGenerator) const;
 
   /**
    * @brief Update the global scene with the new found camera pose, intrinsic (if not defined) and 
@@ -337,15 +368,52 @@ private:
    */
   void registerChanges(const std::set<IndexT>& newReconstructedViews);
 
+  /**
+   * @brief Update the candidate scores of the views with the landmarks added or removed since the last update.
+   *        Only the views observing a changed track are updated.
+   */
+  void updateCandidateScores();
+
   /**
    * @brief Remove observation/tracks that have:
    * - too large residual error
    * - too small angular value
    *
-   * @param[in] precision
+   * @param[in] onlyRefinedLandmarks only evaluate the landmarks affected by the local bundle adjustment
    * @return number of removed outliers
    */
-  std::size_t removeOutliers();
+  std::size_t removeOutliers(bool onlyRefinedLandmarks = false);
+
+  /**
+   * @brief Sort the views by frame id (then by image path) to define the order of the captured sequence
+   */
+  void computeSequenceOrder();
+
+  /**
+   * @brief Get the remaining views close to the sliding window in the sequence order
+   * @param[in] remainingViewIds the views not reconstructed yet
+   * @param[out] candidateViewIds the remaining views at most slidingWindowSize positions away from a view of the window
+   */
+  void getSlidingWindowCandidates(const std::set<IndexT>& remainingViewIds, std::set<IndexT>& candidateViewIds) const;
+
+  /**
+   * @brief Add the new reconstructed views to the sliding window and drop the oldest ones
+   * @param[in] newReconstructedViews the newly reconstructed view ids
+   */
+  void updateSlidingWindow(const std::set<IndexT>& newReconstructedViews);
+
+  /**
+   * @brief Write a checkpoint of the reconstruction in the background.
+   *        It contains the scene, the views to update, the per camera thresholds and the local BA intrinsics state.
+   *        The previous checkpoint is only replaced once the new one is complete.
+   */
+  void saveCheckpoint();
+
+  /**
+   * @brief Restore the scene and the reconstruction state of the last complete checkpoint
+   * @return false if there is no valid checkpoint
+   */
+  bool loadCheckpoint();
 
 private:
 
@@ -363,6 +431,26 @@ private:
   std::vector<int> _pyramidWeights;
   int _pyramidThreshold;
 
+  /**
+   * @brief Connection of a view with the reconstructed landmarks, maintained incrementally.
+   */
+  struct CandidateScore
+  {
+    /// number of reconstructed tracks observed by the view
+    std::size_t nbTracks = 0;
+    /// number of reconstructed tracks in each cell of the pyramid (all levels)
+    std::vector<unsigned int> nbTracksPerCell;
+    /// number of non-empty cells per pyramid level
+    std::vector<std::size_t> nbFilledCellsPerLevel;
+  };
+
+  /// candidate score of each view connected to the reconstruction
+  HashMap<IndexT, CandidateScore> _candidateScores;
+  /// reconstructed tracks taken into account in the candidate scores, indexed by track id
+  std::vector<bool> _isTrackScored;
+  /// number of tracks taken into account in the candidate scores
+  std::size_t _nbScoredTracks = 0;
+
   // Temporary data
 
   /// List of views which are affected by a previous update
@@ -381,6 +469,19 @@ private:
 
   /// Contains all the data used by the Local BA approach
   std::shared_ptr<LocalBundleAdjustmentGraph> _localStrategyGraph;
+  /// Bundle adjustment kept between iterations to reuse its problem
+  std::unique_ptr<BundleAdjustmentCeres> _bundleAdjustment;
+
+  // Sliding window data
+
+  /// view ids in the order of the captured sequence
+  std::vector<IndexT> _sequenceViewIds;
+  /// position of each view in the captured sequence
+  HashMap<IndexT, std::size_t> _sequencePositionPerViewId;
+  /// last resected views, in resection order
+  std::deque<IndexT> _slidingWindowViewIds;
+  /// number of views resected since the last bundle adjustment of the whole scene
+  std::size_t _nbViewsSinceGlobalBA = 0;
 
   // Log
 
@@ -393,6 +494,15 @@ private:
   std::string _htmlLogFile;
   /// property tree for json stats export
   pt::ptree _jsonLogTree;
+
+  // Checkpoints
+
+  /// folder of the last complete checkpoint
+  const std::string _checkpointFolder;
+  /// time since the last checkpoint
+  system::Timer _checkpointTimer;
+  /// checkpoint being written
+  system::TaskGroup _checkpointGroup;
 };
 
 } // namespace sfm
@@ -194,3 +194,56 @@ BOOST_AUTO_TEST_CASE(SEQUENTIAL_SFM_Known_Rig)
   BOOST_CHECK_EQUAL(sfmEngine.getSfMData().getLandmarks().size(), nbPoints);
 }
 
+
+// Test a time-ordered capture reconstructed with the sliding window
+BOOST_AUTO_TEST_CASE(SEQUENTIAL_SFM_Sliding_Window)
+{
+  const int nviews = 12;
+  const int npoints = 128;
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  // Translate the input dataset to a SfMData scene
+  SfMData sfmData = getInputScene(d, config, EINTRINSIC::PINHOLE_CAMERA);
+  for(auto& viewPair : sfmData.getViews())
+    viewPair.second->setFrameId(viewPair.first);
+
+  // Remove poses and structure
+  SfMData sfmData2 = sfmData;
+  sfmData2.getPoses().clear();
+  sfmData2.structure.clear();
+
+  ReconstructionEngine_sequentialSfM::Params sfmParams;
+  sfmParams.userInitialImagePair = Pair(0, 1);
+  sfmParams.lockAllIntrinsics = true;
+  sfmParams.slidingWindowSize = 3;
+  sfmParams.slidingWindowGlobalBAInterval = 4;
+
+  ReconstructionEngine_sequentialSfM sfmEngine(
+    sfmData2,
+    sfmParams,
+    "./",
+    "./Reconstruction_Report.html");
+
+  // Add a tiny noise in 2D observations to make data more realistic
+  std::normal_distribution<double> distribution(0.0,0.5);
+
+  // Configure the featuresPerView & the matches_provider from the synthetic dataset
+  feature::FeaturesPerView featuresPerView;
+  generateSyntheticFeatures(featuresPerView, feature::EImageDescriberType::UNKNOWN, sfmData, distribution);
+
+  matching::PairwiseMatches pairwiseMatches;
+  generateSyntheticMatches(pairwiseMatches, sfmData, feature::EImageDescriberType::UNKNOWN);
+
+  // Configure data provider (Features and Matches)
+  sfmEngine.setFeatures(&featuresPerView);
+  sfmEngine.setMatches(&pairwiseMatches);
+
+  BOOST_CHECK (sfmEngine.process());
+
+  const double residual = RMSE(sfmEngine.getSfMData());
+  ALICEVISION_LOG_DEBUG("RMSE residual: " << residual);
+  BOOST_CHECK_LT(residual, 0.5);
+  BOOST_CHECK_EQUAL(sfmEngine.getSfMData().getPoses().size(), nviews);
+  BOOST_CHECK_EQUAL(sfmEngine.getSfMData().getLandmarks().size(), npoints);
+}
@@ -16,6 +16,13 @@
 #include <aliceVision/sfm/sfmTriangulation.hpp>
 #include <aliceVision/system/ProgressDisplay.hpp>
 #include <aliceVision/config.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <map>
+#include <vector>
 
 namespace aliceVision {
 namespace sfm {
@@ -81,89 +88,89 @@ void StructureEstimationFromKnownPoses::match(const SfMData& sfmData,
   auto progressDisplay = system::createConsoleProgressDisplay(pairs.size(), std::cout,
     "Compute pairwise fundamental guided matching:\n" );
 
-  #pragma omp parallel
-  for (PairSet::const_iterator it = pairs.begin(); it != pairs.end(); ++it)
+  // random access to the pairs, to balance the pairs between the threads
+  const std::vector<Pair> pairsVec(pairs.begin(), pairs.end());
+
+  #pragma omp parallel for schedule(dynamic)
+  for (int p = 0; p < pairsVec.size(); ++p)
   {
-    #pragma omp single nowait
-    {
+    const Pair& pair = pairsVec[p];
+
     // --
     // Perform GUIDED MATCHING
     // --
     // Use the computed model to check valid correspondences
     // - by considering geometric error and descriptor distance ratio.
 
-    const View * viewL = sfmData.getViews().at(it->first).get();
-    const Pose3 poseL = sfmData.getPose(*viewL).getTransform();
+    const View * viewL = sfmData.getViews().at(pair.first).get();
+    const View * viewR = sfmData.getViews().at(pair.second).get();
     const Intrinsics::const_iterator iterIntrinsicL = sfmData.getIntrinsics().find(viewL->getIntrinsicId());
-    const View * viewR = sfmData.getViews().at(it->second).get();
-    const Pose3 poseR = sfmData.getPose(*viewR).getTransform();
     const Intrinsics::const_iterator iterIntrinsicR = sfmData.getIntrinsics().find(viewR->getIntrinsicId());
 
-    if (sfmData.getIntrinsics().count(viewL->getIntrinsicId()) != 0 ||
-        sfmData.getIntrinsics().count(viewR->getIntrinsicId()) != 0)
+    if (iterIntrinsicL == sfmData.getIntrinsics().end() ||
+        iterIntrinsicR == sfmData.getIntrinsics().end())
+      continue;
+
+    const Pose3 poseL = sfmData.getPose(*viewL).getTransform();
+    const Pose3 poseR = sfmData.getPose(*viewR).getTransform();
+
+    const std::shared_ptr<camera::Pinhole> pinHoleCamL = std::dynamic_pointer_cast<camera::Pinhole>(iterIntrinsicL->second);
+    const std::shared_ptr<camera::Pinhole> pinHoleCamR = std::dynamic_pointer_cast<camera::Pinhole>(iterIntrinsicR->second);
+    if (!pinHoleCamL || !pinHoleCamR)
     {
-      std::shared_ptr<IntrinsicBase> camL = iterIntrinsicL->second;
-      std::shared_ptr<camera::Pinhole> pinHoleCamL = std::dynamic_pointer_cast<camera::Pinhole>(camL);
-      if (!pinHoleCamL) {
-        ALICEVISION_LOG_ERROR("Camera is not pinhole in match");
-      }
+      ALICEVISION_LOG_ERROR("Camera is not pinhole in match");
+      continue;
+    }
 
-      std::shared_ptr<IntrinsicBase> camR = iterIntrinsicR->second;
-      std::shared_ptr<camera::Pinhole> pinHoleCamR = std::dynamic_pointer_cast<camera::Pinhole>(camR);
-      if (!pinHoleCamL) {
-        ALICEVISION_LOG_ERROR("Camera is not pinhole in match");
-      }
-      
-      const Mat34 P_L = pinHoleCamL->getProjectiveEquivalent(poseL);
-      const Mat34 P_R = pinHoleCamR->getProjectiveEquivalent(poseR);
-
-      const Mat3 F_lr = F_from_P(P_L, P_R);
-      std::vector<feature::EImageDescriberType> commonDescTypes = regionsPerView.getCommonDescTypes(*it);
-      
-      matching::MatchesPerDescType allImagePairMatches;
-      for(feature::EImageDescriberType descType: commonDescTypes)
-      {
-        std::vector<matching::IndMatch> matches;
-#ifdef ALICEVISION_EXHAUSTIVE_MATCHING
-          matching::guidedMatching
-          <Mat3, multiview::relativePose::FundamentalEpipolarDistanceError>
-          (
-            F_lr,
-            iterIntrinsicL->second.get(),
-            regionsPerView.getRegions(it->first, descType),
-            iterIntrinsicR->second.get(),
-            regionsPerView.getRegions(it->second, descType),
-            // descType,
-            Square(thresholdF), Square(0.8),
-            matches
-          );
-      #else
-        const Vec3 epipole2  = epipole_from_P(P_R, poseL);
-
-        //const feature::Regions& regions = regionsPerView.getRegions(it->first);
-        matching::guidedMatchingFundamentalFast<multiview::relativePose::FundamentalEpipolarDistanceError>
-          (
-            F_lr,
-            epipole2,
-            iterIntrinsicL->second.get(),
-            regionsPerView.getRegions(it->first, descType),
-            iterIntrinsicR->second.get(),
-            regionsPerView.getRegions(it->second, descType),
-            iterIntrinsicR->second->w(), iterIntrinsicR->second->h(),
-            //descType,
-            Square(geometricErrorMax), Square(0.8),
-            matches
-          );
-      #endif
-         allImagePairMatches[descType] = matches;
-      }
+    const Mat34 P_L = pinHoleCamL->getProjectiveEquivalent(poseL);
+    const Mat34 P_R = pinHoleCamR->getProjectiveEquivalent(poseR);
 
-      #pragma omp critical
-      {
-        ++progressDisplay;
-        _putativeMatches[*it] = allImagePairMatches;
-      }
+    const Mat3 F_lr = F_from_P(P_L, P_R);
+    std::vector<feature::EImageDescriberType> commonDescTypes = regionsPerView.getCommonDescTypes(pair);
+
+    matching::MatchesPerDescType allImagePairMatches;
+    for(feature::EImageDescriberType descType: commonDescTypes)
+    {
+      std::vector<matching::IndMatch> matches;
+#ifdef ALICEVISION_EXHAUSTIVE_MATCHING
+      matching::guidedMatching
+        <Mat3, multiview::relativePose::FundamentalEpipolarDistanceError>
+        (
+          F_lr,
+          iterIntrinsicL->second.get(),
+          regionsPerView.getRegions(pair.first, descType),
+          iterIntrinsicR->second.get(),
+          regionsPerView.getRegions(pair.second, descType),
+          // descType,
+          Square(thresholdF), Square(0.8),
+          matches
+        );
+#else
+      const Vec3 epipole2  = epipole_from_P(P_R, poseL);
+
+      // the left features are bucketed by the intersection of their epipolar line with the right image border,
+      // so each right feature is only compared to the features of the buckets within the error band
+      matching::guidedMatchingFundamentalFast<multiview::relativePose::FundamentalEpipolarDistanceError>
+        (
+          F_lr,
+          epipole2,
+          iterIntrinsicL->second.get(),
+          regionsPerView.getRegions(pair.first, descType),
+          iterIntrinsicR->second.get(),
+          regionsPerView.getRegions(pair.second, descType),
+          iterIntrinsicR->second->w(), iterIntrinsicR->second->h(),
+          //descType,
+          Square(geometricErrorMax), Square(0.8),
+          matches
+        );
+#endif
+      allImagePairMatches[descType] = std::move(matches);
     }
+
+    #pragma omp critical
+    {
+      ++progressDisplay;
+      _putativeMatches[pair] = std::move(allImagePairMatches);
     }
   }
 }
@@ -181,83 +188,130 @@ void StructureEstimationFromKnownPoses::filter(
   typedef std::vector< graph::Triplet > Triplets;
   const Triplets triplets = graph::tripletListing(pairs);
 
-  auto progressDisplay = system::createConsoleProgressDisplay(triplets.size(), std::cout,
-    "Per triplet tracks validation (discard spurious correspondences):\n" );
-  #pragma omp parallel
-  for( Triplets::const_iterator it = triplets.begin(); it != triplets.end(); ++it)
+  // number of triplets still using the putative matches of each pair:
+  // the matches of a pair are released once all its triplets are validated, so they are not all kept in memory
+  std::map<Pair, int> nbRemainingTriplets;
+  for (const graph::Triplet& triplet : triplets)
   {
-    #pragma omp single nowait
+    for (const Pair& pair : {std::make_pair(triplet.i, triplet.j), std::make_pair(triplet.i, triplet.k), std::make_pair(triplet.j, triplet.k)})
     {
-      ++progressDisplay;
+      if (_putativeMatches.count(pair))
+        ++nbRemainingTriplets[pair];
+    }
+  }
+  for (auto& pairMatches : _putativeMatches)
+  {
+    if (!nbRemainingTriplets.count(pairMatches.first))
+      matching::MatchesPerDescType().swap(pairMatches.second);
+  }
+
+  // validated matches of each thread, merged at the end
+  std::vector<matching::PairwiseMatches> tripletMatchesPerThread(omp_get_max_threads());
 
-      const graph::Triplet & triplet = *it;
-      const IndexT I = triplet.i, J = triplet.j , K = triplet.k;
+  auto progressDisplay = system::createConsoleProgressDisplay(triplets.size(), std::cout,
+    "Per triplet tracks validation (discard spurious correspondences):\n" );
+
+  #pragma omp parallel for schedule(dynamic)
+  for (int t = 0; t < triplets.size(); ++t)
+  {
+    const graph::Triplet & triplet = triplets[t];
+    const IndexT I = triplet.i, J = triplet.j , K = triplet.k;
+    const std::array<Pair, 3> tripletPairs = {std::make_pair(I,J), std::make_pair(I,K), std::make_pair(J,K)};
 
-      track::TracksMap map_tracksCommon;
+    track::TracksMap map_tracksCommon;
+    {
       track::TracksBuilder tracksBuilder;
+      matching::PairwiseMatches map_matchesIJK;
+      for (const Pair& pair : tripletPairs)
       {
-        matching::PairwiseMatches map_matchesIJK;
-        if (_putativeMatches.count(std::make_pair(I,J)))
-          map_matchesIJK.insert(*_putativeMatches.find(std::make_pair(I,J)));
+        const auto it = _putativeMatches.find(pair);
+        if (it != _putativeMatches.end())
+          map_matchesIJK.insert(*it);
+      }
 
-        if (_putativeMatches.count(std::make_pair(I,K)))
-          map_matchesIJK.insert(*_putativeMatches.find(std::make_pair(I,K)));
+      if (map_matchesIJK.size() >= 2) {
+        tracksBuilder.build(map_matchesIJK);
+        tracksBuilder.filter(true,3, false);
+        tracksBuilder.exportToSTL(map_tracksCommon);
+      }
+    }
 
-        if (_putativeMatches.count(std::make_pair(J,K)))
-          map_matchesIJK.insert(*_putativeMatches.find(std::make_pair(J,K)));
+    #pragma omp critical
+    {
+      ++progressDisplay;
+      for (const Pair& pair : tripletPairs)
+      {
+        const auto it = nbRemainingTriplets.find(pair);
+        if (it != nbRemainingTriplets.end() && --(it->second) == 0)
+          matching::MatchesPerDescType().swap(_putativeMatches.at(pair));
+      }
+    }
 
-        if (map_matchesIJK.size() >= 2) {
-          tracksBuilder.build(map_matchesIJK);
-          tracksBuilder.filter(true,3, false);
-          tracksBuilder.exportToSTL(map_tracksCommon);
-        }
+    matching::PairwiseMatches& tripletMatches = tripletMatchesPerThread[omp_get_thread_num()];
 
-        // Triangulate the tracks
-        for (track::TracksMap::const_iterator iterTracks = map_tracksCommon.begin();
-          iterTracks != map_tracksCommon.end(); ++iterTracks) {
-          {
-            const track::Track & subTrack = iterTracks->second;
-            multiview::Triangulation trianObj;
-            for (auto iter = subTrack.featPerView.begin(); iter != subTrack.featPerView.end(); ++iter)
-            {
-              const size_t imaIndex = iter->first;
-              const size_t featIndex = iter->second;
-              const View * view = sfmData.getViews().at(imaIndex).get();
-              
-              std::shared_ptr<camera::IntrinsicBase> cam = sfmData.getIntrinsics().at(view->getIntrinsicId());
-              std::shared_ptr<camera::Pinhole> camPinHole = std::dynamic_pointer_cast<camera::Pinhole>(cam);
-              if (!camPinHole) {
-                ALICEVISION_LOG_ERROR("Camera is not pinhole in filter");
-                continue;
-              }
-
-              const Pose3 pose = sfmData.getPose(*view).getTransform();
-              const Vec2 pt = regionsPerView.getRegions(imaIndex, subTrack.descType).GetRegionPosition(featIndex);
-              trianObj.add(camPinHole->getProjectiveEquivalent(pose), cam->get_ud_pixel(pt));
-            }
-            const Vec3 Xs = trianObj.compute();
-            if (trianObj.minDepth() > 0 && trianObj.error()/(double)trianObj.size() < 4.0)
-            // TODO: Add an angular check ?
-            {
-              #pragma omp critical
-              {
-                track::Track::FeatureIdPerView::const_iterator iterI, iterJ, iterK;
-                iterI = iterJ = iterK = subTrack.featPerView.begin();
-                std::advance(iterJ,1);
-                std::advance(iterK,2);
-
-                _tripletMatches[std::make_pair(I,J)][subTrack.descType].emplace_back(iterI->second, iterJ->second);
-                _tripletMatches[std::make_pair(J,K)][subTrack.descType].emplace_back(iterJ->second, iterK->second);
-                _tripletMatches[std::make_pair(I,K)][subTrack.descType].emplace_back(iterI->second, iterK->second);
-              }
-            }
-          }
+    // Triangulate the tracks
+    for (track::TracksMap::const_iterator iterTracks = map_tracksCommon.begin();
+      iterTracks != map_tracksCommon.end(); ++iterTracks)
+    {
+      const track::Track & subTrack = iterTracks->second;
+      multiview::Triangulation trianObj;
+      for (auto iter = subTrack.featPerView.begin(); iter != subTrack.featPerView.end(); ++iter)
+      {
+        const size_t imaIndex = iter->first;
+        const size_t featIndex = iter->second;
+        const View * view = sfmData.getViews().at(imaIndex).get();
+
+        std::shared_ptr<camera::IntrinsicBase> cam = sfmData.getIntrinsics().at(view->getIntrinsicId());
+        std::shared_ptr<camera::Pinhole> camPinHole = std::dynamic_pointer_cast<camera::Pinhole>(cam);
+        if (!camPinHole) {
+          ALICEVISION_LOG_ERROR("Camera is not pinhole in filter");
+          continue;
         }
+
+        const Pose3 pose = sfmData.getPose(*view).getTransform();
+        const Vec2 pt = regionsPerView.getRegions(imaIndex, subTrack.descType).GetRegionPosition(featIndex);
+        trianObj.add(camPinHole->getProjectiveEquivalent(pose), cam->get_ud_pixel(pt));
+      }
+      const Vec3 Xs = trianObj.compute();
+      if (trianObj.minDepth() > 0 && trianObj.error()/(double)trianObj.size() < 4.0)
+      // TODO: Add an angular check ?
+      {
+        track::Track::FeatureIdPerView::const_iterator iterI, iterJ, iterK;
+        iterI = iterJ = iterK = subTrack.featPerView.begin();
+        std::advance(iterJ,1);
+        std::advance(iterK,2);
+
+        tripletMatches[std::make_pair(I,J)][subTrack.descType].emplace_back(iterI->second, iterJ->second);
+        tripletMatches[std::make_pair(J,K)][subTrack.descType].emplace_back(iterJ->second, iterK->second);
+        tripletMatches[std::make_pair(I,K)][subTrack.descType].emplace_back(iterI->second, iterK->second);
       }
     }
   }
   // Clear putatives matches since they are no longer required
   matching::PairwiseMatches().swap(_putativeMatches);
+
+  // Merge the validated matches, a match validated by several triplets is kept once
+  for (matching::PairwiseMatches& tripletMatches : tripletMatchesPerThread)
+  {
+    for (auto& pairMatches : tripletMatches)
+    {
+      for (auto& descMatches : pairMatches.second)
+      {
+        matching::IndMatches& matches = _tripletMatches[pairMatches.first][descMatches.first];
+        matches.insert(matches.end(), descMatches.second.begin(), descMatches.second.end());
+      }
+    }
+    matching::PairwiseMatches().swap(tripletMatches);
+  }
+  for (auto& pairMatches : _tripletMatches)
+  {
+    for (auto& descMatches : pairMatches.second)
+    {
+      matching::IndMatches& matches = descMatches.second;
+      std::sort(matches.begin(), matches.end());
+      matches.erase(std::unique(matches.begin(), matches.end()), matches.end());
+    }
+  }
 }
 
 /// Init & triangulate landmark observations from validated 3-view correspondences
@@ -267,25 +321,27 @@ void StructureEstimationFromKnownPoses::triangulate(
   std::mt19937 &randomNumberGenerator)
 {
   track::TracksMap map_tracksCommon;
-  track::TracksBuilder tracksBuilder;
-  tracksBuilder.build(_tripletMatches);
-  tracksBuilder.filter(true,3);
-  tracksBuilder.exportToSTL(map_tracksCommon);
-  matching::PairwiseMatches().swap(_tripletMatches);
+  {
+    track::TracksBuilder tracksBuilder;
+    tracksBuilder.build(_tripletMatches);
+    matching::PairwiseMatches().swap(_tripletMatches);
+    tracksBuilder.filter(true,3);
+    tracksBuilder.exportToSTL(map_tracksCommon);
+  }
 
   // Generate new Structure tracks
   sfmData.structure.clear();
 
-  // Fill sfm_data with the computed tracks (no 3D yet)
+  // Fill sfm_data with the computed tracks (no 3D yet),
+  // each track is released once converted to a landmark (from the last one, to erase them in constant time)
   Landmarks & structure = sfmData.structure;
-  IndexT idx(0);
-  for (track::TracksMap::const_iterator itTracks = map_tracksCommon.begin();
-    itTracks != map_tracksCommon.end();
-    ++itTracks, ++idx)
+  for (IndexT idx = map_tracksCommon.size(); idx > 0; --idx)
   {
+    const auto itTracks = std::prev(map_tracksCommon.end());
     const track::Track & track = itTracks->second;
-    structure[idx] = Landmark(track.descType);
-    Observations & observations = structure.at(idx).observations;
+    Landmark& landmark = structure[idx - 1];
+    landmark = Landmark(track.descType);
+    Observations & observations = landmark.observations;
     for (auto it = track.featPerView.begin(); it != track.featPerView.end(); ++it)
     {
       const size_t imaIndex = it->first;
@@ -295,6 +351,7 @@ void StructureEstimationFromKnownPoses::triangulate(
 
       observations[imaIndex] = Observation(feat.coords().cast<double>(), featIndex, feat.scale());
     }
+    map_tracksCommon.erase(itTracks);
   }
 
   // Triangulate them using a robust triangulation scheme
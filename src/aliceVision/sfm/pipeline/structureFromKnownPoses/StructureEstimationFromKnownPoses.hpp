@@ -34,6 +34,7 @@ public:
     double geometricErrorMax);
 
   /// Filter inconsistent correspondences by using 3-view correspondences on view triplets
+  /// (the putative matches of a pair are released once all its triplets are validated)
   void filter(
     const sfmData::SfMData& sfmData,
     const PairSet& pairs,
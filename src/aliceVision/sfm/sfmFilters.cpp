@@ -7,44 +7,75 @@
 
 #include "sfmFilters.hpp"
 #include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfmData/LandmarksColumns.hpp>
 #include <aliceVision/stl/stl.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/sfm/BundleAdjustment.hpp>
 
+#include <algorithm>
+#include <cstdint>
 #include <iterator>
 
 namespace aliceVision {
 namespace sfm {
 
+namespace {
+
+/**
+ * @brief Columnar copy of the whole structure, or only of the given landmarks.
+ */
+sfmData::LandmarksColumns getLandmarksColumns(const sfmData::Landmarks& landmarks, const std::vector<IndexT>* landmarkIds)
+{
+  if(landmarkIds == nullptr)
+    return sfmData::LandmarksColumns(landmarks);
+  return sfmData::LandmarksColumns(landmarks, *landmarkIds);
+}
+
+} // namespace
+
 IndexT RemoveOutliers_PixelResidualError(sfmData::SfMData& sfmData,
                                          EFeatureConstraint featureConstraint,
                                          const double dThresholdPixel,
-                                         const unsigned int minTrackLength)
+                                         const unsigned int minTrackLength,
+                                         const std::vector<IndexT>* landmarkIds)
 {
-  IndexT outlier_count = 0;
-  sfmData::Landmarks::iterator iterTracks = sfmData.structure.begin();
-
+  // evaluate the observations on a columnar copy of the structure
+  const sfmData::LandmarksColumns columns = getLandmarksColumns(sfmData.structure, landmarkIds);
+  const sfmData::ObservationCameras cameras(sfmData, columns);
+  std::vector<unsigned char> isOutlier(columns.nbObservations(), 0);
 
-  while(iterTracks != sfmData.structure.end())
+  #pragma omp parallel for
+  for(std::int64_t landmarkIndex = 0; landmarkIndex < static_cast<std::int64_t>(columns.size()); ++landmarkIndex)
   {
-    sfmData::Observations & observations = iterTracks->second.observations;
-    sfmData::Observations::iterator itObs = observations.begin();
-
-    while(itObs != observations.end())
+    const Vec3 X = columns.positions.col(landmarkIndex);
+    for(std::size_t o = columns.observationOffsets[landmarkIndex]; o < columns.observationOffsets[landmarkIndex + 1]; ++o)
     {
-      const sfmData::View * view = sfmData.views.at(itObs->first).get();
-      const geometry::Pose3 pose = sfmData.getPose(*view).getTransform();
-      const camera::IntrinsicBase * intrinsic = sfmData.intrinsics.at(view->getIntrinsicId()).get();
-
-      Vec2 residual = intrinsic->residual(pose, iterTracks->second.X.homogeneous(), itObs->second.x);
-      if(featureConstraint == EFeatureConstraint::SCALE && itObs->second.scale > 0.0)
+      const geometry::Pose3& pose = cameras.getPose(o);
+      Vec2 residual = cameras.getIntrinsic(o)->residual(pose, X.homogeneous(), columns.observationPoints.col(o));
+      if(featureConstraint == EFeatureConstraint::SCALE && columns.observationScales[o] > 0.0)
       {
           // Apply the scale of the feature to get a residual value
           // relative to the feature precision.
-          residual /= itObs->second.scale;
+          residual /= columns.observationScales[o];
       }
 
-      if((pose.depth(iterTracks->second.X) < 0) || (residual.norm() > dThresholdPixel))
+      isOutlier[o] = (pose.depth(X) < 0) || (residual.norm() > dThresholdPixel);
+    }
+  }
+
+  // remove the outliers
+  IndexT outlier_count = 0;
+
+  for(std::size_t landmarkIndex = 0; landmarkIndex < columns.size(); ++landmarkIndex)
+  {
+    const sfmData::Landmarks::iterator iterTracks = sfmData.structure.find(columns.landmarkIds[landmarkIndex]);
+    sfmData::Observations & observations = iterTracks->second.observations;
+    sfmData::Observations::iterator itObs = observations.begin();
+    std::size_t o = columns.observationOffsets[landmarkIndex];
+
+    while(itObs != observations.end())
+    {
+      if(isOutlier[o++])
       {
         ++outlier_count;
         itObs = observations.erase(itObs);
@@ -54,33 +85,31 @@ IndexT RemoveOutliers_PixelResidualError(sfmData::SfMData& sfmData,
     }
 
     if (observations.empty() || observations.size() < minTrackLength)
-      iterTracks = sfmData.structure.erase(iterTracks);
-    else
-      ++iterTracks;
+      sfmData.structure.erase(iterTracks);
   }
   return outlier_count;
 }
 
-IndexT RemoveOutliers_AngleError(sfmData::SfMData& sfmData, const double dMinAcceptedAngle)
+IndexT RemoveOutliers_AngleError(sfmData::SfMData& sfmData, const double dMinAcceptedAngle, const std::vector<IndexT>* landmarkIds)
 {
   // note that smallest accepted angle => largest accepted cos(angle)
   const double dMaxAcceptedCosAngle = std::cos(degreeToRadian(dMinAcceptedAngle));
 
-  using LandmarksKeysVec = std::vector<sfmData::Landmarks::key_type>;
-  LandmarksKeysVec v_keys; v_keys.reserve(sfmData.structure.size());
-  std::transform(sfmData.structure.cbegin(), sfmData.structure.cend(), std::back_inserter(v_keys), stl::RetrieveKey());
+  const sfmData::LandmarksColumns columns = getLandmarksColumns(sfmData.structure, landmarkIds);
+  const sfmData::ObservationCameras cameras(sfmData, columns);
 
-  LandmarksKeysVec toErase;
+  std::vector<sfmData::Landmarks::key_type> toErase;
 
   #pragma omp parallel for
-  for (int landmarkIndex = 0; landmarkIndex < v_keys.size(); ++landmarkIndex)
+  for (int landmarkIndex = 0; landmarkIndex < columns.size(); ++landmarkIndex)
   {
-    const sfmData::Observations &observations = sfmData.structure.at(v_keys[landmarkIndex]).observations;
+    const std::size_t obsBegin = columns.observationOffsets[landmarkIndex];
+    const std::size_t obsEnd = columns.observationOffsets[landmarkIndex + 1];
 
     // create matrix for observation directions from camera to point
-    Mat3X viewDirections(3, observations.size());
+    Mat3X viewDirections(3, obsEnd - obsBegin);
     Mat3X::Index i;
-    sfmData::Observations::const_iterator itObs;
+    std::size_t o;
     
     // Greedy algorithm almost always finds an acceptable angle in 1-5 iterations (if it exists).
     // It works by greedily chasing the first larger view angle found from the current greedy index.
@@ -91,13 +120,9 @@ IndexT RemoveOutliers_AngleError(sfmData::SfMData& sfmData, const double dMinAcc
 
 
     // fill matrix, optimistically checking each new entry against col(greedyI)
-    for(itObs = observations.begin(), i = 0; itObs != observations.end(); ++itObs, ++i)
+    for(o = obsBegin, i = 0; o != obsEnd; ++o, ++i)
     {
-      const sfmData::View * view = sfmData.views.at(itObs->first).get();
-      const geometry::Pose3 pose = sfmData.getPose(*view).getTransform();
-      const camera::IntrinsicBase * intrinsic = sfmData.intrinsics.at(view->getIntrinsicId()).get();
-
-      viewDirections.col(i) = applyIntrinsicExtrinsic(pose, intrinsic, itObs->second.x);
+      viewDirections.col(i) = applyIntrinsicExtrinsic(cameras.getPose(o), cameras.getIntrinsic(o), columns.observationPoints.col(o));
 
       double dCosAngle = viewDirections.col(i).transpose() * viewDirections.col(greedyI);
       if (dCosAngle < dMaxAcceptedCosAngle)
@@ -112,7 +137,7 @@ IndexT RemoveOutliers_AngleError(sfmData::SfMData& sfmData, const double dMinAcc
     }
 
     // early exit, acceptable angle found
-    if (itObs != observations.end())
+    if (o != obsEnd)
     {
       continue;
     }
@@ -140,7 +165,7 @@ IndexT RemoveOutliers_AngleError(sfmData::SfMData& sfmData, const double dMinAcc
     if (i == 0)
     {
       #pragma omp critical
-      toErase.push_back(v_keys[landmarkIndex]);
+      toErase.push_back(columns.landmarkIds[landmarkIndex]);
     }
   }
 
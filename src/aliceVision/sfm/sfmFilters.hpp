@@ -10,6 +10,8 @@
 #include <aliceVision/types.hpp>
 #include <aliceVision/sfm/BundleAdjustment.hpp>
 
+#include <vector>
+
 namespace aliceVision {
 
 namespace sfmData {
@@ -32,15 +34,19 @@ inline PairSet Pair_filter(const IterablePairs& pairs, const IterableIndex& inde
 }
 
 /// Remove observations with too large reprojection error.
+/// Only the landmarks in landmarkIds are evaluated if it is given.
 /// Return the number of removed tracks.
 IndexT RemoveOutliers_PixelResidualError(sfmData::SfMData& sfmData,
                                          EFeatureConstraint featureConstraint,
                                          const double dThresholdPixel,
-                                         const unsigned int minTrackLength = 2);
+                                         const unsigned int minTrackLength = 2,
+                                         const std::vector<IndexT>* landmarkIds = nullptr);
 
 // Remove tracks that have a small angle (tracks with tiny angle leads to instable 3D points)
+// Only the landmarks in landmarkIds are evaluated if it is given.
 // Return the number of removed tracks
-IndexT RemoveOutliers_AngleError(sfmData::SfMData& sfmData, const double dMinAcceptedAngle);
+IndexT RemoveOutliers_AngleError(sfmData::SfMData& sfmData, const double dMinAcceptedAngle,
+                                 const std::vector<IndexT>* landmarkIds = nullptr);
 
 bool eraseUnstablePoses(sfmData::SfMData& sfmData, const IndexT min_points_per_pose, std::set<IndexT> *outRemovedViewsId = NULL);
 
@@ -6,6 +6,8 @@
 
 #include "sfmStatistics.hpp"
 
+#include <cstdint>
+
 #include <aliceVision/sfm/pipeline/localization/SfMLocalizer.hpp>
 
 #include <aliceVision/sfm/pipeline/regionsIO.hpp>
@@ -16,6 +18,19 @@
 namespace aliceVision {
 namespace sfm {
 
+void computeObservationsResiduals(const sfmData::LandmarksColumns& columns, const sfmData::ObservationCameras& cameras, Mat2X& out_residuals)
+{
+  out_residuals.resize(2, columns.nbObservations());
+
+  #pragma omp parallel for
+  for(std::int64_t landmarkIndex = 0; landmarkIndex < static_cast<std::int64_t>(columns.size()); ++landmarkIndex)
+  {
+    const Vec4 X = columns.positions.col(landmarkIndex).homogeneous();
+    for(std::size_t o = columns.observationOffsets[landmarkIndex]; o < columns.observationOffsets[landmarkIndex + 1]; ++o)
+      out_residuals.col(o) = cameras.getIntrinsic(o)->residual(cameras.getPose(o), X, columns.observationPoints.col(o));
+  }
+}
+
 void computeResidualsHistogram(const sfmData::SfMData& sfmData, BoxStats<double>& out_stats, utils::Histogram<double>* out_histogram, const std::set<IndexT>& specificViews)
 {
   {
@@ -30,30 +45,23 @@ void computeResidualsHistogram(const sfmData::SfMData& sfmData, BoxStats<double>
     return;
 
   // Collect residuals for each observation
+  const sfmData::LandmarksColumns columns(sfmData.getLandmarks());
+  Mat2X residuals;
+  computeObservationsResiduals(columns, sfmData::ObservationCameras(sfmData, columns), residuals);
+
   std::vector<double> vec_residuals;
-  vec_residuals.reserve(sfmData.structure.size());
+  vec_residuals.reserve(columns.nbObservations());
 
-  for(const auto &track : sfmData.getLandmarks())
+  for(std::size_t o = 0; o < columns.nbObservations(); ++o)
   {
-    const aliceVision::sfmData::Observations & observations = track.second.observations;
-    for(const auto& obs: observations)
+    if(!specificViews.empty())
     {
-      if(!specificViews.empty())
-      {
-          if(specificViews.count(obs.first) == 0)
-              continue;
-      }
-      const sfmData::View& view = sfmData.getView(obs.first);
-      const aliceVision::geometry::Pose3 pose = sfmData.getPose(view).getTransform();
-      const std::shared_ptr<aliceVision::camera::IntrinsicBase> intrinsic = sfmData.getIntrinsics().find(view.getIntrinsicId())->second;
-      const Vec2 residual = intrinsic->residual(pose, track.second.X.homogeneous(), obs.second.x);
-      vec_residuals.push_back(residual.norm());
-      //ALICEVISION_LOG_INFO("[AliceVision] sfmtstatistics::computeResidualsHistogram track: " << track.first << ", residual: " << residual.norm());
+        if(specificViews.count(columns.observationViewIds[o]) == 0)
+            continue;
     }
+    vec_residuals.push_back(residuals.col(o).norm());
   }
 
- // ALICEVISION_LOG_INFO("[AliceVision] sfmtstatistics::computeResidualsHistogram vec_residuals.size(): " << vec_residuals.size());
-
   if(vec_residuals.empty())
       return;
 
@@ -141,11 +149,7 @@ void computeLandmarksPerViewHistogram(const sfmData::SfMData& sfmData, BoxStats<
         for(const auto& obsIt: landmark.second.observations)
         {
             const auto& viewId = obsIt.first;
-            auto it = nbLandmarksPerView.find(viewId);
-            if(it != nbLandmarksPerView.end())
-                ++(it->second);
-            else
-                it->second = 1;
+            ++nbLandmarksPerView[viewId];
         }
     }
     if(nbLandmarksPerView.empty())
@@ -319,20 +323,18 @@ void computeResidualsPerView(const sfmData::SfMData& sfmData, int& nbViews, std:
     nbResidualsPerViewThirdQuartile.resize(nbViews);
 
     // Collect residuals (number of residuals per 3D points) of all landmarks visible in each view
-    std::map<IndexT, std::vector<double>> residualsPerView;
+    const sfmData::LandmarksColumns columns(sfmData.getLandmarks());
+    const sfmData::ObservationCameras cameras(sfmData, columns);
+    Mat2X residuals;
+    computeObservationsResiduals(columns, cameras, residuals);
 
-    for(const auto &landmark : sfmData.getLandmarks())
-    {
-      const aliceVision::sfmData::Observations & observations = landmark.second.observations;
-      for(const auto& obs: observations)
-      {
-        const sfmData::View& view = sfmData.getView(obs.first);
-        const aliceVision::geometry::Pose3 pose = sfmData.getPose(view).getTransform();
-        const std::shared_ptr<aliceVision::camera::IntrinsicBase> intrinsic = sfmData.getIntrinsics().find(view.getIntrinsicId())->second;
-        const Vec2 residual = intrinsic->residual(pose, landmark.second.X.homogeneous(), obs.second.x);
-        residualsPerView[obs.first].push_back(residual.norm());
-      }
-    }
+    std::vector<std::vector<double>> residualsPerViewIndex(cameras.getViewIds().size());
+    for(std::size_t o = 0; o < columns.nbObservations(); ++o)
+        residualsPerViewIndex[cameras.getViewIndex(o)].push_back(residuals.col(o).norm());
+
+    std::map<IndexT, std::vector<double>> residualsPerView;
+    for(std::size_t i = 0; i < residualsPerViewIndex.size(); ++i)
+        residualsPerView[cameras.getViewIds()[i]].swap(residualsPerViewIndex[i]);
 
     std::vector<IndexT> viewKeys;
     for(const auto& v: sfmData.getViews())
@@ -393,11 +395,15 @@ void computeObservationsLengthsPerView(const sfmData::SfMData& sfmData, int& nbV
     for(const auto& v: sfmData.getViews())
         viewKeys.push_back(v.first);
 
+    const std::vector<int> noObservations;
+
     #pragma omp parallel for
     for(int viewIdx = 0; viewIdx < nbViews; ++viewIdx)
     {
         const IndexT viewId = viewKeys[viewIdx];
-        const std::vector<int>& nbObservations = observationLengthsPerView[viewId];
+        // no insertion in the map from the threads
+        const auto it = observationLengthsPerView.find(viewId);
+        const std::vector<int>& nbObservations = (it != observationLengthsPerView.end()) ? it->second : noObservations;
         BoxStats<double> observationsLengthsStats(nbObservations.begin(), nbObservations.end());
         utils::Histogram<double> observationsLengths_histogram(observationsLengthsStats.min, observationsLengthsStats.max + 1, observationsLengthsStats.max - observationsLengthsStats.min + 1);
         observationsLengths_histogram.Add(nbObservations.begin(), nbObservations.end());
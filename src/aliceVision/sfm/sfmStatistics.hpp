@@ -7,6 +7,7 @@
 #pragma once
 
 #include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfmData/LandmarksColumns.hpp>
 #include <aliceVision/numeric/numeric.hpp>
 #include <aliceVision/track/Track.hpp>
 #include <aliceVision/track/tracksUtils.hpp>
@@ -18,6 +19,14 @@
 namespace aliceVision {
 namespace sfm {
 
+/**
+ * @brief Compute the residual between each landmark and its features, in parallel
+ * @param[in] columns : columnar copy of the scene landmarks
+ * @param[in] cameras : pose and intrinsic of each observation of the columns
+ * @param[out] out_residuals : residual of each observation of the columns
+ */
+void computeObservationsResiduals(const sfmData::LandmarksColumns& columns, const sfmData::ObservationCameras& cameras, Mat2X& out_residuals);
+
 /**
  * @brief Compute histogram of residual values between landmarks and features in all the views specified
  * @param[in] sfmData : scene containing the features and the landmarks
@@ -0,0 +1,331 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "sfmUncertainty.hpp"
+
+#include <aliceVision/alicevision_omp.hpp>
+#include <aliceVision/sfmData/LandmarksColumns.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+
+#include <Eigen/SparseCholesky>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace aliceVision {
+namespace sfm {
+
+namespace {
+
+using Mat6 = Eigen::Matrix<double, 6, 6>;
+using Mat26 = Eigen::Matrix<double, 2, 6>;
+using Mat63 = Eigen::Matrix<double, 6, 3>;
+using Mat16x6 = Eigen::Matrix<double, 16, 6>;
+
+template <typename T>
+using AlignedVector = std::vector<T, Eigen::aligned_allocator<T>>;
+
+/**
+ * @brief Derivative of the transform subPose * exp(xi) * pose in xi = 0, flattened in column-major order
+ *        like the derivatives of the intrinsics with respect to the pose.
+ *        xi = (rotation, translation) is the left perturbation of the pose.
+ */
+Mat16x6 getDerivativeTransformWrtPose(const Mat4& subPose, const Mat4& pose)
+{
+  Mat16x6 d;
+  for(int k = 0; k < 6; ++k)
+  {
+    Mat4 generator = Mat4::Zero();
+    if(k < 3)
+      generator.block<3, 3>(0, 0) = CrossProductMatrix(Vec3::Unit(k));
+    else
+      generator(k - 3, 3) = 1.0;
+
+    const Mat4 dT = subPose * generator * pose;
+    d.col(k) = Eigen::Map<const Eigen::Matrix<double, 16, 1>>(dT.data());
+  }
+  return d;
+}
+
+} // namespace
+
+bool computeSparseUncertainty(sfmData::SfMData& sfmData, double observationSigma)
+{
+  system::Timer timer;
+
+  sfmData._posesUncertainty.clear();
+  sfmData._landmarksUncertainty.clear();
+
+  const sfmData::LandmarksColumns columns(sfmData.getLandmarks());
+  const sfmData::ObservationCameras cameras(sfmData, columns);
+  const std::size_t nbObservations = columns.nbObservations();
+  const std::vector<IndexT>& viewIds = cameras.getViewIds();
+
+  // pose and rig sub-pose of each observing view
+  std::vector<IndexT> poseIds;
+  std::vector<IndexT> viewPoseIds(viewIds.size());
+  AlignedVector<Mat4> viewSubPoses(viewIds.size(), Mat4::Identity());
+  for(std::size_t viewIndex = 0; viewIndex < viewIds.size(); ++viewIndex)
+  {
+    const sfmData::View& view = sfmData.getView(viewIds[viewIndex]);
+    viewPoseIds[viewIndex] = view.getPoseId();
+    if(view.isPartOfRig() && !view.isPoseIndependant())
+      viewSubPoses[viewIndex] = sfmData.getRig(view).getSubPose(view.getSubPoseId()).pose.getHomogeneous();
+  }
+  poseIds = viewPoseIds;
+  std::sort(poseIds.begin(), poseIds.end());
+  poseIds.erase(std::unique(poseIds.begin(), poseIds.end()), poseIds.end());
+
+  if(poseIds.size() < 2)
+  {
+    ALICEVISION_LOG_WARNING("Cannot estimate the uncertainty with " << poseIds.size() << " observing pose(s).");
+    return false;
+  }
+
+  std::vector<std::size_t> viewPoseIndexes(viewIds.size());
+  AlignedVector<Mat16x6> viewTransformDerivatives(viewIds.size());
+  AlignedVector<Mat4> poseTransforms(poseIds.size());
+  for(std::size_t poseIndex = 0; poseIndex < poseIds.size(); ++poseIndex)
+    poseTransforms[poseIndex] = sfmData.getAbsolutePose(poseIds[poseIndex]).getTransform().getHomogeneous();
+  for(std::size_t viewIndex = 0; viewIndex < viewIds.size(); ++viewIndex)
+  {
+    viewPoseIndexes[viewIndex] = std::lower_bound(poseIds.begin(), poseIds.end(), viewPoseIds[viewIndex]) - poseIds.begin();
+    viewTransformDerivatives[viewIndex] = getDerivativeTransformWrtPose(viewSubPoses[viewIndex], poseTransforms[viewPoseIndexes[viewIndex]]);
+  }
+
+  // the pose with the most observations is the reference of the gauge,
+  // the other poses are the blocks of the reduced camera system
+  std::vector<std::size_t> observationPoses(nbObservations);
+  std::vector<std::size_t> nbObservationsPerPose(poseIds.size(), 0);
+  for(std::size_t o = 0; o < nbObservations; ++o)
+  {
+    observationPoses[o] = viewPoseIndexes[cameras.getViewIndex(o)];
+    ++nbObservationsPerPose[observationPoses[o]];
+  }
+  const std::size_t referencePose = std::max_element(nbObservationsPerPose.begin(), nbObservationsPerPose.end()) - nbObservationsPerPose.begin();
+
+  const std::size_t fixedBlock = std::numeric_limits<std::size_t>::max();
+  const std::size_t nbBlocks = poseIds.size() - 1;
+  std::vector<std::size_t> poseBlocks(poseIds.size());
+  for(std::size_t poseIndex = 0; poseIndex < poseIds.size(); ++poseIndex)
+    poseBlocks[poseIndex] = (poseIndex == referencePose) ? fixedBlock : (poseIndex < referencePose ? poseIndex : poseIndex - 1);
+
+  // jacobians of the observations and inverse of the landmarks blocks of the normal equations
+  const double weight = 1.0 / observationSigma;
+  AlignedVector<Mat26> poseJacobians(nbObservations);
+  AlignedVector<Mat63> poseLandmarkBlocks(nbObservations);
+  std::vector<Mat3> landmarkInverseBlocks(columns.size());
+  std::vector<char> validLandmarks(columns.size(), 0);
+  std::vector<std::size_t> observationLandmarks(nbObservations);
+
+  #pragma omp parallel for
+  for(std::int64_t l = 0; l < static_cast<std::int64_t>(columns.size()); ++l)
+  {
+    const Vec4 X = columns.positions.col(l).homogeneous();
+    Mat3 landmarkBlock = Mat3::Zero();
+
+    for(std::size_t o = columns.observationOffsets[l]; o < columns.observationOffsets[l + 1]; ++o)
+    {
+      observationLandmarks[o] = l;
+
+      const camera::IntrinsicBase* intrinsic = cameras.getIntrinsic(o);
+      const geometry::Pose3& pose = cameras.getPose(o);
+      const Eigen::Matrix<double, 2, 3> landmarkJacobian = weight * intrinsic->getDerivativeProjectWrtPoint(pose, X).leftCols<3>();
+      landmarkBlock += landmarkJacobian.transpose() * landmarkJacobian;
+
+      if(poseBlocks[observationPoses[o]] == fixedBlock)
+        continue;
+
+      poseJacobians[o] = weight * intrinsic->getDerivativeProjectWrtPose(pose, X) * viewTransformDerivatives[cameras.getViewIndex(o)];
+      poseLandmarkBlocks[o] = poseJacobians[o].transpose() * landmarkJacobian;
+    }
+
+    bool invertible = false;
+    landmarkBlock.computeInverseWithCheck(landmarkInverseBlocks[l], invertible);
+    validLandmarks[l] = invertible;
+  }
+
+  // pose -> observations index (CSR layout), for the valid landmarks
+  std::vector<std::size_t> blockOffsets(nbBlocks + 1, 0);
+  std::vector<std::size_t> blockObservations;
+  {
+    for(std::size_t o = 0; o < nbObservations; ++o)
+    {
+      const std::size_t block = poseBlocks[observationPoses[o]];
+      if(block != fixedBlock && validLandmarks[observationLandmarks[o]])
+        ++blockOffsets[block + 1];
+    }
+    std::partial_sum(blockOffsets.begin(), blockOffsets.end(), blockOffsets.begin());
+
+    blockObservations.resize(blockOffsets.back());
+    std::vector<std::size_t> blockCursors(blockOffsets.begin(), blockOffsets.end() - 1);
+    for(std::size_t o = 0; o < nbObservations; ++o)
+    {
+      const std::size_t block = poseBlocks[observationPoses[o]];
+      if(block != fixedBlock && validLandmarks[observationLandmarks[o]])
+        blockObservations[blockCursors[block]++] = o;
+    }
+  }
+
+  // the scale of the gauge is the distance between the reference pose and the pose sharing the most landmarks with it
+  std::size_t scalePose = (referencePose == 0) ? 1 : 0;
+  {
+    std::vector<std::size_t> nbCommonObservations(poseIds.size(), 0);
+    for(std::size_t l = 0; l < columns.size(); ++l)
+    {
+      if(!validLandmarks[l])
+        continue;
+      const auto obsBegin = observationPoses.begin() + columns.observationOffsets[l];
+      const auto obsEnd = observationPoses.begin() + columns.observationOffsets[l + 1];
+      if(std::find(obsBegin, obsEnd, referencePose) == obsEnd)
+        continue;
+      for(auto it = obsBegin; it != obsEnd; ++it)
+        if(*it != referencePose)
+          ++nbCommonObservations[*it];
+    }
+    if(*std::max_element(nbCommonObservations.begin(), nbCommonObservations.end()) > 0)
+      scalePose = std::max_element(nbCommonObservations.begin(), nbCommonObservations.end()) - nbCommonObservations.begin();
+  }
+  const std::size_t scaleBlock = poseBlocks[scalePose];
+  Vec6 scaleDirection = Vec6::Zero();
+  {
+    const Vec3 referenceCenter = sfmData.getAbsolutePose(poseIds[referencePose]).getTransform().center();
+    const Vec3 scaleCenter = sfmData.getAbsolutePose(poseIds[scalePose]).getTransform().center();
+    // the center of a pose moves by -R^T * dt with the translation perturbation dt
+    scaleDirection.tail<3>() = poseTransforms[scalePose].block<3, 3>(0, 0) * (scaleCenter - referenceCenter).normalized();
+  }
+
+  // reduced camera system: S = U - W * V^-1 * W^T, assembled by rows of pose blocks
+  std::vector<std::vector<Eigen::Triplet<double>>> rowTriplets(nbBlocks);
+
+  #pragma omp parallel for schedule(dynamic)
+  for(std::int64_t i = 0; i < static_cast<std::int64_t>(nbBlocks); ++i)
+  {
+    HashMap<std::size_t, Mat6> rowBlocks;
+    Mat6& diagonalBlock = rowBlocks.emplace(i, Mat6::Zero()).first->second;
+
+    for(std::size_t k = blockOffsets[i]; k < blockOffsets[i + 1]; ++k)
+    {
+      const std::size_t o = blockObservations[k];
+      const std::size_t l = observationLandmarks[o];
+      diagonalBlock += poseJacobians[o].transpose() * poseJacobians[o];
+
+      const Mat63 reducedBlock = poseLandmarkBlocks[o] * landmarkInverseBlocks[l];
+      for(std::size_t o2 = columns.observationOffsets[l]; o2 < columns.observationOffsets[l + 1]; ++o2)
+      {
+        const std::size_t j = poseBlocks[observationPoses[o2]];
+        if(j == fixedBlock)
+          continue;
+        auto it = rowBlocks.find(j);
+        if(it == rowBlocks.end())
+          it = rowBlocks.emplace(j, Mat6::Zero()).first;
+        it->second.noalias() -= reducedBlock * poseLandmarkBlocks[o2].transpose();
+      }
+    }
+
+    // strong prior on the distance to the reference pose
+    if(i == scaleBlock)
+      diagonalBlock += 1e6 * diagonalBlock.diagonal().maxCoeff() * scaleDirection * scaleDirection.transpose();
+
+    std::vector<Eigen::Triplet<double>>& triplets = rowTriplets[i];
+    triplets.reserve(rowBlocks.size() * 36);
+    for(const auto& rowBlock : rowBlocks)
+      for(int c = 0; c < 6; ++c)
+        for(int r = 0; r < 6; ++r)
+          triplets.emplace_back(6 * i + r, 6 * rowBlock.first + c, rowBlock.second(r, c));
+  }
+
+  sMat reducedSystem(6 * nbBlocks, 6 * nbBlocks);
+  {
+    std::vector<Eigen::Triplet<double>> triplets;
+    for(std::vector<Eigen::Triplet<double>>& row : rowTriplets)
+    {
+      triplets.insert(triplets.end(), row.begin(), row.end());
+      std::vector<Eigen::Triplet<double>>().swap(row);
+    }
+    reducedSystem.setFromTriplets(triplets.begin(), triplets.end());
+  }
+
+  const Eigen::SimplicialLLT<sMat> solver(reducedSystem);
+  if(solver.info() != Eigen::Success)
+  {
+    ALICEVISION_LOG_ERROR("The reduced camera system of the uncertainty estimation is not positive definite.");
+    return false;
+  }
+
+  // covariance columns of each pose: the pose covariance and its contribution to the landmarks covariance
+  // Cov(l) = V^-1 + V^-1 * (sum_i sum_j W_jl^T * Cov(j, i) * W_il) * V^-1
+  std::vector<Mat3> observationContributions(nbObservations, Mat3::Zero());
+  AlignedVector<Vec6> blockUncertainties(nbBlocks);
+
+  #pragma omp parallel for schedule(dynamic)
+  for(std::int64_t i = 0; i < static_cast<std::int64_t>(nbBlocks); ++i)
+  {
+    Eigen::MatrixXd unitColumns = Eigen::MatrixXd::Zero(6 * nbBlocks, 6);
+    unitColumns.block<6, 6>(6 * i, 0).setIdentity();
+    const Eigen::MatrixXd covarianceColumns = solver.solve(unitColumns);
+
+    const Mat6 covariance = covarianceColumns.block<6, 6>(6 * i, 0);
+    blockUncertainties[i] = Eigen::SelfAdjointEigenSolver<Mat6>(covariance, Eigen::EigenvaluesOnly).eigenvalues();
+
+    for(std::size_t k = blockOffsets[i]; k < blockOffsets[i + 1]; ++k)
+    {
+      const std::size_t o = blockObservations[k];
+      const std::size_t l = observationLandmarks[o];
+
+      Eigen::Matrix<double, 3, 6> landmarkPoseCovariance = Eigen::Matrix<double, 3, 6>::Zero();
+      for(std::size_t o2 = columns.observationOffsets[l]; o2 < columns.observationOffsets[l + 1]; ++o2)
+      {
+        const std::size_t j = poseBlocks[observationPoses[o2]];
+        if(j != fixedBlock)
+          landmarkPoseCovariance.noalias() += poseLandmarkBlocks[o2].transpose() * covarianceColumns.block<6, 6>(6 * j, 0);
+      }
+      observationContributions[o] = landmarkPoseCovariance * poseLandmarkBlocks[o];
+    }
+  }
+
+  for(std::size_t poseIndex = 0; poseIndex < poseIds.size(); ++poseIndex)
+  {
+    const std::size_t block = poseBlocks[poseIndex];
+    sfmData._posesUncertainty[poseIds[poseIndex]] = (block == fixedBlock) ? Vec6(Vec6::Zero()) : Vec6(blockUncertainties[block]);
+  }
+
+  std::vector<Vec3> landmarkUncertainties(columns.size(), Vec3::Zero());
+
+  #pragma omp parallel for
+  for(std::int64_t l = 0; l < static_cast<std::int64_t>(columns.size()); ++l)
+  {
+    if(!validLandmarks[l])
+      continue;
+
+    Mat3 poseContribution = Mat3::Zero();
+    for(std::size_t o = columns.observationOffsets[l]; o < columns.observationOffsets[l + 1]; ++o)
+      poseContribution += observationContributions[o];
+
+    const Mat3& inverseBlock = landmarkInverseBlocks[l];
+    const Mat3 covariance = inverseBlock + inverseBlock * poseContribution * inverseBlock;
+    landmarkUncertainties[l] = Eigen::SelfAdjointEigenSolver<Mat3>(covariance, Eigen::EigenvaluesOnly).eigenvalues();
+  }
+
+  for(std::size_t l = 0; l < columns.size(); ++l)
+    if(validLandmarks[l])
+      sfmData._landmarksUncertainty[columns.landmarkIds[l]] = landmarkUncertainties[l];
+
+  ALICEVISION_LOG_INFO("Uncertainty of " << poseIds.size() << " poses and " << sfmData._landmarksUncertainty.size()
+                       << " landmarks estimated in (s): " << timer.elapsed() << std::endl
+                       << "\t- reference pose: " << poseIds[referencePose] << std::endl
+                       << "\t- reduced camera system: " << reducedSystem.rows() << " x " << reducedSystem.cols()
+                       << ", " << reducedSystem.nonZeros() << " non-zeros");
+
+  return true;
+}
+
+} // namespace sfm
+} // namespace aliceVision
@@ -0,0 +1,34 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/sfmData/SfMData.hpp>
+
+namespace aliceVision {
+namespace sfm {
+
+/**
+ * @brief Estimate the uncertainty of the poses and the landmarks from the normal equations of the bundle adjustment.
+ *
+ * Only the marginal covariance blocks are computed, the full covariance matrix is never built:
+ * - the landmarks are eliminated with the Schur complement, the reduced camera system is block sparse
+ * - the reduced camera system is factorized with a sparse Cholesky
+ * - the covariance columns of each pose are solved in parallel, they give the pose covariance and
+ *   the contribution of the pose to the covariance of its landmarks
+ *
+ * The intrinsics are fixed. The gauge is fixed by the pose with the most observations
+ * and by the distance between this pose and the pose sharing the most landmarks with it.
+ * The stored uncertainties are the eigenvalues of the covariance blocks, the reference pose has no uncertainty.
+ *
+ * @param[in,out] sfmData The scene, the results are stored in _posesUncertainty and _landmarksUncertainty
+ * @param[in] observationSigma The standard deviation of the observations, in pixels
+ * @return false if there are not enough poses or if the reduced camera system is not positive definite
+ */
+bool computeSparseUncertainty(sfmData::SfMData& sfmData, double observationSigma = 1.0);
+
+} // namespace sfm
+} // namespace aliceVision
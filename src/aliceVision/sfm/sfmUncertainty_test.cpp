@@ -0,0 +1,220 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfm/sfmUncertainty.hpp>
+#include <aliceVision/sfm/utils/syntheticScene.hpp>
+#include <aliceVision/multiview/NViewDataSet.hpp>
+
+#include <Eigen/Geometry>
+
+#include <map>
+
+#define BOOST_TEST_MODULE sfmUncertainty
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::sfm;
+using namespace aliceVision::sfmData;
+
+namespace {
+
+using Mat6 = Eigen::Matrix<double, 6, 6>;
+
+double meanPoseUncertainty(const SfMData& sfmData)
+{
+  double sum = 0.0;
+  for(const auto& uncertaintyIt : sfmData._posesUncertainty)
+    sum += uncertaintyIt.second.sum();
+  return sum / sfmData._posesUncertainty.size();
+}
+
+/// Jacobians of the projection wrt the left perturbation (rotation, translation) of the pose and wrt the point,
+/// by central differences
+void getNumericJacobians(const camera::IntrinsicBase& intrinsic, const geometry::Pose3& pose, const Vec3& X,
+                         Eigen::Matrix<double, 2, 6>& poseJacobian, Mat23& pointJacobian)
+{
+  const double eps = 1e-6;
+  const Mat34 T = pose.getHomogeneous().topRows<3>();
+  for(int k = 0; k < 6; ++k)
+  {
+    Vec2 proj[2];
+    for(int side = 0; side < 2; ++side)
+    {
+      const double delta = side ? eps : -eps;
+      Mat34 perturbed = T;
+      if(k < 3)
+        perturbed = Eigen::AngleAxisd(delta, Vec3::Unit(k)).toRotationMatrix() * T;
+      else
+        perturbed(k - 3, 3) += delta;
+      proj[side] = intrinsic.project(geometry::Pose3(perturbed), X.homogeneous());
+    }
+    poseJacobian.col(k) = (proj[1] - proj[0]) / (2.0 * eps);
+  }
+  for(int k = 0; k < 3; ++k)
+  {
+    const double delta = eps * std::max(1.0, X.norm());
+    const Vec2 projPlus = intrinsic.project(pose, (X + delta * Vec3::Unit(k)).homogeneous());
+    const Vec2 projMinus = intrinsic.project(pose, (X - delta * Vec3::Unit(k)).homogeneous());
+    pointJacobian.col(k) = (projPlus - projMinus) / (2.0 * delta);
+  }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(SFM_UNCERTAINTY_denseInverse)
+{
+  const NViewDatasetConfigurator config;
+  SfMData sfmData = getInputScene(NRealisticCamerasRing(5, 24, config), config, camera::EINTRINSIC::PINHOLE_CAMERA);
+  BOOST_REQUIRE(computeSparseUncertainty(sfmData));
+
+  // same gauge as the sparse estimation: the reference pose is fixed and the scale pose has a prior
+  // on its distance to the reference pose
+  std::map<IndexT, int> poseBlocks;
+  IndexT referencePoseId = UndefinedIndexT;
+  for(const auto& poseIt : sfmData.getPoses())
+  {
+    if(sfmData._posesUncertainty.at(poseIt.first).isZero())
+      referencePoseId = poseIt.first;
+    else
+      poseBlocks.emplace(poseIt.first, 0);
+  }
+  BOOST_REQUIRE(referencePoseId != UndefinedIndexT);
+  int nbPoseParams = 0;
+  for(auto& poseBlock : poseBlocks)
+  {
+    poseBlock.second = nbPoseParams;
+    nbPoseParams += 6;
+  }
+
+  std::map<IndexT, std::size_t> nbCommonObservations;
+  for(const auto& landmarkIt : sfmData.getLandmarks())
+  {
+    std::set<IndexT> landmarkPoses;
+    for(const auto& observationIt : landmarkIt.second.observations)
+      landmarkPoses.insert(sfmData.getView(observationIt.first).getPoseId());
+    if(!landmarkPoses.count(referencePoseId))
+      continue;
+    for(const auto& observationIt : landmarkIt.second.observations)
+    {
+      const IndexT poseId = sfmData.getView(observationIt.first).getPoseId();
+      if(poseId != referencePoseId)
+        ++nbCommonObservations[poseId];
+    }
+  }
+  IndexT scalePoseId = nbCommonObservations.begin()->first;
+  for(const auto& countIt : nbCommonObservations)
+  {
+    if(countIt.second > nbCommonObservations.at(scalePoseId))
+      scalePoseId = countIt.first;
+  }
+
+  // full normal matrix of the poses and the landmarks
+  const int nbParams = nbPoseParams + 3 * sfmData.getLandmarks().size();
+  Eigen::MatrixXd normalMatrix = Eigen::MatrixXd::Zero(nbParams, nbParams);
+  std::map<IndexT, int> landmarkBlocks;
+  for(const auto& landmarkIt : sfmData.getLandmarks())
+  {
+    const int landmarkBlock = nbPoseParams + 3 * landmarkBlocks.size();
+    landmarkBlocks.emplace(landmarkIt.first, landmarkBlock);
+
+    for(const auto& observationIt : landmarkIt.second.observations)
+    {
+      const View& view = sfmData.getView(observationIt.first);
+      Eigen::Matrix<double, 2, 6> poseJacobian;
+      Mat23 pointJacobian;
+      getNumericJacobians(*sfmData.getIntrinsicPtr(view.getIntrinsicId()), sfmData.getPose(view).getTransform(),
+                          landmarkIt.second.X, poseJacobian, pointJacobian);
+
+      normalMatrix.block<3, 3>(landmarkBlock, landmarkBlock) += pointJacobian.transpose() * pointJacobian;
+      if(view.getPoseId() == referencePoseId)
+        continue;
+      const int poseBlock = poseBlocks.at(view.getPoseId());
+      normalMatrix.block<6, 6>(poseBlock, poseBlock) += poseJacobian.transpose() * poseJacobian;
+      normalMatrix.block<6, 3>(poseBlock, landmarkBlock) += poseJacobian.transpose() * pointJacobian;
+      normalMatrix.block<3, 6>(landmarkBlock, poseBlock) += pointJacobian.transpose() * poseJacobian;
+    }
+  }
+
+  {
+    const Eigen::MatrixXd landmarksInverse = normalMatrix.bottomRightCorner(nbParams - nbPoseParams, nbParams - nbPoseParams).inverse();
+    const Eigen::MatrixXd reducedSystem = normalMatrix.topLeftCorner(nbPoseParams, nbPoseParams) -
+      normalMatrix.topRightCorner(nbPoseParams, nbParams - nbPoseParams) * landmarksInverse * normalMatrix.bottomLeftCorner(nbParams - nbPoseParams, nbPoseParams);
+
+    const geometry::Pose3 scalePose = sfmData.getAbsolutePose(scalePoseId).getTransform();
+    const Vec3 referenceCenter = sfmData.getAbsolutePose(referencePoseId).getTransform().center();
+    Vec6 scaleDirection = Vec6::Zero();
+    scaleDirection.tail<3>() = scalePose.rotation() * (scalePose.center() - referenceCenter).normalized();
+
+    const int scaleBlock = poseBlocks.at(scalePoseId);
+    normalMatrix.block<6, 6>(scaleBlock, scaleBlock) +=
+      1e6 * reducedSystem.block<6, 6>(scaleBlock, scaleBlock).diagonal().maxCoeff() * scaleDirection * scaleDirection.transpose();
+  }
+
+  const Eigen::MatrixXd covariance = normalMatrix.inverse();
+
+  for(const auto& poseBlock : poseBlocks)
+  {
+    const Vec6 expected = Eigen::SelfAdjointEigenSolver<Mat6>(Mat6(covariance.block<6, 6>(poseBlock.second, poseBlock.second)), Eigen::EigenvaluesOnly).eigenvalues();
+    const Vec6& uncertainty = sfmData._posesUncertainty.at(poseBlock.first);
+    BOOST_CHECK_SMALL((uncertainty - expected).norm() / expected.norm(), 1e-4);
+  }
+  for(const auto& landmarkBlock : landmarkBlocks)
+  {
+    const Vec3 expected = Eigen::SelfAdjointEigenSolver<Mat3>(Mat3(covariance.block<3, 3>(landmarkBlock.second, landmarkBlock.second)), Eigen::EigenvaluesOnly).eigenvalues();
+    const Vec3& uncertainty = sfmData._landmarksUncertainty.at(landmarkBlock.first);
+    BOOST_CHECK_SMALL((uncertainty - expected).norm() / expected.norm(), 1e-4);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(SFM_UNCERTAINTY_marginals)
+{
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(6, 64, config);
+  SfMData sfmData = getInputScene(d, config, camera::EINTRINSIC::PINHOLE_CAMERA);
+
+  BOOST_REQUIRE(computeSparseUncertainty(sfmData));
+  BOOST_CHECK_EQUAL(sfmData._posesUncertainty.size(), sfmData.getPoses().size());
+  BOOST_CHECK_EQUAL(sfmData._landmarksUncertainty.size(), sfmData.getLandmarks().size());
+
+  // a single pose is the reference of the gauge
+  int nbReferencePoses = 0;
+  for(const auto& uncertaintyIt : sfmData._posesUncertainty)
+  {
+    if(uncertaintyIt.second.isZero())
+      ++nbReferencePoses;
+    else
+      BOOST_CHECK_GT(uncertaintyIt.second.minCoeff(), 0.0);
+  }
+  BOOST_CHECK_EQUAL(nbReferencePoses, 1);
+
+  for(const auto& uncertaintyIt : sfmData._landmarksUncertainty)
+    BOOST_CHECK_GT(uncertaintyIt.second.minCoeff(), 0.0);
+
+  // the covariances scale with the variance of the observations
+  SfMData sfmDataSigma2 = sfmData;
+  BOOST_REQUIRE(computeSparseUncertainty(sfmDataSigma2, 2.0));
+  for(const auto& uncertaintyIt : sfmData._posesUncertainty)
+    for(int i = 0; i < 6; ++i)
+      BOOST_CHECK_CLOSE(4.0 * uncertaintyIt.second(i), sfmDataSigma2._posesUncertainty.at(uncertaintyIt.first)(i), 1e-3);
+  for(const auto& uncertaintyIt : sfmData._landmarksUncertainty)
+    for(int i = 0; i < 3; ++i)
+      BOOST_CHECK_CLOSE(4.0 * uncertaintyIt.second(i), sfmDataSigma2._landmarksUncertainty.at(uncertaintyIt.first)(i), 1e-3);
+}
+
+BOOST_AUTO_TEST_CASE(SFM_UNCERTAINTY_moreLandmarks)
+{
+  const NViewDatasetConfigurator config;
+  SfMData sparseScene = getInputScene(NRealisticCamerasRing(6, 32, config), config, camera::EINTRINSIC::PINHOLE_CAMERA);
+  SfMData denseScene = getInputScene(NRealisticCamerasRing(6, 512, config), config, camera::EINTRINSIC::PINHOLE_CAMERA);
+
+  BOOST_REQUIRE(computeSparseUncertainty(sparseScene));
+  BOOST_REQUIRE(computeSparseUncertainty(denseScene));
+
+  // the poses are better constrained with more landmarks
+  BOOST_CHECK_LT(meanPoseUncertainty(denseScene), meanPoseUncertainty(sparseScene));
+}
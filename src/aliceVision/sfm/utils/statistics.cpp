@@ -7,6 +7,8 @@
 
 #include "statistics.hpp"
 #include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfmData/LandmarksColumns.hpp>
+#include <aliceVision/sfm/sfmStatistics.hpp>
 
 namespace aliceVision {
 namespace sfm {
@@ -14,27 +16,14 @@ namespace sfm {
 double RMSE(const sfmData::SfMData& sfmData)
 {
   // Compute residuals for each observation
-  std::vector<double> vec;
-  for(sfmData::Landmarks::const_iterator iterTracks = sfmData.getLandmarks().begin();
-      iterTracks != sfmData.getLandmarks().end();
-      ++iterTracks)
-  {
-    const sfmData::Observations& obs = iterTracks->second.observations;
-    for(sfmData::Observations::const_iterator itObs = obs.begin();
-      itObs != obs.end(); ++itObs)
-    {
-      const sfmData::View* view = sfmData.getViews().find(itObs->first)->second.get();
-      const geometry::Pose3 pose = sfmData.getPose(*view).getTransform();
-      const std::shared_ptr<camera::IntrinsicBase> intrinsic = sfmData.getIntrinsics().at(view->getIntrinsicId());
-      const Vec2 residual = intrinsic->residual(pose, iterTracks->second.X.homogeneous(), itObs->second.x);
-      vec.push_back(residual(0));
-      vec.push_back(residual(1));
-    }
-  }
-  if(vec.empty())
+  const sfmData::LandmarksColumns columns(sfmData.getLandmarks());
+  if(columns.nbObservations() == 0)
     return -1.0;
-  const Eigen::Map<Eigen::RowVectorXd> residuals(&vec[0], vec.size());
-  const double RMSE = std::sqrt(residuals.squaredNorm() / vec.size());
+
+  Mat2X residuals;
+  computeObservationsResiduals(columns, sfmData::ObservationCameras(sfmData, columns), residuals);
+
+  const double RMSE = std::sqrt(residuals.squaredNorm() / residuals.size());
   return RMSE;
 }
 
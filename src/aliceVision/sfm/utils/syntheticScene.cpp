@@ -8,6 +8,8 @@
 #include "syntheticScene.hpp"
 #include <aliceVision/sfm/sfm.hpp>
 
+#include <algorithm>
+#include <cmath>
 #include <random>
 #include <iostream>
 
@@ -206,5 +208,114 @@ sfmData::SfMData getInputRigScene(const NViewDataSet& d,
   return sfmData;
 }
 
+sfmData::SfMData getSyntheticSurveyScene(const SyntheticSurveyConfigurator& config)
+{
+  sfmData::SfMData sfmData;
+  std::mt19937 generator(config.seed);
+
+  // the views are on a square grid, at the altitude where an image covers the given overlap
+  const std::size_t gridSize = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(config.nbViews))));
+  const double spacing = config.sceneSize / gridSize;
+  const double altitude = config.relief + config.overlap * spacing * config.focal / std::max(config.width, config.height);
+
+  // 1. Intrinsic data (shared, so only one camera intrinsic is defined)
+  const IndexT intrinsicId = 0;
+  auto intrinsic = std::make_shared<camera::Pinhole>(config.width, config.height, config.focal, config.focal, 0, 0);
+  sfmData.intrinsics[intrinsicId] = intrinsic;
+
+  // 2. Views and poses, looking down with a small random tilt
+  Mat3 lookDown = Mat3::Identity();
+  lookDown(1, 1) = -1.0;
+  lookDown(2, 2) = -1.0;
+
+  std::normal_distribution<double> positionJitter(0.0, config.jitter * spacing);
+  std::normal_distribution<double> angleJitter(0.0, degreeToRadian(1.0));
+
+  for(std::size_t i = 0; i < config.nbViews; ++i)
+  {
+    const IndexT viewId = i, poseId = i;
+    sfmData.views[viewId] = std::make_shared<sfmData::View>("", viewId, intrinsicId, poseId, config.width, config.height);
+
+    const Vec3 center((i % gridSize + 0.5) * spacing + positionJitter(generator),
+                      (i / gridSize + 0.5) * spacing + positionJitter(generator),
+                      altitude + positionJitter(generator));
+    const Mat3 rotation = RotationAroundX(angleJitter(generator)) * RotationAroundY(angleJitter(generator)) *
+                          RotationAroundZ(angleJitter(generator)) * lookDown;
+    sfmData.setPose(*sfmData.views.at(viewId), sfmData::CameraPose(geometry::Pose3(rotation, center)));
+  }
+
+  // 3. 3D points, sorted in the cells of the view grid
+  std::uniform_real_distribution<double> groundDistribution(0.0, config.sceneSize);
+  std::uniform_real_distribution<double> reliefDistribution(0.0, config.relief);
+
+  const auto cellIndex = [&](double x) {
+    return std::min(gridSize - 1, static_cast<std::size_t>(std::max(0.0, x / spacing)));
+  };
+
+  std::vector<Vec3> points(config.nbPoints);
+  std::vector<std::vector<std::size_t>> cellPoints(gridSize * gridSize);
+  for(std::size_t p = 0; p < config.nbPoints; ++p)
+  {
+    points[p] = Vec3(groundDistribution(generator), groundDistribution(generator), reliefDistribution(generator));
+    cellPoints[cellIndex(points[p](1)) * gridSize + cellIndex(points[p](0))].push_back(p);
+  }
+
+  // 4. Observations: project the points of the cells around each view
+  const double footprint = altitude * std::max(config.width, config.height) / config.focal;
+  const std::ptrdiff_t cellRadius = static_cast<std::ptrdiff_t>(std::ceil(0.5 * footprint / spacing)) + 1;
+
+  std::vector<std::vector<std::pair<std::size_t, Vec2>>> viewObservations(config.nbViews);
+
+  #pragma omp parallel for
+  for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(config.nbViews); ++i)
+  {
+    const geometry::Pose3 pose = sfmData.getPose(*sfmData.views.at(i)).getTransform();
+    const std::ptrdiff_t cx = cellIndex(pose.center()(0));
+    const std::ptrdiff_t cy = cellIndex(pose.center()(1));
+
+    for(std::ptrdiff_t y = std::max(std::ptrdiff_t(0), cy - cellRadius); y <= std::min(std::ptrdiff_t(gridSize) - 1, cy + cellRadius); ++y)
+    {
+      for(std::ptrdiff_t x = std::max(std::ptrdiff_t(0), cx - cellRadius); x <= std::min(std::ptrdiff_t(gridSize) - 1, cx + cellRadius); ++x)
+      {
+        for(std::size_t p : cellPoints[y * gridSize + x])
+        {
+          if(pose.depth(points[p]) <= 0.0)
+            continue;
+          const Vec2 pt = intrinsic->project(pose, points[p].homogeneous());
+          if(pt(0) >= 0.0 && pt(1) >= 0.0 && pt(0) < config.width && pt(1) < config.height)
+            viewObservations[i].emplace_back(p, pt);
+        }
+      }
+    }
+  }
+
+  // 5. Landmarks, the points seen by at least 2 views, with the feature ids in the order of the points in each view
+  std::vector<std::size_t> nbObservations(config.nbPoints, 0);
+  for(const auto& observations : viewObservations)
+    for(const auto& observation : observations)
+      ++nbObservations[observation.first];
+
+  const double unknownScale = 0.0;
+  for(std::size_t i = 0; i < config.nbViews; ++i)
+  {
+    std::sort(viewObservations[i].begin(), viewObservations[i].end(),
+              [](const std::pair<std::size_t, Vec2>& a, const std::pair<std::size_t, Vec2>& b) { return a.first < b.first; });
+
+    IndexT featureId = 0;
+    for(const auto& observation : viewObservations[i])
+    {
+      if(nbObservations[observation.first] < 2)
+        continue;
+      sfmData::Landmark& landmark = sfmData.structure[observation.first];
+      landmark.X = points[observation.first];
+      landmark.observations[i] = sfmData::Observation(observation.second, featureId++, unknownScale);
+    }
+    viewObservations[i].clear();
+    viewObservations[i].shrink_to_fit();
+  }
+
+  return sfmData;
+}
+
 } // namespace sfm
 } // namespace aliceVision
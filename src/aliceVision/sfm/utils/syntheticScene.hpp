@@ -12,6 +12,8 @@
 #include <aliceVision/multiview/NViewDataSet.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
 
+#include <random>
+
 namespace aliceVision {
 namespace sfm {
 
@@ -21,15 +23,17 @@ namespace sfm {
  * @param[in] sfmData synthetic SfM dataset
  * @param[in] descType
  * @param[in] noise
+ * @param[in] seed the seed of the noise random generator
  */
 template <typename NoiseGenerator>
 void generateSyntheticFeatures(feature::FeaturesPerView& out_featuresPerView,
                                feature::EImageDescriberType descType,
                                const sfmData::SfMData& sfmData,
-                               NoiseGenerator& noise)
+                               NoiseGenerator& noise,
+                               unsigned int seed = std::default_random_engine::default_seed)
 {
   assert(descType != feature::EImageDescriberType::UNINITIALIZED);
-  std::default_random_engine generator;
+  std::default_random_engine generator(seed);
 
   // precompute output feature vectors size and resize
   {
@@ -91,5 +95,41 @@ sfmData::SfMData getInputScene(const NViewDataSet& d, const NViewDatasetConfigur
 // As only one intrinsic is defined we used shared intrinsic
 sfmData::SfMData getInputRigScene(const NViewDataSet& d, const NViewDatasetConfigurator& config, camera::EINTRINSIC eintrinsic);
 
+/**
+ * @brief Parameters of a synthetic aerial survey (see getSyntheticSurveyScene())
+ */
+struct SyntheticSurveyConfigurator
+{
+  /// Number of views, placed on a square grid
+  std::size_t nbViews = 100;
+  /// Number of 3D points, uniformly placed on the ground
+  std::size_t nbPoints = 10000;
+  /// Side of the square ground (m)
+  double sceneSize = 100.0;
+  /// Maximum height of the 3D points above the ground (m)
+  double relief = 5.0;
+  /// Side of the ground seen by an image, in distances between two neighbour views
+  double overlap = 3.0;
+  /// Standard deviation of the view positions, in distances between two neighbour views
+  double jitter = 0.1;
+  /// Shared pinhole intrinsic (px)
+  int width = 1000;
+  int height = 1000;
+  double focal = 1000.0;
+  /// Seed of the random generator
+  unsigned int seed = 0;
+};
+
+/**
+ * @brief Create a synthetic aerial survey: the views are on a grid above a square ground, looking down,
+ *        and each 3D point is observed by the views it projects into.
+ *        Unlike NViewDataSet where each view sees all the points, the number of observations per view only depends
+ *        on the density of points and on the overlap, so the scene scales to a large number of views.
+ *        The 3D points with less than 2 observations are not in the output landmarks.
+ * @param[in] config The survey parameters
+ * @return The scene with views, poses, a shared pinhole intrinsic and landmarks
+ */
+sfmData::SfMData getSyntheticSurveyScene(const SyntheticSurveyConfigurator& config);
+
 } // namespace sfm
 } // namespace aliceVision
@@ -0,0 +1,86 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfm/utils/syntheticScene.hpp>
+
+#include <map>
+
+#define BOOST_TEST_MODULE syntheticScene
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::sfm;
+using namespace aliceVision::sfmData;
+
+namespace {
+
+double meanObservationsPerView(const SfMData& sfmData)
+{
+  std::size_t nbObservations = 0;
+  for(const auto& landmarkIt : sfmData.getLandmarks())
+    nbObservations += landmarkIt.second.observations.size();
+  return double(nbObservations) / sfmData.getViews().size();
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(SYNTHETIC_SCENE_Survey_observations)
+{
+  SyntheticSurveyConfigurator config;
+  config.nbViews = 64;
+  config.nbPoints = 5000;
+
+  const SfMData sfmData = getSyntheticSurveyScene(config);
+
+  BOOST_CHECK_EQUAL(sfmData.getViews().size(), config.nbViews);
+  BOOST_CHECK_EQUAL(sfmData.getPoses().size(), config.nbViews);
+  BOOST_CHECK(!sfmData.getLandmarks().empty());
+  BOOST_CHECK_LE(sfmData.getLandmarks().size(), config.nbPoints);
+
+  const camera::IntrinsicBase& intrinsic = *sfmData.getIntrinsics().at(0);
+
+  // each landmark is seen by several views, at its projection
+  std::map<IndexT, std::size_t> nbFeaturesPerView;
+  for(const auto& landmarkIt : sfmData.getLandmarks())
+  {
+    const Landmark& landmark = landmarkIt.second;
+    BOOST_CHECK_GE(landmark.observations.size(), 2);
+
+    for(const auto& observationIt : landmark.observations)
+    {
+      const View& view = sfmData.getView(observationIt.first);
+      const geometry::Pose3 pose = sfmData.getPose(view).getTransform();
+      const Vec2 residual = intrinsic.residual(pose, landmark.X.homogeneous(), observationIt.second.x);
+      BOOST_CHECK_SMALL(residual.norm(), 1e-6);
+      ++nbFeaturesPerView[observationIt.first];
+    }
+  }
+
+  // the feature ids of each view are contiguous
+  for(const auto& landmarkIt : sfmData.getLandmarks())
+    for(const auto& observationIt : landmarkIt.second.observations)
+      BOOST_CHECK_LT(observationIt.second.id_feat, nbFeaturesPerView.at(observationIt.first));
+}
+
+BOOST_AUTO_TEST_CASE(SYNTHETIC_SCENE_Survey_scaling)
+{
+  // with the same density of points, the observations per view do not depend on the number of views
+  SyntheticSurveyConfigurator config;
+  config.nbViews = 100;
+  config.nbPoints = 16000;
+  config.sceneSize = 100.0;
+  const double smallMean = meanObservationsPerView(getSyntheticSurveyScene(config));
+
+  config.nbViews = 400;
+  config.nbPoints = 64000;
+  config.sceneSize = 200.0;
+  const double largeMean = meanObservationsPerView(getSyntheticSurveyScene(config));
+
+  BOOST_CHECK_GT(smallMean, 100.0);
+  BOOST_CHECK_CLOSE(smallMean, largeMean, 20.0);
+}
@@ -0,0 +1,122 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "LandmarksColumns.hpp"
+
+#include <algorithm>
+
+namespace aliceVision {
+namespace sfmData {
+
+LandmarksColumns::LandmarksColumns(const Landmarks& landmarks)
+{
+  std::size_t nbObs = 0;
+  for(const auto& landmarkPair : landmarks)
+    nbObs += landmarkPair.second.observations.size();
+
+  reserve(landmarks.size(), nbObs);
+
+  for(const auto& landmarkPair : landmarks)
+    add(landmarkPair.first, landmarkPair.second);
+}
+
+LandmarksColumns::LandmarksColumns(const Landmarks& landmarks, const std::vector<IndexT>& subsetLandmarkIds)
+{
+  std::size_t nbObs = 0;
+  for(const IndexT landmarkId : subsetLandmarkIds)
+    nbObs += landmarks.at(landmarkId).observations.size();
+
+  reserve(subsetLandmarkIds.size(), nbObs);
+
+  for(const IndexT landmarkId : subsetLandmarkIds)
+    add(landmarkId, landmarks.at(landmarkId));
+}
+
+void LandmarksColumns::reserve(std::size_t nbLandmarks, std::size_t nbObs)
+{
+  landmarkIds.reserve(nbLandmarks);
+  descTypes.reserve(nbLandmarks);
+  positions.resize(3, nbLandmarks);
+  colors.reserve(nbLandmarks);
+  observationOffsets.reserve(nbLandmarks + 1);
+  observationViewIds.reserve(nbObs);
+  observationFeatIds.reserve(nbObs);
+  observationPoints.resize(2, nbObs);
+  observationScales.reserve(nbObs);
+}
+
+void LandmarksColumns::add(IndexT landmarkId, const Landmark& landmark)
+{
+  positions.col(landmarkIds.size()) = landmark.X;
+  landmarkIds.push_back(landmarkId);
+  descTypes.push_back(landmark.descType);
+  colors.push_back(landmark.rgb);
+
+  for(const auto& observationPair : landmark.observations)
+  {
+    observationPoints.col(observationViewIds.size()) = observationPair.second.x;
+    observationViewIds.push_back(observationPair.first);
+    observationFeatIds.push_back(observationPair.second.id_feat);
+    observationScales.push_back(observationPair.second.scale);
+  }
+  observationOffsets.push_back(observationViewIds.size());
+}
+
+void LandmarksColumns::toLandmarks(Landmarks& landmarks) const
+{
+  landmarks.clear();
+  for(std::size_t i = 0; i < size(); ++i)
+  {
+    Landmark& landmark = landmarks[landmarkIds[i]];
+    landmark.X = positions.col(i);
+    landmark.descType = descTypes[i];
+    landmark.rgb = colors[i];
+    landmark.observations.reserve(nbObservations(i));
+
+    // observations are sorted by view id
+    for(std::size_t o = observationOffsets[i]; o < observationOffsets[i + 1]; ++o)
+    {
+      landmark.observations.insert(landmark.observations.end(),
+                                   std::make_pair(observationViewIds[o], Observation(observationPoints.col(o), observationFeatIds[o], observationScales[o])));
+    }
+  }
+}
+
+void LandmarksColumns::updateLandmarks(Landmarks& landmarks) const
+{
+  assert(landmarks.size() == size());
+  std::size_t i = 0;
+  for(auto& landmarkPair : landmarks)
+  {
+    assert(landmarkPair.first == landmarkIds[i]);
+    landmarkPair.second.X = positions.col(i);
+    landmarkPair.second.rgb = colors[i];
+    ++i;
+  }
+}
+
+ObservationCameras::ObservationCameras(const SfMData& sfmData, const LandmarksColumns& columns)
+{
+  _viewIds = columns.observationViewIds;
+  std::sort(_viewIds.begin(), _viewIds.end());
+  _viewIds.erase(std::unique(_viewIds.begin(), _viewIds.end()), _viewIds.end());
+
+  _poses.reserve(_viewIds.size());
+  _intrinsics.reserve(_viewIds.size());
+  for(const IndexT viewId : _viewIds)
+  {
+    const View * view = sfmData.views.at(viewId).get();
+    _poses.push_back(sfmData.getPose(*view).getTransform());
+    _intrinsics.push_back(sfmData.intrinsics.at(view->getIntrinsicId()).get());
+  }
+
+  _observationCameras.resize(columns.nbObservations());
+  for(std::size_t o = 0; o < columns.nbObservations(); ++o)
+    _observationCameras[o] = std::lower_bound(_viewIds.begin(), _viewIds.end(), columns.observationViewIds[o]) - _viewIds.begin();
+}
+
+} // namespace sfmData
+} // namespace aliceVision
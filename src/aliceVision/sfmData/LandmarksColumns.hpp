@@ -0,0 +1,107 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/sfmData/SfMData.hpp>
+
+#include <vector>
+
+namespace aliceVision {
+namespace sfmData {
+
+/**
+ * @brief Columnar (structure of arrays) copy of the landmarks.
+ *
+ * Positions, colors and observations are stored in contiguous arrays,
+ * the observations of landmark i are in [observationOffsets[i], observationOffsets[i+1]) sorted by view id.
+ * It is meant for hot loops over the whole structure (bundle adjustment setup, filters, colorization),
+ * the Landmarks container stays the reference layout (IO, edition).
+ *
+ * Landmarks are stored in the iteration order of the Landmarks container they are built from.
+ */
+struct LandmarksColumns
+{
+  LandmarksColumns() = default;
+
+  /**
+   * @brief Build the columns from the landmarks container.
+   */
+  explicit LandmarksColumns(const Landmarks& landmarks);
+
+  /**
+   * @brief Build the columns from a subset of the landmarks, stored in the order of the given ids.
+   * @param[in] landmarks The landmarks container
+   * @param[in] subsetLandmarkIds The ids of the landmarks to copy, they must exist in the container
+   */
+  LandmarksColumns(const Landmarks& landmarks, const std::vector<IndexT>& subsetLandmarkIds);
+
+  /// Number of landmarks
+  std::size_t size() const { return landmarkIds.size(); }
+
+  /// Total number of observations
+  std::size_t nbObservations() const { return observationViewIds.size(); }
+
+  /// Number of observations of a landmark
+  std::size_t nbObservations(std::size_t landmarkIndex) const
+  {
+    return observationOffsets[landmarkIndex + 1] - observationOffsets[landmarkIndex];
+  }
+
+  /**
+   * @brief Convert back to the landmarks container layout.
+   * @param[out] landmarks The output landmarks (cleared first)
+   */
+  void toLandmarks(Landmarks& landmarks) const;
+
+  /**
+   * @brief Copy the positions and colors back to the landmarks they were built from.
+   * @param[in,out] landmarks The landmarks container (same landmarks as the columns)
+   */
+  void updateLandmarks(Landmarks& landmarks) const;
+
+  std::vector<IndexT> landmarkIds;
+  std::vector<feature::EImageDescriberType> descTypes;
+  Mat3X positions;
+  std::vector<image::RGBColor> colors;
+
+  std::vector<std::size_t> observationOffsets = {0};
+  std::vector<IndexT> observationViewIds;
+  std::vector<IndexT> observationFeatIds;
+  Mat2X observationPoints;
+  std::vector<double> observationScales;
+
+private:
+  void reserve(std::size_t nbLandmarks, std::size_t nbObs);
+  void add(IndexT landmarkId, const Landmark& landmark);
+};
+
+/**
+ * @brief Pose and intrinsic of each view observing the columns, resolved once.
+ */
+class ObservationCameras
+{
+public:
+  ObservationCameras(const SfMData& sfmData, const LandmarksColumns& columns);
+
+  const geometry::Pose3& getPose(std::size_t observationIndex) const { return _poses[_observationCameras[observationIndex]]; }
+  const camera::IntrinsicBase* getIntrinsic(std::size_t observationIndex) const { return _intrinsics[_observationCameras[observationIndex]]; }
+
+  /// Index of the view of an observation in getViewIds()
+  std::size_t getViewIndex(std::size_t observationIndex) const { return _observationCameras[observationIndex]; }
+
+  /// Sorted ids of the views observing the columns
+  const std::vector<IndexT>& getViewIds() const { return _viewIds; }
+
+private:
+  std::vector<IndexT> _viewIds;
+  std::vector<geometry::Pose3> _poses;
+  std::vector<const camera::IntrinsicBase*> _intrinsics;
+  std::vector<std::size_t> _observationCameras;
+};
+
+} // namespace sfmData
+} // namespace aliceVision
@@ -0,0 +1,278 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "NeighborCamsGraph.hpp"
+
+#include <aliceVision/camera/IntrinsicBase.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/stl/hash.hpp>
+#include <aliceVision/system/Logger.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include <algorithm>
+
+namespace fs = boost::filesystem;
+namespace bpt = boost::property_tree;
+
+namespace aliceVision {
+namespace sfmData {
+
+/// Increment when the content of the graph files changes
+static const int neighborCamsGraphVersion = 2;
+
+void NeighborCamsGraph::build(const SfMData& sfmData, float minViewAngle, float maxViewAngle)
+{
+    _minViewAngle = minViewAngle;
+    _maxViewAngle = maxViewAngle;
+    _sceneKey = computeSceneKey(sfmData);
+    _neighborsPerView.clear();
+
+    struct Camera
+    {
+        IndexT viewId;
+        geometry::Pose3 pose;
+        const camera::IntrinsicBase* intrinsicPtr;
+        std::vector<const Landmark*> landmarks;
+    };
+
+    std::vector<Camera> cameras;
+    std::map<IndexT, std::size_t> cameraIndexPerViewId;
+
+    for(const auto& viewPair : sfmData.getViews())
+    {
+        const View& view = *(viewPair.second);
+        if(!sfmData.isPoseAndIntrinsicDefined(&view))
+            continue;
+
+        cameraIndexPerViewId[view.getViewId()] = cameras.size();
+        cameras.push_back({view.getViewId(), sfmData.getPose(view).getTransform(), sfmData.getIntrinsicPtr(view.getIntrinsicId()), {}});
+    }
+
+    // landmarks of each camera, to scan the landmarks once for all the cameras
+    for(const auto& landmarkPair : sfmData.getLandmarks())
+    {
+        for(const auto& observationPair : landmarkPair.second.observations)
+        {
+            const auto it = cameraIndexPerViewId.find(observationPair.first);
+            if(it != cameraIndexPerViewId.end())
+                cameras[it->second].landmarks.push_back(&landmarkPair.second);
+        }
+    }
+
+    std::vector<std::vector<NeighborCam>> neighborsPerCamera(cameras.size());
+
+    #pragma omp parallel for schedule(dynamic)
+    for(int c = 0; c < static_cast<int>(cameras.size()); ++c)
+    {
+        const Camera& cam = cameras[c];
+
+        struct Accumulator
+        {
+            int nbSharedLandmarks = 0;
+            double angleSum = 0.0;
+        };
+        std::map<std::size_t, Accumulator> accumulators;
+
+        for(const Landmark* landmark : cam.landmarks)
+        {
+            const Vec2& x = landmark->observations.at(cam.viewId).x;
+
+            for(const auto& observationPair : landmark->observations)
+            {
+                if(observationPair.first == cam.viewId)
+                    continue;
+
+                const auto it = cameraIndexPerViewId.find(observationPair.first);
+                if(it == cameraIndexPerViewId.end())
+                    continue;
+
+                const Camera& otherCam = cameras[it->second];
+                const double angle = camera::angleBetweenRays(cam.pose, cam.intrinsicPtr, otherCam.pose, otherCam.intrinsicPtr, x, observationPair.second.x);
+
+                if(angle < _minViewAngle || angle > _maxViewAngle)
+                    continue;
+
+                Accumulator& accumulator = accumulators[it->second];
+                ++accumulator.nbSharedLandmarks;
+                accumulator.angleSum += angle;
+            }
+        }
+
+        std::vector<NeighborCam>& neighbors = neighborsPerCamera[c];
+        neighbors.reserve(accumulators.size());
+
+        for(const auto& accumulatorPair : accumulators)
+        {
+            const Camera& otherCam = cameras[accumulatorPair.first];
+            const Accumulator& accumulator = accumulatorPair.second;
+
+            NeighborCam neighbor;
+            neighbor.viewId = otherCam.viewId;
+            neighbor.nbSharedLandmarks = accumulator.nbSharedLandmarks;
+            neighbor.overlap = float(accumulator.nbSharedLandmarks) / float(cam.landmarks.size());
+            neighbor.baseline = (cam.pose.center() - otherCam.pose.center()).norm();
+            neighbor.meanAngle = float(accumulator.angleSum / accumulator.nbSharedLandmarks);
+            neighbors.push_back(neighbor);
+        }
+
+        // by decreasing number of shared landmarks, the view id makes the order deterministic
+        std::sort(neighbors.begin(), neighbors.end(), [](const NeighborCam& a, const NeighborCam& b) {
+            if(a.nbSharedLandmarks != b.nbSharedLandmarks)
+                return a.nbSharedLandmarks > b.nbSharedLandmarks;
+            return a.viewId < b.viewId;
+        });
+    }
+
+    for(std::size_t c = 0; c < cameras.size(); ++c)
+        _neighborsPerView[cameras[c].viewId] = std::move(neighborsPerCamera[c]);
+
+    ALICEVISION_LOG_INFO("Neighbor cameras graph of " << cameras.size() << " cameras built.");
+}
+
+std::size_t NeighborCamsGraph::computeSceneKey(const SfMData& sfmData)
+{
+    // by view id, the key does not depend on the views storage order
+    std::map<IndexT, const View*> cameraViews;
+    for(const auto& viewPair : sfmData.getViews())
+    {
+        if(sfmData.isPoseAndIntrinsicDefined(viewPair.second.get()))
+            cameraViews[viewPair.first] = viewPair.second.get();
+    }
+
+    std::size_t key = 0;
+    for(const auto& cameraViewPair : cameraViews)
+    {
+        const View& view = *cameraViewPair.second;
+        const geometry::Pose3 pose = sfmData.getPose(view).getTransform();
+
+        stl::hash_combine(key, view.getViewId());
+        for(int i = 0; i < 9; ++i)
+            stl::hash_combine(key, pose.rotation()(i));
+        for(int i = 0; i < 3; ++i)
+            stl::hash_combine(key, pose.center()(i));
+        stl::hash_combine(key, sfmData.getIntrinsicPtr(view.getIntrinsicId())->hashValue());
+    }
+
+    std::size_t nbObservations = 0;
+    for(const auto& landmarkPair : sfmData.getLandmarks())
+        nbObservations += landmarkPair.second.observations.size();
+
+    stl::hash_combine(key, sfmData.getLandmarks().size());
+    stl::hash_combine(key, nbObservations);
+    return key;
+}
+
+bool NeighborCamsGraph::load(const std::string& path, const SfMData& sfmData)
+{
+    _neighborsPerView.clear();
+
+    try
+    {
+        bpt::ptree fileTree;
+        bpt::read_json(path, fileTree);
+
+        if(fileTree.get<int>("version", 0) != neighborCamsGraphVersion)
+        {
+            ALICEVISION_LOG_WARNING("Ignore the neighbor cameras graph file '" << path << "' of another version.");
+            return false;
+        }
+
+        if(fileTree.get<std::size_t>("sceneKey") != computeSceneKey(sfmData))
+        {
+            ALICEVISION_LOG_WARNING("Ignore the neighbor cameras graph file '" << path << "' built from other cameras or landmarks.");
+            return false;
+        }
+
+        _sceneKey = fileTree.get<std::size_t>("sceneKey");
+        _minViewAngle = fileTree.get<float>("minViewAngle");
+        _maxViewAngle = fileTree.get<float>("maxViewAngle");
+
+        for(const bpt::ptree::value_type& viewNode : fileTree.get_child("views"))
+        {
+            std::vector<NeighborCam>& neighbors = _neighborsPerView[viewNode.second.get<IndexT>("viewId")];
+
+            for(const bpt::ptree::value_type& neighborNode : viewNode.second.get_child("neighbors"))
+            {
+                NeighborCam neighbor;
+                neighbor.viewId = neighborNode.second.get<IndexT>("viewId");
+                neighbor.nbSharedLandmarks = neighborNode.second.get<int>("nbSharedLandmarks");
+                neighbor.overlap = neighborNode.second.get<float>("overlap");
+                neighbor.baseline = neighborNode.second.get<double>("baseline");
+                neighbor.meanAngle = neighborNode.second.get<float>("meanAngle");
+                neighbors.push_back(neighbor);
+            }
+        }
+    }
+    catch(const std::exception& e)
+    {
+        ALICEVISION_LOG_WARNING("Cannot read the neighbor cameras graph file '" << path << "': " << e.what());
+        _neighborsPerView.clear();
+        return false;
+    }
+
+    ALICEVISION_LOG_INFO("Neighbor cameras graph of " << _neighborsPerView.size() << " cameras loaded from '" << path << "'.");
+    return true;
+}
+
+bool NeighborCamsGraph::save(const std::string& path) const
+{
+    bpt::ptree fileTree;
+    fileTree.put("version", neighborCamsGraphVersion);
+    fileTree.put("sceneKey", _sceneKey);
+    fileTree.put("minViewAngle", _minViewAngle);
+    fileTree.put("maxViewAngle", _maxViewAngle);
+
+    bpt::ptree viewsTree;
+    for(const auto& viewPair : _neighborsPerView)
+    {
+        bpt::ptree viewTree;
+        viewTree.put("viewId", viewPair.first);
+
+        bpt::ptree neighborsTree;
+        for(const NeighborCam& neighbor : viewPair.second)
+        {
+            bpt::ptree neighborTree;
+            neighborTree.put("viewId", neighbor.viewId);
+            neighborTree.put("nbSharedLandmarks", neighbor.nbSharedLandmarks);
+            neighborTree.put("overlap", neighbor.overlap);
+            neighborTree.put("baseline", neighbor.baseline);
+            neighborTree.put("meanAngle", neighbor.meanAngle);
+            neighborsTree.push_back(std::make_pair("", neighborTree));
+        }
+        viewTree.add_child("neighbors", neighborsTree);
+        viewsTree.push_back(std::make_pair("", viewTree));
+    }
+    fileTree.add_child("views", viewsTree);
+
+    // the graph is read by concurrent processes, the file is replaced once complete
+    const std::string tmpPath = path + "." + fs::unique_path().string() + ".tmp";
+    try
+    {
+        bpt::write_json(tmpPath, fileTree);
+        fs::rename(tmpPath, path);
+    }
+    catch(const std::exception& e)
+    {
+        ALICEVISION_LOG_WARNING("Cannot write the neighbor cameras graph file '" << path << "': " << e.what());
+        boost::system::error_code ec;
+        fs::remove(tmpPath, ec);
+        return false;
+    }
+    return true;
+}
+
+const std::vector<NeighborCam>& NeighborCamsGraph::getNeighbors(IndexT viewId) const
+{
+    static const std::vector<NeighborCam> noNeighbors;
+    const auto it = _neighborsPerView.find(viewId);
+    return (it != _neighborsPerView.end()) ? it->second : noNeighbors;
+}
+
+} // namespace sfmData
+} // namespace aliceVision
@@ -0,0 +1,120 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace sfmData {
+
+class SfMData;
+
+/// Default file name of the neighbor cameras graph, in the prepareDenseScene output folder
+static const std::string neighborCamsGraphFilename = "neighborCams.json";
+
+/**
+ * @brief A neighbor camera of a view, from the landmarks they share.
+ */
+struct NeighborCam
+{
+    /// view id of the neighbor camera
+    IndexT viewId = UndefinedIndexT;
+    /// number of shared landmarks seen with an angle between the graph min and max view angles
+    int nbSharedLandmarks = 0;
+    /// ratio of the landmarks of the view shared with the neighbor camera
+    float overlap = 0.f;
+    /// distance between the two camera centers
+    double baseline = 0.0;
+    /// mean angle between the rays of the shared landmarks (degrees)
+    float meanAngle = 0.f;
+};
+
+/**
+ * @brief The neighbor cameras of each view of a scene, computed once from the SfM landmarks.
+ *
+ * The landmarks are scanned once for all the views, instead of once per view,
+ * and the graph is saved with the prepareDenseScene images to be shared by the dense stages.
+ */
+class NeighborCamsGraph
+{
+public:
+    NeighborCamsGraph() = default;
+
+    /**
+     * @brief Compute the neighbor cameras of all the views with a pose and an intrinsic.
+     * @param[in] sfmData the scene
+     * @param[in] minViewAngle the minimum angle between the rays of a shared landmark (degrees)
+     * @param[in] maxViewAngle the maximum angle between the rays of a shared landmark (degrees)
+     */
+    void build(const SfMData& sfmData, float minViewAngle, float maxViewAngle);
+
+    /**
+     * @brief Load the graph from a JSON file.
+     * @param[in] path the file path
+     * @param[in] sfmData the current scene, the graph is rejected if it was built from another one
+     * @return false if the file cannot be read or was built from another scene, the graph is then empty
+     */
+    bool load(const std::string& path, const SfMData& sfmData);
+
+    /**
+     * @brief Save the graph in a JSON file.
+     * @param[in] path the file path
+     * @return false if the file cannot be written
+     */
+    bool save(const std::string& path) const;
+
+    inline bool empty() const
+    {
+        return _neighborsPerView.empty();
+    }
+
+    inline float getMinViewAngle() const
+    {
+        return _minViewAngle;
+    }
+
+    inline float getMaxViewAngle() const
+    {
+        return _maxViewAngle;
+    }
+
+    /**
+     * @return true if the graph was built with the given view angles
+     */
+    inline bool hasViewAngles(float minViewAngle, float maxViewAngle) const
+    {
+        return (_minViewAngle == minViewAngle && _maxViewAngle == maxViewAngle);
+    }
+
+    /**
+     * @brief Compute the key of the scene data the graph depends on:
+     *        the view ids, poses and intrinsics of the cameras and the number of landmarks and observations.
+     * @param[in] sfmData the scene
+     * @return the scene key
+     */
+    static std::size_t computeSceneKey(const SfMData& sfmData);
+
+    /**
+     * @brief Get the neighbor cameras of a view.
+     * @param[in] viewId the view id
+     * @return the neighbor cameras, by decreasing number of shared landmarks
+     */
+    const std::vector<NeighborCam>& getNeighbors(IndexT viewId) const;
+
+private:
+    float _minViewAngle = 0.f;
+    float _maxViewAngle = 0.f;
+    std::size_t _sceneKey = 0;
+    std::map<IndexT, std::vector<NeighborCam>> _neighborsPerView;
+};
+
+} // namespace sfmData
+} // namespace aliceVision
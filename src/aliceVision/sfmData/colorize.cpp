@@ -8,120 +8,128 @@
 #include "colorize.hpp"
 #include <aliceVision/alicevision_omp.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfmData/LandmarksColumns.hpp>
 #include <aliceVision/stl/indexedSort.hpp>
 #include <aliceVision/stl/mapUtils.hpp>
 #include <aliceVision/image/io.hpp>
 #include <aliceVision/system/ProgressDisplay.hpp>
 
-#include <map>
+#include <algorithm>
+#include <limits>
+#include <numeric>
 #include <random>
 #include <vector>
 #include <functional>
 namespace aliceVision {
 namespace sfmData {
 
-void colorizeTracks(SfMData& sfmData)
+void colorizeTracks(SfMData& sfmData, int downscale)
 {
   auto progressDisplay = system::createConsoleProgressDisplay(sfmData.getLandmarks().size(), std::cout,
                                                               "\nCompute scene structure color\n");
 
-  std::vector<std::reference_wrapper<Landmark>> remainingLandmarksToColor;
-  remainingLandmarksToColor.reserve(sfmData.getLandmarks().size());
+  // work on a columnar copy of the structure to avoid chasing pointers
+  LandmarksColumns columns(sfmData.getLandmarks());
+  const std::size_t nbObservations = columns.nbObservations();
 
-  for(auto& landmarkPair : sfmData.getLandmarks())
-    remainingLandmarksToColor.push_back(landmarkPair.second);
+  // sorted ids of the views observing the landmarks
+  std::vector<IndexT> viewIds(columns.observationViewIds);
+  std::sort(viewIds.begin(), viewIds.end());
+  viewIds.erase(std::unique(viewIds.begin(), viewIds.end()), viewIds.end());
 
-  struct ViewInfo
+  // view -> observations index (CSR layout):
+  // the observations of view v are viewObservations[viewOffsets[v]..viewOffsets[v+1]), sorted by landmark
+  std::vector<std::size_t> viewOffsets(viewIds.size() + 1, 0);
+  std::vector<std::size_t> viewObservations(nbObservations);
+  std::vector<std::size_t> observationLandmarks(nbObservations);
   {
-    ViewInfo(IndexT viewId, std::size_t cardinal)
-      : viewId(viewId)
-      , cardinal(cardinal)
-    {}
-
-    IndexT viewId;
-    std::size_t cardinal;
-    std::vector<std::reference_wrapper<Landmark>> landmarks;
-  };
-
-  std::vector<ViewInfo> sortedViewsCardinal;
-  sortedViewsCardinal.reserve(sfmData.getViews().size());
-  {
-    // create cardinal per viewId map
-    std::map<IndexT, std::size_t> viewsCardinalMap; // <ViewId, Cardinal>
-    for(const auto& landmarkPair : sfmData.getLandmarks())
+    std::vector<std::size_t> observationViews(nbObservations);
+    for(std::size_t landmarkIndex = 0; landmarkIndex < columns.size(); ++landmarkIndex)
     {
-      const Observations& observations = landmarkPair.second.observations;
-      for(const auto& observationPair : observations)
-        ++viewsCardinalMap[observationPair.first]; // TODO: 0
+      for(std::size_t obsIndex = columns.observationOffsets[landmarkIndex]; obsIndex < columns.observationOffsets[landmarkIndex + 1]; ++obsIndex)
+      {
+        const std::size_t viewIndex = std::lower_bound(viewIds.begin(), viewIds.end(), columns.observationViewIds[obsIndex]) - viewIds.begin();
+        observationViews[obsIndex] = viewIndex;
+        observationLandmarks[obsIndex] = landmarkIndex;
+        ++viewOffsets[viewIndex + 1];
+      }
     }
+    std::partial_sum(viewOffsets.begin(), viewOffsets.end(), viewOffsets.begin());
 
-    // copy key-value pairs from the map to the vector
-    for(const auto& cardinalPair : viewsCardinalMap)
-      sortedViewsCardinal.push_back(ViewInfo(cardinalPair.first, cardinalPair.second));
-
-    // sort the vector, biggest cardinality first
-    std::sort(sortedViewsCardinal.begin(),
-              sortedViewsCardinal.end(),
-              [] (const ViewInfo& l, const ViewInfo& r) { return l.cardinal > r.cardinal; });
+    std::vector<std::size_t> viewCursors(viewOffsets.begin(), viewOffsets.end() - 1);
+    for(std::size_t obsIndex = 0; obsIndex < nbObservations; ++obsIndex)
+      viewObservations[viewCursors[observationViews[obsIndex]]++] = obsIndex;
   }
 
-  // assign each landmark to a view
-  for(ViewInfo& viewCardinal : sortedViewsCardinal)
+  // views sorted by cardinality, biggest first
+  std::vector<std::size_t> sortedViews(viewIds.size());
+  std::iota(sortedViews.begin(), sortedViews.end(), 0);
+  std::stable_sort(sortedViews.begin(), sortedViews.end(), [&](std::size_t l, std::size_t r) {
+    return viewOffsets[l + 1] - viewOffsets[l] > viewOffsets[r + 1] - viewOffsets[r];
+  });
+
+  // assign each landmark to the first view observing it, in the cardinality order:
+  // the landmark is colored from this observation only, so each color is written by a single thread
+  const std::size_t unassigned = std::numeric_limits<std::size_t>::max();
+  std::vector<std::size_t> landmarkObservation(columns.size(), unassigned);
+  std::vector<std::size_t> nbLandmarksPerView(viewIds.size(), 0);
+  for(const std::size_t viewIndex : sortedViews)
   {
-    std::vector<std::reference_wrapper<Landmark>> toKeep;
-    const IndexT viewId = viewCardinal.viewId;
-
-    for(int i = 0; i < remainingLandmarksToColor.size(); ++i)
+    for(std::size_t i = viewOffsets[viewIndex]; i < viewOffsets[viewIndex + 1]; ++i)
     {
-      Landmark& landmark = remainingLandmarksToColor.at(i);
-      auto it = landmark.observations.find(viewId);
-      if(it != landmark.observations.end())
-      {
-        viewCardinal.landmarks.push_back(landmark);
-      }
-      else
+      const std::size_t obsIndex = viewObservations[i];
+      std::size_t& assignedObservation = landmarkObservation[observationLandmarks[obsIndex]];
+      if(assignedObservation == unassigned)
       {
-        toKeep.push_back(landmark);
+        assignedObservation = obsIndex;
+        ++nbLandmarksPerView[viewIndex];
       }
     }
-    std::swap(toKeep, remainingLandmarksToColor);
-
-    if(remainingLandmarksToColor.empty())
-      break;
   }
 
   std::random_device randomDevice;
   std::mt19937 rng(randomDevice());
 
   // create an unsorted index container
-  std::vector<int> unsortedIndexes(sortedViewsCardinal.size()) ;
-  std::iota(std::begin(unsortedIndexes), std::end(unsortedIndexes), 0);
-  std::shuffle(unsortedIndexes.begin(), unsortedIndexes.end(), rng);
-
-  // landmark colorization
-#pragma omp parallel for
-  for(int i = 0; i < unsortedIndexes.size(); ++i)
+  std::vector<std::size_t> unsortedViews;
+  unsortedViews.reserve(viewIds.size());
+  for(std::size_t viewIndex = 0; viewIndex < viewIds.size(); ++viewIndex)
+    if(nbLandmarksPerView[viewIndex] > 0)
+      unsortedViews.push_back(viewIndex);
+  std::shuffle(unsortedViews.begin(), unsortedViews.end(), rng);
+
+  downscale = std::max(1, downscale);
+  image::ImageReadOptions readOptions(image::EImageColorSpace::SRGB);
+  readOptions.downscale = downscale;
+
+  // landmark colorization, each view streams its row of the index
+#pragma omp parallel for schedule(dynamic)
+  for(int i = 0; i < unsortedViews.size(); ++i)
   {
-    const ViewInfo& viewCardinal = sortedViewsCardinal.at(unsortedIndexes.at(i));
-    if(!viewCardinal.landmarks.empty())
-    {
-      const View& view = sfmData.getView(viewCardinal.viewId);
-      image::Image<image::RGBColor> image;
-      image::readImage(view.getImagePath(), image, image::EImageColorSpace::SRGB);
-
-      for(Landmark& landmark : viewCardinal.landmarks)
-      {
-        // color the point
-        Vec2 pt = landmark.observations.at(view.getViewId()).x;
-        // clamp the pixel position if the feature/marker center is outside the image.
-        pt.x() = clamp(pt.x(), 0.0, static_cast<double>(image.Width() - 1));
-        pt.y() = clamp(pt.y(), 0.0, static_cast<double>(image.Height() - 1));
-        landmark.rgb = image(pt.y(), pt.x());
-      }
+    const std::size_t viewIndex = unsortedViews[i];
+    const View& view = sfmData.getView(viewIds[viewIndex]);
+    image::Image<image::RGBColor> image;
+    image::readImage(view.getImagePath(), image, readOptions);
 
-      progressDisplay += viewCardinal.landmarks.size();
+    for(std::size_t j = viewOffsets[viewIndex]; j < viewOffsets[viewIndex + 1]; ++j)
+    {
+      const std::size_t obsIndex = viewObservations[j];
+      const std::size_t landmarkIndex = observationLandmarks[obsIndex];
+      if(landmarkObservation[landmarkIndex] != obsIndex)
+        continue;
+
+      // color the point
+      Vec2 pt = columns.observationPoints.col(obsIndex) / static_cast<double>(downscale);
+      // clamp the pixel position if the feature/marker center is outside the image.
+      pt.x() = clamp(pt.x(), 0.0, static_cast<double>(image.Width() - 1));
+      pt.y() = clamp(pt.y(), 0.0, static_cast<double>(image.Height() - 1));
+      columns.colors[landmarkIndex] = image(pt.y(), pt.x());
     }
+
+    progressDisplay += nbLandmarksPerView[viewIndex];
   }
+
+  columns.updateLandmarks(sfmData.getLandmarks());
 }
 
 } // namespace sfm
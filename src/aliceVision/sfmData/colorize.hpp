@@ -16,9 +16,11 @@ class SfMData;
  * @brief colorizeTracks Add the associated color to each 3D point of
  * the sfmData, using the track to determine the best view from which
  * to get the color.
+ * The views are read in parallel, each one only once.
  * @param[in,out] sfmData The container of the data
+ * @param[in] downscale The images are read with their size divided by this factor
  */
-void colorizeTracks(SfMData& sfmData);
+void colorizeTracks(SfMData& sfmData, int downscale = 1);
 
 } // namespace sfmData
 } // namespace aliceVision
@@ -1,6 +1,9 @@
 
 #include <boost/filesystem.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfmData/LandmarksColumns.hpp>
+#include <aliceVision/sfmData/NeighborCamsGraph.hpp>
+#include <aliceVision/camera/Pinhole.hpp>
 
 #define BOOST_TEST_MODULE sfmData
 
@@ -51,3 +54,131 @@ BOOST_AUTO_TEST_CASE(SfMData_InternalFolders)
   BOOST_CHECK_EQUAL(sfmData.getRelativeMatchesFolders()[0], fs::relative(refFolder, otherFolder));
 }
 
+
+BOOST_AUTO_TEST_CASE(SfMData_LandmarksColumns)
+{
+  sfmData::Landmarks landmarks;
+  for(IndexT i = 0; i < 10; ++i)
+  {
+    sfmData::Landmark& landmark = landmarks[i * 3];
+    landmark.X = Vec3(i, 2.0 * i, -1.0 * i);
+    landmark.descType = feature::EImageDescriberType::SIFT;
+    landmark.rgb = image::RGBColor(i, i + 1, i + 2);
+    for(IndexT v = 0; v < i % 4; ++v)
+      landmark.observations[v * 2] = sfmData::Observation(Vec2(v, i), i * 10 + v, 1.0 + v);
+  }
+
+  const sfmData::LandmarksColumns columns(landmarks);
+  BOOST_CHECK_EQUAL(columns.size(), landmarks.size());
+
+  std::size_t nbObs = 0;
+  std::size_t i = 0;
+  for(const auto& landmarkPair : landmarks)
+  {
+    BOOST_CHECK_EQUAL(columns.landmarkIds[i], landmarkPair.first);
+    BOOST_CHECK_EQUAL(columns.nbObservations(i), landmarkPair.second.observations.size());
+    nbObs += landmarkPair.second.observations.size();
+    ++i;
+  }
+  BOOST_CHECK_EQUAL(columns.nbObservations(), nbObs);
+
+  sfmData::Landmarks roundTrip;
+  columns.toLandmarks(roundTrip);
+  BOOST_CHECK(roundTrip == landmarks);
+
+  // update positions and colors in place
+  sfmData::LandmarksColumns updated = columns;
+  updated.positions *= 2.0;
+  updated.colors[0] = image::RGBColor(255, 0, 0);
+  updated.updateLandmarks(roundTrip);
+  BOOST_CHECK(roundTrip.at(0).rgb == image::RGBColor(255, 0, 0));
+  BOOST_CHECK(roundTrip.at(3).X.isApprox(2.0 * landmarks.at(3).X));
+  BOOST_CHECK(roundTrip.at(3).observations == landmarks.at(3).observations);
+
+  // subset, in the order of the given ids
+  const sfmData::LandmarksColumns subset(landmarks, {9, 3});
+  BOOST_CHECK_EQUAL(subset.size(), 2);
+  BOOST_CHECK_EQUAL(subset.landmarkIds[0], 9);
+  BOOST_CHECK_EQUAL(subset.nbObservations(0), landmarks.at(9).observations.size());
+  BOOST_CHECK_EQUAL(subset.nbObservations(1), landmarks.at(3).observations.size());
+  BOOST_CHECK(subset.positions.col(1).isApprox(landmarks.at(3).X));
+}
+
+BOOST_AUTO_TEST_CASE(SfMData_NeighborCamsGraph)
+{
+  sfmData::SfMData sfmData;
+  const auto intrinsic = std::make_shared<camera::Pinhole>(1000, 1000, 1000.0, 1000.0, 0.0, 0.0);
+  sfmData.intrinsics[0] = intrinsic;
+
+  // view 1 is 1m away from view 0, view 2 is 2m away, view 3 is too close to triangulate
+  const std::vector<Vec3> centers = {Vec3(0.0, 0.0, 0.0), Vec3(1.0, 0.0, 0.0), Vec3(0.0, 2.0, 0.0), Vec3(0.01, 0.0, 0.0)};
+  for(IndexT viewId = 0; viewId < centers.size(); ++viewId)
+  {
+    sfmData.views[viewId] = std::make_shared<sfmData::View>("", viewId, 0, viewId, 1000, 1000);
+    sfmData.setPose(*sfmData.views[viewId], sfmData::CameraPose(geometry::Pose3(Mat3::Identity(), centers[viewId])));
+  }
+
+  // landmarks 10m in front of the cameras, seen by view 0 and another view
+  const std::vector<std::pair<IndexT, int>> sharedLandmarks = {{1, 30}, {2, 25}, {3, 40}};
+  IndexT landmarkId = 0;
+  for(const auto& shared : sharedLandmarks)
+  {
+    for(int i = 0; i < shared.second; ++i)
+    {
+      sfmData::Landmark& landmark = sfmData.structure[landmarkId++];
+      landmark.X = Vec3(0.1 * i, 0.05 * i, 10.0);
+      for(IndexT viewId : {IndexT(0), shared.first})
+      {
+        const geometry::Pose3 pose = sfmData.getPose(*sfmData.views[viewId]).getTransform();
+        landmark.observations[viewId] = sfmData::Observation(intrinsic->project(pose, landmark.X.homogeneous()), i, 1.0);
+      }
+    }
+  }
+
+  sfmData::NeighborCamsGraph graph;
+  graph.build(sfmData, 2.0f, 70.0f);
+
+  // view 3 is not a neighbor, the angles between its rays and the rays of view 0 are too small
+  const std::vector<sfmData::NeighborCam>& neighbors = graph.getNeighbors(0);
+  BOOST_REQUIRE_EQUAL(neighbors.size(), 2);
+  BOOST_CHECK_EQUAL(neighbors[0].viewId, 1);
+  BOOST_CHECK_EQUAL(neighbors[0].nbSharedLandmarks, 30);
+  BOOST_CHECK_CLOSE(neighbors[0].overlap, 30.f / 95.f, 1e-3);
+  BOOST_CHECK_CLOSE(neighbors[0].baseline, 1.0, 1e-6);
+  BOOST_CHECK_EQUAL(neighbors[1].viewId, 2);
+  BOOST_CHECK_EQUAL(neighbors[1].nbSharedLandmarks, 25);
+  BOOST_CHECK_GT(neighbors[1].meanAngle, neighbors[0].meanAngle);
+  BOOST_CHECK(graph.getNeighbors(3).empty());
+  BOOST_CHECK_EQUAL(graph.getNeighbors(1).size(), 1);
+
+  // save and load
+  const std::string filename = "neighborCams_test.json";
+  BOOST_REQUIRE(graph.save(filename));
+  sfmData::NeighborCamsGraph loadedGraph;
+  BOOST_REQUIRE(loadedGraph.load(filename, sfmData));
+  BOOST_CHECK(loadedGraph.hasViewAngles(2.0f, 70.0f));
+  BOOST_REQUIRE_EQUAL(loadedGraph.getNeighbors(0).size(), 2);
+  BOOST_CHECK_EQUAL(loadedGraph.getNeighbors(0)[1].viewId, 2);
+  BOOST_CHECK_EQUAL(loadedGraph.getNeighbors(0)[1].nbSharedLandmarks, 25);
+
+  // the graph is rejected if the cameras or the landmarks have changed since it was built
+  {
+    sfmData::SfMData movedSfmData = sfmData;
+    movedSfmData.setPose(*movedSfmData.views[2], sfmData::CameraPose(geometry::Pose3(Mat3::Identity(), Vec3(0.0, 2.5, 0.0))));
+    BOOST_CHECK(!loadedGraph.load(filename, movedSfmData));
+    BOOST_CHECK(loadedGraph.empty());
+  }
+  {
+    sfmData::SfMData otherViewsSfmData = sfmData;
+    otherViewsSfmData.views[4] = std::make_shared<sfmData::View>("", 4, 0, 4, 1000, 1000);
+    otherViewsSfmData.setPose(*otherViewsSfmData.views[4], sfmData::CameraPose(geometry::Pose3(Mat3::Identity(), Vec3(3.0, 0.0, 0.0))));
+    BOOST_CHECK(!loadedGraph.load(filename, otherViewsSfmData));
+  }
+  {
+    sfmData::SfMData otherLandmarksSfmData = sfmData;
+    otherLandmarksSfmData.structure.erase(0);
+    BOOST_CHECK(!loadedGraph.load(filename, otherLandmarksSfmData));
+  }
+  BOOST_CHECK(loadedGraph.load(filename, sfmData));
+  fs::remove(filename);
+}
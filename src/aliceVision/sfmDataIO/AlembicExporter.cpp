@@ -401,22 +401,28 @@ void AlembicExporter::addLandmarks(const sfmData::Landmarks& landmarks, const sf
   if(landmarks.empty())
     return;
 
+  // the landmarks by index, to fill the contiguous arrays in parallel
+  std::vector<sfmData::Landmarks::const_iterator> landmarkIts;
+  landmarkIts.reserve(landmarks.size());
+  for(auto it = landmarks.begin(); it != landmarks.end(); ++it)
+    landmarkIts.push_back(it);
+  const int nbLandmarks = static_cast<int>(landmarkIts.size());
+
   // Fill vector with the values taken from AliceVision
-  std::vector<V3f> positions;
-  std::vector<Imath::C3f> colors;
-  std::vector<Alembic::Util::uint32_t> descTypes;
-  positions.reserve(landmarks.size());
-  descTypes.reserve(landmarks.size());
-
-  // For all the 3d points in the hash_map
-  for(const auto& landmark : landmarks)
+  std::vector<V3f> positions(nbLandmarks);
+  std::vector<Imath::C3f> colors(nbLandmarks);
+  std::vector<Alembic::Util::uint32_t> descTypes(nbLandmarks);
+
+  #pragma omp parallel for
+  for(int i = 0; i < nbLandmarks; ++i)
   {
-    const Vec3& pt = landmark.second.X;
-    const image::RGBColor& color = landmark.second.rgb;
+    const sfmData::Landmark& landmark = landmarkIts[i]->second;
+    const Vec3& pt = landmark.X;
+    const image::RGBColor& color = landmark.rgb;
     // convert position from computer vision convention to computer graphics (opengl-like)
-    positions.emplace_back(pt[0], -pt[1], -pt[2]);
-    colors.emplace_back(color.r()/255.f, color.g()/255.f, color.b()/255.f);
-    descTypes.emplace_back(static_cast<Alembic::Util::uint8_t>(landmark.second.descType));
+    positions[i] = V3f(pt[0], -pt[1], -pt[2]);
+    colors[i] = Imath::C3f(color.r()/255.f, color.g()/255.f, color.b()/255.f);
+    descTypes[i] = static_cast<Alembic::Util::uint8_t>(landmark.descType);
   }
 
   std::vector<Alembic::Util::uint64_t> ids(positions.size());
@@ -442,50 +448,52 @@ void AlembicExporter::addLandmarks(const sfmData::Landmarks& landmarks, const sf
 
   if(withVisibility)
   {
-    std::vector<::uint32_t> visibilitySize;
-    visibilitySize.reserve(positions.size());
-    for(const auto& landmark : landmarks)
+    std::vector<::uint32_t> visibilitySize(nbLandmarks);
+    // offsets of the observations of each landmark in the visibility arrays
+    std::vector<std::size_t> visibilityOffsets(nbLandmarks + 1, 0);
+    for(int i = 0; i < nbLandmarks; ++i)
     {
-      visibilitySize.emplace_back(landmark.second.observations.size());
+      visibilitySize[i] = landmarkIts[i]->second.observations.size();
+      visibilityOffsets[i + 1] = visibilityOffsets[i] + visibilitySize[i];
     }
-    std::size_t nbObservations = std::accumulate(visibilitySize.begin(), visibilitySize.end(), 0);
+    const std::size_t nbObservations = visibilityOffsets.back();
 
     // Use std::vector<::uint32_t> and std::vector<float> instead of std::vector<V2i> and std::vector<V2f>
     // Because Maya don't import them correctly
-    std::vector<::uint32_t> visibilityViewId;
+    std::vector<::uint32_t> visibilityViewId(nbObservations);
     std::vector<::uint32_t> visibilityFeatId;
-    visibilityViewId.reserve(nbObservations);
-
     std::vector<float> featPos2d;
     std::vector<float> featScale;
     if(withFeatures)
     {
-      featPos2d.reserve(nbObservations*2);
-      visibilityFeatId.reserve(nbObservations);
-      featScale.reserve(nbObservations);
+      featPos2d.resize(nbObservations*2);
+      visibilityFeatId.resize(nbObservations);
+      featScale.resize(nbObservations);
     }
 
-    for (const auto& landmark : landmarks)
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for(int i = 0; i < nbLandmarks; ++i)
     {
-      const sfmData::Observations& observations = landmark.second.observations;
-      for(const auto& vObs: observations )
+      std::size_t obsIndex = visibilityOffsets[i];
+      for(const auto& vObs : landmarkIts[i]->second.observations)
       {
         const sfmData::Observation& obs = vObs.second;
 
         // viewId
-        visibilityViewId.emplace_back(vObs.first);
+        visibilityViewId[obsIndex] = vObs.first;
 
         if(withFeatures)
         {
           // featureId
-          visibilityFeatId.emplace_back(obs.id_feat);
+          visibilityFeatId[obsIndex] = obs.id_feat;
 
           // feature 2D position (x, y))
-          featPos2d.emplace_back(obs.x[0]);
-          featPos2d.emplace_back(obs.x[1]);
+          featPos2d[2 * obsIndex] = obs.x[0];
+          featPos2d[2 * obsIndex + 1] = obs.x[1];
 
-          featScale.emplace_back(obs.scale);
+          featScale[obsIndex] = obs.scale;
         }
+        ++obsIndex;
       }
     }
 
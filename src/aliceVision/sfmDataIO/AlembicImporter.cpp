@@ -133,7 +133,7 @@ struct AV_UInt32ArraySamplePtr
     return _isUnsigned ? _v_uint->size() : _v_int->size();
   }
 
-  std::size_t operator[](const std::size_t& i)
+  std::size_t operator[](const std::size_t& i) const
   {
     return _isUnsigned ? (*_v_uint)[i] : (*_v_int)[i];
   }
@@ -189,17 +189,18 @@ bool readPointCloud(const Version & abcVersion, IObject iObj, M44d mat, sfmData:
     }
   }
 
-  // Number of points before adding the Alembic data
+  // the landmarks are decoded in parallel, then added after the existing ones
   const std::size_t nbPointsInit = sfmdata.structure.size();
-  for(std::size_t point3d_i = 0;
-      point3d_i < positions->size();
-      ++point3d_i)
+  const int nbPoints = static_cast<int>(positions->size());
+  std::vector<sfmData::Landmark> landmarks(nbPoints);
+
+  #pragma omp parallel for
+  for(int point3d_i = 0; point3d_i < nbPoints; ++point3d_i)
   {
     const P3fArraySamplePtr::element_type::value_type & pos_i = positions->get()[point3d_i];
 
+    sfmData::Landmark& landmark = landmarks[point3d_i];
 
-    sfmData::Landmark& landmark = sfmdata.structure[nbPointsInit + point3d_i];
-    
     if (abcVersion < Version(1, 2, 3))
     {
       landmark = sfmData::Landmark(Vec3(pos_i.x, pos_i.y, pos_i.z), feature::EImageDescriberType::UNKNOWN);
@@ -226,6 +227,15 @@ bool readPointCloud(const Version & abcVersion, IObject iObj, M44d mat, sfmData:
     }
   }
 
+  // offsets of the observations of each 3D point in the visibility arrays
+  const auto computeVisibilityOffsets = [&](const AV_UInt32ArraySamplePtr& sampleVisibilitySize)
+  {
+    std::vector<std::size_t> offsets(nbPoints + 1, 0);
+    for(int point3d_i = 0; point3d_i < nbPoints; ++point3d_i)
+      offsets[point3d_i + 1] = offsets[point3d_i] + sampleVisibilitySize[point3d_i];
+    return offsets;
+  };
+
   // for compatibility with files generated with a previous version
   if(userProps &&
      userProps.getPropertyHeader("mvg_visibilitySize") &&
@@ -255,20 +265,20 @@ bool readPointCloud(const Version & abcVersion, IObject iObj, M44d mat, sfmData:
       return false;
     }
 
-    std::size_t obsGlobal_i = 0;
-    for(std::size_t point3d_i = 0;
-        point3d_i < positions->size();
-        ++point3d_i)
+    const std::vector<std::size_t> offsets = computeVisibilityOffsets(sampleVisibilitySize);
+    if(2 * offsets.back() > sampleVisibilityIds.size())
     {
-      sfmData::Landmark& landmark = sfmdata.structure[nbPointsInit + point3d_i];
-      // Number of observation for this 3d point
-      const std::size_t visibilitySize = sampleVisibilitySize[point3d_i];
+      ALICEVISION_LOG_ERROR("Alembic Error: the visibility sizes exceed the number of visibility Ids.");
+      return false;
+    }
 
-      for(std::size_t obs_i = 0;
-          obs_i < visibilitySize*2;
-          obs_i+=2, obsGlobal_i+=2)
-      {
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for(int point3d_i = 0; point3d_i < nbPoints; ++point3d_i)
+    {
+      sfmData::Landmark& landmark = landmarks[point3d_i];
 
+      for(std::size_t obsGlobal_i = 2 * offsets[point3d_i]; obsGlobal_i < 2 * offsets[point3d_i + 1]; obsGlobal_i += 2)
+      {
         const int viewID = sampleVisibilityIds[obsGlobal_i];
         const int featID = sampleVisibilityIds[obsGlobal_i+1];
         sfmData::Observation& observations = landmark.observations[viewID];
@@ -338,16 +348,19 @@ bool readPointCloud(const Version & abcVersion, IObject iObj, M44d mat, sfmData:
 
     const bool hasFeatures = bool(sampleVisibilityFeatId) && (sampleVisibilityFeatId.size() > 0);
 
-    std::size_t obsGlobalIndex = 0;
-    for(std::size_t point3d_i = 0; point3d_i < positions->size(); ++point3d_i)
+    const std::vector<std::size_t> offsets = computeVisibilityOffsets(sampleVisibilitySize);
+    if(offsets.back() > sampleVisibilityViewId.size())
     {
-      const int landmarkId = nbPointsInit + point3d_i;
-      sfmData::Landmark& landmark = sfmdata.structure[landmarkId];
+      ALICEVISION_LOG_ERROR("Alembic Error: the visibility sizes exceed the number of visibility view Ids.");
+      return false;
+    }
 
-      // Number of observation for this 3d point
-      const std::size_t visibilitySize = sampleVisibilitySize[point3d_i];
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for(int point3d_i = 0; point3d_i < nbPoints; ++point3d_i)
+    {
+      sfmData::Landmark& landmark = landmarks[point3d_i];
 
-      for(std::size_t obs_i = 0; obs_i < visibilitySize; ++obs_i, ++obsGlobalIndex)
+      for(std::size_t obsGlobalIndex = offsets[point3d_i]; obsGlobalIndex < offsets[point3d_i + 1]; ++obsGlobalIndex)
       {
         const int viewId = sampleVisibilityViewId[obsGlobalIndex];
 
@@ -372,11 +385,13 @@ bool readPointCloud(const Version & abcVersion, IObject iObj, M44d mat, sfmData:
         {
           landmark.observations[viewId] = sfmData::Observation();
         }
-
       }
     }
   }
 
+  for(int point3d_i = 0; point3d_i < nbPoints; ++point3d_i)
+    sfmdata.structure[nbPointsInit + point3d_i] = std::move(landmarks[point3d_i]);
+
   return true;
 }
 
@@ -10,6 +10,9 @@
 
 #include <boost/filesystem.hpp>
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <sstream>
 #include <fstream>
 
@@ -27,8 +30,56 @@ ColmapConfig::ColmapConfig(const std::string& basePath)
     _camerasTxtPath = (fs::path(_sparseDirectory) / fs::path("cameras.txt")).string();
     _imagesTxtPath = (fs::path(_sparseDirectory) / fs::path("images.txt")).string();
     _points3DPath = (fs::path(_sparseDirectory) / fs::path("points3D.txt")).string();
+    _camerasBinPath = (fs::path(_sparseDirectory) / fs::path("cameras.bin")).string();
+    _imagesBinPath = (fs::path(_sparseDirectory) / fs::path("images.bin")).string();
+    _points3DBinPath = (fs::path(_sparseDirectory) / fs::path("points3D.bin")).string();
 }
 
+namespace {
+
+/// append a value to a buffer in the Colmap binary format (little endian)
+template <typename T>
+void appendBinary(std::string& buffer, const T& value)
+{
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+/**
+ * @brief Format the items in parallel and write them in order.
+ *        The items are formatted by chunks, and the chunks are written by blocks to bound the memory.
+ * @param[in,out] outfile the output file
+ * @param[in] nbItems the number of items
+ * @param[in] chunkSize the number of items per chunk
+ * @param[in] format the function appending the item of the given index to a buffer
+ */
+template <typename FormatFunction>
+void writeParallel(std::ofstream& outfile, std::size_t nbItems, std::size_t chunkSize, const FormatFunction& format)
+{
+    const std::size_t nbChunksPerBlock = 256;
+    std::vector<std::string> chunks(nbChunksPerBlock);
+
+    for(std::size_t blockStart = 0; blockStart < nbItems; blockStart += chunkSize * nbChunksPerBlock)
+    {
+        const int nbChunks = static_cast<int>(std::min(nbChunksPerBlock, (nbItems - blockStart + chunkSize - 1) / chunkSize));
+
+        #pragma omp parallel for schedule(dynamic)
+        for(int c = 0; c < nbChunks; ++c)
+        {
+            std::string& buffer = chunks[c];
+            buffer.clear();
+            const std::size_t begin = blockStart + c * chunkSize;
+            const std::size_t end = std::min(begin + chunkSize, nbItems);
+            for(std::size_t i = begin; i < end; ++i)
+                format(i, buffer);
+        }
+
+        for(int c = 0; c < nbChunks; ++c)
+            outfile.write(chunks[c].data(), chunks[c].size());
+    }
+}
+
+} // namespace
+
 const std::set<camera::EINTRINSIC>& colmapCompatibleIntrinsics()
 {
     static const std::set<camera::EINTRINSIC> compatibleIntrinsics{
@@ -227,6 +278,58 @@ std::string convertIntrinsicsToColmapString(const IndexT intrinsicsID, std::shar
     return intrString.str();
 }
 
+int convertIntrinsicsToColmapParams(const IndexT intrinsicsID, std::shared_ptr<camera::IntrinsicBase> intrinsic,
+                                    std::vector<double>& params)
+{
+    // Colmap camera model ids
+    enum : int
+    {
+        PINHOLE = 1,
+        OPENCV_FISHEYE = 5,
+        FULL_OPENCV = 6,
+        FOV = 7
+    };
+
+    const camera::EINTRINSIC intrinsicType = intrinsic->getType();
+    if(!isColmapCompatible(intrinsicType))
+    {
+        throw std::invalid_argument("The intrinsics " + EINTRINSIC_enumToString(intrinsicType) + " for camera " +
+                                    std::to_string(intrinsicsID) + " are not supported in Colmap");
+    }
+
+    // all the compatible intrinsics are pinhole cameras, see convertIntrinsicsToColmapString for the parameters
+    const camera::Pinhole* pinhole = dynamic_cast<const camera::Pinhole*>(intrinsic.get());
+    const std::vector<double> intrinsicParams = pinhole->getParams();
+    params = {pinhole->getFocalLengthPixX(), pinhole->getFocalLengthPixY(), pinhole->getPrincipalPoint().x(),
+              pinhole->getPrincipalPoint().y()};
+
+    switch(intrinsicType)
+    {
+        case camera::PINHOLE_CAMERA:
+            return PINHOLE;
+        case camera::PINHOLE_CAMERA_RADIAL1:
+            // k1, k2, p1, p2, k3, k4, k5, k6
+            params.insert(params.end(), {intrinsicParams.at(4), 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0});
+            return FULL_OPENCV;
+        case camera::PINHOLE_CAMERA_RADIAL3:
+            params.insert(params.end(), {intrinsicParams.at(4), intrinsicParams.at(5), 0.0, 0.0, intrinsicParams.at(6),
+                                         0.0, 0.0, 0.0});
+            return FULL_OPENCV;
+        case camera::PINHOLE_CAMERA_BROWN:
+            params.insert(params.end(), {intrinsicParams.at(4), intrinsicParams.at(5), intrinsicParams.at(7),
+                                         intrinsicParams.at(8), intrinsicParams.at(6), 0.0, 0.0, 0.0});
+            return FULL_OPENCV;
+        case camera::PINHOLE_CAMERA_FISHEYE:
+            // k1, k2, k3, k4
+            params.insert(params.end(), intrinsicParams.begin() + 4, intrinsicParams.begin() + 8);
+            return OPENCV_FISHEYE;
+        default:
+            // PINHOLE_CAMERA_FISHEYE1, omega
+            params.push_back(intrinsicParams.at(4));
+            return FOV;
+    }
+}
+
 void generateColmapCamerasTxtFile(const sfmData::SfMData& sfmData, const std::string& filename)
 {
     // Adapted from Colmap Reconstruction::WriteCamerasText()
@@ -400,9 +503,178 @@ void generateColmapPoints3DTxtFile(const sfmData::SfMData& sfmData, const Compat
     }
 }
 
+void generateColmapCamerasBinFile(const sfmData::SfMData& sfmData, const std::string& filename)
+{
+    // adapted from Colmap's Reconstruction::WriteCamerasBinary()
+    std::ofstream outfile(filename, std::ios::binary);
+
+    if(!outfile)
+    {
+        ALICEVISION_LOG_ERROR("Unable to create the cameras file " << filename);
+        throw std::runtime_error("Unable to create the cameras file " + filename);
+    }
+
+    std::string buffer;
+    std::uint64_t nbCameras = 0;
+    for(const auto& iter : sfmData.getIntrinsics())
+    {
+        const IndexT intrID = iter.first;
+        const std::shared_ptr<camera::IntrinsicBase>& intrinsic = iter.second;
+        if(!isColmapCompatible(intrinsic->getType()))
+            continue;
+
+        std::vector<double> params;
+        const int modelId = convertIntrinsicsToColmapParams(intrID, intrinsic, params);
+
+        appendBinary(buffer, static_cast<std::uint32_t>(intrID));
+        appendBinary(buffer, modelId);
+        appendBinary(buffer, static_cast<std::uint64_t>(intrinsic->w()));
+        appendBinary(buffer, static_cast<std::uint64_t>(intrinsic->h()));
+        for(const double param : params)
+            appendBinary(buffer, param);
+        ++nbCameras;
+    }
+
+    outfile.write(reinterpret_cast<const char*>(&nbCameras), sizeof(nbCameras));
+    outfile.write(buffer.data(), buffer.size());
+}
+
+void generateColmapImagesBinFile(const sfmData::SfMData& sfmData, const CompatibleList& viewSelections,
+                                 const PerViewVisibility& perViewVisibility, const std::string& filename)
+{
+    // adapted from Colmap's Reconstruction::WriteImagesBinary()
+    std::ofstream outfile(filename, std::ios::binary);
+
+    if(!outfile)
+    {
+        ALICEVISION_LOG_ERROR("Unable to create the image file " << filename);
+        throw std::runtime_error("Unable to create the image file " + filename);
+    }
+
+    std::vector<IndexT> viewIDs(viewSelections.begin(), viewSelections.end());
+    std::sort(viewIDs.begin(), viewIDs.end());
+
+    const std::uint64_t nbImages = viewIDs.size();
+    outfile.write(reinterpret_cast<const char*>(&nbImages), sizeof(nbImages));
+
+    const std::map<IndexT, Vec2> noVisibility;
+
+    // one image per chunk, the images have a lot of points
+    writeParallel(outfile, viewIDs.size(), 1, [&](std::size_t i, std::string& buffer)
+    {
+        const IndexT viewID = viewIDs[i];
+        const auto visibilityIt = perViewVisibility.find(viewID);
+        const auto& visibility = (visibilityIt != perViewVisibility.end()) ? visibilityIt->second : noVisibility;
+        const sfmData::View& view = sfmData.getView(viewID);
+
+        const auto pose = sfmData.getPose(view).getTransform();
+        const Eigen::Quaterniond quat(pose.rotation());
+        const Vec3 tra = pose.translation();
+
+        appendBinary(buffer, static_cast<std::uint32_t>(viewID));
+        appendBinary(buffer, quat.w());
+        appendBinary(buffer, quat.x());
+        appendBinary(buffer, quat.y());
+        appendBinary(buffer, quat.z());
+        appendBinary(buffer, tra[0]);
+        appendBinary(buffer, tra[1]);
+        appendBinary(buffer, tra[2]);
+        appendBinary(buffer, static_cast<std::uint32_t>(view.getIntrinsicId()));
+        // the image name is null terminated
+        const std::string imageFilename = fs::path(view.getImagePath()).filename().string();
+        buffer.append(imageFilename.c_str(), imageFilename.size() + 1);
+
+        appendBinary(buffer, static_cast<std::uint64_t>(visibility.size()));
+        for(const auto& obs : visibility)
+        {
+            appendBinary(buffer, obs.second.x());
+            appendBinary(buffer, obs.second.y());
+            appendBinary(buffer, static_cast<std::uint64_t>(obs.first));
+        }
+    });
+}
+
+void generateColmapPoints3DBinFile(const sfmData::SfMData& sfmData, const PerViewVisibility& perViewVisibility,
+                                   const std::string& filename)
+{
+    // adapted from Colmap's Reconstruction::WritePoints3DBinary()
+    std::ofstream outfile(filename, std::ios::binary);
+
+    if(!outfile)
+    {
+        ALICEVISION_LOG_ERROR("Unable to create the 3D point file " << filename);
+        throw std::runtime_error("Unable to create the 3D point file " + filename);
+    }
+
+    // the sorted landmark IDs of each image, the index of a landmark is the index of its 2D point in the image
+    std::map<IndexT, std::vector<IndexT>> landmarksPerView;
+    for(const auto& viewVisibility : perViewVisibility)
+    {
+        std::vector<IndexT>& landmarkIds = landmarksPerView[viewVisibility.first];
+        landmarkIds.reserve(viewVisibility.second.size());
+        for(const auto& obs : viewVisibility.second)
+            landmarkIds.push_back(obs.first);
+    }
+
+    const sfmData::Landmarks& landmarks = sfmData.getLandmarks();
+    std::vector<sfmData::Landmarks::const_iterator> landmarkIts;
+    landmarkIts.reserve(landmarks.size());
+    for(auto it = landmarks.begin(); it != landmarks.end(); ++it)
+        landmarkIts.push_back(it);
+
+    const std::uint64_t nbPoints = landmarkIts.size();
+    outfile.write(reinterpret_cast<const char*>(&nbPoints), sizeof(nbPoints));
+
+    // default reprojection error (not used)
+    const double defaultError{-1.0};
+
+    writeParallel(outfile, landmarkIts.size(), 1024, [&](std::size_t i, std::string& buffer)
+    {
+        const IndexT landmarkId = landmarkIts[i]->first;
+        const sfmData::Landmark& landmark = landmarkIts[i]->second;
+
+        appendBinary(buffer, static_cast<std::uint64_t>(landmarkId));
+        appendBinary(buffer, landmark.X.x());
+        appendBinary(buffer, landmark.X.y());
+        appendBinary(buffer, landmark.X.z());
+        appendBinary(buffer, static_cast<std::uint8_t>(landmark.rgb.r()));
+        appendBinary(buffer, static_cast<std::uint8_t>(landmark.rgb.g()));
+        appendBinary(buffer, static_cast<std::uint8_t>(landmark.rgb.b()));
+        appendBinary(buffer, defaultError);
+
+        // the track length is known once the observations of the selected views are written
+        const std::size_t trackLengthOffset = buffer.size();
+        appendBinary(buffer, std::uint64_t(0));
+        std::uint64_t trackLength = 0;
+
+        for(const auto& itObs : landmark.observations)
+        {
+            const auto viewIt = landmarksPerView.find(itObs.first);
+            if(viewIt == landmarksPerView.end())
+                continue;
+
+            const std::vector<IndexT>& viewLandmarkIds = viewIt->second;
+            const auto point2DIt = std::lower_bound(viewLandmarkIds.begin(), viewLandmarkIds.end(), landmarkId);
+            appendBinary(buffer, static_cast<std::uint32_t>(itObs.first));
+            appendBinary(buffer, static_cast<std::uint32_t>(std::distance(viewLandmarkIds.begin(), point2DIt)));
+            ++trackLength;
+        }
+        std::memcpy(&buffer[trackLengthOffset], &trackLength, sizeof(trackLength));
+    });
+}
+
 void generateColmapSceneFiles(const sfmData::SfMData& sfmData, const CompatibleList& viewsSelection,
-                              const ColmapConfig& colmapParams)
+                              const ColmapConfig& colmapParams, bool binary)
 {
+    if(binary)
+    {
+        const auto perViewVisibility = computePerViewVisibility(sfmData, viewsSelection);
+        generateColmapCamerasBinFile(sfmData, colmapParams._camerasBinPath);
+        generateColmapImagesBinFile(sfmData, viewsSelection, perViewVisibility, colmapParams._imagesBinPath);
+        generateColmapPoints3DBinFile(sfmData, perViewVisibility, colmapParams._points3DBinPath);
+        return;
+    }
+
     generateColmapCamerasTxtFile(sfmData, colmapParams._camerasTxtPath);
     generateColmapImagesTxtFile(sfmData, viewsSelection, colmapParams._imagesTxtPath);
     generateColmapPoints3DTxtFile(sfmData, viewsSelection, colmapParams._points3DPath);
@@ -418,7 +690,8 @@ void create_directories(const std::string& directory)
     }
 }
 
-void convertToColmapScene(const sfmData::SfMData& sfmData, const std::string& colmapBaseDir, bool copyImages)
+void convertToColmapScene(const sfmData::SfMData& sfmData, const std::string& colmapBaseDir, bool copyImages,
+                          bool binary)
 {
     // retrieve the views that are compatible with Colmap and that can be exported
     const auto views2export = getColmapCompatibleViews(sfmData);
@@ -446,7 +719,7 @@ void convertToColmapScene(const sfmData::SfMData& sfmData, const std::string& co
     }
 
     ALICEVISION_LOG_INFO("Generating Colmap files...");
-    generateColmapSceneFiles(sfmData, views2export, colmapParams);
+    generateColmapSceneFiles(sfmData, views2export, colmapParams, binary);
 }
 
 }
@@ -14,6 +14,10 @@
 #include <boost/test/tools/floating_point_comparison.hpp>
 #include <aliceVision/unitTest.hpp>
 
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+
 using namespace aliceVision;
 
 BOOST_AUTO_TEST_CASE(colmap_isCompatible)
@@ -125,4 +129,78 @@ BOOST_AUTO_TEST_CASE(colmap_convertIntrinsicsToColmapString)
             BOOST_CHECK(sfmDataIO::isColmapCompatible(sfmTest.getIntrinsics().at(intrID)->getType()));
         }
     }
-}
\ No newline at end of file
+}
+BOOST_AUTO_TEST_CASE(colmap_convertIntrinsicsToColmapParams)
+{
+    const auto brown = std::make_shared<camera::PinholeBrownT2>(1920, 1080, 1548.76, 1547.32, 992.36, 549.54, -0.02078,
+                                                                0.1705, -0.00714, 0.00134, -0.000542);
+    std::vector<double> params;
+    // FULL_OPENCV
+    BOOST_CHECK_EQUAL(sfmDataIO::convertIntrinsicsToColmapParams(13, brown, params), 6);
+
+    const std::vector<double> paramsRef{1548.76, 1547.32, 1952.36, 1089.54, -0.02078, 0.1705,
+                                        0.00134, -0.000542, -0.00714, 0.0, 0.0, 0.0};
+    BOOST_CHECK_EQUAL(params.size(), paramsRef.size());
+    for(std::size_t i = 0; i < std::min(params.size(), paramsRef.size()); ++i)
+        BOOST_CHECK_SMALL(params[i] - paramsRef[i], 1e-9);
+
+    const auto incompatible = std::make_shared<camera::EquiDistant>(1920, 1080, 1548.76, 992.36, 549.54, -0.02078);
+    BOOST_CHECK_THROW(sfmDataIO::convertIntrinsicsToColmapParams(23, incompatible, params), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(colmap_binaryPoints3DTracks)
+{
+    sfmData::SfMData sfmTest{};
+    sfmTest.getIntrinsics().emplace(0, std::make_shared<camera::Pinhole>(1920, 1080, 1548.76, 1547.32, 992.36, 549.54));
+    for(IndexT viewId = 0; viewId < 2; ++viewId)
+    {
+        sfmTest.getViews().emplace(viewId, std::make_shared<sfmData::View>("", viewId, 0, viewId));
+        sfmTest.getPoses().emplace(viewId, sfmData::CameraPose());
+    }
+
+    // landmark 5 is only seen by the view 1
+    for(IndexT landmarkId : {2, 5, 7})
+    {
+        sfmData::Landmark landmark(Vec3(0.0, 0.0, 1.0), feature::EImageDescriberType::SIFT);
+        if(landmarkId != 5)
+            landmark.observations[0] = sfmData::Observation(Vec2(landmarkId, 0.0), landmarkId, 1.0);
+        landmark.observations[1] = sfmData::Observation(Vec2(landmarkId, 1.0), landmarkId, 1.0);
+        sfmTest.getLandmarks().emplace(landmarkId, landmark);
+    }
+
+    const sfmDataIO::CompatibleList views{0, 1};
+    const auto perViewVisibility = sfmDataIO::computePerViewVisibility(sfmTest, views);
+    sfmDataIO::generateColmapPoints3DBinFile(sfmTest, perViewVisibility, "colmap_points3D.bin");
+
+    // read the tracks, each point2D index refers to the position of the landmark in the sorted image points
+    std::ifstream infile("colmap_points3D.bin", std::ios::binary);
+    std::uint64_t nbPoints = 0;
+    infile.read(reinterpret_cast<char*>(&nbPoints), sizeof(nbPoints));
+    BOOST_CHECK_EQUAL(nbPoints, 3);
+
+    const std::map<std::pair<std::uint32_t, std::uint64_t>, std::uint32_t> point2DIndexRef{
+        {{0, 2}, 0}, {{0, 7}, 1}, {{1, 2}, 0}, {{1, 5}, 1}, {{1, 7}, 2}};
+
+    for(std::uint64_t i = 0; i < nbPoints; ++i)
+    {
+        std::uint64_t pointId = 0;
+        infile.read(reinterpret_cast<char*>(&pointId), sizeof(pointId));
+        // X, Y, Z, R, G, B, error
+        infile.seekg(3 * sizeof(double) + 3 * sizeof(std::uint8_t) + sizeof(double), std::ios::cur);
+        std::uint64_t trackLength = 0;
+        infile.read(reinterpret_cast<char*>(&trackLength), sizeof(trackLength));
+        BOOST_CHECK_EQUAL(trackLength, (pointId == 5) ? 1 : 2);
+
+        for(std::uint64_t j = 0; j < trackLength; ++j)
+        {
+            std::uint32_t imageId = 0;
+            std::uint32_t point2DIndex = 0;
+            infile.read(reinterpret_cast<char*>(&imageId), sizeof(imageId));
+            infile.read(reinterpret_cast<char*>(&point2DIndex), sizeof(point2DIndex));
+            BOOST_CHECK_EQUAL(point2DIndex, point2DIndexRef.at({imageId, pointId}));
+        }
+    }
+    BOOST_CHECK(infile.good());
+    infile.close();
+    std::remove("colmap_points3D.bin");
+}
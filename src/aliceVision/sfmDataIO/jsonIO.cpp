@@ -10,8 +10,20 @@
 
 #include <boost/property_tree/json_parser.hpp>
 
-#include <memory>
 #include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
 
 namespace aliceVision {
 namespace sfmDataIO {
@@ -395,6 +407,733 @@ void loadLandmark(IndexT& landmarkId, sfmData::Landmark& landmark, bpt::ptree& l
   }
 }
 
+namespace {
+
+/// A range of the JSON text
+using JsonRange = std::pair<const char*, const char*>;
+
+/**
+ * @brief Escape a string as the boost property tree JSON writer does
+ */
+void appendEscaped(std::string& out, const std::string& value)
+{
+  static const char* hexDigits = "0123456789ABCDEF";
+
+  for(const char c : value)
+  {
+    const unsigned char u = static_cast<unsigned char>(c);
+
+    if(u == 0x20 || u == 0x21 || (u >= 0x23 && u <= 0x2E) || (u >= 0x30 && u <= 0x5B) || u >= 0x5D)
+      out += c;
+    else if(c == '\b') out += "\\b";
+    else if(c == '\f') out += "\\f";
+    else if(c == '\n') out += "\\n";
+    else if(c == '\r') out += "\\r";
+    else if(c == '\t') out += "\\t";
+    else if(c == '/')  out += "\\/";
+    else if(c == '"')  out += "\\\"";
+    else if(c == '\\') out += "\\\\";
+    else
+    {
+      out += "\\u00";
+      out += hexDigits[u / 16];
+      out += hexDigits[u % 16];
+    }
+  }
+}
+
+inline void appendIndent(std::string& out, int indent)
+{
+  out.append(4 * indent, ' ');
+}
+
+/**
+ * @brief Append a JSON value, written as a string like all the values of the boost property tree JSON writer
+ */
+inline void appendValue(std::string& out, const std::string& value)
+{
+  out += '"';
+  appendEscaped(out, value);
+  out += '"';
+}
+
+inline void appendValue(std::string& out, double value)
+{
+  // same precision as the property tree: max_digits10
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), "%.*g", std::numeric_limits<double>::max_digits10, value);
+  out += '"';
+  out += buffer;
+  out += '"';
+}
+
+template<typename T, typename std::enable_if<std::is_integral<T>::value, int>::type = 0>
+inline void appendValue(std::string& out, T value)
+{
+  // the characters are written as numbers like in the property tree
+  out += '"';
+  out += std::to_string(static_cast<typename std::conditional<std::is_signed<T>::value, long long, unsigned long long>::type>(value));
+  out += '"';
+}
+
+/**
+ * @brief Append the name of an object member, with the indentation of the member
+ */
+inline void appendMemberName(std::string& out, const char* name, int indent)
+{
+  appendIndent(out, indent);
+  out += '"';
+  out += name;
+  out += "\": ";
+}
+
+template<typename Derived>
+void appendMatrix(std::string& out, const Eigen::MatrixBase<Derived>& matrix, int indent)
+{
+  out += "[\n";
+  for(int i = 0; i < matrix.size(); ++i)
+  {
+    appendIndent(out, indent + 1);
+    appendValue(out, matrix(i));
+    out += (i + 1 < matrix.size()) ? ",\n" : "\n";
+  }
+  appendIndent(out, indent);
+  out += ']';
+}
+
+/**
+ * @brief Append a property tree in the format of bpt::write_json
+ * @param[in] indent the indentation level of the tree, greater than 0
+ */
+void appendTree(std::string& out, const bpt::ptree& tree, int indent)
+{
+  if(tree.empty())
+  {
+    appendValue(out, tree.data());
+    return;
+  }
+
+  const bool isArray = (tree.count("") == tree.size());
+
+  out += isArray ? "[\n" : "{\n";
+  for(auto it = tree.begin(); it != tree.end(); ++it)
+  {
+    appendIndent(out, indent + 1);
+    if(!isArray)
+    {
+      appendValue(out, it->first);
+      out += ": ";
+    }
+    appendTree(out, it->second, indent + 1);
+    out += (std::next(it) != tree.end()) ? ",\n" : "\n";
+  }
+  appendIndent(out, indent);
+  out += isArray ? ']' : '}';
+}
+
+/**
+ * @brief Append a Landmark directly in the format of saveLandmark, without property tree
+ */
+void appendLandmark(std::string& out, IndexT landmarkId, const sfmData::Landmark& landmark, int indent, bool saveObservations, bool saveFeatures)
+{
+  out += "{\n";
+
+  appendMemberName(out, "landmarkId", indent + 1);
+  appendValue(out, landmarkId);
+  out += ",\n";
+
+  appendMemberName(out, "descType", indent + 1);
+  appendValue(out, feature::EImageDescriberType_enumToString(landmark.descType));
+  out += ",\n";
+
+  appendMemberName(out, "color", indent + 1);
+  appendMatrix(out, landmark.rgb, indent + 1);
+  out += ",\n";
+
+  appendMemberName(out, "X", indent + 1);
+  appendMatrix(out, landmark.X, indent + 1);
+
+  // observations
+  if(saveObservations)
+  {
+    out += ",\n";
+    appendMemberName(out, "observations", indent + 1);
+
+    if(landmark.observations.empty())
+    {
+      // empty tree of the property tree writer
+      out += "\"\"";
+    }
+    else
+    {
+      const int obsIndent = indent + 2;
+
+      out += "[\n";
+      for(auto it = landmark.observations.begin(); it != landmark.observations.end(); ++it)
+      {
+        const sfmData::Observation& observation = it->second;
+
+        appendIndent(out, obsIndent);
+        out += "{\n";
+        appendMemberName(out, "observationId", obsIndent + 1);
+        appendValue(out, it->first);
+
+        // features
+        if(saveFeatures)
+        {
+          out += ",\n";
+          appendMemberName(out, "featureId", obsIndent + 1);
+          appendValue(out, observation.id_feat);
+          out += ",\n";
+          appendMemberName(out, "x", obsIndent + 1);
+          appendMatrix(out, observation.x, obsIndent + 1);
+          out += ",\n";
+          appendMemberName(out, "scale", obsIndent + 1);
+          appendValue(out, observation.scale);
+        }
+
+        out += '\n';
+        appendIndent(out, obsIndent);
+        out += (std::next(it) != landmark.observations.end()) ? "},\n" : "}\n";
+      }
+      appendIndent(out, indent + 1);
+      out += ']';
+    }
+  }
+
+  out += '\n';
+  appendIndent(out, indent);
+  out += '}';
+}
+
+/**
+ * @brief Write a JSON array, its elements are formatted in parallel by chunks and written in order
+ * @param[in] nbElements the number of elements
+ * @param[in] indent the indentation level of the array
+ * @param[in] appendElement the formatting of an element by index, at the indentation level of the elements
+ */
+void writeArray(std::ostream& stream, std::size_t nbElements, int indent,
+                const std::function<void(std::string&, std::size_t)>& appendElement)
+{
+  const std::size_t chunkSize = 4096;
+
+  stream << "[\n";
+
+  std::vector<std::string> chunk;
+  for(std::size_t chunkBegin = 0; chunkBegin < nbElements; chunkBegin += chunkSize)
+  {
+    const std::size_t chunkEnd = std::min(nbElements, chunkBegin + chunkSize);
+    chunk.assign(chunkEnd - chunkBegin, std::string());
+
+    // an exception cannot leave the parallel region, the first one is rethrown after it
+    std::exception_ptr error;
+
+    #pragma omp parallel for schedule(dynamic, 64)
+    for(int i = 0; i < static_cast<int>(chunk.size()); ++i)
+    {
+      try
+      {
+        const std::size_t elementIndex = chunkBegin + i;
+        std::string& out = chunk[i];
+
+        appendIndent(out, indent + 1);
+        appendElement(out, elementIndex);
+        out += (elementIndex + 1 < nbElements) ? ",\n" : "\n";
+      }
+      catch(...)
+      {
+        #pragma omp critical(writeArrayError)
+        {
+          if(!error)
+            error = std::current_exception();
+        }
+      }
+    }
+
+    if(error)
+      std::rethrow_exception(error);
+
+    for(const std::string& element : chunk)
+      stream << element;
+  }
+
+  stream << std::string(4 * indent, ' ') << ']';
+}
+
+/**
+ * @brief Write a JSON array of the elements of a map, in the map order
+ */
+template<typename MapT, typename AppendElement>
+void writeMapArray(std::ostream& stream, const MapT& map, int indent, AppendElement appendElement)
+{
+  std::vector<const typename MapT::value_type*> elements;
+  elements.reserve(map.size());
+  for(const auto& element : map)
+    elements.push_back(&element);
+
+  writeArray(stream, elements.size(), indent, [&](std::string& out, std::size_t i) { appendElement(out, *elements[i]); });
+}
+
+/**
+ * @brief Cursor on a JSON text, read without building a property tree.
+ *        The values can be written as strings (property tree writer) or as JSON numbers.
+ *        The empty string value of the property tree writer is read as an empty object or array.
+ */
+class JsonReader
+{
+public:
+  JsonReader(const JsonRange& range, const char* text)
+    : _pos(range.first)
+    , _end(range.second)
+    , _text(text)
+  {}
+
+  const char* position() const { return _pos; }
+
+  [[noreturn]] void error(const std::string& message) const
+  {
+    throw std::runtime_error("Invalid JSON at offset " + std::to_string(_pos - _text) + ": " + message);
+  }
+
+  void skipSpaces()
+  {
+    while(_pos != _end && (*_pos == ' ' || *_pos == '\n' || *_pos == '\r' || *_pos == '\t'))
+      ++_pos;
+  }
+
+  void expect(char c)
+  {
+    skipSpaces();
+    if(_pos == _end || *_pos != c)
+      error(std::string("'") + c + "' expected");
+    ++_pos;
+  }
+
+  bool skipIf(char c)
+  {
+    skipSpaces();
+    if(_pos == _end || *_pos != c)
+      return false;
+    ++_pos;
+    return true;
+  }
+
+  std::string readString()
+  {
+    expect('"');
+
+    std::string value;
+    for(;;)
+    {
+      const char* begin = _pos;
+      while(_pos != _end && *_pos != '"' && *_pos != '\\')
+        ++_pos;
+      value.append(begin, _pos);
+
+      if(_pos == _end)
+        error("unterminated string");
+      if(*_pos++ == '"')
+        return value;
+      readEscape(value);
+    }
+  }
+
+  /**
+   * @brief Read a number, written as a string or as a JSON number
+   */
+  template<typename T>
+  T readNumber()
+  {
+    const JsonRange token = readToken();
+    T value;
+    if(token.first == token.second || !parseNumber(token, value))
+      error("invalid number '" + std::string(token.first, token.second) + "'");
+    return value;
+  }
+
+  /**
+   * @brief Skip a value, the objects and arrays are skipped without checking their content
+   */
+  void skipValue()
+  {
+    skipSpaces();
+    if(_pos == _end)
+      error("value expected");
+    if(*_pos != '{' && *_pos != '[')
+    {
+      readToken();
+      return;
+    }
+
+    int depth = 0;
+    do
+    {
+      if(_pos == _end)
+        error("unterminated object or array");
+      if(*_pos == '"')
+      {
+        readToken();
+        continue;
+      }
+      if(*_pos == '{' || *_pos == '[')
+        ++depth;
+      else if(*_pos == '}' || *_pos == ']')
+        --depth;
+      ++_pos;
+    }
+    while(depth > 0);
+  }
+
+  /**
+   * @brief Skip a value and get its range
+   */
+  JsonRange skipValueRange()
+  {
+    skipSpaces();
+    const char* begin = _pos;
+    skipValue();
+    return {begin, _pos};
+  }
+
+  /**
+   * @brief Read an object, onMember(name) must read the value of each member
+   */
+  template<typename OnMember>
+  void readObject(OnMember onMember)
+  {
+    if(readEmptyValue())
+      return;
+    expect('{');
+    if(skipIf('}'))
+      return;
+    do
+    {
+      const std::string name = readString();
+      expect(':');
+      onMember(name);
+    }
+    while(skipIf(','));
+    expect('}');
+  }
+
+  /**
+   * @brief Read an array, onElement() must read each element
+   */
+  template<typename OnElement>
+  void readArray(OnElement onElement)
+  {
+    if(readEmptyValue())
+      return;
+    expect('[');
+    if(skipIf(']'))
+      return;
+    do
+    {
+      onElement();
+    }
+    while(skipIf(','));
+    expect(']');
+  }
+
+  /**
+   * @brief Get the ranges of the elements of an array
+   */
+  std::vector<JsonRange> readArrayRanges()
+  {
+    std::vector<JsonRange> elements;
+    readArray([&]{ elements.push_back(skipValueRange()); });
+    return elements;
+  }
+
+private:
+  bool readEmptyValue()
+  {
+    skipSpaces();
+    if(_end - _pos >= 2 && _pos[0] == '"' && _pos[1] == '"')
+    {
+      _pos += 2;
+      return true;
+    }
+    return false;
+  }
+
+  /// Read a string without unescaping it or a literal, return its content
+  JsonRange readToken()
+  {
+    skipSpaces();
+    if(_pos == _end)
+      error("value expected");
+
+    if(*_pos == '"')
+    {
+      const char* begin = ++_pos;
+      while(_pos != _end && *_pos != '"')
+        _pos += (*_pos == '\\' && _pos + 1 != _end) ? 2 : 1;
+      if(_pos == _end)
+        error("unterminated string");
+      return {begin, _pos++};
+    }
+
+    const char* begin = _pos;
+    while(_pos != _end && *_pos != ',' && *_pos != ']' && *_pos != '}' &&
+          *_pos != ' ' && *_pos != '\n' && *_pos != '\r' && *_pos != '\t')
+      ++_pos;
+    if(begin == _pos)
+      error("value expected");
+    return {begin, _pos};
+  }
+
+  void readEscape(std::string& value)
+  {
+    if(_pos == _end)
+      error("unterminated string");
+
+    switch(*_pos++)
+    {
+      case '"':  value += '"';  return;
+      case '\\': value += '\\'; return;
+      case '/':  value += '/';  return;
+      case 'b':  value += '\b'; return;
+      case 'f':  value += '\f'; return;
+      case 'n':  value += '\n'; return;
+      case 'r':  value += '\r'; return;
+      case 't':  value += '\t'; return;
+      case 'u':  break;
+      default:   error("invalid escape sequence");
+    }
+
+    unsigned long codePoint = readHex4();
+    if(codePoint >= 0xD800 && codePoint < 0xDC00 && _end - _pos >= 6 && _pos[0] == '\\' && _pos[1] == 'u')
+    {
+      // surrogate pair
+      _pos += 2;
+      const unsigned long low = readHex4();
+      codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+    }
+
+    // UTF-8 encoding
+    if(codePoint < 0x80)
+    {
+      value += static_cast<char>(codePoint);
+    }
+    else if(codePoint < 0x800)
+    {
+      value += static_cast<char>(0xC0 | (codePoint >> 6));
+      value += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+    else if(codePoint < 0x10000)
+    {
+      value += static_cast<char>(0xE0 | (codePoint >> 12));
+      value += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+      value += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+    else
+    {
+      value += static_cast<char>(0xF0 | (codePoint >> 18));
+      value += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+      value += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+      value += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+  }
+
+  unsigned long readHex4()
+  {
+    if(_end - _pos < 4)
+      error("invalid unicode escape sequence");
+
+    unsigned long value = 0;
+    for(int i = 0; i < 4; ++i, ++_pos)
+    {
+      const char c = *_pos;
+      value *= 16;
+      if(c >= '0' && c <= '9')      value += c - '0';
+      else if(c >= 'a' && c <= 'f') value += c - 'a' + 10;
+      else if(c >= 'A' && c <= 'F') value += c - 'A' + 10;
+      else error("invalid unicode escape sequence");
+    }
+    return value;
+  }
+
+  // the tokens are followed by a delimiter in the text, so the conversions stop at their end
+
+  static bool parseNumber(const JsonRange& token, double& value)
+  {
+    char* end;
+    value = std::strtod(token.first, &end);
+    return end == token.second;
+  }
+
+  template<typename T, typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value, int>::type = 0>
+  static bool parseNumber(const JsonRange& token, T& value)
+  {
+    char* end;
+    const unsigned long long number = std::strtoull(token.first, &end, 10);
+    value = static_cast<T>(number);
+    return end == token.second && number <= std::numeric_limits<T>::max();
+  }
+
+  template<typename T, typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, int>::type = 0>
+  static bool parseNumber(const JsonRange& token, T& value)
+  {
+    char* end;
+    const long long number = std::strtoll(token.first, &end, 10);
+    value = static_cast<T>(number);
+    return end == token.second && number >= std::numeric_limits<T>::min() && number <= std::numeric_limits<T>::max();
+  }
+
+  const char* _pos;
+  const char* _end;
+  /// beginning of the whole text, for the error offsets
+  const char* _text;
+};
+
+template<typename Derived>
+void readMatrix(JsonReader& reader, const std::string& name, Eigen::MatrixBase<Derived>& matrix)
+{
+  int i = 0;
+  reader.readArray([&]
+  {
+    if(i >= matrix.size())
+      reader.error("Invalid matrix / vector type for : " + name);
+    matrix(i++) = reader.readNumber<typename Derived::Scalar>();
+  });
+}
+
+/**
+ * @brief Read a Landmark directly in the format of saveLandmark, without property tree
+ */
+void readLandmark(JsonReader& reader, IndexT& landmarkId, sfmData::Landmark& landmark, bool loadObservations, bool loadFeatures)
+{
+  bool hasLandmarkId = false;
+  bool hasDescType = false;
+  bool hasColor = false;
+  bool hasX = false;
+  bool hasObservations = false;
+
+  reader.readObject([&](const std::string& name)
+  {
+    if(name == "landmarkId")
+    {
+      landmarkId = reader.readNumber<IndexT>();
+      hasLandmarkId = true;
+    }
+    else if(name == "descType")
+    {
+      landmark.descType = feature::EImageDescriberType_stringToEnum(reader.readString());
+      hasDescType = true;
+    }
+    else if(name == "color")
+    {
+      readMatrix(reader, name, landmark.rgb);
+      hasColor = true;
+    }
+    else if(name == "X")
+    {
+      readMatrix(reader, name, landmark.X);
+      hasX = true;
+    }
+    else if(name == "observations" && loadObservations)
+    {
+      hasObservations = true;
+      reader.readArray([&]
+      {
+        sfmData::Observation observation;
+        IndexT observationId = UndefinedIndexT;
+        bool hasObservationId = false;
+        bool hasFeatureId = false;
+        bool hasFeature = false;
+
+        reader.readObject([&](const std::string& obsName)
+        {
+          if(obsName == "observationId")
+          {
+            observationId = reader.readNumber<IndexT>();
+            hasObservationId = true;
+          }
+          else if(obsName == "featureId" && loadFeatures)
+          {
+            observation.id_feat = reader.readNumber<IndexT>();
+            hasFeatureId = true;
+          }
+          else if(obsName == "x" && loadFeatures)
+          {
+            readMatrix(reader, obsName, observation.x);
+            hasFeature = true;
+          }
+          else if(obsName == "scale" && loadFeatures)
+          {
+            observation.scale = reader.readNumber<double>();
+          }
+          else
+          {
+            reader.skipValue();
+          }
+        });
+
+        if(!hasObservationId || (loadFeatures && (!hasFeatureId || !hasFeature)))
+          reader.error("incomplete observation of the landmark " + std::to_string(landmarkId));
+
+        landmark.observations.emplace(observationId, observation);
+      });
+    }
+    else
+    {
+      reader.skipValue();
+    }
+  });
+
+  if(!hasLandmarkId || !hasDescType || !hasColor || !hasX || (loadObservations && !hasObservations))
+    reader.error("incomplete landmark");
+}
+
+/**
+ * @brief Read the elements of a landmarks array in parallel
+ */
+void readLandmarks(const JsonRange& range, const char* text, sfmData::Landmarks& landmarks, bool loadObservations, bool loadFeatures)
+{
+  const std::vector<JsonRange> elements = JsonReader(range, text).readArrayRanges();
+  std::vector<std::pair<IndexT, sfmData::Landmark>> loadedLandmarks(elements.size());
+
+  // the exceptions cannot leave the parallel region
+  std::string errorMessage;
+
+  #pragma omp parallel for schedule(dynamic, 256)
+  for(int i = 0; i < static_cast<int>(elements.size()); ++i)
+  {
+    try
+    {
+      JsonReader reader(elements[i], text);
+      readLandmark(reader, loadedLandmarks[i].first, loadedLandmarks[i].second, loadObservations, loadFeatures);
+    }
+    catch(const std::exception& e)
+    {
+      #pragma omp critical(readLandmarks)
+      {
+        if(errorMessage.empty())
+          errorMessage = e.what();
+      }
+    }
+  }
+
+  if(!errorMessage.empty())
+    throw std::runtime_error(errorMessage);
+
+  for(auto& landmarkPair : loadedLandmarks)
+    landmarks.emplace(landmarkPair.first, std::move(landmarkPair.second));
+}
+
+/**
+ * @brief Parse an element in a property tree, for the sections read with the property tree functions
+ */
+bpt::ptree readTree(const JsonRange& range)
+{
+  bpt::ptree tree;
+  std::istringstream stream(std::string(range.first, range.second));
+  bpt::read_json(stream, tree);
+  return tree;
+}
+
+} // namespace
 
 bool saveJSON(const sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag)
 {
@@ -409,61 +1148,71 @@ bool saveJSON(const sfmData::SfMData& sfmData, const std::string& filename, ESfM
   const bool saveFeatures = (partFlag & OBSERVATIONS_WITH_FEATURES) == OBSERVATIONS_WITH_FEATURES;
   const bool saveObservations = saveFeatures || ((partFlag & OBSERVATIONS) == OBSERVATIONS);
 
-  // main tree
-  bpt::ptree fileTree;
+  std::ofstream stream(filename);
+  if(!stream.is_open())
+    throw std::runtime_error("Cannot open the JSON file '" + filename + "' for writing.");
+
+  // the root object is written member by member, in the format of bpt::write_json
+  bool isFirstMember = true;
+  const auto beginMember = [&](const char* name)
+  {
+    std::string out = isFirstMember ? "{\n" : ",\n";
+    appendMemberName(out, name, 1);
+    stream << out;
+    isFirstMember = false;
+  };
+
+  // the elements saved in a property tree one at a time
+  const auto appendElementTree = [](std::string& out, const std::function<void(bpt::ptree&)>& saveElement)
+  {
+    bpt::ptree parentTree;
+    saveElement(parentTree);
+    appendTree(out, parentTree.front().second, 2);
+  };
 
   // file version
-  saveMatrix("version", version, fileTree);
+  {
+    std::string out;
+    beginMember("version");
+    appendMatrix(out, version, 1);
+    stream << out;
+  }
 
   // folders
   if(!sfmData.getRelativeFeaturesFolders().empty())
   {
-    bpt::ptree featureFoldersTree;
+    const std::vector<std::string> featuresFolders = sfmData.getRelativeFeaturesFolders();
 
-    for(const std::string& featuresFolder : sfmData.getRelativeFeaturesFolders())
-    {
-      bpt::ptree featureFolderTree;
-      featureFolderTree.put("", featuresFolder);
-      featureFoldersTree.push_back(std::make_pair("", featureFolderTree));
-    }
-
-    fileTree.add_child("featuresFolders", featureFoldersTree);
+    beginMember("featuresFolders");
+    writeArray(stream, featuresFolders.size(), 1, [&](std::string& out, std::size_t i) { appendValue(out, featuresFolders[i]); });
   }
 
   if(!sfmData.getRelativeMatchesFolders().empty())
   {
-    bpt::ptree matchingFoldersTree;
+    const std::vector<std::string> matchesFolders = sfmData.getRelativeMatchesFolders();
 
-    for(const std::string& matchesFolder : sfmData.getRelativeMatchesFolders())
-    {
-      bpt::ptree matchingFolderTree;
-      matchingFolderTree.put("", matchesFolder);
-      matchingFoldersTree.push_back(std::make_pair("", matchingFolderTree));
-    }
-
-    fileTree.add_child("matchesFolders", matchingFoldersTree);
+    beginMember("matchesFolders");
+    writeArray(stream, matchesFolders.size(), 1, [&](std::string& out, std::size_t i) { appendValue(out, matchesFolders[i]); });
   }
 
   // views
   if(saveViews && !sfmData.getViews().empty())
   {
-    bpt::ptree viewsTree;
-
-    for(const auto& viewPair : sfmData.getViews())
-      saveView("", *(viewPair.second), viewsTree);
-
-    fileTree.add_child("views", viewsTree);
+    beginMember("views");
+    writeMapArray(stream, sfmData.getViews(), 1, [&](std::string& out, const sfmData::Views::value_type& viewPair)
+    {
+      appendElementTree(out, [&](bpt::ptree& parentTree) { saveView("", *(viewPair.second), parentTree); });
+    });
   }
 
   // intrinsics
   if(saveIntrinsics && !sfmData.getIntrinsics().empty())
   {
-    bpt::ptree intrinsicsTree;
-
-    for(const auto& intrinsicPair : sfmData.getIntrinsics())
-      saveIntrinsic("", intrinsicPair.first, intrinsicPair.second, intrinsicsTree);
-
-    fileTree.add_child("intrinsics", intrinsicsTree);
+    beginMember("intrinsics");
+    writeMapArray(stream, sfmData.getIntrinsics(), 1, [&](std::string& out, const sfmData::Intrinsics::value_type& intrinsicPair)
+    {
+      appendElementTree(out, [&](bpt::ptree& parentTree) { saveIntrinsic("", intrinsicPair.first, intrinsicPair.second, parentTree); });
+    });
   }
 
   //extrinsics
@@ -472,63 +1221,61 @@ bool saveJSON(const sfmData::SfMData& sfmData, const std::string& filename, ESfM
     // poses
     if(!sfmData.getPoses().empty())
     {
-      bpt::ptree posesTree;
-
-      for(const auto& posePair : sfmData.getPoses())
+      beginMember("poses");
+      writeMapArray(stream, sfmData.getPoses(), 1, [&](std::string& out, const sfmData::Poses::value_type& posePair)
       {
-        bpt::ptree poseTree;
-
-        poseTree.put("poseId", posePair.first);
-        saveCameraPose("pose", posePair.second, poseTree);
-        posesTree.push_back(std::make_pair("", poseTree));
-      }
+        appendElementTree(out, [&](bpt::ptree& parentTree)
+        {
+          bpt::ptree poseTree;
 
-      fileTree.add_child("poses", posesTree);
+          poseTree.put("poseId", posePair.first);
+          saveCameraPose("pose", posePair.second, poseTree);
+          parentTree.push_back(std::make_pair("", poseTree));
+        });
+      });
     }
 
     // rigs
     if(!sfmData.getRigs().empty())
     {
-      bpt::ptree rigsTree;
-
-      for(const auto& rigPair : sfmData.getRigs())
-        saveRig("", rigPair.first, rigPair.second, rigsTree);
-
-      fileTree.add_child("rigs", rigsTree);
+      beginMember("rigs");
+      writeMapArray(stream, sfmData.getRigs(), 1, [&](std::string& out, const sfmData::Rigs::value_type& rigPair)
+      {
+        appendElementTree(out, [&](bpt::ptree& parentTree) { saveRig("", rigPair.first, rigPair.second, parentTree); });
+      });
     }
   }
 
   // structure
   if(saveStructure && !sfmData.getLandmarks().empty())
   {
-    bpt::ptree structureTree;
-
-    for(const auto& structurePair : sfmData.getLandmarks())
-      saveLandmark("", structurePair.first, structurePair.second, structureTree, saveObservations, saveFeatures);
-
-    fileTree.add_child("structure", structureTree);
+    beginMember("structure");
+    writeMapArray(stream, sfmData.getLandmarks(), 1, [&](std::string& out, const sfmData::Landmarks::value_type& landmarkPair)
+    {
+      appendLandmark(out, landmarkPair.first, landmarkPair.second, 2, saveObservations, saveFeatures);
+    });
   }
 
   // control points
   if(saveControlPoints && !sfmData.getControlPoints().empty())
   {
-    bpt::ptree controlPointTree;
-
-    for(const auto& controlPointPair : sfmData.getControlPoints())
-      saveLandmark("", controlPointPair.first, controlPointPair.second, controlPointTree);
-
-    fileTree.add_child("controlPoints", controlPointTree);
+    beginMember("controlPoints");
+    writeMapArray(stream, sfmData.getControlPoints(), 1, [&](std::string& out, const sfmData::Landmarks::value_type& landmarkPair)
+    {
+      appendLandmark(out, landmarkPair.first, landmarkPair.second, 2, true, true);
+    });
   }
 
-  // write the json file with the tree
+  stream << (isFirstMember ? "{\n}" : "\n}") << std::endl;
 
-  bpt::write_json(filename, fileTree);
+  if(!stream.good())
+    throw std::runtime_error("Cannot write the JSON file '" + filename + "'.");
 
   return true;
 }
 
 bool loadJSON(sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag, bool incompleteViews,
-              EViewIdMethod viewIdMethod, const std::string& viewIdRegex)
+              EViewIdMethod viewIdMethod, const std::string& viewIdRegex, image::ImageMetadataCache* metadataCache)
 {
   Version version;
 
@@ -541,59 +1288,86 @@ bool loadJSON(sfmData::SfMData& sfmData, const std::string& filename, ESfMData p
   const bool loadFeatures = (partFlag & OBSERVATIONS_WITH_FEATURES) == OBSERVATIONS_WITH_FEATURES;
   const bool loadObservations = loadFeatures || ((partFlag & OBSERVATIONS) == OBSERVATIONS);
 
-  // main tree
-  bpt::ptree fileTree;
+  // read the json file
+  std::string fileContent;
+  {
+    std::ifstream stream(filename, std::ios::binary);
+    if(!stream.is_open())
+      throw std::runtime_error("Cannot open the JSON file '" + filename + "'.");
+
+    std::ostringstream contentStream;
+    contentStream << stream.rdbuf();
+    fileContent = contentStream.str();
+  }
+
+  const char* text = fileContent.c_str();
+
+  // ranges of the members of the root object, the sections are read in a fixed order
+  std::map<std::string, JsonRange> sections;
+  {
+    JsonReader reader({text, text + fileContent.size()}, text);
+    reader.readObject([&](const std::string& name) { sections[name] = reader.skipValueRange(); });
+  }
 
-  // read the json file and initialize the tree
-  bpt::read_json(filename, fileTree);
+  const auto hasSection = [&](const std::string& name) { return sections.count(name) != 0; };
+  const auto sectionElements = [&](const std::string& name) { return JsonReader(sections.at(name), text).readArrayRanges(); };
 
   // version
   {
+    if(!hasSection("version"))
+      throw std::runtime_error("No version in the JSON file '" + filename + "'.");
+
+    JsonReader reader(sections.at("version"), text);
     Vec3i v;
-    loadMatrix("version", v, fileTree);
+    readMatrix(reader, "version", v);
     version = v;
   }
 
   // folders
-  if(fileTree.count("featuresFolders"))
-    for(bpt::ptree::value_type& featureFolderNode : fileTree.get_child("featuresFolders"))
-      sfmData.addFeaturesFolder(featureFolderNode.second.get_value<std::string>());
+  if(hasSection("featuresFolders"))
+  {
+    JsonReader reader(sections.at("featuresFolders"), text);
+    reader.readArray([&]{ sfmData.addFeaturesFolder(reader.readString()); });
+  }
 
-  if(fileTree.count("matchesFolders"))
-    for(bpt::ptree::value_type& matchingFolderNode : fileTree.get_child("matchesFolders"))
-      sfmData.addMatchesFolder(matchingFolderNode.second.get_value<std::string>());
+  if(hasSection("matchesFolders"))
+  {
+    JsonReader reader(sections.at("matchesFolders"), text);
+    reader.readArray([&]{ sfmData.addMatchesFolder(reader.readString()); });
+  }
 
   // intrinsics
-  if(loadIntrinsics && fileTree.count("intrinsics"))
+  if(loadIntrinsics && hasSection("intrinsics"))
   {
     sfmData::Intrinsics& intrinsics = sfmData.getIntrinsics();
 
-    for(bpt::ptree::value_type &intrinsicNode : fileTree.get_child("intrinsics"))
+    for(const JsonRange& intrinsicRange : sectionElements("intrinsics"))
     {
       IndexT intrinsicId;
       std::shared_ptr<camera::IntrinsicBase> intrinsic;
+      bpt::ptree intrinsicTree = readTree(intrinsicRange);
 
-      loadIntrinsic(version, intrinsicId, intrinsic, intrinsicNode.second);
+      loadIntrinsic(version, intrinsicId, intrinsic, intrinsicTree);
 
       intrinsics.emplace(intrinsicId, intrinsic);
     }
   }
 
   // views
-  if(loadViews && fileTree.count("views"))
+  if(loadViews && hasSection("views"))
   {
     sfmData::Views& views = sfmData.getViews();
+    const std::vector<JsonRange> viewRanges = sectionElements("views");
 
     if(incompleteViews)
     {
       // store incomplete views in a vector
-      std::vector<sfmData::View> incompleteViews(fileTree.get_child("views").size());
+      std::vector<sfmData::View> incompleteViews(viewRanges.size());
 
-      int viewIndex = 0;
-      for(bpt::ptree::value_type &viewNode : fileTree.get_child("views"))
+      for(std::size_t viewIndex = 0; viewIndex < viewRanges.size(); ++viewIndex)
       {
-        loadView(incompleteViews.at(viewIndex), viewNode.second);
-        ++viewIndex;
+        bpt::ptree viewTree = readTree(viewRanges.at(viewIndex));
+        loadView(incompleteViews.at(viewIndex), viewTree);
       }
 
       // update incomplete views
@@ -619,7 +1393,7 @@ bool loadJSON(sfmData::SfMData& sfmData, const std::string& filename, ESfMData p
           v.setWidth(intrinsics->w());
           v.setHeight(intrinsics->h());
         }
-        updateIncompleteView(incompleteViews.at(i), viewIdMethod, viewIdRegex);
+        updateIncompleteView(incompleteViews.at(i), viewIdMethod, viewIdRegex, metadataCache);
       }
 
       // copy complete views in the SfMData views map
@@ -629,10 +1403,11 @@ bool loadJSON(sfmData::SfMData& sfmData, const std::string& filename, ESfMData p
     else
     {
       // store directly in the SfMData views map
-      for(bpt::ptree::value_type &viewNode : fileTree.get_child("views"))
+      for(const JsonRange& viewRange : viewRanges)
       {
         sfmData::View view;
-        loadView(view, viewNode.second);
+        bpt::ptree viewTree = readTree(viewRange);
+        loadView(view, viewTree);
         views.emplace(view.getViewId(), std::make_shared<sfmData::View>(view));
       }
     }
@@ -642,13 +1417,13 @@ bool loadJSON(sfmData::SfMData& sfmData, const std::string& filename, ESfMData p
   if(loadExtrinsics)
   {
     // poses
-    if(fileTree.count("poses"))
+    if(hasSection("poses"))
     {
       sfmData::Poses& poses = sfmData.getPoses();
 
-      for(bpt::ptree::value_type &poseNode : fileTree.get_child("poses"))
+      for(const JsonRange& poseRange : sectionElements("poses"))
       {
-        bpt::ptree& poseTree = poseNode.second;
+        bpt::ptree poseTree = readTree(poseRange);
         sfmData::CameraPose pose;
 
         loadCameraPose("pose", pose, poseTree);
@@ -658,16 +1433,17 @@ bool loadJSON(sfmData::SfMData& sfmData, const std::string& filename, ESfMData p
     }
 
     // rigs
-    if(fileTree.count("rigs"))
+    if(hasSection("rigs"))
     {
       sfmData::Rigs& rigs = sfmData.getRigs();
 
-      for(bpt::ptree::value_type &rigNode : fileTree.get_child("rigs"))
+      for(const JsonRange& rigRange : sectionElements("rigs"))
       {
         IndexT rigId;
         sfmData::Rig rig;
+        bpt::ptree rigTree = readTree(rigRange);
 
-        loadRig(rigId, rig, rigNode.second);
+        loadRig(rigId, rig, rigTree);
 
         rigs.emplace(rigId, rig);
       }
@@ -675,36 +1451,12 @@ bool loadJSON(sfmData::SfMData& sfmData, const std::string& filename, ESfMData p
   }
 
   // structure
-  if(loadStructure && fileTree.count("structure"))
-  {
-    sfmData::Landmarks& structure = sfmData.getLandmarks();
-
-    for(bpt::ptree::value_type &landmarkNode : fileTree.get_child("structure"))
-    {
-      IndexT landmarkId;
-      sfmData::Landmark landmark;
-
-      loadLandmark(landmarkId, landmark, landmarkNode.second, loadObservations, loadFeatures);
-
-      structure.emplace(landmarkId, landmark);
-    }
-  }
+  if(loadStructure && hasSection("structure"))
+    readLandmarks(sections.at("structure"), text, sfmData.getLandmarks(), loadObservations, loadFeatures);
 
   // control points
-  if(loadControlPoints && fileTree.count("controlPoints"))
-  {
-    sfmData::Landmarks& controlPoints = sfmData.getControlPoints();
-
-    for(bpt::ptree::value_type &landmarkNode : fileTree.get_child("controlPoints"))
-    {
-      IndexT landmarkId;
-      sfmData::Landmark landmark;
-
-      loadLandmark(landmarkId, landmark, landmarkNode.second);
-
-      controlPoints.emplace(landmarkId, landmark);
-    }
-  }
+  if(loadControlPoints && hasSection("controlPoints"))
+    readLandmarks(sections.at("controlPoints"), text, sfmData.getControlPoints(), true, true);
 
   return true;
 }
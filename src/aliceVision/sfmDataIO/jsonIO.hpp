@@ -207,7 +207,8 @@ void saveLandmark(const std::string& name, IndexT landmarkId, const sfmData::Lan
 void loadLandmark(IndexT& landmarkId, sfmData::Landmark& landmark, bpt::ptree& landmarkTree, bool loadObservations = true, bool loadFeatures = true);
 
 /**
- * @brief Save an SfMData in a JSON file with a boost property tree.
+ * @brief Save an SfMData in a JSON file, in the format of the boost property tree JSON writer.
+ *        The file is written section by section, the landmarks are formatted in parallel without property tree.
  * @param[in] sfmData The input SfMData
  * @param[in] filename The filename
  * @param[in] partFlag The ESfMData save flag
@@ -217,16 +218,19 @@ bool saveJSON(const sfmData::SfMData& sfmData, const std::string& filename, ESfM
 
 /**
  * @brief Load a JSON SfMData file.
+ *        The file is read without building a property tree of the whole file, the landmarks are parsed in parallel.
  * @param[out] sfmData The output SfMData
  * @param[in] filename The filename
  * @param[in] partFlag The ESfMData load flag
  * @param[in] incompleteViews If true, try to load incomplete views
  * @param[in] viewIdMethod ViewId generation method to use if incompleteViews is true
  * @param[in] viewIdRegex Optional regex used when viewIdMethod is FILENAME
+ * @param[in] metadataCache Optional persistent cache of the image metadata used if incompleteViews is true
  * @return true if completed
  */
 bool loadJSON(sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag, bool incompleteViews = false,
-              EViewIdMethod viewIdMethod = EViewIdMethod::METADATA, const std::string& viewIdRegex = "");
+              EViewIdMethod viewIdMethod = EViewIdMethod::METADATA, const std::string& viewIdRegex = "",
+              image::ImageMetadataCache* metadataCache = nullptr);
 
 } // namespace sfmDataIO
 } // namespace aliceVision
@@ -6,12 +6,117 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "plyIO.hpp"
+#include <aliceVision/system/Logger.hpp>
 
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
 
 namespace aliceVision {
 namespace sfmDataIO {
 
+namespace {
+
+/// number of vertices formatted in parallel before each write
+const std::size_t plyVerticesPerWrite = 1 << 22;
+
+/// binary vertex record: position (float x, y, z) and color (uchar red, green, blue)
+const std::size_t plyVertexSize = 3 * sizeof(float) + 3;
+
+void writeVertex(char* out, const Vec3& X, const image::RGBColor& rgb)
+{
+  const float position[3] = {static_cast<float>(X(0)), static_cast<float>(X(1)), static_cast<float>(X(2))};
+  std::memcpy(out, position, sizeof(position));
+  out[12] = static_cast<char>(rgb.r());
+  out[13] = static_cast<char>(rgb.g());
+  out[14] = static_cast<char>(rgb.b());
+}
+
+/// a scalar property of a PLY element
+struct PlyProperty
+{
+  std::string name;
+  std::string type;
+  std::size_t offset = 0;
+  std::size_t size = 0;
+};
+
+/// an element of a PLY file with its scalar properties
+struct PlyElement
+{
+  std::string name;
+  std::size_t count = 0;
+  std::size_t size = 0;
+  bool hasList = false;
+  std::vector<PlyProperty> properties;
+
+  int propertyIndex(const std::string& propertyName) const
+  {
+    for(std::size_t i = 0; i < properties.size(); ++i)
+    {
+      if(properties[i].name == propertyName)
+        return static_cast<int>(i);
+    }
+    return -1;
+  }
+};
+
+std::size_t plyTypeSize(const std::string& type)
+{
+  if(type == "char" || type == "uchar" || type == "int8" || type == "uint8")
+    return 1;
+  if(type == "short" || type == "ushort" || type == "int16" || type == "uint16")
+    return 2;
+  if(type == "int" || type == "uint" || type == "int32" || type == "uint32" || type == "float" || type == "float32")
+    return 4;
+  if(type == "double" || type == "float64")
+    return 8;
+  throw std::runtime_error("unknown property type '" + type + "'");
+}
+
+/// read a little-endian binary scalar property as a double
+double readBinaryValue(const char* data, const std::string& type)
+{
+  const auto read = [data](auto value)
+  {
+    std::memcpy(&value, data, sizeof(value));
+    return static_cast<double>(value);
+  };
+
+  if(type == "char" || type == "int8")
+    return read(std::int8_t());
+  if(type == "uchar" || type == "uint8")
+    return read(std::uint8_t());
+  if(type == "short" || type == "int16")
+    return read(std::int16_t());
+  if(type == "ushort" || type == "uint16")
+    return read(std::uint16_t());
+  if(type == "int" || type == "int32")
+    return read(std::int32_t());
+  if(type == "uint" || type == "uint32")
+    return read(std::uint32_t());
+  if(type == "float" || type == "float32")
+    return read(float());
+  return read(double());
+}
+
+/// the color channel of a property, float colors are in [0, 1]
+unsigned char toColor(double value, const std::string& type)
+{
+  if(type == "float" || type == "float32" || type == "double" || type == "float64")
+    value *= 255.0;
+  return static_cast<unsigned char>(std::min(std::max(value, 0.0), 255.0));
+}
+
+} // namespace
+
 bool savePLY(
   const sfmData::SfMData& sfmData,
   const std::string& filename,
@@ -24,65 +129,250 @@ bool savePLY(
     return false;
 
   //Create the stream and check it is ok
-  std::ofstream stream(filename);
+  std::ofstream stream(filename, std::ios::binary);
   if (!stream.is_open())
     return false;
 
-  bool bOk = false;
+  // the camera centers first, then the landmarks
+  std::vector<Vec3> centers;
+  if (b_extrinsics)
+  {
+    for (const auto& view : sfmData.getViews())
+    {
+      if (sfmData.isPoseAndIntrinsicDefined(view.second.get()))
+        centers.push_back(sfmData.getPose(*(view.second.get())).getTransform().center());
+    }
+  }
+
+  std::vector<const sfmData::Landmark*> landmarks;
+  if (b_structure)
+  {
+    landmarks.reserve(sfmData.getLandmarks().size());
+    for (const auto& landmark : sfmData.getLandmarks())
+      landmarks.push_back(&landmark.second);
+  }
+
+  const std::size_t nbVertices = centers.size() + landmarks.size();
+
+  stream << "ply"
+    << '\n' << "format binary_little_endian 1.0"
+    << '\n' << "element vertex " << nbVertices
+    << '\n' << "property float x"
+    << '\n' << "property float y"
+    << '\n' << "property float z"
+    << '\n' << "property uchar red"
+    << '\n' << "property uchar green"
+    << '\n' << "property uchar blue"
+    << '\n' << "end_header" << '\n';
+
+  // the vertex records have a fixed size, they are formatted in parallel in large blocks
+  const image::RGBColor cameraColor(0, 255, 0);
+  std::vector<char> buffer(std::min(nbVertices, plyVerticesPerWrite) * plyVertexSize);
+
+  for (std::size_t first = 0; first < nbVertices && stream.good(); first += plyVerticesPerWrite)
   {
-    // Count how many views having valid poses:
-    IndexT view_with_pose_count = 0;
-    if (b_extrinsics)
+    const std::size_t nbBlockVertices = std::min(plyVerticesPerWrite, nbVertices - first);
+
+    #pragma omp parallel for
+    for (int i = 0; i < static_cast<int>(nbBlockVertices); ++i)
     {
-      for (const auto& view : sfmData.getViews())
+      const std::size_t vertex = first + i;
+      char* out = buffer.data() + i * plyVertexSize;
+      if (vertex < centers.size())
+        writeVertex(out, centers[vertex], cameraColor);
+      else
       {
-        view_with_pose_count += sfmData.isPoseAndIntrinsicDefined(view.second.get());
+        const sfmData::Landmark& landmark = *landmarks[vertex - centers.size()];
+        writeVertex(out, landmark.X, landmark.rgb);
       }
     }
-    stream << "ply"
-      << '\n' << "format ascii 1.0"
-      << '\n' << "element vertex "
-        // Vertex count: (#landmark + #view_with_valid_pose)
-        << ((b_structure ? sfmData.getLandmarks().size() : 0) +
-            view_with_pose_count)
-      << '\n' << "property float x"
-      << '\n' << "property float y"
-      << '\n' << "property float z"
-      << '\n' << "property uchar red"
-      << '\n' << "property uchar green"
-      << '\n' << "property uchar blue"
-      << '\n' << "end_header" << std::endl;
-
-      if (b_extrinsics)
+    stream.write(buffer.data(), nbBlockVertices * plyVertexSize);
+  }
+
+  stream.flush();
+  const bool bOk = stream.good();
+  stream.close();
+  return bOk;
+}
+
+bool loadPLY(sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag)
+{
+  if((partFlag & STRUCTURE) != STRUCTURE)
+    return true;
+
+  boost::iostreams::mapped_file_source file;
+  try
+  {
+    file.open(filename);
+  }
+  catch(const std::exception& e)
+  {
+    ALICEVISION_LOG_ERROR("Cannot open the PLY file '" << filename << "': " << e.what());
+    return false;
+  }
+
+  try
+  {
+    const char* data = file.data();
+    const std::size_t fileSize = file.size();
+
+    // header
+    std::size_t position = 0;
+    const auto readLine = [&]()
+    {
+      const char* end = static_cast<const char*>(std::memchr(data + position, '\n', fileSize - position));
+      if(end == nullptr)
+        throw std::runtime_error("truncated header");
+      std::string line(data + position, end);
+      if(!line.empty() && line.back() == '\r')
+        line.pop_back();
+      position = end - data + 1;
+      return line;
+    };
+
+    if(fileSize < 4 || readLine() != "ply")
+      throw std::runtime_error("it is not a PLY file");
+
+    std::string format;
+    std::vector<PlyElement> elements;
+    for(std::string line = readLine(); line != "end_header"; line = readLine())
+    {
+      std::istringstream lineStream(line);
+      std::string keyword;
+      lineStream >> keyword;
+
+      if(keyword == "format")
       {
-        for (const auto& view : sfmData.getViews())
+        lineStream >> format;
+      }
+      else if(keyword == "element")
+      {
+        elements.emplace_back();
+        lineStream >> elements.back().name >> elements.back().count;
+      }
+      else if(keyword == "property")
+      {
+        if(elements.empty())
+          throw std::runtime_error("property without element");
+        PlyElement& element = elements.back();
+        PlyProperty property;
+        lineStream >> property.type;
+        if(property.type == "list")
         {
-          if (sfmData.isPoseAndIntrinsicDefined(view.second.get()))
-          {
-            const geometry::Pose3 pose = sfmData.getPose(*(view.second.get())).getTransform();
-            stream << pose.center().transpose()
-              << " 0 255 0" << "\n";
-          }
+          element.hasList = true;
+          continue;
         }
+        lineStream >> property.name;
+        property.size = plyTypeSize(property.type);
+        property.offset = element.size;
+        element.size += property.size;
+        element.properties.push_back(property);
+      }
+    }
+
+    const bool isBinary = (format == "binary_little_endian");
+    if(!isBinary && format != "ascii")
+      throw std::runtime_error("unsupported format '" + format + "'");
+
+    // skip the elements before the vertices
+    std::size_t elementIndex = 0;
+    for(; elementIndex < elements.size() && elements[elementIndex].name != "vertex"; ++elementIndex)
+    {
+      const PlyElement& element = elements[elementIndex];
+      if(isBinary)
+      {
+        if(element.hasList)
+          throw std::runtime_error("list properties before the vertices are not supported");
+        position += element.count * element.size;
+      }
+      else
+      {
+        for(std::size_t i = 0; i < element.count; ++i)
+          readLine();
       }
+    }
+    if(elementIndex == elements.size())
+      throw std::runtime_error("no vertex element");
+
+    const PlyElement& vertices = elements[elementIndex];
+    if(vertices.hasList)
+      throw std::runtime_error("list properties of the vertices are not supported");
+
+    const int xyz[3] = {vertices.propertyIndex("x"), vertices.propertyIndex("y"), vertices.propertyIndex("z")};
+    const int rgb[3] = {vertices.propertyIndex("red"), vertices.propertyIndex("green"), vertices.propertyIndex("blue")};
+    if(xyz[0] < 0 || xyz[1] < 0 || xyz[2] < 0)
+      throw std::runtime_error("no vertex position");
+    const bool hasColor = (rgb[0] >= 0 && rgb[1] >= 0 && rgb[2] >= 0);
+
+    std::vector<sfmData::Landmark> landmarks(vertices.count);
+
+    if(isBinary)
+    {
+      if(position > fileSize || vertices.count * vertices.size > fileSize - position)
+        throw std::runtime_error("truncated vertices");
 
-      if (b_structure)
+      const char* vertexData = data + position;
+
+      #pragma omp parallel for
+      for(int i = 0; i < static_cast<int>(vertices.count); ++i)
+      {
+        const char* record = vertexData + i * vertices.size;
+        sfmData::Landmark& landmark = landmarks[i];
+        for(int c = 0; c < 3; ++c)
+        {
+          const PlyProperty& property = vertices.properties[xyz[c]];
+          landmark.X(c) = readBinaryValue(record + property.offset, property.type);
+        }
+        if(hasColor)
+        {
+          const PlyProperty& red = vertices.properties[rgb[0]];
+          const PlyProperty& green = vertices.properties[rgb[1]];
+          const PlyProperty& blue = vertices.properties[rgb[2]];
+          landmark.rgb = image::RGBColor(toColor(readBinaryValue(record + red.offset, red.type), red.type),
+                                         toColor(readBinaryValue(record + green.offset, green.type), green.type),
+                                         toColor(readBinaryValue(record + blue.offset, blue.type), blue.type));
+        }
+      }
+    }
+    else
+    {
+      std::vector<double> values(vertices.properties.size());
+      for(std::size_t i = 0; i < vertices.count; ++i)
       {
-        const sfmData::Landmarks& landmarks = sfmData.getLandmarks();
-        for (sfmData::Landmarks::const_iterator iterLandmarks = landmarks.begin();
-          iterLandmarks != landmarks.end();
-          ++iterLandmarks)  {
-          stream << iterLandmarks->second.X.transpose() << " "
-                 << (int)iterLandmarks->second.rgb.r() << " "
-                 << (int)iterLandmarks->second.rgb.g() << " "
-                 << (int)iterLandmarks->second.rgb.b() << "\n";
+        const std::string line = readLine();
+        const char* begin = line.c_str();
+        for(double& value : values)
+        {
+          char* end = nullptr;
+          value = std::strtod(begin, &end);
+          if(end == begin)
+            throw std::runtime_error("invalid vertex " + std::to_string(i));
+          begin = end;
         }
+
+        sfmData::Landmark& landmark = landmarks[i];
+        landmark.X = Vec3(values[xyz[0]], values[xyz[1]], values[xyz[2]]);
+        if(hasColor)
+          landmark.rgb = image::RGBColor(toColor(values[rgb[0]], vertices.properties[rgb[0]].type),
+                                         toColor(values[rgb[1]], vertices.properties[rgb[1]].type),
+                                         toColor(values[rgb[2]], vertices.properties[rgb[2]].type));
       }
-      stream.flush();
-      bOk = stream.good();
-      stream.close();
+    }
+
+    sfmData::Landmarks& sfmLandmarks = sfmData.getLandmarks();
+    const IndexT firstId = sfmLandmarks.empty() ? 0 : (std::max_element(sfmLandmarks.begin(), sfmLandmarks.end(),
+                                                       [](const sfmData::Landmarks::value_type& a, const sfmData::Landmarks::value_type& b)
+                                                       { return a.first < b.first; })->first + 1);
+    for(std::size_t i = 0; i < landmarks.size(); ++i)
+      sfmLandmarks.emplace(firstId + i, std::move(landmarks[i]));
   }
-  return bOk;
+  catch(const std::exception& e)
+  {
+    ALICEVISION_LOG_ERROR("Cannot load the PLY file '" << filename << "': " << e.what());
+    return false;
+  }
+
+  return true;
 }
 
 } // namespace sfmDataIO
@@ -15,7 +15,8 @@ namespace aliceVision {
 namespace sfmDataIO {
 
 /**
- * @brief Save the structure and camera positions of a SfMData container as 3D points in a PLY ASCII file.
+ * @brief Save the structure and camera positions of a SfMData container as 3D points in a binary little-endian PLY file.
+ *        The vertices are formatted in parallel by large blocks before being written.
  * @param[in] sfmData The input SfMData
  * @param[in] filename The filename
  * @param[in] partFlag The ESfMData save flag
@@ -25,5 +26,17 @@ bool savePLY(const sfmData::SfMData& sfmData,
              const std::string& filename,
              ESfMData partFlag);
 
+/**
+ * @brief Load the vertices of an ASCII or binary little-endian PLY file as the structure of a SfMData container.
+ *        The vertices get new landmark ids after the existing ones, without observations.
+ * @param[out] sfmData The output SfMData
+ * @param[in] filename The filename
+ * @param[in] partFlag The ESfMData load flag, only STRUCTURE is read
+ * @return true if completed
+ */
+bool loadPLY(sfmData::SfMData& sfmData,
+             const std::string& filename,
+             ESfMData partFlag);
+
 } // namespace sfmDataIO
 } // namespace aliceVision
@@ -8,10 +8,13 @@
 #include <aliceVision/system/Timer.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
+#include <aliceVision/sfmDataIO/jsonIO.hpp>
 #include <aliceVision/config.hpp>
 
 #include <boost/filesystem.hpp>
+#include <boost/property_tree/json_parser.hpp>
 
+#include <fstream>
 #include <sstream>
 
 #define BOOST_TEST_MODULE sfmDataIO
@@ -71,7 +74,7 @@ sfmData::SfMData createTestScene(std::size_t viewsCount = 2, std::size_t observa
 
 BOOST_AUTO_TEST_CASE(SfMData_IO_SAVE_LOAD)
 {
-    std::vector<std::string> ext_Type = {"sfm", "json"};
+    std::vector<std::string> ext_Type = {"sfm", "json", "sfmb"};
 
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ALEMBIC)
     ext_Type.push_back("abc");
@@ -179,6 +182,105 @@ BOOST_AUTO_TEST_CASE(SfMData_IO_SAVE_LOAD)
     }
 }
 
+BOOST_AUTO_TEST_CASE(SfMData_IO_JSON_PropertyTreeCompatibility)
+{
+    const std::string filename = "JSON_COMPATIBILITY.sfm";
+
+    // more landmarks than a chunk of the JSON writer
+    sfmData::SfMData sfmData = createTestScene(2, 2, true);
+    for(IndexT landmarkId = 1; landmarkId < 5000; ++landmarkId)
+    {
+        sfmData::Landmark& landmark = sfmData.structure[landmarkId];
+        landmark.X = Vec3(landmarkId, -0.1 * landmarkId, 1e-7 / landmarkId);
+        landmark.rgb = image::RGBColor(landmarkId % 256, 0, 255);
+        landmark.descType = feature::EImageDescriberType::SIFT;
+        for(IndexT viewId = 0; viewId < landmarkId % 3; ++viewId)
+            landmark.observations[viewId] = sfmData::Observation(Vec2(0.5 * landmarkId, 1.0 / landmarkId), landmarkId, 2.5);
+    }
+
+    // the streamed file is read by the property tree
+    BOOST_CHECK(Save(sfmData, filename, ALL));
+    {
+        bpt::ptree fileTree;
+        bpt::read_json(filename, fileTree);
+        BOOST_CHECK_EQUAL(fileTree.get_child("structure").size(), sfmData.structure.size());
+
+        for(bpt::ptree::value_type& landmarkNode : fileTree.get_child("structure"))
+        {
+            IndexT landmarkId;
+            sfmData::Landmark landmark;
+            loadLandmark(landmarkId, landmark, landmarkNode.second);
+            BOOST_CHECK(landmark == sfmData.structure.at(landmarkId));
+            BOOST_CHECK(landmark.X == sfmData.structure.at(landmarkId).X);
+        }
+
+        sfmData::SfMData sfmDataLoad;
+        BOOST_CHECK(Load(sfmDataLoad, filename, ALL));
+        BOOST_CHECK(sfmData == sfmDataLoad);
+    }
+
+    // the values can also be written as JSON numbers
+    {
+        std::ofstream file(filename);
+        file << "{\"version\": [1, 2, 1], \"structure\": [{\"landmarkId\": 7, \"descType\": \"sift\", "
+                "\"color\": [255, 0, \"12\"], \"X\": [1.5, -2, 3e2], \"observations\": \"\"}]}";
+    }
+    {
+        sfmData::SfMData sfmDataLoad;
+        BOOST_CHECK(Load(sfmDataLoad, filename, ALL));
+        BOOST_REQUIRE_EQUAL(sfmDataLoad.structure.size(), 1);
+
+        const sfmData::Landmark& landmark = sfmDataLoad.structure.at(7);
+        BOOST_CHECK(landmark.X == Vec3(1.5, -2.0, 300.0));
+        BOOST_CHECK(landmark.rgb == image::RGBColor(255, 0, 12));
+        BOOST_CHECK(landmark.observations.empty());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(SfMData_IO_SFMB)
+{
+    const std::string filename = "SAVE_LOAD_COMPLETE.sfmb";
+
+    sfmData::SfMData sfmData = createTestScene(4, 3, false);
+    sfmData.addFeaturesFolder("features");
+    sfmData.addMatchesFolder("matches");
+
+    // a rig of the two first views
+    sfmData::Rig rig(2);
+    rig.setSubPose(0, sfmData::RigSubPose(Pose3(Mat3::Identity(), Vec3(0.5, 0, 0)), sfmData::ERigSubPoseStatus::ESTIMATED));
+    sfmData.getRigs().emplace(0, rig);
+    sfmData.views.at(0)->setRigAndSubPoseId(0, 0);
+    sfmData.views.at(1)->setRigAndSubPoseId(0, 1);
+    sfmData.views.at(1)->setIndependantPose(false);
+    sfmData.views.at(2)->addMetadata("Exif:FocalLength", "35");
+    sfmData.views.at(3)->addAncestor(2);
+
+    sfmData.control_points[3].X = Vec3(1, 2, 3);
+    sfmData.control_points[3].descType = feature::EImageDescriberType::SIFT;
+    sfmData.control_points[3].observations[1] = sfmData::Observation(Vec2(4, 5), 6, 1.5);
+
+    BOOST_CHECK(Save(sfmData, filename, ALL));
+
+    {
+        sfmData::SfMData sfmDataLoad;
+        BOOST_CHECK(Load(sfmDataLoad, filename, ALL));
+        BOOST_CHECK(sfmData == sfmDataLoad);
+        BOOST_CHECK_EQUAL(sfmDataLoad.getRelativeFeaturesFolders().size(), 1);
+        BOOST_CHECK_EQUAL(sfmDataLoad.getRelativeMatchesFolders().size(), 1);
+        BOOST_CHECK_EQUAL(sfmDataLoad.views.at(2)->getMetadata().at("Exif:FocalLength"), "35");
+    }
+
+    // the structure without the observations features
+    {
+        sfmData::SfMData sfmDataLoad;
+        BOOST_CHECK(Load(sfmDataLoad, filename, ESfMData(STRUCTURE | OBSERVATIONS)));
+        BOOST_CHECK_EQUAL(sfmDataLoad.views.size(), 0);
+        BOOST_REQUIRE_EQUAL(sfmDataLoad.structure.size(), 1);
+        BOOST_CHECK_EQUAL(sfmDataLoad.structure.at(0).observations.size(), 3);
+        BOOST_CHECK_EQUAL(sfmDataLoad.structure.at(0).observations.at(1).id_feat, UndefinedIndexT);
+    }
+}
+
 /*
 BOOST_AUTO_TEST_CASE(SfMData_IO_BigFile) {
   const int nbViews = 1000;
@@ -230,5 +332,34 @@ BOOST_AUTO_TEST_CASE(SfMData_IO_SAVE_PLY) {
     ESfMData flags_part = ESfMData(EXTRINSICS | STRUCTURE);
     BOOST_CHECK( Save(sfmData, filename, flags_part) );
     BOOST_CHECK( fs::is_regular_file(filename) );
+
+    // LOAD the camera centers and the landmarks back as 3D points
+    sfmData::SfMData sfmDataLoad;
+    BOOST_CHECK( Load(sfmDataLoad, filename, ESfMData(STRUCTURE)) );
+    BOOST_CHECK_EQUAL( sfmDataLoad.getLandmarks().size(), sfmData.getPoses().size() + sfmData.getLandmarks().size() );
+
+    const sfmData::Landmark& landmark = sfmData.getLandmarks().begin()->second;
+    const sfmData::Landmark& landmarkLoad = sfmDataLoad.getLandmarks().at(sfmData.getPoses().size());
+    BOOST_CHECK_SMALL( (landmark.X - landmarkLoad.X).norm(), 1e-5 );
+    BOOST_CHECK( landmark.rgb == landmarkLoad.rgb );
+  }
+
+  // LOAD an ASCII PLY
+  {
+    const std::string filename = "LOAD_ASCII.ply";
+    {
+      std::ofstream stream(filename);
+      stream << "ply\nformat ascii 1.0\ncomment test\n"
+             << "element vertex 2\nproperty double x\nproperty double y\nproperty double z\n"
+             << "property float nx\nproperty uchar red\nproperty uchar green\nproperty uchar blue\n"
+             << "element face 0\nproperty list uchar int vertex_indices\nend_header\n"
+             << "1 2 3 0 10 20 30\n-4.5 5 6e-1 0 255 0 0\n";
+    }
+
+    sfmData::SfMData sfmDataLoad;
+    BOOST_CHECK( Load(sfmDataLoad, filename, ALL) );
+    BOOST_CHECK_EQUAL( sfmDataLoad.getLandmarks().size(), 2 );
+    BOOST_CHECK( sfmDataLoad.getLandmarks().at(1).X.isApprox(Vec3(-4.5, 5.0, 0.6)) );
+    BOOST_CHECK( sfmDataLoad.getLandmarks().at(0).rgb == image::RGBColor(10, 20, 30) );
   }
 }
@@ -0,0 +1,640 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "sfmbIO.hpp"
+#include <aliceVision/sfmDataIO/jsonIO.hpp>
+#include <aliceVision/system/Logger.hpp>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/property_tree/json_parser.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace aliceVision {
+namespace sfmDataIO {
+
+namespace {
+
+enum ESfmbSection
+{
+  eSfmbFolders = 0,
+  eSfmbViews,
+  eSfmbIntrinsics,
+  eSfmbPoses,
+  eSfmbRigs,
+  eSfmbLandmarks,
+  eSfmbLandmarksObservations,
+  eSfmbControlPoints,
+  eSfmbControlPointsObservations,
+  eSfmbNbSections
+};
+
+struct SfmbSection
+{
+  std::uint64_t offset = 0;
+  /// size in bytes
+  std::uint64_t size = 0;
+  /// number of records
+  std::uint64_t count = 0;
+};
+
+struct SfmbHeader
+{
+  static constexpr std::uint32_t currentVersion = 1;
+
+  char magic[8] = {'A', 'V', 'S', 'F', 'M', 'B', '\0', '\0'};
+  std::uint32_t version = currentVersion;
+  std::int32_t sfmDataVersion[3] = {ALICEVISION_SFMDATAIO_VERSION_MAJOR, ALICEVISION_SFMDATAIO_VERSION_MINOR, ALICEVISION_SFMDATAIO_VERSION_REVISION};
+  /// the saved ESfMData parts
+  std::uint32_t partFlag = 0;
+  std::uint32_t reserved = 0;
+  SfmbSection sections[eSfmbNbSections];
+
+  bool isValid() const { return std::memcmp(magic, SfmbHeader().magic, sizeof(magic)) == 0; }
+};
+
+struct SfmbPose
+{
+  std::uint32_t poseId;
+  std::uint32_t locked;
+  /// column-major
+  double rotation[9];
+  double center[3];
+};
+
+struct SfmbLandmark
+{
+  std::uint32_t landmarkId;
+  std::int32_t descType;
+  double X[3];
+  std::uint8_t rgb[3];
+  std::uint8_t reserved[5];
+  /// number of records of the landmark in the observations section
+  std::uint64_t nbObservations;
+};
+
+struct SfmbObservation
+{
+  std::uint32_t viewId;
+  std::uint32_t featureId;
+  double x[2];
+  double scale;
+};
+
+static_assert(sizeof(SfmbHeader) == 32 + eSfmbNbSections * sizeof(SfmbSection), "Unexpected SFMB header layout.");
+static_assert(sizeof(SfmbPose) == 104, "Unexpected SFMB pose layout.");
+static_assert(sizeof(SfmbLandmark) == 48, "Unexpected SFMB landmark layout.");
+static_assert(sizeof(SfmbObservation) == 32, "Unexpected SFMB observation layout.");
+
+/// Variable-size records of a section
+class SfmbBuffer
+{
+public:
+  template <typename T>
+  void write(const T& value)
+  {
+    const char* bytes = reinterpret_cast<const char*>(&value);
+    _data.insert(_data.end(), bytes, bytes + sizeof(T));
+  }
+
+  void writeString(const std::string& value)
+  {
+    write<std::uint32_t>(value.size());
+    _data.insert(_data.end(), value.begin(), value.end());
+  }
+
+  const std::vector<char>& data() const { return _data; }
+
+private:
+  std::vector<char> _data;
+};
+
+/// Reader of the variable-size records of a section, with bounds checking
+class SfmbReader
+{
+public:
+  SfmbReader(const char* data, std::size_t size)
+    : _pos(data)
+    , _end(data + size)
+  {}
+
+  template <typename T>
+  T read()
+  {
+    T value;
+    std::memcpy(&value, take(sizeof(T)), sizeof(T));
+    return value;
+  }
+
+  std::string readString()
+  {
+    const std::size_t size = read<std::uint32_t>();
+    return std::string(take(size), size);
+  }
+
+private:
+  const char* take(std::size_t size)
+  {
+    if(static_cast<std::size_t>(_end - _pos) < size)
+      throw std::runtime_error("truncated section");
+    const char* data = _pos;
+    _pos += size;
+    return data;
+  }
+
+  const char* _pos;
+  const char* _end;
+};
+
+class SfmbWriter
+{
+public:
+  SfmbWriter(const std::string& filepath)
+    : _file(filepath, std::ios::out | std::ios::binary)
+  {
+    // placeholder header, updated in close()
+    _file.write(reinterpret_cast<const char*>(&_header), sizeof(SfmbHeader));
+  }
+
+  bool isOpen() const { return _file.is_open(); }
+
+  void writeSection(ESfmbSection section, const char* data, std::size_t size, std::size_t count)
+  {
+    // align the sections to allow a direct access to the mapped file
+    const std::uint64_t position = static_cast<std::uint64_t>(_file.tellp());
+    const char padding[8] = {0};
+    _file.write(padding, (8 - position % 8) % 8);
+
+    _header.sections[section].offset = static_cast<std::uint64_t>(_file.tellp());
+    _header.sections[section].size = size;
+    _header.sections[section].count = count;
+    if(size > 0)
+      _file.write(data, size);
+  }
+
+  template <typename T>
+  void writeSection(ESfmbSection section, const std::vector<T>& records)
+  {
+    writeSection(section, reinterpret_cast<const char*>(records.data()), records.size() * sizeof(T), records.size());
+  }
+
+  void writeSection(ESfmbSection section, const SfmbBuffer& buffer, std::size_t count)
+  {
+    writeSection(section, buffer.data().data(), buffer.data().size(), count);
+  }
+
+  bool close(ESfMData partFlag)
+  {
+    _header.partFlag = static_cast<std::uint32_t>(partFlag);
+    _file.seekp(0);
+    _file.write(reinterpret_cast<const char*>(&_header), sizeof(SfmbHeader));
+
+    const bool ok = _file.good();
+    _file.close();
+    return ok;
+  }
+
+private:
+  std::ofstream _file;
+  SfmbHeader _header;
+};
+
+void writeLandmarks(SfmbWriter& writer, ESfmbSection landmarksSection, ESfmbSection observationsSection,
+                    const sfmData::Landmarks& landmarks, bool saveObservations, bool saveFeatures)
+{
+  std::vector<SfmbLandmark> landmarkRecords;
+  std::vector<SfmbObservation> observationRecords;
+  landmarkRecords.reserve(landmarks.size());
+
+  for(const auto& landmarkPair : landmarks)
+  {
+    const sfmData::Landmark& landmark = landmarkPair.second;
+
+    SfmbLandmark record{};
+    record.landmarkId = landmarkPair.first;
+    record.descType = static_cast<std::int32_t>(landmark.descType);
+    for(int i = 0; i < 3; ++i)
+    {
+      record.X[i] = landmark.X(i);
+      record.rgb[i] = landmark.rgb(i);
+    }
+
+    if(saveObservations)
+    {
+      record.nbObservations = landmark.observations.size();
+      for(const auto& observationPair : landmark.observations)
+      {
+        const sfmData::Observation& observation = observationPair.second;
+
+        SfmbObservation observationRecord{};
+        observationRecord.viewId = observationPair.first;
+        observationRecord.featureId = UndefinedIndexT;
+        if(saveFeatures)
+        {
+          observationRecord.featureId = observation.id_feat;
+          observationRecord.x[0] = observation.x(0);
+          observationRecord.x[1] = observation.x(1);
+          observationRecord.scale = observation.scale;
+        }
+        observationRecords.push_back(observationRecord);
+      }
+    }
+    landmarkRecords.push_back(record);
+  }
+
+  writer.writeSection(landmarksSection, landmarkRecords);
+  writer.writeSection(observationsSection, observationRecords);
+}
+
+void readLandmarks(const char* data, const SfmbHeader& header, ESfmbSection landmarksSection, ESfmbSection observationsSection,
+                   sfmData::Landmarks& landmarks, bool loadObservations, bool loadFeatures)
+{
+  const SfmbSection& section = header.sections[landmarksSection];
+  const SfmbSection& obsSection = header.sections[observationsSection];
+
+  if(section.size != section.count * sizeof(SfmbLandmark) || obsSection.size != obsSection.count * sizeof(SfmbObservation))
+    throw std::runtime_error("invalid landmarks section");
+
+  // the records are read from the mapped file by copy, the sections are aligned
+  std::vector<SfmbLandmark> records(section.count);
+  if(!records.empty())
+    std::memcpy(records.data(), data + section.offset, section.size);
+
+  std::vector<std::uint64_t> observationOffsets(records.size() + 1, 0);
+  for(std::size_t i = 0; i < records.size(); ++i)
+    observationOffsets[i + 1] = observationOffsets[i] + records[i].nbObservations;
+
+  if(loadObservations && observationOffsets.back() != obsSection.count)
+    throw std::runtime_error("invalid observations section");
+
+  std::vector<std::pair<IndexT, sfmData::Landmark>> loadedLandmarks(records.size());
+
+  #pragma omp parallel for
+  for(int i = 0; i < static_cast<int>(records.size()); ++i)
+  {
+    const SfmbLandmark& record = records[i];
+    sfmData::Landmark& landmark = loadedLandmarks[i].second;
+
+    loadedLandmarks[i].first = record.landmarkId;
+    landmark.descType = static_cast<feature::EImageDescriberType>(record.descType);
+    landmark.X = Vec3(record.X[0], record.X[1], record.X[2]);
+    landmark.rgb = image::RGBColor(record.rgb[0], record.rgb[1], record.rgb[2]);
+
+    if(!loadObservations)
+      continue;
+
+    for(std::uint64_t o = observationOffsets[i]; o < observationOffsets[i + 1]; ++o)
+    {
+      SfmbObservation observationRecord;
+      std::memcpy(&observationRecord, data + obsSection.offset + o * sizeof(SfmbObservation), sizeof(SfmbObservation));
+
+      sfmData::Observation observation;
+      if(loadFeatures)
+      {
+        observation.id_feat = observationRecord.featureId;
+        observation.x = Vec2(observationRecord.x[0], observationRecord.x[1]);
+        observation.scale = observationRecord.scale;
+      }
+      landmark.observations.emplace(observationRecord.viewId, observation);
+    }
+  }
+
+  for(auto& landmarkPair : loadedLandmarks)
+    landmarks.emplace(landmarkPair.first, std::move(landmarkPair.second));
+}
+
+} // namespace
+
+bool saveSFMB(const sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag)
+{
+  // save flags
+  const bool saveViews = (partFlag & VIEWS) == VIEWS;
+  const bool saveIntrinsics = (partFlag & INTRINSICS) == INTRINSICS;
+  const bool saveExtrinsics = (partFlag & EXTRINSICS) == EXTRINSICS;
+  const bool saveStructure = (partFlag & STRUCTURE) == STRUCTURE;
+  const bool saveControlPoints = (partFlag & CONTROL_POINTS) == CONTROL_POINTS;
+  const bool saveFeatures = (partFlag & OBSERVATIONS_WITH_FEATURES) == OBSERVATIONS_WITH_FEATURES;
+  const bool saveObservations = saveFeatures || ((partFlag & OBSERVATIONS) == OBSERVATIONS);
+
+  SfmbWriter writer(filename);
+  if(!writer.isOpen())
+    return false;
+
+  // folders
+  {
+    SfmbBuffer buffer;
+    const std::vector<std::string> featuresFolders = sfmData.getRelativeFeaturesFolders();
+    const std::vector<std::string> matchesFolders = sfmData.getRelativeMatchesFolders();
+
+    buffer.write<std::uint32_t>(featuresFolders.size());
+    for(const std::string& folder : featuresFolders)
+      buffer.writeString(folder);
+    buffer.write<std::uint32_t>(matchesFolders.size());
+    for(const std::string& folder : matchesFolders)
+      buffer.writeString(folder);
+
+    writer.writeSection(eSfmbFolders, buffer, featuresFolders.size() + matchesFolders.size());
+  }
+
+  // views
+  if(saveViews)
+  {
+    SfmbBuffer buffer;
+    for(const auto& viewPair : sfmData.getViews())
+    {
+      const sfmData::View& view = *(viewPair.second);
+
+      buffer.write<std::uint32_t>(view.getViewId());
+      buffer.write<std::uint32_t>(view.getPoseId());
+      buffer.write<std::uint32_t>(view.getRigId());
+      buffer.write<std::uint32_t>(view.getSubPoseId());
+      buffer.write<std::uint32_t>(view.getFrameId());
+      buffer.write<std::uint32_t>(view.getIntrinsicId());
+      buffer.write<std::uint32_t>(view.getResectionId());
+      buffer.write<std::uint32_t>(view.isPoseIndependant() ? 1 : 0);
+      buffer.write<std::uint64_t>(view.getWidth());
+      buffer.write<std::uint64_t>(view.getHeight());
+      buffer.writeString(view.getImagePath());
+
+      buffer.write<std::uint32_t>(view.getAncestors().size());
+      for(const IndexT ancestor : view.getAncestors())
+        buffer.write<std::uint32_t>(ancestor);
+
+      buffer.write<std::uint32_t>(view.getMetadata().size());
+      for(const auto& metadataPair : view.getMetadata())
+      {
+        buffer.writeString(metadataPair.first);
+        buffer.writeString(metadataPair.second);
+      }
+    }
+    writer.writeSection(eSfmbViews, buffer, sfmData.getViews().size());
+  }
+
+  // intrinsics, in the same JSON as the .sfm files to share their many camera models
+  if(saveIntrinsics)
+  {
+    SfmbBuffer buffer;
+    for(const auto& intrinsicPair : sfmData.getIntrinsics())
+    {
+      bpt::ptree parentTree;
+      saveIntrinsic("", intrinsicPair.first, intrinsicPair.second, parentTree);
+
+      std::ostringstream stream;
+      bpt::write_json(stream, parentTree.front().second, false);
+      buffer.writeString(stream.str());
+    }
+    writer.writeSection(eSfmbIntrinsics, buffer, sfmData.getIntrinsics().size());
+  }
+
+  // extrinsics
+  if(saveExtrinsics)
+  {
+    // poses
+    std::vector<SfmbPose> poseRecords;
+    poseRecords.reserve(sfmData.getPoses().size());
+    for(const auto& posePair : sfmData.getPoses())
+    {
+      const geometry::Pose3& pose = posePair.second.getTransform();
+
+      SfmbPose record{};
+      record.poseId = posePair.first;
+      record.locked = posePair.second.isLocked() ? 1 : 0;
+      Eigen::Map<Mat3>(record.rotation) = pose.rotation();
+      Eigen::Map<Vec3>(record.center) = pose.center();
+      poseRecords.push_back(record);
+    }
+    writer.writeSection(eSfmbPoses, poseRecords);
+
+    // rigs
+    SfmbBuffer buffer;
+    for(const auto& rigPair : sfmData.getRigs())
+    {
+      buffer.write<std::uint32_t>(rigPair.first);
+      buffer.write<std::uint32_t>(rigPair.second.getSubPoses().size());
+      for(const sfmData::RigSubPose& subPose : rigPair.second.getSubPoses())
+      {
+        buffer.write<std::uint32_t>(static_cast<std::uint32_t>(subPose.status));
+        const Mat3 rotation = subPose.pose.rotation();
+        const Vec3 center = subPose.pose.center();
+        for(int i = 0; i < 9; ++i)
+          buffer.write<double>(rotation(i));
+        for(int i = 0; i < 3; ++i)
+          buffer.write<double>(center(i));
+      }
+    }
+    writer.writeSection(eSfmbRigs, buffer, sfmData.getRigs().size());
+  }
+
+  // structure
+  if(saveStructure)
+    writeLandmarks(writer, eSfmbLandmarks, eSfmbLandmarksObservations, sfmData.getLandmarks(), saveObservations, saveFeatures);
+
+  // control points
+  if(saveControlPoints)
+    writeLandmarks(writer, eSfmbControlPoints, eSfmbControlPointsObservations, sfmData.getControlPoints(), true, true);
+
+  // the observations features are only loaded if they have been saved
+  const ESfMData savedPartFlag = ESfMData(saveFeatures ? partFlag : (partFlag & ~OBSERVATIONS_WITH_FEATURES));
+
+  return writer.close(savedPartFlag);
+}
+
+bool loadSFMB(sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag)
+{
+  boost::iostreams::mapped_file_source file;
+  try
+  {
+    file.open(filename);
+  }
+  catch(const std::exception& e)
+  {
+    ALICEVISION_LOG_ERROR("Cannot open the SFMB file '" << filename << "': " << e.what());
+    return false;
+  }
+
+  SfmbHeader header;
+  if(file.size() >= sizeof(SfmbHeader))
+    std::memcpy(&header, file.data(), sizeof(SfmbHeader));
+
+  if(file.size() < sizeof(SfmbHeader) || !header.isValid())
+  {
+    ALICEVISION_LOG_ERROR("Cannot load the SFMB file '" << filename << "', it is not a SFMB file.");
+    return false;
+  }
+
+  if(header.version > SfmbHeader::currentVersion)
+  {
+    ALICEVISION_LOG_ERROR("Cannot load the SFMB file '" << filename << "', it has an unsupported version (" << header.version << ").");
+    return false;
+  }
+
+  for(int i = 0; i < eSfmbNbSections; ++i)
+  {
+    const SfmbSection& s = header.sections[i];
+    if(s.offset > file.size() || s.size > file.size() - s.offset)
+    {
+      ALICEVISION_LOG_ERROR("Cannot load the SFMB file '" << filename << "', it is truncated.");
+      return false;
+    }
+  }
+
+  // load flags, only for the saved parts
+  const ESfMData savedPartFlag = ESfMData(header.partFlag);
+  const bool loadViews = (partFlag & VIEWS) == VIEWS;
+  const bool loadIntrinsics = (partFlag & INTRINSICS) == INTRINSICS;
+  const bool loadExtrinsics = (partFlag & EXTRINSICS) == EXTRINSICS;
+  const bool loadStructure = (partFlag & STRUCTURE) == STRUCTURE;
+  const bool loadControlPoints = (partFlag & CONTROL_POINTS) == CONTROL_POINTS;
+  const bool loadFeatures = (partFlag & OBSERVATIONS_WITH_FEATURES) == OBSERVATIONS_WITH_FEATURES &&
+                            (savedPartFlag & OBSERVATIONS_WITH_FEATURES) == OBSERVATIONS_WITH_FEATURES;
+  const bool loadObservations = loadFeatures || ((partFlag & OBSERVATIONS) == OBSERVATIONS) ||
+                                ((partFlag & OBSERVATIONS_WITH_FEATURES) == OBSERVATIONS_WITH_FEATURES);
+
+  const Version version(header.sfmDataVersion[0], header.sfmDataVersion[1], header.sfmDataVersion[2]);
+  const auto sectionReader = [&](ESfmbSection section)
+  {
+    return SfmbReader(file.data() + header.sections[section].offset, header.sections[section].size);
+  };
+
+  try
+  {
+    // folders
+    {
+      SfmbReader reader = sectionReader(eSfmbFolders);
+      if(header.sections[eSfmbFolders].size > 0)
+      {
+        const std::size_t nbFeaturesFolders = reader.read<std::uint32_t>();
+        for(std::size_t i = 0; i < nbFeaturesFolders; ++i)
+          sfmData.addFeaturesFolder(reader.readString());
+        const std::size_t nbMatchesFolders = reader.read<std::uint32_t>();
+        for(std::size_t i = 0; i < nbMatchesFolders; ++i)
+          sfmData.addMatchesFolder(reader.readString());
+      }
+    }
+
+    // intrinsics
+    if(loadIntrinsics)
+    {
+      SfmbReader reader = sectionReader(eSfmbIntrinsics);
+      for(std::uint64_t i = 0; i < header.sections[eSfmbIntrinsics].count; ++i)
+      {
+        bpt::ptree intrinsicTree;
+        std::istringstream stream(reader.readString());
+        bpt::read_json(stream, intrinsicTree);
+
+        IndexT intrinsicId;
+        std::shared_ptr<camera::IntrinsicBase> intrinsic;
+        loadIntrinsic(version, intrinsicId, intrinsic, intrinsicTree);
+
+        sfmData.getIntrinsics().emplace(intrinsicId, intrinsic);
+      }
+    }
+
+    // views
+    if(loadViews)
+    {
+      SfmbReader reader = sectionReader(eSfmbViews);
+      for(std::uint64_t i = 0; i < header.sections[eSfmbViews].count; ++i)
+      {
+        auto view = std::make_shared<sfmData::View>();
+
+        view->setViewId(reader.read<std::uint32_t>());
+        view->setPoseId(reader.read<std::uint32_t>());
+        const IndexT rigId = reader.read<std::uint32_t>();
+        const IndexT subPoseId = reader.read<std::uint32_t>();
+        if(rigId != UndefinedIndexT)
+          view->setRigAndSubPoseId(rigId, subPoseId);
+        view->setFrameId(reader.read<std::uint32_t>());
+        view->setIntrinsicId(reader.read<std::uint32_t>());
+        view->setResectionId(reader.read<std::uint32_t>());
+        view->setIndependantPose(reader.read<std::uint32_t>() != 0);
+        view->setWidth(reader.read<std::uint64_t>());
+        view->setHeight(reader.read<std::uint64_t>());
+        view->setImagePath(reader.readString());
+
+        const std::size_t nbAncestors = reader.read<std::uint32_t>();
+        for(std::size_t a = 0; a < nbAncestors; ++a)
+          view->addAncestor(reader.read<std::uint32_t>());
+
+        const std::size_t nbMetadata = reader.read<std::uint32_t>();
+        for(std::size_t m = 0; m < nbMetadata; ++m)
+        {
+          const std::string key = reader.readString();
+          view->addMetadata(key, reader.readString());
+        }
+
+        sfmData.getViews().emplace(view->getViewId(), view);
+      }
+    }
+
+    // extrinsics
+    if(loadExtrinsics)
+    {
+      // poses
+      const SfmbSection& posesSection = header.sections[eSfmbPoses];
+      if(posesSection.size != posesSection.count * sizeof(SfmbPose))
+        throw std::runtime_error("invalid poses section");
+
+      for(std::uint64_t i = 0; i < posesSection.count; ++i)
+      {
+        SfmbPose record;
+        std::memcpy(&record, file.data() + posesSection.offset + i * sizeof(SfmbPose), sizeof(SfmbPose));
+
+        const geometry::Pose3 pose(Eigen::Map<const Mat3>(record.rotation), Eigen::Map<const Vec3>(record.center));
+        sfmData.getPoses().emplace(record.poseId, sfmData::CameraPose(pose, record.locked != 0));
+      }
+
+      // rigs
+      SfmbReader reader = sectionReader(eSfmbRigs);
+      for(std::uint64_t i = 0; i < header.sections[eSfmbRigs].count; ++i)
+      {
+        const IndexT rigId = reader.read<std::uint32_t>();
+        const std::size_t nbSubPoses = reader.read<std::uint32_t>();
+        sfmData::Rig rig(nbSubPoses);
+
+        for(std::size_t s = 0; s < nbSubPoses; ++s)
+        {
+          sfmData::RigSubPose subPose;
+          subPose.status = static_cast<sfmData::ERigSubPoseStatus>(reader.read<std::uint32_t>());
+
+          Mat3 rotation;
+          Vec3 center;
+          for(int c = 0; c < 9; ++c)
+            rotation(c) = reader.read<double>();
+          for(int c = 0; c < 3; ++c)
+            center(c) = reader.read<double>();
+          subPose.pose = geometry::Pose3(rotation, center);
+
+          rig.setSubPose(s, subPose);
+        }
+        sfmData.getRigs().emplace(rigId, rig);
+      }
+    }
+
+    // structure
+    if(loadStructure)
+      readLandmarks(file.data(), header, eSfmbLandmarks, eSfmbLandmarksObservations, sfmData.getLandmarks(), loadObservations, loadFeatures);
+
+    // control points
+    if(loadControlPoints)
+      readLandmarks(file.data(), header, eSfmbControlPoints, eSfmbControlPointsObservations, sfmData.getControlPoints(), true, true);
+  }
+  catch(const std::exception& e)
+  {
+    ALICEVISION_LOG_ERROR("Cannot load the SFMB file '" << filename << "': " << e.what());
+    return false;
+  }
+
+  return true;
+}
+
+} // namespace sfmDataIO
+} // namespace aliceVision
@@ -0,0 +1,54 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/sfmDataIO/sfmDataIO.hpp>
+
+#include <string>
+
+namespace aliceVision {
+namespace sfmDataIO {
+
+// AliceVision SFMB file (binary SfMData):
+// -- Header
+// magic, file version, SfMData version, saved ESfMData parts, table of the sections
+// -- Sections (each one starting on an 8 bytes boundary)
+// Folders [features folders, matches folders]
+// Views [records of the view ids, image size, path, ancestors and metadata]
+// Intrinsics [records of the intrinsics in compact JSON, as in the .sfm files]
+// Poses [fixed-size records: pose id, locked, rotation, center]
+// Rigs [records of the rig id and sub-poses]
+// Landmarks, ControlPoints [fixed-size records: id, describer type, X, color, number of observations]
+// LandmarksObservations, ControlPointsObservations [fixed-size records: view id, feature id, x, scale]
+// --
+// The file is memory mapped and only the sections of the loaded ESfMData parts are read,
+// so loading the views and extrinsics never touches the landmarks payload.
+
+/**
+ * @brief Save SfMData in a binary SFMB file.
+ * @param[in] sfmData The input SfMData
+ * @param[in] filename The filename
+ * @param[in] partFlag The ESfMData save flag
+ * @return true if completed
+ */
+bool saveSFMB(const sfmData::SfMData& sfmData,
+              const std::string& filename,
+              ESfMData partFlag);
+
+/**
+ * @brief Load SfMData from a binary SFMB file, only the sections of the requested parts are read.
+ * @param[out] sfmData The output SfMData
+ * @param[in] filename The filename
+ * @param[in] partFlag The ESfMData load flag
+ * @return true if completed
+ */
+bool loadSFMB(sfmData::SfMData& sfmData,
+              const std::string& filename,
+              ESfMData partFlag);
+
+} // namespace sfmDataIO
+} // namespace aliceVision
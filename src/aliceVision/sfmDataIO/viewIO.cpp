@@ -10,6 +10,7 @@
 #include <aliceVision/sfmData/uid.hpp>
 #include <aliceVision/camera/camera.hpp>
 #include <aliceVision/image/io.hpp>
+#include <aliceVision/image/metadataCache.hpp>
 #include "aliceVision/utils/filesIO.hpp"
 
 #include <stdexcept>
@@ -20,7 +21,8 @@ namespace fs = boost::filesystem;
 namespace aliceVision {
 namespace sfmDataIO {
 
-void updateIncompleteView(sfmData::View& view, EViewIdMethod viewIdMethod, const std::string& viewIdRegex)
+void updateIncompleteView(sfmData::View& view, EViewIdMethod viewIdMethod, const std::string& viewIdRegex,
+                          image::ImageMetadataCache* metadataCache)
 {
   // check if the view is complete
   if(view.getViewId() != UndefinedIndexT &&
@@ -31,14 +33,16 @@ void updateIncompleteView(sfmData::View& view, EViewIdMethod viewIdMethod, const
     return;
 
   int width, height;
-  const auto metadata = image::readImageMetadata(view.getImagePath(), width, height);
+  const std::map<std::string, std::string> metadata = (metadataCache != nullptr) ?
+        metadataCache->readImageMetadata(view.getImagePath(), width, height) :
+        image::getMapFromMetadata(image::readImageMetadata(view.getImagePath(), width, height));
 
   view.setWidth(width);
   view.setHeight(height);
 
   // reset metadata
   if(view.getMetadata().empty())
-    view.setMetadata(image::getMapFromMetadata(metadata));
+    view.setMetadata(metadata);
 
   // Reset viewId
   if(view.getViewId() == UndefinedIndexT)
@@ -16,6 +16,11 @@
 #include <memory>
 
 namespace aliceVision {
+
+namespace image {
+class ImageMetadataCache;
+} // namespace image
+
 namespace sfmDataIO {
 
 enum class EViewIdMethod
@@ -60,8 +65,10 @@ inline std::istream& operator>>(std::istream& in, EViewIdMethod& s)
  * @param view The given incomplete view
  * @param[in] viewIdMethod ViewId generation method to use
  * @param[in] viewIdRegex Optional regex used when viewIdMethod is FILENAME
+ * @param[in] metadataCache Optional persistent cache of the image metadata
  */
-void updateIncompleteView(sfmData::View& view, EViewIdMethod viewIdMethod = EViewIdMethod::METADATA, const std::string& viewIdRegex = "");
+void updateIncompleteView(sfmData::View& view, EViewIdMethod viewIdMethod = EViewIdMethod::METADATA, const std::string& viewIdRegex = "",
+                          image::ImageMetadataCache* metadataCache = nullptr);
 
 /**
  * @brief create an intrinsic for the given View
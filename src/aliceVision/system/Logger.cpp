@@ -11,6 +11,7 @@
 #include <boost/log/trivial.hpp>
 #include <boost/log/expressions.hpp>
 #include <boost/log/sinks/sync_frontend.hpp>
+#include <boost/log/sinks/async_frontend.hpp>
 #include <boost/log/sinks/text_ostream_backend.hpp>
 #include <boost/log/sources/severity_logger.hpp>
 #include <boost/log/sources/record_ostream.hpp>
@@ -76,11 +77,16 @@ std::istream& operator>>(std::istream& in, EVerboseLevel& verboseLevel)
 
 std::shared_ptr<Logger> Logger::_instance = nullptr;
 
-Logger::Logger()
+namespace {
+
+using TextBackend = boost::log::sinks::text_ostream_backend;
+using SynchronousSink = boost::log::sinks::synchronous_sink<TextBackend>;
+using AsynchronousSink = boost::log::sinks::asynchronous_sink<TextBackend>;
+
+template <typename SinkT>
+boost::shared_ptr<SinkT> createConsoleSink()
 {
   namespace expr = boost::log::expressions;
-  namespace sinks = boost::log::sinks;
-  using sink_t = sinks::synchronous_sink<boost::log::sinks::text_ostream_backend>;
 
 #if BOOST_VERSION >= 105600
   using boost::null_deleter;
@@ -89,31 +95,43 @@ Logger::Logger()
 #else
   using null_deleter = boost::log::empty_deleter;
 #endif
-  boost::shared_ptr<sink_t> sink;
 
-  {
-    // create a backend and attach a stream to it
-    boost::shared_ptr<sinks::text_ostream_backend> backend = boost::make_shared<sinks::text_ostream_backend>();
-    backend->add_stream(boost::shared_ptr<std::ostream>(&std::clog, null_deleter()));
-    // backend->add_stream( boost::shared_ptr< std::ostream >( new std::ofstream("sample.log") ) );
+  // create a backend and attach a stream to it
+  boost::shared_ptr<TextBackend> backend = boost::make_shared<TextBackend>();
+  backend->add_stream(boost::shared_ptr<std::ostream>(&std::clog, null_deleter()));
+  // backend->add_stream( boost::shared_ptr< std::ostream >( new std::ofstream("sample.log") ) );
 
-    // enable auto-flushing after each log record written
-    backend->auto_flush(true);
+  // enable auto-flushing after each log record written
+  backend->auto_flush(true);
 
-    // wrap it into the frontend and register in the core.
-    sink = boost::make_shared<sink_t>(backend);
-  }
+  // wrap it into the frontend
+  boost::shared_ptr<SinkT> sink = boost::make_shared<SinkT>(backend);
 
   sink->reset_formatter();
 
   // specify format of the log records
-  sink->set_formatter(expr::stream   
+  sink->set_formatter(expr::stream
          << "[" << expr::format_date_time<boost::posix_time::ptime>("TimeStamp","%H:%M:%S.%f") << "]"
          << "[" << boost::log::trivial::severity << "]"
          << " " << expr::smessage);
 
+  return sink;
+}
+
+} // namespace
+
+Logger::Logger()
+{
+  const char* envSync = std::getenv("ALICEVISION_LOG_SYNC");
+  _asynchronous = (envSync == NULL || std::string(envSync) == "0");
+
+  if(_asynchronous)
+    _sink = createConsoleSink<AsynchronousSink>();
+  else
+    _sink = createConsoleSink<SynchronousSink>();
+
   // register the sink in the logging core
-  boost::log::core::get()->add_sink(sink);
+  boost::log::core::get()->add_sink(_sink);
 
   boost::log::add_common_attributes();
 
@@ -125,6 +143,30 @@ Logger::Logger()
     setLogLevel(envLevel);
 }
 
+void Logger::stop()
+{
+  if(!_asynchronous)
+  {
+    _sink->flush();
+    return;
+  }
+
+  // write the pending records and stop the logging thread,
+  // the next records are written synchronously from the calling thread
+  const boost::shared_ptr<AsynchronousSink> asyncSink = boost::static_pointer_cast<AsynchronousSink>(_sink);
+  _sink = createConsoleSink<SynchronousSink>();
+  boost::log::core::get()->add_sink(_sink);
+  boost::log::core::get()->remove_sink(asyncSink);
+  asyncSink->stop();
+  asyncSink->flush();
+  _asynchronous = false;
+}
+
+void Logger::flush()
+{
+  _sink->flush();
+}
+
 std::shared_ptr<Logger> Logger::get()
 {
   if(_instance == nullptr)
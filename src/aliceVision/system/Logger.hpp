@@ -10,6 +10,8 @@
 #include <aliceVision/prettyprint.hpp>
 
 #include <boost/log/trivial.hpp>
+#include <boost/log/sinks/sink.hpp>
+#include <boost/smart_ptr/shared_ptr.hpp>
 
 #include <memory>
 #include <iostream>
@@ -75,6 +77,13 @@ std::ostream& operator<<(std::ostream& os, EVerboseLevel verboseLevel);
 
 std::istream& operator>>(std::istream& in, EVerboseLevel& verboseLevel);
 
+/**
+ * @brief Console logger.
+ *
+ * The records are written by a dedicated thread, so logging from worker threads does not serialize them.
+ * Set the environment variable ALICEVISION_LOG_SYNC=1 to write the records from the calling thread instead,
+ * e.g. to get all the records before a crash.
+ */
 class Logger
 {
 public:
@@ -103,6 +112,18 @@ public:
    */
   void setLogLevel(const std::string& level);
 
+  /**
+   * @brief Block until all the pending records are written
+   */
+  void flush();
+
+  /**
+   * @brief Write the pending records and stop the logging thread.
+   *        The next records are written from the calling thread.
+   * @note Called at the end of aliceVision_main, before the static objects are destroyed
+   */
+  void stop();
+
 private:
 
   /**
@@ -117,6 +138,9 @@ private:
   void setLogLevel(const boost::log::trivial::severity_level level);
 
   static std::shared_ptr<Logger> _instance;
+
+  boost::shared_ptr<boost::log::sinks::sink> _sink;
+  bool _asynchronous = true;
 };
 
 } // namespace system
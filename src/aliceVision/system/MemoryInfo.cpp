@@ -13,6 +13,7 @@
 
 #if defined(__WINDOWS__)
 #include <windows.h>
+#include <psapi.h>
 #elif defined(__LINUX__)
 #include <sys/sysinfo.h>
 #include <fstream>
@@ -24,6 +25,8 @@
 #include <mach/mach_types.h>
 #include <mach/mach_init.h>
 #include <mach/mach_host.h>
+#include <mach/task.h>
+#include <mach/task_info.h>
 #else
 #warning "System unrecognized. Can't found memory infos."
 #include <limits>
@@ -53,6 +56,22 @@ unsigned long linuxGetAvailableRam()
     }
     return 0; // nothing found
 }
+
+/// read the given field of /proc/self/status, in bytes
+std::size_t linuxGetProcessStatus(const std::string& field)
+{
+    std::string token;
+    std::ifstream file("/proc/self/status");
+    while(file >> token) {
+        if(token == field) {
+            std::size_t mem;
+            // read in kB and convert to bytes
+            return (file >> mem) ? mem * 1024 : 0;
+        }
+        file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    }
+    return 0;
+}
 #endif
 
 MemoryInfo getMemoryInfo()
@@ -129,6 +148,46 @@ MemoryInfo getMemoryInfo()
     return infos;
 }
 
+ProcessMemoryInfo getProcessMemoryInfo()
+{
+    ProcessMemoryInfo infos;
+
+#if defined(__WINDOWS__)
+    PROCESS_MEMORY_COUNTERS counters;
+    if(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        infos.rss = counters.WorkingSetSize;
+        infos.peakRss = counters.PeakWorkingSetSize;
+    }
+#elif defined(__LINUX__)
+    infos.rss = linuxGetProcessStatus("VmRSS:");
+    infos.peakRss = linuxGetProcessStatus("VmHWM:");
+#elif defined(__APPLE__)
+    mach_task_basic_info_data_t taskInfo;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if(KERN_SUCCESS == task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&taskInfo, &count))
+    {
+        infos.rss = taskInfo.resident_size;
+        infos.peakRss = taskInfo.resident_size_max;
+    }
+#endif
+
+    return infos;
+}
+
+bool resetPeakRss()
+{
+#if defined(__LINUX__)
+    // writing 5 in clear_refs resets the peak RSS of the process (since Linux 4.0), see proc(5)
+    std::ofstream file("/proc/self/clear_refs");
+    file << "5";
+    file.close();
+    return !file.fail();
+#else
+    return false;
+#endif
+}
+
 std::ostream& operator<<(std::ostream& os, const MemoryInfo& infos)
 {
   const double convertionGb = std::pow(2,30);
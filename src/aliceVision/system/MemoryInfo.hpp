@@ -25,6 +25,21 @@ struct MemoryInfo
 
 MemoryInfo getMemoryInfo();
 
+/// the physical memory used by the current process
+struct ProcessMemoryInfo
+{
+    std::size_t rss{0};     //< the current resident set size
+    std::size_t peakRss{0}; //< the resident set size high-water mark, since the process start or the last resetPeakRss()
+};
+
+ProcessMemoryInfo getProcessMemoryInfo();
+
+/**
+ * @brief Reset the resident set size high-water mark of the current process to its current resident set size.
+ * @return false if the high-water mark cannot be reset on this system (only supported on Linux)
+ */
+bool resetPeakRss();
+
 std::ostream& operator<<(std::ostream& os, const MemoryInfo& infos);
 
 }
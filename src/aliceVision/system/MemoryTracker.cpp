@@ -0,0 +1,125 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "MemoryTracker.hpp"
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/MemoryInfo.hpp>
+#include <aliceVision/system/Metrics.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace aliceVision {
+namespace system {
+
+namespace {
+
+const double convertionMb = std::pow(2, 20);
+
+/// fold the given peaks in the output peaks
+void updatePeaks(MemoryTracker::Peaks& out_peaks, const MemoryTracker::Peaks& peaks)
+{
+  if(out_peaks.size() < peaks.size())
+    out_peaks.resize(peaks.size(), 0);
+  for(std::size_t i = 0; i < peaks.size(); ++i)
+    out_peaks[i] = std::max(out_peaks[i], peaks[i]);
+}
+
+} // namespace
+
+AllocationCounter::AllocationCounter(const char* name)
+  : _name(name)
+{
+  MemoryTracker::get().registerCounter(this);
+}
+
+MemoryTracker& MemoryTracker::get()
+{
+  static MemoryTracker tracker;
+  return tracker;
+}
+
+void MemoryTracker::registerCounter(AllocationCounter* counter)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _counters.push_back(counter);
+}
+
+void MemoryTracker::collectPeaks()
+{
+  Peaks peaks(_counters.size() + 1);
+  peaks[0] = static_cast<std::int64_t>(getProcessMemoryInfo().peakRss);
+  resetPeakRss();
+  for(std::size_t i = 0; i < _counters.size(); ++i)
+  {
+    peaks[i + 1] = _counters[i]->peakBytes();
+    _counters[i]->resetPeak();
+  }
+
+  for(Peaks* stagePeaks : _openStages)
+    updatePeaks(*stagePeaks, peaks);
+  updatePeaks(_processPeaks, peaks);
+}
+
+void MemoryTracker::addProfilerCounters() const
+{
+  Profiler& profiler = Profiler::get();
+  if(!profiler.isEnabled())
+    return;
+
+  const double now = profiler.now();
+  profiler.addCounter("RSS", now, getProcessMemoryInfo().rss / convertionMb);
+  for(const AllocationCounter* counter : _counters)
+    profiler.addCounter(counter->name(), now, counter->bytes() / convertionMb);
+}
+
+void MemoryTracker::openStage(Peaks& peaks)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  collectPeaks();
+  peaks.assign(_counters.size() + 1, 0);
+  _openStages.push_back(&peaks);
+  addProfilerCounters();
+}
+
+void MemoryTracker::closeStage(const char* name, Peaks& peaks)
+{
+  std::stringstream log;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    collectPeaks();
+    _openStages.erase(std::find(_openStages.begin(), _openStages.end(), &peaks));
+    addProfilerCounters();
+
+    Metrics& metrics = Metrics::get();
+    const std::string prefix = std::string("memory.") + name + ".";
+    log << "Memory peak of stage '" << name << "': " << peaks[0] / convertionMb << " MB RSS";
+    metrics.addSample(prefix + "peakRss", peaks[0]);
+    for(std::size_t i = 0; i < _counters.size() && i + 1 < peaks.size(); ++i)
+    {
+      if(peaks[i + 1] == 0)
+        continue;
+      log << ", " << peaks[i + 1] / convertionMb << " MB " << _counters[i]->name();
+      metrics.addSample(prefix + _counters[i]->name(), peaks[i + 1]);
+    }
+  }
+  ALICEVISION_LOG_INFO(log.str());
+}
+
+void MemoryTracker::writeMetrics()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  collectPeaks();
+
+  Metrics& metrics = Metrics::get();
+  metrics.setGauge("memory.peakRss", _processPeaks[0]);
+  for(std::size_t i = 0; i < _counters.size(); ++i)
+    metrics.setGauge(std::string("memory.") + _counters[i]->name(), _processPeaks[i + 1]);
+}
+
+} // namespace system
+} // namespace aliceVision
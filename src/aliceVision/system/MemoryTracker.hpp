@@ -0,0 +1,157 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/system/Profiler.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Track the memory of the enclosing scope as a stage of the given name.
+ *        The stage is also a zone of the profiler.
+ * @note The name must be a string literal, or outlive the tracker.
+ */
+#define ALICEVISION_MEMORY_STAGE(name) \
+  const aliceVision::system::MemoryStage ALICEVISION_PROFILE_CONCAT(memoryStage, __LINE__)(name)
+
+namespace aliceVision {
+namespace system {
+
+/**
+ * @brief Count the bytes allocated by a kind of container (e.g. the pinned host memory of the depth map).
+ *        The counters are global objects, registered in the MemoryTracker on construction.
+ */
+class AllocationCounter
+{
+public:
+  /**
+   * @param[in] name The name of the counted allocations, a string literal
+   */
+  explicit AllocationCounter(const char* name);
+
+  AllocationCounter(const AllocationCounter&) = delete;
+  AllocationCounter& operator=(const AllocationCounter&) = delete;
+
+  inline const char* name() const { return _name; }
+
+  /// the currently allocated bytes
+  inline std::int64_t bytes() const { return _bytes.load(std::memory_order_relaxed); }
+
+  /// the maximum of the allocated bytes since the start or the last resetPeak()
+  inline std::int64_t peakBytes() const { return _peakBytes.load(std::memory_order_relaxed); }
+
+  inline void add(std::int64_t bytes)
+  {
+    const std::int64_t current = _bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    std::int64_t peak = _peakBytes.load(std::memory_order_relaxed);
+    while(current > peak && !_peakBytes.compare_exchange_weak(peak, current, std::memory_order_relaxed))
+    {}
+  }
+
+  inline void remove(std::int64_t bytes)
+  {
+    _bytes.fetch_sub(bytes, std::memory_order_relaxed);
+  }
+
+  /// reset the peak to the currently allocated bytes
+  inline void resetPeak()
+  {
+    _peakBytes.store(bytes(), std::memory_order_relaxed);
+  }
+
+private:
+  const char* _name;
+  std::atomic<std::int64_t> _bytes{0};
+  std::atomic<std::int64_t> _peakBytes{0};
+};
+
+/**
+ * @brief Track the peak memory of the stages of a program.
+ *
+ * The peak of a stage is the maximum of the process resident set size and of each AllocationCounter
+ * while the stage is open. The stages can be nested and opened from several threads:
+ * the peaks are collected and reset each time a stage is opened or closed,
+ * then given to all the stages open at this time.
+ * The peaks of a stage are logged and added to the metrics as histograms, as a stage can run several times.
+ * The current memory (in MB) is added to the profiling trace as counters when a stage is opened or closed.
+ */
+class MemoryTracker
+{
+public:
+  /// the memory tracker of the process
+  static MemoryTracker& get();
+
+  /// a memory peak, in bytes, for the process RSS and each allocation counter
+  using Peaks = std::vector<std::int64_t>;
+
+  /**
+   * @brief Open a stage.
+   * @param[in,out] peaks The peaks of the stage, updated until closeStage()
+   */
+  void openStage(Peaks& peaks);
+
+  /**
+   * @brief Close a stage and report its peaks.
+   * @param[in] name The stage name
+   * @param[in,out] peaks The peaks of the stage given to openStage()
+   */
+  void closeStage(const char* name, Peaks& peaks);
+
+  /// add the process peak memory and the peak of each allocation counter to the metrics
+  void writeMetrics();
+
+  void registerCounter(AllocationCounter* counter);
+
+private:
+  MemoryTracker() = default;
+
+  /// collect the current peaks in all the open stages and reset them
+  void collectPeaks();
+
+  /// record the current memory as counters of the profiler
+  void addProfilerCounters() const;
+
+  std::mutex _mutex;
+  std::vector<AllocationCounter*> _counters;
+  std::vector<Peaks*> _openStages;
+  /// the peaks since the start of the process
+  Peaks _processPeaks;
+};
+
+/**
+ * @brief Track the memory of a stage of the MemoryTracker for the lifetime of the object.
+ */
+class MemoryStage
+{
+public:
+  explicit MemoryStage(const char* name)
+    : _name(name)
+    , _zone(name)
+  {
+    MemoryTracker::get().openStage(_peaks);
+  }
+
+  ~MemoryStage()
+  {
+    MemoryTracker::get().closeStage(_name, _peaks);
+  }
+
+  MemoryStage(const MemoryStage&) = delete;
+  MemoryStage& operator=(const MemoryStage&) = delete;
+
+private:
+  const char* _name;
+  MemoryTracker::Peaks _peaks;
+  ProfileZone _zone;
+};
+
+} // namespace system
+} // namespace aliceVision
@@ -0,0 +1,63 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/system/MemoryInfo.hpp>
+#include <aliceVision/system/MemoryTracker.hpp>
+#include <aliceVision/system/Metrics.hpp>
+
+#define BOOST_TEST_MODULE MemoryTracker
+
+#include <boost/test/unit_test.hpp>
+#include <boost/property_tree/json_parser.hpp>
+
+BOOST_AUTO_TEST_CASE(MemoryTracker_processMemory)
+{
+    const aliceVision::system::ProcessMemoryInfo memory = aliceVision::system::getProcessMemoryInfo();
+    BOOST_CHECK_LE(memory.rss, memory.peakRss);
+}
+
+BOOST_AUTO_TEST_CASE(MemoryTracker_stages)
+{
+    using namespace aliceVision::system;
+
+    static AllocationCounter counter("testAllocations");
+
+    Metrics::get().enable("memory tracker test", "memoryTracker_test.json");
+    {
+        ALICEVISION_MEMORY_STAGE("outer");
+        counter.add(100);
+        {
+            ALICEVISION_MEMORY_STAGE("inner");
+            counter.add(400);
+            counter.remove(400);
+        }
+        // the outer stage keeps the peak of the inner stage
+        counter.add(50);
+        counter.remove(150);
+    }
+    {
+        ALICEVISION_MEMORY_STAGE("after");
+        counter.add(10);
+        counter.remove(10);
+    }
+    BOOST_CHECK_EQUAL(counter.bytes(), 0);
+
+    MemoryTracker::get().writeMetrics();
+    BOOST_CHECK(Metrics::get().write());
+
+    boost::property_tree::ptree metrics;
+    boost::property_tree::read_json("memoryTracker_test.json", metrics);
+
+    // the metric names contain '.', use '/' as the path separator of the tree
+    const auto path = [](const std::string& name) { return boost::property_tree::ptree::path_type(name, '/'); };
+    const boost::property_tree::ptree& histograms = metrics.get_child("histograms");
+    BOOST_CHECK_EQUAL(histograms.get<double>(path("memory.outer.testAllocations/max")), 500.0);
+    BOOST_CHECK_EQUAL(histograms.get<double>(path("memory.inner.testAllocations/max")), 500.0);
+    BOOST_CHECK_EQUAL(histograms.get<double>(path("memory.after.testAllocations/max")), 10.0);
+    BOOST_CHECK_GT(histograms.get<double>(path("memory.outer.peakRss/max")), 0.0);
+    BOOST_CHECK_EQUAL(metrics.get<double>(path("gauges/memory.testAllocations")), 500.0);
+    BOOST_CHECK_GE(metrics.get<double>(path("gauges/memory.peakRss")), histograms.get<double>(path("memory.outer.peakRss/max")));
+}
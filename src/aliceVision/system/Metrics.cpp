@@ -0,0 +1,160 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "Metrics.hpp"
+#include <aliceVision/system/Logger.hpp>
+
+#include <boost/property_tree/json_parser.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+
+namespace aliceVision {
+namespace system {
+
+namespace {
+
+/// the bucket of the non-positive samples
+const int nonPositiveBucket = std::numeric_limits<int>::min();
+
+std::string jsonNumber(double value)
+{
+  if(!std::isfinite(value))
+    return "null";
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), "%.*g", std::numeric_limits<double>::max_digits10, value);
+  return buffer;
+}
+
+std::string jsonString(const std::string& value)
+{
+  return "\"" + boost::property_tree::json_parser::create_escapes(value) + "\"";
+}
+
+void writeValues(std::ostream& stream, const std::map<std::string, double>& values)
+{
+  stream << "{";
+  for(auto it = values.begin(); it != values.end(); ++it)
+    stream << (it == values.begin() ? "\n    " : ",\n    ") << jsonString(it->first) << ": " << jsonNumber(it->second);
+  stream << (values.empty() ? "}" : "\n  }");
+}
+
+} // namespace
+
+Metrics& Metrics::get()
+{
+  static Metrics metrics;
+  return metrics;
+}
+
+Metrics::Metrics()
+  : _start(std::chrono::steady_clock::now())
+{}
+
+void Metrics::enable(const std::string& programName, const std::string& metricsFilepath)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _programName = programName;
+  _metricsFilepath = metricsFilepath;
+  _enabled.store(true, std::memory_order_relaxed);
+}
+
+void Metrics::addCounter(const std::string& name, double value)
+{
+  if(!isEnabled())
+    return;
+  std::lock_guard<std::mutex> lock(_mutex);
+  _counters[name] += value;
+}
+
+void Metrics::setGauge(const std::string& name, double value)
+{
+  if(!isEnabled())
+    return;
+  std::lock_guard<std::mutex> lock(_mutex);
+  _gauges[name] = value;
+}
+
+void Metrics::addSample(const std::string& name, double value)
+{
+  if(!isEnabled())
+    return;
+
+  const int bucket = (value > 0.0) ? static_cast<int>(std::ceil(std::log2(value))) : nonPositiveBucket;
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  Histogram& histogram = _histograms[name];
+  histogram.min = (histogram.count == 0) ? value : std::min(histogram.min, value);
+  histogram.max = (histogram.count == 0) ? value : std::max(histogram.max, value);
+  histogram.sum += value;
+  ++histogram.count;
+  ++histogram.buckets[bucket];
+}
+
+bool Metrics::write() const
+{
+  if(!isEnabled() || _metricsFilepath.empty())
+    return true;
+  return write(_metricsFilepath);
+}
+
+bool Metrics::write(const std::string& metricsFilepath) const
+{
+  std::ofstream stream(metricsFilepath);
+  if(!stream.is_open())
+  {
+    ALICEVISION_LOG_ERROR("Cannot write the metrics file '" << metricsFilepath << "'.");
+    return false;
+  }
+
+  const double duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  stream << "{\n"
+         << "  \"program\": " << jsonString(_programName) << ",\n"
+         << "  \"duration\": " << jsonNumber(duration) << ",\n"
+         << "  \"counters\": ";
+  writeValues(stream, _counters);
+  stream << ",\n  \"gauges\": ";
+  writeValues(stream, _gauges);
+  stream << ",\n  \"histograms\": {";
+
+  for(auto it = _histograms.begin(); it != _histograms.end(); ++it)
+  {
+    const Histogram& histogram = it->second;
+    stream << (it == _histograms.begin() ? "\n    " : ",\n    ") << jsonString(it->first) << ": {"
+           << "\"count\": " << histogram.count
+           << ", \"sum\": " << jsonNumber(histogram.sum)
+           << ", \"min\": " << jsonNumber(histogram.min)
+           << ", \"max\": " << jsonNumber(histogram.max)
+           << ", \"mean\": " << jsonNumber(histogram.sum / histogram.count)
+           << ", \"buckets\": {";
+    // the buckets are written by upper bound
+    for(auto bucketIt = histogram.buckets.begin(); bucketIt != histogram.buckets.end(); ++bucketIt)
+    {
+      const double upperBound = (bucketIt->first == nonPositiveBucket) ? 0.0 : std::ldexp(1.0, bucketIt->first);
+      stream << (bucketIt == histogram.buckets.begin() ? "" : ", ") << "\"" << jsonNumber(upperBound) << "\": " << bucketIt->second;
+    }
+    stream << "}}";
+  }
+  stream << (_histograms.empty() ? "}" : "\n  }") << "\n}\n";
+
+  if(!stream.good())
+  {
+    ALICEVISION_LOG_ERROR("Cannot write the metrics file '" << metricsFilepath << "'.");
+    return false;
+  }
+
+  ALICEVISION_LOG_INFO("Metrics written in '" << metricsFilepath << "'.");
+  return true;
+}
+
+} // namespace system
+} // namespace aliceVision
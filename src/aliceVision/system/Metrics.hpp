@@ -0,0 +1,107 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace aliceVision {
+namespace system {
+
+/**
+ * @brief Registry of the performance metrics of a program, written as a JSON file.
+ *
+ * - counters are summed (e.g. the number of extracted features),
+ * - gauges keep their last value (e.g. the number of reconstructed views),
+ * - histograms summarize the distribution of their samples (e.g. the duration of each bundle adjustment),
+ *   with their count, sum, min, max and the count of the samples in each power of two bucket.
+ *
+ * The metrics are only recorded once the registry is enabled, the record functions are thread-safe.
+ */
+class Metrics
+{
+public:
+  /// the metrics of the process
+  static Metrics& get();
+
+  /**
+   * @brief Start recording the metrics, to write at the end of the program.
+   * @param[in] programName The name of the program written in the metrics file
+   * @param[in] metricsFilepath The JSON file written by write()
+   */
+  void enable(const std::string& programName, const std::string& metricsFilepath);
+
+  inline bool isEnabled() const
+  {
+    return _enabled.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Add a value to a counter.
+   * @param[in] name The counter name
+   * @param[in] value The value to add
+   */
+  void addCounter(const std::string& name, double value = 1.0);
+
+  /**
+   * @brief Set the value of a gauge.
+   * @param[in] name The gauge name
+   * @param[in] value The gauge value
+   */
+  void setGauge(const std::string& name, double value);
+
+  /**
+   * @brief Add a sample to a histogram.
+   * @param[in] name The histogram name
+   * @param[in] value The sample value
+   */
+  void addSample(const std::string& name, double value);
+
+  /**
+   * @brief Write the metrics in the JSON file given to enable(), if any.
+   *        The program duration is written with the metrics.
+   * @return false if the file cannot be written
+   */
+  bool write() const;
+
+  /**
+   * @brief Write the metrics in a JSON file.
+   * @param[in] metricsFilepath The output JSON file
+   * @return false if the file cannot be written
+   */
+  bool write(const std::string& metricsFilepath) const;
+
+private:
+  Metrics();
+
+  struct Histogram
+  {
+    std::size_t count = 0;
+    double sum = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+    /// the number of samples by power of two upper bound, the non-positive samples in the bucket 0
+    std::map<int, std::size_t> buckets;
+  };
+
+  std::atomic<bool> _enabled{false};
+  std::string _programName;
+  std::string _metricsFilepath;
+  std::chrono::steady_clock::time_point _start;
+
+  mutable std::mutex _mutex;
+  std::map<std::string, double> _counters;
+  std::map<std::string, double> _gauges;
+  std::map<std::string, Histogram> _histograms;
+};
+
+} // namespace system
+} // namespace aliceVision
@@ -0,0 +1,50 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/system/Metrics.hpp>
+
+#define BOOST_TEST_MODULE Metrics
+
+#include <boost/test/unit_test.hpp>
+#include <boost/property_tree/json_parser.hpp>
+
+BOOST_AUTO_TEST_CASE(Metrics_JSON)
+{
+    using namespace aliceVision::system;
+
+    // the metrics are not recorded before the registry is enabled
+    Metrics::get().addCounter("disabled");
+
+    Metrics::get().enable("metrics test", "metrics_test.json");
+    Metrics::get().addCounter("views");
+    Metrics::get().addCounter("views", 2);
+    Metrics::get().setGauge("landmarks", 10);
+    Metrics::get().setGauge("landmarks", 42);
+    for(const double value : {0.5, 3.0, 4.0, 100.0})
+        Metrics::get().addSample("time", value);
+    BOOST_CHECK(Metrics::get().write());
+
+    boost::property_tree::ptree metrics;
+    boost::property_tree::read_json("metrics_test.json", metrics);
+
+    BOOST_CHECK_EQUAL(metrics.get<std::string>("program"), "metrics test");
+    BOOST_CHECK_GE(metrics.get<double>("duration"), 0.0);
+    BOOST_CHECK(!metrics.get_child("counters").count("disabled"));
+    BOOST_CHECK_EQUAL(metrics.get<double>("counters.views"), 3.0);
+    BOOST_CHECK_EQUAL(metrics.get<double>("gauges.landmarks"), 42.0);
+
+    const boost::property_tree::ptree& histogram = metrics.get_child("histograms.time");
+    BOOST_CHECK_EQUAL(histogram.get<int>("count"), 4);
+    BOOST_CHECK_EQUAL(histogram.get<double>("sum"), 107.5);
+    BOOST_CHECK_EQUAL(histogram.get<double>("min"), 0.5);
+    BOOST_CHECK_EQUAL(histogram.get<double>("max"), 100.0);
+
+    // the samples by power of two upper bound, with '.' as the path separator of the tree
+    const boost::property_tree::ptree& buckets = histogram.get_child("buckets");
+    BOOST_CHECK_EQUAL(buckets.get<int>(boost::property_tree::ptree::path_type("0.5", '/')), 1);
+    BOOST_CHECK_EQUAL(buckets.get<int>("4"), 2);
+    BOOST_CHECK_EQUAL(buckets.get<int>("128"), 1);
+}
@@ -0,0 +1,119 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "Profiler.hpp"
+#include <aliceVision/system/Logger.hpp>
+
+#include <boost/property_tree/json_parser.hpp>
+
+#include <cstdio>
+#include <fstream>
+
+namespace aliceVision {
+namespace system {
+
+Profiler& Profiler::get()
+{
+  static Profiler profiler;
+  return profiler;
+}
+
+Profiler::Profiler()
+  : _start(std::chrono::steady_clock::now())
+{}
+
+void Profiler::enable(const std::string& traceFilepath)
+{
+  _traceFilepath = traceFilepath;
+  _enabled.store(true, std::memory_order_relaxed);
+}
+
+double Profiler::now() const
+{
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - _start).count();
+}
+
+Profiler::ThreadZones& Profiler::threadZones()
+{
+  thread_local ThreadZones* zones = nullptr;
+  if(zones == nullptr)
+  {
+    std::lock_guard<std::mutex> lock(_threadsMutex);
+    _threads.emplace_back(new ThreadZones());
+    zones = _threads.back().get();
+    zones->threadIndex = static_cast<int>(_threads.size());
+  }
+  return *zones;
+}
+
+void Profiler::addZone(const char* name, double start, double end)
+{
+  ThreadZones& zones = threadZones();
+  std::lock_guard<std::mutex> lock(zones.mutex);
+  zones.zones.push_back({name, start, end});
+}
+
+void Profiler::addCounter(const char* name, double time, double value)
+{
+  ThreadZones& zones = threadZones();
+  std::lock_guard<std::mutex> lock(zones.mutex);
+  zones.counters.push_back({name, time, value});
+}
+
+bool Profiler::writeTrace() const
+{
+  if(_traceFilepath.empty())
+    return true;
+  return writeTrace(_traceFilepath);
+}
+
+bool Profiler::writeTrace(const std::string& traceFilepath) const
+{
+  std::ofstream stream(traceFilepath);
+  if(!stream.is_open())
+  {
+    ALICEVISION_LOG_ERROR("Cannot write the profiling trace file '" << traceFilepath << "'.");
+    return false;
+  }
+
+  std::size_t nbEvents = 0;
+  stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  {
+    std::lock_guard<std::mutex> threadsLock(_threadsMutex);
+    char timing[128];
+    for(const auto& thread : _threads)
+    {
+      std::lock_guard<std::mutex> lock(thread->mutex);
+      for(const Zone& zone : thread->zones)
+      {
+        std::snprintf(timing, sizeof(timing), "\"ts\":%.3f,\"dur\":%.3f", zone.start, zone.end - zone.start);
+        stream << (nbEvents++ ? ",\n" : "\n")
+               << "{\"name\":\"" << boost::property_tree::json_parser::create_escapes(std::string(zone.name))
+               << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread->threadIndex << "," << timing << "}";
+      }
+      for(const Counter& counter : thread->counters)
+      {
+        std::snprintf(timing, sizeof(timing), "\"ts\":%.3f,\"args\":{\"value\":%.17g}", counter.time, counter.value);
+        stream << (nbEvents++ ? ",\n" : "\n")
+               << "{\"name\":\"" << boost::property_tree::json_parser::create_escapes(std::string(counter.name))
+               << "\",\"ph\":\"C\",\"pid\":1," << timing << "}";
+      }
+    }
+  }
+  stream << "\n]}\n";
+
+  if(!stream.good())
+  {
+    ALICEVISION_LOG_ERROR("Cannot write the profiling trace file '" << traceFilepath << "'.");
+    return false;
+  }
+
+  ALICEVISION_LOG_INFO("Profiling trace of " << nbEvents << " events written in '" << traceFilepath << "'.");
+  return true;
+}
+
+} // namespace system
+} // namespace aliceVision
@@ -0,0 +1,154 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/system/nvtx.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#define ALICEVISION_PROFILE_CONCAT_IMPL(a, b) a##b
+#define ALICEVISION_PROFILE_CONCAT(a, b) ALICEVISION_PROFILE_CONCAT_IMPL(a, b)
+
+/**
+ * @brief Profile the enclosing scope as a zone of the given name.
+ * @note The name must be a string literal, or outlive the profiler.
+ */
+#define ALICEVISION_PROFILE_ZONE(name) \
+  const aliceVision::system::ProfileZone ALICEVISION_PROFILE_CONCAT(profileZone, __LINE__)(name)
+
+namespace aliceVision {
+namespace system {
+
+/**
+ * @brief Collect the scoped zones of all the threads, and export them as a Chrome trace.
+ *
+ * The zones are only recorded once the profiler is enabled, a disabled zone costs a flag read.
+ * Each thread records its zones in its own buffer, they are merged when the trace is written.
+ * Counters (e.g. the memory usage) can be recorded along the zones, they are displayed as graphs.
+ * The trace is a Chrome trace event JSON file, to open in chrome://tracing or ui.perfetto.dev.
+ */
+class Profiler
+{
+public:
+  /// the profiler of the process
+  static Profiler& get();
+
+  /**
+   * @brief Start recording the zones, to write at the end of the command line.
+   * @param[in] traceFilepath The Chrome trace file written by writeTrace()
+   */
+  void enable(const std::string& traceFilepath);
+
+  inline bool isEnabled() const
+  {
+    return _enabled.load(std::memory_order_relaxed);
+  }
+
+  /// the time since the start of the process in microseconds
+  double now() const;
+
+  /**
+   * @brief Record a zone of the calling thread.
+   * @param[in] name The zone name
+   * @param[in] start The start time in microseconds
+   * @param[in] end The end time in microseconds
+   */
+  void addZone(const char* name, double start, double end);
+
+  /**
+   * @brief Record a value of a counter.
+   * @param[in] name The counter name, a string literal or a string that outlives the profiler
+   * @param[in] time The time of the value in microseconds
+   * @param[in] value The counter value
+   */
+  void addCounter(const char* name, double time, double value);
+
+  /**
+   * @brief Write the recorded zones in the Chrome trace file given to enable(), if any.
+   * @return false if the file cannot be written
+   */
+  bool writeTrace() const;
+
+  /**
+   * @brief Write the recorded zones in a Chrome trace file.
+   * @param[in] traceFilepath The output JSON file
+   * @return false if the file cannot be written
+   */
+  bool writeTrace(const std::string& traceFilepath) const;
+
+private:
+  Profiler();
+
+  struct Zone
+  {
+    const char* name;
+    double start;
+    double end;
+  };
+
+  struct Counter
+  {
+    const char* name;
+    double time;
+    double value;
+  };
+
+  /// the zones of a thread, the mutex is only shared with writeTrace()
+  struct ThreadZones
+  {
+    int threadIndex;
+    std::mutex mutex;
+    std::vector<Zone> zones;
+    std::vector<Counter> counters;
+  };
+
+  ThreadZones& threadZones();
+
+  std::atomic<bool> _enabled{false};
+  std::string _traceFilepath;
+  std::chrono::steady_clock::time_point _start;
+
+  mutable std::mutex _threadsMutex;
+  std::vector<std::unique_ptr<ThreadZones>> _threads;
+};
+
+/**
+ * @brief Record a zone of the profiler for the lifetime of the object.
+ *        The zone is also a NVTX range when AliceVision is built with ALICEVISION_USE_NVTX.
+ */
+class ProfileZone
+{
+public:
+  explicit ProfileZone(const char* name)
+    : _name(name)
+    , _start(Profiler::get().isEnabled() ? Profiler::get().now() : -1.0)
+  {
+    nvtxPush(name);
+  }
+
+  ~ProfileZone()
+  {
+    nvtxPop(_name);
+    if(_start >= 0.0)
+      Profiler::get().addZone(_name, _start, Profiler::get().now());
+  }
+
+  ProfileZone(const ProfileZone&) = delete;
+  ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+  const char* _name;
+  const double _start;
+};
+
+} // namespace system
+} // namespace aliceVision
@@ -0,0 +1,53 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/system/Profiler.hpp>
+
+#define BOOST_TEST_MODULE Profiler
+
+#include <boost/test/unit_test.hpp>
+#include <boost/property_tree/json_parser.hpp>
+
+#include <set>
+#include <thread>
+
+BOOST_AUTO_TEST_CASE(Profiler_ChromeTrace)
+{
+    using namespace aliceVision::system;
+
+    // zones are not recorded before the profiler is enabled
+    {
+        ALICEVISION_PROFILE_ZONE("disabled");
+    }
+
+    Profiler::get().enable("profiler_test_trace.json");
+    {
+        ALICEVISION_PROFILE_ZONE("outer");
+        std::thread thread([]()
+        {
+            ALICEVISION_PROFILE_ZONE("thread");
+        });
+        thread.join();
+        ALICEVISION_PROFILE_ZONE("inner");
+    }
+    BOOST_CHECK(Profiler::get().writeTrace());
+
+    boost::property_tree::ptree trace;
+    boost::property_tree::read_json("profiler_test_trace.json", trace);
+
+    std::set<std::string> names;
+    std::set<int> threads;
+    for(const auto& event : trace.get_child("traceEvents"))
+    {
+        names.insert(event.second.get<std::string>("name"));
+        threads.insert(event.second.get<int>("tid"));
+        BOOST_CHECK_EQUAL(event.second.get<std::string>("ph"), "X");
+        BOOST_CHECK_GE(event.second.get<double>("dur"), 0.0);
+    }
+
+    BOOST_CHECK(names == std::set<std::string>({"outer", "inner", "thread"}));
+    BOOST_CHECK_EQUAL(threads.size(), 2);
+}
@@ -6,7 +6,12 @@
 
 #include "ProgressDisplay.hpp"
 #include <boost/timer/progress_display.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <mutex>
+#include <thread>
 
 namespace aliceVision {
 namespace system {
@@ -24,6 +29,10 @@ public:
 ProgressDisplay::ProgressDisplay() : _impl{std::make_shared<ProgressDisplayImplEmpty>()}
 {}
 
+/**
+ * The increments only update an atomic counter, so they can be done in hot parallel loops.
+ * The bar is drawn by a reporter thread, woken up periodically or when the expected count is reached.
+ */
 class ProgressDisplayImplBoostProgress : public ProgressDisplayImpl {
 public:
     ProgressDisplayImplBoostProgress(unsigned long expectedCount,
@@ -31,39 +40,88 @@ public:
                                      const std::string& s1,
                                      const std::string& s2,
                                      const std::string& s3) :
+        _expectedCount{expectedCount},
         _display{expectedCount, os, s1, s2, s3}
     {
+        _reporter = std::thread(&ProgressDisplayImplBoostProgress::report, this);
     }
 
-    ~ProgressDisplayImplBoostProgress() override = default;
+    ~ProgressDisplayImplBoostProgress() override
+    {
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+            _stop = true;
+        }
+        _condition.notify_one();
+        _reporter.join();
+    }
 
     void restart(unsigned long expectedCount) override
     {
+        std::lock_guard<std::mutex> lock{_mutex};
+        _count = 0;
+        _expectedCount = expectedCount;
+        _displayedCount = 0;
         _display.restart(expectedCount);
     }
 
     void increment(unsigned long count) override
     {
-        std::lock_guard<std::mutex> lock{_mutex};
-        _display += count;
+        const unsigned long previousCount = _count.fetch_add(count, std::memory_order_relaxed);
+        const unsigned long expectedCount = _expectedCount.load(std::memory_order_relaxed);
+
+        // do not wait for the next refresh to complete the bar
+        if(previousCount < expectedCount && previousCount + count >= expectedCount)
+            _condition.notify_one();
     }
 
     unsigned long count() override
     {
-        std::lock_guard<std::mutex> lock{_mutex};
-        return _display.count();
+        return _count.load(std::memory_order_relaxed);
     }
 
     unsigned long expectedCount() override
     {
-        return _display.expected_count();
+        return _expectedCount.load(std::memory_order_relaxed);
     }
 
 private:
+    void report()
+    {
+        std::unique_lock<std::mutex> lock{_mutex};
+        while(!_stop)
+        {
+            _condition.wait_for(lock, refreshPeriod);
+            update();
+        }
+        update();
+    }
+
+    // must be called with the mutex locked
+    void update()
+    {
+        // boost::timer::progress_display only ends the bar if the expected count is reached exactly
+        const unsigned long count = std::min(_count.load(std::memory_order_relaxed), _expectedCount.load(std::memory_order_relaxed));
+        if(count > _displayedCount)
+        {
+            _display += count - _displayedCount;
+            _displayedCount = count;
+        }
+    }
+
+    static constexpr std::chrono::milliseconds refreshPeriod{100};
+
+    std::atomic<unsigned long> _count{0};
+    std::atomic<unsigned long> _expectedCount;
+    unsigned long _displayedCount = 0;
+    bool _stop = false;
     std::mutex _mutex;
+    std::condition_variable _condition;
     boost::timer::progress_display _display;
+    std::thread _reporter;
 };
 
+constexpr std::chrono::milliseconds ProgressDisplayImplBoostProgress::refreshPeriod;
 
 ProgressDisplay createConsoleProgressDisplay(unsigned long expectedCount,
                                              std::ostream& os,
@@ -29,6 +29,8 @@ public:
  * The API is essentially the same as boost::timer::progress_display
  *
  * For ease of use value semantics are exposed.
+ *
+ * The increments are lock-free, the console output is refreshed by a separate thread.
  */
 class ProgressDisplay {
 public:
@@ -40,13 +42,13 @@ public:
         _impl->restart(expectedCount);
     }
 
-    // Thread safe with respect to other calls to operator++ and to calls to count()
+    // Thread safe and lock-free with respect to other calls to operator++ and to calls to count()
     void operator++()
     {
         _impl->increment(1);
     }
 
-    // Thread safe with respect to other calls to operator++ and to calls to count()
+    // Thread safe and lock-free with respect to other calls to operator++ and to calls to count()
     void operator+=(unsigned long increment)
     {
         _impl->increment(increment);
@@ -0,0 +1,61 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/system/ProgressDisplay.hpp>
+
+#define BOOST_TEST_MODULE ProgressDisplay
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace aliceVision;
+
+BOOST_AUTO_TEST_CASE(ProgressDisplay_concurrentIncrements)
+{
+    const unsigned long nbThreads = 4;
+    const unsigned long nbIncrementsPerThread = 10000;
+
+    std::ostringstream os;
+    {
+        system::ProgressDisplay progressDisplay = system::createConsoleProgressDisplay(nbThreads * nbIncrementsPerThread, os);
+
+        std::vector<std::thread> threads;
+        for(unsigned long t = 0; t < nbThreads; ++t)
+        {
+            threads.emplace_back([&]() {
+                for(unsigned long i = 0; i < nbIncrementsPerThread; ++i)
+                    ++progressDisplay;
+            });
+        }
+        for(std::thread& thread : threads)
+            thread.join();
+
+        BOOST_CHECK_EQUAL(progressDisplay.count(), nbThreads * nbIncrementsPerThread);
+        BOOST_CHECK_EQUAL(progressDisplay.expectedCount(), nbThreads * nbIncrementsPerThread);
+    }
+
+    // the bar is complete once the display is destroyed
+    const std::string output = os.str();
+    BOOST_CHECK_EQUAL(std::count(output.begin(), output.end(), '*'), 51);
+    BOOST_CHECK_EQUAL(output.back(), '\n');
+}
+
+BOOST_AUTO_TEST_CASE(ProgressDisplay_overshoot)
+{
+    std::ostringstream os;
+    {
+        system::ProgressDisplay progressDisplay = system::createConsoleProgressDisplay(10, os);
+        progressDisplay += 25;
+        BOOST_CHECK_EQUAL(progressDisplay.count(), 25);
+    }
+
+    const std::string output = os.str();
+    BOOST_CHECK_EQUAL(std::count(output.begin(), output.end(), '*'), 51);
+}
@@ -0,0 +1,242 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "TaskScheduler.hpp"
+#include "cpu.hpp"
+
+#include <aliceVision/alicevision_omp.hpp>
+
+namespace aliceVision {
+namespace system {
+
+namespace {
+
+std::mutex instanceMutex;
+std::unique_ptr<TaskScheduler> instance;
+
+// the scheduler and the queue index of the current compute thread
+thread_local TaskScheduler* currentScheduler = nullptr;
+thread_local int currentWorkerId = -1;
+
+} // namespace
+
+TaskScheduler::TaskScheduler(int nbThreads, int nbIOThreads)
+{
+    nbThreads = std::max(nbThreads, 1);
+    nbIOThreads = std::max(nbIOThreads, 1);
+
+    for(int i = 0; i < nbThreads + 1; ++i)
+        _queues.emplace_back(new TaskQueue());
+
+    for(int i = 0; i < nbThreads; ++i)
+        _workers.emplace_back(&TaskScheduler::workerLoop, this, i);
+
+    for(int i = 0; i < nbIOThreads; ++i)
+        _ioWorkers.emplace_back(&TaskScheduler::ioWorkerLoop, this);
+}
+
+TaskScheduler::~TaskScheduler()
+{
+    {
+        std::lock_guard<std::mutex> sleepLock(_sleepMutex);
+        std::lock_guard<std::mutex> ioLock(_ioQueue.mutex);
+        _stop = true;
+    }
+    _sleepCondition.notify_all();
+    _ioCondition.notify_all();
+
+    for(std::thread& worker : _workers)
+        worker.join();
+    for(std::thread& worker : _ioWorkers)
+        worker.join();
+}
+
+TaskScheduler& TaskScheduler::getInstance()
+{
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    if(!instance)
+        instance.reset(new TaskScheduler(get_total_cpus()));
+    return *instance;
+}
+
+void TaskScheduler::setup(int nbThreads, int nbIOThreads)
+{
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    if(instance && instance->getNbThreads() == std::max(nbThreads, 1) && instance->getNbIOThreads() == std::max(nbIOThreads, 1))
+        return;
+    instance.reset();
+    instance.reset(new TaskScheduler(nbThreads, nbIOThreads));
+}
+
+TaskScheduler& TaskScheduler::getCurrent()
+{
+    if(currentScheduler)
+        return *currentScheduler;
+    return getInstance();
+}
+
+int TaskScheduler::getCurrentWorkerId() const
+{
+    return (currentScheduler == this) ? currentWorkerId : -1;
+}
+
+void TaskScheduler::push(Task task)
+{
+    const int workerId = getCurrentWorkerId();
+    TaskQueue& queue = *_queues[(workerId >= 0) ? workerId : _workers.size()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    {
+        // under the sleep mutex, so an idle thread cannot miss the notification
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        ++_nbQueuedTasks;
+    }
+    _sleepCondition.notify_one();
+}
+
+void TaskScheduler::pushIO(Task task)
+{
+    {
+        std::lock_guard<std::mutex> lock(_ioQueue.mutex);
+        _ioQueue.tasks.push_back(std::move(task));
+    }
+    _ioCondition.notify_one();
+}
+
+bool TaskScheduler::runOwnTask(int workerId)
+{
+    Task task;
+    {
+        TaskQueue& queue = *_queues[workerId];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if(queue.tasks.empty())
+            return false;
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+    }
+    --_nbQueuedTasks;
+    task();
+    return true;
+}
+
+bool TaskScheduler::runAnyTask(int workerId)
+{
+    if(runOwnTask(workerId))
+        return true;
+
+    // the shared queue first, then steal the oldest task of the other threads
+    const int nbQueues = static_cast<int>(_queues.size());
+    for(int i = 0; i < nbQueues - 1; ++i)
+    {
+        const int queueId = (i == 0) ? nbQueues - 1 : (workerId + i) % (nbQueues - 1);
+
+        Task task;
+        {
+            TaskQueue& queue = *_queues[queueId];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if(queue.tasks.empty())
+                continue;
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        --_nbQueuedTasks;
+        task();
+        return true;
+    }
+    return false;
+}
+
+void TaskScheduler::workerLoop(int workerId)
+{
+    currentScheduler = this;
+    currentWorkerId = workerId;
+    // the parallelism comes from the tasks, an OpenMP region in a task would oversubscribe the cores
+    omp_set_num_threads(1);
+
+    while(true)
+    {
+        if(runAnyTask(workerId))
+            continue;
+
+        std::unique_lock<std::mutex> lock(_sleepMutex);
+        _sleepCondition.wait(lock, [this]() { return _stop || _nbQueuedTasks > 0; });
+        if(_stop && _nbQueuedTasks == 0)
+            return;
+    }
+}
+
+void TaskScheduler::ioWorkerLoop()
+{
+    while(true)
+    {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(_ioQueue.mutex);
+            _ioCondition.wait(lock, [this]() { return _stop || !_ioQueue.tasks.empty(); });
+            if(_ioQueue.tasks.empty())
+                return;
+            task = std::move(_ioQueue.tasks.front());
+            _ioQueue.tasks.pop_front();
+        }
+        task();
+    }
+}
+
+TaskGroup::~TaskGroup()
+{
+    try
+    {
+        wait();
+    }
+    catch(...)
+    {
+    }
+}
+
+void TaskGroup::wait()
+{
+    const int workerId = _scheduler.getCurrentWorkerId();
+    if(workerId >= 0)
+    {
+        // only the tasks created by this thread, the group tasks stolen by the other threads are waited below
+        while(_nbPendingTasks > 0 && _scheduler.runOwnTask(workerId))
+        {
+        }
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _doneCondition.wait(lock, [this]() { return _nbPendingTasks == 0; });
+    }
+
+    if(_hasError)
+    {
+        std::exception_ptr error;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            std::swap(error, _error);
+        }
+        _hasError = false;
+        std::rethrow_exception(error);
+    }
+}
+
+void TaskGroup::onTaskDone(std::exception_ptr error)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if(error && !_error)
+    {
+        _error = error;
+        _hasError = true;
+    }
+    if(--_nbPendingTasks == 0)
+        _doneCondition.notify_all();
+}
+
+} // namespace system
+} // namespace aliceVision
@@ -0,0 +1,223 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace aliceVision {
+namespace system {
+
+/**
+ * @brief Work-stealing scheduler of the compute tasks, with a few more threads for the tasks blocking on IO.
+ *
+ * Each compute thread has its own queue: the tasks created by a task are pushed on the queue of its thread,
+ * and the idle threads steal the oldest tasks of the other queues. So the nested parallel loops share the same
+ * threads instead of creating new ones. The OpenMP regions inside the tasks run on a single thread.
+ * The tasks are submitted through a TaskGroup.
+ */
+class TaskScheduler
+{
+public:
+    /**
+     * @param[in] nbThreads number of compute threads
+     * @param[in] nbIOThreads number of threads of the tasks waiting on IO (or on a device)
+     */
+    explicit TaskScheduler(int nbThreads, int nbIOThreads = 2);
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    /// Wait for the queued tasks and stop the threads
+    ~TaskScheduler();
+
+    /**
+     * @brief Get the global scheduler, with one compute thread per core unless set up by setup()
+     */
+    static TaskScheduler& getInstance();
+
+    /**
+     * @brief Replace the global scheduler (see HardwareContext::setupThreads)
+     *        It must not be called while tasks are running on the global scheduler.
+     */
+    static void setup(int nbThreads, int nbIOThreads = 2);
+
+    /**
+     * @brief Get the scheduler of the current thread if it is a compute thread, the global scheduler otherwise
+     */
+    static TaskScheduler& getCurrent();
+
+    int getNbThreads() const { return static_cast<int>(_workers.size()); }
+    int getNbIOThreads() const { return static_cast<int>(_ioWorkers.size()); }
+
+private:
+    friend class TaskGroup;
+
+    using Task = std::function<void()>;
+
+    struct TaskQueue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    /// Push a compute task on the queue of the current thread (or on the shared queue)
+    void push(Task task);
+    void pushIO(Task task);
+
+    /// Index of the queue of the current thread, -1 if it is not a compute thread of this scheduler
+    int getCurrentWorkerId() const;
+
+    /// Run the most recent task of the queue of the current compute thread
+    bool runOwnTask(int workerId);
+
+    /// Run a task of the queue of the current thread, of the shared queue or stolen from another thread
+    bool runAnyTask(int workerId);
+
+    void workerLoop(int workerId);
+    void ioWorkerLoop();
+
+    /// one queue per compute thread, then the shared queue of the tasks submitted by the other threads
+    std::vector<std::unique_ptr<TaskQueue>> _queues;
+    std::vector<std::thread> _workers;
+    std::atomic<int> _nbQueuedTasks{0};
+    std::mutex _sleepMutex;
+    std::condition_variable _sleepCondition;
+
+    TaskQueue _ioQueue;
+    std::vector<std::thread> _ioWorkers;
+    std::condition_variable _ioCondition;
+
+    bool _stop = false;
+};
+
+/**
+ * @brief Group of tasks waited together.
+ *
+ * A compute thread waiting for a group runs the tasks of its own queue meanwhile (its nested tasks),
+ * but never steals unrelated tasks which could wait for it. The first error of a task is rethrown by wait(),
+ * the tasks of the group not yet started are then skipped.
+ */
+class TaskGroup
+{
+public:
+    explicit TaskGroup(TaskScheduler& scheduler = TaskScheduler::getCurrent())
+      : _scheduler(scheduler)
+    {}
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    /// Wait for the tasks, their errors are ignored
+    ~TaskGroup();
+
+    /// Run a compute task
+    template <typename Func>
+    void run(Func&& func)
+    {
+        _scheduler.push(makeTask(std::forward<Func>(func)));
+    }
+
+    /// Run a task mostly waiting on IO (or on a device), outside the compute threads
+    template <typename Func>
+    void runIO(Func&& func)
+    {
+        _scheduler.pushIO(makeTask(std::forward<Func>(func)));
+    }
+
+    /**
+     * @brief Wait for all the tasks of the group
+     * @throw the first exception thrown by a task
+     */
+    void wait();
+
+private:
+    template <typename Func>
+    TaskScheduler::Task makeTask(Func&& func)
+    {
+        ++_nbPendingTasks;
+        return [this, func = std::forward<Func>(func)]() mutable {
+            std::exception_ptr error;
+            if(!_hasError)
+            {
+                try
+                {
+                    func();
+                }
+                catch(...)
+                {
+                    error = std::current_exception();
+                }
+            }
+            onTaskDone(error);
+        };
+    }
+
+    void onTaskDone(std::exception_ptr error);
+
+    TaskScheduler& _scheduler;
+    std::atomic<int> _nbPendingTasks{0};
+    std::atomic<bool> _hasError{false};
+    std::exception_ptr _error;
+    std::mutex _mutex;
+    std::condition_variable _doneCondition;
+};
+
+/**
+ * @brief Call func(chunkBegin, chunkEnd) on contiguous chunks of [begin, end) in parallel
+ * @param[in] grainSize the number of indexes of a chunk, 0 to split the range in a few chunks per thread
+ */
+template <typename Func>
+void parallelForChunks(std::ptrdiff_t begin, std::ptrdiff_t end, Func&& func, std::ptrdiff_t grainSize = 0)
+{
+    if(begin >= end)
+        return;
+
+    TaskScheduler& scheduler = TaskScheduler::getCurrent();
+    const std::ptrdiff_t size = end - begin;
+    if(grainSize <= 0)
+        grainSize = std::max(std::ptrdiff_t(1), size / (4 * scheduler.getNbThreads()));
+
+    if(size <= grainSize || scheduler.getNbThreads() <= 1)
+    {
+        func(begin, end);
+        return;
+    }
+
+    TaskGroup group(scheduler);
+    for(std::ptrdiff_t chunkBegin = begin; chunkBegin < end; chunkBegin += std::min(grainSize, end - chunkBegin))
+    {
+        const std::ptrdiff_t chunkEnd = chunkBegin + std::min(grainSize, end - chunkBegin);
+        group.run([&func, chunkBegin, chunkEnd]() { func(chunkBegin, chunkEnd); });
+    }
+    group.wait();
+}
+
+/**
+ * @brief Call func(i) for each i in [begin, end) in parallel
+ * @param[in] grainSize the number of indexes of a task, 0 to split the range in a few tasks per thread
+ */
+template <typename Func>
+void parallelFor(std::ptrdiff_t begin, std::ptrdiff_t end, Func&& func, std::ptrdiff_t grainSize = 0)
+{
+    parallelForChunks(begin, end, [&func](std::ptrdiff_t chunkBegin, std::ptrdiff_t chunkEnd) {
+        for(std::ptrdiff_t i = chunkBegin; i < chunkEnd; ++i)
+            func(i);
+    }, grainSize);
+}
+
+} // namespace system
+} // namespace aliceVision
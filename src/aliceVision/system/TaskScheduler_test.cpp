@@ -0,0 +1,82 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/system/TaskScheduler.hpp>
+
+#define BOOST_TEST_MODULE TaskScheduler
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+using namespace aliceVision::system;
+
+BOOST_AUTO_TEST_CASE(TaskScheduler_parallelFor)
+{
+    TaskScheduler::setup(4);
+
+    std::vector<int> values(10000, 0);
+    parallelFor(0, values.size(), [&](std::ptrdiff_t i) { values[i] = static_cast<int>(i); });
+
+    for(std::size_t i = 0; i < values.size(); ++i)
+        BOOST_CHECK_EQUAL(values[i], static_cast<int>(i));
+}
+
+BOOST_AUTO_TEST_CASE(TaskScheduler_nested)
+{
+    TaskScheduler::setup(2);
+
+    // more nested loops than threads, the waiting threads run their own chunks
+    std::atomic<int> count(0);
+    parallelFor(0, 16, [&](std::ptrdiff_t) {
+        parallelFor(0, 16, [&](std::ptrdiff_t) {
+            parallelFor(0, 16, [&](std::ptrdiff_t) { ++count; }, 1);
+        }, 1);
+    }, 1);
+
+    BOOST_CHECK_EQUAL(count, 16 * 16 * 16);
+}
+
+BOOST_AUTO_TEST_CASE(TaskScheduler_groupIO)
+{
+    TaskScheduler::setup(2, 1);
+
+    std::atomic<int> nbCompute(0);
+    std::atomic<int> nbIO(0);
+    TaskGroup group;
+    for(int i = 0; i < 8; ++i)
+    {
+        group.run([&]() { ++nbCompute; });
+        group.runIO([&]() { ++nbIO; });
+    }
+    group.wait();
+
+    BOOST_CHECK_EQUAL(nbCompute, 8);
+    BOOST_CHECK_EQUAL(nbIO, 8);
+}
+
+BOOST_AUTO_TEST_CASE(TaskScheduler_error)
+{
+    TaskScheduler::setup(2);
+
+    TaskGroup group;
+    group.run([]() { throw std::runtime_error("task error"); });
+    BOOST_CHECK_THROW(group.wait(), std::runtime_error);
+
+    // the group can be reused once the error is rethrown
+    bool done = false;
+    group.run([&]() { done = true; });
+    BOOST_CHECK_NO_THROW(group.wait());
+    BOOST_CHECK(done);
+
+    BOOST_CHECK_THROW(parallelFor(0, 100, [](std::ptrdiff_t i) {
+        if(i == 42)
+            throw std::runtime_error("loop error");
+    }, 1), std::runtime_error);
+}
@@ -9,10 +9,16 @@ namespace aliceVision {
 bool CmdLine::execute(int argc, char** argv)
 {
     std::string verboseLevel = system::EVerboseLevel_enumToString(system::Logger::getDefaultVerboseLevel());
+    std::string profileTraceFilepath;
+    std::string metricsFilepath;
 
     boost::program_options::options_description logParams("Log parameters");
     logParams.add_options()
-        ("verboseLevel,v", boost::program_options::value<std::string>(&verboseLevel)->default_value(verboseLevel), "verbosity level (fatal, error, warning, info, debug, trace).");
+        ("verboseLevel,v", boost::program_options::value<std::string>(&verboseLevel)->default_value(verboseLevel), "verbosity level (fatal, error, warning, info, debug, trace).")
+        ("profileTrace", boost::program_options::value<std::string>(&profileTraceFilepath)->default_value(profileTraceFilepath),
+         "Profile the main stages and write them in this Chrome trace JSON file (open it in chrome://tracing or ui.perfetto.dev).")
+        ("metricsFile", boost::program_options::value<std::string>(&metricsFilepath)->default_value(metricsFilepath),
+         "Write the performance metrics (counters, gauges and histograms) of the program in this JSON file.");
 
     _allParams.add(logParams);
 
@@ -52,6 +58,12 @@ bool CmdLine::execute(int argc, char** argv)
     // set verbose level
     system::Logger::get()->setLogLevel(verboseLevel);
 
+    if(!profileTraceFilepath.empty())
+        system::Profiler::get().enable(profileTraceFilepath);
+
+    if(!metricsFilepath.empty())
+        system::Metrics::get().enable(_name, metricsFilepath);
+
     _hContext.displayHardware();
 
     return true;
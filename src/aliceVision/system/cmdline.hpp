@@ -7,6 +7,8 @@
 #pragma once
 
 #include "Logger.hpp"
+#include "Metrics.hpp"
+#include "Profiler.hpp"
 #include "Timer.hpp"
 #include "hardwareContext.hpp"
 
@@ -171,6 +173,7 @@ class CmdLine
 {
 public:
     CmdLine(const std::string& name) :
+        _name(name),
         _allParams(name)
     {
     }
@@ -188,6 +191,7 @@ public:
     }
 
 private:
+    std::string _name;
     boost::program_options::options_description _allParams;
     HardwareContext _hContext;
 };
@@ -2,6 +2,7 @@
 
 #include "cpu.hpp"
 #include "MemoryInfo.hpp"
+#include "TaskScheduler.hpp"
 #include <aliceVision/alicevision_omp.hpp>
 
 namespace aliceVision {
@@ -10,7 +11,14 @@ void HardwareContext::setupFromCommandLine(boost::program_options::options_descr
 {
     options.add_options()
         ("maxMemoryAvailable", boost::program_options::value<size_t>(&_maxUserMemoryAvailable)->default_value(_maxUserMemoryAvailable), "User specified available RAM")
-        ("maxCoresAvailable", boost::program_options::value<unsigned int>(&_maxUserCoresAvailable)->default_value(_maxUserCoresAvailable), "User specified available number of cores");
+        ("maxCoresAvailable", boost::program_options::value<unsigned int>(&_maxUserCoresAvailable)->default_value(_maxUserCoresAvailable), "User specified available number of cores")
+        ("maxGpusAvailable", boost::program_options::value<unsigned int>(&_maxUserGpusAvailable)->default_value(_maxUserGpusAvailable), "User specified available number of GPU devices")
+        ("maxJobsPerGpu", boost::program_options::value<int>(&_maxJobsPerGpu)->default_value(_maxJobsPerGpu), "Maximum number of jobs of all the applications of the machine sharing a GPU device")
+        ("threadsPinning", boost::program_options::value<system::EThreadsPinning>(&_threadsPinning)->default_value(_threadsPinning),
+         "Threads pinning on the NUMA nodes (sockets) of the machine:\n"
+         " * none: the threads are scheduled by the OS\n"
+         " * node: the threads are split between the nodes, each thread can run on all the cores of its node\n"
+         " * core: each thread is pinned to one core, the cores are taken node after node");
 }
 
 void HardwareContext::displayHardware()
@@ -19,6 +27,8 @@ void HardwareContext::displayHardware()
     
     std::cout << "\tDetected core count : " << system::get_total_cpus() << std::endl;
 
+    std::cout << "\tDetected NUMA node count : " << system::getNumaNodesCpus().size() << std::endl;
+
     if (_maxUserCoresAvailable < std::numeric_limits<unsigned int>::max())
     {
         std::cout << "\tUser upper limit on core count : " << _maxUserCoresAvailable << std::endl;
@@ -35,6 +45,13 @@ void HardwareContext::displayHardware()
         std::cout << "\tUser upper limit on memory available : " << _maxUserMemoryAvailable / (1024 * 1024) << " Mo" << std::endl;
     }
 
+    if (_maxUserGpusAvailable < std::numeric_limits<unsigned int>::max())
+    {
+        std::cout << "\tUser upper limit on GPU device count : " << _maxUserGpusAvailable << std::endl;
+    }
+
+    std::cout << "\tMaximum number of jobs per GPU device : " << _maxJobsPerGpu << std::endl;
+
     std::cout << std::endl;
 }
 
@@ -58,4 +75,12 @@ unsigned int HardwareContext::getMaxThreads() const
     return count;
 }
 
-}
\ No newline at end of file
+void HardwareContext::setupThreads() const
+{
+    const unsigned int nbThreads = getMaxThreads();
+    omp_set_num_threads(nbThreads);
+    system::pinOpenMPThreads(_threadsPinning, nbThreads);
+    system::TaskScheduler::setup(nbThreads);
+}
+
+}
@@ -8,6 +8,7 @@
 
 #include "Logger.hpp"
 #include "Timer.hpp"
+#include "numa.hpp"
 
 #include <boost/program_options/options_description.hpp>
 
@@ -33,10 +34,34 @@ public:
         _limitUserCores = coresLimit;
     }
 
+    /// Maximum number of GPU devices used by this application
+    unsigned int getUserMaxGpusAvailable() const
+    {
+        return _maxUserGpusAvailable;
+    }
+
+    /// Maximum number of jobs of all the applications of the machine sharing a GPU device
+    int getMaxJobsPerGpu() const
+    {
+        return _maxJobsPerGpu;
+    }
+
+    /// Threads pinning policy on the NUMA nodes
+    system::EThreadsPinning getThreadsPinning() const
+    {
+        return _threadsPinning;
+    }
+
     void setupFromCommandLine(boost::program_options::options_description & options);
 
     unsigned int getMaxThreads() const;
 
+    /**
+     * @brief Set the number of OpenMP threads and of the system::TaskScheduler threads to getMaxThreads(),
+     *        and pin the OpenMP threads with the user threads pinning policy
+     */
+    void setupThreads() const;
+
 private:
     /**
      * @brief This is the maximum memory available 
@@ -57,6 +82,25 @@ private:
      * The value will only be used if less than the _maxUserCoresAvailable value
      */
     unsigned int _limitUserCores = std::numeric_limits<unsigned int>::max();
+
+    /**
+     * @brief This is the maximum number of GPU devices available to this application
+     * This information is passed to the application through command line parameters
+     * to partition the devices between the applications running on the same machine
+     */
+    unsigned int _maxUserGpusAvailable = std::numeric_limits<unsigned int>::max();
+
+    /**
+     * @brief This is the maximum number of jobs, of all the applications of the machine, running on a GPU device
+     * A new job waits for a device with less jobs (see gpu::GpuResourceManager)
+     */
+    int _maxJobsPerGpu = 1;
+
+    /**
+     * @brief This is the threads pinning policy on the NUMA nodes (sockets) of the machine
+     * This information is passed to the application through command line parameters
+     */
+    system::EThreadsPinning _threadsPinning = system::EThreadsPinning::NONE;
 };
 
 }
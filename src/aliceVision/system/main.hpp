@@ -9,7 +9,8 @@
 /**
  * @file \c main() function wrapper
  * Provides an implementation of \c main() that automatically catches and logs
- * otherwise unhandled exceptions.
+ * otherwise unhandled exceptions, and writes the profiling trace and the metrics
+ * file (with the memory peaks) and the pending log records once the program ends.
  *
  * To use this wrapper you need to change your source file containing \c main() as such:
  * 1. Include this header
@@ -17,6 +18,9 @@
  */
 
 #include "Logger.hpp"
+#include "MemoryTracker.hpp"
+#include "Metrics.hpp"
+#include "Profiler.hpp"
 
 #include <stdexcept>
 
@@ -32,9 +36,10 @@ int aliceVision_main(int argc, char* argv[]);
  * find out, something this main() function avoids. */
 int main(int argc, char* argv[])
 {
+    int status = EXIT_FAILURE;
     try
     {
-        return aliceVision_main(argc, argv);
+        status = aliceVision_main(argc, argv);
     }
     catch(const std::exception& e)
     {
@@ -44,5 +49,13 @@ int main(int argc, char* argv[])
     {
         ALICEVISION_LOG_FATAL("Unknown exception");
     }
-    return EXIT_FAILURE;
+
+    aliceVision::system::Metrics::get().setGauge("exitStatus", status);
+    aliceVision::system::MemoryTracker::get().writeMetrics();
+    aliceVision::system::Metrics::get().write();
+    aliceVision::system::Profiler::get().writeTrace();
+
+    // the logging thread is stopped before the static objects are destroyed
+    aliceVision::system::Logger::get()->stop();
+    return status;
 }
@@ -0,0 +1,178 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "numa.hpp"
+#include "cpu.hpp"
+#include "Logger.hpp"
+
+#include <boost/algorithm/string/case_conv.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace aliceVision {
+namespace system {
+
+std::vector<int> parseCpuList(const std::string& cpuList)
+{
+    std::vector<int> cpus;
+    std::stringstream ss(cpuList);
+    std::string range;
+    while(std::getline(ss, range, ','))
+    {
+        if(range.empty() || range == "\n")
+            continue;
+        const std::size_t dash = range.find('-');
+        const int first = std::stoi(range.substr(0, dash));
+        const int last = (dash == std::string::npos) ? first : std::stoi(range.substr(dash + 1));
+        for(int cpu = first; cpu <= last; ++cpu)
+            cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+std::vector<std::vector<int>> getNumaNodesCpus()
+{
+    std::vector<std::vector<int>> nodesCpus;
+#if defined(__linux__)
+    for(int node = 0; ; ++node)
+    {
+        const std::string cpuListPath = "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist";
+        std::ifstream cpuListFile(cpuListPath);
+        if(!cpuListFile)
+            break;
+        std::string cpuList;
+        std::getline(cpuListFile, cpuList);
+        try
+        {
+            std::vector<int> cpus = parseCpuList(cpuList);
+            // the nodes without CPU (memory only) are not used to pin the threads
+            if(!cpus.empty())
+                nodesCpus.push_back(std::move(cpus));
+        }
+        catch(const std::exception&)
+        {
+            ALICEVISION_LOG_WARNING("Cannot parse the CPU list of the NUMA node " << node << ": '" << cpuList << "'.");
+        }
+    }
+#endif
+    if(nodesCpus.empty())
+    {
+        nodesCpus.emplace_back();
+        for(int cpu = 0; cpu < get_total_cpus(); ++cpu)
+            nodesCpus.back().push_back(cpu);
+    }
+    return nodesCpus;
+}
+
+bool setCurrentThreadAffinity(const std::vector<int>& cpus)
+{
+#if defined(__linux__)
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for(const int cpu : cpus)
+    {
+        if(cpu >= 0 && cpu < CPU_SETSIZE)
+            CPU_SET(cpu, &cpuSet);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet) == 0;
+#else
+    return false;
+#endif
+}
+
+std::string EThreadsPinning_enumToString(EThreadsPinning pinning)
+{
+    switch(pinning)
+    {
+        case EThreadsPinning::NONE: return "none";
+        case EThreadsPinning::NODE: return "node";
+        case EThreadsPinning::CORE: return "core";
+    }
+    throw std::out_of_range("Invalid threads pinning enum: " + std::to_string(int(pinning)));
+}
+
+EThreadsPinning EThreadsPinning_stringToEnum(const std::string& pinning)
+{
+    const std::string value = boost::to_lower_copy(pinning);
+
+    if(value == "none") return EThreadsPinning::NONE;
+    if(value == "node") return EThreadsPinning::NODE;
+    if(value == "core") return EThreadsPinning::CORE;
+
+    throw std::out_of_range("Invalid threads pinning: '" + pinning + "'");
+}
+
+std::ostream& operator<<(std::ostream& os, EThreadsPinning pinning)
+{
+    os << EThreadsPinning_enumToString(pinning);
+    return os;
+}
+
+std::istream& operator>>(std::istream& in, EThreadsPinning& pinning)
+{
+    std::string token;
+    in >> token;
+    pinning = EThreadsPinning_stringToEnum(token);
+    return in;
+}
+
+void pinOpenMPThreads(EThreadsPinning pinning, int nbThreads)
+{
+    if(pinning == EThreadsPinning::NONE || nbThreads < 1)
+        return;
+
+    const std::vector<std::vector<int>> nodesCpus = getNumaNodesCpus();
+    const int nbNodes = nodesCpus.size();
+
+    std::vector<int> allCpus;
+    for(const std::vector<int>& cpus : nodesCpus)
+        allCpus.insert(allCpus.end(), cpus.begin(), cpus.end());
+
+    ALICEVISION_LOG_INFO("Pin " << nbThreads - 1 << " worker threads on " << nbNodes << " NUMA node(s) (" << allCpus.size() << " CPUs), policy: " << pinning << ".");
+
+    int nbFailures = 0;
+    #pragma omp parallel num_threads(nbThreads) reduction(+:nbFailures)
+    {
+        const int threadId = omp_get_thread_num();
+        const int nbTeamThreads = omp_get_num_threads();
+
+        // contiguous blocks of threads per node, as the chunks of a static schedule
+        const int node = int((long long)(threadId) * nbNodes / nbTeamThreads);
+
+        // the master thread is not pinned: it runs the sequential parts and the threads it creates
+        // (other thread pools, larger OpenMP teams) would inherit its affinity
+        if(threadId != 0)
+        {
+            bool pinned = false;
+            if(pinning == EThreadsPinning::NODE)
+            {
+                pinned = setCurrentThreadAffinity(nodesCpus[node]);
+            }
+            else
+            {
+                // the threads of a node take the CPUs of this node first
+                const int firstNodeThread = int(((long long)(node) * nbTeamThreads + nbNodes - 1) / nbNodes);
+                const std::vector<int>& cpus = nodesCpus[node];
+                pinned = setCurrentThreadAffinity({cpus[(threadId - firstNodeThread) % cpus.size()]});
+            }
+            if(!pinned)
+                ++nbFailures;
+        }
+    }
+
+    if(nbFailures > 0)
+        ALICEVISION_LOG_WARNING("Cannot pin " << nbFailures << " thread(s), the threads are scheduled by the OS.");
+}
+
+} // namespace system
+} // namespace aliceVision
@@ -0,0 +1,107 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace system {
+
+/**
+ * @brief Parse a Linux CPU list, like "0-15,32-47".
+ * @param[in] cpuList the CPU list
+ * @return the CPU indexes, in the order of the list
+ * @throw std::invalid_argument if the list cannot be parsed
+ */
+std::vector<int> parseCpuList(const std::string& cpuList);
+
+/**
+ * @brief Get the CPUs of each NUMA node (socket) of the machine.
+ *        Without NUMA information (or outside Linux), all the CPUs are in a single node.
+ * @return the sorted CPU indexes of each node
+ */
+std::vector<std::vector<int>> getNumaNodesCpus();
+
+/**
+ * @brief Restrict the current thread to the given CPUs.
+ * @param[in] cpus the CPU indexes
+ * @return false if the affinity is not supported or cannot be set
+ */
+bool setCurrentThreadAffinity(const std::vector<int>& cpus);
+
+/**
+ * @brief Threads pinning policy
+ */
+enum class EThreadsPinning
+{
+    /// the threads are scheduled by the OS
+    NONE = 0,
+    /// the threads are split in contiguous blocks, each block is pinned to the CPUs of one NUMA node
+    NODE,
+    /// each thread is pinned to one CPU, the CPUs are taken node after node
+    CORE
+};
+
+std::string EThreadsPinning_enumToString(EThreadsPinning pinning);
+EThreadsPinning EThreadsPinning_stringToEnum(const std::string& pinning);
+
+std::ostream& operator<<(std::ostream& os, EThreadsPinning pinning);
+std::istream& operator>>(std::istream& in, EThreadsPinning& pinning);
+
+/**
+ * @brief Pin the OpenMP worker threads with the given policy.
+ *        The OpenMP runtime reuses its threads, so the next parallel regions with at most nbThreads threads
+ *        keep the pinning. The thread t of a static schedule is on the node t * nbNodes / nbThreads.
+ *        The master thread keeps its affinity, so the threads it creates later are not restricted.
+ * @param[in] pinning the pinning policy
+ * @param[in] nbThreads the number of OpenMP threads
+ */
+void pinOpenMPThreads(EThreadsPinning pinning, int nbThreads);
+
+/**
+ * @brief Reserve the memory of a large vector, its pages being touched first by the OpenMP threads
+ *        of a static schedule over the elements.
+ *
+ * The OS places a memory page on the NUMA node of the thread writing it first. A vector resized by one
+ * thread would be entirely on the node of this thread, so the other nodes would access it through
+ * the inter-socket link. Once reserved by this function, the vector is resized as usual and the loops with
+ * a static schedule over its elements access their local memory (with pinned threads, see pinOpenMPThreads).
+ *
+ * @param[in,out] v the vector, nothing is done if its capacity is already enough
+ * @param[in] n the number of elements
+ */
+template <typename T, typename Allocator>
+void firstTouchReserve(std::vector<T, Allocator>& v, std::size_t n)
+{
+    if(v.capacity() >= n)
+        return;
+
+    v.reserve(n);
+
+    // the storage after the constructed elements is raw memory, writing its bytes only places the pages
+    constexpr std::ptrdiff_t pageSize = 4096;
+    char* const bytes = reinterpret_cast<char*>(v.data());
+    const std::ptrdiff_t bytesBegin = v.size() * sizeof(T);
+    const std::ptrdiff_t bytesEnd = n * sizeof(T);
+    const std::ptrdiff_t firstPage = (bytesBegin + pageSize - 1) / pageSize;
+    const std::ptrdiff_t nbPages = (bytesEnd + pageSize - 1) / pageSize;
+
+    #pragma omp parallel for schedule(static)
+    for(std::ptrdiff_t page = firstPage; page < nbPages; ++page)
+    {
+        bytes[std::min(page * pageSize, bytesEnd - 1)] = 0;
+    }
+}
+
+} // namespace system
+} // namespace aliceVision
@@ -0,0 +1,61 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/system/numa.hpp>
+
+#define BOOST_TEST_MODULE numa
+
+#include <boost/test/unit_test.hpp>
+
+#include <stdexcept>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+using namespace aliceVision::system;
+
+BOOST_AUTO_TEST_CASE(numa_parseCpuList)
+{
+    BOOST_CHECK(parseCpuList("").empty());
+
+    const std::vector<int> single = parseCpuList("5");
+    BOOST_REQUIRE_EQUAL(single.size(), 1);
+    BOOST_CHECK_EQUAL(single[0], 5);
+
+    const std::vector<int> expected = {0, 1, 2, 3, 8, 10, 11};
+    const std::vector<int> cpus = parseCpuList("0-3,8,10-11");
+    BOOST_CHECK_EQUAL_COLLECTIONS(cpus.begin(), cpus.end(), expected.begin(), expected.end());
+
+    // empty ranges (trailing separator) are ignored
+    const std::vector<int> trailing = parseCpuList("0-3,8,10-11,");
+    BOOST_CHECK_EQUAL_COLLECTIONS(trailing.begin(), trailing.end(), expected.begin(), expected.end());
+
+    BOOST_CHECK_THROW(parseCpuList("a-b"), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(numa_getNumaNodesCpus)
+{
+    const std::vector<std::vector<int>> nodesCpus = getNumaNodesCpus();
+    BOOST_REQUIRE(!nodesCpus.empty());
+    for(const std::vector<int>& cpus : nodesCpus)
+        BOOST_CHECK(!cpus.empty());
+}
+
+#if defined(__linux__)
+BOOST_AUTO_TEST_CASE(numa_pinOpenMPThreadsKeepsMasterAffinity)
+{
+    cpu_set_t before;
+    BOOST_REQUIRE_EQUAL(sched_getaffinity(0, sizeof(cpu_set_t), &before), 0);
+
+    pinOpenMPThreads(EThreadsPinning::CORE, 4);
+
+    cpu_set_t after;
+    BOOST_REQUIRE_EQUAL(sched_getaffinity(0, sizeof(cpu_set_t), &after), 0);
+    BOOST_CHECK(CPU_EQUAL(&before, &after));
+}
+#endif
@@ -7,121 +7,286 @@
 
 #include "TracksBuilder.hpp"
 
-#include <lemon/list_graph.h>
-#include <lemon/unionfind.h>
+#include <aliceVision/matching/io.hpp>
+#include <aliceVision/system/Logger.hpp>
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
 
 
 namespace aliceVision {
 namespace track {
 
 using namespace aliceVision::matching;
-using namespace lemon;
-
-/// IndexedFeaturePair is: map<viewId, keypointId>
-using IndexedFeaturePair = std::pair<std::size_t, KeypointId>;
-using IndexMap = lemon::ListDigraph::NodeMap<std::size_t>;
-using UnionFindObject = lemon::UnionFindEnum< IndexMap >;
 
-using MapNodeToIndex = stl::flat_map< lemon::ListDigraph::Node, IndexedFeaturePair>;
-using MapIndexToNode = stl::flat_map< IndexedFeaturePair, lemon::ListDigraph::Node >;
+namespace {
 
-struct TracksBuilderData
+/// Compact feature key inside a view: (descType, featIndex)
+struct FeatureKey
 {
-  /// graph container to create the node
-  lemon::ListDigraph graph;
-  /// node to index map
-  MapNodeToIndex map_nodeToIndex;
-  std::unique_ptr<IndexMap> index;
-  std::unique_ptr<UnionFindObject> tracksUF;
+  feature::EImageDescriberType descType;
+  IndexT featIndex;
 
-  const UnionFindObject& getUnionFindEnum() const
+  bool operator<(const FeatureKey& other) const
   {
-    return *tracksUF;
+    if(descType == other.descType)
+      return featIndex < other.featIndex;
+    return descType < other.descType;
   }
 
-  const MapNodeToIndex& getReverseMap() const
+  bool operator==(const FeatureKey& other) const
   {
-    return map_nodeToIndex;
+    return descType == other.descType && featIndex == other.featIndex;
   }
 };
 
-TracksBuilder::TracksBuilder()
+using FeatureKeysPerView = std::map<std::size_t, std::vector<FeatureKey>>;
+
+/// Sort and remove the duplicates of a feature key list
+void sortUnique(std::vector<FeatureKey>& keys)
 {
-    _d.reset(new TracksBuilderData());
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
 }
 
-TracksBuilder::~TracksBuilder() = default;
+} // namespace
 
-void TracksBuilder::build(const PairwiseMatches& pairwiseMatches)
+struct TracksBuilderData
 {
-  typedef std::set<IndexedFeaturePair> SetIndexedPair;
+  /// all the referenced features, sorted by (viewId, descType, featIndex)
+  std::vector<IndexT> featureViewIds;
+  std::vector<FeatureKey> featureKeys;
+  /// range [begin, end) of the features of each view
+  stl::flat_map<std::size_t, std::pair<std::size_t, std::size_t>> viewRanges;
+  /// concurrent union-find parents (the root of a set is its smallest feature index)
+  std::unique_ptr<std::atomic<std::uint32_t>[]> parents;
+  /// tracks in CSR layout: the features of track t are trackFeatures[trackOffsets[t], trackOffsets[t+1])
+  std::vector<std::size_t> trackOffsets;
+  std::vector<std::uint32_t> trackFeatures;
+
+  std::size_t nbFeatures() const { return featureKeys.size(); }
+
+  std::uint32_t find(std::uint32_t x) const
+  {
+    // path halving, concurrent writers only replace a parent by one of its ancestors
+    while(true)
+    {
+      std::uint32_t p = parents[x].load(std::memory_order_relaxed);
+      if(p == x)
+        return x;
+      const std::uint32_t gp = parents[p].load(std::memory_order_relaxed);
+      if(p != gp)
+        parents[x].compare_exchange_weak(p, gp, std::memory_order_relaxed);
+      x = gp;
+    }
+  }
+
+  void join(std::uint32_t a, std::uint32_t b)
+  {
+    while(true)
+    {
+      a = find(a);
+      b = find(b);
+      if(a == b)
+        return;
+      // always link the largest root under the smallest one
+      if(a < b)
+        std::swap(a, b);
+      std::uint32_t expected = a;
+      if(parents[a].compare_exchange_strong(expected, b, std::memory_order_relaxed))
+        return;
+    }
+  }
 
-  // set of all features of all images: (imageIndex, featureIndex)
-  SetIndexedPair allFeatures;
+  std::uint32_t getFeatureIndex(const std::pair<std::size_t, std::size_t>& viewRange, const FeatureKey& key) const
+  {
+    const auto begin = featureKeys.begin() + viewRange.first;
+    const auto end = featureKeys.begin() + viewRange.second;
+    const auto it = std::lower_bound(begin, end, key);
+    assert(it != end && *it == key);
+    return static_cast<std::uint32_t>(it - featureKeys.begin());
+  }
 
-  // for each couple of images make the union according the pair matches
-  for(const auto& matchesPerDescIt: pairwiseMatches)
+  /// Add the features referenced by the matches to the per view lists
+  void addFeatures(const PairwiseMatches& pairwiseMatches, FeatureKeysPerView& keysPerView) const
   {
-    const std::size_t& I = matchesPerDescIt.first.first;
-    const std::size_t& J = matchesPerDescIt.first.second;
-    const MatchesPerDescType& matchesPerDesc = matchesPerDescIt.second;
+    // list the matches involving each view (as first or second view of the pair)
+    std::map<std::size_t, std::vector<std::pair<const MatchesPerDescType*, bool>>> matchesPerView;
+    for(const auto& matchesPerDescIt : pairwiseMatches)
+    {
+      matchesPerView[matchesPerDescIt.first.first].emplace_back(&matchesPerDescIt.second, true);
+      matchesPerView[matchesPerDescIt.first.second].emplace_back(&matchesPerDescIt.second, false);
+    }
+
+    std::vector<std::pair<std::vector<FeatureKey>*, const std::vector<std::pair<const MatchesPerDescType*, bool>>*>> views;
+    views.reserve(matchesPerView.size());
+    for(const auto& viewMatches : matchesPerView)
+      views.emplace_back(&keysPerView[viewMatches.first], &viewMatches.second);
 
-    for(const auto& matchesIt: matchesPerDesc)
+    #pragma omp parallel for schedule(dynamic)
+    for(int v = 0; v < static_cast<int>(views.size()); ++v)
     {
-      const feature::EImageDescriberType descType = matchesIt.first;
-      const IndMatches& matches = matchesIt.second;
-      // we have correspondences between I and J image index.
-      for(const IndMatch& m: matches)
+      std::vector<FeatureKey> newKeys;
+      for(const auto& pairMatches : *views[v].second)
       {
-        IndexedFeaturePair pairI(I, KeypointId(descType, m._i));
-        IndexedFeaturePair pairJ(J, KeypointId(descType, m._j));
-        allFeatures.insert(pairI);
-        allFeatures.insert(pairJ);
+        const bool isFirstView = pairMatches.second;
+        for(const auto& matchesIt : *pairMatches.first)
+        {
+          for(const IndMatch& m : matchesIt.second)
+            newKeys.push_back({matchesIt.first, isFirstView ? m._i : m._j});
+        }
       }
+      sortUnique(newKeys);
+
+      // merge with the features of the previous calls
+      std::vector<FeatureKey>& keys = *views[v].first;
+      const std::size_t previousSize = keys.size();
+      keys.insert(keys.end(), newKeys.begin(), newKeys.end());
+      std::inplace_merge(keys.begin(), keys.begin() + previousSize, keys.end());
+      keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
     }
   }
 
-  // build the node indirection for each referenced feature
-  MapIndexToNode map_indexToNode;
-  map_indexToNode.reserve(allFeatures.size());
-  _d->map_nodeToIndex.reserve(allFeatures.size());
-
-  for(const IndexedFeaturePair& featPair: allFeatures)
+  /// Build the compact feature index and initialize the union-find (each feature is its own set)
+  void initFeatures(FeatureKeysPerView& keysPerView)
   {
-    lemon::ListDigraph::Node node = _d->graph.addNode();
-    map_indexToNode.insert(std::make_pair(featPair, node));
-    _d->map_nodeToIndex.insert(std::make_pair(node, featPair));
-  }
+    std::size_t nbFeatures = 0;
+    viewRanges.clear();
+    viewRanges.reserve(keysPerView.size());
+    for(const auto& viewKeys : keysPerView)
+    {
+      viewRanges[viewKeys.first] = std::make_pair(nbFeatures, nbFeatures + viewKeys.second.size());
+      nbFeatures += viewKeys.second.size();
+    }
 
-  // add the element of myset to the UnionFind insert method.
-  _d->index.reset(new IndexMap(_d->graph));
-  _d->tracksUF.reset(new UnionFindObject(*_d->index));
+    if(nbFeatures >= std::numeric_limits<std::uint32_t>::max())
+      throw std::runtime_error("Can't build tracks, too many features (" + std::to_string(nbFeatures) + ").");
 
-  for(ListDigraph::NodeIt it(_d->graph); it != INVALID; ++it)
-  {
-    _d->tracksUF->insert(it);
+    featureViewIds.resize(nbFeatures);
+    featureKeys.resize(nbFeatures);
+    for(auto& viewKeys : keysPerView)
+    {
+      const std::size_t begin = viewRanges.at(viewKeys.first).first;
+      std::copy(viewKeys.second.begin(), viewKeys.second.end(), featureKeys.begin() + begin);
+      std::fill(featureViewIds.begin() + begin, featureViewIds.begin() + begin + viewKeys.second.size(), static_cast<IndexT>(viewKeys.first));
+      std::vector<FeatureKey>().swap(viewKeys.second);
+    }
+
+    parents.reset(new std::atomic<std::uint32_t>[nbFeatures]);
+    #pragma omp parallel for
+    for(std::int64_t i = 0; i < static_cast<std::int64_t>(nbFeatures); ++i)
+      parents[i].store(static_cast<std::uint32_t>(i), std::memory_order_relaxed);
   }
 
-  // make the union according the pair matches
-  for(const auto& matchesPerDescIt: pairwiseMatches)
+  /// Join the features according to the pair matches
+  void joinMatches(const PairwiseMatches& pairwiseMatches)
   {
-    const std::size_t& I = matchesPerDescIt.first.first;
-    const std::size_t& J = matchesPerDescIt.first.second;
-    const MatchesPerDescType& matchesPerDesc = matchesPerDescIt.second;
-
-    for(const auto& matchesIt: matchesPerDesc)
+    const std::vector<PairwiseMatches::const_iterator> pairs = [&]()
     {
-      const feature::EImageDescriberType descType = matchesIt.first;
-      const IndMatches& matches = matchesIt.second;
-      // we have correspondences between I and J image index.
-      for(const IndMatch& m: matches)
+      std::vector<PairwiseMatches::const_iterator> its;
+      its.reserve(pairwiseMatches.size());
+      for(auto it = pairwiseMatches.begin(); it != pairwiseMatches.end(); ++it)
+        its.push_back(it);
+      return its;
+    }();
+
+    #pragma omp parallel for schedule(dynamic)
+    for(int p = 0; p < static_cast<int>(pairs.size()); ++p)
+    {
+      const auto& rangeI = viewRanges.at(pairs[p]->first.first);
+      const auto& rangeJ = viewRanges.at(pairs[p]->first.second);
+
+      for(const auto& matchesIt : pairs[p]->second)
       {
-        IndexedFeaturePair pairI(I, KeypointId(descType, m._i));
-        IndexedFeaturePair pairJ(J, KeypointId(descType, m._j));
-        _d->tracksUF->join(map_indexToNode[pairI], map_indexToNode[pairJ]);
+        const feature::EImageDescriberType descType = matchesIt.first;
+        // we have correspondences between I and J image index.
+        for(const IndMatch& m : matchesIt.second)
+        {
+          join(getFeatureIndex(rangeI, {descType, m._i}),
+               getFeatureIndex(rangeJ, {descType, m._j}));
+        }
       }
     }
   }
+
+  /// Gather the union-find sets into the CSR tracks (ordered by smallest feature index)
+  void buildTracks()
+  {
+    const std::size_t nbFeat = nbFeatures();
+    std::vector<std::uint32_t> roots(nbFeat);
+
+    #pragma omp parallel for
+    for(std::int64_t i = 0; i < static_cast<std::int64_t>(nbFeat); ++i)
+      roots[i] = find(static_cast<std::uint32_t>(i));
+
+    // the root is the smallest feature of its set, so tracks are numbered in features order
+    std::vector<std::uint32_t> trackIndex(nbFeat, std::numeric_limits<std::uint32_t>::max());
+    std::size_t nbTracks = 0;
+    for(std::size_t i = 0; i < nbFeat; ++i)
+    {
+      if(roots[i] == i)
+        trackIndex[i] = static_cast<std::uint32_t>(nbTracks++);
+    }
+
+    trackOffsets.assign(nbTracks + 1, 0);
+    for(std::size_t i = 0; i < nbFeat; ++i)
+      ++trackOffsets[trackIndex[roots[i]] + 1];
+    for(std::size_t t = 0; t < nbTracks; ++t)
+      trackOffsets[t + 1] += trackOffsets[t];
+
+    std::vector<std::size_t> cursor(trackOffsets.begin(), trackOffsets.end() - 1);
+    trackFeatures.resize(nbFeat);
+    for(std::size_t i = 0; i < nbFeat; ++i)
+      trackFeatures[cursor[trackIndex[roots[i]]]++] = static_cast<std::uint32_t>(i);
+  }
+
+  std::size_t nbTracks() const
+  {
+    return trackOffsets.empty() ? 0 : trackOffsets.size() - 1;
+  }
+};
+
+TracksBuilder::TracksBuilder()
+{
+    _d.reset(new TracksBuilderData());
+}
+
+TracksBuilder::~TracksBuilder() = default;
+
+void TracksBuilder::build(const PairwiseMatches& pairwiseMatches)
+{
+  FeatureKeysPerView keysPerView;
+  _d->addFeatures(pairwiseMatches, keysPerView);
+  _d->initFeatures(keysPerView);
+  _d->joinMatches(pairwiseMatches);
+  _d->buildTracks();
+}
+
+void TracksBuilder::build(const std::vector<std::string>& matchFiles, const std::set<IndexT>& viewsKeysFilter)
+{
+  // first pass: index all the referenced features
+  FeatureKeysPerView keysPerView;
+  for(const std::string& matchFile : matchFiles)
+  {
+    PairwiseMatches fileMatches;
+    if(!LoadMatchFile(fileMatches, matchFile, viewsKeysFilter))
+      throw std::runtime_error("Can't build tracks, can't load match file '" + matchFile + "' !");
+    _d->addFeatures(fileMatches, keysPerView);
+  }
+  _d->initFeatures(keysPerView);
+
+  // second pass: join the matched features
+  for(const std::string& matchFile : matchFiles)
+  {
+    PairwiseMatches fileMatches;
+    if(!LoadMatchFile(fileMatches, matchFile, viewsKeysFilter))
+      throw std::runtime_error("Can't build tracks, can't load match file '" + matchFile + "' !");
+    _d->joinMatches(fileMatches);
+  }
+  _d->buildTracks();
 }
 
 void TracksBuilder::filter(bool clearForks, std::size_t minTrackLength, bool multithreaded)
@@ -132,49 +297,56 @@ void TracksBuilder::filter(bool clearForks, std::size_t minTrackLength, bool mul
   if(!clearForks && minTrackLength == 0)
       return;
 
-  std::set<int> set_classToErase;
+  const std::size_t nbTracks = _d->nbTracks();
+  std::vector<unsigned char> keepTrack(nbTracks, 0);
 
-#pragma omp parallel if(multithreaded)
-  for(lemon::UnionFindEnum<IndexMap>::ClassIt cit(*_d->tracksUF); cit != INVALID; ++cit)
+#pragma omp parallel for schedule(dynamic, 1024) if(multithreaded)
+  for(std::int64_t t = 0; t < static_cast<std::int64_t>(nbTracks); ++t)
   {
-
-#pragma omp single nowait
+    // features are sorted by view inside a track
+    std::size_t nbViews = 0;
+    IndexT previousViewId = UndefinedIndexT;
+    for(std::size_t i = _d->trackOffsets[t]; i < _d->trackOffsets[t + 1]; ++i)
     {
-      std::size_t cpt = 0;
-      std::set<std::size_t> myset;
-      for(lemon::UnionFindEnum<IndexMap>::ItemIt iit(*_d->tracksUF, cit); iit != INVALID; ++iit)
-      {
-        myset.insert(_d->map_nodeToIndex[iit].first);
-        ++cpt;
-      }
-      if((clearForks && myset.size() != cpt) || myset.size() < minTrackLength)
-      {
-#pragma omp critical
-        set_classToErase.insert(cit.operator int());
-      }
+      const IndexT viewId = _d->featureViewIds[_d->trackFeatures[i]];
+      if(i == _d->trackOffsets[t] || viewId != previousViewId)
+        ++nbViews;
+      previousViewId = viewId;
     }
+    const std::size_t trackLength = _d->trackOffsets[t + 1] - _d->trackOffsets[t];
+    keepTrack[t] = !((clearForks && nbViews != trackLength) || nbViews < minTrackLength);
   }
 
-  std::for_each(set_classToErase.begin(), set_classToErase.end(),
-                [&](int toErase){ _d->tracksUF->eraseClass(toErase); });
+  // compact the kept tracks
+  std::size_t nbKeptTracks = 0;
+  std::size_t nbKeptFeatures = 0;
+  for(std::size_t t = 0; t < nbTracks; ++t)
+  {
+    const std::size_t begin = _d->trackOffsets[t];
+    const std::size_t end = _d->trackOffsets[t + 1];
+    if(!keepTrack[t])
+      continue;
+    std::copy(_d->trackFeatures.begin() + begin, _d->trackFeatures.begin() + end, _d->trackFeatures.begin() + nbKeptFeatures);
+    _d->trackOffsets[nbKeptTracks] = nbKeptFeatures;
+    nbKeptFeatures += end - begin;
+    ++nbKeptTracks;
+  }
+  _d->trackOffsets[nbKeptTracks] = nbKeptFeatures;
+  _d->trackOffsets.resize(nbKeptTracks + 1);
+  _d->trackFeatures.resize(nbKeptFeatures);
 }
 
 bool TracksBuilder::exportToStream(std::ostream& os)
 {
-  std::size_t cpt = 0;
-  for(lemon::UnionFindEnum< IndexMap >::ClassIt cit(*_d->tracksUF); cit != INVALID; ++cit)
+  for(std::size_t t = 0; t < _d->nbTracks(); ++t)
   {
-    os << "Class: " << cpt++ << std::endl;
-    std::size_t cptTrackLength = 0;
-    for(lemon::UnionFindEnum< IndexMap >::ItemIt iit(*_d->tracksUF, cit); iit != INVALID; ++iit)
-    {
-      ++cptTrackLength;
-    }
-    os << "\t" << "track length: " << cptTrackLength << std::endl;
+    os << "Class: " << t << std::endl;
+    os << "\t" << "track length: " << (_d->trackOffsets[t + 1] - _d->trackOffsets[t]) << std::endl;
 
-    for(lemon::UnionFindEnum< IndexMap >::ItemIt iit(*_d->tracksUF, cit); iit != INVALID; ++iit)
+    for(std::size_t i = _d->trackOffsets[t]; i < _d->trackOffsets[t + 1]; ++i)
     {
-      os << _d->map_nodeToIndex[ iit ].first << "  " << _d->map_nodeToIndex[ iit ].second << std::endl;
+      const std::uint32_t f = _d->trackFeatures[i];
+      os << _d->featureViewIds[f] << "  " << KeypointId(_d->featureKeys[f].descType, _d->featureKeys[f].featIndex) << std::endl;
     }
   }
   return os.good();
@@ -183,31 +355,64 @@ bool TracksBuilder::exportToStream(std::ostream& os)
 void TracksBuilder::exportToSTL(TracksMap& allTracks) const
 {
   allTracks.clear();
+  allTracks.reserve(_d->nbTracks());
 
-  std::size_t trackIndex = 0;
-  for(lemon::UnionFindEnum< IndexMap >::ClassIt cit(*_d->tracksUF); cit != INVALID; ++cit, ++trackIndex)
+  for(std::size_t t = 0; t < _d->nbTracks(); ++t)
   {
     // create the output track
-    std::pair<TracksMap::iterator, bool> ret = allTracks.insert(std::make_pair(trackIndex, Track()));
+    std::pair<TracksMap::iterator, bool> ret = allTracks.insert(std::make_pair(t, Track()));
 
     Track& outTrack = ret.first->second;
+    outTrack.featPerView.reserve(_d->trackOffsets[t + 1] - _d->trackOffsets[t]);
 
-    for(lemon::UnionFindEnum< IndexMap >::ItemIt iit(*_d->tracksUF, cit); iit != INVALID; ++iit)
+    for(std::size_t i = _d->trackOffsets[t]; i < _d->trackOffsets[t + 1]; ++i)
     {
-      const IndexedFeaturePair & currentPair = _d->map_nodeToIndex.at(iit);
+      const std::uint32_t f = _d->trackFeatures[i];
       // all descType inside the track will be the same
-      outTrack.descType = currentPair.second.descType;
-      outTrack.featPerView[currentPair.first] = currentPair.second.featIndex;
+      outTrack.descType = _d->featureKeys[f].descType;
+      outTrack.featPerView[_d->featureViewIds[f]] = _d->featureKeys[f].featIndex;
     }
   }
 }
 
+void TracksBuilder::exportToStore(TracksStore& tracksStore) const
+{
+  const std::size_t nbTracks = _d->nbTracks();
+  std::vector<std::size_t> trackIds(nbTracks);
+  std::vector<feature::EImageDescriberType> descTypes(nbTracks);
+  std::vector<std::size_t> offsets;
+  std::vector<std::uint32_t> viewIds;
+  std::vector<std::uint32_t> featIds;
+  offsets.reserve(nbTracks + 1);
+  viewIds.reserve(_d->trackFeatures.size());
+  featIds.reserve(_d->trackFeatures.size());
+
+  offsets.push_back(0);
+  for(std::size_t t = 0; t < nbTracks; ++t)
+  {
+    trackIds[t] = t;
+    for(std::size_t i = _d->trackOffsets[t]; i < _d->trackOffsets[t + 1]; ++i)
+    {
+      const std::uint32_t f = _d->trackFeatures[i];
+      descTypes[t] = _d->featureKeys[f].descType;
+      // keep only the last feature of a view (same as exportToSTL if forks were not cleared)
+      if(viewIds.size() > offsets.back() && viewIds.back() == _d->featureViewIds[f])
+      {
+        featIds.back() = _d->featureKeys[f].featIndex;
+        continue;
+      }
+      viewIds.push_back(_d->featureViewIds[f]);
+      featIds.push_back(_d->featureKeys[f].featIndex);
+    }
+    offsets.push_back(viewIds.size());
+  }
+
+  tracksStore = TracksStore(std::move(trackIds), std::move(descTypes), std::move(offsets), std::move(viewIds), std::move(featIds));
+}
+
 std::size_t TracksBuilder::nbTracks() const
 {
-    std::size_t cpt = 0;
-    for(lemon::UnionFindEnum< IndexMap >::ClassIt cit(*_d->tracksUF); cit != lemon::INVALID; ++cit)
-        ++cpt;
-    return cpt;
+    return _d->nbTracks();
 }
 
 } // namespace track
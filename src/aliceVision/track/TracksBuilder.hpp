@@ -7,8 +7,12 @@
 #pragma once
 
 #include <aliceVision/track/Track.hpp>
+#include <aliceVision/track/TracksStore.hpp>
 
 #include <memory>
+#include <set>
+#include <string>
+#include <vector>
 
 
 namespace aliceVision {
@@ -21,6 +25,8 @@ struct TracksBuilderData;
  *
  * Implementation of [1] an efficient algorithm to compute track from pairwise
  * correspondences.
+ * The features are stored in a compact index and merged with a concurrent (lock-free) union-find,
+ * so tracks can be built with several threads.
  *
  * [1] "Unordered feature tracking made fast and easy"
  *     Pierre Moulon and Pascal Monasse. CVMP 2012
@@ -54,6 +60,16 @@ public:
     */
     void build(const PairwiseMatches& pairwiseMatches);
 
+    /**
+    * @brief Build tracks streaming the pairWise matches from match files.
+    *        Each file is loaded twice (features indexing then union), one at a time,
+    *        so all the matches never need to be in memory.
+    * @param[in] matchFiles The match files (see matching::LoadMatchFile)
+    * @param[in] viewsKeysFilter Only use the pairs with both views in this set (empty uses all the pairs)
+    * @throw std::runtime_error if a match file can't be loaded
+    */
+    void build(const std::vector<std::string>& matchFiles, const std::set<IndexT>& viewsKeysFilter = std::set<IndexT>());
+
     /**
     * @brief Remove bad tracks (too short or track with ids collision)
     * @param[in] clearForks: remove tracks with multiple observation in a single image
@@ -75,6 +91,11 @@ public:
     */
     void exportToSTL(TracksMap& allTracks) const;
 
+    /**
+    * @brief Export tracks in the compact TracksStore layout, with the same track ids as exportToSTL.
+    */
+    void exportToStore(TracksStore& tracksStore) const;
+
     /**
     * @brief Return the number of connected set in the UnionFind structure (tree forest)
     * @return number of connected set in the UnionFind structure
@@ -0,0 +1,167 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "TracksStore.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace aliceVision {
+namespace track {
+
+TracksStore::TracksStore(const TracksMap& tracks)
+{
+  std::size_t nbObservations = 0;
+  for(const auto& track : tracks)
+    nbObservations += track.second.featPerView.size();
+
+  _trackIds.reserve(tracks.size());
+  _descTypes.reserve(tracks.size());
+  _offsets.reserve(tracks.size() + 1);
+  _viewIds.reserve(nbObservations);
+  _featIds.reserve(nbObservations);
+
+  _offsets.push_back(0);
+  // TracksMap and featPerView are sorted, so track ids and view ids are sorted too
+  for(const auto& track : tracks)
+  {
+    _trackIds.push_back(track.first);
+    _descTypes.push_back(track.second.descType);
+    for(const auto& feat : track.second.featPerView)
+    {
+      _viewIds.push_back(static_cast<std::uint32_t>(feat.first));
+      _featIds.push_back(static_cast<std::uint32_t>(feat.second));
+    }
+    _offsets.push_back(_viewIds.size());
+  }
+
+  buildPerViewIndex();
+}
+
+TracksStore::TracksStore(std::vector<std::size_t>&& trackIds,
+                         std::vector<feature::EImageDescriberType>&& descTypes,
+                         std::vector<std::size_t>&& offsets,
+                         std::vector<std::uint32_t>&& viewIds,
+                         std::vector<std::uint32_t>&& featIds)
+  : _trackIds(std::move(trackIds))
+  , _descTypes(std::move(descTypes))
+  , _offsets(std::move(offsets))
+  , _viewIds(std::move(viewIds))
+  , _featIds(std::move(featIds))
+{
+  if(_offsets.empty())
+    _offsets.push_back(0);
+
+  if(_descTypes.size() != _trackIds.size() ||
+     _offsets.size() != _trackIds.size() + 1 ||
+     _offsets.back() != _viewIds.size() ||
+     _featIds.size() != _viewIds.size())
+    throw std::invalid_argument("Invalid tracks store data.");
+
+  buildPerViewIndex();
+}
+
+void TracksStore::buildPerViewIndex()
+{
+  // list the views
+  _perViewIds = _viewIds;
+  std::sort(_perViewIds.begin(), _perViewIds.end());
+  _perViewIds.erase(std::unique(_perViewIds.begin(), _perViewIds.end()), _perViewIds.end());
+
+  const auto getViewIndex = [&](std::uint32_t viewId)
+  {
+    return static_cast<std::size_t>(std::lower_bound(_perViewIds.begin(), _perViewIds.end(), viewId) - _perViewIds.begin());
+  };
+
+  // count the tracks per view
+  _perViewOffsets.assign(_perViewIds.size() + 1, 0);
+  std::vector<std::size_t> observationViewIndexes(_viewIds.size());
+  for(std::size_t i = 0; i < _viewIds.size(); ++i)
+  {
+    observationViewIndexes[i] = getViewIndex(_viewIds[i]);
+    ++_perViewOffsets[observationViewIndexes[i] + 1];
+  }
+  for(std::size_t v = 0; v < _perViewIds.size(); ++v)
+    _perViewOffsets[v + 1] += _perViewOffsets[v];
+
+  // tracks are visited by increasing id, so the track ids of each view are sorted
+  std::vector<std::size_t> cursor(_perViewOffsets.begin(), _perViewOffsets.end() - 1);
+  _perViewTrackIds.resize(_viewIds.size());
+  for(std::size_t t = 0; t < _trackIds.size(); ++t)
+  {
+    for(std::size_t i = _offsets[t]; i < _offsets[t + 1]; ++i)
+      _perViewTrackIds[cursor[observationViewIndexes[i]]++] = _trackIds[t];
+  }
+}
+
+TrackView TracksStore::getTrack(std::size_t trackIndex) const
+{
+  assert(trackIndex < size());
+  TrackView track;
+  track.trackId = _trackIds[trackIndex];
+  track.descType = _descTypes[trackIndex];
+  track.viewIds = ConstArrayView<std::uint32_t>(_viewIds.data() + _offsets[trackIndex], _viewIds.data() + _offsets[trackIndex + 1]);
+  track.featIds = ConstArrayView<std::uint32_t>(_featIds.data() + _offsets[trackIndex], _featIds.data() + _offsets[trackIndex + 1]);
+  return track;
+}
+
+bool TracksStore::findTrackIndex(std::size_t trackId, std::size_t& trackIndex) const
+{
+  const auto it = std::lower_bound(_trackIds.begin(), _trackIds.end(), trackId);
+  if(it == _trackIds.end() || *it != trackId)
+    return false;
+  trackIndex = static_cast<std::size_t>(it - _trackIds.begin());
+  return true;
+}
+
+bool TracksStore::findFeatureInView(std::size_t trackIndex, IndexT viewId, std::uint32_t& featId) const
+{
+  const auto begin = _viewIds.begin() + _offsets[trackIndex];
+  const auto end = _viewIds.begin() + _offsets[trackIndex + 1];
+  const auto it = std::lower_bound(begin, end, viewId);
+  if(it == end || *it != viewId)
+    return false;
+  featId = _featIds[static_cast<std::size_t>(it - _viewIds.begin())];
+  return true;
+}
+
+ConstArrayView<std::size_t> TracksStore::getTracksInView(IndexT viewId) const
+{
+  const auto it = std::lower_bound(_perViewIds.begin(), _perViewIds.end(), viewId);
+  if(it == _perViewIds.end() || *it != viewId)
+    return ConstArrayView<std::size_t>();
+  const std::size_t v = static_cast<std::size_t>(it - _perViewIds.begin());
+  return ConstArrayView<std::size_t>(_perViewTrackIds.data() + _perViewOffsets[v], _perViewTrackIds.data() + _perViewOffsets[v + 1]);
+}
+
+void TracksStore::exportToTracksMap(TracksMap& tracks) const
+{
+  tracks.clear();
+  tracks.reserve(size());
+  for(std::size_t t = 0; t < size(); ++t)
+  {
+    Track& track = tracks[_trackIds[t]];
+    track.descType = _descTypes[t];
+    track.featPerView.reserve(_offsets[t + 1] - _offsets[t]);
+    for(std::size_t i = _offsets[t]; i < _offsets[t + 1]; ++i)
+      track.featPerView.insert(track.featPerView.end(), std::make_pair(static_cast<std::size_t>(_viewIds[i]), static_cast<std::size_t>(_featIds[i])));
+  }
+}
+
+void TracksStore::exportToTracksPerView(TracksPerView& tracksPerView) const
+{
+  tracksPerView.clear();
+  tracksPerView.reserve(_perViewIds.size());
+  for(std::size_t v = 0; v < _perViewIds.size(); ++v)
+  {
+    tracksPerView[_perViewIds[v]].assign(_perViewTrackIds.begin() + _perViewOffsets[v],
+                                         _perViewTrackIds.begin() + _perViewOffsets[v + 1]);
+  }
+}
+
+} // namespace track
+} // namespace aliceVision
@@ -0,0 +1,145 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/track/Track.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace aliceVision {
+namespace track {
+
+/**
+ * @brief Non-owning read-only view on a contiguous array.
+ */
+template <typename T>
+class ConstArrayView
+{
+public:
+  ConstArrayView() = default;
+  ConstArrayView(const T* begin, const T* end)
+    : _begin(begin)
+    , _end(end)
+  {}
+
+  const T* begin() const { return _begin; }
+  const T* end() const { return _end; }
+  std::size_t size() const { return static_cast<std::size_t>(_end - _begin); }
+  bool empty() const { return _begin == _end; }
+  const T& operator[](std::size_t i) const { return _begin[i]; }
+
+private:
+  const T* _begin = nullptr;
+  const T* _end = nullptr;
+};
+
+/**
+ * @brief View on the observations of a track stored in a TracksStore.
+ *        The observations are sorted by increasing view id.
+ */
+struct TrackView
+{
+  std::size_t trackId = 0;
+  feature::EImageDescriberType descType = feature::EImageDescriberType::UNINITIALIZED;
+  ConstArrayView<std::uint32_t> viewIds;
+  ConstArrayView<std::uint32_t> featIds;
+
+  std::size_t size() const { return viewIds.size(); }
+};
+
+/**
+ * @brief Immutable compact storage of tracks.
+ *
+ * The observations of all the tracks are packed in two 32-bit arrays (viewId, featId)
+ * with a CSR offsets array, instead of one flat_map allocation per track.
+ * A second CSR index gives the sorted list of visible track ids per view (same content as TracksPerView).
+ *
+ * Track indexes (position in the store, from 0 to size()-1) are sorted by increasing track id.
+ */
+class TracksStore
+{
+public:
+  TracksStore() = default;
+
+  /**
+   * @brief Build the store from the tracks map.
+   */
+  explicit TracksStore(const TracksMap& tracks);
+
+  /**
+   * @brief Build the store from CSR data.
+   * @param[in] trackIds The sorted track ids
+   * @param[in] descTypes The describer type of each track
+   * @param[in] offsets The observations of track i are in [offsets[i], offsets[i+1])
+   * @param[in] viewIds The view id of each observation (sorted inside each track)
+   * @param[in] featIds The feature id of each observation
+   */
+  TracksStore(std::vector<std::size_t>&& trackIds,
+              std::vector<feature::EImageDescriberType>&& descTypes,
+              std::vector<std::size_t>&& offsets,
+              std::vector<std::uint32_t>&& viewIds,
+              std::vector<std::uint32_t>&& featIds);
+
+  /// Number of tracks
+  std::size_t size() const { return _trackIds.size(); }
+  bool empty() const { return _trackIds.empty(); }
+
+  /// Total number of observations
+  std::size_t nbObservations() const { return _viewIds.size(); }
+
+  /// Get the track at the given index (0 <= trackIndex < size())
+  TrackView getTrack(std::size_t trackIndex) const;
+
+  /**
+   * @brief Find the index of a track id.
+   * @return false if the track id doesn't exist
+   */
+  bool findTrackIndex(std::size_t trackId, std::size_t& trackIndex) const;
+
+  /**
+   * @brief Find the feature of a track in a view.
+   * @return false if the track is not visible in the view
+   */
+  bool findFeatureInView(std::size_t trackIndex, IndexT viewId, std::uint32_t& featId) const;
+
+  /// Get the sorted ids of the views with at least one observation
+  const std::vector<std::uint32_t>& getViewIds() const { return _perViewIds; }
+
+  /**
+   * @brief Get the sorted ids of the tracks visible in a view (zero-copy equivalent of TracksPerView).
+   * @return an empty view if the view has no track
+   */
+  ConstArrayView<std::size_t> getTracksInView(IndexT viewId) const;
+
+  /**
+   * @brief Convert to the track map layout.
+   */
+  void exportToTracksMap(TracksMap& tracks) const;
+
+  /**
+   * @brief Convert to the per view track ids layout.
+   */
+  void exportToTracksPerView(TracksPerView& tracksPerView) const;
+
+private:
+  void buildPerViewIndex();
+
+  std::vector<std::size_t> _trackIds;
+  std::vector<feature::EImageDescriberType> _descTypes;
+  std::vector<std::size_t> _offsets;
+  std::vector<std::uint32_t> _viewIds;
+  std::vector<std::uint32_t> _featIds;
+
+  /// per view index: tracks visible in _perViewIds[v] are _perViewTrackIds[_perViewOffsets[v], _perViewOffsets[v+1])
+  std::vector<std::uint32_t> _perViewIds;
+  std::vector<std::size_t> _perViewOffsets;
+  std::vector<std::size_t> _perViewTrackIds;
+};
+
+} // namespace track
+} // namespace aliceVision
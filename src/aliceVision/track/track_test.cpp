@@ -8,7 +8,11 @@
 #include "aliceVision/track/TracksBuilder.hpp"
 #include "aliceVision/track/tracksUtils.hpp"
 #include "aliceVision/matching/IndMatch.hpp"
+#include "aliceVision/matching/io.hpp"
 
+#include <boost/filesystem.hpp>
+
+#include <random>
 #include <vector>
 #include <utility>
 
@@ -17,6 +21,7 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/test/tools/floating_point_comparison.hpp>
 
+using namespace aliceVision;
 using namespace aliceVision::feature;
 using namespace aliceVision::track;
 using namespace aliceVision::matching;
@@ -180,6 +185,108 @@ BOOST_AUTO_TEST_CASE(Track_Conflict) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(Track_StreamFromMatchFiles) {
+
+  // random matches between 10 views, saved with one match file per view
+  std::mt19937 gen(0);
+  std::uniform_int_distribution<IndexT> featDistribution(0, 200);
+  PairwiseMatches map_pairwisematches;
+  for(IndexT I = 0; I < 10; ++I)
+  {
+    for(IndexT J = I + 1; J < 10; ++J)
+    {
+      IndMatches& matches = map_pairwisematches[std::make_pair(I, J)][EImageDescriberType::UNKNOWN];
+      for(int m = 0; m < 100; ++m)
+        matches.emplace_back(featDistribution(gen), featDistribution(gen));
+    }
+  }
+
+  const std::string testFolder = "trackStreamTest";
+  boost::filesystem::create_directory(testFolder);
+  BOOST_CHECK(Save(map_pairwisematches, testFolder, "bin", true));
+
+  std::vector<std::string> matchFiles;
+  for(IndexT I = 0; I < 9; ++I)
+    matchFiles.push_back((boost::filesystem::path(testFolder) / (std::to_string(I) + ".matches.bin")).string());
+
+  TracksBuilder trackBuilder;
+  trackBuilder.build(map_pairwisematches);
+  trackBuilder.filter(true, 2);
+  TracksMap map_tracks;
+  trackBuilder.exportToSTL(map_tracks);
+
+  TracksBuilder streamTrackBuilder;
+  streamTrackBuilder.build(matchFiles);
+  streamTrackBuilder.filter(true, 2);
+  TracksMap map_streamTracks;
+  streamTrackBuilder.exportToSTL(map_streamTracks);
+
+  BOOST_CHECK(!map_tracks.empty());
+  BOOST_CHECK_EQUAL(map_tracks.size(), map_streamTracks.size());
+  for(const auto& trackIt : map_tracks)
+    BOOST_CHECK(trackIt.second.featPerView == map_streamTracks.at(trackIt.first).featPerView);
+
+  boost::filesystem::remove_all(testFolder);
+}
+
+BOOST_AUTO_TEST_CASE(Track_TracksStore) {
+
+  //A    B    C
+  //0 -> 0 -> 0
+  //1 -> 1 -> 6
+  //2 -> 3
+  PairwiseMatches map_pairwisematches;
+  map_pairwisematches[std::make_pair(0, 1)][EImageDescriberType::UNKNOWN] = {IndMatch(0,0), IndMatch(1,1), IndMatch(2,3)};
+  map_pairwisematches[std::make_pair(1, 2)][EImageDescriberType::UNKNOWN] = {IndMatch(0,0), IndMatch(1,6)};
+
+  TracksBuilder trackBuilder;
+  trackBuilder.build(map_pairwisematches);
+  TracksMap map_tracks;
+  trackBuilder.exportToSTL(map_tracks);
+  TracksStore tracksStore;
+  trackBuilder.exportToStore(tracksStore);
+
+  BOOST_CHECK_EQUAL(3, tracksStore.size());
+  BOOST_CHECK_EQUAL(8, tracksStore.nbObservations());
+
+  // same content as the track map
+  TracksMap map_storeTracks;
+  tracksStore.exportToTracksMap(map_storeTracks);
+  BOOST_CHECK_EQUAL(map_tracks.size(), map_storeTracks.size());
+  for(const auto& trackIt : map_tracks)
+    BOOST_CHECK(trackIt.second.featPerView == map_storeTracks.at(trackIt.first).featPerView);
+
+  const TracksStore tracksStoreFromMap(map_tracks);
+  BOOST_CHECK_EQUAL(tracksStore.nbObservations(), tracksStoreFromMap.nbObservations());
+
+  // same per view track ids
+  TracksPerView map_tracksPerView;
+  computeTracksPerView(map_tracks, map_tracksPerView);
+  TracksPerView map_storeTracksPerView;
+  tracksStore.exportToTracksPerView(map_storeTracksPerView);
+  BOOST_CHECK(map_tracksPerView == map_storeTracksPerView);
+
+  const ConstArrayView<std::size_t> tracksInC = tracksStore.getTracksInView(2);
+  BOOST_CHECK_EQUAL(2, tracksInC.size());
+  BOOST_CHECK(tracksStore.getTracksInView(5).empty());
+
+  std::set<std::size_t> visibleTracks, storeVisibleTracks;
+  getCommonTracksInImages({0, 1, 2}, map_tracksPerView, visibleTracks);
+  getCommonTracksInImages({0, 1, 2}, tracksStore, storeVisibleTracks);
+  BOOST_CHECK_EQUAL(2, storeVisibleTracks.size());
+  BOOST_CHECK(visibleTracks == storeVisibleTracks);
+
+  std::vector<FeatureId> featIds, storeFeatIds;
+  getFeatureIdInViewPerTrack(map_tracks, {0, 1, 2}, 1, &featIds);
+  getFeatureIdInViewPerTrack(tracksStore, {0, 1, 2}, 1, &storeFeatIds);
+  BOOST_CHECK(featIds == storeFeatIds);
+
+  std::map<std::size_t, std::size_t> lengths, storeLengths;
+  tracksLength(map_tracks, lengths);
+  tracksLength(tracksStore, storeLengths);
+  BOOST_CHECK(lengths == storeLengths);
+}
+
 BOOST_AUTO_TEST_CASE(Track_GetCommonTracksInImages)
 {
   {
@@ -228,3 +335,49 @@ BOOST_AUTO_TEST_CASE(Track_GetCommonTracksInImages)
     BOOST_CHECK_EQUAL(base.size(), set_visibleTracks.size());
   }
 }
+
+BOOST_AUTO_TEST_CASE(Track_IntersectTrackIds)
+{
+  std::mt19937 randomNumberGenerator(42);
+  std::uniform_int_distribution<std::size_t> trackIdDistribution(0, 100000);
+
+  // balanced (merge) and unbalanced (galloping search) list sizes
+  for(const std::size_t sizeB : {std::size_t(10), std::size_t(1000), std::size_t(50000)})
+  {
+    std::set<std::size_t> setA, setB;
+    while(setA.size() < 1000)
+      setA.insert(trackIdDistribution(randomNumberGenerator));
+    while(setB.size() < sizeB)
+      setB.insert(trackIdDistribution(randomNumberGenerator));
+
+    const TrackIdSet tracksA(setA.begin(), setA.end());
+    const TrackIdSet tracksB(setB.begin(), setB.end());
+
+    TrackIdSet expected;
+    std::set_intersection(setA.begin(), setA.end(), setB.begin(), setB.end(), std::back_inserter(expected));
+
+    TrackIdSet commonTracks;
+    intersectTrackIds(ConstArrayView<std::size_t>(tracksA.data(), tracksA.data() + tracksA.size()),
+                      ConstArrayView<std::size_t>(tracksB.data(), tracksB.data() + tracksB.size()), commonTracks);
+    BOOST_CHECK(commonTracks == expected);
+
+    // symmetric
+    intersectTrackIds(ConstArrayView<std::size_t>(tracksB.data(), tracksB.data() + tracksB.size()),
+                      ConstArrayView<std::size_t>(tracksA.data(), tracksA.data() + tracksA.size()), commonTracks);
+    BOOST_CHECK(commonTracks == expected);
+
+    // same result with the dense views bitsets
+    TracksPerView tracksPerView;
+    tracksPerView[0] = tracksA;
+    tracksPerView[1] = tracksB;
+
+    TracksBitsetPerView tracksBitsetPerView;
+    computeDenseTracksBitsetPerView(tracksPerView, tracksBitsetPerView);
+    BOOST_CHECK_EQUAL(tracksBitsetPerView.count(1), (sizeB == 50000) ? 1 : 0);
+
+    getCommonTracksInImages({0, 1}, tracksPerView, tracksBitsetPerView, commonTracks);
+    BOOST_CHECK(commonTracks == expected);
+    getCommonTracksInImages({0, 1}, tracksPerView, commonTracks);
+    BOOST_CHECK(commonTracks == expected);
+  }
+}
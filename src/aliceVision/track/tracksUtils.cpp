@@ -7,6 +7,7 @@
 
 #include "tracksUtils.hpp"
 
+#include <algorithm>
 #include <iterator>
 
 
@@ -44,51 +45,197 @@ bool getCommonTracksInImages(const std::set<std::size_t>& imageIndexes,
 }
 
 
-void getCommonTracksInImages(const std::set<std::size_t>& imageIndexes,
-                             const TracksPerView& tracksPerView,
-                             std::set<std::size_t>& visibleTracks)
+void intersectTrackIds(const ConstArrayView<std::size_t>& tracksA,
+                       const ConstArrayView<std::size_t>& tracksB,
+                       TrackIdSet& commonTracks)
+{
+  commonTracks.clear();
+
+  // look for the ids of the smallest list in the largest one
+  const bool aIsSmallest = (tracksA.size() <= tracksB.size());
+  const ConstArrayView<std::size_t>& smallTracks = aIsSmallest ? tracksA : tracksB;
+  const ConstArrayView<std::size_t>& largeTracks = aIsSmallest ? tracksB : tracksA;
+
+  if(smallTracks.empty())
+    return;
+
+  commonTracks.reserve(smallTracks.size());
+
+  // similar sizes: linear merge
+  if(largeTracks.size() < 32 * smallTracks.size())
+  {
+    std::set_intersection(smallTracks.begin(), smallTracks.end(),
+                          largeTracks.begin(), largeTracks.end(),
+                          std::back_inserter(commonTracks));
+    return;
+  }
+
+  // unbalanced sizes: galloping search from the previous position in the largest list,
+  // each search costs O(log(distance to the next id)) instead of O(distance)
+  const std::size_t* it = largeTracks.begin();
+  const std::size_t* const end = largeTracks.end();
+  for(const std::size_t trackId : smallTracks)
+  {
+    // exponential search of an upper bound, all the ids before 'it' are lower than trackId
+    std::ptrdiff_t step = 1;
+    const std::size_t* bound = it;
+    while(bound != end && *bound < trackId)
+    {
+      it = bound + 1;
+      bound = (end - bound > step) ? bound + step : end;
+      step *= 2;
+    }
+    it = std::lower_bound(it, bound, trackId);
+    if(it == end)
+      break;
+    if(*it == trackId)
+    {
+      commonTracks.push_back(trackId);
+      ++it;
+    }
+  }
+}
+
+void computeDenseTracksBitsetPerView(const TracksPerView& tracksPerView,
+                                     TracksBitsetPerView& tracksBitsetPerView)
+{
+  tracksBitsetPerView.clear();
+  for(const auto& viewTracks : tracksPerView)
+  {
+    const TrackIdSet& imageTracks = viewTracks.second;
+    if(imageTracks.empty())
+      continue;
+
+    // only the views whose bitset is not larger than their track ids list
+    const std::size_t nbBits = imageTracks.back() + 1;
+    if(nbBits > imageTracks.size() * 8 * sizeof(std::size_t))
+      continue;
+
+    stl::dynamic_bitset& bitset = tracksBitsetPerView[viewTracks.first];
+    bitset = stl::dynamic_bitset(nbBits);
+    for(const std::size_t trackId : imageTracks)
+      bitset[trackId] = true;
+  }
+}
+
+namespace {
+
+/**
+ * @brief Intersect the sorted track ids visible in each image.
+ *        The images are intersected by increasing number of tracks,
+ *        the candidates are filtered with the image bitset if any.
+ * @param[in] getTracksInView returns the sorted track ids visible in a view (empty if none)
+ * @param[in] getBitset returns the tracks bitset of a view (nullptr if none)
+ */
+template <typename GetTracksInView, typename GetBitset>
+void intersectTracksInImages(const std::set<std::size_t>& imageIndexes,
+                             GetTracksInView getTracksInView,
+                             GetBitset getBitset,
+                             TrackIdSet& visibleTracks)
 {
   assert(!imageIndexes.empty());
   visibleTracks.clear();
 
-  // take the first image id
-  std::set<std::size_t>::const_iterator it = imageIndexes.cbegin();
+  std::vector<std::pair<ConstArrayView<std::size_t>, std::size_t>> imagesTracks;
+  imagesTracks.reserve(imageIndexes.size());
+  for(const std::size_t imageIndex : imageIndexes)
   {
-    TracksPerView::const_iterator tracksPerViewIt = tracksPerView.find(*it);
-    // if there are no tracks for the first view just return as there will not be
-    // any common track
-    if(tracksPerViewIt == tracksPerView.end())
-    {
-      // one image is not present in the tracksPerView, so there is no track in common
-      visibleTracks.clear();
+    const ConstArrayView<std::size_t> imageTracks = getTracksInView(imageIndex);
+    // one image is not present in the tracks, so there is no track in common
+    if(imageTracks.empty())
       return;
-    }
-    const TrackIdSet& imageTracks = tracksPerViewIt->second;
-    // copy all the visible tracks by the first image
-    visibleTracks.insert(imageTracks.cbegin(), imageTracks.cend());
+    imagesTracks.emplace_back(imageTracks, imageIndex);
   }
-  ++it;
-  // for each of the remaining view
-  for(; it != imageIndexes.cend(); ++it)
+
+  // the candidates are the tracks of the image with the fewest tracks
+  std::sort(imagesTracks.begin(), imagesTracks.end(), [](const auto& a, const auto& b)
+  {
+    return a.first.size() < b.first.size();
+  });
+  visibleTracks.assign(imagesTracks.front().first.begin(), imagesTracks.front().first.end());
+
+  TrackIdSet tmp;
+  for(std::size_t i = 1; i < imagesTracks.size() && !visibleTracks.empty(); ++i)
   {
-    // if there are no tracks for this view just return
-    TracksPerView::const_iterator tracksPerViewIt = tracksPerView.find(*it);
-    if(tracksPerViewIt == tracksPerView.end())
+    const stl::dynamic_bitset* bitset = getBitset(imagesTracks[i].second);
+    if(bitset != nullptr)
     {
-      // one image is not present in the tracksPerView, so there is no track in common
-      visibleTracks.clear();
-      return;
+      visibleTracks.erase(std::remove_if(visibleTracks.begin(), visibleTracks.end(), [&](std::size_t trackId)
+      {
+        return trackId >= bitset->size() || !(*bitset)[trackId];
+      }), visibleTracks.end());
+    }
+    else
+    {
+      intersectTrackIds(ConstArrayView<std::size_t>(visibleTracks.data(), visibleTracks.data() + visibleTracks.size()),
+                        imagesTracks[i].first, tmp);
+      visibleTracks.swap(tmp);
     }
-    const TrackIdSet& imageTracks = tracksPerViewIt->second;
-    std::set<std::size_t> tmp;
-    std::set_intersection(
-        visibleTracks.cbegin(), visibleTracks.cend(),
-        imageTracks.cbegin(), imageTracks.cend(),
-        std::inserter(tmp, tmp.begin()));
-    visibleTracks.swap(tmp);
   }
 }
 
+ConstArrayView<std::size_t> getTracksInView(const TracksPerView& tracksPerView, std::size_t viewId)
+{
+  TracksPerView::const_iterator tracksPerViewIt = tracksPerView.find(viewId);
+  if(tracksPerViewIt == tracksPerView.end())
+    return ConstArrayView<std::size_t>();
+  const TrackIdSet& imageTracks = tracksPerViewIt->second;
+  return ConstArrayView<std::size_t>(imageTracks.data(), imageTracks.data() + imageTracks.size());
+}
+
+const stl::dynamic_bitset* noBitset(std::size_t)
+{
+  return nullptr;
+}
+
+} // namespace
+
+void getCommonTracksInImages(const std::set<std::size_t>& imageIndexes,
+                             const TracksPerView& tracksPerView,
+                             std::set<std::size_t>& visibleTracks)
+{
+  TrackIdSet commonTracks;
+  getCommonTracksInImages(imageIndexes, tracksPerView, commonTracks);
+  visibleTracks = std::set<std::size_t>(commonTracks.begin(), commonTracks.end());
+}
+
+void getCommonTracksInImages(const std::set<std::size_t>& imageIndexes,
+                             const TracksPerView& tracksPerView,
+                             TrackIdSet& visibleTracks)
+{
+  intersectTracksInImages(imageIndexes, [&](std::size_t viewId)
+  {
+    return getTracksInView(tracksPerView, viewId);
+  }, noBitset, visibleTracks);
+}
+
+void getCommonTracksInImages(const std::set<std::size_t>& imageIndexes,
+                             const TracksPerView& tracksPerView,
+                             const TracksBitsetPerView& tracksBitsetPerView,
+                             TrackIdSet& visibleTracks)
+{
+  intersectTracksInImages(imageIndexes, [&](std::size_t viewId)
+  {
+    return getTracksInView(tracksPerView, viewId);
+  }, [&](std::size_t viewId) -> const stl::dynamic_bitset*
+  {
+    const auto it = tracksBitsetPerView.find(viewId);
+    return (it == tracksBitsetPerView.end()) ? nullptr : &it->second;
+  }, visibleTracks);
+}
+
+void getCommonTracksInImages(const std::set<std::size_t>& imageIndexes,
+                             const TracksStore& tracksStore,
+                             std::set<std::size_t>& visibleTracks)
+{
+  TrackIdSet commonTracks;
+  intersectTracksInImages(imageIndexes, [&](std::size_t viewId)
+  {
+    return tracksStore.getTracksInView(static_cast<IndexT>(viewId));
+  }, noBitset, commonTracks);
+  visibleTracks = std::set<std::size_t>(commonTracks.begin(), commonTracks.end());
+}
+
 bool getCommonTracksInImagesFast(const std::set<std::size_t>& imageIndexes,
                                  const TracksMap& tracksIn,
                                  const TracksPerView& tracksPerView,
@@ -97,11 +244,11 @@ bool getCommonTracksInImagesFast(const std::set<std::size_t>& imageIndexes,
   assert(!imageIndexes.empty());
   tracksOut.clear();
 
-  std::set<std::size_t> set_visibleTracks;
-  getCommonTracksInImages(imageIndexes, tracksPerView, set_visibleTracks);
+  TrackIdSet visibleTracks;
+  getCommonTracksInImages(imageIndexes, tracksPerView, visibleTracks);
 
   // go along the tracks
-  for(std::size_t visibleTrack: set_visibleTracks)
+  for(std::size_t visibleTrack: visibleTracks)
   {
     TracksMap::const_iterator itTrackIn = tracksIn.find(visibleTrack);
     if(itTrackIn == tracksIn.end())
@@ -146,6 +293,18 @@ void getTracksInImagesFast(const std::set<IndexT>& imagesId,
   }
 }
 
+void getTracksInImagesFast(const std::set<IndexT>& imagesId,
+                           const TracksStore& tracksStore,
+                           std::set<IndexT>& tracksIds)
+{
+  tracksIds.clear();
+  for(const IndexT id : imagesId)
+  {
+    const ConstArrayView<std::size_t> imageTracks = tracksStore.getTracksInView(id);
+    tracksIds.insert(imageTracks.begin(), imageTracks.end());
+  }
+}
+
 void getTracksInImage(const std::size_t& imageIndex,
                              const TracksMap& tracks,
                              std::set<std::size_t>& tracksIds)
@@ -171,6 +330,18 @@ void getTracksInImageFast(const std::size_t& imageId,
   tracksIds.insert(imageTracks.cbegin(), imageTracks.cend());
 }
 
+void getTracksInImageFast(const std::size_t& imageId,
+                                 const TracksStore& tracksStore,
+                                 std::set<std::size_t>& tracksIds)
+{
+  const ConstArrayView<std::size_t> imageTracks = tracksStore.getTracksInView(static_cast<IndexT>(imageId));
+  if(imageTracks.empty())
+    return;
+
+  tracksIds.clear();
+  tracksIds.insert(imageTracks.begin(), imageTracks.end());
+}
+
 void computeTracksPerView(const TracksMap& tracks, TracksPerView& tracksPerView)
 {
   for(const auto& track: tracks)
@@ -224,6 +395,26 @@ bool getFeatureIdInViewPerTrack(const TracksMap& allTracks,
   return !out_featId->empty();
 }
 
+bool getFeatureIdInViewPerTrack(const TracksStore& tracksStore,
+                                       const std::set<std::size_t>& trackIds,
+                                       IndexT viewId,
+                                       std::vector<FeatureId>* out_featId)
+{
+  for(std::size_t trackId: trackIds)
+  {
+    std::size_t trackIndex;
+    std::uint32_t featId;
+
+    // ignore it if the track doesn't exist or is not visible in the view
+    if(!tracksStore.findTrackIndex(trackId, trackIndex) ||
+       !tracksStore.findFeatureInView(trackIndex, viewId, featId))
+      continue;
+
+    out_featId->emplace_back(tracksStore.getTrack(trackIndex).descType, featId);
+  }
+  return !out_featId->empty();
+}
+
 void tracksToIndexedMatches(const TracksMap& tracks,
                                    const std::vector<IndexT>& filterIndex,
                                    std::vector<IndMatch>* out_index)
@@ -264,6 +455,13 @@ void tracksLength(const TracksMap& tracks,
   }
 }
 
+void tracksLength(const TracksStore& tracksStore,
+                         std::map<std::size_t, std::size_t>& occurenceTrackLength)
+{
+  for(std::size_t t = 0; t < tracksStore.size(); ++t)
+    ++occurenceTrackLength[tracksStore.getTrack(t).size()];
+}
+
 void imageIdInTracks(const TracksPerView& tracksPerView,
                             std::set<std::size_t>& imagesId)
 {
@@ -282,5 +480,11 @@ void imageIdInTracks(const TracksMap& tracks,
   }
 }
 
+void imageIdInTracks(const TracksStore& tracksStore,
+                            std::set<std::size_t>& imagesId)
+{
+  imagesId.insert(tracksStore.getViewIds().begin(), tracksStore.getViewIds().end());
+}
+
 } // namespace track
 } // namespace aliceVision
@@ -7,6 +7,8 @@
 
 #pragma once
 #include <aliceVision/track/Track.hpp>
+#include <aliceVision/track/TracksStore.hpp>
+#include <aliceVision/stl/DynamicBitset.hpp>
 
 
 namespace aliceVision {
@@ -32,6 +34,66 @@ void getCommonTracksInImages(const std::set<std::size_t>& imageIndexes,
                                     const TracksPerView& tracksPerView,
                                     std::set<std::size_t>& visibleTracks);
   
+/**
+ * @brief Find common tracks among a set of images.
+ * @param[in] imageIndexes: set of images we are looking for common tracks.
+ * @param[in] tracksPerView: for each view it contains the list of visible tracks. *The tracks ids must be ordered*.
+ * @param[out] visibleTracks: output with only the common tracks, ordered.
+ */
+void getCommonTracksInImages(const std::set<std::size_t>& imageIndexes,
+                                    const TracksPerView& tracksPerView,
+                                    TrackIdSet& visibleTracks);
+
+/**
+ * @brief Bitset of the visible tracks for each view, indexed by track id.
+ */
+using TracksBitsetPerView = stl::flat_map<std::size_t, stl::dynamic_bitset>;
+
+/**
+ * @brief Compute the visible tracks bitset of the views with a dense track coverage,
+ *        i.e. the views whose bitset is not larger than their list of track ids.
+ * @param[in] tracksPerView: for each view it contains the list of visible tracks. *The tracks ids must be ordered*.
+ * @param[out] tracksBitsetPerView: the bitset of the dense views.
+ */
+void computeDenseTracksBitsetPerView(const TracksPerView& tracksPerView,
+                                     TracksBitsetPerView& tracksBitsetPerView);
+
+/**
+ * @brief Find common tracks among a set of images.
+ *        The candidate tracks are tested in constant time against the images with a bitset,
+ *        it is worth it when the same images are intersected many times.
+ * @param[in] imageIndexes: set of images we are looking for common tracks.
+ * @param[in] tracksPerView: for each view it contains the list of visible tracks. *The tracks ids must be ordered*.
+ * @param[in] tracksBitsetPerView: the visible tracks bitset of the dense views (see computeDenseTracksBitsetPerView).
+ * @param[out] visibleTracks: output with only the common tracks, ordered.
+ */
+void getCommonTracksInImages(const std::set<std::size_t>& imageIndexes,
+                                    const TracksPerView& tracksPerView,
+                                    const TracksBitsetPerView& tracksBitsetPerView,
+                                    TrackIdSet& visibleTracks);
+
+/**
+ * @brief Intersection of two ordered lists of track ids.
+ *        The lists are merged if their sizes are similar, otherwise the ids of the smallest list
+ *        are searched in the largest one with a galloping (exponential) search.
+ * @param[in] tracksA: ordered track ids.
+ * @param[in] tracksB: ordered track ids.
+ * @param[out] commonTracks: the ordered common track ids.
+ */
+void intersectTrackIds(const ConstArrayView<std::size_t>& tracksA,
+                       const ConstArrayView<std::size_t>& tracksB,
+                       TrackIdSet& commonTracks);
+
+/**
+ * @brief Find common tracks among a set of images.
+ * @param[in] imageIndexes: set of images we are looking for common tracks.
+ * @param[in] tracksStore: all tracks of the scene.
+ * @param[out] visibleTracks: output with only the common tracks.
+ */
+void getCommonTracksInImages(const std::set<std::size_t>& imageIndexes,
+                                    const TracksStore& tracksStore,
+                                    std::set<std::size_t>& visibleTracks);
+
 /**
  * @brief Find common tracks among images.
  * @param[in] imageIndexes: set of images we are looking for common tracks.
@@ -64,6 +126,16 @@ void getTracksInImagesFast(const std::set<IndexT>& imagesId,
                                   const TracksPerView& tracksPerView,
                                   std::set<IndexT>& tracksIds);
 
+/**
+ * @brief Find all the visible tracks from a set of images.
+ * @param[in] imagesId set of images we are looking for tracks.
+ * @param[in] tracksStore all tracks of the scene.
+ * @param[out] tracksId the tracks in the images
+ */
+void getTracksInImagesFast(const std::set<IndexT>& imagesId,
+                                  const TracksStore& tracksStore,
+                                  std::set<IndexT>& tracksIds);
+
 /**
  * @brief Find all the visible tracks from a single image.
  * @param[in] imageIndex of the image we are looking for tracks.
@@ -84,6 +156,16 @@ void getTracksInImageFast(const std::size_t& imageId,
                                  const TracksPerView& tracksPerView,
                                  std::set<std::size_t>& tracksIds);
 
+/**
+ * @brief Find all the visible tracks from a single image.
+ * @param[in] imageId of the image we are looking for tracks.
+ * @param[in] tracksStore all tracks of the scene.
+ * @param[out] tracksIds the tracks in the image
+ */
+void getTracksInImageFast(const std::size_t& imageId,
+                                 const TracksStore& tracksStore,
+                                 std::set<std::size_t>& tracksIds);
+
 /**
  * @brief Compute the number of tracks for each view
  * @param[in] tracks all tracks of the scene as a map {trackId, track}
@@ -112,6 +194,18 @@ bool getFeatureIdInViewPerTrack(const TracksMap& allTracks,
                                        IndexT viewId,
                                        std::vector<FeatureId>* out_featId);
 
+/**
+ * @brief Get feature id (with associated describer type) in the specified view for each TrackId
+ * @param[in] tracksStore all tracks of the scene
+ * @param[in] trackIds the tracks in the images
+ * @param[in] viewId: ImageId we are looking for features
+ * @param[out] out_featId the number of features in the image as a vector
+ * @return true if the vector of features Ids is not empty
+ */
+bool getFeatureIdInViewPerTrack(const TracksStore& tracksStore,
+                                       const std::set<std::size_t>& trackIds,
+                                       IndexT viewId,
+                                       std::vector<FeatureId>* out_featId);
 
 struct FunctorMapFirstEqual : public std::unary_function <TracksMap , bool>
 {
@@ -150,6 +244,14 @@ void tracksToIndexedMatches(const TracksMap& tracks,
 void tracksLength(const TracksMap& tracks,
                          std::map<std::size_t, std::size_t>& occurenceTrackLength);
 
+/**
+ * @brief Return the occurrence of tracks length.
+ * @param[in] tracksStore all tracks of the scene
+ * @param[out] occurenceTrackLength : the occurence length of each trackId in the scene
+ */
+void tracksLength(const TracksStore& tracksStore,
+                         std::map<std::size_t, std::size_t>& occurenceTrackLength);
+
 /**
  * @brief Return a set containing the image Id considered in the tracks container.
  * @param[in] tracksPerView the visible tracks as a map {viewID, vector<trackID>}
@@ -166,5 +268,13 @@ void imageIdInTracks(const TracksPerView& tracksPerView,
 void imageIdInTracks(const TracksMap& tracks,
                             std::set<std::size_t>& imagesId);
 
+/**
+ * @brief Return a set containing the image Id considered in the tracks container.
+ * @param[in] tracksStore all tracks of the scene
+ * @param[out] imagesId set of images considered in the tracks container.
+ */
+void imageIdInTracks(const TracksStore& tracksStore,
+                            std::set<std::size_t>& imagesId);
+
 } // namespace track
 } // namespace aliceVision
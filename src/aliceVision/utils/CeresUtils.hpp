@@ -21,6 +21,10 @@ namespace utils {
 // See https://github.com/ceres-solver/ceres-solver/commit/2335b5b4b7a4703ca9458aa275ca878945763a34
 #define ALICEVISION_CERES_HAS_CXSPARSE ((CERES_VERSION_MAJOR * 100 + CERES_VERSION_MINOR) <= 201)
 
+// Ceres supports CUDA dense linear algebra since 2.1 and CUDA sparse linear algebra (cuDSS) since 2.3
+#define ALICEVISION_CERES_HAS_CUDA_DENSE ((CERES_VERSION_MAJOR * 100 + CERES_VERSION_MINOR) >= 201)
+#define ALICEVISION_CERES_HAS_CUDA_SPARSE ((CERES_VERSION_MAJOR * 100 + CERES_VERSION_MINOR) >= 203)
+
 #if ALICEVISION_CERES_HAS_MANIFOLD
 using CeresManifold = ceres::Manifold;
 #else
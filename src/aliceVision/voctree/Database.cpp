@@ -8,10 +8,14 @@
 #include <aliceVision/system/ProgressDisplay.hpp>
 #include <boost/accumulators/accumulators.hpp>
 #include <boost/accumulators/statistics/tail.hpp>
+#include <algorithm>
 #include <cmath>
 #include <fstream>
 #include <stdexcept>
+#include <boost/filesystem.hpp>
 #include <boost/format.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <cstring>
 
 namespace aliceVision{
 namespace voctree{
@@ -37,6 +41,76 @@ std::ostream& operator<<(std::ostream& os, const DocMatches& matches)
     return os;
 }
 
+namespace {
+
+/// Magic number of the database files, followed by the version and the key
+const char databaseFileMagic[8] = {'A', 'V', 'V', 'T', 'D', 'B', '\0', '\0'};
+/// Increment when the content of the database files changes
+const uint32_t databaseFileVersion = 2;
+
+template<typename T>
+void writeValue(std::ostream& out, T value)
+{
+  out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+enum class EDistanceMethod
+{
+  CLASSIC,
+  COMMON_POINTS,
+  STRONG_COMMON_POINTS,
+  WEIGHTED_STRONG_COMMON_POINTS,
+  INVERSED_WEIGHTED_COMMON_POINTS
+};
+
+EDistanceMethod distanceMethodFromString(const std::string& distanceMethod)
+{
+  if(distanceMethod == "classic")
+    return EDistanceMethod::CLASSIC;
+  if(distanceMethod == "commonPoints")
+    return EDistanceMethod::COMMON_POINTS;
+  if(distanceMethod == "strongCommonPoints")
+    return EDistanceMethod::STRONG_COMMON_POINTS;
+  if(distanceMethod == "weightedStrongCommonPoints")
+    return EDistanceMethod::WEIGHTED_STRONG_COMMON_POINTS;
+  if(distanceMethod == "inversedWeightedCommonPoints")
+    return EDistanceMethod::INVERSED_WEIGHTED_COMMON_POINTS;
+  throw std::invalid_argument("distance method "+ distanceMethod +" unknown!");
+}
+
+inline void encodeVarint(uint32_t value, std::vector<uint8_t>& out)
+{
+  while(value >= 0x80)
+  {
+    out.push_back(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<uint8_t>(value));
+}
+
+inline uint32_t decodeVarint(const uint8_t*& in)
+{
+  uint32_t value = 0;
+  int shift = 0;
+  while(*in & 0x80)
+  {
+    value |= static_cast<uint32_t>(*in++ & 0x7f) << shift;
+    shift += 7;
+  }
+  value |= static_cast<uint32_t>(*in++) << shift;
+  return value;
+}
+
+} // namespace
+
+void Database::InvertedFile::append(uint32_t document, uint32_t count)
+{
+  encodeVarint(nbDocuments == 0 ? document : document - lastDocument, postings);
+  encodeVarint(count, postings);
+  lastDocument = document;
+  ++nbDocuments;
+}
+
 Database::Database(uint32_t num_words)
 : word_files_(num_words),
 word_weights_( num_words, 1.0f ) { }
@@ -46,22 +120,57 @@ DocId Database::insert(DocId doc_id, const SparseHistogram& document)
   // Ensure that the new document to insert is not already there.
   assert(database_.find(doc_id) == database_.end());
 
-  // For each word, retrieve its inverted file and increment the count for doc_id.
+  // the documents are indexed in insertion order, so each inverted file stays sorted
+  const uint32_t docIndex = document_ids_.size();
+  uint32_t docSize = 0;
+
+  // For each word, append the document and the word count to its inverted file.
   for(SparseHistogram::const_iterator it = document.begin(), end = document.end(); it != end; ++it)
   {
     Word word = it->first;
-    InvertedFile& file = word_files_[word];
-    if(file.empty() || file.back().id != doc_id)
-      file.push_back(WordFrequency(doc_id, it->second.size()));
-    else
-      file.back().count += it->second.size();
+    word_files_[word].append(docIndex, it->second.size());
+    docSize += it->second.size();
   }
 
+  document_indices_[doc_id] = docIndex;
+  document_ids_.push_back(doc_id);
+  document_sizes_.push_back(docSize);
   database_[doc_id] = document;
 
   return doc_id;
 }
 
+bool Database::remove(DocId doc_id)
+{
+  const auto it = document_indices_.find(doc_id);
+  if(it == document_indices_.end())
+    return false;
+
+  // the postings of the document stay in the inverted files, the document index is not ranked anymore
+  document_ids_[it->second] = UndefinedIndexT;
+  document_indices_.erase(it);
+  database_.erase(doc_id);
+  ++nb_removed_documents_;
+
+  if(nb_removed_documents_ > database_.size())
+    compact();
+  return true;
+}
+
+void Database::compact()
+{
+  const SparseHistogramPerImage documents = std::move(database_);
+  word_files_.assign(word_files_.size(), InvertedFile());
+  document_ids_.clear();
+  document_sizes_.clear();
+  document_indices_.clear();
+  database_.clear();
+  nb_removed_documents_ = 0;
+
+  for(const auto& document : documents)
+    insert(document.first, document.second);
+}
+
 void Database::sanityCheck(std::size_t N, std::map<std::size_t, DocMatches>& matches) const
 {
   // if N is equal to zero
@@ -120,19 +229,134 @@ void Database::find(const std::vector<Word>& document, std::size_t N, std::vecto
  * @param[in] distanceMethod the method used to compute distance between histograms.
  */
 void Database::find( const SparseHistogram& query, std::size_t N, std::vector<DocMatch>& matches, const std::string &distanceMethod) const
+{
+    std::vector<float> scores;
+    find(query, N, matches, scores, distanceMethod);
+}
+
+void Database::find(const SparseHistogram& query, std::size_t N, std::vector<DocMatch>& matches, std::vector<float>& scores, const std::string &distanceMethod) const
+{
+    findAmong(query, N, nullptr, matches, scores, distanceMethod);
+}
+
+void Database::find(const SparseHistogram& query, std::size_t N, const std::vector<DocId>& candidates, std::vector<DocMatch>& matches, std::vector<float>& scores, const std::string &distanceMethod) const
+{
+    findAmong(query, N, &candidates, matches, scores, distanceMethod);
+}
+
+void Database::findAmong(const SparseHistogram& query, std::size_t N, const std::vector<DocId>* candidates, std::vector<DocMatch>& matches, std::vector<float>& scores, const std::string& distanceMethod) const
 {
     matches.clear();
-    matches.reserve(database_.size());
-    for(const auto& document : database_)
+    const EDistanceMethod method = distanceMethodFromString(distanceMethod);
+
+    // the indices of the ranked documents, all of them without candidates
+    std::vector<uint32_t> candidateIndices;
+    if(candidates)
     {
-        // for each document/image in the database compute the distance between the
-        // histograms of the query image and the others
-        const float distance = sparseDistance(query, document.second, distanceMethod, word_weights_);
-        matches.emplace_back(document.first, distance);
+        candidateIndices.reserve(candidates->size());
+        for(const DocId docId : *candidates)
+        {
+            const auto it = document_indices_.find(docId);
+            if(it != document_indices_.end())
+                candidateIndices.push_back(it->second);
+        }
     }
-    const std::size_t nMatches = std::min(N, matches.size());
-    std::partial_sort(matches.begin(), matches.begin() + nMatches, matches.end());
-    matches.resize(nMatches);
+    const std::size_t nbRanked = candidates ? candidateIndices.size() : document_ids_.size();
+    const auto getDocIndex = [&](std::size_t i) -> uint32_t { return candidates ? candidateIndices[i] : i; };
+
+    if(method == EDistanceMethod::WEIGHTED_STRONG_COMMON_POINTS)
+    {
+        // this distance does not only depend on the common words, all the documents are compared
+        matches.reserve(nbRanked);
+        for(std::size_t i = 0; i < nbRanked; ++i)
+        {
+            // for each document/image in the database compute the distance between the
+            // histograms of the query image and the others
+            const DocId docId = document_ids_[getDocIndex(i)];
+            if(docId == UndefinedIndexT)
+                continue;
+            const float distance = sparseDistance(query, database_.at(docId), distanceMethod, word_weights_);
+            matches.emplace_back(docId, distance);
+        }
+        const std::size_t nMatches = std::min(N, matches.size());
+        std::partial_sort(matches.begin(), matches.begin() + nMatches, matches.end());
+        matches.resize(nMatches);
+        return;
+    }
+
+    // accumulate the contribution of the common words of each document
+    scores.assign(document_ids_.size(), 0.0f);
+    float querySize = 0.0f;
+
+    for(const auto& wordPair : query)
+    {
+        const Word word = wordPair.first;
+        const uint32_t queryCount = wordPair.second.size();
+        querySize += queryCount;
+
+        if(word >= word_files_.size() ||
+           (method == EDistanceMethod::STRONG_COMMON_POINTS && queryCount != 1))
+            continue;
+
+        const InvertedFile& file = word_files_[word];
+        const uint8_t* posting = file.postings.data();
+        uint32_t docIndex = 0;
+
+        for(uint32_t i = 0; i < file.nbDocuments; ++i)
+        {
+            docIndex += decodeVarint(posting);
+            const uint32_t count = decodeVarint(posting);
+            const uint32_t minCount = std::min(queryCount, count);
+
+            switch(method)
+            {
+                case EDistanceMethod::CLASSIC:
+                case EDistanceMethod::COMMON_POINTS:
+                    scores[docIndex] += minCount;
+                    break;
+                case EDistanceMethod::STRONG_COMMON_POINTS:
+                    if(count == 1)
+                        scores[docIndex] += 1.0f;
+                    break;
+                case EDistanceMethod::INVERSED_WEIGHTED_COMMON_POINTS:
+                    scores[docIndex] += (1.f / minCount) * word_weights_[word];
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    // keep the N best documents in a heap, its top is the worst of them
+    const std::size_t nMatches = std::min(N, candidates ? nbRanked : database_.size());
+    if(nMatches == 0)
+        return;
+    matches.reserve(nMatches);
+
+    for(std::size_t i = 0; i < nbRanked; ++i)
+    {
+        const uint32_t docIndex = getDocIndex(i);
+        if(document_ids_[docIndex] == UndefinedIndexT)
+            continue;
+        // the L1 distance is the sum of the sizes minus twice the common counts
+        const float distance = (method == EDistanceMethod::CLASSIC) ?
+                               querySize + document_sizes_[docIndex] - 2.0f * scores[docIndex] :
+                               -scores[docIndex];
+        const DocMatch match(document_ids_[docIndex], distance);
+
+        if(matches.size() < nMatches)
+        {
+            matches.push_back(match);
+            std::push_heap(matches.begin(), matches.end());
+        }
+        else if(match < matches.front())
+        {
+            std::pop_heap(matches.begin(), matches.end());
+            matches.back() = match;
+            std::push_heap(matches.begin(), matches.end());
+        }
+    }
+    std::sort_heap(matches.begin(), matches.end());
 }
 
 /**
@@ -145,9 +369,16 @@ void Database::computeTfIdfWeights(float default_weight)
 {
   float N = (float) database_.size();
   std::size_t num_words = word_files_.size();
+
+  // the inverted files may still count removed documents
+  std::vector<std::size_t> nbDocuments(num_words, 0);
+  for(const auto& document : database_)
+    for(const auto& wordPair : document.second)
+      ++nbDocuments[wordPair.first];
+
   for(std::size_t i = 0; i < num_words; ++i)
   {
-    std::size_t Ni = word_files_[i].size();
+    std::size_t Ni = nbDocuments[i];
     if(Ni != 0)
       word_weights_[i] = std::log(N / Ni);
     else
@@ -183,6 +414,111 @@ void Database::loadWeights(const std::string& file)
   }
 }
 
+void Database::save(const std::string& file, std::size_t key) const
+{
+  // write in a temporary file and rename it once complete
+  const std::string tmpFile = file + "." + boost::filesystem::unique_path().string();
+  try
+  {
+    std::ofstream out;
+    out.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+    out.open(tmpFile, std::ios_base::binary);
+
+    out.write(databaseFileMagic, sizeof(databaseFileMagic));
+    writeValue<uint32_t>(out, databaseFileVersion);
+    writeValue<uint64_t>(out, key);
+    writeValue<uint32_t>(out, word_weights_.size());
+    out.write(reinterpret_cast<const char*>(word_weights_.data()), word_weights_.size() * sizeof(float));
+    writeValue<uint64_t>(out, database_.size());
+
+    // each document: its ID, its number of words, then each word, its number of features and their indices
+    for(const auto& document : database_)
+    {
+      writeValue<uint32_t>(out, document.first);
+      writeValue<uint32_t>(out, document.second.size());
+      for(const auto& wordPair : document.second)
+      {
+        writeValue<int32_t>(out, wordPair.first);
+        writeValue<uint32_t>(out, wordPair.second.size());
+        out.write(reinterpret_cast<const char*>(wordPair.second.data()), wordPair.second.size() * sizeof(IndexT));
+      }
+    }
+    out.close();
+    boost::filesystem::rename(tmpFile, file);
+  }
+  catch(const std::exception& e)
+  {
+    boost::system::error_code ec;
+    boost::filesystem::remove(tmpFile, ec);
+    throw std::runtime_error("Cannot write the database file '" + file + "': " + e.what());
+  }
+}
+
+bool Database::load(const std::string& file, std::size_t key)
+{
+  boost::iostreams::mapped_file_source mappedFile;
+  try
+  {
+    mappedFile.open(file);
+  }
+  catch(const std::exception& e)
+  {
+    throw std::runtime_error("Cannot read the database file '" + file + "': " + e.what());
+  }
+
+  const char* data = mappedFile.data();
+  const char* const end = data + mappedFile.size();
+  const auto read = [&](void* value, std::size_t size) {
+    if(end - data < static_cast<std::ptrdiff_t>(size))
+      throw std::runtime_error("Truncated database file '" + file + "'.");
+    std::memcpy(value, data, size);
+    data += size;
+  };
+  const auto readUInt32 = [&]() { uint32_t value; read(&value, sizeof(value)); return value; };
+
+  // the documents of another vocabulary or of another file version are not read
+  char magic[sizeof(databaseFileMagic)];
+  read(magic, sizeof(magic));
+  if(std::memcmp(magic, databaseFileMagic, sizeof(magic)) != 0 || readUInt32() != databaseFileVersion)
+    return false;
+  uint64_t fileKey;
+  read(&fileKey, sizeof(fileKey));
+  if(fileKey != key)
+    return false;
+
+  const uint32_t num_words = readUInt32();
+  Database database(num_words);
+  read(database.word_weights_.data(), num_words * sizeof(float));
+
+  uint64_t nbDocuments;
+  read(&nbDocuments, sizeof(nbDocuments));
+  for(uint64_t d = 0; d < nbDocuments; ++d)
+  {
+    const DocId docId = readUInt32();
+    const uint32_t nbWords = readUInt32();
+
+    SparseHistogram document;
+    for(uint32_t w = 0; w < nbWords; ++w)
+    {
+      Word word;
+      read(&word, sizeof(word));
+      if(word < 0 || static_cast<uint32_t>(word) >= num_words)
+        throw std::runtime_error("Invalid word in the database file '" + file + "'.");
+      std::vector<IndexT>& features = document[word];
+      const uint32_t nbFeatures = readUInt32();
+      if(static_cast<std::size_t>(end - data) < nbFeatures * sizeof(IndexT))
+        throw std::runtime_error("Truncated database file '" + file + "'.");
+      features.resize(nbFeatures);
+      read(features.data(), features.size() * sizeof(IndexT));
+    }
+    database.insert(docId, document);
+  }
+
+  // the current documents are only replaced by a complete file
+  *this = std::move(database);
+  return true;
+}
+
 ///**
 // * Normalize a document vector representing the histogram of visual words for a given image
 // * 
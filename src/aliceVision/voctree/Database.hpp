@@ -10,8 +10,10 @@
 #include <aliceVision/types.hpp>
 
 #include <map>
+#include <cstdint>
 #include <cstddef>
 #include <string>
+#include <vector>
 
 namespace aliceVision{
 namespace voctree{
@@ -56,6 +58,8 @@ std::ostream& operator<<(std::ostream& os, const DocMatches& matches);
 /**
  * @brief Class for efficiently matching a bag-of-words representation of a document (image) against
  * a database of known documents.
+ *
+ * The documents are indexed by an inverted file: the query only visits the documents sharing its words.
  */
 class Database
 {
@@ -77,6 +81,16 @@ public:
    */
   DocId insert(DocId doc_id, const SparseHistogram& document);
 
+  /**
+   * @brief Remove a document.
+   * The inverted files keep the removed documents, they are rebuilt once the removed documents
+   * are more than the others.
+   *
+   * @param doc_id ID of the document to remove
+   * \return false if the document is not in the database.
+   */
+  bool remove(DocId doc_id);
+
   /**
    * @brief Perform a sanity check of the database by querying each document
    * of the database and finding its top N matches
@@ -106,6 +120,30 @@ public:
    */
   void find(const SparseHistogram& query, std::size_t N, std::vector<DocMatch>& matches, const std::string &distanceMethod = "strongCommonPoints") const;
 
+  /**
+   * @brief Find the top N matches in the database for the query document,
+   * with a scoring buffer reused across the queries of a thread.
+   *
+   * @param[in] query The query document, a normalized set of quantized words.
+   * @param[in] N        The number of matches to return.
+   * @param[out] matches  IDs and scores for the top N matching database documents.
+   * @param[in,out] scores the scoring buffer, resized to the number of documents
+   * @param[in] distanceMethod distance method (norm L1, etc.)
+   */
+  void find(const SparseHistogram& query, std::size_t N, std::vector<DocMatch>& matches, std::vector<float>& scores, const std::string &distanceMethod = "strongCommonPoints") const;
+
+  /**
+   * @brief Find the top N matches among some documents of the database for the query document.
+   *
+   * @param[in] query The query document, a normalized set of quantized words.
+   * @param[in] N        The number of matches to return.
+   * @param[in] candidates the IDs of the documents to rank, the IDs not in the database are ignored
+   * @param[out] matches  IDs and scores for the top N matching candidate documents.
+   * @param[in,out] scores the scoring buffer, resized to the number of documents
+   * @param[in] distanceMethod distance method (norm L1, etc.)
+   */
+  void find(const SparseHistogram& query, std::size_t N, const std::vector<DocId>& candidates, std::vector<DocMatch>& matches, std::vector<float>& scores, const std::string &distanceMethod = "strongCommonPoints") const;
+
   /**
    * @brief Compute the TF-IDF weights of all the words. To be called after inserting a corpus of
    * training examples into the database.
@@ -125,9 +163,24 @@ public:
   /// Load the vocabulary word weights from a file.
   void loadWeights(const std::string& file);
 
-  // Save weights and documents
-  //void save(const std::string& file) const;
-  //void load(const std::string& file);
+  /**
+   * @brief Save the weights and the documents to a binary file.
+   * The file is written in a temporary file renamed once complete.
+   * @param[in] file the database file path
+   * @param[in] key the identifier of the vocabulary of the documents, checked by load()
+   * @throws std::runtime_error if the file cannot be written
+   */
+  void save(const std::string& file, std::size_t key = 0) const;
+
+  /**
+   * @brief Load the weights and the documents of a file written by save(), replacing the current ones.
+   * The file is memory mapped and the inverted files are built from the documents.
+   * @param[in] file the database file path
+   * @param[in] key the identifier of the vocabulary of the documents given to save()
+   * @return false if the file has another key or another version, the current documents are kept
+   * @throws std::runtime_error if the file cannot be read or is invalid
+   */
+  bool load(const std::string& file, std::size_t key = 0);
 
   const SparseHistogramPerImage& getSparseHistogramPerImage() const
   {
@@ -136,28 +189,37 @@ public:
   
 private:
 
-  struct WordFrequency
+  /**
+   * @brief The documents containing a word, in increasing order of document index.
+   * Each posting is the difference with the previous document index then the word count
+   * in the document, both varint encoded.
+   */
+  struct InvertedFile
   {
-    DocId id;
-    uint32_t count;
-
-    WordFrequency() = default;
-    WordFrequency(DocId _id, uint32_t _count)
-      : id(_id)
-      , count(_count)
-    {}
-  };
+    std::vector<uint8_t> postings;
+    uint32_t nbDocuments = 0;
+    uint32_t lastDocument = 0;
 
-  // Stored in increasing order by DocId
-  typedef std::vector<WordFrequency> InvertedFile;
+    void append(uint32_t document, uint32_t count);
+  };
 
   /// @todo Use sorted vector?
   // typedef std::vector< std::pair<Word, float> > DocumentVector;
   
   friend std::ostream& operator<<(std::ostream& os, const SparseHistogram& dv);
 
+  /// Rebuild the inverted files without the removed documents
+  void compact();
+
+  /// Find the top N matches among the candidate documents, or all of them if null
+  void findAmong(const SparseHistogram& query, std::size_t N, const std::vector<DocId>* candidates, std::vector<DocMatch>& matches, std::vector<float>& scores, const std::string& distanceMethod) const;
+
   std::vector<InvertedFile> word_files_;
   std::vector<float> word_weights_;
+  std::vector<DocId> document_ids_; // by document index, in insertion order, UndefinedIndexT once removed
+  std::vector<uint32_t> document_sizes_; // number of words by document index
+  std::map<DocId, uint32_t> document_indices_; // document index by document ID
+  std::size_t nb_removed_documents_ = 0; // removed documents still in the inverted files
   SparseHistogramPerImage database_; // Precomputed for inserted documents
 
   /**
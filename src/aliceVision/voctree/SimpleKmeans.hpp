@@ -10,6 +10,8 @@
 #include "DefaultAllocator.hpp"
 
 #include <aliceVision/alicevision_omp.hpp>
+#include <aliceVision/feature/Descriptor.hpp>
+#include <aliceVision/feature/metricSIMD.hpp>
 #include <aliceVision/system/Logger.hpp>
 
 #include <boost/function.hpp>
@@ -278,10 +280,61 @@ bool checkVectorElements(const std::vector<Feature, FeatureAllocator> &f, const
   return correct;
 }
 
+/**
+ * @brief Find the nearest center of a feature, with one distance computation per center.
+ */
+template<class Feature, class Distance, class FeatureAllocator>
+struct NearestCenter
+{
+  static unsigned int find(const Feature& feature, const std::vector<Feature, FeatureAllocator>& centers, const Distance& distance)
+  {
+    typename Distance::result_type d_min = std::numeric_limits<typename Distance::result_type>::max();
+    unsigned int nearest = 0;
+
+    for(unsigned int j = 0; j < centers.size(); ++j)
+    {
+      const typename Distance::result_type d = distance(feature, centers[j]);
+      if(d < d_min)
+      {
+        d_min = d;
+        nearest = j;
+      }
+    }
+    return nearest;
+  }
+};
+
+/**
+ * @brief Find the nearest center of a float descriptor with the SIMD distance kernels,
+ *        the centers are contiguous float rows.
+ */
+template<std::size_t N, class FeatureAllocator>
+struct NearestCenter<feature::Descriptor<float, N>, L2<feature::Descriptor<float, N>, feature::Descriptor<float, N>>, FeatureAllocator>
+{
+  typedef feature::Descriptor<float, N> Feature;
+  static_assert(sizeof(Feature) == N * sizeof(float), "The descriptors should be stored as contiguous float rows.");
+
+  static unsigned int find(const Feature& feature, const std::vector<Feature, FeatureAllocator>& centers, const L2<Feature, Feature>&)
+  {
+    thread_local std::vector<float> distances;
+    distances.resize(centers.size());
+    feature::simd::squaredL2Distances(feature.getData(), centers.front().getData(), centers.size(), N, distances.data());
+    return static_cast<unsigned int>(std::min_element(distances.begin(), distances.end()) - distances.begin());
+  }
+};
+
 /**
  * @brief Class for performing K-means clustering, optimized for a particular feature type and metric.
  *
  * The standard Lloyd's algorithm is used. By default, cluster centers are initialized randomly.
+ * If a mini-batch size is set, the mini-batch K-means is used instead on the large feature sets:
+ *
+ *  Sculley, D. (2010). "Web-scale k-means clustering"
+ *  Proceedings of the 19th international conference on World Wide Web, pp. 1177–1178.
+ *
+ * Each iteration assigns a random batch of features, each center moves to the mean of all the features
+ * assigned to it so far (per-center learning rate 1/count). The centers are seeded on a random subset
+ * of 3 batches and all the features are assigned to the final centers.
  */
 template<class Feature,
          class Distance = L2<Feature, Feature>,
@@ -329,6 +382,18 @@ public:
     restarts_ = restarts;
   }
 
+  std::size_t getMiniBatchSize() const
+  {
+    return mini_batch_size_;
+  }
+
+  /// Set the number of features per mini-batch iteration, 0 for the standard Lloyd's algorithm.
+
+  void setMiniBatchSize(std::size_t miniBatchSize)
+  {
+    mini_batch_size_ = miniBatchSize;
+  }
+
   int getVerbose() const
   {
     return verbose_;
@@ -372,11 +437,36 @@ private:
                                     std::vector<Feature, FeatureAllocator>& centers,
                                     std::vector<unsigned int>& membership) const;
 
+  squared_distance_type clusterMiniBatch(const std::vector<Feature*>& features, std::size_t k,
+                                         std::vector<Feature, FeatureAllocator>& centers,
+                                         std::vector<unsigned int>& membership) const;
+
+  /**
+   * @brief Assign each feature to its nearest center, the features are processed in parallel.
+   *
+   * @param      features   The features to assign.
+   * @param      centers    The current centers.
+   * @param[in,out] membership Cluster assignment for each feature
+   * @param[out] sums       Sum of the features assigned to each center
+   * @param[out] counts     Number of features assigned to each center
+   * @return the number of features whose assignment changed
+   */
+  std::size_t assign(const std::vector<Feature*>& features,
+                     const std::vector<Feature, FeatureAllocator>& centers,
+                     std::vector<unsigned int>& membership,
+                     std::vector<Feature, FeatureAllocator>& sums,
+                     std::vector<std::size_t>& counts) const;
+
+  squared_distance_type computeSSE(const std::vector<Feature*>& features,
+                                   const std::vector<Feature, FeatureAllocator>& centers,
+                                   const std::vector<unsigned int>& membership) const;
+
   Feature zero_;
   Distance distance_;
   Initializer choose_centers_;
   std::size_t max_iterations_;
   std::size_t restarts_;
+  std::size_t mini_batch_size_;
   int verbose_;
 };
 
@@ -388,7 +478,8 @@ distance_(d),
 choose_centers_(InitKmeanspp()),
 max_iterations_(100),
 verbose_(verbose),
-restarts_(1)
+restarts_(1),
+mini_batch_size_(0)
 {
 }
 
@@ -415,13 +506,28 @@ SimpleKmeans<Feature, Distance, FeatureAllocator>::clusterPointers(const std::ve
   new_centers.resize(k);
   std::vector<unsigned int> new_membership(features.size());
 
+  const bool useMiniBatch = (mini_batch_size_ > 0) && (features.size() > 3 * mini_batch_size_);
+
   squared_distance_type least_sse = std::numeric_limits<squared_distance_type>::max();
   assert(restarts_ > 0);
   for(std::size_t starts = 0; starts < restarts_; ++starts)
   {
     if(verbose_ > 0) ALICEVISION_LOG_DEBUG("Trial " << starts + 1 << "/" << restarts_);
-    choose_centers_(features, k, new_centers, distance_, verbose_);
-    squared_distance_type sse = clusterOnce(features, k, new_centers, new_membership);
+    squared_distance_type sse;
+    if(useMiniBatch)
+    {
+      // seed the centers on a random subset, the initializer cost is proportional to the number of features
+      std::vector<Feature*> seeding_features(3 * mini_batch_size_);
+      for(Feature*& f : seeding_features)
+        f = features[rand() % features.size()];
+      choose_centers_(seeding_features, k, new_centers, distance_, verbose_);
+      sse = clusterMiniBatch(features, k, new_centers, new_membership);
+    }
+    else
+    {
+      choose_centers_(features, k, new_centers, distance_, verbose_);
+      sse = clusterOnce(features, k, new_centers, new_membership);
+    }
     if(verbose_ > 0) ALICEVISION_LOG_DEBUG("End of Trial " << starts + 1 << "/" << restarts_);
     if(sse < least_sse)
     {
@@ -436,82 +542,93 @@ SimpleKmeans<Feature, Distance, FeatureAllocator>::clusterPointers(const std::ve
   return least_sse;
 }
 
+template < class Feature, class Distance, class FeatureAllocator >
+std::size_t SimpleKmeans<Feature, Distance, FeatureAllocator>::assign(const std::vector<Feature*>& features,
+                                                                      const std::vector<Feature, FeatureAllocator>& centers,
+                                                                      std::vector<unsigned int>& membership,
+                                                                      std::vector<Feature, FeatureAllocator>& sums,
+                                                                      std::vector<std::size_t>& counts) const
+{
+  const std::size_t k = centers.size();
+
+  // On small problems enabling multithreading does much more harm than good because thread
+  // creation is relatively expensive.
+  const bool enableMultithreading = features.size() * k > 1000000;
+  const int nbThreads = enableMultithreading ? omp_get_max_threads() : 1;
+
+  // per thread accumulators, the assignment loop does not lock the centers
+  std::vector<std::vector<Feature, FeatureAllocator>> threadSums(nbThreads, std::vector<Feature, FeatureAllocator>(k, zero_));
+  std::vector<std::vector<std::size_t>> threadCounts(nbThreads, std::vector<std::size_t>(k, 0));
+  std::size_t nbChanged = 0;
+
+  #pragma omp parallel for reduction(+:nbChanged) num_threads(nbThreads)
+  for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(features.size()); ++i)
+  {
+    // @todo if k is large, let's say k>100 use FLAAN to retrieve the
+    // cluster center
+    const unsigned int nearest = NearestCenter<Feature, Distance, FeatureAllocator>::find(*features[i], centers, distance_);
+
+    // Assign feature i to the cluster it is nearest to
+    if(membership[i] != nearest)
+    {
+      ++nbChanged;
+      membership[i] = nearest;
+    }
+    // Accumulate the cluster center and its membership count
+    const int t = omp_get_thread_num();
+    threadSums[t][nearest] += *features[i];
+    ++threadCounts[t][nearest];
+  }
+
+  sums = threadSums.front();
+  counts = threadCounts.front();
+  for(int t = 1; t < nbThreads; ++t)
+  {
+    for(std::size_t j = 0; j < k; ++j)
+    {
+      sums[j] += threadSums[t][j];
+      counts[j] += threadCounts[t][j];
+    }
+  }
+  return nbChanged;
+}
+
+template < class Feature, class Distance, class FeatureAllocator >
+typename SimpleKmeans<Feature, Distance, FeatureAllocator>::squared_distance_type
+SimpleKmeans<Feature, Distance, FeatureAllocator>::computeSSE(const std::vector<Feature*>& features,
+                                                              const std::vector<Feature, FeatureAllocator>& centers,
+                                                              const std::vector<unsigned int>& membership) const
+{
+  /// @todo Kahan summation?
+  squared_distance_type sse = squared_distance_type(0);
+  assert(features.size() > 0);
+
+  #pragma omp parallel for reduction(+:sse) if(features.size() > 100000)
+  for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(features.size()); ++i)
+  {
+    sse += distance_(*features[i], centers[membership[i]]);
+  }
+  return sse;
+}
+
 template < class Feature, class Distance, class FeatureAllocator >
 typename SimpleKmeans<Feature, Distance, FeatureAllocator>::squared_distance_type
 SimpleKmeans<Feature, Distance, FeatureAllocator>::clusterOnce(const std::vector<Feature*>& features, std::size_t k,
                                                                std::vector<Feature, FeatureAllocator>& centers,
                                                                std::vector<unsigned int>& membership) const
 {
-  typedef typename std::vector<Feature, FeatureAllocator>::value_type centerType;
-  typedef typename Distance::value_type feature_value_type;
-
   std::vector<std::size_t> new_center_counts(k);
   std::vector<Feature, FeatureAllocator> new_centers(k);
-  std::vector<std::mutex> centersLocks(k);
   squared_distance_type max_center_shift = std::numeric_limits<squared_distance_type>::max();
 
   if(verbose_ > 0) ALICEVISION_LOG_DEBUG("Iterations");
   for(std::size_t iter = 0; iter < max_iterations_; ++iter)
   {
     if(verbose_ > 0) ALICEVISION_LOG_DEBUG("*");
-    // Zero out new centers and counts
-    std::fill(new_center_counts.begin(), new_center_counts.end(), 0);
-    //		for(std::size_t i = 0; i < k; checkElements(new_centers[i++], "bef"));
-    std::fill(new_centers.begin(), new_centers.end(), zero_);
-    //		for(std::size_t i = 0; i < k; checkElements(new_centers[i++], "aft"));
-    assert(checkVectorElements(new_centers, "newcenters init"));
-    bool is_stable = true;
-
-    // On small problems enabling multithreading does much more harm than good because thread
-    // creation is relatively expensive.
-    // TODO: Ideally a thread pool would be created before the first iteration and the iterations
-    // would reuse the existing threads.
-    bool enableMultithreading = features.size() * k > 1000000;
 
     // Assign data objects to current centers
-    #pragma omp parallel for shared( new_centers, new_center_counts, features, centers, membership) if(enableMultithreading)
-    for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(features.size()); ++i)
-    {
-      squared_distance_type d_min = std::numeric_limits<squared_distance_type>::max();
-      unsigned int nearest = 0;
-      bool found = false;
-
-      // @todo if k is large, let's say k>100 use FLAAN to retrieve the 
-      // cluster center
-
-      // Find the nearest cluster center to feature i
-      for(unsigned int j = 0; j < k; ++j)
-      {
-        squared_distance_type distance = distance_(*features[i], centers[j]);
-        //		printf("\t\tdistance %f\n", (float)distance);
-        //		PrintFeat(*features[i] );
-        if(distance < d_min)
-        {
-          d_min = distance;
-          nearest = j;
-          found = true;
-        }
-        //		 printf("\t distance %f %f\n", (double)distance, (double)d_min);
-      }
-      assert(found);
-      // Assign feature i to the cluster it is nearest to
-      if(membership[i] != nearest)
-      {
-        is_stable = false;
-        membership[i] = nearest;
-      }
-      // Accumulate the cluster center and its membership count
-      //	  printf("\t nearest %d\n", nearest);
-      //			checkElements(*features[i], "feat");
-      {
-        std::lock_guard<std::mutex> lock{centersLocks[nearest]};
-        new_centers[nearest] += *features[i];
-        //			checkElements(new_centers[nearest], "sum");
-        //	  printf("\t new_centers[nearest] += *features[i];\n");
-        ++new_center_counts[nearest];
-        //	  printf("\taccumulate\n");
-      }
-    }//for
+    const bool is_stable = (assign(features, centers, membership, new_centers, new_center_counts) == 0);
+    assert(checkVectorElements(new_centers, "newcenters"));
 
     if(is_stable) break;
 
@@ -522,9 +639,6 @@ SimpleKmeans<Feature, Distance, FeatureAllocator>::clusterOnce(const std::vector
     {
       if(new_center_counts[i] > 0)
       {
-        //		  printf("%d - %d\n", i, new_center_counts[i] );
-        //		  PrintFeat(new_centers[i] );
-        //		checkElements(new_centers[i], "bef");
         new_centers[i] = new_centers[i] / new_center_counts[i];
 
         squared_distance_type shift = distance_(new_centers[i], centers[i]);
@@ -532,9 +646,6 @@ SimpleKmeans<Feature, Distance, FeatureAllocator>::clusterOnce(const std::vector
         max_center_shift = std::max(max_center_shift, shift);
 
         centers[i] = new_centers[i];
-        //					centers[i] = new_centers[i] / new_center_counts[i];
-        //		checkElements(new_centers[i], "aft");
-        //		PrintFeat(centers[i] );
       }
       else
       {
@@ -545,20 +656,60 @@ SimpleKmeans<Feature, Distance, FeatureAllocator>::clusterOnce(const std::vector
         ALICEVISION_LOG_DEBUG("Choosing a new center: " << index);
       }
     }
-    //			ALICEVISION_LOG_DEBUG("max_center_shift: " << max_center_shift);  
     if(max_center_shift <= 10e-10) break;
   }
   if(verbose_ > 0) ALICEVISION_LOG_DEBUG("");
 
   // Return the sum squared error
-  /// @todo Kahan summation?
-  squared_distance_type sse = squared_distance_type(0);
-  assert(features.size() > 0);
-  for(std::size_t i = 0; i < features.size(); ++i)
+  return computeSSE(features, centers, membership);
+}
+
+template < class Feature, class Distance, class FeatureAllocator >
+typename SimpleKmeans<Feature, Distance, FeatureAllocator>::squared_distance_type
+SimpleKmeans<Feature, Distance, FeatureAllocator>::clusterMiniBatch(const std::vector<Feature*>& features, std::size_t k,
+                                                                    std::vector<Feature, FeatureAllocator>& centers,
+                                                                    std::vector<unsigned int>& membership) const
+{
+  // sum and number of all the features assigned to each center so far
+  std::vector<Feature, FeatureAllocator> cumulated_sums(k, zero_);
+  std::vector<std::size_t> cumulated_counts(k, 0);
+
+  std::vector<Feature*> batch(mini_batch_size_);
+  std::vector<unsigned int> batch_membership(mini_batch_size_);
+  std::vector<Feature, FeatureAllocator> batch_sums;
+  std::vector<std::size_t> batch_counts;
+
+  if(verbose_ > 0) ALICEVISION_LOG_DEBUG("Mini-batch iterations");
+  for(std::size_t iter = 0; iter < max_iterations_; ++iter)
   {
-    sse += distance_(*features[i], centers[membership[i]]);
+    for(Feature*& f : batch)
+      f = features[rand() % features.size()];
+
+    assign(batch, centers, batch_membership, batch_sums, batch_counts);
+
+    squared_distance_type max_center_shift = 0;
+    for(std::size_t i = 0; i < k; ++i)
+    {
+      // the centers without any assigned feature keep their seed
+      if(batch_counts[i] == 0)
+        continue;
+
+      cumulated_sums[i] += batch_sums[i];
+      cumulated_counts[i] += batch_counts[i];
+
+      const Feature new_center = cumulated_sums[i] / cumulated_counts[i];
+      max_center_shift = std::max(max_center_shift, distance_(new_center, centers[i]));
+      centers[i] = new_center;
+    }
+    if(max_center_shift <= 10e-10) break;
   }
-  return sse;
+
+  // Assign all the features to the final centers
+  std::fill(membership.begin(), membership.end(), 0);
+  assign(features, centers, membership, batch_sums, batch_counts);
+
+  // Return the sum squared error
+  return computeSSE(features, centers, membership);
 }
 
 }
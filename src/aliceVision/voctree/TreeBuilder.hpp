@@ -8,6 +8,9 @@
 
 #include "MutableVocabularyTree.hpp"
 #include "SimpleKmeans.hpp"
+
+#include <aliceVision/alicevision_omp.hpp>
+
 #include <deque>
 //#include <cstdio> //DEBUG
 
@@ -79,19 +82,38 @@ public:
     return verbose_;
   }
 
+  /**
+   * @brief Cluster the sibling subsets of a level in parallel.
+   *
+   * The k-means of each subset then runs on a single thread, so it is only used when a level
+   * has at least as many subsets as threads. The random seeding depends on the threads scheduling,
+   * the built tree is not reproducible.
+   */
+  void setParallelSubtrees(bool parallelSubtrees)
+  {
+    parallelSubtrees_ = parallelSubtrees;
+  }
+
+  bool getParallelSubtrees() const
+  {
+    return parallelSubtrees_;
+  }
+
 protected:
   Tree tree_;
   Kmeans kmeans_;
   Feature zero_;
 private:
   unsigned char verbose_;
+  bool parallelSubtrees_;
 };
 
 template<class Feature, template<typename, typename> class DistanceT, class FeatureAllocator>
 TreeBuilder<Feature, DistanceT, FeatureAllocator>::TreeBuilder(const Feature& zero, Distance d, unsigned char verbose)
 : kmeans_(zero, d, verbose),
 zero_(zero),
-verbose_(verbose)
+verbose_(verbose),
+parallelSubtrees_(false)
 {
 }
 
@@ -118,16 +140,33 @@ void TreeBuilder<Feature, DistanceT, FeatureAllocator>::build(const FeatureVecto
       feature_ptrs.push_back(const_cast<Feature*> (&f));
     }
   }
-  FeatureVector centers; // always size k
   for(uint32_t level = 0; level < levels; ++level)
   {
     if(verbose_) printf("# Level %u\n", level);
-    std::vector<unsigned int> membership;
 
-    for(std::size_t i = 0, ie = subset_queue.size(); i < ie; ++i)
+    const std::size_t nbSubsets = subset_queue.size();
+
+    // Cluster the subsets of the level, they are disjoint so the siblings are independent.
+    std::vector<FeatureVector> subsetCenters(nbSubsets); // always size k
+    std::vector< std::vector<unsigned int> > subsetMembership(nbSubsets);
+    const bool parallelLevel = parallelSubtrees_ && (nbSubsets >= static_cast<std::size_t>(omp_get_max_threads()));
+
+    #pragma omp parallel for schedule(dynamic) if(parallelLevel)
+    for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(nbSubsets); ++i)
+    {
+      const std::vector<Feature*> &subset = subset_queue[i];
+      if(subset.size() <= k)
+        continue;
+
+      // Cluster the current subset into k centers.
+      if(verbose_ > 2) printf("#\tclustering the subset %ld of %lu elements into %d centers\n", i + 1, subset.size(), k);
+      kmeans_.clusterPointers(subset, k, subsetCenters[i], subsetMembership[i]);
+    }
+
+    for(std::size_t i = 0; i < nbSubsets; ++i)
     {
       std::vector<Feature*> &subset = subset_queue.front();
-      if(verbose_ > 1) printf("#\tClustering subset %lu/%lu of size %lu\n", i + 1, ie, subset.size());
+      if(verbose_ > 1) printf("#\tSubset %lu/%lu of size %lu\n", i + 1, nbSubsets, subset.size());
 
       // If the subset already has k or fewer elements, just use those as the centers.
       if(subset.size() <= k)
@@ -148,9 +187,8 @@ void TreeBuilder<Feature, DistanceT, FeatureAllocator>::build(const FeatureVecto
       }
       else
       {
-        // Cluster the current subset into k centers.
-        if(verbose_ > 2) printf("#\tclustering the current subset of %lu elements into %d centers\n", subset.size(), k);
-        kmeans_.clusterPointers(subset, k, centers, membership);
+        const FeatureVector& centers = subsetCenters[i];
+        const std::vector<unsigned int>& membership = subsetMembership[i];
         // Add the centers and mark them as valid.
         tree_.centers().insert(tree_.centers().end(), centers.begin(), centers.end());
         tree_.validCenters().insert(tree_.validCenters().end(), k, 1);
@@ -0,0 +1,194 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "VisualWordsCache.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/functional/hash.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace fs = boost::filesystem;
+
+namespace aliceVision {
+namespace voctree {
+
+namespace {
+
+/// Increment when the content of the cache files changes
+const uint32_t visualWordsCacheVersion = 1;
+
+template<typename T>
+void writeValue(std::ostream& out, T value)
+{
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+T readValue(std::istream& in)
+{
+    T value;
+    in.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return value;
+}
+
+} // namespace
+
+std::size_t computeFileHash(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if(!file)
+        throw std::runtime_error("Cannot read the file '" + path + "' to compute its hash.");
+
+    std::size_t hash = 0;
+    std::vector<char> buffer(1024 * 1024);
+    while(file)
+    {
+        file.read(buffer.data(), buffer.size());
+        boost::hash_range(hash, buffer.begin(), buffer.begin() + file.gcount());
+    }
+    return hash;
+}
+
+VisualWordsCache::VisualWordsCache(const std::string& folder, const std::string& treeFilepath)
+  : _folder(folder)
+  , _treeHash(computeFileHash(treeFilepath))
+{
+    if(!fs::exists(_folder))
+        fs::create_directories(_folder);
+}
+
+std::string VisualWordsCache::getCacheFilePath(const std::string& descriptorsPath) const
+{
+    std::ostringstream filename;
+    filename << "words_" << std::hex << std::setfill('0')
+             << std::setw(16) << _treeHash << "_"
+             << std::setw(16) << boost::hash<std::string>()(fs::absolute(descriptorsPath).string()) << ".bin";
+    return (fs::path(_folder) / filename.str()).string();
+}
+
+bool VisualWordsCache::load(const std::string& descriptorsPath, std::size_t maxDescriptors, SparseHistogram& histogram)
+{
+    histogram.clear();
+
+    boost::system::error_code ec;
+    const std::time_t writeTime = fs::last_write_time(descriptorsPath, ec);
+    const std::uintmax_t fileSize = ec ? 0 : fs::file_size(descriptorsPath, ec);
+    const std::string cachePath = getCacheFilePath(descriptorsPath);
+
+    if(ec || !fs::exists(cachePath))
+    {
+        ++_nbMisses;
+        return false;
+    }
+
+    try
+    {
+        std::ifstream in;
+        in.exceptions(std::ifstream::eofbit | std::ifstream::failbit | std::ifstream::badbit);
+        in.open(cachePath, std::ios_base::binary);
+
+        if(readValue<uint32_t>(in) != visualWordsCacheVersion || readValue<uint64_t>(in) != _treeHash)
+        {
+            ++_nbMisses;
+            return false;
+        }
+
+        // the file name hash may collide, the descriptor file is checked
+        std::string path(readValue<uint64_t>(in), '\0');
+        in.read(&path[0], path.size());
+        if(path != fs::absolute(descriptorsPath).string() ||
+           readValue<uint64_t>(in) != fileSize ||
+           readValue<int64_t>(in) != writeTime)
+        {
+            ++_nbMisses;
+            return false;
+        }
+
+        // the words of a truncated file only serve the requests of fewer descriptors
+        const std::size_t cachedMaxDescriptors = readValue<uint64_t>(in);
+        const std::size_t nbWords = readValue<uint64_t>(in);
+        const bool isComplete = (cachedMaxDescriptors == 0 || nbWords < cachedMaxDescriptors);
+        if(!isComplete && (maxDescriptors == 0 || maxDescriptors > cachedMaxDescriptors))
+        {
+            ++_nbMisses;
+            return false;
+        }
+
+        const std::size_t nbReadWords = (maxDescriptors == 0) ? nbWords : std::min(maxDescriptors, nbWords);
+        std::vector<Word> words(nbReadWords);
+        if(nbReadWords > 0)
+            in.read(reinterpret_cast<char*>(words.data()), nbReadWords * sizeof(Word));
+        computeSparseHistogram(words, histogram);
+    }
+    catch(const std::exception& e)
+    {
+        ALICEVISION_LOG_WARNING("Ignore the invalid visual words cache file '" << cachePath << "': " << e.what());
+        histogram.clear();
+        ++_nbMisses;
+        return false;
+    }
+
+    ++_nbHits;
+    return true;
+}
+
+void VisualWordsCache::save(const std::string& descriptorsPath, std::size_t maxDescriptors, const SparseHistogram& histogram)
+{
+    boost::system::error_code ec;
+    const std::time_t writeTime = fs::last_write_time(descriptorsPath, ec);
+    const std::uintmax_t fileSize = ec ? 0 : fs::file_size(descriptorsPath, ec);
+    if(ec)
+        return;
+
+    // the words by descriptor index
+    std::size_t nbWords = 0;
+    for(const auto& wordPair : histogram)
+        nbWords += wordPair.second.size();
+    std::vector<Word> words(nbWords);
+    for(const auto& wordPair : histogram)
+        for(const IndexT descriptorIndex : wordPair.second)
+            words.at(descriptorIndex) = wordPair.first;
+
+    // another process may use the same cache, the file is replaced once complete
+    const std::string cachePath = getCacheFilePath(descriptorsPath);
+    const std::string tmpPath = cachePath + "." + fs::unique_path().string() + ".tmp";
+    try
+    {
+        {
+            std::ofstream out;
+            out.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+            out.open(tmpPath, std::ios_base::binary);
+
+            const std::string path = fs::absolute(descriptorsPath).string();
+            writeValue<uint32_t>(out, visualWordsCacheVersion);
+            writeValue<uint64_t>(out, _treeHash);
+            writeValue<uint64_t>(out, path.size());
+            out.write(path.data(), path.size());
+            writeValue<uint64_t>(out, fileSize);
+            writeValue<int64_t>(out, writeTime);
+            writeValue<uint64_t>(out, maxDescriptors);
+            writeValue<uint64_t>(out, nbWords);
+            if(nbWords > 0)
+                out.write(reinterpret_cast<const char*>(words.data()), nbWords * sizeof(Word));
+        }
+        fs::rename(tmpPath, cachePath);
+    }
+    catch(const std::exception& e)
+    {
+        ALICEVISION_LOG_WARNING("Cannot write the visual words cache file '" << cachePath << "': " << e.what());
+        fs::remove(tmpPath, ec);
+    }
+}
+
+} // namespace voctree
+} // namespace aliceVision
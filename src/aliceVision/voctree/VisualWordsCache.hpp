@@ -0,0 +1,108 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include "VocabularyTree.hpp"
+
+#include <aliceVision/feature/Descriptor.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+
+namespace aliceVision {
+namespace voctree {
+
+/**
+ * @brief Compute the hash of the content of a file.
+ * @throws std::runtime_error if the file cannot be read.
+ */
+std::size_t computeFileHash(const std::string& path);
+
+/**
+ * @brief Persistent cache of the visual words of the descriptor files.
+ *
+ * The visual words of each descriptor file are stored in one file of the cache folder, by vocabulary tree.
+ * An entry is valid while the descriptor file keeps the same modification time and size,
+ * so an unchanged dataset is not quantized again across runs and matching modes.
+ * The words of the first descriptors of a file also serve the requests of fewer descriptors.
+ * The cache is thread-safe.
+ */
+class VisualWordsCache
+{
+public:
+    /**
+     * @param[in] folder the folder of the cache files, created if needed
+     * @param[in] treeFilepath the vocabulary tree file, the cache files are keyed on the hash of its content
+     */
+    VisualWordsCache(const std::string& folder, const std::string& treeFilepath);
+
+    VisualWordsCache(const VisualWordsCache&) = delete;
+    VisualWordsCache& operator=(const VisualWordsCache&) = delete;
+
+    /**
+     * @brief Get the visual words of the first descriptors of a file
+     * @param[in] descriptorsPath the descriptor file path
+     * @param[in] maxDescriptors the number of descriptors read from the file, 0 for all
+     * @param[out] histogram the visual words of the descriptors
+     * @return false if they are not in the cache
+     */
+    bool load(const std::string& descriptorsPath, std::size_t maxDescriptors, SparseHistogram& histogram);
+
+    /**
+     * @brief Save the visual words of the first descriptors of a file
+     * @param[in] descriptorsPath the descriptor file path
+     * @param[in] maxDescriptors the number of descriptors read from the file, 0 for all
+     * @param[in] histogram the visual words of the descriptors
+     */
+    void save(const std::string& descriptorsPath, std::size_t maxDescriptors, const SparseHistogram& histogram);
+
+    /// Number of descriptor files read from the cache
+    std::size_t getNbHits() const { return _nbHits; }
+    /// Number of descriptor files not found in the cache
+    std::size_t getNbMisses() const { return _nbMisses; }
+
+private:
+    std::string getCacheFilePath(const std::string& descriptorsPath) const;
+
+    std::string _folder;
+    std::size_t _treeHash = 0;
+
+    std::atomic<std::size_t> _nbHits{0};
+    std::atomic<std::size_t> _nbMisses{0};
+};
+
+/**
+ * @brief Get the visual words of a descriptor file from the cache, or quantize its descriptors
+ * and save them in the cache.
+ * @param[in] descriptorsPath the descriptor file path
+ * @param[in] tree the vocabulary tree
+ * @param[in] maxDescriptors the number of descriptors read from the file, 0 for all
+ * @param[in] cache the visual words cache, may be null
+ * @return the visual words of the descriptors
+ */
+template<class DescriptorT, class VocDescriptorT>
+SparseHistogram quantizeDescriptorsFile(const std::string& descriptorsPath,
+                                        const VocabularyTree<VocDescriptorT>& tree,
+                                        std::size_t maxDescriptors,
+                                        VisualWordsCache* cache)
+{
+    SparseHistogram histogram;
+    if(cache && cache->load(descriptorsPath, maxDescriptors, histogram))
+        return histogram;
+
+    std::vector<DescriptorT> descriptors;
+    feature::loadDescsFromBinFile(descriptorsPath, descriptors, false, maxDescriptors);
+    histogram = tree.quantizeToSparse(descriptors);
+
+    if(cache)
+        cache->save(descriptorsPath, maxDescriptors, histogram);
+    return histogram;
+}
+
+} // namespace voctree
+} // namespace aliceVision
@@ -16,13 +16,20 @@
 #include <aliceVision/types.hpp>
 #include <aliceVision/system/Logger.hpp>
 
+#include <aliceVision/feature/Descriptor.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
 #include <stdint.h>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
 #include <vector>
 #include <map>
 #include <cassert>
 #include <limits>
 #include <fstream>
 #include <stdexcept>
+#include <string>
 #include <iostream>
 
 
@@ -83,6 +90,14 @@ public:
   /// Get the number of words the tree contains.
   virtual uint32_t words() const = 0;
 
+  /**
+   * @brief Get the node of a level which is the ancestor of a word.
+   * @param[in] word the word
+   * @param[in] level the level of the node, 0 for the children of the root
+   * @return the node index, the nodes of a level follow the nodes of the previous levels
+   */
+  virtual uint32_t getAncestorNode(Word word, uint32_t level) const = 0;
+
   /// Clears vocabulary, leaving an empty tree.
   virtual void clear() = 0;
 
@@ -90,6 +105,96 @@ public:
 
 inline IVocabularyTree::~IVocabularyTree() {}
 
+namespace detail {
+
+/// Find the closest child center of each descriptor of a group by comparing them one by one
+template<class DistanceT, class DescriptorT, class Feature>
+void compareToChildren(const std::vector<const DescriptorT*>& descriptors, const Feature* children, int32_t nbChildren, int32_t* bestChildren)
+{
+  typedef typename DistanceT::result_type distance_type;
+
+  for(std::size_t d = 0; d < descriptors.size(); ++d)
+  {
+    int32_t bestChild = 0;
+    distance_type bestDistance = std::numeric_limits<distance_type>::max();
+    for(int32_t child = 0; child < nbChildren; ++child)
+    {
+      const distance_type childDistance = DistanceT()(*descriptors[d], children[child]);
+      if(childDistance < bestDistance)
+      {
+        bestChild = child;
+        bestDistance = childDistance;
+      }
+    }
+    bestChildren[d] = bestChild;
+  }
+}
+
+/**
+ * @brief Find the closest child center of each descriptor of a group, all in the same node.
+ * The generic version compares each descriptor to each child with the distance functor.
+ */
+template<class DistanceT>
+struct ClosestChildren
+{
+  template<class DescriptorT, class Feature>
+  static void find(const std::vector<const DescriptorT*>& descriptors, const Feature* children, int32_t nbChildren, int32_t* bestChildren)
+  {
+    compareToChildren<DistanceT>(descriptors, children, nbChildren, bestChildren);
+  }
+};
+
+/**
+ * @brief L2 version for the fixed size descriptors.
+ * The children are transposed once for the group, so the distances to all the children are
+ * accumulated together in vectorizable loops. Each distance sums the elements in the same order
+ * as L2, the words are identical.
+ */
+template<typename T1, typename T2, std::size_t N>
+struct ClosestChildren<L2<feature::Descriptor<T1, N>, feature::Descriptor<T2, N>>>
+{
+  typedef L2<feature::Descriptor<T1, N>, feature::Descriptor<T2, N>> DistanceT;
+
+  /// Below this group size, transposing the children costs more than it saves
+  static const std::size_t minGroupSize = 4;
+
+  static void find(const std::vector<const feature::Descriptor<T1, N>*>& descriptors,
+                   const feature::Descriptor<T2, N>* children, int32_t nbChildren, int32_t* bestChildren)
+  {
+    if(descriptors.size() < minGroupSize || nbChildren == 0)
+    {
+      compareToChildren<DistanceT>(descriptors, children, nbChildren, bestChildren);
+      return;
+    }
+
+    std::vector<double> transposedChildren(N * nbChildren);
+    for(int32_t child = 0; child < nbChildren; ++child)
+      for(std::size_t i = 0; i < N; ++i)
+        transposedChildren[i * nbChildren + child] = static_cast<double>(children[child][i]);
+
+    std::vector<double> distances(nbChildren);
+    for(std::size_t d = 0; d < descriptors.size(); ++d)
+    {
+      const feature::Descriptor<T1, N>& descriptor = *descriptors[d];
+      std::fill(distances.begin(), distances.end(), 0.0);
+      for(std::size_t i = 0; i < N; ++i)
+      {
+        const double value = static_cast<double>(descriptor[i]);
+        const double* childrenValues = &transposedChildren[i * nbChildren];
+        for(int32_t child = 0; child < nbChildren; ++child)
+        {
+          const double diff = value - childrenValues[child];
+          distances[child] += diff * diff;
+        }
+      }
+      // the first closest child, as the generic version
+      bestChildren[d] = static_cast<int32_t>(std::min_element(distances.begin(), distances.end()) - distances.begin());
+    }
+  }
+};
+
+} // namespace detail
+
 /**
  * @brief Optimized vocabulary tree quantizer, templated on feature type and distance metric
  * for maximum efficiency.
@@ -119,7 +224,11 @@ public:
   template<class DescriptorT>
   Word quantize(const DescriptorT& feature) const;
 
-  /// Quantizes a set of features into visual words.
+  /**
+   * @brief Quantizes a set of features into visual words.
+   * The features are descended by blocks, level by level, and the features of a block in the same node
+   * are compared together to its children.
+   */
   template<class DescriptorT>
   std::vector<Word> quantize(const std::vector<DescriptorT>& features) const;
 
@@ -127,6 +236,20 @@ public:
   template<class DescriptorT>
   SparseHistogram quantizeToSparse(const std::vector<DescriptorT>& features) const;
 
+  /**
+   * @brief Aggregate a set of features into a VLAD global descriptor on the centers of a level.
+   * Each feature adds its residual to the center of its ancestor node at this level, then the residuals
+   * are square rooted, normalized by center and normalized globally.
+   * @param[in] features the features
+   * @param[in] level the level of the centers, 0 for the children of the root
+   * @return the descriptor of vladSize(level) values, null without features
+   */
+  template<class DescriptorT>
+  std::vector<float> computeVlad(const std::vector<DescriptorT>& features, uint32_t level) const;
+
+  /// Get the size of the VLAD descriptors on the centers of a level.
+  std::size_t vladSize(uint32_t level) const;
+
   SparseHistogram quantizeToSparse(const void* blindDescriptors) const override
   {
     const std::vector<Feature>* descriptors = static_cast<const std::vector<Feature>*>(blindDescriptors);
@@ -140,6 +263,8 @@ public:
   /// Get the number of words the tree contains.
   uint32_t words() const override;
 
+  uint32_t getAncestorNode(Word word, uint32_t level) const override;
+
   /// Clears vocabulary, leaving an empty tree.
   void clear() override;
 
@@ -173,6 +298,10 @@ protected:
   }
 
   void setNodeCounts();
+
+  /// Quantizes the features of [begin, end) together
+  template<class DescriptorT>
+  void quantizeBlock(const std::vector<DescriptorT>& features, std::size_t begin, std::size_t end, std::vector<Word>& words) const;
 };
 
 template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
@@ -228,19 +357,77 @@ std::vector<Word> VocabularyTree<Feature, Distance, FeatureAllocator>::quantize(
 {
   // ALICEVISION_LOG_DEBUG("VocabularyTree quantize: " << features.size());
   std::vector<Word> imgVisualWords(features.size(), 0);
+  assert(initialized());
+
+  // large blocks share more nodes, with enough blocks to balance the threads
+  const std::size_t blockSize = std::max(std::size_t(256), features.size() / (4 * omp_get_max_threads()));
+  const ptrdiff_t nbBlocks = (features.size() + blockSize - 1) / blockSize;
 
   // quantize the features
-  #pragma omp parallel for
-  for(ptrdiff_t j = 0; j < static_cast<ptrdiff_t>(features.size()); ++j)
+  #pragma omp parallel for schedule(dynamic)
+  for(ptrdiff_t b = 0; b < nbBlocks; ++b)
   {
-    // store the visual word associated to the feature in the temporary list
-    imgVisualWords[j] = quantize<DescriptorT>(features[j]);
+    // store the visual words associated to the features in the temporary list
+    quantizeBlock(features, b * blockSize, std::min(features.size(), (b + 1) * blockSize), imgVisualWords);
   }
 
   // add the vector to the documents
   return imgVisualWords;
 }
 
+template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
+template<class DescriptorT>
+void VocabularyTree<Feature, Distance, FeatureAllocator>::quantizeBlock(const std::vector<DescriptorT>& features,
+                                                                           std::size_t begin, std::size_t end,
+                                                                           std::vector<Word>& words) const
+{
+  const std::size_t nbFeatures = end - begin;
+
+  // current node of each feature, from the virtual "root" index which has no associated center
+  std::vector<int32_t> nodes(nbFeatures, -1);
+  std::vector<std::size_t> order(nbFeatures);
+  std::iota(order.begin(), order.end(), std::size_t(0));
+
+  std::vector<const DescriptorT*> group;
+  std::vector<int32_t> bestChildren;
+
+  for(unsigned level = 0; level < levels_; ++level)
+  {
+    // gather the features in the same node
+    if(level > 0)
+      std::sort(order.begin(), order.end(), [&nodes](std::size_t a, std::size_t b) { return nodes[a] < nodes[b]; });
+
+    for(std::size_t groupBegin = 0; groupBegin < nbFeatures;)
+    {
+      const int32_t node = nodes[order[groupBegin]];
+      std::size_t groupEnd = groupBegin + 1;
+      while(groupEnd < nbFeatures && nodes[order[groupEnd]] == node)
+        ++groupEnd;
+
+      // offset to the first child of the node, it has fewer than splits() children if one is not valid
+      const int32_t firstChild = (node + 1) * splits();
+      int32_t nbChildren = 0;
+      while(nbChildren < static_cast<int32_t>(splits()) && valid_centers_[firstChild + nbChildren])
+        ++nbChildren;
+
+      group.clear();
+      for(std::size_t i = groupBegin; i < groupEnd; ++i)
+        group.push_back(&features[begin + order[i]]);
+      bestChildren.resize(group.size());
+
+      detail::ClosestChildren<Distance<DescriptorT, Feature>>::find(group, &centers_[firstChild], nbChildren, bestChildren.data());
+
+      for(std::size_t i = groupBegin; i < groupEnd; ++i)
+        nodes[order[i]] = firstChild + bestChildren[i - groupBegin];
+
+      groupBegin = groupEnd;
+    }
+  }
+
+  for(std::size_t i = 0; i < nbFeatures; ++i)
+    words[begin + i] = nodes[i] - word_start_;
+}
+
 template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
 template<class DescriptorT>
 SparseHistogram VocabularyTree<Feature, Distance, FeatureAllocator>::quantizeToSparse(const std::vector<DescriptorT>& features) const
@@ -251,6 +438,86 @@ SparseHistogram VocabularyTree<Feature, Distance, FeatureAllocator>::quantizeToS
   return histo;
 }
 
+template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
+std::size_t VocabularyTree<Feature, Distance, FeatureAllocator>::vladSize(uint32_t level) const
+{
+  std::size_t nbNodes = k_;
+  for(uint32_t i = 0; i < level; ++i)
+    nbNodes *= k_;
+  return nbNodes * Feature::static_size;
+}
+
+template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
+template<class DescriptorT>
+std::vector<float> VocabularyTree<Feature, Distance, FeatureAllocator>::computeVlad(const std::vector<DescriptorT>& features, uint32_t level) const
+{
+  assert(initialized());
+  if(level >= levels_)
+    throw std::invalid_argument("The VLAD level " + std::to_string(level) + " is not a level of the vocabulary tree.");
+
+  const std::size_t dimension = Feature::static_size;
+  std::vector<float> vlad(vladSize(level), 0.0f);
+
+  // the nodes of a level follow the nodes of the previous levels
+  std::size_t firstNode = 0;
+  std::size_t nbNodes = k_;
+  for(uint32_t i = 0; i < level; ++i)
+  {
+    firstNode += nbNodes;
+    nbNodes *= k_;
+  }
+
+  const std::vector<Word> words = quantize(features);
+  for(std::size_t i = 0; i < features.size(); ++i)
+  {
+    // the parent of the node n is n / k - 1
+    std::size_t node = words[i] + word_start_;
+    for(uint32_t l = levels_ - 1; l > level; --l)
+      node = node / k_ - 1;
+
+    float* residual = &vlad[(node - firstNode) * dimension];
+    for(std::size_t d = 0; d < dimension; ++d)
+      residual[d] += static_cast<float>(features[i][d]) - static_cast<float>(centers_[node][d]);
+  }
+
+  // power normalization then intra and global normalizations, against the bursts of similar features
+  for(float& value : vlad)
+    value = (value < 0.0f) ? -std::sqrt(-value) : std::sqrt(value);
+
+  double sumSquares = 0.0;
+  for(std::size_t n = 0; n < nbNodes; ++n)
+  {
+    float* residual = &vlad[n * dimension];
+    double norm = 0.0;
+    for(std::size_t d = 0; d < dimension; ++d)
+      norm += residual[d] * residual[d];
+    if(norm == 0.0)
+      continue;
+    const float invNorm = 1.0 / std::sqrt(norm);
+    for(std::size_t d = 0; d < dimension; ++d)
+      residual[d] *= invNorm;
+    sumSquares += 1.0;
+  }
+  if(sumSquares > 0.0)
+  {
+    const float invNorm = 1.0 / std::sqrt(sumSquares);
+    for(float& value : vlad)
+      value *= invNorm;
+  }
+  return vlad;
+}
+
+template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
+uint32_t VocabularyTree<Feature, Distance, FeatureAllocator>::getAncestorNode(Word word, uint32_t level) const
+{
+  assert(level < levels_);
+  // the parent of the node n is n / k - 1
+  uint32_t node = word + word_start_;
+  for(uint32_t l = levels_ - 1; l > level; --l)
+    node = node / k_ - 1;
+  return node;
+}
+
 template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
 uint32_t VocabularyTree<Feature, Distance, FeatureAllocator>::levels() const
 {
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <aliceVision/voctree/Database.hpp>
+#include <aliceVision/voctree/VisualWordsCache.hpp>
 #include <aliceVision/voctree/VocabularyTree.hpp>
 
 #include <string>
@@ -29,6 +30,7 @@ namespace voctree {
  * @param[out] db The built database
  * @param[out] documents A map containing for each image the list of associated visual words
  * @param[in] Nmax The maximum number of features loaded in each desc file. For Nmax = 0 (default), all the descriptors are loaded.
+ * @param[in] wordsCache The cache of the visual words of the descriptor files, may be null
  * @return the number of overall features read
  */
 template<class DescriptorT, class VocDescriptorT>
@@ -36,7 +38,8 @@ std::size_t populateDatabase(const sfmData::SfMData& sfmData,
                              const std::vector<std::string>& featuresFolders,
                              const VocabularyTree<VocDescriptorT>& tree,
                              Database& db,
-                             const int Nmax = 0);
+                             const int Nmax = 0,
+                             VisualWordsCache* wordsCache = nullptr);
 
 /**
  * @brief Given an non empty database, it queries the database with a set of images
@@ -26,7 +26,8 @@ std::size_t populateDatabase(const sfmData::SfMData& sfmData,
                              const std::vector<std::string>& featuresFolders,
                              const VocabularyTree<VocDescriptorT>& tree,
                              Database& db,
-                             const int Nmax)
+                             const int Nmax,
+                             VisualWordsCache* wordsCache)
 {
   std::map<IndexT, std::string> descriptorsFiles;
   getListOfDescriptorFiles(sfmData, featuresFolders, descriptorsFiles);
@@ -39,14 +40,12 @@ std::size_t populateDatabase(const sfmData::SfMData& sfmData,
   // Run through the path vector and read the descriptors
   for(const auto &currentFile : descriptorsFiles)
   {
-    
-    std::vector<DescriptorT> descriptors;
+    // Read and quantize the descriptors, or read their visual words from the cache
+    SparseHistogram newDoc = quantizeDescriptorsFile<DescriptorT>(currentFile.second, tree, Nmax, wordsCache);
 
-    // Read the descriptors
-    loadDescsFromBinFile(currentFile.second, descriptors, false, Nmax);
-    size_t result = descriptors.size();
-    
-    SparseHistogram newDoc =  tree.quantizeToSparse(descriptors);
+    size_t result = 0;
+    for(const auto& wordPair : newDoc)
+      result += wordPair.second.size();
 
     // Insert document in database
     db.insert(currentFile.first, newDoc);
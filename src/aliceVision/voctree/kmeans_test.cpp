@@ -299,3 +299,61 @@ BOOST_AUTO_TEST_CASE(kmeanVarying)
     }
   }
 }
+
+BOOST_AUTO_TEST_CASE(kmeanMiniBatch)
+{
+  using namespace aliceVision;
+  ALICEVISION_LOG_DEBUG("Testing mini-batch kmeans on float descriptors...");
+
+  makeRandomOperationsReproducible();
+
+  const std::size_t DIMENSION = 32;
+  const std::size_t FEATURENUMBER = 2000;
+  const std::size_t K = 8;
+
+  typedef feature::Descriptor<float, DIMENSION> DescriptorFloat;
+  typedef voctree::SimpleKmeans<DescriptorFloat> Kmeans;
+
+  std::default_random_engine generator;
+  std::uniform_real_distribution<float> noise(-1.f, 1.f);
+
+  // K well separated clusters
+  std::vector<DescriptorFloat> features;
+  features.reserve(FEATURENUMBER * K);
+  for(std::size_t i = 0; i < K; ++i)
+  {
+    for(std::size_t j = 0; j < FEATURENUMBER; ++j)
+    {
+      DescriptorFloat f;
+      for(std::size_t d = 0; d < DIMENSION; ++d)
+        f[d] = noise(generator) + ((d % K == i) ? 20.f : 0.f);
+      features.push_back(f);
+    }
+  }
+
+  std::vector<DescriptorFloat> centers;
+  std::vector<unsigned int> membership;
+
+  Kmeans lloyd(DescriptorFloat(0));
+  lloyd.setRestarts(3);
+  const Kmeans::squared_distance_type lloydSSE = lloyd.cluster(features, K, centers, membership);
+
+  Kmeans miniBatch(DescriptorFloat(0));
+  miniBatch.setRestarts(3);
+  miniBatch.setMiniBatchSize(256);
+  const Kmeans::squared_distance_type miniBatchSSE = miniBatch.cluster(features, K, centers, membership);
+
+  ALICEVISION_LOG_DEBUG("SSE: Lloyd " << lloydSSE << ", mini-batch " << miniBatchSSE);
+  BOOST_CHECK_LE(miniBatchSSE, lloydSSE * 1.01);
+
+  // each cluster is recovered
+  BOOST_CHECK_EQUAL(membership.size(), features.size());
+  std::vector<std::size_t> h(K, 0);
+  for(std::size_t i = 0; i < membership.size(); ++i)
+  {
+    BOOST_CHECK_EQUAL(membership[i], membership[(i / FEATURENUMBER) * FEATURENUMBER]);
+    ++h[membership[i]];
+  }
+  for(std::size_t i = 0; i < h.size(); ++i)
+    BOOST_CHECK_EQUAL(h[i], FEATURENUMBER);
+}
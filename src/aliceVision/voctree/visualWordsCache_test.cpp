@@ -0,0 +1,89 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/voctree/VisualWordsCache.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+#include <string>
+
+#define BOOST_TEST_MODULE VisualWordsCache
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::voctree;
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+void writeFile(const fs::path& path, const std::string& content)
+{
+    std::ofstream file(path.string(), std::ios::binary);
+    file << content;
+}
+
+SparseHistogram makeHistogram(const std::vector<Word>& words)
+{
+    SparseHistogram histogram;
+    computeSparseHistogram(words, histogram);
+    return histogram;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(VisualWordsCache_persistence)
+{
+    const fs::path folder = fs::temp_directory_path() / fs::unique_path();
+    fs::create_directories(folder);
+    const fs::path treePath = folder / "tree";
+    const fs::path descriptorsPath = folder / "1.sift.desc";
+    writeFile(treePath, "tree");
+    writeFile(descriptorsPath, "descriptors");
+
+    const std::vector<Word> words = {3, 1, 4, 1, 5, 9, 2, 6};
+    const fs::path cacheFolder = folder / "cache";
+    {
+        VisualWordsCache cache(cacheFolder.string(), treePath.string());
+        SparseHistogram histogram;
+        BOOST_CHECK(!cache.load(descriptorsPath.string(), 0, histogram));
+        cache.save(descriptorsPath.string(), 0, makeHistogram(words));
+    }
+
+    // a new cache reads the saved file, the first words serve fewer descriptors
+    {
+        VisualWordsCache cache(cacheFolder.string(), treePath.string());
+        SparseHistogram histogram;
+        BOOST_CHECK(cache.load(descriptorsPath.string(), 0, histogram));
+        BOOST_CHECK(histogram == makeHistogram(words));
+        BOOST_CHECK(cache.load(descriptorsPath.string(), 3, histogram));
+        BOOST_CHECK(histogram == makeHistogram({3, 1, 4}));
+        BOOST_CHECK_EQUAL(cache.getNbHits(), 2);
+    }
+
+    // the words of the first descriptors only do not serve more descriptors
+    {
+        VisualWordsCache cache(cacheFolder.string(), treePath.string());
+        cache.save(descriptorsPath.string(), 4, makeHistogram({3, 1, 4, 1}));
+        SparseHistogram histogram;
+        BOOST_CHECK(cache.load(descriptorsPath.string(), 2, histogram));
+        BOOST_CHECK(!cache.load(descriptorsPath.string(), 5, histogram));
+        BOOST_CHECK(!cache.load(descriptorsPath.string(), 0, histogram));
+    }
+
+    // another vocabulary tree does not use the cached words
+    writeFile(treePath, "another tree");
+    {
+        VisualWordsCache cache(cacheFolder.string(), treePath.string());
+        SparseHistogram histogram;
+        BOOST_CHECK(!cache.load(descriptorsPath.string(), 2, histogram));
+        BOOST_CHECK_EQUAL(cache.getNbMisses(), 1);
+    }
+
+    fs::remove_all(folder);
+}
@@ -5,9 +5,13 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include <aliceVision/voctree/Database.hpp>
+#include <aliceVision/voctree/MutableVocabularyTree.hpp>
+
+#include <boost/filesystem.hpp>
 
 #include <iostream>
 #include <fstream>
+#include <random>
 #include <vector>
 
 #define BOOST_TEST_MODULE vocabularyTree
@@ -17,6 +21,8 @@
 
 using namespace aliceVision::voctree;
 
+namespace fs = boost::filesystem;
+
 BOOST_AUTO_TEST_CASE(database)
 {
   const int cardDocuments = 10;
@@ -57,3 +63,261 @@ BOOST_AUTO_TEST_CASE(database)
     BOOST_CHECK_SMALL(static_cast<double>(match[0].score), 0.001);
   }
 }
+
+BOOST_AUTO_TEST_CASE(database_invertedFile)
+{
+  const int cardDocuments = 50;
+  const int cardWords = 300;
+  const int nbFeatures = 80;
+
+  // random documents with repeated words
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<Word> wordDistribution(0, cardWords - 1);
+
+  // the word weights are left to 1
+  Database db(cardWords);
+  std::vector<SparseHistogram> histograms(cardDocuments);
+  for(int i = 0; i < cardDocuments; ++i)
+  {
+    std::vector<Word> document(nbFeatures);
+    for(Word& word : document)
+      word = wordDistribution(generator);
+    computeSparseHistogram(document, histograms[i]);
+    // the ids are not contiguous, the varints of their indexes use several bytes
+    db.insert(1000 * i, histograms[i]);
+  }
+  const std::vector<float> weights(cardWords, 1.f);
+
+  // the inverted file gives the distances to all the documents, in best-to-worst order
+  for(const std::string distanceMethod : {"classic", "commonPoints", "strongCommonPoints", "inversedWeightedCommonPoints"})
+  {
+    for(int i = 0; i < cardDocuments; ++i)
+    {
+      std::vector<DocMatch> matches;
+      db.find(histograms[i], cardDocuments, matches, distanceMethod);
+      BOOST_REQUIRE_EQUAL(matches.size(), cardDocuments);
+
+      for(std::size_t m = 0; m < matches.size(); ++m)
+      {
+        if(m > 0)
+          BOOST_CHECK(!(matches[m] < matches[m - 1]));
+
+        const SparseHistogram& document = db.getSparseHistogramPerImage().at(matches[m].id);
+        BOOST_CHECK_CLOSE(matches[m].score + 1.0, sparseDistance(histograms[i], document, distanceMethod, weights) + 1.0, 1e-4);
+      }
+
+      // the top N are the N first of all the matches
+      std::vector<DocMatch> best;
+      db.find(histograms[i], 5, best, distanceMethod);
+      BOOST_REQUIRE_EQUAL(best.size(), 5);
+      for(std::size_t m = 0; m < best.size(); ++m)
+        BOOST_CHECK_EQUAL(best[m].score, matches[m].score);
+
+      // the candidates are ranked among themselves, the unknown ids are ignored
+      const std::vector<DocId> candidates = {DocId(1000 * ((i + 7) % cardDocuments)), 1, DocId(1000 * ((i + 3) % cardDocuments))};
+      std::vector<DocMatch> candidateMatches;
+      std::vector<float> scores;
+      db.find(histograms[i], 5, candidates, candidateMatches, scores, distanceMethod);
+      BOOST_REQUIRE_EQUAL(candidateMatches.size(), 2);
+      BOOST_CHECK(!(candidateMatches[1] < candidateMatches[0]));
+      for(const DocMatch& match : candidateMatches)
+      {
+        BOOST_CHECK(match.id == candidates[0] || match.id == candidates[2]);
+        const SparseHistogram& document = db.getSparseHistogramPerImage().at(match.id);
+        BOOST_CHECK_CLOSE(match.score + 1.0, sparseDistance(histograms[i], document, distanceMethod, weights) + 1.0, 1e-4);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(database_saveLoadRemove)
+{
+  const int cardDocuments = 40;
+  const int cardWords = 200;
+  const int nbFeatures = 60;
+
+  std::mt19937 generator(3);
+  std::uniform_int_distribution<Word> wordDistribution(0, cardWords - 1);
+
+  Database db(cardWords);
+  std::vector<SparseHistogram> histograms(cardDocuments);
+  for(int i = 0; i < cardDocuments; ++i)
+  {
+    std::vector<Word> document(nbFeatures);
+    for(Word& word : document)
+      word = wordDistribution(generator);
+    computeSparseHistogram(document, histograms[i]);
+    db.insert(i, histograms[i]);
+  }
+  db.computeTfIdfWeights();
+
+  // the loaded database gives the same matches
+  const fs::path databasePath = fs::temp_directory_path() / fs::unique_path("%%%%-%%%%.db");
+  db.save(databasePath.string(), 42);
+
+  // a file of another key is not loaded
+  Database loaded;
+  BOOST_CHECK(!loaded.load(databasePath.string(), 43));
+  BOOST_CHECK_EQUAL(loaded.size(), 0);
+
+  BOOST_CHECK(loaded.load(databasePath.string(), 42));
+  BOOST_CHECK_EQUAL(loaded.size(), cardDocuments);
+
+  // a truncated file is rejected and the current documents are kept
+  fs::resize_file(databasePath, fs::file_size(databasePath) - 2);
+  BOOST_CHECK_THROW(loaded.load(databasePath.string(), 42), std::runtime_error);
+  BOOST_CHECK_EQUAL(loaded.size(), cardDocuments);
+  fs::remove(databasePath);
+
+  for(int i = 0; i < cardDocuments; ++i)
+  {
+    std::vector<DocMatch> matches, loadedMatches;
+    db.find(histograms[i], 10, matches, "inversedWeightedCommonPoints");
+    loaded.find(histograms[i], 10, loadedMatches, "inversedWeightedCommonPoints");
+    BOOST_CHECK(matches == loadedMatches);
+  }
+
+  // the removed documents are not found, before and after the inverted files are rebuilt
+  Database reference(cardWords);
+  for(int i = 0; i < cardDocuments; ++i)
+  {
+    if(i % 4 != 0)
+      BOOST_CHECK(loaded.remove(i));
+    else
+      reference.insert(i, histograms[i]);
+
+    if(i == cardDocuments / 2 || i == cardDocuments - 1)
+    {
+      for(int q = 0; q < cardDocuments; ++q)
+      {
+        std::vector<DocMatch> matches;
+        loaded.find(histograms[q], cardDocuments, matches, "commonPoints");
+        BOOST_CHECK_EQUAL(matches.size(), loaded.size());
+        for(const DocMatch& match : matches)
+          BOOST_CHECK(match.id % 4 == 0 || match.id > i);
+      }
+    }
+  }
+  BOOST_CHECK(!loaded.remove(1));
+  BOOST_CHECK_EQUAL(loaded.size(), reference.size());
+
+  for(int q = 0; q < cardDocuments; ++q)
+  {
+    std::vector<DocMatch> matches, referenceMatches;
+    loaded.find(histograms[q], 5, matches, "commonPoints");
+    reference.find(histograms[q], 5, referenceMatches, "commonPoints");
+    BOOST_REQUIRE_EQUAL(matches.size(), referenceMatches.size());
+    for(std::size_t m = 0; m < matches.size(); ++m)
+      BOOST_CHECK_EQUAL(matches[m].score, referenceMatches[m].score);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(vocabularyTree_batchedQuantize)
+{
+  typedef aliceVision::feature::Descriptor<float, 16> CenterT;
+  typedef aliceVision::feature::Descriptor<unsigned char, 16> DescriptorT;
+
+  const uint32_t levels = 4;
+  const uint32_t splits = 6;
+
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<float> centerDistribution(0.f, 255.f);
+  std::uniform_int_distribution<int> descriptorDistribution(0, 255);
+
+  // random centers, with some nodes having fewer children
+  MutableVocabularyTree<CenterT> tree;
+  tree.setSize(levels, splits);
+  tree.centers().resize(tree.nodes());
+  tree.validCenters().resize(tree.nodes(), 1);
+  for(std::size_t i = 0; i < tree.nodes(); ++i)
+  {
+    for(std::size_t j = 0; j < CenterT::static_size; ++j)
+      tree.centers()[i][j] = centerDistribution(generator);
+    if(i % splits == splits - 1 && i % 7 == 0)
+      tree.validCenters()[i] = 0;
+  }
+
+  std::vector<DescriptorT> descriptors(3000);
+  for(DescriptorT& descriptor : descriptors)
+    for(std::size_t j = 0; j < DescriptorT::static_size; ++j)
+      descriptor[j] = descriptorDistribution(generator);
+
+  // the batched quantization gives the words of the quantization one by one
+  const std::vector<Word> words = tree.quantize(descriptors);
+  BOOST_REQUIRE_EQUAL(words.size(), descriptors.size());
+  for(std::size_t i = 0; i < descriptors.size(); ++i)
+    BOOST_CHECK_EQUAL(words[i], tree.quantize(descriptors[i]));
+}
+
+BOOST_AUTO_TEST_CASE(vocabularyTree_vlad)
+{
+  typedef aliceVision::feature::Descriptor<float, 8> CenterT;
+  typedef aliceVision::feature::Descriptor<unsigned char, 8> DescriptorT;
+
+  const uint32_t levels = 2;
+  const uint32_t splits = 3;
+
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<float> centerDistribution(0.f, 255.f);
+  std::uniform_int_distribution<int> descriptorDistribution(0, 255);
+
+  MutableVocabularyTree<CenterT> tree;
+  tree.setSize(levels, splits);
+  tree.centers().resize(tree.nodes());
+  tree.validCenters().resize(tree.nodes(), 1);
+  for(std::size_t i = 0; i < tree.nodes(); ++i)
+    for(std::size_t j = 0; j < CenterT::static_size; ++j)
+      tree.centers()[i][j] = centerDistribution(generator);
+
+  std::vector<DescriptorT> descriptors(200);
+  for(DescriptorT& descriptor : descriptors)
+    for(std::size_t j = 0; j < DescriptorT::static_size; ++j)
+      descriptor[j] = descriptorDistribution(generator);
+
+  BOOST_CHECK_EQUAL(tree.vladSize(0), splits * CenterT::static_size);
+  BOOST_CHECK_EQUAL(tree.vladSize(1), splits * splits * CenterT::static_size);
+  BOOST_CHECK_THROW(tree.computeVlad(descriptors, levels), std::invalid_argument);
+
+  // on the leaves, the residuals are accumulated by word
+  const std::vector<Word> words = tree.quantize(descriptors);
+  std::vector<double> expected(tree.vladSize(1), 0.0);
+  for(std::size_t i = 0; i < descriptors.size(); ++i)
+    for(std::size_t j = 0; j < CenterT::static_size; ++j)
+      expected[words[i] * CenterT::static_size + j] += float(descriptors[i][j]) - tree.centers()[splits + words[i]][j];
+
+  double sumSquares = 0.0;
+  for(std::size_t w = 0; w < splits * splits; ++w)
+  {
+    double norm = 0.0;
+    for(std::size_t j = 0; j < CenterT::static_size; ++j)
+    {
+      double& value = expected[w * CenterT::static_size + j];
+      value = (value < 0.0) ? -std::sqrt(-value) : std::sqrt(value);
+      norm += value * value;
+    }
+    if(norm == 0.0)
+      continue;
+    for(std::size_t j = 0; j < CenterT::static_size; ++j)
+      expected[w * CenterT::static_size + j] /= std::sqrt(norm);
+    sumSquares += 1.0;
+  }
+
+  const std::vector<float> vlad = tree.computeVlad(descriptors, 1);
+  BOOST_REQUIRE_EQUAL(vlad.size(), expected.size());
+  for(std::size_t i = 0; i < vlad.size(); ++i)
+    BOOST_CHECK_SMALL(vlad[i] - expected[i] / std::sqrt(sumSquares), 1e-5);
+
+  // the ancestors of the words
+  for(Word word = 0; word < static_cast<Word>(splits * splits); ++word)
+  {
+    BOOST_CHECK_EQUAL(tree.getAncestorNode(word, 1), splits + word);
+    BOOST_CHECK_EQUAL(tree.getAncestorNode(word, 0), word / splits);
+  }
+
+  // the descriptors on the first level are normalized
+  const std::vector<float> coarseVlad = tree.computeVlad(descriptors, 0);
+  double norm = 0.0;
+  for(const float value : coarseVlad)
+    norm += value * value;
+  BOOST_CHECK_CLOSE(norm, 1.0, 1e-3);
+}
@@ -0,0 +1,77 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "Benchmark.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Metrics.hpp>
+
+#include <algorithm>
+#include <sstream>
+
+namespace aliceVision {
+namespace benchmarks {
+
+BenchmarkRunner::BenchmarkRunner(const std::string& filter, int minIterations, double minTime)
+  : _filter(filter)
+  , _filterRegex(filter)
+  , _minIterations(std::max(1, minIterations))
+  , _minTime(minTime)
+{}
+
+bool BenchmarkRunner::isSelected(const std::string& name) const
+{
+  return _filter.empty() || std::regex_search(name, _filterRegex);
+}
+
+bool BenchmarkRunner::isAnySelected(const std::vector<std::string>& names) const
+{
+  return std::any_of(names.begin(), names.end(), [this](const std::string& name) { return isSelected(name); });
+}
+
+void BenchmarkRunner::run(const std::string& name, std::size_t nbItems, const std::function<void()>& f)
+{
+  if(!isSelected(name))
+    return;
+
+  // warm up the caches and the lazy allocations
+  f();
+
+  std::vector<double> timesMs;
+  system::Timer totalTimer;
+  while(timesMs.size() < static_cast<std::size_t>(_minIterations) || totalTimer.elapsed() < _minTime)
+  {
+    system::Timer timer;
+    f();
+    timesMs.push_back(timer.elapsedMs());
+  }
+
+  std::vector<double> sortedTimesMs = timesMs;
+  std::sort(sortedTimesMs.begin(), sortedTimesMs.end());
+  const double medianMs = sortedTimesMs[sortedTimesMs.size() / 2];
+
+  system::Metrics& metrics = system::Metrics::get();
+  const std::string prefix = "benchmark." + name + ".";
+  for(double timeMs : timesMs)
+    metrics.addSample(prefix + "timeMs", timeMs);
+  metrics.setGauge(prefix + "medianMs", medianMs);
+
+  std::stringstream log;
+  log << name << ": " << medianMs << " ms (min: " << sortedTimesMs.front() << " ms, max: " << sortedTimesMs.back()
+      << " ms, " << timesMs.size() << " iterations)";
+  if(nbItems > 1 && medianMs > 0.0)
+  {
+    const double itemsPerSecond = nbItems * 1000.0 / medianMs;
+    metrics.setGauge(prefix + "itemsPerSecond", itemsPerSecond);
+    log << ", " << itemsPerSecond << " items/s";
+  }
+  ALICEVISION_LOG_INFO(log.str());
+
+  ++_nbRuns;
+}
+
+} // namespace benchmarks
+} // namespace aliceVision
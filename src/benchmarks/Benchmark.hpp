@@ -0,0 +1,94 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/system/Timer.hpp>
+
+#include <functional>
+#include <regex>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace benchmarks {
+
+/**
+ * @brief Run the micro-benchmarks selected on the command line and report their timings.
+ *
+ * Each benchmark runs once to warm up, then at least minIterations times and until minTime is spent.
+ * The timings are logged and added to the metrics:
+ *  - the histogram "benchmark.<name>.timeMs" gets the time of each iteration,
+ *  - the gauge "benchmark.<name>.medianMs" gets the median time, the one to compare between builds,
+ *  - the gauge "benchmark.<name>.itemsPerSecond" gets the throughput, if the benchmark processes several items.
+ */
+class BenchmarkRunner
+{
+public:
+  /**
+   * @param[in] filter The regular expression selecting the benchmarks to run, all of them if empty
+   * @param[in] minIterations The minimum number of timed iterations of each benchmark
+   * @param[in] minTime The minimum time spent in each benchmark (s)
+   */
+  BenchmarkRunner(const std::string& filter, int minIterations, double minTime);
+
+  /**
+   * @brief Return true if the benchmark of the given full name is selected.
+   */
+  bool isSelected(const std::string& name) const;
+
+  /**
+   * @brief Return true if any of the benchmarks of the given full names is selected.
+   *        A group of benchmarks should skip its shared setup if not.
+   *        The filter is always applied to the full names, so an anchored filter (e.g. '^camera\.project$')
+   *        selects its benchmark whatever the group it belongs to.
+   */
+  bool isAnySelected(const std::vector<std::string>& names) const;
+
+  /**
+   * @brief Time a benchmark, if selected.
+   * @param[in] name The benchmark name, "<module>.<kernel>"
+   * @param[in] nbItems The number of items (e.g. points, descriptors, pixels) processed by each iteration
+   * @param[in] f The function to time
+   */
+  void run(const std::string& name, std::size_t nbItems, const std::function<void()>& f);
+
+  /// the number of benchmarks run
+  inline int nbRuns() const { return _nbRuns; }
+
+private:
+  std::string _filter;
+  std::regex _filterRegex;
+  int _minIterations;
+  double _minTime;
+  int _nbRuns = 0;
+};
+
+/**
+ * @brief Prevent the compiler from optimizing away a benchmarked result.
+ */
+template <typename T>
+inline void doNotOptimize(const T& value)
+{
+#if defined(_MSC_VER)
+  static volatile const void* sink;
+  sink = &value;
+#else
+  asm volatile("" : : "g"(&value) : "memory");
+#endif
+}
+
+/// descriptor distance, cascade hashing, vocabulary tree quantization and tracks building
+void runFeatureBenchmarks(BenchmarkRunner& runner);
+
+/// robust estimation of the F/E/H matrices, P3P resection, triangulation and camera models
+void runGeometryBenchmarks(BenchmarkRunner& runner);
+
+/// image convolution, resampling, undistortion and laplacian pyramid
+void runImageBenchmarks(BenchmarkRunner& runner);
+
+} // namespace benchmarks
+} // namespace aliceVision
@@ -0,0 +1,212 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "Benchmark.hpp"
+
+#include <aliceVision/feature/Descriptor.hpp>
+#include <aliceVision/feature/metric.hpp>
+#include <aliceVision/matching/ArrayMatcher_cascadeHashing.hpp>
+#include <aliceVision/matching/IndMatch.hpp>
+#include <aliceVision/track/TracksBuilder.hpp>
+#include <aliceVision/voctree/MutableVocabularyTree.hpp>
+
+#include <Eigen/Core>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace aliceVision {
+namespace benchmarks {
+
+namespace {
+
+constexpr int descriptorLength = 128;
+
+using DescriptorMatrixUChar = Eigen::Matrix<unsigned char, Eigen::Dynamic, descriptorLength, Eigen::RowMajor>;
+using DescriptorMatrixFloat = Eigen::Matrix<float, Eigen::Dynamic, descriptorLength, Eigen::RowMajor>;
+
+DescriptorMatrixUChar randomDescriptors(int nbDescriptors, std::mt19937& generator)
+{
+  std::uniform_int_distribution<int> distribution(0, 255);
+  DescriptorMatrixUChar descriptors(nbDescriptors, descriptorLength);
+  for(int i = 0; i < descriptors.size(); ++i)
+    descriptors.data()[i] = static_cast<unsigned char>(distribution(generator));
+  return descriptors;
+}
+
+template <typename MetricT, typename MatrixT>
+void benchmarkDistance(BenchmarkRunner& runner, const std::string& name, const MatrixT& a, const MatrixT& b)
+{
+  runner.run(name, a.rows(), [&]() {
+    const MetricT metric;
+    typename MetricT::ResultType sum = 0;
+    for(int i = 0; i < a.rows(); ++i)
+      sum += metric(a.row(i).data(), b.row(i).data(), descriptorLength);
+    doNotOptimize(sum);
+  });
+}
+
+void benchmarkDescriptorDistance(BenchmarkRunner& runner, std::mt19937& generator)
+{
+  if(!runner.isAnySelected({"feature.distance.l2SimpleUChar", "feature.distance.l2VectorizedUChar",
+                             "feature.distance.l2SimpleFloat", "feature.distance.l2VectorizedFloat"}))
+    return;
+
+  const int nbDescriptors = 100000;
+  const DescriptorMatrixUChar aUChar = randomDescriptors(nbDescriptors, generator);
+  const DescriptorMatrixUChar bUChar = randomDescriptors(nbDescriptors, generator);
+  const DescriptorMatrixFloat aFloat = aUChar.cast<float>();
+  const DescriptorMatrixFloat bFloat = bUChar.cast<float>();
+
+  benchmarkDistance<feature::L2_Simple<unsigned char>>(runner, "feature.distance.l2SimpleUChar", aUChar, bUChar);
+  benchmarkDistance<feature::L2_Vectorized<unsigned char>>(runner, "feature.distance.l2VectorizedUChar", aUChar, bUChar);
+  benchmarkDistance<feature::L2_Simple<float>>(runner, "feature.distance.l2SimpleFloat", aFloat, bFloat);
+  benchmarkDistance<feature::L2_Vectorized<float>>(runner, "feature.distance.l2VectorizedFloat", aFloat, bFloat);
+}
+
+void benchmarkCascadeHashing(BenchmarkRunner& runner, std::mt19937& generator)
+{
+  if(!runner.isAnySelected({"matching.cascadeHashing.build", "matching.cascadeHashing.search"}))
+    return;
+
+  const int nbDescriptors = 10000;
+  const DescriptorMatrixUChar database = randomDescriptors(nbDescriptors, generator);
+
+  // the queries are noisy copies of the database, so the matching finds real neighbours
+  std::normal_distribution<float> noise(0.f, 8.f);
+  DescriptorMatrixUChar queries = database;
+  for(int i = 0; i < queries.size(); ++i)
+    queries.data()[i] = static_cast<unsigned char>(std::min(255.f, std::max(0.f, queries.data()[i] + noise(generator))));
+
+  using MatcherT = matching::ArrayMatcher_cascadeHashing<unsigned char>;
+
+  runner.run("matching.cascadeHashing.build", nbDescriptors, [&]() {
+    std::mt19937 matcherGenerator(0);
+    MatcherT matcher;
+    matcher.Build(matcherGenerator, database.data(), nbDescriptors, descriptorLength);
+  });
+
+  std::mt19937 matcherGenerator(0);
+  MatcherT matcher;
+  matcher.Build(matcherGenerator, database.data(), nbDescriptors, descriptorLength);
+
+  runner.run("matching.cascadeHashing.search", nbDescriptors, [&]() {
+    matching::IndMatches matches;
+    std::vector<MatcherT::DistanceType> distances;
+    matcher.SearchNeighbours(queries.data(), nbDescriptors, &matches, &distances, 2);
+    doNotOptimize(matches);
+  });
+}
+
+void benchmarkVocabularyTree(BenchmarkRunner& runner, std::mt19937& generator)
+{
+  if(!runner.isAnySelected({"voctree.quantize.single", "voctree.quantize.batched"}))
+    return;
+
+  using CenterT = feature::Descriptor<float, descriptorLength>;
+  using DescriptorT = feature::Descriptor<unsigned char, descriptorLength>;
+
+  // random centers, with the branching factor of the usual trees on fewer levels
+  const uint32_t levels = 4;
+  const uint32_t splits = 10;
+
+  std::uniform_real_distribution<float> centerDistribution(0.f, 255.f);
+  std::uniform_int_distribution<int> descriptorDistribution(0, 255);
+
+  voctree::MutableVocabularyTree<CenterT> tree;
+  tree.setSize(levels, splits);
+  tree.centers().resize(tree.nodes());
+  tree.validCenters().resize(tree.nodes(), 1);
+  for(CenterT& center : tree.centers())
+    for(std::size_t j = 0; j < CenterT::static_size; ++j)
+      center[j] = centerDistribution(generator);
+
+  std::vector<DescriptorT> descriptors(20000);
+  for(DescriptorT& descriptor : descriptors)
+    for(std::size_t j = 0; j < DescriptorT::static_size; ++j)
+      descriptor[j] = descriptorDistribution(generator);
+
+  runner.run("voctree.quantize.single", descriptors.size(), [&]() {
+    std::vector<voctree::Word> words(descriptors.size());
+    for(std::size_t i = 0; i < descriptors.size(); ++i)
+      words[i] = tree.quantize(descriptors[i]);
+    doNotOptimize(words);
+  });
+
+  runner.run("voctree.quantize.batched", descriptors.size(), [&]() {
+    const std::vector<voctree::Word> words = tree.quantize(descriptors);
+    doNotOptimize(words);
+  });
+}
+
+void benchmarkTracksBuilder(BenchmarkRunner& runner, std::mt19937& generator)
+{
+  if(!runner.isAnySelected({"track.build", "track.buildFilterExport"}))
+    return;
+
+  // a sequence of views, each one matched with its next neighbours
+  const IndexT nbViews = 100;
+  const IndexT nbNeighbours = 5;
+  const std::size_t nbFeatures = 5000;
+  const std::size_t nbMatchesPerPair = 2000;
+
+  // the features of each view are shuffled, so the tracks are spread over the feature ids
+  std::vector<std::vector<std::size_t>> featureIds(nbViews, std::vector<std::size_t>(nbFeatures));
+  for(std::vector<std::size_t>& viewFeatureIds : featureIds)
+  {
+    std::iota(viewFeatureIds.begin(), viewFeatureIds.end(), std::size_t(0));
+    std::shuffle(viewFeatureIds.begin(), viewFeatureIds.end(), generator);
+  }
+
+  matching::PairwiseMatches pairwiseMatches;
+  std::size_t nbMatches = 0;
+  std::uniform_int_distribution<std::size_t> pointDistribution(0, nbFeatures - 1);
+  for(IndexT i = 0; i < nbViews; ++i)
+  {
+    for(IndexT j = i + 1; j < std::min(nbViews, i + 1 + nbNeighbours); ++j)
+    {
+      matching::IndMatches& matches = pairwiseMatches[Pair(i, j)][feature::EImageDescriberType::SIFT];
+      matches.reserve(nbMatchesPerPair);
+      for(std::size_t m = 0; m < nbMatchesPerPair; ++m)
+      {
+        const std::size_t point = pointDistribution(generator);
+        matches.emplace_back(featureIds[i][point], featureIds[j][point]);
+      }
+      nbMatches += matches.size();
+    }
+  }
+
+  runner.run("track.build", nbMatches, [&]() {
+    track::TracksBuilder tracksBuilder;
+    tracksBuilder.build(pairwiseMatches);
+  });
+
+  runner.run("track.buildFilterExport", nbMatches, [&]() {
+    track::TracksBuilder tracksBuilder;
+    tracksBuilder.build(pairwiseMatches);
+    tracksBuilder.filter(true, 2);
+    track::TracksMap tracks;
+    tracksBuilder.exportToSTL(tracks);
+    doNotOptimize(tracks);
+  });
+}
+
+} // namespace
+
+void runFeatureBenchmarks(BenchmarkRunner& runner)
+{
+  std::mt19937 generator(0);
+
+  benchmarkDescriptorDistance(runner, generator);
+  benchmarkCascadeHashing(runner, generator);
+  benchmarkVocabularyTree(runner, generator);
+  benchmarkTracksBuilder(runner, generator);
+}
+
+} // namespace benchmarks
+} // namespace aliceVision
@@ -0,0 +1,235 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "Benchmark.hpp"
+
+#include <aliceVision/camera/PinholeRadial.hpp>
+#include <aliceVision/geometry/Pose3.hpp>
+#include <aliceVision/multiview/NViewDataSet.hpp>
+#include <aliceVision/multiview/essential.hpp>
+#include <aliceVision/multiview/RelativePoseKernel.hpp>
+#include <aliceVision/multiview/Unnormalizer.hpp>
+#include <aliceVision/multiview/relativePose/Essential5PSolver.hpp>
+#include <aliceVision/multiview/relativePose/Fundamental7PSolver.hpp>
+#include <aliceVision/multiview/relativePose/FundamentalError.hpp>
+#include <aliceVision/multiview/relativePose/Homography4PSolver.hpp>
+#include <aliceVision/multiview/relativePose/HomographyError.hpp>
+#include <aliceVision/multiview/resection/P3PSolver.hpp>
+#include <aliceVision/multiview/triangulation/Triangulation.hpp>
+#include <aliceVision/multiview/triangulation/triangulationDLT.hpp>
+#include <aliceVision/numeric/numeric.hpp>
+#include <aliceVision/robustEstimation/ACRansac.hpp>
+
+#include <random>
+#include <vector>
+
+namespace aliceVision {
+namespace benchmarks {
+
+namespace {
+
+// the images of the synthetic dataset (see NViewDatasetConfigurator)
+constexpr int imageSize = 1000;
+constexpr int nbCorrespondences = 2000;
+constexpr double outlierRatio = 0.3;
+constexpr std::size_t nbRansacIterations = 1024;
+
+/**
+ * @brief Replace a ratio of the correspondences by random points of the second image.
+ */
+void addOutliers(Mat& x2, std::mt19937& generator)
+{
+  std::uniform_real_distribution<double> distribution(0.0, imageSize);
+  for(Mat::Index i = 0; i < x2.cols(); ++i)
+  {
+    if(i % 10 < outlierRatio * 10)
+      x2.col(i) = Vec2(distribution(generator), distribution(generator));
+  }
+}
+
+template <typename KernelT>
+void benchmarkACRansac(BenchmarkRunner& runner, const std::string& name, const KernelT& kernel)
+{
+  runner.run(name, 1, [&]() {
+    std::mt19937 randomNumberGenerator(0);
+    std::vector<std::size_t> inliers;
+    robustEstimation::Mat3Model model;
+    robustEstimation::ACRANSAC(kernel, randomNumberGenerator, inliers, nbRansacIterations, &model, Square(4.0));
+    doNotOptimize(model);
+  });
+}
+
+void benchmarkRelativePose(BenchmarkRunner& runner, std::mt19937& generator)
+{
+  if(!runner.isAnySelected({"multiview.acransac.fundamental7P", "multiview.acransac.essential5P",
+                             "multiview.acransac.homography4P"}))
+    return;
+
+  const NViewDataSet dataset = NRealisticCamerasRing(2, nbCorrespondences);
+  const Mat x1 = dataset._x[0];
+  Mat x2 = dataset._x[1];
+  addOutliers(x2, generator);
+
+  {
+    using KernelT = multiview::RelativePoseKernel<multiview::relativePose::Fundamental7PSolver,
+                                                  multiview::relativePose::FundamentalEpipolarDistanceError,
+                                                  multiview::UnnormalizerT,
+                                                  robustEstimation::Mat3Model>;
+    const KernelT kernel(x1, imageSize, imageSize, x2, imageSize, imageSize, true);
+    benchmarkACRansac(runner, "multiview.acransac.fundamental7P", kernel);
+  }
+  {
+    using KernelT = multiview::RelativePoseKernel_K<multiview::relativePose::Essential5PSolver,
+                                                    multiview::relativePose::FundamentalEpipolarDistanceError,
+                                                    robustEstimation::Mat3Model>;
+    const KernelT kernel(x1, imageSize, imageSize, x2, imageSize, imageSize, dataset._K[0], dataset._K[1]);
+    benchmarkACRansac(runner, "multiview.acransac.essential5P", kernel);
+  }
+  {
+    // correspondences of a plane through a random homography
+    Mat3 H;
+    H << 1.1, 0.05, 20.0,
+         -0.03, 0.95, -15.0,
+         1e-5, -2e-5, 1.0;
+    std::uniform_real_distribution<double> distribution(0.0, imageSize);
+    std::normal_distribution<double> noise(0.0, 0.5);
+    Mat xH1(2, nbCorrespondences);
+    Mat xH2(2, nbCorrespondences);
+    for(int i = 0; i < nbCorrespondences; ++i)
+    {
+      const Vec2 p1(distribution(generator), distribution(generator));
+      const Vec3 p2 = H * p1.homogeneous();
+      xH1.col(i) = p1;
+      xH2.col(i) = p2.hnormalized() + Vec2(noise(generator), noise(generator));
+    }
+    addOutliers(xH2, generator);
+
+    using KernelT = multiview::RelativePoseKernel<multiview::relativePose::Homography4PSolver,
+                                                  multiview::relativePose::HomographyAsymmetricError,
+                                                  multiview::UnnormalizerI,
+                                                  robustEstimation::Mat3Model>;
+    const KernelT kernel(xH1, imageSize, imageSize, xH2, imageSize, imageSize, false);
+    benchmarkACRansac(runner, "multiview.acransac.homography4P", kernel);
+  }
+}
+
+void benchmarkResection(BenchmarkRunner& runner)
+{
+  if(!runner.isAnySelected({"multiview.resection.p3p"}))
+    return;
+
+  const NViewDataSet dataset = NRealisticCamerasRing(1, 3 * nbCorrespondences);
+
+  // the P3P solver works on the normalized image points
+  const Mat3 Kinv = dataset._K[0].inverse();
+  const Mat2X x2d = (Kinv * dataset._x[0].colwise().homogeneous()).colwise().hnormalized();
+
+  const multiview::resection::P3PSolver solver;
+  runner.run("multiview.resection.p3p", nbCorrespondences, [&]() {
+    std::vector<robustEstimation::Mat34Model> models;
+    for(int i = 0; i < nbCorrespondences; ++i)
+    {
+      models.clear();
+      solver.solveFixed(x2d.block<2, 3>(0, 3 * i), dataset._X.block<3, 3>(0, 3 * i), models);
+    }
+    doNotOptimize(models);
+  });
+}
+
+void benchmarkTriangulation(BenchmarkRunner& runner)
+{
+  if(!runner.isAnySelected({"multiview.triangulation.dlt2Views", "multiview.triangulation.nViews"}))
+    return;
+
+  const std::size_t nbViews = 8;
+  const NViewDataSet dataset = NRealisticCamerasRing(nbViews, nbCorrespondences);
+
+  std::vector<Mat34> Ps(nbViews);
+  for(std::size_t i = 0; i < nbViews; ++i)
+    Ps[i] = dataset.P(i);
+
+  runner.run("multiview.triangulation.dlt2Views", nbCorrespondences, [&]() {
+    Vec3 X;
+    for(int i = 0; i < nbCorrespondences; ++i)
+      multiview::TriangulateDLT(Ps[0], dataset._x[0].col(i), Ps[1], dataset._x[1].col(i), &X);
+    doNotOptimize(X);
+  });
+
+  runner.run("multiview.triangulation.nViews", nbCorrespondences, [&]() {
+    Mat2X x(2, nbViews);
+    Vec4 X;
+    for(int i = 0; i < nbCorrespondences; ++i)
+    {
+      for(std::size_t j = 0; j < nbViews; ++j)
+        x.col(j) = dataset._x[j].col(i);
+      multiview::TriangulateNView(x, Ps, &X);
+    }
+    doNotOptimize(X);
+  });
+}
+
+void benchmarkCamera(BenchmarkRunner& runner, std::mt19937& generator)
+{
+  if(!runner.isAnySelected({"camera.project", "camera.projectBatch", "camera.undistort", "camera.undistortBatch"}))
+    return;
+
+  const int nbPoints = 100000;
+  const camera::PinholeRadialK3 intrinsic(4000, 3000, 3500.0, 3500.0, 10.0, -5.0, -0.2, 0.1, -0.01);
+  const geometry::Pose3 pose(RotationAroundY(0.1), Vec3(0.1, 0.0, -1.0));
+
+  // points in front of the camera, and pixels in the image
+  std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+  std::uniform_real_distribution<double> widthDistribution(0.0, intrinsic.w());
+  std::uniform_real_distribution<double> heightDistribution(0.0, intrinsic.h());
+  Mat3X points(3, nbPoints);
+  Mat2X pixels(2, nbPoints);
+  for(int i = 0; i < nbPoints; ++i)
+  {
+    points.col(i) = Vec3(distribution(generator), distribution(generator), 5.0 + distribution(generator));
+    pixels.col(i) = Vec2(widthDistribution(generator), heightDistribution(generator));
+  }
+
+  runner.run("camera.project", nbPoints, [&]() {
+    Vec2 sum = Vec2::Zero();
+    for(int i = 0; i < nbPoints; ++i)
+      sum += intrinsic.project(pose, points.col(i).homogeneous());
+    doNotOptimize(sum);
+  });
+
+  runner.run("camera.projectBatch", nbPoints, [&]() {
+    Mat2X projected;
+    intrinsic.projectBatch(pose, points, projected);
+    doNotOptimize(projected);
+  });
+
+  runner.run("camera.undistort", nbPoints, [&]() {
+    Vec2 sum = Vec2::Zero();
+    for(int i = 0; i < nbPoints; ++i)
+      sum += intrinsic.get_ud_pixel(pixels.col(i));
+    doNotOptimize(sum);
+  });
+
+  runner.run("camera.undistortBatch", nbPoints, [&]() {
+    Mat2X undistorted;
+    intrinsic.get_ud_pixelBatch(pixels, undistorted);
+    doNotOptimize(undistorted);
+  });
+}
+
+} // namespace
+
+void runGeometryBenchmarks(BenchmarkRunner& runner)
+{
+  std::mt19937 generator(0);
+
+  benchmarkRelativePose(runner, generator);
+  benchmarkResection(runner);
+  benchmarkTriangulation(runner);
+  benchmarkCamera(runner, generator);
+}
+
+} // namespace benchmarks
+} // namespace aliceVision
@@ -0,0 +1,110 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "Benchmark.hpp"
+
+#include <aliceVision/camera/PinholeRadial.hpp>
+#include <aliceVision/camera/UndistortionMap.hpp>
+#include <aliceVision/camera/cameraUndistortImage.hpp>
+#include <aliceVision/image/Image.hpp>
+#include <aliceVision/image/filtering.hpp>
+#include <aliceVision/image/imageAlgo.hpp>
+#include <aliceVision/image/resampling.hpp>
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace benchmarks {
+
+namespace {
+
+constexpr int imageWidth = 2048;
+constexpr int imageHeight = 1536;
+
+template <typename T>
+void benchmarkImage(BenchmarkRunner& runner, const std::string& type, const image::Image<T>& input, T fillColor)
+{
+  const std::size_t nbPixels = static_cast<std::size_t>(input.Width()) * input.Height();
+
+  runner.run("image.convolution.gaussianSeparable" + type, nbPixels, [&]() {
+    image::Image<T> output;
+    image::ImageGaussianFilter(input, 1.6, output);
+    doNotOptimize(output);
+  });
+
+  runner.run("image.convolution.oiioGaussian" + type, nbPixels, [&]() {
+    image::Image<T> output;
+    imageAlgo::convolveImage(input, output);
+    doNotOptimize(output);
+  });
+
+  runner.run("image.resampling.halfSample" + type, nbPixels, [&]() {
+    image::Image<T> output;
+    image::ImageHalfSample(input, output);
+    doNotOptimize(output);
+  });
+
+  runner.run("image.resampling.resize" + type, nbPixels, [&]() {
+    image::Image<T> output;
+    imageAlgo::resizeImage(2, input, output);
+    doNotOptimize(output);
+  });
+
+  if(runner.isSelected("image.undistort" + type))
+  {
+    const camera::PinholeRadialK3 intrinsic(input.Width(), input.Height(), 1800.0, 1800.0, 0.0, 0.0, -0.2, 0.1, -0.01);
+    const camera::UndistortionMap undistortionMap(intrinsic, camera::UndistortionMapDomain(input.Width(), input.Height()));
+
+    runner.run("image.undistort" + type, nbPixels, [&]() {
+      image::Image<T> output;
+      camera::UndistortImage(input, undistortionMap, output, fillColor);
+      doNotOptimize(output);
+    });
+  }
+}
+
+} // namespace
+
+void runImageBenchmarks(BenchmarkRunner& runner)
+{
+  std::vector<std::string> names = {"image.laplacianPyramid"};
+  for(const std::string type : {"Float", "RGBf"})
+  {
+    for(const std::string kernel : {"convolution.gaussianSeparable", "convolution.oiioGaussian", "resampling.halfSample",
+                                    "resampling.resize", "undistort"})
+      names.push_back("image." + kernel + type);
+  }
+  if(!runner.isAnySelected(names))
+    return;
+
+  std::mt19937 generator(0);
+  std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+
+  image::Image<float> gray(imageWidth, imageHeight);
+  image::Image<image::RGBfColor> color(imageWidth, imageHeight);
+  for(int i = 0; i < imageHeight; ++i)
+  {
+    for(int j = 0; j < imageWidth; ++j)
+    {
+      gray(i, j) = distribution(generator);
+      color(i, j) = image::RGBfColor(distribution(generator), distribution(generator), distribution(generator));
+    }
+  }
+
+  benchmarkImage(runner, "Float", gray, 0.0f);
+  benchmarkImage(runner, "RGBf", color, image::RGBfColor(0.0f));
+
+  runner.run("image.laplacianPyramid", static_cast<std::size_t>(imageWidth) * imageHeight, [&]() {
+    std::vector<image::Image<image::RGBfColor>> pyramid;
+    imageAlgo::laplacianPyramid(pyramid, color, 4, 2);
+    doNotOptimize(pyramid);
+  });
+}
+
+} // namespace benchmarks
+} // namespace aliceVision
@@ -0,0 +1,77 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "Benchmark.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/cmdline.hpp>
+#include <aliceVision/system/main.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <memory>
+#include <regex>
+#include <string>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+
+namespace po = boost::program_options;
+
+int aliceVision_main(int argc, char** argv)
+{
+    // command-line parameters
+    std::string filter;
+    int minIterations = 10;
+    double minTime = 0.5;
+
+    po::options_description optionalParams("Optional parameters");
+    optionalParams.add_options()
+        ("filter", po::value<std::string>(&filter)->default_value(filter),
+         "Regular expression selecting the benchmarks to run by full name (e.g. 'multiview.acransac', '^image\\.', "
+         "'^camera\\.project$'), all of them if empty.")
+        ("minIterations", po::value<int>(&minIterations)->default_value(minIterations),
+         "Minimum number of timed runs of each benchmark.")
+        ("minTime", po::value<double>(&minTime)->default_value(minTime),
+         "Minimum time spent in each benchmark (s).");
+
+    CmdLine cmdline("This program times the hot kernels of AliceVision on synthetic data.\n"
+                    "Use --metricsFile to write the timings in a JSON file, to compare them between builds.\n"
+                    "AliceVision benchmarks");
+    cmdline.add(optionalParams);
+    if(!cmdline.execute(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+
+    std::unique_ptr<benchmarks::BenchmarkRunner> runner;
+    try
+    {
+        runner.reset(new benchmarks::BenchmarkRunner(filter, minIterations, minTime));
+    }
+    catch(const std::regex_error& e)
+    {
+        ALICEVISION_LOG_ERROR("Invalid benchmark filter '" << filter << "': " << e.what());
+        return EXIT_FAILURE;
+    }
+
+    benchmarks::runFeatureBenchmarks(*runner);
+    benchmarks::runGeometryBenchmarks(*runner);
+    benchmarks::runImageBenchmarks(*runner);
+
+    if(runner->nbRuns() == 0)
+    {
+        ALICEVISION_LOG_ERROR("No benchmark matches the filter '" << filter << "'.");
+        return EXIT_FAILURE;
+    }
+
+    ALICEVISION_LOG_INFO(runner->nbRuns() << " benchmarks done.");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,527 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/feature/FeaturesPerView.hpp>
+#include <aliceVision/feature/regionsFactory.hpp>
+#include <aliceVision/matching/IndMatch.hpp>
+#include <aliceVision/matching/RegionsMatcher.hpp>
+#include <aliceVision/matching/matcherType.hpp>
+#include <aliceVision/sfm/BundleAdjustmentCeres.hpp>
+#include <aliceVision/sfm/BundleAdjustmentSymbolicCeres.hpp>
+#include <aliceVision/sfm/pipeline/sequential/ReconstructionEngine_sequentialSfM.hpp>
+#include <aliceVision/sfm/utils/statistics.hpp>
+#include <aliceVision/sfm/utils/syntheticScene.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/MemoryTracker.hpp>
+#include <aliceVision/system/Metrics.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/system/cmdline.hpp>
+#include <aliceVision/system/main.hpp>
+#include <aliceVision/track/TracksBuilder.hpp>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
+
+using namespace aliceVision;
+
+namespace fs = boost::filesystem;
+namespace po = boost::program_options;
+
+namespace {
+
+const feature::EImageDescriberType descType = feature::EImageDescriberType::SIFT;
+using DescriptorT = feature::SIFT_Regions::DescriptorT;
+
+/**
+ * @brief The duration of each stage, for the final summary.
+ */
+class StageReport
+{
+public:
+  void add(const std::string& stage, double duration)
+  {
+    ALICEVISION_LOG_INFO("Stage '" << stage << "' done in " << duration << " s.");
+    system::Metrics::get().setGauge("pipelineBenchmark." + stage + ".time", duration);
+    _stages.emplace_back(stage, duration);
+  }
+
+  void log() const
+  {
+    std::stringstream summary;
+    summary << "Pipeline benchmark summary (the memory peaks of the stages are logged above and in the metrics):";
+    for(const auto& stage : _stages)
+      summary << std::endl << "\t- " << stage.first << ": " << stage.second << " s";
+    ALICEVISION_LOG_INFO(summary.str());
+  }
+
+private:
+  std::vector<std::pair<std::string, double>> _stages;
+};
+
+/**
+ * @brief The landmark of each feature of each view of the synthetic scene.
+ */
+std::map<IndexT, std::vector<IndexT>> getFeatureLandmarks(const sfmData::SfMData& scene)
+{
+  std::map<IndexT, std::vector<IndexT>> featureLandmarks;
+  for(const auto& viewIt : scene.getViews())
+    featureLandmarks[viewIt.first];
+
+  for(const auto& landmarkIt : scene.getLandmarks())
+  {
+    for(const auto& observationIt : landmarkIt.second.observations)
+    {
+      std::vector<IndexT>& landmarks = featureLandmarks.at(observationIt.first);
+      if(landmarks.size() <= observationIt.second.id_feat)
+        landmarks.resize(observationIt.second.id_feat + 1, UndefinedIndexT);
+      landmarks[observationIt.second.id_feat] = landmarkIt.first;
+    }
+  }
+  return featureLandmarks;
+}
+
+/**
+ * @brief Select the pairs of views to match, as the image matching would:
+ *        the views that share enough landmarks.
+ */
+std::map<IndexT, std::vector<IndexT>> selectPairs(const sfmData::SfMData& scene,
+                                                  const std::map<IndexT, std::vector<IndexT>>& featureLandmarks,
+                                                  std::size_t minNbSharedLandmarks)
+{
+  const std::vector<IndexT> viewIds = [&]() {
+    std::vector<IndexT> ids;
+    for(const auto& it : featureLandmarks)
+      ids.push_back(it.first);
+    return ids;
+  }();
+
+  std::vector<std::vector<IndexT>> neighbours(viewIds.size());
+
+  #pragma omp parallel for schedule(dynamic)
+  for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(viewIds.size()); ++i)
+  {
+    const IndexT viewId = viewIds[i];
+    std::map<IndexT, std::size_t> nbSharedLandmarks;
+    for(IndexT landmarkId : featureLandmarks.at(viewId))
+    {
+      if(landmarkId == UndefinedIndexT)
+        continue;
+      for(const auto& observationIt : scene.getLandmarks().at(landmarkId).observations)
+      {
+        if(observationIt.first > viewId)
+          ++nbSharedLandmarks[observationIt.first];
+      }
+    }
+    for(const auto& it : nbSharedLandmarks)
+    {
+      if(it.second >= minNbSharedLandmarks)
+        neighbours[i].push_back(it.first);
+    }
+  }
+
+  std::map<IndexT, std::vector<IndexT>> pairs;
+  for(std::size_t i = 0; i < viewIds.size(); ++i)
+  {
+    if(!neighbours[i].empty())
+      pairs[viewIds[i]] = std::move(neighbours[i]);
+  }
+  return pairs;
+}
+
+/**
+ * @brief Create the regions of a view: each feature has the descriptor of its landmark with some noise.
+ *        The noise only depends on the view, so the regions of a view are the same each time they are created.
+ */
+feature::SIFT_Regions createRegions(IndexT viewId,
+                                    const feature::FeaturesPerView& featuresPerView,
+                                    const std::vector<IndexT>& featureLandmarks,
+                                    const std::vector<DescriptorT>& landmarkDescriptors,
+                                    double descriptorNoise,
+                                    unsigned int seed)
+{
+  std::seed_seq seedSequence{seed, static_cast<unsigned int>(viewId)};
+  std::mt19937 generator(seedSequence);
+  std::normal_distribution<float> noise(0.f, static_cast<float>(descriptorNoise));
+
+  feature::SIFT_Regions regions;
+  regions.Features() = featuresPerView.getFeatures(viewId, descType);
+  regions.Descriptors().resize(regions.Features().size());
+  for(std::size_t f = 0; f < regions.Descriptors().size(); ++f)
+  {
+    const DescriptorT& landmarkDescriptor = landmarkDescriptors.at(featureLandmarks.at(f));
+    DescriptorT& descriptor = regions.Descriptors()[f];
+    for(std::size_t i = 0; i < DescriptorT::static_size; ++i)
+      descriptor[i] = static_cast<unsigned char>(std::min(255.f, std::max(0.f, landmarkDescriptor[i] + noise(generator))));
+  }
+  return regions;
+}
+
+/**
+ * @brief Move the poses and the landmarks of the scene and use the noisy features as observations,
+ *        to start the bundle adjustment from the ground truth when the SfM is not run.
+ */
+void perturbScene(sfmData::SfMData& scene, const feature::FeaturesPerView& featuresPerView, double positionNoise, unsigned int seed)
+{
+  std::mt19937 generator(seed);
+  std::normal_distribution<double> position(0.0, positionNoise);
+  std::normal_distribution<double> angle(0.0, degreeToRadian(0.1));
+
+  for(auto& poseIt : scene.getPoses())
+  {
+    const geometry::Pose3& pose = poseIt.second.getTransform();
+    const Mat3 rotation = RotationAroundX(angle(generator)) * RotationAroundY(angle(generator)) * pose.rotation();
+    const Vec3 center = pose.center() + Vec3(position(generator), position(generator), position(generator));
+    poseIt.second.setTransform(geometry::Pose3(rotation, center));
+  }
+
+  for(auto& landmarkIt : scene.getLandmarks())
+  {
+    sfmData::Landmark& landmark = landmarkIt.second;
+    landmark.X += Vec3(position(generator), position(generator), position(generator));
+    for(auto& observationIt : landmark.observations)
+    {
+      const feature::PointFeature& feature = featuresPerView.getFeatures(observationIt.first, descType).at(observationIt.second.id_feat);
+      observationIt.second.x = feature.coords().cast<double>();
+    }
+  }
+}
+
+} // namespace
+
+int aliceVision_main(int argc, char** argv)
+{
+    // command-line parameters
+    std::string outputFolder;
+    sfm::SyntheticSurveyConfigurator surveyConfig;
+    std::string stagesName = "matching,tracks,sfm,bundleAdjustment";
+    double featureNoise = 0.5;
+    double descriptorNoise = 10.0;
+    std::string matcherTypeName = matching::EMatcherType_enumToString(matching::CASCADE_HASHING_L2);
+    float distRatio = 0.8f;
+    std::size_t minNbSharedLandmarks = 30;
+
+    po::options_description requiredParams("Required parameters");
+    requiredParams.add_options()
+        ("output,o", po::value<std::string>(&outputFolder)->required(),
+         "Output folder of the reconstruction logs.");
+
+    po::options_description sceneParams("Synthetic scene parameters");
+    sceneParams.add_options()
+        ("nbViews", po::value<std::size_t>(&surveyConfig.nbViews)->default_value(surveyConfig.nbViews),
+         "Number of views, on a square grid above the ground.")
+        ("nbPoints", po::value<std::size_t>(&surveyConfig.nbPoints)->default_value(surveyConfig.nbPoints),
+         "Number of 3D points on the ground.")
+        ("sceneSize", po::value<double>(&surveyConfig.sceneSize)->default_value(surveyConfig.sceneSize),
+         "Side of the square ground (m).")
+        ("relief", po::value<double>(&surveyConfig.relief)->default_value(surveyConfig.relief),
+         "Maximum height of the 3D points above the ground (m).")
+        ("overlap", po::value<double>(&surveyConfig.overlap)->default_value(surveyConfig.overlap),
+         "Side of the ground seen by an image, in distances between two neighbour views.")
+        ("featureNoise", po::value<double>(&featureNoise)->default_value(featureNoise),
+         "Standard deviation of the feature positions (px).")
+        ("descriptorNoise", po::value<double>(&descriptorNoise)->default_value(descriptorNoise),
+         "Standard deviation of the descriptor values of the observations of a landmark.")
+        ("seed", po::value<unsigned int>(&surveyConfig.seed)->default_value(surveyConfig.seed),
+         "Seed of the random generators, for reproducible scenes.");
+
+    po::options_description optionalParams("Optional parameters");
+    optionalParams.add_options()
+        ("stages", po::value<std::string>(&stagesName)->default_value(stagesName),
+         "Comma separated stages to run: matching, tracks, sfm, bundleAdjustment, symbolicBundleAdjustment.\n"
+         "Without matching, the tracks and the SfM use the ground truth matches. "
+         "Without sfm, the bundle adjustment starts from the perturbed ground truth scene. "
+         "symbolicBundleAdjustment runs the bundle adjustment with analytic jacobians on the same input as bundleAdjustment.")
+        ("matcherType", po::value<std::string>(&matcherTypeName)->default_value(matcherTypeName),
+         "Matcher of the matching stage (BRUTE_FORCE_L2, ANN_L2, CASCADE_HASHING_L2, FAST_CASCADE_HASHING_L2).")
+        ("distanceRatio", po::value<float>(&distRatio)->default_value(distRatio),
+         "Distance ratio of the matching stage.")
+        ("minNbSharedLandmarks", po::value<std::size_t>(&minNbSharedLandmarks)->default_value(minNbSharedLandmarks),
+         "Minimum number of landmarks seen by two views to match them.");
+
+    CmdLine cmdline("This program generates a synthetic aerial survey and runs the SfM pipeline on it, "
+                    "reporting the time and the memory peak of each stage (see --metricsFile).\n"
+                    "AliceVision pipelineBenchmark");
+    cmdline.add(requiredParams);
+    cmdline.add(sceneParams);
+    cmdline.add(optionalParams);
+    if(!cmdline.execute(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+
+    std::set<std::string> stages;
+    {
+        std::vector<std::string> stageNames;
+        boost::split(stageNames, stagesName, boost::is_any_of(","));
+        for(const std::string& stage : stageNames)
+        {
+            const std::string name = boost::trim_copy(stage);
+            if(name.empty())
+                continue;
+            if(name != "matching" && name != "tracks" && name != "sfm" && name != "bundleAdjustment" && name != "symbolicBundleAdjustment")
+            {
+                ALICEVISION_LOG_ERROR("Unknown pipeline stage '" << name << "'.");
+                return EXIT_FAILURE;
+            }
+            stages.insert(name);
+        }
+    }
+
+    if(surveyConfig.nbViews < 2 || surveyConfig.nbPoints < 1 || surveyConfig.sceneSize <= 0.0 || surveyConfig.overlap <= 0.0)
+    {
+        ALICEVISION_LOG_ERROR("Invalid synthetic scene parameters.");
+        return EXIT_FAILURE;
+    }
+
+    if(!fs::exists(outputFolder))
+        fs::create_directories(outputFolder);
+
+    system::Metrics& metrics = system::Metrics::get();
+    StageReport report;
+
+    // synthetic scene and its features
+    sfmData::SfMData scene;
+    feature::FeaturesPerView featuresPerView;
+    {
+        ALICEVISION_MEMORY_STAGE("sceneGeneration");
+        system::Timer timer;
+
+        scene = sfm::getSyntheticSurveyScene(surveyConfig);
+
+        std::normal_distribution<double> noise(0.0, featureNoise);
+        sfm::generateSyntheticFeatures(featuresPerView, descType, scene, noise, surveyConfig.seed);
+
+        std::size_t nbObservations = 0;
+        for(const auto& landmarkIt : scene.getLandmarks())
+            nbObservations += landmarkIt.second.observations.size();
+
+        ALICEVISION_LOG_INFO("Synthetic scene: " << scene.getViews().size() << " views, "
+                             << scene.getLandmarks().size() << " landmarks, " << nbObservations << " observations.");
+        metrics.setGauge("pipelineBenchmark.scene.nbViews", scene.getViews().size());
+        metrics.setGauge("pipelineBenchmark.scene.nbLandmarks", scene.getLandmarks().size());
+        metrics.setGauge("pipelineBenchmark.scene.nbObservations", nbObservations);
+
+        report.add("sceneGeneration", timer.elapsed());
+    }
+
+    // matching
+    matching::PairwiseMatches pairwiseMatches;
+    if(stages.count("matching"))
+    {
+        ALICEVISION_MEMORY_STAGE("matching");
+        system::Timer timer;
+
+        const matching::EMatcherType matcherType = matching::EMatcherType_stringToEnum(matcherTypeName);
+        const std::map<IndexT, std::vector<IndexT>> featureLandmarks = getFeatureLandmarks(scene);
+        const std::map<IndexT, std::vector<IndexT>> pairs = selectPairs(scene, featureLandmarks, minNbSharedLandmarks);
+
+        // a random descriptor per landmark
+        std::vector<DescriptorT> landmarkDescriptors(surveyConfig.nbPoints);
+        {
+            std::mt19937 generator(surveyConfig.seed);
+            std::uniform_int_distribution<int> distribution(0, 255);
+            for(DescriptorT& descriptor : landmarkDescriptors)
+                for(std::size_t i = 0; i < DescriptorT::static_size; ++i)
+                    descriptor[i] = static_cast<unsigned char>(distribution(generator));
+        }
+
+        std::vector<IndexT> databaseViewIds;
+        std::size_t nbPairs = 0;
+        for(const auto& it : pairs)
+        {
+            databaseViewIds.push_back(it.first);
+            nbPairs += it.second.size();
+        }
+        ALICEVISION_LOG_INFO("Match " << nbPairs << " pairs of views.");
+
+        std::size_t nbMatches = 0;
+        std::size_t nbCorrectMatches = 0;
+
+        // each view is the database of its pairs, the regions of the other views are created on the fly
+        #pragma omp parallel for schedule(dynamic) reduction(+:nbMatches, nbCorrectMatches)
+        for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(databaseViewIds.size()); ++i)
+        {
+            const IndexT viewI = databaseViewIds[i];
+            const std::vector<IndexT>& landmarksI = featureLandmarks.at(viewI);
+            const feature::SIFT_Regions regionsI =
+              createRegions(viewI, featuresPerView, landmarksI, landmarkDescriptors, descriptorNoise, surveyConfig.seed);
+            if(regionsI.RegionCount() == 0)
+                continue;
+
+            std::mt19937 randomNumberGenerator(surveyConfig.seed + viewI);
+            const matching::RegionsDatabaseMatcher matcher(randomNumberGenerator, matcherType, regionsI);
+
+            for(IndexT viewJ : pairs.at(viewI))
+            {
+                const std::vector<IndexT>& landmarksJ = featureLandmarks.at(viewJ);
+                const feature::SIFT_Regions regionsJ =
+                  createRegions(viewJ, featuresPerView, landmarksJ, landmarkDescriptors, descriptorNoise, surveyConfig.seed);
+
+                matching::IndMatches matches;
+                matcher.Match(distRatio, regionsJ, matches);
+                if(matches.empty())
+                    continue;
+
+                nbMatches += matches.size();
+                for(const matching::IndMatch& match : matches)
+                {
+                    if(landmarksI.at(match._i) == landmarksJ.at(match._j))
+                        ++nbCorrectMatches;
+                }
+
+                #pragma omp critical
+                {
+                    pairwiseMatches[Pair(viewI, viewJ)][descType] = std::move(matches);
+                }
+            }
+        }
+
+        const double precision = (nbMatches > 0) ? double(nbCorrectMatches) / nbMatches : 0.0;
+        ALICEVISION_LOG_INFO(nbMatches << " matches in " << pairwiseMatches.size() << " pairs, " << precision * 100.0 << "% correct.");
+        metrics.setGauge("pipelineBenchmark.matching.nbPairs", pairwiseMatches.size());
+        metrics.setGauge("pipelineBenchmark.matching.nbMatches", nbMatches);
+        metrics.setGauge("pipelineBenchmark.matching.precision", precision);
+
+        report.add("matching", timer.elapsed());
+    }
+    else if(stages.count("tracks") || stages.count("sfm"))
+    {
+        ALICEVISION_LOG_INFO("No matching stage, use the ground truth matches.");
+        sfm::generateSyntheticMatches(pairwiseMatches, scene, descType);
+    }
+
+    // tracks
+    if(stages.count("tracks"))
+    {
+        ALICEVISION_MEMORY_STAGE("tracks");
+        system::Timer timer;
+
+        track::TracksBuilder tracksBuilder;
+        tracksBuilder.build(pairwiseMatches);
+        tracksBuilder.filter(true, 2);
+        track::TracksMap tracks;
+        tracksBuilder.exportToSTL(tracks);
+
+        ALICEVISION_LOG_INFO(tracks.size() << " tracks.");
+        metrics.setGauge("pipelineBenchmark.tracks.nbTracks", tracks.size());
+
+        report.add("tracks", timer.elapsed());
+    }
+
+    // sfm
+    sfmData::SfMData reconstruction;
+    const bool hasReconstruction = stages.count("sfm");
+    if(hasReconstruction)
+    {
+        ALICEVISION_MEMORY_STAGE("sfm");
+        system::Timer timer;
+
+        sfmData::SfMData sfmInput = scene;
+        sfmInput.getPoses().clear();
+        sfmInput.getLandmarks().clear();
+
+        sfm::ReconstructionEngine_sequentialSfM::Params sfmParams;
+        sfmParams.lockAllIntrinsics = true;
+
+        sfm::ReconstructionEngine_sequentialSfM sfmEngine(sfmInput, sfmParams, outputFolder);
+        sfmEngine.setFeatures(&featuresPerView);
+        sfmEngine.setMatches(&pairwiseMatches);
+
+        if(!sfmEngine.process())
+            ALICEVISION_LOG_WARNING("The SfM failed.");
+
+        reconstruction = sfmEngine.getSfMData();
+        ALICEVISION_LOG_INFO(reconstruction.getPoses().size() << " poses and " << reconstruction.getLandmarks().size() << " landmarks reconstructed.");
+        metrics.setGauge("pipelineBenchmark.sfm.nbPoses", reconstruction.getPoses().size());
+        metrics.setGauge("pipelineBenchmark.sfm.nbLandmarks", reconstruction.getLandmarks().size());
+
+        report.add("sfm", timer.elapsed());
+    }
+
+    // bundle adjustment
+    if(stages.count("bundleAdjustment") || stages.count("symbolicBundleAdjustment"))
+    {
+        if(!hasReconstruction)
+        {
+            // start from the ground truth, 1% of the distance between two views away
+            reconstruction = scene;
+            const double spacing = surveyConfig.sceneSize / std::ceil(std::sqrt(double(surveyConfig.nbViews)));
+            perturbScene(reconstruction, featuresPerView, 0.01 * spacing, surveyConfig.seed);
+        }
+    }
+    const sfm::BundleAdjustment::ERefineOptions refineOptions = sfm::BundleAdjustment::REFINE_ROTATION |
+                                                                sfm::BundleAdjustment::REFINE_TRANSLATION |
+                                                                sfm::BundleAdjustment::REFINE_STRUCTURE;
+
+    // automatic differentiation
+    if(stages.count("bundleAdjustment"))
+    {
+        sfmData::SfMData adjusted = reconstruction;
+
+        ALICEVISION_MEMORY_STAGE("bundleAdjustment");
+        system::Timer timer;
+
+        sfm::BundleAdjustmentCeres::CeresOptions options(false);
+        if(adjusted.getPoses().size() > 100)
+            options.setSparseBA();
+        else
+            options.setDenseBA();
+
+        sfm::BundleAdjustmentCeres bundleAdjustment(options);
+        if(!bundleAdjustment.adjust(adjusted, refineOptions))
+            ALICEVISION_LOG_WARNING("The bundle adjustment failed.");
+
+        const double rmse = sfm::RMSE(adjusted);
+        ALICEVISION_LOG_INFO("Bundle adjustment RMSE: " << rmse << " px.");
+        metrics.setGauge("pipelineBenchmark.bundleAdjustment.RMSE", rmse);
+
+        report.add("bundleAdjustment", timer.elapsed());
+    }
+
+    // analytic jacobians
+    if(stages.count("symbolicBundleAdjustment"))
+    {
+        sfmData::SfMData adjusted = reconstruction;
+
+        ALICEVISION_MEMORY_STAGE("symbolicBundleAdjustment");
+        system::Timer timer;
+
+        sfm::BundleAdjustmentSymbolicCeres::CeresOptions options(false);
+        if(adjusted.getPoses().size() > 100)
+            options.setSparseBA();
+        else
+            options.setDenseBA();
+
+        sfm::BundleAdjustmentSymbolicCeres bundleAdjustment(options);
+        if(!bundleAdjustment.adjust(adjusted, refineOptions))
+            ALICEVISION_LOG_WARNING("The symbolic bundle adjustment failed.");
+
+        const double rmse = sfm::RMSE(adjusted);
+        ALICEVISION_LOG_INFO("Symbolic bundle adjustment RMSE: " << rmse << " px.");
+        metrics.setGauge("pipelineBenchmark.symbolicBundleAdjustment.RMSE", rmse);
+
+        report.add("symbolicBundleAdjustment", timer.elapsed());
+    }
+
+    report.log();
+    return EXIT_SUCCESS;
+}
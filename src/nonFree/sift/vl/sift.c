@@ -802,17 +802,39 @@ _vl_sift_smooth (VlSiftFilt * self,
     return ;
   }
 
-  vl_imconvcol_vf (tempImage, height,
-                   inputImage, width, height, width,
-                   self->gaussFilter,
-                   - self->gaussFilterWidth, self->gaussFilterWidth,
-                   1, VL_PAD_BY_CONTINUITY | VL_TRANSPOSE) ;
-
-  vl_imconvcol_vf (outputImage, width,
-                   tempImage, height, width, height,
-                   self->gaussFilter,
-                   - self->gaussFilterWidth, self->gaussFilterWidth,
-                   1, VL_PAD_BY_CONTINUITY | VL_TRANSPOSE) ;
+  {
+    /* The columns are convolved independently, they are split in chunks
+     * processed in parallel. The chunks start on multiples of 4 columns
+     * so that the SSE2 code path keeps the buffers aligned. */
+    vl_index const chunkSize = 64 ;
+    vl_index const numColumnChunks = ((vl_index)width + chunkSize - 1) / chunkSize ;
+    vl_index const numRowChunks = ((vl_index)height + chunkSize - 1) / chunkSize ;
+    vl_index c ;
+
+#if defined(_OPENMP)
+#pragma omp parallel for if (width * height > 128 * 128)
+#endif
+    for (c = 0 ; c < numColumnChunks ; ++c) {
+      vl_size x = c * chunkSize ;
+      vl_imconvcol_vf (tempImage + x * height, height,
+                       inputImage + x, VL_MIN((vl_size)chunkSize, width - x), height, width,
+                       self->gaussFilter,
+                       - self->gaussFilterWidth, self->gaussFilterWidth,
+                       1, VL_PAD_BY_CONTINUITY | VL_TRANSPOSE) ;
+    }
+
+#if defined(_OPENMP)
+#pragma omp parallel for if (width * height > 128 * 128)
+#endif
+    for (c = 0 ; c < numRowChunks ; ++c) {
+      vl_size y = c * chunkSize ;
+      vl_imconvcol_vf (outputImage + y * width, width,
+                       tempImage + y, VL_MIN((vl_size)chunkSize, height - y), width, height,
+                       self->gaussFilter,
+                       - self->gaussFilterWidth, self->gaussFilterWidth,
+                       1, VL_PAD_BY_CONTINUITY | VL_TRANSPOSE) ;
+    }
+  }
 }
 
 /** ------------------------------------------------------------------
@@ -1450,8 +1472,6 @@ vl_sift_update_gradient (VlSiftFilt *f)
   int       s_max = f->s_max ;
   int       w     = vl_sift_get_octave_width  (f) ;
   int       h     = vl_sift_get_octave_height (f) ;
-  int const xo    = 1 ;
-  int const yo    = w ;
   int const so    = h * w ;
   int y, s ;
 
@@ -1460,72 +1480,49 @@ vl_sift_update_gradient (VlSiftFilt *f)
   for (s  = s_min + 1 ;
        s <= s_max - 2 ; ++ s) {
 
-    vl_sift_pix *src, *end, *grad, gx, gy ;
+    vl_sift_pix const *octave = vl_sift_get_octave (f,s) ;
+    vl_sift_pix *octaveGrad = f->grad + 2 * so * (s - s_min -1) ;
 
-#define SAVE_BACK                                                       \
-    *grad++ = vl_fast_sqrt_f (gx*gx + gy*gy) ;                          \
-    *grad++ = vl_mod_2pi_f   (vl_fast_atan2_f (gy, gx) + 2*VL_PI) ;     \
-    ++src ;                                                             \
-
-    src  = vl_sift_get_octave (f,s) ;
-    grad = f->grad + 2 * so * (s - s_min -1) ;
-
-    /* first pixel of the first row */
-    gx = src[+xo] - src[0] ;
-    gy = src[+yo] - src[0] ;
-    SAVE_BACK ;
-
-    /* middle pixels of the  first row */
-    end = (src - 1) + w - 1 ;
-    while (src < end) {
-      gx = 0.5 * (src[+xo] - src[-xo]) ;
-      gy =        src[+yo] - src[0] ;
-      SAVE_BACK ;
-    }
+    /* the rows are independent, they are processed in parallel */
+#if defined(_OPENMP)
+#pragma omp parallel for if (so > 128 * 128)
+#endif
+    for (y = 0 ; y < h ; ++y) {
+      /* offsets and scale of the vertical difference, one-sided on the first and last rows */
+      int const yn = (y < h - 1) ? w : 0 ;
+      int const yp = (y > 0) ? w : 0 ;
+      double const ys = (y > 0 && y < h - 1) ? 0.5 : 1.0 ;
 
-    /* last pixel of the first row */
-    gx = src[0]   - src[-xo] ;
-    gy = src[+yo] - src[0] ;
-    SAVE_BACK ;
+      vl_sift_pix const *src = octave + y * w ;
+      vl_sift_pix const *end ;
+      vl_sift_pix *grad = octaveGrad + 2 * y * w ;
+      vl_sift_pix gx, gy ;
 
-    for (y = 1 ; y < h -1 ; ++y) {
+#define SAVE_BACK                                                       \
+      *grad++ = vl_fast_sqrt_f (gx*gx + gy*gy) ;                        \
+      *grad++ = vl_mod_2pi_f   (vl_fast_atan2_f (gy, gx) + 2*VL_PI) ;   \
+      ++src ;                                                           \
 
-      /* first pixel of the middle rows */
-      gx =        src[+xo] - src[0] ;
-      gy = 0.5 * (src[+yo] - src[-yo]) ;
+      /* first pixel of the row */
+      gx = src[+1] - src[0] ;
+      gy = ys * (src[+yn] - src[-yp]) ;
       SAVE_BACK ;
 
-      /* middle pixels of the middle rows */
+      /* middle pixels of the row */
       end = (src - 1) + w - 1 ;
       while (src < end) {
-        gx = 0.5 * (src[+xo] - src[-xo]) ;
-        gy = 0.5 * (src[+yo] - src[-yo]) ;
+        gx = 0.5 * (src[+1] - src[-1]) ;
+        gy = ys * (src[+yn] - src[-yp]) ;
         SAVE_BACK ;
       }
 
-      /* last pixel of the middle row */
-      gx =        src[0]   - src[-xo] ;
-      gy = 0.5 * (src[+yo] - src[-yo]) ;
+      /* last pixel of the row */
+      gx = src[0] - src[-1] ;
+      gy = ys * (src[+yn] - src[-yp]) ;
       SAVE_BACK ;
-    }
 
-    /* first pixel of the last row */
-    gx = src[+xo] - src[0] ;
-    gy = src[  0] - src[-yo] ;
-    SAVE_BACK ;
-
-    /* middle pixels of the last row */
-    end = (src - 1) + w - 1 ;
-    while (src < end) {
-      gx = 0.5 * (src[+xo] - src[-xo]) ;
-      gy =        src[0]   - src[-yo] ;
-      SAVE_BACK ;
+#undef SAVE_BACK
     }
-
-    /* last pixel of the last row */
-    gx = src[0]   - src[-xo] ;
-    gy = src[0]   - src[-yo] ;
-    SAVE_BACK ;
   }
   f->grad_o = f->o_cur ;
 }
@@ -0,0 +1,172 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/panorama/gaussian.hpp>
+#include <aliceVision/panorama/imageOps.hpp>
+#include <aliceVision/image/all.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/system/cmdline.hpp>
+#include <aliceVision/system/main.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+
+namespace po = boost::program_options;
+
+/**
+ * @brief Mean time of a function over several iterations (ms)
+ */
+template <class F>
+double benchmark(int nbIterations, F f)
+{
+    system::Timer timer;
+    for(int i = 0; i < nbIterations; ++i)
+    {
+        f();
+    }
+    return timer.elapsedMs() / nbIterations;
+}
+
+template <class T>
+float maxDifference(const image::Image<T>& a, const image::Image<T>& b, int channels)
+{
+    const float* da = reinterpret_cast<const float*>(a.data());
+    const float* db = reinterpret_cast<const float*>(b.data());
+
+    float diff = 0.0f;
+    for(int i = 0; i < a.Width() * a.Height() * channels; ++i)
+    {
+        diff = std::max(diff, std::abs(da[i] - db[i]));
+    }
+    return diff;
+}
+
+template <class T>
+void benchmarkGaussian(const std::string& name, const image::Image<T>& input, int channels, int nbIterations)
+{
+    image::Image<T> outputGeneric(input.Width(), input.Height());
+    image::Image<T> outputVectorized(input.Width(), input.Height());
+
+    const double genericMs =
+        benchmark(nbIterations, [&]() { convolveGaussian5x5Generic<T>(outputGeneric, input); });
+    const double vectorizedMs =
+        benchmark(nbIterations, [&]() { convolveGaussian5x5<T>(outputVectorized, input); });
+
+    ALICEVISION_LOG_INFO(name << " gaussian 5x5:" << std::endl
+                              << "\t- generic: " << genericMs << " ms" << std::endl
+                              << "\t- vectorized: " << vectorizedMs << " ms (x" << genericMs / vectorizedMs << ")"
+                              << std::endl
+                              << "\t- max difference: " << maxDifference(outputGeneric, outputVectorized, channels));
+}
+
+template <class T>
+void benchmarkResampling(const std::string& name, const image::Image<T>& input, int nbIterations)
+{
+    image::Image<T> half(input.Width() / 2, input.Height() / 2);
+    image::Image<T> full(input.Width(), input.Height());
+
+    const double downscaleMs = benchmark(nbIterations, [&]() { downscale(half, input); });
+    const double upscaleMs = benchmark(nbIterations, [&]() { upscale(full, half); });
+
+    ALICEVISION_LOG_INFO(name << " resampling:" << std::endl
+                              << "\t- downscale: " << downscaleMs << " ms" << std::endl
+                              << "\t- upscale: " << upscaleMs << " ms");
+}
+
+int aliceVision_main(int argc, char** argv)
+{
+    // command-line parameters
+
+    std::string verboseLevel = system::EVerboseLevel_enumToString(system::Logger::getDefaultVerboseLevel());
+    int width = 4096;
+    int height = 2048;
+    int nbIterations = 10;
+
+    po::options_description allParams("AliceVision panoramaPyramidBenchmark\n"
+                                      "Compare the vectorized panorama pyramid kernels to the generic ones.");
+
+    po::options_description optionalParams("Optional parameters");
+    optionalParams.add_options()
+        ("width", po::value<int>(&width)->default_value(width),
+         "Width of the random test image.")
+        ("height", po::value<int>(&height)->default_value(height),
+         "Height of the random test image.")
+        ("iterations", po::value<int>(&nbIterations)->default_value(nbIterations),
+         "Number of runs of each kernel.");
+
+    po::options_description logParams("Log parameters");
+    logParams.add_options()
+        ("verboseLevel,v", po::value<std::string>(&verboseLevel)->default_value(verboseLevel),
+         "verbosity level (fatal, error, warning, info, debug, trace).");
+
+    allParams.add(optionalParams).add(logParams);
+
+    po::variables_map vm;
+    try
+    {
+        po::store(po::parse_command_line(argc, argv, allParams), vm);
+
+        if(vm.count("help"))
+        {
+            ALICEVISION_COUT(allParams);
+            return EXIT_SUCCESS;
+        }
+        po::notify(vm);
+    }
+    catch(boost::program_options::error& e)
+    {
+        ALICEVISION_CERR("ERROR: " << e.what());
+        ALICEVISION_COUT("Usage:\n\n" << allParams);
+        return EXIT_FAILURE;
+    }
+
+    ALICEVISION_COUT("Program called with the following parameters:");
+    ALICEVISION_COUT(vm);
+
+    // set verbose level
+    system::Logger::get()->setLogLevel(verboseLevel);
+
+    if(width < 3 || height < 3 || nbIterations < 1)
+    {
+        ALICEVISION_LOG_ERROR("Invalid benchmark size.");
+        return EXIT_FAILURE;
+    }
+
+    std::mt19937 generator(0);
+    std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+
+    image::Image<image::RGBfColor> color(width, height);
+    image::Image<float> weights(width, height);
+    for(int i = 0; i < height; ++i)
+    {
+        for(int j = 0; j < width; ++j)
+        {
+            color(i, j) = image::RGBfColor(distribution(generator), distribution(generator), distribution(generator));
+            weights(i, j) = distribution(generator);
+        }
+    }
+
+    ALICEVISION_LOG_INFO("Benchmark on " << width << "x" << height << " images, " << nbIterations << " iterations.");
+
+    benchmarkGaussian("RGB", color, 3, nbIterations);
+    benchmarkGaussian("Float", weights, 1, nbIterations);
+    benchmarkResampling("RGB", color, nbIterations);
+    benchmarkResampling("Float", weights, nbIterations);
+
+    return EXIT_SUCCESS;
+}
@@ -9,17 +9,23 @@
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/cmdline.hpp>
 #include <aliceVision/system/main.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
 
+#include <OpenImageIO/imageio.h>
+
+#include <algorithm>
+#include <atomic>
 #include <cstdlib>
 #include <string>
+#include <vector>
 
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
@@ -32,6 +38,8 @@ int aliceVision_main(int argc, char** argv)
   std::vector<std::string> imagePaths;
   std::string outputFolder;
   std::string outImageFileTypeName = image::EImageFileType_enumToString(image::EImageFileType::EXR);
+  int nbParallelImages = 0;
+  int nbDemosaicThreads = 0;
 
   po::options_description requiredParams("Required parameters");
   requiredParams.add_options()
@@ -43,7 +51,11 @@ int aliceVision_main(int argc, char** argv)
   po::options_description optionalParams("Optional parameters");
   optionalParams.add_options()
     ("outputFileType", po::value<std::string>(&outImageFileTypeName)->default_value(outImageFileTypeName),
-      image::EImageFileType_informations().c_str());
+      image::EImageFileType_informations().c_str())
+    ("nbParallelImages", po::value<int>(&nbParallelImages)->default_value(nbParallelImages),
+      "Number of images decoded in parallel (0: as many as the available cores).")
+    ("nbDemosaicThreads", po::value<int>(&nbDemosaicThreads)->default_value(nbDemosaicThreads),
+      "Number of threads used to decode and demosaic each image (0: the available cores shared between the parallel images).");
 
   CmdLine cmdline("AliceVision convertRAW");
   cmdline.add(requiredParams);
@@ -60,7 +72,8 @@ int aliceVision_main(int argc, char** argv)
   if(!fs::is_directory(outputFolder))
     fs::create_directory(outputFolder);
 
-  int nbImages = 0;
+  // check the input and output paths before decoding anything
+  std::vector<std::string> outputPaths;
   for(const std::string& path : imagePaths)
   {
     // check input path
@@ -70,8 +83,6 @@ int aliceVision_main(int argc, char** argv)
       return EXIT_FAILURE;
     }
 
-    nbImages += 1;
-
     // genrate output filename
     std::string outputPath = (outputFolder + "/" + fs::path(path).filename().replace_extension(image::EImageFileType_enumToString(outputFileType)).string());
 
@@ -80,35 +91,59 @@ int aliceVision_main(int argc, char** argv)
       ALICEVISION_LOG_ERROR("Error: Image '" + outputPath + "' already exists.");
       return EXIT_FAILURE;
     }
+    outputPaths.push_back(outputPath);
+  }
+
+  // share the cores between the images decoded in parallel and the decoding of each image
+  const int nbImages = static_cast<int>(imagePaths.size());
+  const int maxThreads = static_cast<int>(cmdline.getHardwareContext().getMaxThreads());
+  if(nbParallelImages <= 0)
+    nbParallelImages = maxThreads;
+  nbParallelImages = std::max(1, std::min(nbParallelImages, nbImages));
+  if(nbDemosaicThreads <= 0)
+    nbDemosaicThreads = std::max(1, maxThreads / nbParallelImages);
+
+  ALICEVISION_LOG_INFO("Convert " << nbImages << " image(s), " << nbParallelImages << " in parallel with "
+                       << nbDemosaicThreads << " thread(s) per image.");
+
+  oiio::attribute("threads", nbDemosaicThreads);
+  // the demosaicing of each image may open its own parallel region
+  omp_set_nested(nbDemosaicThreads > 1);
 
-    // read input image
-    // only read the 3 first channels
-    image::Image<image::RGBColor> image;
-    oiio::ParamValueList metadata;
+  std::atomic<bool> hasError(false);
+
+  #pragma omp parallel for num_threads(nbParallelImages) schedule(dynamic)
+  for(int i = 0; i < nbImages; ++i)
+  {
+    if(hasError)
+      continue;
+
+    omp_set_num_threads(nbDemosaicThreads);
+
+    const std::string& path = imagePaths[i];
 
     try
     {
+      // read input image
+      // only read the 3 first channels
+      image::Image<image::RGBColor> image;
       ALICEVISION_LOG_INFO("Reading " << path);
       image::readImage(path, image, image::EImageColorSpace::LINEAR);
-      metadata = image::readImageMetadata(path);
-    }
-    catch(std::exception& e)
-    {
-      ALICEVISION_LOG_ERROR(std::string("Error: ") + e.what());
-      return EXIT_FAILURE;
-    }
+      const oiio::ParamValueList metadata = image::readImageMetadata(path);
 
-    // write output image
-    try
-    {
-      image::writeImage(outputPath, image, image::ImageWriteOptions(), metadata);
+      // write output image
+      image::writeImage(outputPaths[i], image, image::ImageWriteOptions(), metadata);
     }
     catch(std::exception& e)
     {
       ALICEVISION_LOG_ERROR(std::string("Error: ") + e.what());
-      return EXIT_FAILURE;
+      hasError = true;
     }
   }
+
+  if(hasError)
+    return EXIT_FAILURE;
+
   ALICEVISION_LOG_INFO("Successfull conversion of " << nbImages << " image(s).");
   return EXIT_SUCCESS;
 }
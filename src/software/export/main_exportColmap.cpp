@@ -20,7 +20,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
@@ -33,6 +33,7 @@ int aliceVision_main(int argc, char* argv[])
     std::string sfmDataFilename;
     std::string outDirectory;
     bool copyImages{false};
+    bool binary{false};
 
 
     po::options_description requiredParams("Required parameters");
@@ -43,7 +44,10 @@ int aliceVision_main(int argc, char* argv[])
              "and points3D.txt files.")
         ("copyImages", po::value<bool>(&copyImages)->default_value(copyImages),
              "Copy original images to colmap folder. This is required if your images are not all in the same "
-             "folder.");
+             "folder.")
+        ("binary", po::value<bool>(&binary)->default_value(binary),
+             "Write the cameras.bin, images.bin and points3D.bin files in the Colmap binary format, formatted in "
+             "parallel, instead of the text files.");
 
     CmdLine cmdline("Export an AV sfmdata to a Colmap scene, creating the folder structure and "
                     "the scene files that can be used for running a MVS step.\n"
@@ -67,7 +71,7 @@ int aliceVision_main(int argc, char* argv[])
         return EXIT_FAILURE;
     }
 
-    sfmDataIO::convertToColmapScene(sfmData, outDirectory, copyImages);
+    sfmDataIO::convertToColmapScene(sfmData, outDirectory, copyImages, binary);
 
     return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -20,6 +20,10 @@
 #include <iterator>
 #include <iomanip>
 #include <fstream>
+#include <algorithm>
+#include <exception>
+#include <string>
+#include <vector>
 
 // These constants define the current software version.
 // They must be updated when the command line is changed.
@@ -105,141 +109,204 @@ bool exportToMVE2Format(
     out << cameraCount << " " << featureCount << "\n";
 
     // Export (calibrated) views as undistorted images
-    auto progressDisplay = system::createConsoleProgressDisplay(sfm_data.getViews().size(), std::cout);
-    std::pair<int,int> w_h_image_size;
-    Image<RGBColor> image, image_ud, thumbnail;
-    std::string sOutViewIteratorDirectory;
-    std::size_t view_index = 0;
-    std::map<std::size_t, IndexT> viewIdToviewIndex;
-    for(Views::const_iterator iter = sfm_data.getViews().begin();
-      iter != sfm_data.getViews().end(); ++iter, ++progressDisplay)
+    // Warning: We use view_index instead of view->getViewId() because MVE use indexes instead of IDs.
+    std::vector<const View*> calibratedViews;
+    std::map<IndexT, std::size_t> viewIdToviewIndex;
+    for(const auto& viewPair : sfm_data.getViews())
     {
-      const View * view = iter->second.get();
-
+      const View * view = viewPair.second.get();
       if (!sfm_data.isPoseAndIntrinsicDefined(view))
         continue;
+      viewIdToviewIndex[view->getViewId()] = calibratedViews.size();
+      calibratedViews.push_back(view);
+    }
+
+    // the images are undistorted in parallel, the camera lines of the bundle are written in order afterwards
+    std::vector<std::string> cameraLines(calibratedViews.size());
+    auto progressDisplay = system::createConsoleProgressDisplay(calibratedViews.size(), std::cout);
 
-      viewIdToviewIndex[view->getViewId()] = view_index;
-      // Create current view subfolder 'view_xxxx.mve'
-      std::ostringstream padding;
-      // Warning: We use view_index instead of view->getViewId() because MVE use indexes instead of IDs.
-      padding << std::setw(4) << std::setfill('0') << view_index;
+    // exceptions cannot leave the OpenMP regions, the first one is rethrown after the loop
+    std::exception_ptr error;
 
-      sOutViewIteratorDirectory = (fs::path(sOutViewsDirectory) / ("view_" + padding.str() + ".mve")).string();
-      if (!fs::exists(sOutViewIteratorDirectory))
+    #pragma omp parallel for schedule(dynamic)
+    for(int view_index = 0; view_index < static_cast<int>(calibratedViews.size()); ++view_index)
+    {
+      try
       {
-        fs::create_directory(sOutViewIteratorDirectory);
-      }
+        const View * view = calibratedViews[view_index];
+        Image<RGBColor> image, image_ud, thumbnail;
 
-      // We have a valid view with a corresponding camera & pose
-      const std::string srcImage = view->getImagePath();
-      const std::string dstImage = (fs::path(sOutViewIteratorDirectory) / "undistorted.png").string();
+        // Create current view subfolder 'view_xxxx.mve'
+        std::ostringstream padding;
+        padding << std::setw(4) << std::setfill('0') << view_index;
 
-      Intrinsics::const_iterator iterIntrinsic = sfm_data.getIntrinsics().find(view->getIntrinsicId());
-      const IntrinsicBase * cam = iterIntrinsic->second.get();
-      if (cam->isValid() && cam->hasDistortion())
-      {
-        // Undistort and save the image
+        const std::string sOutViewIteratorDirectory = (fs::path(sOutViewsDirectory) / ("view_" + padding.str() + ".mve")).string();
+        if (!fs::exists(sOutViewIteratorDirectory))
+        {
+          fs::create_directory(sOutViewIteratorDirectory);
+        }
+
+        // We have a valid view with a corresponding camera & pose
+        const std::string srcImage = view->getImagePath();
+        const std::string dstImage = (fs::path(sOutViewIteratorDirectory) / "undistorted.png").string();
+
+        Intrinsics::const_iterator iterIntrinsic = sfm_data.getIntrinsics().find(view->getIntrinsicId());
+        const IntrinsicBase * cam = iterIntrinsic->second.get();
+        // the source image is always read for the thumbnail
         readImage(srcImage, image, image::EImageColorSpace::NO_CONVERSION);
-        UndistortImage(image, cam, image_ud, BLACK);
-        writeImage(dstImage, image_ud,
+        if (cam->isValid() && cam->hasDistortion())
+        {
+          // Undistort and save the image
+          UndistortImage(image, cam, image_ud, BLACK);
+          writeImage(dstImage, image_ud,
+                     image::ImageWriteOptions().toColorSpace(image::EImageColorSpace::NO_CONVERSION));
+        }
+        else // (no distortion)
+        {
+          // If extensions match, copy the PNG image
+          if (fs::extension(srcImage) == ".PNG" ||
+            fs::extension(srcImage) == ".png")
+          {
+            fs::copy_file(srcImage, dstImage, fs::copy_options::overwrite_existing);
+          }
+          else
+          {
+            writeImage(dstImage, image,
+                       image::ImageWriteOptions().toColorSpace(image::EImageColorSpace::NO_CONVERSION));
+          }
+        }
+
+        // Prepare to write an MVE 'meta.ini' file for the current view
+        const Pose3 pose = sfm_data.getPose(*view).getTransform();
+        const Pinhole * pinhole_cam = static_cast<const Pinhole *>(cam);
+
+        const Mat3& rotation = pose.rotation();
+        const Vec3& translation = pose.translation();
+        
+        // Focal length and principal point must be normalized (0..1)
+        const float flen = pinhole_cam->getFocalLengthPixX() / static_cast<double>(std::max(cam->w(), cam->h()));
+        const float pixelAspect = pinhole_cam->getFocalLengthPixX() / pinhole_cam->getFocalLengthPixY();
+        const float ppX = std::abs(pinhole_cam->getPrincipalPoint()(0)/cam->w());
+        const float ppY = std::abs(pinhole_cam->getPrincipalPoint()(1)/cam->h());
+
+        // For each camera, write to bundle:  focal length, radial distortion[0-1], rotation matrix[0-8], translation vector[0-2]
+        std::ostringstream fileOut;
+        fileOut
+          << "# MVE view meta data is stored in INI-file syntax." << fileOut.widen('\n')
+          << "# This file is generated, formatting will get lost." << fileOut.widen('\n')
+          << fileOut.widen('\n')
+          << "[camera]" << fileOut.widen('\n')
+          << "focal_length = " << flen << fileOut.widen('\n')
+          << "pixel_aspect = " << pixelAspect << fileOut.widen('\n')
+          << "principal_point = " << ppX << " " << ppY << fileOut.widen('\n')
+          << "rotation = " << rotation(0, 0) << " " << rotation(0, 1) << " " << rotation(0, 2) << " "
+          << rotation(1, 0) << " " << rotation(1, 1) << " " << rotation(1, 2) << " "
+          << rotation(2, 0) << " " << rotation(2, 1) << " " << rotation(2, 2) << fileOut.widen('\n')
+          << "translation = " << translation[0] << " " << translation[1] << " "
+          << translation[2] << " " << fileOut.widen('\n')
+          << fileOut.widen('\n')
+          << "[view]" << fileOut.widen('\n')
+          << "id = " << view_index << fileOut.widen('\n')
+          << "name = " << fs::path(srcImage).filename().string() << fileOut.widen('\n');
+
+        // To do:  trim any extra separator(s) from aliceVision name we receive, e.g.:
+        // '/home/insight/aliceVision_KevinCain/aliceVision_Build/software/SfM/ImageDataset_SceauxCastle/images//100_7100.JPG'
+        std::ofstream file((fs::path(sOutViewIteratorDirectory) / "meta.ini").string());
+        file << fileOut.str();
+        file.close();
+
+        std::ostringstream cameraOut;
+        cameraOut
+          << flen << " " << "0" << " " << "0" << "\n"  // Write '0' distortion values for pre-corrected images
+          << rotation(0, 0) << " " << rotation(0, 1) << " " << rotation(0, 2) << "\n"
+          << rotation(1, 0) << " " << rotation(1, 1) << " " << rotation(1, 2) << "\n"
+          << rotation(2, 0) << " " << rotation(2, 1) << " " << rotation(2, 2) << "\n"
+          << translation[0] << " " << translation[1] << " " << translation[2] << "\n";
+        cameraLines[view_index] = cameraOut.str();
+
+        // Save a thumbnail image "thumbnail.png", 50x50 pixels
+        thumbnail = create_thumbnail(image, 50, 50);
+        const std::string dstThumbnailImage = (fs::path(sOutViewIteratorDirectory) / "thumbnail.png").string();
+        writeImage(dstThumbnailImage, thumbnail,
                    image::ImageWriteOptions().toColorSpace(image::EImageColorSpace::NO_CONVERSION));
+
+        ++progressDisplay;
       }
-      else // (no distortion)
+      catch(const std::exception& e)
       {
-        // If extensions match, copy the PNG image
-        if (fs::extension(srcImage) == ".PNG" ||
-          fs::extension(srcImage) == ".png")
+        ALICEVISION_LOG_ERROR("Cannot export the view " << calibratedViews[view_index]->getViewId() << ": " << e.what());
+        #pragma omp critical(exportMVE2Error)
         {
-          fs::copy_file(srcImage, dstImage);
-        }
-        else
-        {
-          readImage( srcImage, image, image::EImageColorSpace::NO_CONVERSION);
-          writeImage(dstImage, image,
-                     image::ImageWriteOptions().toColorSpace(image::EImageColorSpace::NO_CONVERSION));
+          if(!error)
+            error = std::current_exception();
         }
       }
-
-      // Prepare to write an MVE 'meta.ini' file for the current view
-      const Pose3 pose = sfm_data.getPose(*view).getTransform();
-      const Pinhole * pinhole_cam = static_cast<const Pinhole *>(cam);
-
-      const Mat3& rotation = pose.rotation();
-      const Vec3& translation = pose.translation();
-      
-      // Focal length and principal point must be normalized (0..1)
-      const float flen = pinhole_cam->getFocalLengthPixX() / static_cast<double>(std::max(cam->w(), cam->h()));
-      const float pixelAspect = pinhole_cam->getFocalLengthPixX() / pinhole_cam->getFocalLengthPixY();
-      const float ppX = std::abs(pinhole_cam->getPrincipalPoint()(0)/cam->w());
-      const float ppY = std::abs(pinhole_cam->getPrincipalPoint()(1)/cam->h());
-
-      // For each camera, write to bundle:  focal length, radial distortion[0-1], rotation matrix[0-8], translation vector[0-2]
-      std::ostringstream fileOut;
-      fileOut
-        << "# MVE view meta data is stored in INI-file syntax." << fileOut.widen('\n')
-        << "# This file is generated, formatting will get lost." << fileOut.widen('\n')
-        << fileOut.widen('\n')
-        << "[camera]" << fileOut.widen('\n')
-        << "focal_length = " << flen << fileOut.widen('\n')
-        << "pixel_aspect = " << pixelAspect << fileOut.widen('\n')
-        << "principal_point = " << ppX << " " << ppY << fileOut.widen('\n')
-        << "rotation = " << rotation(0, 0) << " " << rotation(0, 1) << " " << rotation(0, 2) << " "
-        << rotation(1, 0) << " " << rotation(1, 1) << " " << rotation(1, 2) << " "
-        << rotation(2, 0) << " " << rotation(2, 1) << " " << rotation(2, 2) << fileOut.widen('\n')
-        << "translation = " << translation[0] << " " << translation[1] << " "
-        << translation[2] << " " << fileOut.widen('\n')
-        << fileOut.widen('\n')
-        << "[view]" << fileOut.widen('\n')
-        << "id = " << view_index << fileOut.widen('\n')
-        << "name = " << fs::path(srcImage).filename().string() << fileOut.widen('\n');
-
-      // To do:  trim any extra separator(s) from aliceVision name we receive, e.g.:
-      // '/home/insight/aliceVision_KevinCain/aliceVision_Build/software/SfM/ImageDataset_SceauxCastle/images//100_7100.JPG'
-      std::ofstream file((fs::path(sOutViewIteratorDirectory) / "meta.ini").string());
-      file << fileOut.str();
-      file.close();
-
-      out
-        << flen << " " << "0" << " " << "0" << "\n"  // Write '0' distortion values for pre-corrected images
-        << rotation(0, 0) << " " << rotation(0, 1) << " " << rotation(0, 2) << "\n"
-        << rotation(1, 0) << " " << rotation(1, 1) << " " << rotation(1, 2) << "\n"
-        << rotation(2, 0) << " " << rotation(2, 1) << " " << rotation(2, 2) << "\n"
-        << translation[0] << " " << translation[1] << " " << translation[2] << "\n";
-
-      // Save a thumbnail image "thumbnail.png", 50x50 pixels
-      thumbnail = create_thumbnail(image, 50, 50);
-      const std::string dstThumbnailImage = (fs::path(sOutViewIteratorDirectory) / "thumbnail.png").string();
-      writeImage(dstThumbnailImage, thumbnail,
-                 image::ImageWriteOptions().toColorSpace(image::EImageColorSpace::NO_CONVERSION));
-      
-      ++view_index;
     }
 
+    if(error)
+      std::rethrow_exception(error);
+
+    for(const std::string& cameraLine : cameraLines)
+      out << cameraLine;
+
     // For each feature, write to bundle:  position XYZ[0-3], color RGB[0-2], all ref.view_id & ref.feature_id
     // The following method is adapted from Simon Fuhrmann's MVE project:
     // https://github.com/simonfuhrmann/mve/blob/e3db7bc60ce93fe51702ba77ef480e151f927c23/libs/mve/bundle_io.cc
 
+    // the landmarks are formatted in parallel by chunks
+    std::vector<Landmarks::const_iterator> landmarkIts;
+    landmarkIts.reserve(landmarks.size());
     for (Landmarks::const_iterator iterLandmarks = landmarks.begin(); iterLandmarks != landmarks.end(); ++iterLandmarks)
-    {
-      const Vec3 exportPoint = iterLandmarks->second.X;
-      out << exportPoint.x() << " " << exportPoint.y() << " " << exportPoint.z() << "\n";
-      out << 250 << " " << 100 << " " << 150 << "\n";  // Write arbitrary RGB color, see above note
+      landmarkIts.push_back(iterLandmarks);
 
-      // Tally set of feature observations
-      const Observations & observations = iterLandmarks->second.observations;
-      const size_t featureCount = std::distance(observations.begin(), observations.end());
-      out << featureCount;
+    const int chunkSize = 4096;
+    const int nbChunks = (static_cast<int>(landmarkIts.size()) + chunkSize - 1) / chunkSize;
+    std::vector<std::string> landmarkChunks(nbChunks);
 
-      for (Observations::const_iterator itObs = observations.begin(); itObs != observations.end(); ++itObs)
+    #pragma omp parallel for schedule(dynamic)
+    for (int c = 0; c < nbChunks; ++c)
+    {
+      try
       {
-          const IndexT viewId = itObs->first;
-          const IndexT viewIndex = viewIdToviewIndex[viewId];
-          const IndexT featId = itObs->second.id_feat;
-          out << " " << viewIndex << " " << featId << " 0";
+        std::ostringstream chunkOut;
+        const std::size_t chunkEnd = std::min(landmarkIts.size(), static_cast<std::size_t>(c + 1) * chunkSize);
+        for (std::size_t i = static_cast<std::size_t>(c) * chunkSize; i < chunkEnd; ++i)
+        {
+          const Vec3 exportPoint = landmarkIts[i]->second.X;
+          chunkOut << exportPoint.x() << " " << exportPoint.y() << " " << exportPoint.z() << "\n";
+          chunkOut << 250 << " " << 100 << " " << 150 << "\n";  // Write arbitrary RGB color, see above note
+
+          // Tally set of feature observations
+          const Observations & observations = landmarkIts[i]->second.observations;
+          chunkOut << observations.size();
+
+          for (Observations::const_iterator itObs = observations.begin(); itObs != observations.end(); ++itObs)
+          {
+              const IndexT viewId = itObs->first;
+              const std::size_t viewIndex = viewIdToviewIndex.at(viewId);
+              const IndexT featId = itObs->second.id_feat;
+              chunkOut << " " << viewIndex << " " << featId << " 0";
+          }
+          chunkOut << "\n";
+        }
+        landmarkChunks[c] = chunkOut.str();
+      }
+      catch(const std::exception& e)
+      {
+        ALICEVISION_LOG_ERROR("Cannot export the landmarks chunk " << c << ": " << e.what());
+        #pragma omp critical(exportMVE2Error)
+        {
+          if(!error)
+            error = std::current_exception();
+        }
       }
-      out << "\n";
     }
+
+    if(error)
+      std::rethrow_exception(error);
+
+    for (const std::string& landmarkChunk : landmarkChunks)
+      out << landmarkChunk;
     out.close();
   }
   return bOk;
@@ -194,7 +194,7 @@ int aliceVision_main(int argc, char** argv)
 
     // set maxThreads
     HardwareContext hwc = cmdline.getHardwareContext();
-    omp_set_num_threads(hwc.getMaxThreads());
+    hwc.setupThreads();
 
     // Read sfm data
     sfmData::SfMData sfmData;
@@ -288,22 +288,13 @@ int aliceVision_main(int argc, char** argv)
         {
             // Read from file
             const std::string samplesFilepath = (fs::path(samplesFolder) / (std::to_string(group_pos) + "_samples.dat")).string();
-            std::ifstream fileSamples(samplesFilepath, std::ios::binary);
-            if (!fileSamples.is_open())
+            std::vector<hdr::ImageSample> samples;
+            if (!hdr::readSamples(samplesFilepath, samples))
             {
                 ALICEVISION_LOG_ERROR("Impossible to read samples from file " << samplesFilepath);
                 return EXIT_FAILURE;
             }
 
-            std::size_t size;
-            fileSamples.read((char*)&size, sizeof(size));
-
-            std::vector<hdr::ImageSample> samples(size);
-            for (std::size_t i = 0; i < size; ++i)
-            {
-                fileSamples >> samples[i];
-            }
-
             sampling.analyzeSource(samples, channelQuantization, group_pos);
 
             std::map<int, luminanceInfo> luminanceInfos;
@@ -338,22 +329,13 @@ int aliceVision_main(int argc, char** argv)
             {
                 // Read from file
                 const std::string samplesFilepath = (fs::path(samplesFolder) / (std::to_string(group_pos) + "_samples.dat")).string();
-                std::ifstream fileSamples(samplesFilepath, std::ios::binary);
-                if (!fileSamples.is_open())
+                std::vector<hdr::ImageSample> samples;
+                if (!hdr::readSamples(samplesFilepath, samples))
                 {
                     ALICEVISION_LOG_ERROR("Impossible to read samples from file " << samplesFilepath);
                     return EXIT_FAILURE;
                 }
 
-                std::size_t size = 0;
-                fileSamples.read((char*)&size, sizeof(size));
-
-                std::vector<hdr::ImageSample> samples(size);
-                for (int i = 0; i < size; ++i)
-                {
-                    fileSamples >> samples[i];
-                }
-
                 std::vector<hdr::ImageSample> out_samples;
                 sampling.extractUsefulSamples(out_samples, samples, group_pos);
 
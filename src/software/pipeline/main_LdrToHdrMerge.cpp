@@ -117,7 +117,7 @@ int aliceVision_main(int argc, char** argv)
 
     // set maxThreads
     HardwareContext hwc = cmdline.getHardwareContext();
-    omp_set_num_threads(hwc.getMaxThreads());
+    hwc.setupThreads();
 
     // Analyze path
     boost::filesystem::path path(sfmOutputDataFilepath);
@@ -288,11 +288,29 @@ int aliceVision_main(int argc, char** argv)
     {
         const std::vector<std::shared_ptr<sfmData::View>>& group = groupedViews[g];
 
-        std::vector<image::Image<image::RGBfColor>> images(group.size());
         std::shared_ptr<sfmData::View> targetView = targetViews[g];
         std::vector<sfmData::ExposureSetting> exposuresSetting(group.size());
+        for(std::size_t i = 0; i < group.size(); ++i)
+        {
+            exposuresSetting[i] = group[i]->getCameraExposureSetting(/*targetView->getMetadataISO(), targetView->getMetadataFNumber()*/);
+        }
+        if(!sfmData::hasComparableExposures(exposuresSetting))
+        {
+            ALICEVISION_THROW_ERROR("Camera exposure settings are inconsistent.");
+        }
+        std::vector<double> exposures = getExposures(exposuresSetting);
+
+        const sfmData::ExposureSetting targetCameraSetting = targetView->getCameraExposureSetting();
+        if(group.size() > 1)
+        {
+            ALICEVISION_LOG_INFO("[" << g - rangeStart << "/" << rangeSize << "] Merge " << group.size() << " LDR images " << g << "/" << groupedViews.size());
+        }
 
-        // Load all images of the group
+        // Load and merge the images of the group one at a time,
+        // only the shortest exposure is kept for the highlights correction
+        hdr::hdrIncrementalMerge merge(fusionWeight, response, group.size());
+        image::Image<image::RGBfColor> shortestExposure;
+        image::Image<image::RGBfColor> HDRimage;
         for(std::size_t i = 0; i < group.size(); ++i)
         {
             const std::string filepath = group[i]->getImagePath();
@@ -302,34 +320,33 @@ int aliceVision_main(int argc, char** argv)
             options.workingColorSpace = workingColorSpace;
             options.rawColorInterpretation = image::ERawColorInterpretation_stringToEnum(group[i]->getRawColorInterpretation());
             options.colorProfileFileName = group[i]->getColorProfileFileName();
-            image::readImage(filepath, images[i], options);
 
-            exposuresSetting[i] = group[i]->getCameraExposureSetting(/*targetView->getMetadataISO(), targetView->getMetadataFNumber()*/);
-        }
-        if(!sfmData::hasComparableExposures(exposuresSetting))
-        {
-            ALICEVISION_THROW_ERROR("Camera exposure settings are inconsistent.");
+            image::Image<image::RGBfColor> image;
+            image::readImage(filepath, image, options);
+
+            if(group.size() == 1)
+            {
+                // Nothing to do
+                HDRimage.swap(image);
+                break;
+            }
+
+            merge.add(image, i, exposures[i]);
+
+            if(i == 0 && highlightCorrectionFactor > 0.0f)
+            {
+                shortestExposure.swap(image);
+            }
         }
-        std::vector<double> exposures = getExposures(exposuresSetting);
 
-        // Merge HDR images
-        image::Image<image::RGBfColor> HDRimage;
-        if(images.size() > 1)
+        if(group.size() > 1)
         {
-            hdr::hdrMerge merge;
-            sfmData::ExposureSetting targetCameraSetting = targetView->getCameraExposureSetting();
-            ALICEVISION_LOG_INFO("[" << g - rangeStart << "/" << rangeSize << "] Merge " << group.size() << " LDR images " << g << "/" << groupedViews.size());
-            merge.process(images, exposures, fusionWeight, response, HDRimage, targetCameraSetting.getExposure());
+            merge.finalize(HDRimage, targetCameraSetting.getExposure());
             if(highlightCorrectionFactor > 0.0f)
             {
-                merge.postProcessHighlight(images, exposures, fusionWeight, response, HDRimage, targetCameraSetting.getExposure(), highlightCorrectionFactor, highlightTargetLux);
+                hdr::hdrMerge().postProcessHighlight(shortestExposure, HDRimage, targetCameraSetting.getExposure(), highlightCorrectionFactor, highlightTargetLux);
             }
         }
-        else if(images.size() == 1)
-        {
-            // Nothing to do
-            HDRimage = images[0];
-        }
 
         const std::string hdrImagePath = getHdrImagePath(outputPath, g);
 
@@ -9,6 +9,8 @@
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/cmdline.hpp>
 #include <aliceVision/system/main.hpp>
+#include <aliceVision/system/MemoryInfo.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 // SFMData
 #include <aliceVision/sfmData/SfMData.hpp>
@@ -33,10 +35,10 @@
 #include <boost/accumulators/accumulators.hpp>
 #include <boost/accumulators/statistics.hpp>
 
+#include <algorithm>
+#include <exception>
 #include <sstream>
 
-#include <fstream>
-
 
 // These constants define the current software version.
 // They must be updated when the command line is changed.
@@ -110,7 +112,7 @@ int aliceVision_main(int argc, char** argv)
 
     // set maxThreads
     HardwareContext hwc = cmdline.getHardwareContext();
-    omp_set_num_threads(hwc.getMaxThreads());
+    hwc.setupThreads();
 
     const std::size_t channelQuantization = std::pow(2, channelQuantizationPower);
 
@@ -189,106 +191,123 @@ int aliceVision_main(int argc, char** argv)
     }
     ALICEVISION_LOG_DEBUG("Range to compute: rangeStart=" << rangeStart << ", rangeSize=" << rangeSize);
 
-    for(std::size_t groupIdx = rangeStart; groupIdx < rangeStart + rangeSize; ++groupIdx)
-    {
-        auto & group = groupedViews[groupIdx];
-        ALICEVISION_LOG_INFO("Extracting samples from group " << groupIdx);
-
-        std::vector<std::string> paths;
-        std::vector<sfmData::ExposureSetting> exposuresSetting;
-        std::vector<IndexT> viewIds;
+    // Each group loads all its brackets, the number of groups processed concurrently is bounded by the available memory
+    const system::MemoryInfo memInfo = system::getMemoryInfo();
+    const double maxMemory = 0.9 * double(std::min(memInfo.availableRam, hwc.getUserMaxMemoryAvailable()));
+    const std::size_t groupMemory = hdr::Sampling::getMemoryConsumption(width, height, usedNbBrackets, channelQuantization, params);
+    const int maxThreads = std::min(int(hwc.getMaxThreads()), omp_get_max_threads());
+    const int nbConcurrentGroups = std::max(1, int(std::min(double(maxThreads), maxMemory / double(std::max(groupMemory, std::size_t(1))))));
+    ALICEVISION_LOG_INFO("Number of groups processed concurrently: " << nbConcurrentGroups << " (" << groupMemory / (1024 * 1024) << " MB per group)");
 
-        image::ERawColorInterpretation rawColorInterpretation = image::ERawColorInterpretation::LibRawWhiteBalancing;
-        std::string colorProfileFileName = "";
+    std::exception_ptr groupError;
 
-        for (auto & v : group)
+    #pragma omp parallel for num_threads(nbConcurrentGroups) schedule(dynamic)
+    for(int groupIdx = rangeStart; groupIdx < rangeStart + rangeSize; ++groupIdx)
+    {
+        try
         {
-            paths.push_back(v->getImagePath());
-            exposuresSetting.push_back(v->getCameraExposureSetting());
-            viewIds.push_back(v->getViewId());
+            auto & group = groupedViews[groupIdx];
+            ALICEVISION_LOG_INFO("Extracting samples from group " << groupIdx);
 
-            const std::string rawColorInterpretation_str = v->getRawColorInterpretation();
-            rawColorInterpretation = image::ERawColorInterpretation_stringToEnum(rawColorInterpretation_str);
-            colorProfileFileName = v->getColorProfileFileName();
-
-            ALICEVISION_LOG_INFO("Image: " << paths.back() << ", exposure: " << exposuresSetting.back() << ", raw color interpretation: " << rawColorInterpretation_str);
-        }
-        if(!sfmData::hasComparableExposures(exposuresSetting))
-        {
-            ALICEVISION_THROW_ERROR("Camera exposure settings are inconsistent.");
-        }
-        std::vector<double> exposures = getExposures(exposuresSetting);
+            std::vector<std::string> paths;
+            std::vector<sfmData::ExposureSetting> exposuresSetting;
+            std::vector<IndexT> viewIds;
 
-        image::ImageReadOptions imgReadOptions;
-        imgReadOptions.workingColorSpace = workingColorSpace;
-        imgReadOptions.rawColorInterpretation = rawColorInterpretation;
-        imgReadOptions.colorProfileFileName = colorProfileFileName;
+            image::ERawColorInterpretation rawColorInterpretation = image::ERawColorInterpretation::LibRawWhiteBalancing;
+            std::string colorProfileFileName = "";
 
-        const bool simplifiedSampling = byPass || (calibrationMethod == ECalibrationMethod::LINEAR);
+            for (auto & v : group)
+            {
+                paths.push_back(v->getImagePath());
+                exposuresSetting.push_back(v->getCameraExposureSetting());
+                viewIds.push_back(v->getViewId());
 
-        std::vector<hdr::ImageSample> out_samples;
-        const bool res = hdr::Sampling::extractSamplesFromImages(out_samples, paths, viewIds, exposures, width, height, channelQuantization, imgReadOptions, params, simplifiedSampling);
-        if (!res)
-        {
-            ALICEVISION_LOG_ERROR("Error while extracting samples from group " << groupIdx);
-        }
+                const std::string rawColorInterpretation_str = v->getRawColorInterpretation();
+                rawColorInterpretation = image::ERawColorInterpretation_stringToEnum(rawColorInterpretation_str);
+                colorProfileFileName = v->getColorProfileFileName();
 
-        using namespace boost::accumulators;
-        using Accumulator = accumulator_set<float, stats<tag::min, tag::max, tag::median, tag::mean>>;
-        Accumulator acc_nbUsedBrackets;
-        {
-            utils::Histogram<int> histogram(1, usedNbBrackets, usedNbBrackets-1);
-            for(const hdr::ImageSample& sample : out_samples)
+                ALICEVISION_LOG_INFO("Image: " << paths.back() << ", exposure: " << exposuresSetting.back() << ", raw color interpretation: " << rawColorInterpretation_str);
+            }
+            if(!sfmData::hasComparableExposures(exposuresSetting))
             {
-                acc_nbUsedBrackets(sample.descriptions.size());
-                histogram.Add(sample.descriptions.size());
+                ALICEVISION_THROW_ERROR("Camera exposure settings are inconsistent.");
             }
-            ALICEVISION_LOG_INFO("Number of used brackets in selected samples: "
-                                 << " min: " << extract::min(acc_nbUsedBrackets) << " max: "
-                                 << extract::max(acc_nbUsedBrackets) << " mean: " << extract::mean(acc_nbUsedBrackets)
-                                 << " median: " << extract::median(acc_nbUsedBrackets));
+            std::vector<double> exposures = getExposures(exposuresSetting);
 
-            ALICEVISION_LOG_INFO("Histogram of the number of brackets per sample: " << histogram.ToString("", 2));
-        }
-        if(debug)
-        {
-            image::Image<image::RGBfColor> selectedPixels(width, height, true);
+            image::ImageReadOptions imgReadOptions;
+            imgReadOptions.workingColorSpace = workingColorSpace;
+            imgReadOptions.rawColorInterpretation = rawColorInterpretation;
+            imgReadOptions.colorProfileFileName = colorProfileFileName;
+
+            const bool simplifiedSampling = byPass || (calibrationMethod == ECalibrationMethod::LINEAR);
 
-            for(const hdr::ImageSample& sample: out_samples)
+            std::vector<hdr::ImageSample> out_samples;
+            const bool res = hdr::Sampling::extractSamplesFromImages(out_samples, paths, viewIds, exposures, width, height, channelQuantization, imgReadOptions, params, simplifiedSampling);
+            if (!res)
             {
-                const float score = float(sample.descriptions.size()) / float(usedNbBrackets);
-                const image::RGBfColor color = getColorFromJetColorMap(score);
-                selectedPixels(sample.y, sample.x) = image::RGBfColor(color.r(), color.g(), color.b());
+                ALICEVISION_LOG_ERROR("Error while extracting samples from group " << groupIdx);
             }
-            oiio::ParamValueList metadata;
-            metadata.push_back(oiio::ParamValue("AliceVision:nbSelectedPixels", int(selectedPixels.size())));
-            metadata.push_back(oiio::ParamValue("AliceVision:minNbUsedBrackets", extract::min(acc_nbUsedBrackets)));
-            metadata.push_back(oiio::ParamValue("AliceVision:maxNbUsedBrackets", extract::max(acc_nbUsedBrackets)));
-            metadata.push_back(oiio::ParamValue("AliceVision:meanNbUsedBrackets", extract::mean(acc_nbUsedBrackets)));
-            metadata.push_back(oiio::ParamValue("AliceVision:medianNbUsedBrackets", extract::median(acc_nbUsedBrackets)));
 
-            image::writeImage((fs::path(outputFolder) / (std::to_string(groupIdx) + "_selectedPixels.png")).string(),
-                              selectedPixels, image::ImageWriteOptions(), metadata);
+            using namespace boost::accumulators;
+            using Accumulator = accumulator_set<float, stats<tag::min, tag::max, tag::median, tag::mean>>;
+            Accumulator acc_nbUsedBrackets;
+            {
+                utils::Histogram<int> histogram(1, usedNbBrackets, usedNbBrackets-1);
+                for(const hdr::ImageSample& sample : out_samples)
+                {
+                    acc_nbUsedBrackets(sample.descriptions.size());
+                    histogram.Add(sample.descriptions.size());
+                }
+                ALICEVISION_LOG_INFO("Number of used brackets in selected samples: "
+                                     << " min: " << extract::min(acc_nbUsedBrackets) << " max: "
+                                     << extract::max(acc_nbUsedBrackets) << " mean: " << extract::mean(acc_nbUsedBrackets)
+                                     << " median: " << extract::median(acc_nbUsedBrackets));
+
+                ALICEVISION_LOG_INFO("Histogram of the number of brackets per sample: " << histogram.ToString("", 2));
+            }
+            if(debug)
+            {
+                image::Image<image::RGBfColor> selectedPixels(width, height, true);
+
+                for(const hdr::ImageSample& sample: out_samples)
+                {
+                    const float score = float(sample.descriptions.size()) / float(usedNbBrackets);
+                    const image::RGBfColor color = getColorFromJetColorMap(score);
+                    selectedPixels(sample.y, sample.x) = image::RGBfColor(color.r(), color.g(), color.b());
+                }
+                oiio::ParamValueList metadata;
+                metadata.push_back(oiio::ParamValue("AliceVision:nbSelectedPixels", int(selectedPixels.size())));
+                metadata.push_back(oiio::ParamValue("AliceVision:minNbUsedBrackets", extract::min(acc_nbUsedBrackets)));
+                metadata.push_back(oiio::ParamValue("AliceVision:maxNbUsedBrackets", extract::max(acc_nbUsedBrackets)));
+                metadata.push_back(oiio::ParamValue("AliceVision:meanNbUsedBrackets", extract::mean(acc_nbUsedBrackets)));
+                metadata.push_back(oiio::ParamValue("AliceVision:medianNbUsedBrackets", extract::median(acc_nbUsedBrackets)));
+
+                image::writeImage((fs::path(outputFolder) / (std::to_string(groupIdx) + "_selectedPixels.png")).string(),
+                                  selectedPixels, image::ImageWriteOptions(), metadata);
 
-        }
+            }
 
-        // Store to file
-        const std::string samplesFilepath = (fs::path(outputFolder) / (std::to_string(groupIdx) + "_samples.dat")).string();
-        std::ofstream fileSamples(samplesFilepath, std::ios::binary);
-        if (!fileSamples.is_open())
-        {
-            ALICEVISION_LOG_ERROR("Impossible to write samples");
-            return EXIT_FAILURE;
+            // Store to file
+            const std::string samplesFilepath = (fs::path(outputFolder) / (std::to_string(groupIdx) + "_samples.dat")).string();
+            if(!hdr::writeSamples(samplesFilepath, out_samples))
+            {
+                ALICEVISION_THROW_ERROR("Impossible to write samples: " << samplesFilepath);
+            }
         }
-
-        const std::size_t size = out_samples.size();
-        fileSamples.write((const char *)&size, sizeof(size));
-
-        for(std::size_t i = 0; i < out_samples.size(); ++i)
+        catch(...)
         {
-            fileSamples << out_samples[i];
+            #pragma omp critical(LdrToHdrSampling_groupError)
+            {
+                if(!groupError)
+                    groupError = std::current_exception();
+            }
         }
     }
 
+    if(groupError)
+    {
+        std::rethrow_exception(groupError);
+    }
+
     return EXIT_SUCCESS;
 }
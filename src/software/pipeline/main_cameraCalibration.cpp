@@ -17,6 +17,7 @@
 #include <aliceVision/system/main.hpp>
 #include <aliceVision/system/cmdline.hpp>
 #include <aliceVision/config.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
@@ -193,49 +194,84 @@ int aliceVision_main(int argc, char** argv)
   aliceVision::system::Timer durationAlgo;
   aliceVision::system::Timer duration;
   
-  std::size_t currentFrame = 0;
-  while (feed.readImage(imageGrey, queryIntrinsics, currentImgName, hasIntrinsics))
+  // the frames are read sequentially and the patterns are detected by batches of frames in parallel
+  struct Frame
   {
+    std::size_t frameId = 0;
+    std::size_t inputFrameId = 0;
     cv::Mat viewGray;
-    cv::eigen2cv(imageGrey.GetMat(), viewGray);
+    bool found = false;
+    std::vector<int> detectedId;
+    std::vector<cv::Point2f> pointbuf;
+  };
+  const std::size_t batchSize = 4 * omp_get_max_threads();
+  std::vector<Frame> frames(batchSize);
 
-    // Check image is correctly loaded
-    if (viewGray.size() == cv::Size(0, 0))
-    {
-      throw std::runtime_error(std::string("Invalid image: ") + currentImgName);
-    }
-    // Check image size is always the same
-    if (imageSize == cv::Size(0, 0))
+  std::size_t currentFrame = 0;
+  bool hasFrames = true;
+  while (hasFrames)
+  {
+    std::size_t nbFramesInBatch = 0;
+    while (nbFramesInBatch < batchSize)
     {
-      // First image: initialize the image size.
-      imageSize = viewGray.size();
+      if (!feed.readImage(imageGrey, queryIntrinsics, currentImgName, hasIntrinsics))
+      {
+        hasFrames = false;
+        break;
+      }
+
+      Frame& frame = frames[nbFramesInBatch];
+      frame.frameId = currentFrame;
+      frame.inputFrameId = iInputFrame;
+      cv::eigen2cv(imageGrey.GetMat(), frame.viewGray);
+
+      // Check image is correctly loaded
+      if (frame.viewGray.size() == cv::Size(0, 0))
+      {
+        throw std::runtime_error(std::string("Invalid image: ") + currentImgName);
+      }
+      // Check image size is always the same
+      if (imageSize == cv::Size(0, 0))
+      {
+        // First image: initialize the image size.
+        imageSize = frame.viewGray.size();
+      }
+      // Check image resolutions are always the same
+      else if (imageSize != frame.viewGray.size())
+      {
+        throw std::runtime_error(std::string("You cannot mix multiple image resolutions during the camera calibration. See image file: ") + currentImgName);
+      }
+      ++nbFramesInBatch;
+
+      ++iInputFrame;
+      currentFrame = std::floor(iInputFrame * step);
+      feed.goToFrame(currentFrame);
     }
-    // Check image resolutions are always the same
-    else if (imageSize != viewGray.size())
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < static_cast<int>(nbFramesInBatch); ++i)
     {
-      throw std::runtime_error(std::string("You cannot mix multiple image resolutions during the camera calibration. See image file: ") + currentImgName);
-    }
+      Frame& frame = frames[i];
+      frame.detectedId.clear();
+      frame.pointbuf.clear();
+      ALICEVISION_CERR("[" << frame.frameId << "/" << nbFrames << "] (" << frame.inputFrameId << "/" << nbFramesToProcess << ")");
 
-    std::vector<cv::Point2f> pointbuf;
-    std::vector<int> detectedId;
-    ALICEVISION_CERR("[" << currentFrame << "/" << nbFrames << "] (" << iInputFrame << "/" << nbFramesToProcess << ")");
+      // Find the chosen pattern in images
+      frame.found = aliceVision::calibration::findPattern(patternType, frame.viewGray, boardSize, frame.detectedId, frame.pointbuf);
+    }
 
-    // Find the chosen pattern in images
-    const bool found = aliceVision::calibration::findPattern(patternType, viewGray, boardSize, detectedId, pointbuf);
-    
-    if (found)
+    for (std::size_t i = 0; i < nbFramesInBatch; ++i)
     {
-      validFrames.push_back(currentFrame);
-      detectedIdPerFrame.push_back(detectedId);
-      imagePoints.push_back(pointbuf);
+      Frame& frame = frames[i];
+      if (frame.found)
+      {
+        validFrames.push_back(frame.frameId);
+        detectedIdPerFrame.push_back(std::move(frame.detectedId));
+        imagePoints.push_back(std::move(frame.pointbuf));
+      }
     }
-
-    ++iInputFrame;
-    currentFrame = std::floor(iInputFrame * step);
-    feed.goToFrame(currentFrame);
   }
 
-  
   ALICEVISION_CERR("find points duration: " << aliceVision::system::prettyTime(duration.elapsedMs()));
   ALICEVISION_CERR("Grid detected in " << imagePoints.size() << " images on " << iInputFrame << " input images.");
 
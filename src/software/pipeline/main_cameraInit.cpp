@@ -15,6 +15,7 @@
 #include <aliceVision/system/cmdline.hpp>
 #include <aliceVision/image/io.cpp>
 #include <aliceVision/image/dcp.hpp>
+#include <aliceVision/image/metadataCache.hpp>
 
 #include <boost/atomic/atomic_ref.hpp>
 #include <boost/program_options.hpp>
@@ -28,6 +29,7 @@
 #include <sstream>
 #include <memory>
 #include <string>
+#include <set>
 #include <vector>
 #include <cstdlib>
 #include <stdexcept>
@@ -38,7 +40,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 using namespace aliceVision::sfmDataIO;
@@ -146,6 +148,7 @@ int aliceVision_main(int argc, char **argv)
   std::string sfmFilePath;
   std::string imageFolder;
   std::string sensorDatabasePath;
+  std::string metadataCacheFolder;
   std::string lensCorrectionProfileInfo;
   std::string outputFilePath;
 
@@ -183,6 +186,9 @@ int aliceVision_main(int argc, char **argv)
   optionalParams.add_options()
     ("sensorDatabase,s", po::value<std::string>(&sensorDatabasePath)->default_value(""),
       "Camera sensor width database path.")
+    ("metadataCacheFolder", po::value<std::string>(&metadataCacheFolder)->default_value(metadataCacheFolder),
+      "Folder of a persistent cache of the images metadata, so the unchanged images are not read again "
+      "when the same images are initialized again (no cache if empty). It also stores the index of the LCP database.")
     ("colorProfileDatabase,c", po::value<std::string>(&colorProfileDatabaseDirPath)->default_value(""),
       "DNG Color Profiles (DCP) database path.")
     ("lensCorrectionProfileInfo", po::value<std::string>(&lensCorrectionProfileInfo)->default_value(""),
@@ -339,11 +345,16 @@ int aliceVision_main(int argc, char **argv)
   // number of views with LCP data used to add vignetting params in metadata
   std::size_t lcpVignettingViewCount = 0;
 
+  // persistent cache of the images metadata
+  std::unique_ptr<image::ImageMetadataCache> metadataCache;
+  if(!metadataCacheFolder.empty())
+    metadataCache.reset(new image::ImageMetadataCache(metadataCacheFolder));
+
   // load known informations
   if(imageFolder.empty())
   {
     // fill SfMData from the JSON file
-    loadJSON(sfmData, sfmFilePath, ESfMData(VIEWS|INTRINSICS|EXTRINSICS), true, viewIdMethod, viewIdRegex);
+    loadJSON(sfmData, sfmFilePath, ESfMData(VIEWS|INTRINSICS|EXTRINSICS), true, viewIdMethod, viewIdRegex, metadataCache.get());
   }
   else
   {
@@ -360,7 +371,7 @@ int aliceVision_main(int argc, char **argv)
       {
         sfmData::View& view = incompleteViews.at(i);
         view.setImagePath(imagePaths.at(i).string());
-        updateIncompleteView(view, viewIdMethod, viewIdRegex);
+        updateIncompleteView(view, viewIdMethod, viewIdRegex, metadataCache.get());
       }
 
       for(const auto& view : incompleteViews)
@@ -371,6 +382,13 @@ int aliceVision_main(int argc, char **argv)
     }
   }
 
+  if(metadataCache)
+  {
+    ALICEVISION_LOG_INFO("Images metadata: " << metadataCache->getNbHits() << " from the cache, "
+                         << metadataCache->getNbMisses() << " read from the files.");
+    metadataCache->save();
+  }
+
   if(sfmData.getViews().empty())
   {
     ALICEVISION_LOG_ERROR("Can't find views in input.");
@@ -385,6 +403,20 @@ int aliceVision_main(int argc, char **argv)
 
   std::map<IndexT, std::vector<IndexT>> poseGroups;
 
+  // look up the sensors of all the cameras at once, in the indexed database
+  std::map<std::pair<std::string, std::string>, sensorDB::Datasheet> sensorDatasheets;
+  {
+    std::set<std::pair<std::string, std::string>> cameras;
+    for(const auto& viewPair : sfmData.getViews())
+    {
+      const std::string& make = viewPair.second->getMetadataMake();
+      const std::string& model = viewPair.second->getMetadataModel();
+      if(!make.empty() || !model.empty())
+        cameras.emplace(make, model);
+    }
+    sensorDatasheets = sensorDB::getInfos(cameras, sensorDB::DatasheetIndex(sensorDatabase));
+  }
+
   ALICEVISION_LOG_DEBUG("List files in the DCP database: " << colorProfileDatabaseDirPath);
   char allColorProfilesFound = 1; // char type instead of bool to support usage of atomic
   image::DCPDatabase dcpDatabase(colorProfileDatabaseDirPath);
@@ -401,6 +433,21 @@ int aliceVision_main(int argc, char **argv)
     ALICEVISION_LOG_INFO(lcpStore.size() << " profile(s) stored in the LCP database.");
   }
 
+  // Index the LCP headers once before the views are processed, from the previous index if any
+  if(lcpStore.size() > 1)
+  {
+    const std::string lcpIndexPath = metadataCacheFolder.empty() ? "" : (fs::path(metadataCacheFolder) / "lcpIndex.bin").string();
+    if(!lcpIndexPath.empty() && fs::exists(lcpIndexPath))
+      lcpStore.loadIndex(lcpIndexPath);
+
+    if(lcpStore.buildIndex() > 0 && !lcpIndexPath.empty())
+    {
+      fs::create_directories(metadataCacheFolder);
+      if(!lcpStore.saveIndex(lcpIndexPath))
+        ALICEVISION_LOG_WARNING("Cannot write the LCP index file: " << lcpIndexPath);
+    }
+  }
+
   #pragma omp parallel for
   for (int i = 0; i < sfmData.getViews().size(); ++i)
   {
@@ -547,7 +594,6 @@ int aliceVision_main(int argc, char **argv)
 
         if (!make.empty() && !lensModel.empty())
         {
-            #pragma omp critical (lcp)
             lcpData = lcpStore.findLCP(make, model, lensModel, lensID, 1);
         }
     }
@@ -573,9 +619,11 @@ int aliceVision_main(int argc, char **argv)
     // try to find in the sensor width in the database
     if(hasCameraMetadata)
     {
-      sensorDB::Datasheet datasheet;
-      if(sensorDB::getInfo(make, model, sensorDatabase, datasheet))
+      const auto datasheetIt = sensorDatasheets.find(std::make_pair(make, model));
+      if(datasheetIt != sensorDatasheets.end())
       {
+        const sensorDB::Datasheet& datasheet = datasheetIt->second;
+
         // sensor is in the database
         ALICEVISION_LOG_TRACE("Sensor width found in sensor database: " << std::endl
                               << "\t- brand: " << make << std::endl
@@ -5,17 +5,20 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include <aliceVision/config.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 #include <aliceVision/localization/ILocalizer.hpp>
 #include <aliceVision/localization/VoctreeLocalizer.hpp>
+#include <aliceVision/localization/PrioritizedSearchLocalizer.hpp>
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CCTAG)
 #include <aliceVision/localization/CCTagLocalizer.hpp>
 #endif
 #include <aliceVision/localization/LocalizationResult.hpp>
 #include <aliceVision/localization/optimization.hpp>
 #include <aliceVision/image/io.hpp>
-#include <aliceVision/dataio/FeedProvider.hpp>
+#include <aliceVision/dataio/AsyncFeedProvider.hpp>
 #include <aliceVision/feature/ImageDescriber.hpp>
 #include <aliceVision/feature/imageDescriberCommon.hpp>
+#include <aliceVision/matching/matcherType.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
 #include <aliceVision/robustEstimation/estimators.hpp>
@@ -33,6 +36,8 @@
 #include <boost/accumulators/statistics/max.hpp>
 #include <boost/accumulators/statistics/sum.hpp>
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -46,7 +51,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 8
 
 using namespace aliceVision;
 
@@ -54,6 +59,18 @@ namespace bfs = boost::filesystem;
 namespace bacc = boost::accumulators;
 namespace po = boost::program_options;
 
+/**
+ * @brief Get a percentile of the localization times
+ * @param[in] sortedTimes the times sorted in increasing order, not empty
+ * @param[in] percentile the percentile in [0, 100]
+ * @return the time below which the given percentage of the localizations took
+ */
+double getPercentile(const std::vector<double>& sortedTimes, double percentile)
+{
+  const std::size_t rank = static_cast<std::size_t>(std::ceil(percentile / 100.0 * sortedTimes.size()));
+  return sortedTimes[std::min(std::max(rank, std::size_t(1)), sortedTimes.size()) - 1];
+}
+
 int aliceVision_main(int argc, char** argv)
 {
   /// the calibration file
@@ -88,6 +105,10 @@ int aliceVision_main(int argc, char** argv)
   
   // voctree parameters
   std::string algostring = "AllResults";
+  /// number of 2D-3D correspondences stopping the prioritized search
+  std::size_t nbCorrespondences = 200;
+  /// level of the vocabulary tree of the 3D-2D search of the prioritized search
+  uint32_t pointSearchLevel = 2;
   /// number of similar images to search when querying the voctree
   std::size_t numResults = 4;
   /// maximum number of successfully matched similar images
@@ -97,11 +118,19 @@ int aliceVision_main(int argc, char** argv)
   std::string vocTreeFilepath;
   /// the vocabulary tree weights file
   std::string weightsFilepath;
+  std::string wordsCacheFolder;
+  std::string voctreeDatabaseFile;
   /// Number of previous frame of the sequence to use for matching
   std::size_t nbFrameBufferMatching = 10;
+  /// Number of frames localized at the same time, 0 for all the cores
+  int nbConcurrentQueries = 1;
   /// enable/disable the robust matching (geometric validation) when matching query image
   /// and databases images
   bool robustMatching = true;
+  /// the matcher used to match the query image with the database images
+  std::string matcherTypeName = matching::EMatcherType_enumToString(matching::ANN_L2);
+  /// reuse the matchers built on the regions of the database images across the frames
+  bool reuseViewMatchers = false;
   
   /// the Alembic export file
   std::string exportAlembicFile = "trackedcameras.abc";
@@ -178,8 +207,21 @@ int aliceVision_main(int argc, char** argv)
           "[voctree] Filename for the vocabulary tree")
       ("voctreeWeights", po::value<std::string>(&weightsFilepath), 
           "[voctree] Filename for the vocabulary tree weights")
+      ("voctreeWordsCacheFolder", po::value<std::string>(&wordsCacheFolder),
+          "[voctree] Folder of the cache of the visual words of the scene descriptor files, "
+          "reused while the descriptor files and the vocabulary tree do not change")
+      ("voctreeDatabaseFile", po::value<std::string>(&voctreeDatabaseFile),
+          "[voctree] File of the vocabulary tree database of the scene, loaded if it exists and "
+          "updated with the views added to or removed from the scene")
       ("algorithm", po::value<std::string>(&algostring)->default_value(algostring), 
-          "[voctree] Algorithm type: FirstBest, AllResults" )
+          "[voctree] Algorithm type: FirstBest, AllResults, PrioritizedSearch (direct 2D-3D matching expanded "
+          "through the database images of the matched 3D points), Direct (direct 2D-3D matching with the descriptors "
+          "of the 3D points, saved next to the sfmdata file and shared with sfmLocalization)" )
+      ("nbCorrespondences", po::value<std::size_t>(&nbCorrespondences)->default_value(nbCorrespondences),
+          "[voctree] For PrioritizedSearch, number of 2D-3D correspondences stopping the search")
+      ("pointSearchLevel", po::value<uint32_t>(&pointSearchLevel)->default_value(pointSearchLevel),
+          "[voctree] For PrioritizedSearch, level of the vocabulary tree nodes whose query features are searched "
+          "for the 3D points of the database images, 0 for the first level")
       ("matchingError", po::value<double>(&matchingErrorMax)->default_value(matchingErrorMax), 
           "[voctree] Maximum matching error (in pixels) allowed for image matching with "
           "geometric verification. If set to 0 it lets the ACRansac select "
@@ -187,9 +229,19 @@ int aliceVision_main(int argc, char** argv)
       ("nbFrameBufferMatching", po::value<std::size_t>(&nbFrameBufferMatching)->default_value(nbFrameBufferMatching),
           "[voctree] Number of previous frame of the sequence to use for matching "
           "(0 = Disable)")
+      ("nbConcurrentQueries", po::value<int>(&nbConcurrentQueries)->default_value(nbConcurrentQueries),
+          "[voctree] Number of frames localized at the same time, 0 to use all the cores. "
+          "The frames localized at the same time may not be in the frame buffer of each other.")
       ("robustMatching", po::value<bool>(&robustMatching)->default_value(robustMatching), 
           "[voctree] Enable/Disable the robust matching between query and database images, "
           "all putative matches will be considered.")
+      ("matcherType", po::value<std::string>(&matcherTypeName)->default_value(matcherTypeName),
+          "[voctree] Matcher used to match the query image with the database images: "
+          "BRUTE_FORCE_L2, ANN_L2, CASCADE_HASHING_L2, GPU_BRUTE_FORCE_L2 (requires CUDA)")
+      ("reuseViewMatchers", po::value<bool>(&reuseViewMatchers)->default_value(reuseViewMatchers),
+          "[voctree] Build the matchers on the regions of the database images once and match the query "
+          "images with them, instead of building a matcher on the regions of each query image. "
+          "The ratio test then compares the database image features closest to each query feature.")
 // cctag specific options
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CCTAG)
       ("nNearestKeyFrames", po::value<size_t>(&nNearestKeyFrames)->default_value(nNearestKeyFrames), 
@@ -315,13 +367,32 @@ int aliceVision_main(int argc, char** argv)
   }
   else
 #endif
+  if(algostring == "PrioritizedSearch")
+  {
+    localization::PrioritizedSearchLocalizer* tmpLoc = new localization::PrioritizedSearchLocalizer(sfmData,
+                                                   descriptorsFolder,
+                                                   vocTreeFilepath,
+                                                   weightsFilepath,
+                                                   matchDescTypes,
+                                                   wordsCacheFolder,
+                                                   voctreeDatabaseFile);
+    localizer.reset(tmpLoc);
+
+    localization::PrioritizedSearchLocalizer::Parameters *tmpParam = new localization::PrioritizedSearchLocalizer::Parameters();
+    param.reset(tmpParam);
+    tmpParam->_nbCorrespondences = nbCorrespondences;
+    tmpParam->_pointSearchLevel = pointSearchLevel;
+  }
+  else
   {
 
     localization::VoctreeLocalizer* tmpLoc = new localization::VoctreeLocalizer(sfmData,
                                                    descriptorsFolder,
                                                    vocTreeFilepath,
                                                    weightsFilepath,
-                                                   matchDescTypes);
+                                                   matchDescTypes,
+                                                   wordsCacheFolder,
+                                                   voctreeDatabaseFile);
 
     localizer.reset(tmpLoc);
     
@@ -335,6 +406,15 @@ int aliceVision_main(int argc, char** argv)
     tmpParam->_matchingError = matchingErrorMax;
     tmpParam->_nbFrameBufferMatching = nbFrameBufferMatching;
     tmpParam->_useRobustMatching = robustMatching;
+    tmpParam->_matcherType = matching::EMatcherType_stringToEnum(matcherTypeName);
+    tmpParam->_reuseViewMatchers = reuseViewMatchers;
+
+    if(tmpParam->_algorithm == localization::VoctreeLocalizer::Algorithm::Direct &&
+       tmpLoc->isInit() && !tmpLoc->initLandmarksDescriptors(sfmFilePath))
+    {
+      ALICEVISION_LOG_ERROR("Cannot initialize the descriptors of the 3D points for the Direct algorithm.");
+      return EXIT_FAILURE;
+    }
   }
   
   assert(localizer);
@@ -354,9 +434,18 @@ int aliceVision_main(int argc, char** argv)
     ALICEVISION_CERR("ERROR while initializing the localizer!");
     return EXIT_FAILURE;
   }
+
+  // only the voctree localizer supports concurrent queries
+  if(nbConcurrentQueries <= 0)
+    nbConcurrentQueries = omp_get_max_threads();
+  if(!useVoctreeLocalizer && nbConcurrentQueries > 1)
+  {
+    ALICEVISION_LOG_WARNING("The CCTag localizer localizes the frames one at a time.");
+    nbConcurrentQueries = 1;
+  }
   
-  // create the feedProvider
-  dataio::FeedProvider feed(mediaFilepath, calibFile);
+  // create the feedProvider, the next frames are decoded during the localization
+  dataio::AsyncFeedProvider feed(mediaFilepath, calibFile);
   if(!feed.isInit())
   {
     ALICEVISION_CERR("ERROR while initializing the FeedProvider!");
@@ -369,9 +458,19 @@ int aliceVision_main(int argc, char** argv)
   exporter.initAnimatedCamera("camera");
 #endif
   
-  image::Image<float> imageGrey;
-  camera::PinholeRadialK3 queryIntrinsics;
-  bool hasIntrinsics = false;
+  /// a frame to localize
+  struct Query
+  {
+    image::Image<float> imageGrey;
+    camera::PinholeRadialK3 intrinsics;
+    bool hasIntrinsics = false;
+    std::string imageName;
+    /// each frame has its own seed, the results do not depend on the concurrent frames
+    std::mt19937::result_type seed = 0;
+    localization::LocalizationResult result;
+    /// localization time in [ms]
+    double time = 0.0;
+  };
   
   std::size_t frameCounter = 0;
   std::size_t goodFrameCounter = 0;
@@ -385,50 +484,87 @@ int aliceVision_main(int argc, char** argv)
   // Define an accumulator set for computing the mean and the
   // standard deviation of the time taken for localization
   bacc::accumulator_set<double, bacc::stats<bacc::tag::mean, bacc::tag::min, bacc::tag::max, bacc::tag::sum > > stats;
+  std::vector<double> localizationTimes;
   
   std::vector<localization::LocalizationResult> vec_localizationResults;
   
-  while(feed.readImage(imageGrey, queryIntrinsics, currentImgName, hasIntrinsics))
+  // the frames are localized by batches, a few frames by concurrent query keep all the threads busy
+  const std::size_t batchSize = (nbConcurrentQueries > 1) ? 4 * nbConcurrentQueries : 1;
+  std::vector<Query> queries(batchSize);
+  const auto processingStart = std::chrono::steady_clock::now();
+  
+  bool hasFrames = true;
+  while(hasFrames)
   {
-    ALICEVISION_COUT("******************************");
-    ALICEVISION_COUT("FRAME " << utils::toStringZeroPadded(frameCounter, 4));
-    ALICEVISION_COUT("******************************");
-    localization::LocalizationResult localizationResult;
-    auto detect_start = std::chrono::steady_clock::now();
-    localizer->localize(imageGrey, 
-                       param.get(),
-                       generator,
-                       hasIntrinsics /*useInputIntrinsics*/,
-                       queryIntrinsics,
-                       localizationResult,
-                       currentImgName);
-    auto detect_end = std::chrono::steady_clock::now();
-    auto detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
-    ALICEVISION_COUT("\nLocalization took  " << detect_elapsed.count() << " [ms]");
-    stats(detect_elapsed.count());
+    std::size_t nbQueries = 0;
+    while(nbQueries < batchSize)
+    {
+      Query& query = queries[nbQueries];
+      if(!feed.readImage(query.imageGrey, query.intrinsics, query.imageName, query.hasIntrinsics))
+      {
+        hasFrames = false;
+        break;
+      }
+      query.seed = generator();
+      ++nbQueries;
+      feed.goToNextFrame();
+    }
     
-    vec_localizationResults.emplace_back(localizationResult);
-
-    // save data
-    if(localizationResult.isValid())
+    #pragma omp parallel for num_threads(nbConcurrentQueries) schedule(dynamic)
+    for(int i = 0; i < static_cast<int>(nbQueries); ++i)
     {
-#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ALEMBIC)
-      exporter.addCameraKeyframe(localizationResult.getPose(), &queryIntrinsics, currentImgName, frameCounter, frameCounter);
-#endif
+      Query& query = queries[i];
+      std::mt19937 queryGenerator(query.seed);
+      query.result = localization::LocalizationResult();
       
-      goodFrameCounter++;
-      goodFrameList.push_back(currentImgName + " : " + std::to_string(localizationResult.getIndMatch3D2D().size()) );
+      const auto detect_start = std::chrono::steady_clock::now();
+      localizer->localize(query.imageGrey, 
+                         param.get(),
+                         queryGenerator,
+                         query.hasIntrinsics /*useInputIntrinsics*/,
+                         query.intrinsics,
+                         query.result,
+                         query.imageName);
+      const auto detect_end = std::chrono::steady_clock::now();
+      query.time = std::chrono::duration<double, std::milli>(detect_end - detect_start).count();
     }
-    else
+    
+    for(std::size_t i = 0; i < nbQueries; ++i)
     {
-      ALICEVISION_CERR("Unable to localize frame " << frameCounter);
+      const Query& query = queries[i];
+      const localization::LocalizationResult& localizationResult = query.result;
+      currentImgName = query.imageName;
+      
+      ALICEVISION_COUT("******************************");
+      ALICEVISION_COUT("FRAME " << utils::toStringZeroPadded(frameCounter, 4));
+      ALICEVISION_COUT("******************************");
+      ALICEVISION_COUT("\nLocalization took  " << query.time << " [ms]");
+      stats(query.time);
+      localizationTimes.push_back(query.time);
+      
+      vec_localizationResults.emplace_back(localizationResult);
+
+      // save data
+      if(localizationResult.isValid())
+      {
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ALEMBIC)
+        exporter.addCameraKeyframe(localizationResult.getPose(), &query.intrinsics, currentImgName, frameCounter, frameCounter);
+#endif
+        
+        goodFrameCounter++;
+        goodFrameList.push_back(currentImgName + " : " + std::to_string(localizationResult.getIndMatch3D2D().size()) );
+      }
+      else
+      {
+        ALICEVISION_CERR("Unable to localize frame " << frameCounter);
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ALEMBIC)
-      exporter.jumpKeyframe(currentImgName);
+        exporter.jumpKeyframe(currentImgName);
 #endif
+      }
+      ++frameCounter;
     }
-    ++frameCounter;
-    feed.goToNextFrame();
   }
+  const double processingTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - processingStart).count();
 
   if(wantsJsonOutput)
   {
@@ -500,6 +636,16 @@ int aliceVision_main(int argc, char** argv)
   ALICEVISION_COUT("Mean time for localization:   " << bacc::mean(stats) << " [ms]");
   ALICEVISION_COUT("Max time for localization:   " << bacc::max(stats) << " [ms]");
   ALICEVISION_COUT("Min time for localization:   " << bacc::min(stats) << " [ms]");
+  if(!localizationTimes.empty())
+  {
+    std::sort(localizationTimes.begin(), localizationTimes.end());
+    ALICEVISION_COUT("Localization with " << nbConcurrentQueries << " concurrent frames took " << processingTime << " [s], "
+                     << frameCounter / processingTime << " frames per second");
+    ALICEVISION_COUT("Percentiles of the localization time: "
+                     << "50%: " << getPercentile(localizationTimes, 50) << " [ms], "
+                     << "90%: " << getPercentile(localizationTimes, 90) << " [ms], "
+                     << "99%: " << getPercentile(localizationTimes, 99) << " [ms]");
+  }
 
   return EXIT_SUCCESS;
 }
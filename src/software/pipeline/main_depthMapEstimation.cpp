@@ -21,7 +21,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 3
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 5
 
 using namespace aliceVision;
 
@@ -67,6 +67,11 @@ int aliceVision_main(int argc, char* argv[])
     // number of GPUs to use (0 means use all GPUs)
     int nbGPUs = 0;
 
+    // dynamic scheduling
+    bool useWorkQueue = false;
+    std::string workQueueFolder;
+    int workQueueNbCamsPerJob = 4;
+
     po::options_description requiredParams("Required parameters");
     requiredParams.add_options()
         ("input,i", po::value<std::string>(&sfmDataFilename)->required(),
@@ -131,6 +136,16 @@ int aliceVision_main(int argc, char* argv[])
             "Semi Global Matching: Define axes for the filtering of the similarity volume.")
         ("sgmDepthListPerTile", po::value<bool>(&sgmParams.depthListPerTile)->default_value(sgmParams.depthListPerTile),
             "Semi Global Matching: Select the list of depth planes per tile or globally to the image.")
+        ("sgmUseFusedVolumeOptimization", po::value<bool>(&sgmParams.useFusedVolumeOptimization)->default_value(sgmParams.useFusedVolumeOptimization),
+            "Semi Global Matching: Optimize the similarity volume with one fused kernel per slice of each path "
+            "(the elapsed time of the optimization is logged to compare with the default kernels).")
+        ("sgmUseCoarseDepthPruning", po::value<bool>(&sgmParams.useCoarseDepthPruning)->default_value(sgmParams.useCoarseDepthPruning),
+            "Semi Global Matching: Coarse-to-fine depth pruning. A coarse similarity volume selects a band of depths per block of pixels, "
+            "the full resolution volume only evaluates these depths and the depths used by no block are removed from the tile depth list.")
+        ("sgmCoarseDepthPruningStep", po::value<int>(&sgmParams.coarseDepthPruningStep)->default_value(sgmParams.coarseDepthPruningStep),
+            "Semi Global Matching: Size of the blocks of pixels of the coarse depth pruning (step of the coarse volume relative to sgmStepXY).")
+        ("sgmCoarseDepthPruningMargin", po::value<int>(&sgmParams.coarseDepthPruningMargin)->default_value(sgmParams.coarseDepthPruningMargin),
+            "Semi Global Matching: Number of depths kept in front of and behind the best coarse depths of a block neighborhood.")
         ("refineScale", po::value<int>(&refineParams.scale)->default_value(refineParams.scale),
             "Refine: Downscale factor applied on source images for the Refine step (in addition to the global downscale).")
         ("refineStepXY", po::value<int>(&refineParams.stepXY)->default_value(refineParams.stepXY),
@@ -159,6 +174,11 @@ int aliceVision_main(int argc, char* argv[])
             "Enable/Disable depth/similarity map post-process color optimization.")
         ("autoAdjustSmallImage", po::value<bool>(&depthMapParams.autoAdjustSmallImage)->default_value(depthMapParams.autoAdjustSmallImage),
             "Automatically adjust depth map parameters if images are smaller than one tile (maxTCamsPerTile=maxTCams, adjust step if needed).")
+        ("targetTimePerImage", po::value<double>(&depthMapParams.targetTimePerImage)->default_value(depthMapParams.targetTimePerImage),
+            "Auto-tuning: target computation time per image (in seconds). The highest quality preset predicted to fit is used "
+            "(lower number of depths, T cameras and refine samples). 0 means disabled.")
+        ("maxDeviceMemoryPerImage", po::value<double>(&depthMapParams.maxDeviceMemoryPerImage)->default_value(depthMapParams.maxDeviceMemoryPerImage),
+            "Auto-tuning: device memory budget per image (in MB), also limits the number of simultaneous tiles. 0 means disabled.")
         ("exportIntermediateDepthSimMaps", po::value<bool>(&exportIntermediateDepthSimMaps)->default_value(exportIntermediateDepthSimMaps),
             "Export intermediate depth/similarity maps from the SGM and Refine steps.")
         ("exportIntermediateVolumes", po::value<bool>(&exportIntermediateVolumes)->default_value(exportIntermediateVolumes),
@@ -169,8 +189,18 @@ int aliceVision_main(int argc, char* argv[])
             "Export intermediate volumes 9 points from the SGM and Refine steps in CSV files.")
         ("exportTilePattern", po::value<bool>(&depthMapParams.exportTilePattern)->default_value(depthMapParams.exportTilePattern),
             "Export workflow tile pattern.")
+        ("imageCacheFolder", po::value<std::string>(&depthMapParams.imageCacheFolder)->default_value(depthMapParams.imageCacheFolder),
+            "Folder of the preprocessed images disk cache (downscaled images converted for the GPU), reused by the next runs and chunks. "
+            "Empty means no disk cache.")
         ("nbGPUs", po::value<int>(&nbGPUs)->default_value(nbGPUs),
-            "Number of GPUs to use (0 means use all GPUs).");
+            "Number of GPUs to use (0 means use all GPUs).")
+        ("useWorkQueue", po::value<bool>(&useWorkQueue)->default_value(useWorkQueue),
+            "Pull the cameras from a work queue ordered by estimated cost instead of splitting them statically between the GPUs.")
+        ("workQueueFolder", po::value<std::string>(&workQueueFolder)->default_value(workQueueFolder),
+            "Folder shared by the processes pulling from the same work queue (enables the work queue). "
+            "Processes on several nodes can share it, they should use the same input and camera range.")
+        ("workQueueNbCamsPerJob", po::value<int>(&workQueueNbCamsPerJob)->default_value(workQueueNbCamsPerJob),
+            "Number of cameras pulled by a GPU from the work queue for each job.");
 
     CmdLine cmdline("Dense Reconstruction.\n"
                     "This program estimate a depth map for each input calibrated camera using Plane Sweeping, a multi-view stereo algorithm notable for its efficiency on modern graphics hardware (GPU).\n"
@@ -284,6 +314,10 @@ int aliceVision_main(int argc, char* argv[])
     mp.userParams.put("sgm.filteringAxes", sgmParams.filteringAxes);
     mp.userParams.put("sgm.useSfmSeeds", sgmParams.useSfmSeeds);
     mp.userParams.put("sgm.depthListPerTile", sgmParams.depthListPerTile);
+    mp.userParams.put("sgm.useFusedVolumeOptimization", sgmParams.useFusedVolumeOptimization);
+    mp.userParams.put("sgm.useCoarseDepthPruning", sgmParams.useCoarseDepthPruning);
+    mp.userParams.put("sgm.coarseDepthPruningStep", sgmParams.coarseDepthPruningStep);
+    mp.userParams.put("sgm.coarseDepthPruningMargin", sgmParams.coarseDepthPruningMargin);
     mp.userParams.put("sgm.exportIntermediateDepthSimMaps", exportIntermediateDepthSimMaps);
     mp.userParams.put("sgm.exportIntermediateVolumes", exportIntermediateVolumes);
     mp.userParams.put("sgm.exportIntermediateCrossVolumes", exportIntermediateCrossVolumes);
@@ -311,6 +345,9 @@ int aliceVision_main(int argc, char* argv[])
     mp.userParams.put("depthMap.maxTCams", depthMapParams.maxTCams);
     mp.userParams.put("depthMap.exportTilePattern", depthMapParams.exportTilePattern);
     mp.userParams.put("depthMap.autoAdjustSmallImage", depthMapParams.autoAdjustSmallImage);
+    mp.userParams.put("depthMap.imageCacheFolder", depthMapParams.imageCacheFolder);
+    mp.userParams.put("depthMap.targetTimePerImage", depthMapParams.targetTimePerImage);
+    mp.userParams.put("depthMap.maxDeviceMemoryPerImage", depthMapParams.maxDeviceMemoryPerImage);
 
     std::vector<int> cams;
     cams.reserve(mp.ncams);
@@ -337,7 +374,18 @@ int aliceVision_main(int argc, char* argv[])
     }
 
     ALICEVISION_LOG_INFO("Create depth maps.");
-    depthMap::computeOnMultiGPUs(mp, cams, depthMap::estimateAndRefineDepthMaps, nbGPUs);
+    if(useWorkQueue || !workQueueFolder.empty())
+    {
+      std::vector<double> costs;
+      depthMap::estimateDepthMapsCost(mp, cams, costs);
+
+      depthMap::CameraWorkQueue workQueue(cams, costs, workQueueFolder);
+      depthMap::computeOnMultiGPUs(mp, workQueue, depthMap::estimateAndRefineDepthMaps, nbGPUs, std::max(1, workQueueNbCamsPerJob), cmdline.getHardwareContext());
+    }
+    else
+    {
+      depthMap::computeOnMultiGPUs(mp, cams, depthMap::estimateAndRefineDepthMaps, nbGPUs, cmdline.getHardwareContext());
+    }
 
     ALICEVISION_COMMANDLINE_END
 }
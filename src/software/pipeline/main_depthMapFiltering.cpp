@@ -24,7 +24,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 2
 
 using namespace aliceVision;
 
@@ -53,6 +53,10 @@ int aliceVision_main(int argc, char* argv[])
     int pixSizeBallWithLowSimilarity = 0;
     int nNearestCams = 10;
     bool computeNormalMaps = false;
+    bool useGpu = false;
+    int maxNbCachedDepthMaps = 20;
+    int nbGPUs = 0;
+    std::string neighborCamsGraphFilepath;
 
     po::options_description requiredParams("Required parameters");
     requiredParams.add_options()
@@ -86,7 +90,15 @@ int aliceVision_main(int argc, char* argv[])
         ("nNearestCams", po::value<int>(&nNearestCams)->default_value(nNearestCams),
             "Number of nearest cameras.")
         ("computeNormalMaps", po::value<bool>(&computeNormalMaps)->default_value(computeNormalMaps),
-            "Compute normal maps per depth map");
+            "Compute normal maps per depth map")
+        ("useGpu", po::value<bool>(&useGpu)->default_value(useGpu),
+            "Filter the depth maps on the GPU.")
+        ("maxNbCachedDepthMaps", po::value<int>(&maxNbCachedDepthMaps)->default_value(maxNbCachedDepthMaps),
+            "Maximum number of neighbor depth maps kept in GPU memory (with useGpu).")
+        ("nbGPUs", po::value<int>(&nbGPUs)->default_value(nbGPUs),
+            "Number of GPUs to use (0 means use all GPUs).")
+        ("neighborCamsGraph", po::value<std::string>(&neighborCamsGraphFilepath)->default_value(neighborCamsGraphFilepath),
+            "Neighbor cameras graph file of prepareDenseScene, to find the nearest cameras without scanning the landmarks.");
 
     CmdLine cmdline("This program filters depth maps to remove values that are not consistent with other depth maps.\n"
                     "AliceVision depthMapFiltering");
@@ -111,6 +123,12 @@ int aliceVision_main(int argc, char* argv[])
     mp.setMinViewAngle(minViewAngle);
     mp.setMaxViewAngle(maxViewAngle);
 
+    if(!neighborCamsGraphFilepath.empty() && !mp.loadNeighborCamsGraph(neighborCamsGraphFilepath))
+    {
+        ALICEVISION_LOG_ERROR("The neighbor cameras graph file '" << neighborCamsGraphFilepath << "' cannot be read or does not match the input sfmData.");
+        return EXIT_FAILURE;
+    }
+
     std::vector<int> cams;
     cams.reserve(mp.ncams);
 
@@ -137,16 +155,30 @@ int aliceVision_main(int argc, char* argv[])
 
     ALICEVISION_LOG_INFO("Filter depth maps.");
 
+    if(useGpu)
+    {
+        mp.userParams.put("depthMapFiltering.minNumOfConsistentCams", minNumOfConsistentCams);
+        mp.userParams.put("depthMapFiltering.minNumOfConsistentCamsWithLowSimilarity", minNumOfConsistentCamsWithLowSimilarity);
+        mp.userParams.put("depthMapFiltering.pixToleranceFactor", pixToleranceFactor);
+        mp.userParams.put("depthMapFiltering.pixSizeBall", pixSizeBall);
+        mp.userParams.put("depthMapFiltering.pixSizeBallWithLowSimilarity", pixSizeBallWithLowSimilarity);
+        mp.userParams.put("depthMapFiltering.nNearestCams", nNearestCams);
+        mp.userParams.put("depthMapFiltering.maxNbCachedDepthMaps", maxNbCachedDepthMaps);
+        // the normal maps are computed from the filtered depth maps before they leave the device
+        mp.userParams.put("depthMapFiltering.computeNormalMaps", computeNormalMaps);
+
+        depthMap::computeOnMultiGPUs(mp, cams, depthMap::filterDepthMaps, nbGPUs, cmdline.getHardwareContext());
+    }
+    else
     {
         fuseCut::Fuser fs(mp);
         fs.filterGroups(cams, pixToleranceFactor, pixSizeBall, pixSizeBallWithLowSimilarity, nNearestCams);
         fs.filterDepthMaps(cams, minNumOfConsistentCams, minNumOfConsistentCamsWithLowSimilarity);
     }
 
-    if (computeNormalMaps)
+    if (computeNormalMaps && !useGpu)
     {
-        int nbGPUs = 0;
-        depthMap::computeOnMultiGPUs(mp, cams, depthMap::computeNormalMaps, nbGPUs);
+        depthMap::computeOnMultiGPUs(mp, cams, depthMap::computeNormalMaps, nbGPUs, cmdline.getHardwareContext());
     }
 
     ALICEVISION_LOG_INFO("Task done in (s): " + std::to_string(timer.elapsed()));
@@ -26,6 +26,7 @@
 #include <aliceVision/calibration/checkerDetector.hpp>
 
 #include <chrono>
+#include <exception>
 #include <vector>
 
 
@@ -543,61 +544,96 @@ int aliceVision_main(int argc, char* argv[])
         std::vector<calibration::LineWithPoints> allLineWithPoints;
         std::vector<std::vector<calibration::LineWithPoints>> lineWithPointsPerImage;
 
-        for(const std::string lensGridFilepath : lensGridFilepaths)
-        {
-            //Check pixel ratio
-            double pixelRatio = 1.0; // view->getDoubleMetadata({"PixelAspectRatio"}); // TODO
-            if (pixelRatio < 0.0)
-            {
-                pixelRatio = 1.0;
-            }
-
-            //Read image
-            image::Image<image::RGBColor> input;
-            image::readImage(lensGridFilepath, input, image::EImageColorSpace::SRGB);
+        // The lens grid images are processed in parallel, their lines are gathered in the input order
+        std::vector<std::vector<calibration::LineWithPoints>> lineWithPointsPerGrid(lensGridFilepaths.size());
+        std::vector<char> isValidGrid(lensGridFilepaths.size(), 0);
+        std::exception_ptr gridError;
 
-            if (pixelRatio != 1.0)
+        #pragma omp parallel for schedule(dynamic)
+        for(int idGrid = 0; idGrid < lensGridFilepaths.size(); ++idGrid)
+        {
+            const std::string& lensGridFilepath = lensGridFilepaths[idGrid];
+            try
             {
-                // if pixel are not squared, convert the image for lines extraction
+                //Check pixel ratio
+                double pixelRatio = 1.0; // view->getDoubleMetadata({"PixelAspectRatio"}); // TODO
+                if (pixelRatio < 0.0)
+                {
+                    pixelRatio = 1.0;
+                }
+
+                //Read image
+                image::Image<image::RGBColor> input;
+                image::readImage(lensGridFilepath, input, image::EImageColorSpace::SRGB);
+
+                if (pixelRatio != 1.0)
+                {
+                    // if pixel are not squared, convert the image for lines extraction
+                    const double w = input.Width();
+                    const double h = input.Height();
+                    const double nw = w;
+                    const double nh = h / pixelRatio;
+                    image::Image<image::RGBColor> resizedInput(nw, nh);
+
+                    const oiio::ImageSpec imageSpecResized(nw, nh, 3, oiio::TypeDesc::UCHAR);
+                    const oiio::ImageSpec imageSpecOrigin(w, h, 3, oiio::TypeDesc::UCHAR);
+
+                    const oiio::ImageBuf inBuf(imageSpecOrigin, input.data());
+                    oiio::ImageBuf outBuf(imageSpecResized, resizedInput.data());
+
+                    oiio::ImageBufAlgo::resize(outBuf, inBuf);
+                    input.swap(resizedInput);
+                }
+
+                const Vec2 originalScale = cameraPinhole->getScale();
+            
                 const double w = input.Width();
                 const double h = input.Height();
-                const double nw = w;
-                const double nh = h / pixelRatio;
-                image::Image<image::RGBColor> resizedInput(nw, nh);
-
-                const oiio::ImageSpec imageSpecResized(nw, nh, 3, oiio::TypeDesc::UCHAR);
-                const oiio::ImageSpec imageSpecOrigin(w, h, 3, oiio::TypeDesc::UCHAR);
-
-                const oiio::ImageBuf inBuf(imageSpecOrigin, input.data());
-                oiio::ImageBuf outBuf(imageSpecResized, resizedInput.data());
-
-                oiio::ImageBufAlgo::resize(outBuf, inBuf);
-                input.swap(resizedInput);
+                if(w != cameraPinhole->w())
+                {
+                    ALICEVISION_THROW_ERROR("Inconsistant size between the image and the camera intrinsics (image: "
+                                            << w << "x" << h << ", camera: " << cameraPinhole->w() << "x" << cameraPinhole->h());
+                }
+
+                fs::copy_file(lensGridFilepath, fs::path(outputPath) / fs::path(lensGridFilepath).filename(),
+                              fs::copy_options::overwrite_existing);
+
+                const std::string checkerImagePath =
+                    (fs::path(outputPath) / fs::path(lensGridFilepath).stem()).string() + "_checkerboard.exr";
+
+                // Retrieve lines
+                std::vector<calibration::LineWithPoints> lineWithPoints;
+                if (!retrieveLines(lineWithPoints, input, checkerImagePath))
+                {
+                    ALICEVISION_LOG_ERROR("Impossible to extract the checkerboards lines from " << lensGridFilepath);
+                    continue;
+                }
+                lineWithPointsPerGrid[idGrid].swap(lineWithPoints);
+                isValidGrid[idGrid] = 1;
             }
-
-            const Vec2 originalScale = cameraPinhole->getScale();
-        
-            const double w = input.Width();
-            const double h = input.Height();
-            if(w != cameraPinhole->w())
+            catch(...)
             {
-                ALICEVISION_THROW_ERROR("Inconsistant size between the image and the camera intrinsics (image: "
-                                        << w << "x" << h << ", camera: " << cameraPinhole->w() << "x" << cameraPinhole->h());
+                #pragma omp critical(distortionCalibrationGridError)
+                {
+                    if(!gridError)
+                        gridError = std::current_exception();
+                }
             }
+        }
 
-            fs::copy_file(lensGridFilepath, fs::path(outputPath) / fs::path(lensGridFilepath).filename(),
-                          fs::copy_options::overwrite_existing);
-
-            const std::string checkerImagePath =
-                (fs::path(outputPath) / fs::path(lensGridFilepath).stem()).string() + "_checkerboard.exr";
+        if(gridError)
+        {
+            std::rethrow_exception(gridError);
+        }
 
-            // Retrieve lines
-            std::vector<calibration::LineWithPoints> lineWithPoints;
-            if (!retrieveLines(lineWithPoints, input, checkerImagePath))
+        for(std::size_t idGrid = 0; idGrid < lensGridFilepaths.size(); ++idGrid)
+        {
+            if(!isValidGrid[idGrid])
             {
-                ALICEVISION_LOG_ERROR("Impossible to extract the checkerboards lines");
                 continue;
             }
+
+            const std::vector<calibration::LineWithPoints>& lineWithPoints = lineWithPointsPerGrid[idGrid];
             lineWithPointsPerImage.push_back(lineWithPoints);
             allLineWithPoints.insert(allLineWithPoints.end(), lineWithPoints.begin(), lineWithPoints.end());
         }
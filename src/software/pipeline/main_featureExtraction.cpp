@@ -15,6 +15,7 @@
  || ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CCTAG)
 #define ALICEVISION_HAVE_GPU_FEATURES
 #include <aliceVision/gpu/gpu.hpp>
+#include <aliceVision/gpu/GpuResourceManager.hpp>
 #endif
 #include <aliceVision/system/Timer.hpp>
 #include <aliceVision/system/Logger.hpp>
@@ -24,7 +25,9 @@
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
 
+#include <algorithm>
 #include <string>
+#include <sstream>
 #include <iostream>
 #include <functional>
 #include <memory>
@@ -32,7 +35,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 2
 
 using namespace aliceVision;
 
@@ -56,6 +59,7 @@ int aliceVision_main(int argc, char **argv)
   int rangeSize = 1;
   int maxThreads = 0;
   bool forceCpuExtraction = false;
+  feature::EFeatureFileFormat featuresFileFormat = feature::EFeatureFileFormat::BINARY;
 
   po::options_description requiredParams("Required parameters");
   requiredParams.add_options()
@@ -85,6 +89,8 @@ int aliceVision_main(int argc, char **argv)
       "Use only CPU feature extraction methods.")
     ("masksFolder", po::value<std::string>(&masksFolder),
       "Masks folder.")
+    ("featuresFileFormat", po::value<feature::EFeatureFileFormat>(&featuresFileFormat)->default_value(featuresFileFormat),
+      feature::EFeatureFileFormat_information().c_str())
     ("rangeStart", po::value<int>(&rangeStart)->default_value(rangeStart),
       "Range image index start.")
     ("rangeSize", po::value<int>(&rangeSize)->default_value(rangeSize),
@@ -134,10 +140,27 @@ int aliceVision_main(int argc, char **argv)
   feature::FeatureExtractor extractor(sfmData);
   extractor.setMasksFolder(masksFolder);
   extractor.setOutputFolder(outputFolder);
+  extractor.setFeaturesFileFormat(featuresFileFormat);
+
+  // the existing features are recomputed if one of these settings changes
+  {
+    std::ostringstream settings;
+    settings << "version=" << ALICEVISION_SOFTWARE_VERSION_MAJOR << "." << ALICEVISION_SOFTWARE_VERSION_MINOR
+             << ";describerPreset=" << featDescConfig.descPreset
+             << ";describerQuality=" << featDescConfig.quality
+             << ";gridFiltering=" << featDescConfig.gridFiltering
+             << ";maxNbFeatures=" << featDescConfig.maxNbFeatures
+             << ";contrastFiltering=" << featDescConfig.contrastFiltering
+             << ";relativePeakThreshold=" << featDescConfig.relativePeakThreshold
+             << ";forceCpuExtraction=" << forceCpuExtraction
+             << ";featuresFileFormat=" << featuresFileFormat;
+    extractor.setSettings(settings.str());
+  }
 
   // set maxThreads
   HardwareContext hwc = cmdline.getHardwareContext();
   hwc.setUserCoresLimit(maxThreads);
+  hwc.setupThreads();
 
   // set extraction range
   if(rangeStart != -1)
@@ -155,24 +178,50 @@ int aliceVision_main(int argc, char **argv)
     extractor.setRange(rangeStart, rangeSize);
   }
 
+#ifdef ALICEVISION_HAVE_GPU_FEATURES
+  // the GPU device is reserved for the whole extraction, so the other processes of the machine use the other devices
+  gpu::GpuResourceManager gpuResourceManager(hwc);
+#endif
+
   // initialize feature extractor imageDescribers
   {
     std::vector<feature::EImageDescriberType> imageDescriberTypes = feature::EImageDescriberType_stringToEnums(describerTypesName);
+    std::vector<std::shared_ptr<feature::ImageDescriber>> imageDescribers;
 
     for(const auto& imageDescriberType: imageDescriberTypes)
     {
       std::shared_ptr<feature::ImageDescriber> imageDescriber = feature::createImageDescriber(imageDescriberType);
       imageDescriber->setConfigurationPreset(featDescConfig);
-      if(forceCpuExtraction)
+      if(forceCpuExtraction || hwc.getUserMaxGpusAvailable() == 0)
         imageDescriber->setUseCuda(false);
 
-      extractor.addImageDescriber(imageDescriber);
+      imageDescribers.push_back(imageDescriber);
     }
+
+#ifdef ALICEVISION_HAVE_GPU_FEATURES
+    const bool useCuda = std::any_of(imageDescribers.begin(), imageDescribers.end(), [](const std::shared_ptr<feature::ImageDescriber>& imageDescriber) {
+      return imageDescriber->useCuda();
+    });
+    if(useCuda)
+    {
+      const std::vector<int> cudaDevices = gpuResourceManager.acquireDevices(1);
+      for(const auto& imageDescriber : imageDescribers)
+      {
+        if(cudaDevices.empty())
+          imageDescriber->setUseCuda(false);
+        else
+          imageDescriber->setCudaPipe(cudaDevices.front());
+      }
+    }
+#endif
+
+    for(const auto& imageDescriber : imageDescribers)
+      extractor.addImageDescriber(imageDescriber);
   }
 
   // feature extraction routines
   // for each View of the SfMData container:
-  // - if regions file exist continue,
+  // - if regions files exist with a manifest matching the image, mask and settings, continue,
   // - if no file, compute features
   {
     system::Timer timer;
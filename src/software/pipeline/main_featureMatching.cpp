@@ -8,6 +8,7 @@
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
 #include <aliceVision/sfm/pipeline/regionsIO.hpp>
+#include <aliceVision/sfm/pipeline/LazyRegionsPerView.hpp>
 #include <aliceVision/sfm/pipeline/ReconstructionEngine.hpp>
 #include <aliceVision/sfm/pipeline/structureFromKnownPoses/StructureEstimationFromKnownPoses.hpp>
 #include <aliceVision/matching/matchesFiltering.hpp>
@@ -23,10 +24,12 @@
 #include <aliceVision/matchingImageCollection/GeometricFilterMatrix_E_AC.hpp>
 #include <aliceVision/matchingImageCollection/GeometricFilterMatrix_H_AC.hpp>
 #include <aliceVision/matchingImageCollection/GeometricFilterMatrix_HGrowing.hpp>
+#include <aliceVision/matchingImageCollection/GeometricFilterKVLD.hpp>
 #include <aliceVision/matchingImageCollection/GeometricFilterType.hpp>
 #include <aliceVision/matchingImageCollection/ImagePairListIO.hpp>
 #include <aliceVision/matching/pairwiseAdjacencyDisplay.hpp>
 #include <aliceVision/matching/io.hpp>
+#include <aliceVision/gpu/gpu.hpp>
 #include <aliceVision/system/main.hpp>
 #include <aliceVision/system/Timer.hpp>
 #include <aliceVision/system/cmdline.hpp>
@@ -39,11 +42,12 @@
 #include <cstdlib>
 #include <fstream>
 #include <cctype>
+#include <mutex>
 
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 9
 
 using namespace aliceVision;
 using namespace aliceVision::camera;
@@ -110,14 +114,20 @@ int aliceVision_main(int argc, char **argv)
   bool guidedMatching = false;
   bool crossMatching = false;
   int maxIteration = 2048;
+  bool ransacBailOut = false;
+  bool ransacProsac = false;
+  std::size_t ransacBatchSize = 1;
   bool matchFilePerImage = false;
   size_t numMatchesToKeep = 0;
   bool useGridSort = true;
   bool exportDebugFiles = false;
   bool matchFromKnownCameraPoses = false;
-  const std::string fileExtension = "txt";
+  std::string fileExtension = "txt";
   int randomSeed = std::mt19937::default_seed;
   double minRequired2DMotion = -1.0;
+  std::size_t maxRegionsMemory = 0;
+  bool useHashedDescriptionsCache = false;
+  std::size_t kvldMaxNeighbors = 20;
 
   po::options_description requiredParams("Required parameters");
   requiredParams.add_options()
@@ -135,7 +145,7 @@ int aliceVision_main(int argc, char **argv)
     ("describerTypes,d", po::value<std::string>(&describerTypesName)->default_value(describerTypesName),
       feature::EImageDescriberType_informations().c_str())
     ("imagePairsList,l", po::value<std::vector<std::string>>(&predefinedPairList)->multitoken(),
-      "Path(s) to one or more files which contain the list of image pairs to match.")
+      "Path(s) to one or more files which contain the list of image pairs to match (text or binary lists).")
     ("photometricMatchingMethod,p", po::value<std::string>(&nearestMatchingMethod)->default_value(nearestMatchingMethod),
       "For Scalar based regions descriptor:\n"
       "* BRUTE_FORCE_L2: L2 BruteForce matching\n"
@@ -143,6 +153,9 @@ int aliceVision_main(int argc, char **argv)
       "* CASCADE_HASHING_L2: L2 Cascade Hashing matching\n"
       "* FAST_CASCADE_HASHING_L2: L2 Cascade Hashing with precomputed hashed regions\n"
       "(faster than CASCADE_HASHING_L2 but use more memory)\n"
+      "* GPU_BRUTE_FORCE_L2: L2 BruteForce matching on the GPU (requires CUDA)\n"
+      "* PRODUCT_QUANTIZATION_L2: L2 matching on PCA-reduced and product quantized descriptors "
+      "(approximated distances, 16 bytes per descriptor)\n"
       "For Binary based descriptor:\n"
       "* BRUTE_FORCE_HAMMING: BruteForce Hamming matching")
     ("geometricEstimator", po::value<robustEstimation::ERobustEstimator>(&geometricEstimator)->default_value(geometricEstimator),
@@ -166,10 +179,27 @@ int aliceVision_main(int argc, char **argv)
       "Make sure that the matching process is symmetric (same matches for I->J than fo J->I).")
     ("matchFilePerImage", po::value<bool>(&matchFilePerImage)->default_value(matchFilePerImage),
       "Save matches in a separate file per image.")
+    ("matchFileFormat", po::value<std::string>(&fileExtension)->default_value(fileExtension),
+      "File format of the output matches:\n"
+      "* txt: text file\n"
+      "* bin: binary file with a pair index (faster to load, pairs can be loaded partially)")
     ("distanceRatio", po::value<float>(&distRatio)->default_value(distRatio),
       "Distance ratio to discard non meaningful matches.")
     ("maxIteration", po::value<int>(&maxIteration)->default_value(maxIteration),
       "Maximum number of iterations allowed in ransac step.")
+    ("kvldMaxNeighbors", po::value<std::size_t>(&kvldMaxNeighbors)->default_value(kvldMaxNeighbors),
+      "With the kvld geometric filter, number of nearest neighbor matches verified for each match "
+      "(0 for all the matches in the KVLD range, slow on dense matches).")
+    ("ransacBailOut", po::value<bool>(&ransacBailOut)->default_value(ransacBailOut),
+      "Reject early the models which are unlikely to beat the best one in the A Contrario ransac, "
+      "from their errors on a subset of the matches.")
+    ("ransacProsac", po::value<bool>(&ransacProsac)->default_value(ransacProsac),
+      "Sample progressively the matches from the smallest distance ratio in the ransac (PROSAC), "
+      "to find a good model in fewer iterations.")
+    ("ransacBatchSize", po::value<std::size_t>(&ransacBatchSize)->default_value(ransacBatchSize),
+      "Number of hypotheses estimated and scored in parallel in each LO_RANSAC iteration of the fundamental matrix filter. "
+      "The threads are only used when a single pair is filtered, the pairs are otherwise filtered in parallel. "
+      "The result depends on this value but not on the number of threads.")
     ("useGridSort", po::value<bool>(&useGridSort)->default_value(useGridSort),
       "Use matching grid sort.")
     ("minRequired2DMotion", po::value<double>(&minRequired2DMotion)->default_value(minRequired2DMotion),
@@ -178,8 +208,16 @@ int aliceVision_main(int argc, char **argv)
       "Export debug files (svg, dot).")
     ("maxMatches", po::value<std::size_t>(&numMatchesToKeep)->default_value(numMatchesToKeep),
       "Maximum number pf matches to keep.")
+    ("maxRegionsMemory", po::value<std::size_t>(&maxRegionsMemory)->default_value(maxRegionsMemory),
+      "Maximum memory (in MB) used by the descriptors during the photometric matching. "
+      "Descriptors are loaded when the first pair of a view is scheduled and released once all its pairs are matched. "
+      "The pairs are reordered to maximize the reuse of the loaded views. "
+      "0 loads all the descriptors upfront. Ignored with guided matching (descriptors are needed until the end).")
+    ("useHashedDescriptionsCache", po::value<bool>(&useHashedDescriptionsCache)->default_value(useHashedDescriptionsCache),
+      "With FAST_CASCADE_HASHING_L2, save the hashed descriptors next to the descriptors files "
+      "and reuse them in the other chunks and later runs. Needs a fixed random seed.")
     ("rangeStart", po::value<int>(&rangeStart)->default_value(rangeStart),
-      "Range image index start.")
+      "Range image index start (pair index start with binary image pairs lists).")
     ("rangeSize", po::value<int>(&rangeSize)->default_value(rangeSize),
       "Range size.")
     ("randomSeed", po::value<int>(&randomSeed)->default_value(randomSeed),
@@ -199,6 +237,12 @@ int aliceVision_main(int argc, char **argv)
       return EXIT_FAILURE;
   }
 
+  if(fileExtension != "txt" && fileExtension != "bin")
+  {
+    ALICEVISION_LOG_ERROR("Invalid match file format: " << fileExtension);
+    return EXIT_FAILURE;
+  }
+
   const double defaultLoRansacMatchingError = 20.0;
   if(!adjustRobustEstimatorThreshold(geometricEstimator, geometricErrorMax, defaultLoRansacMatchingError))
     return EXIT_FAILURE;
@@ -281,75 +325,148 @@ int aliceVision_main(int argc, char **argv)
 
   // allocate the right Matcher according the Matching requested method
   EMatcherType collectionMatcherType = EMatcherType_stringToEnum(nearestMatchingMethod);
+
+  if(collectionMatcherType == EMatcherType::GPU_BRUTE_FORCE_L2)
+  {
+    ALICEVISION_LOG_INFO(gpu::gpuInformationCUDA());
+
+    // the GPU matcher relies on warp shuffle instructions
+    if(!gpu::gpuSupportCUDA(3,0))
+    {
+      ALICEVISION_LOG_ERROR("The " << nearestMatchingMethod << " matcher needs a CUDA-Enabled GPU (with at least compute capability 3.0).");
+      return EXIT_FAILURE;
+    }
+  }
+
   std::unique_ptr<IImageCollectionMatcher> imageCollectionMatcher = createImageCollectionMatcher(collectionMatcherType, distRatio, crossMatching);
 
+  if(useHashedDescriptionsCache)
+  {
+    if(collectionMatcherType != EMatcherType::FAST_CASCADE_HASHING_L2)
+    {
+      ALICEVISION_LOG_WARNING("Option useHashedDescriptionsCache is only used with FAST_CASCADE_HASHING_L2.");
+    }
+    else if(randomSeed == -1)
+    {
+      ALICEVISION_LOG_WARNING("Option useHashedDescriptionsCache is ignored with a random seed.");
+    }
+    else
+    {
+      dynamic_cast<matchingImageCollection::ImageCollectionMatcher_cascadeHashing&>(*imageCollectionMatcher)
+        .setHashedDescriptionsCache(featuresFolders, static_cast<std::uint32_t>(randomSeed));
+    }
+  }
+
   const std::vector<feature::EImageDescriberType> describerTypes = feature::EImageDescriberType_stringToEnums(describerTypesName);
 
   ALICEVISION_LOG_INFO("There are " << sfmData.getViews().size() << " views and " << pairs.size() << " image pairs.");
 
-  ALICEVISION_LOG_INFO("Load features and descriptors");
+  const bool useLazyRegions = (maxRegionsMemory > 0 && !guidedMatching);
+  if(maxRegionsMemory > 0 && guidedMatching)
+    ALICEVISION_LOG_WARNING("Option maxRegionsMemory is ignored with guided matching.");
 
-  // load the corresponding view regions
   RegionsPerView regionPerView;
-  if(!sfm::loadRegionsPerView(regionPerView, sfmData, featuresFolders, describerTypes, filter))
+  if(!useLazyRegions)
   {
-    ALICEVISION_LOG_ERROR("Invalid regions in '" + sfmDataFilename + "'");
-    return EXIT_FAILURE;
+    ALICEVISION_LOG_INFO("Load features and descriptors");
+
+    // load the corresponding view regions
+    if(!sfm::loadRegionsPerView(regionPerView, sfmData, featuresFolders, describerTypes, filter))
+    {
+      ALICEVISION_LOG_ERROR("Invalid regions in '" + sfmDataFilename + "'");
+      return EXIT_FAILURE;
+    }
   }
 
   // perform the matching
   system::Timer timer;
-  PairSet pairsPoseKnown;
-  PairSet pairsPoseUnknown;
+  sfm::StructureEstimationFromKnownPoses structureEstimator;
 
-  if(matchFromKnownCameraPoses)
+  const auto computePutativeMatches = [&](const PairSet& pairsToMatch, const RegionsPerView& regionsPerView)
   {
-      for(const auto& p: pairs)
-      {
-        if(sfmData.isPoseAndIntrinsicDefined(p.first) && sfmData.isPoseAndIntrinsicDefined(p.second))
+    ALICEVISION_PROFILE_ZONE("putativeMatching");
+
+    PairSet pairsPoseKnown;
+    PairSet pairsPoseUnknown;
+
+    if(matchFromKnownCameraPoses)
+    {
+        for(const auto& p: pairsToMatch)
         {
-            pairsPoseKnown.insert(p);
+          if(sfmData.isPoseAndIntrinsicDefined(p.first) && sfmData.isPoseAndIntrinsicDefined(p.second))
+          {
+              pairsPoseKnown.insert(p);
+          }
+          else
+          {
+              pairsPoseUnknown.insert(p);
+          }
         }
-        else
+    }
+    else
+    {
+        pairsPoseUnknown = pairsToMatch;
+    }
+
+    if(!pairsPoseKnown.empty())
+    {
+      // compute matches from known camera poses when you have an initialization on the camera poses
+      ALICEVISION_LOG_INFO("Putative matches from known poses: " << pairsPoseKnown.size() << " image pairs.");
+
+      structureEstimator.match(sfmData, pairsPoseKnown, regionsPerView, knownPosesGeometricErrorMax);
+    }
+
+    if(!pairsPoseUnknown.empty())
+    {
+        ALICEVISION_LOG_INFO("Putative matches (unknown poses): " << pairsPoseUnknown.size() << " image pairs.");
+        // match feature descriptors between them without geometric notion
+
+        for(const feature::EImageDescriberType descType : describerTypes)
         {
-            pairsPoseUnknown.insert(p);
+          assert(descType != feature::EImageDescriberType::UNINITIALIZED);
+          ALICEVISION_LOG_INFO(EImageDescriberType_enumToString(descType) + " Regions Matching");
+
+          // photometric matching of putative pairs
+          imageCollectionMatcher->Match(randomNumberGenerator, regionsPerView, pairsPoseUnknown, descType, mapPutativesMatches);
         }
-      }
-  }
-  else
-  {
-      pairsPoseUnknown = pairs;
-  }
+    }
+  };
 
-  if(!pairsPoseKnown.empty())
+  if(useLazyRegions)
   {
-    // compute matches from known camera poses when you have an initialization on the camera poses
-    ALICEVISION_LOG_INFO("Putative matches from known poses: " << pairsPoseKnown.size() << " image pairs.");
-
-    sfm::StructureEstimationFromKnownPoses structureEstimator;
-    structureEstimator.match(sfmData, pairsPoseKnown, regionPerView, knownPosesGeometricErrorMax);
-    mapPutativesMatches = structureEstimator.getPutativesMatches();
-  }
+    ALICEVISION_LOG_INFO("Load features and descriptors on demand (max descriptors memory: " << maxRegionsMemory << " MB)");
 
-  if(!pairsPoseUnknown.empty())
-  {
-      ALICEVISION_LOG_INFO("Putative matches (unknown poses): " << pairsPoseUnknown.size() << " image pairs.");
-      // match feature descriptors between them without geometric notion
+    sfm::LazyRegionsPerView lazyRegionsPerView(sfmData, featuresFolders, describerTypes, maxRegionsMemory * 1024 * 1024);
+    lazyRegionsPerView.setPairs(matchingImageCollection::reorderPairsForLocality(pairs));
 
-      for(const feature::EImageDescriberType descType : describerTypes)
+    try
+    {
+      PairSet batch;
+      while(lazyRegionsPerView.loadNextBatch(batch))
       {
-        assert(descType != feature::EImageDescriberType::UNINITIALIZED);
-        ALICEVISION_LOG_INFO(EImageDescriberType_enumToString(descType) + " Regions Matching");
-
-        // photometric matching of putative pairs
-        imageCollectionMatcher->Match(randomNumberGenerator, regionPerView, pairsPoseUnknown, descType, mapPutativesMatches);
-
-        // TODO: DELI
-        // if(!guided_matching) regionPerView.clearDescriptors()
+        computePutativeMatches(batch, lazyRegionsPerView.getRegionsPerView());
+        lazyRegionsPerView.releaseBatch(batch);
       }
+    }
+    catch(const std::exception& e)
+    {
+      ALICEVISION_LOG_ERROR("Invalid regions in '" + sfmDataFilename + "': " << e.what());
+      return EXIT_FAILURE;
+    }
 
+    ALICEVISION_LOG_INFO("Peak descriptors memory: " << (lazyRegionsPerView.getPeakDescriptorsMemory() / (1024 * 1024)) << " MB");
+
+    // the features are kept for the geometric filtering
+    regionPerView.getData() = std::move(lazyRegionsPerView.getRegionsPerView().getData());
+  }
+  else
+  {
+    computePutativeMatches(pairs, regionPerView);
   }
 
+  for(const auto& knownPosesMatches : structureEstimator.getPutativesMatches())
+    mapPutativesMatches[knownPosesMatches.first] = knownPosesMatches.second;
+
   filterMatchesByMin2DMotion(mapPutativesMatches, regionPerView, minRequired2DMotion);
 
   if(mapPutativesMatches.empty())
@@ -426,9 +543,50 @@ int aliceVision_main(int argc, char **argv)
   //    - Use an upper bound for the a contrario estimated threshold
 
   timer.reset();
-  
 
-  matching::PairwiseMatches geometricMatches;
+  // the matches are grid filtered and written as soon as the geometric filter is done for each pair,
+  // they are only kept all in memory for the statistics
+#ifdef ALICEVISION_DEBUG_MATCHING
+  const bool keepFinalMatches = true;
+#else
+  const bool keepFinalMatches = exportDebugFiles;
+#endif
+  PairwiseMatches finalMatches;
+  std::mutex finalMatchesMutex;
+  matching::PairwiseMatchesWriter matchesWriter(getImagePairs(mapPutativesMatches), matchesFolder, fileExtension, matchFilePerImage, filePrefix);
+
+  // essential matrix filtering also removes the pairs with a poor overlap
+  const bool removePoorlyOverlappingPairs = (geometricFilterType == EGeometricFilterType::ESSENTIAL_MATRIX);
+
+  const auto onPairFiltered = [&](const Pair& imagePair, MatchesPerDescType& geometricMatches)
+  {
+    PairwiseMatches pairMatches;
+    if(!geometricMatches.empty() &&
+       !(removePoorlyOverlappingPairs && matchingImageCollection::isPoorlyOverlappingImagePair(geometricMatches, mapPutativesMatches.at(imagePair), 0.3f, 50)))
+    {
+      ALICEVISION_LOG_INFO("\t- image pair (" + std::to_string(imagePair.first) + ", " + std::to_string(imagePair.second) + ") contains " + std::to_string(geometricMatches.getNbAllMatches()) + " geometric matches.");
+
+      // grid filtering
+      PairwiseMatches pairGeometricMatches;
+      pairGeometricMatches.emplace(imagePair, std::move(geometricMatches));
+      matchesGridFilteringForAllPairs(pairGeometricMatches, sfmData, regionPerView, useGridSort,
+                                      numMatchesToKeep, pairMatches);
+    }
+
+    MatchesPerDescType pairFinalMatches;
+    if(!pairMatches.empty())
+    {
+      pairFinalMatches = std::move(pairMatches.begin()->second);
+      ALICEVISION_LOG_INFO("\t- image pair (" << imagePair.first << ", " << imagePair.second << ") contains "
+                           << pairFinalMatches.getNbAllMatches() << " geometric matches after grid filtering.");
+      if(keepFinalMatches)
+      {
+        std::lock_guard<std::mutex> lock(finalMatchesMutex);
+        finalMatches.emplace(imagePair, pairFinalMatches);
+      }
+    }
+    matchesWriter.add(imagePair, std::move(pairFinalMatches));
+  };
 
   ALICEVISION_LOG_INFO("Geometric filtering: using " << matchingImageCollection::EGeometricFilterType_enumToString(geometricFilterType));
 
@@ -436,15 +594,21 @@ int aliceVision_main(int argc, char **argv)
   {
 
     case EGeometricFilterType::NO_FILTERING:
-      geometricMatches = mapPutativesMatches;
+    {
+      for(const auto& putativeMatches : mapPutativesMatches)
+      {
+        MatchesPerDescType geometricMatches = putativeMatches.second;
+        onPairFiltered(putativeMatches.first, geometricMatches);
+      }
+    }
     break;
 
     case EGeometricFilterType::FUNDAMENTAL_MATRIX:
     {
-      matchingImageCollection::robustModelEstimation(geometricMatches,
+      matchingImageCollection::robustModelEstimation(onPairFiltered,
         &sfmData,
         regionPerView,
-        GeometricFilterMatrix_F_AC(geometricErrorMax, maxIteration, geometricEstimator),
+        GeometricFilterMatrix_F_AC(geometricErrorMax, maxIteration, geometricEstimator, false, ransacBailOut, ransacProsac, ransacBatchSize),
         mapPutativesMatches,
         randomNumberGenerator,
         guidedMatching);
@@ -453,10 +617,10 @@ int aliceVision_main(int argc, char **argv)
 
   case EGeometricFilterType::FUNDAMENTAL_WITH_DISTORTION:
   {
-    matchingImageCollection::robustModelEstimation(geometricMatches,
+    matchingImageCollection::robustModelEstimation(onPairFiltered,
       &sfmData,
       regionPerView,
-      GeometricFilterMatrix_F_AC(geometricErrorMax, maxIteration, geometricEstimator, true),
+      GeometricFilterMatrix_F_AC(geometricErrorMax, maxIteration, geometricEstimator, true, ransacBailOut, ransacProsac, ransacBatchSize),
       mapPutativesMatches,
       randomNumberGenerator,
       guidedMatching);
@@ -465,25 +629,23 @@ int aliceVision_main(int argc, char **argv)
 
     case EGeometricFilterType::ESSENTIAL_MATRIX:
     {
-      matchingImageCollection::robustModelEstimation(geometricMatches,
+      matchingImageCollection::robustModelEstimation(onPairFiltered,
         &sfmData,
         regionPerView,
-        GeometricFilterMatrix_E_AC(geometricErrorMax, maxIteration),
+        GeometricFilterMatrix_E_AC(geometricErrorMax, maxIteration, ransacBailOut, ransacProsac),
         mapPutativesMatches,
         randomNumberGenerator,
         guidedMatching);
-
-      removePoorlyOverlappingImagePairs(geometricMatches, mapPutativesMatches, 0.3f, 50);
     }
     break;
 
     case EGeometricFilterType::HOMOGRAPHY_MATRIX:
     {
       const bool onlyGuidedMatching = true;
-      matchingImageCollection::robustModelEstimation(geometricMatches,
+      matchingImageCollection::robustModelEstimation(onPairFiltered,
         &sfmData,
         regionPerView,
-        GeometricFilterMatrix_H_AC(geometricErrorMax, maxIteration),
+        GeometricFilterMatrix_H_AC(geometricErrorMax, maxIteration, ransacBailOut, ransacProsac),
         mapPutativesMatches, randomNumberGenerator, guidedMatching,
         onlyGuidedMatching ? -1.0 : 0.6);
     }
@@ -491,7 +653,7 @@ int aliceVision_main(int argc, char **argv)
 
     case EGeometricFilterType::HOMOGRAPHY_GROWING:
     {
-      matchingImageCollection::robustModelEstimation(geometricMatches,
+      matchingImageCollection::robustModelEstimation(onPairFiltered,
         &sfmData,
         regionPerView,
         GeometricFilterMatrix_HGrowing(geometricErrorMax, maxIteration),
@@ -500,31 +662,21 @@ int aliceVision_main(int argc, char **argv)
         guidedMatching);
     }
     break;
-  }
 
-  ALICEVISION_LOG_INFO(std::to_string(geometricMatches.size()) + " geometric image pair matches:");
-  for(const auto& matchGeo: geometricMatches)
-    ALICEVISION_LOG_INFO("\t- image pair (" + std::to_string(matchGeo.first.first) + ", " + std::to_string(matchGeo.first.second) + ") contains " + std::to_string(matchGeo.second.getNbAllMatches()) + " geometric matches.");
-
-  // grid filtering
-  ALICEVISION_LOG_INFO("Grid filtering");
-
-  PairwiseMatches finalMatches;
-  matchesGridFilteringForAllPairs(geometricMatches, sfmData, regionPerView, useGridSort,
-                                  numMatchesToKeep, finalMatches);
-
-    ALICEVISION_LOG_INFO("After grid filtering:");
-    for (const auto& matchGridFiltering: finalMatches)
+    case EGeometricFilterType::KVLD:
     {
-        ALICEVISION_LOG_INFO("\t- image pair (" << matchGridFiltering.first.first << ", "
-                             << matchGridFiltering.first.second << ") contains "
-                             << matchGridFiltering.second.getNbAllMatches()
-                             << " geometric matches.");
+      matchingImageCollection::kvldFiltering(onPairFiltered,
+        sfmData,
+        regionPerView,
+        mapPutativesMatches,
+        kvldMaxNeighbors);
     }
+    break;
+  }
 
-  // export geometric filtered matches
-  ALICEVISION_LOG_INFO("Save geometric matches.");
-  Save(finalMatches, matchesFolder, fileExtension, matchFilePerImage, filePrefix);
+  // export the geometric filtered matches left
+  matchesWriter.finish();
+  ALICEVISION_LOG_INFO(matchesWriter.getNbWrittenPairs() << " geometric image pair matches saved.");
   ALICEVISION_LOG_INFO("Task done in (s): " + std::to_string(timer.elapsed()));
 
   // d. Export some statistics
@@ -552,7 +704,7 @@ int aliceVision_main(int argc, char **argv)
 #ifdef ALICEVISION_DEBUG_MATCHING
   {
     ALICEVISION_LOG_DEBUG("GEOMETRIC");
-    getStatsMap(geometricMatches);
+    getStatsMap(finalMatches);
   }
 #endif
 
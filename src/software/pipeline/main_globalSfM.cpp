@@ -23,7 +23,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 2
 
 using namespace aliceVision;
 
@@ -46,6 +46,8 @@ int aliceVision_main(int argc, char **argv)
   sfm::ERotationAveragingMethod rotationAveragingMethod = sfm::ROTATION_AVERAGING_L2;
   sfm::ETranslationAveragingMethod translationAveragingMethod = sfm::TRANSLATION_AVERAGING_SOFTL1;
   bool lockAllIntrinsics = false;
+  bool useGPUBundleAdjustment = false;
+  std::size_t partitionedBAMaxNbPoses = 0;
   int randomSeed = std::mt19937::default_seed;
 
   po::options_description requiredParams("Required parameters");
@@ -77,6 +79,10 @@ int aliceVision_main(int argc, char **argv)
       "* 3: L1 soft minimization")
     ("lockAllIntrinsics", po::value<bool>(&lockAllIntrinsics)->default_value(lockAllIntrinsics),
       "Force lock of all camera intrinsic parameters, so they will not be refined during Bundle Adjustment.")
+    ("useGPUBA", po::value<bool>(&useGPUBundleAdjustment)->default_value(useGPUBundleAdjustment),
+      "Solve the bundle adjustment linear systems on the GPU (requires Ceres built with CUDA support).")
+    ("partitionedBAMaxNbPoses", po::value<std::size_t>(&partitionedBAMaxNbPoses)->default_value(partitionedBAMaxNbPoses),
+      "Split the bundle adjustments of scenes with more poses than this value into overlapping clusters adjusted in parallel (0 to disable).")
     ("randomSeed", po::value<int>(&randomSeed)->default_value(randomSeed),
       "This seed value will generate a sequence using a linear random generator. Set -1 to use a random seed.")
     ;
@@ -169,6 +175,8 @@ int aliceVision_main(int argc, char **argv)
 
   // configure reconstruction parameters
   sfmEngine.setLockAllIntrinsics(lockAllIntrinsics); // TODO: rename param
+  sfmEngine.setUseGPUBundleAdjustment(useGPUBundleAdjustment);
+  sfmEngine.setPartitionedBundleAdjustment(partitionedBAMaxNbPoses);
 
   // configure motion averaging method
   sfmEngine.SetRotationAveragingMethod(sfm::ERotationAveragingMethod(rotationAveragingMethod));
@@ -0,0 +1,203 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfmDataIO/sfmDataIO.hpp>
+#include <aliceVision/sfm/pipeline/regionsIO.hpp>
+#include <aliceVision/feature/imageDescriberCommon.hpp>
+#include <aliceVision/sfm/generateReport.hpp>
+#include <aliceVision/sfm/pipeline/hierarchical/ReconstructionEngine_hierarchicalSfM.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/main.hpp>
+#include <aliceVision/system/cmdline.hpp>
+
+#include <boost/program_options.hpp>
+#include <boost/filesystem.hpp>
+
+#include <cstdlib>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+
+namespace po = boost::program_options;
+namespace fs = boost::filesystem;
+
+int aliceVision_main(int argc, char **argv)
+{
+  // command-line parameters
+  std::string sfmDataFilepath;
+  std::vector<std::string> featuresFolders;
+  std::vector<std::string> matchesFolders;
+  std::string extraInfoFolder;
+  std::string outputSfMViewsAndPoses;
+
+  // user optional parameters
+
+  std::string outSfMDataFilepath = "SfmData.json";
+  std::string describerTypesName = feature::EImageDescriberType_enumToString(feature::EImageDescriberType::SIFT);
+  sfm::ReconstructionEngine_hierarchicalSfM::Params params;
+  sfm::ReconstructionEngine_sequentialSfM::Params& sfmParams = params.sfmParams;
+  bool computeStructureColor = true;
+  int randomSeed = std::mt19937::default_seed;
+
+  po::options_description requiredParams("Required parameters");
+  requiredParams.add_options()
+    ("input,i", po::value<std::string>(&sfmDataFilepath)->required(),
+      "SfMData file.")
+    ("output,o", po::value<std::string>(&outSfMDataFilepath)->required(),
+      "Path to the output SfMData file.")
+    ("featuresFolders,f", po::value<std::vector<std::string>>(&featuresFolders)->multitoken()->required(),
+      "Path to folder(s) containing the extracted features.")
+    ("matchesFolders,m", po::value<std::vector<std::string>>(&matchesFolders)->multitoken()->required(),
+      "Path to folder(s) in which computed matches are stored.")
+    ;
+
+  po::options_description optionalParams("Optional parameters");
+  optionalParams.add_options()
+    ("outputViewsAndPoses", po::value<std::string>(&outputSfMViewsAndPoses)->default_value(outputSfMViewsAndPoses),
+      "Path to the output SfMData file (with only views and poses).")
+    ("extraInfoFolder", po::value<std::string>(&extraInfoFolder)->default_value(extraInfoFolder),
+      "Folder for the cluster reconstructions and additional reconstruction information files.")
+    ("describerTypes,d", po::value<std::string>(&describerTypesName)->default_value(describerTypesName),
+      feature::EImageDescriberType_informations().c_str())
+    ("maxNbViewsPerCluster", po::value<std::size_t>(&params.maxNbViewsPerCluster)->default_value(params.maxNbViewsPerCluster),
+      "Maximum number of views of a cluster, without the views shared with the neighbor clusters.")
+    ("clusterOverlapRatio", po::value<double>(&params.overlapRatio)->default_value(params.overlapRatio),
+      "Number of neighbor views added to a cluster to merge it, relative to its number of views.")
+    ("minNbCommonCameras", po::value<std::size_t>(&params.minNbCommonCameras)->default_value(params.minNbCommonCameras),
+      "Minimum number of cameras shared by a cluster and the merged scene to merge it.")
+    ("clusterIndex", po::value<int>(&params.clusterIndex)->default_value(params.clusterIndex),
+      "Only reconstruct this cluster and write it in the extraInfoFolder, to distribute the clusters over several processes. "
+      "The run with -1 reuses the written clusters, reconstructs the other ones and merges all of them.")
+    ("minInputTrackLength", po::value<int>(&sfmParams.minInputTrackLength)->default_value(sfmParams.minInputTrackLength),
+      "Minimum track length in input of SfM.")
+    ("minAngleForTriangulation", po::value<double>(&sfmParams.minAngleForTriangulation)->default_value(sfmParams.minAngleForTriangulation),
+      "Minimum angle for triangulation.")
+    ("minAngleForLandmark", po::value<double>(&sfmParams.minAngleForLandmark)->default_value(sfmParams.minAngleForLandmark),
+      "Minimum angle for landmark.")
+    ("maxReprojectionError", po::value<double>(&sfmParams.maxReprojectionError)->default_value(sfmParams.maxReprojectionError),
+      "Maximum reprojection error.")
+    ("lockAllIntrinsics", po::value<bool>(&sfmParams.lockAllIntrinsics)->default_value(sfmParams.lockAllIntrinsics),
+      "Force lock of all camera intrinsic parameters, so they will not be refined during Bundle Adjustment.")
+    ("useLocalBA,l", po::value<bool>(&sfmParams.useLocalBundleAdjustment)->default_value(sfmParams.useLocalBundleAdjustment),
+      "Enable/Disable the Local bundle adjustment strategy in the cluster reconstructions.")
+    ("useGPUBA", po::value<bool>(&sfmParams.useGPUBundleAdjustment)->default_value(sfmParams.useGPUBundleAdjustment),
+      "Solve the bundle adjustment linear systems on the GPU (requires Ceres built with CUDA support).")
+    ("partitionedBAMaxNbPoses", po::value<std::size_t>(&sfmParams.partitionedBundleAdjustmentMaxNbPoses)->default_value(sfmParams.partitionedBundleAdjustmentMaxNbPoses),
+      "Split the bundle adjustments of scenes with more poses than this value into overlapping clusters adjusted in parallel (0 to disable).")
+    ("computeStructureColor", po::value<bool>(&computeStructureColor)->default_value(computeStructureColor),
+      "Compute each 3D point color.\n")
+    ("randomSeed", po::value<int>(&randomSeed)->default_value(randomSeed),
+      "This seed value will generate a sequence using a linear random generator. Set -1 to use a random seed.")
+    ;
+
+  CmdLine cmdline("Hierarchical reconstruction.\n"
+                  "This program splits the view graph into overlapping clusters, reconstructs them with the incremental SfM "
+                  "and merges them before a global bundle adjustment.\n"
+                  "AliceVision hierarchicalSfM");
+
+  cmdline.add(requiredParams);
+  cmdline.add(optionalParams);
+  if (!cmdline.execute(argc, argv))
+  {
+      return EXIT_FAILURE;
+  }
+
+  // set maxThreads
+  HardwareContext hwc = cmdline.getHardwareContext();
+  hwc.setupThreads();
+
+  // load input SfMData scene
+  sfmData::SfMData sfmData;
+  if(!sfmDataIO::Load(sfmData, sfmDataFilepath, sfmDataIO::ESfMData(sfmDataIO::VIEWS|sfmDataIO::INTRINSICS)))
+  {
+    ALICEVISION_LOG_ERROR("The input SfMData file '" << sfmDataFilepath << "' cannot be read.");
+    return EXIT_FAILURE;
+  }
+
+  if(!sfmData.getRigs().empty())
+  {
+    ALICEVISION_LOG_ERROR("Rigs are not currently supported in Hierarchical SfM." << std::endl << "Please use Incremental SfM. Aborted");
+    return EXIT_FAILURE;
+  }
+
+  // get describerTypes
+  const std::vector<feature::EImageDescriberType> describerTypes = feature::EImageDescriberType_stringToEnums(describerTypesName);
+
+  // features reading
+  feature::FeaturesPerView featuresPerView;
+  if(!sfm::loadFeaturesPerView(featuresPerView, sfmData, featuresFolders, describerTypes))
+  {
+    ALICEVISION_LOG_ERROR("Invalid features");
+    return EXIT_FAILURE;
+  }
+
+  // matches reading
+  matching::PairwiseMatches pairwiseMatches;
+  if(!sfm::loadPairwiseMatches(pairwiseMatches, sfmData, matchesFolders, describerTypes))
+  {
+    ALICEVISION_LOG_ERROR("Unable to load matches files from: " << matchesFolders);
+    return EXIT_FAILURE;
+  }
+
+  if(extraInfoFolder.empty())
+    extraInfoFolder = fs::path(outSfMDataFilepath).parent_path().string();
+
+  if (!fs::exists(extraInfoFolder))
+    fs::create_directory(extraInfoFolder);
+
+  // hierarchical SfM reconstruction process
+  aliceVision::system::Timer timer;
+  sfm::ReconstructionEngine_hierarchicalSfM sfmEngine(sfmData, params, extraInfoFolder);
+
+  sfmEngine.initRandomSeed(randomSeed);
+
+  // configure the featuresPerView & the matches_provider
+  sfmEngine.setFeatures(&featuresPerView);
+  sfmEngine.setMatches(&pairwiseMatches);
+
+  if(!sfmEngine.process())
+    return EXIT_FAILURE;
+
+  // get the color for the 3D points
+  if(computeStructureColor)
+    sfmEngine.colorize();
+
+  // set featuresFolders and matchesFolders relative paths
+  {
+    sfmEngine.getSfMData().addFeaturesFolders(featuresFolders);
+    sfmEngine.getSfMData().addMatchesFolders(matchesFolders);
+    sfmEngine.getSfMData().setAbsolutePath(fs::path(outSfMDataFilepath).parent_path().string());
+  }
+
+  ALICEVISION_LOG_INFO("Hierarchical structure from motion took (s): " << timer.elapsed());
+
+  if(params.clusterIndex < 0)
+  {
+    ALICEVISION_LOG_INFO("Generating HTML report...");
+    sfm::generateSfMReport(sfmEngine.getSfMData(), (fs::path(extraInfoFolder) / "sfm_report.html").string());
+  }
+
+  // export to disk computed scene (data & visualizable results)
+  ALICEVISION_LOG_INFO("Export SfMData to disk");
+
+  sfmDataIO::Save(sfmEngine.getSfMData(), outSfMDataFilepath, sfmDataIO::ESfMData::ALL);
+
+  if(!outputSfMViewsAndPoses.empty())
+    sfmDataIO::Save(sfmEngine.getSfMData(), outputSfMViewsAndPoses, sfmDataIO::ESfMData(sfmDataIO::VIEWS|sfmDataIO::EXTRINSICS|sfmDataIO::INTRINSICS));
+
+  ALICEVISION_LOG_INFO("Structure from Motion results:" << std::endl
+    << "\t- # input images: " << sfmEngine.getSfMData().getViews().size() << std::endl
+    << "\t- # cameras calibrated: " << sfmEngine.getSfMData().getPoses().size() << std::endl
+    << "\t- # landmarks: " << sfmEngine.getSfMData().getLandmarks().size());
+
+  return EXIT_SUCCESS;
+}
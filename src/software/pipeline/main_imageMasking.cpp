@@ -12,6 +12,8 @@
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/Timer.hpp>
 #include <aliceVision/system/cmdline.hpp>
+#include <aliceVision/system/main.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <OpenImageIO/imagebuf.h>
 #include <OpenImageIO/imagebufalgo.h>
@@ -20,6 +22,8 @@
 #include <boost/filesystem.hpp>
 #include <boost/algorithm/string/case_conv.hpp> 
 
+#include <exception>
+
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
@@ -78,7 +82,7 @@ inline std::istream& operator>>(std::istream& in, EAlgorithm& s)
 /**
  * @brief Write mask images from input images based on chosen algorithm.
  */
-int main(int argc, char **argv)
+int aliceVision_main(int argc, char **argv)
 {
     // command-line parameters
     std::string sfmFilePath;
@@ -261,121 +265,143 @@ int main(int argc, char **argv)
 
     bool useDepthMap = !depthMapExp.empty() || !depthMapFolder.empty();
 
-    // #pragma omp parallel for
+    // random access to the views of the range
+    std::vector<const sfmData::View*> rangeViews;
+    rangeViews.reserve(size);
+    for(auto it = std::next(viewPairItBegin, rangeStart); rangeViews.size() < static_cast<std::size_t>(size); ++it)
+        rangeViews.push_back(it->second.get());
+
+    // the images are independent, the first error is rethrown after the loop
+    std::exception_ptr error;
+
+    #pragma omp parallel for schedule(dynamic)
     for(int i = 0; i < size; ++i)
     {
-        const auto& item = std::next(viewPairItBegin, rangeStart + i);
-        const IndexT& index = item->first;
-        const sfmData::View& view = *item->second;
-
-        std::string imgPath = view.getImagePath();
-        std::string depthMapPath;
-        if(!depthMapExp.empty())
+        try
         {
-            depthMapPath = depthMapExp;
-            {
-                const auto pos = depthMapPath.find(k_depthMapFolder);
-                if(pos != std::string::npos)
-                    depthMapPath.replace(pos, k_depthMapFolder.size(), depthMapFolder);
-            }
-            {
-                const auto pos = depthMapPath.find(k_inputFolder);
-                if(pos != std::string::npos)
-                    depthMapPath.replace(pos, k_inputFolder.size(), fs::path(imgPath).parent_path().string());
-            }
-            {
-                const auto pos = depthMapPath.find(k_filename);
-                if(pos != std::string::npos)
-                    depthMapPath.replace(pos, k_filename.size(), fs::path(imgPath).filename().string());
-            }
+            const sfmData::View& view = *rangeViews[i];
+            const IndexT index = view.getViewId();
+
+            std::string imgPath = view.getImagePath();
+            std::string depthMapPath;
+            if(!depthMapExp.empty())
             {
-                const auto pos = depthMapPath.find(k_stem);
-                if(pos != std::string::npos)
-                    depthMapPath.replace(pos, k_stem.size(), fs::path(imgPath).stem().string());
+                depthMapPath = depthMapExp;
+                {
+                    const auto pos = depthMapPath.find(k_depthMapFolder);
+                    if(pos != std::string::npos)
+                        depthMapPath.replace(pos, k_depthMapFolder.size(), depthMapFolder);
+                }
+                {
+                    const auto pos = depthMapPath.find(k_inputFolder);
+                    if(pos != std::string::npos)
+                        depthMapPath.replace(pos, k_inputFolder.size(), fs::path(imgPath).parent_path().string());
+                }
+                {
+                    const auto pos = depthMapPath.find(k_filename);
+                    if(pos != std::string::npos)
+                        depthMapPath.replace(pos, k_filename.size(), fs::path(imgPath).filename().string());
+                }
+                {
+                    const auto pos = depthMapPath.find(k_stem);
+                    if(pos != std::string::npos)
+                        depthMapPath.replace(pos, k_stem.size(), fs::path(imgPath).stem().string());
+                }
+                {
+                    const auto pos = depthMapPath.find(k_ext);
+                    if(pos != std::string::npos)
+                        depthMapPath.replace(pos, k_stem.size(), fs::path(imgPath).extension().string().substr(1));
+                }
+                if(!fs::exists(depthMapPath))
+                {
+                    ALICEVISION_LOG_DEBUG("depthMapPath from expression: \"" << depthMapPath << "\" not found.");
+                    depthMapPath.clear();
+                }
+                else
+                {
+                    ALICEVISION_LOG_DEBUG("depthMapPath from expression: \"" << depthMapPath << "\" found.");
+                }
             }
+            else if(!depthMapFolder.empty())
             {
-                const auto pos = depthMapPath.find(k_ext);
-                if(pos != std::string::npos)
-                    depthMapPath.replace(pos, k_stem.size(), fs::path(imgPath).extension().string().substr(1));
+                // Look for View UID
+                fs::path p = fs::path(depthMapFolder) / (std::to_string(view.getViewId()) + fs::path(imgPath).extension().string());
+                if(fs::exists(p))
+                {
+                    depthMapPath = p.string();
+                    ALICEVISION_LOG_DEBUG("depthMapPath found from folder and View UID: \"" << depthMapPath << "\".");
+                }
+                else
+                {
+                    // Look for an image with the same filename
+                    p = fs::path(depthMapFolder) / fs::path(imgPath).filename();
+                    if(fs::exists(p))
+                    {
+                        depthMapPath = p.string();
+                        ALICEVISION_LOG_DEBUG("depthMapPath found from folder and input filename: \"" << depthMapPath << "\".");
+                    }
+                }
             }
-            if(!fs::exists(depthMapPath))
+
+            const std::string p = useDepthMap ? depthMapPath : imgPath;
+            image::Image<unsigned char> result;
+            process(result, p);
+
+            if(invert)
             {
-                ALICEVISION_LOG_DEBUG("depthMapPath from expression: \"" << depthMapPath << "\" not found.");
-                depthMapPath.clear();
+                imageMasking::postprocess_invert(result);
             }
-            else
+            if(growRadius > 0)
             {
-                ALICEVISION_LOG_DEBUG("depthMapPath from expression: \"" << depthMapPath << "\" found.");
+                imageMasking::postprocess_dilate(result, growRadius);
             }
-        }
-        else if(!depthMapFolder.empty())
-        {
-            // Look for View UID
-            fs::path p = fs::path(depthMapFolder) / (std::to_string(view.getViewId()) + fs::path(imgPath).extension().string());
-            if(fs::exists(p))
+            if(shrinkRadius > 0)
             {
-                depthMapPath = p.string();
-                ALICEVISION_LOG_DEBUG("depthMapPath found from folder and View UID: \"" << depthMapPath << "\".");
+                imageMasking::postprocess_erode(result, shrinkRadius);
             }
-            else
+
+            if(useDepthMap)
             {
-                // Look for an image with the same filename
-                p = fs::path(depthMapFolder) / fs::path(imgPath).filename();
-                if(fs::exists(p))
+                bool viewHorizontal = view.getWidth() > view.getHeight();
+                bool depthMapHorizontal = result.Width() > result.Height();
+                if(viewHorizontal != depthMapHorizontal)
                 {
-                    depthMapPath = p.string();
-                    ALICEVISION_LOG_DEBUG("depthMapPath found from folder and input filename: \"" << depthMapPath << "\".");
+                    ALICEVISION_LOG_ERROR("Image " << imgPath << " : " << view.getWidth() << "x" << view.getHeight());
+                    ALICEVISION_LOG_ERROR("Depth Map " << depthMapPath << " : " << result.Width() << "x" << result.Height());
+                    throw std::runtime_error("Depth map orientation is not aligned with source image.");
                 }
-            }
-        }
+                if(view.getWidth() != result.Width())
+                {
+                    ALICEVISION_LOG_DEBUG("Rescale depth map \"" << imgPath << "\" from: " << result.Width() << "x" << result.Height() << ", to: " << view.getWidth() << "x" << view.getHeight());
 
-        const std::string p = useDepthMap ? depthMapPath : imgPath;
-        image::Image<unsigned char> result;
-        process(result, p);
+                    image::Image<unsigned char> rescaled(view.getWidth(), view.getHeight());
 
-        if(invert)
-        {
-            imageMasking::postprocess_invert(result);
-        }
-        if(growRadius > 0)
-        {
-            imageMasking::postprocess_dilate(result, growRadius);
-        }
-        if(shrinkRadius > 0)
-        {
-            imageMasking::postprocess_erode(result, shrinkRadius);
-        }
+                    const oiio::ImageBuf inBuf(oiio::ImageSpec(result.Width(), result.Height(), 1, oiio::TypeDesc::UINT8), result.data());
+                    oiio::ImageBuf outBuf(oiio::ImageSpec(rescaled.Width(), rescaled.Height(), 1, oiio::TypeDesc::UINT8), rescaled.data());
 
-        if(useDepthMap)
-        {
-            bool viewHorizontal = view.getWidth() > view.getHeight();
-            bool depthMapHorizontal = result.Width() > result.Height();
-            if(viewHorizontal != depthMapHorizontal)
-            {
-                ALICEVISION_LOG_ERROR("Image " << imgPath << " : " << view.getWidth() << "x" << view.getHeight());
-                ALICEVISION_LOG_ERROR("Depth Map " << depthMapPath << " : " << result.Width() << "x" << result.Height());
-                throw std::runtime_error("Depth map orientation is not aligned with source image.");
+                    oiio::ImageBufAlgo::resize(outBuf, inBuf);
+
+                    result.swap(rescaled);
+                }
             }
-            if(view.getWidth() != result.Width())
+            const auto resultFilename = fs::path(std::to_string(index)).replace_extension("png");
+            const std::string resultPath = (fs::path(outputFilePath) / resultFilename).string();
+            image::writeImage(resultPath, result,
+                              image::ImageWriteOptions().toColorSpace(image::EImageColorSpace::LINEAR));
+        }
+        catch(...)
+        {
+            #pragma omp critical(imageMaskingError)
             {
-                ALICEVISION_LOG_DEBUG("Rescale depth map \"" << imgPath << "\" from: " << result.Width() << "x" << result.Height() << ", to: " << view.getWidth() << "x" << view.getHeight());
-
-                image::Image<unsigned char> rescaled(view.getWidth(), view.getHeight());
-
-                const oiio::ImageBuf inBuf(oiio::ImageSpec(result.Width(), result.Height(), 1, oiio::TypeDesc::UINT8), result.data());
-                oiio::ImageBuf outBuf(oiio::ImageSpec(rescaled.Width(), rescaled.Height(), 1, oiio::TypeDesc::UINT8), rescaled.data());
-
-                oiio::ImageBufAlgo::resize(outBuf, inBuf);
-
-                result.swap(rescaled);
+                if(!error)
+                    error = std::current_exception();
             }
         }
-        const auto resultFilename = fs::path(std::to_string(index)).replace_extension("png");
-        const std::string resultPath = (fs::path(outputFilePath) / resultFilename).string();
-        image::writeImage(resultPath, result,
-                          image::ImageWriteOptions().toColorSpace(image::EImageColorSpace::LINEAR));
     }
 
+    if(error)
+        std::rethrow_exception(error);
+
     ALICEVISION_LOG_INFO("Task done in (s): " + std::to_string(timer.elapsed()));
     return EXIT_SUCCESS;
 }
@@ -30,7 +30,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 5
 
 using namespace aliceVision;
 using namespace aliceVision::voctree;
@@ -59,12 +59,24 @@ int aliceVision_main(int argc, char** argv)
   std::size_t numImageQuery = 50;
   /// the number of neighbors to retrieve for each image in Sequential Mode
   std::size_t numImageQuerySequential = 50;
+  /// the number of spatial neighbors ranked for each image in SpatialVocabularyTree Mode
+  std::size_t nbSpatialNeighbors = 200;
+  /// the maximum distance to the spatial neighbors in SpatialVocabularyTree Mode
+  double spatialMaxDistance = 0.0;
+  /// the global descriptors settings in GlobalDescriptor Mode
+  GlobalDescriptorParams globalDescriptorParams;
   /// the filename of the voctree
   std::string treeFilepath;
+  std::string wordsCacheFolder;
   /// the filename for the voctree weights
   std::string weightsFilepath;
   /// flag for the optional weights file
   bool withWeights = false;
+  /// the range of the views queried in the vocabulary tree
+  int rangeStart = -1;
+  int rangeSize = 1;
+  /// the pair lists of the chunks to merge
+  std::vector<std::string> inputPairsLists;
 
 
   // multiple SfM parameters
@@ -83,7 +95,7 @@ int aliceVision_main(int argc, char** argv)
     ("featuresFolders,f", po::value<std::vector<std::string>>(&featuresFolders)->multitoken()->required(),
       "Path to folder(s) containing the extracted features.")
     ("output,o", po::value<std::string>(&outputFile)->required(),
-      "Filepath to the output file with the list of selected image pairs.");
+      "Filepath to the output file with the list of selected image pairs (binary list if the extension is '.bin').");
 
   po::options_description optionalParams("Optional parameters");
   optionalParams.add_options()
@@ -94,7 +106,9 @@ int aliceVision_main(int argc, char** argv)
       " * SequentialAndVocabularyTree: combine both previous approaches\n"
       " * Exhaustive: all images combinations\n"
       " * Frustum: images with camera frustum intersection (only for cameras with known poses)\n"
-      " * FrustumOrVocTree: frustum intersection if cameras with known poses else use VocTree.\n")
+      " * FrustumOrVocTree: frustum intersection if cameras with known poses else use VocTree.\n"
+      " * SpatialVocabularyTree: VocabularyTree ranking of the spatial neighbors from GPS metadata or known poses.\n"
+      " * GlobalDescriptor: nearest VLAD descriptors on the vocabulary tree centers, from an HNSW index.\n")
     ("minNbImages", po::value<std::size_t>(&minNbImages)->default_value(minNbImages),
       "Minimal number of images to use the vocabulary tree. If we have less images than this threshold, we will compute all matching combinations.")
     ("maxDescriptors", po::value<std::size_t>(&nbMaxDescriptors)->default_value(nbMaxDescriptors),
@@ -105,11 +119,38 @@ int aliceVision_main(int argc, char** argv)
     ("nbNeighbors", po::value<std::size_t>(&numImageQuerySequential)->default_value(numImageQuerySequential),
       "The number of neighbors to retrieve for each image (If 0 it will "
       "retrieve all the neighbors).")
+    ("nbSpatialNeighbors", po::value<std::size_t>(&nbSpatialNeighbors)->default_value(nbSpatialNeighbors),
+      "The number of nearest views ranked by the vocabulary tree for each image with a position "
+      "in SpatialVocabularyTree mode. Zero means all the views (within spatialMaxDistance).")
+    ("spatialMaxDistance", po::value<double>(&spatialMaxDistance)->default_value(spatialMaxDistance),
+      "The maximum distance to the views ranked by the vocabulary tree in SpatialVocabularyTree mode "
+      "(in meters for GPS positions). Zero means no limit.")
+    ("vladLevel", po::value<uint32_t>(&globalDescriptorParams.vladLevel)->default_value(globalDescriptorParams.vladLevel),
+      "The level of the vocabulary tree centers of the VLAD descriptors in GlobalDescriptor mode, "
+      "0 for the children of the root. The descriptors size is the number of centers times the features size.")
+    ("annNbLinks", po::value<std::size_t>(&globalDescriptorParams.hnsw.nbLinks)->default_value(globalDescriptorParams.hnsw.nbLinks),
+      "The number of links of each image in the HNSW graph of the GlobalDescriptor mode.")
+    ("annEfSearch", po::value<std::size_t>(&globalDescriptorParams.efSearch)->default_value(globalDescriptorParams.efSearch),
+      "The number of images explored by each query of the HNSW index in GlobalDescriptor mode, "
+      "more gives a higher recall but slower queries.")
+    ("annIndexFile", po::value<std::string>(&globalDescriptorParams.indexFile)->default_value(globalDescriptorParams.indexFile),
+      "The HNSW index file of the GlobalDescriptor mode. If it exists, it is loaded and only the new images are indexed, "
+      "then it is saved. Not saved if empty.")
     ("tree,t", po::value<std::string>(&treeFilepath)->default_value(treeFilepath),
       "Input file path of the vocabulary tree. This file can be generated by 'createVoctree'. "
       "This software is intended to be used with a generic, pre-trained vocabulary tree.")
     ("weights,w", po::value<std::string>(&weightsFilepath)->default_value(weightsFilepath),
-      "Input name for the vocabulary tree weight file, if not provided all voctree leaves will have the same weight.");
+      "Input name for the vocabulary tree weight file, if not provided all voctree leaves will have the same weight.")
+    ("wordsCacheFolder", po::value<std::string>(&wordsCacheFolder)->default_value(wordsCacheFolder),
+      "Folder of the cache of the visual words of each descriptor file, reused while the descriptors file "
+      "and the vocabulary tree do not change. Disabled if empty.")
+    ("rangeStart", po::value<int>(&rangeStart)->default_value(rangeStart),
+      "Range image index start. Only the views of the range query the vocabulary tree, "
+      "the pair lists of the chunks are merged with 'inputPairsLists'.")
+    ("rangeSize", po::value<int>(&rangeSize)->default_value(rangeSize),
+      "Range size.")
+    ("inputPairsLists", po::value<std::vector<std::string>>(&inputPairsLists)->multitoken(),
+      "Pair lists of the chunks of a range to merge in the output file, no image is queried.");
 
   po::options_description multiSfMParams("Multiple SfM");
   multiSfMParams.add_options()
@@ -135,6 +176,27 @@ int aliceVision_main(int argc, char** argv)
       return EXIT_FAILURE;
   }
 
+  // merge the pair lists of the chunks, the output does not depend on the chunks order
+  if(!inputPairsLists.empty())
+  {
+    PairVec pairs;
+    for(const std::string& pairsList : inputPairsLists)
+    {
+      if(!matchingImageCollection::loadPairsFromFile(pairsList, pairs))
+      {
+        ALICEVISION_LOG_ERROR("The pair list '" << pairsList << "' cannot be read.");
+        return EXIT_FAILURE;
+      }
+    }
+    if(!matchingImageCollection::savePairsToFile(outputFile, pairs))
+    {
+      ALICEVISION_LOG_ERROR("Unable to write the pair list: " << outputFile);
+      return EXIT_FAILURE;
+    }
+    ALICEVISION_LOG_INFO(pairs.size() << " image pairs of " << inputPairsLists.size() << " lists exported in: " << outputFile);
+    return EXIT_SUCCESS;
+  }
+
   // multiple SfM
   const bool useMultiSfM = !sfmDataFilenameB.empty();
   const EImageMatchingMode matchingMode = EImageMatchingMode_stringToEnum(matchingModeName);
@@ -185,6 +247,30 @@ int aliceVision_main(int argc, char** argv)
           aliceVision::voctree::getListOfDescriptorFiles(sfmDataB, featuresFolders, descriptorsFilesB);
   }
 
+  // set query range
+  std::set<IndexT> queryViewIds;
+  if(rangeStart != -1)
+  {
+    if(rangeStart < 0 || rangeSize < 0 ||
+       rangeStart > sfmDataA.getViews().size())
+    {
+      ALICEVISION_LOG_ERROR("Range is incorrect");
+      return EXIT_FAILURE;
+    }
+
+    if(rangeStart + rangeSize > sfmDataA.getViews().size())
+      rangeSize = sfmDataA.getViews().size() - rangeStart;
+
+    auto itView = sfmDataA.getViews().begin();
+    std::advance(itView, rangeStart);
+    for(int i = 0; i < rangeSize; ++i, ++itView)
+      queryViewIds.insert(itView->first);
+
+    // an empty range still must not query all the views
+    if(queryViewIds.empty())
+      queryViewIds.insert(UndefinedIndexT);
+  }
+
   OrderedPairList selectedPairs;
 
   switch(method)
@@ -207,7 +293,25 @@ int aliceVision_main(int argc, char** argv)
     {
       ALICEVISION_LOG_INFO("Use VOCABULARYTREE matching.");
       conditionVocTree(treeFilepath, withWeights, weightsFilepath, matchingMode,featuresFolders, sfmDataA, nbMaxDescriptors, sfmDataFilenameA, sfmDataB,
-                       sfmDataFilenameB, useMultiSfM, descriptorsFilesA,  numImageQuery, selectedPairs);
+                       sfmDataFilenameB, useMultiSfM, descriptorsFilesA,  numImageQuery, selectedPairs, wordsCacheFolder, queryViewIds);
+      break;
+    }
+    case EImageMatchingMethod::SPATIAL_VOCABULARYTREE:
+    {
+      ALICEVISION_LOG_INFO("Use SPATIAL VOCABULARYTREE matching.");
+      PairList spatialNeighbors;
+      const std::size_t nbPositionedViews = generateSpatialNeighbors(sfmDataA, sfmDataB, nbSpatialNeighbors, spatialMaxDistance, spatialNeighbors);
+      ALICEVISION_LOG_INFO(nbPositionedViews << " of " << sfmDataA.getViews().size()
+                           << " views only rank their spatial neighbors, the others rank all the views.");
+      conditionVocTree(treeFilepath, withWeights, weightsFilepath, matchingMode,featuresFolders, sfmDataA, nbMaxDescriptors, sfmDataFilenameA, sfmDataB,
+                       sfmDataFilenameB, useMultiSfM, descriptorsFilesA,  numImageQuery, selectedPairs, wordsCacheFolder, queryViewIds, spatialNeighbors);
+      break;
+    }
+    case EImageMatchingMethod::GLOBAL_DESCRIPTOR:
+    {
+      ALICEVISION_LOG_INFO("Use GLOBAL DESCRIPTOR matching.");
+      generateFromGlobalDescriptors(treeFilepath, matchingMode, descriptorsFilesA, descriptorsFilesB, nbMaxDescriptors,
+                                    numImageQuery, globalDescriptorParams, selectedPairs, queryViewIds);
       break;
     }
     case EImageMatchingMethod::SEQUENTIAL:
@@ -221,7 +325,7 @@ int aliceVision_main(int argc, char** argv)
       ALICEVISION_LOG_INFO("Use SEQUENTIAL and VOCABULARYTREE matching.");
       generateSequentialMatches(sfmDataA, numImageQuerySequential, selectedPairs);
       conditionVocTree(treeFilepath, withWeights, weightsFilepath, matchingMode,featuresFolders, sfmDataA, nbMaxDescriptors, sfmDataFilenameA, sfmDataB,
-                       sfmDataFilenameB, useMultiSfM, descriptorsFilesA,  numImageQuery, selectedPairs);
+                       sfmDataFilenameB, useMultiSfM, descriptorsFilesA,  numImageQuery, selectedPairs, wordsCacheFolder, queryViewIds);
       break;
     }
     case EImageMatchingMethod::FRUSTUM:
@@ -266,13 +370,14 @@ int aliceVision_main(int argc, char** argv)
   }
 
   // write it to file
-  PairSet selectedPairsSet;
+  PairVec selectedPairsVec;
   for (const auto& imagePairs : selectedPairs) {
       for (const auto& index : imagePairs.second) {
-          selectedPairsSet.emplace(imagePairs.first, index);
+          selectedPairsVec.emplace_back(imagePairs.first, index);
       }
   }
-  matchingImageCollection::savePairsToFile(outputFile, selectedPairsSet);
+  matchingImageCollection::sortAndDeduplicatePairs(selectedPairsVec);
+  matchingImageCollection::savePairsToFile(outputFile, selectedPairsVec);
 
   ALICEVISION_LOG_INFO("pairList exported in: " << outputFile);
 
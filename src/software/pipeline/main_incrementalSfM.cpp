@@ -11,6 +11,7 @@
 #include <aliceVision/sfm/pipeline/regionsIO.hpp>
 #include <aliceVision/feature/imageDescriberCommon.hpp>
 #include <aliceVision/system/Timer.hpp>
+#include <aliceVision/system/Metrics.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/main.hpp>
 #include <aliceVision/system/cmdline.hpp>
@@ -27,7 +28,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 6
 
 using namespace aliceVision;
 
@@ -153,6 +154,21 @@ int aliceVision_main(int argc, char **argv)
       "It reduces the reconstruction time, especially for big datasets (500+ images).")
     ("localBAGraphDistance", po::value<int>(&sfmParams.localBundelAdjustementGraphDistanceLimit)->default_value(sfmParams.localBundelAdjustementGraphDistanceLimit),
       "Graph-distance limit setting the Active region in the Local Bundle Adjustment strategy.")
+    ("useGPUBA", po::value<bool>(&sfmParams.useGPUBundleAdjustment)->default_value(sfmParams.useGPUBundleAdjustment),
+      "Solve the bundle adjustment linear systems on the GPU (requires Ceres built with CUDA support).")
+    ("partitionedBAMaxNbPoses", po::value<std::size_t>(&sfmParams.partitionedBundleAdjustmentMaxNbPoses)->default_value(sfmParams.partitionedBundleAdjustmentMaxNbPoses),
+      "Split the full bundle adjustments of scenes with more poses than this value into overlapping clusters adjusted in parallel (0 to disable).")
+    ("reuseBAProblem", po::value<bool>(&sfmParams.reuseBundleAdjustmentProblem)->default_value(sfmParams.reuseBundleAdjustmentProblem),
+      "Keep the bundle adjustment problem between iterations and only update it with the new/removed cameras, points and observations.")
+    ("slidingWindowSize", po::value<std::size_t>(&sfmParams.slidingWindowSize)->default_value(sfmParams.slidingWindowSize),
+      "For time-ordered captures (video, drone strips): number of last resected views refined by the bundle adjustment. "
+      "The next views are searched around them in the frame order (0 to disable).")
+    ("slidingWindowGlobalBAInterval", po::value<std::size_t>(&sfmParams.slidingWindowGlobalBAInterval)->default_value(sfmParams.slidingWindowGlobalBAInterval),
+      "With the sliding window: number of resected views between two bundle adjustments of the whole scene (0 to only adjust it at the end).")
+    ("checkpointInterval", po::value<double>(&sfmParams.checkpointInterval)->default_value(sfmParams.checkpointInterval),
+      "Minimum interval (in seconds) between two checkpoints of the reconstruction written in the background in the extraInfoFolder (0 to disable).")
+    ("resumeFromCheckpoint", po::value<bool>(&sfmParams.resumeFromCheckpoint)->default_value(sfmParams.resumeFromCheckpoint),
+      "Resume the reconstruction from the last checkpoint of the extraInfoFolder, if any.")
     ("localizerEstimator", po::value<robustEstimation::ERobustEstimator>(&sfmParams.localizerEstimator)->default_value(sfmParams.localizerEstimator),
       "Estimator type used to localize cameras (acransac (default), ransac, lsmeds, loransac, maxconsensus)")
     ("localizerEstimatorError", po::value<double>(&sfmParams.localizerEstimatorError)->default_value(0.0),
@@ -191,7 +207,7 @@ int aliceVision_main(int argc, char **argv)
 
   // set maxThreads
   HardwareContext hwc = cmdline.getHardwareContext();
-  omp_set_num_threads(hwc.getMaxThreads());
+  hwc.setupThreads();
 
   const double defaultLoRansacLocalizationError = 4.0;
   if(!robustEstimation::adjustRobustEstimatorThreshold(sfmParams.localizerEstimator, sfmParams.localizerEstimatorError, defaultLoRansacLocalizationError))
@@ -329,5 +345,12 @@ int aliceVision_main(int argc, char **argv)
     << "\t- # poses: " << sfmEngine.getSfMData().getPoses().size() << std::endl
     << "\t- # landmarks: " << sfmEngine.getSfMData().getLandmarks().size());
 
+  system::Metrics& metrics = system::Metrics::get();
+  metrics.setGauge("sfm.time", timer.elapsed());
+  metrics.setGauge("sfm.views", sfmEngine.getSfMData().getViews().size());
+  metrics.setGauge("sfm.validViews", sfmEngine.getSfMData().getValidViews().size());
+  metrics.setGauge("sfm.poses", sfmEngine.getSfMData().getPoses().size());
+  metrics.setGauge("sfm.landmarks", sfmEngine.getSfMData().getLandmarks().size());
+
   return EXIT_SUCCESS;
 }
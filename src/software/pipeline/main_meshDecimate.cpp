@@ -9,14 +9,8 @@
 #include <aliceVision/system/main.hpp>
 #include <aliceVision/system/Timer.hpp>
 #include <aliceVision/mvsUtils/common.hpp>
-
-#include <OpenMesh/Core/IO/reader/OBJReader.hh>
-#include <OpenMesh/Core/IO/writer/OBJWriter.hh>
-#include <OpenMesh/Core/IO/MeshIO.hh>
-#include <OpenMesh/Core/Mesh/TriMesh_ArrayKernelT.hh>
-#include <OpenMesh/Core/Geometry/VectorT.hh>
-#include <OpenMesh/Tools/Decimater/DecimaterT.hh>
-#include <OpenMesh/Tools/Decimater/ModQuadricT.hh>
+#include <aliceVision/mesh/Mesh.hpp>
+#include <aliceVision/mesh/MeshDecimation.hpp>
 
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
@@ -46,9 +40,9 @@ int aliceVision_main(int argc, char* argv[])
     po::options_description requiredParams("Required parameters");
     requiredParams.add_options()
         ("input,i", po::value<std::string>(&inputMeshPath)->required(),
-            "Input Mesh (OBJ file format).")
+            "Input Mesh (OBJ file format, or bin file format to keep the vertices visibilities).")
         ("output,o", po::value<std::string>(&outputMeshPath)->required(),
-            "Output mesh (OBJ file format).");
+            "Output mesh (OBJ file format, or bin file format to keep the vertices visibilities).");
 
     po::options_description optionalParams("Optional parameters");
     optionalParams.add_options()
@@ -77,23 +71,20 @@ int aliceVision_main(int argc, char* argv[])
     if(!bfs::is_directory(outDirectory))
         bfs::create_directory(outDirectory);
 
-    // Mesh type
-    typedef OpenMesh::TriMesh_ArrayKernelT<>                      Mesh;
-    // Decimater type
-    typedef OpenMesh::Decimater::DecimaterT< Mesh >               Decimater;
-    // Decimation Module Handle type
-    typedef OpenMesh::Decimater::ModQuadricT< Mesh >::Handle HModQuadric;
-
-    Mesh mesh;
-    if(!OpenMesh::IO::read_mesh(mesh, inputMeshPath))
+    mesh::Mesh mesh;
+    try
+    {
+        mesh.load(inputMeshPath);
+    }
+    catch(const std::exception& e)
     {
-        ALICEVISION_LOG_ERROR("Unable to read input mesh from the file: " << inputMeshPath);
+        ALICEVISION_LOG_ERROR("Unable to read input mesh from the file: " << inputMeshPath << "\n" << e.what());
         return EXIT_FAILURE;
     }
 
     ALICEVISION_LOG_INFO("Mesh file: \"" << inputMeshPath << "\" loaded.");
 
-    int nbInputPoints = mesh.n_vertices();
+    int nbInputPoints = mesh.pts.size();
     int nbOutputPoints = 0;
     if(fixedNbVertices != 0)
     {
@@ -117,45 +108,33 @@ int aliceVision_main(int argc, char* argv[])
         }
     }
 
-    ALICEVISION_LOG_INFO("Input mesh: " << nbInputPoints << " vertices and " << mesh.n_faces() << " facets.");
+    ALICEVISION_LOG_INFO("Input mesh: " << nbInputPoints << " vertices and " << mesh.tris.size() << " facets.");
     ALICEVISION_LOG_INFO("Target output mesh: " << nbOutputPoints << " vertices.");
 
     {
-        // a decimater object, connected to a mesh
-        Decimater   decimater(mesh);
-        // use a quadric module
-        HModQuadric hModQuadric;
-        // register module at the decimater
-        decimater.add(hModQuadric);
-
-        // the way to access the module
-        std::cout << decimater.module(hModQuadric).name() << std::endl;
-
-        /*
-         * since we need exactly one priority module (non-binary)
-         * we have to call set_binary(false) for our priority module
-         * in the case of HModQuadric, unset_max_err() calls set_binary(false) internally
-         */
-        decimater.module(hModQuadric).unset_max_err();
-        // let the decimater initialize the mesh and the modules
-        decimater.initialize();
-        // do decimation
-        size_t removedVertices = decimater.decimate_to(nbOutputPoints);
-        decimater.mesh().garbage_collection();
+        mesh::MeshDecimationParams decimationParams;
+        decimationParams.nbVertices = nbOutputPoints;
+        mesh::decimateMesh(mesh, decimationParams);
     }
-    ALICEVISION_LOG_INFO("Output mesh: " << mesh.n_vertices() << " vertices and " << mesh.n_faces() << " facets.");
+    ALICEVISION_LOG_INFO("Output mesh: " << mesh.pts.size() << " vertices and " << mesh.tris.size() << " facets.");
 
-    if(mesh.n_faces() == 0)
+    if(mesh.tris.empty())
     {
         ALICEVISION_LOG_ERROR("Failed: the output mesh is empty.");
         return EXIT_FAILURE;
     }
+    if(flipNormals)
+        mesh.invertTriangleOrientations();
 
     ALICEVISION_LOG_INFO("Save mesh.");
     // Save output mesh
-    if(!OpenMesh::IO::write_mesh(mesh, outputMeshPath))
+    try
+    {
+        mesh.save(outputMeshPath);
+    }
+    catch(const std::exception& e)
     {
-        ALICEVISION_LOG_ERROR("Failed to save mesh \"" << outputMeshPath << "\".");
+        ALICEVISION_LOG_ERROR("Failed to save mesh \"" << outputMeshPath << "\".\n" << e.what());
         return EXIT_FAILURE;
     }
     ALICEVISION_LOG_INFO("Mesh file: \"" << outputMeshPath << "\" saved.");
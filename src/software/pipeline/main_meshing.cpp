@@ -21,18 +21,25 @@
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/main.hpp>
 #include <aliceVision/system/Timer.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <Eigen/Geometry>
 
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
 
+#include <algorithm>
 #include <cmath>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <tuple>
 
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 4
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 3
 
 using namespace aliceVision;
 
@@ -247,6 +254,274 @@ inline std::istream& operator>>(std::istream& in, BoundingBox& out_bbox)
 }
 
 
+/**
+ * @brief Regular grid of blocks over a hexahedron, used by the partitioned meshing.
+ *        The hexahedron is parameterized by its vertex 0 and its edges 0-1, 0-3 and 0-4.
+ */
+struct BlocksGrid
+{
+    BlocksGrid(const Point3d hexah[8], int nbBlocks)
+    {
+        origin = Eigen::Vector3d(hexah[0].x, hexah[0].y, hexah[0].z);
+        const int axesVertices[3] = {1, 3, 4};
+        for(int i = 0; i < 3; ++i)
+            axes.col(i) = Eigen::Vector3d(hexah[axesVertices[i]].x, hexah[axesVertices[i]].y, hexah[axesVertices[i]].z) - origin;
+        invAxes = axes.inverse();
+
+        // blocks as close as possible to cubes
+        const double volume = axes.col(0).norm() * axes.col(1).norm() * axes.col(2).norm();
+        const double blockSize = std::cbrt(volume / std::max(1, nbBlocks));
+        for(int i = 0; i < 3; ++i)
+            dims[i] = std::max(1, static_cast<int>(std::round(axes.col(i).norm() / blockSize)));
+    }
+
+    int nbBlocks() const { return dims[0] * dims[1] * dims[2]; }
+
+    /**
+     * @brief Get the hexahedron of a block, with the same vertices order as the input hexahedron.
+     * @param[in] blockIndex the block index
+     * @param[in] overlap the overlap with the neighboring blocks (fraction of the block size on each side)
+     * @param[out] out_hexah the block hexahedron
+     */
+    void getBlockHexahedron(int blockIndex, double overlap, Point3d out_hexah[8]) const
+    {
+        const int blockCoords[3] = {blockIndex % dims[0], (blockIndex / dims[0]) % dims[1], blockIndex / (dims[0] * dims[1])};
+        Eigen::Vector3d from;
+        Eigen::Vector3d to;
+        for(int i = 0; i < 3; ++i)
+        {
+            from(i) = std::max(0.0, (blockCoords[i] - overlap) / dims[i]);
+            to(i) = std::min(1.0, (blockCoords[i] + 1 + overlap) / dims[i]);
+        }
+
+        // local coordinates of the hexahedron vertices
+        const int vertices[8][3] = {{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}, {0, 0, 1}, {1, 0, 1}, {1, 1, 1}, {0, 1, 1}};
+        for(int v = 0; v < 8; ++v)
+        {
+            Eigen::Vector3d local;
+            for(int i = 0; i < 3; ++i)
+                local(i) = vertices[v][i] ? to(i) : from(i);
+            const Eigen::Vector3d p = origin + axes * local;
+            out_hexah[v] = Point3d(p.x(), p.y(), p.z());
+        }
+    }
+
+    /// Get the index of the block containing a point (without overlap), the points outside of the grid belong to the closest block
+    int getBlockIndex(const Point3d& p) const
+    {
+        const Eigen::Vector3d local = invAxes * (Eigen::Vector3d(p.x, p.y, p.z) - origin);
+        int blockCoords[3];
+        for(int i = 0; i < 3; ++i)
+            blockCoords[i] = std::min(dims[i] - 1, std::max(0, static_cast<int>(std::floor(local(i) * dims[i]))));
+        return blockCoords[0] + dims[0] * (blockCoords[1] + dims[1] * blockCoords[2]);
+    }
+
+    Eigen::Vector3d origin;
+    Eigen::Matrix3d axes;
+    Eigen::Matrix3d invAxes;
+    int dims[3];
+};
+
+/// Compute the mesh and the points visibilities of one block of the partitioned meshing and save them in \p blockFolder
+void computeBlockMesh(mvsUtils::MultiViewParams& mp,
+                      Point3d blockHexah[8],
+                      const sfmData::SfMData& sfmData,
+                      bool meshingFromDepthMaps,
+                      bool addLandmarksToTheDensePointCloud,
+                      fuseCut::FuseParams& fuseParams,
+                      int maxNbConnectedHelperPoints,
+                      bool saveRawDensePointCloud,
+                      bool colorizeOutput,
+                      bool exportDebugTetrahedralization,
+                      const std::string& blockFolder,
+                      const std::string& meshFilepath,
+                      const std::string& ptsCamsFilepath)
+{
+    StaticVector<StaticVector<int>> ptsCams;
+
+    StaticVector<int> cams;
+    if(meshingFromDepthMaps)
+    {
+        cams = mp.findCamsWhichIntersectsHexahedron(blockHexah);
+    }
+    else
+    {
+        cams.resize(mp.getNbCameras());
+        for(int i = 0; i < cams.size(); ++i)
+            cams[i] = i;
+    }
+
+    if(cams.empty())
+    {
+        ALICEVISION_LOG_INFO("No camera intersects the block, the block is empty.");
+        saveArrayOfArraysToFile(ptsCamsFilepath, ptsCams);
+        return;
+    }
+
+    fuseCut::DelaunayGraphCut delaunayGC(mp);
+    delaunayGC.createDensePointCloud(blockHexah, cams, addLandmarksToTheDensePointCloud ? &sfmData : nullptr, meshingFromDepthMaps ? &fuseParams : nullptr);
+    if(saveRawDensePointCloud)
+    {
+        ALICEVISION_LOG_INFO("Save block dense point cloud before cut and filtering.");
+        StaticVector<StaticVector<int>> rawPtsCams;
+        delaunayGC.createPtsCams(rawPtsCams);
+        sfmData::SfMData densePointCloud;
+        createDenseSfMData(sfmData, mp, delaunayGC._verticesCoords, rawPtsCams, densePointCloud);
+        removeLandmarksWithoutObservations(densePointCloud);
+        if(colorizeOutput)
+            sfmData::colorizeTracks(densePointCloud);
+        sfmDataIO::Save(densePointCloud, blockFolder + "densePointCloud_raw.abc", sfmDataIO::ESfMData::ALL_DENSE);
+    }
+
+    delaunayGC.createGraphCut(blockHexah, cams, blockFolder, blockFolder + "SpaceCamsTracks/", false, exportDebugTetrahedralization);
+    delaunayGC.graphCutPostProcessing(blockHexah, blockFolder);
+
+    mesh::Mesh* mesh = delaunayGC.createMesh(maxNbConnectedHelperPoints);
+    delaunayGC.createPtsCams(ptsCams);
+    mesh::meshPostProcessing(mesh, ptsCams, mp, blockFolder, nullptr, blockHexah);
+
+    if(mesh != nullptr && !mesh->tris.empty())
+        mesh->saveToBin(meshFilepath);
+    else
+        ptsCams.clear();
+    delete mesh;
+
+    // written last, marks the block as computed
+    saveArrayOfArraysToFile(ptsCamsFilepath, ptsCams);
+}
+
+/**
+ * @brief Join the meshes of the blocks of the partitioned meshing.
+ *        Each triangle is kept in the block containing its barycenter, so the overlaps are not duplicated.
+ *        The vertices shared by neighboring blocks are merged up to a tolerance relative to the grid size.
+ */
+mesh::Mesh* joinBlocksMeshes(const BlocksGrid& grid,
+                             const std::vector<std::string>& meshFilepaths,
+                             const std::vector<std::string>& ptsCamsFilepaths,
+                             StaticVector<StaticVector<int>>& out_ptsCams)
+{
+    mesh::Mesh* mesh = new mesh::Mesh();
+    out_ptsCams.clear();
+
+    for(int b = 0; b < grid.nbBlocks(); ++b)
+    {
+        mesh::Mesh blockMesh;
+        if(!fs::exists(meshFilepaths[b]) || !blockMesh.loadFromBin(meshFilepaths[b]))
+            continue;
+
+        StaticVector<StaticVector<int>> blockPtsCams;
+        loadArrayOfArraysFromFile(blockPtsCams, ptsCamsFilepaths[b]);
+
+        StaticVectorBool trisToStay;
+        trisToStay.resize(blockMesh.tris.size(), false);
+        for(int i = 0; i < blockMesh.tris.size(); ++i)
+        {
+            const mesh::Mesh::triangle& t = blockMesh.tris[i];
+            const Point3d barycenter = (blockMesh.pts[t.v[0]] + blockMesh.pts[t.v[1]] + blockMesh.pts[t.v[2]]) / 3.0;
+            trisToStay[i] = (grid.getBlockIndex(barycenter) == b);
+        }
+        blockMesh.letJustTringlesIdsInMesh(trisToStay);
+
+        StaticVector<int> ptIdToNewPtId;
+        blockMesh.removeFreePointsFromMesh(ptIdToNewPtId);
+
+        const int ptsOffset = out_ptsCams.size();
+        out_ptsCams.resize(ptsOffset + blockMesh.pts.size());
+        for(int i = 0; i < ptIdToNewPtId.size(); ++i)
+        {
+            if(ptIdToNewPtId[i] > -1 && i < blockPtsCams.size())
+                out_ptsCams[ptsOffset + ptIdToNewPtId[i]] = blockPtsCams[i];
+        }
+
+        ALICEVISION_LOG_INFO("Block " << b << ": " << blockMesh.tris.size() << " triangles kept.");
+        mesh->addMesh(blockMesh);
+    }
+
+    // merge the vertices closer than the tolerance: the blocks are computed independently,
+    // so the seam vertices may differ by the numerical noise of each block.
+    // The points are hashed on a grid of cells of the tolerance size, the candidates are in the 27 neighboring cells.
+    const double weldTolerance = 1e-6 * (grid.axes.col(0) + grid.axes.col(1) + grid.axes.col(2)).norm();
+    const double weldTolerance2 = weldTolerance * weldTolerance;
+    const auto getCell = [&](const Point3d& p) {
+        return std::make_tuple(static_cast<long long>(std::floor(p.x / weldTolerance)),
+                               static_cast<long long>(std::floor(p.y / weldTolerance)),
+                               static_cast<long long>(std::floor(p.z / weldTolerance)));
+    };
+    std::map<std::tuple<long long, long long, long long>, std::vector<int>> cells;
+    StaticVector<int> ptIdToUniquePtId;
+    ptIdToUniquePtId.resize(mesh->pts.size());
+    int nbMergedPts = 0;
+    for(int i = 0; i < mesh->pts.size(); ++i)
+    {
+        const Point3d& p = mesh->pts[i];
+        const auto cell = getCell(p);
+        int uniquePtId = -1;
+        for(long long dz = -1; dz <= 1 && uniquePtId == -1; ++dz)
+        {
+            for(long long dy = -1; dy <= 1 && uniquePtId == -1; ++dy)
+            {
+                for(long long dx = -1; dx <= 1 && uniquePtId == -1; ++dx)
+                {
+                    const auto it = cells.find(std::make_tuple(std::get<0>(cell) + dx, std::get<1>(cell) + dy, std::get<2>(cell) + dz));
+                    if(it == cells.end())
+                        continue;
+                    for(int j : it->second)
+                    {
+                        if((mesh->pts[j] - p).size2() <= weldTolerance2)
+                        {
+                            uniquePtId = j;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        if(uniquePtId == -1)
+        {
+            cells[cell].push_back(i);
+            ptIdToUniquePtId[i] = i;
+        }
+        else
+        {
+            ptIdToUniquePtId[i] = uniquePtId;
+            for(int cam : out_ptsCams[i])
+                out_ptsCams[uniquePtId].push_back_distinct(cam);
+            ++nbMergedPts;
+        }
+    }
+
+    if(nbMergedPts > 0)
+    {
+        StaticVectorBool trisToStay;
+        trisToStay.resize(mesh->tris.size(), true);
+        for(int i = 0; i < mesh->tris.size(); ++i)
+        {
+            mesh::Mesh::triangle& t = mesh->tris[i];
+            for(int k = 0; k < 3; ++k)
+                t.v[k] = ptIdToUniquePtId[t.v[k]];
+            // degenerated by the merge
+            trisToStay[i] = (t.v[0] != t.v[1] && t.v[1] != t.v[2] && t.v[2] != t.v[0]);
+        }
+        mesh->letJustTringlesIdsInMesh(trisToStay);
+
+        StaticVector<int> ptIdToNewPtId;
+        mesh->removeFreePointsFromMesh(ptIdToNewPtId);
+
+        StaticVector<StaticVector<int>> ptsCams;
+        ptsCams.resize(mesh->pts.size());
+        for(int i = 0; i < ptIdToNewPtId.size(); ++i)
+        {
+            if(ptIdToNewPtId[i] > -1)
+                ptsCams[ptIdToNewPtId[i]].swap(out_ptsCams[i]);
+        }
+        out_ptsCams.swap(ptsCams);
+    }
+
+    ALICEVISION_LOG_INFO("Join blocks meshes: " << nbMergedPts << " shared vertices merged, " << mesh->pts.size() << " vertices, " << mesh->tris.size() << " triangles.");
+    return mesh;
+}
+
 int aliceVision_main(int argc, char* argv[])
 {
     system::Timer timer;
@@ -271,6 +546,13 @@ int aliceVision_main(int argc, char* argv[])
     double minSolidAngleRatio = 0.2;
     int nbSolidAngleFilteringIterations = 2;
     unsigned int seed = 0;
+    std::string delaunayBackend = "BDEL";
+    int partitioningNbBlocks = 8;
+    double partitioningBlocksOverlap = 0.1;
+    int rangeStart = -1;
+    int rangeSize = -1;
+    std::string maxflowSolver = "adjList";
+    bool maxflowVerify = false;
     BoundingBox boundingBox;
 
     fuseCut::FuseParams fuseParams;
@@ -291,7 +573,7 @@ int aliceVision_main(int argc, char* argv[])
         ("output,o", po::value<std::string>(&outputDensePointCloud)->required(),
           "Output Dense SfMData file.")
         ("outputMesh,o", po::value<std::string>(&outputMesh)->required(),
-          "Output mesh");
+          "Output mesh (.obj, or .bin to keep the vertices visibilities).");
 
     po::options_description optionalParams("Optional parameters");
     optionalParams.add_options()
@@ -316,6 +598,15 @@ int aliceVision_main(int argc, char* argv[])
             "Filter points based on their number of observations")
         ("partitioning", po::value<EPartitioningMode>(&partitioningMode)->default_value(partitioningMode),
             "Partitioning: 'singleBlock' or 'auto'.")
+        ("partitioningNbBlocks", po::value<int>(&partitioningNbBlocks)->default_value(partitioningNbBlocks),
+            "Partitioning 'auto': approximate number of blocks. Each block is meshed independently to bound the memory.")
+        ("partitioningBlocksOverlap", po::value<double>(&partitioningBlocksOverlap)->default_value(partitioningBlocksOverlap),
+            "Partitioning 'auto': overlap between the neighboring blocks (fraction of the block size).")
+        ("rangeStart", po::value<int>(&rangeStart)->default_value(rangeStart),
+            "Partitioning 'auto': compute a sub-range of blocks from index rangeStart to rangeStart+rangeSize. "
+            "The blocks already computed are skipped, the meshes are joined once all the blocks are computed.")
+        ("rangeSize", po::value<int>(&rangeSize)->default_value(rangeSize),
+            "Partitioning 'auto': compute a sub-range of N blocks (N=rangeSize).")
         ("repartition", po::value<ERepartitionMode>(&repartitionMode)->default_value(repartitionMode),
             "Repartition: 'multiResolution' or 'regularGrid'.")
         ("estimateSpaceFromSfM", po::value<bool>(&estimateSpaceFromSfM)->default_value(estimateSpaceFromSfM),
@@ -379,6 +670,12 @@ int aliceVision_main(int argc, char* argv[])
             "Maximum number of connected helper points before we remove them.")
         ("exportDebugTetrahedralization", po::value<bool>(&exportDebugTetrahedralization)->default_value(exportDebugTetrahedralization),
             "Export debug cells score as tetrahedral mesh. WARNING: could create huge meshes, only use on very small datasets.")        
+        ("delaunayBackend", po::value<std::string>(&delaunayBackend)->default_value(delaunayBackend),
+            "Delaunay tetrahedralization backend: BDEL (sequential insertion) or PDEL (parallel insertion, limited by the number of cores).")
+        ("maxflowSolver", po::value<std::string>(&maxflowSolver)->default_value(maxflowSolver),
+            "Maxflow solver of the graph cut: adjList, csr (single-threaded Boykov-Kolmogorov) or pushRelabel (parallel).")
+        ("maxflowVerify", po::value<bool>(&maxflowVerify)->default_value(maxflowVerify),
+            "Compare the graph cut labeling with the adjList solver (debug, requires more memory and time).")
         ("seed", po::value<unsigned int>(&seed)->default_value(seed),
             "Seed used in random processes. (0 to use a random seed).");
 
@@ -391,6 +688,10 @@ int aliceVision_main(int argc, char* argv[])
         return EXIT_FAILURE;
     }
 
+    // set maxThreads
+    HardwareContext hwc = cmdline.getHardwareContext();
+    hwc.setupThreads();
+
 
     if(depthMapsFolder.empty())
     {
@@ -431,6 +732,9 @@ int aliceVision_main(int argc, char* argv[])
     mp.userParams.put("delaunaycut.nPixelSizeBehind", nPixelSizeBehind);
     mp.userParams.put("delaunaycut.fullWeight", fullWeight);
     mp.userParams.put("delaunaycut.voteFilteringForWeaklySupportedSurfaces", voteFilteringForWeaklySupportedSurfaces);
+    mp.userParams.put("delaunaycut.delaunayBackend", delaunayBackend);
+    mp.userParams.put("delaunaycut.maxflowSolver", maxflowSolver);
+    mp.userParams.put("delaunaycut.maxflowVerify", maxflowVerify);
     mp.userParams.put("hallucinationsFiltering.invertTetrahedronBasedOnNeighborsNbIterations", invertTetrahedronBasedOnNeighborsNbIterations);
     mp.userParams.put("hallucinationsFiltering.minSolidAngleRatio", minSolidAngleRatio);
     mp.userParams.put("hallucinationsFiltering.nbSolidAngleFilteringIterations", nbSolidAngleFilteringIterations);
@@ -458,7 +762,137 @@ int aliceVision_main(int argc, char* argv[])
             {
                 case ePartitioningAuto:
                 {
-                    throw std::invalid_argument("Meshing mode: 'multiResolution', partitioning: 'auto' is not yet implemented.");
+                    ALICEVISION_LOG_INFO("Meshing mode: multi-resolution, partitioning: auto.");
+
+                    const fs::path blocksDirectory = outDirectory / "blocks";
+                    if(!fs::is_directory(blocksDirectory))
+                        fs::create_directory(blocksDirectory);
+
+                    // the space is estimated once and reused by the runs on the other ranges of blocks,
+                    // the cache and the computed blocks are discarded if the space or partitioning options change
+                    const std::string hexahFilepath = (blocksDirectory / "hexahedron.bin").string();
+                    const std::string keyFilepath = (blocksDirectory / "partitioning.key").string();
+                    std::string key;
+                    {
+                        std::ostringstream keyStream;
+                        keyStream.precision(17);
+                        keyStream << "sfmData=" << fs::absolute(sfmDataFilename).string()
+                                  << "\nboundingBox=" << boundingBox.translation.transpose() << " " << boundingBox.rotation.transpose() << " " << boundingBox.scale.transpose()
+                                  << "\nestimateSpaceFromSfM=" << estimateSpaceFromSfM
+                                  << "\nestimateSpaceMinObservations=" << estimateSpaceMinObservations
+                                  << "\nestimateSpaceMinObservationAngle=" << estimateSpaceMinObservationAngle
+                                  << "\npartitioningNbBlocks=" << partitioningNbBlocks
+                                  << "\npartitioningBlocksOverlap=" << partitioningBlocksOverlap
+                                  << "\n";
+                        key = keyStream.str();
+                    }
+
+                    bool validCache = false;
+                    if(fs::exists(hexahFilepath) && fs::exists(keyFilepath))
+                    {
+                        std::ifstream keyFile(keyFilepath);
+                        const std::string savedKey((std::istreambuf_iterator<char>(keyFile)), std::istreambuf_iterator<char>());
+                        validCache = (savedKey == key);
+                    }
+
+                    std::array<Point3d, 8> hexah;
+
+                    if(validCache)
+                    {
+                        StaticVector<Point3d>* savedHexah = loadArrayFromFile<Point3d>(hexahFilepath);
+                        std::copy(savedHexah->begin(), savedHexah->end(), hexah.begin());
+                        delete savedHexah;
+                    }
+                    else
+                    {
+                        if(fs::exists(hexahFilepath))
+                        {
+                            ALICEVISION_LOG_INFO("The space or partitioning options changed, the previously computed blocks are discarded.");
+                            fs::remove_all(blocksDirectory);
+                            fs::create_directory(blocksDirectory);
+                        }
+
+                        float minPixSize;
+                        fuseCut::Fuser fs(mp);
+
+                        if(boundingBox.isInitialized())
+                            boundingBox.toHexahedron(&hexah[0]);
+                        else if(meshingFromDepthMaps && (!estimateSpaceFromSfM || sfmData.getLandmarks().empty()))
+                            fs.divideSpaceFromDepthMaps(&hexah[0], minPixSize);
+                        else
+                            fs.divideSpaceFromSfM(sfmData, &hexah[0], estimateSpaceMinObservations, estimateSpaceMinObservationAngle);
+
+                        StaticVector<Point3d> hexahToSave;
+                        hexahToSave.resize(8);
+                        std::copy(hexah.begin(), hexah.end(), hexahToSave.begin());
+                        saveArrayToFile<Point3d>(hexahFilepath, hexahToSave);
+
+                        // written last, marks the hexahedron as valid
+                        std::ofstream keyFile(keyFilepath);
+                        keyFile << key;
+                    }
+
+                    const BlocksGrid grid(&hexah[0], partitioningNbBlocks);
+                    const int nbBlocks = grid.nbBlocks();
+                    ALICEVISION_LOG_INFO("Partitioning: " << grid.dims[0] << "x" << grid.dims[1] << "x" << grid.dims[2] << " blocks.");
+
+                    std::vector<std::string> meshFilepaths(nbBlocks);
+                    std::vector<std::string> ptsCamsFilepaths(nbBlocks);
+                    for(int b = 0; b < nbBlocks; ++b)
+                    {
+                        meshFilepaths[b] = (blocksDirectory / ("block_" + std::to_string(b) + "_mesh.bin")).string();
+                        ptsCamsFilepaths[b] = (blocksDirectory / ("block_" + std::to_string(b) + "_ptsCams.bin")).string();
+                    }
+
+                    int blocksRangeStart = 0;
+                    int blocksRangeEnd = nbBlocks;
+                    if(rangeSize != -1)
+                    {
+                        if(rangeStart < 0 || rangeSize <= 0 || rangeStart >= nbBlocks)
+                        {
+                            ALICEVISION_LOG_ERROR("Range is incorrect (rangeStart: " << rangeStart << ", rangeSize: " << rangeSize << ", nbBlocks: " << nbBlocks << ").");
+                            return EXIT_FAILURE;
+                        }
+                        blocksRangeStart = rangeStart;
+                        blocksRangeEnd = std::min(rangeStart + rangeSize, nbBlocks);
+                    }
+
+                    // the peak memory is bounded by the memory of one block
+                    for(int b = blocksRangeStart; b < blocksRangeEnd; ++b)
+                    {
+                        if(fs::exists(ptsCamsFilepaths[b]))
+                        {
+                            ALICEVISION_LOG_INFO("Block " << b << " already computed.");
+                            continue;
+                        }
+                        ALICEVISION_LOG_INFO("Compute block " << b << " / " << nbBlocks << ".");
+
+                        Point3d blockHexah[8];
+                        grid.getBlockHexahedron(b, partitioningBlocksOverlap, blockHexah);
+
+                        const fs::path blockDirectory = blocksDirectory / ("block_" + std::to_string(b));
+                        if(!fs::is_directory(blockDirectory))
+                            fs::create_directory(blockDirectory);
+
+                        computeBlockMesh(mp, blockHexah, sfmData, meshingFromDepthMaps, addLandmarksToTheDensePointCloud,
+                                         fuseParams, maxNbConnectedHelperPoints, saveRawDensePointCloud, colorizeOutput,
+                                         exportDebugTetrahedralization, blockDirectory.string() + "/",
+                                         meshFilepaths[b], ptsCamsFilepaths[b]);
+                    }
+
+                    for(int b = 0; b < nbBlocks; ++b)
+                    {
+                        if(!fs::exists(ptsCamsFilepaths[b]))
+                        {
+                            ALICEVISION_LOG_INFO("Blocks " << blocksRangeStart << " to " << blocksRangeEnd - 1 << " computed, "
+                                                 "the meshes are joined once all the blocks are computed.");
+                            ALICEVISION_LOG_INFO("Task done in (s): " + std::to_string(timer.elapsed()));
+                            return EXIT_SUCCESS;
+                        }
+                    }
+
+                    mesh = joinBlocksMeshes(grid, meshFilepaths, ptsCamsFilepaths, ptsCams);
+                    break;
                 }
                 case ePartitioningSingleBlock:
                 {
@@ -568,7 +1002,10 @@ int aliceVision_main(int argc, char* argv[])
     ALICEVISION_LOG_INFO("Save dense point cloud.");
     sfmDataIO::Save(densePointCloud, outputDensePointCloud, sfmDataIO::ESfMData::ALL_DENSE);
 
-    ALICEVISION_LOG_INFO("Save obj mesh file.");
+    // the visibilities are kept in the binary mesh file, so the next nodes do not need to remap them
+    mesh->pointsVisibilities.swap(ptsCams);
+
+    ALICEVISION_LOG_INFO("Save mesh file.");
     ALICEVISION_LOG_INFO("OUTPUT MESH " << outputMesh);
     mesh->save(outputMesh);
     delete mesh;
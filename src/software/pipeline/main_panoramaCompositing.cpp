@@ -39,7 +39,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
@@ -137,6 +137,43 @@ std::unique_ptr<PanoramaMap> buildMap(const sfmData::SfMData& sfmData, const std
     return ret;
 }
 
+bool writeChunksPlan(const std::string& planFilepath, const std::vector<std::vector<IndexT>>& chunks,
+                     const std::vector<double>& chunksCosts)
+{
+    bpt::ptree chunksTree;
+    for(std::size_t chunkId = 0; chunkId < chunks.size(); chunkId++)
+    {
+        bpt::ptree viewsTree;
+        for(IndexT viewId : chunks[chunkId])
+        {
+            bpt::ptree viewTree;
+            viewTree.put("", viewId);
+            viewsTree.push_back(std::make_pair("", viewTree));
+        }
+
+        bpt::ptree chunkTree;
+        chunkTree.put("rangeIteration", chunkId);
+        chunkTree.put("estimatedCost", chunksCosts[chunkId]);
+        chunkTree.add_child("views", viewsTree);
+        chunksTree.push_back(std::make_pair("", chunkTree));
+    }
+
+    bpt::ptree fileTree;
+    fileTree.add_child("chunks", chunksTree);
+
+    try
+    {
+        bpt::write_json(planFilepath, fileTree);
+    }
+    catch(const bpt::json_parser_error& e)
+    {
+        ALICEVISION_LOG_ERROR("Cannot write the chunks plan file '" << planFilepath << "': " << e.what());
+        return false;
+    }
+
+    return true;
+}
+
 bool processImage(const PanoramaMap& panoramaMap, const sfmData::SfMData& sfmData, const std::string& compositerType,
                   const std::string& warpingFolder, const std::string& labelsFilePath, const std::string& outputFolder,
                   const image::EStorageDataType& storageDataType, IndexT viewReference,
@@ -627,6 +664,7 @@ int aliceVision_main(int argc, char** argv)
     std::string outputFolder;
     std::string compositerType = "multiband";
     std::string overlayType = "none";
+    std::string chunksPlanFilepath;
     int rangeIteration = -1;
     int rangeSize = 1;
     int maxThreads = 1;
@@ -655,7 +693,9 @@ int aliceVision_main(int argc, char** argv)
         ("rangeSize", po::value<int>(&rangeSize)->default_value(rangeSize), "Range size.")
         ("maxThreads", po::value<int>(&maxThreads)->default_value(maxThreads), "max number of threads to use.")
         ("labels,l", po::value<std::string>(&labelsFilepath)->required(), "Labels image from seams estimation.")
-        ("useTiling,n", po::value<bool>(&useTiling)->default_value(useTiling), "use tiling for compositing.");
+        ("useTiling,n", po::value<bool>(&useTiling)->default_value(useTiling), "use tiling for compositing.")
+        ("chunksPlan", po::value<std::string>(&chunksPlanFilepath)->default_value(chunksPlanFilepath),
+        "Write the views and the estimated compositing cost of each chunk in this json file (by the first chunk).");
 
     CmdLine cmdline(
         "Performs the panorama stiching of warped images, with an option to use constraints from precomputed seams maps.\n"
@@ -670,7 +710,7 @@ int aliceVision_main(int argc, char** argv)
     // set maxThreads
     HardwareContext hwc = cmdline.getHardwareContext();
     hwc.setUserCoresLimit(maxThreads);
-    omp_set_num_threads(hwc.getMaxThreads());
+    hwc.setupThreads();
 
     if(overlayType == "borders" || overlayType == "all")
     {
@@ -769,14 +809,29 @@ int aliceVision_main(int argc, char** argv)
         return EXIT_FAILURE;
     }
 
-    // Distribute more smartly inputs among chunks
+    // Distribute inputs among chunks by balancing their estimated compositing costs
     std::vector<std::vector<IndexT>> chunks;
-    if(!panoramaMap->optimizeChunks(chunks, rangeSize))
+    std::vector<double> chunksCosts;
+    if(!panoramaMap->optimizeChunks(chunks, rangeSize, &chunksCosts))
     {
         ALICEVISION_LOG_ERROR("Can't build chunks");
         return EXIT_FAILURE;
     }
 
+    if(rangeIteration < chunks.size())
+    {
+        ALICEVISION_LOG_INFO("Chunk " << rangeIteration << "/" << chunks.size() << ": " << chunks[rangeIteration].size()
+                                      << " views, estimated cost " << chunksCosts[rangeIteration]);
+    }
+
+    if(!chunksPlanFilepath.empty() && rangeIteration == 0)
+    {
+        if(!writeChunksPlan(chunksPlanFilepath, chunks, chunksCosts))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+
     if(rangeIteration >= chunks.size())
     {
         // nothing to compute for this chunk
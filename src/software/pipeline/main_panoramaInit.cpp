@@ -1,5 +1,6 @@
 #include <aliceVision/image/all.hpp>
 #include <aliceVision/system/cmdline.hpp>
+#include <aliceVision/system/main.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/numeric/numeric.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
@@ -655,7 +656,7 @@ private:
     size_t _minimal_size;
 };
 
-int main(int argc, char* argv[])
+int aliceVision_main(int argc, char* argv[])
 {
     using namespace aliceVision;
 
@@ -121,35 +121,59 @@ int aliceVision_main(int argc, char** argv)
         return EXIT_FAILURE;
     }
 
-    int panoramaWidth = 0;
-    int panoramaHeight = 0;
+    struct SourceInfo
+    {
+        IndexT id;
+        std::string path;
+        int offsetX;
+        int offsetY;
+        int width;
+        int height;
+    };
+
+    // Read the metadata of each source once, the panorama metadata come from the first source
     oiio::ParamValueList metadata;
+    std::vector<SourceInfo> sourcesInfos;
+    for (auto sourceItem : sourcesList)
+    {
+        SourceInfo si;
+        si.id = sourceItem.first;
+        si.path = sourceItem.second;
+
+        oiio::ParamValueList sourceMetadata = image::readImageMetadata(si.path, si.width, si.height);
+        si.offsetY = sourceMetadata.find("AliceVision:offsetY")->get_int();
+        si.offsetX = sourceMetadata.find("AliceVision:offsetX")->get_int();
+
+        if (sourcesInfos.empty())
+        {
+            metadata = sourceMetadata;
+        }
+
+        sourcesInfos.push_back(si);
+    }
 
-    auto sourceInput = sourcesList[0];
-    metadata = image::readImageMetadata(sourceInput.second);
-    panoramaWidth = metadata.find("AliceVision:panoramaWidth")->get_int();
-    panoramaHeight = metadata.find("AliceVision:panoramaHeight")->get_int();
+    const int panoramaWidth = metadata.find("AliceVision:panoramaWidth")->get_int();
+    const int panoramaHeight = metadata.find("AliceVision:panoramaHeight")->get_int();
+
+    for (SourceInfo& si : sourcesInfos)
+    {
+        if (si.offsetX < 0)
+        {
+            si.offsetX += panoramaWidth;
+        }
+    }
 
     int tileCountWidth = std::ceil(double(panoramaWidth) / double(tileSize));
     int tileCountHeight = std::ceil(double(panoramaHeight) / double(tileSize));
 
     std::map<std::pair<int, int>, IndexT> fullTiles;
-    for (auto sourceItem : sourcesList)
+    for (const SourceInfo& si : sourcesInfos)
     {
-        std::string imagePath = sourceItem.second;
+        const int offsetX = si.offsetX;
+        const int offsetY = si.offsetY;
+        const int width = si.width;
+        const int height = si.height;
 
-        // Get offset
-        int width = 0;
-        int height = 0;
-        oiio::ParamValueList metadata = image::readImageMetadata(imagePath, width, height);
-        const int offsetY = metadata.find("AliceVision:offsetY")->get_int();
-
-        int offsetX = metadata.find("AliceVision:offsetX")->get_int();
-        if (offsetX < 0)
-        {
-            offsetX += panoramaWidth;
-        }
-    
         int left = std::floor(double(offsetX) / double(tileSize));
         int top = std::floor(double(offsetY) / double(tileSize));
         int right = std::ceil(double(offsetX + width - 1) / double(tileSize));
@@ -176,7 +200,7 @@ int aliceVision_main(int argc, char** argv)
 
                 if (fullTiles.find(pos) == fullTiles.end())
                 {
-                    fullTiles[pos] = sourceItem.first;
+                    fullTiles[pos] = si.id;
                 }
             }
         }
@@ -200,42 +224,43 @@ int aliceVision_main(int argc, char** argv)
         bool filed = false;
         size_t used = 0;
         std::shared_ptr<image::Image<image::RGBAfColor>> tileContent = nullptr;
-    };    
-    image::Image<TileInfo> tiles(tileCountWidth, tileCountHeight, true, {false, 0, nullptr});
+    };
 
-    for (auto sourceItem : sourcesList)
+    // The panorama is merged one row of tiles at a time,
+    // only the rows of the sources overlapping the current row of tiles are read
+    std::vector<TileInfo> tiles(tileCountWidth);
+    image::Image<image::RGBAfColor> vide(tileSize, tileSize, true, image::RGBAfColor(0.0f, 0.0f, 0.0f, 0.0f));
+    image::Image<image::RGBAfColor> source;
+
+    for (int ty = 0; ty < tileCountHeight; ty++)
     {
-        std::string imagePath = sourceItem.second;
-
-        // Get offset
-        int width = 0;
-        int height = 0;
-        oiio::ParamValueList metadata = image::readImageMetadata(imagePath, width, height);
-        const int offsetY = metadata.find("AliceVision:offsetY")->get_int();
-        int offsetX = metadata.find("AliceVision:offsetX")->get_int();
-        if (offsetX < 0)
+        const int y = ty * tileSize;
+
+        for (TileInfo& ti : tiles)
         {
-            offsetX += panoramaWidth;
+            ti = TileInfo();
         }
-    
-        image::Image<image::RGBAfColor> source;
-        image::readImage(imagePath, source, image::EImageColorSpace::NO_CONVERSION);
 
-        int left = std::floor(double(offsetX) / double(tileSize));
-        int top = std::floor(double(offsetY) / double(tileSize));
-        int right = std::ceil(double(offsetX + width - 1) / double(tileSize));
-        int bottom = std::ceil(double(offsetY + height - 1) / double(tileSize));
-
-        //Loop over all tiles of this input
-        for (int ty = top; ty <= bottom; ty++)
+        for (const SourceInfo& si : sourcesInfos)
         {
-            if (ty < 0 || ty >= tileCountHeight) 
+            const int offsetX = si.offsetX;
+            const int offsetY = si.offsetY;
+            const int width = si.width;
+            const int height = si.height;
+
+            // Source rows overlapping this row of tiles
+            const int sourceYBegin = std::max(0, y - offsetY);
+            const int sourceYEnd = std::min(height, y + int(tileSize) - offsetY);
+            if (sourceYBegin >= sourceYEnd)
             {
                 continue;
             }
 
-            int y = ty * tileSize;
-    
+            int left = std::floor(double(offsetX) / double(tileSize));
+            int right = std::ceil(double(offsetX + width - 1) / double(tileSize));
+
+            bool loaded = false;
+
             for (int iter_tx = left; iter_tx <= right; iter_tx++)
             {
                 int tx = iter_tx;
@@ -246,8 +271,8 @@ int aliceVision_main(int argc, char** argv)
                     tx = tx - tileCountWidth;
                     offset_loop = - panoramaWidth;
                 }
-                
-                if (tx < 0 || tx >= tileCountWidth) 
+
+                if (tx < 0 || tx >= tileCountWidth)
                 {
                     continue;
                 }
@@ -260,19 +285,24 @@ int aliceVision_main(int argc, char** argv)
                 pos.second = ty;
                 if (fullTiles.find(pos) != fullTiles.end())
                 {
-                    if (fullTiles[pos] != sourceItem.first)
+                    if (fullTiles[pos] != si.id)
                     {
                         continue;
                     }
                 }
 
-                TileInfo& ti = tiles(ty, tx);
+                TileInfo& ti = tiles[tx];
                 if (ti.filed)
                 {
                     continue;
                 }
 
- 
+                if (!loaded)
+                {
+                    image::readImageROI(si.path, source, oiio::ROI(0, width, sourceYBegin, sourceYEnd));
+                    loaded = true;
+                }
+
                 if (ti.tileContent == nullptr)
                 {
                     ti.tileContent = std::make_shared<image::Image<image::RGBAfColor>>(tileSize, tileSize, true, image::RGBAfColor(0.0f, 0.0f, 0.0f, 0.0f));
@@ -283,11 +313,10 @@ int aliceVision_main(int argc, char** argv)
                     int panorama_y = y + py;
                     int source_y = panorama_y - offsetY;
 
-                    if (source_y < 0 || source_y >= height)
+                    if (source_y < sourceYBegin || source_y >= sourceYEnd)
                     {
                         continue;
                     }
-                    
 
                     for (int px = 0; px < tileSize; px++)
                     {
@@ -312,7 +341,7 @@ int aliceVision_main(int argc, char** argv)
 
                         //Check if the pixel is already written
                         image::RGBAfColor & dpix = ti.tileContent->operator()(py, px);
-                        image::RGBAfColor pix = source(source_y, source_x);
+                        image::RGBAfColor pix = source(source_y - sourceYBegin, source_x);
                         if (pix.a() > 0.9)
                         {
                             if (dpix.a() < 0.1)
@@ -349,34 +378,31 @@ int aliceVision_main(int argc, char** argv)
                 ti.filed = true;
             }
         }
-    }
 
-    image::Image<image::RGBAfColor> vide(tileSize, tileSize, true, image::RGBAfColor(0.0f, 0.0f, 0.0f, 0.0f));
-    for (int ty = 0; ty < tileCountHeight; ty++)
-    {
+        // Flush the row of tiles
         for (int tx = 0; tx < tileCountWidth; tx++)
         {
-            TileInfo& ti = tiles(ty, tx);
+            TileInfo& ti = tiles[tx];
 
             if (ti.filed)
             {
                 continue;
             }
-            
+
             if (ti.tileContent)
-            {   
+            {
                 panorama->write_tile (tx * tileSize, ty * tileSize, 0, oiio::TypeDesc::FLOAT, ti.tileContent->data());
             }
             else
-            { 
+            {
                 panorama->write_tile (tx * tileSize, ty * tileSize, 0, oiio::TypeDesc::FLOAT, vide.data());
             }
 
+            ti.tileContent = nullptr;
             ti.filed = true;
         }
     }
 
-
     panorama->close();
 
 
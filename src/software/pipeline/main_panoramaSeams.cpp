@@ -36,7 +36,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
@@ -87,7 +87,7 @@ bool computeWTALabels(image::Image<IndexT> & labels, const std::vector<std::shar
 
 bool computeGCLabels(image::Image<IndexT>& labels, const std::vector<std::shared_ptr<sfmData::View>>& views,
                      const std::string& inputPath, std::pair<int, int>& panoramaSize, int smallestViewScale,
-                     int downscale)
+                     int downscale, int refinementCorridor)
 {
     ALICEVISION_LOG_INFO("Estimating smart seams for panorama");
 
@@ -95,6 +95,7 @@ bool computeGCLabels(image::Image<IndexT>& labels, const std::vector<std::shared
     ALICEVISION_LOG_INFO("Graphcut pyramid size is " << pyramidSize);
 
     HierarchicalGraphcutSeams seams(panoramaSize.first / downscale, panoramaSize.second / downscale, pyramidSize);
+    seams.setRefinementCorridor(refinementCorridor);
 
     if (!seams.initialize(labels)) 
     {
@@ -172,6 +173,7 @@ int aliceVision_main(int argc, char** argv)
 
     int maxPanoramaWidth = 3000;
     bool useGraphCut = true;
+    int refinementCorridor = 20;
     image::EStorageDataType storageDataType = image::EStorageDataType::Float;
 
     // Description of mandatory parameters
@@ -186,7 +188,10 @@ int aliceVision_main(int argc, char** argv)
     po::options_description optionalParams("Optional parameters");
     optionalParams.add_options()
         ("maxWidth", po::value<int>(&maxPanoramaWidth)->required(), "Max Panorama Width.")
-        ("useGraphCut,g", po::value<bool>(&useGraphCut)->default_value(useGraphCut), "Enable graphcut algorithm to improve seams.");
+        ("useGraphCut,g", po::value<bool>(&useGraphCut)->default_value(useGraphCut), "Enable graphcut algorithm to improve seams.")
+        ("refinementCorridor", po::value<int>(&refinementCorridor)->default_value(refinementCorridor),
+         "Graphcut half width (in pixels) of the band around the coarser seams re-solved at each finer level "
+         "(0 to let the seams move over 20% of each level).");
 
     CmdLine cmdline("Estimates the ideal path for the transition between images in order to minimize seams artifacts.\n"
                     "AliceVision panoramaSeams");
@@ -199,7 +204,7 @@ int aliceVision_main(int argc, char** argv)
 
     // set maxThreads
     HardwareContext hwc = cmdline.getHardwareContext();
-    omp_set_num_threads(hwc.getMaxThreads());
+    hwc.setupThreads();
 
     // load input scene
     sfmData::SfMData sfmData;
@@ -337,7 +342,7 @@ int aliceVision_main(int argc, char** argv)
 
     if (useGraphCut)
     {
-        if(!computeGCLabels(labels, views, warpingFolder, panoramaSize, smallestScale, downscaleFactor))
+        if(!computeGCLabels(labels, views, warpingFolder, panoramaSize, smallestScale, downscaleFactor, refinementCorridor))
         {
             ALICEVISION_LOG_ERROR("Error computing graph cut labels");
             return EXIT_FAILURE;
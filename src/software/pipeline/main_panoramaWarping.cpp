@@ -19,14 +19,24 @@
 
 // Internal functions
 #include <aliceVision/panorama/coordinatesMap.hpp>
+#include <aliceVision/panorama/coordinatesMapCache.hpp>
 #include <aliceVision/panorama/remapBbox.hpp>
 #include <aliceVision/panorama/warper.hpp>
 #include <aliceVision/panorama/distance.hpp>
 
+#include <aliceVision/config.hpp>
+#include <aliceVision/gpu/gpu.hpp>
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+#include <aliceVision/panorama/cuda/DeviceWarper.hpp>
+#endif
+
+#include <memory>
+
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 2
 
 using namespace aliceVision;
 
@@ -103,6 +113,8 @@ int aliceVision_main(int argc, char** argv)
     int percentUpscale = 50;
     int tileSize = 256;
     int maxPanoramaWidth = 0;
+    bool useGpu = false;
+    std::string coordinatesMapCacheFolder;
 
     image::EStorageDataType storageDataType = image::EStorageDataType::Float;
 
@@ -127,7 +139,12 @@ int aliceVision_main(int argc, char** argv)
         "storageDataType", po::value<image::EStorageDataType>(&storageDataType)->default_value(storageDataType),
         ("Storage data type: " + image::EStorageDataType_informations()).c_str())(
         "rangeStart", po::value<int>(&rangeStart)->default_value(rangeStart),
-        "Range image index start.")("rangeSize", po::value<int>(&rangeSize)->default_value(rangeSize), "Range size.");
+        "Range image index start.")("rangeSize", po::value<int>(&rangeSize)->default_value(rangeSize), "Range size.")(
+        "useGpu", po::value<bool>(&useGpu)->default_value(useGpu),
+        "Sample the source images pyramids on the GPU (the coordinates maps are still computed on the CPU).")(
+        "coordinatesMapCache", po::value<std::string>(&coordinatesMapCacheFolder)->default_value(coordinatesMapCacheFolder),
+        "Folder to cache the coordinates maps. The views with the same intrinsics and pose (e.g. the frames of a fixed "
+        "rig) reuse the cached maps instead of recomputing them.");
 
     CmdLine cmdline("Warps the input images in the panorama coordinate system.\n"
                     "AliceVision panoramaWarping");
@@ -140,7 +157,18 @@ int aliceVision_main(int argc, char** argv)
 
     // set maxThreads
     HardwareContext hwc = cmdline.getHardwareContext();
-    omp_set_num_threads(hwc.getMaxThreads());
+    hwc.setupThreads();
+
+    if(useGpu)
+    {
+        ALICEVISION_LOG_INFO(gpu::gpuInformationCUDA());
+
+        if(!gpu::gpuSupportCUDA(2, 0))
+        {
+            ALICEVISION_LOG_ERROR("The GPU warping needs a CUDA-Enabled GPU (with at least compute capability 2.0).");
+            return EXIT_FAILURE;
+        }
+    }
 
     bool clampHalf = false;
     oiio::TypeDesc typeColor = oiio::TypeDesc::FLOAT;
@@ -234,6 +262,12 @@ int aliceVision_main(int argc, char** argv)
     std::memset(empty_float.get(), 0, tileSize * tileSize * 3 * sizeof(float));
     std::memset(empty_char.get(), 0, tileSize * tileSize * sizeof(char));
 
+    std::unique_ptr<CoordinatesMapCache> mapCache;
+    if(!coordinatesMapCacheFolder.empty())
+    {
+        mapCache.reset(new CoordinatesMapCache(coordinatesMapCacheFolder, tileSize));
+    }
+
     // Preprocessing per view
     for(std::size_t i = std::size_t(rangeStart); i < std::size_t(rangeStart + rangeSize); ++i)
     {
@@ -253,15 +287,43 @@ int aliceVision_main(int argc, char** argv)
         geometry::Pose3 camPose = sfmData.getPose(view).getTransform();
         std::shared_ptr<camera::IntrinsicBase> intrinsic = sfmData.getIntrinsicsharedPtr(view.getIntrinsicId());
 
+        // The cached maps already define the sub maps
+        std::string mapCacheKey;
+        int cachedSubMapsCount = 0;
+        if(mapCache)
+        {
+            mapCacheKey = mapCache->computeKey(panoramaSize, camPose, *(intrinsic.get()));
+            cachedSubMapsCount = mapCache->getSubMapsCount(mapCacheKey);
+
+            // A sub map cannot be computed alone, all the cached sub maps must be readable to use the cache
+            for(int idsub = 0; idsub < cachedSubMapsCount; idsub++)
+            {
+                BoundingBox cachedBbox;
+                if(!mapCache->openForReading(mapCacheKey, idsub, cachedBbox))
+                {
+                    ALICEVISION_LOG_WARNING("Cannot read the cached coordinates map " << mapCacheKey << "_" << idsub
+                                            << ", the coordinates maps are computed again.");
+                    cachedSubMapsCount = 0;
+                    break;
+                }
+            }
+            mapCache->close();
+        }
+
         // Compute coarse bounding box to make computations faster
         BoundingBox coarseBboxInitial;
-        if(!computeCoarseBB(coarseBboxInitial, panoramaSize, camPose, *(intrinsic.get())))
+        if(cachedSubMapsCount == 0 && !computeCoarseBB(coarseBboxInitial, panoramaSize, camPose, *(intrinsic.get())))
         {
             continue;
         }
 
         std::vector<BoundingBox> coarsesBbox;
-        if(coarseBboxInitial.width > coarseBboxInitial.height * 2.0)
+        if(cachedSubMapsCount > 0)
+        {
+            ALICEVISION_LOG_INFO("Use the cached coordinates maps " << mapCacheKey);
+            coarsesBbox.resize(cachedSubMapsCount);
+        }
+        else if(coarseBboxInitial.width > coarseBboxInitial.height * 2.0)
         {
             const int count = int(double(coarseBboxInitial.width) / double(coarseBboxInitial.height));
             const int width = coarseBboxInitial.width / count;
@@ -302,6 +364,16 @@ int aliceVision_main(int argc, char** argv)
             // Initialize bouding box for image
             BoundingBox globalBbox;
 
+            const bool cached = cachedSubMapsCount > 0 && mapCache->openForReading(mapCacheKey, idsub, globalBbox);
+            if(cachedSubMapsCount > 0 && !cached)
+            {
+                // The cache was checked before loading the image, the map was removed from the cache since
+                ALICEVISION_LOG_ERROR("Cannot read the cached coordinates map " << mapCacheKey << "_" << idsub
+                                      << ", the sub image " << idsub << " of the view " << view.getViewId() << " is not warped.");
+                continue;
+            }
+
+            if(!cached)
             {
                 // Search for first non empty box starting from the top
                 bool found = false;
@@ -349,6 +421,7 @@ int aliceVision_main(int argc, char** argv)
                 }
             }
 
+            if(!cached)
             {
                 // Search for first non empty box starting from the bottom
                 bool found = false;
@@ -395,6 +468,7 @@ int aliceVision_main(int argc, char** argv)
                 }
             }
 
+            if(!cached)
             {
                 // Search for first non empty box starting from the left
                 bool found = false;
@@ -441,6 +515,7 @@ int aliceVision_main(int argc, char** argv)
                 }
             }
 
+            if(!cached)
             {
                 // Search for first non empty box starting from the left
                 bool found = false;
@@ -496,6 +571,10 @@ int aliceVision_main(int argc, char** argv)
             globalBbox.width = std::min(globalBbox.width, panoramaSize.first);
             globalBbox.height = std::min(globalBbox.height, panoramaSize.second);
 
+            // Store the computed map for the next views with the same geometry
+            const bool writeCache =
+                mapCache && !cached && mapCache->openForWriting(mapCacheKey, idsub, int(coarsesBbox.size()), globalBbox);
+
             // Load metadata and update for output
             oiio::ParamValueList metadata = image::readImageMetadata(imagePath);
             metadata.push_back(oiio::ParamValue("AliceVision:offsetX", globalBbox.left));
@@ -552,6 +631,36 @@ int aliceVision_main(int argc, char** argv)
                 continue;
             }
 
+            // Upload the pyramid once, the tiles are sampled on the GPU
+            cuda::DeviceWarper* deviceWarper = nullptr;
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+            std::unique_ptr<cuda::DeviceWarper> deviceWarperPtr;
+            if(useGpu)
+            {
+                std::vector<cuda::DeviceWarperImage> levels;
+                for(const image::Image<image::RGBfColor>& level : pyramid.getPyramidColor())
+                {
+                    cuda::DeviceWarperImage deviceLevel;
+                    deviceLevel.data = reinterpret_cast<const float*>(level.data());
+                    deviceLevel.width = level.Width();
+                    deviceLevel.height = level.Height();
+                    levels.push_back(deviceLevel);
+                }
+
+                try
+                {
+                    deviceWarperPtr.reset(new cuda::DeviceWarper());
+                    deviceWarperPtr->setPyramid(levels);
+                    deviceWarper = deviceWarperPtr.get();
+                }
+                catch(const std::exception& e)
+                {
+                    ALICEVISION_LOG_WARNING("Cannot warp on the GPU, fallback to the CPU: " << e.what());
+                    deviceWarperPtr.reset();
+                }
+            }
+#endif
+
             std::vector<BoundingBox> boxes;
             for(int y = 0; y < globalBbox.height; y += tileSize)
             {
@@ -576,16 +685,34 @@ int aliceVision_main(int argc, char** argv)
 
                 // Prepare coordinates map
                 CoordinatesMap map;
-                if(!map.build(panoramaSize, camPose, *(intrinsic.get()), localBbox))
+                if(cached)
                 {
-                    continue;
+                    if(!mapCache->readTile(map, localBbox, x, y))
+                    {
+                        continue;
+                    }
+                }
+                else
+                {
+                    if(!map.build(panoramaSize, camPose, *(intrinsic.get()), localBbox))
+                    {
+                        continue;
+                    }
+
+                    if(writeCache)
+                    {
+                        mapCache->writeTile(map, x, y);
+                    }
                 }
 
                 // Warp image
                 GaussianWarper warper;
-                if(!warper.warp(map, pyramid, clampHalf))
+                if(deviceWarper == nullptr || !warper.warp(map, *deviceWarper, clampHalf))
                 {
-                    continue;
+                    if(!warper.warp(map, pyramid, clampHalf))
+                    {
+                        continue;
+                    }
                 }
 
                 // Alpha mask
@@ -617,6 +744,11 @@ int aliceVision_main(int argc, char** argv)
             out_view->close();
             out_mask->close();
             out_weights->close();
+
+            if(mapCache)
+            {
+                mapCache->close();
+            }
         }
     }
 
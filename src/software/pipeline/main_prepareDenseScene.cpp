@@ -5,9 +5,12 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfmData/NeighborCamsGraph.hpp>
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
 #include <aliceVision/image/all.hpp>
+#include <aliceVision/image/AsyncImageWriter.hpp>
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/MemoryInfo.hpp>
 #include <aliceVision/system/ProgressDisplay.hpp>
 #include <aliceVision/system/cmdline.hpp>
 #include <aliceVision/system/main.hpp>
@@ -17,6 +20,7 @@
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
 
+#include <algorithm>
 #include <stdlib.h>
 #include <stdio.h>
 #include <cmath>
@@ -29,7 +33,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 4
 
 using namespace aliceVision;
 using namespace aliceVision::camera;
@@ -41,10 +45,14 @@ using namespace aliceVision::sfmDataIO;
 namespace po = boost::program_options;
 namespace fs = boost::filesystem;
 
+/**
+ * @brief Read, correct the exposure, mask and undistort an image.
+ * @param[out] output the undistorted image
+ */
 template <class ImageT, class MaskFuncT>
-void process(const std::string &dstColorImage, const IntrinsicBase* cam, const oiio::ParamValueList & metadata, const std::string & srcImage, bool evCorrection, float exposureCompensation, MaskFuncT && maskFunc)
+void process(ImageT& output, const IntrinsicBase* cam, const std::string & srcImage, bool evCorrection, float exposureCompensation, UndistortionMapCache& undistortionMapCache, MaskFuncT && maskFunc)
 {
-  ImageT image, image_ud;
+  ImageT image;
   readImage(srcImage, image, image::EImageColorSpace::LINEAR);
 
   //exposure correction
@@ -62,15 +70,13 @@ void process(const std::string &dstColorImage, const IntrinsicBase* cam, const o
   // undistort
   if(cam->isValid() && cam->hasDistortion())
   {
-    // undistort the image and save it
     using Pix = typename ImageT::Tpixel;
     Pix pixZero(Pix::Zero());
-    UndistortImage(image, cam, image_ud, pixZero);
-    writeImage(dstColorImage, image_ud, image::ImageWriteOptions(), metadata);
+    UndistortImage(image, cam, output, pixZero, undistortionMapCache);
   }
   else
   {
-    writeImage(dstColorImage, image, image::ImageWriteOptions(), metadata);
+    output.swap(image);
   }
 }
 
@@ -83,10 +89,16 @@ bool prepareDenseScene(const SfMData& sfmData,
                        image::EImageFileType outputFileType,
                        bool saveMetadata,
                        bool saveMatricesFiles,
-                       bool evCorrection)
+                       bool evCorrection,
+                       std::size_t undistortionMapsMaxMemory,
+                       bool undistortionMapsHalfPrecision,
+                       bool outputMipmaps,
+                       bool outputImages,
+                       unsigned int maxThreads,
+                       std::size_t maxMemory)
 {
   // defined view Ids
-  std::set<IndexT> viewIds;
+  std::vector<IndexT> viewIds;
 
   sfmData::Views::const_iterator itViewBegin = sfmData.getViews().begin();
   sfmData::Views::const_iterator itViewEnd = sfmData.getViews().end();
@@ -105,13 +117,16 @@ bool prepareDenseScene(const SfMData& sfmData,
     const View* view = it->second.get();
     if (!sfmData.isPoseAndIntrinsicDefined(view))
       continue;
-    viewIds.insert(view->getViewId());
+    viewIds.push_back(view->getViewId());
   }
 
   if((outputFileType != image::EImageFileType::EXR) && saveMetadata)
     ALICEVISION_LOG_WARNING("Cannot save informations in images metadata.\n"
                             "Choose '.exr' file type if you want AliceVision custom metadata");
 
+  if(!outputImages)
+    ALICEVISION_LOG_INFO("The undistorted images are not written, the dense steps undistort the source images when they read them.");
+
   // export data
   auto progressDisplay = system::createConsoleProgressDisplay(viewIds.size(), std::cout,
                                                               "Exporting Scene Undistorted Images\n");
@@ -120,13 +135,40 @@ bool prepareDenseScene(const SfMData& sfmData,
   const double medianCameraExposure = sfmData.getMedianCameraExposureSetting().getExposure();
   ALICEVISION_LOG_INFO("Median Camera Exposure: " << medianCameraExposure << ", Median EV: " << std::log2(1.0/medianCameraExposure));
 
-#pragma omp parallel for num_threads(3)
-  for(int i = 0; i < viewIds.size(); ++i)
+  // undistortion maps shared by the views of the same intrinsic
+  UndistortionMapCache undistortionMapCache(undistortionMapsMaxMemory * 1024 * 1024, undistortionMapsHalfPrecision);
+
+  // the reduced resolution levels allow the dense steps to read the images at their processing scale
+  const image::ImageWriteOptions writeOptions = image::ImageWriteOptions().exrMipmaps(outputMipmaps);
+
+  // the images are encoded in a thread while the next ones are decoded and undistorted
+  const std::size_t writeBufferSize = 2;
+  image::AsyncImageWriter imageWriter(writeBufferSize);
+
+  // each thread holds a decoded and an undistorted image, the threads and the write buffer fit in 90% of the available RAM
+  std::size_t maxImageSize = 0;
+  for(const IndexT viewId : viewIds)
   {
-    auto itView = viewIds.begin();
-    std::advance(itView, i);
+    const View& view = *(sfmData.getViews().at(viewId));
+    maxImageSize = std::max(maxImageSize, view.getWidth() * view.getHeight() * sizeof(RGBAfColor));
+  }
 
-    const IndexT viewId = *itView;
+  int nbThreads = int(maxThreads);
+  if(outputImages)
+  {
+    const system::MemoryInfo memoryInformation = system::getMemoryInfo();
+    std::size_t memoryBudget = std::size_t(0.9 * std::min(memoryInformation.availableRam, maxMemory));
+    memoryBudget -= std::min(memoryBudget, (writeBufferSize + 1) * maxImageSize);
+    const std::size_t maxThreadsInBudget = memoryBudget / std::max(std::size_t(1), 2 * maxImageSize);
+    nbThreads = int(std::max(std::size_t(1), std::min(std::size_t(maxThreads), maxThreadsInBudget)));
+  }
+
+  ALICEVISION_LOG_INFO("Prepare the images with " << nbThreads << " thread(s).");
+
+#pragma omp parallel for schedule(dynamic) num_threads(nbThreads)
+  for(int i = 0; i < viewIds.size(); ++i)
+  {
+    const IndexT viewId = viewIds[i];
     const View* view = sfmData.getViews().at(viewId).get();
 
     Intrinsics::const_iterator iterIntrinsic = sfmData.getIntrinsics().find(view->getIntrinsicId());
@@ -136,7 +178,9 @@ bool prepareDenseScene(const SfMData& sfmData,
 
     // get metadata from source image to be sure we get all metadata. We don't use the metadatas from the Views inside the SfMData to avoid type conversion problems with string maps.
     std::string srcImage = view->getImagePath();
-    oiio::ParamValueList metadata = image::readImageMetadata(srcImage);
+    oiio::ParamValueList metadata;
+    if(outputImages)
+      metadata = image::readImageMetadata(srcImage);
 
     // export camera
     if(saveMetadata || saveMatricesFiles)
@@ -209,25 +253,36 @@ bool prepareDenseScene(const SfMData& sfmData,
       }
     }
 
-    // export undistort image
-    {      
-      if(!imagesFolders.empty())
-      {
-          std::vector<std::string> paths = sfmDataIO::viewPathsFromFolders(*view, imagesFolders);
+    if(!imagesFolders.empty())
+    {
+        std::vector<std::string> paths = sfmDataIO::viewPathsFromFolders(*view, imagesFolders);
 
-          // if path was not found
-          if(paths.empty())
-          {
-              throw std::runtime_error("Cannot find view '" + std::to_string(view->getViewId()) + "' image file in given folder(s)");
-          }
-          else if(paths.size() > 1)
-          {
-              throw std::runtime_error( "Ambiguous case: Multiple source image files found in given folder(s) for the view '" + 
-                  std::to_string(view->getViewId()) + "'.");
-          }
+        // if path was not found
+        if(paths.empty())
+        {
+            throw std::runtime_error("Cannot find view '" + std::to_string(view->getViewId()) + "' image file in given folder(s)");
+        }
+        else if(paths.size() > 1)
+        {
+            throw std::runtime_error( "Ambiguous case: Multiple source image files found in given folder(s) for the view '" + 
+                std::to_string(view->getViewId()) + "'.");
+        }
 
-          srcImage = paths[0];
-      }
+        srcImage = paths[0];
+    }
+
+    if(!outputImages)
+    {
+      // the dense steps read the source image and its mask from this file and undistort them
+      // (see mvsUtils::MultiViewParams)
+      std::ofstream sourceFile((fs::path(outFolder) / (baseFilename + "_source.txt")).string());
+      sourceFile << srcImage << "\n"
+                 << image::findMaskPath(masksFolders, viewId, srcImage) << "\n";
+    }
+
+    // export undistort image
+    if(outputImages)
+    {
       const std::string dstColorImage = (fs::path(outFolder) / (baseFilename + "." + image::EImageFileType_enumToString(outputFileType))).string();
       const IntrinsicBase* cam = iterIntrinsic->second.get();
 
@@ -243,10 +298,11 @@ bool prepareDenseScene(const SfMData& sfmData,
           ALICEVISION_LOG_INFO("image " << viewId << ", exposure: " << cameraExposure << ", Ev " << ev << " Ev compensation: " + std::to_string(exposureCompensation));
       }
 
+      Image<RGBAfColor> image_ud;
       image::Image<unsigned char> mask;
       if(tryLoadMask(&mask, masksFolders, viewId, srcImage))
       {
-        process<Image<RGBAfColor>>(dstColorImage, cam, metadata, srcImage, evCorrection, exposureCompensation, [&mask] (Image<RGBAfColor> & image)
+        process(image_ud, cam, srcImage, evCorrection, exposureCompensation, undistortionMapCache, [&mask] (Image<RGBAfColor> & image)
         {
           if(image.Width() * image.Height() != mask.Width() * mask.Height())
           {
@@ -264,13 +320,32 @@ bool prepareDenseScene(const SfMData& sfmData,
       else
       {
         const auto noMaskingFunc = [] (Image<RGBAfColor> & image) {};
-        process<Image<RGBAfColor>>(dstColorImage, cam, metadata, srcImage, evCorrection, exposureCompensation, noMaskingFunc);
+        process(image_ud, cam, srcImage, evCorrection, exposureCompensation, undistortionMapCache, noMaskingFunc);
+      }
+
+      try
+      {
+        imageWriter.write(dstColorImage, std::move(image_ud), writeOptions, metadata);
+      }
+      catch(const std::exception&)
+      {
+        // the write error is reported once all the views are processed
       }
     }
 
     ++progressDisplay;
   }
 
+  try
+  {
+    imageWriter.wait();
+  }
+  catch(const std::exception& e)
+  {
+    ALICEVISION_LOG_ERROR(e.what());
+    return false;
+  }
+
   return true;
 }
 
@@ -289,6 +364,13 @@ int aliceVision_main(int argc, char *argv[])
   bool saveMetadata = true;
   bool saveMatricesTxtFiles = false;
   bool evCorrection = false;
+  std::size_t undistortionMapsMaxMemory = 1024;
+  bool undistortionMapsHalfPrecision = false;
+  bool outputMipmaps = false;
+  bool saveNeighborCamsGraph = true;
+  float minViewAngle = 2.0f;
+  float maxViewAngle = 70.0f;
+  bool outputImages = true;
 
   po::options_description requiredParams("Required parameters");
   requiredParams.add_options()
@@ -316,7 +398,24 @@ int aliceVision_main(int argc, char *argv[])
     ("rangeSize", po::value<int>(&rangeSize)->default_value(rangeSize),
       "Range size.")
     ("evCorrection", po::value<bool>(&evCorrection)->default_value(evCorrection),
-      "Correct exposure value.");
+      "Correct exposure value.")
+    ("undistortionMapsMaxMemory", po::value<std::size_t>(&undistortionMapsMaxMemory)->default_value(undistortionMapsMaxMemory),
+      "Memory limit of the undistortion maps shared by the images of the same intrinsic (MB).")
+    ("undistortionMapsHalfPrecision", po::value<bool>(&undistortionMapsHalfPrecision)->default_value(undistortionMapsHalfPrecision),
+      "Store the undistortion maps in half precision to use less memory.")
+    ("outputMipmaps", po::value<bool>(&outputMipmaps)->default_value(outputMipmaps),
+      "Write the EXR images as tiles with their reduced resolution levels, "
+      "so the images are read faster at a lower processing scale.")
+    ("outputImages", po::value<bool>(&outputImages)->default_value(outputImages),
+      "Write the undistorted images. Otherwise, the source image and mask paths are written in <viewId>_source.txt files "
+      "and the dense steps undistort the source images when they read them.")
+    ("saveNeighborCamsGraph", po::value<bool>(&saveNeighborCamsGraph)->default_value(saveNeighborCamsGraph),
+      "Save the neighbor cameras of each view, computed once from the landmarks, "
+      "for the depth map estimation and filtering.")
+    ("minViewAngle", po::value<float>(&minViewAngle)->default_value(minViewAngle),
+      "Minimum angle between two views of a shared landmark in the neighbor cameras graph.")
+    ("maxViewAngle", po::value<float>(&maxViewAngle)->default_value(maxViewAngle),
+      "Maximum angle between two views of a shared landmark in the neighbor cameras graph.");
 
   CmdLine cmdline("AliceVision prepareDenseScene");
   cmdline.add(requiredParams);
@@ -363,8 +462,19 @@ int aliceVision_main(int argc, char *argv[])
     rangeStart = 0;
   }
 
+  // the neighbor cameras graph is computed by the first chunk only
+  if(saveNeighborCamsGraph && rangeStart == 0)
+  {
+    NeighborCamsGraph neighborCamsGraph;
+    neighborCamsGraph.build(sfmData, minViewAngle, maxViewAngle);
+    if(!neighborCamsGraph.save((fs::path(outFolder) / neighborCamsGraphFilename).string()))
+      return EXIT_FAILURE;
+  }
+
+  HardwareContext hwc = cmdline.getHardwareContext();
+
   // export
-  if(prepareDenseScene(sfmData, imagesFolders, masksFolders, rangeStart, rangeEnd, outFolder, outputFileType, saveMetadata, saveMatricesTxtFiles, evCorrection))
+  if(prepareDenseScene(sfmData, imagesFolders, masksFolders, rangeStart, rangeEnd, outFolder, outputFileType, saveMetadata, saveMatricesTxtFiles, evCorrection, undistortionMapsMaxMemory, undistortionMapsHalfPrecision, outputMipmaps, outputImages, hwc.getMaxThreads(), hwc.getUserMaxMemoryAvailable()))
     return EXIT_SUCCESS;
 
   return EXIT_FAILURE;
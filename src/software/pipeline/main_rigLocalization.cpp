@@ -5,13 +5,14 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include <aliceVision/config.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 #include <aliceVision/localization/VoctreeLocalizer.hpp>
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CCTAG)
 #include <aliceVision/localization/CCTagLocalizer.hpp>
 #endif
 #include <aliceVision/rig/Rig.hpp>
 #include <aliceVision/image/io.hpp>
-#include <aliceVision/dataio/FeedProvider.hpp>
+#include <aliceVision/dataio/AsyncFeedProvider.hpp>
 #include <aliceVision/feature/ImageDescriber.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
@@ -45,7 +46,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 2
 
 using namespace aliceVision;
 
@@ -103,6 +104,8 @@ int aliceVision_main(int argc, char** argv)
   std::size_t numResults = 4;
   /// maximum number of matching documents to retain
   std::size_t maxResults = 10;
+  /// number of frames localized at the same time
+  int nbConcurrentQueries = 1;
   
   // parameters for cctag localizer
   std::size_t nNearestKeyFrames = 5;
@@ -178,6 +181,8 @@ int aliceVision_main(int argc, char** argv)
           "[voctree] Maximum matching error (in pixels) allowed for image matching with "
           "geometric verification. If set to 0 it lets the ACRansac select "
           "an optimal value.")
+      ("nbConcurrentQueries", po::value<int>(&nbConcurrentQueries)->default_value(nbConcurrentQueries),
+          "[voctree] Number of rig frames localized at the same time, 0 to use all the cores.")
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CCTAG)
   // parameters for cctag localizer
       ("nNearestKeyFrames", po::value<std::size_t>(&nNearestKeyFrames)->default_value(nNearestKeyFrames),
@@ -297,6 +302,15 @@ int aliceVision_main(int argc, char** argv)
     return EXIT_FAILURE;
   }
 
+  // only the voctree localizer supports concurrent queries
+  if(nbConcurrentQueries <= 0)
+    nbConcurrentQueries = omp_get_max_threads();
+  if(!useVoctreeLocalizer && nbConcurrentQueries > 1)
+  {
+    ALICEVISION_LOG_WARNING("The CCTag localizer localizes the frames one at a time.");
+    nbConcurrentQueries = 1;
+  }
+
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ALEMBIC)
   sfmDataIO::AlembicExporter exporter(exportAlembicFile);
   exporter.initAnimatedCamera("rig");
@@ -316,7 +330,7 @@ int aliceVision_main(int argc, char** argv)
   }
 #endif
 
-  std::vector<dataio::FeedProvider*> feeders(numCameras);
+  std::vector<std::unique_ptr<dataio::AsyncFeedProvider>> feeders(numCameras);
   std::vector<std::string> subMediaFilepath(numCameras);
   
   // Init the feeder for each camera
@@ -330,8 +344,8 @@ int aliceVision_main(int argc, char** argv)
           (mediaPath[idCamera]) : 
           (bfs::path(mediaPath[idCamera]).parent_path().string());
 
-    // create the feedProvider
-    feeders[idCamera] = new dataio::FeedProvider(feedPath, calibFile);
+    // create the feedProvider, each camera is decoded in its own thread during the localization
+    feeders[idCamera].reset(new dataio::AsyncFeedProvider(feedPath, calibFile));
     if(!feeders[idCamera]->isInit())
     {
       ALICEVISION_CERR("ERROR while initializing the FeedProvider for the camera " 
@@ -350,115 +364,142 @@ int aliceVision_main(int argc, char** argv)
   if(numCameras > 1)
     rig::loadRigCalibration(rigCalibPath, vec_subPoses);
   assert(vec_subPoses.size() == numCameras-1);
-  geometry::Pose3 rigPose;
   
   // Define an accumulator set for computing the mean and the
   // standard deviation of the time taken for localization
   bacc::accumulator_set<double, bacc::stats<bacc::tag::mean, bacc::tag::min, bacc::tag::max, bacc::tag::sum > > stats;
 
-  // store the result
-  std::vector< std::vector<localization::LocalizationResult> > rigResultPerFrame;
-  
+  /// the frame of each camera of the rig to localize
+  struct RigQuery
+  {
+    std::vector<image::Image<float>> vec_imageGrey;
+    std::vector<camera::PinholeRadialK3> vec_queryIntrinsics;
+    /// each frame has its own seed, the results do not depend on the concurrent frames
+    std::mt19937::result_type seed = 0;
+    geometry::Pose3 rigPose;
+    std::vector<localization::LocalizationResult> localizationResults;
+    bool isLocalized = false;
+    /// localization time in [ms]
+    double time = 0.0;
+  };
+
+  // the frames are localized by batches, a few frames by concurrent query keep all the threads busy
+  const std::size_t batchSize = (nbConcurrentQueries > 1) ? 4 * nbConcurrentQueries : 1;
+  std::vector<RigQuery> queries(batchSize);
+
   while(haveImage)
   {
-    // @fixme It's better to have arrays of pointers...
-    std::vector<image::Image<float> > vec_imageGrey;
-    std::vector<camera::PinholeRadialK3 > vec_queryIntrinsics;
-    vec_imageGrey.reserve(numCameras);
-    vec_queryIntrinsics.reserve(numCameras);
-           
-    // for each camera get the image and the associated internal parameters
-    for(std::size_t idCamera = 0; idCamera < numCameras; ++idCamera)
+    std::size_t nbQueries = 0;
+    while(nbQueries < batchSize)
     {
-      image::Image<float> imageGrey;
-      camera::PinholeRadialK3 queryIntrinsics;
-      bool hasIntrinsics = false;
-      std::string currentImgName;
-      haveImage = feeders[idCamera]->readImage(imageGrey, queryIntrinsics, currentImgName, hasIntrinsics);
-      feeders[idCamera]->goToNextFrame();
+      RigQuery& query = queries[nbQueries];
+      // @fixme It's better to have arrays of pointers...
+      query.vec_imageGrey.resize(numCameras);
+      query.vec_queryIntrinsics.resize(numCameras);
 
-      if(!haveImage)
+      // for each camera get the image and the associated internal parameters
+      for(std::size_t idCamera = 0; idCamera < numCameras; ++idCamera)
       {
-        if(idCamera > 0)
+        bool hasIntrinsics = false;
+        std::string currentImgName;
+        haveImage = feeders[idCamera]->readImage(query.vec_imageGrey[idCamera], query.vec_queryIntrinsics[idCamera], currentImgName, hasIntrinsics);
+        feeders[idCamera]->goToNextFrame();
+
+        if(!haveImage)
+        {
+          if(idCamera > 0)
+          {
+            // this is quite odd, it means that eg the fist camera has an image but
+            // one of the others has not image
+            ALICEVISION_CERR("This is weird... Camera " << idCamera << " seems not to have any available images while some other cameras do...");
+            return EXIT_FAILURE;  // a bit harsh but if we are here it's cheesy to say the less
+          }
+          break;
+        }
+
+        // for now let's suppose that the cameras are calibrated internally too
+        if(!hasIntrinsics)
         {
-          // this is quite odd, it means that eg the fist camera has an image but
-          // one of the others has not image
-          ALICEVISION_CERR("This is weird... Camera " << idCamera << " seems not to have any available images while some other cameras do...");
+          ALICEVISION_CERR("For now only internally calibrated cameras are supported!"
+                  << "\nCamera " << idCamera << " does not have calibration for image " << currentImgName);
           return EXIT_FAILURE;  // a bit harsh but if we are here it's cheesy to say the less
         }
-        break;
       }
-      
-      // for now let's suppose that the cameras are calibrated internally too
-      if(!hasIntrinsics)
+
+      if(!haveImage)
       {
-        ALICEVISION_CERR("For now only internally calibrated cameras are supported!"
-                << "\nCamera " << idCamera << " does not have calibration for image " << currentImgName);
-        return EXIT_FAILURE;  // a bit harsh but if we are here it's cheesy to say the less
+        // no more images are available
+        break;
       }
-      
-      vec_imageGrey.push_back(imageGrey);
-      vec_queryIntrinsics.push_back(queryIntrinsics);
+
+      query.seed = randomNumberGenerator();
+      ++nbQueries;
     }
-    
-    if(!haveImage)
+
+    #pragma omp parallel for num_threads(nbConcurrentQueries) schedule(dynamic)
+    for(int i = 0; i < static_cast<int>(nbQueries); ++i)
     {
-      // no more images are available
-      break;
+      RigQuery& query = queries[i];
+      std::mt19937 queryGenerator(query.seed);
+      query.localizationResults.clear();
+
+      const auto detect_start = std::chrono::steady_clock::now();
+      query.isLocalized = localizer->localizeRig(query.vec_imageGrey,
+                                                 param.get(),
+                                                 queryGenerator,
+                                                 query.vec_queryIntrinsics,
+                                                 vec_subPoses,
+                                                 query.rigPose,
+                                                 query.localizationResults);
+      const auto detect_end = std::chrono::steady_clock::now();
+      query.time = std::chrono::duration<double, std::milli>(detect_end - detect_start).count();
     }
-    
-    ALICEVISION_COUT("******************************");
-    ALICEVISION_COUT("FRAME " << utils::toStringZeroPadded(frameCounter, 4));
-    ALICEVISION_COUT("******************************");
-    auto detect_start = std::chrono::steady_clock::now();
-    std::vector<localization::LocalizationResult> localizationResults;
-    const bool isLocalized = localizer->localizeRig(vec_imageGrey,
-                                                    param.get(),
-                                                    randomNumberGenerator,
-                                                    vec_queryIntrinsics,
-                                                    vec_subPoses,
-                                                    rigPose,
-                                                    localizationResults);
-    auto detect_end = std::chrono::steady_clock::now();
-    auto detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
-    ALICEVISION_COUT("Localization took  " << detect_elapsed.count() << " [ms]");
-    stats(detect_elapsed.count());
-    
-    rigResultPerFrame.push_back(localizationResults);
-    
-    if(isLocalized)
+
+    for(std::size_t i = 0; i < nbQueries; ++i)
     {
-      ++numLocalizedFrames;
-#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ALEMBIC)
-      // save the position of the main camera
-      exporter.addCameraKeyframe(rigPose, &vec_queryIntrinsics[0], subMediaFilepath[0], frameCounter, frameCounter);
-      assert(cameraExporters.size()==numCameras);
-      assert(localizationResults.size()==numCameras);
-      assert(vec_queryIntrinsics.size()==numCameras);
-      // save the position of all cameras of the rig
-      for(std::size_t camIDX = 0; camIDX < numCameras; ++camIDX)
+      const RigQuery& query = queries[i];
+      const std::vector<localization::LocalizationResult>& localizationResults = query.localizationResults;
+
+      ALICEVISION_COUT("******************************");
+      ALICEVISION_COUT("FRAME " << utils::toStringZeroPadded(frameCounter, 4));
+      ALICEVISION_COUT("******************************");
+      ALICEVISION_COUT("Localization took  " << query.time << " [ms]");
+      stats(query.time);
+
+      if(query.isLocalized)
       {
-        ALICEVISION_COUT("cam pose" << camIDX << "\n" <<  localizationResults[camIDX].getPose().rotation() << "\n" << localizationResults[camIDX].getPose().center());
-        if(camIDX > 0)
-          ALICEVISION_COUT("cam subpose" << camIDX-1 << "\n" <<  vec_subPoses[camIDX-1].rotation() << "\n" << vec_subPoses[camIDX-1].center());
-        cameraExporters[camIDX].addCameraKeyframe(localizationResults[camIDX].getPose(), &vec_queryIntrinsics[camIDX], subMediaFilepath[camIDX], frameCounter, frameCounter);
-      }
-#endif
-    }
-    else
-    {
-     ALICEVISION_CERR("Unable to localize frame " << frameCounter);
+        ++numLocalizedFrames;
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ALEMBIC)
-      exporter.jumpKeyframe();
-      assert(cameraExporters.size()==numCameras);
-      for(std::size_t camIDX = 0; camIDX < numCameras; ++camIDX)
-      {
-        cameraExporters[camIDX].jumpKeyframe();
+        // save the position of the main camera
+        exporter.addCameraKeyframe(query.rigPose, &query.vec_queryIntrinsics[0], subMediaFilepath[0], frameCounter, frameCounter);
+        assert(cameraExporters.size()==numCameras);
+        assert(localizationResults.size()==numCameras);
+        assert(query.vec_queryIntrinsics.size()==numCameras);
+        // save the position of all cameras of the rig
+        for(std::size_t camIDX = 0; camIDX < numCameras; ++camIDX)
+        {
+          ALICEVISION_COUT("cam pose" << camIDX << "\n" <<  localizationResults[camIDX].getPose().rotation() << "\n" << localizationResults[camIDX].getPose().center());
+          if(camIDX > 0)
+            ALICEVISION_COUT("cam subpose" << camIDX-1 << "\n" <<  vec_subPoses[camIDX-1].rotation() << "\n" << vec_subPoses[camIDX-1].center());
+          cameraExporters[camIDX].addCameraKeyframe(localizationResults[camIDX].getPose(), &query.vec_queryIntrinsics[camIDX], subMediaFilepath[camIDX], frameCounter, frameCounter);
+        }
+#endif
       }
+      else
+      {
+       ALICEVISION_CERR("Unable to localize frame " << frameCounter);
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ALEMBIC)
+        exporter.jumpKeyframe();
+        assert(cameraExporters.size()==numCameras);
+        for(std::size_t camIDX = 0; camIDX < numCameras; ++camIDX)
+        {
+          cameraExporters[camIDX].jumpKeyframe();
+        }
 #endif
-    }
+      }
 
-    ++frameCounter;
+      ++frameCounter;
+    }
   }
   
   // print out some time stats
@@ -0,0 +1,170 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfmDataIO/sfmDataIO.hpp>
+#include <aliceVision/sfm/pipeline/PipelineRunner.hpp>
+#include <aliceVision/feature/imageDescriberCommon.hpp>
+#include <aliceVision/feature/feature.hpp>
+#include <aliceVision/matching/matcherType.hpp>
+#include <aliceVision/matchingImageCollection/GeometricFilterType.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/main.hpp>
+#include <aliceVision/system/cmdline.hpp>
+
+#include <boost/program_options.hpp>
+#include <boost/filesystem.hpp>
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+
+namespace po = boost::program_options;
+namespace fs = boost::filesystem;
+
+/// - Extract the features of the views
+/// - Match them on all the image pairs
+/// - Reconstruct the scene with the incremental SfM
+/// The regions and the matches are passed in memory, their files are only written as optional checkpoints.
+int aliceVision_main(int argc, char **argv)
+{
+  // command-line parameters
+  std::string sfmDataFilename;
+  std::string outputSfM;
+
+  // user optional parameters
+
+  std::string extraInfoFolder;
+  std::string describerTypesName = feature::EImageDescriberType_enumToString(feature::EImageDescriberType::SIFT);
+  feature::ConfigurationPreset featDescConfig;
+  std::string nearestMatchingMethod = "ANN_L2";
+  std::string geometricFilterTypeName = matchingImageCollection::EGeometricFilterType_enumToString(matchingImageCollection::EGeometricFilterType::FUNDAMENTAL_MATRIX);
+  int maxThreads = 0;
+
+  sfm::PipelineRunner::Params params;
+
+  po::options_description requiredParams("Required parameters");
+  requiredParams.add_options()
+    ("input,i", po::value<std::string>(&sfmDataFilename)->required(),
+      "SfMData file.")
+    ("output,o", po::value<std::string>(&outputSfM)->required(),
+      "Path to the output SfMData file.");
+
+  po::options_description optionalParams("Optional parameters");
+  optionalParams.add_options()
+    ("extraInfoFolder", po::value<std::string>(&extraInfoFolder)->default_value(extraInfoFolder),
+      "Folder for intermediate reconstruction files and additional reconstruction information files.")
+    ("describerTypes,d", po::value<std::string>(&describerTypesName)->default_value(describerTypesName),
+      feature::EImageDescriberType_informations().c_str())
+    ("describerPreset,p", po::value<feature::EImageDescriberPreset>(&featDescConfig.descPreset)->default_value(featDescConfig.descPreset),
+      "Control the ImageDescriber configuration (low, medium, normal, high, ultra).")
+    ("describerQuality", po::value<feature::EFeatureQuality>(&featDescConfig.quality)->default_value(featDescConfig.quality),
+      feature::EFeatureQuality_information().c_str())
+    ("featuresFolder", po::value<std::string>(&params.featuresFolder)->default_value(params.featuresFolder),
+      "Checkpoint folder of the features and descriptors files. "
+      "The up-to-date files are loaded instead of extracted, nothing is written if empty.")
+    ("matchesFolder", po::value<std::string>(&params.matchesFolder)->default_value(params.matchesFolder),
+      "Checkpoint folder of the matches files, nothing is written if empty.")
+    ("photometricMatchingMethod", po::value<std::string>(&nearestMatchingMethod)->default_value(nearestMatchingMethod),
+      "Nearest matching method (see featureMatching).")
+    ("geometricFilterType,g", po::value<std::string>(&geometricFilterTypeName)->default_value(geometricFilterTypeName),
+      matchingImageCollection::EGeometricFilterType_informations().c_str())
+    ("geometricEstimator", po::value<robustEstimation::ERobustEstimator>(&params.geometricEstimator)->default_value(params.geometricEstimator),
+      "Geometric estimator: acransac or loransac (only available for fundamental matrix, need to set '--geometricError').")
+    ("geometricError", po::value<double>(&params.geometricErrorMax)->default_value(params.geometricErrorMax),
+      "Maximum error (in pixels) allowed for features matching during geometric verification. "
+      "If set to 0 it lets the ACRansac select an optimal value.")
+    ("distanceRatio", po::value<float>(&params.distRatio)->default_value(params.distRatio),
+      "Distance ratio to discard non meaningful matches.")
+    ("maxIteration", po::value<int>(&params.maxIteration)->default_value(params.maxIteration),
+      "Maximum number of iterations allowed in ransac step.")
+    ("guidedMatching", po::value<bool>(&params.guidedMatching)->default_value(params.guidedMatching),
+      "Use the found model to improve the pairwise correspondences.")
+    ("crossMatching", po::value<bool>(&params.crossMatching)->default_value(params.crossMatching),
+      "Make sure that the matching process is symmetric (same matches for I->J than fo J->I).")
+    ("maxMatches", po::value<std::size_t>(&params.numMatchesToKeep)->default_value(params.numMatchesToKeep),
+      "Maximum number of matches to keep per pair (0 for all).")
+    ("minRequired2DMotion", po::value<double>(&params.minRequired2DMotion)->default_value(params.minRequired2DMotion),
+      "Filter out matches without enough 2D motion (threshold in pixels, -1 to disable).")
+    ("minInputTrackLength", po::value<int>(&params.sfmParams.minInputTrackLength)->default_value(params.sfmParams.minInputTrackLength),
+      "Minimum track length in input of SfM.")
+    ("maxReprojectionError", po::value<double>(&params.sfmParams.maxReprojectionError)->default_value(params.sfmParams.maxReprojectionError),
+      "Maximum reprojection error.")
+    ("lockAllIntrinsics", po::value<bool>(&params.sfmParams.lockAllIntrinsics)->default_value(params.sfmParams.lockAllIntrinsics),
+      "Force lock of all camera intrinsic parameters, so they will not be refined during Bundle Adjustment.")
+    ("useLocalBA,l", po::value<bool>(&params.sfmParams.useLocalBundleAdjustment)->default_value(params.sfmParams.useLocalBundleAdjustment),
+      "Enable/Disable the Local bundle adjustment strategy.")
+    ("computeStructureColor", po::value<bool>(&params.computeStructureColor)->default_value(params.computeStructureColor),
+      "Compute each 3D point color.")
+    ("randomSeed", po::value<int>(&params.randomSeed)->default_value(params.randomSeed),
+      "This seed value will generate a sequence using a linear random generator. Set -1 to use a random seed.")
+    ("maxThreads", po::value<int>(&maxThreads)->default_value(maxThreads),
+      "Specifies the maximum number of threads to run simultaneously (0 for automatic mode).");
+
+  CmdLine cmdline("In-process features extraction, features matching and incremental reconstruction.\n"
+                  "AliceVision sfmPipeline");
+  cmdline.add(requiredParams);
+  cmdline.add(optionalParams);
+  if(!cmdline.execute(argc, argv))
+  {
+    return EXIT_FAILURE;
+  }
+
+  if(describerTypesName.empty())
+  {
+    ALICEVISION_LOG_ERROR("--describerTypes option is empty.");
+    return EXIT_FAILURE;
+  }
+
+  // load input scene
+  sfmData::SfMData sfmData;
+  if(!sfmDataIO::Load(sfmData, sfmDataFilename, sfmDataIO::ESfMData(sfmDataIO::VIEWS|sfmDataIO::INTRINSICS)))
+  {
+    ALICEVISION_LOG_ERROR("The input SfMData file '" + sfmDataFilename + "' cannot be read.");
+    return EXIT_FAILURE;
+  }
+
+  if(extraInfoFolder.empty())
+    extraInfoFolder = fs::path(outputSfM).parent_path().string();
+
+  params.matcherType = matching::EMatcherType_stringToEnum(nearestMatchingMethod);
+  params.geometricFilterType = matchingImageCollection::EGeometricFilterType_stringToEnum(geometricFilterTypeName);
+  params.outputSfMData = outputSfM;
+
+  sfm::PipelineRunner runner(sfmData, extraInfoFolder, params);
+
+  for(const auto& imageDescriberType : feature::EImageDescriberType_stringToEnums(describerTypesName))
+  {
+    std::shared_ptr<feature::ImageDescriber> imageDescriber = feature::createImageDescriber(imageDescriberType);
+    imageDescriber->setConfigurationPreset(featDescConfig);
+    imageDescriber->setUseCuda(false);
+    runner.addImageDescriber(imageDescriber);
+  }
+
+  // set maxThreads
+  HardwareContext hwc = cmdline.getHardwareContext();
+  hwc.setUserCoresLimit(maxThreads);
+  hwc.setupThreads();
+
+  system::Timer timer;
+
+  if(!runner.process(hwc))
+  {
+    ALICEVISION_LOG_ERROR("The reconstruction failed.");
+    return EXIT_FAILURE;
+  }
+
+  ALICEVISION_LOG_INFO("Task done in (s): " + std::to_string(timer.elapsed()));
+  return EXIT_SUCCESS;
+}
@@ -14,6 +14,7 @@
 #include <aliceVision/mvsUtils/common.hpp>
 #include <aliceVision/mvsUtils/MultiViewParams.hpp>
 #include <aliceVision/mvsUtils/ImagesCache.hpp>
+#include <aliceVision/gpu/gpu.hpp>
 #include <aliceVision/sfmMvsUtils/visibility.hpp>
 #include <aliceVision/system/cmdline.hpp>
 #include <aliceVision/system/Logger.hpp>
@@ -28,7 +29,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 3
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 3
 
 using namespace aliceVision;
 
@@ -70,7 +71,7 @@ int aliceVision_main(int argc, char* argv[])
         ("input,i", po::value<std::string>(&sfmDataFilename)->required(),
           "Dense point cloud SfMData file.")
         ("inputMesh", po::value<std::string>(&inputMeshFilepath)->required(),
-            "Input mesh to texture.")
+            "Input mesh to texture (a .bin mesh from the meshing keeps its vertices visibilities).")
         ("output,o", po::value<std::string>(&outputFolder)->required(),
             "Folder for output mesh");
 
@@ -134,7 +135,15 @@ int aliceVision_main(int argc, char* argv[])
             " * Push: For each vertex of the reconstruction, push the visibilities to the closest triangle in the input mesh.\n"
             " * PullPush: Combine results from Pull and Push results.'")
         ("subdivisionTargetRatio", po::value<float>(&texParams.subdivisionTargetRatio)->default_value(texParams.subdivisionTargetRatio),
-            "Percentage of the density of the reconstruction as the target for the subdivision (0: disable subdivision, 0.5: half density of the reconstruction, 1: full density of the reconstruction).");
+            "Percentage of the density of the reconstruction as the target for the subdivision (0: disable subdivision, 0.5: half density of the reconstruction, 1: full density of the reconstruction).")
+        ("maxMemory", po::value<int>(&texParams.maxMemory)->default_value(texParams.maxMemory),
+            "Maximum amount of RAM (MB) used to process the texture atlases by batches (0: use all the available RAM).")
+        ("useGpu", po::value<bool>(&texParams.useGpu)->default_value(texParams.useGpu),
+            "Rasterize the texture atlases and project the images on the GPU.")
+        ("maxNbCachedCameras", po::value<int>(&texParams.maxNbCachedCameras)->default_value(texParams.maxNbCachedCameras),
+            "Maximum number of images (and their laplacian pyramids) kept in GPU memory, to reuse them for the next texture atlases.")
+        ("nbWriteThreads", po::value<int>(&texParams.nbWriteThreads)->default_value(texParams.nbWriteThreads),
+            "Number of texture atlases filled and written in parallel with the texturing of the next atlases (0: write them after each atlas).");
 
 
     CmdLine cmdline("AliceVision texturing");
@@ -147,6 +156,17 @@ int aliceVision_main(int argc, char* argv[])
     // set bump mapping file type
     bumpMappingParams.bumpMappingFileType = (bumpMappingParams.bumpType == mesh::EBumpMappingType::Normal) ? normalFileType : heightFileType;
 
+    if(texParams.useGpu)
+    {
+        ALICEVISION_LOG_INFO(gpu::gpuInformationCUDA());
+
+        if(!gpu::gpuSupportCUDA(2,0))
+        {
+            ALICEVISION_LOG_ERROR("The GPU texturing needs a CUDA-Enabled GPU (with at least compute capability 2.0).");
+            return EXIT_FAILURE;
+        }
+    }
+
     GEO::initialize();
 
     texParams.visibilityRemappingMethod = mesh::EVisibilityRemappingMethod_stringToEnum(visibilityRemappingMethod);
@@ -189,8 +209,9 @@ int aliceVision_main(int argc, char* argv[])
     // generate UVs if necessary
     if(!mesh.hasUVs())
     {
-        // Need visibilities to compute unwrap
-        mesh.remapVisibilities(texParams.visibilityRemappingMethod, mp, refMesh);
+        // Need visibilities to compute unwrap, a binary input mesh can already have them
+        if(mesh.mesh->pointsVisibilities.empty())
+            mesh.remapVisibilities(texParams.visibilityRemappingMethod, mp, refMesh);
         ALICEVISION_LOG_INFO("Input mesh has no UV coordinates, start unwrapping (" + unwrapMethod + ")");
         mesh.unwrap(mp, mesh::EUnwrapMethod_stringToEnum(unwrapMethod));
         ALICEVISION_LOG_INFO("Unwrapping done.");
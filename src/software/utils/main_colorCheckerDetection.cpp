@@ -8,6 +8,7 @@
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
 
 #include <aliceVision/image/all.hpp>
+#include <aliceVision/image/imageCache.hpp>
 #include <aliceVision/system/cmdline.hpp>
 #include <aliceVision/system/main.hpp>
 #include <aliceVision/config.hpp>
@@ -26,6 +27,7 @@
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/mcc.hpp>
 
+#include <atomic>
 #include <string>
 #include <fstream>
 #include <vector>
@@ -34,7 +36,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
@@ -143,6 +145,8 @@ struct ImageOptions {
 struct CCheckerDetectionSettings {
     cv::mcc::TYPECHART typechart;
     unsigned int maxCountByImage;
+    /// maximum size of the image of the coarse detection, 0 to detect on the full resolution image
+    int detectionMaxSize;
     std::string outputData;
     bool debug;
 };
@@ -338,38 +342,114 @@ struct MacbethCCheckerQuad : Quad {
 };
 
 
-void detectColorChecker(
+/**
+ * @brief Detect the color checkers on the full resolution image
+ */
+std::vector<cv::Ptr<cv::mcc::CChecker>> detectFullResolution(const cv::Mat& imgBGR, const CCheckerDetectionSettings& settings)
+{
+    std::vector<cv::Ptr<cv::mcc::CChecker>> checkers;
+    cv::Ptr<cv::mcc::CCheckerDetector> detector = cv::mcc::CCheckerDetector::create();
+    if(detector->process(imgBGR, settings.typechart, settings.maxCountByImage))
+        checkers = detector->getListColorChecker();
+    return checkers;
+}
+
+/**
+ * @brief Detect the color checkers on a downscaled image, then refine each of them on the full resolution image
+ * in a region of interest around its coarse position. A checker not found again keeps its coarse position.
+ * If no checker is found on the downscaled image (e.g. a checker too small once downscaled), the detection
+ * falls back to the full resolution image.
+ */
+std::vector<cv::Ptr<cv::mcc::CChecker>> detectCoarseToFine(const cv::Mat& imgBGR, const CCheckerDetectionSettings& settings)
+{
+    std::vector<cv::Ptr<cv::mcc::CChecker>> checkers;
+    const int maxSize = std::max(imgBGR.cols, imgBGR.rows);
+
+    if(settings.detectionMaxSize <= 0 || maxSize <= settings.detectionMaxSize)
+        return detectFullResolution(imgBGR, settings);
+
+    const float scale = static_cast<float>(settings.detectionMaxSize) / static_cast<float>(maxSize);
+    cv::Mat coarseBGR;
+    cv::resize(imgBGR, coarseBGR, cv::Size(), scale, scale, cv::INTER_AREA);
+
+    cv::Ptr<cv::mcc::CCheckerDetector> coarseDetector = cv::mcc::CCheckerDetector::create();
+    if(!coarseDetector->process(coarseBGR, settings.typechart, settings.maxCountByImage))
+    {
+        ALICEVISION_LOG_DEBUG("No color checker found on the downscaled image, detect on the full resolution image.");
+        return detectFullResolution(imgBGR, settings);
+    }
+
+    // the coarse checkers at full resolution and their regions of interest, with a margin for the coarse error
+    const cv::Rect imageRect(0, 0, imgBGR.cols, imgBGR.rows);
+    std::vector<cv::Rect> regionsOfInterest;
+    for(const cv::Ptr<cv::mcc::CChecker>& checker : coarseDetector->getListColorChecker())
+    {
+        std::vector<cv::Point2f> box = checker->getBox();
+        for(cv::Point2f& corner : box)
+            corner /= scale;
+        checker->setBox(box);
+        checker->setCenter(checker->getCenter() / scale);
+
+        const cv::Rect boundingRect = cv::boundingRect(box);
+        const int margin = std::max(boundingRect.width, boundingRect.height) / 4;
+        regionsOfInterest.push_back(cv::Rect(boundingRect.x - margin, boundingRect.y - margin,
+                                             boundingRect.width + 2 * margin, boundingRect.height + 2 * margin) & imageRect);
+        checkers.push_back(checker);
+    }
+
+    cv::Ptr<cv::mcc::CCheckerDetector> fineDetector = cv::mcc::CCheckerDetector::create();
+    if(!fineDetector->process(imgBGR, settings.typechart, regionsOfInterest, static_cast<int>(regionsOfInterest.size())))
+        return checkers;
+
+    // the refined checker of each region of interest
+    const std::vector<cv::Ptr<cv::mcc::CChecker>> fineCheckers = fineDetector->getListColorChecker();
+    for(std::size_t i = 0; i < checkers.size(); ++i)
+    {
+        for(const cv::Ptr<cv::mcc::CChecker>& fineChecker : fineCheckers)
+        {
+            if(cv::Rect2f(regionsOfInterest[i]).contains(fineChecker->getCenter()))
+            {
+                checkers[i] = fineChecker;
+                break;
+            }
+        }
+    }
+    return checkers;
+}
+
+
+bool detectColorChecker(
     std::vector<MacbethCCheckerQuad> &detectedCCheckers,
-    ImageOptions& imgOpt,
-    CCheckerDetectionSettings &settings)
+    const ImageOptions& imgOpt,
+    const CCheckerDetectionSettings &settings)
 {
     const std::string outputFolder = fs::path(settings.outputData).parent_path().string() + "/";
     const std::string imgSrcPath = imgOpt.imgFsPath.string();
     const std::string imgSrcStem = imgOpt.imgFsPath.stem().string();
     const std::string imgDestStem = imgSrcStem;
 
-    // Load image
-    image::Image<image::RGBAfColor> img;
-    image::readImage(imgSrcPath, img, imgOpt.readOptions);
+    // Load image, through the decoded images shared by the stages of the process
+    const std::shared_ptr<image::Image<image::RGBAfColor>> imgPtr =
+        image::ImageCache::getInstance().get<image::RGBAfColor>(imgSrcPath, imgOpt.readOptions);
+    const image::Image<image::RGBAfColor>& img = *imgPtr;
     cv::Mat imgBGR = image::imageRGBAToCvMatBGR(img, CV_8UC3);
 
     if(imgBGR.cols == 0 || imgBGR.rows == 0)
     {
         ALICEVISION_LOG_ERROR("Image at: '" << imgSrcPath << "'.\n" << "is empty.");
-        exit(EXIT_FAILURE);
+        return false;
     }
 
-    cv::Ptr<cv::mcc::CCheckerDetector> detector = cv::mcc::CCheckerDetector::create();
-
-    if(!detector->process(imgBGR, settings.typechart, settings.maxCountByImage))
+    const std::vector<cv::Ptr<cv::mcc::CChecker>> checkers = detectCoarseToFine(imgBGR, settings);
+    if(checkers.empty())
     {
         ALICEVISION_LOG_INFO("Checker not detected in image at: '" << imgSrcPath << "'");
-        return;
+        return true;
     }
 
     int counter = 0;
 
-    for(const cv::Ptr<cv::mcc::CChecker> cchecker : detector->getListColorChecker())
+    for(const cv::Ptr<cv::mcc::CChecker>& cchecker : checkers)
     {
         const std::string counterStr = "_" + std::to_string(++counter);
 
@@ -388,12 +468,14 @@ void detectColorChecker(
             cv::imwrite(outputFolder + imgDestStem + counterStr + ".jpg", imgBGR);
 
             const std::string masksFolder = outputFolder + "masks/";
-            fs::create_directory(masksFolder);
+            boost::system::error_code ec;
+            fs::create_directories(masksFolder, ec);
 
             for (int i = 0; i < ccq._cellMasks.size(); ++i)
                 cv::imwrite(masksFolder + imgDestStem + counterStr + "_" + std::to_string(i) + ".jpg", ccq._cellMasks[i]);
         }
     }
+    return true;
 }
 
 
@@ -406,6 +488,7 @@ int aliceVision_main(int argc, char** argv)
     // user optional parameters
     bool debug = false;
     unsigned int maxCountByImage = 1;
+    int detectionMaxSize = 2000;
 
     po::options_description inputParams("Required parameters");
     inputParams.add_options()
@@ -419,7 +502,10 @@ int aliceVision_main(int argc, char** argv)
         ("debug", po::value<bool>(&debug),
          "Output debug data.")
         ("maxCount", po::value<unsigned int>(&maxCountByImage),
-         "Maximum color charts count to detect in a single image.");
+         "Maximum color charts count to detect in a single image.")
+        ("detectionMaxSize", po::value<int>(&detectionMaxSize)->default_value(detectionMaxSize),
+         "Maximum size of the downscaled image used to find the color charts, they are then refined on the "
+         "full resolution image. 0 to detect on the full resolution image.");
 
     CmdLine cmdline("This program is used to perform Macbeth color checker chart detection.\n"
                     "AliceVision colorCheckerDetection");
@@ -433,10 +519,12 @@ int aliceVision_main(int argc, char** argv)
     CCheckerDetectionSettings settings;
     settings.typechart = cv::mcc::TYPECHART::MCC24;
     settings.maxCountByImage = maxCountByImage;
+    settings.detectionMaxSize = detectionMaxSize;
     settings.outputData = outputData;
     settings.debug = debug;
 
     std::vector< MacbethCCheckerQuad > detectedCCheckers;
+    std::vector< ImageOptions > imagesOptions;
 
     // Check if inputExpression is recognized as sfm data file
     const std::string inputExt = boost::to_lower_copy(fs::path(inputExpression).extension().string());
@@ -451,14 +539,10 @@ int aliceVision_main(int argc, char** argv)
             return EXIT_FAILURE;
         }
 
-        int counter = 0;
-
-        // Detect color checker for each images
         for(const auto& viewIt : sfmData.getViews())
         {
             const sfmData::View& view = *(viewIt.second);
 
-            ALICEVISION_LOG_INFO(++counter << "/" << sfmData.getViews().size() << " - Process image at: '" << view.getImagePath() << "'.");
             ImageOptions imgOpt = {
                 view.getImagePath(),
                 std::to_string(view.getViewId()),
@@ -466,7 +550,7 @@ int aliceVision_main(int argc, char** argv)
                 view.getMetadataLensSerialNumber() };
             imgOpt.readOptions.workingColorSpace = image::EImageColorSpace::SRGB;
             imgOpt.readOptions.rawColorInterpretation = image::ERawColorInterpretation_stringToEnum(view.getRawColorInterpretation());
-            detectColorChecker(detectedCCheckers, imgOpt, settings);
+            imagesOptions.push_back(imgOpt);
         }
 
     }
@@ -506,18 +590,46 @@ int aliceVision_main(int argc, char** argv)
             ALICEVISION_LOG_INFO(size << " images found.");
         }
 
-        int counter = 0;
         for(const std::string& imgSrcPath : filesStrPaths)
         {
-            ALICEVISION_LOG_INFO(++counter << "/" << size << " - Process image at: '" << imgSrcPath << "'.");
             ImageOptions imgOpt;
             imgOpt.imgFsPath = imgSrcPath;
             imgOpt.readOptions.workingColorSpace = image::EImageColorSpace::SRGB;
-            detectColorChecker(detectedCCheckers, imgOpt, settings);
+            imagesOptions.push_back(imgOpt);
         }
 
     }
 
+    // Detect color checker for each images: the images are decoded and processed in parallel,
+    // the checkers are kept in the order of the images
+    std::vector< std::vector< MacbethCCheckerQuad > > detectedCCheckersPerImage(imagesOptions.size());
+    std::atomic<int> counter(0);
+    std::atomic<bool> validImages(true);
+
+    #pragma omp parallel for schedule(dynamic)
+    for(int i = 0; i < static_cast<int>(imagesOptions.size()); ++i)
+    {
+        const std::string imgPath = imagesOptions[i].imgFsPath.string();
+        ALICEVISION_LOG_INFO(++counter << "/" << imagesOptions.size() << " - Process image at: '" << imgPath << "'.");
+        // exceptions cannot leave the OpenMP region
+        try
+        {
+            if(!detectColorChecker(detectedCCheckersPerImage[i], imagesOptions[i], settings))
+                validImages = false;
+        }
+        catch(const std::exception& e)
+        {
+            ALICEVISION_LOG_ERROR("Cannot process the image '" << imgPath << "': " << e.what());
+            validImages = false;
+        }
+    }
+
+    if(!validImages)
+        return EXIT_FAILURE;
+
+    for(auto& imageCCheckers : detectedCCheckersPerImage)
+        detectedCCheckers.insert(detectedCCheckers.end(), imageCCheckers.begin(), imageCCheckers.end());
+
     if (detectedCCheckers.empty())
     {
         ALICEVISION_LOG_INFO("Could not find any macbeth color checker in the input images.");
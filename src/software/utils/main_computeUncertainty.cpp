@@ -11,8 +11,10 @@
 #include <aliceVision/system/main.hpp>
 #include <aliceVision/config.hpp>
 
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_UNCERTAINTYTE)
 #include <uncertaintyTE/uncertainty.h>
 #include <uncertaintyTE/IO.h>
+#endif
 
 #include <boost/program_options.hpp>
 
@@ -23,7 +25,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 using namespace aliceVision::sfm;
@@ -38,25 +40,38 @@ int aliceVision_main(int argc, char **argv)
   std::string sfmDataFilename;
   std::string outSfMDataFilename;
   std::string outputStats;
-  std::string algorithm = cov::EAlgorithm_enumToString(cov::eAlgorithmSvdTaylorExpansion);
+  std::string algorithm = "sparseSchur";
+  double observationSigma = 1.0;
   bool debug = false;
 
-  params.add_options()
+  po::options_description requiredParams("Required parameters");
+  requiredParams.add_options()
     ("input,i", po::value<std::string>(&sfmDataFilename)->required(),
       "SfMData file to align.")
-  ("output,o", po::value<std::string>(&outSfMDataFilename)->required(),
-    "Output SfMData scene.")
-  ("outputCov,c", po::value<std::string>(&outputStats),
-    "Output covariances file.")
-  ("algorithm,a", po::value<std::string>(&algorithm)->default_value(algorithm),
-    "Algorithm.")
-  ("debug,d", po::value<bool>(&debug)->default_value(debug),
-    "Enable creation of debug files in the current folder.")
-    ("verboseLevel,v", po::value<std::string>(&verboseLevel)->default_value(verboseLevel),
-      "verbosity level (fatal,  error, warning, info, debug, trace).");
+    ("output,o", po::value<std::string>(&outSfMDataFilename)->required(),
+      "Output SfMData scene.");
+
+  po::options_description optionalParams("Optional parameters");
+  optionalParams.add_options()
+    ("algorithm,a", po::value<std::string>(&algorithm)->default_value(algorithm),
+      "Algorithm: sparseSchur (marginal covariance blocks from the sparse reduced camera system)"
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_UNCERTAINTYTE)
+      " or one of the uncertaintyTE algorithms"
+#endif
+      ".")
+    ("observationSigma", po::value<double>(&observationSigma)->default_value(observationSigma),
+      "Standard deviation of the observations, in pixels (sparseSchur).")
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_UNCERTAINTYTE)
+    ("outputCov,c", po::value<std::string>(&outputStats),
+      "Output covariances file (uncertaintyTE).")
+    ("debug,d", po::value<bool>(&debug)->default_value(debug),
+      "Enable creation of debug files in the current folder (uncertaintyTE).")
+#endif
+    ;
 
   CmdLine cmdline("AliceVision computeUncertainty");
-  cmdline.add(params);
+  cmdline.add(requiredParams);
+  cmdline.add(optionalParams);
   if (!cmdline.execute(argc, argv))
   {
       return EXIT_FAILURE;
@@ -78,70 +93,86 @@ int aliceVision_main(int argc, char **argv)
     return EXIT_FAILURE;
   }
 
-  ceres::CRSMatrix jacobian;
+  if(algorithm == "sparseSchur")
   {
-    BundleAdjustmentCeres bundleAdjustmentObj;
-    BundleAdjustment::ERefineOptions refineOptions = BundleAdjustment::REFINE_ROTATION | BundleAdjustment::REFINE_TRANSLATION | BundleAdjustment::REFINE_STRUCTURE;
-    bundleAdjustmentObj.createJacobian(sfmData, refineOptions, jacobian);
+    if(!computeSparseUncertainty(sfmData, observationSigma))
+    {
+      ALICEVISION_LOG_ERROR("The uncertainty cannot be estimated.");
+      return EXIT_FAILURE;
+    }
   }
-
+  else
   {
-    cov::Options options;
-    // Configure covariance engine (find the indexes of the most distatnt points etc.)
-    // setPts2Fix(opt, mutable_points.size() / 3, mutable_points.data());
-    options._numCams = sfmData.getValidViews().size();
-    options._camParams = 6;
-    options._numPoints = sfmData.structure.size();
-    options._numObs = jacobian.num_rows / 2;
-    options._algorithm = cov::EAlgorithm_stringToEnum(algorithm);
-    options._epsilon = 1e-10;
-    options._lambda = -1;
-    options._svdRemoveN = -1;
-    options._maxIterTE = -1;
-    options._debug = debug;
-
-    cov::Statistic statistic;
-    std::vector<double> points3D;
-    points3D.reserve(sfmData.structure.size() * 3);
-    for(auto& landmarkIt: sfmData.structure)
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_UNCERTAINTYTE)
+    ceres::CRSMatrix jacobian;
     {
-      double* p = landmarkIt.second.X.data();
-      points3D.push_back(p[0]);
-      points3D.push_back(p[1]);
-      points3D.push_back(p[2]);
+      BundleAdjustmentCeres bundleAdjustmentObj;
+      BundleAdjustment::ERefineOptions refineOptions = BundleAdjustment::REFINE_ROTATION | BundleAdjustment::REFINE_TRANSLATION | BundleAdjustment::REFINE_STRUCTURE;
+      bundleAdjustmentObj.createJacobian(sfmData, refineOptions, jacobian);
     }
 
-    cov::Uncertainty uncertainty;
+    {
+      cov::Options options;
+      // Configure covariance engine (find the indexes of the most distatnt points etc.)
+      // setPts2Fix(opt, mutable_points.size() / 3, mutable_points.data());
+      options._numCams = sfmData.getValidViews().size();
+      options._camParams = 6;
+      options._numPoints = sfmData.structure.size();
+      options._numObs = jacobian.num_rows / 2;
+      options._algorithm = cov::EAlgorithm_stringToEnum(algorithm);
+      options._epsilon = 1e-10;
+      options._lambda = -1;
+      options._svdRemoveN = -1;
+      options._maxIterTE = -1;
+      options._debug = debug;
+
+      cov::Statistic statistic;
+      std::vector<double> points3D;
+      points3D.reserve(sfmData.structure.size() * 3);
+      for(auto& landmarkIt: sfmData.structure)
+      {
+        double* p = landmarkIt.second.X.data();
+        points3D.push_back(p[0]);
+        points3D.push_back(p[1]);
+        points3D.push_back(p[2]);
+      }
 
-    getCovariances(options, statistic, jacobian, &points3D[0], uncertainty);
+      cov::Uncertainty uncertainty;
 
-    if(!outputStats.empty())
-      saveResults(outputStats, options, statistic, uncertainty);
+      getCovariances(options, statistic, jacobian, &points3D[0], uncertainty);
 
-    {
-      const std::vector<double> posesUncertainty = uncertainty.getCamerasUncEigenValues();
+      if(!outputStats.empty())
+        saveResults(outputStats, options, statistic, uncertainty);
 
-      std::size_t indexPose = 0;
-      for (Poses::const_iterator itPose = sfmData.getPoses().begin(); itPose != sfmData.getPoses().end(); ++itPose, ++indexPose)
       {
-        const IndexT idPose = itPose->first;
-        Vec6& u = sfmData._posesUncertainty[idPose]; // create uncertainty entry
-        const double* uIn = &posesUncertainty[indexPose*6];
-        u << uIn[0],  uIn[1],  uIn[2],  uIn[3],  uIn[4],  uIn[5];
+        const std::vector<double> posesUncertainty = uncertainty.getCamerasUncEigenValues();
+
+        std::size_t indexPose = 0;
+        for (Poses::const_iterator itPose = sfmData.getPoses().begin(); itPose != sfmData.getPoses().end(); ++itPose, ++indexPose)
+        {
+          const IndexT idPose = itPose->first;
+          Vec6& u = sfmData._posesUncertainty[idPose]; // create uncertainty entry
+          const double* uIn = &posesUncertainty[indexPose*6];
+          u << uIn[0],  uIn[1],  uIn[2],  uIn[3],  uIn[4],  uIn[5];
+        }
       }
-    }
-    {
-      const std::vector<double> landmarksUncertainty = uncertainty.getPointsUncEigenValues();
-
-      std::size_t indexLandmark = 0;
-      for (Landmarks::const_iterator itLandmark = sfmData.getLandmarks().begin(); itLandmark != sfmData.getLandmarks().end(); ++itLandmark, ++indexLandmark)
       {
-        const IndexT idLandmark = itLandmark->first;
-        Vec3& u = sfmData._landmarksUncertainty[idLandmark]; // create uncertainty entry
-        const double* uIn = &landmarksUncertainty[indexLandmark*3];
-        u << uIn[0],  uIn[1],  uIn[2];
+        const std::vector<double> landmarksUncertainty = uncertainty.getPointsUncEigenValues();
+
+        std::size_t indexLandmark = 0;
+        for (Landmarks::const_iterator itLandmark = sfmData.getLandmarks().begin(); itLandmark != sfmData.getLandmarks().end(); ++itLandmark, ++indexLandmark)
+        {
+          const IndexT idLandmark = itLandmark->first;
+          Vec3& u = sfmData._landmarksUncertainty[idLandmark]; // create uncertainty entry
+          const double* uIn = &landmarksUncertainty[indexLandmark*3];
+          u << uIn[0],  uIn[1],  uIn[2];
+        }
       }
     }
+#else
+    ALICEVISION_LOG_ERROR("Unknown uncertainty algorithm '" << algorithm << "', AliceVision is built without uncertaintyTE.");
+    return EXIT_FAILURE;
+#endif
   }
 
   std::cout << "Save into \"" << outSfMDataFilename << "\"" << std::endl;
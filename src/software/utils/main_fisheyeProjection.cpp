@@ -7,7 +7,7 @@
 
 #include <aliceVision/numeric/numeric.hpp>
 #include <aliceVision/image/io.hpp>
-#include <aliceVision/image/Sampler.hpp>
+#include <aliceVision/image/remap.hpp>
 #include <aliceVision/image/convertion.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/cmdline.hpp>
@@ -27,6 +27,7 @@
 #include <iostream>
 #include <iterator>
 #include <fstream>
+#include <future>
 #include <vector>
 #include <boost/regex.hpp>
 #include <boost/math/constants/constants.hpp>
@@ -164,43 +165,50 @@ void setFisheyeImage(image::Image<image::RGBfColor>& imageIn, float blurWidth_pa
 
 
 /**
- * @brief Project fisheye image into an equirectangular map and merge it to output panorama
- * @param[in] imageIn - input RGBAf fisheye image
+ * @brief Compute the remap table projecting a fisheye image into the equirectangular map
+ * @param[in] inWidth - input fisheye image width
+ * @param[in] inHeight - input fisheye image height
+ * @param[in] panoramaSize - height of the equirectangular map, its width is twice the height
  * @param[in] nbImages
- * @param[in] iter - index of input image for merging into panorama
+ * @param[in] iter - index of input image in the panorama
  * @param[in] rotations - contains adjustment rotations on each image set by user
- * @param[out] imageOut - output panorama which is incremented at each call
+ * @param[out] table - fisheye position of each panorama pixel
  */
-void fisheyeToEquirectangular(image::Image<image::RGBAfColor>& imageIn, int nbImages, int iter, const std::array<std::vector<double>, 3>& rotations, image::Image<image::RGBAfColor>& imageOut)
+void computeFisheyeToEquirectangularTable(std::size_t inWidth, std::size_t inHeight, std::size_t panoramaSize, int nbImages, int iter,
+                                          const std::array<std::vector<double>, 3>& rotations, image::RemapTable& table)
 {
-  std::size_t inWidth = imageIn.Width();
-  std::size_t inHeight = imageIn.Height();
-  std::size_t inSize = std::min(inWidth, inHeight);
+  const std::size_t inSize = std::min(inWidth, inHeight);
 
   const double zRotation = double(30.0 - iter * 360.0 / nbImages) + rotations[2].at(iter);
   const double xRotation = double(-abs(90.0 - abs(zRotation))/30.0) + rotations[0].at(iter);
   const double yRotation = rotations[1].at(iter);
+  const Mat3 rotation = rotationXYZ(degreeToRadian(xRotation), degreeToRadian(yRotation), degreeToRadian(zRotation));
+
+  table.build(2 * panoramaSize, panoramaSize, [&](int i, int j, Eigen::Vector2f& xFish) {
+    const Vec3 ray = rotation * SphericalMapping::get3DPoint(Vec2(i,j), 2*panoramaSize, panoramaSize);
+    const Vec2 x = SphericalMapping::get2DCoordinates(ray, inSize);
+    xFish = Eigen::Vector2f(inWidth/2 - x(0), inHeight/2 - x(1));
+    return true;
+  });
+}
 
-  const image::Sampler2d<image::SamplerLinear> sampler;
-  for(int j = 0; j < inSize; ++j)
-  {
-    for(int i = 0; i < 2 * inSize; ++i)
-    {
-      Vec3 ray = SphericalMapping::get3DPoint(Vec2(i,j), 2*inSize, inSize);
-
-      ray = rotationXYZ(degreeToRadian(xRotation), degreeToRadian(yRotation), degreeToRadian(zRotation)) * ray;
-      const Vec2 x = SphericalMapping::get2DCoordinates(ray, inSize);
-      const Vec2 xFish(inWidth/2 - x(0), inHeight/2 - x(1));
-
-      const image::RGBAfColor& pixel = sampler(imageIn, xFish(1), xFish(0));
-      float alpha = pixel.a();
 
-      imageOut(j, i).r() = pixel.r()*alpha + imageOut(j, i).r()*(1.f-alpha);
-      imageOut(j, i).g() = pixel.g()*alpha + imageOut(j, i).g()*(1.f-alpha);
-      imageOut(j, i).b() = pixel.b()*alpha + imageOut(j, i).b()*(1.f-alpha);
-      imageOut(j, i).a() = pixel.a()*alpha + imageOut(j, i).a()*(1.f-alpha);
-    }
-  }
+/**
+ * @brief Project fisheye image into an equirectangular map and merge it to output panorama
+ * @param[in] imageIn - input RGBAf fisheye image
+ * @param[in] table - remap table of the fisheye image, see computeFisheyeToEquirectangularTable
+ * @param[out] imageOut - output panorama which is incremented at each call
+ */
+void fisheyeToEquirectangular(const image::Image<image::RGBAfColor>& imageIn, const image::RemapTable& table, image::Image<image::RGBAfColor>& imageOut)
+{
+  image::remap(imageIn, table, imageOut, [](image::RGBAfColor& outPixel, const image::RGBAfColor& pixel) {
+    const float alpha = pixel.a();
+
+    outPixel.r() = pixel.r()*alpha + outPixel.r()*(1.f-alpha);
+    outPixel.g() = pixel.g()*alpha + outPixel.g()*(1.f-alpha);
+    outPixel.b() = pixel.b()*alpha + outPixel.b()*(1.f-alpha);
+    outPixel.a() = pixel.a()*alpha + outPixel.a()*(1.f-alpha);
+  });
 }
 
 
@@ -219,19 +227,30 @@ void stitchPanorama(const std::vector<std::string>& imagePaths, const std::vecto
   oiio::ImageBuf& bufferOut = buffers[0];
   std::size_t inSize;
 
-  for(int i=0; i<nbImages; ++i)
+  // load and prepare an input image, in background while the previous one is projected
+  const auto loadImage = [&](int i)
   {
     oiio::ImageBuf& buffer = buffers[i];
     image::Image<image::RGBfColor> imageIn;
     image::Image<image::RGBAfColor> imageAlpha;
 
-    ALICEVISION_LOG_INFO("Projecting " << imagePaths[i] << " into equirectangular space");
-
     image::readImage(imagePaths[i], imageIn, image::EImageColorSpace::LINEAR);
     image::getBufferFromImage(imageIn, buffer);
     buffer.specmod().extra_attribs = metadatas[i];
 
     setFisheyeImage(imageIn, blurWidth, buffer, imageAlpha);
+    return imageAlpha;
+  };
+
+  std::future<image::Image<image::RGBAfColor>> nextImage = std::async(std::launch::async, loadImage, 0);
+
+  for(int i=0; i<nbImages; ++i)
+  {
+    const image::Image<image::RGBAfColor> imageAlpha = nextImage.get();
+    if(i + 1 < nbImages)
+      nextImage = std::async(std::launch::async, loadImage, i + 1);
+
+    ALICEVISION_LOG_INFO("Projecting " << imagePaths[i] << " into equirectangular space");
 
     if(i == 0)
     {
@@ -239,7 +258,9 @@ void stitchPanorama(const std::vector<std::string>& imagePaths, const std::vecto
       imageOut.resize(2*inSize, inSize, true, image::RGBAfColor(0.f, 0.f, 0.f, 0.f));
     }
 
-    fisheyeToEquirectangular(imageAlpha, nbImages, i, rotations, imageOut);
+    image::RemapTable table;
+    computeFisheyeToEquirectangularTable(imageAlpha.Width(), imageAlpha.Height(), inSize, nbImages, i, rotations, table);
+    fisheyeToEquirectangular(imageAlpha, table, imageOut);
   }
 
   // save equirectangular image with fisheye's metadata
@@ -13,6 +13,7 @@
 #include <aliceVision/mvsUtils/fileIO.hpp>
 #include <aliceVision/lightingEstimation/lightingEstimation.hpp>
 #include <aliceVision/image/io.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <OpenImageIO/imagebuf.h>
 #include <OpenImageIO/imagebufalgo_util.h>
@@ -20,6 +21,7 @@
 #include <boost/program_options.hpp> 
 #include <boost/filesystem.hpp>
 
+#include <exception>
 #include <string>
 #include <vector>
 
@@ -309,6 +311,10 @@ int main(int argc, char** argv)
       return EXIT_FAILURE;
   }
 
+  // set maxThreads
+  HardwareContext hwc = cmdline.getHardwareContext();
+  hwc.setupThreads();
+
   // read the input SfM scene
   sfmData::SfMData sfmData;
   if(!sfmDataIO::Load(sfmData, sfmDataFilename, sfmDataIO::ESfMData::ALL))
@@ -322,52 +328,77 @@ int main(int argc, char** argv)
 
   lightingEstimation::LighthingEstimator estimator;
 
+  std::vector<IndexT> viewIds;
   for(const auto& viewPair : sfmData.getViews())
-  {
-    const IndexT viewId = viewPair.first;
+    viewIds.push_back(viewPair.first);
 
-    const std::string picturePath = mp.getImagePath(mp.getIndexFromViewId(viewId));
-    const std::string normalsPath = mvsUtils::getFileNameFromViewId(mp, viewId, mvsUtils::EFileType::normalMap, 0);
+  // the views are added in parallel, the estimator accumulates the normal equations of all the views
+  std::exception_ptr viewError;
 
-    image::Image<image::RGBfColor> normals;
-    image::readImage(normalsPath, normals, image::EImageColorSpace::LINEAR);
-
-    if(lightingColor == ELightingColor::Luminance)
-    {
-      image::Image<float> albedo, picture;
-      image::readImage(picturePath, picture, image::EImageColorSpace::LINEAR);
-
-      initAlbedo(albedo, picture, albedoEstimationMethod, albedoEstimationFilterSize, outputFolder, viewId);
-
-      estimator.addImage(albedo, picture, normals);
-    }
-    else if(lightingColor == ELightingColor::RGB)
-    {
-      image::Image<image::RGBfColor> albedo, picture;
-      image::readImage(picturePath, picture, image::EImageColorSpace::LINEAR);
-
-      initAlbedo(albedo, picture, albedoEstimationMethod, albedoEstimationFilterSize, outputFolder, viewId);
-
-      estimator.addImage(albedo, picture, normals);
-    }
+  #pragma omp parallel for schedule(dynamic)
+  for(int i = 0; i < viewIds.size(); ++i)
+  {
+    const IndexT viewId = viewIds[i];
 
-    if(lightEstimationMode == ELightingEstimationMode::PER_IMAGE)
+    try
     {
-      ALICEVISION_LOG_INFO("Solving view: " << viewId << " lighting estimation...");
-      lightingEstimation::LightingVector shl;
-      estimator.estimateLigthing(shl);
-      estimator.clear(); // clear aggregate data
-
-      std::ofstream file((fs::path(outputFolder) / (std::to_string(viewId) + ".shl")).string());
-      if(file.is_open())
-        file << shl;
+      // in per image mode, each view has its own estimator
+      lightingEstimation::LighthingEstimator viewEstimator;
+      lightingEstimation::LighthingEstimator& currentEstimator = (lightEstimationMode == ELightingEstimationMode::PER_IMAGE) ? viewEstimator : estimator;
+
+      const std::string picturePath = mp.getImagePath(mp.getIndexFromViewId(viewId));
+      const std::string normalsPath = mvsUtils::getFileNameFromViewId(mp, viewId, mvsUtils::EFileType::normalMap, 0);
+
+      image::Image<image::RGBfColor> normals;
+      image::readImage(normalsPath, normals, image::EImageColorSpace::LINEAR);
+
+      if(lightingColor == ELightingColor::Luminance)
+      {
+        image::Image<float> albedo, picture;
+        image::readImage(picturePath, picture, image::EImageColorSpace::LINEAR);
+
+        initAlbedo(albedo, picture, albedoEstimationMethod, albedoEstimationFilterSize, outputFolder, viewId);
+
+        currentEstimator.addImage(albedo, picture, normals);
+      }
+      else if(lightingColor == ELightingColor::RGB)
+      {
+        image::Image<image::RGBfColor> albedo, picture;
+        image::readImage(picturePath, picture, image::EImageColorSpace::LINEAR);
+
+        initAlbedo(albedo, picture, albedoEstimationMethod, albedoEstimationFilterSize, outputFolder, viewId);
+
+        currentEstimator.addImage(albedo, picture, normals);
+      }
+
+      if(lightEstimationMode == ELightingEstimationMode::PER_IMAGE)
+      {
+        ALICEVISION_LOG_INFO("Solving view: " << viewId << " lighting estimation...");
+        lightingEstimation::LightingVector shl;
+        currentEstimator.estimateLigthing(shl);
+
+        std::ofstream file((fs::path(outputFolder) / (std::to_string(viewId) + ".shl")).string());
+        if(file.is_open())
+          file << shl;
+      }
+      else
+      {
+        ALICEVISION_LOG_INFO("View: " << viewId << " added to the problem.");
+      }
     }
-    else
+    catch(...)
     {
-      ALICEVISION_LOG_INFO("View: " << viewId << " added to the problem.");
+      #pragma omp critical(lightingEstimation_viewError)
+      {
+        if(!viewError)
+          viewError = std::current_exception();
+      }
     }
   }
 
+  if(viewError)
+    std::rethrow_exception(viewError);
+
   if(lightEstimationMode == ELightingEstimationMode::GLOBAL)
   {
     ALICEVISION_LOG_INFO("Solving global scene lighting estimation...");
@@ -0,0 +1,138 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfmDataIO/sfmDataIO.hpp>
+#include <aliceVision/feature/imageDescriberCommon.hpp>
+#include <aliceVision/feature/RegionsPack.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/system/main.hpp>
+#include <aliceVision/system/cmdline.hpp>
+
+#include <boost/program_options.hpp>
+#include <boost/filesystem.hpp>
+
+#include <string>
+#include <vector>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+
+namespace po = boost::program_options;
+namespace fs = boost::filesystem;
+
+/// Gather the per-view features and descriptors files of each describer type
+/// into a single regions pack file per describer type.
+int aliceVision_main(int argc, char **argv)
+{
+  // command-line parameters
+  std::string sfmDataFilename;
+  std::vector<std::string> featuresFolders;
+  std::string outputFolder;
+
+  // user optional parameters
+  std::string describerTypesName = feature::EImageDescriberType_enumToString(feature::EImageDescriberType::SIFT);
+
+  po::options_description requiredParams("Required parameters");
+  requiredParams.add_options()
+    ("input,i", po::value<std::string>(&sfmDataFilename)->required(),
+      "SfMData file.")
+    ("featuresFolders,f", po::value<std::vector<std::string>>(&featuresFolders)->multitoken()->required(),
+      "Path to folder(s) containing the extracted features.")
+    ("output,o", po::value<std::string>(&outputFolder)->required(),
+      "Output folder for the regions pack files (<describerType>.regionsPack).");
+
+  po::options_description optionalParams("Optional parameters");
+  optionalParams.add_options()
+    ("describerTypes,d", po::value<std::string>(&describerTypesName)->default_value(describerTypesName),
+      feature::EImageDescriberType_informations().c_str());
+
+  CmdLine cmdline("AliceVision regionsPack");
+  cmdline.add(requiredParams);
+  cmdline.add(optionalParams);
+  if (!cmdline.execute(argc, argv))
+  {
+      return EXIT_FAILURE;
+  }
+
+  // create output folder
+  if(!fs::exists(outputFolder))
+  {
+    if(!fs::create_directory(outputFolder))
+    {
+      ALICEVISION_LOG_ERROR("Cannot create output folder");
+      return EXIT_FAILURE;
+    }
+  }
+
+  // load input scene
+  sfmData::SfMData sfmData;
+  if(!sfmDataIO::Load(sfmData, sfmDataFilename, sfmDataIO::ESfMData(sfmDataIO::VIEWS)))
+  {
+    ALICEVISION_LOG_ERROR("The input file '" + sfmDataFilename + "' cannot be read");
+    return EXIT_FAILURE;
+  }
+
+  featuresFolders.insert(featuresFolders.begin(), sfmData.getFeaturesFolders().begin(), sfmData.getFeaturesFolders().end());
+
+  system::Timer timer;
+
+  for(const feature::EImageDescriberType describerType : feature::EImageDescriberType_stringToEnums(describerTypesName))
+  {
+    const std::string describerTypeName = feature::EImageDescriberType_enumToString(describerType);
+    const std::string packPath = feature::getRegionsPackPath(outputFolder, describerType);
+    const std::string tmpPackPath = packPath + "." + fs::unique_path().string();
+
+    std::size_t nbViews = 0;
+    {
+      feature::RegionsPackWriter writer(tmpPackPath);
+
+      for(const auto& viewPair : sfmData.getViews())
+      {
+        const std::string basename = std::to_string(viewPair.first) + "." + describerTypeName;
+
+        std::string featsPath;
+        std::string descsPath;
+
+        for(const std::string& folder : featuresFolders)
+        {
+          const fs::path featPath = fs::path(folder) / (basename + ".feat");
+          const fs::path descPath = fs::path(folder) / (basename + ".desc");
+
+          if(fs::exists(featPath) && fs::exists(descPath))
+          {
+            featsPath = featPath.string();
+            descsPath = descPath.string();
+          }
+        }
+
+        if(featsPath.empty())
+        {
+          ALICEVISION_LOG_WARNING("Can't find " << describerTypeName << " regions files for view " << viewPair.first);
+          continue;
+        }
+
+        writer.addView(viewPair.first, featsPath, descsPath);
+        ++nbViews;
+      }
+
+      writer.close();
+    }
+
+    // the regions pack is only visible once complete
+    fs::rename(tmpPackPath, packPath);
+
+    ALICEVISION_LOG_INFO(nbViews << " views packed in " << packPath);
+  }
+
+  ALICEVISION_LOG_INFO("Task done in (s): " + std::to_string(timer.elapsed()));
+  return EXIT_SUCCESS;
+}
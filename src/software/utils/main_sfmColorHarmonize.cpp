@@ -21,7 +21,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
@@ -38,6 +38,7 @@ int aliceVision_main( int argc, char **argv )
   std::string describerTypesName = feature::EImageDescriberType_enumToString(feature::EImageDescriberType::SIFT);
   EHistogramSelectionMethod selectionMethod;
   int imgRef;
+  EGainOffsetSolver solver = EGainOffsetSolver::LinearProgramming;
 
   // user optional parameters
   po::options_description requiredParams("Required parameters");
@@ -58,7 +59,9 @@ int aliceVision_main( int argc, char **argv )
   po::options_description optionalParams("Optional parameters");
   optionalParams.add_options()
     ("describerTypes,d", po::value<std::string>(&describerTypesName)->default_value(describerTypesName),
-      feature::EImageDescriberType_informations().c_str());
+      feature::EImageDescriberType_informations().c_str())
+    ("solver", po::value<EGainOffsetSolver>(&solver)->default_value(solver),
+      EGainOffsetSolver_description().c_str());
 
   CmdLine cmdline("AliceVision sfmColorHarmonize");
   cmdline.add(requiredParams);
@@ -89,7 +92,8 @@ int aliceVision_main( int argc, char **argv )
     outputFolder,
     describerTypes,
     selectionMethod,
-    imgRef);
+    imgRef,
+    solver);
 
   if(colorHarmonizeEngine.Process())
   {
@@ -24,7 +24,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
@@ -47,6 +47,8 @@ int aliceVision_main(int argc, char **argv)
   // user optional parameters
   std::string describerTypesName = feature::EImageDescriberType_enumToString(feature::EImageDescriberType::SIFT);
   double maxResidualError = std::numeric_limits<double>::infinity();
+  std::size_t maxDescriptorsPerLandmark = 3;
+  bool useLandmarksDescriptorsFile = true;
 
   po::options_description requiredParams("Required parameters");
   requiredParams.add_options()
@@ -64,7 +66,12 @@ int aliceVision_main(int argc, char **argv)
     ("describerTypes,d", po::value<std::string>(&describerTypesName)->default_value(describerTypesName),
       feature::EImageDescriberType_informations().c_str())
     ("maxResidualError", po::value<double>(&maxResidualError)->default_value(maxResidualError),
-      "Upper bound of the residual error tolerance.");
+      "Upper bound of the residual error tolerance.")
+    ("maxDescriptorsPerLandmark", po::value<std::size_t>(&maxDescriptorsPerLandmark)->default_value(maxDescriptorsPerLandmark),
+      "Maximum number of observation descriptors kept by 3D point.")
+    ("useLandmarksDescriptorsFile", po::value<bool>(&useLandmarksDescriptorsFile)->default_value(useLandmarksDescriptorsFile),
+      "Load the 3D points descriptors and their index from the file next to the SfMData file, "
+      "or save them there once built. The file is shared with the cameraLocalization direct mode.");
 
   CmdLine cmdline("Image localization in an existing SfM reconstruction.\n"
                   "AliceVision sfmLocalization");
@@ -112,15 +119,8 @@ int aliceVision_main(int argc, char **argv)
   // - extract the regions of the view
   // - try to locate the image
   //-
-  sfm::SfMLocalizationSingle3DTrackObservationDatabase localizer;
+  sfm::SfMLocalizationSingle3DTrackObservationDatabase localizer(maxDescriptorsPerLandmark);
   {
-    feature::RegionsPerView regionsPerView;
-    if (!sfm::loadRegionsPerView(regionsPerView, sfmData, featuresFolders, {describerType}))
-    {
-      ALICEVISION_LOG_ERROR("Invalid regions.");
-      return EXIT_FAILURE;
-    }
-
     if (outputFolder.empty())
     {
       ALICEVISION_LOG_ERROR("It is an invalid output folder");
@@ -129,10 +129,37 @@ int aliceVision_main(int argc, char **argv)
 
     if (!fs::exists(outputFolder))
       fs::create_directory(outputFolder);
-    
-    if(!localizer.Init(sfmData, regionsPerView))
+
+    // the 3D points descriptors saved with the scene are memory-mapped, the regions are not loaded
+    const std::string landmarksDescriptorsPath = sfm::getLandmarksDescriptorsPath(sfmDataFilename, describerType);
+    const std::uint64_t landmarksDescriptorsKey = sfm::computeLandmarksDescriptorsKey(sfmData, describerType, maxDescriptorsPerLandmark);
+    auto landmarksDescriptors = std::make_shared<sfm::LandmarksDescriptors>();
+
+    if (useLandmarksDescriptorsFile && landmarksDescriptors->load(landmarksDescriptorsPath, landmarksDescriptorsKey))
     {
-      ALICEVISION_LOG_ERROR("Cannot initialize the SfM localizer");
+      ALICEVISION_LOG_INFO("3D points descriptors loaded from " << landmarksDescriptorsPath);
+      if(!localizer.Init(sfmData, landmarksDescriptors))
+      {
+        ALICEVISION_LOG_ERROR("Cannot initialize the SfM localizer");
+      }
+    }
+    else
+    {
+      feature::RegionsPerView regionsPerView;
+      if (!sfm::loadRegionsPerView(regionsPerView, sfmData, featuresFolders, {describerType}))
+      {
+        ALICEVISION_LOG_ERROR("Invalid regions.");
+        return EXIT_FAILURE;
+      }
+
+      if(!localizer.Init(sfmData, regionsPerView))
+      {
+        ALICEVISION_LOG_ERROR("Cannot initialize the SfM localizer");
+      }
+      else if(useLandmarksDescriptorsFile)
+      {
+        localizer.getLandmarksDescriptors()->save(landmarksDescriptorsPath);
+      }
     }
   }
   
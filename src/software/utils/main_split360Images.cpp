@@ -7,7 +7,8 @@
 
 #include <aliceVision/numeric/numeric.hpp>
 #include <aliceVision/image/io.hpp>
-#include <aliceVision/image/Sampler.hpp>
+#include <aliceVision/image/remap.hpp>
+#include <aliceVision/image/AsyncImageWriter.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/cmdline.hpp>
 #include <aliceVision/system/main.hpp>
@@ -27,12 +28,15 @@
 #include <iostream>
 #include <iterator>
 #include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
@@ -91,8 +95,71 @@ double focalFromPinholeHeight(int height, double thetaMax = degreeToRadian(60.0)
     return f;
 }
 
+/**
+ * @brief The remap tables of the equirectangular splits, computed once per source image size
+ *        and shared by all the images of this size
+ */
+class SplitRemapTables
+{
+public:
+    SplitRemapTables(std::size_t nbSplits, std::size_t splitResolution, double fovDegree)
+        : _splitResolution(splitResolution)
+    {
+        const double twoPi = boost::math::constants::pi<double>() * 2.0;
+        const double alpha = twoPi / static_cast<double>(nbSplits);
+
+        const double fov = degreeToRadian(fovDegree);
+        _focal = (splitResolution / 2.0) / tan(fov / 2.0);
+
+        double angle = 0.0;
+        for(std::size_t i = 0; i < nbSplits; ++i)
+        {
+            _cameras.emplace_back(_focal, splitResolution, splitResolution, RotationAroundY(angle));
+            angle += alpha;
+        }
+    }
+
+    double getFocal() const { return _focal; }
+
+    /**
+     * @brief Get the remap tables of the splits (one per camera) for a source image size
+     */
+    std::shared_ptr<const std::vector<image::RemapTable>> get(int inWidth, int inHeight)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        std::shared_ptr<const std::vector<image::RemapTable>>& tables = _tablesPerSize[std::make_pair(inWidth, inHeight)];
+        if(tables)
+            return tables;
+
+        std::shared_ptr<std::vector<image::RemapTable>> newTables = std::make_shared<std::vector<image::RemapTable>>(_cameras.size());
+        for(std::size_t c = 0; c < _cameras.size(); ++c)
+        {
+            const PinholeCameraR& camera = _cameras[c];
+
+            // Backward mapping:
+            // - Find for each pixels of the pinhole image where it comes from the panoramic image
+            (*newTables)[c].build(_splitResolution, _splitResolution, [&](int x, int y, Eigen::Vector2f& sourcePosition) {
+                const Vec3 ray = camera.getRay(x, y);
+                sourcePosition = SphericalMapping::toEquirectangular(ray, inWidth, inHeight).cast<float>();
+                return true;
+            });
+        }
+        tables = newTables;
+        return tables;
+    }
+
+private:
+    std::vector<PinholeCameraR> _cameras;
+    std::size_t _splitResolution;
+    double _focal;
+
+    std::mutex _mutex;
+    std::map<std::pair<int, int>, std::shared_ptr<const std::vector<image::RemapTable>>> _tablesPerSize;
+};
+
 bool splitDualFisheye(const std::string& imagePath, const std::string& outputFolder, const std::string& extension,
-                      const std::string& splitPreset)
+                      const std::string& splitPreset, image::AsyncImageWriter& writer)
 {
     // Load source image from disk
     image::Image<image::RGBfColor> imageSource;
@@ -139,8 +206,8 @@ bool splitDualFisheye(const std::string& imagePath, const std::string& outputFol
         fs::path path(imagePath);
         std::string filename = extension.empty() ?
             path.filename().string() : path.stem().string() + "." + extension;
-        image::writeImage(subFolder + std::string("/") + filename,
-                          imageOut, image::ImageWriteOptions(), image::readImageMetadata(imagePath));
+        writer.write(subFolder + std::string("/") + filename,
+                     std::move(imageOut), image::ImageWriteOptions(), image::readImageMetadata(imagePath));
     }
 
     // Success
@@ -149,80 +216,46 @@ bool splitDualFisheye(const std::string& imagePath, const std::string& outputFol
 }
 
 bool splitEquirectangular(const std::string& imagePath, const std::string& outputFolder, const std::string& extension,
-                          std::size_t nbSplits, std::size_t splitResolution, double fovDegree)
+                          SplitRemapTables& remapTables, image::AsyncImageWriter& writer)
 {
     // Load source image from disk
     image::Image<image::RGBColor> imageSource;
     image::readImage(imagePath, imageSource, image::EImageColorSpace::LINEAR);
 
-    const int inWidth = imageSource.Width();
-    const int inHeight = imageSource.Height();
-
-    std::vector<PinholeCameraR> cameras;
-
-    const double twoPi = boost::math::constants::pi<double>() * 2.0;
-    const double alpha = twoPi / static_cast<double>(nbSplits);
-
-    const double fov = degreeToRadian(fovDegree);
-    const double focal_px = (splitResolution / 2.0) / tan(fov / 2.0);
+    const std::shared_ptr<const std::vector<image::RemapTable>> tables = remapTables.get(imageSource.Width(), imageSource.Height());
+    if(tables->empty())
+        return true;
 
-    double angle = 0.0;
-    for(std::size_t i = 0; i < nbSplits; ++i)
-    {
-        cameras.emplace_back(focal_px, splitResolution, splitResolution, RotationAroundY(angle));
-        angle += alpha;
-    }
+    // Retrieve image metadata
+    oiio::ImageSpec outMetadataSpec;
+    outMetadataSpec.extra_attribs = image::readImageMetadata(imagePath);
 
-    const image::Sampler2d<image::SamplerLinear> sampler;
-    image::Image<image::RGBColor> imaOut(splitResolution, splitResolution, image::BLACK);
+    // Override make and model in order to force camera model in SfM
+    outMetadataSpec.attribute("Make",  "Custom");
+    outMetadataSpec.attribute("Model", "Pinhole");
+    const std::size_t splitResolution = tables->front().Width();
+    const float focal_mm = remapTables.getFocal() / splitResolution; // muliplied by sensorWidth (which is 1 for "Custom")
+    outMetadataSpec.attribute("Exif:FocalLength", focal_mm);
 
     // Make sure rig folder exists
     std::string rigFolder = outputFolder + "/rig";
     fs::create_directory(rigFolder);
 
-    size_t index = 0;
-    for(const PinholeCameraR& camera : cameras)
+    for(std::size_t index = 0; index < tables->size(); ++index)
     {
-        imaOut.fill(image::BLACK);
-
-        // Backward mapping:
-        // - Find for each pixels of the pinhole image where it comes from the panoramic image
-        for(int j = 0; j < splitResolution; ++j)
-        {
-            for(int i = 0; i < splitResolution; ++i)
-            {
-                const Vec3 ray = camera.getRay(i, j);
-                const Vec2 x = SphericalMapping::toEquirectangular(ray, inWidth, inHeight);
-                imaOut(j,i) = sampler(imageSource, x(1), x(0));
-            }
-        }
-
-        // Retrieve image specs and metadata
-        oiio::ImageBuf bufferOut;
-        image::getBufferFromImage(imageSource, bufferOut);
-
-        oiio::ImageSpec& outMetadataSpec = bufferOut.specmod();
-
-        outMetadataSpec.extra_attribs = image::readImageMetadata(imagePath);
-
-        // Override make and model in order to force camera model in SfM
-        outMetadataSpec.attribute("Make",  "Custom");
-        outMetadataSpec.attribute("Model", "Pinhole");
-        const float focal_mm = focal_px / splitResolution; // muliplied by sensorWidth (which is 1 for "Custom")
-        outMetadataSpec.attribute("Exif:FocalLength", focal_mm);
+        image::Image<image::RGBColor> imaOut(splitResolution, splitResolution, true, image::BLACK);
+        image::remap(imageSource, (*tables)[index], imaOut);
 
         // Make sure sub-folder exists for complete rig structure
         std::string subFolder = rigFolder + std::string("/") + std::to_string(index);
         fs::create_directory(subFolder);
 
-        // Save new image on disk
+        // Save new image on disk, the image is encoded while the next split is computed
         fs::path path(imagePath);
         std::string filename = extension.empty() ?
             path.filename().string() : path.stem().string() + "." + extension;
-        image::writeImage(subFolder + std::string("/") + filename,
-                          imaOut, image::ImageWriteOptions(), outMetadataSpec.extra_attribs);
-
-        ++index;
+        writer.write(subFolder + std::string("/") + filename,
+                     std::move(imaOut), image::ImageWriteOptions(), outMetadataSpec.extra_attribs);
     }
     ALICEVISION_LOG_INFO(imagePath + " successfully split");
     return true;
@@ -315,6 +348,7 @@ int aliceVision_main(int argc, char** argv)
     bool equirectangularPreviewMode = false;
     double fov = 110.0;                         // Field of View in degree
     int nbThreads = 3;
+    int nbWriteThreads = 2;
     std::string extension;
 
     po::options_description requiredParams("Required parameters");
@@ -340,6 +374,8 @@ int aliceVision_main(int argc, char** argv)
         "Field of View to extract (in degree).")
         ("nbThreads", po::value<int>(&nbThreads)->default_value(nbThreads),
         "Number of threads.")
+        ("nbWriteThreads", po::value<int>(&nbWriteThreads)->default_value(nbWriteThreads),
+        "Number of threads writing the split images in background.")
         ("extension", po::value<std::string>(&extension)->default_value(extension),
          "Output image extension (empty to keep the source file format).");
 
@@ -414,36 +450,48 @@ int aliceVision_main(int argc, char** argv)
         }
     }
 
-    #pragma omp parallel for num_threads(nbThreads)
+    // the remap tables are shared by the images of the same size,
+    // the images are read in parallel and written in background while the next ones are split
+    SplitRemapTables remapTables(equirectangularNbSplits, equirectangularSplitResolution, fov);
+    image::AsyncImageWriter writer(2 * std::max(nbThreads, 1), nbWriteThreads);
+
+    #pragma omp parallel for num_threads(nbThreads) schedule(dynamic)
     for (int i = 0; i < imagePaths.size(); ++i)
     {
         const std::string& imagePath = imagePaths[i];
         bool hasCorrectPath = true;
 
-        if (splitMode == "equirectangular")
+        try
         {
-            if(equirectangularPreviewMode)
+            if (splitMode == "equirectangular")
             {
-                hasCorrectPath =
-                    splitEquirectangularPreview(imagePath, outputFolder,
-                                                equirectangularNbSplits, equirectangularSplitResolution, fov);
+                if(equirectangularPreviewMode)
+                {
+                    hasCorrectPath =
+                        splitEquirectangularPreview(imagePath, outputFolder,
+                                                    equirectangularNbSplits, equirectangularSplitResolution, fov);
+                }
+                else
+                {
+                    hasCorrectPath =
+                        splitEquirectangular(imagePath, outputFolder, extension, remapTables, writer);
+                }
             }
-            else
+            else if(splitMode == "dualfisheye")
             {
                 hasCorrectPath =
-                    splitEquirectangular(imagePath, outputFolder, extension,
-                                         equirectangularNbSplits, equirectangularSplitResolution, fov);
+                    splitDualFisheye(imagePath, outputFolder, extension,
+                                     dualFisheyeSplitPreset, writer);
+            }
+            else //exif
+            {
+                ALICEVISION_LOG_ERROR("Exif mode not implemented yet !");
             }
         }
-        else if(splitMode == "dualfisheye")
-        {
-            hasCorrectPath =
-                splitDualFisheye(imagePath, outputFolder, extension,
-                                 dualFisheyeSplitPreset);
-        }
-        else //exif
+        catch(const std::exception& e)
         {
-            ALICEVISION_LOG_ERROR("Exif mode not implemented yet !");
+            ALICEVISION_LOG_ERROR(e.what());
+            hasCorrectPath = false;
         }
 
         if (!hasCorrectPath)
@@ -453,6 +501,16 @@ int aliceVision_main(int argc, char** argv)
         }
     }
 
+    try
+    {
+        writer.wait();
+    }
+    catch(const std::exception& e)
+    {
+        ALICEVISION_LOG_ERROR("Failed to write the split images: " << e.what());
+        return EXIT_FAILURE;
+    }
+
     if (!badPaths.empty())
     {
         ALICEVISION_LOG_ERROR("Error: Can't open image file(s) below");
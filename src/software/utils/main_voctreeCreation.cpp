@@ -27,7 +27,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 static const int DIMENSION = 128;
 
@@ -53,6 +53,8 @@ int aliceVision_main(int argc, char** argv)
   std::uint32_t restart = 5;
   std::uint32_t LEVELS = 6;
   bool sanityCheck = true;
+  std::size_t miniBatchSize = 0;
+  bool parallelSubtrees = true;
 
   po::options_description requiredParams("Required parameters");
   requiredParams.add_options()
@@ -67,6 +69,11 @@ int aliceVision_main(int argc, char** argv)
     (",k", po::value<uint32_t>(&K)->default_value(10), "The branching factor of the tree")
     ("restart,r", po::value<uint32_t>(&restart)->default_value(5), "Number of times that the kmean is launched for each cluster, the best solution is kept")
     (",L", po::value<uint32_t>(&LEVELS)->default_value(6), "Number of levels of the tree")
+    ("miniBatchSize", po::value<std::size_t>(&miniBatchSize)->default_value(miniBatchSize),
+      "Number of descriptors per mini-batch k-means iteration, on the nodes with more than 3 batches of descriptors. "
+      "0 uses the standard k-means on all the descriptors of each node.")
+    ("parallelSubtrees", po::value<bool>(&parallelSubtrees)->default_value(parallelSubtrees),
+      "Cluster the sibling nodes of a level in parallel (the tree is not reproducible from one run to another).")
     ("sanitycheck,s", po::value<bool>(&sanityCheck)->default_value(sanityCheck), "Perform a sanity check at the end of the creation of the vocabulary tree. The sanity check is a query to the database with the same documents/images useed to train the vocabulary tree");
 
   CmdLine cmdline("This program is used to load the sift descriptors from a SfMData file and create a vocabulary tree.\n"
@@ -109,6 +116,8 @@ int aliceVision_main(int argc, char** argv)
   aliceVision::voctree::TreeBuilder<DescriptorFloat> builder(DescriptorFloat(0));
   builder.setVerbose(tbVerbosity);
   builder.kmeans().setRestarts(restart);
+  builder.kmeans().setMiniBatchSize(miniBatchSize);
+  builder.setParallelSubtrees(parallelSubtrees);
   ALICEVISION_COUT("Building a tree of L=" << LEVELS << " levels with a branching factor of k=" << K);
   detect_start = std::chrono::steady_clock::now();
   builder.build(descriptors, K, LEVELS);
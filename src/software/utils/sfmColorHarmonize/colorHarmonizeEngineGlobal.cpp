@@ -8,6 +8,7 @@
 #include "colorHarmonizeEngineGlobal.hpp"
 #include "software/utils/sfmHelper/sfmIOHelper.hpp"
 
+#include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/ProgressDisplay.hpp>
 #include <aliceVision/system/Timer.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
@@ -16,6 +17,8 @@
 #include <aliceVision/graph/graph.hpp>
 #include <aliceVision/config.hpp>
 #include <aliceVision/image/all.hpp>
+#include <aliceVision/image/imageCache.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 //load features per view
 #include <aliceVision/sfm/pipeline/regionsIO.hpp>
 // feature matches
@@ -83,6 +86,35 @@ std::istream& operator>>(std::istream& in, EHistogramSelectionMethod& p)
   return in;
 }
 
+EGainOffsetSolver EGainOffsetSolver_stringToEnum(const std::string& solver)
+{
+  if(solver == "linear_programming") return EGainOffsetSolver::LinearProgramming;
+  if(solver == "least_squares")      return EGainOffsetSolver::LeastSquares;
+
+  throw std::invalid_argument("Invalid gain and offset solver: " + solver);
+}
+
+std::string EGainOffsetSolver_enumToString(const EGainOffsetSolver solver)
+{
+  if(solver == EGainOffsetSolver::LinearProgramming) return "linear_programming";
+  if(solver == EGainOffsetSolver::LeastSquares)      return "least_squares";
+
+  throw std::invalid_argument("Unrecognized EGainOffsetSolver: " + std::to_string(int(solver)));
+}
+
+std::ostream& operator<<(std::ostream& os, EGainOffsetSolver p)
+{
+  return os << EGainOffsetSolver_enumToString(p);
+}
+
+std::istream& operator>>(std::istream& in, EGainOffsetSolver& p)
+{
+  std::string token;
+  in >> token;
+  p = EGainOffsetSolver_stringToEnum(token);
+  return in;
+}
+
 ColorHarmonizationEngineGlobal::ColorHarmonizationEngineGlobal(
     const std::string& sfmDataFilename,
     const std::vector<std::string>& featuresFolders,
@@ -90,7 +122,8 @@ ColorHarmonizationEngineGlobal::ColorHarmonizationEngineGlobal(
     const std::string& outputDirectory,
     const std::vector<feature::EImageDescriberType>& descTypes,
     EHistogramSelectionMethod selectionMethod,
-    int imgRef)
+    int imgRef,
+    EGainOffsetSolver solver)
   : _sfmDataFilename(sfmDataFilename)
   , _featuresFolders(featuresFolders)
   , _matchesFolders(matchesFolders)
@@ -98,6 +131,7 @@ ColorHarmonizationEngineGlobal::ColorHarmonizationEngineGlobal(
   , _descTypes(descTypes)
   , _selectionMethod(selectionMethod)
   , _imgRef(imgRef)
+  , _solver(solver)
 {
   if(!fs::exists(outputDirectory))
     fs::create_directory(outputDirectory);
@@ -198,16 +232,38 @@ bool ColorHarmonizationEngineGlobal::Process()
   double minvalue = 0.0;
   double maxvalue = 255.0;
 
+  if(_selectionMethod != EHistogramSelectionMethod::eHistogramHarmonizeFullFrame &&
+     _selectionMethod != EHistogramSelectionMethod::eHistogramHarmonizeMatchedPoints &&
+     _selectionMethod != EHistogramSelectionMethod::eHistogramHarmonizeVLDSegment)
+  {
+    std::cout << "Selection method unsupported" << std::endl;
+    return false;
+  }
+
   // For each edge computes the selection masks and histograms (for the RGB channels)
   std::vector<relativeColorHistogramEdge> map_relativeHistograms[3];
   map_relativeHistograms[0].resize(_pairwiseMatches.size());
   map_relativeHistograms[1].resize(_pairwiseMatches.size());
   map_relativeHistograms[2].resize(_pairwiseMatches.size());
 
-  for (size_t i = 0; i < _pairwiseMatches.size(); ++i)
+  std::vector<matching::PairwiseMatches::const_iterator> pairwiseMatchesIts;
+  pairwiseMatchesIts.reserve(_pairwiseMatches.size());
+  for(matching::PairwiseMatches::const_iterator iter = _pairwiseMatches.begin(); iter != _pairwiseMatches.end(); ++iter)
+    pairwiseMatchesIts.push_back(iter);
+
+  // the pairs are sorted by first view, so the decoded images are shared by the pairs processed at the same time
+  std::size_t maxImageSize = 0;
+  for(const auto& imageSize : _imageSize)
+    maxImageSize = std::max(maxImageSize, imageSize.first * imageSize.second * sizeof(RGBColor));
+  image::ImageCache imageCache((2 * omp_get_max_threads() + 2) * maxImageSize);
+  const image::ImageReadOptions readOptions(image::EImageColorSpace::LINEAR);
+
+  auto progressDisplay = system::createConsoleProgressDisplay(pairwiseMatchesIts.size(), std::cout,
+                                                              "\n- Histograms computation -\n");
+  #pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < pairwiseMatchesIts.size(); ++i)
   {
-    matching::PairwiseMatches::const_iterator iter = _pairwiseMatches.begin();
-    std::advance(iter, i);
+    matching::PairwiseMatches::const_iterator iter = pairwiseMatchesIts[i];
 
     const size_t viewI = iter->first.first;
     const size_t viewJ = iter->first.second;
@@ -218,9 +274,9 @@ bool ColorHarmonizationEngineGlobal::Process()
     //-- Edges names:
     std::pair< std::string, std::string > p_imaNames;
     p_imaNames = make_pair( _fileNames[ viewI ], _fileNames[ viewJ ] );
-    std::cout << "Current edge : "
+    ALICEVISION_LOG_DEBUG("Current edge : "
       << fs::path(p_imaNames.first).filename().string() << "\t"
-      << fs::path(p_imaNames.second).filename().string() << std::endl;
+      << fs::path(p_imaNames.second).filename().string());
 
     //-- Compute the masks from the data selection:
     Image< unsigned char > maskI ( _imageSize[ viewI ].first, _imageSize[ viewI ].second );
@@ -269,9 +325,6 @@ bool ColorHarmonizationEngineGlobal::Process()
         }
       }
       break;
-      default:
-        std::cout << "Selection method unsupported" << std::endl;
-        return false;
     }
 
     //-- Export the masks
@@ -294,9 +347,10 @@ bool ColorHarmonizationEngineGlobal::Process()
     }
 
     //-- Compute the histograms
-    Image< RGBColor > imageI, imageJ;
-    readImage(p_imaNames.first, imageI, image::EImageColorSpace::LINEAR);
-    readImage(p_imaNames.second, imageJ, image::EImageColorSpace::LINEAR);
+    const std::shared_ptr<Image<RGBColor>> imageIPtr = imageCache.get<RGBColor>(p_imaNames.first, readOptions);
+    const std::shared_ptr<Image<RGBColor>> imageJPtr = imageCache.get<RGBColor>(p_imaNames.second, readOptions);
+    const Image<RGBColor>& imageI = *imageIPtr;
+    const Image<RGBColor>& imageJ = *imageJPtr;
 
     utils::Histogram< double > histoI( minvalue, maxvalue, bin);
     utils::Histogram< double > histoJ( minvalue, maxvalue, bin);
@@ -305,7 +359,7 @@ bool ColorHarmonizationEngineGlobal::Process()
     colorHarmonization::CommonDataByPair::computeHisto( histoI, maskI, channelIndex, imageI );
     colorHarmonization::CommonDataByPair::computeHisto( histoJ, maskJ, channelIndex, imageJ );
     relativeColorHistogramEdge & edgeR = map_relativeHistograms[channelIndex][i];
-    edgeR = relativeColorHistogramEdge(map_cameraNodeToCameraIndex[viewI], map_cameraNodeToCameraIndex[viewJ],
+    edgeR = relativeColorHistogramEdge(map_cameraNodeToCameraIndex.at(viewI), map_cameraNodeToCameraIndex.at(viewJ),
       histoI.GetHist(), histoJ.GetHist());
 
     histoI = histoJ = utils::Histogram<double>(minvalue, maxvalue, bin);
@@ -313,7 +367,7 @@ bool ColorHarmonizationEngineGlobal::Process()
     colorHarmonization::CommonDataByPair::computeHisto( histoI, maskI, channelIndex, imageI );
     colorHarmonization::CommonDataByPair::computeHisto( histoJ, maskJ, channelIndex, imageJ );
     relativeColorHistogramEdge & edgeG = map_relativeHistograms[channelIndex][i];
-    edgeG = relativeColorHistogramEdge(map_cameraNodeToCameraIndex[viewI], map_cameraNodeToCameraIndex[viewJ],
+    edgeG = relativeColorHistogramEdge(map_cameraNodeToCameraIndex.at(viewI), map_cameraNodeToCameraIndex.at(viewJ),
       histoI.GetHist(), histoJ.GetHist());
 
     histoI = histoJ = utils::Histogram<double>(minvalue, maxvalue, bin);
@@ -321,11 +375,13 @@ bool ColorHarmonizationEngineGlobal::Process()
     colorHarmonization::CommonDataByPair::computeHisto( histoI, maskI, channelIndex, imageI );
     colorHarmonization::CommonDataByPair::computeHisto( histoJ, maskJ, channelIndex, imageJ );
     relativeColorHistogramEdge & edgeB = map_relativeHistograms[channelIndex][i];
-    edgeB = relativeColorHistogramEdge(map_cameraNodeToCameraIndex[viewI], map_cameraNodeToCameraIndex[viewJ],
+    edgeB = relativeColorHistogramEdge(map_cameraNodeToCameraIndex.at(viewI), map_cameraNodeToCameraIndex.at(viewJ),
       histoI.GetHist(), histoJ.GetHist());
+
+    ++progressDisplay;
   }
 
-  std::cout << "\n -- \n SOLVE for color consistency with linear programming\n --" << std::endl;
+  std::cout << "\n -- \n SOLVE for color consistency with " << EGainOffsetSolver_enumToString(_solver) << "\n --" << std::endl;
   //-- Solve for the gains and offsets:
   std::vector<size_t> vec_indexToFix;
   vec_indexToFix.push_back(map_cameraNodeToCameraIndex[_imgRef]);
@@ -338,43 +394,59 @@ bool ColorHarmonizationEngineGlobal::Process()
 
   aliceVision::system::Timer timer;
 
-  #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_MOSEK)
-  typedef MOSEKSolver SOLVER_LP_T;
-  #else
-  typedef OSI_CISolverWrapper SOLVER_LP_T;
-  #endif
-  // Red channel
-  {
-    SOLVER_LP_T lpSolver(vec_solution_r.size());
-
-    GainOffsetConstraintBuilder cstBuilder(map_relativeHistograms[0], vec_indexToFix);
-    LPConstraintsSparse constraint;
-    cstBuilder.Build(constraint);
-    lpSolver.setup(constraint);
-    lpSolver.solve();
-    lpSolver.getSolution(vec_solution_r);
-  }
-  // Green channel
+  if(_solver == EGainOffsetSolver::LeastSquares)
   {
-    SOLVER_LP_T lpSolver(vec_solution_g.size());
-
-    GainOffsetConstraintBuilder cstBuilder(map_relativeHistograms[1], vec_indexToFix);
-    LPConstraintsSparse constraint;
-    cstBuilder.Build(constraint);
-    lpSolver.setup(constraint);
-    lpSolver.solve();
-    lpSolver.getSolution(vec_solution_g);
+    std::vector<double>* vec_solutions[3] = {&vec_solution_r, &vec_solution_g, &vec_solution_b};
+    for(int channelIndex = 0; channelIndex < 3; ++channelIndex)
+    {
+      if(!solveGainOffsetLeastSquares(set_indeximage.size(), map_relativeHistograms[channelIndex], vec_indexToFix,
+                                      *vec_solutions[channelIndex]))
+      {
+        std::cout << "The least squares gain and offset system cannot be solved" << std::endl;
+        return false;
+      }
+    }
   }
-  // Blue channel
+  else
   {
-    SOLVER_LP_T lpSolver(vec_solution_b.size());
-
-    GainOffsetConstraintBuilder cstBuilder(map_relativeHistograms[2], vec_indexToFix);
-    LPConstraintsSparse constraint;
-    cstBuilder.Build(constraint);
-    lpSolver.setup(constraint);
-    lpSolver.solve();
-    lpSolver.getSolution(vec_solution_b);
+    #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_MOSEK)
+    typedef MOSEKSolver SOLVER_LP_T;
+    #else
+    typedef OSI_CISolverWrapper SOLVER_LP_T;
+    #endif
+    // Red channel
+    {
+      SOLVER_LP_T lpSolver(vec_solution_r.size());
+
+      GainOffsetConstraintBuilder cstBuilder(map_relativeHistograms[0], vec_indexToFix);
+      LPConstraintsSparse constraint;
+      cstBuilder.Build(constraint);
+      lpSolver.setup(constraint);
+      lpSolver.solve();
+      lpSolver.getSolution(vec_solution_r);
+    }
+    // Green channel
+    {
+      SOLVER_LP_T lpSolver(vec_solution_g.size());
+
+      GainOffsetConstraintBuilder cstBuilder(map_relativeHistograms[1], vec_indexToFix);
+      LPConstraintsSparse constraint;
+      cstBuilder.Build(constraint);
+      lpSolver.setup(constraint);
+      lpSolver.solve();
+      lpSolver.getSolution(vec_solution_g);
+    }
+    // Blue channel
+    {
+      SOLVER_LP_T lpSolver(vec_solution_b.size());
+
+      GainOffsetConstraintBuilder cstBuilder(map_relativeHistograms[2], vec_indexToFix);
+      LPConstraintsSparse constraint;
+      cstBuilder.Build(constraint);
+      lpSolver.setup(constraint);
+      lpSolver.solve();
+      lpSolver.getSolution(vec_solution_b);
+    }
   }
 
   std::cout << std::endl
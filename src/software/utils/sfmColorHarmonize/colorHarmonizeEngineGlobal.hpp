@@ -36,6 +36,24 @@ std::string EHistogramSelectionMethod_enumToString(const EHistogramSelectionMeth
 std::ostream& operator<<(std::ostream& os, EHistogramSelectionMethod p);
 std::istream& operator>>(std::istream& in, EHistogramSelectionMethod& p);
 
+enum class EGainOffsetSolver
+{
+    LinearProgramming = 0,
+    LeastSquares
+};
+
+inline std::string EGainOffsetSolver_description()
+{
+  return "Gain and offset solver: \n"
+         "* linear_programming: L-infinity minimization with a linear program \n"
+         "* least_squares: sparse least squares, faster on large graphs\n";
+}
+
+EGainOffsetSolver EGainOffsetSolver_stringToEnum(const std::string& solver);
+std::string EGainOffsetSolver_enumToString(const EGainOffsetSolver solver);
+std::ostream& operator<<(std::ostream& os, EGainOffsetSolver p);
+std::istream& operator>>(std::istream& in, EGainOffsetSolver& p);
+
 /**
  * @brief The ColorHarmonizationEngineGlobal class
  *
@@ -54,7 +72,8 @@ public:
     const std::string& outputDirectory,
     const std::vector<feature::EImageDescriberType>& descTypes,
     EHistogramSelectionMethod selectionMethod,
-    int imgRef = 0);
+    int imgRef = 0,
+    EGainOffsetSolver solver = EGainOffsetSolver::LinearProgramming);
 
   ~ColorHarmonizationEngineGlobal();
 
@@ -64,6 +83,7 @@ private:
 
   EHistogramSelectionMethod _selectionMethod;
   int _imgRef;
+  EGainOffsetSolver _solver;
 
   // Input data
 